@@ -32,27 +32,44 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/flowdiagnostics/AnisotropicEikonal.cpp
         opm/core/flowdiagnostics/DGBasis.cpp
         opm/core/flowdiagnostics/FlowDiagnostics.cpp
+        opm/core/flowdiagnostics/FlowDiagnosticsEngine.cpp
+        opm/core/flowdiagnostics/StreamlineTracer.cpp
         opm/core/flowdiagnostics/TofDiscGalReorder.cpp
+        opm/core/flowdiagnostics/TofLevelSweep.cpp
         opm/core/flowdiagnostics/TofReorder.cpp
         opm/core/grid/GridHelpers.cpp
         opm/core/grid/GridManager.cpp
         opm/core/grid/GridUtilities.cpp
         opm/core/grid/cart_grid.c
+        opm/core/grid/coarse_grid.c
         opm/core/grid/cornerpoint_grid.c
         opm/core/grid/cpgpreprocess/facetopology.c
         opm/core/grid/cpgpreprocess/geometry.c
         opm/core/grid/cpgpreprocess/preprocess.c
         opm/core/grid/cpgpreprocess/uniquepoints.c
+        opm/core/grid/geometry_soa.c
         opm/core/grid/grid.c
+        opm/core/grid/grid_binary.c
+        opm/core/grid/grid_hash.c
+        opm/core/grid/grid_text.c
+        opm/core/grid/grid_topology.c
         opm/core/grid/grid_equal.cpp
+        opm/core/io/AsyncOutputWriter.cpp
+        opm/core/io/GatherOutputWriter.cpp
+        opm/core/io/CheckpointWriter.cpp
+        opm/core/io/FieldArchive.cpp
         opm/core/io/OutputWriter.cpp
         opm/core/io/eclipse/EclipseGridInspector.cpp
         opm/core/io/eclipse/EclipseReader.cpp
         opm/core/io/eclipse/EclipseWriteRFTHandler.cpp
         opm/core/io/eclipse/EclipseWriter.cpp
+        opm/core/io/eclipse/GrdeclIndex.cpp
+        opm/core/io/eclipse/RestartFileIndex.cpp
         opm/core/io/eclipse/writeECLData.cpp
         opm/core/io/vag/vag.cpp
         opm/core/io/vtk/writeVtkData.cpp
+        opm/core/linalg/DeflatedConjugateGradient.cpp
+        opm/core/linalg/LinearSolverAmgx.cpp
         opm/core/linalg/LinearSolverFactory.cpp
         opm/core/linalg/LinearSolverInterface.cpp
         opm/core/linalg/LinearSolverIstl.cpp
@@ -62,8 +79,11 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/linalg/sparse_sys.c
         opm/core/pressure/CompressibleTpfa.cpp
         opm/core/pressure/FlowBCManager.cpp
+        opm/core/pressure/IncompMsmfem.cpp
         opm/core/pressure/IncompTpfa.cpp
+        opm/core/pressure/IncompTpfaStaticData.cpp
         opm/core/pressure/IncompTpfaSinglePhase.cpp
+        opm/core/pressure/SinglePhaseUpscaler.cpp
         opm/core/pressure/cfsh.c
         opm/core/pressure/flow_bc.c
         opm/core/pressure/fsh.c
@@ -79,6 +99,8 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/pressure/msmfem/hash_set.c
         opm/core/pressure/msmfem/ifsh_ms.c
         opm/core/pressure/msmfem/partition.c
+        opm/core/pressure/msmfem/partition_graph.c
+        opm/core/pressure/tpfa/TpfaOperator.cpp
         opm/core/pressure/tpfa/TransTpfa.cpp
         opm/core/pressure/tpfa/cfs_tpfa.c
         opm/core/pressure/tpfa/cfs_tpfa_residual.c
@@ -102,8 +124,10 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/props/satfunc/SaturationPropsBasic.cpp
         opm/core/props/satfunc/SaturationPropsFromDeck.cpp
         opm/core/simulator/AdaptiveSimulatorTimer.cpp
+        opm/core/simulator/BlackoilStartup.cpp
         opm/core/simulator/BlackoilState.cpp
         opm/core/simulator/TwophaseState.cpp
+        opm/core/simulator/PhasePipeline.cpp
         opm/core/simulator/SimulatorCompressibleTwophase.cpp
         opm/core/simulator/SimulatorIncompTwophase.cpp
         opm/core/simulator/SimulatorOutput.cpp
@@ -111,6 +135,7 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/simulator/SimulatorTimer.cpp
         opm/core/simulator/TimeStepControl.cpp
         opm/core/transport/TransportSolverTwophaseInterface.cpp
+        opm/core/transport/implicit/CSRMatrixBlockGaussSeidelSolver.cpp
         opm/core/transport/implicit/TransportSolverTwophaseImplicit.cpp
         opm/core/transport/implicit/transport_source.c
         opm/core/transport/minimal/spu_explicit.c
@@ -120,16 +145,23 @@ list (APPEND MAIN_SOURCE_FILES
         opm/core/transport/reorder/TransportSolverTwophaseReorder.cpp
         opm/core/transport/reorder/reordersequence.cpp
         opm/core/transport/reorder/tarjan.c
+        opm/core/utility/CellRegionIndex.cpp
         opm/core/utility/Event.cpp
+        opm/core/utility/KernelTimer.cpp
+        opm/core/utility/MemoryReport.cpp
         opm/core/utility/MonotCubicInterpolator.cpp
         opm/core/utility/NullStream.cpp
         opm/core/utility/StopWatch.cpp
+        opm/core/utility/ThreadControl.cpp
+        opm/core/utility/TimingTree.cpp
         opm/core/utility/VelocityInterpolation.cpp
         opm/core/utility/WachspressCoord.cpp
         opm/core/utility/compressedToCartesian.cpp
         opm/core/utility/extractPvtTableIndex.cpp
+        opm/core/utility/first_touch.c
         opm/core/utility/miscUtilities.cpp
         opm/core/utility/miscUtilitiesBlackoil.cpp
+        opm/core/utility/parameters/FrozenParameterGroup.cpp
         opm/core/utility/parameters/Parameter.cpp
         opm/core/utility/parameters/ParameterGroup.cpp
         opm/core/utility/parameters/ParameterTools.cpp
@@ -153,15 +185,49 @@ list (APPEND MAIN_SOURCE_FILES
 list (APPEND TEST_SOURCE_FILES
   tests/test_writenumwells.cpp
 	tests/test_writeReadRestartFile.cpp
+	tests/test_restartfileindex.cpp
+	tests/test_grdeclindex.cpp
+	tests/test_vag.cpp
 	tests/test_EclipseWriter.cpp
 	tests/test_EclipseWriteRFTHandler.cpp
 	tests/test_compressedpropertyaccess.cpp
+	tests/test_cellregionindex.cpp
 	tests/test_dgbasis.cpp
 	tests/test_cartgrid.cpp
+	tests/test_hybsys_global.cpp
+	tests/test_coarse_sys.cpp
+	tests/test_partition_graph.cpp
+	tests/test_rootfinders.cpp
+	tests/test_fixedsizead.cpp
+	tests/test_reproduciblesum.cpp
+	tests/test_spu_explicit.cpp
+	tests/test_blockgaussseidel.cpp
   tests/test_ug.cpp
 	tests/test_cubic.cpp
 	tests/test_event.cpp
+	tests/test_asyncoutputwriter.cpp
+	tests/test_checkpoint.cpp
+	tests/test_fieldarchive.cpp
+	tests/test_gatheroutputwriter.cpp
+	tests/test_timingtree.cpp
+	tests/test_memoryreport.cpp
+	tests/test_kerneltimer.cpp
+	tests/test_phasepipeline.cpp
+	tests/test_threadcontrol.cpp
+	tests/test_fluidstatebatch.cpp
+	tests/test_flowbcmanager.cpp
+	tests/test_incompmsmfem.cpp
 	tests/test_flowdiagnostics.cpp
+	tests/test_flowdiagnosticsengine.cpp
+	tests/test_streamlinetracer.cpp
+	tests/test_reordersequence.cpp
+	tests/test_tofreorder.cpp
+	tests/test_tpfaoperator.cpp
+	tests/test_cfs_tpfa_residual.cpp
+	tests/test_bcsrmatrix.cpp
+	tests/test_csrmatrix.cpp
+	tests/test_deflatedcg.cpp
+	tests/test_singlephaseupscaler.cpp
 	tests/test_nonuniformtablelinear.cpp
 	tests/test_parallelistlinformation.cpp
 	tests/test_sparsevector.cpp
@@ -236,6 +302,7 @@ list (APPEND TEST_DATA_FILES
 # originally generated with the command:
 # find tutorials examples -name '*.c*' -printf '\t%p\n' | sort
 list (APPEND EXAMPLE_SOURCE_FILES
+	examples/benchmark_linear_solvers.cpp
 	examples/compute_eikonal_from_files.cpp
 	examples/compute_initial_state.cpp
 	examples/compute_tof.cpp
@@ -243,6 +310,7 @@ list (APPEND EXAMPLE_SOURCE_FILES
   examples/mirror_grid.cpp
 	examples/sim_2p_comp_reorder.cpp
 	examples/sim_2p_incomp.cpp
+	examples/sim_2p_incomp_ensemble.cpp
 	examples/wells_example.cpp
 	examples/diagnose_relperm.cpp
 	tutorials/tutorial1.cpp
@@ -268,6 +336,7 @@ list (APPEND PROGRAM_SOURCE_FILES
   examples/mirror_grid.cpp
 	examples/sim_2p_comp_reorder.cpp
 	examples/sim_2p_incomp.cpp
+	examples/sim_2p_incomp_ensemble.cpp
 	)
 
 # originally generated with the command:
@@ -277,9 +346,13 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/flowdiagnostics/AnisotropicEikonal.hpp
         opm/core/flowdiagnostics/DGBasis.hpp
         opm/core/flowdiagnostics/FlowDiagnostics.hpp
+        opm/core/flowdiagnostics/FlowDiagnosticsEngine.hpp
+        opm/core/flowdiagnostics/StreamlineTracer.hpp
         opm/core/flowdiagnostics/TofDiscGalReorder.hpp
+        opm/core/flowdiagnostics/TofLevelSweep.hpp
         opm/core/flowdiagnostics/TofReorder.hpp
         opm/core/grid.h
+        opm/core/grid/CartesianGridView.hpp
         opm/core/grid/CellQuadrature.hpp
         opm/core/grid/ColumnExtract.hpp
         opm/core/grid/FaceQuadrature.hpp
@@ -288,12 +361,21 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/grid/GridUtilities.hpp
         opm/core/grid/MinpvProcessor.hpp
         opm/core/grid/PinchProcessor.hpp
+        opm/core/grid/QuadratureTable.hpp
         opm/core/grid/cart_grid.h
+        opm/core/grid/coarse_grid.h
         opm/core/grid/cornerpoint_grid.h
         opm/core/grid/cpgpreprocess/facetopology.h
         opm/core/grid/cpgpreprocess/geometry.h
         opm/core/grid/cpgpreprocess/preprocess.h
         opm/core/grid/cpgpreprocess/uniquepoints.h
+        opm/core/grid/geometry_soa.h
+        opm/core/grid/grid_binary.h
+        opm/core/grid/grid_topology.h
+        opm/core/io/AsyncOutputWriter.hpp
+        opm/core/io/GatherOutputWriter.hpp
+        opm/core/io/CheckpointWriter.hpp
+        opm/core/io/FieldArchive.hpp
         opm/core/io/OutputWriter.hpp
         opm/core/io/eclipse/CornerpointChopper.hpp
         opm/core/io/eclipse/EclipseGridInspector.hpp
@@ -302,9 +384,14 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/io/eclipse/EclipseUnits.hpp
         opm/core/io/eclipse/EclipseWriteRFTHandler.hpp
         opm/core/io/eclipse/EclipseWriter.hpp
+        opm/core/io/eclipse/GrdeclIndex.hpp
+        opm/core/io/eclipse/RestartFileIndex.hpp
         opm/core/io/eclipse/writeECLData.hpp
         opm/core/io/vag/vag.hpp
         opm/core/io/vtk/writeVtkData.hpp
+        opm/core/linalg/DeflatedConjugateGradient.hpp
+        opm/core/linalg/LinearOperatorInterface.hpp
+        opm/core/linalg/LinearSolverAmgx.hpp
         opm/core/linalg/LinearSolverFactory.hpp
         opm/core/linalg/LinearSolverInterface.hpp
         opm/core/linalg/LinearSolverIstl.hpp
@@ -316,8 +403,11 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/linalg/sparse_sys.h
         opm/core/pressure/CompressibleTpfa.hpp
         opm/core/pressure/FlowBCManager.hpp
+        opm/core/pressure/IncompMsmfem.hpp
         opm/core/pressure/IncompTpfa.hpp
+        opm/core/pressure/IncompTpfaStaticData.hpp
         opm/core/pressure/IncompTpfaSinglePhase.hpp
+        opm/core/pressure/SinglePhaseUpscaler.hpp
         opm/core/pressure/flow_bc.h
         opm/core/pressure/fsh.h
         opm/core/pressure/fsh_common_impl.h
@@ -331,6 +421,11 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/pressure/msmfem/hash_set.h
         opm/core/pressure/msmfem/ifsh_ms.h
         opm/core/pressure/msmfem/partition.h
+        opm/core/pressure/msmfem/partition_graph.h
+        opm/core/pressure/tpfa/IfsTpfa.hpp
+        opm/core/pressure/tpfa/IfsTpfa_impl.hpp
+        opm/core/pressure/tpfa/TpfaOperator.hpp
+        opm/core/pressure/tpfa/TpfaOperator_impl.hpp
         opm/core/pressure/tpfa/TransTpfa.hpp
         opm/core/pressure/tpfa/TransTpfa_impl.hpp
         opm/core/pressure/tpfa/cfs_tpfa.h
@@ -345,18 +440,22 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/props/BlackoilPropertiesBasic.hpp
         opm/core/props/BlackoilPropertiesFromDeck.hpp
         opm/core/props/BlackoilPropertiesInterface.hpp
+        opm/core/props/BlackoilPropertiesShadow.hpp
+        opm/core/props/BlackoilPropertiesShadow_impl.hpp
         opm/core/props/IncompPropertiesBasic.hpp
         opm/core/props/IncompPropertiesFromDeck.hpp
         opm/core/props/IncompPropertiesInterface.hpp
         opm/core/props/IncompPropertiesShadow.hpp
         opm/core/props/IncompPropertiesShadow_impl.hpp
         opm/core/props/IncompPropertiesSinglePhase.hpp
+        opm/core/props/NumPhasesDispatch.hpp
         opm/core/props/phaseUsageFromDeck.hpp
         opm/core/props/pvt/PvtPropertiesBasic.hpp
         opm/core/props/pvt/PvtPropertiesIncompFromDeck.hpp
         opm/core/props/pvt/ThermalGasPvtWrapper.hpp
         opm/core/props/pvt/ThermalOilPvtWrapper.hpp
         opm/core/props/pvt/ThermalWaterPvtWrapper.hpp
+        opm/core/props/pvt/ViscosityTemperatureFactor.hpp
         opm/core/props/rock/RockBasic.hpp
         opm/core/props/rock/RockCompressibility.hpp
         opm/core/props/rock/RockFromDeck.hpp
@@ -368,11 +467,14 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/simulator/AdaptiveSimulatorTimer.hpp
         opm/core/simulator/AdaptiveTimeStepping.hpp
         opm/core/simulator/AdaptiveTimeStepping_impl.hpp
+        opm/core/simulator/BlackoilStartup.hpp
         opm/core/simulator/BlackoilState.hpp
         opm/core/simulator/BlackoilStateToFluidState.hpp
         opm/core/simulator/EquilibrationHelpers.hpp
         opm/core/simulator/ExplicitArraysFluidState.hpp
+        opm/core/simulator/ExplicitArraysFluidStateBatch.hpp
         opm/core/simulator/ExplicitArraysSatDerivativesFluidState.hpp
+        opm/core/simulator/PhasePipeline.hpp
         opm/core/simulator/SimulatorCompressibleTwophase.hpp
         opm/core/simulator/SimulatorIncompTwophase.hpp
         opm/core/simulator/SimulatorOutput.hpp
@@ -389,6 +491,8 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/simulator/initState_impl.hpp
         opm/core/transport/TransportSolverTwophaseInterface.hpp
         opm/core/transport/implicit/CSRMatrixBlockAssembler.hpp
+        opm/core/transport/implicit/CSRMatrixBlockGaussSeidelSolver.hpp
+        opm/core/transport/implicit/CSRMatrixLinearSolver.hpp
         opm/core/transport/implicit/CSRMatrixUmfpackSolver.hpp
         opm/core/transport/implicit/ImplicitAssembly.hpp
         opm/core/transport/implicit/ImplicitTransport.hpp
@@ -401,25 +505,36 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/transport/implicit/transport_source.h
         opm/core/transport/minimal/spu_explicit.h
         opm/core/transport/minimal/spu_implicit.h
+        opm/core/transport/reorder/ReorderSequence.hpp
+        opm/core/transport/reorder/ReorderSequence_impl.hpp
         opm/core/transport/reorder/ReorderSolverInterface.hpp
         opm/core/transport/reorder/TransportSolverCompressibleTwophaseReorder.hpp
         opm/core/transport/reorder/TransportSolverTwophaseReorder.hpp
         opm/core/transport/reorder/reordersequence.h
         opm/core/transport/reorder/tarjan.h
+        opm/core/utility/AlignedAllocator.hpp
         opm/core/utility/Average.hpp
+        opm/core/utility/CellRegionIndex.hpp
         opm/core/utility/CompressedPropertyAccess.hpp
         opm/core/utility/DataMap.hpp
         opm/core/utility/Event.hpp
         opm/core/utility/Event_impl.hpp
         opm/core/utility/Factory.hpp
+        opm/core/utility/FixedSizeAd.hpp
+        opm/core/utility/KernelTimer.hpp
+        opm/core/utility/MemoryReport.hpp
         opm/core/utility/MonotCubicInterpolator.hpp
         opm/core/utility/NonuniformTableLinear.hpp
         opm/core/utility/NullStream.hpp
         opm/core/utility/RegionMapping.hpp
+        opm/core/utility/RegionSortedOrder.hpp
+        opm/core/utility/ReproducibleSum.hpp
         opm/core/utility/RootFinders.hpp
         opm/core/utility/SparseTable.hpp
         opm/core/utility/SparseVector.hpp
         opm/core/utility/StopWatch.hpp
+        opm/core/utility/ThreadControl.hpp
+        opm/core/utility/TimingTree.hpp
         opm/core/utility/UniformTableLinear.hpp
         opm/core/utility/Units.hpp
         opm/core/utility/VelocityInterpolation.hpp
@@ -427,11 +542,13 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/utility/buildUniformMonotoneTable.hpp
         opm/core/utility/compressedToCartesian.hpp
         opm/core/utility/extractPvtTableIndex.hpp
+        opm/core/utility/first_touch.h
         opm/core/utility/have_boost_redef.hpp
         opm/core/utility/linearInterpolation.hpp
         opm/core/utility/miscUtilities.hpp
         opm/core/utility/miscUtilitiesBlackoil.hpp
         opm/core/utility/miscUtilities_impl.hpp
+        opm/core/utility/parameters/FrozenParameterGroup.hpp
         opm/core/utility/parameters/Parameter.hpp
         opm/core/utility/parameters/ParameterGroup.hpp
         opm/core/utility/parameters/ParameterGroup_impl.hpp
@@ -449,6 +566,7 @@ list (APPEND PUBLIC_HEADER_FILES
         opm/core/wells/InjectionSpecification.hpp
         opm/core/wells/ProductionSpecification.hpp
         opm/core/wells/WellCollection.hpp
+        opm/core/wells/WellIndexCache.hpp
         opm/core/wells/WellsGroup.hpp
         opm/core/wells/WellsManager.hpp
         opm/core/wells/WellsManager_impl.hpp
@@ -0,0 +1,292 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// \file
+/// Throughput benchmarks of core kernels on synthetic Cartesian grids.
+///
+/// Parameters (with defaults):
+///   nx, ny, nz   50, 50, 20   Grid dimensions for create_grid_cart3d().
+///   repeats      10           Number of timed runs of each kernel.
+///   output       opm-core-bench.json
+///                             File to write the JSON report to.  The
+///                             report goes to standard output if empty
+///                             (some kernels also print to standard output).
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid/cornerpoint_grid.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/tpfa/cfs_tpfa_residual.h>
+#include <opm/core/pressure/tpfa/compr_quant_general.h>
+#include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/flowdiagnostics/TofReorder.hpp>
+#include <opm/core/props/satfunc/SaturationPropsBasic.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    struct BenchResult
+    {
+        std::string name;
+        int         items;      // Number of items (cells or faces) per run.
+        double      mean;       // Seconds.
+        double      min;        // Seconds.
+    };
+
+    /// Time 'repeats' runs of 'kernel', following one untimed warm-up run.
+    template <class Kernel>
+    BenchResult timeKernel(const std::string& name, const int items,
+                           const int repeats, Kernel kernel)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        kernel();
+
+        double total = 0.0;
+        double best  = std::numeric_limits<double>::max();
+        for (int r = 0; r < repeats; ++r) {
+            const Clock::time_point start = Clock::now();
+            kernel();
+            const double secs =
+                std::chrono::duration<double>(Clock::now() - start).count();
+            total += secs;
+            best   = std::min(best, secs);
+        }
+
+        BenchResult res;
+        res.name  = name;
+        res.items = items;
+        res.mean  = total / repeats;
+        res.min   = best;
+        return res;
+    }
+
+    void writeJson(std::ostream& os, const UnstructuredGrid& g,
+                   const int nx, const int ny, const int nz, const int repeats,
+                   const std::vector<BenchResult>& results)
+    {
+        os.precision(9);
+        os << "{\n"
+           << "  \"grid\": { \"nx\": " << nx << ", \"ny\": " << ny << ", \"nz\": " << nz
+           << ", \"cells\": " << g.number_of_cells
+           << ", \"faces\": " << g.number_of_faces << " },\n"
+           << "  \"repeats\": " << repeats << ",\n"
+           << "  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            os << "    { \"name\": \"" << r.name << "\""
+               << ", \"items\": " << r.items
+               << ", \"mean_seconds\": " << r.mean
+               << ", \"min_seconds\": " << r.min
+               << ", \"items_per_second\": " << (r.min > 0.0 ? r.items / r.min : 0.0)
+               << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+        os << "  ]\n}\n";
+    }
+
+    /// Uniform Darcy flux field.  Boundary fluxes are represented as
+    /// cell sources (inflow) and sinks (outflow).
+    void uniformFlux(const UnstructuredGrid& g,
+                     std::vector<double>& flux,
+                     std::vector<double>& src)
+    {
+        const double v[3] = { 1.0, 0.5, 0.25 };
+        const int dim = g.dimensions;
+
+        flux.assign(g.number_of_faces, 0.0);
+        src .assign(g.number_of_cells, 0.0);
+        for (int f = 0; f < g.number_of_faces; ++f) {
+            for (int d = 0; d < dim; ++d) {
+                flux[f] += v[d] * g.face_normals[dim*f + d];
+            }
+            const int c0 = g.face_cells[2*f + 0];
+            const int c1 = g.face_cells[2*f + 1];
+            if (c1 < 0) {
+                src[c0] -= flux[f];
+            } else if (c0 < 0) {
+                src[c1] += flux[f];
+            }
+        }
+    }
+
+    struct GridDeleter
+    {
+        void operator()(UnstructuredGrid* g) const { destroy_grid(g); }
+    };
+} // anon namespace
+
+
+
+// ----------------- Main program -----------------
+int
+main(int argc, char** argv)
+try
+{
+    using namespace Opm;
+
+    parameter::ParameterGroup param(argc, argv, false, false);
+    const int nx      = param.getDefault("nx", 50);
+    const int ny      = param.getDefault("ny", 50);
+    const int nz      = param.getDefault("nz", 20);
+    const int repeats = std::max(1, param.getDefault("repeats", 10));
+    const std::string output = param.getDefault<std::string>("output", "opm-core-bench.json");
+
+    std::unique_ptr<UnstructuredGrid, GridDeleter> grid(create_grid_cart3d(nx, ny, nz));
+    if (!grid) {
+        OPM_THROW(std::runtime_error, "Failed to create " << nx << "x" << ny << "x" << nz << " grid.");
+    }
+    UnstructuredGrid& g = *grid;
+    const int nc  = g.number_of_cells;
+    const int nf  = g.number_of_faces;
+    const int nhf = g.cell_facepos[nc];
+    const int dim = g.dimensions;
+
+    std::vector<BenchResult> results;
+
+    // Geometry.
+    results.push_back(timeKernel("compute_geometry", nc, repeats,
+                                 [&]() { compute_geometry(&g); }));
+
+    // Transmissibilities.
+    std::vector<double> perm(nc * dim * dim, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        for (int d = 0; d < dim; ++d) {
+            perm[c*dim*dim + d*dim + d] = 1.0e-13;
+        }
+    }
+    std::vector<double> htrans(nhf), trans(nf);
+    results.push_back(timeKernel("tpfa_trans_compute", nf, repeats, [&]() {
+                tpfa_htrans_compute(&g, &perm[0], &htrans[0]);
+                tpfa_trans_compute(&g, &htrans[0], &trans[0]);
+            }));
+
+    // Incompressible assembly.
+    {
+        struct ifs_tpfa_data* h = ifs_tpfa_construct(&g, 0);
+        if (h == 0) {
+            OPM_THROW(std::runtime_error, "Failed to construct ifs_tpfa assembler.");
+        }
+        std::vector<double> src(nc, 0.0), totmob(nc, 1.0), gpress(nhf, 0.0);
+        src[0] = 1.0;  src[nc - 1] = -1.0;
+        struct ifs_tpfa_forces F = { &src[0], 0, 0, &totmob[0], 0 };
+        results.push_back(timeKernel("ifs_tpfa_assemble", nc, repeats, [&]() {
+                    ifs_tpfa_assemble(&g, &F, &trans[0], &gpress[0], h);
+                }));
+        ifs_tpfa_destroy(h);
+    }
+
+    // Compressible residual assembly, two phases.
+    {
+        const int np = 2;
+        struct cfs_tpfa_res_data* h = cfs_tpfa_res_construct(&g, 0, np);
+        struct compr_quantities_gen* cq = compr_quantities_gen_allocate(nc, nf, np);
+        if ((h == 0) || (cq == 0)) {
+            OPM_THROW(std::runtime_error, "Failed to construct cfs_tpfa_res assembler.");
+        }
+        std::fill(cq->dAc, cq->dAc + nc*np*np, 0.0);
+        std::fill(cq->Ac , cq->Ac  + nc*np*np, 0.0);
+        std::fill(cq->Af , cq->Af  + nf*np*np, 0.0);
+        std::fill(cq->phasemobf, cq->phasemobf + nf*np, 1.0);
+        std::fill(cq->voldiscr , cq->voldiscr  + nc   , 0.0);
+        for (int c = 0; c < nc; ++c) {
+            for (int p = 0; p < np; ++p) {
+                cq->Ac [c*np*np + p*np + p] = 1.0;
+                cq->dAc[c*np*np + p*np + p] = 1.0e-9;
+            }
+        }
+        for (int f = 0; f < nf; ++f) {
+            for (int p = 0; p < np; ++p) {
+                cq->Af[f*np*np + p*np + p] = 1.0;
+            }
+        }
+        std::vector<double> zc(nc*np, 0.5), gravcap_f(nf*np, 0.0);
+        std::vector<double> cpress(nc, 1.0e7), porevol(nc, 0.2);
+        struct cfs_tpfa_res_forces forces = { 0, 0 };
+        results.push_back(timeKernel("cfs_tpfa_res_assemble", nc, repeats, [&]() {
+                    cfs_tpfa_res_assemble(&g, 86400.0, &forces, &zc[0], cq, &trans[0],
+                                          &gravcap_f[0], &cpress[0], 0, &porevol[0], h);
+                }));
+        compr_quantities_gen_deallocate(cq);
+        cfs_tpfa_res_destroy(h);
+    }
+
+    // Reordering and time-of-flight.
+    std::vector<double> flux, src;
+    uniformFlux(g, flux, src);
+    {
+        std::vector<int> sequence(nc), components(nc + 1);
+        int ncomp = 0;
+        results.push_back(timeKernel("compute_sequence", nc, repeats, [&]() {
+                    compute_sequence(&g, &flux[0], &sequence[0], &components[0], &ncomp);
+                }));
+    }
+    {
+        std::vector<double> pv(nc, 1.0), tof;
+        TofReorder solver(g);
+        results.push_back(timeKernel("TofReorder::solveTof", nc, repeats, [&]() {
+                    solver.solveTof(&flux[0], &pv[0], &src[0], tof);
+                }));
+    }
+
+    // Relative permeability.  SaturationPropsFromDeck needs an input
+    // deck, so the analytic SaturationPropsBasic is measured here.
+    {
+        const int np = 2;
+        SaturationPropsBasic props;
+        props.init(np, SaturationPropsBasic::Quadratic);
+        std::vector<double> s(nc*np), kr(nc*np), dkrds(nc*np*np);
+        for (int c = 0; c < nc; ++c) {
+            s[c*np + 0] = double(c % 101) / 100.0;
+            s[c*np + 1] = 1.0 - s[c*np + 0];
+        }
+        results.push_back(timeKernel("SaturationPropsBasic::relperm", nc, repeats, [&]() {
+                    props.relperm(nc, &s[0], &kr[0], &dkrds[0]);
+                }));
+    }
+
+    if (output.empty()) {
+        writeJson(std::cout, g, nx, ny, nz, repeats, results);
+    } else {
+        std::ofstream os(output.c_str());
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Failed to open " << output);
+        }
+        writeJson(os, g, nx, ny, nz, repeats, results);
+    }
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
@@ -0,0 +1,317 @@
+#!/usr/bin/env python
+#
+# Copyright 2016 SINTEF ICT, Applied Mathematics.
+#
+# This file is part of the Open Porous Media project (OPM).
+#
+# OPM is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# OPM is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+# End-to-end throughput benchmarks of the example programs.
+#
+# For every grid size, an SPE10-like deck is generated: a Cartesian
+# grid with the cell sizes of SPE10 model 2, a smooth log-normal
+# permeability in the upper (Tarbert-like) layers and meandering
+# high-permeability channels in the lower (Upper Ness-like) layers,
+# and a five-spot well pattern.  The programs
+#
+#   sim_2p_incomp, sim_2p_comp_reorder, compute_tof and
+#   compute_initial_state
+#
+# are then run on it with every thread count (OMP_NUM_THREADS),
+# recording the wall time of the run and of its phases (from the
+# SimulatorReport written to walltime.param, or the timings printed
+# by compute_tof), the peak resident set size, and the parallel
+# efficiency relative to the smallest thread count.  The results are
+# written as JSON, for tracking trends between versions.
+#
+# Usage (from a build directory, after "make opm-core-e2e-bench" or
+# building the four example programs):
+#
+#   python opm-core-e2e-bench.py --bindir bin --sizes 30x55x17,60x110x34 \
+#          --threads 1,2,4 --output opm-core-e2e-bench.json
+
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+PROGRAMS = ['sim_2p_incomp', 'sim_2p_comp_reorder', 'compute_tof', 'compute_initial_state']
+
+# Cell sizes of SPE10 model 2: 20 ft x 10 ft x 2 ft.
+DX, DY, DZ = 6.096, 3.048, 0.6096
+# Share of the layers that are Tarbert-like in SPE10 (35 of 85).
+TARBERT_SHARE = 35.0 / 85.0
+
+
+def permeability(nx, ny, nz, seed):
+    """Horizontal permeability (mD) by cell, x fastest, and porosity."""
+    rng = random.Random(seed)
+    perm = []
+    tarbert_layers = max(1, int(round(TARBERT_SHARE * nz)))
+    for k in range(nz):
+        if k < tarbert_layers:
+            # Log-normal field, smoothed by a 3x3 moving average.
+            noise = [[rng.gauss(0.0, 1.0) for i in range(nx)] for j in range(ny)]
+            mean = math.log(rng.uniform(20.0, 200.0))
+            for j in range(ny):
+                for i in range(nx):
+                    s, n = 0.0, 0
+                    for jj in range(max(0, j - 1), min(ny, j + 2)):
+                        for ii in range(max(0, i - 1), min(nx, i + 2)):
+                            s += noise[jj][ii]
+                            n += 1
+                    perm.append(math.exp(mean + 1.5 * s / math.sqrt(n)))
+        else:
+            # Low-permeability background with channels meandering in y.
+            channels = [(rng.uniform(0, nx), rng.uniform(0.5, 3.0),
+                         rng.uniform(0.05 * nx, 0.2 * nx), rng.uniform(0.5, 2.0),
+                         rng.uniform(0, 2 * math.pi))
+                        for c in range(max(1, nx // 15))]
+            for j in range(ny):
+                centres = [(x0 + a * math.sin(w * 2 * math.pi * j / ny + ph), hw)
+                           for (x0, hw, a, w, ph) in channels]
+                for i in range(nx):
+                    inside = any(abs(i - x) <= hw for (x, hw) in centres)
+                    if inside:
+                        perm.append(math.exp(rng.gauss(math.log(2000.0), 0.5)))
+                    else:
+                        perm.append(math.exp(rng.gauss(math.log(1.0), 1.5)))
+    poro = [min(0.4, max(0.01, 0.1 + 0.04 * math.log10(max(k, 1e-3)))) for k in perm]
+    return perm, poro
+
+
+def writeArray(f, keyword, values, fmt='%.6g'):
+    f.write('%s\n' % keyword)
+    for i in range(0, len(values), 8):
+        f.write(' '.join(fmt % v for v in values[i:i + 8]) + '\n')
+    f.write('/\n\n')
+
+
+def writeGrid(f, nx, ny, nz, perm, poro):
+    nc = nx * ny * nz
+    f.write('GRID\n\n')
+    f.write('DX\n%d*%g /\nDY\n%d*%g /\nDZ\n%d*%g /\n' % (nc, DX, nc, DY, nc, DZ))
+    f.write('TOPS\n%d*3657.6 /\n\n' % (nx * ny))
+    writeArray(f, 'PERMX', perm)
+    writeArray(f, 'PERMY', perm)
+    writeArray(f, 'PERMZ', [0.1 * k for k in perm])
+    writeArray(f, 'PORO', poro)
+
+
+def writeTwophaseDeck(path, nx, ny, nz, perm, poro, steps, step_days):
+    """Water-oil deck with five-spot wells for the simulators and tof."""
+    nc = nx * ny * nz
+    porevol = sum(p * DX * DY * DZ for p in poro)
+    # Inject 30% of the pore volume over the schedule.
+    rate = 0.3 * porevol / (steps * step_days)
+    with open(path, 'w') as f:
+        f.write('RUNSPEC\n\nWATER\nOIL\n\nMETRIC\n\n')
+        f.write('DIMENS\n%d %d %d /\n\n' % (nx, ny, nz))
+        f.write('TABDIMS\n1 1 20 20 1 20 /\n\n')
+        f.write('WELLDIMS\n5 %d 1 5 /\n\n' % nz)
+        f.write('START\n1 JAN 2000 /\n\n')
+        writeGrid(f, nx, ny, nz, perm, poro)
+        f.write('PROPS\n\n')
+        f.write('SWOF\n')
+        for i in range(11):
+            sw = 0.2 + 0.6 * i / 10.0
+            se = (sw - 0.2) / 0.6
+            f.write('%.3f %.6f %.6f 0\n' % (sw, se * se, (1 - se) ** 2))
+        f.write('/\n\n')
+        f.write('PVTW\n300 1.01 4.5e-5 0.3 0 /\n\n')
+        f.write('PVCDO\n300 1.05 1.5e-4 3.0 0 /\n\n')
+        f.write('DENSITY\n850 1025 1 /\n\n')
+        f.write('SOLUTION\n\n')
+        f.write('PRESSURE\n%d*300 /\n\nSWAT\n%d*0.2 /\n\n' % (nc, nc))
+        f.write('SCHEDULE\n\n')
+        ic, jc = nx // 2 + 1, ny // 2 + 1
+        wells = [('INJ', ic, jc)] + [('P%d' % (n + 1), i, j) for n, (i, j) in
+                                     enumerate([(1, 1), (nx, 1), (1, ny), (nx, ny)])]
+        f.write('WELSPECS\n')
+        for (name, i, j) in wells:
+            f.write("'%s' 'G' %d %d 1* '%s' /\n" % (name, i, j, 'WATER' if name == 'INJ' else 'OIL'))
+        f.write('/\n\nCOMPDAT\n')
+        for (name, i, j) in wells:
+            f.write("'%s' %d %d 1 %d 'OPEN' 2* 0.2 /\n" % (name, i, j, nz))
+        f.write('/\n\nWCONINJE\n')
+        f.write("'INJ' 'WATER' 'OPEN' 'RATE' %g 1* 1000 /\n/\n\n" % rate)
+        f.write('WCONPROD\n')
+        for (name, i, j) in wells[1:]:
+            f.write("'%s' 'OPEN' 'BHP' 5* 250 /\n" % name)
+        f.write('/\n\nTSTEP\n%d*%g /\n\nEND\n' % (steps, step_days))
+
+
+def writeEquilDeck(path, nx, ny, nz, perm, poro):
+    """Dead three-phase deck with an equilibration for compute_initial_state."""
+    with open(path, 'w') as f:
+        f.write('RUNSPEC\n\nWATER\nOIL\nGAS\n\nMETRIC\n\n')
+        f.write('DIMENS\n%d %d %d /\n\n' % (nx, ny, nz))
+        f.write('TABDIMS\n1 1 20 20 1 20 /\n\nEQLDIMS\n1 /\n\n')
+        f.write('START\n1 JAN 2000 /\n\n')
+        writeGrid(f, nx, ny, nz, perm, poro)
+        f.write('PROPS\n\n')
+        f.write('SWOF\n0.2 0 1 0\n0.8 1 0 0\n1.0 1 0 0\n/\n\n')
+        f.write('SGOF\n0 0 1 0\n0.8 1 0 0\n/\n\n')
+        f.write('PVDO\n100 1.05 3.0\n400 1.00 3.2\n/\n\n')
+        f.write('PVDG\n100 0.010 0.015\n400 0.003 0.025\n/\n\n')
+        f.write('PVTW\n300 1.01 4.5e-5 0.3 0 /\n\n')
+        f.write('DENSITY\n850 1025 1 /\n\n')
+        # Gas-oil contact in the upper third, oil-water contact in the
+        # lower third of the reservoir.
+        top, height = 3657.6, nz * DZ
+        f.write('SOLUTION\n\nEQUIL\n%g 300 %g 0 %g 0 1* 1* 0 /\n\n'
+                % (top, top + 2.0 * height / 3.0, top + height / 3.0))
+        f.write('SCHEDULE\n\nEND\n')
+
+
+def programArgs(program, deck, outdir):
+    args = ['deck_filename=' + deck, 'output_dir=' + outdir]
+    if program in ('sim_2p_incomp', 'sim_2p_comp_reorder'):
+        # walltime.param is needed, the state output is not.
+        args += ['output=true', 'output_vtk=false', 'output_interval=1000000']
+    elif program == 'compute_tof':
+        args += ['output=false']
+    return args
+
+
+def readParamTimings(path):
+    """Phase times from a SimulatorReport::reportParam() file."""
+    phases = {}
+    if not os.path.exists(path):
+        return phases
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'/timing/(.*)/?total_time=(.*)', line.strip())
+            if m:
+                name = m.group(1).rstrip('/') or 'total'
+                phases[name] = float(m.group(2))
+    return phases
+
+
+def readTofTimings(text):
+    phases = {}
+    m = re.search(r'Pressure solver took:\s*([0-9.eE+-]+)', text)
+    if m:
+        phases['pressure'] = float(m.group(1))
+    tof = [float(t) for t in re.findall(r'solve took:\s*([0-9.eE+-]+)', text)]
+    if tof:
+        phases['tof'] = sum(tof)
+    return phases
+
+
+def run(program, binary, deck, outdir, threads):
+    """Run a program, returning wall time, phases and peak RSS in kB."""
+    if os.path.isdir(outdir):
+        shutil.rmtree(outdir)
+    os.makedirs(outdir)
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    log = open(os.path.join(outdir, 'log.txt'), 'w+')
+    start = time.time()
+    proc = subprocess.Popen([binary] + programArgs(program, deck, outdir),
+                            stdout=log, stderr=subprocess.STDOUT, env=env)
+    # wait4() gives the resource usage of this child alone.
+    status, rusage = os.wait4(proc.pid, 0)[1:]
+    wall = time.time() - start
+    proc.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+    log.seek(0)
+    text = log.read()
+    log.close()
+    if proc.returncode != 0:
+        raise RuntimeError('%s failed, see %s' % (program, os.path.join(outdir, 'log.txt')))
+    if program in ('sim_2p_incomp', 'sim_2p_comp_reorder'):
+        phases = readParamTimings(os.path.join(outdir, 'walltime.param'))
+    elif program == 'compute_tof':
+        phases = readTofTimings(text)
+    else:
+        phases = {}
+    # ru_maxrss is in kilobytes on Linux.
+    return {'wall_seconds': wall, 'phases': phases, 'peak_rss_kb': rusage.ru_maxrss}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='End-to-end benchmarks of the opm-core example programs.')
+    parser.add_argument('--bindir', required=True, help='directory of the example programs')
+    parser.add_argument('--sizes', default='30x55x17,60x110x34', help='comma separated NXxNYxNZ')
+    parser.add_argument('--threads', default='1,2,4', help='comma separated thread counts')
+    parser.add_argument('--programs', default=','.join(PROGRAMS))
+    parser.add_argument('--steps', type=int, default=10, help='report steps of the simulations')
+    parser.add_argument('--step-days', type=float, default=30.0)
+    parser.add_argument('--repeats', type=int, default=1, help='runs of each case, the fastest is kept')
+    parser.add_argument('--seed', type=int, default=1, help='seed of the permeability field')
+    parser.add_argument('--workdir', default='opm-core-e2e-bench')
+    parser.add_argument('--output', default='opm-core-e2e-bench.json', help='JSON report, "-" for stdout')
+    opts = parser.parse_args()
+
+    sizes = [tuple(int(n) for n in s.split('x')) for s in opts.sizes.split(',')]
+    threads = sorted(int(t) for t in opts.threads.split(','))
+    programs = opts.programs.split(',')
+    for p in programs:
+        if p not in PROGRAMS:
+            sys.exit('Unknown program: ' + p)
+
+    results = []
+    for (nx, ny, nz) in sizes:
+        name = '%dx%dx%d' % (nx, ny, nz)
+        casedir = os.path.abspath(os.path.join(opts.workdir, name))
+        if not os.path.isdir(casedir):
+            os.makedirs(casedir)
+        perm, poro = permeability(nx, ny, nz, opts.seed)
+        twophase = os.path.join(casedir, 'SPE10LIKE.DATA')
+        equil = os.path.join(casedir, 'SPE10LIKE_EQUIL.DATA')
+        writeTwophaseDeck(twophase, nx, ny, nz, perm, poro, opts.steps, opts.step_days)
+        writeEquilDeck(equil, nx, ny, nz, perm, poro)
+        for program in programs:
+            binary = os.path.join(opts.bindir, program)
+            deck = equil if program == 'compute_initial_state' else twophase
+            runs = []
+            for t in threads:
+                best = None
+                for r in range(max(1, opts.repeats)):
+                    outdir = os.path.join(casedir, '%s_t%d' % (program, t))
+                    res = run(program, binary, deck, outdir, t)
+                    if best is None or res['wall_seconds'] < best['wall_seconds']:
+                        best = res
+                best['threads'] = t
+                print('%-24s %-12s %3d threads %10.3f s %10d kB'
+                      % (program, name, t, best['wall_seconds'], best['peak_rss_kb']))
+                runs.append(best)
+            base = runs[0]
+            for r in runs:
+                r['efficiency'] = (base['wall_seconds'] * base['threads']
+                                   / (r['wall_seconds'] * r['threads']))
+            results.append({'program': program,
+                            'grid': {'nx': nx, 'ny': ny, 'nz': nz, 'cells': nx * ny * nz},
+                            'runs': runs})
+
+    report = {'seed': opts.seed, 'steps': opts.steps, 'step_days': opts.step_days,
+              'repeats': opts.repeats, 'benchmarks': results}
+    if opts.output == '-':
+        json.dump(report, sys.stdout, indent=2, sort_keys=True)
+        print()
+    else:
+        with open(opts.output, 'w') as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write('\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,390 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/// \file
+/// Throughput benchmarks of the output pipeline.
+///
+/// A synthetic black-oil state is written for a number of report
+/// steps through EclipseWriter (unified restart and summary files),
+/// writeVtkData() (ASCII VTU) and writeVtuData() (binary VTU),
+/// and read back through init_from_restart_file() and, step by step,
+/// RestartFileIndex.  For every stage the per-step latencies, bytes
+/// moved, throughput and C++ heap allocations per step are reported.
+/// The bytes of the writers are the growth of the files they write,
+/// those of the readers the on-disk size of the keywords restored.
+/// Allocations are counted by replacing the global operator new, so
+/// allocations made by ert through malloc() are not included.
+///
+/// Parameters (with defaults):
+///   nx, ny, nz   40, 40, 20   Grid dimensions.
+///   steps        10           Number of report steps written and read.
+///   output_dir   opm-core-io-bench
+///                             Directory the files are written to.
+///   output       opm-core-io-bench.json
+///                             File to write the JSON report to, relative
+///                             to output_dir.  The report goes to standard
+///                             output if empty.
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/io/eclipse/EclipseIOUtil.hpp>
+#include <opm/core/io/eclipse/EclipseReader.hpp>
+#include <opm/core/io/eclipse/EclipseWriter.hpp>
+#include <opm/core/io/eclipse/RestartFileIndex.hpp>
+#include <opm/core/io/vtk/writeVtkData.hpp>
+#include <opm/core/props/BlackoilPhases.hpp>
+#include <opm/core/props/phaseUsageFromDeck.hpp>
+#include <opm/core/simulator/BlackoilState.hpp>
+#include <opm/core/simulator/SimulatorTimer.hpp>
+#include <opm/core/simulator/WellState.hpp>
+#include <opm/core/utility/DataMap.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/wells/WellsManager.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseContext.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Schedule/Schedule.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    std::atomic<long> heap_allocations(0);
+}
+
+// Count the C++ heap allocations of the stages.
+void* operator new(std::size_t n)
+{
+    ++heap_allocations;
+    if (void* p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n)
+{
+    return operator new(n);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct StageResult
+    {
+        std::string         name;
+        std::vector<double> seconds;      // Per step.
+        double              bytes;        // Total over all steps.
+        long                allocations;  // Total over all steps.
+    };
+
+    /// Time one call of 'step' for each of 'steps' steps.  The step
+    /// function returns the number of bytes it moved.
+    template <class Step>
+    StageResult timeStage(const std::string& name, const int steps, Step step)
+    {
+        StageResult res;
+        res.name = name;
+        res.bytes = 0.0;
+        res.allocations = 0;
+        for (int s = 1; s <= steps; ++s) {
+            const long allocs = heap_allocations;
+            const Clock::time_point start = Clock::now();
+            res.bytes += step(s);
+            res.seconds.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+            res.allocations += heap_allocations - allocs;
+        }
+        return res;
+    }
+
+    /// Total size of the regular files in a directory.
+    double directorySize(const boost::filesystem::path& dir)
+    {
+        double size = 0.0;
+        for (boost::filesystem::directory_iterator it(dir), end; it != end; ++it) {
+            if (boost::filesystem::is_regular_file(it->status())) {
+                size += boost::filesystem::file_size(it->path());
+            }
+        }
+        return size;
+    }
+
+    /// A deck that writes a unified restart file at every report step,
+    /// and restarts from the last one.
+    std::string benchmarkDeck(const int nx, const int ny, const int nz, const int steps)
+    {
+        std::ostringstream deck;
+        deck << "RUNSPEC\nOIL\nGAS\nWATER\nDISGAS\nVAPOIL\nUNIFOUT\nUNIFIN\n"
+             << "DIMENS\n" << nx << ' ' << ny << ' ' << nz << " /\n"
+             << "GRID\n"
+             << "DXV\n" << nx << "*10.0 /\n"
+             << "DYV\n" << ny << "*10.0 /\n"
+             << "DZV\n" << nz << "*2.0 /\n"
+             << "TOPS\n" << nx*ny << "*2000.0 /\n"
+             << "SOLUTION\n"
+             << "RESTART\nIOBENCH " << steps << " /\n"
+             << "START\n1 JAN 2000 /\n"
+             << "SCHEDULE\n"
+             << "SKIPREST\n"
+             << "RPTRST\nBASIC=1\n/\n"
+             << "WELSPECS\n"
+             << "'PROD' 'G' 1 1 1* 'OIL' /\n"
+             << "'INJ' 'G' " << nx << ' ' << ny << " 1* 'WATER' /\n"
+             << "/\n"
+             << "COMPDAT\n"
+             << "'PROD' 1 1 1 " << nz << " 'OPEN' 2* 0.3 /\n"
+             << "'INJ' " << nx << ' ' << ny << " 1 " << nz << " 'OPEN' 2* 0.3 /\n"
+             << "/\n"
+             << "WCONPROD\n'PROD' 'OPEN' 'BHP' 5* 100 /\n/\n"
+             << "WCONINJE\n'INJ' 'WATER' 'OPEN' 'RATE' 1000 1* 400 /\n/\n"
+             << "TSTEP\n" << steps << "*10 /\n";
+        return deck.str();
+    }
+
+    /// Fill the state with smoothly varying, step-dependent values.
+    void syntheticState(const int step, const PhaseUsage& pu,
+                        BlackoilState& state, WellState& well_state)
+    {
+        const int nc = state.pressure().size();
+        const int np = pu.num_phases;
+        const int aqua = pu.phase_pos[BlackoilPhases::Aqua];
+        const int vapour = pu.phase_pos[BlackoilPhases::Vapour];
+        const int liquid = pu.phase_pos[BlackoilPhases::Liquid];
+        for (int c = 0; c < nc; ++c) {
+            const double x = double(c) / nc;
+            state.pressure()[c] = 2.0e7 + 1.0e5*step + 1.0e6*x;
+            state.temperature()[c] = 350.0;
+            double* s = &state.saturation()[np*c];
+            s[aqua] = 0.2 + 0.05*step*x;
+            s[vapour] = 0.1*(1.0 - x);
+            s[liquid] = 1.0 - s[aqua] - s[vapour];
+            state.gasoilratio()[c] = 100.0 + x;
+            state.rv()[c] = 1.0e-4*x;
+        }
+        std::fill(well_state.bhp().begin(), well_state.bhp().end(), 1.0e7 + step);
+        std::fill(well_state.perfPress().begin(), well_state.perfPress().end(), 1.5e7);
+        std::fill(well_state.perfRates().begin(), well_state.perfRates().end(), 1.0e-3*step);
+        std::fill(well_state.wellRates().begin(), well_state.wellRates().end(), 1.0e-2*step);
+    }
+
+    /// On-disk bytes of the cell keywords restored for a report step.
+    double restoredBytes(const RestartFileIndex& index, const int step)
+    {
+        const char* names[] = { "PRESSURE", "TEMP", "SWAT", "SGAS", "RS", "RV", "OPM_XWEL" };
+        double bytes = 0.0;
+        for (const char* name : names) {
+            if (const RestartFileIndex::Keyword* kw = index.find(name, step)) {
+                bytes += double(kw->count) * kw->elemSize;
+            }
+        }
+        return bytes;
+    }
+
+    void writeJson(std::ostream& os, const int nx, const int ny, const int nz,
+                   const int steps, const std::vector<StageResult>& results)
+    {
+        os.precision(9);
+        os << "{\n"
+           << "  \"grid\": { \"nx\": " << nx << ", \"ny\": " << ny << ", \"nz\": " << nz
+           << ", \"cells\": " << nx*ny*nz << " },\n"
+           << "  \"steps\": " << steps << ",\n"
+           << "  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const StageResult& r = results[i];
+            double total = 0.0;
+            double best = std::numeric_limits<double>::max();
+            double worst = 0.0;
+            for (double t : r.seconds) {
+                total += t;
+                best = std::min(best, t);
+                worst = std::max(worst, t);
+            }
+            const double n = r.seconds.size();
+            os << "    { \"name\": \"" << r.name << "\""
+               << ", \"bytes\": " << r.bytes
+               << ", \"total_seconds\": " << total
+               << ", \"mean_step_seconds\": " << total / n
+               << ", \"min_step_seconds\": " << best
+               << ", \"max_step_seconds\": " << worst
+               << ", \"mb_per_second\": " << (total > 0.0 ? r.bytes / total / 1.0e6 : 0.0)
+               << ", \"allocations_per_step\": " << r.allocations / n
+               << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+        os << "  ]\n}\n";
+    }
+} // anon namespace
+
+
+
+// ----------------- Main program -----------------
+int
+main(int argc, char** argv)
+try
+{
+    using namespace Opm;
+
+    parameter::ParameterGroup param(argc, argv, false, false);
+    const int nx    = param.getDefault("nx", 40);
+    const int ny    = param.getDefault("ny", 40);
+    const int nz    = param.getDefault("nz", 20);
+    const int steps = std::max(1, param.getDefault("steps", 10));
+    const std::string output_dir = param.getDefault<std::string>("output_dir", "opm-core-io-bench");
+    const std::string output = param.getDefault<std::string>("output", "opm-core-io-bench.json");
+
+    // The restart file is looked up relative to the working directory.
+    boost::filesystem::create_directories(output_dir);
+    boost::filesystem::current_path(output_dir);
+    const boost::filesystem::path here(".");
+
+    Parser parser;
+    ParseContext parseContext;
+    DeckConstPtr deck = parser.parseString(benchmarkDeck(nx, ny, nz, steps), parseContext);
+    EclipseStatePtr eclipseState(new EclipseState(deck, parseContext));
+    const PhaseUsage pu = phaseUsageFromDeck(deck);
+
+    GridManager gm(eclipseState->getEclipseGrid());
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const int nc = UgGridHelpers::numCells(grid);
+    WellsManager wells_manager(eclipseState, 0, grid, 0);
+
+    BlackoilState state(nc, UgGridHelpers::numFaces(grid), pu.num_phases);
+    WellState well_state;
+    well_state.init(wells_manager.c_wells(), state);
+
+    std::vector<StageResult> results;
+
+    // Eclipse restart and summary output.
+    {
+        parameter::ParameterGroup writer_param;
+        writer_param.insertParameter("deck_filename", "IOBENCH.DATA");
+        writer_param.insertParameter("output_dir", ".");
+        EclipseWriter writer(writer_param, eclipseState, pu, nc, UgGridHelpers::globalCell(grid));
+        SimulatorTimer timer;
+        timer.init(eclipseState->getSchedule()->getTimeMap());
+        writer.writeInit(timer);
+        results.push_back(timeStage("EclipseWriter::writeTimeStep", steps, [&](const int s) {
+                    syntheticState(s, pu, state, well_state);
+                    timer.setCurrentStepNum(s);
+                    const double before = directorySize(here);
+                    writer.writeTimeStep(timer, state, well_state, false);
+                    return directorySize(here) - before;
+                }));
+    }
+
+    // VTK output of the cell fields.
+    DataMap dm;
+    dm["pressure"] = &state.pressure();
+    dm["saturation"] = &state.saturation();
+    dm["gasoilratio"] = &state.gasoilratio();
+    results.push_back(timeStage("writeVtkData", steps, [&](const int s) {
+                syntheticState(s, pu, state, well_state);
+                const std::string name = "step-" + std::to_string(s) + ".vtu";
+                {
+                    std::ofstream os(name.c_str());
+                    writeVtkData(grid, dm, os);
+                }
+                return double(boost::filesystem::file_size(name));
+            }));
+    results.push_back(timeStage("writeVtuData", steps, [&](const int s) {
+                syntheticState(s, pu, state, well_state);
+                const std::string name = "step-" + std::to_string(s) + "-binary.vtu";
+                {
+                    std::ofstream os(name.c_str(), std::ios::out | std::ios::binary);
+                    writeVtuData(grid, dm, os);
+                }
+                return double(boost::filesystem::file_size(name));
+            }));
+
+    // Restart reading, through the deck's RESTART step and step by step.
+    const std::string restart_file = "IOBENCH.UNRST";
+    double restart_bytes = 0.0;
+    {
+        const RestartFileIndex index(restart_file);
+        restart_bytes = restoredBytes(index, steps);
+    }
+    results.push_back(timeStage("init_from_restart_file", steps, [&](const int) {
+                BlackoilState restored(nc, UgGridHelpers::numFaces(grid), pu.num_phases);
+                WellState restored_wells;
+                restored_wells.init(wells_manager.c_wells(), restored);
+                init_from_restart_file(eclipseState, nc, pu, restored, restored_wells);
+                return restart_bytes;
+            }));
+    std::vector<double> values;
+    results.push_back(timeStage("RestartFileIndex::read", steps, [&](const int s) {
+                const RestartFileIndex index(restart_file);
+                if (!index.hasReportStep(s)) {
+                    OPM_THROW(std::runtime_error, "No report step " << s << " in " << restart_file);
+                }
+                for (const char* name : { "PRESSURE", "TEMP", "SWAT", "SGAS", "RS", "RV", "OPM_XWEL" }) {
+                    if (const RestartFileIndex::Keyword* kw = index.find(name, s)) {
+                        values.resize(kw->count);
+                        index.read(*kw, 0, kw->count, values.data());
+                    }
+                }
+                return restoredBytes(index, s);
+            }));
+
+    if (output.empty()) {
+        writeJson(std::cout, nx, ny, nz, steps, results);
+    } else {
+        std::ofstream os(output.c_str());
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Failed to open " << output);
+        }
+        writeJson(os, nx, ny, nz, steps, results);
+    }
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
@@ -0,0 +1,153 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/// Benchmark of the LinearSolverFactory backends on a system written by
+/// csrmatrix_write_bin(), e.g. through linsolver_dump_prefix.
+///
+/// Parameters:
+///   matrix_filename  Binary matrix file (required).
+///   rhs_filename     Binary right hand side file. If not given, the
+///                    right hand side is A times a vector of ones.
+///   linsolvers       Comma separated list of backends ("umfpack,istl").
+///   repeats          Number of solves per backend (1).
+/// All other parameters, such as linsolver_type, are passed on to the
+/// solvers.
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <opm/core/linalg/LinearSolverFactory.hpp>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/StopWatch.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    double relativeResidual(const CSRMatrix& A, const std::vector<double>& b,
+                            const std::vector<double>& x)
+    {
+        std::vector<double> r(A.m);
+        csrmatrix_matvec(&A, &x[0], &r[0]);
+        double rnorm = 0.0;
+        double bnorm = 0.0;
+        for (std::size_t i = 0; i < A.m; ++i) {
+            rnorm += (b[i] - r[i]) * (b[i] - r[i]);
+            bnorm += b[i] * b[i];
+        }
+        return bnorm > 0.0 ? std::sqrt(rnorm / bnorm) : std::sqrt(rnorm);
+    }
+} // anon namespace
+
+
+
+// ----------------- Main program -----------------
+int
+main(int argc, char** argv)
+try
+{
+    using namespace Opm;
+
+    parameter::ParameterGroup param(argc, argv);
+
+    const std::string matrix_filename = param.get<std::string>("matrix_filename");
+    std::shared_ptr<CSRMatrix> A(csrmatrix_read_bin(matrix_filename.c_str()), csrmatrix_delete);
+    if (!A) {
+        OPM_THROW(std::runtime_error, "Could not read matrix from " << matrix_filename);
+    }
+    const int size = A->m;
+
+    std::vector<double> b(size);
+    if (param.has("rhs_filename")) {
+        const std::string rhs_filename = param.get<std::string>("rhs_filename");
+        std::size_t n = 0;
+        double* v = vector_read_bin(rhs_filename.c_str(), &n);
+        if (v == 0 || int(n) != size) {
+            std::free(v);
+            OPM_THROW(std::runtime_error, "Could not read right hand side of size "
+                      << size << " from " << rhs_filename);
+        }
+        b.assign(v, v + n);
+        std::free(v);
+    } else {
+        const std::vector<double> ones(size, 1.0);
+        csrmatrix_matvec(A.get(), &ones[0], &b[0]);
+    }
+
+    const std::string linsolvers = param.getDefault<std::string>("linsolvers", "umfpack,istl");
+    const int repeats = param.getDefault("repeats", 1);
+
+    std::cout << "System with " << size << " rows and " << A->nnz << " non-zeros.\n";
+    std::cout << std::setw(10) << "solver" << std::setw(14) << "setup [s]"
+              << std::setw(14) << "solve [s]" << std::setw(8) << "its"
+              << std::setw(11) << "converged" << std::setw(14) << "residual" << '\n';
+
+    std::istringstream solver_list(linsolvers);
+    std::string ls;
+    while (std::getline(solver_list, ls, ',')) {
+        parameter::ParameterGroup solver_param = param;
+        solver_param.insertParameter("linsolver", ls);
+
+        time::StopWatch clock;
+        clock.start();
+        std::unique_ptr<LinearSolverFactory> solver;
+        try {
+            solver.reset(new LinearSolverFactory(solver_param));
+        }
+        catch (const std::exception& e) {
+            std::cout << std::setw(10) << ls << "  skipped: " << e.what() << '\n';
+            continue;
+        }
+        clock.stop();
+        const double setup_time = clock.secsSinceStart();
+
+        std::vector<double> x(size, 0.0);
+        double solve_time = 0.0;
+        LinearSolverInterface::LinearSolverReport rep = LinearSolverInterface::LinearSolverReport();
+        for (int k = 0; k < repeats; ++k) {
+            std::fill(x.begin(), x.end(), 0.0);
+            clock.start();
+            rep = solver->solve(size, A->nnz, A->ia, A->ja, A->sa, &b[0], &x[0]);
+            clock.stop();
+            solve_time += clock.secsSinceStart();
+        }
+
+        std::cout << std::setw(10) << ls << std::setw(14) << setup_time
+                  << std::setw(14) << solve_time / repeats << std::setw(8) << rep.iterations
+                  << std::setw(11) << (rep.converged ? "yes" : "no")
+                  << std::setw(14) << relativeResidual(*A, b, x) << '\n';
+    }
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
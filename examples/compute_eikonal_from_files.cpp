@@ -88,6 +88,10 @@ try
         startcells.assign(beg, end);
     }
 
+    // Parameters for the 3d solver.
+    const double tolerance = param.getDefault("tolerance", 1e-10);
+    const int num_threads = param.getDefault("num_threads", 0);
+
     // Write parameters used for later reference.
     bool output = param.getDefault("output", true);
     std::string output_dir;
@@ -111,8 +115,14 @@ try
     Opm::time::StopWatch timer;
     timer.start();
     std::vector<double> solution;
-    AnisotropicEikonal2d ae(grid);
-    ae.solve(metric.data(), startcells, solution);
+    if (grid.dimensions == 2) {
+        AnisotropicEikonal2d ae(grid);
+        ae.solve(metric.data(), startcells, solution);
+    } else {
+        AnisotropicEikonal3d ae(grid, tolerance, num_threads);
+        ae.solve(metric.data(), startcells, solution);
+        std::cout << "Fast iterative method used " << ae.iterations() << " iterations." << std::endl;
+    }
     timer.stop();
     double tt = timer.secsSinceStart();
     std::cout << "Eikonal solver took: " << tt << " seconds." << std::endl;
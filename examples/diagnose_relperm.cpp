@@ -48,7 +48,7 @@
 
 void usage() {
     std::cout << std::endl << 
-        "Usage: diagnose_relperm <eclipseFile>" << std::endl;
+        "Usage: diagnose_relperm <eclipseFile> [--errors-only]" << std::endl;
 }
 
 
@@ -63,6 +63,7 @@ try
         exit(1);
     } 
     const char* eclipseFilename = argv[1];
+    const bool errorsOnly = (argc > 2) && (std::string(argv[2]) == "--errors-only");
     EclipseStateConstPtr eclState; 
     ParserPtr parser(new Opm::Parser);
     Opm::ParseContext parseContext({{ ParseContext::PARSE_RANDOM_SLASH , InputError::IGNORE }, 
@@ -90,7 +91,7 @@ try
     std::string logFile = baseName + ".SATFUNCLOG";
     Opm::time::StopWatch timer;
     timer.start();
-    RelpermDiagnostics diagnostic(logFile);
+    RelpermDiagnostics diagnostic(logFile, errorsOnly);
     diagnostic.diagnosis(eclState, deck, grid);
     timer.stop();
     double tt = timer.secsSinceStart();
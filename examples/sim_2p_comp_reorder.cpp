@@ -32,8 +32,11 @@
 #include <opm/core/simulator/initState.hpp>
 #include <opm/core/simulator/SimulatorReport.hpp>
 #include <opm/core/simulator/SimulatorTimer.hpp>
+#include <opm/core/utility/KernelTimer.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/ThreadControl.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 
 #include <opm/core/props/BlackoilPropertiesBasic.hpp>
 #include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
@@ -41,6 +44,7 @@
 
 #include <opm/core/linalg/LinearSolverFactory.hpp>
 
+#include <opm/core/simulator/BlackoilStartup.hpp>
 #include <opm/core/simulator/BlackoilState.hpp>
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/core/simulator/SimulatorCompressibleTwophase.hpp>
@@ -54,6 +58,7 @@
 #include <boost/filesystem.hpp>
 
 #include <algorithm>
+#include <utility>
 #include <iostream>
 #include <vector>
 #include <numeric>
@@ -83,14 +88,19 @@ try
     std::cout << "\n================    Test program for weakly compressible two-phase flow     ===============\n\n";
     parameter::ParameterGroup param(argc, argv, false);
     std::cout << "---------------    Reading parameters     ---------------" << std::endl;
+    threads::setNumThreads(param);
 
     // If we have a "deck_filename", grid and props will be read from that.
     bool use_deck = param.has("deck_filename");
     EclipseStateConstPtr eclipseState;
-    std::unique_ptr<GridManager> grid;
-    std::unique_ptr<BlackoilPropertiesInterface> props;
-    std::unique_ptr<RockCompressibility> rock_comp;
-    std::unique_ptr<BlackoilState> state;
+    std::shared_ptr<GridManager> grid;
+    std::shared_ptr<BlackoilPropertiesInterface> props;
+    std::shared_ptr<RockCompressibility> rock_comp;
+    std::shared_ptr<BlackoilState> state;
+    // Wells of the first report step, only with a deck.
+    std::shared_ptr<WellsManager> first_wells;
+    // Well indices of completions seen in earlier report steps.
+    WellIndexCache well_index_cache;
 
 
     ParserPtr parser(new Opm::Parser());
@@ -105,27 +115,17 @@ try
         deck = parser->parseFile(deck_filename , parseContext);
         eclipseState.reset(new EclipseState(deck, parseContext));
 
-        // Grid init
-        grid.reset(new GridManager(deck));
-        {
-            const UnstructuredGrid& ug_grid = *(grid->c_grid());
-            state.reset( new BlackoilState( UgGridHelpers::numCells( ug_grid ) , UgGridHelpers::numFaces( ug_grid ) ,2));
-            // Rock and fluid init
-            props.reset(new BlackoilPropertiesFromDeck(deck, eclipseState, ug_grid, param));
-            // check_well_controls = param.getDefault("check_well_controls", false);
-            // max_well_control_iterations = param.getDefault("max_well_control_iterations", 10);
-            // Rock compressibility.
-            rock_comp.reset(new RockCompressibility(deck, eclipseState));
-            // Gravity.
-            gravity[2] = deck->hasKeyword("NOGRAV") ? 0.0 : unit::gravity;
-            // Init state variables (saturation and pressure).
-            if (param.has("init_saturation")) {
-                initStateBasic(ug_grid, *props, param, gravity[2], *state);
-            } else {
-                initStateFromDeck(ug_grid, *props, deck, gravity[2], *state);
-            }
-            initBlackoilSurfvol(ug_grid, *props, *state);
-        }
+        // Grid, rock and fluid properties, rock compressibility, wells
+        // and initial state, built concurrently where independent.
+        BlackoilStartup startup(deck, eclipseState, param, &well_index_cache);
+        grid = startup.grid();
+        props = startup.props();
+        rock_comp = startup.rockCompressibility();
+        first_wells = startup.wells();
+        state = startup.state();
+        gravity[2] = startup.gravity();
+        // check_well_controls = param.getDefault("check_well_controls", false);
+        // max_well_control_iterations = param.getDefault("max_well_control_iterations", 10);
     } else {
         // Grid init.
         const int nx = param.getDefault("nx", 100);
@@ -189,6 +189,14 @@ try
     // Linear solver.
     LinearSolverFactory linsolver(param);
 
+    // Hardware counters and peak memory in the timings of each scope.
+    Opm::time::TimingTree::setHardwareCounters(param.getDefault("timing_hardware_counters", false));
+    // Sampled kernel timings, written at exit (to stderr if the
+    // filename is empty).
+    if (param.has("kernel_timing_file")) {
+        Opm::time::KernelTimer::reportAtExit(param.get<std::string>("kernel_timing_file"));
+    }
+
     // Write parameters used for later reference.
     bool output = param.getDefault("output", true);
     std::ofstream epoch_os;
@@ -253,12 +261,16 @@ try
                       << simtimer.numSteps() - step << ")\n\n" << std::flush;
 
             // Create new wells, well_state
-            WellsManager wells(eclipseState , reportStepIdx , *grid->c_grid(), props->permeability());
+            std::shared_ptr<WellsManager> wells = std::move(first_wells);
+            if (reportStepIdx > 0) {
+                wells.reset(new WellsManager(eclipseState , reportStepIdx , *grid->c_grid(),
+                                             props->permeability(), &well_index_cache));
+            }
             // @@@ HACK: we should really make a new well state and
             // properly transfer old well state to it every report step,
             // since number of wells may change etc.
             if (reportStepIdx == 0) {
-                well_state.init(wells.c_wells(), *state);
+                well_state.init(wells->c_wells(), *state);
             }
 
             // Create and run simulator.
@@ -266,7 +278,7 @@ try
                                                     *grid->c_grid(),
                                                     *props,
                                                     rock_comp->isActive() ? rock_comp.get() : 0,
-                                                    wells,
+                                                    *wells,
                                                     src,
                                                     bcs.c_bcs(),
                                                     linsolver,
@@ -286,6 +298,7 @@ try
 
     std::cout << "\n\n================    End of simulation     ===============\n\n";
     rep.report(std::cout);
+    rep.reportTimings(std::cout);
 
     if (output) {
         std::string filename = output_dir + "/walltime.param";
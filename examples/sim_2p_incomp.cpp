@@ -32,8 +32,12 @@
 #include <opm/core/simulator/initState.hpp>
 #include <opm/core/simulator/SimulatorReport.hpp>
 #include <opm/core/simulator/SimulatorTimer.hpp>
+#include <opm/core/utility/KernelTimer.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/ThreadControl.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 
 #include <opm/core/props/IncompPropertiesBasic.hpp>
 #include <opm/core/props/IncompPropertiesFromDeck.hpp>
@@ -83,6 +87,7 @@ try
     std::cout << "\n================    Test program for incompressible two-phase flow     ===============\n\n";
     parameter::ParameterGroup param(argc, argv, false);
     std::cout << "---------------    Reading parameters     ---------------" << std::endl;
+    threads::setNumThreads(param);
 
 #if ! HAVE_SUITESPARSE_UMFPACK_H
     // This is an extra check to intercept a potentially invalid request for the
@@ -203,6 +208,14 @@ try
     // Linear solver.
     LinearSolverFactory linsolver(param);
 
+    // Hardware counters and peak memory in the timings of each scope.
+    Opm::time::TimingTree::setHardwareCounters(param.getDefault("timing_hardware_counters", false));
+    // Sampled kernel timings, written at exit (to stderr if the
+    // filename is empty).
+    if (param.has("kernel_timing_file")) {
+        Opm::time::KernelTimer::reportAtExit(param.get<std::string>("kernel_timing_file"));
+    }
+
     // Write parameters used for later reference.
     bool output = param.getDefault("output", true);
     std::ofstream epoch_os;
@@ -227,6 +240,8 @@ try
     }
 
     SimulatorReport rep;
+    MemoryReport memory;
+    grid->reportMemory(memory);
     if (!use_deck) {
         std::cout << "\n\n================    Starting main simulation loop     ===============\n"
                   << "                        (number of report steps: 1)\n\n" << std::flush;
@@ -247,6 +262,7 @@ try
         WellState well_state;
         well_state.init(0, *state);
         rep = simulator.run(simtimer, *state, well_state);
+        simulator.reportMemory(memory);
     } else {
         // With a deck, we may have more epochs etc.
         Opm::TimeMapConstPtr timeMap = eclipseState->getSchedule()->getTimeMap();
@@ -295,6 +311,7 @@ try
                 warnIfUnusedParams(param);
             }
             SimulatorReport epoch_rep = simulator.run(simtimer, *state, well_state);
+            simulator.reportMemory(memory);
             if (output) {
                 epoch_rep.reportParam(epoch_os);
             }
@@ -306,6 +323,8 @@ try
 
     std::cout << "\n\n================    End of simulation     ===============\n\n";
     rep.report(std::cout);
+    rep.reportTimings(std::cout);
+    rep.reportMemory(std::cout, memory);
 
     if (output) {
       std::string filename = output_dir + "/walltime.param";
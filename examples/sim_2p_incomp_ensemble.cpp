@@ -0,0 +1,407 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+
+#include <opm/core/pressure/FlowBCManager.hpp>
+
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/wells.h>
+#include <opm/core/wells/WellsManager.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/simulator/initState.hpp>
+#include <opm/core/simulator/SimulatorReport.hpp>
+#include <opm/core/simulator/SimulatorTimer.hpp>
+#include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/StopWatch.hpp>
+#include <opm/core/utility/ThreadControl.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <opm/core/props/IncompPropertiesBasic.hpp>
+#include <opm/core/props/IncompPropertiesFromDeck.hpp>
+#include <opm/core/props/IncompPropertiesShadow.hpp>
+#include <opm/core/props/rock/RockCompressibility.hpp>
+
+#include <opm/core/linalg/LinearSolverFactory.hpp>
+
+#include <opm/core/simulator/PhasePipeline.hpp>
+#include <opm/core/simulator/TwophaseState.hpp>
+#include <opm/core/simulator/WellState.hpp>
+#include <opm/core/simulator/SimulatorIncompTwophase.hpp>
+
+#include <opm/parser/eclipse/Parser/ParseContext.hpp>
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+#include <memory>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    // One realization of the ensemble. Everything a member modifies
+    // while running is owned by it; the grid, fluid properties,
+    // sources and boundary conditions are shared read-only.
+    struct Member
+    {
+        std::vector<double> porosity;
+        std::vector<double> permeability;
+        std::unique_ptr<Opm::IncompPropertiesShadow> props;
+        std::unique_ptr<Opm::WellsManager> wells;
+        std::unique_ptr<Opm::LinearSolverFactory> linsolver;
+        std::unique_ptr<Opm::SimulatorIncompTwophase> simulator;
+        std::unique_ptr<Opm::TwophaseState> state;
+        Opm::WellState well_state;
+        Opm::SimulatorTimer timer;
+        Opm::SimulatorReport report;
+        std::string error;
+    };
+
+
+
+    // Read n values from a file.
+    std::vector<double> readValues(const std::string& filename)
+    {
+        std::ifstream is(filename.c_str());
+        if (!is) {
+            OPM_THROW(std::runtime_error, "Could not open " << filename);
+        }
+        std::vector<double> values;
+        double v;
+        while (is >> v) {
+            values.push_back(v);
+        }
+        return values;
+    }
+
+
+
+    // Porosity and permeability of a member. With a realization_prefix,
+    // they are read from <prefix><member>.poro (one value per cell) and
+    // <prefix><member>.perm (one isotropic value, or a full dim x dim
+    // tensor, per cell, in SI units). Otherwise the permeability of the
+    // base model is scaled by factors spread log-uniformly over
+    // [10^-perm_log_spread, 10^perm_log_spread] across the ensemble.
+    void setupRealization(const Opm::parameter::ParameterGroup& param,
+                          const Opm::IncompPropertiesInterface& base,
+                          const int member,
+                          const int ensemble_size,
+                          Member& m)
+    {
+        const int nc = base.numCells();
+        const int dim = base.numDimensions();
+        m.porosity.assign(base.porosity(), base.porosity() + nc);
+        m.permeability.assign(base.permeability(), base.permeability() + nc*dim*dim);
+        if (param.has("realization_prefix")) {
+            std::ostringstream prefix;
+            prefix << param.get<std::string>("realization_prefix") << member;
+            const std::vector<double> poro = readValues(prefix.str() + ".poro");
+            const std::vector<double> perm = readValues(prefix.str() + ".perm");
+            if (int(poro.size()) != nc) {
+                OPM_THROW(std::runtime_error, prefix.str() << ".poro has " << poro.size()
+                          << " values, expected " << nc);
+            }
+            m.porosity = poro;
+            if (int(perm.size()) == nc) {
+                std::fill(m.permeability.begin(), m.permeability.end(), 0.0);
+                for (int c = 0; c < nc; ++c) {
+                    for (int d = 0; d < dim; ++d) {
+                        m.permeability[dim*dim*c + (dim + 1)*d] = perm[c];
+                    }
+                }
+            } else if (int(perm.size()) == nc*dim*dim) {
+                m.permeability = perm;
+            } else {
+                OPM_THROW(std::runtime_error, prefix.str() << ".perm has " << perm.size()
+                          << " values, expected " << nc << " or " << nc*dim*dim);
+            }
+        } else {
+            const double spread = param.getDefault("perm_log_spread", 0.5);
+            const double t = (ensemble_size > 1) ? 2.0*member/(ensemble_size - 1) - 1.0 : 0.0;
+            const double factor = std::pow(10.0, spread*t);
+            for (double& k : m.permeability) {
+                k *= factor;
+            }
+        }
+        m.props.reset(new Opm::IncompPropertiesShadow(base));
+        m.props->usePorosity(m.porosity.data()).usePermeability(m.permeability.data());
+    }
+
+
+
+    void warnIfUnusedParams(const Opm::parameter::ParameterGroup& param)
+    {
+        if (param.anyUnused()) {
+            std::cout << "--------------------   Unused parameters:   --------------------\n";
+            param.displayUsage();
+            std::cout << "----------------------------------------------------------------" << std::endl;
+        }
+    }
+} // anon namespace
+
+
+
+// ----------------- Main program -----------------
+int
+main(int argc, char** argv)
+try
+{
+    using namespace Opm;
+
+    std::cout << "\n================    Ensemble of incompressible two-phase flow simulations     ===============\n\n";
+    parameter::ParameterGroup param(argc, argv, false);
+    std::cout << "---------------    Reading parameters     ---------------" << std::endl;
+
+#if ! HAVE_SUITESPARSE_UMFPACK_H
+    {
+        const bool use_reorder = param.getDefault("use_reorder", true);
+        if (!use_reorder) {
+            OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
+                  "Either reconfigure opm-core with SuiteSparse/UMFPACK support and recompile, "
+                  "or use the reordering solver (use_reorder=true).");
+        }
+    }
+#endif
+
+    const int ensemble_size = param.getDefault("ensemble_size", 4);
+    const int num_cores = std::max(int(std::thread::hardware_concurrency()), 1);
+    // With pipeline=true, the pressure and transport solves of the
+    // members are stages of a shared pipeline with a few slots of each
+    // kind, so that one member's transport overlaps another's pressure
+    // solve. There are then twice as many ensemble threads as slots by
+    // default, so that a member is ready whenever a slot is freed.
+    const bool use_pipeline = param.getDefault("pipeline", false);
+    std::unique_ptr<PhasePipeline> pipeline;
+    int num_threads = 0;
+    int member_threads = 0;
+    if (use_pipeline) {
+        const int pressure_slots = param.getDefault("pipeline_pressure_slots", 1);
+        const int transport_slots = param.getDefault("pipeline_transport_slots", 1);
+        const int stage_threads = std::max(num_cores / (pressure_slots + transport_slots), 1);
+        pipeline.reset(new PhasePipeline(pressure_slots, transport_slots,
+                                         param.getDefault("pipeline_pressure_threads", stage_threads),
+                                         param.getDefault("pipeline_transport_threads", stage_threads)));
+        num_threads = param.getDefault("ensemble_threads", 2*(pressure_slots + transport_slots));
+        member_threads = param.getDefault("member_threads", stage_threads);
+    } else {
+        num_threads = param.getDefault("ensemble_threads", num_cores);
+        // Threads of the parallel kernels within each member, by default
+        // sharing the cores evenly between the ensemble threads.
+        member_threads = param.getDefault("member_threads",
+                                          std::max(num_cores / std::max(num_threads, 1), 1));
+    }
+
+    // Static data shared by all members: grid, fluid and base rock
+    // properties, initial state, sources and boundary conditions.
+    bool use_deck = param.has("deck_filename");
+    EclipseStateConstPtr eclipseState;
+    Opm::DeckConstPtr deck;
+    std::unique_ptr<GridManager> grid;
+    std::unique_ptr<IncompPropertiesInterface> props;
+    std::unique_ptr<RockCompressibility> rock_comp;
+    std::unique_ptr<TwophaseState> state;
+    double gravity[3] = { 0.0 };
+    if (use_deck) {
+        ParserPtr parser(new Opm::Parser());
+        ParseContext parseContext;
+        std::string deck_filename = param.get<std::string>("deck_filename");
+        deck = parser->parseFile(deck_filename , parseContext);
+        eclipseState.reset( new EclipseState(deck, parseContext));
+        grid.reset(new GridManager(deck));
+        const UnstructuredGrid& ug_grid = *(grid->c_grid());
+        props.reset(new IncompPropertiesFromDeck(deck, eclipseState, ug_grid));
+        state.reset( new TwophaseState(  UgGridHelpers::numCells( ug_grid ) , UgGridHelpers::numFaces( ug_grid )));
+        rock_comp.reset(new RockCompressibility(deck, eclipseState));
+        gravity[2] = deck->hasKeyword("NOGRAV") ? 0.0 : unit::gravity;
+        if (param.has("init_saturation")) {
+            initStateBasic(ug_grid, *props, param, gravity[2], *state);
+        } else {
+            initStateFromDeck(ug_grid, *props, deck, gravity[2], *state);
+        }
+    } else {
+        const int nx = param.getDefault("nx", 100);
+        const int ny = param.getDefault("ny", 100);
+        const int nz = param.getDefault("nz", 1);
+        const double dx = param.getDefault("dx", 1.0);
+        const double dy = param.getDefault("dy", 1.0);
+        const double dz = param.getDefault("dz", 1.0);
+        grid.reset(new GridManager(nx, ny, nz, dx, dy, dz));
+        const UnstructuredGrid& ug_grid = *(grid->c_grid());
+        props.reset(new IncompPropertiesBasic(param, ug_grid.dimensions, UgGridHelpers::numCells( ug_grid )));
+        state.reset( new TwophaseState(  UgGridHelpers::numCells( ug_grid ) , UgGridHelpers::numFaces( ug_grid )));
+        rock_comp.reset(new RockCompressibility(param));
+        gravity[2] = param.getDefault("gravity", 0.0);
+        initStateBasic(ug_grid, *props, param, gravity[2], *state);
+    }
+    const bool use_gravity = (gravity[0] != 0.0 || gravity[1] != 0.0 || gravity[2] != 0.0);
+    const double *grav = use_gravity ? &gravity[0] : 0;
+
+    // Sources, as in sim_2p_incomp, given as pore volumes of the base model.
+    const int num_cells = grid->c_grid()->number_of_cells;
+    std::vector<double> src(num_cells, 0.0);
+    if (!use_deck) {
+        std::vector<double> porevol;
+        computePorevolume(*grid->c_grid(), props->porosity(), porevol);
+        const double tot_porevol_init = std::accumulate(porevol.begin(), porevol.end(), 0.0);
+        const double default_injection = use_gravity ? 0.0 : 0.1;
+        const double flow_per_sec = param.getDefault<double>("injected_porevolumes_per_day", default_injection)
+            *tot_porevol_init/unit::day;
+        src[0] = flow_per_sec;
+        src[num_cells - 1] = -flow_per_sec;
+    }
+
+    FlowBCManager bcs;
+    if (param.getDefault("use_pside", false)) {
+        int pside = param.get<int>("pside");
+        double pside_pressure = param.get<double>("pside_pressure");
+        bcs.pressureSide(*grid->c_grid(), FlowBCManager::Side(pside), pside_pressure);
+    }
+
+    const bool output = param.getDefault("output", true);
+    const std::string output_dir = param.getDefault("output_dir", std::string("output"));
+
+    // Set up the members one by one, since the parameter object and
+    // the deck are not thread safe. Only the simulation runs concurrently.
+    std::cout << "---------------    Setting up " << ensemble_size << " members     ---------------" << std::endl;
+    std::vector<Member> members(ensemble_size);
+    for (int k = 0; k < ensemble_size; ++k) {
+        Member& m = members[k];
+        setupRealization(param, *props, k, ensemble_size, m);
+        if (output) {
+            std::ostringstream member_dir;
+            member_dir << output_dir << "/member_" << k;
+            boost::filesystem::path fpath(member_dir.str());
+            try {
+                create_directories(fpath);
+            }
+            catch (...) {
+                OPM_THROW(std::runtime_error, "Creating directories failed: " << fpath);
+            }
+            param.insertParameter("output_dir", member_dir.str());
+        }
+        // Well indices depend on the permeability of the member.
+        if (use_deck) {
+            m.wells.reset(new WellsManager(eclipseState, 0, *grid->c_grid(), m.props->permeability()));
+        } else {
+            m.wells.reset(new WellsManager());
+        }
+        m.linsolver.reset(new LinearSolverFactory(param));
+        m.simulator.reset(new SimulatorIncompTwophase(param,
+                                                      *grid->c_grid(),
+                                                      *m.props,
+                                                      rock_comp->isActive() ? rock_comp.get() : 0,
+                                                      *m.wells,
+                                                      src,
+                                                      bcs.c_bcs(),
+                                                      *m.linsolver,
+                                                      grav));
+        m.simulator->setPhasePipeline(pipeline.get());
+        m.state.reset(new TwophaseState(*state));
+        m.well_state.init(m.wells->c_wells(), *m.state);
+        if (use_deck) {
+            m.timer.init(eclipseState->getSchedule()->getTimeMap());
+        } else {
+            m.timer.init(param);
+        }
+    }
+    warnIfUnusedParams(param);
+
+    // Members take different times to run, so each thread takes the
+    // next member not yet started until all are done.
+    std::cout << "\n\n================    Running ensemble on " << num_threads
+              << " threads (" << member_threads << " per member)     ===============\n\n" << std::flush;
+    time::StopWatch wall_timer;
+    wall_timer.start();
+    std::atomic<int> next_member(0);
+    auto worker = [&]() {
+        threads::ScopedNumThreads member_thread_limit(member_threads);
+        for (int k = next_member++; k < ensemble_size; k = next_member++) {
+            Member& m = members[k];
+            try {
+                m.report = m.simulator->run(m.timer, *m.state, m.well_state);
+            }
+            catch (const std::exception& e) {
+                m.error = e.what();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < std::min(num_threads, ensemble_size); ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    wall_timer.stop();
+    const double wall_time = wall_timer.secsSinceStart();
+
+    std::cout << "\n\n================    End of ensemble     ===============\n\n";
+    SimulatorReport rep;
+    int failed = 0;
+    for (int k = 0; k < ensemble_size; ++k) {
+        const Member& m = members[k];
+        std::cout << "Member " << std::setw(4) << k;
+        if (m.error.empty()) {
+            std::cout << "  total time " << m.report.total_time
+                      << "  pressure " << m.report.pressure_time
+                      << "  transport " << m.report.transport_time << '\n';
+            rep += m.report;
+        } else {
+            std::cout << "  failed: " << m.error << '\n';
+            ++failed;
+        }
+    }
+    std::cout << "\nWall time: " << wall_time << " seconds for " << ensemble_size - failed
+              << " members, " << (ensemble_size - failed)*3600.0/wall_time << " members per hour.\n";
+    if (pipeline) {
+        std::cout << "Pipeline: pressure and transport overlapped for " << pipeline->overlapTime()
+                  << " seconds, members waited " << pipeline->waitTime(PhasePipeline::Pressure)
+                  << " seconds for pressure and " << pipeline->waitTime(PhasePipeline::Transport)
+                  << " seconds for transport.\n";
+    }
+    std::cout << "Summed over members:\n";
+    rep.report(std::cout);
+
+    if (output) {
+        std::string filename = output_dir + "/walltime.param";
+        std::fstream tot_os(filename.c_str(),std::fstream::trunc | std::fstream::out);
+        rep.reportParam(tot_os);
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+catch (const std::exception &e) {
+    std::cerr << "Program threw an exception: " << e.what() << "\n";
+    throw;
+}
@@ -22,7 +22,13 @@
 #include <opm/core/grid.h>
 #include <opm/core/utility/RootFinders.hpp>
 
-#if BOOST_HEAP_AVAILABLE
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 namespace Opm
 {
@@ -51,6 +57,51 @@ namespace Opm
                                           + g[3] * d[1] * d[1]);
             return dist;
         }
+
+        /// Anisotropic distance in 3d with respect to a metric g.
+        /// If d = v2 - v1, the distance is sqrt(d^T g d).
+        double distanceAniso3d(const double v1[3],
+                               const double v2[3],
+                               const double g[9])
+        {
+            const double d[3] = { v2[0] - v1[0], v2[1] - v1[1], v2[2] - v1[2] };
+            double q = 0.0;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    q += g[3*i + j] * d[i] * d[j];
+                }
+            }
+            return std::sqrt(q);
+        }
+
+        /// As DistanceDerivative, but in 3d.
+        struct DistanceDerivative3d
+        {
+            const double* x1;
+            const double* x2;
+            const double* x;
+            double u1;
+            double u2;
+            const double* g;
+            double operator()(const double theta) const
+            {
+                double xt[3];
+                double a[3];
+                double b[3];
+                for (int i = 0; i < 3; ++i) {
+                    xt[i] = (1-theta)*x1[i] + theta*x2[i];
+                    a[i] = x[i] - xt[i];
+                    b[i] = x1[i] - x2[i];
+                }
+                double dQdtheta = 0.0;
+                for (int i = 0; i < 3; ++i) {
+                    for (int j = 0; j < 3; ++j) {
+                        dQdtheta += 2*a[i]*b[j]*g[3*i + j];
+                    }
+                }
+                return u2 - u1 + dQdtheta/(2*distanceAniso3d(x, xt, g));
+            }
+        };
     } // anonymous namespace
 
 
@@ -61,13 +112,25 @@ namespace Opm
     /// Construct solver.
     /// \param[in] grid      A 2d grid.
     AnisotropicEikonal2d::AnisotropicEikonal2d(const UnstructuredGrid& grid)
+        : AnisotropicEikonal2d(grid, nullptr)
+    {
+    }
+
+    /// Construct solver, reusing precomputed connectivity.
+    /// \param[in] grid          A 2d grid.
+    /// \param[in] connectivity  Connectivity of grid, as from
+    ///                          computeGridConnectivity(). If null,
+    ///                          the neighbours are computed.
+    AnisotropicEikonal2d::AnisotropicEikonal2d(const UnstructuredGrid& grid,
+                                               std::shared_ptr<const GridConnectivity> connectivity)
         : grid_(grid),
           safety_factor_(1.2)
     {
         if (grid.dimensions != 2) {
             OPM_THROW(std::logic_error, "Grid for AnisotropicEikonal2d must be 2d.");
         }
-        cell_neighbours_ = cellNeighboursAcrossVertices(grid);
+        cell_neighbours_ = connectivity ? connectivity->cell_vertex_neighbours
+                                        : cellNeighboursAcrossVertices(grid);
         orderCounterClockwise(grid, cell_neighbours_);
         computeGridRadius();
     }
@@ -106,21 +169,21 @@ namespace Opm
         const double inf = 1e100;
         solution.clear();
         solution.resize(num_cells, inf);
-        is_accepted_.clear();
-        is_accepted_.resize(num_cells, false);
-        accepted_front_.clear();
+        is_accepted_.assign(num_cells, false);
+        is_front_.assign(num_cells, false);
         considered_.clear();
-        considered_handles_.clear();
-        is_considered_.clear();
-        is_considered_.resize(num_cells, false);
+        considered_pos_.assign(num_cells, NotConsidered);
 
         // 2. Move the startcells to Accepted. U_i = q(x_i)
         const int num_startcells = startcells.size();
         for (int ii = 0; ii < num_startcells; ++ii) {
             is_accepted_[startcells[ii]] = true;
+            is_front_[startcells[ii]] = true;
             solution[startcells[ii]] = 0.0;
         }
-        accepted_front_.insert(startcells.begin(), startcells.end());
+        for (int ii = 0; ii < num_startcells; ++ii) {
+            updateFront(startcells[ii]);
+        }
 
         // 3. Move cells adjacent to startcells to Considered, evaluate
         //    U_i = min_{(x_j,x_k) \in NF(x_i)} G_{j,k}
@@ -129,7 +192,7 @@ namespace Opm
             const int num_nb = cell_neighbours_[scell].size();
             for (int nb = 0; nb < num_nb; ++nb) {
                 const int nb_cell = cell_neighbours_[scell][nb];
-                if (!is_accepted_[nb_cell] && !is_considered_[nb_cell]) {
+                if (!is_accepted_[nb_cell] && considered_pos_[nb_cell] == NotConsidered) {
                     const double value = computeValue(nb_cell, metric, solution.data());
                     pushConsidered(std::make_pair(value, nb_cell));
                 }
@@ -146,37 +209,26 @@ namespace Opm
             is_accepted_[rcell] = true;
             solution[rcell] = r.first;
             popConsidered();
-            accepted_front_.insert(rcell);
-            for (auto it = accepted_front_.begin(); it != accepted_front_.end();) {
-                // Note that loop increment happens in the body of this loop.
-                const int cell = *it;
-                bool on_front = false;
-                for (auto it2 = cell_neighbours_[cell].begin(); it2 != cell_neighbours_[cell].end(); ++it2) {
-                    if (!is_accepted_[*it2]) {
-                        on_front = true;
-                        break;
-                    }
-                }
-                if (!on_front) {
-                    accepted_front_.erase(it++);
-                } else {
-                    ++it;
-                }
+            // Only r and its neighbours may leave the front.
+            is_front_[rcell] = true;
+            updateFront(rcell);
+            for (auto it = cell_neighbours_[rcell].begin(); it != cell_neighbours_[rcell].end(); ++it) {
+                updateFront(*it);
             }
 
             // 6. Recompute the value for all Considered cells within
             //    distance h * F_2/F1 from x_r. Use min of previous and new.
-            for (auto it = considered_.begin(); it != considered_.end(); ++it) {
-                const int ccell = it->second;
+            //    Decreasing a value only moves the cell towards the heap
+            //    root, i.e. among the positions already visited, so every
+            //    considered cell is visited exactly once.
+            const int num_considered = considered_.size();
+            for (int pos = 0; pos < num_considered; ++pos) {
+                const ValueAndCell& vc = considered_[pos];
+                const int ccell = vc.second;
                 if (isClose(rcell, ccell)) {
                     const double value = computeValueUpdate(ccell, metric, solution.data(), rcell);
-                    if (value < it->first) {
-                        // Update value for considered cell.
-                        // Note that as solution values decrease, their
-                        // goodness w.r.t. the heap comparator increase,
-                        // therefore we may safely call the increase()
-                        // modificator below.
-                        considered_.increase(considered_handles_[ccell], std::make_pair(value, ccell));
+                    if (value < vc.first) {
+                        decreaseConsidered(pos, value);
                     }
                 }
             }
@@ -184,7 +236,7 @@ namespace Opm
             // 7. Move cells adjacent to r from Far to Considered.
             for (auto it = cell_neighbours_[rcell].begin(); it != cell_neighbours_[rcell].end(); ++it) {
                 const int nb_cell = *it;
-                if (!is_accepted_[nb_cell] && !is_considered_[nb_cell]) {
+                if (!is_accepted_[nb_cell] && considered_pos_[nb_cell] == NotConsidered) {
                     assert(solution[nb_cell] == inf);
                     const double value = computeValue(nb_cell, metric, solution.data());
                     pushConsidered(std::make_pair(value, nb_cell));
@@ -223,7 +275,7 @@ namespace Opm
         double val = inf;
         for (int ii = 0; ii < num_nbs; ++ii) {
             const int n[2] = { nbs[ii], nbs[(ii+1) % num_nbs] };
-            if (accepted_front_.count(n[0]) && accepted_front_.count(n[1])) {
+            if (is_front_[n[0]] && is_front_[n[1]]) {
                 const double cand_val = computeFromTri(cell, n[0], n[1], metric, solution);
                 val = std::min(val, cand_val);
             }
@@ -232,7 +284,7 @@ namespace Opm
             // Failed to find two accepted front nodes adjacent to this,
             // so we go for a single-neighbour update.
             for (int ii = 0; ii < num_nbs; ++ii) {
-                if (accepted_front_.count(nbs[ii])) {
+                if (is_front_[nbs[ii]]) {
                     const double cand_val = computeFromLine(cell, nbs[ii], metric, solution);
                     val = std::min(val, cand_val);
                 }
@@ -260,7 +312,7 @@ namespace Opm
         for (int ii = 0; ii < num_nbs; ++ii) {
             const int n[2] = { nbs[ii], nbs[(ii+1) % num_nbs] };
             if ((n[0] == new_cell || n[1] == new_cell)
-                && accepted_front_.count(n[0]) && accepted_front_.count(n[1])) {
+                && is_front_[n[0]] && is_front_[n[1]]) {
                 const double cand_val = computeFromTri(cell, n[0], n[1], metric, solution);
                 val = std::min(val, cand_val);
             }
@@ -269,7 +321,7 @@ namespace Opm
             // Failed to find two accepted front nodes adjacent to this,
             // so we go for a single-neighbour update.
             for (int ii = 0; ii < num_nbs; ++ii) {
-                if (nbs[ii] == new_cell && accepted_front_.count(nbs[ii])) {
+                if (nbs[ii] == new_cell && is_front_[nbs[ii]]) {
                     const double cand_val = computeFromLine(cell, nbs[ii], metric, solution);
                     val = std::min(val, cand_val);
                 }
@@ -359,7 +411,7 @@ namespace Opm
 
     const AnisotropicEikonal2d::ValueAndCell& AnisotropicEikonal2d::topConsidered() const
     {
-        return considered_.top();
+        return considered_.front();
     }
 
 
@@ -368,9 +420,9 @@ namespace Opm
 
     void AnisotropicEikonal2d::pushConsidered(const ValueAndCell& vc)
     {
-        HeapHandle h = considered_.push(vc);
-        considered_handles_[vc.second] = h;
-        is_considered_[vc.second] = true;
+        considered_.push_back(vc);
+        considered_pos_[vc.second] = considered_.size() - 1;
+        siftUpConsidered(considered_.size() - 1);
     }
 
 
@@ -379,9 +431,97 @@ namespace Opm
 
     void AnisotropicEikonal2d::popConsidered()
     {
-        is_considered_[considered_.top().second] = false;
-        considered_handles_.erase(considered_.top().second);
-        considered_.pop();
+        considered_pos_[considered_.front().second] = NotConsidered;
+        if (considered_.size() > 1) {
+            considered_.front() = considered_.back();
+            considered_pos_[considered_.front().second] = 0;
+            considered_.pop_back();
+            siftDownConsidered(0);
+        } else {
+            considered_.pop_back();
+        }
+    }
+
+
+
+
+
+    void AnisotropicEikonal2d::decreaseConsidered(const int pos, const double value)
+    {
+        assert(value < considered_[pos].first);
+        considered_[pos].first = value;
+        siftUpConsidered(pos);
+    }
+
+
+
+
+
+    // Move the heap entry at pos towards the root until its parent
+    // is smaller. Entries are ordered by value, then by cell index.
+    void AnisotropicEikonal2d::siftUpConsidered(int pos)
+    {
+        const ValueAndCell vc = considered_[pos];
+        while (pos > 0) {
+            const int parent = (pos - 1)/2;
+            if (!(vc < considered_[parent])) {
+                break;
+            }
+            considered_[pos] = considered_[parent];
+            considered_pos_[considered_[pos].second] = pos;
+            pos = parent;
+        }
+        considered_[pos] = vc;
+        considered_pos_[vc.second] = pos;
+    }
+
+
+
+
+
+    // Move the heap entry at pos away from the root until both its
+    // children are larger.
+    void AnisotropicEikonal2d::siftDownConsidered(int pos)
+    {
+        const int size = considered_.size();
+        const ValueAndCell vc = considered_[pos];
+        for (;;) {
+            int child = 2*pos + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size && considered_[child + 1] < considered_[child]) {
+                ++child;
+            }
+            if (!(considered_[child] < vc)) {
+                break;
+            }
+            considered_[pos] = considered_[child];
+            considered_pos_[considered_[pos].second] = pos;
+            pos = child;
+        }
+        considered_[pos] = vc;
+        considered_pos_[vc.second] = pos;
+    }
+
+
+
+
+
+    // Remove an accepted cell from the accepted front if all its
+    // neighbours are accepted.
+    void AnisotropicEikonal2d::updateFront(const int cell)
+    {
+        if (!is_front_[cell]) {
+            return;
+        }
+        const auto& nbs = cell_neighbours_[cell];
+        for (auto it = nbs.begin(); it != nbs.end(); ++it) {
+            if (!is_accepted_[*it]) {
+                return;
+            }
+        }
+        is_front_[cell] = false;
     }
 
 
@@ -426,36 +566,251 @@ namespace Opm
 
 
 
-} // namespace Opm
+    // ----------------  Methods for class AnisotropicEikonal3d ----------------
 
 
-#else // BOOST_HEAP_AVAILABLE is false
+    /// Construct solver.
+    AnisotropicEikonal3d::AnisotropicEikonal3d(const UnstructuredGrid& grid,
+                                               const double tolerance,
+                                               const int num_threads)
+        : AnisotropicEikonal3d(grid, nullptr, tolerance, num_threads)
+    {
+    }
 
-namespace {
-    const char* AnisotropicEikonal2derrmsg =
-        "\n********************************************************************************\n"
-        "This library has not been compiled with support for the AnisotropicEikonal2d\n"
-        "class, due to too old version of the boost libraries (Boost.Heap from boost\n"
-        "version 1.49 or newer is required.\n"
-        "To use this class you must recompile opm-core on a system with sufficiently new\n"
-        "version of the boost libraries."
-        "\n********************************************************************************\n";
-}
+    /// Construct solver, reusing precomputed connectivity.
+    AnisotropicEikonal3d::AnisotropicEikonal3d(const UnstructuredGrid& grid,
+                                               std::shared_ptr<const GridConnectivity> connectivity,
+                                               const double tolerance,
+                                               const int num_threads)
+        : grid_(grid),
+          tolerance_(tolerance),
+          num_threads_(num_threads),
+          iterations_(0)
+    {
+        if (grid.dimensions != 3) {
+            OPM_THROW(std::logic_error, "Grid for AnisotropicEikonal3d must be 3d.");
+        }
+        cell_neighbours_ = connectivity ? connectivity->cell_vertex_neighbours
+                                        : cellNeighboursAcrossVertices(grid);
+
+        // Find the pairs of neighbours that are neighbours of each other.
+        // The neighbour rows are sorted, so membership is a binary
+        // search, and the rows are counted and filled in parallel.
+        const SparseTable<int>& cn = cell_neighbours_;
+        auto visit_pairs = [&cn](const int cell, int* out) {
+            const auto& nbs = cn[cell];
+            int count = 0;
+            for (auto it = nbs.begin(); it != nbs.end(); ++it) {
+                const auto& nbs2 = cn[*it];
+                for (auto it2 = nbs2.begin(); it2 != nbs2.end(); ++it2) {
+                    if (*it2 > *it && std::binary_search(nbs.begin(), nbs.end(), *it2)) {
+                        if (out) {
+                            out[count] = *it;
+                            out[count + 1] = *it2;
+                        }
+                        count += 2;
+                    }
+                }
+            }
+            return count;
+        };
+        neighbour_pairs_.build(grid.number_of_cells,
+                               [&visit_pairs](const int cell) { return visit_pairs(cell, 0); },
+                               [&visit_pairs](const int cell, int* out) { visit_pairs(cell, out); });
+    }
+
+    /// Solve the eikonal equation.
+    /// \param[in]  metric            Array of metric tensors, M, for each cell.
+    /// \param[in]  startcells        Array of cells where u = 0 at the centroid.
+    /// \param[out] solution          Array of solution to the eikonal equation.
+    void AnisotropicEikonal3d::solve(const double* metric,
+                                     const std::vector<int>& startcells,
+                                     std::vector<double>& solution)
+    {
+        // Algorithm summary:
+        // 1. U_i = 0 for the startcells, U_i = \inf elsewhere.
+        // 2. Put the neighbours of the startcells in the active list L.
+        // 3. Compute new values for all cells in L, from the values of
+        //    the previous iteration.
+        // 4. Remove the cells whose values did not change from L.
+        //    Compute new values for their neighbours not in L, and add
+        //    those whose values decrease to L.
+        // 5. If L is not empty, go to step 3.
+        // The values are nonincreasing, so the startcells are never
+        // added to L.
+#if defined(_OPENMP)
+        const int num_threads = num_threads_ > 0 ? num_threads_ : omp_get_max_threads();
+#endif
+        const int num_cells = grid_.number_of_cells;
+        const double inf = 1e100;
+
+        // 1. U_i = 0 for the startcells, U_i = \inf elsewhere.
+        solution.assign(num_cells, inf);
+        const int num_startcells = startcells.size();
+        for (int ii = 0; ii < num_startcells; ++ii) {
+            solution[startcells[ii]] = 0.0;
+        }
+
+        // 2. Put the neighbours of the startcells in the active list L.
+        active_.clear();
+        is_active_.assign(num_cells, false);
+        for (int ii = 0; ii < num_startcells; ++ii) {
+            const auto& nbs = cell_neighbours_[startcells[ii]];
+            for (auto it = nbs.begin(); it != nbs.end(); ++it) {
+                if (!is_active_[*it] && solution[*it] == inf) {
+                    is_active_[*it] = true;
+                    active_.push_back(*it);
+                }
+            }
+        }
+
+        iterations_ = 0;
+        std::vector<double> value;
+        std::vector<int> candidates;
+        while (!active_.empty()) {
+            ++iterations_;
+
+            // 3. Compute new values for all cells in L.
+            const int num_active = active_.size();
+            value.resize(num_active);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+#endif
+            for (int ii = 0; ii < num_active; ++ii) {
+                value[ii] = computeValue(active_[ii], metric, solution.data());
+            }
+
+            // 4. Remove the cells whose values did not change from L,
+            //    collecting their neighbours not in L.
+            candidates.clear();
+            int num_kept = 0;
+            for (int ii = 0; ii < num_active; ++ii) {
+                const int cell = active_[ii];
+                const double old_value = solution[cell];
+                solution[cell] = std::min(old_value, value[ii]);
+                if (old_value - solution[cell] <= tolerance_ * solution[cell]) {
+                    is_active_[cell] = false;
+                    const auto& nbs = cell_neighbours_[cell];
+                    candidates.insert(candidates.end(), nbs.begin(), nbs.end());
+                } else {
+                    active_[num_kept++] = cell;
+                }
+            }
+            active_.resize(num_kept);
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            int num_candidates = 0;
+            for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+                if (!is_active_[*it]) {
+                    candidates[num_candidates++] = *it;
+                }
+            }
+            candidates.resize(num_candidates);
+
+            //    Compute new values for the candidates, and add those
+            //    whose values decrease to L.
+            value.resize(num_candidates);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+#endif
+            for (int ii = 0; ii < num_candidates; ++ii) {
+                value[ii] = computeValue(candidates[ii], metric, solution.data());
+            }
+            for (int ii = 0; ii < num_candidates; ++ii) {
+                const int cell = candidates[ii];
+                if (solution[cell] - value[ii] > tolerance_ * value[ii]) {
+                    solution[cell] = value[ii];
+                    is_active_[cell] = true;
+                    active_.push_back(cell);
+                }
+            }
+
+            // 5. If L is not empty, go to step 3.
+        }
+    }
+
+
+
+
+
+    int AnisotropicEikonal3d::iterations() const
+    {
+        return iterations_;
+    }
 
-namespace Opm
-{
 
-    AnisotropicEikonal2d::AnisotropicEikonal2d(const UnstructuredGrid&)
+
+
+
+    double AnisotropicEikonal3d::computeValue(const int cell,
+                                              const double* metric,
+                                              const double* solution) const
     {
-        OPM_THROW(std::logic_error, AnisotropicEikonal2derrmsg);
+        const double inf = 1e100;
+        double val = inf;
+        const auto& nbs = cell_neighbours_[cell];
+        for (auto it = nbs.begin(); it != nbs.end(); ++it) {
+            if (solution[*it] < inf) {
+                val = std::min(val, computeFromLine(cell, *it, metric, solution));
+            }
+        }
+        const auto& pairs = neighbour_pairs_[cell];
+        const int num_pairs = pairs.size() / 2;
+        for (int ii = 0; ii < num_pairs; ++ii) {
+            const int n0 = pairs[2*ii];
+            const int n1 = pairs[2*ii + 1];
+            if (solution[n0] < inf && solution[n1] < inf) {
+                val = std::min(val, computeFromSegment(cell, n0, n1, metric, solution));
+            }
+        }
+        return val;
     }
 
-    void AnisotropicEikonal2d::solve(const double*,
-                                     const std::vector<int>&,
-                                     std::vector<double>&)
+
+
+
+
+    double AnisotropicEikonal3d::computeFromLine(const int cell,
+                                                 const int from,
+                                                 const double* metric,
+                                                 const double* solution) const
     {
-        OPM_THROW(std::logic_error, AnisotropicEikonal2derrmsg);
+        // Using the metric of 'cell', not 'from'.
+        const double dist = distanceAniso3d(grid_.cell_centroids + 3 * cell,
+                                            grid_.cell_centroids + 3 * from,
+                                            metric + 9 * cell);
+        return solution[from] + dist;
     }
-}
 
-#endif // BOOST_HEAP_AVAILABLE
+
+
+
+
+    double AnisotropicEikonal3d::computeFromSegment(const int cell,
+                                                    const int n0,
+                                                    const int n1,
+                                                    const double* metric,
+                                                    const double* solution) const
+    {
+        DistanceDerivative3d dd;
+        dd.x1 = grid_.cell_centroids + 3 * n0;
+        dd.x2 = grid_.cell_centroids + 3 * n1;
+        dd.x = grid_.cell_centroids + 3 * cell;
+        dd.u1 = solution[n0];
+        dd.u2 = solution[n1];
+        dd.g = metric + 9 * cell;
+        int iter = 0;
+        const double theta = RegulaFalsi<ContinueOnError>::solve(dd, 0.0, 1.0, 15, 1e-8, iter);
+        double xt[3];
+        for (int i = 0; i < 3; ++i) {
+            xt[i] = (1-theta)*dd.x1[i] + theta*dd.x2[i];
+        }
+        const double d1 = distanceAniso3d(dd.x1, dd.x, dd.g) + solution[n0];
+        const double d2 = distanceAniso3d(dd.x2, dd.x, dd.g) + solution[n1];
+        const double dt = distanceAniso3d(xt, dd.x, dd.g) + (1-theta)*solution[n0] + theta*solution[n1];
+        return std::min(d1, std::min(d2, dt));
+    }
+
+
+
+} // namespace Opm
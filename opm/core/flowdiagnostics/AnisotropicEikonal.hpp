@@ -21,27 +21,16 @@
 #define OPM_ANISOTROPICEIKONAL_HEADER_INCLUDED
 
 #include <opm/core/utility/SparseTable.hpp>
+#include <memory>
 #include <vector>
-#include <set>
-#include <map>
-
-#include <opm/common/utility/platform_dependent/disable_warnings.h>
-
-#include <boost/version.hpp>
-
-#define BOOST_HEAP_AVAILABLE ((BOOST_VERSION / 100 % 1000) >= 49)
-
-#if BOOST_HEAP_AVAILABLE
-#include <boost/heap/fibonacci_heap.hpp>
-#endif
-
-#include <opm/common/utility/platform_dependent/reenable_warnings.h>
-
+#include <utility>
 
 struct UnstructuredGrid;
 
 namespace Opm
 {
+    struct GridConnectivity;
+
     /// A solver for the anisotropic eikonal equation:
     ///    \f[ || \nabla u^T M^{-1}(x) \nabla u || = 1 \qquad x \in \Omega \f]
     /// where M(x) is a symmetric positive definite matrix.
@@ -54,6 +43,14 @@ namespace Opm
         /// \param[in] grid      A 2d grid.
         explicit AnisotropicEikonal2d(const UnstructuredGrid& grid);
 
+        /// Construct solver, reusing precomputed connectivity.
+        /// \param[in] grid          A 2d grid.
+        /// \param[in] connectivity  Connectivity of grid, as from
+        ///                          computeGridConnectivity(). If null,
+        ///                          the neighbours are computed.
+        AnisotropicEikonal2d(const UnstructuredGrid& grid,
+                             std::shared_ptr<const GridConnectivity> connectivity);
+
         /// Solve the eikonal equation.
         /// \param[in]  metric            Array of metric tensors, M, for each cell.
         /// \param[in]  startcells        Array of cells where u = 0 at the centroid.
@@ -62,28 +59,26 @@ namespace Opm
                    const std::vector<int>& startcells,
                    std::vector<double>& solution);
     private:
-#if BOOST_HEAP_AVAILABLE
         // Grid and topology.
         const UnstructuredGrid& grid_;
         SparseTable<int> cell_neighbours_;
 
         // Keep track of accepted cells.
         std::vector<char> is_accepted_;
-        std::set<int> accepted_front_;
+        std::vector<char> is_front_;
 
         // Quantities relating to anisotropy.
         std::vector<double> grid_radius_;
         std::vector<double> aniso_ratio_;
         const double safety_factor_;
 
-        // Keep track of considered cells.
+        // Keep track of considered cells, using a binary min-heap
+        // stored in considered_. The position of each cell in the
+        // heap is in considered_pos_ (NotConsidered if absent).
         typedef std::pair<double, int> ValueAndCell;
-        typedef boost::heap::compare<std::greater<ValueAndCell>> Comparator;
-        typedef boost::heap::fibonacci_heap<ValueAndCell, Comparator> Heap;
-        Heap considered_;
-        typedef Heap::handle_type HeapHandle;
-        std::map<int, HeapHandle> considered_handles_;
-        std::vector<char> is_considered_;
+        std::vector<ValueAndCell> considered_;
+        enum { NotConsidered = -1 };
+        std::vector<int> considered_pos_;
 
         bool isClose(const int c1, const int c2) const;
         double computeValue(const int cell, const double* metric, const double* solution) const;
@@ -94,10 +89,86 @@ namespace Opm
         const ValueAndCell& topConsidered() const;
         void pushConsidered(const ValueAndCell& vc);
         void popConsidered();
+        void decreaseConsidered(const int pos, const double value);
+        void siftUpConsidered(int pos);
+        void siftDownConsidered(int pos);
+        void updateFront(const int cell);
 
         void computeGridRadius();
         void computeAnisoRatio(const double* metric);
-#endif // BOOST_HEAP_AVAILABLE
+    };
+
+
+
+    /// A solver for the anisotropic eikonal equation in 3d:
+    ///    \f[ || \nabla u^T M^{-1}(x) \nabla u || = 1 \qquad x \in \Omega \f]
+    /// where M(x) is a symmetric positive definite matrix.
+    /// Unlike AnisotropicEikonal2d, which uses an (inherently serial)
+    /// ordered upwind method, this class uses the fast iterative method
+    /// of W.-K. Jeong and R.T. Whitaker, "A Fast Iterative Method for
+    /// Eikonal Equations". All cells of the active list are updated
+    /// concurrently (using OpenMP if available) in each iteration, so
+    /// the result does not depend on the number of threads.
+    /// Cell values are computed from the values of neighbours across
+    /// vertices, either from a single neighbour or from the segment
+    /// between two neighbours that are themselves neighbours.
+    class AnisotropicEikonal3d
+    {
+    public:
+        /// Construct solver.
+        /// \param[in] grid         A 3d grid.
+        /// \param[in] tolerance    A cell leaves the active list when the
+        ///                         relative change of its value in an
+        ///                         iteration is below this tolerance.
+        /// \param[in] num_threads  Number of threads used. If zero, the
+        ///                         OpenMP default is used.
+        explicit AnisotropicEikonal3d(const UnstructuredGrid& grid,
+                                      const double tolerance = 1e-10,
+                                      const int num_threads = 0);
+
+        /// Construct solver, reusing precomputed connectivity.
+        /// \param[in] grid          A 3d grid.
+        /// \param[in] connectivity  Connectivity of grid, as from
+        ///                          computeGridConnectivity(). If null,
+        ///                          the neighbours are computed.
+        /// \param[in] tolerance     As for the other constructor.
+        /// \param[in] num_threads   As for the other constructor.
+        AnisotropicEikonal3d(const UnstructuredGrid& grid,
+                             std::shared_ptr<const GridConnectivity> connectivity,
+                             const double tolerance = 1e-10,
+                             const int num_threads = 0);
+
+        /// Solve the eikonal equation.
+        /// \param[in]  metric            Array of metric tensors, M, for each cell.
+        /// \param[in]  startcells        Array of cells where u = 0 at the centroid.
+        /// \param[out] solution          Array of solution to the eikonal equation.
+        void solve(const double* metric,
+                   const std::vector<int>& startcells,
+                   std::vector<double>& solution);
+
+        /// Number of iterations used by the last call to solve().
+        int iterations() const;
+
+    private:
+        // Grid and topology.
+        const UnstructuredGrid& grid_;
+        SparseTable<int> cell_neighbours_;
+        // For each cell, pairs of neighbours that are neighbours of
+        // each other, stored consecutively.
+        SparseTable<int> neighbour_pairs_;
+
+        const double tolerance_;
+        const int num_threads_;
+        int iterations_;
+
+        // The active list, and a flag for each cell telling if it
+        // is in that list.
+        std::vector<int> active_;
+        std::vector<char> is_active_;
+
+        double computeValue(const int cell, const double* metric, const double* solution) const;
+        double computeFromLine(const int cell, const int from, const double* metric, const double* solution) const;
+        double computeFromSegment(const int cell, const int n0, const int n1, const double* metric, const double* solution) const;
     };
 
 } // namespace Opm
@@ -26,6 +26,56 @@
 namespace Opm
 {
 
+    namespace
+    {
+
+        // Multilinear (degree 1) basis functions and their gradients
+        // for a fixed number of dimensions, so that all loops may be
+        // unrolled. See DGBasisMultilin::eval() and evalGrad() for
+        // the ordering of the basis functions.
+        template <int dim>
+        void evalMultilin1(const double* cc, const double* x, double* f_x)
+        {
+            const int num_basis = 1 << dim;
+            double f[dim][2];
+            for (int dd = 0; dd < dim; ++dd) {
+                f[dd][0] = 0.5 - x[dd] + cc[dd];
+                f[dd][1] = 0.5 + x[dd] - cc[dd];
+            }
+            for (int ix = 0; ix < num_basis; ++ix) {
+                double val = 1.0;
+                for (int dd = 0; dd < dim; ++dd) {
+                    val *= f[dd][(ix >> (dim - dd - 1)) & 1];
+                }
+                f_x[ix] = val;
+            }
+        }
+
+        template <int dim>
+        void evalGradMultilin1(const double* cc, const double* x, double* grad_f_x)
+        {
+            const int num_basis = 1 << dim;
+            const double fder[2] = { -1.0,  1.0 };
+            double f[dim][2];
+            for (int dd = 0; dd < dim; ++dd) {
+                f[dd][0] = 0.5 - x[dd] + cc[dd];
+                f[dd][1] = 0.5 + x[dd] - cc[dd];
+            }
+            for (int ix = 0; ix < num_basis; ++ix) {
+                for (int dder = 0; dder < dim; ++dder) {
+                    double val = 1.0;
+                    for (int dd = 0; dd < dim; ++dd) {
+                        const int ind = (ix >> (dim - dd - 1)) & 1;
+                        val *= (dder == dd ? fder[ind] : f[dd][ind]);
+                    }
+                    grad_f_x[ix*dim + dder] = val;
+                }
+            }
+        }
+
+    } // anonymous namespace
+
+
     // ----------------  Methods for class DGBasisInterface ----------------
 
 
@@ -248,6 +298,10 @@ namespace Opm
             f_x[0] = 1;
             break;
         case 1:
+            if (dim == 3) {
+                evalMultilin1<3>(cc, x, f_x);
+                break;
+            }
             std::fill(f_x, f_x + num_basis, 1.0);
             for (int dd = 0; dd < dim; ++dd) {
                 const double f[2] = { 0.5 - x[dd] + cc[dd],  0.5 + x[dd] - cc[dd] };
@@ -280,6 +334,10 @@ namespace Opm
                 std::fill(grad_f_x, grad_f_x + num_basis*dim, 0.0);
                 break;
             case 1:
+                if (dim == 3) {
+                    evalGradMultilin1<3>(cc, x, grad_f_x);
+                    break;
+                }
                 std::fill(grad_f_x, grad_f_x + num_basis*dim, 1.0);
                 for (int dd = 0; dd < dim; ++dd) {
                     const double f[2] = { 0.5 - x[dd] + cc[dd],  0.5 + x[dd] - cc[dd] };
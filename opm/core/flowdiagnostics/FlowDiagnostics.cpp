@@ -22,11 +22,61 @@
 
 #include <opm/common/ErrorMacros.hpp>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <numeric>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 namespace Opm
 {
 
+    namespace
+    {
+
+        // Below this size, sorting is done by a single thread.
+        const int ParallelSortMinSize = 100000;
+
+        // Sort a vector, using OpenMP threads if available. Each thread
+        // sorts a contiguous chunk, and the chunks are then merged
+        // pairwise. The result is the same as from std::sort() for any
+        // strict total order.
+        template <class T>
+        void parallelSort(std::vector<T>& v)
+        {
+#if defined(_OPENMP)
+            const int n = v.size();
+            const int num_chunks = omp_get_max_threads();
+            if (num_chunks < 2 || n < ParallelSortMinSize) {
+                std::sort(v.begin(), v.end());
+                return;
+            }
+            std::vector<int> bounds(num_chunks + 1);
+            for (int chunk = 0; chunk <= num_chunks; ++chunk) {
+                bounds[chunk] = static_cast<long long>(n) * chunk / num_chunks;
+            }
+#pragma omp parallel for schedule(static)
+            for (int chunk = 0; chunk < num_chunks; ++chunk) {
+                std::sort(v.begin() + bounds[chunk], v.begin() + bounds[chunk + 1]);
+            }
+            for (int width = 1; width < num_chunks; width *= 2) {
+#pragma omp parallel for schedule(dynamic)
+                for (int chunk = 0; chunk < num_chunks - width; chunk += 2*width) {
+                    const int last = std::min(chunk + 2*width, num_chunks);
+                    std::inplace_merge(v.begin() + bounds[chunk],
+                                       v.begin() + bounds[chunk + width],
+                                       v.begin() + bounds[last]);
+                }
+            }
+#else
+            std::sort(v.begin(), v.end());
+#endif
+        }
+
+    } // anonymous namespace
+
 
     /// \brief Compute flow-capacity/storage-capacity based on time-of-flight.
     ///
@@ -40,6 +90,8 @@ namespace Opm
     /// \param[in]  rtof  reverse (time to producer) time-of-flight values for each cell
     /// \return           a pair of vectors, the first containing F (flow capacity) the second
     ///                   containing Phi (storage capacity).
+    ///
+    /// The sort by total travel time uses OpenMP threads if available.
     std::pair<std::vector<double>, std::vector<double>> computeFandPhi(const std::vector<double>& pv,
                                                                        const std::vector<double>& ftof,
                                                                        const std::vector<double>& rtof)
@@ -52,11 +104,14 @@ namespace Opm
         const int n = pv.size();
         typedef std::pair<double, double> D2;
         std::vector<D2> time_and_pv(n);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
         for (int ii = 0; ii < n; ++ii) {
             time_and_pv[ii].first = ftof[ii] + rtof[ii]; // Total travel time.
             time_and_pv[ii].second = pv[ii];
         }
-        std::sort(time_and_pv.begin(), time_and_pv.end());
+        parallelSort(time_and_pv);
 
         // Compute Phi.
         std::vector<double> Phi(n + 1);
@@ -166,6 +221,178 @@ namespace Opm
 
 
 
+    /// \brief Compute approximate flow-capacity/storage-capacity curve
+    ///        without sorting the cells.
+    ///
+    /// \param[in]  pv        pore volumes of each cell
+    /// \param[in]  ftof      forward (time from injector) time-of-flight values for each cell
+    /// \param[in]  rtof      reverse (time to producer) time-of-flight values for each cell
+    /// \param[in]  num_bins  number of travel time bins, must be positive
+    /// \return               the approximate curve and its error bounds.
+    BinnedFandPhi computeFandPhiBinned(const std::vector<double>& pv,
+                                       const std::vector<double>& ftof,
+                                       const std::vector<double>& rtof,
+                                       const int num_bins)
+    {
+        if (pv.size() != ftof.size() || pv.size() != rtof.size()) {
+            OPM_THROW(std::runtime_error, "computeFandPhiBinned(): Input vectors must have same size.");
+        }
+        if (pv.empty()) {
+            OPM_THROW(std::runtime_error, "computeFandPhiBinned(): Input vectors must not be empty.");
+        }
+        if (num_bins < 1) {
+            OPM_THROW(std::runtime_error, "computeFandPhiBinned(): Number of bins must be positive.");
+        }
+
+        // Find range of total travel times.
+        const int n = pv.size();
+        double tmin = std::numeric_limits<double>::max();
+        double tmax = 0.0;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) reduction(min:tmin) reduction(max:tmax)
+#endif
+        for (int ii = 0; ii < n; ++ii) {
+            const double t = ftof[ii] + rtof[ii];
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+        if (!(tmin > 0.0) || !std::isfinite(tmax)) {
+            OPM_THROW(std::runtime_error, "computeFandPhiBinned(): Total travel times must be positive and finite.");
+        }
+
+        // Accumulate pore volume and flux per bin. Each thread has its own
+        // histogram, and the histograms are summed in thread order.
+        const double log_tmin = std::log(tmin);
+        const double log_range = std::log(tmax) - log_tmin;
+        const double bins_per_log = log_range > 0.0 ? num_bins / log_range : 0.0;
+        struct Bin
+        {
+            double pv;
+            double flux;
+            double tlo;
+            double thi;
+        };
+        const Bin empty_bin = { 0.0, 0.0, std::numeric_limits<double>::max(), 0.0 };
+#if defined(_OPENMP)
+        const int num_threads = omp_get_max_threads();
+#else
+        const int num_threads = 1;
+#endif
+        std::vector<std::vector<Bin>> thread_bins(num_threads);
+#if defined(_OPENMP)
+#pragma omp parallel num_threads(num_threads)
+#endif
+        {
+#if defined(_OPENMP)
+            std::vector<Bin>& bins = thread_bins[omp_get_thread_num()];
+#else
+            std::vector<Bin>& bins = thread_bins[0];
+#endif
+            bins.assign(num_bins, empty_bin);
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+            for (int ii = 0; ii < n; ++ii) {
+                const double t = ftof[ii] + rtof[ii];
+                const int b = std::min(static_cast<int>((std::log(t) - log_tmin) * bins_per_log), num_bins - 1);
+                Bin& bin = bins[b];
+                bin.pv += pv[ii];
+                bin.flux += pv[ii] / t;
+                bin.tlo = std::min(bin.tlo, t);
+                bin.thi = std::max(bin.thi, t);
+            }
+        }
+        std::vector<Bin>& bins = thread_bins[0];
+        for (int t = 1; t < num_threads; ++t) {
+            for (int b = 0; b < num_bins; ++b) {
+                bins[b].pv += thread_bins[t][b].pv;
+                bins[b].flux += thread_bins[t][b].flux;
+                bins[b].tlo = std::min(bins[b].tlo, thread_bins[t][b].tlo);
+                bins[b].thi = std::max(bins[b].thi, thread_bins[t][b].thi);
+            }
+        }
+
+        // Cumulate nonempty bins.
+        BinnedFandPhi result;
+        result.flowcap.reserve(num_bins + 1);
+        result.storagecap.reserve(num_bins + 1);
+        result.flowcap.push_back(0.0);
+        result.storagecap.push_back(0.0);
+        for (int b = 0; b < num_bins; ++b) {
+            if (bins[b].thi > 0.0) {
+                result.flowcap.push_back(result.flowcap.back() + bins[b].flux);
+                result.storagecap.push_back(result.storagecap.back() + bins[b].pv);
+            }
+        }
+        const double ft = result.flowcap.back(); // Total flux.
+        const double vt = result.storagecap.back(); // Total pore volume.
+        const int np = result.flowcap.size();
+        for (int ii = 1; ii < np; ++ii) { // Note limits of loop.
+            result.flowcap[ii] /= ft;
+            result.storagecap[ii] /= vt;
+        }
+
+        // Within a bin the exact curve starts with slope at most s1 and
+        // ends with slope at least s2, so it lies in the triangle formed
+        // by the linear segment and the lines with those slopes through
+        // its end points.
+        result.max_flowcap_error = 0.0;
+        double area = 0.0;
+        int ii = 0;
+        for (int b = 0; b < num_bins; ++b) {
+            if (bins[b].thi == 0.0) {
+                continue;
+            }
+            ++ii;
+            const double dphi = result.storagecap[ii] - result.storagecap[ii-1];
+            const double df = result.flowcap[ii] - result.flowcap[ii-1];
+            const double s1 = vt / (ft * bins[b].tlo);
+            const double s2 = vt / (ft * bins[b].thi);
+            if (s1 > s2 && dphi > 0.0) {
+                const double s = df / dphi;
+                const double x = std::max((df - s2 * dphi) / (s1 - s2), 0.0);
+                const double height = std::max((s1 - s) * x, 0.0);
+                result.max_flowcap_error = std::max(result.max_flowcap_error, height);
+                area += 0.5 * dphi * height;
+            }
+        }
+        result.lorenz_error = 2.0 * area;
+
+        return result;
+    }
+
+
+
+
+
+    /// \brief Compute the Lorenz coefficient based on an approximate F-Phi curve.
+    ///
+    /// \param[in]  fphi  F-Phi curve as from computeFandPhiBinned()
+    /// \return           the Lorenz coefficient, accurate to within fphi.lorenz_error
+    double computeLorenz(const BinnedFandPhi& fphi)
+    {
+        return computeLorenz(fphi.flowcap, fphi.storagecap);
+    }
+
+
+
+
+
+    /// \brief Compute sweep efficiency versus dimensionless time (PVI)
+    ///        based on an approximate F-Phi curve.
+    ///
+    /// \param[in]  fphi  F-Phi curve as from computeFandPhiBinned()
+    /// \return           as computeSweep() for F and Phi vectors, with one
+    ///                   point per nonempty bin.
+    std::pair<std::vector<double>, std::vector<double>> computeSweep(const BinnedFandPhi& fphi)
+    {
+        return computeSweep(fphi.flowcap, fphi.storagecap);
+    }
+
+
+
+
+
     /// \brief Compute volumes associated with injector-producer pairs.
     ///
     /// \param[in]  wells       wells structure, containing NI injector wells and NP producer wells.
@@ -223,4 +450,131 @@ namespace Opm
 
 
 
+    /// \brief Compress tracer values, dropping small values.
+    ///
+    /// \param[in]  tracer       array of tracer values, N per cell, as from
+    ///                          TofReorder::solveTofTracer()
+    /// \param[in]  num_tracers  number of tracers, N
+    /// \param[in]  threshold    values not exceeding this are dropped
+    /// \return                  the compressed tracer values
+    SparseTracerValues
+    compressTracerValues(const std::vector<double>& tracer,
+                         const int num_tracers,
+                         const double threshold)
+    {
+        if (num_tracers <= 0 || tracer.size() % num_tracers != 0) {
+            OPM_THROW(std::runtime_error, "compressTracerValues(): wrong size of input array tracer.");
+        }
+        const int nc = tracer.size() / num_tracers;
+        SparseTracerValues result;
+        std::vector<std::pair<int, double>> row;
+        for (int c = 0; c < nc; ++c) {
+            row.clear();
+            for (int tr = 0; tr < num_tracers; ++tr) {
+                const double value = tracer[num_tracers * c + tr];
+                if (value > threshold) {
+                    row.push_back(std::make_pair(tr, value));
+                }
+            }
+            result.appendRow(row.begin(), row.end());
+        }
+        return result;
+    }
+
+
+
+    /// \brief Compute volumes associated with injector-producer pairs,
+    ///        from compressed tracer values.
+    ///
+    /// \param[in]  wells       wells structure, containing NI injector wells and NP producer wells.
+    /// \param[in]  porevol     pore volume of each grid cell
+    /// \param[in]  ftracer     forward (injector) tracer values, with injector indices in [0, NI)
+    /// \param[in]  btracer     backward (producer) tracer values, with producer indices in [0, NP)
+    /// \return                 as computeWellPairs() for dense tracer arrays.
+    std::vector<std::tuple<int, int, double>>
+    computeWellPairs(const Wells& wells,
+                     const std::vector<double>& porevol,
+                     const SparseTracerValues& ftracer,
+                     const SparseTracerValues& btracer)
+    {
+        // Identify injectors and producers.
+        std::vector<int> inj;
+        std::vector<int> prod;
+        const int nw = wells.number_of_wells;
+        for (int w = 0; w < nw; ++w) {
+            if (wells.type[w] == INJECTOR) {
+                inj.push_back(w);
+            } else {
+                prod.push_back(w);
+            }
+        }
+
+        // Check sizes of input arrays.
+        const int nc = porevol.size();
+        if (ftracer.size() != nc) {
+            OPM_THROW(std::runtime_error, "computeWellPairs(): wrong size of input array ftracer.");
+        }
+        if (btracer.size() != nc) {
+            OPM_THROW(std::runtime_error, "computeWellPairs(): wrong size of input array btracer.");
+        }
+
+        // Accumulate associated pore volumes in one pass over the cells.
+        // Each thread has its own accumulator, and the accumulators are
+        // summed in thread order afterwards, so that for a given number
+        // of threads the result does not depend on scheduling.
+        const int num_inj = inj.size();
+        const int num_prod = prod.size();
+        const int num_pairs = num_inj * num_prod;
+#if defined(_OPENMP)
+        const int num_threads = omp_get_max_threads();
+#else
+        const int num_threads = 1;
+#endif
+        std::vector<std::vector<double>> assoc_porevol(num_threads);
+#if defined(_OPENMP)
+#pragma omp parallel num_threads(num_threads)
+#endif
+        {
+#if defined(_OPENMP)
+            std::vector<double>& acc = assoc_porevol[omp_get_thread_num()];
+#else
+            std::vector<double>& acc = assoc_porevol[0];
+#endif
+            acc.assign(num_pairs, 0.0);
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+            for (int c = 0; c < nc; ++c) {
+                const auto frow = ftracer[c];
+                const auto brow = btracer[c];
+                for (auto fit = frow.begin(); fit != frow.end(); ++fit) {
+                    assert(fit->first >= 0 && fit->first < num_inj);
+                    const double fvol = porevol[c] * fit->second;
+                    double* pair_acc = acc.data() + num_prod * fit->first;
+                    for (auto bit = brow.begin(); bit != brow.end(); ++bit) {
+                        assert(bit->first >= 0 && bit->first < num_prod);
+                        pair_acc[bit->first] += fvol * bit->second;
+                    }
+                }
+            }
+        }
+        for (int t = 1; t < num_threads; ++t) {
+            for (int pair = 0; pair < num_pairs; ++pair) {
+                assoc_porevol[0][pair] += assoc_porevol[t][pair];
+            }
+        }
+
+        std::vector<std::tuple<int, int, double> > result;
+        result.reserve(num_pairs);
+        for (int inj_ix = 0; inj_ix < num_inj; ++inj_ix) {
+            for (int prod_ix = 0; prod_ix < num_prod; ++prod_ix) {
+                result.push_back(std::make_tuple(inj[inj_ix], prod[prod_ix],
+                                                 assoc_porevol[0][num_prod * inj_ix + prod_ix]));
+            }
+        }
+        return result;
+    }
+
+
+
 } // namespace Opm
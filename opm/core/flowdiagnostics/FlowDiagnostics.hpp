@@ -21,6 +21,7 @@
 #define OPM_FLOWDIAGNOSTICS_HEADER_INCLUDED
 
 
+#include <opm/core/utility/SparseTable.hpp>
 #include <vector>
 #include <utility>
 #include <tuple>
@@ -82,6 +83,67 @@ namespace Opm
                  const std::vector<double>& storagecap);
 
 
+    /// Approximate F-Phi curve, as computed by computeFandPhiBinned().
+    struct BinnedFandPhi
+    {
+        /// Flow capacity (F) at the bin edges, starting with zero.
+        std::vector<double> flowcap;
+        /// Storage capacity (Phi) at the bin edges, starting with zero.
+        std::vector<double> storagecap;
+        /// Bound on the difference between flowcap and the exact
+        /// F-Phi curve at any storage capacity.
+        double max_flowcap_error;
+        /// Bound on the difference between computeLorenz() of this
+        /// curve and of the exact curve.
+        double lorenz_error;
+    };
+
+
+    /// \brief Compute approximate flow-capacity/storage-capacity curve
+    ///        without sorting the cells.
+    ///
+    /// The cells are binned by total travel time, using bins equally
+    /// spaced in log(time) between the smallest and largest times, and
+    /// the curve is formed by cumulating the bins. F and Phi are exact
+    /// at the bin edges, and the exact curve is concave, so it lies in
+    /// a triangle above each linear segment whose size is limited by
+    /// the spread of travel times in the bin. The error bounds stated
+    /// in the result are computed from those triangles. Empty bins do
+    /// not contribute points to the curve.
+    ///
+    /// The cost is linear in the number of cells and the binning is done
+    /// in parallel if OpenMP is available, making this suitable for
+    /// repeated diagnostics of very large models.
+    ///
+    /// \param[in]  pv        pore volumes of each cell
+    /// \param[in]  ftof      forward (time from injector) time-of-flight values for each cell
+    /// \param[in]  rtof      reverse (time to producer) time-of-flight values for each cell
+    /// \param[in]  num_bins  number of travel time bins, must be positive
+    /// \return               the approximate curve and its error bounds.
+    BinnedFandPhi
+    computeFandPhiBinned(const std::vector<double>& pv,
+                         const std::vector<double>& ftof,
+                         const std::vector<double>& rtof,
+                         const int num_bins = 1000);
+
+
+    /// \brief Compute the Lorenz coefficient based on an approximate F-Phi curve.
+    ///
+    /// \param[in]  fphi  F-Phi curve as from computeFandPhiBinned()
+    /// \return           the Lorenz coefficient, accurate to within fphi.lorenz_error
+    double computeLorenz(const BinnedFandPhi& fphi);
+
+
+    /// \brief Compute sweep efficiency versus dimensionless time (PVI)
+    ///        based on an approximate F-Phi curve.
+    ///
+    /// \param[in]  fphi  F-Phi curve as from computeFandPhiBinned()
+    /// \return           as computeSweep() for F and Phi vectors, with one
+    ///                   point per nonempty bin.
+    std::pair<std::vector<double>, std::vector<double>>
+    computeSweep(const BinnedFandPhi& fphi);
+
+
     /// \brief Compute volumes associated with injector-producer pairs.
     ///
     /// \param[in]  wells       wells structure, containing NI injector wells and NP producer wells.
@@ -98,6 +160,45 @@ namespace Opm
                      const std::vector<double>& ftracer,
                      const std::vector<double>& btracer);
 
+
+    /// Tracer values in compressed per-cell format. Row c of the table
+    /// contains the (tracer index, value) pairs of the nonzero tracers
+    /// in cell c, ordered by tracer index.
+    typedef SparseTable<std::pair<int, double>> SparseTracerValues;
+
+
+    /// \brief Compress tracer values, dropping small values.
+    ///
+    /// \param[in]  tracer       array of tracer values, N per cell, as from
+    ///                          TofReorder::solveTofTracer()
+    /// \param[in]  num_tracers  number of tracers, N
+    /// \param[in]  threshold    values not exceeding this are dropped
+    /// \return                  the compressed tracer values
+    SparseTracerValues
+    compressTracerValues(const std::vector<double>& tracer,
+                         const int num_tracers,
+                         const double threshold = 0.0);
+
+
+    /// \brief Compute volumes associated with injector-producer pairs,
+    ///        from compressed tracer values.
+    ///
+    /// The pair volumes are accumulated in a single pass over the cells,
+    /// (using OpenMP threads if available), so the cost is proportional
+    /// to the number of nonzero injector-producer tracer products, not
+    /// to the number of pairs times the number of cells.
+    ///
+    /// \param[in]  wells       wells structure, containing NI injector wells and NP producer wells.
+    /// \param[in]  porevol     pore volume of each grid cell
+    /// \param[in]  ftracer     forward (injector) tracer values, with injector indices in [0, NI)
+    /// \param[in]  btracer     backward (producer) tracer values, with producer indices in [0, NP)
+    /// \return                 as computeWellPairs() for dense tracer arrays.
+    std::vector<std::tuple<int, int, double>>
+    computeWellPairs(const Wells& wells,
+                     const std::vector<double>& porevol,
+                     const SparseTracerValues& ftracer,
+                     const SparseTracerValues& btracer);
+
 } // namespace Opm
 
 #endif // OPM_FLOWDIAGNOSTICS_HEADER_INCLUDED
@@ -0,0 +1,281 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/flowdiagnostics/FlowDiagnosticsEngine.hpp>
+#include <opm/core/flowdiagnostics/FlowDiagnostics.hpp>
+#include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/grid.h>
+#include <opm/core/wells.h>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace Opm
+{
+
+
+    FlowDiagnosticsEngine::Direction::Direction(const UnstructuredGrid& grid)
+        : solver(grid),
+          sequence_version(-1),
+          tof_version(-1)
+    {
+    }
+
+
+
+
+    /// Construct engine.
+    /// \param[in] grid        A 2d or 3d grid. Must outlive the engine.
+    /// \param[in] porevolume  Pore volume of each cell.
+    FlowDiagnosticsEngine::FlowDiagnosticsEngine(const UnstructuredGrid& grid,
+                                                 const std::vector<double>& porevolume)
+        : grid_(grid),
+          porevolume_(porevolume),
+          wells_(0),
+          version_(0),
+          reorder_ctx_(create_reorder_context(&grid), destroy_reorder_context),
+          forward_(grid),
+          reverse_(grid),
+          fandphi_version_(-1),
+          lorenz_(0.0),
+          lorenz_version_(-1),
+          sweep_version_(-1),
+          wellpairs_version_(-1)
+    {
+        if (int(porevolume.size()) != grid.number_of_cells) {
+            OPM_THROW(std::runtime_error, "FlowDiagnosticsEngine: wrong size of porevolume.");
+        }
+        if (!reorder_ctx_) {
+            OPM_THROW(std::runtime_error, "FlowDiagnosticsEngine: failed to allocate reorder context.");
+        }
+    }
+
+
+
+
+    /// Set a new flow field, invalidating all diagnostics.
+    /// \param[in] darcyflux  Array of signed face fluxes.
+    /// \param[in] source     Source term, as for TofReorder::solveTof().
+    /// \param[in] wells      Wells whose perforated cells are the tracer
+    ///                       heads. Must be kept alive and unchanged
+    ///                       until the next call to setFlowField().
+    void FlowDiagnosticsEngine::setFlowField(const std::vector<double>& darcyflux,
+                                             const std::vector<double>& source,
+                                             const Wells& wells)
+    {
+        if (int(darcyflux.size()) != grid_.number_of_faces) {
+            OPM_THROW(std::runtime_error, "FlowDiagnosticsEngine::setFlowField(): wrong size of darcyflux.");
+        }
+        if (int(source.size()) != grid_.number_of_cells) {
+            OPM_THROW(std::runtime_error, "FlowDiagnosticsEngine::setFlowField(): wrong size of source.");
+        }
+        wells_ = &wells;
+        ++version_;
+
+        // The reverse problem has negated fluxes and sources.
+        forward_.flux = darcyflux;
+        forward_.source = source;
+        reverse_.flux.resize(darcyflux.size());
+        std::transform(darcyflux.begin(), darcyflux.end(), reverse_.flux.begin(), std::negate<double>());
+        reverse_.source.resize(source.size());
+        std::transform(source.begin(), source.end(), reverse_.source.begin(), std::negate<double>());
+
+        // Tracer heads are the perforated cells of each injector
+        // (forward) or producer (reverse).
+        forward_.tracerheads.clear();
+        reverse_.tracerheads.clear();
+        for (int w = 0; w < wells.number_of_wells; ++w) {
+            const int* beg = wells.well_cells + wells.well_connpos[w];
+            const int* end = wells.well_cells + wells.well_connpos[w + 1];
+            if (wells.type[w] == INJECTOR) {
+                forward_.tracerheads.appendRow(beg, end);
+            } else {
+                reverse_.tracerheads.appendRow(beg, end);
+            }
+        }
+    }
+
+
+
+
+    /// Version of the current flow field. Zero before the first
+    /// call to setFlowField(), incremented by each call.
+    int FlowDiagnosticsEngine::flowFieldVersion() const
+    {
+        return version_;
+    }
+
+
+
+
+    const std::vector<int>& FlowDiagnosticsEngine::forwardSequence()
+    {
+        computeSequence(forward_);
+        return forward_.sequence;
+    }
+
+
+    const std::vector<int>& FlowDiagnosticsEngine::forwardComponents()
+    {
+        computeSequence(forward_);
+        return forward_.components;
+    }
+
+
+    const std::vector<int>& FlowDiagnosticsEngine::reverseSequence()
+    {
+        computeSequence(reverse_);
+        return reverse_.sequence;
+    }
+
+
+    const std::vector<int>& FlowDiagnosticsEngine::reverseComponents()
+    {
+        computeSequence(reverse_);
+        return reverse_.components;
+    }
+
+
+
+
+    const std::vector<double>& FlowDiagnosticsEngine::forwardTof()
+    {
+        computeTof(forward_);
+        return forward_.tof;
+    }
+
+
+    const std::vector<double>& FlowDiagnosticsEngine::reverseTof()
+    {
+        computeTof(reverse_);
+        return reverse_.tof;
+    }
+
+
+    const std::vector<double>& FlowDiagnosticsEngine::forwardTracer()
+    {
+        computeTof(forward_);
+        return forward_.tracer;
+    }
+
+
+    const std::vector<double>& FlowDiagnosticsEngine::reverseTracer()
+    {
+        computeTof(reverse_);
+        return reverse_.tracer;
+    }
+
+
+
+
+    const std::pair<std::vector<double>, std::vector<double>>& FlowDiagnosticsEngine::fandPhi()
+    {
+        if (fandphi_version_ != version_) {
+            fandphi_ = computeFandPhi(porevolume_, forwardTof(), reverseTof());
+            fandphi_version_ = version_;
+        }
+        return fandphi_;
+    }
+
+
+    double FlowDiagnosticsEngine::lorenz()
+    {
+        if (lorenz_version_ != version_) {
+            const auto& fphi = fandPhi();
+            lorenz_ = computeLorenz(fphi.first, fphi.second);
+            lorenz_version_ = version_;
+        }
+        return lorenz_;
+    }
+
+
+    const std::pair<std::vector<double>, std::vector<double>>& FlowDiagnosticsEngine::sweep()
+    {
+        if (sweep_version_ != version_) {
+            const auto& fphi = fandPhi();
+            sweep_ = computeSweep(fphi.first, fphi.second);
+            sweep_version_ = version_;
+        }
+        return sweep_;
+    }
+
+
+    const std::vector<std::tuple<int, int, double>>& FlowDiagnosticsEngine::wellPairs()
+    {
+        if (wellpairs_version_ != version_) {
+            wellpairs_ = computeWellPairs(*wells_, porevolume_, forwardTracer(), reverseTracer());
+            wellpairs_version_ = version_;
+        }
+        return wellpairs_;
+    }
+
+
+
+
+    void FlowDiagnosticsEngine::checkFlowField() const
+    {
+        if (version_ == 0) {
+            OPM_THROW(std::runtime_error, "FlowDiagnosticsEngine: no flow field set.");
+        }
+    }
+
+
+
+
+    // Compute the ordering of one direction, once per flow field,
+    // reusing the workspace of the reorder context.
+    void FlowDiagnosticsEngine::computeSequence(Direction& dir)
+    {
+        checkFlowField();
+        if (dir.sequence_version == version_) {
+            return;
+        }
+        const int num_cells = grid_.number_of_cells;
+        dir.sequence.resize(num_cells);
+        dir.components.resize(num_cells + 1);
+        int num_components = 0;
+        compute_sequence_context(reorder_ctx_.get(), &grid_, dir.flux.data(), dir.sequence.data(),
+                                 dir.components.data(), &num_components, 0);
+        dir.components.resize(num_components + 1);
+        dir.sequence_version = version_;
+    }
+
+
+
+
+    // Solve for time-of-flight and tracers of one direction, once per
+    // flow field, using the cached ordering.
+    void FlowDiagnosticsEngine::computeTof(Direction& dir)
+    {
+        checkFlowField();
+        if (dir.tof_version == version_) {
+            return;
+        }
+        computeSequence(dir);
+        dir.solver.setOrdering(dir.sequence, dir.components);
+        dir.solver.solveTofTracer(dir.flux.data(), porevolume_.data(), dir.source.data(),
+                                  dir.tracerheads, dir.tof, dir.tracer);
+        dir.solver.clearOrdering();
+        dir.tof_version = version_;
+    }
+
+
+} // namespace Opm
@@ -0,0 +1,138 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_FLOWDIAGNOSTICSENGINE_HEADER_INCLUDED
+#define OPM_FLOWDIAGNOSTICSENGINE_HEADER_INCLUDED
+
+#include <opm/core/flowdiagnostics/TofReorder.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <tuple>
+
+struct UnstructuredGrid;
+struct Wells;
+struct ReorderContext;
+
+namespace Opm
+{
+
+    /// Computes flow diagnostics for a sequence of flow fields on a
+    /// fixed grid.
+    ///
+    /// All diagnostics are computed on first request and memoized
+    /// until the flow field is replaced by setFlowField(). The forward
+    /// and reverse cell orderings are computed once per flow field and
+    /// shared by all time-of-flight and tracer solves for that field.
+    ///
+    /// The forward quantities are computed from the injectors, with one
+    /// tracer per injector, and the reverse quantities from the producers,
+    /// with one tracer per producer, both in the order of the wells.
+    class FlowDiagnosticsEngine
+    {
+    public:
+        /// Construct engine.
+        /// \param[in] grid        A 2d or 3d grid. Must outlive the engine.
+        /// \param[in] porevolume  Pore volume of each cell.
+        FlowDiagnosticsEngine(const UnstructuredGrid& grid,
+                              const std::vector<double>& porevolume);
+
+        /// Set a new flow field, invalidating all diagnostics.
+        /// \param[in] darcyflux  Array of signed face fluxes.
+        /// \param[in] source     Source term, as for TofReorder::solveTof().
+        /// \param[in] wells      Wells whose perforated cells are the tracer
+        ///                       heads. Must be kept alive and unchanged
+        ///                       until the next call to setFlowField().
+        void setFlowField(const std::vector<double>& darcyflux,
+                          const std::vector<double>& source,
+                          const Wells& wells);
+
+        /// Version of the current flow field. Zero before the first
+        /// call to setFlowField(), incremented by each call.
+        int flowFieldVersion() const;
+
+        /// Forward cell ordering, as from compute_sequence().
+        const std::vector<int>& forwardSequence();
+        /// Forward component start indices, as from compute_sequence().
+        const std::vector<int>& forwardComponents();
+        /// Reverse cell ordering, as from compute_sequence() for the
+        /// negated fluxes.
+        const std::vector<int>& reverseSequence();
+        /// Reverse component start indices.
+        const std::vector<int>& reverseComponents();
+
+        /// Time-of-flight from the injectors, one value per cell.
+        const std::vector<double>& forwardTof();
+        /// Time-of-flight to the producers, one value per cell.
+        const std::vector<double>& reverseTof();
+        /// Injector tracers, one value per injector per cell (cell-major).
+        const std::vector<double>& forwardTracer();
+        /// Producer tracers, one value per producer per cell (cell-major).
+        const std::vector<double>& reverseTracer();
+
+        /// F-Phi curve, as from computeFandPhi().
+        const std::pair<std::vector<double>, std::vector<double>>& fandPhi();
+        /// Lorenz coefficient, as from computeLorenz().
+        double lorenz();
+        /// Sweep efficiency versus dimensionless time, as from computeSweep().
+        const std::pair<std::vector<double>, std::vector<double>>& sweep();
+        /// Injector-producer pair volumes, as from computeWellPairs().
+        const std::vector<std::tuple<int, int, double>>& wellPairs();
+
+    private:
+        struct Direction
+        {
+            explicit Direction(const UnstructuredGrid& grid);
+            TofReorder solver;
+            SparseTable<int> tracerheads;
+            std::vector<double> flux;
+            std::vector<double> source;
+            std::vector<int> sequence;
+            std::vector<int> components;
+            std::vector<double> tof;
+            std::vector<double> tracer;
+            int sequence_version;
+            int tof_version;
+        };
+
+        void checkFlowField() const;
+        void computeSequence(Direction& dir);
+        void computeTof(Direction& dir);
+
+        const UnstructuredGrid& grid_;
+        std::vector<double> porevolume_;
+        const Wells* wells_;
+        int version_;
+        std::unique_ptr<ReorderContext, void(*)(ReorderContext*)> reorder_ctx_;
+        Direction forward_;
+        Direction reverse_;
+        std::pair<std::vector<double>, std::vector<double>> fandphi_;
+        int fandphi_version_;
+        double lorenz_;
+        int lorenz_version_;
+        std::pair<std::vector<double>, std::vector<double>> sweep_;
+        int sweep_version_;
+        std::vector<std::tuple<int, int, double>> wellpairs_;
+        int wellpairs_version_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_FLOWDIAGNOSTICSENGINE_HEADER_INCLUDED
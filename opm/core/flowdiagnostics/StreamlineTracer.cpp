@@ -0,0 +1,299 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/flowdiagnostics/StreamlineTracer.hpp>
+#include <opm/core/grid.h>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Opm
+{
+
+
+    namespace
+    {
+        enum { NoTracerHead = -1, InflowBoundary = -1, NotTerminated = -2 };
+
+        // Pollock exit time along one logical direction. The velocity
+        // is v0 at xi = 0 and v1 at xi = 1, varying linearly in
+        // between. Returns infinity if the direction is not exited, and
+        // otherwise sets side to 0 (low side) or 1 (high side).
+        inline double exitTime(const double v0, const double v1,
+                               const double xi, int& side)
+        {
+            const double g = v1 - v0;
+            const double v = v0 + g*xi;
+            const bool uniform = std::fabs(g) <= 1e-12*std::max(std::fabs(v0), std::fabs(v1));
+            if (v > 0.0 && v1 > 0.0) {
+                side = 1;
+                return uniform ? (1.0 - xi)/v : std::log(v1/v)/g;
+            }
+            if (v < 0.0 && v0 < 0.0) {
+                side = 0;
+                return uniform ? -xi/v : std::log(v0/v)/g;
+            }
+            return std::numeric_limits<double>::infinity();
+        }
+
+        // Position along one logical direction after time dt.
+        inline double advance(const double v0, const double v1,
+                              const double xi, const double dt)
+        {
+            const double g = v1 - v0;
+            const double v = v0 + g*xi;
+            const bool uniform = std::fabs(g) <= 1e-12*std::max(std::fabs(v0), std::fabs(v1));
+            const double x = uniform ? xi + v*dt : (v*std::exp(g*dt) - v0)/g;
+            return std::min(std::max(x, 0.0), 1.0);
+        }
+    } // anonymous namespace
+
+
+
+
+    /// Construct tracer.
+    /// \param[in] grid            A 2d or 3d grid with face tags.
+    /// \param[in] seeds_per_dim   Number of seeds per cell in each
+    ///                            logical direction.
+    /// \param[in] max_steps       Maximum number of cells traversed
+    ///                            by a single streamline.
+    /// \param[in] max_tof         Time-of-flight given to streamlines
+    ///                            that stagnate or exceed max_steps.
+    StreamlineTracer::StreamlineTracer(const UnstructuredGrid& grid,
+                                       const int seeds_per_dim,
+                                       const int max_steps,
+                                       const double max_tof)
+        : grid_(grid),
+          dim_(grid.dimensions),
+          seeds_per_dim_(seeds_per_dim),
+          max_steps_(max_steps),
+          max_tof_(max_tof),
+          source_(0)
+    {
+        if (grid.cell_facetag == 0) {
+            OPM_THROW(std::runtime_error, "StreamlineTracer(): Grid must have face tags.");
+        }
+        if (seeds_per_dim < 1) {
+            OPM_THROW(std::runtime_error, "StreamlineTracer(): Need at least one seed per dimension.");
+        }
+        const int num_sides = 2*dim_;
+        face_tag_.assign(2*grid.number_of_faces, -1);
+        std::vector<char> has_side(num_sides);
+        for (int c = 0; c < grid.number_of_cells; ++c) {
+            std::fill(has_side.begin(), has_side.end(), 0);
+            for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                const int tag = grid.cell_facetag[hf];
+                if (tag < 0 || tag >= num_sides) {
+                    OPM_THROW(std::runtime_error, "StreamlineTracer(): Face tag " << tag
+                              << " of cell " << c << " out of range.");
+                }
+                has_side[tag] = 1;
+                face_tag_[2*f + (grid.face_cells[2*f] == c ? 0 : 1)] = tag;
+            }
+            if (std::find(has_side.begin(), has_side.end(), 0) != has_side.end()) {
+                OPM_THROW(std::runtime_error, "StreamlineTracer(): Cell " << c
+                          << " is not a logical hexahedron.");
+            }
+        }
+    }
+
+
+
+
+    /// Solve for time-of-flight.
+    /// \param[in]  darcyflux         Array of signed face fluxes.
+    /// \param[in]  porevolume        Array of pore volumes.
+    /// \param[in]  source            Source term. Sign convention is:
+    ///                                 (+) inflow flux,
+    ///                                 (-) outflow flux.
+    /// \param[out] tof               Array of time-of-flight values.
+    void StreamlineTracer::solveTof(const double* darcyflux,
+                                    const double* porevolume,
+                                    const double* source,
+                                    std::vector<double>& tof)
+    {
+        std::vector<double> tracer;
+        solveTofTracer(darcyflux, porevolume, source, SparseTable<int>(), tof, tracer);
+    }
+
+
+
+
+    /// Solve for time-of-flight and a number of tracers.
+    /// \param[in]  darcyflux         Array of signed face fluxes.
+    /// \param[in]  porevolume        Array of pore volumes.
+    /// \param[in]  source            Source term, as for solveTof().
+    /// \param[in]  tracerheads       Table containing one row per tracer, and each
+    ///                               row contains the source cells for that tracer.
+    /// \param[out] tof               Array of time-of-flight values (1 per cell).
+    /// \param[out] tracer            Array of tracer values, N per cell in
+    ///                               cell-major order as for TofReorder.
+    ///                               The value of tracer k in a cell is the
+    ///                               fraction of its seeds whose streamlines
+    ///                               end in a head of tracer k.
+    void StreamlineTracer::solveTofTracer(const double* darcyflux,
+                                          const double* porevolume,
+                                          const double* source,
+                                          const SparseTable<int>& tracerheads,
+                                          std::vector<double>& tof,
+                                          std::vector<double>& tracer)
+    {
+        const int num_cells = grid_.number_of_cells;
+        const int num_tracers = tracerheads.size();
+        source_ = source;
+        setupSides(darcyflux, porevolume);
+
+        std::vector<int> head_by_cell(num_cells, NoTracerHead);
+        for (int tr = 0; tr < num_tracers; ++tr) {
+            for (const int cell : tracerheads[tr]) {
+                head_by_cell[cell] = tr;
+            }
+        }
+
+        int num_seeds = 1;
+        for (int d = 0; d < dim_; ++d) {
+            num_seeds *= seeds_per_dim_;
+        }
+        const double seed_weight = 1.0/num_seeds;
+
+        tof.assign(num_cells, 0.0);
+        tracer.assign(num_cells*num_tracers, 0.0);
+
+        // Seeds are independent, so cells are processed in parallel.
+        // The number of cells traversed varies a lot between streamlines.
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int cell = 0; cell < num_cells; ++cell) {
+            double tof_sum = 0.0;
+            for (int s = 0; s < num_seeds; ++s) {
+                double xi[3] = { 0.5, 0.5, 0.5 };
+                for (int d = 0, rest = s; d < dim_; ++d, rest /= seeds_per_dim_) {
+                    xi[d] = (rest % seeds_per_dim_ + 0.5)/seeds_per_dim_;
+                }
+                int end_cell = NotTerminated;
+                tof_sum += std::min(traceSeed(cell, xi, end_cell), max_tof_);
+                if (end_cell >= 0 && head_by_cell[end_cell] != NoTracerHead) {
+                    tracer[num_tracers*cell + head_by_cell[end_cell]] += seed_weight;
+                }
+            }
+            tof[cell] = tof_sum*seed_weight;
+        }
+    }
+
+
+
+
+    /// Compute the upstream velocity and exit face of each cell side.
+    void StreamlineTracer::setupSides(const double* darcyflux, const double* porevolume)
+    {
+        const int num_cells = grid_.number_of_cells;
+        const int num_sides = 2*dim_;
+        side_velocity_.assign(num_cells*num_sides, 0.0);
+        side_exit_face_.assign(num_cells*num_sides, -1);
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < num_cells; ++c) {
+            double* vel = &side_velocity_[num_sides*c];
+            int* exit_face = &side_exit_face_[num_sides*c];
+            double max_outflux[6];
+            std::fill(max_outflux, max_outflux + num_sides, -std::numeric_limits<double>::max());
+            for (int hf = grid_.cell_facepos[c]; hf < grid_.cell_facepos[c + 1]; ++hf) {
+                const int f = grid_.cell_faces[hf];
+                const int tag = grid_.cell_facetag[hf];
+                // Outflux of the upstream (negated) flux field.
+                const double outflux = (grid_.face_cells[2*f] == c) ? -darcyflux[f] : darcyflux[f];
+                vel[tag] += (tag % 2 == 0) ? -outflux : outflux;
+                if (outflux > max_outflux[tag]) {
+                    max_outflux[tag] = outflux;
+                    exit_face[tag] = f;
+                }
+            }
+            for (int side = 0; side < num_sides; ++side) {
+                vel[side] /= porevolume[c];
+            }
+        }
+    }
+
+
+
+
+    /// Trace a streamline upstream from a point in a cell.
+    /// \param[in]     start_cell  Cell containing the seed.
+    /// \param[in,out] xi          Logical coordinates of the seed in its cell.
+    /// \param[out]    end_cell    Source cell in which the streamline ends,
+    ///                            InflowBoundary or NotTerminated.
+    /// \return Time-of-flight of the seed.
+    double StreamlineTracer::traceSeed(const int start_cell, double* xi, int& end_cell) const
+    {
+        const int num_sides = 2*dim_;
+        int cell = start_cell;
+        double t = 0.0;
+        for (int step = 0; step < max_steps_; ++step) {
+            if (source_[cell] > 0.0) {
+                end_cell = cell;
+                return t;
+            }
+            const double* vel = &side_velocity_[num_sides*cell];
+            double dt = std::numeric_limits<double>::infinity();
+            int exit_side = -1;
+            for (int d = 0; d < dim_; ++d) {
+                int side = 0;
+                const double dt_d = exitTime(vel[2*d], vel[2*d + 1], xi[d], side);
+                if (dt_d < dt) {
+                    dt = dt_d;
+                    exit_side = 2*d + side;
+                }
+            }
+            if (exit_side < 0) {
+                // Stagnation point.
+                break;
+            }
+            for (int d = 0; d < dim_; ++d) {
+                xi[d] = advance(vel[2*d], vel[2*d + 1], xi[d], dt);
+            }
+            const int exit_dir = exit_side/2;
+            xi[exit_dir] = exit_side % 2;
+            t += dt;
+
+            const int face = side_exit_face_[num_sides*cell + exit_side];
+            const int c0 = grid_.face_cells[2*face];
+            const int next = (c0 == cell) ? grid_.face_cells[2*face + 1] : c0;
+            if (next < 0) {
+                end_cell = InflowBoundary;
+                return t;
+            }
+            // Continue through the matching side of the next cell,
+            // swapping logical directions if they do not agree.
+            const int entry_side = face_tag_[2*face + (c0 == next ? 0 : 1)];
+            const int entry_dir = entry_side/2;
+            if (entry_dir != exit_dir) {
+                std::swap(xi[entry_dir], xi[exit_dir]);
+            }
+            xi[entry_dir] = entry_side % 2;
+            cell = next;
+        }
+        end_cell = NotTerminated;
+        return max_tof_;
+    }
+
+
+} // namespace Opm
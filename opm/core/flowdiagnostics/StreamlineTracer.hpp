@@ -0,0 +1,121 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_STREAMLINETRACER_HEADER_INCLUDED
+#define OPM_STREAMLINETRACER_HEADER_INCLUDED
+
+#include <vector>
+
+struct UnstructuredGrid;
+
+namespace Opm
+{
+
+    template <typename T> class SparseTable;
+
+    /// Computes time-of-flight and tracers by semi-analytic
+    /// (Pollock) streamline tracing, as an alternative to TofReorder.
+    ///
+    /// Every cell must be a logical hexahedron (quadrilateral in 2d):
+    /// the grid must have face tags, and each cell must have at least
+    /// one face with each of the tags 0, ..., 2*dim - 1, where tags
+    /// 2*i and 2*i + 1 are the low and high sides in logical direction
+    /// i. A cell is mapped to the unit cube of volume equal to its pore
+    /// volume, and each velocity component varies linearly between the
+    /// total fluxes of its two sides. Streamlines are then traced
+    /// exactly from cell to cell, using only the face fluxes. If a side
+    /// consists of several faces, a streamline leaving through that side
+    /// continues through the face with the largest outflux.
+    ///
+    /// A number of seed points per cell are traced upstream in
+    /// parallel, and the time-of-flight and tracer values of a cell are
+    /// averages over its seeds. A streamline ends when it enters a cell
+    /// with positive source, or passes through a boundary face with
+    /// inflow. Since streamlines end on entry, seeds in source cells have
+    /// zero time-of-flight.
+    class StreamlineTracer
+    {
+    public:
+        /// Construct tracer.
+        /// \param[in] grid            A 2d or 3d grid with face tags.
+        /// \param[in] seeds_per_dim   Number of seeds per cell in each
+        ///                            logical direction.
+        /// \param[in] max_steps       Maximum number of cells traversed
+        ///                            by a single streamline.
+        /// \param[in] max_tof         Time-of-flight given to streamlines
+        ///                            that stagnate or exceed max_steps.
+        StreamlineTracer(const UnstructuredGrid& grid,
+                         const int seeds_per_dim = 2,
+                         const int max_steps = 10000,
+                         const double max_tof = 1e20);
+
+        /// Solve for time-of-flight.
+        /// \param[in]  darcyflux         Array of signed face fluxes.
+        /// \param[in]  porevolume        Array of pore volumes.
+        /// \param[in]  source            Source term. Sign convention is:
+        ///                                 (+) inflow flux,
+        ///                                 (-) outflow flux.
+        /// \param[out] tof               Array of time-of-flight values.
+        void solveTof(const double* darcyflux,
+                      const double* porevolume,
+                      const double* source,
+                      std::vector<double>& tof);
+
+        /// Solve for time-of-flight and a number of tracers.
+        /// \param[in]  darcyflux         Array of signed face fluxes.
+        /// \param[in]  porevolume        Array of pore volumes.
+        /// \param[in]  source            Source term, as for solveTof().
+        /// \param[in]  tracerheads       Table containing one row per tracer, and each
+        ///                               row contains the source cells for that tracer.
+        /// \param[out] tof               Array of time-of-flight values (1 per cell).
+        /// \param[out] tracer            Array of tracer values, N per cell in
+        ///                               cell-major order as for TofReorder.
+        ///                               The value of tracer k in a cell is the
+        ///                               fraction of its seeds whose streamlines
+        ///                               end in a head of tracer k.
+        void solveTofTracer(const double* darcyflux,
+                            const double* porevolume,
+                            const double* source,
+                            const SparseTable<int>& tracerheads,
+                            std::vector<double>& tof,
+                            std::vector<double>& tracer);
+
+    private:
+        void setupSides(const double* darcyflux, const double* porevolume);
+        double traceSeed(const int start_cell, double* xi, int& end_cell) const;
+
+    private:
+        const UnstructuredGrid& grid_;
+        int dim_;
+        int seeds_per_dim_;
+        int max_steps_;
+        double max_tof_;
+        const double* source_;
+        // Tag of each face as seen from its first and second cell.
+        std::vector<int> face_tag_;
+        // Per cell and side, for the upstream (negated) flux field:
+        // velocity in the positive logical direction, scaled by the
+        // inverse pore volume, and the face to continue through.
+        std::vector<double> side_velocity_;
+        std::vector<int> side_exit_face_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_STREAMLINETRACER_HEADER_INCLUDED
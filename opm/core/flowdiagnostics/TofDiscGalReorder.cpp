@@ -34,9 +34,123 @@
 #include <numeric>
 #include <iostream>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 namespace Opm
 {
 
+    namespace
+    {
+
+        /// Solve A X = B by Gaussian elimination with partial
+        /// pivoting, for a fixed number N of unknowns so that all
+        /// loops over rows and columns may be unrolled. Storage and
+        /// return value are as for LAPACK's dgesv(): A is N-by-N and
+        /// B is N-by-nrhs, both in Fortran ordering. A is overwritten,
+        /// B is overwritten by X, and a nonzero value k is returned if
+        /// the k'th pivot is exactly zero.
+        template <int N>
+        int solveFixedSize(double* A, double* B, const int nrhs)
+        {
+            for (int k = 0; k < N; ++k) {
+                int p = k;
+                for (int i = k + 1; i < N; ++i) {
+                    if (std::fabs(A[i + N*k]) > std::fabs(A[p + N*k])) {
+                        p = i;
+                    }
+                }
+                if (A[p + N*k] == 0.0) {
+                    return k + 1;
+                }
+                if (p != k) {
+                    for (int j = k; j < N; ++j) {
+                        std::swap(A[k + N*j], A[p + N*j]);
+                    }
+                    for (int r = 0; r < nrhs; ++r) {
+                        std::swap(B[k + N*r], B[p + N*r]);
+                    }
+                }
+                const double inv_pivot = 1.0/A[k + N*k];
+                for (int i = k + 1; i < N; ++i) {
+                    const double l = A[i + N*k]*inv_pivot;
+                    for (int j = k + 1; j < N; ++j) {
+                        A[i + N*j] -= l*A[k + N*j];
+                    }
+                    for (int r = 0; r < nrhs; ++r) {
+                        B[i + N*r] -= l*B[k + N*r];
+                    }
+                }
+            }
+            for (int r = 0; r < nrhs; ++r) {
+                double* x = B + N*r;
+                for (int i = N - 1; i >= 0; --i) {
+                    double sum = x[i];
+                    for (int j = i + 1; j < N; ++j) {
+                        sum -= A[i + N*j]*x[j];
+                    }
+                    x[i] = sum/A[i + N*i];
+                }
+            }
+            return 0;
+        }
+
+        /// Quadrature points of a cell or face, taken from a
+        /// precomputed table if it is non-empty, and otherwise
+        /// computed by the Quadrature object.
+        template <class Quadrature>
+        class QuadraturePoints
+        {
+        public:
+            QuadraturePoints(const QuadratureTable<Quadrature>& table,
+                             const UnstructuredGrid& grid,
+                             const int entity,
+                             const int degree)
+                : table_(table.numEntities() > 0 ? &table : 0),
+                  quad_(grid, entity, degree),
+                  entity_(entity),
+                  num_pts_(table_ ? table_->numQuadPts(entity) : quad_.numQuadPts())
+            {
+            }
+
+            int numQuadPts() const
+            {
+                return num_pts_;
+            }
+
+            /// Only valid with a table.
+            int pointIndex(const int index) const
+            {
+                return table_->pointIndex(entity_, index);
+            }
+
+            /// Returns the point coordinates, which are written to
+            /// coord unless they are taken from the table.
+            const double* quadPtCoord(const int index, double* coord) const
+            {
+                if (table_) {
+                    return table_->quadPtCoord(entity_, index);
+                }
+                quad_.quadPtCoord(index, coord);
+                return coord;
+            }
+
+            double quadPtWeight(const int index) const
+            {
+                return table_ ? table_->quadPtWeight(entity_, index) : quad_.quadPtWeight(index);
+            }
+
+        private:
+            const QuadratureTable<Quadrature>* table_;
+            const Quadrature quad_;
+            const int entity_;
+            const int num_pts_;
+        };
+
+    } // anonymous namespace
+
+
 
     /// Construct solver.
     TofDiscGalReorder::TofDiscGalReorder(const UnstructuredGrid& grid,
@@ -47,8 +161,6 @@ namespace Opm
           limiter_relative_flux_threshold_(1e-3),
           limiter_method_(MinUpwindAverage),
           limiter_usage_(DuringComputations),
-          coord_(grid.dimensions),
-          velocity_(grid.dimensions),
           gauss_seidel_tol_(1e-3)
     {
         const int dg_degree = param.getDefault("dg_degree", 0);
@@ -60,6 +172,12 @@ namespace Opm
         }
 
         tracers_ensure_unity_ = param.getDefault("tracers_ensure_unity", true);
+        useLevelScheduling(param.getDefault("use_level_scheduling", false));
+
+        const bool use_basis_tables = param.getDefault("use_basis_tables", false);
+        if (use_basis_tables || param.getDefault("use_quadrature_tables", false)) {
+            setupQuadratureTables(use_basis_tables);
+        }
 
         use_cvi_ = param.getDefault("use_cvi", use_cvi_);
         use_limiter_ = param.getDefault("use_limiter", use_limiter_);
@@ -122,12 +240,7 @@ namespace Opm
         tof_coeff.resize(num_basis*grid_.number_of_cells);
         std::fill(tof_coeff.begin(), tof_coeff.end(), 0.0);
         tof_coeff_ = &tof_coeff[0];
-        rhs_.resize(num_basis);
-        jac_.resize(num_basis*num_basis);
-        orig_jac_.resize(num_basis*num_basis);
-        basis_.resize(num_basis);
-        basis_nb_.resize(num_basis);
-        grad_basis_.resize(num_basis*grid_.dimensions);
+        setupWorkspace(1);
         velocity_interpolation_->setupFluxes(darcyflux);
         num_tracers_ = 0;
         num_multicell_ = 0;
@@ -201,12 +314,7 @@ namespace Opm
         tof_coeff.resize(num_basis*grid_.number_of_cells);
         std::fill(tof_coeff.begin(), tof_coeff.end(), 0.0);
         tof_coeff_ = &tof_coeff[0];
-        rhs_.resize(num_basis*(num_tracers_ + 1));
-        jac_.resize(num_basis*num_basis);
-        orig_jac_.resize(num_basis*num_basis);
-        basis_.resize(num_basis);
-        basis_nb_.resize(num_basis);
-        grad_basis_.resize(num_basis*grid_.dimensions);
+        setupWorkspace(num_tracers_ + 1);
         velocity_interpolation_->setupFluxes(darcyflux);
 
         // Set up tracer
@@ -257,6 +365,100 @@ namespace Opm
 
 
 
+    void TofDiscGalReorder::setupQuadratureTables(const bool with_basis)
+    {
+        const int nc = grid_.number_of_cells;
+        const int nf = grid_.number_of_faces;
+        const int degree = basis_func_->degree();
+        cell_quad_[0] = QuadratureTable<CellQuadrature>(grid_, nc, degree);
+        cell_quad_[1] = QuadratureTable<CellQuadrature>(grid_, nc, 2*degree);
+        face_quad_ = QuadratureTable<FaceQuadrature>(grid_, nf, 2*degree);
+        if (!with_basis) {
+            return;
+        }
+
+        const int num_basis = basis_func_->numBasisFunc();
+        const int dim = grid_.dimensions;
+        cell_basis_[0].resize(num_basis*cell_quad_[0].numQuadPts());
+        cell_basis_[1].resize(num_basis*cell_quad_[1].numQuadPts());
+        cell_grad_basis_.resize(dim*num_basis*cell_quad_[1].numQuadPts());
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (int cell = 0; cell < nc; ++cell) {
+            for (int k = 0; k < 2; ++k) {
+                const QuadratureTable<CellQuadrature>& quad = cell_quad_[k];
+                for (int i = 0; i < quad.numQuadPts(cell); ++i) {
+                    const int pt = quad.pointIndex(cell, i);
+                    basis_func_->eval(cell, quad.quadPtCoord(cell, i), &cell_basis_[k][num_basis*pt]);
+                    if (k == 1) {
+                        basis_func_->evalGrad(cell, quad.quadPtCoord(cell, i),
+                                              &cell_grad_basis_[dim*num_basis*pt]);
+                    }
+                }
+            }
+        }
+        face_basis_.assign(2*num_basis*face_quad_.numQuadPts(), 0.0);
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (int face = 0; face < nf; ++face) {
+            for (int side = 0; side < 2; ++side) {
+                const int cell = grid_.face_cells[2*face + side];
+                if (cell < 0) {
+                    continue;
+                }
+                for (int i = 0; i < face_quad_.numQuadPts(face); ++i) {
+                    const int pt = face_quad_.pointIndex(face, i);
+                    basis_func_->eval(cell, face_quad_.quadPtCoord(face, i),
+                                      &face_basis_[num_basis*(2*pt + side)]);
+                }
+            }
+        }
+    }
+
+
+
+
+    void TofDiscGalReorder::setupWorkspace(const int num_rhs)
+    {
+        const int num_basis = basis_func_->numBasisFunc();
+        const int dim = grid_.dimensions;
+#if defined(_OPENMP)
+        const int num_threads = omp_get_max_threads();
+#else
+        const int num_threads = 1;
+#endif
+        workspace_.resize(num_threads);
+        for (int t = 0; t < num_threads; ++t) {
+            LocalWorkspace& ws = workspace_[t];
+            ws.rhs.resize(num_basis*num_rhs);
+            ws.jac.resize(num_basis*num_basis);
+            ws.orig_rhs.resize(num_basis*num_rhs);
+            ws.orig_jac.resize(num_basis*num_basis);
+            ws.coord.resize(dim);
+            ws.basis.resize(num_basis);
+            ws.basis_nb.resize(num_basis);
+            ws.grad_basis.resize(num_basis*dim);
+            ws.velocity.resize(dim);
+        }
+    }
+
+
+
+
+    TofDiscGalReorder::LocalWorkspace& TofDiscGalReorder::localWorkspace() const
+    {
+#if defined(_OPENMP)
+        return workspace_[omp_get_thread_num()];
+#else
+        return workspace_[0];
+#endif
+    }
+
+
+
+
     void TofDiscGalReorder::solveSingleCell(const int cell)
     {
         // Residual:
@@ -272,29 +474,38 @@ namespace Opm
         // For tracers, the equation is the same, except for the last
         // term being zero (the one with \phi).
         //
-        // The rhs_ vector contains a (Fortran ordering) matrix of all
+        // The ws.rhs vector contains a (Fortran ordering) matrix of all
         // right-hand-sides, first for tof and then (optionally) for
         // all tracers.
+        //
+        // This function may be called concurrently for cells of the
+        // same wavefront, so all scratch data lives in the workspace
+        // of the calling thread, and only this cell's coefficients
+        // are written.
 
         const int num_basis = basis_func_->numBasisFunc();
+#if defined(_OPENMP)
+#pragma omp atomic
+#endif
         ++num_singlesolves_;
 
-        std::fill(rhs_.begin(), rhs_.end(), 0.0);
-        std::fill(jac_.begin(), jac_.end(), 0.0);
+        LocalWorkspace& ws = localWorkspace();
+        std::fill(ws.rhs.begin(), ws.rhs.end(), 0.0);
+        std::fill(ws.jac.begin(), ws.jac.end(), 0.0);
 
-        // Add cell contributions to res_ and jac_.
-        cellContribs(cell);
+        // Add cell contributions to ws.rhs and ws.jac.
+        cellContribs(cell, ws);
 
-        // Add face contributions to res_ and jac_.
-        faceContribs(cell);
+        // Add face contributions to ws.rhs and ws.jac.
+        faceContribs(cell, ws);
 
         // Solve linear equation.
-        solveLinearSystem(cell);
+        solveLinearSystem(cell, ws);
 
-        // The solution ends up in rhs_, so we must copy it.
-        std::copy(rhs_.begin(), rhs_.begin() + num_basis, tof_coeff_ + num_basis*cell);
+        // The solution ends up in ws.rhs, so we must copy it.
+        std::copy(ws.rhs.begin(), ws.rhs.begin() + num_basis, tof_coeff_ + num_basis*cell);
         if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
-            std::copy(rhs_.begin() + num_basis, rhs_.end(), tracer_coeff_ + num_tracers_*num_basis*cell);
+            std::copy(ws.rhs.begin() + num_basis, ws.rhs.end(), tracer_coeff_ + num_tracers_*num_basis*cell);
         }
 
         // Apply limiter.
@@ -331,7 +542,7 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::cellContribs(const int cell)
+    void TofDiscGalReorder::cellContribs(const int cell, LocalWorkspace& ws)
     {
         const int num_basis = basis_func_->numBasisFunc();
         const int dim = grid_.dimensions;
@@ -339,21 +550,26 @@ namespace Opm
         // Compute cell residual contribution.
         {
             const int deg_needed = basis_func_->degree();
-            CellQuadrature quad(grid_, cell, deg_needed);
+            const QuadraturePoints<CellQuadrature> quad(cell_quad_[0], grid_, cell, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // Integral of: b_i \phi
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                const double* coord = quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                const double* basis = &ws.basis[0];
+                if (cell_basis_[0].empty()) {
+                    basis_func_->eval(cell, coord, &ws.basis[0]);
+                } else {
+                    basis = &cell_basis_[0][num_basis*quad.pointIndex(quad_pt)];
+                }
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     // Only adding to the tof rhs.
-                    rhs_[j] += w * basis_[j] * porevolume_[cell] / grid_.cell_volumes[cell];
+                    ws.rhs[j] += w * basis[j] * porevolume_[cell] / grid_.cell_volumes[cell];
                 }
             }
         }
 
         // Compute cell jacobian contribution. We use Fortran ordering
-        // for jac_, i.e. rows cycling fastest.
+        // for ws.jac, i.e. rows cycling fastest.
         {
             // Even with ECVI velocity interpolation, degree of precision 1
             // is sufficient for optimal convergence order for DG1 when we
@@ -365,18 +581,26 @@ namespace Opm
             // though this is wasteful for the pure linear basis functions.
             // const int deg_needed = 2*basis_func_->degree() - 1;
             const int deg_needed = 2*basis_func_->degree();
-            CellQuadrature quad(grid_, cell, deg_needed);
+            const QuadraturePoints<CellQuadrature> quad(cell_quad_[1], grid_, cell, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // b_i (v \cdot \grad b_j)
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
-                basis_func_->evalGrad(cell, &coord_[0], &grad_basis_[0]);
-                velocity_interpolation_->interpolate(cell, &coord_[0], &velocity_[0]);
+                const double* coord = quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                const double* basis = &ws.basis[0];
+                const double* grad_basis = &ws.grad_basis[0];
+                if (cell_basis_[1].empty()) {
+                    basis_func_->eval(cell, coord, &ws.basis[0]);
+                    basis_func_->evalGrad(cell, coord, &ws.grad_basis[0]);
+                } else {
+                    const int pt = quad.pointIndex(quad_pt);
+                    basis = &cell_basis_[1][num_basis*pt];
+                    grad_basis = &cell_grad_basis_[dim*num_basis*pt];
+                }
+                velocity_interpolation_->interpolate(cell, coord, &ws.velocity[0]);
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
                         for (int dd = 0; dd < dim; ++dd) {
-                            jac_[j*num_basis + i] -= w * basis_[j] * grad_basis_[dim*i + dd] * velocity_[dd];
+                            ws.jac[j*num_basis + i] -= w * basis[j] * grad_basis[dim*i + dd] * ws.velocity[dd];
                         }
                     }
                 }
@@ -394,14 +618,19 @@ namespace Opm
             const double flux_density = flux / grid_.cell_volumes[cell];
             // Do quadrature over the cell to compute
             // \int_{K} b_i flux b_j dx
-            CellQuadrature quad(grid_, cell, 2*basis_func_->degree());
+            const QuadraturePoints<CellQuadrature> quad(cell_quad_[1], grid_, cell, 2*basis_func_->degree());
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                const double* coord = quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                const double* basis = &ws.basis[0];
+                if (cell_basis_[1].empty()) {
+                    basis_func_->eval(cell, coord, &ws.basis[0]);
+                } else {
+                    basis = &cell_basis_[1][num_basis*quad.pointIndex(quad_pt)];
+                }
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
-                        jac_[j*num_basis + i] += w * basis_[i] * flux_density * basis_[j];
+                        ws.jac[j*num_basis + i] += w * basis[i] * flux_density * basis[j];
                     }
                 }
             }
@@ -411,7 +640,7 @@ namespace Opm
 
 
 
-    void TofDiscGalReorder::faceContribs(const int cell)
+    void TofDiscGalReorder::faceContribs(const int cell, LocalWorkspace& ws)
     {
         const int num_basis = basis_func_->numBasisFunc();
 
@@ -420,7 +649,8 @@ namespace Opm
             const int face = grid_.cell_faces[hface];
             double flux = 0.0;
             int upstream_cell = -1;
-            if (cell == grid_.face_cells[2*face]) {
+            const int side = cell == grid_.face_cells[2*face] ? 0 : 1;
+            if (side == 0) {
                 flux = darcyflux_[face];
                 upstream_cell = grid_.face_cells[2*face+1];
             } else {
@@ -446,25 +676,33 @@ namespace Opm
             // for higher order than DG1).
             const double normal_velocity = flux / grid_.face_areas[face];
             const int deg_needed = 2*basis_func_->degree();
-            FaceQuadrature quad(grid_, face, deg_needed);
+            const QuadraturePoints<FaceQuadrature> quad(face_quad_, grid_, face, deg_needed);
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
-                basis_func_->eval(upstream_cell, &coord_[0], &basis_nb_[0]);
+                const double* coord = quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                const double* basis = &ws.basis[0];
+                const double* basis_nb = &ws.basis_nb[0];
+                if (face_basis_.empty()) {
+                    basis_func_->eval(cell, coord, &ws.basis[0]);
+                    basis_func_->eval(upstream_cell, coord, &ws.basis_nb[0]);
+                } else {
+                    const int pt = quad.pointIndex(quad_pt);
+                    basis = &face_basis_[num_basis*(2*pt + side)];
+                    basis_nb = &face_basis_[num_basis*(2*pt + 1 - side)];
+                }
                 const double w = quad.quadPtWeight(quad_pt);
                 // Modify tof rhs
-                const double tof_upstream = std::inner_product(basis_nb_.begin(), basis_nb_.end(),
+                const double tof_upstream = std::inner_product(basis_nb, basis_nb + num_basis,
                                                                tof_coeff_ + num_basis*upstream_cell, 0.0);
                 for (int j = 0; j < num_basis; ++j) {
-                    rhs_[j] -= w * tof_upstream * normal_velocity * basis_[j];
+                    ws.rhs[j] -= w * tof_upstream * normal_velocity * basis[j];
                 }
                 // Modify tracer rhs
                 if (num_tracers_ && tracerhead_by_cell_[cell] == NoTracerHead) {
                     for (int tr = 0; tr < num_tracers_; ++tr) {
                         const double* up_tr_co = tracer_coeff_ + num_tracers_*num_basis*upstream_cell + num_basis*tr;
-                        const double tracer_up = std::inner_product(basis_nb_.begin(), basis_nb_.end(), up_tr_co, 0.0);
+                        const double tracer_up = std::inner_product(basis_nb, basis_nb + num_basis, up_tr_co, 0.0);
                         for (int j = 0; j < num_basis; ++j) {
-                            rhs_[num_basis*(tr + 1) + j] -= w * tracer_up * normal_velocity * basis_[j];
+                            ws.rhs[num_basis*(tr + 1) + j] -= w * tracer_up * normal_velocity * basis[j];
                         }
                     }
                 }
@@ -475,7 +713,8 @@ namespace Opm
         for (int hface = grid_.cell_facepos[cell]; hface < grid_.cell_facepos[cell+1]; ++hface) {
             const int face = grid_.cell_faces[hface];
             double flux = 0.0;
-            if (cell == grid_.face_cells[2*face]) {
+            const int side = cell == grid_.face_cells[2*face] ? 0 : 1;
+            if (side == 0) {
                 flux = darcyflux_[face];
             } else {
                 flux = -darcyflux_[face];
@@ -487,15 +726,20 @@ namespace Opm
             // Do quadrature over the face to compute
             // \int_{\partial K} b_i (v(x) \cdot n) b_j ds
             const double normal_velocity = flux / grid_.face_areas[face];
-            FaceQuadrature quad(grid_, face, 2*basis_func_->degree());
+            const QuadraturePoints<FaceQuadrature> quad(face_quad_, grid_, face, 2*basis_func_->degree());
             for (int quad_pt = 0; quad_pt < quad.numQuadPts(); ++quad_pt) {
                 // u^ext flux B   (B = {b_j})
-                quad.quadPtCoord(quad_pt, &coord_[0]);
-                basis_func_->eval(cell, &coord_[0], &basis_[0]);
+                const double* coord = quad.quadPtCoord(quad_pt, &ws.coord[0]);
+                const double* basis = &ws.basis[0];
+                if (face_basis_.empty()) {
+                    basis_func_->eval(cell, coord, &ws.basis[0]);
+                } else {
+                    basis = &face_basis_[num_basis*(2*quad.pointIndex(quad_pt) + side)];
+                }
                 const double w = quad.quadPtWeight(quad_pt);
                 for (int j = 0; j < num_basis; ++j) {
                     for (int i = 0; i < num_basis; ++i) {
-                        jac_[j*num_basis + i] += w * basis_[i] * normal_velocity * basis_[j];
+                        ws.jac[j*num_basis + i] += w * basis[i] * normal_velocity * basis[j];
                     }
                 }
             }
@@ -504,11 +748,13 @@ namespace Opm
 
 
 
-    // This function assumes that jac_ and rhs_ contain the
-    // linear system to be solved. They are stored in orig_jac_
-    // and orig_rhs_, then the system is solved via LAPACK,
-    // overwriting the input data (jac_ and rhs_).
-    void TofDiscGalReorder::solveLinearSystem(const int cell)
+    // This function assumes that ws.jac and ws.rhs contain the
+    // linear system to be solved. They are stored in ws.orig_jac
+    // and ws.orig_rhs, then the system is solved, overwriting the
+    // input data (ws.jac and ws.rhs). Systems with 4 or 8 unknowns
+    // (the DG1 systems in 3d) are solved by the fixed-size
+    // elimination above, all other systems by LAPACK.
+    void TofDiscGalReorder::solveLinearSystem(const int cell, LocalWorkspace& ws)
     {
         MAT_SIZE_T n = basis_func_->numBasisFunc();
         int num_tracer_to_compute = num_tracers_;
@@ -522,22 +768,31 @@ namespace Opm
         std::vector<MAT_SIZE_T> piv(n);
         MAT_SIZE_T ldb = n;
         MAT_SIZE_T info = 0;
-        orig_jac_ = jac_;
-        orig_rhs_ = rhs_;
-        dgesv_(&n, &nrhs, &jac_[0], &lda, &piv[0], &rhs_[0], &ldb, &info);
+        ws.orig_jac = ws.jac;
+        ws.orig_rhs = ws.rhs;
+        switch (n) {
+        case 4:
+            info = solveFixedSize<4>(&ws.jac[0], &ws.rhs[0], nrhs);
+            break;
+        case 8:
+            info = solveFixedSize<8>(&ws.jac[0], &ws.rhs[0], nrhs);
+            break;
+        default:
+            dgesv_(&n, &nrhs, &ws.jac[0], &lda, &piv[0], &ws.rhs[0], &ldb, &info);
+        }
         if (info != 0) {
             // Print the local matrix and rhs.
             std::cerr << "Failed solving single-cell system Ax = b in cell " << cell
                       << " with A = \n";
             for (int row = 0; row < n; ++row) {
                 for (int col = 0; col < n; ++col) {
-                    std::cerr << "    " << orig_jac_[row + n*col];
+                    std::cerr << "    " << ws.orig_jac[row + n*col];
                 }
                 std::cerr << '\n';
             }
             std::cerr << "and b = \n";
             for (int row = 0; row < n; ++row) {
-                std::cerr << "    " << orig_rhs_[row] << '\n';
+                std::cerr << "    " << ws.orig_rhs[row] << '\n';
             }
             OPM_THROW(std::runtime_error, "Lapack error: " << info << " encountered in cell " << cell);
         }
@@ -747,11 +1002,12 @@ namespace Opm
         // Evaluate the solution in all corners.
         const int dim = grid_.dimensions;
         const int num_basis = basis_func_->numBasisFunc();
+        std::vector<double>& basis = localWorkspace().basis;
         double min_cornerval = 1e100;
         for (int fnode = grid_.face_nodepos[face]; fnode < grid_.face_nodepos[face+1]; ++fnode) {
             const double* nc = grid_.node_coordinates + dim*grid_.face_nodes[fnode];
-            basis_func_->eval(cell, nc, &basis_[0]);
-            const double tof_corner = std::inner_product(basis_.begin(), basis_.end(),
+            basis_func_->eval(cell, nc, &basis[0]);
+            const double tof_corner = std::inner_product(basis.begin(), basis.end(),
                                                          tof_coeff_ + num_basis*cell, 0.0);
             min_cornerval = std::min(min_cornerval, tof_corner);
         }
@@ -765,14 +1021,15 @@ namespace Opm
         // Evaluate the solution in all corners of all faces. Extract max and min.
         const int dim = grid_.dimensions;
         const int num_basis = basis_func_->numBasisFunc();
+        std::vector<double>& basis = localWorkspace().basis;
         double min_cornerval = 1e100;
         double max_cornerval = -1e100;
         for (int hface = grid_.cell_facepos[cell]; hface < grid_.cell_facepos[cell+1]; ++hface) {
             const int face = grid_.cell_faces[hface];
             for (int fnode = grid_.face_nodepos[face]; fnode < grid_.face_nodepos[face+1]; ++fnode) {
                 const double* nc = grid_.node_coordinates + dim*grid_.face_nodes[fnode];
-                basis_func_->eval(cell, nc, &basis_[0]);
-                const double tracer_corner = std::inner_product(basis_.begin(), basis_.end(),
+                basis_func_->eval(cell, nc, &basis[0]);
+                const double tracer_corner = std::inner_product(basis.begin(), basis.end(),
                                                                 local_coeff, 0.0);
                 min_cornerval = std::min(min_cornerval, tracer_corner);
                 max_cornerval = std::max(min_cornerval, tracer_corner);
@@ -21,6 +21,7 @@
 #define OPM_TOFDISCGALREORDER_HEADER_INCLUDED
 
 #include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
+#include <opm/core/grid/QuadratureTable.hpp>
 #include <memory>
 #include <vector>
 #include <map>
@@ -34,6 +35,8 @@ namespace Opm
     class IncompPropertiesInterface;
     class VelocityInterpolationInterface;
     class DGBasisInterface;
+    class CellQuadrature;
+    class FaceQuadrature;
     namespace parameter { class ParameterGroup; }
     template <typename T> class SparseTable;
 
@@ -71,6 +74,15 @@ namespace Opm
         ///                                             computing (unlimited) solution.
         ///             - AsSimultaneousPostProcess  -- Apply to each cell independently, using un-
         ///                                             limited solution in neighbouring cells.
+        ///   - \c use_level_scheduling (false)           -- Solve independent single-cell components of each
+        ///                                                   wavefront concurrently (see ReorderSolverInterface).
+        ///   - \c use_quadrature_tables (false)          -- Precompute the quadrature points and weights of all
+        ///                                                   cells and faces once (see QuadratureTable), instead
+        ///                                                   of in every solve. Saves time in repeated solves at
+        ///                                                   the cost of memory.
+        ///   - \c use_basis_tables (false)               -- Also precompute the basis functions and their
+        ///                                                   gradients at all quadrature points. Implies
+        ///                                                   use_quadrature_tables.
         TofDiscGalReorder(const UnstructuredGrid& grid,
                           const parameter::ParameterGroup& param);
 
@@ -121,9 +133,28 @@ namespace Opm
         virtual void solveSingleCell(const int cell);
         virtual void solveMultiCell(const int num_cells, const int* cells);
 
-        void cellContribs(const int cell);
-        void faceContribs(const int cell);
-        void solveLinearSystem(const int cell);
+        // Scratch space for assembling and solving a single-cell system.
+        // There is one instance per thread, so that single-cell
+        // components may be solved concurrently.
+        struct LocalWorkspace
+        {
+            std::vector<double> rhs;        // single-cell right-hand-sides
+            std::vector<double> jac;        // single-cell jacobian
+            std::vector<double> orig_rhs;   // single-cell right-hand-sides (copy)
+            std::vector<double> orig_jac;   // single-cell jacobian (copy)
+            std::vector<double> coord;
+            std::vector<double> basis;
+            std::vector<double> basis_nb;
+            std::vector<double> grad_basis;
+            std::vector<double> velocity;
+        };
+
+        void setupQuadratureTables(const bool with_basis);
+        void setupWorkspace(const int num_rhs);
+        LocalWorkspace& localWorkspace() const;
+        void cellContribs(const int cell, LocalWorkspace& ws);
+        void faceContribs(const int cell, LocalWorkspace& ws);
+        void solveLinearSystem(const int cell, LocalWorkspace& ws);
 
     private:
         // Disable copying and assignment.
@@ -144,6 +175,17 @@ namespace Opm
         const double* porevolume_;  // one volume per cell
         const double* source_;      // one volumetric source term per cell
         std::shared_ptr<DGBasisInterface> basis_func_;
+        // Precomputed quadratures, used if non-empty. Cell quadratures
+        // have degree of precision D (index 0) and 2*D (index 1) for
+        // basis degree D, face quadratures 2*D.
+        QuadratureTable<CellQuadrature> cell_quad_[2];
+        QuadratureTable<FaceQuadrature> face_quad_;
+        // Basis values at the quadrature points, used if non-empty.
+        // Face points hold the basis of both face cells, first that of
+        // face_cells[2*face], then that of face_cells[2*face + 1].
+        std::vector<double> cell_basis_[2];
+        std::vector<double> cell_grad_basis_;   // at cell_quad_[1] points
+        std::vector<double> face_basis_;
         double* tof_coeff_;
         // For tracers.
         double* tracer_coeff_;
@@ -152,15 +194,7 @@ namespace Opm
         std::vector<int> tracerhead_by_cell_;
         bool tracers_ensure_unity_;
         // Used by solveSingleCell().
-        std::vector<double> rhs_;   // single-cell right-hand-sides
-        std::vector<double> jac_;   // single-cell jacobian
-        std::vector<double> orig_rhs_;   // single-cell right-hand-sides (copy)
-        std::vector<double> orig_jac_;   // single-cell jacobian (copy)
-        std::vector<double> coord_;
-        mutable std::vector<double> basis_;
-        mutable std::vector<double> basis_nb_;
-        std::vector<double> grad_basis_;
-        std::vector<double> velocity_;
+        mutable std::vector<LocalWorkspace> workspace_;   // one per thread
         int num_singlesolves_;
         // Used by solveMultiCell():
         double gauss_seidel_tol_;
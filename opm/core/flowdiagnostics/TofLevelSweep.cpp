@@ -0,0 +1,228 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/flowdiagnostics/TofLevelSweep.hpp>
+#include <opm/core/grid.h>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm
+{
+
+
+    /// Construct solver.
+    /// \param[in] grid      A 2d or 3d grid.
+    TofLevelSweep::TofLevelSweep(const UnstructuredGrid& grid)
+        : grid_(grid),
+          porevolume_(0),
+          source_(0),
+          tof_(0),
+          tracer_(0),
+          num_tracers_(0),
+          gauss_seidel_tol_(1e-3)
+    {
+        useLevelScheduling(true);
+        const int num_cells = grid.number_of_cells;
+        const int num_hf = grid.cell_facepos[num_cells];
+        hf_pos_.assign(grid.cell_facepos, grid.cell_facepos + num_cells + 1);
+        hf_face_.assign(grid.cell_faces, grid.cell_faces + num_hf);
+        hf_other_.resize(num_hf);
+        hf_sign_.resize(num_hf);
+        hf_flux_.resize(num_hf);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            for (int i = hf_pos_[cell]; i < hf_pos_[cell + 1]; ++i) {
+                const int f = hf_face_[i];
+                const bool first = (cell == grid.face_cells[2*f]);
+                hf_other_[i] = grid.face_cells[2*f + (first ? 1 : 0)];
+                hf_sign_[i] = first ? 1.0 : -1.0;
+            }
+        }
+    }
+
+
+
+
+    /// Solve for time-of-flight.
+    void TofLevelSweep::solveTof(const double* darcyflux,
+                                 const double* porevolume,
+                                 const double* source,
+                                 std::vector<double>& tof)
+    {
+        porevolume_ = porevolume;
+        source_ = source;
+        tof.assign(grid_.number_of_cells, 0.0);
+        tof_ = tof.data();
+        num_tracers_ = 0;
+        tracer_ = 0;
+        sweep(darcyflux);
+        tof_ = 0;
+    }
+
+
+
+
+    /// Solve for time-of-flight and a number of tracers.
+    void TofLevelSweep::solveTofTracer(const double* darcyflux,
+                                       const double* porevolume,
+                                       const double* source,
+                                       const SparseTable<int>& tracerheads,
+                                       std::vector<double>& tof,
+                                       std::vector<double>& tracer)
+    {
+        const int num_cells = grid_.number_of_cells;
+        const int num_tracers = tracerheads.size();
+        porevolume_ = porevolume;
+        source_ = source;
+        tof.assign(num_cells, 0.0);
+        tof_ = tof.data();
+        tracer.assign(num_cells*num_tracers, 0.0);
+        is_head_.assign(num_cells, 0);
+        for (int tr = 0; tr < num_tracers; ++tr) {
+            for (unsigned int i = 0; i < tracerheads[tr].size(); ++i) {
+                const int cell = tracerheads[tr][i];
+                tracer[num_tracers * cell + tr] = 1.0;
+                is_head_[cell] = 1;
+            }
+        }
+        num_tracers_ = num_tracers;
+        tracer_ = tracer.data();
+        sweep(darcyflux);
+        tof_ = 0;
+        tracer_ = 0;
+        num_tracers_ = 0;
+    }
+
+
+
+
+    // Gather the half-face fluxes, order the cells and solve one
+    // level after another. The components of a level only read
+    // values of earlier levels and only write their own cells, so
+    // all of them may be solved at once.
+    void TofLevelSweep::sweep(const double* darcyflux)
+    {
+        const int num_hf = hf_face_.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < num_hf; ++i) {
+            hf_flux_[i] = hf_sign_[i]*darcyflux[hf_face_[i]];
+        }
+
+        reorder(grid_, darcyflux);
+        const std::vector<int>& seq = sequence();
+        const std::vector<int>& comps = components();
+        const std::vector<int>& lev = levels();
+        const std::vector<int>& lev_comps = levelComponents();
+        const int num_levels = lev.size() - 1;
+        for (int level = 0; level < num_levels; ++level) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+            for (int i = lev[level]; i < lev[level + 1]; ++i) {
+                const int comp = lev_comps[i];
+                const int comp_size = comps[comp + 1] - comps[comp];
+                if (comp_size == 1) {
+                    solveSingleCell(seq[comps[comp]]);
+                } else {
+                    solveMultiCell(comp_size, &seq[comps[comp]]);
+                }
+            }
+        }
+    }
+
+
+
+
+    // Compute tof and tracers of a cell from its upwind neighbours,
+    // as in TofReorder, and return the largest change of any value.
+    double TofLevelSweep::updateCell(const int cell) const
+    {
+        // Sources have zero tof, and therefore do not contribute to
+        // the upwind term, whereas sinks are added to the downwind
+        // flux.
+        double upwind_term = 0.0;
+        double downwind_flux = std::max(-source_[cell], 0.0);
+        for (int i = hf_pos_[cell]; i < hf_pos_[cell + 1]; ++i) {
+            const double flux = hf_flux_[i];
+            if (flux < 0.0) {
+                const int other = hf_other_[i];
+                if (other != -1) {
+                    upwind_term += flux*tof_[other];
+                }
+            } else {
+                downwind_flux += flux;
+            }
+        }
+        const double tof = (porevolume_[cell] - upwind_term)/downwind_flux;
+        double max_delta = std::fabs(tof - tof_[cell]);
+        tof_[cell] = tof;
+
+        // Tracers have zero pore volume. Tracer heads keep their values.
+        const int nt = num_tracers_;
+        if (nt == 0 || is_head_[cell]) {
+            return max_delta;
+        }
+        double* t = tracer_ + nt*cell;
+        for (int tr = 0; tr < nt; ++tr) {
+            double upwind_tracer = 0.0;
+            for (int i = hf_pos_[cell]; i < hf_pos_[cell + 1]; ++i) {
+                const double flux = hf_flux_[i];
+                const int other = hf_other_[i];
+                if (flux < 0.0 && other != -1) {
+                    upwind_tracer += flux*tracer_[nt*other + tr];
+                }
+            }
+            const double value = (0.0 - upwind_tracer)/downwind_flux;
+            max_delta = std::max(max_delta, std::fabs(value - t[tr]));
+            t[tr] = value;
+        }
+        return max_delta;
+    }
+
+
+
+
+    void TofLevelSweep::solveSingleCell(const int cell)
+    {
+        updateCell(cell);
+    }
+
+
+
+
+    void TofLevelSweep::solveMultiCell(const int num_cells, const int* cells)
+    {
+        // Using a Gauss-Seidel approach.
+        double max_delta = 1e100;
+        while (max_delta > gauss_seidel_tol_) {
+            max_delta = 0.0;
+            for (int ci = 0; ci < num_cells; ++ci) {
+                max_delta = std::max(max_delta, updateCell(cells[ci]));
+            }
+        }
+    }
+
+
+} // namespace Opm
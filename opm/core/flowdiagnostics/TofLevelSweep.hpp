@@ -0,0 +1,107 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_TOFLEVELSWEEP_HEADER_INCLUDED
+#define OPM_TOFLEVELSWEEP_HEADER_INCLUDED
+
+#include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
+#include <vector>
+
+struct UnstructuredGrid;
+
+namespace Opm
+{
+
+    template <typename T> class SparseTable;
+
+    /// Time-of-flight and tracer solver for repeated evaluations on
+    /// one grid, e.g. in well placement optimisation.  Same
+    /// discretisation as TofReorder without multidimensional upwinding.
+    ///
+    /// The cells are swept level by level (wavefront by wavefront)
+    /// through the DAG of strongly connected components of the upwind
+    /// graph, see ReorderSolverInterface::useLevelScheduling(), and all
+    /// components of a level are solved concurrently (using OpenMP if
+    /// available), including multi-cell ones.  The grid connectivity is
+    /// flattened into half-face arrays once, on construction, and kept
+    /// across calls.  A sweep then reads no grid structures, and each
+    /// call only supplies fluxes, pore volumes and sources.
+    class TofLevelSweep : public ReorderSolverInterface
+    {
+    public:
+        /// Construct solver.
+        /// \param[in] grid      A 2d or 3d grid.
+        explicit TofLevelSweep(const UnstructuredGrid& grid);
+
+        /// Solve for time-of-flight, see TofReorder::solveTof().
+        /// \param[in]  darcyflux         Array of signed face fluxes.
+        /// \param[in]  porevolume        Array of pore volumes.
+        /// \param[in]  source            Source term. Sign convention is:
+        ///                                 (+) inflow flux,
+        ///                                 (-) outflow flux.
+        /// \param[out] tof               Array of time-of-flight values.
+        void solveTof(const double* darcyflux,
+                      const double* porevolume,
+                      const double* source,
+                      std::vector<double>& tof);
+
+        /// Solve for time-of-flight and a number of tracers in a single
+        /// sweep, see TofReorder::solveTofTracer().
+        /// \param[in]  darcyflux         Array of signed face fluxes.
+        /// \param[in]  porevolume        Array of pore volumes.
+        /// \param[in]  source            Source term, as for solveTof().
+        /// \param[in]  tracerheads       Table containing one row per tracer, and each
+        ///                               row contains the source cells for that tracer.
+        /// \param[out] tof               Array of time-of-flight values (1 per cell).
+        /// \param[out] tracer            Array of tracer values. N per cell, where N is
+        ///                               equal to tracerheads.size().
+        void solveTofTracer(const double* darcyflux,
+                            const double* porevolume,
+                            const double* source,
+                            const SparseTable<int>& tracerheads,
+                            std::vector<double>& tof,
+                            std::vector<double>& tracer);
+
+    private:
+        void sweep(const double* darcyflux);
+        double updateCell(const int cell) const;
+        virtual void solveSingleCell(const int cell);
+        virtual void solveMultiCell(const int num_cells, const int* cells);
+
+        const UnstructuredGrid& grid_;
+        // Half-face connectivity, in the order of grid.cell_faces.
+        std::vector<int> hf_pos_;
+        std::vector<int> hf_face_;
+        std::vector<int> hf_other_;     // -1 on the boundary
+        std::vector<double> hf_sign_;   // +1 if the face points out of the cell
+        // Data of the current call.
+        std::vector<double> hf_flux_;   // outward half-face fluxes
+        const double* porevolume_;      // one volume per cell
+        const double* source_;          // one volumetric source term per cell
+        double* tof_;
+        double* tracer_;                // num_tracers_ per cell
+        int num_tracers_;
+        std::vector<char> is_head_;
+        double gauss_seidel_tol_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_TOFLEVELSWEEP_HEADER_INCLUDED
@@ -42,8 +42,12 @@ namespace Opm
           porevolume_(0),
           source_(0),
           tof_(0),
+          batch_tracers_(false),
+          num_tracers_(0),
+          tracer_(0),
           gauss_seidel_tol_(1e-3),
-          use_multidim_upwind_(use_multidim_upwind)
+          use_multidim_upwind_(use_multidim_upwind),
+          update_num_tracers_(-1)
     {
     }
 
@@ -62,6 +66,7 @@ namespace Opm
                               const double* source,
                               std::vector<double>& tof)
     {
+        update_num_tracers_ = -1;
         darcyflux_ = darcyflux;
         porevolume_ = porevolume;
         source_ = source;
@@ -107,6 +112,7 @@ namespace Opm
                                     std::vector<double>& tof,
                                     std::vector<double>& tracer)
     {
+        update_num_tracers_ = -1;
         darcyflux_ = darcyflux;
         porevolume_ = porevolume;
         source_ = source;
@@ -129,10 +135,6 @@ namespace Opm
             std::fill(face_part_tof_.begin(), face_part_tof_.end(), 0.0);
         }
 
-        // Execute solve for tof
-        compute_tracer_ = false;
-        executeSolve();
-
         // Find the tracer heads (injectors).
         const int num_tracers = tracerheads.size();
         tracer.resize(num_cells*num_tracers);
@@ -145,22 +147,45 @@ namespace Opm
             const unsigned int tracerheadsSize = tracerheads[tr].size();
             for (unsigned int i = 0; i < tracerheadsSize; ++i) {
                 const int cell = tracerheads[tr][i];
-                tracer[num_cells * tr + cell] = 1.0;
+                tracer[num_tracers * cell + tr] = 1.0;
                 tracerhead_by_cell_[cell] = tr;
             }
         }
 
-        // Execute solve for tracers.
+        if (!use_multidim_upwind_ && num_tracers > 0) {
+            // Single sweep for tof and all tracers.
+            batch_tracers_ = true;
+            num_tracers_ = num_tracers;
+            tracer_ = tracer.data();
+            tracer_prev_.resize(num_tracers);
+            compute_tracer_ = false;
+            executeSolve();
+            batch_tracers_ = false;
+            tracer_ = 0;
+            return;
+        }
+
+        // Execute solve for tof
+        compute_tracer_ = false;
+        executeSolve();
+
+        // Execute solve for tracers, one at a time in tracer-major
+        // layout.
+        std::vector<double> computed(num_cells*num_tracers);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            for (int tr = 0; tr < num_tracers; ++tr) {
+                computed[num_cells * tr + cell] = tracer[num_tracers * cell + tr];
+            }
+        }
         std::vector<double> fake_pv(num_cells, 0.0);
         porevolume_ = fake_pv.data();
         for (int tr = 0; tr < num_tracers; ++tr) {
-            tof_ = tracer.data() + tr * num_cells;
+            tof_ = computed.data() + tr * num_cells;
             compute_tracer_ = true;
             executeSolve();
         }
 
         // Write output tracer data (transposing the computed data).
-        std::vector<double> computed = tracer;
         for (int cell = 0; cell < num_cells; ++cell) {
             for (int tr = 0; tr < num_tracers; ++tr) {
                 tracer[num_tracers * cell + tr] = computed[num_cells * tr + cell];
@@ -171,6 +196,229 @@ namespace Opm
 
 
 
+    /// Update time-of-flight after a change of fluxes, pore volumes
+    /// or sources.
+    void TofReorder::updateTof(const double* darcyflux,
+                               const double* porevolume,
+                               const double* source,
+                               std::vector<double>& tof)
+    {
+        if (update_num_tracers_ != 0 || int(tof.size()) != grid_.number_of_cells) {
+            solveTof(darcyflux, porevolume, source, tof);
+            buildComponentMap();
+            storeUpdateState(darcyflux, porevolume, source, 0);
+            return;
+        }
+        std::vector<int> changed_cells;
+        const bool reorder_needed = findChangedCells(darcyflux, porevolume, source, changed_cells);
+        darcyflux_ = darcyflux;
+        porevolume_ = porevolume;
+        source_ = source;
+        tof_ = &tof[0];
+        compute_tracer_ = false;
+        executeUpdate(reorder_needed, changed_cells);
+        storeUpdateState(darcyflux, porevolume, source, 0);
+    }
+
+
+
+
+    /// Update time-of-flight and tracers after a change of fluxes,
+    /// pore volumes, sources or tracer heads.
+    void TofReorder::updateTofTracer(const double* darcyflux,
+                                     const double* porevolume,
+                                     const double* source,
+                                     const SparseTable<int>& tracerheads,
+                                     std::vector<double>& tof,
+                                     std::vector<double>& tracer)
+    {
+        const int num_cells = grid_.number_of_cells;
+        const int num_tracers = tracerheads.size();
+        if (num_tracers == 0) {
+            tracer.clear();
+            updateTof(darcyflux, porevolume, source, tof);
+            return;
+        }
+        if (use_multidim_upwind_ || update_num_tracers_ != num_tracers
+            || int(tof.size()) != num_cells || int(tracer.size()) != num_cells*num_tracers) {
+            solveTofTracer(darcyflux, porevolume, source, tracerheads, tof, tracer);
+            buildComponentMap();
+            storeUpdateState(darcyflux, porevolume, source, num_tracers);
+            return;
+        }
+        std::vector<int> changed_cells;
+        const bool reorder_needed = findChangedCells(darcyflux, porevolume, source, changed_cells);
+
+        // Cells that became or ceased to be tracer heads must be
+        // recomputed, with head values reset as in solveTofTracer().
+        std::vector<int> head_by_cell(num_cells, NoTracerHead);
+        for (int tr = 0; tr < num_tracers; ++tr) {
+            for (unsigned int i = 0; i < tracerheads[tr].size(); ++i) {
+                head_by_cell[tracerheads[tr][i]] = tr;
+            }
+        }
+        std::vector<char> head_changed(num_cells, 0);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            if (head_by_cell[cell] != tracerhead_by_cell_[cell]) {
+                head_changed[cell] = 1;
+                changed_cells.push_back(cell);
+                std::fill(&tracer[num_tracers * cell], &tracer[num_tracers * cell] + num_tracers, 0.0);
+            }
+        }
+        for (int tr = 0; tr < num_tracers; ++tr) {
+            for (unsigned int i = 0; i < tracerheads[tr].size(); ++i) {
+                const int cell = tracerheads[tr][i];
+                if (head_changed[cell]) {
+                    tracer[num_tracers * cell + tr] = 1.0;
+                }
+            }
+        }
+        tracerhead_by_cell_.swap(head_by_cell);
+
+        darcyflux_ = darcyflux;
+        porevolume_ = porevolume;
+        source_ = source;
+        tof_ = &tof[0];
+        batch_tracers_ = true;
+        num_tracers_ = num_tracers;
+        tracer_ = tracer.data();
+        tracer_prev_.resize(num_tracers);
+        compute_tracer_ = false;
+        executeUpdate(reorder_needed, changed_cells);
+        batch_tracers_ = false;
+        tracer_ = 0;
+        storeUpdateState(darcyflux, porevolume, source, num_tracers);
+    }
+
+
+
+
+    // Find the cells whose single-cell equations have changed since
+    // the previous update: the cells adjacent to faces with a changed
+    // flux, and the cells with a changed pore volume or source.
+    // Returns true if the ordering must be recomputed, which is the
+    // case if the upwind direction of some changed face is different.
+    bool TofReorder::findChangedCells(const double* darcyflux,
+                                      const double* porevolume,
+                                      const double* source,
+                                      std::vector<int>& changed_cells) const
+    {
+        bool reorder_needed = false;
+        for (int f = 0; f < grid_.number_of_faces; ++f) {
+            if (darcyflux[f] != prev_flux_[f]) {
+                const int old_dir = (prev_flux_[f] > 0.0) - (prev_flux_[f] < 0.0);
+                const int new_dir = (darcyflux[f] > 0.0) - (darcyflux[f] < 0.0);
+                if (old_dir != new_dir) {
+                    reorder_needed = true;
+                }
+                for (int j = 0; j < 2; ++j) {
+                    const int cell = grid_.face_cells[2*f + j];
+                    if (cell >= 0) {
+                        changed_cells.push_back(cell);
+                    }
+                }
+            }
+        }
+        for (int cell = 0; cell < grid_.number_of_cells; ++cell) {
+            if (porevolume[cell] != prev_porevolume_[cell] || source[cell] != prev_source_[cell]) {
+                changed_cells.push_back(cell);
+            }
+        }
+        return reorder_needed;
+    }
+
+
+
+
+    // Recompute the components downstream of the changed cells. A cell
+    // outside this cone has unchanged equations and upwind values, so
+    // its previous solution is still valid.
+    void TofReorder::executeUpdate(const bool reorder_needed,
+                                   const std::vector<int>& changed_cells)
+    {
+        if (reorder_needed) {
+            reorder(grid_, darcyflux_);
+            buildComponentMap();
+        }
+        const std::vector<int>& seq = sequence();
+        const std::vector<int>& comps = components();
+
+        // Mark the cone, including all cells of each component it
+        // touches. The marks are cleared again below.
+        std::vector<int> stack(changed_cells);
+        std::vector<int> cone;
+        while (!stack.empty()) {
+            const int start_cell = stack.back();
+            stack.pop_back();
+            if (in_cone_[start_cell]) {
+                continue;
+            }
+            const int comp = comp_of_cell_[start_cell];
+            for (int i = comps[comp]; i < comps[comp + 1]; ++i) {
+                const int cell = seq[i];
+                in_cone_[cell] = 1;
+                cone.push_back(cell);
+                for (int j = grid_.cell_facepos[cell]; j < grid_.cell_facepos[cell+1]; ++j) {
+                    const int f = grid_.cell_faces[j];
+                    const bool first = (cell == grid_.face_cells[2*f]);
+                    const double outflux = first ? darcyflux_[f] : -darcyflux_[f];
+                    const int other = grid_.face_cells[2*f + (first ? 1 : 0)];
+                    if (outflux > 0.0 && other >= 0 && !in_cone_[other]) {
+                        stack.push_back(other);
+                    }
+                }
+            }
+        }
+
+        std::vector<int> cone_comps;
+        cone_comps.reserve(cone.size());
+        for (std::vector<int>::const_iterator it = cone.begin(); it != cone.end(); ++it) {
+            cone_comps.push_back(comp_of_cell_[*it]);
+            in_cone_[*it] = 0;
+        }
+        std::sort(cone_comps.begin(), cone_comps.end());
+        cone_comps.erase(std::unique(cone_comps.begin(), cone_comps.end()), cone_comps.end());
+
+        num_multicell_ = 0;
+        max_size_multicell_ = 0;
+        max_iter_multicell_ = 0;
+        solveComponents(cone_comps.size(), cone_comps.data());
+    }
+
+
+
+
+    void TofReorder::buildComponentMap()
+    {
+        const std::vector<int>& seq = sequence();
+        const std::vector<int>& comps = components();
+        const int num_comps = comps.size() - 1;
+        comp_of_cell_.resize(grid_.number_of_cells);
+        for (int comp = 0; comp < num_comps; ++comp) {
+            for (int i = comps[comp]; i < comps[comp + 1]; ++i) {
+                comp_of_cell_[seq[i]] = comp;
+            }
+        }
+        in_cone_.assign(grid_.number_of_cells, 0);
+    }
+
+
+
+
+    void TofReorder::storeUpdateState(const double* darcyflux,
+                                      const double* porevolume,
+                                      const double* source,
+                                      const int num_tracers)
+    {
+        prev_flux_.assign(darcyflux, darcyflux + grid_.number_of_faces);
+        prev_porevolume_.assign(porevolume, porevolume + grid_.number_of_cells);
+        prev_source_.assign(source, source + grid_.number_of_cells);
+        update_num_tracers_ = num_tracers;
+    }
+
+
+
+
     void TofReorder::executeSolve()
     {
         num_multicell_ = 0;
@@ -188,6 +436,10 @@ namespace Opm
 
     void TofReorder::solveSingleCell(const int cell)
     {
+        if (batch_tracers_) {
+            solveSingleCellBatched(cell);
+            return;
+        }
         if (use_multidim_upwind_) {
             solveSingleCellMultidimUpwind(cell);
             return;
@@ -236,6 +488,60 @@ namespace Opm
 
 
 
+    // As solveSingleCell(), but also computes all tracers of the cell,
+    // which are then stored contiguously in tracer_.  Tracer values have
+    // zero pore volume and are accumulated in place, so that each face is
+    // visited once and no shared work space is needed.
+    void TofReorder::solveSingleCellBatched(const int cell)
+    {
+        const bool is_head = tracerhead_by_cell_[cell] != NoTracerHead;
+        const int nt = num_tracers_;
+        double* t = tracer_ + nt*cell;
+        if (!is_head) {
+            std::fill(t, t + nt, 0.0);
+        }
+        double upwind_term = 0.0;
+        double downwind_flux = std::max(-source_[cell], 0.0);
+        for (int i = grid_.cell_facepos[cell]; i < grid_.cell_facepos[cell+1]; ++i) {
+            int f = grid_.cell_faces[i];
+            double flux;
+            int other;
+            // Compute cell flux
+            if (cell == grid_.face_cells[2*f]) {
+                flux  = darcyflux_[f];
+                other = grid_.face_cells[2*f+1];
+            } else {
+                flux  =-darcyflux_[f];
+                other = grid_.face_cells[2*f];
+            }
+            // Add flux to upwind terms or downwind_flux
+            if (flux < 0.0) {
+                if (other != -1) {
+                    upwind_term += flux*tof_[other];
+                    if (!is_head) {
+                        const double* t_up = tracer_ + nt*other;
+                        for (int tr = 0; tr < nt; ++tr) {
+                            t[tr] += flux*t_up[tr];
+                        }
+                    }
+                }
+            } else {
+                downwind_flux += flux;
+            }
+        }
+
+        // Compute tof and tracers.
+        tof_[cell] = (porevolume_[cell] - upwind_term)/downwind_flux;
+        if (!is_head) {
+            for (int tr = 0; tr < nt; ++tr) {
+                t[tr] = (0.0 - t[tr])/downwind_flux;
+            }
+        }
+    }
+
+
+
+
     void TofReorder::solveSingleCellMultidimUpwind(const int cell)
     {
         // Compute flux terms.
@@ -317,8 +623,18 @@ namespace Opm
             for (int ci = 0; ci < num_cells; ++ci) {
                 const int cell = cells[ci];
                 const double tof_before = tof_[cell];
+                if (batch_tracers_) {
+                    const double* t = tracer_ + num_tracers_*cell;
+                    std::copy(t, t + num_tracers_, tracer_prev_.begin());
+                }
                 solveSingleCell(cell);
                 max_delta = std::max(max_delta, std::fabs(tof_[cell] - tof_before));
+                if (batch_tracers_) {
+                    const double* t = tracer_ + num_tracers_*cell;
+                    for (int tr = 0; tr < num_tracers_; ++tr) {
+                        max_delta = std::max(max_delta, std::fabs(t[tr] - tracer_prev_[tr]));
+                    }
+                }
             }
             // std::cout << "Max delta = " << max_delta << std::endl;
         }
@@ -72,6 +72,9 @@ namespace Opm
         /// \param[out] tof               Array of time-of-flight values (1 per cell).
         /// \param[out] tracer            Array of tracer values. N per cell, where N is
         ///                               equalt to tracerheads.size().
+        /// Without multidimensional upwinding, time-of-flight and all
+        /// tracers are computed in a single reordered sweep, updating
+        /// the N contiguous tracer values of each cell together.
         void solveTofTracer(const double* darcyflux,
                             const double* porevolume,
                             const double* source,
@@ -79,10 +82,57 @@ namespace Opm
                             std::vector<double>& tof,
                             std::vector<double>& tracer);
 
+        /// Update time-of-flight after a change of fluxes, pore volumes
+        /// or sources. Only the components downstream of changed data
+        /// are recomputed, reusing the ordering of the previous call
+        /// unless the direction of some changed flux is different.
+        /// The first call (or a call after solveTof() or
+        /// solveTofTracer()) does a full solve.
+        /// \param[in]     darcyflux    Array of signed face fluxes.
+        /// \param[in]     porevolume   Array of pore volumes.
+        /// \param[in]     source       Source term, as for solveTof().
+        /// \param[in,out] tof          Array of time-of-flight values. Must
+        ///                             contain the result of the previous
+        ///                             call to updateTof().
+        void updateTof(const double* darcyflux,
+                       const double* porevolume,
+                       const double* source,
+                       std::vector<double>& tof);
+
+        /// Update time-of-flight and tracers, as updateTof(). Changed
+        /// tracer heads are also taken into account. With
+        /// multidimensional upwinding, a full solve is done.
+        /// \param[in]     darcyflux    Array of signed face fluxes.
+        /// \param[in]     porevolume   Array of pore volumes.
+        /// \param[in]     source       Source term, as for solveTof().
+        /// \param[in]     tracerheads  Tracer source cells, as for solveTofTracer().
+        /// \param[in,out] tof          Array of time-of-flight values. Must
+        ///                             contain the result of the previous
+        ///                             call to updateTofTracer().
+        /// \param[in,out] tracer       Array of tracer values, as for tof.
+        void updateTofTracer(const double* darcyflux,
+                             const double* porevolume,
+                             const double* source,
+                             const SparseTable<int>& tracerheads,
+                             std::vector<double>& tof,
+                             std::vector<double>& tracer);
+
     private:
         void executeSolve();
+        bool findChangedCells(const double* darcyflux,
+                              const double* porevolume,
+                              const double* source,
+                              std::vector<int>& changed_cells) const;
+        void executeUpdate(const bool reorder_needed,
+                           const std::vector<int>& changed_cells);
+        void buildComponentMap();
+        void storeUpdateState(const double* darcyflux,
+                              const double* porevolume,
+                              const double* source,
+                              const int num_tracers);
         virtual void solveSingleCell(const int cell);
         void solveSingleCellMultidimUpwind(const int cell);
+        void solveSingleCellBatched(const int cell);
         void assembleSingleCell(const int cell,
                                 std::vector<int>& local_column,
                                 std::vector<double>& local_coefficient,
@@ -103,6 +153,11 @@ namespace Opm
         bool compute_tracer_;
         enum { NoTracerHead = -1 };
         std::vector<int> tracerhead_by_cell_;
+        // For batched tracer solves, cell-major layout.
+        bool batch_tracers_;
+        int num_tracers_;
+        double* tracer_;
+        std::vector<double> tracer_prev_;
         // For solveMultiCell():
         double gauss_seidel_tol_;
         int num_multicell_;
@@ -112,6 +167,13 @@ namespace Opm
         bool use_multidim_upwind_;
         std::vector<double> face_tof_;       // For multidim upwind face tofs.
         std::vector<double> face_part_tof_;  // For multidim upwind face tofs.
+        // For updateTof() and updateTofTracer():
+        int update_num_tracers_;             // -1 if no previous update.
+        std::vector<double> prev_flux_;
+        std::vector<double> prev_porevolume_;
+        std::vector<double> prev_source_;
+        std::vector<int> comp_of_cell_;
+        std::vector<char> in_cone_;
     };
 
 } // namespace Opm
@@ -22,6 +22,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * \file
@@ -57,6 +58,7 @@ struct UnstructuredGrid
     int    *global_cell;
     int     cartdims[3];
     int    *cell_facetag;
+    void   *mapping;
 };
 
 void destroy_grid(struct UnstructuredGrid *g);
@@ -75,6 +77,20 @@ allocate_grid(size_t ndims     ,
 struct UnstructuredGrid *
 read_grid(const char *fname);
 
+int
+write_grid_binary(const struct UnstructuredGrid *G,
+                  const char                    *fname,
+                  uint64_t                       key);
+
+struct UnstructuredGrid *
+read_grid_binary(const char *fname, uint64_t key);
+
+struct UnstructuredGrid *
+map_grid_binary(const char *fname, uint64_t key);
+
+uint64_t
+grid_hash_update(uint64_t h, const void *data, size_t nbytes);
+
  ---- end of synopsis of grid.h ----
 */
 
@@ -242,6 +258,30 @@ struct UnstructuredGrid
        cornerpoint grids.
     */
     int    *cell_facetag;
+
+    /**
+       If non-null, all arrays of the grid live in a read-only
+       memory mapped file created by map_grid_binary(), and this is
+       the handle of that mapping.  Null for grids whose arrays are
+       individually allocated by malloc().  Managed by destroy_grid().
+    */
+    void   *mapping;
+
+    /**
+       Hashes of the topology arrays (including <code>global_cell</code>
+       and <code>cell_facetag</code>) and of the geometry arrays,
+       respectively, as computed by grid_update_hash().  Zero if not
+       known.  The grid constructors of this module and
+       compute_geometry() set these fields, and grid_equal() uses them
+       to decide most comparisons without inspecting the arrays.  Code
+       that modifies the arrays of a grid in place must call
+       grid_update_hash() or grid_invalidate_hash() afterwards.  The
+       topology hash is also suitable as a cache key for data, such as
+       operators or preconditioners, that depends only on the grid's
+       connectivity.
+    */
+    uint64_t topology_hash;
+    uint64_t geometry_hash;
 };
 
 /**
@@ -249,7 +289,8 @@ struct UnstructuredGrid
 
    This function assumes that all arrays of the UnstructuredGrid (if
    non-null) have been individually allocated by malloc(). They will
-   be deallocated with free().
+   be deallocated with free().  The exception is a grid created by
+   map_grid_binary(), whose backing file is unmapped instead.
  */
 void destroy_grid(struct UnstructuredGrid *g);
 
@@ -290,6 +331,23 @@ allocate_grid(size_t ndims     ,
               size_t nnodes    );
 
 
+/**
+ * Count the bytes of the arrays of a grid.
+ *
+ * Arrays of a grid created by map_grid_binary() are counted even though
+ * they are shared with other processes mapping the same file.
+ *
+ * @param[in]  G        Grid.
+ * @param[out] topology Bytes of the topology arrays, including
+ *                      <code>global_cell</code> and <code>cell_facetag</code>.
+ * @param[out] geometry Bytes of the geometry arrays.
+ */
+void
+grid_memory(const struct UnstructuredGrid *G,
+            size_t                        *topology,
+            size_t                        *geometry);
+
+
 /**
  * Import a grid from a character representation stored in file.
  *
@@ -301,8 +359,102 @@ struct UnstructuredGrid *
 read_grid(const char *fname);
 
 
+/**
+ * Initial value of the running hash computed by grid_hash_update().
+ */
+#define GRID_HASH_INIT ((uint64_t) 0xcbf29ce484222325ULL)
+
+/**
+ * Store a grid, including geometry and @c global_cell, in a versioned
+ * binary file intended as a cache between runs.
+ *
+ * The file uses native byte order and places every array on a 64 byte
+ * boundary so that the file may also be memory mapped.  The file is
+ * written to a temporary name and renamed into place on success.
+ *
+ * @param[in] G     Grid.
+ * @param[in] fname File name.
+ * @param[in] key   Caller-defined key, typically a hash of the grid's
+ *                  input data, that must be matched by read_grid_binary().
+ * @return Non-zero on success, zero on failure.
+ */
+int
+write_grid_binary(const struct UnstructuredGrid *G,
+                  const char                    *fname,
+                  uint64_t                       key);
+
+/**
+ * Import a grid stored by write_grid_binary().
+ *
+ * @param[in] fname File name.
+ * @param[in] key   Expected key.
+ * @return Fully formed UnstructuredGrid with all fields allocated and filled.
+ * Returns @c NULL if the file does not exist, if it was written by an
+ * incompatible version or with a different key, if the checksum does not
+ * match or in case of allocation failure.
+ */
+struct UnstructuredGrid *
+read_grid_binary(const char *fname, uint64_t key);
+
+/**
+ * Map a grid stored by write_grid_binary() read-only into memory.
+ *
+ * The grid's arrays point directly into a shared mapping of the file, so
+ * all processes on a node that map the same file share the same physical
+ * pages.  The arrays must not be modified.  Release the grid with
+ * destroy_grid(), which unmaps the file.  The file must not be truncated
+ * or rewritten in place while mapped; write_grid_binary() replaces files
+ * by renaming, which is safe.
+ *
+ * @param[in] fname File name.
+ * @param[in] key   Expected key.
+ * @return Grid backed by the mapped file.  Returns @c NULL under the same
+ * conditions as read_grid_binary(), and on platforms without memory
+ * mapped files.
+ */
+struct UnstructuredGrid *
+map_grid_binary(const char *fname, uint64_t key);
+
+/**
+ * Update a running 64-bit FNV-1a hash with a block of bytes.
+ *
+ * @param[in] h      Current hash value, @c GRID_HASH_INIT initially.
+ * @param[in] data   Data.
+ * @param[in] nbytes Number of bytes in @c data.
+ * @return Updated hash value.
+ */
+uint64_t
+grid_hash_update(uint64_t h, const void *data, size_t nbytes);
+
+/**
+ * Compute and store the topology and geometry hashes of a grid.
+ *
+ * The arrays are hashed in fixed-size chunks, in parallel if OpenMP is
+ * available, so the result does not depend on the number of threads.
+ * The hashes are left unknown (zero) in case of allocation failure.
+ *
+ * @param[in,out] G Grid.
+ */
+void
+grid_update_hash(struct UnstructuredGrid *G);
+
+/**
+ * Mark the topology and geometry hashes of a grid as unknown.
+ *
+ * @param[in,out] G Grid.
+ */
+void
+grid_invalidate_hash(struct UnstructuredGrid *G);
 
 
+/**
+ * Compare grids for equality.
+ *
+ * Topology and @c global_cell are compared exactly and geometry to
+ * within a relative tolerance.  If both grids carry known hashes, the
+ * comparison is decided without inspecting the arrays, except when the
+ * topologies agree but the geometry differs bitwise.
+ */
 bool
 grid_equal(const struct UnstructuredGrid * grid1 , const struct UnstructuredGrid * grid2);
 
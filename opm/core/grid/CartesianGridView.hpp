@@ -0,0 +1,401 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_CARTESIANGRIDVIEW_HEADER_INCLUDED
+#define OPM_CARTESIANGRIDVIEW_HEADER_INCLUDED
+
+#include <opm/core/grid/GridHelpers.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace Opm
+{
+
+    /// Implicit representation of a uniform, three-dimensional Cartesian
+    /// grid.
+    ///
+    /// All topology and geometry is computed from the grid dimensions and
+    /// cell sizes when queried, so the memory use is independent of the
+    /// number of cells. Cells, faces, face cells, cell faces and geometry
+    /// are numbered and oriented exactly as in the UnstructuredGrid
+    /// created by create_grid_hexa3d() with the same arguments. In
+    /// particular, the faces of each cell are ordered by their Cartesian
+    /// tag (I-, I+, J-, J+, K-, K+).
+    ///
+    /// The grid is accessed through the UgGridHelpers functions defined
+    /// below, so that code templated on the grid type (such as
+    /// tpfa_htrans_compute() and BasicTpfaOperator) can be instantiated
+    /// on it.
+    class CartesianGridView
+    {
+    public:
+        /// Iterator over the faces of a cell. Dereferences to a face
+        /// index, and knows the Cartesian tag of the face.
+        class CellFaceIterator
+        {
+        public:
+            typedef int value_type;
+
+            CellFaceIterator(const int* faces, const int tag)
+                : faces_(faces), tag_(tag)
+            {}
+            int operator*() const { return faces_[tag_]; }
+            CellFaceIterator& operator++() { ++tag_; return *this; }
+            bool operator==(const CellFaceIterator& other) const { return tag_ == other.tag_; }
+            bool operator!=(const CellFaceIterator& other) const { return tag_ != other.tag_; }
+            /// Cartesian tag (0, ..., 5 for I-, I+, J-, J+, K-, K+).
+            int tag() const { return tag_; }
+        private:
+            const int* faces_;
+            int tag_;
+        };
+
+        /// The faces of a single cell, computed on construction.
+        class CellFaces
+        {
+        public:
+            typedef CellFaceIterator const_iterator;
+            typedef CellFaceIterator iterator;
+            typedef int value_type;
+            typedef std::size_t size_type;
+
+            CellFaces(const CartesianGridView& grid, const int cell)
+            {
+                for (int tag = 0; tag < 6; ++tag) {
+                    faces_[tag] = grid.cellFace(cell, tag);
+                }
+            }
+            CellFaceIterator begin() const { return CellFaceIterator(faces_, 0); }
+            CellFaceIterator end() const { return CellFaceIterator(faces_, 6); }
+            size_type size() const { return 6; }
+        private:
+            int faces_[6];
+        };
+
+        /// Cell-to-faces mapping, in the form of a sparse table.
+        class Cell2Faces
+        {
+        public:
+            typedef CellFaces row_type;
+
+            explicit Cell2Faces(const CartesianGridView& grid)
+                : grid_(&grid)
+            {}
+            row_type operator[](const std::size_t cell) const
+            {
+                return CellFaces(*grid_, static_cast<int>(cell));
+            }
+            std::size_t size() const { return grid_->numCells(); }
+            std::size_t noEntries() const { return 6*size(); }
+        private:
+            const CartesianGridView* grid_;
+        };
+
+        /// Face-to-cells mapping, as UgGridHelpers::FaceCellsProxy.
+        class FaceCells
+        {
+        public:
+            explicit FaceCells(const CartesianGridView& grid)
+                : grid_(&grid)
+            {}
+            int operator()(const int face, const int local_index) const
+            {
+                return grid_->faceCell(face, local_index);
+            }
+        private:
+            const CartesianGridView* grid_;
+        };
+
+        /// Iterator over cell centroids, for beginCellCentroids().
+        class CellCentroidIterator
+        {
+        public:
+            CellCentroidIterator(const CartesianGridView& grid, const int cell)
+                : grid_(&grid), cell_(cell)
+            {}
+            CellCentroidIterator operator+(const int n) const
+            {
+                return CellCentroidIterator(*grid_, cell_ + n);
+            }
+            std::array<double, 3> operator*() const { return grid_->cellCentroid(cell_); }
+        private:
+            const CartesianGridView* grid_;
+            int cell_;
+        };
+
+        /// Construct grid.
+        /// \param[in] nx, ny, nz  Number of cells in each direction.
+        /// \param[in] dx, dy, dz  Cell size in each direction.
+        CartesianGridView(const int nx, const int ny, const int nz,
+                          const double dx = 1.0, const double dy = 1.0,
+                          const double dz = 1.0)
+        {
+            dims_[0] = nx;  dims_[1] = ny;  dims_[2] = nz;
+            h_[0] = dx;  h_[1] = dy;  h_[2] = dz;
+            nxf_ = (nx + 1)*ny*nz;
+            nyf_ = nx*(ny + 1)*nz;
+            nzf_ = nx*ny*(nz + 1);
+        }
+
+        int numCells() const { return dims_[0]*dims_[1]*dims_[2]; }
+        int numFaces() const { return nxf_ + nyf_ + nzf_; }
+        const int* cartDims() const { return dims_; }
+
+        /// Face of a cell with a given Cartesian tag.
+        int cellFace(const int cell, const int tag) const
+        {
+            const int nx = dims_[0], ny = dims_[1];
+            const int i = cell % nx;
+            const int j = (cell / nx) % ny;
+            const int k = cell / (nx*ny);
+            const int s = tag % 2;
+            switch (tag / 2) {
+            case 0: return i + s + (nx + 1)*(j + ny*k);
+            case 1: return i + nx*(j + s + (ny + 1)*k) + nxf_;
+            default: return i + nx*(j + ny*(k + s)) + nxf_ + nyf_;
+            }
+        }
+
+        /// Cells of a face, -1 outside the grid.
+        /// \param[in] face         Face index.
+        /// \param[in] local_index  0 for the cell on the low side, 1 for
+        ///                         the cell on the high side.
+        int faceCell(const int face, const int local_index) const
+        {
+            int ijk[3];
+            const int dir = faceIJK(face, ijk);
+            ijk[dir] -= 1 - local_index;
+            if (ijk[dir] < 0 || ijk[dir] >= dims_[dir]) {
+                return -1;
+            }
+            return ijk[0] + dims_[0]*(ijk[1] + dims_[1]*ijk[2]);
+        }
+
+        std::array<double, 3> cellCentroid(const int cell) const
+        {
+            const int nx = dims_[0], ny = dims_[1];
+            const int ijk[3] = { cell % nx, (cell / nx) % ny, cell / (nx*ny) };
+            std::array<double, 3> x;
+            for (int d = 0; d < 3; ++d) {
+                x[d] = (node(d, ijk[d]) + node(d, ijk[d] + 1)) / 2.0;
+            }
+            return x;
+        }
+
+        double cellVolume(const int cell) const
+        {
+            const int nx = dims_[0], ny = dims_[1];
+            const int ijk[3] = { cell % nx, (cell / nx) % ny, cell / (nx*ny) };
+            return size(0, ijk[0]) * size(1, ijk[1]) * size(2, ijk[2]);
+        }
+
+        std::array<double, 3> faceCentroid(const int face) const
+        {
+            int ijk[3];
+            const int dir = faceIJK(face, ijk);
+            std::array<double, 3> x;
+            for (int d = 0; d < 3; ++d) {
+                x[d] = (d == dir) ? node(d, ijk[d])
+                    : (node(d, ijk[d]) + node(d, ijk[d] + 1)) / 2.0;
+            }
+            return x;
+        }
+
+        /// Area-weighted face normal, pointing in the positive
+        /// coordinate direction.
+        std::array<double, 3> faceNormal(const int face) const
+        {
+            int ijk[3];
+            const int dir = faceIJK(face, ijk);
+            std::array<double, 3> n = {{ 0.0, 0.0, 0.0 }};
+            n[dir] = faceArea(dir, ijk);
+            return n;
+        }
+
+        double faceArea(const int face) const
+        {
+            int ijk[3];
+            const int dir = faceIJK(face, ijk);
+            return faceArea(dir, ijk);
+        }
+
+    private:
+        // Direction of the normal of a face, and the logical indices of
+        // the face (the index in the normal direction is that of the
+        // node plane).
+        int faceIJK(int face, int* ijk) const
+        {
+            assert(face >= 0 && face < numFaces());
+            int dir = 0;
+            if (face >= nxf_) {
+                face -= nxf_;
+                dir = 1;
+                if (face >= nyf_) {
+                    face -= nyf_;
+                    dir = 2;
+                }
+            }
+            int n[3] = { dims_[0], dims_[1], dims_[2] };
+            n[dir] += 1;
+            ijk[0] = face % n[0];
+            ijk[1] = (face / n[0]) % n[1];
+            ijk[2] = face / (n[0]*n[1]);
+            return dir;
+        }
+
+        double faceArea(const int dir, const int* ijk) const
+        {
+            const int d1 = (dir + 1) % 3;
+            const int d2 = (dir + 2) % 3;
+            return size(d1, ijk[d1]) * size(d2, ijk[d2]);
+        }
+
+        // Node coordinates and cell sizes, computed as in
+        // create_grid_hexa3d() so that the geometry is identical.
+        double node(const int dir, const int i) const { return i*h_[dir]; }
+        double size(const int dir, const int i) const { return node(dir, i + 1) - node(dir, i); }
+
+        int dims_[3];
+        double h_[3];
+        int nxf_;
+        int nyf_;
+        int nzf_;
+    };
+
+namespace UgGridHelpers
+{
+
+inline int numCells(const CartesianGridView& grid)
+{
+    return grid.numCells();
+}
+
+inline int numFaces(const CartesianGridView& grid)
+{
+    return grid.numFaces();
+}
+
+inline int dimensions(const CartesianGridView&)
+{
+    return 3;
+}
+
+inline int64_t numCellFaces(const CartesianGridView& grid)
+{
+    return 6*static_cast<int64_t>(grid.numCells());
+}
+
+inline const int* cartDims(const CartesianGridView& grid)
+{
+    return grid.cartDims();
+}
+
+/// All cells are active, as for an UnstructuredGrid without global_cell.
+inline const int* globalCell(const CartesianGridView&)
+{
+    return 0;
+}
+
+template<>
+struct CellCentroidTraits<CartesianGridView>
+{
+    typedef CartesianGridView::CellCentroidIterator IteratorType;
+    typedef std::array<double, 3> ValueType;
+};
+
+inline CellCentroidTraits<CartesianGridView>::IteratorType
+beginCellCentroids(const CartesianGridView& grid)
+{
+    return CartesianGridView::CellCentroidIterator(grid, 0);
+}
+
+inline double cellCentroidCoordinate(const CartesianGridView& grid, int cell_index,
+                                     int coordinate)
+{
+    return grid.cellCentroid(cell_index)[coordinate];
+}
+
+inline double cellCenterDepth(const CartesianGridView& grid, int cell_index)
+{
+    return grid.cellCentroid(cell_index)[2];
+}
+
+inline std::array<double, 3> cellCentroid(const CartesianGridView& grid, int cell_index)
+{
+    return grid.cellCentroid(cell_index);
+}
+
+inline double cellVolume(const CartesianGridView& grid, int cell_index)
+{
+    return grid.cellVolume(cell_index);
+}
+
+inline std::array<double, 3> faceCentroid(const CartesianGridView& grid, int face_index)
+{
+    return grid.faceCentroid(face_index);
+}
+
+inline std::array<double, 3> faceNormal(const CartesianGridView& grid, int face_index)
+{
+    return grid.faceNormal(face_index);
+}
+
+inline double faceArea(const CartesianGridView& grid, int face_index)
+{
+    return grid.faceArea(face_index);
+}
+
+inline int faceTag(const CartesianGridView&, CartesianGridView::CellFaceIterator cell_face)
+{
+    return cell_face.tag();
+}
+
+template<>
+struct Cell2FacesTraits<CartesianGridView>
+{
+    typedef CartesianGridView::Cell2Faces Type;
+};
+
+inline Cell2FacesTraits<CartesianGridView>::Type
+cell2Faces(const CartesianGridView& grid)
+{
+    return CartesianGridView::Cell2Faces(grid);
+}
+
+template<>
+struct FaceCellTraits<CartesianGridView>
+{
+    typedef CartesianGridView::FaceCells Type;
+};
+
+inline FaceCellTraits<CartesianGridView>::Type
+faceCells(const CartesianGridView& grid)
+{
+    return CartesianGridView::FaceCells(grid);
+}
+
+} // namespace UgGridHelpers
+
+} // namespace Opm
+
+#endif // OPM_CARTESIANGRIDVIEW_HEADER_INCLUDED
@@ -1,34 +1,36 @@
 #include <opm/core/grid.h>
+#include <opm/core/utility/SparseTable.hpp>
 #include <vector>
-#include <map>
 #include <algorithm>
+#include <numeric>
 
 namespace Opm {
 
     namespace {
 
+        /// Cartesian index of a cell.
+        inline int cartesianCellIndex(const UnstructuredGrid& grid, const int cell)
+        {
+            return grid.global_cell ? grid.global_cell[cell] : cell; // If null, assume mapping is identity.
+        }
+
         /// Helper struct for extractColumn
         /// Compares the underlying k-index
         struct ExtractColumnCompare
         {
             ExtractColumnCompare(const UnstructuredGrid& g)
-            : grid(g)
+            : grid(g), nxy(g.cartdims[0]*g.cartdims[1])
             {
                 // empty
             }
 
-            bool operator()(const int i, const int j)
+            bool operator()(const int i, const int j) const
             {
-                // Extract k-index
-                int index_i = grid.global_cell ? grid.global_cell[i] : i;
-                int k_i = index_i / grid.cartdims[0] / grid.cartdims[1];
-                int index_j = grid.global_cell ? grid.global_cell[j] : j;
-                int k_j = index_j / grid.cartdims[0] / grid.cartdims[1];
-
-                return k_i < k_j;
+                return cartesianCellIndex(grid, i) / nxy < cartesianCellIndex(grid, j) / nxy;
             }
 
             const UnstructuredGrid& grid;
+            const int nxy;
         };
 
 
@@ -50,73 +52,125 @@ namespace Opm {
 
 /// Extract each column of the grid.
 ///  \note Assumes the pillars of the grid are all vertically aligned.
+///  Cells are grouped by (i, j) with a counting sort, and each group
+///  is then ordered by k and split into connected parts, in parallel
+///  over the groups. Cells are usually numbered with increasing k, in
+///  which case no sorting is needed and the time is linear in the
+///  number of cells.
 ///  \param grid The grid from which to extract the columns.
-///  \param columns will for each (i, j) where (i, j) represents a non-empty column,
-////        contain the cell indices contained in the column
-///         centered at (i, j) in the second variable, and i+jN in the first variable.
-inline void extractColumn( const UnstructuredGrid& grid, std::vector<std::vector<int> >& columns )
+///  \param columns will contain one row per column, holding the cell
+///         indices of the column ordered by increasing k. The (i, j)
+///         locations appear in order of their first cell. If the cells
+///         at an (i, j) location are not connected, the topmost connected
+///         parts are placed after all other columns, so that the
+///         bottommost part keeps the position of the location.
+inline void extractColumn( const UnstructuredGrid& grid, SparseTable<int>& columns )
 {
-    const int* dims = grid.cartdims;
-
-    // Keeps track of column_index ---> index of vector
-    std::map<int, int> global_to_local;
-    for (int cell = 0; cell < grid.number_of_cells; ++cell) {
-        // Extract Cartesian coordinates
-        int index = grid.global_cell ? grid.global_cell[cell] : cell; // If null, assume mapping is identity.
-        int i_cart = index % dims[0];
-        int k_cart = index / dims[0] / dims[1];
-        int j_cart = (index - k_cart*dims[0]*dims[1])/ dims[0];
-
-        int local_index;
-        std::map<int, int>::iterator local_index_iterator = global_to_local.find(i_cart+j_cart*dims[0]);
-        if (local_index_iterator != global_to_local.end()) {
-            local_index = local_index_iterator->second;
-        } else {
-            local_index = columns.size();
-            global_to_local[i_cart+j_cart*dims[0]] = local_index;
-            columns.push_back(std::vector<int>());
+    const int num_cells = grid.number_of_cells;
+    const int nxy = grid.cartdims[0]*grid.cartdims[1];
+
+    // Number the (i, j) locations in order of appearance, and count
+    // their cells.
+    std::vector<int> ij_col(nxy, -1);
+    std::vector<int> cell_col(num_cells);
+    std::vector<int> col_start(1, 0);
+    for (int cell = 0; cell < num_cells; ++cell) {
+        const int ij = cartesianCellIndex(grid, cell) % nxy;
+        if (ij_col[ij] < 0) {
+            ij_col[ij] = col_start.size() - 1;
+            col_start.push_back(0);
+        }
+        cell_col[cell] = ij_col[ij];
+        ++col_start[cell_col[cell] + 1];
+    }
+    const int num_cols = col_start.size() - 1;
+    std::partial_sum(col_start.begin(), col_start.end(), col_start.begin());
+
+    // Counting sort of the cells by location.
+    std::vector<int> col_cells(num_cells);
+    {
+        std::vector<int> pos(col_start.begin(), col_start.end() - 1);
+        for (int cell = 0; cell < num_cells; ++cell) {
+            col_cells[pos[cell_col[cell]]++] = cell;
         }
-        columns[local_index].push_back(cell);
     }
 
-    int num_cols = columns.size();
+    // Order each location by k, and split it where consecutive cells
+    // are not neighbours.
+    std::vector<char> part_start(num_cells, 0);
+    std::vector<int> num_parts(num_cols);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
     for (int col = 0; col < num_cols; ++col) {
-        std::sort(columns[col].begin(), columns[col].end(), ExtractColumnCompare(grid));
+        int* beg = col_cells.data() + col_start[col];
+        int* end = col_cells.data() + col_start[col + 1];
+        const ExtractColumnCompare k_less(grid);
+        if (!std::is_sorted(beg, end, k_less)) {
+            std::sort(beg, end, k_less);
+        }
+        int parts = 1;
+        for (int i = col_start[col] + 1; i < col_start[col + 1]; ++i) {
+            if (!neighbours(grid, col_cells[i - 1], col_cells[i])) {
+                part_start[i] = 1;
+                ++parts;
+            }
+        }
+        num_parts[col] = parts;
     }
 
-    // At this point, a column may contain multiple disjoint sets of cells.
-    // We must split these columns into connected parts.
-    std::vector< std::vector<int> > new_columns;
+    // The last part of location col is column col, the others are
+    // numbered after all locations.
+    std::vector<int> extra_start(num_cols + 1, 0);
     for (int col = 0; col < num_cols; ++col) {
-        const int colsz = columns[col].size();
-        int first_of_col = 0;
-        for (int k = 1; k < colsz; ++k) {
-            const int c0 = columns[col][k-1];
-            const int c1 = columns[col][k];
-            if (!neighbours(grid, c0, c1)) {
-                // Must split. Move the cells [first_of_col, ... , k-1] to
-                // a new column, known to be connected.
-                new_columns.push_back(std::vector<int>());
-                new_columns.back().assign(columns[col].begin() + first_of_col, columns[col].begin() + k);
-                // The working column now starts with index k.
-                first_of_col = k;
-            }
+        extra_start[col + 1] = extra_start[col] + num_parts[col] - 1;
+    }
+    const int num_columns = num_cols + extra_start[num_cols];
+    std::vector<int> column_size(num_columns);
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            columns.allocate(column_size.begin(), column_size.end());
         }
-        if (first_of_col != 0) {
-            // The column was split, the working part should be
-            // the entire column. We erase the cells before first_of_col.
-            // (Could be more efficient if we instead chop off end.)
-            columns[col].erase(columns[col].begin(), columns[col].begin() + first_of_col);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int col = 0; col < num_cols; ++col) {
+            int part = 0;
+            int first = col_start[col];
+            for (int i = col_start[col] + 1; i <= col_start[col + 1]; ++i) {
+                if (i < col_start[col + 1] && !part_start[i]) {
+                    continue;
+                }
+                const int column = (part == num_parts[col] - 1) ? col : num_cols + extra_start[col] + part;
+                if (pass == 0) {
+                    column_size[column] = i - first;
+                } else {
+                    std::copy(col_cells.begin() + first, col_cells.begin() + i, columns[column].begin());
+                }
+                first = i;
+                ++part;
+            }
         }
     }
+}
 
-    // Must tack on the new columns to complete the set.
-    const int num_cols_all = num_cols + new_columns.size();
-    columns.resize(num_cols_all);
-    for (int col = num_cols; col < num_cols_all; ++col) {
-        columns[col].swap(new_columns[col - num_cols]);
-    }
 
+/// Extract each column of the grid.
+///  \note Assumes the pillars of the grid are all vertically aligned.
+///  \param grid The grid from which to extract the columns.
+///  \param columns will for each (i, j) where (i, j) represents a non-empty column,
+////        contain the cell indices contained in the column
+///         centered at (i, j) in the second variable, and i+jN in the first variable.
+///         Columns are as for the SparseTable version above.
+inline void extractColumn( const UnstructuredGrid& grid, std::vector<std::vector<int> >& columns )
+{
+    SparseTable<int> table;
+    extractColumn(grid, table);
+    const int num_columns = table.size();
+    columns.resize(num_columns);
+    for (int col = 0; col < num_columns; ++col) {
+        columns[col].assign(table[col].begin(), table[col].end());
+    }
 }
 
 } // namespace Opm
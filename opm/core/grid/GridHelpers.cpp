@@ -20,6 +20,25 @@
 */
 #include "config.h"
 #include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/grid/cornerpoint_grid.h>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <stdexcept>
+
+namespace
+{
+// Compute centroids omitted at grid construction on first use.
+void ensureCentroids(const UnstructuredGrid& grid)
+{
+    if (grid.face_centroids == 0 || grid.cell_centroids == 0) {
+        // The grid is logically const: only derived data is added.
+        if (!complete_geometry(const_cast<UnstructuredGrid*>(&grid))) {
+            OPM_THROW(std::runtime_error, "Failed to compute grid centroids.");
+        }
+    }
+}
+} // anonymous namespace
+
 namespace Opm
 {
 namespace UgGridHelpers
@@ -42,6 +61,26 @@ int numCellFaces(const UnstructuredGrid& grid)
     return grid.cell_facepos[grid.number_of_cells];
 }
 
+int numCells(const GridTopology& grid)
+{
+    return grid.number_of_cells;
+}
+
+int numFaces(const GridTopology& grid)
+{
+    return grid.number_of_faces;
+}
+
+int dimensions(const GridTopology& grid)
+{
+    return grid.dimensions;
+}
+
+int64_t numCellFaces(const GridTopology& grid)
+{
+    return grid.cell_facepos[grid.number_of_cells];
+}
+
 const int* globalCell(const UnstructuredGrid& grid)
 {
     return grid.global_cell;
@@ -54,6 +93,7 @@ const int* cartDims(const UnstructuredGrid& grid)
                     
 const double* beginCellCentroids(const UnstructuredGrid& grid)
 {
+    ensureCentroids(grid);
     return grid.cell_centroids;
 }
 
@@ -81,12 +121,14 @@ double cellCenterDepth(const UnstructuredGrid& grid, int cell_index)
 double cellCentroidCoordinate(const UnstructuredGrid& grid, int cell_index,
                                  int coordinate)
 {
+    ensureCentroids(grid);
     return grid.cell_centroids[grid.dimensions*cell_index+coordinate];
 }
 
 const double*
 cellCentroid(const UnstructuredGrid& grid, int cell_index)
 {
+    ensureCentroids(grid);
     return grid.cell_centroids+(cell_index*grid.dimensions);
 }
 
@@ -101,11 +143,13 @@ const double* endCellVolumes(const UnstructuredGrid& grid)
 
 const double* beginFaceCentroids(const UnstructuredGrid& grid)
 {
+    ensureCentroids(grid);
     return grid.face_centroids;
 }
 
 const double* faceCentroid(const UnstructuredGrid& grid, int face_index)
 {
+    ensureCentroids(grid);
     return grid.face_centroids+face_index*grid.dimensions;
 }
 
@@ -135,6 +179,22 @@ SparseTableView face2Vertices(const UnstructuredGrid& grid)
     return SparseTableView(grid.face_nodes, grid.face_nodepos, numFaces(grid));
 }
 
+int faceTag(const GridTopology& grid,
+            boost::iterator_range<const int*>::const_iterator face)
+{
+    return grid.cell_facetag[face-cell2Faces(grid)[0].begin()];
+}
+
+SparseTableView64 cell2Faces(const GridTopology& grid)
+{
+    return SparseTableView64(grid.cell_faces, grid.cell_facepos, numCells(grid));
+}
+
+SparseTableView64 face2Vertices(const GridTopology& grid)
+{
+    return SparseTableView64(grid.face_nodes, grid.face_nodepos, numFaces(grid));
+}
+
 const double* vertexCoordinates(const UnstructuredGrid& grid, int index)
 {
     return grid.node_coordinates+dimensions(grid)*index;
@@ -149,5 +209,10 @@ FaceCellTraits<UnstructuredGrid>::Type faceCells(const UnstructuredGrid& grid)
 {
     return FaceCellsProxy(grid);
 }
+
+FaceCellTraits<GridTopology>::Type faceCells(const GridTopology& grid)
+{
+    return FaceCellsProxy(grid);
+}
 }
 }
@@ -22,6 +22,7 @@
 #define OPM_CORE_GRIDHELPERS_HEADER_INCLUDED
 
 #include <opm/core/grid.h>
+#include <opm/core/grid/grid_topology.h>
 
 #include <opm/common/utility/platform_dependent/disable_warnings.h>
 #include <boost/range/iterator_range.hpp>
@@ -33,12 +34,20 @@ namespace Opm
 namespace UgGridHelpers
 {
 
+// The centroid accessors below compute centroids that were omitted at
+// grid construction (see create_grid_cornerpoint_masked()) on first
+// use.  That first call modifies the grid and must not run concurrently
+// with other accesses to it.
+
 /// \brief Allows viewing a sparse table consisting out of C-array 
 ///
 /// This class can be used to convert two int array (like they are
 /// in UnstructuredGrid for representing the cell to faces mapping
 /// as a sparse table object.
-class SparseTableView
+/// \tparam Offset The type of the row offsets, int for UnstructuredGrid
+///                and int64_t for GridTopology.
+template <typename Offset>
+class BasicSparseTableView
 {
 public:
     class IntRange : public boost::iterator_range<const int*>
@@ -60,7 +69,7 @@ public:
     /// \param offset The offsets of the rows. Row i starts
     ///               at offset[i] and ends a offset[i+1]
     /// \param size   The number of entries/rows of the table
-    SparseTableView(int* data, int *offset, std::size_t size_arg)
+    BasicSparseTableView(int* data, Offset *offset, std::size_t size_arg)
         : data_(data), offset_(offset), size_(size_arg)
     {}
 
@@ -83,7 +92,7 @@ public:
     /// \brief Get the number of non-zero entries.
     std::size_t noEntries() const
     {
-        return offset_[size_];
+        return static_cast<std::size_t>(offset_[size_]);
     }
 
 private:
@@ -92,22 +101,32 @@ private:
     /// \brief offset The offsets of the rows. 
     ///
     /// Row i starts at offset[i] and ends a offset[i+1]
-    const int* offset_;
+    const Offset* offset_;
     /// \brief The size, i.e. the number of rows.
     std::size_t size_;
 };
 
+/// \brief Sparse table view with int offsets, as in UnstructuredGrid.
+typedef BasicSparseTableView<int> SparseTableView;
+
+/// \brief Sparse table view with 64-bit offsets, as in GridTopology.
+typedef BasicSparseTableView<int64_t> SparseTableView64;
+
 /// \brief Get the number of cells of a grid.
 int numCells(const UnstructuredGrid& grid);
+int numCells(const GridTopology& grid);
 
 /// \brief Get the number of faces of a grid.
 int numFaces(const UnstructuredGrid& grid);
+int numFaces(const GridTopology& grid);
 
 /// \brief Get the dimensions of a grid
 int dimensions(const UnstructuredGrid& grid);
+int dimensions(const GridTopology& grid);
 
 /// \brief Get the number of faces, where each face counts as many times as there are adjacent faces
 int numCellFaces(const UnstructuredGrid& grid);
+int64_t numCellFaces(const GridTopology& grid);
 
 /// \brief Get the cartesion dimension of the underlying structured grid.
 const int* cartDims(const UnstructuredGrid& grid);
@@ -239,6 +258,7 @@ double faceArea(const UnstructuredGrid& grid, int face_index);
 /// \param cell_face The face attached to a cell as obtained from cell2Faces()
 /// \return 0, 1, 2, 3, 4, 5 for I-, I+, J-, J+, K-, K+
 int faceTag(const UnstructuredGrid& grid, boost::iterator_range<const int*>::const_iterator cell_face);
+int faceTag(const GridTopology& grid, boost::iterator_range<const int*>::const_iterator cell_face);
 
 /// \brief Maps the grid type to the associated type of the cell to faces mapping.
 ///
@@ -255,6 +275,12 @@ struct Cell2FacesTraits<UnstructuredGrid>
     typedef SparseTableView Type;
 };
 
+template<>
+struct Cell2FacesTraits<GridTopology>
+{
+    typedef SparseTableView64 Type;
+};
+
 /// \brief Maps the grid type to the associated type of the face to vertices mapping.
 ///
 /// Provides a type named Type.
@@ -270,14 +296,26 @@ struct Face2VerticesTraits<UnstructuredGrid>
     typedef SparseTableView Type;
 };
 
+template<>
+struct Face2VerticesTraits<GridTopology>
+{
+    typedef SparseTableView64 Type;
+};
+
 /// \brief Get the cell to faces mapping of a grid.
 Cell2FacesTraits<UnstructuredGrid>::Type 
 cell2Faces(const UnstructuredGrid& grid);
 
+Cell2FacesTraits<GridTopology>::Type
+cell2Faces(const GridTopology& grid);
+
 /// \brief Get the face to vertices mapping of a grid.
 Face2VerticesTraits<UnstructuredGrid>::Type 
 face2Vertices(const UnstructuredGrid& grid);
 
+Face2VerticesTraits<GridTopology>::Type
+face2Vertices(const GridTopology& grid);
+
 /// \brief Get the coordinates of a vertex of the grid.
 /// \param grid The grid the vertex is part of.
 /// \param index The index identifying the vertex.
@@ -289,6 +327,9 @@ public:
     FaceCellsProxy(const UnstructuredGrid& grid)
     : face_cells_(grid.face_cells)
     {}
+    FaceCellsProxy(const GridTopology& grid)
+    : face_cells_(grid.face_cells)
+    {}
     int operator()(int face_index, int local_index) const
     {
         return face_cells_[2*face_index+local_index];
@@ -311,8 +352,15 @@ struct FaceCellTraits<UnstructuredGrid>
     typedef FaceCellsProxy Type;
 };
 
+template<>
+struct FaceCellTraits<GridTopology>
+{
+    typedef FaceCellsProxy Type;
+};
+
 /// \brief Get the face to cell mapping of a grid.
 FaceCellTraits<UnstructuredGrid>::Type faceCells(const UnstructuredGrid& grid);
+FaceCellTraits<GridTopology>::Type faceCells(const GridTopology& grid);
 
 /// \brief Increment an iterator over an array that reresents a dense row-major
 ///  matrix with dims columns
@@ -24,6 +24,7 @@
 #include <opm/core/grid/cart_grid.h>
 #include <opm/core/grid/cornerpoint_grid.h>
 #include <opm/core/grid/MinpvProcessor.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/parser/eclipse/Deck/DeckItem.hpp>
 #include <opm/parser/eclipse/Deck/DeckKeyword.hpp>
@@ -32,21 +33,88 @@
 
 #include <array>
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <numeric>
+#include <string>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    /// Hash of all input data that determines the processed
+    /// corner-point grid.
+    uint64_t cornerpointKey(const struct grdecl& g, const double z_tolerance)
+    {
+        const std::size_t npillars = std::size_t(g.dims[0] + 1) * (g.dims[1] + 1);
+        const std::size_t ncells   = std::size_t(g.dims[0]) * g.dims[1] * g.dims[2];
+        const int haveActnum = g.actnum != nullptr;
+
+        uint64_t h = GRID_HASH_INIT;
+        h = grid_hash_update(h, g.dims, sizeof g.dims);
+        h = grid_hash_update(h, &z_tolerance, sizeof z_tolerance);
+        h = grid_hash_update(h, g.coord, 6 * npillars * sizeof *g.coord);
+        h = grid_hash_update(h, g.zcorn, 8 * ncells * sizeof *g.zcorn);
+        h = grid_hash_update(h, &haveActnum, sizeof haveActnum);
+        if (haveActnum) {
+            h = grid_hash_update(h, g.actnum, ncells * sizeof *g.actnum);
+        }
+        return h;
+    }
+
+    /// Cache file of the grid identified by 'key', or an empty string
+    /// if caching is disabled (the OPM_GRID_CACHE_DIR environment
+    /// variable is unset or empty).
+    std::string cacheFileName(const uint64_t key)
+    {
+        const char* dir = std::getenv("OPM_GRID_CACHE_DIR");
+        if (dir == nullptr || *dir == '\0') {
+            return std::string();
+        }
+        char name[32];
+        std::snprintf(name, sizeof name, "grid-%016llx.ugb",
+                      static_cast<unsigned long long>(key));
+        return std::string(dir) + '/' + name;
+    }
+
+    /// Whether cached grids should be mapped read-only and shared
+    /// between processes (OPM_GRID_CACHE_SHARED set to a non-zero
+    /// value) rather than copied into process memory.
+    bool cacheShared()
+    {
+        const char* shared = std::getenv("OPM_GRID_CACHE_SHARED");
+        return shared != nullptr && std::atoi(shared) != 0;
+    }
+
+    /// Peak resident set size of the process in kB, or zero if not
+    /// available.
+    long peakRssKb()
+    {
+#ifdef __linux__
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            return usage.ru_maxrss;
+        }
+#endif
+        return 0;
+    }
+} // anonymous namespace
 
 namespace Opm
 {
 
     /// Construct a 3d corner-point grid from a deck.
     GridManager::GridManager(Opm::EclipseGridConstPtr eclipseGrid)
-        : ug_(0)
+        : ug_(0), peak_rss_kb_(0)
     {
         initFromEclipseGrid(eclipseGrid, std::vector<double>());
     }
 
 
     GridManager::GridManager(Opm::DeckConstPtr deck)
-        : ug_(0)
+        : ug_(0), peak_rss_kb_(0)
     {
         auto eclipseGrid = std::make_shared<const Opm::EclipseGrid>(deck);
         initFromEclipseGrid(eclipseGrid, std::vector<double>());
@@ -54,15 +122,18 @@ namespace Opm
 
 
     GridManager::GridManager(Opm::EclipseGridConstPtr eclipseGrid,
-                             const std::vector<double>& poreVolumes)
-        : ug_(0)
+                             const std::vector<double>& poreVolumes,
+                             int geometryThreads,
+                             int geometryMask)
+        : ug_(0), peak_rss_kb_(0)
     {
-        initFromEclipseGrid(eclipseGrid, poreVolumes);
+        initFromEclipseGrid(eclipseGrid, poreVolumes, geometryThreads, geometryMask);
     }
 
 
     /// Construct a 2d cartesian grid with cells of unit size.
     GridManager::GridManager(int nx, int ny)
+        : peak_rss_kb_(0)
     {
         ug_ = create_grid_cart2d(nx, ny, 1.0, 1.0);
         if (!ug_) {
@@ -71,6 +142,7 @@ namespace Opm
     }
 
     GridManager::GridManager(int nx, int ny,double dx, double dy)
+        : peak_rss_kb_(0)
     {
         ug_ = create_grid_cart2d(nx, ny, dx, dy);
         if (!ug_) {
@@ -81,6 +153,7 @@ namespace Opm
 
     /// Construct a 3d cartesian grid with cells of unit size.
     GridManager::GridManager(int nx, int ny, int nz)
+        : peak_rss_kb_(0)
     {
         ug_ = create_grid_cart3d(nx, ny, nz);
         if (!ug_) {
@@ -94,6 +167,7 @@ namespace Opm
     /// Construct a 3d cartesian grid with cells of size [dx, dy, dz].
     GridManager::GridManager(int nx, int ny, int nz,
                              double dx, double dy, double dz)
+        : peak_rss_kb_(0)
     {
         ug_ = create_grid_hexa3d(nx, ny, nz, dx, dy, dz);
         if (!ug_) {
@@ -108,6 +182,7 @@ namespace Opm
     /// The file format used is currently undocumented,
     /// and is therefore only suited for internal use.
     GridManager::GridManager(const std::string& input_filename)
+        : peak_rss_kb_(0)
     {
         ug_ = read_grid(input_filename.c_str());
         if (!ug_) {
@@ -134,10 +209,31 @@ namespace Opm
 
 
 
+    long GridManager::peakMemoryKb() const
+    {
+        return peak_rss_kb_;
+    }
+
+
+
+
+    void GridManager::reportMemory(MemoryReport& report) const
+    {
+        std::size_t topology = 0, geometry = 0;
+        grid_memory(ug_, &topology, &geometry);
+        MemoryReport& grid = report.child("grid");
+        grid.add("topology", topology);
+        grid.add("geometry", geometry);
+    }
+
+
+
 
     // Construct corner-point grid from EclipseGrid.
     void GridManager::initFromEclipseGrid(Opm::EclipseGridConstPtr eclipseGrid,
-                                          const std::vector<double>& poreVolumes)
+                                          const std::vector<double>& poreVolumes,
+                                          int geometryThreads,
+                                          int geometryMask)
     {
         struct grdecl g;
         std::vector<int> actnum;
@@ -170,10 +266,46 @@ namespace Opm
 
         const double z_tolerance = eclipseGrid->isPinchActive() ?
             eclipseGrid->getPinchThresholdThickness() : 0.0;
-        ug_ = create_grid_cornerpoint(&g, z_tolerance);
+
+        // Reuse a previously processed grid if one is cached for
+        // exactly this input.
+        const uint64_t key = cornerpointKey(g, z_tolerance);
+        const std::string cachefile = cacheFileName(key);
+        const bool shared = !cachefile.empty() && cacheShared();
+        if (!cachefile.empty()) {
+            ug_ = shared ? map_grid_binary (cachefile.c_str(), key)
+                         : read_grid_binary(cachefile.c_str(), key);
+            if (ug_) {
+                peak_rss_kb_ = peakRssKb();
+                return;
+            }
+        }
+
+        // The grid processing reorders our copy of ZCORN in place rather
+        // than making another one.  Release the input as soon as the grid
+        // is built.
+        ug_ = create_grid_cornerpoint_inplace(&g, zcorn.data(), z_tolerance,
+                                              geometryThreads, geometryMask);
+        std::vector<double>().swap(zcorn);
+        std::vector<double>().swap(coord);
+        std::vector<int>().swap(actnum);
         if (!ug_) {
             OPM_THROW(std::runtime_error, "Failed to construct grid.");
         }
+        peak_rss_kb_ = peakRssKb();
+
+        // Failing to write the cache is not an error.  Grids without
+        // all geometry fields are never cached.
+        if (!cachefile.empty() &&
+            write_grid_binary(ug_, cachefile.c_str(), key) && shared) {
+            // Switch to the shared mapping right away so that later
+            // processes on this node share pages with this one.
+            UnstructuredGrid* mapped = map_grid_binary(cachefile.c_str(), key);
+            if (mapped) {
+                destroy_grid(ug_);
+                ug_ = mapped;
+            }
+        }
     }
 
 
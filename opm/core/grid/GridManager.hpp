@@ -22,6 +22,7 @@
 
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/EclipseGrid.hpp>
+#include <opm/core/grid/cornerpoint_grid.h>
 
 #include <string>
 
@@ -30,6 +31,9 @@ struct grdecl;
 
 namespace Opm
 {
+
+    class MemoryReport;
+
     /// This class manages an Opm::UnstructuredGrid in the sense that it
     /// encapsulates creation and destruction of the grid.
     /// The following grid types can be constructed:
@@ -38,6 +42,15 @@ namespace Opm
     ///   - 2d cartesian grids
     ///   - 3d cartesian grids
     /// The resulting UnstructuredGrid is available through the c_grid() method.
+    ///
+    /// If the environment variable OPM_GRID_CACHE_DIR names a directory,
+    /// processed corner-point grids are cached there in binary form
+    /// (see write_grid_binary()), keyed by a hash of the grid input.
+    /// Later runs with identical input load the cached grid instead of
+    /// processing the corner-point data again.  If OPM_GRID_CACHE_SHARED
+    /// is also set to a non-zero value, the cached grid is memory mapped
+    /// read-only (see map_grid_binary()) so that all processes on a node
+    /// share a single copy of its arrays.
     class GridManager
     {
     public:
@@ -52,8 +65,17 @@ namespace Opm
         /// considerations.
         /// \input[in] eclipseGrid    encapsulates a corner-point grid given from a deck
         /// \input[in] poreVolumes    one element per logical cartesian grid element
+        /// \input[in] geometryThreads number of threads computing the grid
+        ///            geometry, non-positive for the OpenMP default.  The
+        ///            resulting grid does not depend on this value.
+        /// \input[in] geometryMask bitwise OR of GRID_GEOMETRY_* flags
+        ///            selecting the optional geometry fields to store.
+        ///            Omitted centroids are computed on first use through
+        ///            the UgGridHelpers accessors.
         GridManager(Opm::EclipseGridConstPtr eclipseGrid,
-                    const std::vector<double>& poreVolumes);
+                    const std::vector<double>& poreVolumes,
+                    int geometryThreads = 0,
+                    int geometryMask = GRID_GEOMETRY_ALL);
 
         /// Construct a 2d cartesian grid with cells of unit size.
         GridManager(int nx, int ny);
@@ -81,6 +103,15 @@ namespace Opm
         /// to make it clear that we are returning a C-compatible struct.
         const UnstructuredGrid* c_grid() const;
 
+        /// Peak resident memory of the process, in kB, when construction
+        /// of a corner-point grid from an EclipseGrid finished.  Zero for
+        /// other grids, or if the platform does not report it.
+        long peakMemoryKb() const;
+
+        /// Add the bytes of the grid's topology and geometry arrays to
+        /// the child "grid" of the report.
+        void reportMemory(MemoryReport& report) const;
+
         static void createGrdecl(Opm::DeckConstPtr deck, struct grdecl &grdecl);
 
     private:
@@ -90,10 +121,13 @@ namespace Opm
 
         // Construct corner-point grid from EclipseGrid.
         void initFromEclipseGrid(Opm::EclipseGridConstPtr eclipseGrid,
-                                 const std::vector<double>& poreVolumes);
+                                 const std::vector<double>& poreVolumes,
+                                 int geometryThreads = 0,
+                                 int geometryMask = GRID_GEOMETRY_ALL);
 
         // The managed UnstructuredGrid.
         UnstructuredGrid* ug_;
+        long peak_rss_kb_;
     };
 
 } // namespace Opm
@@ -24,66 +24,325 @@
 #include <boost/math/constants/constants.hpp>
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
-#include <set>
+#include <opm/common/ErrorMacros.hpp>
+
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
 
-namespace Opm
+namespace
 {
-    /// For each cell, find indices of all other cells sharing a vertex with it.
-    /// \param[in] grid    A grid object.
-    /// \return            A table of neighbour cell-indices by cell.
-    SparseTable<int> cellNeighboursAcrossVertices(const UnstructuredGrid& grid)
+    /// Face-neighbour cell graph in compressed row form.
+    void cellGraph(const UnstructuredGrid& grid,
+                   std::vector<int>& ptr,
+                   std::vector<int>& adj)
     {
-        // 1. Create vertex->cell mapping. We do this by iterating
-        //    over all faces, and adding both its cell neighbours
-        //    to each of its vertices' data.
-        using namespace UgGridHelpers;
-        const int num_vertices = grid.number_of_nodes;
-        std::vector<std::set<int>> v2c(num_vertices);
-        const int num_faces = numFaces(grid);
-        const auto fc = faceCells(grid);
-        for (int face = 0; face < num_faces; ++face) {
-            for (int nodepos = grid.face_nodepos[face]; nodepos < grid.face_nodepos[face + 1]; ++nodepos) {
-                const int vertex = grid.face_nodes[nodepos];
-                for (int face_nb = 0; face_nb < 2; ++face_nb) {
-                    const int face_nb_cell = fc(face, face_nb);
-                    if (face_nb_cell >= 0) {
-                        v2c[vertex].insert(face_nb_cell);
-                    }
+        const int nc = grid.number_of_cells;
+        ptr.assign(nc + 1, 0);
+        adj.resize(grid.cell_facepos[nc]);
+        int pos = 0;
+        for (int c = 0; c < nc; ++c) {
+            for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                const int f  = grid.cell_faces[hf];
+                const int c0 = grid.face_cells[2*f + 0];
+                const int c1 = grid.face_cells[2*f + 1];
+                const int nb = (c0 == c) ? c1 : c0;
+                if (nb >= 0 && nb != c) {
+                    adj[pos++] = nb;
                 }
             }
+            ptr[c + 1] = pos;
         }
+        adj.resize(pos);
+    }
 
-        // 2. For each cell, iterate over its faces, iterate over
-        //    their vertices, and collect all those vertices' cell
-        //    neighbours. Add as row to sparse table.
-        SparseTable<int> cell_nb;
-        const int num_cells = numCells(grid);
-        const auto c2f = cell2Faces(grid);
-        // Reserve sufficient room for cartesian grids in 2 and 3
-        // dimensions. Note that this is not a limit, just an
-        // optimization similar to std::vector.
-        cell_nb.reserve(num_cells, (dimensions(grid) == 2 ? 8 : 26) * num_cells);
-        std::set<int> nb;
-        for (int cell = 0; cell < num_cells; ++cell) {
-            nb.clear();
-            const auto cell_faces = c2f[cell];
-            const int num_cell_faces = cell_faces.size();
-            for (int local_face = 0; local_face < num_cell_faces; ++local_face) {
-                const int face = cell_faces[local_face];
-                for (int nodepos = grid.face_nodepos[face]; nodepos < grid.face_nodepos[face + 1]; ++nodepos) {
-                    const int vertex = grid.face_nodes[nodepos];
-                    nb.insert(v2c[vertex].begin(), v2c[vertex].end());
+    /// Breadth-first traversal from 'start', visiting neighbours in
+    /// order of increasing degree.  Appends visited cells to 'order'
+    /// and returns the index in 'order' where the last level begins.
+    std::size_t cuthillMcKee(const std::vector<int>& ptr,
+                             const std::vector<int>& adj,
+                             const int start,
+                             std::vector<char>& visited,
+                             std::vector<int>& order)
+    {
+        std::vector<int> nbs;
+        std::size_t head = order.size();
+        std::size_t level_begin = head;
+        std::size_t level_end   = head + 1;
+        order.push_back(start);
+        visited[start] = 1;
+        while (head < order.size()) {
+            if (head == level_end) {
+                level_begin = level_end;
+                level_end   = order.size();
+            }
+            const int c = order[head++];
+            nbs.assign(adj.begin() + ptr[c], adj.begin() + ptr[c + 1]);
+            std::stable_sort(nbs.begin(), nbs.end(), [&ptr](const int a, const int b) {
+                    return ptr[a + 1] - ptr[a] < ptr[b + 1] - ptr[b];
+                });
+            for (const int nb : nbs) {
+                if (!visited[nb]) {
+                    visited[nb] = 1;
+                    order.push_back(nb);
+                }
+            }
+        }
+        return level_begin;
+    }
+
+    std::vector<int> reverseCuthillMcKee(const UnstructuredGrid& grid)
+    {
+        const int nc = grid.number_of_cells;
+        std::vector<int> ptr, adj;
+        cellGraph(grid, ptr, adj);
+        auto degree = [&ptr](const int c) { return ptr[c + 1] - ptr[c]; };
+
+        std::vector<int> order;
+        order.reserve(nc);
+        std::vector<char> visited(nc, 0);
+        for (int seed = 0; seed < nc; ++seed) {
+            if (visited[seed]) {
+                continue;
+            }
+            // Find a pseudo-peripheral start cell: a cell of minimum
+            // degree in the last level of a traversal from 'seed'.
+            const std::size_t begin = order.size();
+            const std::size_t last = cuthillMcKee(ptr, adj, seed, visited, order);
+            const int start = *std::min_element(order.begin() + last, order.end(),
+                                                [&degree](const int a, const int b) {
+                                                    return degree(a) < degree(b);
+                                                });
+            for (std::size_t i = begin; i < order.size(); ++i) {
+                visited[order[i]] = 0;
+            }
+            order.resize(begin);
+            cuthillMcKee(ptr, adj, start, visited, order);
+        }
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    /// Hilbert index of a point with 'n' coordinates of 'b' bits each,
+    /// using Skilling's transpose algorithm.
+    std::uint64_t hilbertIndex(unsigned int x[], const int b, const int n)
+    {
+        const unsigned int m = 1u << (b - 1);
+        // Inverse undo.
+        for (unsigned int q = m; q > 1; q >>= 1) {
+            const unsigned int p = q - 1;
+            for (int i = 0; i < n; ++i) {
+                if (x[i] & q) {
+                    x[0] ^= p;
+                } else {
+                    const unsigned int t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
                 }
             }
-            nb.erase(cell);
-            cell_nb.appendRow(nb.begin(), nb.end());
         }
+        // Gray encode.
+        for (int i = 1; i < n; ++i) {
+            x[i] ^= x[i - 1];
+        }
+        unsigned int t = 0;
+        for (unsigned int q = m; q > 1; q >>= 1) {
+            if (x[n - 1] & q) {
+                t ^= q - 1;
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            x[i] ^= t;
+        }
+        // Interleave the transposed bits.
+        std::uint64_t key = 0;
+        for (int bit = b - 1; bit >= 0; --bit) {
+            for (int i = 0; i < n; ++i) {
+                key = (key << 1) | ((x[i] >> bit) & 1u);
+            }
+        }
+        return key;
+    }
+
+    std::vector<int> hilbertCurve(const UnstructuredGrid& grid)
+    {
+        const int nc  = grid.number_of_cells;
+        const int dim = grid.dimensions;
+        if (dim < 1 || dim > 3) {
+            OPM_THROW(std::logic_error, "Cannot compute Hilbert ordering in " << dim << " dimensions.");
+        }
+        const int bits = 63 / dim < 16 ? 63 / dim : 16;
+        const double* cc = Opm::UgGridHelpers::beginCellCentroids(grid);
+
+        double lo[3], hi[3];
+        for (int d = 0; d < dim; ++d) {
+            lo[d] =  std::numeric_limits<double>::max();
+            hi[d] = -std::numeric_limits<double>::max();
+        }
+        for (int c = 0; c < nc; ++c) {
+            for (int d = 0; d < dim; ++d) {
+                lo[d] = std::min(lo[d], cc[dim*c + d]);
+                hi[d] = std::max(hi[d], cc[dim*c + d]);
+            }
+        }
+
+        const double scale = double((1u << bits) - 1);
+        std::vector<std::uint64_t> key(nc);
+        for (int c = 0; c < nc; ++c) {
+            unsigned int x[3] = { 0, 0, 0 };
+            for (int d = 0; d < dim; ++d) {
+                const double ext = hi[d] - lo[d];
+                const double rel = ext > 0.0 ? (cc[dim*c + d] - lo[d]) / ext : 0.0;
+                x[d] = static_cast<unsigned int>(rel * scale + 0.5);
+            }
+            key[c] = hilbertIndex(x, bits, dim);
+        }
+
+        std::vector<int> order(nc);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&key](const int a, const int b) {
+                return key[a] < key[b];
+            });
+        return order;
+    }
+
+    /// Build a table with 'num_rows' rows, where 'row_func(i, row)'
+    /// appends the entries of row 'i' to 'row'. Each row is sorted and
+    /// made unique. Rows are computed in parallel, once for the sizes
+    /// and once for the entries, to avoid per-row storage.
+    template <class RowFunc>
+    Opm::SparseTable<int> buildSortedTable(const int num_rows, RowFunc row_func)
+    {
+        std::vector<int> sizes(num_rows);
+#pragma omp parallel
+        {
+            std::vector<int> row;
+#pragma omp for schedule(static)
+            for (int i = 0; i < num_rows; ++i) {
+                row.clear();
+                row_func(i, row);
+                std::sort(row.begin(), row.end());
+                sizes[i] = std::unique(row.begin(), row.end()) - row.begin();
+            }
+        }
+        Opm::SparseTable<int> table;
+        table.allocate(sizes.begin(), sizes.end());
+#pragma omp parallel
+        {
+            std::vector<int> row;
+#pragma omp for schedule(static)
+            for (int i = 0; i < num_rows; ++i) {
+                row.clear();
+                row_func(i, row);
+                std::sort(row.begin(), row.end());
+                std::unique(row.begin(), row.end());
+                std::copy(row.begin(), row.begin() + sizes[i], table[i].begin());
+            }
+        }
+        return table;
+    }
+
+    /// Vertices of each cell.
+    Opm::SparseTable<int> cellNodes(const UnstructuredGrid& grid)
+    {
+        return buildSortedTable(grid.number_of_cells, [&grid](const int c, std::vector<int>& row) {
+                for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                    const int f = grid.cell_faces[hf];
+                    row.insert(row.end(), grid.face_nodes + grid.face_nodepos[f],
+                               grid.face_nodes + grid.face_nodepos[f + 1]);
+                }
+            });
+    }
+
+    /// Transpose of the cell-node table. Filling the rows in order of
+    /// increasing cell index keeps them sorted.
+    Opm::SparseTable<int> nodeCells(const UnstructuredGrid& grid,
+                                    const Opm::SparseTable<int>& cell_nodes)
+    {
+        const int num_nodes = grid.number_of_nodes;
+        const int num_cells = grid.number_of_cells;
+        std::vector<int> sizes(num_nodes, 0);
+        for (int c = 0; c < num_cells; ++c) {
+            for (const int node : cell_nodes[c]) {
+                ++sizes[node];
+            }
+        }
+        Opm::SparseTable<int> node_cells;
+        node_cells.allocate(sizes.begin(), sizes.end());
+        std::fill(sizes.begin(), sizes.end(), 0);
+        for (int c = 0; c < num_cells; ++c) {
+            for (const int node : cell_nodes[c]) {
+                node_cells[node][sizes[node]++] = c;
+            }
+        }
+        return node_cells;
+    }
+
+    /// Cells sharing a vertex with each cell, excluding the cell itself.
+    Opm::SparseTable<int> vertexNeighbours(const Opm::SparseTable<int>& cell_nodes,
+                                           const Opm::SparseTable<int>& node_cells)
+    {
+        return buildSortedTable(cell_nodes.size(), [&](const int c, std::vector<int>& row) {
+                for (const int node : cell_nodes[c]) {
+                    for (const int nb : node_cells[node]) {
+                        if (nb != c) {
+                            row.push_back(nb);
+                        }
+                    }
+                }
+            });
+    }
 
-        // 3. Done. Return.
-        return cell_nb;
+    struct GridDeleter
+    {
+        void operator()(UnstructuredGrid* g) const { destroy_grid(g); }
+    };
+} // anonymous namespace
+
+namespace Opm
+{
+    /// For each cell, find indices of all other cells sharing a vertex with it.
+    /// \param[in] grid    A grid object.
+    /// \return            A table of neighbour cell-indices by cell.
+    SparseTable<int> cellNeighboursAcrossVertices(const UnstructuredGrid& grid)
+    {
+        const SparseTable<int> cell_nodes = cellNodes(grid);
+        return vertexNeighbours(cell_nodes, nodeCells(grid, cell_nodes));
+    }
+
+
+
+
+
+
+    /// Compute all connectivity tables of a grid, in parallel if
+    /// OpenMP is available.
+    /// \param[in] grid    A grid object.
+    /// \return            Connectivity tables, to be shared among solvers.
+    std::shared_ptr<const GridConnectivity> computeGridConnectivity(const UnstructuredGrid& grid)
+    {
+        auto conn = std::make_shared<GridConnectivity>();
+        conn->cell_face_neighbours = buildSortedTable(grid.number_of_cells,
+            [&grid](const int c, std::vector<int>& row) {
+                for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                    const int f  = grid.cell_faces[hf];
+                    const int c0 = grid.face_cells[2*f + 0];
+                    const int c1 = grid.face_cells[2*f + 1];
+                    const int nb = (c0 == c) ? c1 : c0;
+                    if (nb >= 0 && nb != c) {
+                        row.push_back(nb);
+                    }
+                }
+            });
+        conn->cell_nodes = cellNodes(grid);
+        conn->node_cells = nodeCells(grid, conn->cell_nodes);
+        conn->cell_vertex_neighbours = vertexNeighbours(conn->cell_nodes, conn->node_cells);
+        return conn;
     }
 
 
@@ -130,4 +389,158 @@ namespace Opm
         }
     }
 
+
+
+
+    /// Compute a cache-friendly cell order.
+    std::vector<int> computeCellOrdering(const UnstructuredGrid& grid,
+                                         const CellOrdering ordering)
+    {
+        switch (ordering) {
+        case ReverseCuthillMcKeeOrdering:
+            return reverseCuthillMcKee(grid);
+        case HilbertCurveOrdering:
+            return hilbertCurve(grid);
+        default:
+            OPM_THROW(std::logic_error, "Unknown cell ordering " << ordering);
+        }
+    }
+
+
+
+
+    /// Create a copy of a grid with renumbered cells and faces.
+    UnstructuredGrid* reorderGrid(const UnstructuredGrid& grid,
+                                  const std::vector<int>& cell_new_to_old,
+                                  GridPermutation& perm)
+    {
+        const int nc  = grid.number_of_cells;
+        const int nf  = grid.number_of_faces;
+        const int dim = grid.dimensions;
+        if (int(cell_new_to_old.size()) != nc) {
+            OPM_THROW(std::logic_error, "Cell permutation has " << cell_new_to_old.size()
+                      << " entries, grid has " << nc << " cells.");
+        }
+
+        // Cell permutation.
+        perm.cell_new_to_old = cell_new_to_old;
+        perm.cell_old_to_new.assign(nc, -1);
+        for (int c = 0; c < nc; ++c) {
+            const int oc = cell_new_to_old[c];
+            if (oc < 0 || oc >= nc || perm.cell_old_to_new[oc] != -1) {
+                OPM_THROW(std::logic_error, "Invalid cell permutation.");
+            }
+            perm.cell_old_to_new[oc] = c;
+        }
+
+        // Faces in order of first appearance in the new cell order.
+        perm.face_old_to_new.assign(nf, -1);
+        perm.face_new_to_old.clear();
+        perm.face_new_to_old.reserve(nf);
+        for (int c = 0; c < nc; ++c) {
+            const int oc = cell_new_to_old[c];
+            for (int hf = grid.cell_facepos[oc]; hf < grid.cell_facepos[oc + 1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                if (perm.face_old_to_new[f] == -1) {
+                    perm.face_old_to_new[f] = perm.face_new_to_old.size();
+                    perm.face_new_to_old.push_back(f);
+                }
+            }
+        }
+        for (int f = 0; f < nf; ++f) {
+            // Faces not connected to any cell keep their relative order.
+            if (perm.face_old_to_new[f] == -1) {
+                perm.face_old_to_new[f] = perm.face_new_to_old.size();
+                perm.face_new_to_old.push_back(f);
+            }
+        }
+
+        std::unique_ptr<UnstructuredGrid, GridDeleter>
+            g(allocate_grid(dim, nc, nf, grid.face_nodepos[nf],
+                            grid.cell_facepos[nc], grid.number_of_nodes));
+        if (!g) {
+            OPM_THROW(std::runtime_error, "Failed to allocate reordered grid.");
+        }
+        g->dimensions      = dim;
+        g->number_of_cells = nc;
+        g->number_of_faces = nf;
+        g->number_of_nodes = grid.number_of_nodes;
+        std::copy(grid.cartdims, grid.cartdims + 3, g->cartdims);
+        std::copy(grid.node_coordinates, grid.node_coordinates + dim*grid.number_of_nodes,
+                  g->node_coordinates);
+
+        // Faces.
+        g->face_nodepos[0] = 0;
+        for (int f = 0; f < nf; ++f) {
+            const int of = perm.face_new_to_old[f];
+            const int* nb = grid.face_nodes + grid.face_nodepos[of];
+            const int* ne = grid.face_nodes + grid.face_nodepos[of + 1];
+            std::copy(nb, ne, g->face_nodes + g->face_nodepos[f]);
+            g->face_nodepos[f + 1] = g->face_nodepos[f] + (ne - nb);
+            for (int k = 0; k < 2; ++k) {
+                const int oc = grid.face_cells[2*of + k];
+                g->face_cells[2*f + k] = (oc >= 0) ? perm.cell_old_to_new[oc] : oc;
+            }
+            g->face_areas[f] = grid.face_areas[of];
+            if (grid.face_centroids != 0) {
+                std::copy(grid.face_centroids + dim*of, grid.face_centroids + dim*(of + 1),
+                          g->face_centroids + dim*f);
+            }
+            std::copy(grid.face_normals + dim*of, grid.face_normals + dim*(of + 1),
+                      g->face_normals + dim*f);
+        }
+
+        // Cells.
+        if (grid.cell_facetag == 0) {
+            free(g->cell_facetag);
+            g->cell_facetag = 0;
+        }
+        g->global_cell = static_cast<int*>(malloc(nc * sizeof *g->global_cell));
+        if (nc > 0 && g->global_cell == 0) {
+            OPM_THROW(std::runtime_error, "Failed to allocate reordered grid.");
+        }
+        g->cell_facepos[0] = 0;
+        for (int c = 0; c < nc; ++c) {
+            const int oc = cell_new_to_old[c];
+            int pos = g->cell_facepos[c];
+            for (int hf = grid.cell_facepos[oc]; hf < grid.cell_facepos[oc + 1]; ++hf, ++pos) {
+                g->cell_faces[pos] = perm.face_old_to_new[grid.cell_faces[hf]];
+                if (g->cell_facetag != 0) {
+                    g->cell_facetag[pos] = grid.cell_facetag[hf];
+                }
+            }
+            g->cell_facepos[c + 1] = pos;
+            g->global_cell[c] = (grid.global_cell != 0) ? grid.global_cell[oc] : oc;
+            g->cell_volumes[c] = grid.cell_volumes[oc];
+            if (grid.cell_centroids != 0) {
+                std::copy(grid.cell_centroids + dim*oc, grid.cell_centroids + dim*(oc + 1),
+                          g->cell_centroids + dim*c);
+            }
+        }
+
+        // Keep omitted optional geometry omitted.
+        if (grid.face_centroids == 0) {
+            free(g->face_centroids);
+            g->face_centroids = 0;
+        }
+        if (grid.cell_centroids == 0) {
+            free(g->cell_centroids);
+            g->cell_centroids = 0;
+        }
+
+        grid_update_hash(g.get());
+
+        return g.release();
+    }
+
+
+
+
+    UnstructuredGrid* reorderGrid(const UnstructuredGrid& grid,
+                                  const CellOrdering ordering,
+                                  GridPermutation& perm)
+    {
+        return reorderGrid(grid, computeCellOrdering(grid, ordering), perm);
+    }
+
 } // namespace Opm
@@ -23,6 +23,10 @@
 #include <opm/core/grid.h>
 #include <opm/core/utility/SparseTable.hpp>
 
+#include <cassert>
+#include <memory>
+#include <vector>
+
 namespace Opm
 {
 
@@ -31,12 +35,123 @@ namespace Opm
     /// \return            A table of neighbour cell-indices by cell.
     SparseTable<int> cellNeighboursAcrossVertices(const UnstructuredGrid& grid);
 
+    /// Connectivity tables of a grid. Computed once by
+    /// computeGridConnectivity() and shared by the solvers that need
+    /// them. All rows are sorted by increasing index.
+    struct GridConnectivity
+    {
+        /// Cells sharing a face with each cell.
+        SparseTable<int> cell_face_neighbours;
+        /// Cells sharing a vertex with each cell, as from
+        /// cellNeighboursAcrossVertices().
+        SparseTable<int> cell_vertex_neighbours;
+        /// Vertices of each cell.
+        SparseTable<int> cell_nodes;
+        /// Cells adjacent to each vertex.
+        SparseTable<int> node_cells;
+    };
+
+    /// Compute all connectivity tables of a grid, in parallel if
+    /// OpenMP is available.
+    /// \param[in] grid    A grid object.
+    /// \return            Connectivity tables, to be shared among solvers.
+    std::shared_ptr<const GridConnectivity> computeGridConnectivity(const UnstructuredGrid& grid);
+
     /// For each cell, order the (cell) neighbours counterclockwise.
     /// \param[in] grid    A 2d grid object.
     /// \param[in, out] nb A cell-cell neighbourhood table, such as from vertexNeighbours().
     void orderCounterClockwise(const UnstructuredGrid& grid,
                                SparseTable<int>& nb);
 
+    /// Cell orderings supported by computeCellOrdering().
+    enum CellOrdering {
+        /// Reverse Cuthill-McKee ordering of the face-neighbour graph.
+        ReverseCuthillMcKeeOrdering,
+        /// Order of cell centroids along a Hilbert space-filling curve.
+        HilbertCurveOrdering
+    };
+
+    /// Cell and face permutations of a grid created by reorderGrid().
+    /// Entry i of a 'new_to_old' vector is the original index of
+    /// cell/face i in the reordered grid; 'old_to_new' is its inverse.
+    struct GridPermutation
+    {
+        std::vector<int> cell_new_to_old;
+        std::vector<int> cell_old_to_new;
+        std::vector<int> face_new_to_old;
+        std::vector<int> face_old_to_new;
+    };
+
+    /// Compute a cache-friendly cell order.
+    /// \param[in] grid      A grid object with geometry.
+    /// \param[in] ordering  Ordering strategy.
+    /// \return              Original cell index of each cell in the new order.
+    std::vector<int> computeCellOrdering(const UnstructuredGrid& grid,
+                                         const CellOrdering ordering);
+
+    /// Create a copy of a grid with renumbered cells and faces.
+    /// Cells appear in the order given by 'cell_new_to_old'.  Faces are
+    /// numbered in order of first appearance when traversing the cells
+    /// of the new grid, so the faces of neighbouring cells are close in
+    /// memory.  The orientation of each face and the node numbering are
+    /// unchanged.  The global_cell field of the new grid is always set,
+    /// so logical Cartesian indices (and hence deck properties) keep
+    /// referring to the same physical cells.
+    /// \param[in] grid             A grid object with geometry.
+    /// \param[in] cell_new_to_old  A permutation of [0, number_of_cells).
+    /// \param[out] perm            Resulting cell and face permutations.
+    /// \return  Reordered grid, to be released with destroy_grid().
+    UnstructuredGrid* reorderGrid(const UnstructuredGrid& grid,
+                                  const std::vector<int>& cell_new_to_old,
+                                  GridPermutation& perm);
+
+    /// Convenience overload using computeCellOrdering().
+    UnstructuredGrid* reorderGrid(const UnstructuredGrid& grid,
+                                  const CellOrdering ordering,
+                                  GridPermutation& perm);
+
+    /// Map per-cell data of a reordered grid back to the original
+    /// cell order, e.g. before output.
+    /// \param[in] perm       Permutations from reorderGrid().
+    /// \param[in] reordered  Data in new order, 'ncomp' values per cell.
+    /// \param[in] ncomp      Number of components per cell.
+    /// \return               Data in original order.
+    template <typename T>
+    std::vector<T> restoreCellOrder(const GridPermutation& perm,
+                                    const std::vector<T>& reordered,
+                                    const int ncomp = 1)
+    {
+        const int nc = perm.cell_new_to_old.size();
+        assert(int(reordered.size()) == nc * ncomp);
+        std::vector<T> original(reordered.size());
+        for (int c = 0; c < nc; ++c) {
+            const int oc = perm.cell_new_to_old[c];
+            for (int k = 0; k < ncomp; ++k) {
+                original[oc*ncomp + k] = reordered[c*ncomp + k];
+            }
+        }
+        return original;
+    }
+
+    /// Map per-cell data in original cell order to the order of a
+    /// reordered grid.  Inverse of restoreCellOrder().
+    template <typename T>
+    std::vector<T> applyCellOrder(const GridPermutation& perm,
+                                  const std::vector<T>& original,
+                                  const int ncomp = 1)
+    {
+        const int nc = perm.cell_new_to_old.size();
+        assert(int(original.size()) == nc * ncomp);
+        std::vector<T> reordered(original.size());
+        for (int c = 0; c < nc; ++c) {
+            const int oc = perm.cell_new_to_old[c];
+            for (int k = 0; k < ncomp; ++k) {
+                reordered[c*ncomp + k] = original[oc*ncomp + k];
+            }
+        }
+        return reordered;
+    }
+
 } // namespace Opm
 
 #endif // OPM_GRIDUTILITIES_HEADER_INCLUDED
@@ -54,9 +54,13 @@ namespace Opm
                      const bool mergeMinPVCells,
                      double* zcorn) const;
     private:
-        std::array<int,8> cornerIndices(const int i, const int j, const int k) const;
-        std::array<double, 8> getCellZcorn(const int i, const int j, const int k, const double* z) const;
-        void setCellZcorn(const int i, const int j, const int k, const std::array<double, 8>& cellz, double* z) const;
+        /// Apply process() to the cells of column (i, j), top to bottom.
+        void processColumn(const int i, const int j,
+                           const std::vector<double>& pv,
+                           const double minpv,
+                           const std::vector<int>& actnum,
+                           const bool mergeMinPVCells,
+                           double* zcorn) const;
         std::array<int, 3> dims_;
         std::array<int, 3> delta_;
     };
@@ -101,73 +105,53 @@ namespace Opm
             OPM_THROW(std::runtime_error, "Wrong size of ACTNUM input, must have one element per logical cartesian cell.");
         }
 
-        // Main loop.
-        for (int kk = 0; kk < dims_[2]; ++kk) {
-            for (int jj = 0; jj < dims_[1]; ++jj) {
-                for (int ii = 0; ii < dims_[0]; ++ii) {
-                    const int c = ii + dims_[0] * (jj + dims_[1] * kk);
-                    if (pv[c] < minpv && (actnum.empty() || actnum[c])) {
-                        // Move deeper (higher k) coordinates to lower k coordinates.
-                        std::array<double, 8> cz = getCellZcorn(ii, jj, kk, zcorn);
-                        for (int count = 0; count < 4; ++count) {
-                            cz[count + 4] = cz[count];
-                        }
-                        setCellZcorn(ii, jj, kk, cz, zcorn);
-
-                        // optionally add removed volume to the cell below.
-                        if (mergeMinPVCells) {
-                            // Check if there is a cell below.
-                            if (pv[c] > 0.0 && kk < dims_[2] - 1) {
-                                // Set lower k coordinates of cell below to upper cells's coordinates.
-                                std::array<double, 8> cz_below = getCellZcorn(ii, jj, kk + 1, zcorn);
-                                for (int count = 0; count < 4; ++count) {
-                                    cz_below[count] = cz[count];
-                                }
-                                setCellZcorn(ii, jj, kk + 1, cz_below, zcorn);
-                            }
-                        }
-                    }
-                }
-            }
+        // Main loop.  Columns are independent since every cell owns
+        // its eight ZCORN values, so they are processed in parallel.
+        const int ncol = dims_[0] * dims_[1];
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (int col = 0; col < ncol; ++col) {
+            processColumn(col % dims_[0], col / dims_[0], pv, minpv, actnum, mergeMinPVCells, zcorn);
         }
     }
 
 
 
-    inline std::array<int,8> MinpvProcessor::cornerIndices(const int i, const int j, const int k) const
-    {
-        const int ix = 2*(i*delta_[0] + j*delta_[1] + k*delta_[2]);
-        std::array<int, 8> ixs = {{ ix,                         ix + delta_[0],
-                                    ix + delta_[1],             ix + delta_[1] + delta_[0],
-                                    ix + delta_[2],             ix + delta_[2] + delta_[0],
-                                    ix + delta_[2] + delta_[1], ix + delta_[2] + delta_[1] + delta_[0] }};
-
-        return ixs;
-    }
-
-
-
-    // Returns the eight z-values associated with a given cell.
-    // The ordering is such that i runs fastest. That is, with
-    // L = low and H = high:
-    // {LLL, HLL, LHL, HHL, LLH, HLH, LHH, HHH }.
-    inline std::array<double, 8> MinpvProcessor::getCellZcorn(const int i, const int j, const int k, const double* z) const
+    inline void MinpvProcessor::processColumn(const int ii, const int jj,
+                                              const std::vector<double>& pv,
+                                              const double minpv,
+                                              const std::vector<int>& actnum,
+                                              const bool mergeMinPVCells,
+                                              double* zcorn) const
     {
-        const std::array<int, 8> ixs = cornerIndices(i, j, k);
-        std::array<double, 8> cellz;
-        for (int count = 0; count < 8; ++count) {
-            cellz[count] = z[ixs[count]];
-        }
-        return cellz;
-    }
-
-
+        // Offsets of the four corners of a cell's top (or bottom)
+        // face relative to its first corner.  Cell (ii, jj, kk) has
+        // its top corners at top + 2*kk*delta_[2] and its bottom
+        // corners delta_[2] further on.
+        const int off[4] = { 0, delta_[0], delta_[1], delta_[1] + delta_[0] };
+        const int top = 2*(ii*delta_[0] + jj*delta_[1]);
+        const int nxy = dims_[0] * dims_[1];
+        int c = ii + dims_[0]*jj;
+        for (int kk = 0; kk < dims_[2]; ++kk, c += nxy) {
+            if (pv[c] < minpv && (actnum.empty() || actnum[c])) {
+                // Move deeper (higher k) coordinates to lower k coordinates.
+                const double* zt = zcorn + top + 2*kk*delta_[2];
+                double*       zb = zcorn + top + 2*kk*delta_[2] + delta_[2];
+                for (int count = 0; count < 4; ++count) {
+                    zb[off[count]] = zt[off[count]];
+                }
 
-    inline void MinpvProcessor::setCellZcorn(const int i, const int j, const int k, const std::array<double, 8>& cellz, double* z) const
-    {
-        const std::array<int, 8> ixs = cornerIndices(i, j, k);
-        for (int count = 0; count < 8; ++count) {
-            z[ixs[count]] = cellz[count];
+                // optionally add removed volume to the cell below.
+                // Check if there is a cell below.
+                if (mergeMinPVCells && pv[c] > 0.0 && kk < dims_[2] - 1) {
+                    // Set lower k coordinates of cell below to upper cells's coordinates.
+                    double* zn = zb + delta_[2];
+                    for (int count = 0; count < 4; ++count) {
+                        zn[off[count]] = zt[off[count]];
+                    }
+                }
+            }
         }
     }
 
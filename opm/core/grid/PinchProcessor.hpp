@@ -26,10 +26,12 @@
 #include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/PinchMode.hpp>
 #include <opm/core/utility/Units.hpp>
+#include <opm/core/utility/compressedToCartesian.hpp>
 #include <array>
 #include <iostream>
 #include <algorithm>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <limits>
 
 namespace Opm
@@ -66,12 +68,30 @@ namespace Opm
                      const std::vector<double>& pv,
                      NNC& nnc);
 
+        /// Generate NNCs for cells which pv is less than MINPV, in flat form.
+        /// \param[in]    Grid      cpgrid or unstructured grid
+        /// \param[in]    htrans    half cell transmissibility, size is number of cellfaces.
+        /// \param[in]    multz     Z+ transmissibility multiplier for all active cells
+        /// \param[in]    pv        pore volume for all the cartesian cells
+        /// \param[out]   nncCells  global (cartesian) cell indices of the NNCs,
+        ///                          two consecutive entries per connection.
+        /// \param[out]   nncTrans  transmissibility of each connection.
+        void process(const Grid& grid,
+                     const std::vector<double>& htrans,
+                     const std::vector<int>& actnum,
+                     const std::vector<double>& multz,
+                     const std::vector<double>& pv,
+                     std::vector<int>& nncCells,
+                     std::vector<double>& nncTrans);
+
     private:
         double minpvValue_;
         double thickness_;
         PinchMode::ModeEnum transMode_;
         PinchMode::ModeEnum multzMode_;
-        
+        /// Active cell index of every cartesian cell, -1 if inactive.
+        std::vector<int> activeIdx_;
+
         /// Mark minpved cells.
         std::vector<int> getMinpvCells_(const std::vector<int>& actnum,
                                         const std::vector<double>& pv);
@@ -108,6 +128,9 @@ namespace Opm
         /// Get map between half-trans index and the pair of face index and cell index.
         std::vector<int> getHfIdxMap_(const Grid& grid);
         
+        /// Set up the map from cartesian to active cell indices.
+        void buildActiveIdx_(const Grid& grid);
+
         /// Get active cell index.
         int getActiveCellIdx_(const Grid& grid,
                               const int globalIdx);
@@ -118,10 +141,13 @@ namespace Opm
                           const std::vector<int>& actnum,
                           const std::vector<double>& multz,
                           const std::vector<double>& pv,
-                          NNC& nnc);
-        
+                          std::vector<int>& nncCells,
+                          std::vector<double>& nncTrans);
+
         /// Item 5 in PINCH keyword.
-        std::unordered_multimap<int, double> multzOptions_(const Grid& grid,
+        /// Returns (face, multiplier) pairs, segment i belonging to the
+        /// pinch pair (pinCells[2*i], pinCells[2*i+1]).
+        std::vector<std::pair<int, double> > multzOptions_(const Grid& grid,
                                                            const std::vector<int>& pinCells,
                                                            const std::vector<int>& pinFaces,
                                                            const std::vector<double>& multz,
@@ -129,7 +155,7 @@ namespace Opm
 
         /// Apply multz vector to face transmissibility.
         void applyMultz_(std::vector<double>& trans,
-                         const std::unordered_multimap<int, double>& multzmap);
+                         const std::vector<std::pair<int, double> >& multzmap);
 
     };
 
@@ -267,19 +293,27 @@ namespace Opm
 
 
     template<class Grid>
-    inline int PinchProcessor<Grid>::getActiveCellIdx_(const Grid& grid,
-                                                       const int globalIdx)
+    inline void PinchProcessor<Grid>::buildActiveIdx_(const Grid& grid)
     {
         const int nc = Opm::UgGridHelpers::numCells(grid);
+        const int* dims = Opm::UgGridHelpers::cartDims(grid);
         const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
-        int idx = -1;
-        for (int i = 0; i < nc; ++i) {
-            if (global_cell[i] == globalIdx) {
-                idx = i;
-                break;
-            }
+        activeIdx_ = Opm::cartesianToCompressed(nc, global_cell, dims[0] * dims[1] * dims[2]);
+    }
+
+
+
+    template<class Grid>
+    inline int PinchProcessor<Grid>::getActiveCellIdx_(const Grid& grid,
+                                                       const int globalIdx)
+    {
+        if (activeIdx_.empty()) {
+            buildActiveIdx_(grid);
+        }
+        if (globalIdx < 0 || globalIdx >= static_cast<int>(activeIdx_.size())) {
+            return -1;
         }
-        return idx;
+        return activeIdx_[globalIdx];
     }
 
 
@@ -297,15 +331,19 @@ namespace Opm
         auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
         const auto& hfmap = getHfIdxMap_(grid); 
         const auto& f2c = Opm::UgGridHelpers::faceCells(grid);
+        // First position of each face in pinFaces, -1 if not pinched.
+        std::vector<int> pinPos(nf, -1);
+        for (int idx = static_cast<int>(pinFaces.size()) - 1; idx >= 0; --idx) {
+            pinPos[pinFaces[idx]] = idx;
+        }
         for (int cellIdx = 0; cellIdx < nc; ++cellIdx) {
             auto cellFacesRange = cell_faces[cellIdx];
             for (auto cellFaceIter = cellFacesRange.begin(); cellFaceIter != cellFacesRange.end(); ++cellFaceIter, ++cellFaceIdx) {
                 const int faceIdx = *cellFaceIter;
-                const auto pos = std::find(pinFaces.begin(), pinFaces.end(), faceIdx);
-                if (pos == pinFaces.end()) {
+                if (pinPos[faceIdx] < 0) {
                     trans[faceIdx] += 1. / htrans[cellFaceIdx];
                 } else {
-                    const int idx1 = std::distance(std::begin(pinFaces), pos);
+                    const int idx1 = pinPos[faceIdx];
                     int idx2;
                     if (idx1 % 2 == 0) {
                         idx2 = idx1 + 1;
@@ -337,22 +375,20 @@ namespace Opm
         const int* dims = Opm::UgGridHelpers::cartDims(grid);
         std::vector<int> minpvCells = getMinpvCells_(actnum, pv);
         std::vector<std::vector<int>> segment;
-        for (int z = 0; z < dims[2]; ++z) {
-            for (int y = 0; y < dims[1]; ++y) {
-                for (int x = 0; x < dims[0]; ++x) {
+        // Each (x, y) column is scanned once from top to bottom,
+        // collecting maximal runs of consecutive minpv cells.
+        for (int y = 0; y < dims[1]; ++y) {
+            for (int x = 0; x < dims[0]; ++x) {
+                for (int z = 0; z < dims[2]; ++z) {
                     const int c = getGlobalIndex_(x, y, z, dims);
-                    std::vector<int> seg;
                     if (minpvCells[c]) {
-                        seg.push_back(c);
-                        minpvCells[c] = 0;
-                        for (int zz = z+1; zz < dims[2]; ++zz) {
-                            const int cc =  getGlobalIndex_(x, y, zz, dims);
-                            if (minpvCells[cc]) {
-                                seg.push_back(cc);
-                                minpvCells[cc] = 0;
-                            } else {
+                        std::vector<int> seg;
+                        for (; z < dims[2]; ++z) {
+                            const int cc = getGlobalIndex_(x, y, z, dims);
+                            if (!minpvCells[cc]) {
                                 break;
                             }
+                            seg.push_back(cc);
                         }
                         segment.push_back(seg);
                     }
@@ -360,6 +396,11 @@ namespace Opm
             }
         }
 
+        // Order segments by their top cell, as a layer-by-layer traversal would.
+        std::sort(segment.begin(), segment.end(),
+                  [](const std::vector<int>& a, const std::vector<int>& b)
+                  { return a.front() < b.front(); });
+
         return segment;
     }
 
@@ -371,7 +412,8 @@ namespace Opm
                                                    const std::vector<int>& actnum,
                                                    const std::vector<double>& multz,
                                                    const std::vector<double>& pv,
-                                                   NNC& nnc)
+                                                   std::vector<int>& nncCells,
+                                                   std::vector<double>& nncTrans)
     {
         const int* dims = Opm::UgGridHelpers::cartDims(grid);
         std::vector<int> pinFaces;
@@ -419,8 +461,11 @@ namespace Opm
         auto faceTrans = transCompute_(grid, htrans, pinCells, pinFaces);
         auto multzmap = multzOptions_(grid, pinCells, pinFaces, multz, newSeg);
         applyMultz_(faceTrans, multzmap);
-        for (int i = 0; i < static_cast<int>(pinCells.size())/2; ++i) {
-            nnc.addNNC(static_cast<int>(pinCells[2*i]), static_cast<int>(pinCells[2*i+1]), faceTrans[pinFaces[2*i]]);
+        const int nnnc = static_cast<int>(pinCells.size())/2;
+        nncCells = pinCells;
+        nncTrans.resize(nnnc);
+        for (int i = 0; i < nnnc; ++i) {
+            nncTrans[i] = faceTrans[pinFaces[2*i]];
         }
     }
         
@@ -428,20 +473,22 @@ namespace Opm
  
 
     template<class Grid>
-    inline std::unordered_multimap<int, double> PinchProcessor<Grid>::multzOptions_(const Grid& grid,
+    inline std::vector<std::pair<int, double> > PinchProcessor<Grid>::multzOptions_(const Grid& grid,
                                                                                     const std::vector<int>& pinCells,
                                                                                     const std::vector<int>& pinFaces,
                                                                                     const std::vector<double>& multz,
                                                                                     const std::vector<std::vector<int> >& segs)
     {
-        std::unordered_multimap<int, double> multzmap;
+        std::vector<std::pair<int, double> > multzmap;
+        multzmap.reserve(pinFaces.size());
         if (multzMode_ == PinchMode::ModeEnum::TOP) {
             for (int i = 0; i < static_cast<int>(pinFaces.size())/2; ++i) {
-                multzmap.insert(std::make_pair(pinFaces[2*i], multz[getActiveCellIdx_(grid, pinCells[2*i])]));
-                multzmap.insert(std::make_pair(pinFaces[2*i+1],multz[getActiveCellIdx_(grid, pinCells[2*i])]));
+                multzmap.push_back(std::make_pair(pinFaces[2*i], multz[getActiveCellIdx_(grid, pinCells[2*i])]));
+                multzmap.push_back(std::make_pair(pinFaces[2*i+1],multz[getActiveCellIdx_(grid, pinCells[2*i])]));
             }
         } else if (multzMode_ == PinchMode::ModeEnum::ALL) {
-            for (auto& seg : segs) {
+            for (int s = 0; s < static_cast<int>(segs.size()); ++s) {
+                const auto& seg = segs[s];
                 //find the min multz in seg cells.
                 auto multzValue = std::numeric_limits<double>::max();
                 for (auto& cellIdx : seg) {
@@ -450,10 +497,9 @@ namespace Opm
                         multzValue = std::min(multzValue, multz[activeIdx]);
                     }
                 }
-                //find the right face.
-                auto index = std::distance(std::begin(pinCells), std::find(pinCells.begin(), pinCells.end(), seg.front()));
-                multzmap.insert(std::make_pair(pinFaces[index], multzValue));
-                multzmap.insert(std::make_pair(pinFaces[index+1], multzValue));
+                //the faces of the pinch pair the segment belongs to.
+                multzmap.push_back(std::make_pair(pinFaces[2*s], multzValue));
+                multzmap.push_back(std::make_pair(pinFaces[2*s+1], multzValue));
             }
         }
 
@@ -464,7 +510,7 @@ namespace Opm
 
     template<class Grid>
     inline void PinchProcessor<Grid>::applyMultz_(std::vector<double>& trans,
-                                                  const std::unordered_multimap<int, double>& multzmap)
+                                                  const std::vector<std::pair<int, double> >& multzmap)
     {
         for (auto& x : multzmap) {
             trans[x.first] *= x.second;
@@ -481,7 +527,27 @@ namespace Opm
                                               const std::vector<double>& pv,
                                               NNC& nnc)
     {
-        transTopbot_(grid, htrans, actnum, multz, pv, nnc);
+        std::vector<int> nncCells;
+        std::vector<double> nncTrans;
+        process(grid, htrans, actnum, multz, pv, nncCells, nncTrans);
+        for (int i = 0; i < static_cast<int>(nncTrans.size()); ++i) {
+            nnc.addNNC(nncCells[2*i], nncCells[2*i+1], nncTrans[i]);
+        }
+    }
+
+
+
+    template <class Grid>
+    inline void PinchProcessor<Grid>::process(const Grid& grid,
+                                              const std::vector<double>& htrans,
+                                              const std::vector<int>& actnum,
+                                              const std::vector<double>& multz,
+                                              const std::vector<double>& pv,
+                                              std::vector<int>& nncCells,
+                                              std::vector<double>& nncTrans)
+    {
+        buildActiveIdx_(grid);
+        transTopbot_(grid, htrans, actnum, multz, pv, nncCells, nncTrans);
     }
 
 } // namespace Opm
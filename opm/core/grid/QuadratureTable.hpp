@@ -0,0 +1,134 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_QUADRATURETABLE_HEADER_INCLUDED
+#define OPM_QUADRATURETABLE_HEADER_INCLUDED
+
+#include <opm/core/grid.h>
+#include <numeric>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Precomputed quadrature points and weights for all cells or all
+    /// faces of a grid, for a fixed degree of precision.
+    ///
+    /// The Quadrature template argument is CellQuadrature or
+    /// FaceQuadrature, and the table holds exactly the points and
+    /// weights these compute, so that a solver visiting every entity
+    /// repeatedly does the subdivision geometry only once. With OpenMP,
+    /// the table is built concurrently. The points of all entities are
+    /// numbered consecutively, entity by entity, which allows callers to
+    /// tabulate further per-point data (such as basis function values)
+    /// by pointIndex().
+    template <class Quadrature>
+    class QuadratureTable
+    {
+    public:
+        /// Construct an empty table.
+        QuadratureTable()
+            : dim_(0), pos_(1, 0)
+        {
+        }
+
+        /// Construct table.
+        /// \param[in] grid          A grid of dimension <= 3.
+        /// \param[in] num_entities  Number of cells (for CellQuadrature)
+        ///                          or faces (for FaceQuadrature) of grid.
+        /// \param[in] degree        Degree of precision, as for Quadrature.
+        QuadratureTable(const UnstructuredGrid& grid,
+                        const int num_entities,
+                        const int degree)
+            : dim_(grid.dimensions), pos_(num_entities + 1, 0)
+        {
+            if (num_entities == 0) {
+                return;
+            }
+            // Check the arguments outside the parallel regions,
+            // since the constructor may throw.
+            Quadrature check(grid, 0, degree);
+            static_cast<void>(check);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (int e = 0; e < num_entities; ++e) {
+                pos_[e + 1] = Quadrature(grid, e, degree).numQuadPts();
+            }
+            std::partial_sum(pos_.begin(), pos_.end(), pos_.begin());
+            coord_.resize(dim_*pos_.back());
+            weight_.resize(pos_.back());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (int e = 0; e < num_entities; ++e) {
+                const Quadrature quad(grid, e, degree);
+                for (int i = 0; i < pos_[e + 1] - pos_[e]; ++i) {
+                    quad.quadPtCoord(i, &coord_[dim_*(pos_[e] + i)]);
+                    weight_[pos_[e] + i] = quad.quadPtWeight(i);
+                }
+            }
+        }
+
+        /// Number of cells or faces.
+        int numEntities() const
+        {
+            return pos_.size() - 1;
+        }
+
+        /// Total number of quadrature points of all entities.
+        int numQuadPts() const
+        {
+            return pos_.back();
+        }
+
+        /// Number of quadrature points of an entity.
+        int numQuadPts(const int entity) const
+        {
+            return pos_[entity + 1] - pos_[entity];
+        }
+
+        /// Index of an entity's quadrature point among all points.
+        int pointIndex(const int entity, const int index) const
+        {
+            return pos_[entity] + index;
+        }
+
+        /// Coordinates of a quadrature point (dimension values).
+        const double* quadPtCoord(const int entity, const int index) const
+        {
+            return &coord_[dim_*(pos_[entity] + index)];
+        }
+
+        /// Weight of a quadrature point, as for Quadrature::quadPtWeight().
+        double quadPtWeight(const int entity, const int index) const
+        {
+            return weight_[pos_[entity] + index];
+        }
+
+    private:
+        int dim_;
+        std::vector<int> pos_;          // point start of each entity
+        std::vector<double> coord_;     // dim_ per point
+        std::vector<double> weight_;    // one per point
+    };
+
+} // namespace Opm
+
+#endif // OPM_QUADRATURETABLE_HEADER_INCLUDED
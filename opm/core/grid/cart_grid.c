@@ -129,6 +129,8 @@ create_grid_tensor2d(int nx, int ny, const double *x, const double *y)
     {
         fill_cart_topology_2d(G);
         fill_cart_geometry_2d(G, x, y);
+
+        grid_update_hash(G);
     }
 
     return G;
@@ -155,8 +157,11 @@ create_grid_tensor3d(int           nx    ,
 
         if (depthz == NULL) {
             fill_cart_geometry_3d(G, x, y, z);
+
+            grid_update_hash(G);
         }
         else {
+            /* Hashed by compute_geometry(). */
             fill_layered_geometry_3d(G, x, y, z, depthz);
         }
     }
@@ -0,0 +1,545 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/grid.h>
+#include <opm/core/grid/coarse_grid.h>
+#include <opm/core/pressure/msmfem/coarse_conn.h>
+
+#include <stdlib.h>
+
+/* Initial size of the table of fine faces in each coarse face. */
+#define COARSE_GRID_EXPCT_NCONN 16
+
+
+/* Directed edge (or, in two space dimensions, directed face) 'a'->'b'. */
+struct edge {
+    int a;
+    int b;
+};
+
+
+/* ---------------------------------------------------------------------- */
+static int
+edge_compare_undirected(const void *x, const void *y)
+/* ---------------------------------------------------------------------- */
+{
+    const struct edge *e1 = x;
+    const struct edge *e2 = y;
+
+    int lo1 = (e1->a < e1->b) ? e1->a : e1->b;
+    int lo2 = (e2->a < e2->b) ? e2->a : e2->b;
+    int hi1 = (e1->a < e1->b) ? e1->b : e1->a;
+    int hi2 = (e2->a < e2->b) ? e2->b : e2->a;
+
+    if (lo1 != lo2) { return (lo1 < lo2) ? -1 : 1; }
+    if (hi1 != hi2) { return (hi1 < hi2) ? -1 : 1; }
+
+    return 0;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+edge_compare_start(const void *x, const void *y)
+/* ---------------------------------------------------------------------- */
+{
+    const struct edge *e1 = x;
+    const struct edge *e2 = y;
+
+    return (e1->a < e2->a) ? -1 : (e1->a > e2->a);
+}
+
+
+/* Number of blocks in partition 'p' of 'nc' cells, or -1 if 'p'
+ * contains negative block numbers. */
+/* ---------------------------------------------------------------------- */
+static int
+count_blocks(int nc, const int *p)
+/* ---------------------------------------------------------------------- */
+{
+    int c, nb;
+
+    nb = 0;
+    for (c = 0; (c < nc) && (nb >= 0); c++) {
+        if      (p[c] < 0)   { nb = -1;       }
+        else if (p[c] >= nb) { nb = p[c] + 1; }
+    }
+
+    return nb;
+}
+
+
+/* Face tag of each fine half-face, indexed by 2*f + (side of cell in
+ * face_cells).  All tags are zero if the fine grid carries no tags.
+ * Returns number of distinct tags (maximum tag plus one). */
+/* ---------------------------------------------------------------------- */
+static int
+fine_halfface_tags(const struct UnstructuredGrid *G, int *ftag)
+/* ---------------------------------------------------------------------- */
+{
+    int c, i, f, side, ntag;
+
+    for (i = 0; i < 2 * G->number_of_faces; i++) { ftag[i] = 0; }
+
+    ntag = 1;
+    if (G->cell_facetag != NULL) {
+        for (c = 0; c < G->number_of_cells; c++) {
+            for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+                f    = G->cell_faces[i];
+                side = G->face_cells[2*f + 0] != c;
+
+                ftag[2*f + side] = G->cell_facetag[i];
+
+                if (G->cell_facetag[i] >= ntag) {
+                    ntag = G->cell_facetag[i] + 1;
+                }
+            }
+        }
+    }
+
+    return ntag;
+}
+
+
+/* Orientation of fine face 'f' relative to coarse face whose first
+ * cell is block 'b': +1 if the fine normal points out of 'b', -1 if
+ * it points into 'b'. */
+/* ---------------------------------------------------------------------- */
+static double
+subface_sign(const struct UnstructuredGrid *G, const int *p, int f, int b)
+/* ---------------------------------------------------------------------- */
+{
+    int c = G->face_cells[2*f + 0];
+
+    return ((c >= 0) && (p[c] == b)) ? 1.0 : -1.0;
+}
+
+
+/* Outline of the 'nsub' oriented fine 'subfaces' of a coarse face as a
+ * single closed node loop (3D) or end-point pair (2D).  Edges interior
+ * to the coarse face occur once in each direction and cancel.
+ *
+ * Returns number of nodes stored in 'nodes', or -1 if the remaining
+ * edges do not form a single loop.  'e' must hold one entry per fine
+ * face node. */
+/* ---------------------------------------------------------------------- */
+static int
+subface_outline(const struct UnstructuredGrid *G, const int *p, int b,
+                int nsub, const int *subfaces,
+                struct edge *e, int *nodes)
+/* ---------------------------------------------------------------------- */
+{
+    int i, j, k, m, s, f, net, ne, nn, pos;
+    const int *fn;
+    struct edge key, *next;
+
+    /* Collect directed edges. */
+    ne = 0;
+    for (i = 0; i < nsub; i++) {
+        f  = subfaces[i];
+        fn = G->face_nodes + G->face_nodepos[f];
+        m  = G->face_nodepos[f + 1] - G->face_nodepos[f];
+
+        s  = (subface_sign(G, p, f, b) > 0.0) ? 0 : 1;
+
+        if (G->dimensions == 2) {
+            /* Face is a directed segment.  Record start and end
+             * node with out-degree +1 and -1, respectively. */
+            e[ne].a = fn[s];      e[ne].b =  1;  ne += 1;
+            e[ne].a = fn[1 - s];  e[ne].b = -1;  ne += 1;
+        } else {
+            for (k = 0; k < m; k++) {
+                e[ne].a = fn[s ? (k + 1) % m : k];
+                e[ne].b = fn[s ? k : (k + 1) % m];
+                ne += 1;
+            }
+        }
+    }
+
+    nn = 0;
+
+    if (G->dimensions == 2) {
+        /* One start (+1) and one end (-1) node, all others balanced. */
+        qsort(e, ne, sizeof *e, edge_compare_start);
+
+        nodes[0] = nodes[1] = -1;
+        for (i = 0; i < ne; i = j) {
+            net = 0;
+            for (j = i; (j < ne) && (e[j].a == e[i].a); j++) {
+                net += e[j].b;
+            }
+
+            if ((net == 1) && (nodes[0] < 0)) {
+                nodes[0] = e[i].a;
+            } else if ((net == -1) && (nodes[1] < 0)) {
+                nodes[1] = e[i].a;
+            } else if (net != 0) {
+                return -1;
+            }
+        }
+
+        return ((nodes[0] >= 0) && (nodes[1] >= 0)) ? 2 : -1;
+    }
+
+    /* Cancel opposing edge pairs. */
+    qsort(e, ne, sizeof *e, edge_compare_undirected);
+
+    pos = 0;
+    for (i = 0; i < ne; i = j) {
+        net = 0;
+        for (j = i; (j < ne) && (edge_compare_undirected(&e[i], &e[j]) == 0); j++) {
+            net += (e[j].a < e[j].b) ? 1 : -1;
+        }
+
+        if ((net < -1) || (net > 1)) {
+            return -1;
+        }
+
+        if (net != 0) {
+            key.a = (e[i].a < e[i].b) ? e[i].a : e[i].b;
+            key.b = (e[i].a < e[i].b) ? e[i].b : e[i].a;
+            if (net < 0) {
+                k = key.a;  key.a = key.b;  key.b = k;
+            }
+            e[pos++] = key;
+        }
+    }
+    ne = pos;
+
+    if (ne < 3) {
+        return -1;
+    }
+
+    /* Chain remaining edges, requiring unique start nodes. */
+    qsort(e, ne, sizeof *e, edge_compare_start);
+    for (i = 1; i < ne; i++) {
+        if (e[i].a == e[i - 1].a) {
+            return -1;
+        }
+    }
+
+    nodes[nn++] = e[0].a;
+    key.a       = e[0].b;
+    while ((key.a != e[0].a) && (nn < ne)) {
+        nodes[nn++] = key.a;
+
+        next = bsearch(&key, e, ne, sizeof *e, edge_compare_start);
+        if (next == NULL) {
+            return -1;
+        }
+        key.a = next->b;
+    }
+
+    return ((key.a == e[0].a) && (nn == ne)) ? nn : -1;
+}
+
+
+/* Distinct nodes of 'nsub' fine 'subfaces' in order of first
+ * appearance.  'mark' holds one entry per fine node, all different
+ * from 'stamp' on entry.  Returns number of nodes stored. */
+/* ---------------------------------------------------------------------- */
+static int
+subface_nodes(const struct UnstructuredGrid *G, int nsub,
+              const int *subfaces, int stamp, int *mark, int *nodes)
+/* ---------------------------------------------------------------------- */
+{
+    int i, k, n, f;
+
+    n = 0;
+    for (i = 0; i < nsub; i++) {
+        f = subfaces[i];
+
+        for (k = G->face_nodepos[f]; k < G->face_nodepos[f + 1]; k++) {
+            if (mark[G->face_nodes[k]] != stamp) {
+                mark[G->face_nodes[k]] = stamp;
+                nodes[n++] = G->face_nodes[k];
+            }
+        }
+    }
+
+    return n;
+}
+
+
+/* Aggregate cell and face geometry of fine grid 'G' onto coarse grid 'C'
+ * of 'nb' blocks.  Coarse face topology and connectivity must be set. */
+/* ---------------------------------------------------------------------- */
+static void
+aggregate_geometry(const struct UnstructuredGrid *G, const int *p,
+                   const struct coarse_topology *topo,
+                   struct UnstructuredGrid *C)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, b, j, i, f, d, dim;
+    double s, a, v;
+
+    dim = G->dimensions;
+
+    for (b = 0; b < C->number_of_cells; b++) {
+        C->cell_volumes[b] = 0.0;
+        for (d = 0; d < dim; d++) { C->cell_centroids[dim*b + d] = 0.0; }
+    }
+
+    for (c = 0; c < G->number_of_cells; c++) {
+        b = p[c];
+        v = G->cell_volumes[c];
+
+        C->cell_volumes[b] += v;
+        for (d = 0; d < dim; d++) {
+            C->cell_centroids[dim*b + d] += v * G->cell_centroids[dim*c + d];
+        }
+    }
+
+    for (b = 0; b < C->number_of_cells; b++) {
+        if (C->cell_volumes[b] > 0.0) {
+            for (d = 0; d < dim; d++) {
+                C->cell_centroids[dim*b + d] /= C->cell_volumes[b];
+            }
+        }
+    }
+
+    for (j = 0; j < C->number_of_faces; j++) {
+        C->face_areas[j] = 0.0;
+        for (d = 0; d < dim; d++) {
+            C->face_normals  [dim*j + d] = 0.0;
+            C->face_centroids[dim*j + d] = 0.0;
+        }
+
+        for (i = topo->subfacepos[j]; i < topo->subfacepos[j + 1]; i++) {
+            f = topo->subfaces[i];
+            s = subface_sign(G, p, f, C->face_cells[2*j + 0]);
+            a = G->face_areas[f];
+
+            C->face_areas[j] += a;
+            for (d = 0; d < dim; d++) {
+                C->face_normals  [dim*j + d] += s * G->face_normals  [dim*f + d];
+                C->face_centroids[dim*j + d] += a * G->face_centroids[dim*f + d];
+            }
+        }
+
+        if (C->face_areas[j] > 0.0) {
+            for (d = 0; d < dim; d++) {
+                C->face_centroids[dim*j + d] /= C->face_areas[j];
+            }
+        }
+    }
+}
+
+
+/* Coarse cell-to-face mapping and, if 'ftag' is non-NULL, face tags.
+ * Boundary faces carry the tag of their pseudo block (neighbours[2*j+1]
+ * - nb); interior faces that of their first fine half-face in the
+ * block. */
+/* ---------------------------------------------------------------------- */
+static void
+build_cell_faces(const struct UnstructuredGrid *G, const int *p,
+                 const struct coarse_topology *topo, int nb,
+                 const int *ftag, struct UnstructuredGrid *C)
+/* ---------------------------------------------------------------------- */
+{
+    int b, i, j, f, side;
+
+    for (b = 0; b <= nb; b++) {
+        C->cell_facepos[b] = topo->blkfacepos[b];
+    }
+
+    for (i = 0; i < topo->blkfacepos[nb]; i++) {
+        C->cell_faces[i] = topo->blkfaces[i];
+    }
+
+    if (C->cell_facetag != NULL) {
+        for (b = 0; b < nb; b++) {
+            for (i = C->cell_facepos[b]; i < C->cell_facepos[b + 1]; i++) {
+                j = C->cell_faces[i];
+
+                if (topo->neighbours[2*j + 1] >= nb) {
+                    C->cell_facetag[i] = topo->neighbours[2*j + 1] - nb;
+                } else {
+                    f    = topo->subfaces[topo->subfacepos[j]];
+                    side = ! ((G->face_cells[2*f + 0] >= 0) &&
+                              (p[G->face_cells[2*f + 0]] == b));
+
+                    C->cell_facetag[i] = ftag[2*f + side];
+                }
+            }
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct UnstructuredGrid *
+create_grid_coarse(const struct UnstructuredGrid *G, const int *p)
+/* ---------------------------------------------------------------------- */
+{
+    int  nc, nf, nb, ntag, ncf, nfn, maxfn, nnodes;
+    int  c, f, j, i, d, n, side, ok;
+    int *ftag, *pe, *neigh, *fnodes, *fnpos, *mark;
+
+    struct edge             *e;
+    struct coarse_topology  *topo;
+    struct UnstructuredGrid *C;
+
+    if ((G == NULL) || (p == NULL) ||
+        (G->face_centroids == NULL) || (G->cell_centroids == NULL)) {
+        return NULL;
+    }
+
+    nc = G->number_of_cells;
+    nf = G->number_of_faces;
+    nb = count_blocks(nc, p);
+    if (nb <= 0) {
+        return NULL;
+    }
+
+    C    = NULL;
+    topo = NULL;
+
+    maxfn  = G->face_nodepos[nf];
+    ftag   = malloc(2 * nf             * sizeof *ftag);
+    neigh  = malloc(2 * nf             * sizeof *neigh);
+    mark   = malloc(G->number_of_nodes * sizeof *mark);
+    fnodes = malloc((maxfn + 1)        * sizeof *fnodes);
+    e      = malloc((maxfn + 1)        * sizeof *e);
+    pe     = NULL;
+    fnpos  = NULL;
+
+    ok = (ftag != NULL) && (neigh != NULL) &&
+         (mark != NULL) && (fnodes != NULL) && (e != NULL);
+
+    if (ok) {
+        ntag = fine_halfface_tags(G, ftag);
+        pe   = malloc((nc + ntag) * sizeof *pe);
+        ok   = pe != NULL;
+    }
+
+    if (ok) {
+        /* Route boundary faces through one pseudo cell (and block) per
+         * face tag so that coarse boundary faces are split by tag. */
+        for (c = 0; c < nc;   c++) { pe[c]      = p[c];   }
+        for (i = 0; i < ntag; i++) { pe[nc + i] = nb + i; }
+
+        for (f = 0; f < nf; f++) {
+            for (side = 0; side < 2; side++) {
+                c = G->face_cells[2*f + side];
+
+                if (c >= 0) {
+                    neigh[2*f + side] = c;
+                } else {
+                    neigh[2*f + side] = nc + ftag[2*f + !side];
+                }
+            }
+        }
+
+        topo = coarse_topology_create(nc + ntag, nf, COARSE_GRID_EXPCT_NCONN,
+                                      pe, neigh);
+
+        ok = (topo != NULL) && (topo->subfaces != NULL);
+    }
+
+    if (ok) {
+        ncf   = topo->nfaces;
+        fnpos = malloc((ncf + 1) * sizeof *fnpos);
+        ok    = fnpos != NULL;
+    }
+
+    if (ok) {
+        /* Coarse face nodes, in terms of fine node numbers. */
+        for (i = 0; i < G->number_of_nodes; i++) { mark[i] = -1; }
+
+        fnpos[0] = 0;
+        for (j = 0; j < ncf; j++) {
+            n = subface_outline(G, p, topo->neighbours[2*j + 0],
+                                topo->subfacepos[j + 1] - topo->subfacepos[j],
+                                topo->subfaces + topo->subfacepos[j],
+                                e, fnodes + fnpos[j]);
+
+            if (n < 0) {
+                n = subface_nodes(G,
+                                  topo->subfacepos[j + 1] - topo->subfacepos[j],
+                                  topo->subfaces + topo->subfacepos[j],
+                                  j, mark, fnodes + fnpos[j]);
+            }
+
+            fnpos[j + 1] = fnpos[j] + n;
+        }
+        nfn = fnpos[ncf];
+
+        /* Compact node numbering. */
+        for (i = 0; i < G->number_of_nodes; i++) { mark[i] = -1; }
+
+        nnodes = 0;
+        for (i = 0; i < nfn; i++) {
+            if (mark[fnodes[i]] < 0) {
+                mark[fnodes[i]] = nnodes++;
+            }
+        }
+
+        C  = allocate_grid(G->dimensions, nb, ncf, nfn,
+                           topo->blkfacepos[nb], nnodes);
+        ok = C != NULL;
+    }
+
+    if (ok) {
+        for (i = 0; i < G->number_of_nodes; i++) {
+            if (mark[i] >= 0) {
+                for (d = 0; d < G->dimensions; d++) {
+                    C->node_coordinates[G->dimensions*mark[i] + d] =
+                        G->node_coordinates[G->dimensions*i + d];
+                }
+            }
+        }
+
+        for (j = 0; j <= ncf; j++) { C->face_nodepos[j] = fnpos[j];        }
+        for (i = 0; i <  nfn; i++) { C->face_nodes[i]   = mark[fnodes[i]]; }
+
+        for (j = 0; j < ncf; j++) {
+            C->face_cells[2*j + 0] = topo->neighbours[2*j + 0];
+            C->face_cells[2*j + 1] = (topo->neighbours[2*j + 1] >= nb) ?
+                -1 : topo->neighbours[2*j + 1];
+        }
+
+        if (G->cell_facetag == NULL) {
+            free(C->cell_facetag);
+            C->cell_facetag = NULL;
+        }
+
+        build_cell_faces(G, p, topo, nb, ftag, C);
+        aggregate_geometry(G, p, topo, C);
+
+        C->cartdims[0] = nb;
+        C->cartdims[1] = 1;
+        C->cartdims[2] = 1;
+
+        grid_update_hash(C);
+    }
+
+    coarse_topology_destroy(topo);
+
+    free(fnpos);
+    free(e);
+    free(fnodes);
+    free(mark);
+    free(pe);
+    free(neigh);
+    free(ftag);
+
+    return C;
+}
@@ -0,0 +1,71 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_COARSE_GRID_HEADER_INCLUDED
+#define OPM_COARSE_GRID_HEADER_INCLUDED
+
+/**
+ * \file
+ *
+ * Construct a coarse grid directly from a fine grid and a partition of its
+ * cells, e.g., as produced by partition_unif_idx() and partition_compress().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct UnstructuredGrid;
+
+/**
+ * Form coarse grid by aggregating the cells of a fine grid into blocks.
+ *
+ * Each coarse cell is the union of the fine cells of one block.  Each coarse
+ * face is the union of the fine faces between a pair of blocks or, on the
+ * outer boundary, the fine faces of a block that share a face tag.  The
+ * coarse geometry is aggregated from the fine geometry: volumes and areas
+ * are summed, normals are summed with orientation from the first to the
+ * second cell of the coarse face, and centroids are volume- or
+ * area-weighted averages.
+ *
+ * The nodes of a coarse face trace the outline of its fine faces when that
+ * outline is a single closed loop (an end-point pair in two dimensions).
+ * Otherwise they are the distinct nodes of the fine faces in no particular
+ * order.  The coarse geometry must therefore not be recomputed from the
+ * nodes using compute_geometry().
+ *
+ * The coarse grid has no @c global_cell map; its Cartesian dimensions are
+ * <code>(number of blocks, 1, 1)</code>.
+ *
+ * @param[in] G Fine grid with complete geometry, including centroids.
+ * @param[in] p Partition vector.  Block number of each fine cell.  Blocks
+ *              must be numbered contiguously from zero.
+ *
+ * @return Fully formed coarse grid with one cell per block, or @c NULL if
+ * the input is invalid or memory allocation fails.  Must be destroyed using
+ * function destroy_grid().
+ */
+struct UnstructuredGrid *
+create_grid_coarse(const struct UnstructuredGrid *G, const int *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPM_COARSE_GRID_HEADER_INCLUDED */
@@ -19,6 +19,7 @@
 #include <opm/core/grid/cpgpreprocess/geometry.h>
 #include <opm/core/grid/cpgpreprocess/preprocess.h>
 #include <opm/core/grid.h>
+#include <opm/core/utility/first_touch.h>
 
 
 static int
@@ -105,9 +106,9 @@ fill_cell_topology(struct processed_grid  *pg,
 }
 
 static int
-allocate_geometry(struct UnstructuredGrid *g)
+allocate_geometry(struct UnstructuredGrid *g, int mask)
 {
-    int ok;
+    int ok, nalloc;
     size_t nc, nf, nd;
 
     assert (g->dimensions == 3);
@@ -116,52 +117,131 @@ allocate_geometry(struct UnstructuredGrid *g)
     nf = g->number_of_faces;
     nd = 3;
 
-    g->face_areas     = malloc(nf * 1  * sizeof *g->face_areas);
-    g->face_centroids = malloc(nf * nd * sizeof *g->face_centroids);
-    g->face_normals   = malloc(nf * nd * sizeof *g->face_normals);
-
-    g->cell_volumes   = malloc(nc * 1  * sizeof *g->cell_volumes);
-    g->cell_centroids = malloc(nc * nd * sizeof *g->cell_centroids);
+    g->face_areas     = first_touch_calloc(nf, 1  * sizeof *g->face_areas);
+    g->face_normals   = first_touch_calloc(nf, nd * sizeof *g->face_normals);
+    g->cell_volumes   = first_touch_calloc(nc, 1  * sizeof *g->cell_volumes);
 
     ok  = g->face_areas     != NULL;
-    ok += g->face_centroids != NULL;
     ok += g->face_normals   != NULL;
-
     ok += g->cell_volumes   != NULL;
-    ok += g->cell_centroids != NULL;
+    nalloc = 3;
+
+    if (mask & GRID_GEOMETRY_FACE_CENTROIDS) {
+        g->face_centroids = first_touch_calloc(nf, nd * sizeof *g->face_centroids);
+        ok += g->face_centroids != NULL;
+        nalloc += 1;
+    }
 
-    return ok == 5;
+    if (mask & GRID_GEOMETRY_CELL_CENTROIDS) {
+        g->cell_centroids = first_touch_calloc(nc, nd * sizeof *g->cell_centroids);
+        ok += g->cell_centroids != NULL;
+        nalloc += 1;
+    }
+
+    return ok == nalloc;
 }
 
 
 void compute_geometry(struct UnstructuredGrid *g)
 {
+    compute_geometry_threaded(g, 0);
+}
+
+
+void compute_geometry_threaded(struct UnstructuredGrid *g, int nthreads)
+{
+    double *fcentroids;
+
     assert (g != NULL);
     if (g!=NULL)
     {
-        assert (g->face_centroids != NULL);
         assert (g->face_normals   != NULL);
         assert (g->face_areas     != NULL);
-        assert (g->cell_centroids != NULL);
         assert (g->cell_volumes   != NULL);
 
+        /* Cell geometry needs face centroids.  Use a temporary array
+         * if the grid does not store them. */
+        fcentroids = g->face_centroids;
+        if (fcentroids == NULL) {
+            fcentroids = malloc(g->number_of_faces * g->dimensions
+                                * sizeof *fcentroids);
+            if (fcentroids == NULL) {
+                return;
+            }
+        }
+
         compute_face_geometry(g->dimensions  , g->node_coordinates,
                               g->number_of_faces, g->face_nodepos,
                               g->face_nodes, g->face_normals,
-                              g->face_centroids, g->face_areas);
+                              fcentroids, g->face_areas, nthreads);
 
         compute_cell_geometry(g->dimensions, g->node_coordinates,
                               g->face_nodepos, g->face_nodes,
                               g->face_cells, g->face_normals,
-                              g->face_centroids, g->number_of_cells,
+                              fcentroids, g->number_of_cells,
                               g->cell_facepos, g->cell_faces,
-                              g->cell_centroids, g->cell_volumes);
+                              g->cell_centroids, g->cell_volumes,
+                              nthreads);
+
+        if (fcentroids != g->face_centroids) {
+            free(fcentroids);
+        }
+
+        grid_update_hash(g);
+    }
+}
+
+
+int complete_geometry(struct UnstructuredGrid *g)
+{
+    size_t nc, nf, nd;
+
+    nc = g->number_of_cells;
+    nf = g->number_of_faces;
+    nd = g->dimensions;
+
+    if ((g->face_centroids != NULL) && (g->cell_centroids != NULL)) {
+        return 1;
+    }
+
+    if (g->face_centroids == NULL) {
+        g->face_centroids = first_touch_calloc(nf, nd * sizeof *g->face_centroids);
+    }
+    if (g->cell_centroids == NULL) {
+        g->cell_centroids = first_touch_calloc(nc, nd * sizeof *g->cell_centroids);
     }
+
+    if ((g->face_centroids == NULL) || (g->cell_centroids == NULL)) {
+        return 0;
+    }
+
+    /* The remaining fields are recomputed, too, with identical
+     * results. */
+    compute_geometry(g);
+
+    return 1;
 }
 
 
 struct UnstructuredGrid *
 create_grid_cornerpoint(const struct grdecl *in, double tol)
+{
+    return create_grid_cornerpoint_threaded(in, tol, 0);
+}
+
+
+struct UnstructuredGrid *
+create_grid_cornerpoint_threaded(const struct grdecl *in, double tol,
+                                 int nthreads)
+{
+    return create_grid_cornerpoint_masked(in, tol, nthreads,
+                                          GRID_GEOMETRY_ALL);
+}
+
+
+static struct UnstructuredGrid *
+create_grid_cornerpoint_impl(const struct grdecl *in, double *zcorn,
+                             double tol, int nthreads, int geometry_mask)
 {
     struct UnstructuredGrid *g;
    int                      ok;
@@ -173,7 +253,14 @@ create_grid_cornerpoint(const struct grdecl *in, double tol)
        return NULL;
    }
 
-   process_grdecl(in, tol, &pg);
+   if (zcorn != NULL)
+   {
+       process_grdecl_inplace(in, zcorn, tol, &pg);
+   }
+   else
+   {
+       process_grdecl(in, tol, &pg);
+   }
 
    /*
     *  Convert "struct processed_grid" to "struct UnstructuredGrid".
@@ -205,7 +292,7 @@ create_grid_cornerpoint(const struct grdecl *in, double tol)
    /* allocate and fill g->cell_faces/g->cell_facepos and
     * g->cell_facetag as well as the geometry-related fields. */
    ok =       fill_cell_topology(&pg, g);
-   ok = ok && allocate_geometry(g);
+   ok = ok && allocate_geometry(g, geometry_mask);
 
    if (!ok)
    {
@@ -215,8 +302,6 @@ create_grid_cornerpoint(const struct grdecl *in, double tol)
    else
    {
 
-       compute_geometry(g);
-
        g->cartdims[0]      = pg.dimensions[0];
        g->cartdims[1]      = pg.dimensions[1];
        g->cartdims[2]      = pg.dimensions[2];
@@ -227,9 +312,30 @@ create_grid_cornerpoint(const struct grdecl *in, double tol)
         * This is needed to avoid creating dangling references in the
         * free_processed_grid() call. */
        pg.local_cell_index = NULL;
+
+       /* Last, as it also computes the grid's hashes. */
+       compute_geometry_threaded(g, nthreads);
    }
 
    free_processed_grid(&pg);
 
    return g;
 }
+
+
+struct UnstructuredGrid *
+create_grid_cornerpoint_masked(const struct grdecl *in, double tol,
+                               int nthreads, int geometry_mask)
+{
+    return create_grid_cornerpoint_impl(in, NULL, tol, nthreads,
+                                        geometry_mask);
+}
+
+
+struct UnstructuredGrid *
+create_grid_cornerpoint_inplace(const struct grdecl *in, double *zcorn,
+                                double tol, int nthreads, int geometry_mask)
+{
+    return create_grid_cornerpoint_impl(in, zcorn, tol, nthreads,
+                                        geometry_mask);
+}
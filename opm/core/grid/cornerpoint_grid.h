@@ -47,6 +47,16 @@
 extern "C" {
 #endif
 
+    /**
+     * Optional geometry fields, for use with
+     * create_grid_cornerpoint_masked().  Face areas and normals and cell
+     * volumes are always computed.
+     */
+#define GRID_GEOMETRY_FACE_CENTROIDS (1 << 0)
+#define GRID_GEOMETRY_CELL_CENTROIDS (1 << 1)
+#define GRID_GEOMETRY_ALL (GRID_GEOMETRY_FACE_CENTROIDS | \
+                           GRID_GEOMETRY_CELL_CENTROIDS)
+
     /**
      * Construct grid representation from corner-point specification of a
      * particular geological model.
@@ -71,6 +81,70 @@ extern "C" {
     create_grid_cornerpoint(const struct grdecl *in, double tol);
 
 
+    /**
+     * Construct grid representation from corner-point specification as
+     * create_grid_cornerpoint(), computing the geometry using function
+     * compute_geometry_threaded().
+     *
+     * @param[in] in       Corner-point specification.
+     * @param[in] tol      Absolute tolerance of node-coincidence.
+     * @param[in] nthreads Number of geometry threads.  Non-positive value
+     *                     selects the default number of OpenMP threads.
+     *
+     * @return Fully formed grid data structure.  Must be destroyed using
+     * function destroy_grid().
+     */
+    struct UnstructuredGrid *
+    create_grid_cornerpoint_threaded(const struct grdecl *in, double tol,
+                                     int nthreads);
+
+
+    /**
+     * Construct grid representation from corner-point specification as
+     * create_grid_cornerpoint_threaded(), storing only selected optional
+     * geometry fields.
+     *
+     * Fields not selected in @c geometry_mask are neither allocated nor
+     * stored, and are @c NULL in the resulting grid.  They may be filled
+     * in later by function complete_geometry().
+     *
+     * @param[in] in            Corner-point specification.
+     * @param[in] tol           Absolute tolerance of node-coincidence.
+     * @param[in] nthreads      Number of geometry threads.  Non-positive
+     *                          value selects the default number of OpenMP
+     *                          threads.
+     * @param[in] geometry_mask Bitwise OR of @c GRID_GEOMETRY_* flags.
+     *
+     * @return Fully formed grid data structure.  Must be destroyed using
+     * function destroy_grid().
+     */
+    struct UnstructuredGrid *
+    create_grid_cornerpoint_masked(const struct grdecl *in, double tol,
+                                   int nthreads, int geometry_mask);
+
+
+    /**
+     * Construct grid representation from corner-point specification as
+     * create_grid_cornerpoint_masked(), using the ZCORN array of the
+     * specification as workspace (see process_grdecl_inplace()).
+     *
+     * @param[in]     in            Corner-point specification.
+     * @param[in,out] zcorn         Modifiable alias of
+     *                              <CODE>in->zcorn</CODE>.  The contents
+     *                              are unspecified on return.
+     * @param[in]     tol           Absolute tolerance of node-coincidence.
+     * @param[in]     nthreads      Number of geometry threads.
+     * @param[in]     geometry_mask Bitwise OR of @c GRID_GEOMETRY_* flags.
+     *
+     * @return Fully formed grid data structure.  Must be destroyed using
+     * function destroy_grid().
+     */
+    struct UnstructuredGrid *
+    create_grid_cornerpoint_inplace(const struct grdecl *in, double *zcorn,
+                                    double tol, int nthreads,
+                                    int geometry_mask);
+
+
     /**
      * Compute derived geometric primitives in a grid.
      *
@@ -90,12 +164,41 @@ extern "C" {
      *   -# Volumes, one scalar per cell stored sequentially in
      *      <CODE>g->cell_volumes</CODE>.
      *
-     * These fields must be allocated prior to calling compute_geometry().
+     * These fields must be allocated prior to calling compute_geometry(),
+     * except the centroid arrays.  Centroids are not stored if the
+     * corresponding field is @c NULL.
      *
      * @param[in,out] g Grid structure.
      */
     void compute_geometry(struct UnstructuredGrid *g);
 
+
+    /**
+     * Compute derived geometric primitives in a grid using a given number of
+     * threads.
+     *
+     * Faces are distributed across threads, and so are cells, each cell
+     * being accumulated by a single thread.  The result is therefore
+     * bitwise identical for any number of threads.
+     *
+     * @param[in,out] g        Grid structure.
+     * @param[in]     nthreads Number of threads.  Non-positive value selects
+     *                         the default number of OpenMP threads.  Ignored
+     *                         (treated as one) if the library is built
+     *                         without OpenMP support.
+     */
+    void compute_geometry_threaded(struct UnstructuredGrid *g, int nthreads);
+
+
+    /**
+     * Allocate and compute any geometry fields that were omitted when the
+     * grid was constructed (see create_grid_cornerpoint_masked()).
+     *
+     * @param[in,out] g Grid structure.
+     * @return Non-zero on success, zero in case of allocation failure.
+     */
+    int complete_geometry(struct UnstructuredGrid *g);
+
 #ifdef __cplusplus
 }
 #endif
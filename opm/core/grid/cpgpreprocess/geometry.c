@@ -8,6 +8,18 @@
 #include "geometry.h"
 #include <assert.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+
+/* ------------------------------------------------------------------ */
+static int
+geometry_threads(int nthreads)
+/* ------------------------------------------------------------------ */
+{
+   return (nthreads > 0) ? nthreads : omp_get_max_threads();
+}
+#endif
+
 /* ------------------------------------------------------------------ */
 static void
 cross(const double u[3], const double v[3], double w[3])
@@ -31,9 +43,11 @@ norm(const double w[3])
 static void
 compute_face_geometry_3d(double *coords, int nfaces,
                          int *nodepos, int *facenodes, double *fnormals,
-                         double *fcentroids, double *fareas)
+                         double *fcentroids, double *fareas, int nthreads)
 /* ------------------------------------------------------------------ */
 {
+   /* Each face is computed by a single thread from its own nodes
+    * only, so the result is independent of the number of threads. */
 
    /* Assume 3D for now */
    const int ndims = 3;
@@ -52,13 +66,18 @@ compute_face_geometry_3d(double *coords, int nfaces,
    double a;
    int    num_face_nodes;
    double area;
-   /*#pragma omp parallel for  */
-
-   /*#pragma omp parallel for shared(fnormals,fcentroids,fareas)*/
-#pragma omp parallel for default(none) 			   \
+#if defined(_OPENMP)
+   const int nt = geometry_threads(nthreads);
+#else
+   (void) nthreads;
+#endif
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(none) num_threads(nt) schedule(static) \
     private(f,x,u,v,w,i,k,node,cface,n,a,num_face_nodes,area)		\
     shared(fnormals,fcentroids,fareas  \
 	   ,coords, nfaces, nodepos, facenodes, twothirds)
+#endif
    for (f=0; f<nfaces; ++f)
    {
       for(i=0; i<ndims; ++i) x[i] = 0.0;
@@ -189,13 +208,13 @@ compute_edge_geometry_2d(
 void
 compute_face_geometry(int ndims, double *coords, int nfaces,
                       int *nodepos, int *facenodes, double *fnormals,
-                      double *fcentroids, double *fareas)
+                      double *fcentroids, double *fareas, int nthreads)
 /* ------------------------------------------------------------------ */
 {
    if (ndims == 3)
    {
       compute_face_geometry_3d(coords, nfaces, nodepos, facenodes,
-                               fnormals, fcentroids, fareas);
+                               fnormals, fcentroids, fareas, nthreads);
    }
    else if (ndims == 2)
    {
@@ -217,9 +236,12 @@ compute_cell_geometry_3d(double *coords,
                          double *fnormals,
                          double *fcentroids,
                          int ncells, int *facepos, int *cellfaces,
-                         double *ccentroids, double *cvolumes)
+                         double *ccentroids, double *cvolumes, int nthreads)
 /* ------------------------------------------------------------------ */
 {
+   /* Each cell is owned by one thread that accumulates its volume
+    * and centroid in face order, so the result is independent of the
+    * number of threads. */
    const int ndims = 3;
    int i,k, f,c;
    int face,node;
@@ -234,12 +256,20 @@ compute_cell_geometry_3d(double *coords,
    double volume;
    double tet_volume, subnormal_sign;
    double twothirds = 0.666666666666666666666666666667;
-#pragma omp parallel for default(none)     \
+#if defined(_OPENMP)
+   const int nt = geometry_threads(nthreads);
+#else
+   (void) nthreads;
+#endif
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(none) num_threads(nt) schedule(static) \
     private(i,k,f,c,face,node,x,u,v,w,xcell				\
 	    ,ccell ,cface,num_faces,volume, tet_volume, subnormal_sign) \
    shared(coords,nodepos,facenodes,neighbors,twothirds,		\
 	  fnormals,fcentroids,facepos,cellfaces,ccentroids,cvolumes) \
     firstprivate(ncells)
+#endif
    for (c=0; c<ncells; ++c)
    {
 
@@ -332,7 +362,10 @@ compute_cell_geometry_3d(double *coords,
             for (i=0; i<ndims; ++i) u[i] = v[i];
          }
       }
-      for (i=0; i<ndims; ++i) ccentroids[3*c+i] = xcell[i] + ccell[i]/volume;
+      if (ccentroids != NULL)
+      {
+         for (i=0; i<ndims; ++i) ccentroids[3*c+i] = xcell[i] + ccell[i]/volume;
+      }
       cvolumes[c] = volume;
    }
 }
@@ -394,8 +427,11 @@ compute_cell_geometry_2d(
       }
       center_x /= (double) num_nodes;
       center_y /= (double) num_nodes;
-      cell_centers[cell * num_dims + x_ofs] = center_x;
-      cell_centers[cell * num_dims + y_ofs] = center_y;
+      if (cell_centers != NULL)
+      {
+         cell_centers[cell * num_dims + x_ofs] = center_x;
+         cell_centers[cell * num_dims + y_ofs] = center_y;
+      }
 
       /* triangulate the polygon by introducing the cell center and then new
        * internal edges from this center to the vertices. the total area of
@@ -438,14 +474,15 @@ compute_cell_geometry(int ndims, double *coords,
                       double *fnormals,
                       double *fcentroids,
                       int ncells, int *facepos, int *cellfaces,
-                      double *ccentroids, double *cvolumes)
+                      double *ccentroids, double *cvolumes, int nthreads)
 /* ------------------------------------------------------------------ */
 {
    if (ndims == 3)
    {
       compute_cell_geometry_3d(coords, nodepos, facenodes,
                                neighbors, fnormals, fcentroids, ncells,
-                               facepos, cellfaces, ccentroids, cvolumes);
+                               facepos, cellfaces, ccentroids, cvolumes,
+                               nthreads);
    }
    else if (ndims == 2)
    {
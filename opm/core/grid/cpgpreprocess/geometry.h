@@ -5,15 +5,19 @@
 #ifndef MRST_GEOMETRY_H_INCLUDED
 #define MRST_GEOMETRY_H_INCLUDED
 
+/* nthreads <= 0 selects the OpenMP default.  Results do not depend on
+ * the number of threads.  Cell centroids are not stored if ccentroids is
+ * NULL. */
 void compute_face_geometry(int ndims, double *coords, int nfaces,
                            int *nodepos, int *facenodes,
                            double *fnormals, double *fcentroids,
-                           double *fareas);
+                           double *fareas, int nthreads);
 void compute_cell_geometry(int ndims, double *coords,
                            int *nodepos, int *facenodes, int *neighbours,
                            double *fnormals,
                            double *fcentroids, int ncells,
                            int *facepos, int *cellfaces,
-                           double *ccentroids, double *cvolumes);
+                           double *ccentroids, double *cvolumes,
+                           int nthreads);
 
 #endif /* MRST_GEOMETRY_H_INCLUDED */
@@ -557,6 +557,59 @@ copy_and_permute_zcorn(int nx, int ny, int nz, const double *in,
     return out;
 }
 
+/* ------------------------------------------------------------------ */
+static double*
+permute_zcorn_inplace(int nx, int ny, int nz, double sign, double *zcorn)
+/* ------------------------------------------------------------------ */
+{
+    /* Same permutation as copy_and_permute_zcorn(), but in place by
+     * following the cycles of the permutation.  Position p of the
+     * result, with k running fastest, then i, then j, receives the
+     * input value at i + 2*nx*(j + 2*ny*k).  A bit per value marks
+     * the positions done, so the only extra memory is 1/64 of the
+     * ZCORN array. */
+    const size_t ni = 2 * ((size_t) nx);
+    const size_t nj = 2 * ((size_t) ny);
+    const size_t nk = 2 * ((size_t) nz);
+    const size_t n  = ni * nj * nk;
+
+    size_t         p, q, s, i, j, k;
+    double         tmp;
+    unsigned char *done;
+
+    done = calloc((n + 7) / 8, sizeof *done);
+    if (done == NULL) {
+        return NULL;
+    }
+
+    for (p = 0; p < n; ++p) {
+        if (done[p / 8] & (1u << (p % 8))) { continue; }
+
+        tmp = zcorn[p];
+        q   = p;
+        for (;;) {
+            done[q / 8] |= (unsigned char) (1u << (q % 8));
+
+            k = q % nk;
+            i = (q / nk) % ni;
+            j =  q / (nk * ni);
+            s = i + ni*(j + nj*k);
+
+            if (s == p) {
+                zcorn[q] = sign * tmp;
+                break;
+            }
+
+            zcorn[q] = sign * zcorn[s];
+            q = s;
+        }
+    }
+
+    free(done);
+
+    return zcorn;
+}
+
 /* ------------------------------------------------------------------ */
 static int
 get_zcorn_sign(int nx, int ny, int nz, const int *actnum,
@@ -755,11 +808,14 @@ reverse_face_nodes(struct processed_grid *out)
 }
 
 
-/*-----------------------------------------------------------------
-  Public interface
-*/
-void process_grdecl(const struct grdecl   *in,
-                    double                tolerance,
+/* ----------------------------------------------------------------------
+ * Process corner-point specification.  If zcorn_work is non-NULL, it
+ * is in->zcorn and is permuted in place rather than copied.
+ * ---------------------------------------------------------------------- */
+static void
+process_grdecl_impl(const struct grdecl   *in,
+                    double                *zcorn_work,
+                    double                 tolerance,
                     struct processed_grid *out)
 {
     struct grdecl g;
@@ -832,9 +888,22 @@ void process_grdecl(const struct grdecl   *in,
     actnum    = malloc (nc *     sizeof *actnum);
     g.actnum  = copy_and_permute_actnum(nx, ny, nz, in->actnum, actnum);
 
-    zcorn     = malloc (nc * 8 * sizeof *zcorn);
     sign      = get_zcorn_sign(nx, ny, nz, in->actnum, in->zcorn, &error);
-    g.zcorn   = copy_and_permute_zcorn(nx, ny, nz, in->zcorn, sign, zcorn);
+
+    /* Determine if coordinate system is left handed or not.  Done
+     * here since it reads in->zcorn, which may be permuted below. */
+    left_handed = is_lefthanded(in);
+
+    if (zcorn_work != NULL) {
+        assert (zcorn_work == in->zcorn);
+        zcorn   = NULL;
+        g.zcorn = permute_zcorn_inplace(nx, ny, nz, sign, zcorn_work);
+    }
+    if ((zcorn_work == NULL) || (g.zcorn == NULL)) {
+        /* No workspace, or no memory for the in-place permutation. */
+        zcorn   = malloc (nc * 8 * sizeof *zcorn);
+        g.zcorn = copy_and_permute_zcorn(nx, ny, nz, in->zcorn, sign, zcorn);
+    }
 
     g.coord   = in->coord;
 
@@ -848,8 +917,6 @@ void process_grdecl(const struct grdecl   *in,
     free (zcorn);
     free (actnum);
 
-    /* Determine if coordinate system is left handed or not. */
-    left_handed = is_lefthanded(in);
     if (left_handed) {
         /* Reflect Y coordinates about XZ plane to create right-handed
          * coordinate system whilst processing intersections. */
@@ -938,6 +1005,25 @@ void process_grdecl(const struct grdecl   *in,
     }
 }
 
+/*-----------------------------------------------------------------
+  Public interface
+*/
+void process_grdecl(const struct grdecl   *in,
+                    double                tolerance,
+                    struct processed_grid *out)
+{
+    process_grdecl_impl(in, NULL, tolerance, out);
+}
+
+/*-------------------------------------------------------*/
+void process_grdecl_inplace(const struct grdecl   *in,
+                            double                *zcorn,
+                            double                 tolerance,
+                            struct processed_grid *out)
+{
+    process_grdecl_impl(in, zcorn, tolerance, out);
+}
+
 /*-------------------------------------------------------*/
 void free_processed_grid(struct processed_grid *g)
 {
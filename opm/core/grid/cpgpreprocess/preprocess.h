@@ -130,6 +130,27 @@ extern "C" {
                         double                 tol,
                         struct processed_grid *out);
 
+    /**
+     * Construct a prototypical grid representation from a corner-point
+     * specification as process_grdecl(), using the specification's ZCORN
+     * array as workspace.
+     *
+     * Function process_grdecl() works on an internal, reordered copy of the
+     * ZCORN array.  This function reorders the array in place instead, which
+     * lowers the peak memory use by the size of the array.
+     *
+     * @param[in]     g     Corner-point specification.
+     * @param[in,out] zcorn Modifiable alias of <CODE>g->zcorn</CODE>.  The
+     *                      contents are unspecified on return.
+     * @param[in]     tol   Absolute tolerance of node-coincidence.
+     * @param[in,out] out   Minimal grid representation, as for
+     *                      process_grdecl().
+     */
+    void process_grdecl_inplace(const struct grdecl   *g    ,
+                                double                *zcorn,
+                                double                 tol  ,
+                                struct processed_grid *out  );
+
     /**
      * Release memory resources acquired in previous grid processing using
      * function process_grdecl().
@@ -264,7 +264,12 @@ static void interpolate_pillar(const double *coord, double *pt)
 /*-----------------------------------------------------------------
   Assign point numbers p such that "zlist(p)==zcorn".  Assume that
   coordinate number is arranged in a sequence such that the natural
-  index is (k,i,j) */
+  index is (k,i,j).
+
+  Pillars are independent, so both loops run in parallel if OpenMP is
+  enabled.  Each pillar's unique z-values are first computed in a
+  fixed-size segment of zlist and then compacted in pillar order, so
+  the node numbering is identical to a sequential run.  */
 int finduniquepoints(const struct grdecl *g,
                      /* return values: */
                      int           *plist, /* list of point numbers on
@@ -273,38 +278,22 @@ int finduniquepoints(const struct grdecl *g,
                      struct processed_grid *out)
 
 {
-
-    const int nx = out->dimensions[0];
-    const int ny = out->dimensions[1];
-    const int nz = out->dimensions[2];
     const int nc = g->dims[0]*g->dims[1]*g->dims[2];
 
-
     /* zlist may need extra space temporarily due to simple boundary
-     * treatement  */
-    int            npillarpoints = 8*(nx+1)*(ny+1)*nz;
-    int            npillars      = (nx+1)*(ny+1);
+     * treatement.  Each pillar gets a segment of 'seglen' entries,
+     * enough for all zcorn values of the four adjacent columns. */
+    int            seglen        = 8*g->dims[2];
+    int            npillars      = (g->dims[0]+1)*(g->dims[1]+1);
 
-    double *zlist = malloc(npillarpoints*sizeof *zlist);
+    double *zlist = malloc(((size_t) npillars)*seglen*sizeof *zlist);
     int     *zptr = malloc((npillars+1)*sizeof *zptr);
 
-
-
-
     int     i,j,k;
+    int     ok;
 
     int     d1[3];
-    int     len    = 0;
-    double  *zout  = zlist;
-    int     pos    = 0;
-    double *pt;
-    const double *z[4];
-    const int *a[4];
-    int *p;
-    int pix, cix;
-    int zix;
-
-    const double *coord = g->coord;
+    int     pix;
 
     d1[0] = 2*g->dims[0];
     d1[1] = 2*g->dims[1];
@@ -312,47 +301,75 @@ int finduniquepoints(const struct grdecl *g,
 
     out->node_coordinates = malloc (3*8*nc*sizeof(*out->node_coordinates));
 
-    zptr[pos++] = zout - zlist;
+    if ((zlist == NULL) || (zptr == NULL) || (out->node_coordinates == NULL)) {
+        free(zptr);
+        free(zlist);
+        return 0;
+    }
 
-    pt    = out->node_coordinates;
+    /* Loop over pillars, find unique points on each pillar.  The
+     * number of unique points on pillar 'pix' is held in zptr[pix+1]
+     * until the segments are compacted. */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(i, j)
+#endif
+    for (pix = 0; pix < npillars; ++pix){
+        const double *z[4];
+        const int    *a[4];
+        double       *zout = zlist + ((size_t) pix)*seglen;
+        int           len;
 
-    /* Loop over pillars, find unique points on each pillar */
-    for (j=0; j < g->dims[1]+1; ++j){
-        for (i=0; i < g->dims[0]+1; ++i){
+        i = pix % (g->dims[0]+1);
+        j = pix / (g->dims[0]+1);
 
-            /* Get positioned pointers for actnum and zcorn data */
-            igetvectors(g->dims,   i,   j, g->actnum, a);
-            dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
+        /* Get positioned pointers for actnum and zcorn data */
+        igetvectors(g->dims,   i,   j, g->actnum, a);
+        dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
 
-            len = createSortedList(     zout, d1[2], 4, z, a);
-            len = uniquify        (len, zout, tolerance);
+        len = createSortedList(     zout, d1[2], 4, z, a);
+        len = uniquify        (len, zout, tolerance);
 
-            /* Assign unique points */
-            for (k=0; k<len; ++k){
-                pt[2] = zout[k];
-                interpolate_pillar(coord, pt);
-                pt += 3;
-            }
+        zptr[pix + 1] = len;
+    }
+
+    /* Compact the per-pillar segments into a sparse table of unique
+     * zcorn values.  Destination never overtakes source. */
+    zptr[0] = 0;
+    for (pix = 0; pix < npillars; ++pix){
+        memmove(zlist + zptr[pix], zlist + ((size_t) pix)*seglen,
+                zptr[pix + 1] * sizeof *zlist);
+        zptr[pix + 1] += zptr[pix];
+    }
 
-            /* Increment pointer to sparse table of unique zcorn
-             * values */
-            zout        = zout + len;
-            zptr[pos++] = zout - zlist;
+    /* Assign unique points */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(k)
+#endif
+    for (pix = 0; pix < npillars; ++pix){
+        const double *coord = g->coord + 6*((size_t) pix);
 
-            coord += 6;
+        for (k = zptr[pix]; k < zptr[pix + 1]; ++k){
+            double *pt = out->node_coordinates + 3*((size_t) k);
+            pt[2] = zlist[k];
+            interpolate_pillar(coord, pt);
         }
     }
-    out->number_of_nodes_on_pillars = zptr[pos-1];
-    out->number_of_nodes            = zptr[pos-1];
+    out->number_of_nodes_on_pillars = zptr[npillars];
+    out->number_of_nodes            = zptr[npillars];
 
     /* Loop over all vertical sets of zcorn values, assign point
      * numbers */
-    p = plist;
+    ok = 1;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(i) reduction(&&:ok)
+#endif
     for (j=0; j < 2*g->dims[1]; ++j){
         for (i=0; i < 2*g->dims[0]; ++i){
+            int pillar, cix, zix;
+            int *p;
 
             /* pillar index */
-            pix = (i+1)/2 + (g->dims[0]+1)*((j+1)/2);
+            pillar = (i+1)/2 + (g->dims[0]+1)*((j+1)/2);
 
             /* cell column position */
             cix = g->dims[2]*((i/2) + (j/2)*g->dims[0]);
@@ -360,22 +377,23 @@ int finduniquepoints(const struct grdecl *g,
             /* zcorn column position */
             zix = 2*g->dims[2]*(i+2*g->dims[0]*j);
 
-            if (!assignPointNumbers(zptr[pix], zptr[pix+1], zlist,
-                                    2*g->dims[2],
-                                    g->zcorn  + zix, g->actnum + cix,
-                                    p, tolerance)){
+            /* point number column position */
+            p = plist + ((size_t) (i + 2*g->dims[0]*j))*(2 + 2*g->dims[2]);
+
+            if (ok && !assignPointNumbers(zptr[pillar], zptr[pillar+1], zlist,
+                                          2*g->dims[2],
+                                          g->zcorn  + zix, g->actnum + cix,
+                                          p, tolerance)){
                 fprintf(stderr, "Something went wrong in assignPointNumbers");
-                return 0;
+                ok = 0;
             }
-
-            p += 2 + 2*g->dims[2];
         }
     }
 
     free(zptr);
     free(zlist);
 
-    return 1;
+    return ok;
 }
 
 /* Local Variables:    */
@@ -0,0 +1,142 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/grid.h>
+#include <opm/core/grid/geometry_soa.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define GEOMETRY_SOA_ALIGN 64
+
+
+/* Number of doubles in an array of 'n' elements padded to a multiple
+ * of the alignment. */
+/* ---------------------------------------------------------------------- */
+static size_t
+padded_length(size_t n)
+/* ---------------------------------------------------------------------- */
+{
+    const size_t per_line = GEOMETRY_SOA_ALIGN / sizeof(double);
+
+    return ((n + per_line - 1) / per_line) * per_line;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+scatter(const double *src, size_t n, int dim, double **dst)
+/* ---------------------------------------------------------------------- */
+{
+    size_t i;
+    int    d;
+
+    for (d = 0; d < dim; d++) {
+        double *restrict out = dst[d];
+
+        for (i = 0; i < n; i++) {
+            out[i] = src[i*dim + d];
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct GridGeometrySoA *
+create_geometry_soa(const struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    struct GridGeometrySoA *geom;
+
+    size_t    lf, lc, total;
+    uintptr_t addr;
+    double   *p;
+    int       d, dim;
+
+    dim = G->dimensions;
+    assert ((dim > 0) && (dim <= 3));
+
+    geom = calloc(1, sizeof *geom);
+    if (geom == NULL) {
+        return NULL;
+    }
+
+    lf    = padded_length(G->number_of_faces);
+    lc    = padded_length(G->number_of_cells);
+    total = dim * (2*lf + lc) * sizeof(double);
+
+    /* C99 has no aligned allocation.  Over-allocate and align by hand. */
+    geom->storage = malloc(total + GEOMETRY_SOA_ALIGN);
+    if (geom->storage == NULL) {
+        free(geom);
+        return NULL;
+    }
+
+    addr  = (uintptr_t) geom->storage;
+    addr  = (addr + GEOMETRY_SOA_ALIGN - 1) & ~((uintptr_t) GEOMETRY_SOA_ALIGN - 1);
+    p     = (double *) addr;
+
+    geom->dimensions      = dim;
+    geom->number_of_cells = G->number_of_cells;
+    geom->number_of_faces = G->number_of_faces;
+
+    for (d = 0; d < dim; d++) {
+        geom->face_normals  [d] = p;  p += lf;
+        geom->face_centroids[d] = p;  p += lf;
+        geom->cell_centroids[d] = p;  p += lc;
+    }
+
+    update_geometry_soa(G, geom);
+
+    return geom;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+update_geometry_soa(const struct UnstructuredGrid *G,
+                    struct GridGeometrySoA        *geom)
+/* ---------------------------------------------------------------------- */
+{
+    assert (geom->dimensions      == G->dimensions);
+    assert (geom->number_of_cells == G->number_of_cells);
+    assert (geom->number_of_faces == G->number_of_faces);
+
+    scatter(G->face_normals  , G->number_of_faces, G->dimensions,
+            geom->face_normals);
+    scatter(G->face_centroids, G->number_of_faces, G->dimensions,
+            geom->face_centroids);
+    scatter(G->cell_centroids, G->number_of_cells, G->dimensions,
+            geom->cell_centroids);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+destroy_geometry_soa(struct GridGeometrySoA *geom)
+/* ---------------------------------------------------------------------- */
+{
+    if (geom != NULL) {
+        free(geom->storage);
+    }
+
+    free(geom);
+}
@@ -0,0 +1,91 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_GEOMETRY_SOA_HEADER_INCLUDED
+#define OPM_GEOMETRY_SOA_HEADER_INCLUDED
+
+/**
+ * \file
+ *
+ * Structure-of-arrays mirror of the vector-valued geometry fields of an
+ * UnstructuredGrid, for kernels that benefit from unit-stride access to
+ * individual coordinate components.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct UnstructuredGrid;
+
+/**
+   Geometry of an UnstructuredGrid, one array per coordinate direction.
+
+   Component @c d of the normal of face @c f is
+   <code>face_normals[d][f]</code>, and correspondingly for the face and
+   cell centroids.  Every array starts on a 64 byte boundary.  Entries for
+   directions <code>d >= dimensions</code> are <code>NULL</code>.
+*/
+struct GridGeometrySoA {
+    int     dimensions;      /**< Number of physical dimensions. */
+    int     number_of_cells; /**< Number of cells. */
+    int     number_of_faces; /**< Number of faces. */
+
+    double *face_normals  [3]; /**< Face normals by component. */
+    double *face_centroids[3]; /**< Face centroids by component. */
+    double *cell_centroids[3]; /**< Cell centroids by component. */
+
+    void   *storage;         /**< Backing allocation.  Internal. */
+};
+
+/**
+   Create a structure-of-arrays mirror of the geometry of a grid.
+
+   \param[in] G Grid with computed geometry.
+   \return Mirror of the geometry of @c G.  @c NULL in case of
+   allocation failure.  Release with destroy_geometry_soa().
+ */
+struct GridGeometrySoA *
+create_geometry_soa(const struct UnstructuredGrid *G);
+
+/**
+   Refresh a mirror after the geometry of its grid has changed.  The grid
+   must have the same number of cells and faces as when the mirror was
+   created.
+
+   \param[in]     G    Grid.
+   \param[in,out] geom Mirror created from @c G by create_geometry_soa().
+ */
+void
+update_geometry_soa(const struct UnstructuredGrid *G,
+                    struct GridGeometrySoA        *geom);
+
+/**
+   Release a mirror created by create_geometry_soa().
+
+   \param[in,out] geom Mirror.  May be @c NULL.
+ */
+void
+destroy_geometry_soa(struct GridGeometrySoA *geom);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPM_GEOMETRY_SOA_HEADER_INCLUDED */
@@ -0,0 +1,554 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define GRID_BINARY_HAVE_MMAP 1
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#else
+#define GRID_BINARY_HAVE_MMAP 0
+#endif
+
+#include "config.h"
+#include <opm/core/grid.h>
+#include <opm/core/grid/grid_binary.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if GRID_BINARY_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Binary grid file layout (native byte order):
+ *
+ *   [   0, 128)  struct grid_binary_header
+ *   [ 128, ...)  Grid arrays in the order of grid_binary_arrays(), each
+ *                starting on a GRID_BINARY_ALIGN byte boundary and
+ *                zero padded up to the next array.
+ *
+ * The checksum covers the array contents, excluding padding.
+ */
+
+#define GRID_BINARY_ALIGN    64
+#define GRID_BINARY_VERSION   1
+#define GRID_BINARY_BYTEORDER 0x01020304u
+#define GRID_BINARY_NARRAYS  13
+
+#define GRID_BINARY_HAS_TAG        (1 << 0)
+#define GRID_BINARY_HAS_GLOBALCELL (1 << 1)
+
+static const char grid_binary_magic[8] = { 'O', 'P', 'M', 'U', 'G', 'R', 'I', 'D' };
+
+struct grid_binary_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+    uint64_t key;
+    uint64_t checksum;
+    uint64_t total_size;
+
+    int32_t  dimensions;
+    int32_t  number_of_cells;
+    int32_t  number_of_faces;
+    int32_t  number_of_nodes;
+    int32_t  number_of_facenodes;
+    int32_t  number_of_cellfaces;
+    int32_t  cartdims[3];
+    int32_t  flags;
+
+    char     reserved[128 - 40 - 10*4];
+};
+
+struct grid_binary_array {
+    void   *data;
+    size_t  nbytes;
+};
+
+/* Mapped file region backing the arrays of a grid created by
+ * map_grid_binary(). */
+struct grid_mapping {
+    void   *addr;
+    size_t  len;
+};
+
+
+/* ---------------------------------------------------------------------- */
+uint64_t
+grid_hash_update(uint64_t h, const void *data, size_t nbytes)
+/* ---------------------------------------------------------------------- */
+{
+    /* 64-bit FNV-1a */
+    const unsigned char *p = data;
+    size_t               i;
+
+    for (i = 0; i < nbytes; i++) {
+        h ^= p[i];
+        h *= (uint64_t) 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static size_t
+aligned_size(size_t nbytes)
+/* ---------------------------------------------------------------------- */
+{
+    return ((nbytes + GRID_BINARY_ALIGN - 1) / GRID_BINARY_ALIGN)
+        * GRID_BINARY_ALIGN;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+grid_binary_arrays(const struct grid_binary_header *hdr,
+                   const struct UnstructuredGrid   *G,
+                   struct grid_binary_array        *a)
+/* ---------------------------------------------------------------------- */
+{
+    /* Array sizes follow from the header alone.  Optional arrays
+     * absent from the file have size zero. */
+    size_t nd, nc, nf, nn, nfn, ncf;
+    int    has_tag, has_gc;
+
+    nd  = hdr->dimensions;
+    nc  = hdr->number_of_cells;
+    nf  = hdr->number_of_faces;
+    nn  = hdr->number_of_nodes;
+    nfn = hdr->number_of_facenodes;
+    ncf = hdr->number_of_cellfaces;
+
+    has_tag = (hdr->flags & GRID_BINARY_HAS_TAG)        != 0;
+    has_gc  = (hdr->flags & GRID_BINARY_HAS_GLOBALCELL) != 0;
+
+#define SET_ARRAY(i, ptr, n)                    \
+    do {                                        \
+        a[i].data   = (ptr);                    \
+        a[i].nbytes = (n) * sizeof *(ptr);      \
+    } while (0)
+
+    SET_ARRAY( 0, G->node_coordinates, nd * nn      );
+    SET_ARRAY( 1, G->face_nodepos    , nf + 1       );
+    SET_ARRAY( 2, G->face_nodes      , nfn          );
+    SET_ARRAY( 3, G->face_cells      , 2 * nf       );
+    SET_ARRAY( 4, G->face_areas      , nf           );
+    SET_ARRAY( 5, G->face_centroids  , nd * nf      );
+    SET_ARRAY( 6, G->face_normals    , nd * nf      );
+    SET_ARRAY( 7, G->cell_facepos    , nc + 1       );
+    SET_ARRAY( 8, G->cell_faces      , ncf          );
+    SET_ARRAY( 9, G->cell_facetag    , has_tag * ncf);
+    SET_ARRAY(10, G->global_cell     , has_gc  * nc );
+    SET_ARRAY(11, G->cell_volumes    , nc           );
+    SET_ARRAY(12, G->cell_centroids  , nd * nc      );
+
+#undef SET_ARRAY
+}
+
+
+/* ---------------------------------------------------------------------- */
+static FILE *
+open_temporary(const char *fname, char **tmpname)
+/* ---------------------------------------------------------------------- */
+{
+    FILE *fp;
+
+#if GRID_BINARY_HAVE_MMAP
+    int fd;
+
+    *tmpname = malloc(strlen(fname) + sizeof ".XXXXXX");
+    if (*tmpname == NULL) {
+        return NULL;
+    }
+    strcpy(*tmpname, fname);
+    strcat(*tmpname, ".XXXXXX");
+
+    fp = NULL;
+    fd = mkstemp(*tmpname);
+    if (fd >= 0) {
+        /* mkstemp() creates the file private to its owner. */
+        fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+        fp = fdopen(fd, "wb");
+        if (fp == NULL) {
+            close(fd);
+            unlink(*tmpname);
+        }
+    }
+#else
+    static unsigned long count = 0;
+    unsigned long        suffix;
+
+    /* Room for ".", at most 16 hex digits and ".tmp". */
+    *tmpname = malloc(strlen(fname) + 1 + 16 + sizeof ".tmp");
+    if (*tmpname == NULL) {
+        return NULL;
+    }
+
+    suffix  = (unsigned long) time(NULL) ^ ((unsigned long) clock() << 16);
+    suffix ^= (unsigned long) (size_t) tmpname ^ (++count << 24);
+    sprintf(*tmpname, "%s.%lx.tmp", fname, suffix & 0xffffffffUL);
+
+    fp = fopen(*tmpname, "wb");
+#endif
+
+    if (fp == NULL) {
+        free(*tmpname);
+        *tmpname = NULL;
+    }
+
+    return fp;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+write_grid_binary(const struct UnstructuredGrid *G,
+                  const char                    *fname,
+                  uint64_t                       key)
+/* ---------------------------------------------------------------------- */
+{
+    struct grid_binary_header hdr;
+    struct grid_binary_array  a[GRID_BINARY_NARRAYS];
+
+    static const char zeros[GRID_BINARY_ALIGN] = { 0 };
+
+    char   *tmpname;
+    FILE   *fp;
+    size_t  i, pad, total;
+    int     ok, save_errno;
+
+    save_errno = errno;
+
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, grid_binary_magic, sizeof hdr.magic);
+
+    hdr.version             = GRID_BINARY_VERSION;
+    hdr.byteorder           = GRID_BINARY_BYTEORDER;
+    hdr.key                 = key;
+    hdr.dimensions          = G->dimensions;
+    hdr.number_of_cells     = G->number_of_cells;
+    hdr.number_of_faces     = G->number_of_faces;
+    hdr.number_of_nodes     = G->number_of_nodes;
+    hdr.number_of_facenodes = G->face_nodepos[ G->number_of_faces ];
+    hdr.number_of_cellfaces = G->cell_facepos[ G->number_of_cells ];
+    hdr.cartdims[0]         = G->cartdims[0];
+    hdr.cartdims[1]         = G->cartdims[1];
+    hdr.cartdims[2]         = G->cartdims[2];
+    hdr.flags               =
+        ((G->cell_facetag != NULL) ? GRID_BINARY_HAS_TAG        : 0) |
+        ((G->global_cell  != NULL) ? GRID_BINARY_HAS_GLOBALCELL : 0);
+
+    grid_binary_arrays(&hdr, G, a);
+
+    hdr.checksum = GRID_HASH_INIT;
+    total        = sizeof hdr;
+    for (i = 0; i < GRID_BINARY_NARRAYS; i++) {
+        if ((a[i].nbytes > 0) && (a[i].data == NULL)) {
+            /* Incomplete grid (e.g., no geometry). */
+            return 0;
+        }
+
+        hdr.checksum = grid_hash_update(hdr.checksum, a[i].data, a[i].nbytes);
+        total       += aligned_size(a[i].nbytes);
+    }
+    hdr.total_size = total;
+
+    /* Write to a temporary file of our own in the same directory and
+     * rename it into place, so that concurrent writers do not clobber
+     * each other and readers never observe a partially written file. */
+    fp = open_temporary(fname, &tmpname);
+    ok = fp != NULL;
+
+    if (ok) {
+        ok = fwrite(&hdr, sizeof hdr, 1, fp) == 1;
+
+        for (i = 0; ok && (i < GRID_BINARY_NARRAYS); i++) {
+            if (a[i].nbytes > 0) {
+                ok  = fwrite(a[i].data, 1, a[i].nbytes, fp) == a[i].nbytes;
+                pad = aligned_size(a[i].nbytes) - a[i].nbytes;
+                ok  = ok && (fwrite(zeros, 1, pad, fp) == pad);
+            }
+        }
+
+        ok = (fclose(fp) == 0) && ok;
+        ok = ok && (rename(tmpname, fname) == 0);
+
+        if (! ok) {
+            remove(tmpname);
+        }
+
+        free(tmpname);
+    }
+
+    errno = save_errno;
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+header_valid(const struct grid_binary_header *hdr, uint64_t key)
+/* ---------------------------------------------------------------------- */
+{
+    return (memcmp(hdr->magic, grid_binary_magic, sizeof hdr->magic) == 0)
+        && (hdr->version    == GRID_BINARY_VERSION)
+        && (hdr->byteorder  == GRID_BINARY_BYTEORDER)
+        && (hdr->key        == key)
+        && (hdr->dimensions      > 0)
+        && (hdr->number_of_cells     >= 0)
+        && (hdr->number_of_faces     >= 0)
+        && (hdr->number_of_nodes     >= 0)
+        && (hdr->number_of_facenodes >= 0)
+        && (hdr->number_of_cellfaces >= 0);
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct UnstructuredGrid *
+read_grid_binary(const char *fname, uint64_t key)
+/* ---------------------------------------------------------------------- */
+{
+    struct grid_binary_header hdr;
+    struct grid_binary_array  a[GRID_BINARY_NARRAYS];
+    struct UnstructuredGrid  *G;
+
+    char     pad[GRID_BINARY_ALIGN];
+    FILE    *fp;
+    size_t   i, npad;
+    uint64_t checksum;
+    int      ok, save_errno;
+
+    save_errno = errno;
+
+    fp = fopen(fname, "rb");
+    if (fp == NULL) {
+        errno = save_errno;
+        return NULL;
+    }
+
+    G  = NULL;
+    ok = (fread(&hdr, sizeof hdr, 1, fp) == 1) && header_valid(&hdr, key);
+
+    if (ok) {
+        G = allocate_grid(hdr.dimensions         ,
+                          hdr.number_of_cells    ,
+                          hdr.number_of_faces    ,
+                          hdr.number_of_facenodes,
+                          hdr.number_of_cellfaces,
+                          hdr.number_of_nodes    );
+        ok = G != NULL;
+    }
+
+    if (ok) {
+        G->dimensions      = hdr.dimensions;
+        G->number_of_cells = hdr.number_of_cells;
+        G->number_of_faces = hdr.number_of_faces;
+        G->number_of_nodes = hdr.number_of_nodes;
+        G->cartdims[0]     = hdr.cartdims[0];
+        G->cartdims[1]     = hdr.cartdims[1];
+        G->cartdims[2]     = hdr.cartdims[2];
+
+        if (! (hdr.flags & GRID_BINARY_HAS_TAG)) {
+            free(G->cell_facetag);
+            G->cell_facetag = NULL;
+        }
+
+        if (hdr.flags & GRID_BINARY_HAS_GLOBALCELL) {
+            G->global_cell = malloc(hdr.number_of_cells * sizeof *G->global_cell);
+            ok = (G->global_cell != NULL) || (hdr.number_of_cells == 0);
+        }
+    }
+
+    if (ok) {
+        grid_binary_arrays(&hdr, G, a);
+
+        checksum = GRID_HASH_INIT;
+        for (i = 0; ok && (i < GRID_BINARY_NARRAYS); i++) {
+            if (a[i].nbytes > 0) {
+                npad = aligned_size(a[i].nbytes) - a[i].nbytes;
+                ok   = (fread(a[i].data, 1, a[i].nbytes, fp) == a[i].nbytes)
+                    && (fread(pad, 1, npad, fp) == npad);
+
+                checksum = grid_hash_update(checksum, a[i].data, a[i].nbytes);
+            }
+        }
+
+        ok = ok && (checksum == hdr.checksum);
+    }
+
+    if (ok) {
+        grid_update_hash(G);
+    }
+    else {
+        destroy_grid(G);
+        G = NULL;
+    }
+
+    fclose(fp);
+
+    errno = save_errno;
+
+    return G;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct UnstructuredGrid *
+map_grid_binary(const char *fname, uint64_t key)
+/* ---------------------------------------------------------------------- */
+{
+#if GRID_BINARY_HAVE_MMAP
+    struct grid_binary_header hdr;
+    struct grid_binary_array  a[GRID_BINARY_NARRAYS];
+    struct grid_mapping      *map;
+    struct UnstructuredGrid  *G;
+    struct stat               st;
+
+    char     *base;
+    void     *addr;
+    size_t    i, len, off[GRID_BINARY_NARRAYS];
+    uint64_t  checksum;
+    int       fd, ok, save_errno;
+
+    save_errno = errno;
+
+    fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        errno = save_errno;
+        return NULL;
+    }
+
+    ok   = (fstat(fd, &st) == 0) && ((size_t) st.st_size >= sizeof hdr);
+    len  = ok ? (size_t) st.st_size : 0;
+    addr = ok ? mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+    /* The mapping stays valid after the descriptor is closed. */
+    close(fd);
+
+    if (addr == MAP_FAILED) {
+        errno = save_errno;
+        return NULL;
+    }
+
+    base = addr;
+    memcpy(&hdr, base, sizeof hdr);
+
+    G   = create_grid_empty();
+    map = malloc(sizeof *map);
+
+    ok = (G != NULL) && (map != NULL) &&
+        header_valid(&hdr, key) && (hdr.total_size == len);
+
+    if (ok) {
+        grid_binary_arrays(&hdr, G, a);
+
+        checksum = GRID_HASH_INIT;
+        off[0]   = sizeof hdr;
+        for (i = 0; i < GRID_BINARY_NARRAYS; i++) {
+            checksum = grid_hash_update(checksum, base + off[i], a[i].nbytes);
+
+            if (i + 1 < GRID_BINARY_NARRAYS) {
+                off[i + 1] = off[i] + aligned_size(a[i].nbytes);
+            }
+        }
+
+        ok = checksum == hdr.checksum;
+    }
+
+    if (ok) {
+#define MAP_ARRAY(i, field)                                     \
+        G->field = (a[i].nbytes > 0) ? (void *) (base + off[i]) : NULL
+
+        MAP_ARRAY( 0, node_coordinates);
+        MAP_ARRAY( 1, face_nodepos    );
+        MAP_ARRAY( 2, face_nodes      );
+        MAP_ARRAY( 3, face_cells      );
+        MAP_ARRAY( 4, face_areas      );
+        MAP_ARRAY( 5, face_centroids  );
+        MAP_ARRAY( 6, face_normals    );
+        MAP_ARRAY( 7, cell_facepos    );
+        MAP_ARRAY( 8, cell_faces      );
+        MAP_ARRAY( 9, cell_facetag    );
+        MAP_ARRAY(10, global_cell     );
+        MAP_ARRAY(11, cell_volumes    );
+        MAP_ARRAY(12, cell_centroids  );
+
+#undef MAP_ARRAY
+
+        G->dimensions      = hdr.dimensions;
+        G->number_of_cells = hdr.number_of_cells;
+        G->number_of_faces = hdr.number_of_faces;
+        G->number_of_nodes = hdr.number_of_nodes;
+        G->cartdims[0]     = hdr.cartdims[0];
+        G->cartdims[1]     = hdr.cartdims[1];
+        G->cartdims[2]     = hdr.cartdims[2];
+
+        map->addr = addr;
+        map->len  = len;
+        G->mapping = map;
+
+        grid_update_hash(G);
+    }
+    else {
+        free(map);
+        free(G);
+        G = NULL;
+
+        munmap(addr, len);
+    }
+
+    errno = save_errno;
+
+    return G;
+#else
+    (void) fname;
+    (void) key;
+
+    return NULL;
+#endif
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+release_grid_mapping(struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    struct grid_mapping *map = G->mapping;
+
+    if (map != NULL) {
+#if GRID_BINARY_HAVE_MMAP
+        munmap(map->addr, map->len);
+#endif
+        free(map);
+
+        G->mapping = NULL;
+    }
+}
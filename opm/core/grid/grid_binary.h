@@ -0,0 +1,40 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_GRID_BINARY_HEADER_INCLUDED
+#define OPM_GRID_BINARY_HEADER_INCLUDED
+
+/* Internal to the grid implementation. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct UnstructuredGrid;
+
+/* Unmap the file backing a grid created by map_grid_binary() and reset
+ * G->mapping.  The grid's array pointers are dangling afterwards. */
+void
+release_grid_mapping(struct UnstructuredGrid *G);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPM_GRID_BINARY_HEADER_INCLUDED */
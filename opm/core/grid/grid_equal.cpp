@@ -14,13 +14,27 @@
 
 bool
 grid_equal(const struct UnstructuredGrid * grid1 , const struct UnstructuredGrid * grid2) {
+    if (grid1 == grid2)
+        return true;
+
+    // Cached hashes decide the comparison unless the geometry differs
+    // bitwise, in which case it may still agree within the tolerance.
+    const bool known_topology = (grid1->topology_hash != 0) && (grid2->topology_hash != 0);
+    if (known_topology) {
+        if (grid1->topology_hash != grid2->topology_hash)
+            return false;
+
+        if ((grid1->geometry_hash != 0) && (grid1->geometry_hash == grid2->geometry_hash))
+            return true;
+    }
+
     if ((grid1->dimensions      == grid2->dimensions)      &&
         (grid1->number_of_cells == grid2->number_of_cells) &&
         (grid1->number_of_faces == grid2->number_of_faces) &&
         (grid1->number_of_nodes == grid2->number_of_nodes)) {
 
         // Exact integer comparisons
-        {
+        if (!known_topology) {
             if (memcmp(grid1->face_nodepos , grid2->face_nodepos , (grid1->number_of_faces + 1) * sizeof * grid1->face_nodepos) != 0)
             return false;
 
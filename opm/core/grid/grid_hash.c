@@ -0,0 +1,202 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+
+#include <opm/core/grid.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Arrays are hashed in chunks of this many bytes.  Chunk hashes are
+ * independent, and thus computed in parallel, and then combined in
+ * order, making the result independent of the number of threads. */
+#define GRID_HASH_CHUNK (((size_t) 1) << 16)
+
+/* Topology (first) and geometry arrays entering the hashes. */
+#define GRID_HASH_NTOPO  7
+#define GRID_HASH_NARRAYS 13
+
+struct grid_hash_array {
+    const void *data;
+    size_t      nbytes;
+};
+
+
+/* ---------------------------------------------------------------------- */
+static size_t
+nchunks(size_t nbytes)
+/* ---------------------------------------------------------------------- */
+{
+    return (nbytes + GRID_HASH_CHUNK - 1) / GRID_HASH_CHUNK;
+}
+
+
+/* FNV-1a like hash processing eight bytes per step. */
+/* ---------------------------------------------------------------------- */
+static uint64_t
+hash_chunk(const unsigned char *p, size_t nbytes)
+/* ---------------------------------------------------------------------- */
+{
+    uint64_t h, w;
+    size_t   i, nw;
+
+    h  = GRID_HASH_INIT;
+    nw = nbytes / sizeof w;
+
+    for (i = 0; i < nw; i++) {
+        memcpy(&w, p + i*sizeof w, sizeof w);
+
+        h ^= w;
+        h *= (uint64_t) 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+
+    return grid_hash_update(h, p + nw*sizeof w, nbytes - nw*sizeof w);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+grid_hash_arrays(const struct UnstructuredGrid *G,
+                 struct grid_hash_array        *a)
+/* ---------------------------------------------------------------------- */
+{
+    size_t nd, nc, nf, nn, nfn, ncf;
+
+    nd  = G->dimensions;
+    nc  = G->number_of_cells;
+    nf  = G->number_of_faces;
+    nn  = G->number_of_nodes;
+    nfn = (G->face_nodepos != NULL) ? G->face_nodepos[nf] : 0;
+    ncf = (G->cell_facepos != NULL) ? G->cell_facepos[nc] : 0;
+
+#define HASH_ARRAY(i, field, n)                                        \
+    a[i].data   = G->field;                                            \
+    a[i].nbytes = (G->field != NULL) ? (n) * sizeof *G->field : 0
+
+    HASH_ARRAY( 0, face_nodepos    , nf + 1 );
+    HASH_ARRAY( 1, face_nodes      , nfn    );
+    HASH_ARRAY( 2, face_cells      , 2 * nf );
+    HASH_ARRAY( 3, cell_facepos    , nc + 1 );
+    HASH_ARRAY( 4, cell_faces      , ncf    );
+    HASH_ARRAY( 5, global_cell     , nc     );
+    HASH_ARRAY( 6, cell_facetag    , ncf    );
+
+    HASH_ARRAY( 7, node_coordinates, nd * nn);
+    HASH_ARRAY( 8, face_centroids  , nd * nf);
+    HASH_ARRAY( 9, face_areas      , nf     );
+    HASH_ARRAY(10, face_normals    , nd * nf);
+    HASH_ARRAY(11, cell_centroids  , nd * nc);
+    HASH_ARRAY(12, cell_volumes    , nc     );
+
+#undef HASH_ARRAY
+}
+
+
+/* ---------------------------------------------------------------------- */
+static uint64_t
+combine(uint64_t h, const struct grid_hash_array *a,
+        const uint64_t *chunk_hash)
+/* ---------------------------------------------------------------------- */
+{
+    int present;
+
+    present = a->data != NULL;
+
+    h = grid_hash_update(h, &present  , sizeof present  );
+    h = grid_hash_update(h, &a->nbytes, sizeof a->nbytes);
+    h = grid_hash_update(h, chunk_hash, nchunks(a->nbytes) * sizeof *chunk_hash);
+
+    return h;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+grid_update_hash(struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    struct grid_hash_array a[GRID_HASH_NARRAYS];
+    size_t                 start[GRID_HASH_NARRAYS + 1];
+    uint64_t              *chunk_hash, h;
+    long                   k, n;
+    int                    i, header[4];
+
+    grid_invalidate_hash(G);
+    grid_hash_arrays(G, a);
+
+    start[0] = 0;
+    for (i = 0; i < GRID_HASH_NARRAYS; i++) {
+        start[i + 1] = start[i] + nchunks(a[i].nbytes);
+    }
+
+    chunk_hash = malloc((start[GRID_HASH_NARRAYS] + 1) * sizeof *chunk_hash);
+    if (chunk_hash == NULL) {
+        /* Hashes remain unknown. */
+        return;
+    }
+
+    n = (long) start[GRID_HASH_NARRAYS];
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 16) private(i)
+#endif
+    for (k = 0; k < n; k++) {
+        size_t off, len;
+
+        for (i = 0; start[i + 1] <= (size_t) k; i++) { ; }
+
+        off = (((size_t) k) - start[i]) * GRID_HASH_CHUNK;
+        len = a[i].nbytes - off;
+        if (len > GRID_HASH_CHUNK) { len = GRID_HASH_CHUNK; }
+
+        chunk_hash[k] = hash_chunk((const unsigned char *) a[i].data + off, len);
+    }
+
+    header[0] = G->dimensions;
+    header[1] = G->number_of_cells;
+    header[2] = G->number_of_faces;
+    header[3] = G->number_of_nodes;
+
+    h = grid_hash_update(GRID_HASH_INIT, header, sizeof header);
+    for (i = 0; i < GRID_HASH_NTOPO; i++) {
+        h = combine(h, &a[i], chunk_hash + start[i]);
+    }
+    G->topology_hash = (h != 0) ? h : 1;
+
+    h = GRID_HASH_INIT;
+    for (i = GRID_HASH_NTOPO; i < GRID_HASH_NARRAYS; i++) {
+        h = combine(h, &a[i], chunk_hash + start[i]);
+    }
+    G->geometry_hash = (h != 0) ? h : 1;
+
+    free(chunk_hash);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+grid_invalidate_hash(struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    G->topology_hash = 0;
+    G->geometry_hash = 0;
+}
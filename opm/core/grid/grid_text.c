@@ -0,0 +1,746 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define GRID_TEXT_HAVE_MMAP 1
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+#else
+#define GRID_TEXT_HAVE_MMAP 0
+#endif
+
+#include "config.h"
+#include <opm/core/grid.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if GRID_TEXT_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+/*
+ * Reader for the character grid format of read_grid():
+ *
+ *   ndims ncells nfaces nnodes nfacenodes ncellfaces  has_tag has_indexmap
+ *   cartdims[0 .. ndims-1]
+ *   node_coordinates, face_nodepos, face_nodes, face_cells, face_areas,
+ *   face_centroids, face_normals, cell_facepos, cell_faces (interleaved
+ *   with cell_facetag if has_tag), global_cell (if has_indexmap),
+ *   cell_volumes, cell_centroids
+ *
+ * all separated by arbitrary white space.  The header fixes the number of
+ * values in every array, so the body is split into chunks on white space
+ * boundaries, the values of each chunk are counted in parallel, and a
+ * second parallel pass parses every value directly into its place in the
+ * arrays of allocate_grid().
+ */
+
+#define GRID_NMETA      6
+#define GRID_NDIMS      0
+#define GRID_NCELLS     1
+#define GRID_NFACES     2
+#define GRID_NNODES     3
+#define GRID_NFACENODES 4
+#define GRID_NCELLFACES 5
+
+#define GRID_TEXT_NSECTIONS   12
+#define GRID_TEXT_MIN_CHUNK   (1 << 20) /* bytes */
+#define GRID_TEXT_TOKEN_MAX   128
+
+
+struct grid_text_buffer {
+    const char *data;
+    size_t      size;
+    int         mapped;
+};
+
+enum grid_text_kind { GRID_TEXT_INT, GRID_TEXT_DOUBLE };
+
+/* A run of 'count' consecutive values in the body, distributed
+ * round-robin over 'ncomp' destination arrays.  A NULL destination
+ * discards its values. */
+struct grid_text_section {
+    const char          *what;
+    enum grid_text_kind  kind;
+    size_t               start;
+    size_t               count;
+    int                  ncomp;
+    void                *dst[2];
+};
+
+
+/* ---------------------------------------------------------------------- */
+static int
+is_space(char c)
+/* ---------------------------------------------------------------------- */
+{
+    return (c == ' ' ) || (c == '\n') || (c == '\t') ||
+           (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+is_digit(char c)
+/* ---------------------------------------------------------------------- */
+{
+    return (c >= '0') && (c <= '9');
+}
+
+
+/* ---------------------------------------------------------------------- */
+static const char *
+skip_space(const char *p, const char *end)
+/* ---------------------------------------------------------------------- */
+{
+    while ((p < end) && is_space(*p)) { p++; }
+
+    return p;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static const char *
+token_end(const char *p, const char *end)
+/* ---------------------------------------------------------------------- */
+{
+    while ((p < end) && !is_space(*p)) { p++; }
+
+    return p;
+}
+
+
+/* Parse a decimal integer token at *pp.  Returns non-zero on success. */
+/* ---------------------------------------------------------------------- */
+static int
+parse_long(const char **pp, const char *end, long long *x)
+/* ---------------------------------------------------------------------- */
+{
+    const char *p;
+    long long   v;
+    int         neg;
+
+    p   = *pp;
+    neg = 0;
+
+    if ((p < end) && ((*p == '+') || (*p == '-'))) {
+        neg = *p == '-';
+        p  += 1;
+    }
+
+    if (! ((p < end) && is_digit(*p))) {
+        return 0;
+    }
+
+    v = 0;
+    while ((p < end) && is_digit(*p)) {
+        if (v > (INT64_MAX - 9) / 10) {
+            return 0;
+        }
+
+        v = 10*v + (*p - '0');
+        p += 1;
+    }
+
+    if ((p < end) && !is_space(*p)) {
+        return 0;
+    }
+
+    *x  = neg ? -v : v;
+    *pp = p;
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+parse_int(const char **pp, const char *end, int *x)
+/* ---------------------------------------------------------------------- */
+{
+    long long v;
+
+    if (! parse_long(pp, end, &v) || (v < INT32_MIN) || (v > INT32_MAX)) {
+        return 0;
+    }
+
+    *x = (int) v;
+
+    return 1;
+}
+
+
+/* Parse a floating point token at *pp.  Numbers of at most 15
+ * significant digits and a decimal exponent within [-22, 22] are
+ * exactly representable as a quotient or product of two doubles and
+ * are converted directly (correctly rounded).  Everything else,
+ * including "inf" and "nan", goes through strtod(). */
+/* ---------------------------------------------------------------------- */
+static int
+parse_double(const char **pp, const char *end, double *x)
+/* ---------------------------------------------------------------------- */
+{
+    static const double pow10[] = {
+        1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 , 1e8 , 1e9 , 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22
+    };
+
+    const char *p, *start;
+    uint64_t    m;
+    int         nd, e10, neg, any, exact;
+
+    start = p = *pp;
+    m     = 0;
+    nd    = e10 = neg = any = 0;
+    exact = 1;
+
+    if ((p < end) && ((*p == '+') || (*p == '-'))) {
+        neg = *p == '-';
+        p  += 1;
+    }
+
+    for (; (p < end) && is_digit(*p); p++) {
+        any = 1;
+        if ((m == 0) && (*p == '0')) { continue; }
+        if (nd < 15) { m = 10*m + (*p - '0'); nd++; }
+        else         { e10++; exact = 0; }
+    }
+
+    if ((p < end) && (*p == '.')) {
+        for (p++; (p < end) && is_digit(*p); p++) {
+            any = 1;
+            if ((m == 0) && (*p == '0')) { e10--; continue; }
+            if (nd < 15) { m = 10*m + (*p - '0'); nd++; e10--; }
+            else         { exact = 0; }
+        }
+    }
+
+    if (any && (p < end) && ((*p == 'e') || (*p == 'E'))) {
+        const char *q;
+        int         eneg, e;
+
+        q    = p + 1;
+        eneg = 0;
+        if ((q < end) && ((*q == '+') || (*q == '-'))) {
+            eneg = *q == '-';
+            q   += 1;
+        }
+
+        if ((q < end) && is_digit(*q)) {
+            for (e = 0; (q < end) && is_digit(*q); q++) {
+                if (e < 100000) { e = 10*e + (*q - '0'); }
+            }
+
+            e10 += eneg ? -e : e;
+            p    = q;
+        }
+    }
+
+    if (any && exact && ((p == end) || is_space(*p))) {
+        if (m == 0) {
+            *x = neg ? -0.0 : 0.0;
+        }
+        else if ((e10 >= -22) && (e10 <= 22)) {
+            *x = (double) m;
+            *x = (e10 < 0) ? (*x / pow10[-e10]) : (*x * pow10[e10]);
+            if (neg) { *x = -*x; }
+        }
+        else {
+            exact = 0;
+        }
+
+        if (exact) {
+            *pp = p;
+            return 1;
+        }
+    }
+
+    /* Slow path.  The buffer need not be NUL-terminated. */
+    {
+        char   buf[GRID_TEXT_TOKEN_MAX], *stop;
+        size_t len;
+
+        p   = token_end(start, end);
+        len = p - start;
+
+        if ((len == 0) || (len >= sizeof buf)) {
+            return 0;
+        }
+
+        memcpy(buf, start, len);
+        buf[len] = '\0';
+
+        *x = strtod(buf, &stop);
+        if (stop != buf + len) {
+            return 0;
+        }
+
+        *pp = p;
+        return 1;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+load_file(const char *fname, struct grid_text_buffer *b)
+/* ---------------------------------------------------------------------- */
+{
+    FILE *fp;
+    char *data;
+    long  len;
+
+    b->data   = NULL;
+    b->size   = 0;
+    b->mapped = 0;
+
+#if GRID_TEXT_HAVE_MMAP
+    {
+        struct stat st;
+        void       *addr;
+        int         fd;
+
+        fd = open(fname, O_RDONLY);
+        if (fd < 0) {
+            return 0;
+        }
+
+        addr = MAP_FAILED;
+        if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+            addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+
+        close(fd);
+
+        if (addr != MAP_FAILED) {
+            b->data   = addr;
+            b->size   = (size_t) st.st_size;
+            b->mapped = 1;
+
+            return 1;
+        }
+    }
+#endif
+
+    fp = fopen(fname, "rb");
+    if (fp == NULL) {
+        return 0;
+    }
+
+    data = NULL;
+    len  = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        len = ftell(fp);
+    }
+
+    if ((len >= 0) && (fseek(fp, 0, SEEK_SET) == 0)) {
+        data = malloc((len > 0) ? (size_t) len : 1);
+
+        if ((data != NULL) && (fread(data, 1, (size_t) len, fp) != (size_t) len)) {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    fclose(fp);
+
+    b->data = data;
+    b->size = (data != NULL) ? (size_t) len : 0;
+
+    return data != NULL;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+release_file(struct grid_text_buffer *b)
+/* ---------------------------------------------------------------------- */
+{
+#if GRID_TEXT_HAVE_MMAP
+    if (b->mapped) {
+        munmap((void *) b->data, b->size);
+        return;
+    }
+#endif
+
+    free((void *) b->data);
+}
+
+
+/* Read the header and allocate the grid.  On success, *pp points past
+ * the Cartesian dimensions. */
+/* ---------------------------------------------------------------------- */
+static struct UnstructuredGrid *
+allocate_grid_from_text(const char **pp, const char *end,
+                        int *has_tag, int *has_indexmap, size_t *dimens)
+/* ---------------------------------------------------------------------- */
+{
+    struct UnstructuredGrid *G;
+
+    const char *p;
+    long long   tmp;
+    size_t      i, n;
+    int         ok;
+
+    p  = *pp;
+    ok = 1;
+
+    for (i = 0; ok && (i < GRID_NMETA); i++) {
+        p  = skip_space(p, end);
+        ok = parse_long(&p, end, &tmp) && (tmp >= 0);
+
+        dimens[i] = ok ? (size_t) tmp : 0;
+    }
+
+    if (! ok) {
+        fprintf(stderr, "Unable to read grid dimensions\n");
+        return NULL;
+    }
+
+    p  = skip_space(p, end);
+    ok = parse_int(&p, end, has_tag);
+    p  = skip_space(p, end);
+    ok = ok && parse_int(&p, end, has_indexmap);
+
+    if (! ok) {
+        fprintf(stderr, "Unable to read grid predicates\n");
+        return NULL;
+    }
+
+    G = allocate_grid(dimens[GRID_NDIMS]     ,
+                      dimens[GRID_NCELLS]    ,
+                      dimens[GRID_NFACES]    ,
+                      dimens[GRID_NFACENODES],
+                      dimens[GRID_NCELLFACES],
+                      dimens[GRID_NNODES]    );
+
+    if (G == NULL) {
+        return NULL;
+    }
+
+    if (! *has_tag) {
+        free(G->cell_facetag);
+        G->cell_facetag = NULL;
+    }
+
+    if (*has_indexmap) {
+        G->global_cell =
+            malloc(dimens[GRID_NCELLS] * sizeof *G->global_cell);
+
+        /* Values are discarded on allocation failure. */
+    }
+
+    G->number_of_cells = (int) dimens[GRID_NCELLS];
+    G->number_of_faces = (int) dimens[GRID_NFACES];
+    G->number_of_nodes = (int) dimens[GRID_NNODES];
+    G->dimensions      = (int) dimens[GRID_NDIMS];
+
+    for (i = 0; ok && (i < dimens[GRID_NDIMS]); i++) {
+        p  = skip_space(p, end);
+        ok = parse_int(&p, end, & G->cartdims[ i ]);
+    }
+
+    if (! ok) {
+        fprintf(stderr, "Unable to read Cartesian dimensions\n");
+
+        destroy_grid(G);
+        return NULL;
+    }
+
+    /* Account for dimens[GRID_DIMS] < 3 */
+    n = (sizeof G->cartdims) / (sizeof G->cartdims[0]);
+    for (; i < n; i++) { G->cartdims[ i ] = 1; }
+
+    *pp = p;
+
+    return G;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static size_t
+define_sections(struct UnstructuredGrid *G, const size_t *dimens,
+                int has_tag, int has_indexmap,
+                struct grid_text_section *s)
+/* ---------------------------------------------------------------------- */
+{
+    size_t d, nc, nf, nn, nfn, ncf, i, start;
+
+    d   = dimens[GRID_NDIMS];
+    nc  = dimens[GRID_NCELLS];
+    nf  = dimens[GRID_NFACES];
+    nn  = dimens[GRID_NNODES];
+    nfn = dimens[GRID_NFACENODES];
+    ncf = dimens[GRID_NCELLFACES];
+
+#define SECTION(k, w, t, n, a, b)                                       \
+    do {                                                                \
+        s[k].what  = (w);      s[k].kind   = (t);                       \
+        s[k].count = (n);      s[k].ncomp  = ((b) != NULL) ? 2 : 1;     \
+        s[k].dst[0] = (void *) (a);                                     \
+        s[k].dst[1] = (void *) (b);                                     \
+    } while (0)
+
+    SECTION( 0, "node coordinates"         , GRID_TEXT_DOUBLE, d * nn , G->node_coordinates, NULL);
+    SECTION( 1, "node indirection array"   , GRID_TEXT_INT   , nf + 1 , G->face_nodepos    , NULL);
+    SECTION( 2, "face-nodes"               , GRID_TEXT_INT   , nfn    , G->face_nodes      , NULL);
+    SECTION( 3, "neighbourship"            , GRID_TEXT_INT   , 2 * nf , G->face_cells      , NULL);
+    SECTION( 4, "face areas"               , GRID_TEXT_DOUBLE, nf     , G->face_areas      , NULL);
+    SECTION( 5, "face centroids"           , GRID_TEXT_DOUBLE, d * nf , G->face_centroids  , NULL);
+    SECTION( 6, "face normals"             , GRID_TEXT_DOUBLE, d * nf , G->face_normals    , NULL);
+    SECTION( 7, "face indirection array"   , GRID_TEXT_INT   , nc + 1 , G->cell_facepos    , NULL);
+    SECTION( 8, "cell-faces"               , GRID_TEXT_INT   ,
+             (has_tag ? 2 : 1) * ncf, G->cell_faces, (has_tag ? G->cell_facetag : NULL));
+    SECTION( 9, "global cellmap"           , GRID_TEXT_INT   ,
+             (has_indexmap ? nc : 0), G->global_cell, NULL);
+    SECTION(10, "cell volumes"             , GRID_TEXT_DOUBLE, nc     , G->cell_volumes    , NULL);
+    SECTION(11, "cell centroids"           , GRID_TEXT_DOUBLE, d * nc , G->cell_centroids  , NULL);
+
+#undef SECTION
+
+    for (i = start = 0; i < GRID_TEXT_NSECTIONS; i++) {
+        s[i].start = start;
+        start     += s[i].count;
+    }
+
+    return start;
+}
+
+
+/* Parse the values of one chunk, the first of which is value number
+ * 'first' of the body.  Returns the index of the section of the first
+ * failing value, or GRID_TEXT_NSECTIONS if all values were parsed. */
+/* ---------------------------------------------------------------------- */
+static int
+parse_chunk(const char *p, const char *end, size_t first, size_t total,
+            const struct grid_text_section *s)
+/* ---------------------------------------------------------------------- */
+{
+    size_t t, j;
+    int    k, c, ok;
+
+    k = 0;
+    for (t = first; t < total; t++) {
+        p = skip_space(p, end);
+        if (p == end) {
+            break;
+        }
+
+        while (t >= s[k].start + s[k].count) { k++; }
+
+        j = (t - s[k].start);
+        c = (int) (j % s[k].ncomp);
+        j =        j / s[k].ncomp;
+
+        if (s[k].dst[c] == NULL) {
+            p = token_end(p, end);
+            continue;
+        }
+
+        if (s[k].kind == GRID_TEXT_INT) {
+            ok = parse_int   (&p, end, ((int    *) s[k].dst[c]) + j);
+        }
+        else {
+            ok = parse_double(&p, end, ((double *) s[k].dst[c]) + j);
+        }
+
+        if (! ok) {
+            return k;
+        }
+    }
+
+    return GRID_TEXT_NSECTIONS;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static size_t
+count_tokens(const char *p, const char *end)
+/* ---------------------------------------------------------------------- */
+{
+    size_t n;
+
+    for (n = 0; ; n++) {
+        p = skip_space(p, end);
+        if (p == end) {
+            break;
+        }
+
+        p = token_end(p, end);
+    }
+
+    return n;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+read_grid_body(const char *begin, const char *end,
+               struct grid_text_section *s, size_t total)
+/* ---------------------------------------------------------------------- */
+{
+    const char **cbeg;
+    size_t      *cfirst, len;
+    int          nchunk, i, failed, ok;
+
+    len    = end - begin;
+    nchunk = 1;
+#if defined(_OPENMP)
+    nchunk = 4 * omp_get_max_threads();
+#endif
+    if ((size_t) nchunk > (len / GRID_TEXT_MIN_CHUNK) + 1) {
+        nchunk = (int) (len / GRID_TEXT_MIN_CHUNK) + 1;
+    }
+
+    cbeg   = malloc((nchunk + 1) * sizeof *cbeg  );
+    cfirst = malloc((nchunk + 1) * sizeof *cfirst);
+
+    if ((cbeg == NULL) || (cfirst == NULL)) {
+        free(cbeg);  free(cfirst);
+        return 0;
+    }
+
+    /* Chunk boundaries, moved forward to white space so that no value
+     * straddles two chunks. */
+    cbeg[0]      = begin;
+    cbeg[nchunk] = end;
+    for (i = 1; i < nchunk; i++) {
+        cbeg[i] = begin + (len / nchunk) * i;
+        if (cbeg[i] < cbeg[i - 1]) { cbeg[i] = cbeg[i - 1]; }
+
+        cbeg[i] = token_end(cbeg[i], end);
+    }
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (i = 0; i < nchunk; i++) {
+        cfirst[i + 1] = count_tokens(cbeg[i], cbeg[i + 1]);
+    }
+
+    cfirst[0] = 0;
+    for (i = 0; i < nchunk; i++) {
+        cfirst[i + 1] += cfirst[i];
+    }
+
+    /* Trailing data beyond the last array is ignored. */
+    ok = cfirst[nchunk] >= total;
+
+    if (! ok) {
+        for (i = 0; (i + 1 < GRID_TEXT_NSECTIONS) &&
+                 (s[i].start + s[i].count <= cfirst[nchunk]); i++) {}
+
+        fprintf(stderr, "Unable to read %s: End-of-file\n", s[i].what);
+    }
+    else {
+        failed = GRID_TEXT_NSECTIONS;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic) reduction(min:failed)
+#endif
+        for (i = 0; i < nchunk; i++) {
+            int k = parse_chunk(cbeg[i], cbeg[i + 1], cfirst[i], total, s);
+
+            if (k < failed) { failed = k; }
+        }
+
+        ok = failed == GRID_TEXT_NSECTIONS;
+        if (! ok) {
+            fprintf(stderr, "Unable to read %s\n", s[failed].what);
+        }
+    }
+
+    free(cfirst);
+    free(cbeg);
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct UnstructuredGrid *
+read_grid(const char *fname)
+/* ---------------------------------------------------------------------- */
+{
+    struct UnstructuredGrid  *G;
+    struct grid_text_buffer   b;
+    struct grid_text_section  s[GRID_TEXT_NSECTIONS];
+
+    const char *p, *end;
+    size_t      dimens[GRID_NMETA], total;
+    int         save_errno, has_tag, has_indexmap, ok;
+
+    save_errno = errno;
+
+    if (! load_file(fname, &b)) {
+        errno = save_errno;
+        return NULL;
+    }
+
+    p   = b.data;
+    end = b.data + b.size;
+
+    G  = allocate_grid_from_text(&p, end, &has_tag, &has_indexmap, dimens);
+    ok = G != NULL;
+
+    if (ok) {
+        total = define_sections(G, dimens, has_tag, has_indexmap, s);
+        ok    = read_grid_body(p, end, s, total);
+    }
+
+    if (ok) {
+        /* The indirection arrays must agree with the allocated sizes. */
+        ok = (G->face_nodepos[ G->number_of_faces ] ==
+              (int) dimens[GRID_NFACENODES]) &&
+             (G->cell_facepos[ G->number_of_cells ] ==
+              (int) dimens[GRID_NCELLFACES]);
+
+        if (! ok) {
+            fprintf(stderr, "Inconsistent grid dimensions\n");
+        }
+    }
+
+    if (ok) {
+        grid_update_hash(G);
+    }
+    else {
+        destroy_grid(G);
+        G = NULL;
+    }
+
+    release_file(&b);
+
+    errno = save_errno;
+
+    return G;
+}
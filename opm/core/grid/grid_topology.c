@@ -0,0 +1,294 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/grid.h>
+#include <opm/core/grid/grid_topology.h>
+
+#include <stdlib.h>
+
+/* A varint of a 64-bit value takes at most ten bytes. */
+#define VARINT_MAXLEN 10
+
+
+/* ---------------------------------------------------------------------- */
+static uint64_t
+zigzag_encode(int64_t v)
+/* ---------------------------------------------------------------------- */
+{
+    return (v < 0) ? ((~(uint64_t) v) << 1) | 1u : ((uint64_t) v) << 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int64_t
+zigzag_decode(uint64_t u)
+/* ---------------------------------------------------------------------- */
+{
+    return (u & 1u) ? (int64_t) ~(u >> 1) : (int64_t) (u >> 1);
+}
+
+
+/* Store 'u' in little-endian base-128 form at 'p'.  Returns number of
+ * bytes written. */
+/* ---------------------------------------------------------------------- */
+static size_t
+varint_put(uint64_t u, unsigned char *p)
+/* ---------------------------------------------------------------------- */
+{
+    size_t n = 0;
+
+    while (u >= 0x80) {
+        p[n++] = (unsigned char) (u | 0x80);
+        u    >>= 7;
+    }
+    p[n++] = (unsigned char) u;
+
+    return n;
+}
+
+
+/* Read varint at position '*pos' of 'buf' into 'u', advancing '*pos'.
+ * Returns zero if the stream ends prematurely or the value does not
+ * fit in 64 bits. */
+/* ---------------------------------------------------------------------- */
+static int
+varint_get(const unsigned char *buf, size_t nbytes, size_t *pos,
+           uint64_t *u)
+/* ---------------------------------------------------------------------- */
+{
+    unsigned shift;
+
+    *u = 0;
+    for (shift = 0; (shift < 64) && (*pos < nbytes); shift += 7) {
+        *u |= ((uint64_t) (buf[*pos] & 0x7f)) << shift;
+
+        if ((buf[(*pos)++] & 0x80) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct GridTopology *
+allocate_grid_topology(int ndims, int ncells, int nfaces,
+                       int64_t nfacenodes, int64_t ncellfaces, int nnodes)
+/* ---------------------------------------------------------------------- */
+{
+    struct GridTopology *T;
+
+    T = malloc(1 * sizeof *T);
+
+    if (T != NULL) {
+        T->dimensions      = ndims;
+        T->number_of_cells = ncells;
+        T->number_of_faces = nfaces;
+        T->number_of_nodes = nnodes;
+
+        T->face_nodepos = malloc((nfaces + (size_t) 1) * sizeof *T->face_nodepos);
+        T->face_nodes   = malloc((size_t) nfacenodes   * sizeof *T->face_nodes);
+        T->face_cells   = malloc(2 * (size_t) nfaces   * sizeof *T->face_cells);
+        T->cell_facepos = malloc((ncells + (size_t) 1) * sizeof *T->cell_facepos);
+        T->cell_faces   = malloc((size_t) ncellfaces   * sizeof *T->cell_faces);
+        T->cell_facetag = malloc((size_t) ncellfaces   * sizeof *T->cell_facetag);
+
+        if ((T->face_nodepos == NULL) ||
+            ((T->face_nodes  == NULL) && (nfacenodes > 0)) ||
+            ((T->face_cells  == NULL) && (nfaces     > 0)) ||
+            (T->cell_facepos == NULL) ||
+            ((T->cell_faces   == NULL) && (ncellfaces > 0)) ||
+            ((T->cell_facetag == NULL) && (ncellfaces > 0))) {
+            destroy_grid_topology(T);
+            T = NULL;
+        }
+    }
+
+    return T;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct GridTopology *
+create_grid_topology(const struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    int                  nc, nf, c, f;
+    int64_t              i, nfn, ncf;
+    struct GridTopology *T;
+
+    nc  = G->number_of_cells;
+    nf  = G->number_of_faces;
+    nfn = G->face_nodepos[nf];
+    ncf = G->cell_facepos[nc];
+
+    T = allocate_grid_topology(G->dimensions, nc, nf, nfn, ncf,
+                               G->number_of_nodes);
+
+    if (T != NULL) {
+        for (f = 0; f <= nf;    f++) { T->face_nodepos[f] = G->face_nodepos[f]; }
+        for (i = 0; i <  nfn;   i++) { T->face_nodes  [i] = G->face_nodes  [i]; }
+        for (f = 0; f < 2 * nf; f++) { T->face_cells  [f] = G->face_cells  [f]; }
+        for (c = 0; c <= nc;    c++) { T->cell_facepos[c] = G->cell_facepos[c]; }
+        for (i = 0; i <  ncf;   i++) { T->cell_faces  [i] = G->cell_faces  [i]; }
+
+        if (G->cell_facetag != NULL) {
+            for (i = 0; i < ncf; i++) { T->cell_facetag[i] = G->cell_facetag[i]; }
+        } else {
+            free(T->cell_facetag);
+            T->cell_facetag = NULL;
+        }
+    }
+
+    return T;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+destroy_grid_topology(struct GridTopology *T)
+/* ---------------------------------------------------------------------- */
+{
+    if (T != NULL) {
+        free(T->cell_facetag);
+        free(T->cell_faces);
+        free(T->cell_facepos);
+        free(T->face_cells);
+        free(T->face_nodes);
+        free(T->face_nodepos);
+    }
+
+    free(T);
+}
+
+
+/* ---------------------------------------------------------------------- */
+unsigned char *
+grid_topology_pack_face_nodes(const struct GridTopology *T, size_t *nbytes)
+/* ---------------------------------------------------------------------- */
+{
+    int            f, nf;
+    int64_t        i, prev, first;
+    size_t         n;
+    unsigned char *buf, *shrunk;
+
+    nf = T->number_of_faces;
+
+    /* Worst case: ten bytes per value, plus face sizes and header. */
+    n   = VARINT_MAXLEN * ((size_t) T->face_nodepos[nf] + nf + 2);
+    buf = malloc(n);
+
+    if (buf != NULL) {
+        n  = varint_put((uint64_t) nf, buf);
+        n += varint_put((uint64_t) T->face_nodepos[nf], buf + n);
+
+        first = 0;
+        for (f = 0; f < nf; f++) {
+            n += varint_put((uint64_t) (T->face_nodepos[f + 1] -
+                                        T->face_nodepos[f]), buf + n);
+
+            prev = first;
+            for (i = T->face_nodepos[f]; i < T->face_nodepos[f + 1]; i++) {
+                n   += varint_put(zigzag_encode(T->face_nodes[i] - prev), buf + n);
+                prev = T->face_nodes[i];
+
+                if (i == T->face_nodepos[f]) { first = prev; }
+            }
+        }
+
+        shrunk = realloc(buf, (n > 0) ? n : 1);
+        if (shrunk != NULL) {
+            buf = shrunk;
+        }
+
+        *nbytes = n;
+    }
+
+    return buf;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+grid_topology_unpack_face_nodes(const unsigned char *buf, size_t nbytes,
+                                struct GridTopology *T)
+/* ---------------------------------------------------------------------- */
+{
+    int      f, ok;
+    size_t   pos;
+    uint64_t u, nf, nfn;
+    int64_t  i, end, prev, first;
+    int64_t *fpos;
+    int32_t *fnodes;
+
+    pos = 0;
+    ok  = varint_get(buf, nbytes, &pos, &nf ) &&
+          varint_get(buf, nbytes, &pos, &nfn) &&
+          (nf == (uint64_t) T->number_of_faces) &&
+          (nfn <= nbytes);      /* At least one byte per node. */
+
+    fpos   = NULL;
+    fnodes = NULL;
+
+    if (ok) {
+        fpos   = malloc((nf + 1) * sizeof *fpos);
+        fnodes = malloc((nfn > 0 ? nfn : 1) * sizeof *fnodes);
+        ok     = (fpos != NULL) && (fnodes != NULL);
+    }
+
+    if (ok) {
+        fpos[0] = 0;
+        first   = 0;
+        i       = 0;
+        for (f = 0; ok && (f < T->number_of_faces); f++) {
+            ok  = varint_get(buf, nbytes, &pos, &u) &&
+                  (u <= nfn - (uint64_t) i);
+            end = ok ? i + (int64_t) u : i;
+
+            prev = first;
+            for (; ok && (i < end); i++) {
+                ok = varint_get(buf, nbytes, &pos, &u);
+
+                prev      += zigzag_decode(u);
+                fnodes[i]  = (int32_t) prev;
+
+                if (i == fpos[f]) { first = prev; }
+            }
+
+            fpos[f + 1] = i;
+        }
+
+        ok = ok && (i == (int64_t) nfn) && (pos == nbytes);
+    }
+
+    if (ok) {
+        free(T->face_nodepos);
+        free(T->face_nodes);
+
+        T->face_nodepos = fpos;
+        T->face_nodes   = fnodes;
+    } else {
+        free(fnodes);
+        free(fpos);
+    }
+
+    return ok;
+}
@@ -0,0 +1,156 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_GRID_TOPOLOGY_HEADER_INCLUDED
+#define OPM_GRID_TOPOLOGY_HEADER_INCLUDED
+
+/**
+ * \file
+ *
+ * Grid topology with 64-bit offsets and 32-bit indices.
+ *
+ * The offset arrays @c face_nodepos and @c cell_facepos of an
+ * UnstructuredGrid are @c int, limiting the number of face nodes and cell
+ * faces to 2^31.  A GridTopology stores those offsets as @c int64_t while
+ * keeping 32-bit entries in the (much larger) index arrays.  For archival,
+ * the face-to-node mapping can further be packed into a delta/varint
+ * encoded byte stream.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct UnstructuredGrid;
+
+/**
+   Topology of a grid with 64-bit offsets.
+
+   The fields have the same meaning as the like-named fields of
+   UnstructuredGrid.
+*/
+struct GridTopology {
+    int      dimensions;      /**< Number of physical dimensions. */
+    int      number_of_cells; /**< Number of cells. */
+    int      number_of_faces; /**< Number of faces. */
+    int      number_of_nodes; /**< Number of nodes. */
+
+    int64_t *face_nodepos;    /**< Start of each face in face_nodes.
+                                   <code>number_of_faces + 1</code>
+                                   entries. */
+    int32_t *face_nodes;      /**< Nodes of each face. */
+    int32_t *face_cells;      /**< Two cells per face, -1 outside. */
+
+    int64_t *cell_facepos;    /**< Start of each cell in cell_faces.
+                                   <code>number_of_cells + 1</code>
+                                   entries. */
+    int32_t *cell_faces;      /**< Faces of each cell. */
+    int32_t *cell_facetag;    /**< Tag of each cell face.  May be
+                                   @c NULL. */
+};
+
+
+/**
+   Allocate a grid topology of the given sizes.
+
+   All arrays, including @c cell_facetag, are allocated but not
+   initialised.
+
+   \param[in] ndims      Number of physical dimensions.
+   \param[in] ncells     Number of cells.
+   \param[in] nfaces     Number of faces.
+   \param[in] nfacenodes Total number of face nodes.
+   \param[in] ncellfaces Total number of cell faces.
+   \param[in] nnodes     Number of nodes.
+
+   \return Allocated topology, or @c NULL on allocation failure.  Must be
+   destroyed using destroy_grid_topology().
+*/
+struct GridTopology *
+allocate_grid_topology(int ndims, int ncells, int nfaces,
+                       int64_t nfacenodes, int64_t ncellfaces, int nnodes);
+
+
+/**
+   Copy the topology of a grid.
+
+   \param[in] G Grid.
+
+   \return Topology of @c G, or @c NULL on allocation failure.  Must be
+   destroyed using destroy_grid_topology().
+*/
+struct GridTopology *
+create_grid_topology(const struct UnstructuredGrid *G);
+
+
+/**
+   Dispose of a grid topology.
+
+   \param[in,out] T Topology.  May be @c NULL.
+*/
+void
+destroy_grid_topology(struct GridTopology *T);
+
+
+/**
+   Pack the face-to-node mapping of a topology for archival.
+
+   The stream starts with the number of faces and face nodes.  The first
+   node of each face is stored as a zig-zag varint delta from the first
+   node of the previous face, the remaining nodes as deltas from their
+   predecessor in the face.  Face sizes are stored as varints.
+   Neighbouring nodes are typically numbered closely, so most entries take
+   one or two bytes instead of four.
+
+   \param[in]  T      Topology.
+   \param[out] nbytes Size, in bytes, of the packed stream.
+
+   \return Packed stream, or @c NULL on allocation failure.  Must be
+   released using @c free().
+*/
+unsigned char *
+grid_topology_pack_face_nodes(const struct GridTopology *T, size_t *nbytes);
+
+
+/**
+   Unpack a stream created by grid_topology_pack_face_nodes().
+
+   Fills @c face_nodepos and replaces @c face_nodes of a topology with as
+   many faces as the packed one.
+
+   \param[in]     buf    Packed stream.
+   \param[in]     nbytes Size, in bytes, of the packed stream.
+   \param[in,out] T      Topology.
+
+   \return One (true) if successful, zero (false) if the stream is
+   malformed, does not match the number of faces of @c T, or memory
+   allocation fails.  @c T is unchanged on failure.
+*/
+int
+grid_topology_unpack_face_nodes(const unsigned char *buf, size_t nbytes,
+                                struct GridTopology *T);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPM_GRID_TOPOLOGY_HEADER_INCLUDED */
@@ -0,0 +1,167 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/io/AsyncOutputWriter.hpp>
+
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/simulator/WellState.hpp>
+#include <opm/core/utility/TimingTree.hpp>
+
+#include <stdexcept>
+
+namespace Opm {
+
+struct AsyncOutputWriter::Snapshot {
+    std::unique_ptr <SimulatorTimerInterface> timer;
+    std::unique_ptr <SimulationDataContainer> reservoirState;
+    WellState wellState;
+    bool isSubstep;
+};
+
+AsyncOutputWriter::AsyncOutputWriter (std::unique_ptr <OutputWriter> writer,
+                                      const int maxQueued)
+    : writer_ (std::move (writer))
+    , maxQueued_ (maxQueued)
+    , writing_ (false)
+    , stop_ (false) {
+
+    if (maxQueued_ < 1) {
+        OPM_THROW(std::invalid_argument, "AsyncOutputWriter: maxQueued must be positive, got " << maxQueued);
+    }
+
+    // start the worker only when all members are set up
+    worker_ = std::thread (&AsyncOutputWriter::run, this);
+}
+
+AsyncOutputWriter::~AsyncOutputWriter () {
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all ();
+    worker_.join ();
+}
+
+void
+AsyncOutputWriter::writeInit (const SimulatorTimerInterface &timer) {
+    flush ();
+    writer_->writeInit (timer);
+}
+
+void
+AsyncOutputWriter::writeTimeStep (const SimulatorTimerInterface& timer,
+                                  const SimulationDataContainer& reservoirState,
+                                  const WellState& wellState,
+                                  bool  isSubstep) {
+    OPM_TIMED_SCOPE("output queue");
+    std::unique_ptr <Snapshot> snapshot;
+    {
+        // back-pressure: wait until there is room in the queue
+        std::unique_lock <std::mutex> lock (mutex_);
+        cond_.wait (lock, [this] {
+                return error_ || int (queue_.size ()) < maxQueued_;
+            });
+        rethrowError ();
+        if (!pool_.empty ()) {
+            snapshot = std::move (pool_.back ());
+            pool_.pop_back ();
+        }
+    }
+
+    // copy outside the lock, so that the worker may proceed. copy
+    // assignment of a recycled snapshot reuses its storage.
+    if (!snapshot) {
+        snapshot.reset (new Snapshot);
+    }
+    snapshot->timer = timer.clone ();
+    if (snapshot->reservoirState) {
+        *snapshot->reservoirState = reservoirState;
+    }
+    else {
+        snapshot->reservoirState.reset (new SimulationDataContainer (reservoirState));
+    }
+    snapshot->wellState = wellState;
+    snapshot->isSubstep = isSubstep;
+
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        queue_.push_back (std::move (snapshot));
+    }
+    cond_.notify_all ();
+}
+
+void
+AsyncOutputWriter::flush () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    cond_.wait (lock, [this] {
+            return error_ || (queue_.empty () && !writing_);
+        });
+    rethrowError ();
+}
+
+void
+AsyncOutputWriter::run () {
+    std::unique_lock <std::mutex> lock (mutex_);
+    for (;;) {
+        // pending writes are finished before stopping
+        cond_.wait (lock, [this] { return stop_ || !queue_.empty (); });
+        if (queue_.empty ()) {
+            return;
+        }
+
+        std::unique_ptr <Snapshot> snapshot = std::move (queue_.front ());
+        queue_.pop_front ();
+        writing_ = true;
+        lock.unlock ();
+
+        std::exception_ptr error;
+        try {
+            OPM_TIMED_SCOPE("output");
+            writer_->writeTimeStep (*snapshot->timer,
+                                    *snapshot->reservoirState,
+                                    snapshot->wellState,
+                                    snapshot->isSubstep);
+        }
+        catch (...) {
+            error = std::current_exception ();
+        }
+
+        lock.lock ();
+        writing_ = false;
+        if (error && !error_) {
+            error_ = error;
+        }
+        pool_.push_back (std::move (snapshot));
+        cond_.notify_all ();
+    }
+}
+
+// must be called with the mutex held
+void
+AsyncOutputWriter::rethrowError () {
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = std::exception_ptr ();
+        std::rethrow_exception (error);
+    }
+}
+
+} // namespace Opm
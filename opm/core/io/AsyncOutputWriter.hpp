@@ -0,0 +1,97 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_ASYNC_OUTPUT_WRITER_HPP
+#define OPM_ASYNC_OUTPUT_WRITER_HPP
+
+#include <opm/core/io/OutputWriter.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * Output writer which runs another writer on a background thread.
+ *
+ * writeTimeStep() copies the timer, reservoir state and well state
+ * into a snapshot and returns, and the wrapped writer is called with
+ * the snapshot on a worker thread. Snapshots are recycled, so that
+ * after the first steps no state is allocated. At most maxQueued
+ * snapshots wait to be written; beyond that writeTimeStep() blocks
+ * until the worker has caught up. Time steps are written in the order
+ * they were given.
+ *
+ * The states are copied as SimulationDataContainer and WellState, so
+ * the wrapped writer must not depend on their dynamic types. An
+ * exception thrown by the wrapped writer is rethrown by the next call
+ * to writeInit(), writeTimeStep() or flush().
+ */
+class AsyncOutputWriter : public OutputWriter {
+public:
+    /// \param[in] writer     Writer to run on the background thread.
+    /// \param[in] maxQueued  Maximum number of pending time steps.
+    explicit AsyncOutputWriter (std::unique_ptr <OutputWriter> writer,
+                                const int maxQueued = 2);
+
+    /// Waits for all pending time steps to be written.
+    virtual ~AsyncOutputWriter ();
+
+    /// Waits for pending time steps, and then writes the static data
+    /// on the calling thread.
+    virtual void writeInit(const SimulatorTimerInterface &timer);
+
+    /// Queues a copy of the time step data for writing.
+    virtual void writeTimeStep(const SimulatorTimerInterface& timer,
+                               const SimulationDataContainer& reservoirState,
+                               const WellState& wellState,
+                               bool  isSubstep);
+
+    /// Waits until all queued time steps are written.
+    void flush ();
+
+private:
+    struct Snapshot;
+
+    void run ();
+    void rethrowError ();
+
+    std::unique_ptr <OutputWriter> writer_;
+    const int maxQueued_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    // Snapshots waiting to be written, and unused snapshots.
+    std::deque <std::unique_ptr <Snapshot> > queue_;
+    std::vector <std::unique_ptr <Snapshot> > pool_;
+    bool writing_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    std::thread worker_;
+};
+
+} // namespace Opm
+
+#endif /* OPM_ASYNC_OUTPUT_WRITER_HPP */
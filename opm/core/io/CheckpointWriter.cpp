@@ -0,0 +1,381 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/io/CheckpointWriter.hpp>
+
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/simulator/WellState.hpp>
+#include <opm/core/utility/TimingTree.hpp>
+#include <opm/core/well_controls.h>
+#include <opm/core/wells.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace Opm {
+
+namespace {
+
+const char MAGIC[8] = { 'O', 'P', 'M', 'C', 'K', 'P', 'T', '\0' };
+const std::int32_t VERSION = 1;
+
+/// Appends values in native byte order.
+class Serializer {
+public:
+    explicit Serializer (std::vector <char>& buffer) : buffer_ (buffer) {
+        buffer_.clear ();
+    }
+
+    void bytes (const void* data, const std::size_t n) {
+        const char* p = static_cast <const char*> (data);
+        buffer_.insert (buffer_.end (), p, p + n);
+    }
+
+    template <typename T>
+    void value (const T& v) {
+        bytes (&v, sizeof (T));
+    }
+
+    void string (const std::string& s) {
+        value (std::uint64_t (s.size ()));
+        bytes (s.data (), s.size ());
+    }
+
+    template <typename T>
+    void vector (const std::vector <T>& v) {
+        value (std::uint64_t (v.size ()));
+        bytes (v.data (), v.size () * sizeof (T));
+    }
+
+private:
+    std::vector <char>& buffer_;
+};
+
+/// Reads values written by a Serializer.
+class Deserializer {
+public:
+    Deserializer (const std::vector <char>& buffer, const std::string& filename)
+        : buffer_ (buffer)
+        , pos_ (0)
+        , filename_ (filename) { }
+
+    void bytes (void* data, const std::size_t n) {
+        if (n > buffer_.size () - pos_) {
+            OPM_THROW(std::runtime_error, "Checkpoint " << filename_ << " is truncated");
+        }
+        std::memcpy (data, buffer_.data () + pos_, n);
+        pos_ += n;
+    }
+
+    template <typename T>
+    T value () {
+        T v;
+        bytes (&v, sizeof (T));
+        return v;
+    }
+
+    std::string string () {
+        std::string s (size (1), '\0');
+        bytes (&s[0], s.size ());
+        return s;
+    }
+
+    template <typename T>
+    std::vector <T> vector () {
+        std::vector <T> v;
+        vector (v);
+        return v;
+    }
+
+    // reads into existing storage
+    template <typename T>
+    void vector (std::vector <T>& v) {
+        v.resize (size (sizeof (T)));
+        bytes (v.data (), v.size () * sizeof (T));
+    }
+
+private:
+    // size of an array of elements of the given size, checked
+    // against the remaining data before anything is allocated
+    std::size_t size (const std::size_t elementSize) {
+        const std::uint64_t n = value <std::uint64_t> ();
+        if (n > (buffer_.size () - pos_) / elementSize) {
+            OPM_THROW(std::runtime_error, "Checkpoint " << filename_ << " is truncated");
+        }
+        return n;
+    }
+
+    const std::vector <char>& buffer_;
+    std::size_t pos_;
+    const std::string& filename_;
+};
+
+template <class Fields>
+void serializeFields (Serializer& out, const Fields& fields) {
+    out.value (std::uint64_t (fields.size ()));
+    for (const auto& field : fields) {
+        out.string (field.first);
+        out.vector (field.second);
+    }
+}
+
+void serialize (std::vector <char>& buffer,
+                const SimulatorTimerInterface& timer,
+                const SimulationDataContainer& reservoirState,
+                const WellState& wellState,
+                const Wells* wells,
+                const std::vector <double>& controllerState) {
+    Serializer out (buffer);
+    out.bytes (MAGIC, sizeof (MAGIC));
+    out.value (VERSION);
+
+    out.value (std::int32_t (timer.reportStepNum ()));
+    out.value (std::int32_t (timer.currentStepNum ()));
+    out.value (timer.simulationTimeElapsed ());
+    out.value (timer.currentStepLength ());
+
+    out.value (std::uint64_t (reservoirState.numCells ()));
+    out.value (std::uint64_t (reservoirState.numFaces ()));
+    serializeFields (out, reservoirState.cellData ());
+    serializeFields (out, reservoirState.faceData ());
+
+    out.value (std::uint64_t (wellState.wellMap ().size ()));
+    for (const auto& well : wellState.wellMap ()) {
+        out.string (well.first);
+        out.value (std::int32_t (well.second[0]));
+    }
+    out.vector (wellState.bhp ());
+    out.vector (wellState.thp ());
+    out.vector (wellState.temperature ());
+    out.vector (wellState.wellRates ());
+    out.vector (wellState.perfRates ());
+    out.vector (wellState.perfPress ());
+
+    std::vector <std::int32_t> controls;
+    if (wells) {
+        for (int w = 0; w < wells->number_of_wells; ++w) {
+            controls.push_back (well_controls_get_current (wells->ctrls[w]));
+        }
+    }
+    out.vector (controls);
+
+    out.vector (controllerState);
+}
+
+void writeFile (const std::string& filename, const std::vector <char>& buffer) {
+    OPM_TIMED_SCOPE("checkpoint");
+    const std::string tmpname = filename + ".tmp";
+    {
+        std::ofstream os (tmpname.c_str (), std::ios::binary | std::ios::trunc);
+        os.write (buffer.data (), buffer.size ());
+        os.close ();
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Failed writing checkpoint " << tmpname);
+        }
+    }
+    if (std::rename (tmpname.c_str (), filename.c_str ()) != 0) {
+        OPM_THROW(std::runtime_error, "Failed renaming checkpoint " << tmpname << " to " << filename);
+    }
+}
+
+void checkSize (const std::string& filename, const std::string& what,
+                const std::size_t expected, const std::size_t actual) {
+    if (expected != actual) {
+        OPM_THROW(std::runtime_error, "Checkpoint " << filename << " has " << actual << " "
+                  << what << ", expected " << expected);
+    }
+}
+
+} // anonymous namespace
+
+void writeCheckpoint (const std::string& filename,
+                      const SimulatorTimerInterface& timer,
+                      const SimulationDataContainer& reservoirState,
+                      const WellState& wellState,
+                      const Wells* wells,
+                      const std::vector <double>& controllerState) {
+    std::vector <char> buffer;
+    serialize (buffer, timer, reservoirState, wellState, wells, controllerState);
+    writeFile (filename, buffer);
+}
+
+CheckpointInfo readCheckpoint (const std::string& filename,
+                               SimulationDataContainer& reservoirState,
+                               WellState& wellState,
+                               Wells* wells) {
+    std::vector <char> buffer;
+    {
+        std::ifstream is (filename.c_str (), std::ios::binary);
+        if (!is) {
+            OPM_THROW(std::runtime_error, "Could not open checkpoint " << filename);
+        }
+        buffer.assign (std::istreambuf_iterator <char> (is), std::istreambuf_iterator <char> ());
+    }
+    Deserializer in (buffer, filename);
+
+    char magic[sizeof (MAGIC)];
+    in.bytes (magic, sizeof (magic));
+    if (std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0) {
+        OPM_THROW(std::runtime_error, filename << " is not a checkpoint");
+    }
+    const std::int32_t version = in.value <std::int32_t> ();
+    if (version != VERSION) {
+        OPM_THROW(std::runtime_error, "Checkpoint " << filename << " has version " << version
+                  << ", expected " << VERSION);
+    }
+
+    CheckpointInfo info;
+    info.reportStep = in.value <std::int32_t> ();
+    info.currentStep = in.value <std::int32_t> ();
+    info.simulationTimeElapsed = in.value <double> ();
+    info.stepLength = in.value <double> ();
+
+    const std::size_t numCells = in.value <std::uint64_t> ();
+    const std::size_t numFaces = in.value <std::uint64_t> ();
+    checkSize (filename, "cells", reservoirState.numCells (), numCells);
+    checkSize (filename, "faces", reservoirState.numFaces (), numFaces);
+    const std::size_t numCellFields = in.value <std::uint64_t> ();
+    for (std::size_t f = 0; f < numCellFields; ++f) {
+        const std::string name = in.string ();
+        std::vector <double> data = in.vector <double> ();
+        if (!reservoirState.hasCellData (name)) {
+            reservoirState.registerCellData (name, numCells ? data.size () / numCells : 1);
+        }
+        checkSize (filename, "values of " + name, reservoirState.getCellData (name).size (), data.size ());
+        reservoirState.getCellData (name).swap (data);
+    }
+    const std::size_t numFaceFields = in.value <std::uint64_t> ();
+    for (std::size_t f = 0; f < numFaceFields; ++f) {
+        const std::string name = in.string ();
+        std::vector <double> data = in.vector <double> ();
+        if (!reservoirState.hasFaceData (name)) {
+            reservoirState.registerFaceData (name, numFaces ? data.size () / numFaces : 1);
+        }
+        checkSize (filename, "values of " + name, reservoirState.getFaceData (name).size (), data.size ());
+        reservoirState.getFaceData (name).swap (data);
+    }
+
+    // the wells are set up by the caller, and must be the same
+    const std::size_t numWells = in.value <std::uint64_t> ();
+    checkSize (filename, "wells", wellState.wellMap ().size (), numWells);
+    for (std::size_t w = 0; w < numWells; ++w) {
+        const std::string name = in.string ();
+        const int index = in.value <std::int32_t> ();
+        const auto it = wellState.wellMap ().find (name);
+        if (it == wellState.wellMap ().end () || it->second[0] != index) {
+            OPM_THROW(std::runtime_error, "Checkpoint " << filename << " has well " << name
+                      << " which is not in the well state");
+        }
+    }
+    const std::size_t numPerfs = wellState.perfRates ().size ();
+    in.vector (wellState.bhp ());
+    in.vector (wellState.thp ());
+    in.vector (wellState.temperature ());
+    in.vector (wellState.wellRates ());
+    in.vector (wellState.perfRates ());
+    in.vector (wellState.perfPress ());
+    checkSize (filename, "well connections", numPerfs, wellState.perfRates ().size ());
+
+    const std::vector <std::int32_t> controls = in.vector <std::int32_t> ();
+    if (wells && !controls.empty ()) {
+        checkSize (filename, "well controls", wells->number_of_wells, controls.size ());
+        for (int w = 0; w < wells->number_of_wells; ++w) {
+            well_controls_set_current (wells->ctrls[w], controls[w]);
+        }
+    }
+
+    info.controllerState = in.vector <double> ();
+    return info;
+}
+
+CheckpointWriter::CheckpointWriter (const std::string& filename,
+                                    const double interval)
+    : filename_ (filename)
+    , interval_ (std::chrono::duration_cast <clock::duration> (std::chrono::duration <double> (interval)))
+    , wells_ (0)
+    , last_ (clock::now ()) { }
+
+CheckpointWriter::~CheckpointWriter () {
+    if (worker_.joinable ()) {
+        worker_.join ();
+    }
+}
+
+void
+CheckpointWriter::setWells (const Wells* wells) {
+    wells_ = wells;
+}
+
+void
+CheckpointWriter::setControllerState (std::function <std::vector <double> ()> controllerState) {
+    controllerState_ = std::move (controllerState);
+}
+
+void
+CheckpointWriter::writeInit (const SimulatorTimerInterface& /* timer */) {
+    last_ = clock::now ();
+}
+
+void
+CheckpointWriter::writeTimeStep (const SimulatorTimerInterface& timer,
+                                 const SimulationDataContainer& reservoirState,
+                                 const WellState& wellState,
+                                 bool  isSubstep) {
+    if (isSubstep || clock::now () - last_ < interval_) {
+        return;
+    }
+    // the buffer is still in use until the previous write is done
+    flush ();
+    last_ = clock::now ();
+
+    const std::vector <double> controllerState = controllerState_
+        ? controllerState_ () : std::vector <double> ();
+    serialize (buffer_, timer, reservoirState, wellState, wells_, controllerState);
+
+    worker_ = std::thread ([this] {
+            try {
+                writeFile (filename_, buffer_);
+            }
+            catch (...) {
+                error_ = std::current_exception ();
+            }
+        });
+}
+
+void
+CheckpointWriter::flush () {
+    if (worker_.joinable ()) {
+        worker_.join ();
+    }
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = std::exception_ptr ();
+        std::rethrow_exception (error);
+    }
+}
+
+} // namespace Opm
@@ -0,0 +1,154 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_CHECKPOINT_WRITER_HPP
+#define OPM_CHECKPOINT_WRITER_HPP
+
+#include <opm/core/io/OutputWriter.hpp>
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Wells;
+
+namespace Opm {
+
+/// Position in the simulation and controller state stored in a
+/// checkpoint, as returned by readCheckpoint().
+struct CheckpointInfo {
+    int reportStep;                      //!< report step of the timer
+    int currentStep;                     //!< step number of the timer
+    double simulationTimeElapsed;        //!< simulation time at the checkpoint
+    double stepLength;                   //!< step length the timer suggested next
+    std::vector <double> controllerState; //!< see AdaptiveTimeStepping::checkpointState()
+};
+
+/*!
+ * Write a checkpoint of the simulation to a compact binary file.
+ *
+ * All cell and face fields of the reservoir state, the well state,
+ * the current controls of the wells and the state of the time step
+ * controller are written in native byte order, so checkpoints are
+ * only meant to be read on the same kind of machine. The file is
+ * first written under a temporary name and then renamed, so an
+ * interrupted write leaves the previous checkpoint intact.
+ *
+ * \param[in] filename         Checkpoint file to write.
+ * \param[in] timer            Timer at the checkpoint.
+ * \param[in] reservoirState   Reservoir state.
+ * \param[in] wellState        Well state.
+ * \param[in] wells            Wells whose current controls are stored, may be null.
+ * \param[in] controllerState  State of the time step controller, may be empty.
+ */
+void writeCheckpoint (const std::string& filename,
+                      const SimulatorTimerInterface& timer,
+                      const SimulationDataContainer& reservoirState,
+                      const WellState& wellState,
+                      const Wells* wells,
+                      const std::vector <double>& controllerState);
+
+/*!
+ * Read a checkpoint written by writeCheckpoint() or CheckpointWriter.
+ *
+ * The reservoir state must have the numbers of cells and faces of the
+ * checkpoint; fields it does not have are registered. The well state
+ * must be initialized for the same wells as when the checkpoint was
+ * written, and, if given, the current controls of the wells are
+ * restored. The caller positions its timer at the returned step.
+ *
+ * \param[in]     filename        Checkpoint file to read.
+ * \param[in,out] reservoirState  Reservoir state to overwrite.
+ * \param[in,out] wellState       Well state to overwrite.
+ * \param[in,out] wells           Wells whose controls are restored, may be null.
+ *
+ * \return Position in the simulation and controller state.
+ */
+CheckpointInfo readCheckpoint (const std::string& filename,
+                               SimulationDataContainer& reservoirState,
+                               WellState& wellState,
+                               Wells* wells);
+
+/*!
+ * Output writer which writes checkpoints at wall-clock intervals.
+ *
+ * writeTimeStep() writes a checkpoint at the end of a report step
+ * if at least the given interval of wall-clock time has passed since
+ * the previous one. The state is serialized into memory on the
+ * calling thread, and the file is written on a background thread, so
+ * the simulation only waits if the previous checkpoint is still being
+ * written. Substeps are not checkpointed, since the adaptive substep
+ * timer is rebuilt at the start of each report step.
+ *
+ * An exception thrown when writing is rethrown by the next call to
+ * writeTimeStep() or flush().
+ */
+class CheckpointWriter : public OutputWriter {
+public:
+    /// \param[in] filename  Checkpoint file, overwritten by each checkpoint.
+    /// \param[in] interval  Minimum wall-clock seconds between checkpoints.
+    CheckpointWriter (const std::string& filename,
+                      const double interval);
+
+    /// Waits for a pending checkpoint to be written.
+    virtual ~CheckpointWriter ();
+
+    /// Stores the current controls of these wells in the checkpoints.
+    /// The wells must outlive the writer or be replaced.
+    void setWells (const Wells* wells);
+
+    /// Stores the state returned by this function as the controller
+    /// state of the checkpoints, e.g. a lambda returning
+    /// AdaptiveTimeStepping::checkpointState().
+    void setControllerState (std::function <std::vector <double> ()> controllerState);
+
+    /// Starts the interval, nothing is written.
+    virtual void writeInit(const SimulatorTimerInterface &timer);
+
+    /// Writes a checkpoint if the interval has passed.
+    virtual void writeTimeStep(const SimulatorTimerInterface& timer,
+                               const SimulationDataContainer& reservoirState,
+                               const WellState& wellState,
+                               bool  isSubstep);
+
+    /// Waits until a pending checkpoint is written.
+    void flush ();
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    const std::string filename_;
+    const clock::duration interval_;
+    const Wells* wells_;
+    std::function <std::vector <double> ()> controllerState_;
+    clock::time_point last_;
+
+    // serialized checkpoint, reused between writes
+    std::vector <char> buffer_;
+    std::exception_ptr error_;
+    std::thread worker_;
+};
+
+} // namespace Opm
+
+#endif /* OPM_CHECKPOINT_WRITER_HPP */
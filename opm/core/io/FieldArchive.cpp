@@ -0,0 +1,768 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/io/FieldArchive.hpp>
+
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace Opm {
+
+namespace {
+
+// Layout of an archive, all values in native byte order:
+//
+//   header  "OPMFARC\0", uint32 version, uint32 byte order mark,
+//           int64 cells, int64 cells per chunk, int64 number of
+//           global cell indices (0 or cells), int32 global indices
+//   step    "STEP", uint64 bytes after this value, directory, chunks
+//   index   "INDX", uint64 steps, uint64 offset of each step,
+//           uint64 offset of "INDX", "FEND"
+//
+// The directory of a step is int32 report step, double time, uint32
+// fields, and for each field uint32 name length, name, uint32
+// components, double error bound, uint32 chunks, and for each chunk
+// uint8 codec and uint64 stored bytes, or the index of the step which
+// stores an unchanged chunk. The chunks follow in the same order.
+const char MAGIC[8] = { 'O', 'P', 'M', 'F', 'A', 'R', 'C', '\0' };
+const std::uint32_t VERSION = 1;
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const char STEP_TAG[4] = { 'S', 'T', 'E', 'P' };
+const char INDEX_TAG[4] = { 'I', 'N', 'D', 'X' };
+const char END_TAG[4] = { 'F', 'E', 'N', 'D' };
+
+/// How a chunk is stored.
+enum Codec : std::uint8_t {
+    RAW = 0,        ///< values as they are
+    SHUFFLED = 1,   ///< deflated bytes of the values, transposed
+    QUANTIZED = 2,  ///< deflated bytes of the zig-zag encoded
+                    ///< differences of the rounded values, transposed
+    REFERENCE = 3   ///< unchanged, stored at an earlier step, whose
+                    ///< index takes the place of the stored bytes
+};
+
+template <typename T>
+void append (std::vector <char>& buffer, const T& v) {
+    const char* p = reinterpret_cast <const char*> (&v);
+    buffer.insert (buffer.end (), p, p + sizeof (T));
+}
+
+void appendBytes (std::vector <char>& buffer, const void* data, const std::size_t n) {
+    const char* p = static_cast <const char*> (data);
+    buffer.insert (buffer.end (), p, p + n);
+}
+
+#if HAVE_ZLIB
+/// Store byte b of element i at b*n + i.
+std::vector <char> shuffle (const void* data, const std::size_t n, const std::size_t width) {
+    const char* p = static_cast <const char*> (data);
+    std::vector <char> out (n * width);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t b = 0; b < width; ++b) {
+            out[b*n + i] = p[i*width + b];
+        }
+    }
+    return out;
+}
+
+void unshuffle (const std::vector <char>& in, const std::size_t n, const std::size_t width, void* data) {
+    char* p = static_cast <char*> (data);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t b = 0; b < width; ++b) {
+            p[i*width + b] = in[b*n + i];
+        }
+    }
+}
+
+std::vector <char> deflate (const std::vector <char>& in) {
+    uLongf len = compressBound (in.size ());
+    std::vector <char> out (len);
+    const int ret = compress2 (reinterpret_cast <Bytef*> (out.data ()), &len,
+                               reinterpret_cast <const Bytef*> (in.data ()), in.size (),
+                               Z_DEFAULT_COMPRESSION);
+    if (ret != Z_OK) {
+        OPM_THROW(std::runtime_error, "zlib compression failed with code " << ret);
+    }
+    out.resize (len);
+    return out;
+}
+
+std::vector <char> inflate (const std::vector <char>& in, const std::size_t size) {
+    std::vector <char> out (size);
+    uLongf len = size;
+    const int ret = uncompress (reinterpret_cast <Bytef*> (out.data ()), &len,
+                                reinterpret_cast <const Bytef*> (in.data ()), in.size ());
+    if (ret != Z_OK || len != size) {
+        OPM_THROW(std::runtime_error, "Corrupt chunk in field archive, zlib code " << ret);
+    }
+    return out;
+}
+#endif
+
+struct EncodedChunk {
+    std::uint8_t codec;
+    std::vector <char> data;
+};
+
+/// Compress n values, rounded to multiples of twice the error bound if
+/// it is positive. The smallest of the encodings is chosen.
+EncodedChunk encodeChunk (const double* values, const std::size_t n, const double tolerance) {
+    EncodedChunk chunk;
+    const std::size_t rawSize = n * sizeof (double);
+#if HAVE_ZLIB
+    if (tolerance > 0.0) {
+        const double unit = 2.0 * tolerance;
+        std::vector <std::uint64_t> zigzag (n);
+        std::int64_t previous = 0;
+        bool representable = true;
+        for (std::size_t i = 0; i < n; ++i) {
+            const double x = values[i] / unit;
+            // also rejects NaN
+            if (! (std::abs (x) < 4503599627370496.0)) {
+                representable = false;
+                break;
+            }
+            const std::int64_t q = std::llround (x);
+            const std::int64_t d = q - previous;
+            previous = q;
+            zigzag[i] = (std::uint64_t (d) << 1) ^ std::uint64_t (d >> 63);
+        }
+        if (representable) {
+            chunk.data = deflate (shuffle (zigzag.data (), n, sizeof (std::uint64_t)));
+            if (chunk.data.size () < rawSize) {
+                chunk.codec = QUANTIZED;
+                return chunk;
+            }
+        }
+    }
+    chunk.data = deflate (shuffle (values, n, sizeof (double)));
+    if (chunk.data.size () < rawSize) {
+        chunk.codec = SHUFFLED;
+        return chunk;
+    }
+#else
+    static_cast <void> (tolerance);
+#endif
+    chunk.codec = RAW;
+    chunk.data.assign (reinterpret_cast <const char*> (values),
+                       reinterpret_cast <const char*> (values) + rawSize);
+    return chunk;
+}
+
+void decodeChunk (const std::uint8_t codec, const std::vector <char>& data,
+                  const std::size_t n, const double tolerance, double* values) {
+    const std::size_t rawSize = n * sizeof (double);
+    switch (codec) {
+    case RAW:
+        if (data.size () != rawSize) {
+            OPM_THROW(std::runtime_error, "Corrupt chunk in field archive");
+        }
+        std::memcpy (values, data.data (), rawSize);
+        return;
+#if HAVE_ZLIB
+    case SHUFFLED:
+        unshuffle (inflate (data, rawSize), n, sizeof (double), values);
+        return;
+    case QUANTIZED: {
+        std::vector <std::uint64_t> zigzag (n);
+        unshuffle (inflate (data, rawSize), n, sizeof (std::uint64_t), zigzag.data ());
+        const double unit = 2.0 * tolerance;
+        std::int64_t q = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            q += std::int64_t (zigzag[i] >> 1) ^ -std::int64_t (zigzag[i] & 1);
+            values[i] = double (q) * unit;
+        }
+        return;
+    }
+#else
+    case SHUFFLED:
+    case QUANTIZED:
+        static_cast <void> (tolerance);
+        OPM_THROW(std::runtime_error, "Reading compressed field archives requires opm-core built with zlib");
+#endif
+    default:
+        OPM_THROW(std::runtime_error, "Unknown codec " << int (codec) << " in field archive");
+    }
+}
+
+/// Parse a list of NAME=bound separated by commas.
+FieldArchiveWriter::Tolerances parseTolerances (const std::string& spec) {
+    FieldArchiveWriter::Tolerances tolerances;
+    std::istringstream list (spec);
+    std::string item;
+    while (std::getline (list, item, ',')) {
+        item.erase (std::remove_if (item.begin (), item.end (),
+                                    [] (const unsigned char c) { return std::isspace (c); }),
+                    item.end ());
+        if (item.empty ()) {
+            continue;
+        }
+        const std::string::size_type eq = item.find ('=');
+        double bound = -1.0;
+        if (eq != std::string::npos && eq > 0) {
+            std::istringstream value (item.substr (eq + 1));
+            value >> bound;
+            if (!value || !value.eof ()) {
+                bound = -1.0;
+            }
+        }
+        if (! (bound >= 0.0)) {
+            OPM_THROW(std::runtime_error, "Invalid error bound '" << item
+                      << "' in output_archive_tolerance, expected NAME=bound");
+        }
+        tolerances[item.substr (0, eq)] = bound;
+    }
+    return tolerances;
+}
+
+template <typename T>
+T readValue (std::istream& is, const std::string& filename) {
+    T v;
+    if (!is.read (reinterpret_cast <char*> (&v), sizeof (T))) {
+        OPM_THROW(std::runtime_error, "Unexpected end of field archive " << filename);
+    }
+    return v;
+}
+
+void readBytes (std::istream& is, void* data, const std::size_t n, const std::string& filename) {
+    if (!is.read (static_cast <char*> (data), n)) {
+        OPM_THROW(std::runtime_error, "Unexpected end of field archive " << filename);
+    }
+}
+
+} // anonymous namespace
+
+
+
+FieldArchiveWriter::FieldArchiveWriter (const std::string& filename,
+                                        const int numCells,
+                                        const int* globalCell,
+                                        const Tolerances& tolerances,
+                                        const int chunkCells,
+                                        const bool incremental)
+    : filename_ (filename)
+    , numCells_ (numCells)
+    , tolerances_ (tolerances)
+    , chunkCells_ (chunkCells)
+    , incremental_ (incremental)
+    , closed_ (false)
+{
+    if (chunkCells_ <= 0) {
+        OPM_THROW(std::invalid_argument, "Chunks of a field archive must have at least one cell");
+    }
+    if (globalCell) {
+        globalCell_.assign (globalCell, globalCell + numCells);
+    }
+}
+
+
+
+FieldArchiveWriter::FieldArchiveWriter (const parameter::ParameterGroup& params,
+                                        std::shared_ptr <const EclipseState> /* eclipseState */,
+                                        const PhaseUsage& /* phaseUsage */,
+                                        const int numCells,
+                                        const int* globalCell)
+    : FieldArchiveWriter (params.getDefault <std::string> ("output_archive_file",
+                                                           params.getDefault <std::string> ("output_dir", ".")
+                                                           + "/fields.opmfa"),
+                          numCells,
+                          globalCell,
+                          parseTolerances (params.getDefault <std::string> ("output_archive_tolerance", "")),
+                          params.getDefault <int> ("output_archive_chunk", 65536),
+                          params.getDefault <bool> ("output_archive_incremental", false))
+{
+}
+
+
+
+FieldArchiveWriter::~FieldArchiveWriter () {
+    try {
+        close ();
+    }
+    catch (...) {
+        // cannot throw from the destructor; the reader scans an
+        // archive without index
+    }
+}
+
+
+
+void FieldArchiveWriter::open () {
+    file_.open (filename_.c_str (), std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        OPM_THROW(std::runtime_error, "Cannot create field archive " << filename_);
+    }
+    std::vector <char> header;
+    appendBytes (header, MAGIC, sizeof (MAGIC));
+    append (header, VERSION);
+    append (header, BYTE_ORDER_MARK);
+    append (header, std::int64_t (numCells_));
+    append (header, std::int64_t (chunkCells_));
+    append (header, std::int64_t (globalCell_.size ()));
+    for (const int g : globalCell_) {
+        append (header, std::int32_t (g));
+    }
+    file_.write (header.data (), header.size ());
+    if (!file_) {
+        OPM_THROW(std::runtime_error, "Cannot write field archive " << filename_);
+    }
+    stepOffsets_.clear ();
+    previous_.clear ();
+    source_.clear ();
+    closed_ = false;
+}
+
+
+
+void FieldArchiveWriter::writeInit(const SimulatorTimerInterface& /* timer */) {
+    if (file_.is_open ()) {
+        file_.close ();
+    }
+    open ();
+}
+
+
+
+void FieldArchiveWriter::writeTimeStep(const SimulatorTimerInterface& timer,
+                                       const SimulationDataContainer& reservoirState,
+                                       const WellState& /* wellState */,
+                                       bool  isSubstep) {
+    if (isSubstep) {
+        return;
+    }
+    if (closed_) {
+        OPM_THROW(std::logic_error, "Field archive " << filename_ << " is closed");
+    }
+    if (!file_.is_open ()) {
+        open ();
+    }
+    if (int (reservoirState.numCells ()) != numCells_) {
+        OPM_THROW(std::runtime_error, "Field archive " << filename_ << " is for " << numCells_
+                  << " cells, but the state has " << reservoirState.numCells ());
+    }
+
+    // one task per chunk of every field
+    struct Task {
+        const double* values;
+        std::size_t n;
+        double tolerance;
+        int reference;
+    };
+    const std::uint32_t stepIndex = stepOffsets_.size ();
+    const int numChunks = (numCells_ + chunkCells_ - 1) / chunkCells_;
+    std::vector <char> directory;
+    append (directory, std::int32_t (timer.reportStepNum ()));
+    append (directory, double (timer.simulationTimeElapsed ()));
+    append (directory, std::uint32_t (reservoirState.cellData ().size ()));
+    std::vector <Task> tasks;
+    std::vector <int> components;
+    std::vector <double> tolerances;
+    for (const auto& field : reservoirState.cellData ()) {
+        const int comp = numCells_ > 0 ? int (field.second.size ()) / numCells_ : 0;
+        if (std::size_t (comp) * numCells_ != field.second.size ()) {
+            OPM_THROW(std::runtime_error, "Size of cell field " << field.first
+                      << " is not a multiple of the number of cells");
+        }
+        const auto tol = tolerances_.find (field.first);
+        const double tolerance = tol == tolerances_.end () ? 0.0 : tol->second;
+        const auto prev = previous_.find (field.first);
+        const bool comparable = prev != previous_.end () && prev->second.size () == field.second.size ();
+        for (int c = 0; c < numChunks; ++c) {
+            const std::size_t begin = std::size_t (c) * chunkCells_ * comp;
+            const std::size_t n = std::size_t (std::min (chunkCells_, numCells_ - c * chunkCells_)) * comp;
+            const bool unchanged = comparable
+                && std::memcmp (field.second.data () + begin, prev->second.data () + begin,
+                                n * sizeof (double)) == 0;
+            tasks.push_back (Task { field.second.data () + begin, n, tolerance,
+                                    unchanged ? int (source_[field.first][c]) : -1 });
+        }
+        components.push_back (comp);
+        tolerances.push_back (tolerance);
+    }
+
+    const int numTasks = tasks.size ();
+    std::vector <EncodedChunk> encoded (numTasks);
+    std::string error;
+#pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < numTasks; ++t) {
+        try {
+            if (tasks[t].reference < 0) {
+                encoded[t] = encodeChunk (tasks[t].values, tasks[t].n, tasks[t].tolerance);
+            }
+        }
+        catch (const std::exception& e) {
+#pragma omp critical
+            error = e.what ();
+        }
+    }
+    if (!error.empty ()) {
+        OPM_THROW(std::runtime_error, error);
+    }
+
+    std::uint64_t dataSize = 0;
+    int t = 0;
+    int f = 0;
+    for (const auto& field : reservoirState.cellData ()) {
+        append (directory, std::uint32_t (field.first.size ()));
+        appendBytes (directory, field.first.data (), field.first.size ());
+        append (directory, std::uint32_t (components[f]));
+        append (directory, tolerances[f]);
+        ++f;
+        append (directory, std::uint32_t (numChunks));
+        std::vector <std::uint32_t> source (numChunks);
+        for (int c = 0; c < numChunks; ++c, ++t) {
+            if (tasks[t].reference >= 0) {
+                append (directory, std::uint8_t (REFERENCE));
+                append (directory, std::uint64_t (tasks[t].reference));
+                source[c] = tasks[t].reference;
+            }
+            else {
+                append (directory, encoded[t].codec);
+                append (directory, std::uint64_t (encoded[t].data.size ()));
+                dataSize += encoded[t].data.size ();
+                source[c] = stepIndex;
+            }
+        }
+        if (incremental_) {
+            source_[field.first].swap (source);
+        }
+    }
+
+    // keep the values to compare the next step with
+    if (incremental_) {
+        previous_ = reservoirState.cellData ();
+        for (auto it = source_.begin (); it != source_.end (); ) {
+            it = previous_.count (it->first) ? std::next (it) : source_.erase (it);
+        }
+    }
+
+    stepOffsets_.push_back (std::uint64_t (file_.tellp ()));
+    std::vector <char> header;
+    appendBytes (header, STEP_TAG, sizeof (STEP_TAG));
+    append (header, std::uint64_t (directory.size () + dataSize));
+    file_.write (header.data (), header.size ());
+    file_.write (directory.data (), directory.size ());
+    for (const auto& chunk : encoded) {
+        file_.write (chunk.data.data (), chunk.data.size ());
+    }
+    file_.flush ();
+    if (!file_) {
+        OPM_THROW(std::runtime_error, "Cannot write field archive " << filename_);
+    }
+}
+
+
+
+void FieldArchiveWriter::close () {
+    if (closed_) {
+        return;
+    }
+    if (!file_.is_open ()) {
+        open ();
+    }
+    closed_ = true;
+    std::vector <char> index;
+    const std::uint64_t indexOffset = file_.tellp ();
+    appendBytes (index, INDEX_TAG, sizeof (INDEX_TAG));
+    append (index, std::uint64_t (stepOffsets_.size ()));
+    for (const auto offset : stepOffsets_) {
+        append (index, offset);
+    }
+    append (index, indexOffset);
+    appendBytes (index, END_TAG, sizeof (END_TAG));
+    file_.write (index.data (), index.size ());
+    file_.close ();
+    if (!file_) {
+        OPM_THROW(std::runtime_error, "Cannot write field archive " << filename_);
+    }
+}
+
+
+
+FieldArchiveReader::FieldArchiveReader (const std::string& filename)
+    : filename_ (filename)
+    , file_ (filename.c_str (), std::ios::binary)
+{
+    if (!file_) {
+        OPM_THROW(std::runtime_error, "Cannot open field archive " << filename_);
+    }
+    char magic[sizeof (MAGIC)];
+    readBytes (file_, magic, sizeof (magic), filename_);
+    if (std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0) {
+        OPM_THROW(std::runtime_error, filename_ << " is not a field archive");
+    }
+    const auto version = readValue <std::uint32_t> (file_, filename_);
+    if (version != VERSION) {
+        OPM_THROW(std::runtime_error, "Unsupported version " << version
+                  << " of field archive " << filename_);
+    }
+    if (readValue <std::uint32_t> (file_, filename_) != BYTE_ORDER_MARK) {
+        OPM_THROW(std::runtime_error, "Field archive " << filename_
+                  << " was written with a different byte order");
+    }
+    numCells_ = static_cast <int> (readValue <std::int64_t> (file_, filename_));
+    chunkCells_ = static_cast <int> (readValue <std::int64_t> (file_, filename_));
+    const auto numGlobal = readValue <std::int64_t> (file_, filename_);
+    if (numCells_ < 0 || chunkCells_ <= 0 || (numGlobal != 0 && numGlobal != numCells_)) {
+        OPM_THROW(std::runtime_error, "Corrupt header of field archive " << filename_);
+    }
+    globalCell_.resize (numGlobal);
+    readBytes (file_, globalCell_.data (), globalCell_.size () * sizeof (int), filename_);
+    const std::uint64_t headerEnd = file_.tellg ();
+
+    file_.seekg (0, std::ios::end);
+    const std::uint64_t fileSize = file_.tellg ();
+
+    // use the index if the archive was closed, otherwise scan the steps
+    // which were completely written
+    const std::uint64_t tailSize = sizeof (std::uint64_t) + sizeof (END_TAG);
+    if (fileSize >= headerEnd + tailSize) {
+        file_.seekg (fileSize - tailSize);
+        const auto indexOffset = readValue <std::uint64_t> (file_, filename_);
+        char tag[sizeof (END_TAG)];
+        readBytes (file_, tag, sizeof (tag), filename_);
+        if (std::memcmp (tag, END_TAG, sizeof (END_TAG)) == 0
+            && indexOffset >= headerEnd && indexOffset < fileSize - tailSize) {
+            file_.seekg (indexOffset);
+            readBytes (file_, tag, sizeof (tag), filename_);
+            if (std::memcmp (tag, INDEX_TAG, sizeof (INDEX_TAG)) != 0) {
+                OPM_THROW(std::runtime_error, "Corrupt index of field archive " << filename_);
+            }
+            std::vector <std::uint64_t> offsets (readValue <std::uint64_t> (file_, filename_));
+            readBytes (file_, offsets.data (), offsets.size () * sizeof (std::uint64_t), filename_);
+            for (const auto offset : offsets) {
+                readStep (offset, indexOffset);
+            }
+            return;
+        }
+    }
+    std::uint64_t offset = headerEnd;
+    const std::uint64_t stepHeaderSize = sizeof (STEP_TAG) + sizeof (std::uint64_t);
+    while (offset + stepHeaderSize <= fileSize) {
+        file_.seekg (offset);
+        char tag[sizeof (STEP_TAG)];
+        readBytes (file_, tag, sizeof (tag), filename_);
+        const auto size = readValue <std::uint64_t> (file_, filename_);
+        if (std::memcmp (tag, STEP_TAG, sizeof (STEP_TAG)) != 0
+            || size > fileSize - offset - stepHeaderSize) {
+            break;
+        }
+        readStep (offset, fileSize);
+        offset += stepHeaderSize + size;
+    }
+}
+
+
+
+void FieldArchiveReader::readStep (const std::uint64_t offset, const std::uint64_t end) {
+    file_.seekg (offset);
+    char tag[sizeof (STEP_TAG)];
+    readBytes (file_, tag, sizeof (tag), filename_);
+    const auto size = readValue <std::uint64_t> (file_, filename_);
+    const std::uint64_t stepEnd = offset + sizeof (STEP_TAG) + sizeof (std::uint64_t) + size;
+    if (std::memcmp (tag, STEP_TAG, sizeof (STEP_TAG)) != 0 || stepEnd > end) {
+        OPM_THROW(std::runtime_error, "Corrupt step in field archive " << filename_);
+    }
+
+    Step step;
+    step.reportStep = readValue <std::int32_t> (file_, filename_);
+    step.time = readValue <double> (file_, filename_);
+    const auto numFields = readValue <std::uint32_t> (file_, filename_);
+    const int numChunks = (numCells_ + chunkCells_ - 1) / chunkCells_;
+    std::vector <Field*> order;
+    for (std::uint32_t f = 0; f < numFields; ++f) {
+        std::string name (readValue <std::uint32_t> (file_, filename_), '\0');
+        readBytes (file_, &name[0], name.size (), filename_);
+        Field& field = step.fields[name];
+        field.components = readValue <std::uint32_t> (file_, filename_);
+        field.tolerance = readValue <double> (file_, filename_);
+        const auto chunks = readValue <std::uint32_t> (file_, filename_);
+        if (int (chunks) != numChunks) {
+            OPM_THROW(std::runtime_error, "Corrupt step in field archive " << filename_);
+        }
+        field.chunks.resize (chunks);
+        for (auto& chunk : field.chunks) {
+            chunk.codec = readValue <std::uint8_t> (file_, filename_);
+            chunk.size = readValue <std::uint64_t> (file_, filename_);
+        }
+        order.push_back (&field);
+    }
+
+    // the chunks follow the directory, in the order of the fields
+    std::uint64_t dataOffset = file_.tellg ();
+    for (Field* field : order) {
+        for (auto& chunk : field->chunks) {
+            if (chunk.codec != REFERENCE) {
+                chunk.offset = dataOffset;
+                dataOffset += chunk.size;
+            }
+        }
+    }
+    if (dataOffset != stepEnd) {
+        OPM_THROW(std::runtime_error, "Corrupt step in field archive " << filename_);
+    }
+
+    // resolve unchanged chunks to where they are stored
+    for (auto& named : step.fields) {
+        Field& field = named.second;
+        for (std::size_t c = 0; c < field.chunks.size (); ++c) {
+            Chunk& chunk = field.chunks[c];
+            if (chunk.codec != REFERENCE) {
+                continue;
+            }
+            const Field* stored = 0;
+            if (chunk.size < steps_.size ()) {
+                const auto it = steps_[chunk.size].fields.find (named.first);
+                if (it != steps_[chunk.size].fields.end ()
+                    && it->second.components == field.components
+                    && it->second.tolerance == field.tolerance) {
+                    stored = &it->second;
+                }
+            }
+            if (!stored || stored->chunks[c].codec == REFERENCE) {
+                OPM_THROW(std::runtime_error, "Invalid reference to an earlier step in field archive "
+                          << filename_);
+            }
+            chunk = stored->chunks[c];
+        }
+    }
+    steps_.push_back (std::move (step));
+}
+
+
+
+int FieldArchiveReader::reportStep (const int step) const {
+    return steps_.at (step).reportStep;
+}
+
+
+
+double FieldArchiveReader::simulationTime (const int step) const {
+    return steps_.at (step).time;
+}
+
+
+
+int FieldArchiveReader::findReportStep (const int reportStep) const {
+    for (int s = 0; s < numSteps (); ++s) {
+        if (steps_[s].reportStep == reportStep) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+
+
+std::vector <std::string> FieldArchiveReader::fieldNames (const int step) const {
+    std::vector <std::string> names;
+    for (const auto& field : steps_.at (step).fields) {
+        names.push_back (field.first);
+    }
+    return names;
+}
+
+
+
+bool FieldArchiveReader::hasField (const int step, const std::string& name) const {
+    return steps_.at (step).fields.count (name) > 0;
+}
+
+
+
+const FieldArchiveReader::Field&
+FieldArchiveReader::field (const int step, const std::string& name) const {
+    const auto& fields = steps_.at (step).fields;
+    const auto it = fields.find (name);
+    if (it == fields.end ()) {
+        OPM_THROW(std::runtime_error, "No field " << name << " at step " << step
+                  << " of field archive " << filename_);
+    }
+    return it->second;
+}
+
+
+
+int FieldArchiveReader::components (const int step, const std::string& name) const {
+    return field (step, name).components;
+}
+
+
+
+double FieldArchiveReader::tolerance (const int step, const std::string& name) const {
+    return field (step, name).tolerance;
+}
+
+
+
+std::vector <double> FieldArchiveReader::read (const int step, const std::string& name) const {
+    return read (step, name, 0, numCells_);
+}
+
+
+
+std::vector <double> FieldArchiveReader::read (const int step, const std::string& name,
+                                               const int begin, const int end) const {
+    if (begin < 0 || end < begin || end > numCells_) {
+        OPM_THROW(std::invalid_argument, "Invalid cell range [" << begin << ", " << end
+                  << ") of field archive with " << numCells_ << " cells");
+    }
+    const Field& f = field (step, name);
+    const std::size_t comp = f.components;
+    std::vector <double> values ((end - begin) * comp);
+    if (begin == end) {
+        return values;
+    }
+    std::vector <char> data;
+    std::vector <double> chunkValues;
+    for (int c = begin / chunkCells_; c <= (end - 1) / chunkCells_; ++c) {
+        const Chunk& chunk = f.chunks[c];
+        const int chunkBegin = c * chunkCells_;
+        const int chunkEnd = std::min (chunkBegin + chunkCells_, numCells_);
+        data.resize (chunk.size);
+        file_.clear ();
+        file_.seekg (chunk.offset);
+        readBytes (file_, data.data (), data.size (), filename_);
+        chunkValues.resize ((chunkEnd - chunkBegin) * comp);
+        decodeChunk (chunk.codec, data, chunkValues.size (), f.tolerance, chunkValues.data ());
+        const int first = std::max (begin, chunkBegin);
+        const int last = std::min (end, chunkEnd);
+        std::copy (chunkValues.begin () + (first - chunkBegin) * comp,
+                   chunkValues.begin () + (last - chunkBegin) * comp,
+                   values.begin () + (first - begin) * comp);
+    }
+    return values;
+}
+
+} // namespace Opm
@@ -0,0 +1,220 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_FIELD_ARCHIVE_HPP
+#define OPM_FIELD_ARCHIVE_HPP
+
+#include <opm/core/io/OutputWriter.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * Output writer which appends the cell fields of every report step to
+ * a compact, compressed archive, for long runs where writing full
+ * restart files at every step would be too large.
+ *
+ * Each field is split into chunks of a fixed number of cells, with all
+ * components of a cell in the same chunk, and every chunk is
+ * compressed separately, so a FieldArchiveReader can extract a single
+ * field, or a range of cells of it, from any step without reading the
+ * rest of the file. Chunks are compressed in parallel with OpenMP.
+ *
+ * Fields are stored losslessly by default: the bytes of the values are
+ * transposed, so that the sign, exponent and leading mantissa bytes
+ * of neighbouring cells are stored together, and then deflated. A
+ * field may instead be given an absolute error bound, in which case
+ * its values are rounded to a multiple of twice the bound, and the
+ * differences of neighbouring rounded values are compressed; values
+ * read back then differ from those written by at most the bound.
+ * Chunks with values which cannot be rounded, such as infinities,
+ * are stored losslessly. Without zlib the chunks are stored raw.
+ *
+ * In incremental mode the writer keeps a copy of the fields of the
+ * previous step, and a chunk whose values are bitwise unchanged is
+ * not written again; the step refers to the step where it is stored
+ * instead. Fields which rarely change, such as the temperature of an
+ * isothermal run, then only take space in the first step. Reading is
+ * unaffected, since references are resolved when the archive is
+ * opened.
+ *
+ * Only report steps are written. Every step is written and flushed as
+ * it is given, and an index of the steps is appended when the writer
+ * is destroyed; the reader rebuilds the index by scanning the file if
+ * it is missing, e.g. after a crash. Values are written in native byte
+ * order. Face fields and well states are not archived.
+ */
+class FieldArchiveWriter : public OutputWriter {
+public:
+    /// Absolute error bound of each field stored lossy, by name.
+    typedef std::map <std::string, double> Tolerances;
+
+    /// \param[in] filename    Archive file, overwritten by writeInit().
+    /// \param[in] numCells    Number of cells of the fields.
+    /// \param[in] globalCell  Global (cartesian) index of each cell,
+    ///                        stored in the archive, may be null.
+    /// \param[in] tolerances  Error bounds of the fields stored lossy.
+    /// \param[in] chunkCells  Number of cells per chunk.
+    /// \param[in] incremental Whether chunks which are unchanged since
+    ///                        the previous step are stored as
+    ///                        references to where they were written.
+    FieldArchiveWriter (const std::string& filename,
+                        const int numCells,
+                        const int* globalCell,
+                        const Tolerances& tolerances = Tolerances (),
+                        const int chunkCells = 65536,
+                        const bool incremental = false);
+
+    /// Constructor for OutputWriter::create(), enabled by the
+    /// parameter output_archive. The parameters are
+    ///
+    ///  - output_archive_file       Archive file, by default
+    ///                              fields.opmfa in output_dir.
+    ///  - output_archive_tolerance  Error bounds as a comma separated
+    ///                              list of NAME=bound, e.g.
+    ///                              "PRESSURE=10,SATURATION=1e-5".
+    ///  - output_archive_chunk      Number of cells per chunk.
+    ///  - output_archive_incremental  Store unchanged chunks as
+    ///                              references.
+    FieldArchiveWriter (const parameter::ParameterGroup& params,
+                        std::shared_ptr <const EclipseState> eclipseState,
+                        const PhaseUsage& phaseUsage,
+                        const int numCells,
+                        const int* globalCell);
+
+    /// Writes the index of the steps.
+    virtual ~FieldArchiveWriter ();
+
+    /// Creates the archive.
+    virtual void writeInit(const SimulatorTimerInterface &timer);
+
+    /// Appends the cell fields of a report step.
+    virtual void writeTimeStep(const SimulatorTimerInterface& timer,
+                               const SimulationDataContainer& reservoirState,
+                               const WellState& wellState,
+                               bool  isSubstep);
+
+    /// Writes the index of the steps and closes the archive. Nothing
+    /// can be written afterwards.
+    void close ();
+
+private:
+    void open ();
+
+    const std::string filename_;
+    const int numCells_;
+    std::vector <int> globalCell_;
+    Tolerances tolerances_;
+    const int chunkCells_;
+    const bool incremental_;
+    std::ofstream file_;
+    bool closed_;
+    std::vector <std::uint64_t> stepOffsets_;
+
+    // in incremental mode: the fields of the previous step, and the
+    // step where each of their chunks is stored
+    std::map <std::string, std::vector <double> > previous_;
+    std::map <std::string, std::vector <std::uint32_t> > source_;
+};
+
+/*!
+ * Random access reader of an archive written by FieldArchiveWriter.
+ *
+ * Opening an archive reads its header and the directories of all
+ * steps; field values are only read, and decompressed, on request.
+ */
+class FieldArchiveReader {
+public:
+    /// \param[in] filename  Archive file.
+    explicit FieldArchiveReader (const std::string& filename);
+
+    /// Number of cells of the fields.
+    int numCells () const { return numCells_; }
+
+    /// Global cell index of each cell, empty if not stored.
+    const std::vector <int>& globalCell () const { return globalCell_; }
+
+    /// Number of archived steps.
+    int numSteps () const { return static_cast <int> (steps_.size ()); }
+
+    /// Report step number of an archived step.
+    int reportStep (const int step) const;
+
+    /// Simulation time of an archived step.
+    double simulationTime (const int step) const;
+
+    /// Archived step with the given report step number, or -1.
+    int findReportStep (const int reportStep) const;
+
+    /// Names of the fields of an archived step, sorted.
+    std::vector <std::string> fieldNames (const int step) const;
+
+    /// Whether an archived step has a field.
+    bool hasField (const int step, const std::string& name) const;
+
+    /// Number of components per cell of a field.
+    int components (const int step, const std::string& name) const;
+
+    /// Error bound the field was stored with, zero if lossless.
+    double tolerance (const int step, const std::string& name) const;
+
+    /// All values of a field, components of each cell together.
+    std::vector <double> read (const int step, const std::string& name) const;
+
+    /// Values of the cells [begin, end) of a field. Only the chunks
+    /// holding these cells are read.
+    std::vector <double> read (const int step, const std::string& name,
+                               const int begin, const int end) const;
+
+private:
+    struct Chunk {
+        std::uint8_t codec;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+    struct Field {
+        int components;
+        double tolerance;
+        std::vector <Chunk> chunks;
+    };
+    struct Step {
+        int reportStep;
+        double time;
+        std::map <std::string, Field> fields;
+    };
+
+    void readStep (const std::uint64_t offset, const std::uint64_t end);
+    const Field& field (const int step, const std::string& name) const;
+
+    const std::string filename_;
+    mutable std::ifstream file_;
+    int numCells_;
+    int chunkCells_;
+    std::vector <int> globalCell_;
+    std::vector <Step> steps_;
+};
+
+} // namespace Opm
+
+#endif /* OPM_FIELD_ARCHIVE_HPP */
@@ -0,0 +1,215 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/io/GatherOutputWriter.hpp>
+
+#if HAVE_MPI
+
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/core/simulator/WellState.hpp>
+#include <opm/core/utility/TimingTree.hpp>
+
+#include <stdexcept>
+
+namespace Opm {
+
+GatherOutputWriter::GatherOutputWriter (std::unique_ptr <OutputWriter> writer,
+                                        const std::vector <int>& ownedLocal,
+                                        const std::vector <int>& ownedGlobal,
+                                        const int numGlobalCells,
+                                        MPI_Comm comm,
+                                        const int writerRank)
+    : writer_ (std::move (writer))
+    , comm_ (comm)
+    , writerRank_ (writerRank)
+    , numGlobalCells_ (numGlobalCells)
+    , ownedLocal_ (ownedLocal)
+    , request_ (MPI_REQUEST_NULL)
+    , pending_ (false)
+    , isSubstep_ (false) {
+
+    MPI_Comm_rank (comm_, &rank_);
+    if (ownedLocal.size () != ownedGlobal.size ()) {
+        OPM_THROW(std::invalid_argument, "GatherOutputWriter: " << ownedLocal.size ()
+                  << " local but " << ownedGlobal.size () << " global cell indices");
+    }
+    if (isWriter () && !writer_) {
+        OPM_THROW(std::invalid_argument, "GatherOutputWriter: no writer on the writer process");
+    }
+
+    // the writer process learns once where the cells of every process go
+    int size = 0;
+    MPI_Comm_size (comm_, &size);
+    int count = static_cast <int> (ownedLocal.size ());
+    if (isWriter ()) {
+        ownedCount_.resize (size);
+    }
+    MPI_Gather (&count, 1, MPI_INT, ownedCount_.data (), 1, MPI_INT, writerRank_, comm_);
+
+    std::vector <int> displs;
+    if (isWriter ()) {
+        displs.resize (size, 0);
+        for (int r = 1; r < size; ++r) {
+            displs[r] = displs[r - 1] + ownedCount_[r - 1];
+        }
+        globalIndex_.resize (displs.back () + ownedCount_.back ());
+    }
+    MPI_Gatherv (const_cast <int*> (ownedGlobal.data ()), count, MPI_INT,
+                 globalIndex_.data (), ownedCount_.data (), displs.data (), MPI_INT,
+                 writerRank_, comm_);
+
+    if (isWriter ()) {
+        std::vector <char> seen (numGlobalCells_, 0);
+        for (const int cell : globalIndex_) {
+            if (cell < 0 || cell >= numGlobalCells_ || seen[cell]) {
+                OPM_THROW(std::invalid_argument, "GatherOutputWriter: global cell " << cell
+                          << " is out of range or owned by two processes");
+            }
+            seen[cell] = 1;
+        }
+        if (int (globalIndex_.size ()) != numGlobalCells_) {
+            OPM_THROW(std::invalid_argument, "GatherOutputWriter: " << globalIndex_.size ()
+                      << " owned cells in a grid of " << numGlobalCells_ << " cells");
+        }
+    }
+}
+
+GatherOutputWriter::~GatherOutputWriter () {
+    try {
+        flush ();
+    }
+    catch (...) {
+        // cannot throw from the destructor; call flush() to see errors
+    }
+}
+
+void
+GatherOutputWriter::writeInit (const SimulatorTimerInterface &timer) {
+    flush ();
+    if (isWriter ()) {
+        writer_->writeInit (timer);
+    }
+}
+
+void
+GatherOutputWriter::writeTimeStep (const SimulatorTimerInterface& timer,
+                                   const SimulationDataContainer& reservoirState,
+                                   const WellState& wellState,
+                                   bool  isSubstep) {
+    flush ();
+    OPM_TIMED_SCOPE("output gather");
+
+    // pack all components of all cell fields of the owned cells, in
+    // the (sorted) order of the field names
+    const int numCells = static_cast <int> (reservoirState.numCells ());
+    fields_.clear ();
+    int valuesPerCell = 0;
+    for (const auto& field : reservoirState.cellData ()) {
+        const int components = numCells > 0 ? int (field.second.size ()) / numCells : 0;
+        fields_.emplace_back (field.first, components);
+        valuesPerCell += components;
+    }
+    sendBuffer_.resize (ownedLocal_.size () * valuesPerCell);
+    double* out = sendBuffer_.data ();
+    for (const auto& field : reservoirState.cellData ()) {
+        const int components = numCells > 0 ? int (field.second.size ()) / numCells : 0;
+        for (const int cell : ownedLocal_) {
+            for (int k = 0; k < components; ++k) {
+                *out++ = field.second[components*cell + k];
+            }
+        }
+    }
+
+    if (isWriter ()) {
+        recvCounts_.resize (ownedCount_.size ());
+        recvDispls_.assign (ownedCount_.size (), 0);
+        for (std::size_t r = 0; r < ownedCount_.size (); ++r) {
+            recvCounts_[r] = ownedCount_[r]*valuesPerCell;
+            if (r > 0) {
+                recvDispls_[r] = recvDispls_[r - 1] + recvCounts_[r - 1];
+            }
+        }
+        recvBuffer_.resize (numGlobalCells_*valuesPerCell);
+
+        timer_ = timer.clone ();
+        if (wellState_) {
+            *wellState_ = wellState;
+        }
+        else {
+            wellState_.reset (new WellState (wellState));
+        }
+        isSubstep_ = isSubstep;
+        if (!globalState_ || globalState_->numPhases () != reservoirState.numPhases ()) {
+            globalState_.reset (new SimulationDataContainer (numGlobalCells_, 0, reservoirState.numPhases ()));
+        }
+    }
+
+    // all buffers, including the counts and displacements, must stay
+    // untouched until the gather completes
+    MPI_Igatherv (sendBuffer_.data (), int (sendBuffer_.size ()), MPI_DOUBLE,
+                  recvBuffer_.data (), recvCounts_.data (), recvDispls_.data (), MPI_DOUBLE,
+                  writerRank_, comm_, &request_);
+    pending_ = true;
+}
+
+void
+GatherOutputWriter::flush () {
+    if (!pending_) {
+        return;
+    }
+    {
+        OPM_TIMED_SCOPE("output gather wait");
+        MPI_Wait (&request_, MPI_STATUS_IGNORE);
+    }
+    pending_ = false;
+    if (!isWriter ()) {
+        return;
+    }
+
+    // the receive buffer holds, for each process in rank order, the
+    // fields of its owned cells in the order they were packed
+    const double* in = recvBuffer_.data ();
+    std::size_t begin = 0;
+    for (const int count : ownedCount_) {
+        for (const auto& field : fields_) {
+            const int components = field.second;
+            if (!globalState_->hasCellData (field.first)) {
+                globalState_->registerCellData (field.first, components);
+            }
+            std::vector <double>& values = globalState_->getCellData (field.first);
+            for (int i = 0; i < count; ++i) {
+                const int cell = globalIndex_[begin + i];
+                for (int k = 0; k < components; ++k) {
+                    values[components*cell + k] = *in++;
+                }
+            }
+        }
+        begin += count;
+    }
+
+    OPM_TIMED_SCOPE("output");
+    writer_->writeTimeStep (*timer_, *globalState_, *wellState_, isSubstep_);
+}
+
+} // namespace Opm
+
+#endif // HAVE_MPI
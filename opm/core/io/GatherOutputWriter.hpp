@@ -0,0 +1,140 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_GATHER_OUTPUT_WRITER_HPP
+#define OPM_GATHER_OUTPUT_WRITER_HPP
+
+#include <opm/core/io/OutputWriter.hpp>
+
+#if HAVE_MPI
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <mpi.h>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * Output writer for distributed runs, which gathers the state of all
+ * processes to one writer process.
+ *
+ * Each process owns a part of the cells of the global grid. At every
+ * writeTimeStep() each process packs the cell data of its owned
+ * cells and starts a nonblocking gather to the writer process, and
+ * returns without waiting for it. The gather is completed by the next
+ * call, when the writer process scatters the values into a state of
+ * the global grid, in the order of the global cell indices, and gives
+ * it to the wrapped writer. The communication and the writing of one
+ * step thus overlap the computation of the next, and only the writer
+ * process waits for the writing.
+ *
+ * All cell fields of the reservoir states are gathered; all processes
+ * must have the same fields. Face fields are not gathered, and the
+ * global state has no faces. The wells are assumed to be known
+ * to all processes, and the well state of the writer process is used.
+ *
+ * All methods, including the constructor and destructor, are
+ * collective over the communicator. With a ParallelISTLInformation,
+ * the owned cells are those of its index set with the owner
+ * attribute, e.g.
+ *
+ * \code{.cpp}
+ *  for (const auto& index : *info.indexSet ()) {
+ *      if (index.local ().attribute () == Dune::OwnerOverlapCopyAttributeSet::owner) {
+ *          ownedLocal.push_back (index.local ().local ());
+ *          ownedGlobal.push_back (index.global ());
+ *      }
+ *  }
+ * \endcode
+ */
+class GatherOutputWriter : public OutputWriter {
+public:
+    /// \param[in] writer          Writer for the global state, used on
+    ///                            the writer process only.
+    /// \param[in] ownedLocal      Local indices of the cells owned by this process.
+    /// \param[in] ownedGlobal     Global indices of the same cells.
+    /// \param[in] numGlobalCells  Number of cells of the global grid.
+    /// \param[in] comm            Communicator of the processes.
+    /// \param[in] writerRank      Rank of the writer process.
+    GatherOutputWriter (std::unique_ptr <OutputWriter> writer,
+                        const std::vector <int>& ownedLocal,
+                        const std::vector <int>& ownedGlobal,
+                        const int numGlobalCells,
+                        MPI_Comm comm,
+                        const int writerRank = 0);
+
+    /// Completes a pending time step.
+    virtual ~GatherOutputWriter ();
+
+    /// Completes a pending time step, and then writes the static
+    /// data on the writer process.
+    virtual void writeInit(const SimulatorTimerInterface &timer);
+
+    /// Completes a pending time step and starts gathering this one.
+    virtual void writeTimeStep(const SimulatorTimerInterface& timer,
+                               const SimulationDataContainer& reservoirState,
+                               const WellState& wellState,
+                               bool  isSubstep);
+
+    /// Completes a pending time step.
+    void flush ();
+
+    /// Whether this is the writer process.
+    bool isWriter () const { return rank_ == writerRank_; }
+
+private:
+    std::unique_ptr <OutputWriter> writer_;
+    MPI_Comm comm_;
+    const int writerRank_;
+    int rank_;
+    const int numGlobalCells_;
+    std::vector <int> ownedLocal_;
+
+    // on the writer process: owned cells of each process, and their
+    // global indices in rank order
+    std::vector <int> ownedCount_;
+    std::vector <int> globalIndex_;
+
+    // the pending step: names and components of the gathered fields,
+    // send and receive buffers, and on the writer process, what to
+    // write with the gathered state
+    std::vector <std::pair <std::string, int> > fields_;
+    std::vector <double> sendBuffer_;
+    std::vector <double> recvBuffer_;
+    std::vector <int> recvCounts_;
+    std::vector <int> recvDispls_;
+    MPI_Request request_;
+    bool pending_;
+    std::unique_ptr <SimulatorTimerInterface> timer_;
+    std::unique_ptr <WellState> wellState_;
+    bool isSubstep_;
+    std::unique_ptr <SimulationDataContainer> globalState_;
+};
+
+} // namespace Opm
+
+#endif // HAVE_MPI
+
+#endif /* OPM_GATHER_OUTPUT_WRITER_HPP */
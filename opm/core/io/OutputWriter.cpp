@@ -1,6 +1,8 @@
 #include "OutputWriter.hpp"
 
 #include <opm/core/grid.h>
+#include <opm/core/io/AsyncOutputWriter.hpp>
+#include <opm/core/io/FieldArchive.hpp>
 #include <opm/core/io/eclipse/EclipseWriter.hpp>
 #include <opm/core/utility/parameters/Parameter.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
@@ -71,6 +73,7 @@ typedef map <const char*, unique_ptr <OutputWriter> (*)(
         std::shared_ptr <const UnstructuredGrid>)> map_t;
 map_t FORMATS = {
     { "output_ecl", &create <EclipseWriter> },
+    { "output_archive", &create <FieldArchiveWriter> },
 };
 
 } // anonymous namespace
@@ -99,5 +102,12 @@ OutputWriter::create (const ParameterGroup& params,
     }
 
     // create a multiplexer from the list of formats we found
-    return unique_ptr <OutputWriter> (new MultiWriter (std::move (list)));
+    unique_ptr <OutputWriter> writer (new MultiWriter (std::move (list)));
+
+    // optionally move the writing off the simulation thread
+    if (params.getDefault <bool> ("output_async", false)) {
+        const int maxQueued = params.getDefault <int> ("output_async_queue", 2);
+        writer.reset (new AsyncOutputWriter (std::move (writer), maxQueued));
+    }
+    return writer;
 }
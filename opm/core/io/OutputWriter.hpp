@@ -96,7 +96,10 @@ public:
      *
      * @param params Configuration properties. This function will setup a
      *               multiplexer of applicable output formats based on the
-     *               desired configuration values.
+     *               desired configuration values. If output_async is
+     *               true, the formats are written on a background
+     *               thread by an AsyncOutputWriter, with at most
+     *               output_async_queue pending time steps.
      *
      * @param deck Input deck used to set up the simulation.
      *
@@ -21,6 +21,7 @@
 #define OPM_CORNERPOINTCHOPPER_HEADER_INCLUDED
 
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/io/eclipse/GrdeclIndex.hpp>
 #include <opm/parser/eclipse/Parser/Parser.hpp>
 #include <opm/parser/eclipse/Parser/ParseContext.hpp>
 #include <opm/parser/eclipse/Units/UnitSystem.hpp>
@@ -28,9 +29,12 @@
 #include <opm/parser/eclipse/Deck/DeckKeyword.hpp>
 #include <opm/parser/eclipse/Deck/DeckRecord.hpp>
 #include <opm/parser/eclipse/Deck/DeckItem.hpp>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 #include <stdexcept>
 #include <memory>
@@ -38,30 +42,80 @@
 namespace Opm
 {
 
+    /// Extracts a box of cells from a corner-point grid given in a
+    /// GRDECL file, with the grid properties of the cells in the box.
+    ///
+    /// By default the whole file is parsed into a deck. In streaming
+    /// mode the file is instead memory mapped and indexed by a
+    /// GrdeclIndex, and only the parts of COORD, ZCORN and the
+    /// properties inside the box are parsed and stored, so that the
+    /// memory use is proportional to the size of the box. The file
+    /// must then contain the whole grid, as INCLUDE is not followed.
     class CornerPointChopper
     {
     public:
-        CornerPointChopper(const std::string& file)
+        /// \param[in] file       GRDECL file with SPECGRID, COORD and ZCORN.
+        /// \param[in] streaming  Whether to read the file through an
+        ///                       index instead of parsing it.
+        explicit CornerPointChopper(const std::string& file, const bool streaming = false)
         {
-            Opm::ParseContext parseContext;
-            Opm::ParserPtr parser(new Opm::Parser());
-            deck_ = parser->parseFile(file , parseContext);
-
             metricUnits_.reset(Opm::UnitSystem::newMETRIC());
 
-            const auto& specgridRecord = deck_->getKeyword("SPECGRID").getRecord(0);
-            dims_[0] = specgridRecord.getItem("NX").get< int >(0);
-            dims_[1] = specgridRecord.getItem("NY").get< int >(0);
-            dims_[2] = specgridRecord.getItem("NZ").get< int >(0);
+            if (streaming) {
+                index_.reset(new GrdeclIndex(file));
+                const char* dimsKeyword = index_->hasKeyword("SPECGRID") ? "SPECGRID" : "DIMENS";
+                const std::vector<double> dims = index_->read(dimsKeyword, 0, 3);
+                for (int d = 0; d < 3; ++d) {
+                    dims_[d] = static_cast<int>(dims[d]);
+                }
+            }
+            else {
+                Opm::ParseContext parseContext;
+                Opm::ParserPtr parser(new Opm::Parser());
+                deck_ = parser->parseFile(file , parseContext);
+
+                const auto& specgridRecord = deck_->getKeyword("SPECGRID").getRecord(0);
+                dims_[0] = specgridRecord.getItem("NX").get< int >(0);
+                dims_[1] = specgridRecord.getItem("NY").get< int >(0);
+                dims_[2] = specgridRecord.getItem("NZ").get< int >(0);
+            }
 
-            int layersz = 8*dims_[0]*dims_[1];
-            const std::vector<double>& ZCORN = deck_->getKeyword("ZCORN").getRawDoubleData();
-            botmax_ = *std::max_element(ZCORN.begin(), ZCORN.begin() + layersz/2);
-            topmin_ = *std::min_element(ZCORN.begin() + dims_[2]*layersz - layersz/2,
-                                        ZCORN.begin() + dims_[2]*layersz);
+            const std::size_t layersz = 8*std::size_t(dims_[0])*dims_[1];
+            if (keywordSize_("ZCORN") != layersz*dims_[2]) {
+                std::cerr << "Error! ZCORN size (" << keywordSize_("ZCORN") << ") not consistent with SPECGRID\n";
+                throw std::runtime_error("Inconsistent ZCORN and SPECGRID.");
+            }
 
-            abszmax_ = *std::max_element(ZCORN.begin(), ZCORN.end());
-            abszmin_ = *std::min_element(ZCORN.begin(), ZCORN.end());
+            // the z limits of each layer, and of the grid's top and
+            // bottom surfaces, in one pass over ZCORN
+            const double inf = std::numeric_limits<double>::max();
+            layer_zmin_.assign(dims_[2], inf);
+            layer_zmax_.assign(dims_[2], -inf);
+            botmax_ = -inf;
+            topmin_ = inf;
+            auto visitor = [&](std::size_t first, const double* z, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::size_t ix = first + i;
+                    const std::size_t k = ix / layersz;
+                    layer_zmin_[k] = std::min(layer_zmin_[k], z[i]);
+                    layer_zmax_[k] = std::max(layer_zmax_[k], z[i]);
+                    if (ix < layersz/2) {
+                        botmax_ = std::max(botmax_, z[i]);
+                    }
+                    if (ix >= dims_[2]*layersz - layersz/2) {
+                        topmin_ = std::min(topmin_, z[i]);
+                    }
+                }
+            };
+            if (index_) {
+                index_->scan("ZCORN", visitor);
+            }
+            else {
+                const std::vector<double>& ZCORN = deck_->getKeyword("ZCORN").getRawDoubleData();
+                visitor(0, ZCORN.data(), ZCORN.size());
+            }
+            abszmax_ = *std::max_element(layer_zmax_.begin(), layer_zmax_.end());
+            abszmin_ = *std::min_element(layer_zmin_.begin(), layer_zmin_.end());
 
             std::cout << "Parsed grdecl file with dimensions ("
                       << dims_[0] << ", " << dims_[1] << ", " << dims_[2] << ")" << std::endl;
@@ -144,23 +198,23 @@ namespace Opm
             new_dims_[0] = imax - imin;
             new_dims_[1] = jmax - jmin;
 
-            // Filter the coord field
-            const std::vector<double>& COORD = deck_->getKeyword("COORD").getRawDoubleData();
-            int num_coord = COORD.size();
-            if (num_coord != 6*(dims_[0] + 1)*(dims_[1] + 1)) {
-                std::cerr << "Error! COORD size (" << COORD.size() << ") not consistent with SPECGRID\n";
+            // Filter the coord field, reading one row of pillars at a time
+            std::size_t num_coord = keywordSize_("COORD");
+            if (num_coord != 6*std::size_t(dims_[0] + 1)*(dims_[1] + 1)) {
+                std::cerr << "Error! COORD size (" << num_coord << ") not consistent with SPECGRID\n";
                 throw std::runtime_error("Inconsistent COORD and SPECGRID.");
             }
-            int num_new_coord = 6*(new_dims_[0] + 1)*(new_dims_[1] + 1);
-            double x_correction = COORD[6*((dims_[0] + 1)*jmin + imin)];
-            double y_correction = COORD[6*((dims_[0] + 1)*jmin + imin) + 1];
-            new_COORD_.resize(num_new_coord, 1e100);
+            Ranges pillar_rows;
+            for (int j = jmin; j < jmax + 1; ++j) {
+                const std::size_t pos = std::size_t(dims_[0] + 1)*j;
+                pillar_rows.emplace_back(6*(pos + imin), 6*(pos + imax + 1));
+            }
+            new_COORD_ = readDoubleRanges_("COORD", pillar_rows);
+            double x_correction = new_COORD_[0];
+            double y_correction = new_COORD_[1];
             for (int j = jmin; j < jmax + 1; ++j) {
                 for (int i = imin; i < imax + 1; ++i) {
-                    int pos = (dims_[0] + 1)*j + i;
                     int new_pos = (new_dims_[0] + 1)*(j-jmin) + (i-imin);
-                    // Copy all 6 coordinates for a pillar.
-                    std::copy(COORD.begin() + 6*pos, COORD.begin() + 6*(pos + 1), new_COORD_.begin() + 6*new_pos);
                     if (resettoorigin) {
                         // Substract lowest x value from all X-coords, similarly for y, and truncate in z-direction
                       new_COORD_[6*new_pos]     -= x_correction;
@@ -177,14 +231,6 @@ namespace Opm
             // This means that zmin must be greater than or equal to the highest
             // coordinate of the bottom surface, while zmax must be less than or
             // equal to the lowest coordinate of the top surface.
-            int layersz = 8*dims_[0]*dims_[1];
-            const std::vector<double>& ZCORN = deck_->getKeyword("ZCORN").getRawDoubleData();
-            int num_zcorn = ZCORN.size();
-            if (num_zcorn != layersz*dims_[2]) {
-                std::cerr << "Error! ZCORN size (" << ZCORN.size() << ") not consistent with SPECGRID\n";
-                throw std::runtime_error("Inconsistent ZCORN and SPECGRID.");
-            }
-
             zmin = std::max(zmin, botmax_);
             zmax = std::min(zmax, topmin_);
             if (zmin >= zmax) {
@@ -197,8 +243,7 @@ namespace Opm
             // First, find the first layer with a z-coordinate strictly above zmin.
             int kmin = -1;
             for (int k = 0; k < dims_[2]; ++k) {
-                double layer_max = *std::max_element(ZCORN.begin() + k*layersz, ZCORN.begin() + (k + 1)*layersz);
-                if (layer_max > zmin) {
+                if (layer_zmax_[k] > zmin) {
                     kmin = k;
                     break;
                 }
@@ -206,8 +251,7 @@ namespace Opm
             // Then, find the last layer with a z-coordinate strictly below zmax.
             int kmax = -1;
             for (int k = dims_[2]; k > 0; --k) {
-                double layer_min = *std::min_element(ZCORN.begin() + (k - 1)*layersz, ZCORN.begin() + k*layersz);
-                if (layer_min < zmax) {
+                if (layer_zmin_[k - 1] < zmax) {
                     kmax = k;
                     break;
                 }
@@ -219,28 +263,33 @@ namespace Opm
             if (resettoorigin) {
                 z_origin_correction = zmin;
             }
-            new_ZCORN_.resize(8*new_dims_[0]*new_dims_[1]*new_dims_[2], 1e100);
+            // The corners of the box are the ZCORN rows of 2*(imax - imin)
+            // values at the corner planes 2*kmin, ..., 2*kmax - 1 and the
+            // corner rows 2*jmin, ..., 2*jmax - 1, which read in order
+            // are the ZCORN field of the box.
+            Ranges corner_rows;
+            for (std::size_t z = 2*kmin; z < std::size_t(2*kmax); ++z) {
+                for (std::size_t y = 2*jmin; y < std::size_t(2*jmax); ++y) {
+                    const std::size_t row = 4*std::size_t(dims_[0])*dims_[1]*z + 2*std::size_t(dims_[0])*y;
+                    corner_rows.emplace_back(row + 2*imin, row + 2*imax);
+                }
+            }
+            new_ZCORN_ = readDoubleRanges_("ZCORN", corner_rows);
+            for (double& z : new_ZCORN_) {
+                z = std::min(zmax, std::max(zmin, z)) - z_origin_correction;
+            }
+
+            // Build mapping from new to old cells, and the rows of cells
+            // to read the properties from.
             new_to_old_cell_.resize(new_dims_[0]*new_dims_[1]*new_dims_[2], -1);
+            cell_rows_.clear();
             int cellcount = 0;
-            int delta[3] = { 1, 2*dims_[0], 4*dims_[0]*dims_[1] };
-            int new_delta[3] = { 1, 2*new_dims_[0], 4*new_dims_[0]*new_dims_[1] };
             for (int k = kmin; k < kmax; ++k) {
                 for (int j = jmin; j < jmax; ++j) {
+                    const std::size_t row = std::size_t(dims_[0])*dims_[1]*k + std::size_t(dims_[0])*j;
+                    cell_rows_.emplace_back(row + imin, row + imax);
                     for (int i = imin; i < imax; ++i) {
                         new_to_old_cell_[cellcount++] = dims_[0]*dims_[1]*k + dims_[0]*j + i;
-                        int old_ix = 2*(i*delta[0] + j*delta[1] + k*delta[2]);
-                        int new_ix = 2*((i-imin)*new_delta[0] + (j-jmin)*new_delta[1] + (k-kmin)*new_delta[2]);
-                        int old_indices[8] = { old_ix, old_ix + delta[0],
-                                               old_ix + delta[1], old_ix + delta[1] + delta[0],
-                                               old_ix + delta[2], old_ix + delta[2] + delta[0],
-                                               old_ix + delta[2] + delta[1], old_ix + delta[2] + delta[1] + delta[0] };
-                        int new_indices[8] = { new_ix, new_ix + new_delta[0],
-                                               new_ix + new_delta[1], new_ix + new_delta[1] + new_delta[0],
-                                               new_ix + new_delta[2], new_ix + new_delta[2] + new_delta[0],
-                                               new_ix + new_delta[2] + new_delta[1], new_ix + new_delta[2] + new_delta[1] + new_delta[0] };
-                        for (int cc = 0; cc < 8; ++cc) {
-                            new_ZCORN_[new_indices[cc]] = std::min(zmax, std::max(zmin, ZCORN[old_indices[cc]])) - z_origin_correction;
-                        }
                     }
                 }
             }
@@ -329,7 +378,10 @@ namespace Opm
         bool hasSOWCR() const {return !new_SOWCR_.empty(); }
 
     private:
+        typedef std::vector<std::pair<std::size_t, std::size_t> > Ranges;
+
         Opm::DeckConstPtr deck_;
+        std::shared_ptr<GrdeclIndex> index_;
         std::shared_ptr<Opm::UnitSystem> metricUnits_;
 
         double botmax_;
@@ -350,6 +402,29 @@ namespace Opm
         int dims_[3];
         int new_dims_[3];
         std::vector<int> new_to_old_cell_;
+        // ranges of cell indices of the box, in the order of the new cells
+        Ranges cell_rows_;
+        std::vector<double> layer_zmin_;
+        std::vector<double> layer_zmax_;
+
+        std::size_t keywordSize_(const std::string& keyword) const
+        {
+            return index_ ? index_->size(keyword) : deck_->getKeyword(keyword).getDataSize();
+        }
+
+        // The values of a keyword in the given ranges, concatenated.
+        std::vector<double> readDoubleRanges_(const std::string& keyword, const Ranges& ranges) const
+        {
+            if (index_) {
+                return index_->read(keyword, ranges);
+            }
+            const std::vector<double>& field = deck_->getKeyword(keyword).getRawDoubleData();
+            std::vector<double> values;
+            for (const auto& range : ranges) {
+                values.insert(values.end(), field.begin() + range.first, field.begin() + range.second);
+            }
+            return values;
+        }
 
         void addDoubleKeyword_(Opm::DeckPtr subDeck,
                                const std::string& keywordName,
@@ -433,7 +508,12 @@ namespace Opm
 
         void filterDoubleField(const std::string& keyword, std::vector<double>& output_field)
         {
-            if (deck_->hasKeyword(keyword)) {
+            if (index_) {
+                if (index_->hasKeyword(keyword)) {
+                    output_field = index_->read(keyword, cell_rows_);
+                }
+            }
+            else if (deck_->hasKeyword(keyword)) {
                 const std::vector<double>& field = deck_->getKeyword(keyword).getRawDoubleData();
                 filterField(field, output_field);
             }
@@ -441,7 +521,13 @@ namespace Opm
 
         void filterIntegerField(const std::string& keyword, std::vector<int>& output_field)
         {
-            if (deck_->hasKeyword(keyword)) {
+            if (index_) {
+                if (index_->hasKeyword(keyword)) {
+                    const std::vector<double> field = index_->read(keyword, cell_rows_);
+                    output_field.assign(field.begin(), field.end());
+                }
+            }
+            else if (deck_->hasKeyword(keyword)) {
                 const std::vector<int>& field = deck_->getKeyword(keyword).getIntData();
                 filterField(field, output_field);
             }
@@ -23,6 +23,7 @@
 #include <opm/core/utility/Units.hpp>
 #include <opm/core/grid/GridHelpers.hpp>
 #include <opm/core/io/eclipse/EclipseIOUtil.hpp>
+#include <opm/core/io/eclipse/RestartFileIndex.hpp>
 
 #include <opm/parser/eclipse/EclipseState/IOConfig/IOConfig.hpp>
 #include <opm/parser/eclipse/EclipseState/InitConfig/InitConfig.hpp>
@@ -226,6 +227,91 @@ namespace Opm
 
 
 
+    // Read the keywords of one cell field of the restart file through
+    // the index, into every stride'th value of dest.
+    static void restoreCellData(const RestartFileIndex& index,
+                                const char* keyword,
+                                int reportstep,
+                                int numcells,
+                                std::vector<double>& dest,
+                                int offset = 0,
+                                int stride = 1,
+                                double scale = 1.0,
+                                double valueOffset = 0.0)
+    {
+        const RestartFileIndex::Keyword* kw = index.find(keyword, reportstep);
+        if (!kw) {
+            throw std::runtime_error(std::string("Restart file is missing ") + keyword + " data!\n");
+        }
+        if (kw->count != numcells || int(dest.size()) < stride*(numcells - 1) + offset + 1) {
+            throw std::runtime_error(std::string("Read of restart file: Could not restore ") + keyword
+                                     + " data, length of data from file not equal number of cells");
+        }
+        index.read(*kw, 0, numcells, dest.data() + offset, stride, scale, valueOffset);
+    }
+
+
+    // Restore the state from an unformatted restart file, decoding only
+    // the keywords needed instead of loading the whole report step.
+    static void restoreFromIndex(const std::string& restart_filename,
+                                 int reportstep,
+                                 bool unified,
+                                 EclipseStateConstPtr eclipseState,
+                                 int numcells,
+                                 const PhaseUsage& phaseUsage,
+                                 SimulationDataContainer& simulator_state,
+                                 WellState& wellstate)
+    {
+        const RestartFileIndex index(restart_filename);
+        if (unified && !index.hasReportStep(reportstep)) {
+            std::string error_str = "Restart file " +  restart_filename + " does not contain data for report step " + std::to_string(reportstep) + "!\n";
+            throw std::runtime_error(error_str);
+        }
+        const int step = unified ? reportstep : -1;
+
+        const double deck_pressure_unit = (eclipseState->getDeckUnitSystem().getType() == UnitSystem::UNIT_TYPE_METRIC) ? Opm::unit::barsa : Opm::unit::psia;
+        restoreCellData(index, "PRESSURE", step, numcells, simulator_state.pressure(), 0, 1, deck_pressure_unit);
+
+        const double scaling = eclipseState->getDeckUnitSystem().parse("Temperature")->getSIScaling();
+        const double offset  = eclipseState->getDeckUnitSystem().parse("Temperature")->getSIOffset();
+        restoreCellData(index, "TEMP", step, numcells, simulator_state.temperature(), 0, 1, scaling, offset);
+
+        const int np = phaseUsage.num_phases;
+        if (phaseUsage.phase_used[BlackoilPhases::Aqua]) {
+            restoreCellData(index, "SWAT", step, numcells, simulator_state.saturation(),
+                            phaseUsage.phase_pos[BlackoilPhases::Aqua], np);
+        }
+        if (phaseUsage.phase_used[BlackoilPhases::Vapour]) {
+            restoreCellData(index, "SGAS", step, numcells, simulator_state.saturation(),
+                            phaseUsage.phase_pos[BlackoilPhases::Vapour], np);
+        }
+
+        if (simulator_state.hasCellData( BlackoilState::RV )) {
+            SimulationConfigConstPtr sim_config = eclipseState->getSimulationConfig();
+            if (sim_config->hasDISGAS()) {
+                restoreCellData(index, "RS", step, numcells, simulator_state.getCellData( BlackoilState::GASOILRATIO ));
+            }
+            if (sim_config->hasVAPOIL()) {
+                restoreCellData(index, "RV", step, numcells, simulator_state.getCellData( BlackoilState::RV ));
+            }
+        }
+
+        const RestartFileIndex::Keyword* xwel = index.find("OPM_XWEL", step);
+        if (!xwel) {
+            throw std::runtime_error("Restart file " + restart_filename + " is missing OPM_XWEL data!\n");
+        }
+        const auto readWellData = [&](std::vector<double>& dest, int begin) {
+            index.read(*xwel, begin, dest.size(), dest.data());
+        };
+        readWellData(wellstate.temperature(), wellstate.getRestartTemperatureOffset());
+        readWellData(wellstate.bhp(), wellstate.getRestartBhpOffset());
+        readWellData(wellstate.perfPress(), wellstate.getRestartPerfPressOffset());
+        readWellData(wellstate.perfRates(), wellstate.getRestartPerfRatesOffset());
+        readWellData(wellstate.wellRates(), wellstate.getRestartWellRatesOffset());
+    }
+
+
+
     void init_from_restart_file(EclipseStateConstPtr eclipse_state,
                                 int numcells,
                                 const PhaseUsage& phase_usage,
@@ -239,6 +325,12 @@ namespace Opm
         bool output                          = false;
         const std::string& restart_file_name = ioConfig->getRestartFileName(restart_file_root, restart_step, output);
 
+        // unformatted files are read through a memory-mapped index,
+        // formatted ones are loaded by ert
+        if (RestartFileIndex::isUnformatted(restart_file_name)) {
+            Opm::restoreFromIndex(restart_file_name, restart_step, ioConfig->getUNIFIN(), eclipse_state, numcells, phase_usage, simulator_state, wellstate);
+            return;
+        }
         Opm::restoreSOLUTION(restart_file_name, restart_step, ioConfig->getUNIFIN(), eclipse_state, numcells, phase_usage, simulator_state);
         Opm::restoreOPM_XWELKeyword(restart_file_name, restart_step, ioConfig->getUNIFIN(), wellstate);
     }
@@ -24,6 +24,7 @@
 #include <opm/core/props/BlackoilPhases.hpp>
 #include <opm/core/utility/Units.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/compressedToCartesian.hpp>
 
 
 #include <opm/parser/eclipse/EclipseState/Schedule/CompletionSet.hpp>
@@ -56,27 +57,60 @@ namespace EclipseWriterDetails {
 
 
 
-        std::vector<ecl_rft_node_type *> rft_nodes;
+        // Look up the completion cells of all RFT wells, then gather
+        // the cell values into one array with the completions of each
+        // well contiguous.
+        const int reportStep = simulatorTimer.reportStepNum();
+        std::vector<WellConstPtr> rft_wells;
+        std::vector<const RFTCells*> rft_cells;
+        std::vector<int> offset(1, 0);
         for (std::vector<WellConstPtr>::const_iterator ci = wells.begin(); ci != wells.end(); ++ci) {
             WellConstPtr well = *ci;
-            if ((well->getRFTActive(simulatorTimer.reportStepNum())) || (well->getPLTActive(simulatorTimer.reportStepNum()))) {
-                ecl_rft_node_type * ecl_node = createEclRFTNode(well,
-                                                                 simulatorTimer,
-                                                                 eclipseGrid,
-                                                                 pressure,
-                                                                 swat,
-                                                                 sgas);
+            if ((well->getRFTActive(reportStep)) || (well->getPLTActive(reportStep))) {
+                rft_wells.push_back(well);
+                rft_cells.push_back(&completionCells(well->getCompletions(reportStep), eclipseGrid));
+                offset.push_back(offset.back() + rft_cells.back()->size());
 
                 // TODO: replace this silenced warning with an appropriate
                 //       use of the OpmLog facilities.
                 // if (well->getPLTActive(simulatorTimer.reportStepNum())) {
                 //     std::cerr << "PLT not supported, writing RFT data" << std::endl;
                 // }
+            }
+        }
 
-                rft_nodes.push_back(ecl_node);
+        const int num_wells = rft_wells.size();
+        std::vector<double> cell_pressure(offset.back(), 0.0);
+        std::vector<double> cell_swat(offset.back(), 0.0);
+        std::vector<double> cell_sgas(offset.back(), 0.0);
+#pragma omp parallel for schedule(dynamic)
+        for (int w = 0; w < num_wells; ++w) {
+            const RFTCells& cells = *rft_cells[w];
+            for (size_t c = 0; c < cells.size(); ++c) {
+                const int active_index = cells[c].activeIndex;
+                const int pos = offset[w] + c;
+                if (pressure.size() > 0) {
+                    cell_pressure[pos] = pressure[active_index];
+                }
+                if (swat.size() > 0) {
+                    cell_swat[pos] = swat[active_index];
+                }
+                if (sgas.size() > 0) {
+                    cell_sgas[pos] = sgas[active_index];
+                }
             }
         }
 
+        std::vector<ecl_rft_node_type *> rft_nodes;
+        for (int w = 0; w < num_wells; ++w) {
+            rft_nodes.push_back(createEclRFTNode(rft_wells[w],
+                                                 simulatorTimer,
+                                                 *rft_cells[w],
+                                                 cell_pressure.data() + offset[w],
+                                                 cell_swat.data() + offset[w],
+                                                 cell_sgas.data() + offset[w]));
+        }
+
 
         if (rft_nodes.size() > 0) {
             ecl_rft_file_update(filename.c_str(), rft_nodes.data(), rft_nodes.size(), ecl_unit);
@@ -89,23 +123,15 @@ namespace EclipseWriterDetails {
 
 
 
-    ecl_rft_node_type * EclipseWriteRFTHandler::createEclRFTNode(WellConstPtr well,
-                                                                  const SimulatorTimerInterface& simulatorTimer,
-                                                                  EclipseGridConstPtr eclipseGrid,
-                                                                  const std::vector<double>& pressure,
-                                                                  const std::vector<double>& swat,
-                                                                  const std::vector<double>& sgas) {
-
-
-        const std::string& well_name      = well->name();
-        size_t             timestep       = (size_t)simulatorTimer.reportStepNum();
-        time_t             recording_date = simulatorTimer.currentPosixTime();
-        double             days           = Opm::unit::convert::to(simulatorTimer.simulationTimeElapsed(), Opm::unit::day);
-
-        std::string type = "RFT";
-        ecl_rft_node_type * ecl_rft_node = ecl_rft_node_alloc_new(well_name.c_str(), type.c_str(), recording_date, days);
+    const EclipseWriteRFTHandler::RFTCells&
+    EclipseWriteRFTHandler::completionCells(CompletionSetConstPtr completionsSet,
+                                            EclipseGridConstPtr eclipseGrid) {
+        std::map<CompletionSetConstPtr, RFTCells>::iterator it = completionCells_.find(completionsSet);
+        if (it != completionCells_.end()) {
+            return it->second;
+        }
 
-        CompletionSetConstPtr completionsSet = well->getCompletions(timestep);
+        RFTCells& cells = completionCells_[completionsSet];
         for (size_t index = 0; index < completionsSet->size(); ++index) {
             CompletionConstPtr completion = completionsSet->get(index);
             size_t i = (size_t)completion->getI();
@@ -116,27 +142,49 @@ namespace EclipseWriterDetails {
             int active_index = globalToActiveIndex_[global_index];
 
             if (active_index > -1) {
-                double depth = eclipseGrid->getCellDepth(i,j,k);
-                double completion_pressure = pressure.size() > 0 ? pressure[active_index] : 0.0;
-                double saturation_water    = swat.size() > 0 ? swat[active_index] : 0.0;
-                double saturation_gas      = sgas.size() > 0 ? sgas[active_index] : 0.0;
-
-                ecl_rft_cell_type * ecl_rft_cell = ecl_rft_cell_alloc_RFT( i ,j, k , depth, completion_pressure, saturation_water, saturation_gas);
-                ecl_rft_node_append_cell( ecl_rft_node , ecl_rft_cell);
+                RFTCell cell;
+                cell.i = i;
+                cell.j = j;
+                cell.k = k;
+                cell.activeIndex = active_index;
+                cell.depth = eclipseGrid->getCellDepth(i,j,k);
+                cells.push_back(cell);
             }
         }
+        return cells;
+    }
+
+
+
+
+    ecl_rft_node_type * EclipseWriteRFTHandler::createEclRFTNode(WellConstPtr well,
+                                                                  const SimulatorTimerInterface& simulatorTimer,
+                                                                  const RFTCells& cells,
+                                                                  const double* pressure,
+                                                                  const double* swat,
+                                                                  const double* sgas) {
+
+
+        const std::string& well_name      = well->name();
+        time_t             recording_date = simulatorTimer.currentPosixTime();
+        double             days           = Opm::unit::convert::to(simulatorTimer.simulationTimeElapsed(), Opm::unit::day);
+
+        std::string type = "RFT";
+        ecl_rft_node_type * ecl_rft_node = ecl_rft_node_alloc_new(well_name.c_str(), type.c_str(), recording_date, days);
+
+        for (size_t c = 0; c < cells.size(); ++c) {
+            const RFTCell& cell = cells[c];
+            ecl_rft_cell_type * ecl_rft_cell = ecl_rft_cell_alloc_RFT( cell.i, cell.j, cell.k, cell.depth, pressure[c], swat[c], sgas[c]);
+            ecl_rft_node_append_cell( ecl_rft_node , ecl_rft_cell);
+        }
 
         return ecl_rft_node;
     }
 
 
     void EclipseWriteRFTHandler::initGlobalToActiveIndex(const int * compressedToCartesianCellIdx, size_t numCells, size_t cartesianSize) {
-        globalToActiveIndex_.resize(cartesianSize, -1);
-        for (size_t active_index = 0; active_index < numCells; ++active_index) {
-            //If compressedToCartesianCellIdx is NULL, assume no compressed to cartesian mapping, set global equal to active index
-            int global_index = (NULL != compressedToCartesianCellIdx) ? compressedToCartesianCellIdx[active_index] : active_index;
-            globalToActiveIndex_[global_index] = active_index;
-        }
+        //If compressedToCartesianCellIdx is NULL, assume no compressed to cartesian mapping, set global equal to active index
+        globalToActiveIndex_ = cartesianToCompressed(numCells, compressedToCartesianCellIdx, cartesianSize);
     }
 
 
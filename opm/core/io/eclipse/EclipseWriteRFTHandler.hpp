@@ -27,8 +27,13 @@
 #include <ert/ecl/ecl_rft_node.h>
 #include <ert/ecl/ecl_util.h>
 
+#include <map>
+#include <memory>
+#include <vector>
+
 
 namespace Opm {
+    class CompletionSet;
     class EclipseGrid;
     class Well;
 
@@ -54,17 +59,34 @@ namespace EclipseWriterDetails {
 
     private:
 
+    /// A completion in an active cell.
+    struct RFTCell {
+        int i, j, k;
+        int activeIndex;
+        double depth;
+    };
+    typedef std::vector<RFTCell> RFTCells;
+
+    const RFTCells& completionCells(std::shared_ptr< const CompletionSet > completions,
+                                    std::shared_ptr< const EclipseGrid > eclipseGrid);
+
     ecl_rft_node_type * createEclRFTNode(std::shared_ptr< const Well > well,
                                          const SimulatorTimerInterface& simulatorTimer,
-                                         std::shared_ptr< const EclipseGrid > eclipseGrid,
-                                         const std::vector<double>& pressure,
-                                         const std::vector<double>& swat,
-                                         const std::vector<double>& sgas);
+                                         const RFTCells& cells,
+                                         const double* pressure,
+                                         const double* swat,
+                                         const double* sgas);
 
     void initGlobalToActiveIndex(const int * compressedToCartesianCellIdx, size_t numCells, size_t cartesianSize);
 
     std::vector<int> globalToActiveIndex_;
 
+    // Active completion cells of each completion set seen so far. The
+    // schedule shares a completion set between the report steps where
+    // it is unchanged, so the cells of a well are only looked up when
+    // its completions change.
+    std::map<std::shared_ptr< const CompletionSet >, RFTCells> completionCells_;
+
     };
 
 
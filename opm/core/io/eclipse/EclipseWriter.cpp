@@ -38,6 +38,7 @@
 #include <opm/core/utility/parameters/Parameter.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/utility/Units.hpp>
+#include <opm/core/utility/compressedToCartesian.hpp>
 #include <opm/core/wells.h> // WellType
 
 #include <opm/parser/eclipse/Deck/DeckKeyword.hpp>
@@ -212,6 +213,38 @@ public:
 
     }
 
+    /// Allocate the keyword once for a number of values, to be
+    /// refilled by assignFromSi() every time it is written.
+    void allocate(const std::string& name, const int numEntries)
+    {
+        if(ertHandle_) {
+            ecl_kw_free(ertHandle_);
+        }
+        ertHandle_ = ecl_kw_alloc(name.c_str(), numEntries, ertType_());
+    }
+
+    /// Fill the keyword in a single pass from one component of striped
+    /// SI values, restricted and reordered to the active cells and
+    /// converted to deck units, as extractFromStripedData(),
+    /// convertFromSiTo() and restrictAndReorderToActiveCells() would.
+    /// If cells is null, the values are taken in their natural order.
+    void assignFromSi(const std::vector<double>& siValues,
+                      const int offset,
+                      const int stride,
+                      const int* cells,
+                      const double toSiConversionFactor = 1.0,
+                      const double toSiOffset = 0)
+    {
+        const int numEntries = ecl_kw_get_size(ertHandle_);
+        T* target = static_cast<T*>(ecl_kw_get_ptr(ertHandle_));
+        for (int i = 0; i < numEntries; ++i) {
+            const int cell = cells ? cells[i] : i;
+            assert(size_t(stride*cell + offset) < siValues.size());
+            target[i] = static_cast<T>(unit::convert::to(siValues[stride*cell + offset] - toSiOffset,
+                                                         toSiConversionFactor));
+        }
+    }
+
     ecl_kw_type *ertHandle() const
     { return ertHandle_; }
 
@@ -235,6 +268,20 @@ private:
     ecl_kw_type *ertHandle_;
 };
 
+/**
+ * Solution keywords of the restart files, allocated once in
+ * EclipseWriter::writeInit() and refilled for every restart step.
+ */
+struct SolutionKeywords : private boost::noncopyable
+{
+    Keyword<float> pressure;
+    Keyword<float> temperature;
+    Keyword<float> swat;
+    Keyword<float> sgas;
+    Keyword<float> rs;
+    Keyword<float> rv;
+};
+
 /**
  * Pointer to memory that holds the name to an Eclipse output file.
  */
@@ -452,10 +499,15 @@ public:
                                           nx,
                                           ny,
                                           nz);
+        mapReportStep_ = -1;
+        unwrittenSteps_ = false;
     }
 
     ~Summary()
-    { ecl_sum_free(ertHandle_); }
+    {
+        flush();
+        ecl_sum_free(ertHandle_);
+    }
 
     typedef std::unique_ptr<WellReport> SummaryReportVar;
     typedef std::vector<SummaryReportVar> SummaryReportVarCollection;
@@ -472,9 +524,22 @@ public:
     // add rate variables for each of the well in the input file
     void addAllWells(Opm::EclipseStateConstPtr eclipseState,
                      const PhaseUsage& uses);
+    // add the values of a time step, and write the summary file to
+    // disk if flushToDisk is true
     void writeTimeStep(int writeStepIdx,
                        const SimulatorTimerInterface& timer,
-                       const WellState& wellState);
+                       const WellState& wellState,
+                       bool flushToDisk);
+
+    // write the summary file to disk if any time steps have been
+    // added since it was last written
+    void flush()
+    {
+        if (unwrittenSteps_) {
+            ecl_sum_fwrite(ertHandle_);
+            unwrittenSteps_ = false;
+        }
+    }
 
     ecl_sum_type *ertHandle() const
     { return ertHandle_; }
@@ -482,6 +547,12 @@ public:
 private:
     ecl_sum_type *ertHandle_;
 
+    // index in the well state of the open wells, for the report step
+    // mapReportStep_
+    std::map<std::string, int> wellNameToIdxMap_;
+    int mapReportStep_;
+    bool unwrittenSteps_;
+
     Opm::EclipseStateConstPtr eclipseState_;
     SummaryReportVarCollection summaryReportVars_;
 };
@@ -1001,18 +1072,22 @@ private:
 // WellReport type being completed first
 void Summary::writeTimeStep(int writeStepIdx,
                             const SimulatorTimerInterface& timer,
-                            const WellState& wellState)
+                            const WellState& wellState,
+                            bool flushToDisk)
 {
-    // create a name -> well index map
-    const Opm::ScheduleConstPtr schedule = eclipseState_->getSchedule();
-    const auto& timeStepWells = schedule->getWells(timer.reportStepNum());
-    std::map<std::string, int> wellNameToIdxMap;
-    int openWellIdx = 0;
-    for (size_t tsWellIdx = 0; tsWellIdx < timeStepWells.size(); ++tsWellIdx) {
-        if (timeStepWells[tsWellIdx]->getStatus(timer.reportStepNum()) != WellCommon::SHUT ) {
-            wellNameToIdxMap[timeStepWells[tsWellIdx]->name()] = openWellIdx;
-            openWellIdx++;
+    // the name -> well index map only changes with the report step
+    if (timer.reportStepNum() != mapReportStep_) {
+        const Opm::ScheduleConstPtr schedule = eclipseState_->getSchedule();
+        const auto& timeStepWells = schedule->getWells(timer.reportStepNum());
+        wellNameToIdxMap_.clear();
+        int openWellIdx = 0;
+        for (size_t tsWellIdx = 0; tsWellIdx < timeStepWells.size(); ++tsWellIdx) {
+            if (timeStepWells[tsWellIdx]->getStatus(timer.reportStepNum()) != WellCommon::SHUT ) {
+                wellNameToIdxMap_[timeStepWells[tsWellIdx]->name()] = openWellIdx;
+                openWellIdx++;
+            }
         }
+        mapReportStep_ = timer.reportStepNum();
     }
 
     // internal view; do not move this code out of Summary!
@@ -1021,11 +1096,15 @@ void Summary::writeTimeStep(int writeStepIdx,
     for (auto varIt = summaryReportVars_.begin(); varIt != summaryReportVars_.end(); ++varIt) {
         ecl_sum_tstep_iset(tstep.ertHandle(),
                            smspec_node_get_params_index((*varIt)->ertHandle()),
-                           (*varIt)->retrieveValue(writeStepIdx, timer, wellState, wellNameToIdxMap));
+                           (*varIt)->retrieveValue(writeStepIdx, timer, wellState, wellNameToIdxMap_));
     }
+    unwrittenSteps_ = true;
 
-    // write the summary file to disk
-    ecl_sum_fwrite(ertHandle());
+    // ERT rewrites all time steps of the summary file, so writing it
+    // after every substep is quadratic in the number of steps
+    if (flushToDisk) {
+        flush();
+    }
 }
 
 void Summary::addAllWells(Opm::EclipseStateConstPtr eclipseState,
@@ -1204,6 +1283,18 @@ void EclipseWriter::writeInit(const SimulatorTimerInterface &timer)
         }
     }
 
+    {
+        const int numActive = gridToEclipseIdx_.size();
+        solutionKeywords_.reset(new EclipseWriterDetails::SolutionKeywords);
+        solutionKeywords_->pressure.allocate("PRESSURE", numActive);
+        solutionKeywords_->temperature.allocate("TEMP", numActive);
+        solutionKeywords_->swat.allocate(EclipseWriterDetails::saturationKeywordNames[BlackoilPhases::PhaseIndex::Aqua], numActive);
+        solutionKeywords_->sgas.allocate(EclipseWriterDetails::saturationKeywordNames[BlackoilPhases::PhaseIndex::Vapour], numActive);
+        // RS and RV are written in the order of the grid
+        solutionKeywords_->rs.allocate("RS", numCells_);
+        solutionKeywords_->rv.allocate("RV", numCells_);
+    }
+
     /* Create summary object (could not do it at construction time,
        since it requires knowledge of the start time). */
     {
@@ -1239,14 +1330,38 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
     }
 
 
-    std::vector<double> pressure = reservoirState.pressure();
-    EclipseWriterDetails::convertFromSiTo(pressure, deckToSiPressure_);
-    EclipseWriterDetails::restrictAndReorderToActiveCells(pressure, gridToEclipseIdx_.size(), gridToEclipseIdx_.data());
+    // in summary-only mode, the summary vectors are computed from the
+    // well state alone and the cell data is never looked at
+    if (summaryOnly_) {
+        summary_->writeTimeStep(writeStepIdx_, timer, wellState, !isSubstep);
+        ++writeStepIdx_;
+        reportStepIdx_ = timer.reportStepNum();
+        return;
+    }
+
+    IOConfigConstPtr ioConfig = eclipseState_->getIOConfigConst();
+    std::vector<WellConstPtr> wells = eclipseState_->getSchedule()->getWells(timer.reportStepNum());
+
+    // only the RFT file needs the converted and reordered arrays,
+    // the restart keywords are filled directly from the state
+    bool rftActive = false;
+    for (const auto& well : wells) {
+        rftActive = rftActive
+            || well->getRFTActive(timer.reportStepNum())
+            || well->getPLTActive(timer.reportStepNum());
+    }
 
+    std::vector<double> pressure;
     std::vector<double> saturation_water;
     std::vector<double> saturation_gas;
 
-    if (phaseUsage_.phase_used[BlackoilPhases::Aqua]) {
+    if (rftActive) {
+        pressure = reservoirState.pressure();
+        EclipseWriterDetails::convertFromSiTo(pressure, deckToSiPressure_);
+        EclipseWriterDetails::restrictAndReorderToActiveCells(pressure, gridToEclipseIdx_.size(), gridToEclipseIdx_.data());
+    }
+
+    if (rftActive && phaseUsage_.phase_used[BlackoilPhases::Aqua]) {
         saturation_water = reservoirState.saturation();
         EclipseWriterDetails::extractFromStripedData(saturation_water,
                                                      /*offset=*/phaseUsage_.phase_pos[BlackoilPhases::Aqua],
@@ -1255,7 +1370,7 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
     }
 
 
-    if (phaseUsage_.phase_used[BlackoilPhases::Vapour]) {
+    if (rftActive && phaseUsage_.phase_used[BlackoilPhases::Vapour]) {
         saturation_gas = reservoirState.saturation();
         EclipseWriterDetails::extractFromStripedData(saturation_gas,
                                                      /*offset=*/phaseUsage_.phase_pos[BlackoilPhases::Vapour],
@@ -1264,10 +1379,6 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
     }
 
 
-
-    IOConfigConstPtr ioConfig = eclipseState_->getIOConfigConst();
-
-
     // Write restart file
     if(!isSubstep && ioConfig->getWriteRestartFile(timer.reportStepNum()))
     {
@@ -1328,48 +1439,57 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
 
 
         EclipseWriterDetails::Solution sol(restartHandle);
-        sol.add(EclipseWriterDetails::Keyword<float>("PRESSURE", pressure));
+        EclipseWriterDetails::SolutionKeywords& kw = *solutionKeywords_;
+        const int* eclipseOrder = gridToEclipseIdx_.data();
+        kw.pressure.assignFromSi(reservoirState.pressure(), 0, 1, eclipseOrder, deckToSiPressure_);
+        sol.add(kw.pressure);
 
 
         // write the cell temperature
-        std::vector<double> temperature = reservoirState.temperature();
-        EclipseWriterDetails::convertFromSiTo(temperature, deckToSiTemperatureFactor_, deckToSiTemperatureOffset_);
-        EclipseWriterDetails::restrictAndReorderToActiveCells(temperature, gridToEclipseIdx_.size(), gridToEclipseIdx_.data());
-        sol.add(EclipseWriterDetails::Keyword<float>("TEMP", temperature));
+        kw.temperature.assignFromSi(reservoirState.temperature(), 0, 1, eclipseOrder,
+                                    deckToSiTemperatureFactor_, deckToSiTemperatureOffset_);
+        sol.add(kw.temperature);
 
 
         if (phaseUsage_.phase_used[BlackoilPhases::Aqua]) {
-            sol.add(EclipseWriterDetails::Keyword<float>(EclipseWriterDetails::saturationKeywordNames[BlackoilPhases::PhaseIndex::Aqua], saturation_water));
+            kw.swat.assignFromSi(reservoirState.saturation(),
+                                 /*offset=*/phaseUsage_.phase_pos[BlackoilPhases::Aqua],
+                                 /*stride=*/phaseUsage_.num_phases,
+                                 eclipseOrder);
+            sol.add(kw.swat);
         }
 
 
         if (phaseUsage_.phase_used[BlackoilPhases::Vapour]) {
-            sol.add(EclipseWriterDetails::Keyword<float>(EclipseWriterDetails::saturationKeywordNames[BlackoilPhases::PhaseIndex::Vapour], saturation_gas));
+            kw.sgas.assignFromSi(reservoirState.saturation(),
+                                 /*offset=*/phaseUsage_.phase_pos[BlackoilPhases::Vapour],
+                                 /*stride=*/phaseUsage_.num_phases,
+                                 eclipseOrder);
+            sol.add(kw.sgas);
         }
 
 
         // Write RS - Dissolved GOR
         if (reservoirState.hasCellData( BlackoilState::GASOILRATIO )) {
-            const std::vector<double>& rs = reservoirState.getCellData( BlackoilState::GASOILRATIO );
-            sol.add(EclipseWriterDetails::Keyword<float>("RS", rs));
+            kw.rs.assignFromSi(reservoirState.getCellData( BlackoilState::GASOILRATIO ), 0, 1, 0);
+            sol.add(kw.rs);
         }
 
         // Write RV - Volatilized oil/gas ratio
         if (reservoirState.hasCellData( BlackoilState::RV )) {
-            const std::vector<double>& rv = reservoirState.getCellData( BlackoilState::RV );
-            sol.add(EclipseWriterDetails::Keyword<float>("RV", rv));
+            kw.rv.assignFromSi(reservoirState.getCellData( BlackoilState::RV ), 0, 1, 0);
+            sol.add(kw.rv);
         }
     }
 
 
     //Write RFT data for current timestep to RFT file
-    std::shared_ptr<EclipseWriterDetails::EclipseWriteRFTHandler> eclipseWriteRFTHandler = std::make_shared<EclipseWriterDetails::EclipseWriteRFTHandler>(
-                                                                                                                      compressedToCartesianCellIdx_,
-                                                                                                                      numCells_,
-                                                                                                                      eclipseState_->getEclipseGrid()->getCartesianSize());
-
-    // Write RFT file.
-    {
+    if (rftActive) {
+        if (!rftHandler_) {
+            rftHandler_.reset(new EclipseWriterDetails::EclipseWriteRFTHandler(compressedToCartesianCellIdx_,
+                                                                               numCells_,
+                                                                               eclipseState_->getEclipseGrid()->getCartesianSize()));
+        }
         char * rft_filename = ecl_util_alloc_filename(outputDir_.c_str(),
                                                       baseName_.c_str(),
                                                       ECL_RFT_FILE,
@@ -1377,15 +1497,14 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
                                                       0);
         auto unit_type = eclipseState_->getDeckUnitSystem().getType();
         ert_ecl_unit_enum ecl_unit = convertUnitTypeErtEclUnitEnum(unit_type);
-        std::vector<WellConstPtr> wells = eclipseState_->getSchedule()->getWells(timer.reportStepNum());
-        eclipseWriteRFTHandler->writeTimeStep(rft_filename,
-                                              ecl_unit,
-                                              timer,
-                                              wells,
-                                              eclipseState_->getEclipseGrid(),
-                                              pressure,
-                                              saturation_water,
-                                              saturation_gas);
+        rftHandler_->writeTimeStep(rft_filename,
+                                   ecl_unit,
+                                   timer,
+                                   wells,
+                                   eclipseState_->getEclipseGrid(),
+                                   pressure,
+                                   saturation_water,
+                                   saturation_gas);
         free( rft_filename );
     }
 
@@ -1401,7 +1520,7 @@ void EclipseWriter::writeTimeStep(const SimulatorTimerInterface& timer,
     // instead of creating a temporary EclipseWriterDetails::Summary in this function
     // every time it is called.  This has been changed so that the final summary file
     // will contain data from the whole simulation, instead of just the last step.
-    summary_->writeTimeStep(writeStepIdx_, timer, wellState);
+    summary_->writeTimeStep(writeStepIdx_, timer, wellState, !isSubstep);
 
     ++writeStepIdx_;
     // store current report index
@@ -1427,16 +1546,17 @@ EclipseWriter::EclipseWriter(const parameter::ParameterGroup& params,
 
     if( compressedToCartesianCellIdx ) {
         // if compressedToCartesianCellIdx available then
-        // compute mapping to eclipse order
-        std::map< int , int > indexMap;
-        for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
-            int cartesianCellIdx = compressedToCartesianCellIdx[cellIdx];
-            indexMap[ cartesianCellIdx ] = cellIdx;
-        }
+        // compute mapping to eclipse order, i.e., the active
+        // cells ordered by their cartesian index
+        const std::vector<int> cartesianToActive =
+            cartesianToCompressed(numCells, compressedToCartesianCellIdx,
+                                  cartesianSize_[0]*cartesianSize_[1]*cartesianSize_[2]);
 
         int idx = 0;
-        for( auto it = indexMap.begin(), end = indexMap.end(); it != end; ++it ) {
-            gridToEclipseIdx_[ idx++ ] = (*it).second;
+        for (const int cellIdx : cartesianToActive) {
+            if (cellIdx >= 0) {
+                gridToEclipseIdx_[ idx++ ] = cellIdx;
+            }
         }
     }
     else {
@@ -1479,6 +1599,9 @@ void EclipseWriter::init(const parameter::ParameterGroup& params)
     // retrieve the value of the "output" parameter
     enableOutput_ = params.getDefault<bool>("output", /*defaultValue=*/true);
 
+    // write only the summary file, no restart or RFT files
+    summaryOnly_ = params.getDefault<bool>("output_ecl_summary_only", /*defaultValue=*/false);
+
     // store in current directory if not explicitly set
     outputDir_ = params.getDefault<std::string>("output_dir", ".");
 
@@ -45,6 +45,8 @@ namespace Opm {
 // forward declarations
 namespace EclipseWriterDetails {
 class Summary;
+struct SolutionKeywords;
+class EclipseWriteRFTHandler;
 }
 
 class SimulationDataContainer;
@@ -60,6 +62,11 @@ namespace parameter { class ParameterGroup; }
  * to 1. It needs the ERT libraries to write to disk, so if the
  * 'write_output' parameter is set but ERT is not available, all
  * methods throw a std::runtime_error.
+ *
+ * Restart files are written at the report steps requested by RPTRST,
+ * and the summary file is written to disk at every report step. If
+ * the 'output_ecl_summary_only' parameter is true, only the summary
+ * file is written, and the reservoir state is not looked at.
  */
 class EclipseWriter : public OutputWriter
 {
@@ -120,12 +127,18 @@ private:
     double deckToSiTemperatureFactor_;
     double deckToSiTemperatureOffset_;
     bool enableOutput_;
+    bool summaryOnly_;
     int writeStepIdx_;
     int reportStepIdx_;
     std::string outputDir_;
     std::string baseName_;
     PhaseUsage phaseUsage_; // active phases in the input deck
     std::shared_ptr<EclipseWriterDetails::Summary> summary_;
+    // restart keywords allocated in writeInit() and reused for every step
+    std::shared_ptr<EclipseWriterDetails::SolutionKeywords> solutionKeywords_;
+    // created at the first RFT output and kept, with the completion
+    // cells it has looked up
+    std::shared_ptr<EclipseWriterDetails::EclipseWriteRFTHandler> rftHandler_;
 
     void init(const parameter::ParameterGroup& params);
 };
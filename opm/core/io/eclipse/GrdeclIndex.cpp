@@ -0,0 +1,402 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define GRDECL_INDEX_HAVE_MMAP 1
+#else
+#define GRDECL_INDEX_HAVE_MMAP 0
+#endif
+
+#include "config.h"
+#include <opm/core/io/eclipse/GrdeclIndex.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#if GRDECL_INDEX_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Opm
+{
+
+    namespace
+    {
+        // values between recorded positions in a data section
+        const std::size_t checkpointDistance = 8192;
+
+        // A value token of a data section, possibly with a repeat
+        // count, as in 3*0.25.
+        struct Token
+        {
+            std::size_t end;        // position after the token
+            std::size_t repeat;     // number of values
+            std::size_t valueBegin; // the value without the repeat count
+            std::size_t valueEnd;
+        };
+
+        bool isBlank(const char c)
+        {
+            return std::isspace(static_cast<unsigned char>(c)) != 0;
+        }
+
+        // Skip white space and comments.
+        std::size_t skipBlank(const char* data, const std::size_t size, std::size_t pos)
+        {
+            while (pos < size) {
+                if (isBlank(data[pos])) {
+                    ++pos;
+                } else if (data[pos] == '-' && pos + 1 < size && data[pos + 1] == '-') {
+                    while (pos < size && data[pos] != '\n') {
+                        ++pos;
+                    }
+                } else {
+                    break;
+                }
+            }
+            return pos;
+        }
+
+        // Whether a data section starts at pos.
+        bool startsData(const char c)
+        {
+            return std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '+'
+                || c == '.' || c == '\'' || c == '/';
+        }
+
+        // Read the value token starting at pos, which must not be
+        // blank or a slash.
+        Token lexToken(const char* data, const std::size_t size, const std::size_t pos)
+        {
+            Token t;
+            t.repeat = 1;
+            t.valueBegin = pos;
+            if (data[pos] == '\'') {
+                const char* close = static_cast<const char*>(std::memchr(data + pos + 1, '\'', size - pos - 1));
+                if (!close) {
+                    throw std::runtime_error("unterminated string");
+                }
+                t.end = close - data + 1;
+                t.valueEnd = t.end;
+                return t;
+            }
+            std::size_t end = pos;
+            std::size_t star = size;
+            while (end < size && !isBlank(data[end]) && data[end] != '/') {
+                if (data[end] == '*' && star == size) {
+                    star = end;
+                }
+                ++end;
+            }
+            t.end = end;
+            t.valueEnd = end;
+            if (star != size) {
+                bool digits = star > pos;
+                std::size_t repeat = 0;
+                for (std::size_t i = pos; i < star && digits; ++i) {
+                    digits = std::isdigit(static_cast<unsigned char>(data[i])) != 0;
+                    repeat = 10*repeat + (data[i] - '0');
+                }
+                if (digits) {
+                    t.repeat = repeat;
+                    t.valueBegin = star + 1;
+                }
+            }
+            return t;
+        }
+
+        double decodeToken(const char* data, const Token& t, const std::string& keyword)
+        {
+            char buf[64];
+            const std::size_t n = t.valueEnd - t.valueBegin;
+            if (n == 0 || n >= sizeof buf) {
+                OPM_THROW(std::runtime_error, "GrdeclIndex: value '"
+                          << std::string(data + t.valueBegin, n) << "' of " << keyword
+                          << " is defaulted or not a number");
+            }
+            // Fortran double precision exponents, as in 1.0D+03
+            for (std::size_t i = 0; i < n; ++i) {
+                const char c = data[t.valueBegin + i];
+                buf[i] = (c == 'D' || c == 'd') ? 'E' : c;
+            }
+            buf[n] = '\0';
+            char* end;
+            const double value = std::strtod(buf, &end);
+            if (end != buf + n) {
+                OPM_THROW(std::runtime_error, "GrdeclIndex: value '" << buf << "' of "
+                          << keyword << " is not a number");
+            }
+            return value;
+        }
+    } // anonymous namespace
+
+
+
+
+    GrdeclIndex::GrdeclIndex(const std::string& filename)
+        : filename_(filename)
+        , data_(0)
+        , size_(0)
+        , mapped_(false)
+    {
+#if GRDECL_INDEX_HAVE_MMAP
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            OPM_THROW(std::runtime_error, "GrdeclIndex: could not open " << filename);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_ = static_cast<std::size_t>(st.st_size);
+            void* addr = ::mmap(0, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const char*>(addr);
+                mapped_ = true;
+            }
+        }
+        ::close(fd);
+#endif
+        if (!mapped_) {
+            // no mmap() on this platform, or it failed: read the file
+            std::ifstream is(filename.c_str(), std::ios::binary);
+            if (!is) {
+                OPM_THROW(std::runtime_error, "GrdeclIndex: could not open " << filename);
+            }
+            buffer_.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+        }
+
+        try {
+            buildIndex();
+        }
+        catch (...) {
+#if GRDECL_INDEX_HAVE_MMAP
+            if (mapped_) {
+                ::munmap(const_cast<char*>(data_), size_);
+            }
+#endif
+            throw;
+        }
+    }
+
+
+
+
+    GrdeclIndex::~GrdeclIndex()
+    {
+#if GRDECL_INDEX_HAVE_MMAP
+        if (mapped_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+
+
+
+    bool GrdeclIndex::hasKeyword(const std::string& name) const
+    {
+        for (const auto& kw : keywords_) {
+            if (kw.name == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+
+
+    std::size_t GrdeclIndex::size(const std::string& name) const
+    {
+        return keyword(name).size;
+    }
+
+
+
+
+    std::vector<double> GrdeclIndex::read(const std::string& name,
+                                          const std::size_t begin,
+                                          const std::size_t end) const
+    {
+        return read(name, std::vector<std::pair<std::size_t, std::size_t> >(1, std::make_pair(begin, end)));
+    }
+
+
+
+
+    std::vector<double>
+    GrdeclIndex::read(const std::string& name,
+                      const std::vector<std::pair<std::size_t, std::size_t> >& ranges) const
+    {
+        const Keyword& kw = keyword(name);
+        std::size_t total = 0;
+        std::size_t previousEnd = 0;
+        for (const auto& range : ranges) {
+            if (range.first < previousEnd || range.second < range.first || range.second > kw.size) {
+                OPM_THROW(std::runtime_error, "GrdeclIndex: values [" << range.first << ", "
+                          << range.second << ") of " << name << " with " << kw.size
+                          << " values are out of range or order");
+            }
+            total += range.second - range.first;
+            previousEnd = range.second;
+        }
+
+        std::vector<double> values;
+        values.reserve(total);
+
+        // position and value index of the next token to read
+        bool started = false;
+        std::size_t pos = 0;
+        std::size_t value = 0;
+        for (const auto& range : ranges) {
+            const std::size_t b = range.first;
+            const std::size_t e = range.second;
+            if (b == e) {
+                continue;
+            }
+
+            // resume from a recorded position if it is closer
+            auto cp = std::upper_bound(kw.checkpoints.begin(), kw.checkpoints.end(),
+                                       std::make_pair(b, std::numeric_limits<std::size_t>::max()));
+            --cp;
+            if (!started || cp->first > value) {
+                value = cp->first;
+                pos = cp->second;
+                started = true;
+            }
+
+            for (;;) {
+                pos = skipBlank(data_, size_, pos);
+                const Token t = lexToken(data_, size_, pos);
+                const std::size_t tokenEnd = value + t.repeat;
+                if (tokenEnd > b) {
+                    const double v = decodeToken(data_, t, name);
+                    values.insert(values.end(), std::min(tokenEnd, e) - std::max(value, b), v);
+                }
+                if (tokenEnd > e) {
+                    // the next range may start in the same token
+                    break;
+                }
+                pos = t.end;
+                value = tokenEnd;
+                if (tokenEnd == e) {
+                    break;
+                }
+            }
+        }
+        return values;
+    }
+
+
+
+
+    void GrdeclIndex::scan(const std::string& name,
+                           const std::function<void(std::size_t, const double*, std::size_t)>& visitor) const
+    {
+        const std::size_t n = size(name);
+        std::vector<std::pair<std::size_t, std::size_t> > ranges;
+        for (std::size_t begin = 0; begin < n; begin += checkpointDistance) {
+            ranges.emplace_back(begin, std::min(begin + checkpointDistance, n));
+        }
+        // read a block of ranges at a time, to bound the memory use
+        const std::size_t rangesPerBlock = 128;
+        for (std::size_t r = 0; r < ranges.size(); r += rangesPerBlock) {
+            const std::vector<std::pair<std::size_t, std::size_t> >
+                block(ranges.begin() + r, ranges.begin() + std::min(r + rangesPerBlock, ranges.size()));
+            const std::vector<double> values = read(name, block);
+            visitor(block.front().first, values.data(), values.size());
+        }
+    }
+
+
+
+
+    void GrdeclIndex::buildIndex()
+    {
+        std::size_t pos = skipBlank(data_, size_, 0);
+        while (pos < size_) {
+            if (data_[pos] == '/') {
+                // end of a record of a keyword with data in several records
+                pos = skipBlank(data_, size_, pos + 1);
+                continue;
+            }
+            std::size_t end = pos;
+            while (end < size_ && !isBlank(data_[end]) && data_[end] != '/') {
+                ++end;
+            }
+            Keyword kw;
+            kw.name.assign(data_ + pos, end - pos);
+            kw.size = 0;
+            pos = skipBlank(data_, size_, end);
+            if (pos < size_ && startsData(data_[pos])) {
+                try {
+                    std::size_t nextCheckpoint = 0;
+                    while (pos < size_ && data_[pos] != '/') {
+                        const Token t = lexToken(data_, size_, pos);
+                        if (kw.size >= nextCheckpoint) {
+                            kw.checkpoints.emplace_back(kw.size, pos);
+                            nextCheckpoint = kw.size + checkpointDistance;
+                        }
+                        kw.size += t.repeat;
+                        pos = skipBlank(data_, size_, t.end);
+                    }
+                }
+                catch (const std::runtime_error& e) {
+                    OPM_THROW(std::runtime_error, "GrdeclIndex: " << e.what() << " in data of "
+                              << kw.name << " in " << filename_);
+                }
+                if (pos >= size_) {
+                    OPM_THROW(std::runtime_error, "GrdeclIndex: data of " << kw.name << " in "
+                              << filename_ << " is not terminated by a slash");
+                }
+                pos = skipBlank(data_, size_, pos + 1);
+            }
+            if (kw.checkpoints.empty()) {
+                kw.checkpoints.emplace_back(0, pos);
+            }
+            keywords_.push_back(kw);
+        }
+    }
+
+
+
+
+    const GrdeclIndex::Keyword& GrdeclIndex::keyword(const std::string& name) const
+    {
+        for (auto kw = keywords_.rbegin(); kw != keywords_.rend(); ++kw) {
+            if (kw->name == name) {
+                return *kw;
+            }
+        }
+        OPM_THROW(std::runtime_error, "GrdeclIndex: keyword " << name << " not found in " << filename_);
+    }
+
+} // namespace Opm
@@ -0,0 +1,109 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_GRDECLINDEX_HEADER_INCLUDED
+#define OPM_GRDECLINDEX_HEADER_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Index of the keywords of a GRDECL text file, for reading parts
+    /// of large arrays such as ZCORN without parsing and storing the
+    /// whole array.
+    ///
+    /// The file is memory mapped, and one pass over it finds each
+    /// keyword and its number of values, expanding repeat counts
+    /// such as 3*0.25. Every few thousand values the position in the
+    /// file is recorded, so that a range of values is read by parsing
+    /// from the nearest recorded position only. Numbers are converted
+    /// only when they are read.
+    ///
+    /// Only the file itself is indexed: INCLUDE and other keywords
+    /// which change how the rest of the input is read are not
+    /// interpreted. A keyword has data if it is followed by a number,
+    /// a repeat count, a quoted string or a slash, and only its first
+    /// record is indexed.
+    class GrdeclIndex
+    {
+    public:
+        /// Map a file and index its keywords. Throws
+        /// std::runtime_error if the file cannot be read or a data
+        /// section has no terminating slash.
+        explicit GrdeclIndex(const std::string& filename);
+
+        ~GrdeclIndex();
+
+        GrdeclIndex(const GrdeclIndex&) = delete;
+        GrdeclIndex& operator=(const GrdeclIndex&) = delete;
+
+        /// Whether the file has a keyword. If it appears more than
+        /// once, the last occurrence is used, as for the deck.
+        bool hasKeyword(const std::string& name) const;
+
+        /// Number of values of a keyword.
+        std::size_t size(const std::string& name) const;
+
+        /// Values [begin, end) of a keyword.
+        std::vector<double> read(const std::string& name,
+                                 const std::size_t begin,
+                                 const std::size_t end) const;
+
+        /// Values of a list of increasing, non-overlapping ranges of
+        /// a keyword, concatenated. Gaps of less than the distance
+        /// between the recorded positions are parsed over; longer
+        /// gaps are skipped.
+        std::vector<double> read(const std::string& name,
+                                 const std::vector<std::pair<std::size_t, std::size_t> >& ranges) const;
+
+        /// Pass all values of a keyword in order to a visitor, about a
+        /// million at a time, as visitor(first index, values, count).
+        void scan(const std::string& name,
+                  const std::function<void(std::size_t, const double*, std::size_t)>& visitor) const;
+
+    private:
+        struct Keyword
+        {
+            std::string name;
+            std::size_t size;
+            // (value index, byte offset) of the token starting at every
+            // checkpointDistance'th value or later
+            std::vector<std::pair<std::size_t, std::size_t> > checkpoints;
+        };
+
+        std::string filename_;
+        const char* data_;
+        std::size_t size_;
+        bool mapped_;
+        std::vector<char> buffer_;
+        std::vector<Keyword> keywords_;
+
+        void buildIndex();
+        const Keyword& keyword(const std::string& name) const;
+    };
+
+} // namespace Opm
+
+#endif // OPM_GRDECLINDEX_HEADER_INCLUDED
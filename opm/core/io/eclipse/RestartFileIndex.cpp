@@ -0,0 +1,313 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define RESTART_FILE_INDEX_HAVE_MMAP 1
+#else
+#define RESTART_FILE_INDEX_HAVE_MMAP 0
+#endif
+
+#include "config.h"
+#include <opm/core/io/eclipse/RestartFileIndex.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if RESTART_FILE_INDEX_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Opm
+{
+
+    namespace
+    {
+        // Unformatted Eclipse files are sequences of Fortran records,
+        // each framed by its length in bytes as a big-endian 32-bit
+        // integer. A keyword is a 16 byte header record (name, number
+        // of values, type) followed by its values in records of at
+        // most 1000 values, or 105 for character types.
+        const std::size_t headerSize = 16;
+
+        std::uint32_t bigEndian32(const unsigned char* p)
+        {
+            return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16)
+                | (std::uint32_t(p[2]) << 8) | std::uint32_t(p[3]);
+        }
+
+        std::uint64_t bigEndian64(const unsigned char* p)
+        {
+            return (std::uint64_t(bigEndian32(p)) << 32) | bigEndian32(p + 4);
+        }
+
+        double decodeValue(const unsigned char* p, const char type)
+        {
+            switch (type) {
+            case 'R': {
+                const std::uint32_t bits = bigEndian32(p);
+                float value;
+                std::memcpy(&value, &bits, sizeof value);
+                return value;
+            }
+            case 'D': {
+                const std::uint64_t bits = bigEndian64(p);
+                double value;
+                std::memcpy(&value, &bits, sizeof value);
+                return value;
+            }
+            default:
+                return static_cast<std::int32_t>(bigEndian32(p));
+            }
+        }
+
+        // Bytes per value and values per record of an Eclipse type.
+        bool typeLayout(const std::string& type, std::size_t& elemSize, std::size_t& blockSize)
+        {
+            blockSize = 1000;
+            if (type == "REAL" || type == "INTE" || type == "LOGI") {
+                elemSize = 4;
+            } else if (type == "DOUB") {
+                elemSize = 8;
+            } else if (type == "MESS") {
+                elemSize = 0;
+            } else if (type == "CHAR") {
+                elemSize = 8;
+                blockSize = 105;
+            } else if (type.size() == 4 && type[0] == 'C'
+                       && std::isdigit(type[1]) && std::isdigit(type[2]) && std::isdigit(type[3])) {
+                elemSize = std::stoi(type.substr(1));
+                blockSize = 105;
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        std::string trimmed(const unsigned char* p, const std::size_t n)
+        {
+            std::string s(reinterpret_cast<const char*>(p), n);
+            s.erase(s.find_last_not_of(' ') + 1);
+            return s;
+        }
+    } // anonymous namespace
+
+
+
+
+    RestartFileIndex::RestartFileIndex(const std::string& filename)
+        : filename_(filename)
+        , data_(0)
+        , size_(0)
+        , mapped_(false)
+    {
+#if RESTART_FILE_INDEX_HAVE_MMAP
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            OPM_THROW(std::runtime_error, "Restart file " << filename << " not found!");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            OPM_THROW(std::runtime_error, "Could not stat restart file " << filename);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(0, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const unsigned char*>(addr);
+                mapped_ = true;
+            }
+        }
+        ::close(fd);
+#endif
+        if (!mapped_) {
+            // no mmap() on this platform, or it failed: read the file
+            std::ifstream is(filename.c_str(), std::ios::binary);
+            if (!is) {
+                OPM_THROW(std::runtime_error, "Restart file " << filename << " not found!");
+            }
+            buffer_.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+        }
+
+        try {
+            buildIndex();
+        }
+        catch (...) {
+#if RESTART_FILE_INDEX_HAVE_MMAP
+            if (mapped_) {
+                ::munmap(const_cast<unsigned char*>(data_), size_);
+            }
+#endif
+            throw;
+        }
+    }
+
+
+
+
+    RestartFileIndex::~RestartFileIndex()
+    {
+#if RESTART_FILE_INDEX_HAVE_MMAP
+        if (mapped_) {
+            ::munmap(const_cast<unsigned char*>(data_), size_);
+        }
+#endif
+    }
+
+
+
+
+    bool RestartFileIndex::isUnformatted(const std::string& filename)
+    {
+        std::ifstream is(filename.c_str(), std::ios::binary);
+        unsigned char marker[4];
+        if (!is.read(reinterpret_cast<char*>(marker), sizeof marker)) {
+            return false;
+        }
+        return bigEndian32(marker) == headerSize;
+    }
+
+
+
+
+    bool RestartFileIndex::hasReportStep(const int reportStep) const
+    {
+        for (const auto& kw : keywords_) {
+            if (kw.name == "SEQNUM" && kw.reportStep == reportStep) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+
+
+    const RestartFileIndex::Keyword*
+    RestartFileIndex::find(const std::string& name, const int reportStep) const
+    {
+        for (const auto& kw : keywords_) {
+            if (kw.name == name && (reportStep < 0 || kw.reportStep == reportStep)) {
+                return &kw;
+            }
+        }
+        return 0;
+    }
+
+
+
+
+    void RestartFileIndex::read(const Keyword& kw,
+                                const int begin,
+                                const int count,
+                                double* dest,
+                                const int stride,
+                                const double scale,
+                                const double offset) const
+    {
+        if (kw.type != "REAL" && kw.type != "DOUB" && kw.type != "INTE") {
+            OPM_THROW(std::runtime_error, "Keyword " << kw.name << " of " << filename_
+                      << " has type " << kw.type << ", not a numeric type");
+        }
+        if (begin < 0 || count < 0 || begin + count > kw.count) {
+            OPM_THROW(std::runtime_error, "Values [" << begin << ", " << begin + count
+                      << ") requested from keyword " << kw.name << " with " << kw.count << " values");
+        }
+
+        // walk the records overlapping the requested range
+        const char type = kw.type[0];
+        const std::size_t recordBytes = kw.blockSize*kw.elemSize + 8;
+        int i = begin;
+        while (i < begin + count) {
+            const std::size_t block = std::size_t(i) / kw.blockSize;
+            const std::size_t first = block*kw.blockSize;
+            const std::size_t inBlock = std::min(kw.blockSize, std::size_t(kw.count) - first);
+            const unsigned char* record = data_ + kw.offset + block*recordBytes;
+            if (bigEndian32(record) != inBlock*kw.elemSize) {
+                OPM_THROW(std::runtime_error, "Corrupt data record of keyword " << kw.name
+                          << " in " << filename_);
+            }
+            const std::size_t end = std::min(first + inBlock, std::size_t(begin + count));
+            const unsigned char* p = record + 4 + (i - first)*kw.elemSize;
+            for (; std::size_t(i) < end; ++i, p += kw.elemSize, dest += stride) {
+                *dest = (decodeValue(p, type) - offset)*scale;
+            }
+        }
+    }
+
+
+
+
+    void RestartFileIndex::buildIndex()
+    {
+        std::size_t pos = 0;
+        int reportStep = -1;
+        while (pos < size_) {
+            if (pos + headerSize + 8 > size_
+                || bigEndian32(data_ + pos) != headerSize
+                || bigEndian32(data_ + pos + 4 + headerSize) != headerSize) {
+                OPM_THROW(std::runtime_error, filename_ << " is not an unformatted Eclipse file"
+                          " (bad keyword header at byte " << pos << ")");
+            }
+            const unsigned char* header = data_ + pos + 4;
+            Keyword kw;
+            kw.name = trimmed(header, 8);
+            kw.count = static_cast<std::int32_t>(bigEndian32(header + 8));
+            kw.type = std::string(reinterpret_cast<const char*>(header + 12), 4);
+            if (kw.count < 0 || !typeLayout(kw.type, kw.elemSize, kw.blockSize)) {
+                OPM_THROW(std::runtime_error, "Keyword " << kw.name << " in " << filename_
+                          << " has unknown type " << kw.type << " or size " << kw.count);
+            }
+            pos += headerSize + 8;
+            kw.offset = pos;
+
+            // the data records follow from the count and type alone, so
+            // that their contents need not be paged in
+            if (kw.count > 0 && kw.elemSize > 0) {
+                const std::size_t numBlocks = (std::size_t(kw.count) + kw.blockSize - 1) / kw.blockSize;
+                pos += std::size_t(kw.count)*kw.elemSize + 8*numBlocks;
+                if (pos > size_) {
+                    OPM_THROW(std::runtime_error, "Keyword " << kw.name << " in " << filename_
+                              << " is truncated");
+                }
+            }
+
+            if (kw.name == "SEQNUM" && kw.count > 0 && kw.type == "INTE") {
+                double step;
+                read(kw, 0, 1, &step);
+                reportStep = static_cast<int>(step);
+            }
+            kw.reportStep = reportStep;
+            keywords_.push_back(kw);
+        }
+    }
+
+} // namespace Opm
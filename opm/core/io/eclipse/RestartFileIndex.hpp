@@ -0,0 +1,106 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_RESTARTFILEINDEX_HEADER_INCLUDED
+#define OPM_RESTARTFILEINDEX_HEADER_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Index of the keywords of an unformatted (binary) Eclipse
+    /// restart file, for reading a few keywords without loading the
+    /// rest of the file.
+    ///
+    /// The file is memory mapped, and only the keyword headers are
+    /// read to build the index, so opening even a large unified
+    /// restart file touches a few pages per keyword. The data of a
+    /// keyword is decoded only when read(), which converts the
+    /// big-endian values while copying them to their destination.
+    ///
+    /// The keywords of a unified restart file belong to the report
+    /// step of the last preceding SEQNUM keyword.
+    class RestartFileIndex
+    {
+    public:
+        /// A keyword of the file.
+        struct Keyword
+        {
+            std::string name;      //!< Name without trailing blanks.
+            std::string type;      //!< Eclipse type, e.g. "REAL" or "DOUB".
+            int count;             //!< Number of values.
+            int reportStep;        //!< Report step of the SEQNUM block, or -1.
+            std::size_t elemSize;  //!< Bytes per value.
+            std::size_t blockSize; //!< Values per record.
+            std::size_t offset;    //!< Position of the first data record.
+        };
+
+        /// Map a file and index its keywords. Throws
+        /// std::runtime_error if the file cannot be mapped or is not
+        /// a well-formed unformatted Eclipse file.
+        explicit RestartFileIndex(const std::string& filename);
+
+        ~RestartFileIndex();
+
+        RestartFileIndex(const RestartFileIndex&) = delete;
+        RestartFileIndex& operator=(const RestartFileIndex&) = delete;
+
+        /// Whether a file looks like an unformatted Eclipse file,
+        /// i.e. starts with a keyword header record.
+        static bool isUnformatted(const std::string& filename);
+
+        /// Whether a unified file has a SEQNUM block for the report step.
+        bool hasReportStep(const int reportStep) const;
+
+        /// First keyword of the given name in a report step, or null.
+        /// A negative report step searches the whole file.
+        const Keyword* find(const std::string& name, const int reportStep) const;
+
+        /// All keywords in file order.
+        const std::vector<Keyword>& keywords() const { return keywords_; }
+
+        /// Decode values [begin, begin + count) of a REAL, DOUB or
+        /// INTE keyword, and store (value - offset)*scale in
+        /// dest[0], dest[stride], ...
+        void read(const Keyword& kw,
+                  const int begin,
+                  const int count,
+                  double* dest,
+                  const int stride = 1,
+                  const double scale = 1.0,
+                  const double offset = 0.0) const;
+
+    private:
+        std::string filename_;
+        const unsigned char* data_;
+        std::size_t size_;
+        bool mapped_;
+        std::vector<unsigned char> buffer_;
+        std::vector<Keyword> keywords_;
+
+        void buildIndex();
+    };
+
+} // namespace Opm
+
+#endif // OPM_RESTARTFILEINDEX_HEADER_INCLUDED
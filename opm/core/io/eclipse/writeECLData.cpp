@@ -41,18 +41,18 @@ namespace Opm
 
   static ecl_kw_type * ecl_kw_wrapper( const UnstructuredGrid& grid,
                                        const std::string& kw_name ,
-                                       const std::vector<double> * data ,
+                                       const DataView& data ,
                                        int offset ,
                                        int stride ) {
 
     if (stride <= 0)
       OPM_THROW(std::runtime_error, "Vector strides must be positive. Got stride = " << stride);
-    if ((stride * std::vector<double>::size_type(grid.number_of_cells)) != data->size())
-      OPM_THROW(std::runtime_error, "Internal mismatch grid.number_of_cells: " << grid.number_of_cells << " data size: " << data->size() / stride);
+    if (stride * grid.number_of_cells != data.count)
+      OPM_THROW(std::runtime_error, "Internal mismatch grid.number_of_cells: " << grid.number_of_cells << " data size: " << data.count / stride);
     {
       ecl_kw_type * ecl_kw = ecl_kw_alloc( kw_name.c_str() , grid.number_of_cells , ECL_FLOAT_TYPE );
       for (int i=0; i < grid.number_of_cells; i++)
-        ecl_kw_iset_float( ecl_kw , i , (*data)[i*stride + offset]);
+        ecl_kw_iset_float( ecl_kw , i , data[i*stride + offset]);
       return ecl_kw;
     }
   }
@@ -92,6 +92,17 @@ namespace Opm
                     const boost::posix_time::ptime& current_date_time,
                     const std::string& output_dir,
                     const std::string& base_name) {
+    writeECLData(grid, dataViews(data), current_step, current_time,
+                 current_date_time, output_dir, base_name);
+  }
+
+  void writeECLData(const UnstructuredGrid& grid,
+                    const DataViewMap& data,
+                    const int current_step,
+                    const double current_time,
+                    const boost::posix_time::ptime& current_date_time,
+                    const std::string& output_dir,
+                    const std::string& base_name) {
 
     ecl_file_enum file_type = ECL_UNIFIED_RESTART_FILE;  // Alternatively ECL_RESTART_FILE for multiple restart files.
     bool fmt_file           = false;
@@ -147,7 +158,7 @@ namespace Opm
     ecl_rst_file_start_solution( rst_file );
 
     {
-      DataMap::const_iterator i = data.find("pressure");
+      DataViewMap::const_iterator i = data.find("pressure");
       if (i != data.end()) {
         ecl_kw_type * pressure_kw = ecl_kw_wrapper( grid , "PRESSURE" , i->second , 0 , 1);
         ecl_rst_file_add_kw( rst_file , pressure_kw );
@@ -156,9 +167,9 @@ namespace Opm
     }
 
     {
-      DataMap::const_iterator i = data.find("saturation");
+      DataViewMap::const_iterator i = data.find("saturation");
       if (i != data.end()) {
-        if (int(i->second->size()) != 2 * grid.number_of_cells) {
+        if (i->second.count != 2 * grid.number_of_cells) {
           OPM_THROW(std::runtime_error, "writeECLData() requires saturation field to have two phases.");
         }
         ecl_kw_type * swat_kw = ecl_kw_wrapper( grid , "SWAT" , i->second , 0 , 2);
@@ -188,6 +199,17 @@ namespace Opm
     {
         OPM_THROW(std::runtime_error, "Cannot call writeECLData() without ERT library support. Reconfigure opm-core with ERT support and recompile.");
     }
+
+    void writeECLData(const UnstructuredGrid&,
+                      const DataViewMap&,
+                      const int,
+                      const double,
+                      const boost::posix_time::ptime&,
+                      const std::string&,
+                      const std::string&)
+    {
+        OPM_THROW(std::runtime_error, "Cannot call writeECLData() without ERT library support. Reconfigure opm-core with ERT support and recompile.");
+    }
 }
 
 #endif
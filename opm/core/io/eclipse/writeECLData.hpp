@@ -41,6 +41,16 @@ namespace Opm
                     const std::string& output_dir,
                     const std::string& base_name);
 
+  // ECLIPSE output for general grids, of views of the data. The
+  // keywords are filled directly from the views.
+  void writeECLData(const UnstructuredGrid& grid,
+                    const DataViewMap& data,
+                    const int current_step,
+                    const double current_time,
+                    const boost::posix_time::ptime& current_date_time,
+                    const std::string& output_dir,
+                    const std::string& base_name);
+
 }
 
 #endif
@@ -36,17 +36,448 @@
 #include "config.h"
 #include <opm/core/io/vag/vag.hpp>
 #include <opm/core/grid/cornerpoint_grid.h>
+#include <opm/common/ErrorMacros.hpp>
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
 #include <string>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <cctype>
 #include <cmath>
 #include <cassert>
+#include <memory>
 #include <set>
+#include <stdexcept>
 #include <vector>
 #include <map>
 namespace Opm
 {
+    namespace
+    {
+        // Tokenizer over the whole text of a VAG file. Integers are
+        // converted by hand and doubles by strtod() directly on the
+        // buffer, which is null terminated.
+        class VagTextReader
+        {
+        public:
+            explicit VagTextReader(const std::string& text)
+                : p_(text.c_str()), end_(text.c_str() + text.size())
+            {}
+
+            bool word(std::string& w)
+            {
+                skipBlank();
+                const char* begin = p_;
+                while (p_ < end_ && !isBlank(*p_)) {
+                    ++p_;
+                }
+                w.assign(begin, p_);
+                return !w.empty();
+            }
+
+            int integer()
+            {
+                skipBlank();
+                const char* begin = p_;
+                bool negative = false;
+                if (p_ < end_ && (*p_ == '-' || *p_ == '+')) {
+                    negative = *p_ == '-';
+                    ++p_;
+                }
+                int value = 0;
+                while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+                    value = 10*value + (*p_ - '0');
+                    ++p_;
+                }
+                if (p_ == begin || (p_ < end_ && !isBlank(*p_))) {
+                    OPM_THROW(std::runtime_error, "VAG: expected an integer, found '"
+                              << std::string(begin, std::min(p_ + 1, end_)) << "'");
+                }
+                return negative ? -value : value;
+            }
+
+            double number()
+            {
+                char* stop;
+                const double value = strtod(p_, &stop);
+                if (stop == p_) {
+                    OPM_THROW(std::runtime_error, "VAG: expected a number at '"
+                              << std::string(p_, std::min(p_ + 16, end_)) << "'");
+                }
+                p_ = stop;
+                return value;
+            }
+
+            void integers(int* values, const std::size_t n)
+            {
+                for (std::size_t i = 0; i < n; ++i) {
+                    values[i] = integer();
+                }
+            }
+
+            void doubles(double* values, const std::size_t n)
+            {
+                for (std::size_t i = 0; i < n; ++i) {
+                    values[i] = number();
+                }
+            }
+
+            void remainingDoubles(std::vector<double>& values)
+            {
+                for (skipBlank(); p_ < end_; skipBlank()) {
+                    values.push_back(number());
+                }
+            }
+
+            // The last word of the rest of the line if it is an
+            // integer, otherwise the first integer of the next line.
+            int numberAtEndOfLine()
+            {
+                const char* eol = p_;
+                while (eol < end_ && *eol != '\n') {
+                    ++eol;
+                }
+                const char* last = eol;
+                while (last > p_ && isBlank(last[-1])) {
+                    --last;
+                }
+                const char* first = last;
+                while (first > p_ && !isBlank(first[-1])) {
+                    --first;
+                }
+                if (first < last && std::isdigit(static_cast<unsigned char>(*first))) {
+                    p_ = first;
+                    return integer();
+                }
+                p_ = eol;
+                return integer();
+            }
+
+            void posStruct(const int n, PosStruct& pos_struct)
+            {
+                pos_struct.pos.resize(n+1);
+                pos_struct.pos[0]=0;
+                for (int i = 0; i < n; ++i) {
+                    const int number = integer();
+                    pos_struct.pos[i+1] = pos_struct.pos[i] + number;
+                    pos_struct.value.resize(pos_struct.pos[i+1]);
+                    integers(pos_struct.value.data() + pos_struct.pos[i], number);
+                }
+            }
+
+        private:
+            const char* p_;
+            const char* end_;
+
+            static bool isBlank(const char c)
+            {
+                return std::isspace(static_cast<unsigned char>(c)) != 0;
+            }
+
+            void skipBlank()
+            {
+                while (p_ < end_ && isBlank(*p_)) {
+                    ++p_;
+                }
+            }
+        };
+
+        // Formats into a buffer that is written to the stream in large
+        // blocks. Doubles use the precision of the stream, so that the
+        // output is that of formatted stream output.
+        class VagTextWriter
+        {
+        public:
+            explicit VagTextWriter(std::ostream& os)
+                : os_(os), precision_(int(os.precision()))
+            {
+                buffer_.reserve(blockSize + 64);
+            }
+
+            VagTextWriter& operator<<(const char* s)
+            {
+                buffer_ += s;
+                return maybeFlush();
+            }
+
+            VagTextWriter& operator<<(const char c)
+            {
+                buffer_ += c;
+                return maybeFlush();
+            }
+
+            VagTextWriter& operator<<(const int value)
+            {
+                char digits[16];
+                int n = 0;
+                unsigned int u = value < 0 ? 0u - unsigned(value) : unsigned(value);
+                do {
+                    digits[n++] = char('0' + u % 10);
+                    u /= 10;
+                } while (u != 0);
+                if (value < 0) {
+                    buffer_ += '-';
+                }
+                while (n > 0) {
+                    buffer_ += digits[--n];
+                }
+                return maybeFlush();
+            }
+
+            VagTextWriter& operator<<(const double value)
+            {
+                char s[64];
+                snprintf(s, sizeof s, "%.*g", precision_, value);
+                buffer_ += s;
+                return maybeFlush();
+            }
+
+            // as writeVector()
+            template <typename T>
+            void vector(const std::vector<T>& vec, const std::size_t n)
+            {
+                for (std::size_t i = 0; i < vec.size(); ++i) {
+                    *this << vec[i] << ((((i + 1) % n) == 0) ? '\n' : ' ');
+                }
+                if ((vec.size() % n) != 0) {
+                    *this << '\n';
+                }
+            }
+
+            // as writePosStruct()
+            void posStruct(const PosStruct& pos_struct)
+            {
+                if (pos_struct.pos.size() == 0) {
+                    return;
+                }
+                const int n = pos_struct.pos.size() - 1;
+                for (int i = 0; i < n; ++i) {
+                    const int number = pos_struct.pos[i+1] - pos_struct.pos[i];
+                    *this << number << ' ';
+                    for (int j = 0; j < number; ++j) {
+                        *this << pos_struct.value[pos_struct.pos[i]+j] << ' ';
+                    }
+                    *this << '\n';
+                }
+            }
+
+            void flush()
+            {
+                os_.write(buffer_.data(), buffer_.size());
+                buffer_.clear();
+                os_.flush();
+            }
+
+        private:
+            static const std::size_t blockSize = 1 << 20;
+            std::ostream& os_;
+            int precision_;
+            std::string buffer_;
+
+            VagTextWriter& maybeFlush()
+            {
+                if (buffer_.size() >= blockSize) {
+                    os_.write(buffer_.data(), buffer_.size());
+                    buffer_.clear();
+                }
+                return *this;
+            }
+        };
+
+        /*
+         * Binary VAG layout (native byte order):
+         *
+         *   magic, version, byte order mark
+         *   int64 counts: vertices, volumes, faces, edges, and the
+         *                 sizes of the arrays below
+         *   vertices (double), then the pos and value arrays of
+         *   volumes->faces, volumes->vertices, faces->edges and
+         *   faces->vertices, faces->volumes and edges (int32), and
+         *   material (double).
+         *
+         * Indices are one-based, as in the VAG struct.
+         */
+        const char vagBinaryMagic[8] = { 'O', 'P', 'M', 'V', 'A', 'G', 'B', 0 };
+        const uint32_t vagBinaryVersion = 1;
+        const uint32_t vagBinaryByteOrder = 0x01020304u;
+
+        enum VagBinaryCount {
+            NumVertices, NumVolumes, NumFaces, NumEdges,
+            SizeVertices,
+            SizeVolumesFacesPos, SizeVolumesFaces,
+            SizeVolumesVerticesPos, SizeVolumesVertices,
+            SizeFacesEdgesPos, SizeFacesEdges,
+            SizeFacesVerticesPos, SizeFacesVertices,
+            SizeFacesVolumes, SizeEdges, SizeMaterial,
+            NumVagBinaryCounts
+        };
+
+        template <typename T>
+        void writeArray(std::ostream& os, const std::vector<T>& v)
+        {
+            os.write(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T));
+        }
+
+        template <typename T>
+        void readArray(std::istream& is, T* v, const int64_t n)
+        {
+            if (!is.read(reinterpret_cast<char*>(v), n*sizeof(T))) {
+                OPM_THROW(std::runtime_error, "Binary VAG stream is truncated");
+            }
+        }
+
+        void skipArray(std::istream& is, const int64_t bytes)
+        {
+            if (!is.ignore(bytes)) {
+                OPM_THROW(std::runtime_error, "Binary VAG stream is truncated");
+            }
+        }
+
+        void readBinaryHeader(std::istream& is, int64_t* counts)
+        {
+            char magic[8];
+            uint32_t version = 0;
+            uint32_t byteorder = 0;
+            if (!is.read(magic, sizeof magic) || memcmp(magic, vagBinaryMagic, sizeof magic) != 0) {
+                OPM_THROW(std::runtime_error, "Not a binary VAG stream");
+            }
+            readArray(is, &version, 1);
+            readArray(is, &byteorder, 1);
+            if (version != vagBinaryVersion || byteorder != vagBinaryByteOrder) {
+                OPM_THROW(std::runtime_error, "Binary VAG stream has version " << version
+                          << " or byte order of another platform");
+            }
+            readArray(is, counts, NumVagBinaryCounts);
+            for (int i = 0; i < NumVagBinaryCounts; ++i) {
+                if (counts[i] < 0 || counts[i] > std::numeric_limits<int>::max()) {
+                    OPM_THROW(std::runtime_error, "Binary VAG stream has invalid sizes");
+                }
+            }
+        }
+
+        void readPosStructBinary(std::istream& is, const int64_t npos, const int64_t nvalue,
+                                 PosStruct& pos_struct)
+        {
+            pos_struct.pos.resize(npos);
+            pos_struct.value.resize(nvalue);
+            readArray(is, pos_struct.pos.data(), npos);
+            readArray(is, pos_struct.value.data(), nvalue);
+        }
+    } // anonymous namespace
+
+    bool isVagBinary(const std::string& contents)
+    {
+        return contents.size() >= sizeof vagBinaryMagic
+            && memcmp(contents.data(), vagBinaryMagic, sizeof vagBinaryMagic) == 0;
+    }
+
+    void writeVagBinary(std::ostream& os, const Opm::VAG& vag_grid)
+    {
+        int64_t counts[NumVagBinaryCounts] = {
+            vag_grid.number_of_vertices, vag_grid.number_of_volumes,
+            vag_grid.number_of_faces, vag_grid.number_of_edges,
+            int64_t(vag_grid.vertices.size()),
+            int64_t(vag_grid.volumes_to_faces.pos.size()), int64_t(vag_grid.volumes_to_faces.value.size()),
+            int64_t(vag_grid.volumes_to_vertices.pos.size()), int64_t(vag_grid.volumes_to_vertices.value.size()),
+            int64_t(vag_grid.faces_to_edges.pos.size()), int64_t(vag_grid.faces_to_edges.value.size()),
+            int64_t(vag_grid.faces_to_vertices.pos.size()), int64_t(vag_grid.faces_to_vertices.value.size()),
+            int64_t(vag_grid.faces_to_volumes.size()), int64_t(vag_grid.edges.size()),
+            int64_t(vag_grid.material.size())
+        };
+        os.write(vagBinaryMagic, sizeof vagBinaryMagic);
+        os.write(reinterpret_cast<const char*>(&vagBinaryVersion), sizeof vagBinaryVersion);
+        os.write(reinterpret_cast<const char*>(&vagBinaryByteOrder), sizeof vagBinaryByteOrder);
+        os.write(reinterpret_cast<const char*>(counts), sizeof counts);
+        writeArray(os, vag_grid.vertices);
+        writeArray(os, vag_grid.volumes_to_faces.pos);
+        writeArray(os, vag_grid.volumes_to_faces.value);
+        writeArray(os, vag_grid.volumes_to_vertices.pos);
+        writeArray(os, vag_grid.volumes_to_vertices.value);
+        writeArray(os, vag_grid.faces_to_edges.pos);
+        writeArray(os, vag_grid.faces_to_edges.value);
+        writeArray(os, vag_grid.faces_to_vertices.pos);
+        writeArray(os, vag_grid.faces_to_vertices.value);
+        writeArray(os, vag_grid.faces_to_volumes);
+        writeArray(os, vag_grid.edges);
+        writeArray(os, vag_grid.material);
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Could not write binary VAG stream");
+        }
+    }
+
+    void readVagBinary(std::istream& is, Opm::VAG& vag_grid)
+    {
+        int64_t counts[NumVagBinaryCounts];
+        readBinaryHeader(is, counts);
+        vag_grid.number_of_vertices = counts[NumVertices];
+        vag_grid.number_of_volumes = counts[NumVolumes];
+        vag_grid.number_of_faces = counts[NumFaces];
+        vag_grid.number_of_edges = counts[NumEdges];
+        vag_grid.vertices.resize(counts[SizeVertices]);
+        readArray(is, vag_grid.vertices.data(), counts[SizeVertices]);
+        readPosStructBinary(is, counts[SizeVolumesFacesPos], counts[SizeVolumesFaces], vag_grid.volumes_to_faces);
+        readPosStructBinary(is, counts[SizeVolumesVerticesPos], counts[SizeVolumesVertices], vag_grid.volumes_to_vertices);
+        readPosStructBinary(is, counts[SizeFacesEdgesPos], counts[SizeFacesEdges], vag_grid.faces_to_edges);
+        readPosStructBinary(is, counts[SizeFacesVerticesPos], counts[SizeFacesVertices], vag_grid.faces_to_vertices);
+        vag_grid.faces_to_volumes.resize(counts[SizeFacesVolumes]);
+        readArray(is, vag_grid.faces_to_volumes.data(), counts[SizeFacesVolumes]);
+        vag_grid.edges.resize(counts[SizeEdges]);
+        readArray(is, vag_grid.edges.data(), counts[SizeEdges]);
+        vag_grid.material.resize(counts[SizeMaterial]);
+        readArray(is, vag_grid.material.data(), counts[SizeMaterial]);
+    }
+
+    UnstructuredGrid* readVagBinaryGrid(std::istream& is)
+    {
+        int64_t counts[NumVagBinaryCounts];
+        readBinaryHeader(is, counts);
+        const int64_t nc = counts[NumVolumes];
+        const int64_t nf = counts[NumFaces];
+        const int64_t nn = counts[NumVertices];
+        if (counts[SizeVertices] != 3*nn
+            || counts[SizeVolumesFacesPos] != nc + 1
+            || counts[SizeFacesVerticesPos] != nf + 1
+            || counts[SizeFacesVolumes] != 2*nf) {
+            OPM_THROW(std::runtime_error, "Binary VAG stream does not describe a complete grid");
+        }
+
+        std::unique_ptr<UnstructuredGrid, void(*)(UnstructuredGrid*)>
+            grid(allocate_grid(3, nc, nf, counts[SizeFacesVertices], counts[SizeVolumesFaces], nn),
+                 destroy_grid);
+        if (!grid) {
+            OPM_THROW(std::runtime_error, "Could not allocate grid of binary VAG stream");
+        }
+
+        // read straight into the grid arrays, in the order of the
+        // file, skipping the mappings that the grid does not have
+        readArray(is, grid->node_coordinates, 3*nn);
+        readArray(is, grid->cell_facepos, nc + 1);
+        readArray(is, grid->cell_faces, counts[SizeVolumesFaces]);
+        skipArray(is, (counts[SizeVolumesVerticesPos] + counts[SizeVolumesVertices]
+                       + counts[SizeFacesEdgesPos] + counts[SizeFacesEdges])*sizeof(int32_t));
+        readArray(is, grid->face_nodepos, nf + 1);
+        readArray(is, grid->face_nodes, counts[SizeFacesVertices]);
+        readArray(is, grid->face_cells, 2*nf);
+
+        // one-based to zero-based, boundary faces get -1
+        for (int64_t i = 0; i < counts[SizeVolumesFaces]; ++i) {
+            grid->cell_faces[i] -= 1;
+        }
+        for (int64_t i = 0; i < counts[SizeFacesVertices]; ++i) {
+            grid->face_nodes[i] -= 1;
+        }
+        for (int64_t i = 0; i < 2*nf; ++i) {
+            grid->face_cells[i] -= 1;
+        }
+        compute_geometry(grid.get());
+        return grid.release();
+    }
+
     void readPosStruct(std::istream& is,int n,PosStruct& pos_struct){
 	using namespace std;
 	//PosStruct pos_struct;
@@ -92,19 +523,26 @@ namespace Opm
     void readVagGrid(std::istream& is,Opm::VAG& vag_grid){
 	using namespace std;
 	using namespace Opm;
-	while (!is.eof()) {
-	    string keyword;
-	    is >> keyword;
+	// parse from a buffer of the whole stream instead of token by
+	// token through the stream
+	string buffer((istreambuf_iterator<char>(is)), istreambuf_iterator<char>());
+	if (isVagBinary(buffer)) {
+	    istringstream bis(buffer);
+	    readVagBinary(bis, vag_grid);
+	    return;
+	}
+	VagTextReader reader(buffer);
+	string keyword;
+	while (reader.word(keyword)) {
 	    //cout << keyword<< endl;
 	    if(keyword == "Number"){
 		string stmp;
-		is >> stmp;
+		reader.word(stmp);
 		if(stmp == "of"){
 		    string entity;
-		    is >> entity;
-		    getline(is,stmp);
-		    int number;
-		    is >> number;
+		    reader.word(entity);
+		    // the number is at the end of the line or on the next one
+		    int number = reader.numberAtEndOfLine();
 		    if(entity=="vertices"){
 			vag_grid.number_of_vertices=number;
 		    }else if((entity=="volumes") || (entity=="control")){
@@ -122,74 +560,56 @@ namespace Opm
 	    }else{
 		// read geometry defined by vertices
 		if(keyword=="Vertices"){
-		    int number;
-		    is >> number;
+		    int number = reader.integer();
 		    vag_grid.vertices.resize(3*number);// assume 3d data
-		    readVector(is,vag_grid.vertices);
+		    reader.doubles(vag_grid.vertices.data(), vag_grid.vertices.size());
 		}
 		// here starts the reding of all pos structures
 		else if(keyword=="Volumes->Faces" || keyword=="Volumes->faces"){
-		    //vag_grid.volumes_to_faces=
-		    int number;
-		    is >> number;
-		    readPosStruct(is,number,vag_grid.volumes_to_faces);
+		    int number = reader.integer();
+		    reader.posStruct(number, vag_grid.volumes_to_faces);
 		    cout << "Volumes->Faces: Number of " << number << endl;
 		}else if(keyword=="Faces->edges" || keyword=="Faces->Edges" ||  keyword=="Faces->Edgess"){
-		    int number;
-		    is >> number;
-		    //vag_grid.volumes_to_faces=
-		    readPosStruct(is,number,vag_grid.faces_to_edges);
+		    int number = reader.integer();
+		    reader.posStruct(number, vag_grid.faces_to_edges);
 		    cout << "Faces->edges: Number of " << number << endl;
 		}else if(keyword=="Faces->Vertices" || keyword=="Faces->vertices"){
-		    int number;
-		    is >> number;
-		    //vag_grid.volumes_to_faces=
-		    readPosStruct(is,number,vag_grid.faces_to_vertices);
+		    int number = reader.integer();
+		    reader.posStruct(number, vag_grid.faces_to_vertices);
 		    cout << "Faces->Vertices: Number of " << number << endl;
 		}else if(keyword=="Volumes->Vertices" || keyword=="Volumes->Verticess"){
-		    int number;
-		    is >> number;
-		    //vag_grid.volumes_to_faces=
-		    readPosStruct(is,number,vag_grid.volumes_to_vertices);
+		    int number = reader.integer();
+		    reader.posStruct(number, vag_grid.volumes_to_vertices);
 		    cout << "Volumes->Vertices: Number of " << number << endl;
 		}
 
 		//  read simple mappings
 		else if(keyword=="Edge" || keyword=="Edges"){
-		    int number;
-		    is >> number;
+		    int number = reader.integer();
 		    vag_grid.edges.resize(2*number);
-		    readVector(is,vag_grid.edges);
+		    reader.integers(vag_grid.edges.data(), vag_grid.edges.size());
 		    cout << "Edges: Number of " << number << endl;
 		}else if(keyword=="Faces->Volumes" || keyword=="Faces->Control"){
-		    int number;
 		    if(keyword=="Faces->Control"){
 			string vol;
-			is >> vol;
+			reader.word(vol);
 		    }
-		    is >> number;
+		    int number = reader.integer();
 		    vag_grid.faces_to_volumes.resize(2*number);
-		    readVector(is,vag_grid.faces_to_volumes);
+		    reader.integers(vag_grid.faces_to_volumes.data(), vag_grid.faces_to_volumes.size());
 		    cout << "Faces->Volumes: Number of " << number << endl;
 		}
 		// read material
 		else if(keyword=="Material"){
 		    string snum;
-		    is >> snum;
-		    int number;
-		    is >> number;
+		    reader.word(snum);
+		    int number = reader.integer();
 		    cout << "Material number  " << number << endl;
 		    // we read all the rest into doubles
-		    while(!is.eof()){
-			double value;
-			is >> value;
-			//cout << value << endl;
-			vag_grid.material.push_back(value);
-		    }
+		    reader.remainingDoubles(vag_grid.material);
 		}else{
 		    //cout << "keyword;
 		}
-		//cout << "Found" << keyword << "Number of " << number << endl;
 	    }
 	}
     }
@@ -372,36 +792,35 @@ namespace Opm
 
     void writeVagFormat(std::ostream& os,Opm::VAG& vag_grid){
 	using namespace std;
-	os << "File in the Vag grid format\n";
-        os << "Number of vertices " ;
-        os << vag_grid.number_of_vertices << endl;;
-        os <<"Number of control volume ";
-        os << vag_grid.number_of_volumes << endl;
-        os <<"Number of faces " ;
-        os << vag_grid.number_of_faces << endl;
-        os <<"Number of edges " ;
-        os << vag_grid.number_of_edges << endl;
-        os <<"Vertices      "   << vag_grid.vertices.size() << endl;
-        writeVector(os, vag_grid.vertices,3);
-        os << "Volumes->faces   " << vag_grid.volumes_to_faces.pos.size()-1 << endl;
-        writePosStruct(os, vag_grid.volumes_to_faces);
-        os << "Volumes->Vertices   " << vag_grid.volumes_to_vertices.pos.size()-1 << endl;
-        writePosStruct(os, vag_grid.volumes_to_vertices);
-        os << "Faces->edges   " << vag_grid.faces_to_edges.pos.size()-1 << endl;
-        writePosStruct(os, vag_grid.faces_to_edges);
-        os << "Faces->vertices   " << vag_grid.faces_to_vertices.pos.size()-1 << endl;
-        writePosStruct(os, vag_grid.faces_to_vertices);
-        os << "Faces->Control volumes   " << floor(vag_grid.faces_to_volumes.size()/2) << endl;
-        writeVector(os,vag_grid.faces_to_volumes,2);
-        os << "Edges   " << floor(vag_grid.edges.size()/2) << endl;
-        writeVector(os,vag_grid.edges,2);
+	// format into a buffer that is written in large blocks, with
+	// the same layout as writeVector() and writePosStruct()
+	VagTextWriter w(os);
+	w << "File in the Vag grid format\n";
+        w << "Number of vertices " << vag_grid.number_of_vertices << '\n';
+        w << "Number of control volume " << vag_grid.number_of_volumes << '\n';
+        w << "Number of faces " << vag_grid.number_of_faces << '\n';
+        w << "Number of edges " << vag_grid.number_of_edges << '\n';
+        w << "Vertices      " << int(vag_grid.vertices.size()/3) << '\n';
+        w.vector(vag_grid.vertices, 3);
+        w << "Volumes->faces   " << int(vag_grid.volumes_to_faces.pos.size())-1 << '\n';
+        w.posStruct(vag_grid.volumes_to_faces);
+        w << "Volumes->Vertices   " << int(vag_grid.volumes_to_vertices.pos.size())-1 << '\n';
+        w.posStruct(vag_grid.volumes_to_vertices);
+        w << "Faces->edges   " << int(vag_grid.faces_to_edges.pos.size())-1 << '\n';
+        w.posStruct(vag_grid.faces_to_edges);
+        w << "Faces->vertices   " << int(vag_grid.faces_to_vertices.pos.size())-1 << '\n';
+        w.posStruct(vag_grid.faces_to_vertices);
+        w << "Faces->Control volumes   " << int(vag_grid.faces_to_volumes.size()/2) << '\n';
+        w.vector(vag_grid.faces_to_volumes, 2);
+        w << "Edges   " << int(vag_grid.edges.size()/2) << '\n';
+        w.vector(vag_grid.edges, 2);
         /*
         assert(vag_grid.material.size()%vag_grid.number_of_volumes==0);
         int lines= floor(vag_grid.material.size()/vag_grid.number_of_volumes);
         os << "Material number   " << 1 << endl;
         writeVector(os,vag_grid.material,lines);
         */
-
+        w.flush();
     }
 
 
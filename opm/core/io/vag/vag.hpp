@@ -88,7 +88,8 @@ namespace Opm
     };
     /**
        Function the vag grid format and make a vag_grid struct. This structure
-       is intended to be converted to a grid.
+       is intended to be converted to a grid. The stream is read into memory
+       and parsed from there; binary vag streams are also accepted.
        \param[in]  is is is stream of the file.
        \param[out] vag_grid is a reference to a vag_grid struct.
     */
@@ -100,6 +101,31 @@ namespace Opm
 
     */
     void writeVagFormat(std::ostream& os,Opm::VAG& vag_grid);
+    /**
+       Function to write the binary vag format, which holds the same
+       arrays as the text format in native byte order.
+       \param[out] os is the stream to write to, opened in binary mode.
+       \param[in] vag_grid is a reference to a vag_grid struct.
+    */
+    void writeVagBinary(std::ostream& os, const Opm::VAG& vag_grid);
+    /**
+       Function to read the binary vag format. readVagGrid() also reads
+       binary streams.
+       \param[in]  is is the stream to read from, opened in binary mode.
+       \param[out] vag_grid is a reference to a vag_grid struct.
+    */
+    void readVagBinary(std::istream& is, Opm::VAG& vag_grid);
+    /**
+       Function to read the binary vag format directly into the arrays
+       of a new grid, without an intermediate vag_grid struct.
+       \param[in] is is the stream to read from, opened in binary mode.
+       \return a grid with computed geometry, to be released with destroy_grid().
+    */
+    UnstructuredGrid* readVagBinaryGrid(std::istream& is);
+    /**
+       Whether the contents of a file are in the binary vag format.
+    */
+    bool isVagBinary(const std::string& contents);
     /**
        Function to read a vector of some type from a stream.
        \param[in]  os is is stream of the file.
@@ -125,7 +151,7 @@ namespace Opm
         const sz_t nn = n;
 
         for (sz_t i = 0; i < vec.size(); ++i) {
-            os << vec[i] << (((i % nn) == 0) ? '\n' : ' ');
+            os << vec[i] << ((((i + 1) % nn) == 0) ? '\n' : ' ');
         }
 
         if ((vec.size() % nn) != 0) {
@@ -23,11 +23,18 @@
 #include <opm/core/grid.h>
 #include <opm/common/ErrorMacros.hpp>
 #include <boost/lexical_cast.hpp>
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
 #include <set>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <numeric>
 #include <vector>
 
 
@@ -39,6 +46,14 @@ namespace Opm
                       const std::array<double, 3>& cell_size,
                       const DataMap& data,
                       std::ostream& os)
+    {
+        writeVtkData(dims, cell_size, dataViews(data), os);
+    }
+
+    void writeVtkData(const std::array<int, 3>& dims,
+                      const std::array<double, 3>& cell_size,
+                      const DataViewMap& data,
+                      std::ostream& os)
     {
         // Dimension is hardcoded in the prototype and the next two lines,
         // but the rest is flexible (allows dimension == 2 or 3).
@@ -74,16 +89,16 @@ namespace Opm
         os << "\n";
 
         os << "\nCELL_DATA " << num_cells << '\n';
-        for (DataMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
+        for (DataViewMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
             std::string name = dit->first;
             os << "SCALARS " << name << " float" << '\n';
             os << "LOOKUP_TABLE " << name << "_table " << '\n';
-            const std::vector<double>& field = *(dit->second);
+            const DataView& field = dit->second;
             // We always print only the first data item for every
             // cell, using 'stride'.
             // This is a hack to get water saturation nicely.
             // \TODO: Extend to properly printing vector data.
-            const int stride = field.size()/num_cells;
+            const int stride = field.count/num_cells;
             const int num_per_line = 5;
             for (int c = 0; c < num_cells; ++c) {
                 os << field[stride*c] << ' ';
@@ -131,17 +146,26 @@ namespace Opm
             }
         }
     private:
-        static int indent_;
+        // per thread, for concurrent output of several files
+        static thread_local int indent_;
         std::string name_;
         std::ostream& os_;
     };
 
-    int Tag::indent_ = 0;
+    thread_local int Tag::indent_ = 0;
 
 
     void writeVtkData(const UnstructuredGrid& grid,
                       const DataMap& data,
                       std::ostream& os)
+    {
+        writeVtkData(grid, dataViews(data), os);
+    }
+
+
+    void writeVtkData(const UnstructuredGrid& grid,
+                      const DataViewMap& data,
+                      std::ostream& os)
     {
         if (grid.dimensions != 3) {
             OPM_THROW(std::runtime_error, "Vtk output for 3d grids only");
@@ -288,10 +312,10 @@ namespace Opm
             pm["NumberOfComponents"] = "1";
             pm["format"] = "ascii";
             pm["type"] = "Float64";
-            for (DataMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
+            for (DataViewMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
                 pm["Name"] = dit->first;
-                const std::vector<double>& field = *(dit->second);
-                const int num_comps = field.size()/grid.number_of_cells;
+                const DataView& field = dit->second;
+                const int num_comps = field.count/grid.number_of_cells;
                 pm["NumberOfComponents"] = boost::lexical_cast<std::string>(num_comps);
                 Tag ptag("DataArray", pm, os);
                 const int num_per_line = num_comps == 1 ? 5 : num_comps;
@@ -315,5 +339,441 @@ namespace Opm
         }
     }
 
+
+
+
+    namespace
+    {
+        // A data array of binary VTU output.
+        struct AppendedArray
+        {
+            AppendedArray(const std::string& type_arg,
+                          const std::string& name_arg,
+                          const int num_components_arg)
+                : type(type_arg), name(name_arg), num_components(num_components_arg)
+            {
+            }
+            std::string type;
+            std::string name;
+            int num_components;
+            // Values, and the appended block: UInt64 header and data.
+            // Raw blocks are written as encoded (the header), followed
+            // by raw, so that the values are not copied again.
+            std::vector<char> raw;
+            std::vector<char> encoded;
+            std::uint64_t blockSize() const
+            {
+                return encoded.size() + raw.size();
+            }
+        };
+
+        template <typename T>
+        void setValues(AppendedArray& array, const std::vector<T>& values)
+        {
+            array.raw.resize(values.size()*sizeof(T));
+            if (!values.empty()) {
+                std::memcpy(array.raw.data(), values.data(), array.raw.size());
+            }
+        }
+
+        // Gather the values of the given cells from a view of a cell
+        // field straight into the raw block.
+        void setFieldValues(AppendedArray& array, const DataView& field,
+                            const std::vector<int>& cells, const int num_comps)
+        {
+            const int num_cells = cells.size();
+            array.raw.resize(std::size_t(num_cells)*num_comps*sizeof(double));
+            double* values = reinterpret_cast<double*>(array.raw.data());
+            for (int i = 0; i < num_cells; ++i) {
+                for (int comp = 0; comp < num_comps; ++comp) {
+                    double value = field[num_comps*cells[i] + comp];
+                    if (std::fabs(value) < std::numeric_limits<double>::min()) {
+                        // Avoiding denormal numbers to work around
+                        // bug in Paraview.
+                        value = 0.0;
+                    }
+                    values[num_comps*i + comp] = value;
+                }
+            }
+        }
+
+        void appendHeader(std::vector<char>& out, const std::vector<std::uint64_t>& header)
+        {
+            const char* p = reinterpret_cast<const char*>(header.data());
+            out.insert(out.end(), p, p + header.size()*sizeof(std::uint64_t));
+        }
+
+        // Encode an array as a raw block (size, data), or as zlib
+        // blocks (number of blocks, block size, size of the last
+        // block, compressed sizes, compressed data).
+        void encode(AppendedArray& array, const VtkEncoding encoding)
+        {
+            const std::uint64_t n = array.raw.size();
+            array.encoded.clear();
+            if (encoding == VtkRawBinary) {
+                // The values are written from raw.
+                appendHeader(array.encoded, std::vector<std::uint64_t>(1, n));
+            } else {
+#if HAVE_ZLIB
+                const std::uint64_t block_size = 1 << 20;
+                const std::uint64_t num_blocks = (n + block_size - 1)/block_size;
+                std::vector<std::uint64_t> header(3 + num_blocks);
+                header[0] = num_blocks;
+                header[1] = block_size;
+                header[2] = (num_blocks == 0) ? 0 : n - (num_blocks - 1)*block_size;
+                std::vector<char> compressed(num_blocks*compressBound(block_size));
+                std::uint64_t total = 0;
+                for (std::uint64_t b = 0; b < num_blocks; ++b) {
+                    const std::uint64_t size = (b + 1 == num_blocks) ? header[2] : block_size;
+                    uLongf len = compressBound(size);
+                    // Favour speed, the output is meant to be bandwidth bound.
+                    const int ret = compress2(reinterpret_cast<Bytef*>(compressed.data() + total), &len,
+                                              reinterpret_cast<const Bytef*>(array.raw.data() + b*block_size),
+                                              size, Z_BEST_SPEED);
+                    if (ret != Z_OK) {
+                        OPM_THROW(std::runtime_error, "zlib compression of " << array.name << " failed");
+                    }
+                    header[3 + b] = len;
+                    total += len;
+                }
+                appendHeader(array.encoded, header);
+                array.encoded.insert(array.encoded.end(), compressed.begin(), compressed.begin() + total);
+#else
+                OPM_THROW(std::runtime_error, "Compressed VTU output requires opm-core built with zlib");
+#endif
+                std::vector<char>().swap(array.raw);
+            }
+        }
+
+        // Encode all arrays, in parallel for compression.
+        void encode(std::vector<AppendedArray>& arrays, const VtkEncoding encoding)
+        {
+            const int num_arrays = arrays.size();
+            std::string error;
+#pragma omp parallel for schedule(dynamic) if (encoding == VtkZlibCompressed)
+            for (int i = 0; i < num_arrays; ++i) {
+                try {
+                    encode(arrays[i], encoding);
+                }
+                catch (const std::exception& e) {
+#pragma omp critical
+                    error = e.what();
+                }
+            }
+            if (!error.empty()) {
+                OPM_THROW(std::runtime_error, error);
+            }
+        }
+
+        const char* byteOrder()
+        {
+            const std::uint16_t one = 1;
+            return (*reinterpret_cast<const unsigned char*>(&one) == 1) ? "LittleEndian" : "BigEndian";
+        }
+
+        void writeArrayTag(const AppendedArray& array, const std::uint64_t offset, std::ostream& os)
+        {
+            Tag::indent(os);
+            os << "<DataArray type=\"" << array.type << "\"";
+            if (!array.name.empty()) {
+                os << " Name=\"" << array.name << "\"";
+            }
+            os << " NumberOfComponents=\"" << array.num_components << "\""
+               << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+        }
+
+        std::string scalarsName(const DataViewMap& data)
+        {
+            if (data.find("saturation") != data.end()) {
+                return "saturation";
+            } else if (data.find("pressure") != data.end()) {
+                return "pressure";
+            }
+            return std::string();
+        }
+    } // anonymous namespace
+
+
+
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const DataMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding)
+    {
+        writeVtuData(grid, dataViews(data), os, encoding);
+    }
+
+
+
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const DataViewMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding)
+    {
+        std::vector<int> cells(grid.number_of_cells);
+        std::iota(cells.begin(), cells.end(), 0);
+        writeVtuData(grid, cells, data, os, encoding);
+    }
+
+
+
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const std::vector<int>& cells,
+                      const DataMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding)
+    {
+        writeVtuData(grid, cells, dataViews(data), os, encoding);
+    }
+
+
+
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const std::vector<int>& cells,
+                      const DataViewMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding)
+    {
+        if (grid.dimensions != 3) {
+            OPM_THROW(std::runtime_error, "Vtk output for 3d grids only");
+        }
+        const int num_cells = cells.size();
+
+        // Mesh of the cells, with the nodes numbered in order of use.
+        std::vector<int> local_node(grid.number_of_nodes, -1);
+        std::vector<double> points;
+        std::vector<int> connectivity;
+        std::vector<int> offsets;
+        std::vector<int> faces;
+        std::vector<int> faceoffsets;
+        offsets.reserve(num_cells);
+        faceoffsets.reserve(num_cells);
+        const int* fp = grid.cell_facepos;
+        const int* np = grid.face_nodepos;
+        std::set<int> cell_pts;
+        for (int i = 0; i < num_cells; ++i) {
+            const int c = cells[i];
+            cell_pts.clear();
+            for (int hf = fp[c]; hf < fp[c+1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                cell_pts.insert(grid.face_nodes + np[f], grid.face_nodes + np[f+1]);
+            }
+            for (std::set<int>::const_iterator it = cell_pts.begin(); it != cell_pts.end(); ++it) {
+                if (local_node[*it] < 0) {
+                    local_node[*it] = points.size()/3;
+                    points.insert(points.end(),
+                                  grid.node_coordinates + 3*(*it),
+                                  grid.node_coordinates + 3*(*it) + 3);
+                }
+                connectivity.push_back(local_node[*it]);
+            }
+            offsets.push_back(connectivity.size());
+            faces.push_back(fp[c+1] - fp[c]);
+            for (int hf = fp[c]; hf < fp[c+1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                faces.push_back(np[f+1] - np[f]);
+                for (int n = np[f]; n < np[f+1]; ++n) {
+                    faces.push_back(local_node[grid.face_nodes[n]]);
+                }
+            }
+            faceoffsets.push_back(faces.size());
+        }
+        const int num_pts = points.size()/3;
+
+        std::vector<AppendedArray> arrays;
+        arrays.push_back(AppendedArray("Float64", "Coordinates", 3));
+        setValues(arrays.back(), points);
+        arrays.push_back(AppendedArray("Int32", "connectivity", 1));
+        setValues(arrays.back(), connectivity);
+        arrays.push_back(AppendedArray("Int32", "offsets", 1));
+        setValues(arrays.back(), offsets);
+        arrays.push_back(AppendedArray("Int32", "faces", 1));
+        setValues(arrays.back(), faces);
+        arrays.push_back(AppendedArray("Int32", "faceoffsets", 1));
+        setValues(arrays.back(), faceoffsets);
+        arrays.push_back(AppendedArray("UInt8", "types", 1));
+        setValues(arrays.back(), std::vector<unsigned char>(num_cells, 42));
+        const int num_mesh_arrays = arrays.size();
+        for (DataViewMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
+            const DataView& field = dit->second;
+            const int num_comps = field.count/grid.number_of_cells;
+            arrays.push_back(AppendedArray("Float64", dit->first, num_comps));
+            setFieldValues(arrays.back(), field, cells, num_comps);
+        }
+        encode(arrays, encoding);
+
+        std::vector<std::uint64_t> array_offset(arrays.size() + 1, 0);
+        for (size_t a = 0; a < arrays.size(); ++a) {
+            array_offset[a + 1] = array_offset[a] + arrays[a].blockSize();
+        }
+
+        os << "<?xml version=\"1.0\"?>\n";
+        PMap pm;
+        pm["type"] = "UnstructuredGrid";
+        pm["version"] = "1.0";
+        pm["byte_order"] = byteOrder();
+        pm["header_type"] = "UInt64";
+        if (encoding == VtkZlibCompressed) {
+            pm["compressor"] = "vtkZLibDataCompressor";
+        }
+        Tag vtkfiletag("VTKFile", pm, os);
+        {
+            Tag ugtag("UnstructuredGrid", os);
+            pm.clear();
+            pm["NumberOfPoints"] = boost::lexical_cast<std::string>(num_pts);
+            pm["NumberOfCells"] = boost::lexical_cast<std::string>(num_cells);
+            Tag piecetag("Piece", pm, os);
+            {
+                Tag pointstag("Points", os);
+                writeArrayTag(arrays[0], array_offset[0], os);
+            }
+            {
+                Tag cellstag("Cells", os);
+                for (int a = 1; a < num_mesh_arrays; ++a) {
+                    writeArrayTag(arrays[a], array_offset[a], os);
+                }
+            }
+            {
+                pm.clear();
+                const std::string scalars = scalarsName(data);
+                if (!scalars.empty()) {
+                    pm["Scalars"] = scalars;
+                }
+                Tag celldatatag("CellData", pm, os);
+                for (size_t a = num_mesh_arrays; a < arrays.size(); ++a) {
+                    writeArrayTag(arrays[a], array_offset[a], os);
+                }
+            }
+        }
+        pm.clear();
+        pm["encoding"] = "raw";
+        Tag appendedtag("AppendedData", pm, os);
+        Tag::indent(os);
+        os << '_';
+        for (size_t a = 0; a < arrays.size(); ++a) {
+            os.write(arrays[a].encoded.data(), arrays[a].encoded.size());
+            os.write(arrays[a].raw.data(), arrays[a].raw.size());
+        }
+        os << '\n';
+    }
+
+
+
+    void writePvtuData(const std::vector<std::string>& pieces,
+                       const DataMap& data,
+                       const int num_cells,
+                       std::ostream& os)
+    {
+        writePvtuData(pieces, dataViews(data), num_cells, os);
+    }
+
+
+
+    void writePvtuData(const std::vector<std::string>& pieces,
+                       const DataViewMap& data,
+                       const int num_cells,
+                       std::ostream& os)
+    {
+        os << "<?xml version=\"1.0\"?>\n";
+        PMap pm;
+        pm["type"] = "PUnstructuredGrid";
+        pm["version"] = "1.0";
+        pm["byte_order"] = byteOrder();
+        pm["header_type"] = "UInt64";
+        Tag vtkfiletag("VTKFile", pm, os);
+        pm.clear();
+        pm["GhostLevel"] = "0";
+        Tag pugtag("PUnstructuredGrid", pm, os);
+        {
+            Tag pointstag("PPoints", os);
+            Tag::indent(os);
+            os << "<PDataArray type=\"Float64\" Name=\"Coordinates\" NumberOfComponents=\"3\"/>\n";
+        }
+        {
+            pm.clear();
+            const std::string scalars = scalarsName(data);
+            if (!scalars.empty()) {
+                pm["Scalars"] = scalars;
+            }
+            Tag celldatatag("PCellData", pm, os);
+            for (DataViewMap::const_iterator dit = data.begin(); dit != data.end(); ++dit) {
+                const int num_comps = num_cells > 0 ? dit->second.count/num_cells : 1;
+                Tag::indent(os);
+                os << "<PDataArray type=\"Float64\" Name=\"" << dit->first
+                   << "\" NumberOfComponents=\"" << num_comps << "\"/>\n";
+            }
+        }
+        for (size_t p = 0; p < pieces.size(); ++p) {
+            Tag::indent(os);
+            os << "<Piece Source=\"" << pieces[p] << "\"/>\n";
+        }
+    }
+
+
+
+    void writeVtuPartitioned(const UnstructuredGrid& grid,
+                             const std::vector<int>& partition,
+                             const DataMap& data,
+                             const std::string& basename,
+                             const VtkEncoding encoding)
+    {
+        writeVtuPartitioned(grid, partition, dataViews(data), basename, encoding);
+    }
+
+
+
+    void writeVtuPartitioned(const UnstructuredGrid& grid,
+                             const std::vector<int>& partition,
+                             const DataViewMap& data,
+                             const std::string& basename,
+                             const VtkEncoding encoding)
+    {
+        if (int(partition.size()) != grid.number_of_cells) {
+            OPM_THROW(std::runtime_error, "Partition has " << partition.size()
+                      << " entries, expected one per cell");
+        }
+        const int num_domains = partition.empty() ? 0
+            : *std::max_element(partition.begin(), partition.end()) + 1;
+        std::vector<std::vector<int> > domain_cells(num_domains);
+        for (int c = 0; c < grid.number_of_cells; ++c) {
+            domain_cells[partition[c]].push_back(c);
+        }
+
+        // Piece names are relative to the directory of the PVTU file.
+        const std::string::size_type slash = basename.find_last_of('/');
+        const std::string filebase = (slash == std::string::npos) ? basename : basename.substr(slash + 1);
+        std::vector<std::string> pieces(num_domains);
+        for (int d = 0; d < num_domains; ++d) {
+            pieces[d] = filebase + "_" + boost::lexical_cast<std::string>(d) + ".vtu";
+        }
+
+        std::string error;
+#pragma omp parallel for schedule(dynamic)
+        for (int d = 0; d < num_domains; ++d) {
+            try {
+                const std::string filename = basename + "_" + boost::lexical_cast<std::string>(d) + ".vtu";
+                std::ofstream os(filename.c_str(), std::ios::binary);
+                if (!os) {
+                    OPM_THROW(std::runtime_error, "Could not open " << filename);
+                }
+                writeVtuData(grid, domain_cells[d], data, os, encoding);
+            }
+            catch (const std::exception& e) {
+#pragma omp critical
+                error = e.what();
+            }
+        }
+        if (!error.empty()) {
+            OPM_THROW(std::runtime_error, error);
+        }
+
+        const std::string filename = basename + ".pvtu";
+        std::ofstream os(filename.c_str());
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Could not open " << filename);
+        }
+        writePvtuData(pieces, data, grid.number_of_cells, os);
+    }
+
 } // namespace Opm
 
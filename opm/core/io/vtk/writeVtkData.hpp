@@ -39,10 +39,95 @@ namespace Opm
                       const DataMap& data,
                       std::ostream& os);
 
+    /// Vtk output for cartesian grids, of views of the data.
+    void writeVtkData(const std::array<int, 3>& dims,
+                      const std::array<double, 3>& cell_size,
+                      const DataViewMap& data,
+                      std::ostream& os);
+
     /// Vtk output for general grids.
     void writeVtkData(const UnstructuredGrid& grid,
                       const DataMap& data,
                       std::ostream& os);
+
+    /// Vtk output for general grids, of views of the data.
+    void writeVtkData(const UnstructuredGrid& grid,
+                      const DataViewMap& data,
+                      std::ostream& os);
+
+    /// Encoding of the appended data of binary VTU output.
+    enum VtkEncoding { VtkRawBinary, VtkZlibCompressed };
+
+    /// Binary VTU output for general 3d grids.
+    /// The mesh and the fields are written as appended binary data
+    /// in blocks, so that formatting does not limit the output rate.
+    /// With VtkZlibCompressed the blocks are zlib-compressed, in
+    /// parallel if OpenMP is enabled. Compression requires opm-core
+    /// to be built with zlib, otherwise an exception is thrown.
+    /// The stream should be opened in binary mode.
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const DataMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding = VtkRawBinary);
+
+    /// Binary VTU output of views of the data. The values are read
+    /// through the views straight into the output blocks.
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const DataViewMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding = VtkRawBinary);
+
+    /// Binary VTU output of a subset of the cells of a general 3d
+    /// grid, e.g. the cells of one domain in partitioned output.
+    /// \param[in] cells  Cells to write. The fields of data are given
+    ///                   for all cells of the grid.
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const std::vector<int>& cells,
+                      const DataMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding = VtkRawBinary);
+
+    /// Binary VTU output of a subset of the cells, of views of the data.
+    void writeVtuData(const UnstructuredGrid& grid,
+                      const std::vector<int>& cells,
+                      const DataViewMap& data,
+                      std::ostream& os,
+                      const VtkEncoding encoding = VtkRawBinary);
+
+    /// PVTU file collecting VTU pieces written by writeVtuData().
+    /// \param[in] pieces     Names of the piece files, relative to the
+    ///                       PVTU file.
+    /// \param[in] data       Fields of the pieces, used for their names
+    ///                       and numbers of components.
+    /// \param[in] num_cells  Number of cells that the fields are given for.
+    void writePvtuData(const std::vector<std::string>& pieces,
+                       const DataMap& data,
+                       const int num_cells,
+                       std::ostream& os);
+
+    /// PVTU file collecting VTU pieces, for views of the data.
+    void writePvtuData(const std::vector<std::string>& pieces,
+                       const DataViewMap& data,
+                       const int num_cells,
+                       std::ostream& os);
+
+    /// Partitioned binary VTU output of a general 3d grid.
+    /// Writes the cells of each domain to basename_<domain>.vtu, in
+    /// parallel if OpenMP is enabled, and basename.pvtu to collect them.
+    /// \param[in] partition  Domain of each cell, numbered from zero.
+    /// \param[in] basename   File name prefix, may include a directory.
+    void writeVtuPartitioned(const UnstructuredGrid& grid,
+                             const std::vector<int>& partition,
+                             const DataMap& data,
+                             const std::string& basename,
+                             const VtkEncoding encoding = VtkRawBinary);
+
+    /// Partitioned binary VTU output of views of the data.
+    void writeVtuPartitioned(const UnstructuredGrid& grid,
+                             const std::vector<int>& partition,
+                             const DataViewMap& data,
+                             const std::string& basename,
+                             const VtkEncoding encoding = VtkRawBinary);
 } // namespace Opm
 
 #endif // OPM_WRITEVTKDATA_HEADER_INCLUDED
@@ -0,0 +1,282 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/linalg/DeflatedConjugateGradient.hpp>
+#include <opm/core/linalg/blas_lapack.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm
+{
+
+    namespace
+    {
+        double dot(const int n, const double* x, const double* y)
+        {
+            double s = 0.0;
+            for (int i = 0; i < n; ++i) {
+                s += x[i]*y[i];
+            }
+            return s;
+        }
+    } // anonymous namespace
+
+
+
+
+    DeflatedConjugateGradient::DeflatedConjugateGradient(const int num_vectors,
+                                                         const int num_directions)
+        : max_vectors_(std::max(num_vectors, 0)),
+          max_directions_(num_directions < 0 ? 2*max_vectors_ : num_directions),
+          size_(0),
+          k_(0)
+    {
+    }
+
+
+
+
+    int DeflatedConjugateGradient::numVectors() const
+    {
+        return k_;
+    }
+
+
+
+
+    std::size_t DeflatedConjugateGradient::allocatedBytes() const
+    {
+        return sizeof(double) * (w_.capacity() + aw_.capacity()
+                                 + p_.capacity() + ap_.capacity());
+    }
+
+
+
+
+    void DeflatedConjugateGradient::clear()
+    {
+        k_ = 0;
+        w_.clear();
+        aw_.clear();
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    DeflatedConjugateGradient::solve(const int size, const Operator& A, const Operator& precond,
+                                     const double* rhs, double* solution,
+                                     const double tolerance, const int maxit)
+    {
+        const int n = size;
+        if (n != size_) {
+            clear();
+            size_ = n;
+        }
+        std::vector<double> r(n), z(n), p(n), q(n);
+
+        LinearSolverInterface::LinearSolverReport res;
+        res.converged = false;
+        res.iterations = 0;
+        res.residual_reduction = 1.0;
+        res.setup_reused = false;
+
+        A(solution, q.data());
+        for (int i = 0; i < n; ++i) {
+            r[i] = rhs[i] - q[i];
+        }
+        const double def0 = std::sqrt(dot(n, r.data(), r.data()));
+        if (def0 == 0.0) {
+            res.converged = true;
+            res.residual_reduction = 0.0;
+            return res;
+        }
+
+        // Coarse operator E = W^T A W of the current matrix, Cholesky
+        // factorised. A space the matrix is not positive definite on
+        // is dropped.
+        MAT_SIZE_T k = k_;
+        std::vector<double> E(k*k);
+        if (k > 0) {
+            aw_.resize(std::size_t(n)*k);
+            for (int j = 0; j < k; ++j) {
+                A(&w_[std::size_t(n)*j], &aw_[std::size_t(n)*j]);
+            }
+            for (int j = 0; j < k; ++j) {
+                for (int i = 0; i <= j; ++i) {
+                    const double e = 0.5*(dot(n, &w_[std::size_t(n)*i], &aw_[std::size_t(n)*j])
+                                          + dot(n, &w_[std::size_t(n)*j], &aw_[std::size_t(n)*i]));
+                    E[i + k*j] = E[j + k*i] = e;
+                }
+            }
+            MAT_SIZE_T info = 0;
+            dpotrf_("L", &k, E.data(), &k, &info);
+            if (info != 0) {
+                clear();
+                k = 0;
+            }
+        }
+        std::vector<double> c(k);
+        // c = E^{-1} B^T v, for B = W or B = AW.
+        auto coarseSolve = [&](const std::vector<double>& B, const double* v) {
+            for (int j = 0; j < k; ++j) {
+                c[j] = dot(n, &B[std::size_t(n)*j], v);
+            }
+            const MAT_SIZE_T one = 1;
+            MAT_SIZE_T info = 0;
+            dpotrs_("L", &k, &one, E.data(), &k, c.data(), &k, &info);
+        };
+        // v -= B c.
+        auto subtract = [&](const std::vector<double>& B, double* v) {
+            for (int j = 0; j < k; ++j) {
+                const double* b = &B[std::size_t(n)*j];
+                for (int i = 0; i < n; ++i) {
+                    v[i] -= c[j]*b[i];
+                }
+            }
+        };
+
+        // Start from the Galerkin projection onto W, which makes the
+        // residual orthogonal to W.
+        if (k > 0) {
+            coarseSolve(w_, r.data());
+            for (int j = 0; j < k; ++j) {
+                const double* w = &w_[std::size_t(n)*j];
+                for (int i = 0; i < n; ++i) {
+                    solution[i] += c[j]*w[i];
+                }
+            }
+            subtract(aw_, r.data());
+        }
+
+        const int max_dirs = std::min(max_directions_, maxit);
+        if (max_dirs > 0 && int(p_.size()) < n*max_dirs) {
+            p_.resize(std::size_t(n)*max_dirs);
+            ap_.resize(std::size_t(n)*max_dirs);
+        }
+        int num_dirs = 0;
+
+        // Search directions are kept A-orthogonal to W.
+        precond(r.data(), z.data());
+        p = z;
+        if (k > 0) {
+            coarseSolve(aw_, z.data());
+            subtract(w_, p.data());
+        }
+        double rho = dot(n, r.data(), z.data());
+        double def = def0;
+        for (int it = 1; it <= maxit; ++it) {
+            A(p.data(), q.data());
+            const double pq = dot(n, p.data(), q.data());
+            if (!(pq > 0.0)) {
+                break;
+            }
+            if (num_dirs < max_dirs) {
+                std::copy(p.begin(), p.end(), &p_[std::size_t(n)*num_dirs]);
+                std::copy(q.begin(), q.end(), &ap_[std::size_t(n)*num_dirs]);
+                ++num_dirs;
+            }
+            const double alpha = rho/pq;
+            for (int i = 0; i < n; ++i) {
+                solution[i] += alpha*p[i];
+                r[i] -= alpha*q[i];
+            }
+            res.iterations = it;
+            def = std::sqrt(dot(n, r.data(), r.data()));
+            if (def <= tolerance*def0) {
+                res.converged = true;
+                break;
+            }
+            precond(r.data(), z.data());
+            const double rho_new = dot(n, r.data(), z.data());
+            const double beta = rho_new/rho;
+            rho = rho_new;
+            for (int i = 0; i < n; ++i) {
+                p[i] = z[i] + beta*p[i];
+            }
+            if (k > 0) {
+                coarseSolve(aw_, z.data());
+                subtract(w_, p.data());
+            }
+        }
+        res.residual_reduction = def/def0;
+
+        harvest(n, num_dirs);
+        return res;
+    }
+
+
+
+
+    void DeflatedConjugateGradient::harvest(const int size, const int num_dirs)
+    {
+        const int n = size;
+        MAT_SIZE_T m = k_ + num_dirs;
+        if (m == 0 || max_vectors_ == 0) {
+            return;
+        }
+        // Basis S = [W, P] with unit columns, and A*S.
+        std::vector<double> S(std::size_t(n)*m);
+        std::vector<double> AS(std::size_t(n)*m);
+        for (int j = 0; j < m; ++j) {
+            const double* s = (j < k_) ? &w_[std::size_t(n)*j] : &p_[std::size_t(n)*(j - k_)];
+            const double* as = (j < k_) ? &aw_[std::size_t(n)*j] : &ap_[std::size_t(n)*(j - k_)];
+            const double scale = 1.0/std::sqrt(dot(n, s, s));
+            for (int i = 0; i < n; ++i) {
+                S[std::size_t(n)*j + i] = scale*s[i];
+                AS[std::size_t(n)*j + i] = scale*as[i];
+            }
+        }
+        // Ritz pairs of A in span(S): G y = theta F y.
+        std::vector<double> G(m*m), F(m*m), theta(m);
+        for (int j = 0; j < m; ++j) {
+            for (int i = 0; i <= j; ++i) {
+                const double* si = &S[std::size_t(n)*i];
+                const double* sj = &S[std::size_t(n)*j];
+                G[i + m*j] = G[j + m*i] = 0.5*(dot(n, si, &AS[std::size_t(n)*j])
+                                               + dot(n, sj, &AS[std::size_t(n)*i]));
+                F[i + m*j] = F[j + m*i] = dot(n, si, sj);
+            }
+        }
+        const MAT_SIZE_T itype = 1;
+        const MAT_SIZE_T lwork = 8*m;
+        std::vector<double> work(lwork);
+        MAT_SIZE_T info = 0;
+        dsygv_(&itype, "V", "U", &m, G.data(), &m, F.data(), &m,
+               theta.data(), work.data(), &lwork, &info);
+        if (info != 0) {
+            // Numerically dependent basis, keep the current space.
+            return;
+        }
+        // W = S Y for the eigenvectors of the smallest Ritz values,
+        // which are returned first.
+        MAT_SIZE_T nk = std::min(int(m), max_vectors_);
+        MAT_SIZE_T nn = n;
+        const double one = 1.0;
+        const double zero = 0.0;
+        w_.resize(std::size_t(n)*nk);
+        dgemm_("N", "N", &nn, &nk, &m, &one, S.data(), &nn, G.data(), &m,
+               &zero, w_.data(), &nn);
+        k_ = nk;
+    }
+
+} // namespace Opm
@@ -0,0 +1,107 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_DEFLATEDCONJUGATEGRADIENT_HEADER_INCLUDED
+#define OPM_DEFLATEDCONJUGATEGRADIENT_HEADER_INCLUDED
+
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Preconditioned conjugate gradients deflated by a subspace that
+    /// is recycled between solves.
+    ///
+    /// The object keeps a few approximate eigenvectors W of the system
+    /// matrix belonging to its smallest eigenvalues. Each solve starts
+    /// from the Galerkin projection of the solution onto W and keeps
+    /// the search directions A-orthogonal to W (Saad, Yeung, Erhel and
+    /// Guyomarc'h, SIAM J. Sci. Comput. 21 (2000)), so the iterations
+    /// do not have to resolve those eigenvalues again. After a solve,
+    /// W is replaced by the Ritz vectors of the smallest Ritz values in
+    /// the span of W and the first search directions of the solve. For
+    /// a sequence of slowly varying symmetric positive definite
+    /// systems, such as the pressure systems of consecutive time
+    /// steps, W then tracks the slowly converging modes.
+    class DeflatedConjugateGradient
+    {
+    public:
+        /// y = Op(x) for arrays of the system size.
+        typedef std::function<void(const double* x, double* y)> Operator;
+
+        /// \param[in] num_vectors     maximum dimension of the recycled space
+        /// \param[in] num_directions  search directions of each solve used
+        ///                            to update the space; defaults to
+        ///                            twice num_vectors
+        explicit DeflatedConjugateGradient(const int num_vectors,
+                                           const int num_directions = -1);
+
+        /// Solve A x = b.
+        /// \param[in] size           number of unknowns
+        /// \param[in] A              symmetric positive definite matrix
+        /// \param[in] precond        symmetric positive definite preconditioner,
+        ///                           z = M^{-1} r
+        /// \param[in] rhs            right hand side b
+        /// \param[inout] solution    initial guess on input, solution on output
+        /// \param[in] tolerance      reduction of the residual norm relative to
+        ///                           the residual of the initial guess
+        /// \param[in] maxit          maximum number of iterations
+        /// \return                   iterations and residual reduction; as the
+        ///                           preconditioner is supplied by the caller,
+        ///                           setup_reused is false
+        LinearSolverInterface::LinearSolverReport
+        solve(const int size, const Operator& A, const Operator& precond,
+              const double* rhs, double* solution,
+              const double tolerance, const int maxit);
+
+        /// Current dimension of the recycled space.
+        int numVectors() const;
+
+        /// Bytes allocated for the recycled space and the stored
+        /// search directions.
+        std::size_t allocatedBytes() const;
+
+        /// Forget the recycled space.
+        void clear();
+
+    private:
+        // Update W from the span of W and the stored directions.
+        void harvest(const int size, const int num_dirs);
+
+        int max_vectors_;
+        int max_directions_;
+        int size_;
+        int k_;
+        // Recycled space W and A*W, size_ x k_, column major.
+        std::vector<double> w_;
+        std::vector<double> aw_;
+        // Search directions of the current solve and their products
+        // with A, size_ x max_directions_.
+        std::vector<double> p_;
+        std::vector<double> ap_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_DEFLATEDCONJUGATEGRADIENT_HEADER_INCLUDED
@@ -0,0 +1,49 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_LINEAROPERATORINTERFACE_HEADER_INCLUDED
+#define OPM_LINEAROPERATORINTERFACE_HEADER_INCLUDED
+
+namespace Opm
+{
+
+    /// Abstract interface for linear operators that are applied
+    /// without storing a matrix, for use with iterative solvers.
+    class LinearOperatorInterface
+    {
+    public:
+        /// Virtual destructor.
+        virtual ~LinearOperatorInterface() {}
+
+        /// Number of rows (and columns) of the operator.
+        virtual int size() const = 0;
+
+        /// Compute y = A x.
+        /// \param[in]  x  array of length size()
+        /// \param[out] y  array of length size()
+        virtual void apply(const double* x, double* y) const = 0;
+
+        /// Diagonal of the operator, array of length size().
+        /// Used by Jacobi type preconditioners.
+        virtual const double* diagonal() const = 0;
+    };
+
+} // namespace Opm
+
+#endif // OPM_LINEAROPERATORINTERFACE_HEADER_INCLUDED
@@ -0,0 +1,302 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/linalg/LinearSolverAmgx.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <amgx_c.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace Opm
+{
+
+namespace {
+
+    void check(const AMGX_RC rc, const char* what)
+    {
+        if (rc != AMGX_RC_OK) {
+            char msg[256];
+            AMGX_get_error_string(rc, msg, sizeof msg);
+            OPM_THROW(std::runtime_error, "AmgX " << what << " failed: " << msg);
+        }
+    }
+
+    void silent_print(const char*, int)
+    {
+    }
+
+    // AmgX is initialised once per process and shut down with the
+    // last solver object.
+    int library_users = 0;
+
+    void acquire_library()
+    {
+        if (library_users++ == 0) {
+            check(AMGX_initialize(), "initialisation");
+            check(AMGX_initialize_plugins(), "plugin initialisation");
+        }
+    }
+
+    void release_library()
+    {
+        if (--library_users == 0) {
+            AMGX_finalize_plugins();
+            AMGX_finalize();
+        }
+    }
+
+    /// Page-locked host array.  Transfers from pinned memory bypass
+    /// the driver's intermediate copy and may run asynchronously.
+    template <typename T>
+    class PinnedBuffer {
+    public:
+        PinnedBuffer() : pinned_(false) {}
+        ~PinnedBuffer() { unpin(); }
+
+        /// Set size, reallocating (and repinning) only on growth.
+        void resize(const std::size_t n)
+        {
+            if (n > buf_.capacity() || ! pinned_) {
+                unpin();
+                std::vector<T>(n).swap(buf_);
+                if (! buf_.empty()) {
+                    check(AMGX_pin_memory(buf_.data(), static_cast<unsigned int>(n * sizeof(T))),
+                          "pinning of host memory");
+                    pinned_ = true;
+                }
+            } else {
+                buf_.resize(n);
+            }
+        }
+
+        T*       data()       { return buf_.data(); }
+        const T* data() const { return buf_.data(); }
+        std::size_t size() const { return buf_.size(); }
+
+    private:
+        PinnedBuffer(const PinnedBuffer&);
+        PinnedBuffer& operator=(const PinnedBuffer&);
+
+        void unpin()
+        {
+            if (pinned_) {
+                AMGX_unpin_memory(buf_.data());
+                pinned_ = false;
+            }
+        }
+
+        std::vector<T> buf_;
+        bool pinned_;
+    };
+
+} // anonymous namespace.
+
+
+
+    struct LinearSolverAmgx::DeviceData
+    {
+        DeviceData(const std::string& config, const std::string& config_file, const int device)
+            : cfg(0), rsrc(0), A(0), x(0), b(0), solver(0), size(-1), nonzeros(-1)
+        {
+            if (config_file.empty()) {
+                check(AMGX_config_create(&cfg, config.c_str()), "configuration");
+            } else {
+                check(AMGX_config_create_from_file(&cfg, config_file.c_str()), "configuration");
+            }
+            int dev = device;
+            check(AMGX_resources_create(&rsrc, cfg, NULL, 1, &dev), "resource creation");
+            check(AMGX_matrix_create(&A, rsrc, AMGX_mode_dDDI), "matrix creation");
+            check(AMGX_vector_create(&x, rsrc, AMGX_mode_dDDI), "vector creation");
+            check(AMGX_vector_create(&b, rsrc, AMGX_mode_dDDI), "vector creation");
+            check(AMGX_solver_create(&solver, rsrc, AMGX_mode_dDDI, cfg), "solver creation");
+        }
+
+        ~DeviceData()
+        {
+            if (solver) AMGX_solver_destroy(solver);
+            if (b)      AMGX_vector_destroy(b);
+            if (x)      AMGX_vector_destroy(x);
+            if (A)      AMGX_matrix_destroy(A);
+            if (rsrc)   AMGX_resources_destroy(rsrc);
+            if (cfg)    AMGX_config_destroy(cfg);
+        }
+
+        /// True if the device matrix has the given sparsity pattern.
+        bool samePattern(const int n, const int nnz, const int* ia, const int* ja) const
+        {
+            return (n == size) && (nnz == nonzeros)
+                && std::equal(ia, ia + n + 1, rows.data())
+                && std::equal(ja, ja + nnz, cols.data());
+        }
+
+        AMGX_config_handle    cfg;
+        AMGX_resources_handle rsrc;
+        AMGX_matrix_handle    A;
+        AMGX_vector_handle    x;
+        AMGX_vector_handle    b;
+        AMGX_solver_handle    solver;
+
+        // Pattern currently on the device, and host staging areas.
+        int                  size;
+        int                  nonzeros;
+        PinnedBuffer<int>    rows;
+        PinnedBuffer<int>    cols;
+        PinnedBuffer<double> vals;
+        PinnedBuffer<double> vec;
+    };
+
+
+
+    LinearSolverAmgx::LinearSolverAmgx(const parameter::ParameterGroup& param)
+        : linsolver_residual_tolerance_(param.getDefault("linsolver_residual_tolerance", 1e-8)),
+          linsolver_max_iterations_(param.getDefault("linsolver_max_iterations", 0)),
+          linsolver_verbosity_(param.getDefault("linsolver_verbosity", 0)),
+          linsolver_initial_guess_(param.getDefault("linsolver_initial_guess", false)),
+          amgx_config_file_(param.getDefault("amgx_config_file", std::string())),
+          amgx_device_(param.getDefault("amgx_device", 0))
+    {
+        acquire_library();
+        if (linsolver_verbosity_ == 0) {
+            AMGX_register_print_callback(&silent_print);
+        }
+    }
+
+
+
+
+    LinearSolverAmgx::~LinearSolverAmgx()
+    {
+        data_.reset();
+        release_library();
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverAmgx::solve(const int size,
+                            const int nonzeros,
+                            const int* ia,
+                            const int* ja,
+                            const double* sa,
+                            const double* rhs,
+                            double* solution,
+                            const boost::any&) const
+    {
+        if (! data_) {
+            const int maxits = (linsolver_max_iterations_ > 0)
+                ? linsolver_max_iterations_ : 5000;
+            std::ostringstream config;
+            config << "config_version=2, exception_handling=1, "
+                   << "solver(main)=PCG, main:preconditioner(amg)=AMG, "
+                   << "main:tolerance=" << linsolver_residual_tolerance_ << ", "
+                   << "main:max_iters=" << maxits << ", "
+                   << "main:convergence=RELATIVE_INI_CORE, main:norm=L2, "
+                   << "main:monitor_residual=1, main:store_res_history=1, "
+                   << "main:print_solve_stats=" << (linsolver_verbosity_ > 0 ? 1 : 0) << ", "
+                   << "amg:algorithm=AGGREGATION, amg:selector=SIZE_2, "
+                   << "amg:smoother=BLOCK_JACOBI, amg:relaxation_factor=0.8, "
+                   << "amg:presweeps=1, amg:postsweeps=1, amg:max_iters=1, "
+                   << "amg:cycle=V, amg:max_levels=50, "
+                   << "amg:coarse_solver=DENSE_LU_SOLVER, amg:dense_lu_num_rows=64";
+            data_.reset(new DeviceData(config.str(), amgx_config_file_, amgx_device_));
+        }
+        DeviceData& d = *data_;
+
+        LinearSolverReport rep = {};
+
+        d.vals.resize(nonzeros);
+        std::memcpy(d.vals.data(), sa, nonzeros * sizeof(double));
+
+        if (d.samePattern(size, nonzeros, ia, ja)) {
+            check(AMGX_matrix_replace_coefficients(d.A, size, nonzeros, d.vals.data(), NULL),
+                  "coefficient update");
+            check(AMGX_solver_resetup(d.solver, d.A), "solver setup");
+            rep.setup_reused = true;
+        } else {
+            d.rows.resize(size + 1);
+            d.cols.resize(nonzeros);
+            std::memcpy(d.rows.data(), ia, (size + 1) * sizeof(int));
+            std::memcpy(d.cols.data(), ja, nonzeros * sizeof(int));
+            d.size     = size;
+            d.nonzeros = nonzeros;
+
+            check(AMGX_matrix_upload_all(d.A, size, nonzeros, 1, 1,
+                                         d.rows.data(), d.cols.data(),
+                                         d.vals.data(), NULL),
+                  "matrix upload");
+            check(AMGX_solver_setup(d.solver, d.A), "solver setup");
+        }
+
+        d.vec.resize(size);
+        std::memcpy(d.vec.data(), rhs, size * sizeof(double));
+        check(AMGX_vector_upload(d.b, size, 1, d.vec.data()), "vector upload");
+
+        if (linsolver_initial_guess_) {
+            std::memcpy(d.vec.data(), solution, size * sizeof(double));
+            check(AMGX_vector_upload(d.x, size, 1, d.vec.data()), "vector upload");
+            check(AMGX_solver_solve(d.solver, d.b, d.x), "solve");
+        } else {
+            check(AMGX_vector_set_zero(d.x, size, 1), "vector initialisation");
+            check(AMGX_solver_solve_with_0_initial_guess(d.solver, d.b, d.x), "solve");
+        }
+
+        check(AMGX_vector_download(d.x, d.vec.data()), "vector download");
+        std::memcpy(solution, d.vec.data(), size * sizeof(double));
+
+        AMGX_SOLVE_STATUS status;
+        check(AMGX_solver_get_status(d.solver, &status), "status query");
+        check(AMGX_solver_get_iterations_number(d.solver, &rep.iterations), "status query");
+
+        double r0 = 0.0, r = 0.0;
+        if ((AMGX_solver_get_iteration_residual(d.solver, 0, 0, &r0) == AMGX_RC_OK) &&
+            (AMGX_solver_get_iteration_residual(d.solver, rep.iterations, 0, &r) == AMGX_RC_OK) &&
+            (r0 > 0.0)) {
+            rep.residual_reduction = r / r0;
+        }
+        rep.converged = (status == AMGX_SOLVE_SUCCESS);
+
+        if (linsolver_verbosity_ > 0) {
+            std::cout << "AmgX: " << rep.iterations << " iterations, residual reduction "
+                      << rep.residual_reduction << (rep.setup_reused ? " (resetup)" : "")
+                      << std::endl;
+        }
+
+        return rep;
+    }
+
+    void LinearSolverAmgx::setTolerance(const double tol)
+    {
+        if (tol != linsolver_residual_tolerance_) {
+            linsolver_residual_tolerance_ = tol;
+            // The tolerance is part of the AmgX configuration.
+            data_.reset();
+        }
+    }
+
+    double LinearSolverAmgx::getTolerance() const
+    {
+        return linsolver_residual_tolerance_;
+    }
+
+} // namespace Opm
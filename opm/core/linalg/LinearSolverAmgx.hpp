@@ -0,0 +1,112 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_LINEARSOLVERAMGX_HEADER_INCLUDED
+#define OPM_LINEARSOLVERAMGX_HEADER_INCLUDED
+
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <memory>
+#include <string>
+
+namespace Opm
+{
+
+    /// Concrete class offloading linear solves to a GPU through
+    /// the AmgX library (selected with linsolver=gpu).
+    ///
+    /// The device matrix, vectors and solver hierarchy are kept
+    /// between calls.  As long as the sparsity pattern (size,
+    /// nonzeros, ia, ja) is unchanged only the coefficients are
+    /// transferred and the AMG setup is refreshed in place.  Host
+    /// side transfers use page-locked staging buffers allocated
+    /// once per pattern.
+    class LinearSolverAmgx : public LinearSolverInterface
+    {
+    public:
+        /// Construct from parameters.
+        /// Accepted parameters are, with defaults:
+        ///   linsolver_residual_tolerance  1e-8
+        ///   linsolver_max_iterations      0 (unlimited=5000)
+        ///   linsolver_verbosity           0
+        ///   linsolver_initial_guess       false. Start iterating from
+        ///                                 the solution array passed to
+        ///                                 solve() instead of from zero.
+        ///   amgx_config_file              <empty string>. If given, an
+        ///                                 AmgX configuration file that
+        ///                                 replaces the built-in PCG/AMG
+        ///                                 configuration (tolerance and
+        ///                                 iteration parameters are then
+        ///                                 taken from the file).
+        ///   amgx_device                   0 (CUDA device ordinal)
+        LinearSolverAmgx(const parameter::ParameterGroup& param);
+
+        /// Destructor.
+        virtual ~LinearSolverAmgx();
+
+        using LinearSolverInterface::solve;
+
+        /// Solve a linear system, with a matrix given in compressed sparse row format.
+        /// \param[in] size        # of rows in matrix
+        /// \param[in] nonzeros    # of nonzeros elements in matrix
+        /// \param[in] ia          array of length (size + 1) containing start and end indices for each row
+        /// \param[in] ja          array of length nonzeros containing column numbers for the nonzero elements
+        /// \param[in] sa          array of length nonzeros containing the values of the nonzero elements
+        /// \param[in] rhs         array of length size containing the right hand side
+        /// \param[inout] solution array of length size to which the solution will be written, may also be used
+        ///                        as initial guess by iterative solvers.
+        virtual LinearSolverReport solve(const int size,
+                                         const int nonzeros,
+                                         const int* ia,
+                                         const int* ja,
+                                         const double* sa,
+                                         const double* rhs,
+                                         double* solution,
+                                         const boost::any&) const;
+
+        /// Set tolerance for the residual in the AmgX linear solver.
+        /// Takes effect at the next solve, which rebuilds the solver.
+        /// \param[in] tol         tolerance value
+        virtual void setTolerance(const double tol);
+
+        /// Get tolerance of the linear solver.
+        /// \param[out] tolerance value
+        virtual double getTolerance() const;
+
+    private:
+        struct DeviceData;
+
+        double      linsolver_residual_tolerance_;
+        int         linsolver_max_iterations_;
+        int         linsolver_verbosity_;
+        bool        linsolver_initial_guess_;
+        std::string amgx_config_file_;
+        int         amgx_device_;
+
+        // Device state is created on first use and survives across
+        // the (logically const) solve() calls.
+        mutable std::unique_ptr<DeviceData> data_;
+    };
+
+
+} // namespace Opm
+
+
+
+#endif // OPM_LINEARSOLVERAMGX_HEADER_INCLUDED
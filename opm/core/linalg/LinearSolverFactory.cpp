@@ -35,15 +35,103 @@
 #include <opm/core/linalg/LinearSolverPetsc.hpp>
 #endif
 
+#if HAVE_AMGX
+#include <opm/core/linalg/LinearSolverAmgx.hpp>
+#endif
+
+#include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/StopWatch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 
 namespace Opm
 {
 
+    namespace
+    {
+        std::shared_ptr<LinearSolverInterface>
+        createSolver(const std::string& ls, const parameter::ParameterGroup& param)
+        {
+            std::shared_ptr<LinearSolverInterface> solver;
+            if (ls == "umfpack") {
+#if HAVE_SUITESPARSE_UMFPACK_H
+                solver.reset(new LinearSolverUmfpack(param));
+#endif
+            }
+
+            else if (ls == "istl") {
+#if HAVE_DUNE_ISTL
+                solver.reset(new LinearSolverIstl(param));
+#endif
+            }
+            else if (ls == "petsc"){
+#if HAVE_PETSC
+                solver.reset(new LinearSolverPetsc(param));
+#endif
+            }
+            else if (ls == "gpu") {
+#if HAVE_AMGX
+                solver.reset(new LinearSolverAmgx(param));
+#endif
+            }
+
+            else {
+                OPM_THROW(std::runtime_error, "Linear solver " << ls << " is unknown.");
+            }
+
+            if (! solver) {
+                OPM_THROW(std::runtime_error, "Linear solver " << ls << " is not enabled in "
+                      "this configuration.");
+            }
+            (void) param;
+            return solver;
+        }
+
+
+
+        /// Numerical symmetry test with a relative tolerance.
+        bool isSymmetric(const int size, const int* ia, const int* ja, const double* sa)
+        {
+            for (int i = 0; i < size; ++i) {
+                for (int k = ia[i]; k < ia[i + 1]; ++k) {
+                    const int j = ja[k];
+                    if (j <= i) {
+                        continue;
+                    }
+                    const int* begin = ja + ia[j];
+                    const int* end = ja + ia[j + 1];
+                    const int* pos = std::find(begin, end, i);
+                    const double aji = (pos == end) ? 0.0 : sa[ia[j] + (pos - begin)];
+                    const double scale = std::max(std::fabs(sa[k]), std::fabs(aji));
+                    if (std::fabs(sa[k] - aji) > 1e-10 * scale) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+
+
+        struct Candidate
+        {
+            std::string name;
+            std::string linsolver;
+            std::string linsolver_type;
+        };
+    } // anonymous namespace
+
+
     LinearSolverFactory::LinearSolverFactory()
+        : auto_tolerance_(-1.0),
+          dump_count_(0)
     {
 #if HAVE_SUITESPARSE_UMFPACK_H
         solver_.reset(new LinearSolverUmfpack);
@@ -60,34 +148,19 @@ namespace Opm
 
 
     LinearSolverFactory::LinearSolverFactory(const parameter::ParameterGroup& param)
+        : auto_tolerance_(-1.0),
+          dump_prefix_(param.getDefault<std::string>("linsolver_dump_prefix", "")),
+          dump_count_(0)
     {
         const std::string ls =
             param.getDefault<std::string>("linsolver", "umfpack");
 
-        if (ls == "umfpack") {
-#if HAVE_SUITESPARSE_UMFPACK_H
-            solver_.reset(new LinearSolverUmfpack);
-#endif
-        }
-
-        else if (ls == "istl") {
-#if HAVE_DUNE_ISTL
-            solver_.reset(new LinearSolverIstl(param));
-#endif
-        }
-        else if (ls == "petsc"){
-#if HAVE_PETSC
-            solver_.reset(new LinearSolverPetsc(param));
-#endif
-        }
-
-        else {
-            OPM_THROW(std::runtime_error, "Linear solver " << ls << " is unknown.");
-        }
-
-        if (! solver_) {
-            OPM_THROW(std::runtime_error, "Linear solver " << ls << " is not enabled in "
-                  "this configuration.");
+        if (ls == "auto") {
+            auto_param_.reset(new parameter::ParameterGroup(param));
+            // Read here, so that it is not reported as unused.
+            param.getDefault("linsolver_auto_direct_size", 100000);
+        } else {
+            solver_ = createSolver(ls, param);
         }
     }
 
@@ -111,17 +184,185 @@ namespace Opm
                                double* solution,
                                const boost::any& add) const
     {
-        return solver_->solve(size, nonzeros, ia, ja, sa, rhs, solution, add);
+        const LinearSolverReport res = solver_
+            ? solver_->solve(size, nonzeros, ia, ja, sa, rhs, solution, add)
+            : selectSolver(size, nonzeros, ia, ja, sa, rhs, solution, add);
+        if (!res.converged && !dump_prefix_.empty()) {
+            dumpSystem(size, nonzeros, ia, ja, sa, rhs);
+        }
+        return res;
+    }
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverFactory::solveBlock(const int size,
+                                    const int block_size,
+                                    const int nonzeros,
+                                    const int* ia,
+                                    const int* ja,
+                                    const double* sa,
+                                    const double* rhs,
+                                    double* solution) const
+    {
+        if (!solver_) {
+            // Select on the expanded scalar system.
+            return LinearSolverInterface::solveBlock(size, block_size, nonzeros,
+                                                     ia, ja, sa, rhs, solution);
+        }
+        return solver_->solveBlock(size, block_size, nonzeros, ia, ja, sa, rhs, solution);
+    }
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverFactory::solveMultiple(const int size,
+                                       const int nonzeros,
+                                       const int* ia,
+                                       const int* ja,
+                                       const double* sa,
+                                       const int nrhs,
+                                       const double* rhs,
+                                       double* solution) const
+    {
+        if (!solver_) {
+            // Select on the first right hand side.
+            return LinearSolverInterface::solveMultiple(size, nonzeros, ia, ja, sa,
+                                                        nrhs, rhs, solution);
+        }
+        return solver_->solveMultiple(size, nonzeros, ia, ja, sa, nrhs, rhs, solution);
     }
 
     void LinearSolverFactory::setTolerance(const double tol)
     {
-        solver_->setTolerance(tol);
+        if (solver_) {
+            solver_->setTolerance(tol);
+        } else {
+            auto_tolerance_ = tol;
+        }
     }
 
     double LinearSolverFactory::getTolerance() const
     {
-        return solver_->getTolerance();
+        return solver_ ? solver_->getTolerance() : auto_tolerance_;
+    }
+
+    void LinearSolverFactory::reportMemory(MemoryReport& report) const
+    {
+        if (solver_) {
+            solver_->reportMemory(report);
+        }
+    }
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverFactory::selectSolver(const int size,
+                                      const int nonzeros,
+                                      const int* ia,
+                                      const int* ja,
+                                      const double* sa,
+                                      const double* rhs,
+                                      double* solution,
+                                      const boost::any& add) const
+    {
+        const parameter::ParameterGroup& param = *auto_param_;
+        const bool symmetric = isSymmetric(size, ia, ja, sa);
+        std::cout << "Linear solver auto selection: " << size << " rows, "
+                  << double(nonzeros) / std::max(size, 1) << " non-zeros per row, "
+                  << (symmetric ? "symmetric" : "nonsymmetric") << ".\n";
+
+        if (!add.empty()) {
+            // Parallel solve: only istl supports it, and trial timings
+            // could differ between processes.
+            solver_ = createSolver("istl", param);
+            if (auto_tolerance_ >= 0.0) {
+                solver_->setTolerance(auto_tolerance_);
+            }
+            std::cout << "Linear solver auto selection: parallel run, using istl." << std::endl;
+            return solver_->solve(size, nonzeros, ia, ja, sa, rhs, solution, add);
+        }
+
+        std::vector<Candidate> candidates;
+#if HAVE_SUITESPARSE_UMFPACK_H
+        if (size <= param.getDefault("linsolver_auto_direct_size", 100000)) {
+            candidates.push_back(Candidate{ "umfpack", "umfpack", "" });
+        }
+#endif
+#if HAVE_DUNE_ISTL
+        if (symmetric) {
+            candidates.push_back(Candidate{ "istl CG_AMG", "istl", "1" });
+            candidates.push_back(Candidate{ "istl CG_ILU0", "istl", "0" });
+        } else {
+            candidates.push_back(Candidate{ "istl BiCGStab_ILU0", "istl", "2" });
+        }
+#endif
+#if HAVE_PETSC
+        candidates.push_back(Candidate{ "petsc", "petsc", "" });
+#endif
+        if (candidates.empty()) {
+            OPM_THROW(std::runtime_error, "No linear solver available for linsolver auto.");
+        }
+
+        // Solve the first system with every candidate, keeping the
+        // solution of the best one.
+        const std::vector<double> guess(solution, solution + size);
+        std::vector<double> x(size);
+        LinearSolverReport best_res = LinearSolverReport();
+        double best_time = 0.0;
+        std::string best_name;
+        for (const Candidate& c : candidates) {
+            parameter::ParameterGroup cparam = param;
+            cparam.insertParameter("linsolver", c.linsolver);
+            if (!c.linsolver_type.empty()) {
+                cparam.insertParameter("linsolver_type", c.linsolver_type);
+            }
+            std::shared_ptr<LinearSolverInterface> solver = createSolver(c.linsolver, cparam);
+            if (auto_tolerance_ >= 0.0) {
+                solver->setTolerance(auto_tolerance_);
+            }
+
+            std::copy(guess.begin(), guess.end(), x.begin());
+            time::StopWatch clock;
+            clock.start();
+            const LinearSolverReport res = solver->solve(size, nonzeros, ia, ja, sa, rhs, &x[0]);
+            clock.stop();
+            const double t = clock.secsSinceStart();
+            std::cout << "    " << c.name << ": " << t << " s, "
+                      << (res.converged ? "converged" : "did not converge") << ".\n";
+
+            const bool better = !solver_
+                || (res.converged && (!best_res.converged || t < best_time));
+            if (better) {
+                solver_ = solver;
+                best_res = res;
+                best_time = t;
+                best_name = c.name;
+                std::copy(x.begin(), x.end(), solution);
+            }
+        }
+        std::cout << "Linear solver auto selection: using " << best_name << "." << std::endl;
+        return best_res;
+    }
+
+    void LinearSolverFactory::dumpSystem(const int size,
+                                         const int nonzeros,
+                                         const int* ia,
+                                         const int* ja,
+                                         const double* sa,
+                                         const double* rhs) const
+    {
+        std::ostringstream base;
+        base << dump_prefix_ << '-' << dump_count_++;
+        CSRMatrix A;
+        A.m = size;
+        A.nnz = nonzeros;
+        A.ia = const_cast<int*>(ia);
+        A.ja = const_cast<int*>(ja);
+        A.sa = const_cast<double*>(sa);
+        const bool ok = csrmatrix_write_bin(&A, (base.str() + ".csr").c_str(), 1)
+            && vector_write_bin(size, rhs, (base.str() + ".rhs").c_str(), 1);
+        if (ok) {
+            std::cerr << "Linear solver did not converge, system written to "
+                      << base.str() << ".{csr,rhs}" << std::endl;
+        } else {
+            std::cerr << "Linear solver did not converge, failed to write system to "
+                      << base.str() << ".{csr,rhs}" << std::endl;
+        }
     }
 
 
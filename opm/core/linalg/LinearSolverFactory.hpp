@@ -23,6 +23,7 @@
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <memory>
+#include <string>
 
 namespace Opm
 {
@@ -42,7 +43,14 @@ namespace Opm
 
         /// Construct from parameters.
         /// The accepted parameters are (default) (allowed values):
-        ///    linsolver ("umfpack")   ("umfpack", "istl", "petsc")
+        ///    linsolver ("umfpack")   ("umfpack", "istl", "petsc", "gpu", "auto")
+        ///    linsolver_auto_direct_size (100000) With linsolver "auto", the
+        ///                          largest system for which umfpack is tried.
+        ///    linsolver_dump_prefix ("") If non-empty, every system for which
+        ///                          solve() does not converge is written to
+        ///                          <prefix>-<n>.csr and <prefix>-<n>.rhs in the
+        ///                          binary format of csrmatrix_write_bin(), for
+        ///                          offline reproduction with benchmark_linear_solvers.
         /// For the umfpack solver to be available, this class must be
         /// compiled with UMFPACK support, as indicated by the
         /// variable HAVE_SUITESPARSE_UMFPACK_H in config.h.
@@ -52,9 +60,23 @@ namespace Opm
         /// For the petsc solver to be available, this class must be
         /// compiled with petsc support, as indicated by the
         /// variable HAVE_PETSC in config.h.
+        /// For the gpu solver to be available, this class must be
+        /// compiled with AmgX support, as indicated by the
+        /// variable HAVE_AMGX in config.h.
         /// Any further parameters are passed on to the constructors
         /// of the actual solver used, see LinearSolverUmfpack,
-        /// LinearSolverIstl and LinearSolverPetsc for details.
+        /// LinearSolverIstl, LinearSolverPetsc and LinearSolverAmgx
+        /// for details.
+        /// With linsolver "auto", the first system passed to solve() is
+        /// inspected for size, non-zeros per row and symmetry, and solved
+        /// with each suitable configuration among those available:
+        /// umfpack for systems of at most linsolver_auto_direct_size rows,
+        /// istl CG_AMG and CG_ILU0 for symmetric systems, istl
+        /// BiCGStab_ILU0 for nonsymmetric systems, and petsc. The fastest
+        /// configuration that converges is used for the rest of the run,
+        /// and the decision is logged to standard output. In parallel runs
+        /// the trials are skipped and istl is used, so that all processes
+        /// make the same choice.
         LinearSolverFactory(const parameter::ParameterGroup& param);
 
         /// Destructor.
@@ -80,6 +102,28 @@ namespace Opm
                                          double* solution,
                                          const boost::any& add=boost::any()) const;
 
+        /// Solve a linear system, with a matrix given in block compressed sparse row format.
+        /// Forwards to the selected solver, see LinearSolverInterface::solveBlock().
+        virtual LinearSolverReport solveBlock(const int size,
+                                              const int block_size,
+                                              const int nonzeros,
+                                              const int* ia,
+                                              const int* ja,
+                                              const double* sa,
+                                              const double* rhs,
+                                              double* solution) const;
+
+        /// Solve a linear system with several right hand sides.
+        /// Forwards to the selected solver, see LinearSolverInterface::solveMultiple().
+        virtual LinearSolverReport solveMultiple(const int size,
+                                                 const int nonzeros,
+                                                 const int* ia,
+                                                 const int* ja,
+                                                 const double* sa,
+                                                 const int nrhs,
+                                                 const double* rhs,
+                                                 double* solution) const;
+
         /// Set tolerance for the linear solver.
         /// \param[in] tol         tolerance value
         /// Not used for LinearSolverFactory
@@ -90,8 +134,35 @@ namespace Opm
         /// Not used for LinearSolverFactory. Returns -1.
         virtual double getTolerance() const;
 
+        /// Add the memory of the underlying solver to the report.
+        /// Nothing is added before the first solve in auto mode.
+        virtual void reportMemory(MemoryReport& report) const;
+
     private:
-        std::shared_ptr<LinearSolverInterface> solver_;
+        LinearSolverReport selectSolver(const int size,
+                                        const int nonzeros,
+                                        const int* ia,
+                                        const int* ja,
+                                        const double* sa,
+                                        const double* rhs,
+                                        double* solution,
+                                        const boost::any& add) const;
+
+        void dumpSystem(const int size,
+                        const int nonzeros,
+                        const int* ia,
+                        const int* ja,
+                        const double* sa,
+                        const double* rhs) const;
+
+        // Set on the first solve in auto mode.
+        mutable std::shared_ptr<LinearSolverInterface> solver_;
+        // Parameters for the candidate solvers, only in auto mode.
+        std::shared_ptr<parameter::ParameterGroup> auto_param_;
+        // Tolerance set before the auto selection, or -1.
+        double auto_tolerance_;
+        std::string dump_prefix_;
+        mutable int dump_count_;
     };
 
 
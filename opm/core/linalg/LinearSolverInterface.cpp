@@ -22,6 +22,8 @@
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/linalg/call_umfpack.h>
+#include <algorithm>
+#include <vector>
 
 namespace Opm
 {
@@ -41,5 +43,97 @@ namespace Opm
         return solve(A->m, A->nnz, A->ia, A->ja, A->sa, rhs, solution);
     }
 
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverInterface::solve(const BCSRMatrix* A,
+                                 const double* rhs,
+                                 double* solution) const
+    {
+        return solveBlock(A->m, A->bs, A->nnz, A->ia, A->ja, A->sa, rhs, solution);
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverInterface::solveBlock(const int size,
+                                      const int block_size,
+                                      const int nonzeros,
+                                      const int* ia,
+                                      const int* ja,
+                                      const double* sa,
+                                      const double* rhs,
+                                      double* solution) const
+    {
+        const int bs  = block_size;
+        const int bs2 = bs * bs;
+
+        std::vector<int>    sia(size*bs + 1);
+        std::vector<int>    sja(nonzeros * bs2);
+        std::vector<double> ssa(nonzeros * bs2);
+
+        // Scalar row i*bs + r holds row r of every block in block row i.
+        int k = 0;
+        sia[0] = 0;
+        for (int i = 0; i < size; ++i) {
+            for (int r = 0; r < bs; ++r) {
+                for (int b = ia[i]; b < ia[i + 1]; ++b) {
+                    for (int c = 0; c < bs; ++c, ++k) {
+                        sja[k] = ja[b]*bs + c;
+                        ssa[k] = sa[b*bs2 + r*bs + c];
+                    }
+                }
+                sia[i*bs + r + 1] = k;
+            }
+        }
+
+        return solve(size*bs, nonzeros*bs2, &sia[0], &sja[0], &ssa[0], rhs, solution);
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverInterface::solveMultiple(const int size,
+                                         const int nonzeros,
+                                         const int* ia,
+                                         const int* ja,
+                                         const double* sa,
+                                         const int nrhs,
+                                         const double* rhs,
+                                         double* solution) const
+    {
+        LinearSolverReport total = { true, 0, 0.0, false };
+        for (int k = 0; k < nrhs; ++k) {
+            const LinearSolverReport rep =
+                solve(size, nonzeros, ia, ja, sa, rhs + k*size, solution + k*size);
+            accumulateReport(total, rep);
+        }
+        return total;
+    }
+
+
+
+
+    void
+    LinearSolverInterface::reportMemory(MemoryReport& /* report */) const
+    {
+    }
+
+
+
+
+    void
+    LinearSolverInterface::accumulateReport(LinearSolverReport& total,
+                                            const LinearSolverReport& single)
+    {
+        total.converged = total.converged && single.converged;
+        total.iterations += single.iterations;
+        total.residual_reduction = std::max(total.residual_reduction, single.residual_reduction);
+        total.setup_reused = total.setup_reused || single.setup_reused;
+    }
+
 } // namespace Opm
 
@@ -23,10 +23,12 @@
 #include<boost/any.hpp>
 
 struct CSRMatrix;
+struct BCSRMatrix;
 
 namespace Opm
 {
 
+    class MemoryReport;
 
     /// Abstract interface for linear solvers.
     class LinearSolverInterface
@@ -43,6 +45,9 @@ namespace Opm
             bool converged;
             int iterations;
             double residual_reduction;
+            /// True if the solver reused a preconditioner set up
+            /// in an earlier call (e.g., an AMG hierarchy).
+            bool setup_reused;
         };
 
         /// Solve a linear system, with a matrix given in compressed sparse row format.
@@ -73,6 +78,60 @@ namespace Opm
                                          double* solution,
                                          const boost::any& add=boost::any()) const = 0;
 
+        /// Solve a linear system, with a matrix given in block compressed sparse row format.
+        /// \param[in] A           matrix in BCSR format
+        /// \param[in] rhs         array of length A->m*A->bs containing the right hand side
+        /// \param[inout] solution array of length A->m*A->bs to which the solution will be written
+        /// Note: this method is a convenience method that calls the virtual solveBlock() method.
+        LinearSolverReport solve(const BCSRMatrix* A,
+                                 const double* rhs,
+                                 double* solution) const;
+
+        /// Solve a linear system, with a matrix given in block compressed sparse row format.
+        /// Unknowns are numbered block by block, i.e. unknown r of block row i has
+        /// index i*block_size + r.
+        /// \param[in] size        # of block rows in matrix
+        /// \param[in] block_size  # of rows (and columns) in each block
+        /// \param[in] nonzeros    # of nonzero blocks in matrix
+        /// \param[in] ia          array of length (size + 1) containing start and end indices for each block row
+        /// \param[in] ja          array of length nonzeros containing block column numbers
+        /// \param[in] sa          array of length nonzeros*block_size*block_size containing the
+        ///                        blocks, each stored row major
+        /// \param[in] rhs         array of length size*block_size containing the right hand side
+        /// \param[inout] solution array of length size*block_size to which the solution will be written
+        /// The default implementation expands the system to scalar format and calls solve().
+        virtual LinearSolverReport solveBlock(const int size,
+                                              const int block_size,
+                                              const int nonzeros,
+                                              const int* ia,
+                                              const int* ja,
+                                              const double* sa,
+                                              const double* rhs,
+                                              double* solution) const;
+
+        /// Solve a linear system with several right hand sides, with a matrix
+        /// given in compressed sparse row format.
+        /// \param[in] size        # of rows in matrix
+        /// \param[in] nonzeros    # of nonzeros elements in matrix
+        /// \param[in] ia          array of length (size + 1) containing start and end indices for each row
+        /// \param[in] ja          array of length nonzeros containing column numbers for the nonzero elements
+        /// \param[in] sa          array of length nonzeros containing the values of the nonzero elements
+        /// \param[in] nrhs        # of right hand sides
+        /// \param[in] rhs         array of length nrhs*size, right hand side k is
+        ///                        rhs[k*size] ... rhs[(k + 1)*size - 1]
+        /// \param[inout] solution array of length nrhs*size, ordered as rhs
+        /// \return Report that is converged if all solves converged, with the
+        ///         total number of iterations and the largest residual reduction.
+        /// The default implementation calls solve() for each right hand side.
+        virtual LinearSolverReport solveMultiple(const int size,
+                                                 const int nonzeros,
+                                                 const int* ia,
+                                                 const int* ja,
+                                                 const double* sa,
+                                                 const int nrhs,
+                                                 const double* rhs,
+                                                 double* solution) const;
+
         /// Set tolerance for the linear solver.
         /// \param[in] tol         tolerance value
         virtual void setTolerance(const double tol) = 0;
@@ -81,6 +140,18 @@ namespace Opm
         /// \param[out] tolerance value
         virtual double getTolerance() const = 0;
 
+        /// Add the bytes kept by the solver between solves (cached
+        /// matrices, preconditioners, recycled spaces) to the report.
+        /// The default implementation adds nothing.
+        /// \param[inout] report  report to add a child "linear solver" to
+        virtual void reportMemory(MemoryReport& report) const;
+
+    protected:
+        /// Add the report of one solve to the report of several,
+        /// as described for solveMultiple().
+        static void accumulateReport(LinearSolverReport& total,
+                                     const LinearSolverReport& single);
+
     };
 
 
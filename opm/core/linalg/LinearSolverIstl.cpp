@@ -23,7 +23,10 @@
 #endif
 
 #include <opm/core/linalg/LinearSolverIstl.hpp>
+#include <opm/core/linalg/DeflatedConjugateGradient.hpp>
 #include <opm/core/linalg/ParallelIstlInformation.hpp>
+#include <opm/core/transport/reorder/tarjan.h>
+#include <opm/core/utility/MemoryReport.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 // Silence compatibility warning from DUNE headers since we don't use
@@ -53,9 +56,13 @@
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <stdexcept>
 #include <iostream>
 #include <type_traits>
+#include <vector>
 
 namespace Opm
 {
@@ -68,14 +75,27 @@ namespace Opm
         typedef Dune::BlockVector<VectorBlockType>        Vector;
         typedef Dune::MatrixAdapter<Mat,Vector,Vector> Operator;
 
+        // Single precision types for preconditioners.
+        typedef Dune::FieldVector<float, 1   > FloatVectorBlockType;
+        typedef Dune::FieldMatrix<float, 1, 1> FloatMatrixBlockType;
+        typedef Dune::BCRSMatrix <FloatMatrixBlockType>          FloatMat;
+        typedef Dune::BlockVector<FloatVectorBlockType>          FloatVector;
+        typedef Dune::MatrixAdapter<FloatMat,FloatVector,FloatVector> FloatOperator;
+
         template<class O, class S, class C>
         LinearSolverInterface::LinearSolverReport
-        solveCG_ILU0(O& A, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity);
+        solveCG_ILU0(O& A, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity,
+                     DeflatedConjugateGradient* recycle = 0);
 
         template<class O, class S, class C>
         LinearSolverInterface::LinearSolverReport
         solveCG_AMG(O& A, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity,
-                    double prolongateFactor, int smoothsteps);
+                    double prolongateFactor, int smoothsteps, DeflatedConjugateGradient* recycle = 0);
+
+        template<class O, class P>
+        LinearSolverInterface::LinearSolverReport
+        solveRecycledCG(O& A, Vector& x, Vector& b, P& precond, DeflatedConjugateGradient& recycle,
+                        double tolerance, int maxit);
 
 #if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
        template<class O, class S, class C>
@@ -92,11 +112,113 @@ namespace Opm
         template<class O, class S, class C>
         LinearSolverInterface::LinearSolverReport
         solveBiCGStab_ILU0(O& A, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity);
+
+        template<class O, class S, class C>
+        LinearSolverInterface::LinearSolverReport
+        solveSinglePrecisionPreconditioned(O& A, Vector& x, Vector& b, S& sp, const C& comm,
+                                           bool use_amg, bool use_bicgstab,
+                                           double tolerance, int maxit, int verbosity,
+                                           double prolongateFactor, int smoothsteps);
+
+        template<class O, class S>
+        LinearSolverInterface::LinearSolverReport
+        solveSinglePrecisionPreconditioned(O& A, Vector& x, Vector& b, S& sp,
+                                           const Dune::Amg::SequentialInformation& comm,
+                                           bool use_amg, bool use_bicgstab,
+                                           double tolerance, int maxit, int verbosity,
+                                           double prolongateFactor, int smoothsteps);
+
+        // Topological order of the strong components of the matrix
+        // graph, with an edge from row i to each column j != i where
+        // a_ij is nonzero.  Unknowns that others depend on come first.
+        void upwindOrdering(const int size, const int* ia, const int* ja, const double* sa,
+                            std::vector<int>& order)
+        {
+            std::vector<int> gia(size + 1);
+            std::vector<int> gja;
+            gja.reserve(ia[size]);
+            gia[0] = 0;
+            for (int row = 0; row < size; ++row) {
+                for (int i = ia[row]; i < ia[row + 1]; ++i) {
+                    if (ja[i] != row && sa[i] != 0.0) {
+                        gja.push_back(ja[i]);
+                    }
+                }
+                gia[row + 1] = gja.size();
+            }
+            order.resize(size);
+            std::vector<int> comp(size + 1);
+            std::vector<int> work(3*size);
+            int ncomp = 0;
+            tarjan(size, gia.data(), gja.data(), order.data(), comp.data(), &ncomp, work.data());
+        }
     } // anonymous namespace
 
 
 
 
+    // ISTL matrix kept between solves.  The sparsity pattern is only
+    // rebuilt when the caller's ia/ja change; otherwise the values
+    // are copied through precomputed element addresses.
+    struct LinearSolverIstl::MatrixCache
+    {
+        std::vector<int> ia;
+        std::vector<int> ja;
+        std::vector<double*> slot;
+        std::unique_ptr<Mat> A;
+
+        bool matches(const int size, const int nonzeros,
+                     const int* ia_in, const int* ja_in) const
+        {
+            return A
+                && int(ia.size()) == size + 1 && int(ja.size()) == nonzeros
+                && std::equal(ia.begin(), ia.end(), ia_in)
+                && std::equal(ja.begin(), ja.end(), ja_in);
+        }
+
+        Mat& update(const int size, const int nonzeros,
+                    const int* ia_in, const int* ja_in, const double* sa)
+        {
+            if (!matches(size, nonzeros, ia_in, ja_in)) {
+                ia.assign(ia_in, ia_in + size + 1);
+                ja.assign(ja_in, ja_in + nonzeros);
+                A.reset(new Mat(size, size, nonzeros, Mat::row_wise));
+                for (Mat::CreateIterator row = A->createbegin(); row != A->createend(); ++row) {
+                    int ri = row.index();
+                    for (int i = ia_in[ri]; i < ia_in[ri + 1]; ++i) {
+                        row.insert(ja_in[i]);
+                    }
+                }
+                slot.resize(nonzeros);
+                for (int ri = 0; ri < size; ++ri) {
+                    for (int i = ia_in[ri]; i < ia_in[ri + 1]; ++i) {
+                        slot[i] = &(*A)[ri][ja_in[i]][0][0];
+                    }
+                }
+            }
+            for (int i = 0; i < nonzeros; ++i) {
+                *slot[i] = sa[i];
+            }
+            return *A;
+        }
+
+        // Bytes of the copied pattern, the slots and the matrix rows,
+        // blocks and column indices.
+        std::size_t bytes() const
+        {
+            std::size_t n = sizeof(int) * (ia.capacity() + ja.capacity())
+                + sizeof(double*) * slot.capacity();
+            if (A) {
+                n += sizeof(Mat::row_type) * A->N()
+                    + (sizeof(Mat::block_type) + sizeof(Mat::size_type)) * A->nonzeroes();
+            }
+            return n;
+        }
+    };
+
+
+
+
     LinearSolverIstl::LinearSolverIstl()
         : linsolver_residual_tolerance_(1e-8),
           linsolver_verbosity_(0),
@@ -104,7 +226,16 @@ namespace Opm
           linsolver_save_system_(false),
           linsolver_max_iterations_(0),
           linsolver_smooth_steps_(2),
-          linsolver_prolongate_factor_(1.6)
+          linsolver_prolongate_factor_(1.6),
+          linsolver_reuse_setup_(0),
+          cpr_true_impes_(false),
+          cpr_pressure_index_(0),
+          linsolver_persistent_matrix_(true),
+          linsolver_initial_guess_(false),
+          linsolver_single_precision_(false),
+          linsolver_recycle_vectors_(0),
+          linsolver_recycle_directions_(0),
+          linsolver_ilu_ordering_(NaturalOrdering)
     {
     }
 
@@ -118,7 +249,16 @@ namespace Opm
           linsolver_save_system_(false),
           linsolver_max_iterations_(0),
           linsolver_smooth_steps_(2),
-          linsolver_prolongate_factor_(1.6)
+          linsolver_prolongate_factor_(1.6),
+          linsolver_reuse_setup_(0),
+          cpr_true_impes_(false),
+          cpr_pressure_index_(0),
+          linsolver_persistent_matrix_(true),
+          linsolver_initial_guess_(false),
+          linsolver_single_precision_(false),
+          linsolver_recycle_vectors_(0),
+          linsolver_recycle_directions_(0),
+          linsolver_ilu_ordering_(NaturalOrdering)
     {
         linsolver_residual_tolerance_ = param.getDefault("linsolver_residual_tolerance", linsolver_residual_tolerance_);
         linsolver_verbosity_ = param.getDefault("linsolver_verbosity", linsolver_verbosity_);
@@ -130,11 +270,46 @@ namespace Opm
         linsolver_max_iterations_ = param.getDefault("linsolver_max_iterations", linsolver_max_iterations_);
         linsolver_smooth_steps_ = param.getDefault("linsolver_smooth_steps", linsolver_smooth_steps_);
         linsolver_prolongate_factor_ = param.getDefault("linsolver_prolongate_factor", linsolver_prolongate_factor_);
+        linsolver_reuse_setup_ = param.getDefault("linsolver_reuse_setup", linsolver_reuse_setup_);
+        const std::string cpr_weights = param.getDefault<std::string>("cpr_weights", "quasi_impes");
+        if (cpr_weights == "true_impes") {
+            cpr_true_impes_ = true;
+        } else if (cpr_weights != "quasi_impes") {
+            OPM_THROW(std::runtime_error, "Unknown cpr_weights: " << cpr_weights);
+        }
+        cpr_pressure_index_ = param.getDefault("cpr_pressure_index", cpr_pressure_index_);
+        linsolver_persistent_matrix_ = param.getDefault("linsolver_persistent_matrix", linsolver_persistent_matrix_);
+        linsolver_initial_guess_ = param.getDefault("linsolver_initial_guess", linsolver_initial_guess_);
+        linsolver_single_precision_ = param.getDefault("linsolver_single_precision_preconditioner",
+                                                       linsolver_single_precision_);
+        linsolver_recycle_vectors_ = param.getDefault("linsolver_recycle_vectors", linsolver_recycle_vectors_);
+        linsolver_recycle_directions_ = param.getDefault("linsolver_recycle_directions",
+                                                         2*linsolver_recycle_vectors_);
+        const std::string ilu_ordering = param.getDefault<std::string>("linsolver_ilu_ordering", "natural");
+        if (ilu_ordering == "upwind") {
+            linsolver_ilu_ordering_ = UpwindOrdering;
+        } else if (ilu_ordering == "sequence") {
+            linsolver_ilu_ordering_ = SequenceOrdering;
+        } else if (ilu_ordering != "natural") {
+            OPM_THROW(std::runtime_error, "Unknown linsolver_ilu_ordering: " << ilu_ordering);
+        }
     }
 
     LinearSolverIstl::~LinearSolverIstl()
     {}
 
+    DeflatedConjugateGradient* LinearSolverIstl::recycleSpace() const
+    {
+        if (linsolver_recycle_vectors_ <= 0) {
+            return 0;
+        }
+        if (!recycle_space_) {
+            recycle_space_.reset(new DeflatedConjugateGradient(linsolver_recycle_vectors_,
+                                                               linsolver_recycle_directions_));
+        }
+        return recycle_space_.get();
+    }
+
     LinearSolverInterface::LinearSolverReport
     LinearSolverIstl::solve(const int size,
                             const int nonzeros,
@@ -145,25 +320,31 @@ namespace Opm
                             double* solution,
                             const boost::any& comm) const
     {
-        // Build Istl structures from input.
-        // System matrix
-        Mat A(size, size, nonzeros, Mat::row_wise);
-        for (Mat::CreateIterator row = A.createbegin(); row != A.createend(); ++row) {
-            int ri = row.index();
-            for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
-                row.insert(ja[i]);
-            }
-        }
-        for (int ri = 0; ri < size; ++ri) {
-            for (int i = ia[ri]; i < ia[ri + 1]; ++i) {
-                A[ri][ja[i]] = sa[i];
-            }
-        }
-
         int maxit = linsolver_max_iterations_;
         if (maxit == 0) {
             maxit = 5000;
         }
+
+        const bool amg_type = (linsolver_type_ == CG_AMG) || (linsolver_type_ == KAMG)
+            || (linsolver_type_ == FastAMG);
+        if (linsolver_reuse_setup_ > 0 && amg_type && !linsolver_save_system_
+            && !(linsolver_single_precision_ && linsolver_type_ == CG_AMG)
+#if HAVE_MPI
+            && comm.type() != typeid(ParallelISTLInformation)
+#endif
+            ) {
+            return solveReusingSetup(size, nonzeros, ia, ja, sa, rhs, solution, maxit);
+        }
+
+        const bool ilu_type = (linsolver_type_ == CG_ILU0) || (linsolver_type_ == BiCGStab_ILU0);
+        if (linsolver_ilu_ordering_ != NaturalOrdering && ilu_type
+#if HAVE_MPI
+            && comm.type() != typeid(ParallelISTLInformation)
+#endif
+            ) {
+            return solveReordered(size, nonzeros, ia, ja, sa, rhs, solution, maxit);
+        }
+
 #if HAVE_MPI
         if(comm.type()==typeid(ParallelISTLInformation))
         {
@@ -171,6 +352,17 @@ namespace Opm
             const ParallelISTLInformation& info = boost::any_cast<const ParallelISTLInformation&>(comm);
             Comm istlComm(info.communicator());
             info.copyValuesTo(istlComm.indexSet(), istlComm.remoteIndices());
+            // System matrix, reusing the allocation of an earlier call
+            // with the same sparsity pattern if possible.
+            MatrixCache local_cache;
+            MatrixCache* cache = &local_cache;
+            if (linsolver_persistent_matrix_) {
+                if (!matrix_cache_) {
+                    matrix_cache_.reset(new MatrixCache);
+                }
+                cache = matrix_cache_.get();
+            }
+            Mat& A = cache->update(size, nonzeros, ia, ja, sa);
             Dune::OverlappingSchwarzOperator<Mat,Vector,Vector, Comm>
                 opA(A, istlComm);
             Dune::OverlappingSchwarzScalarProduct<Vector,Comm> sp(istlComm);
@@ -180,11 +372,94 @@ namespace Opm
 #endif
         {
             (void) comm; // Avoid warning for unused argument if no MPI.
-            Dune::SeqScalarProduct<Vector> sp;
-            Dune::Amg::SequentialInformation seq_comm;
-            Operator opA(A);
-            return solveSystem(opA, solution, rhs, sp, seq_comm, maxit);
+            return solveSequential(size, nonzeros, ia, ja, sa, rhs, solution, maxit);
+        }
+    }
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveSequential(const int size,
+                                      const int nonzeros,
+                                      const int* ia,
+                                      const int* ja,
+                                      const double* sa,
+                                      const double* rhs,
+                                      double* solution,
+                                      int maxit) const
+    {
+        // Build Istl structures from input.
+        // System matrix, reusing the allocation of an earlier call
+        // with the same sparsity pattern if possible.
+        MatrixCache local_cache;
+        MatrixCache* cache = &local_cache;
+        if (linsolver_persistent_matrix_) {
+            if (!matrix_cache_) {
+                matrix_cache_.reset(new MatrixCache);
+            }
+            cache = matrix_cache_.get();
         }
+        Mat& A = cache->update(size, nonzeros, ia, ja, sa);
+
+        Dune::SeqScalarProduct<Vector> sp;
+        Dune::Amg::SequentialInformation seq_comm;
+        Operator opA(A);
+        return solveSystem(opA, solution, rhs, sp, seq_comm, maxit);
+    }
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveReordered(const int size,
+                                     const int nonzeros,
+                                     const int* ia,
+                                     const int* ja,
+                                     const double* sa,
+                                     const double* rhs,
+                                     double* solution,
+                                     int maxit) const
+    {
+        // order[k] is the unknown placed k'th in the permuted system,
+        // pos[] the inverse permutation.
+        std::vector<int> order;
+        if (linsolver_ilu_ordering_ == SequenceOrdering) {
+            if (int(ilu_sequence_.size()) != size) {
+                OPM_THROW(std::runtime_error, "linsolver_ilu_ordering sequence needs an order of all "
+                          << size << " unknowns, setOrdering() gave " << ilu_sequence_.size() << ".");
+            }
+            order = ilu_sequence_;
+        } else {
+            upwindOrdering(size, ia, ja, sa, order);
+        }
+        std::vector<int> pos(size, -1);
+        for (int k = 0; k < size; ++k) {
+            if (order[k] < 0 || order[k] >= size || pos[order[k]] != -1) {
+                OPM_THROW(std::runtime_error, "The order given to setOrdering() is not a permutation.");
+            }
+            pos[order[k]] = k;
+        }
+
+        // The permuted system P A P^T y = P b, with x = P^T y.
+        std::vector<int> pia(size + 1);
+        std::vector<int> pja(nonzeros);
+        std::vector<double> psa(nonzeros);
+        std::vector<double> prhs(size);
+        std::vector<double> psolution(size);
+        pia[0] = 0;
+        for (int k = 0; k < size; ++k) {
+            const int row = order[k];
+            int p = pia[k];
+            for (int i = ia[row]; i < ia[row + 1]; ++i, ++p) {
+                pja[p] = pos[ja[i]];
+                psa[p] = sa[i];
+            }
+            pia[k + 1] = p;
+            prhs[k] = rhs[row];
+            psolution[k] = solution[row];
+        }
+
+        const LinearSolverReport res = solveSequential(size, nonzeros, pia.data(), pja.data(), psa.data(),
+                                                       prhs.data(), psolution.data(), maxit);
+        for (int k = 0; k < size; ++k) {
+            solution[order[k]] = psolution[k];
+        }
+        return res;
     }
 
     template<class O, class S, class C>
@@ -199,7 +474,12 @@ namespace Opm
         comm.copyOwnerToAll(b,b);
         // System solution
         Vector x(opA.getmat().M());
-        x = 0.0;
+        if (linsolver_initial_guess_) {
+            std::copy(solution, solution + x.size(), x.begin());
+            comm.copyOwnerToAll(x,x);
+        } else {
+            x = 0.0;
+        }
 
         if (linsolver_save_system_)
         {
@@ -214,13 +494,29 @@ namespace Opm
         }
 
         LinearSolverReport res;
-        switch (linsolver_type_) {
+        // Recycling is only implemented for sequential scalar products.
+        DeflatedConjugateGradient* recycle
+            = std::is_same<C, Dune::Amg::SequentialInformation>::value ? recycleSpace() : 0;
+        const bool single_precision = linsolver_single_precision_
+            && std::is_same<C, Dune::Amg::SequentialInformation>::value
+            && (linsolver_type_ == CG_ILU0 || linsolver_type_ == CG_AMG
+                || linsolver_type_ == BiCGStab_ILU0);
+        if (single_precision) {
+            res = solveSinglePrecisionPreconditioned(opA, x, b, sp, comm,
+                                                     linsolver_type_ == CG_AMG,
+                                                     linsolver_type_ == BiCGStab_ILU0,
+                                                     linsolver_residual_tolerance_, maxit,
+                                                     linsolver_verbosity_,
+                                                     linsolver_prolongate_factor_,
+                                                     linsolver_smooth_steps_);
+        } else switch (linsolver_type_) {
         case CG_ILU0:
-            res = solveCG_ILU0(opA, x, b, sp, comm, linsolver_residual_tolerance_, maxit, linsolver_verbosity_);
+            res = solveCG_ILU0(opA, x, b, sp, comm, linsolver_residual_tolerance_, maxit, linsolver_verbosity_,
+                               recycle);
             break;
         case CG_AMG:
             res = solveCG_AMG(opA, x, b, sp, comm, linsolver_residual_tolerance_, maxit, linsolver_verbosity_,
-                              linsolver_prolongate_factor_, linsolver_smooth_steps_);
+                              linsolver_prolongate_factor_, linsolver_smooth_steps_, recycle);
             break;
         case KAMG:
 #if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
@@ -252,14 +548,59 @@ namespace Opm
         case BiCGStab_ILU0:
             res = solveBiCGStab_ILU0(opA, x, b, sp, comm, linsolver_residual_tolerance_, maxit, linsolver_verbosity_);
             break;
+        case CPR:
+            OPM_THROW(std::runtime_error, "The CPR solver requires a block system, use solveBlock().");
         default:
             std::cerr << "Unknown linsolver_type: " << int(linsolver_type_) << '\n';
             throw std::runtime_error("Unknown linsolver_type");
         }
+        res.setup_reused = false;
         std::copy(x.begin(), x.end(), solution);
         return res;
     }
 
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveMultiple(const int size,
+                                    const int nonzeros,
+                                    const int* ia,
+                                    const int* ja,
+                                    const double* sa,
+                                    const int nrhs,
+                                    const double* rhs,
+                                    double* solution) const
+    {
+        const bool amg_type = (linsolver_type_ == CG_AMG) || (linsolver_type_ == KAMG)
+            || (linsolver_type_ == FastAMG);
+        if (!amg_type || linsolver_save_system_ || linsolver_single_precision_ || nrhs < 2) {
+            return LinearSolverInterface::solveMultiple(size, nonzeros, ia, ja, sa,
+                                                        nrhs, rhs, solution);
+        }
+        int maxit = linsolver_max_iterations_;
+        if (maxit == 0) {
+            maxit = 5000;
+        }
+
+        // The first solve sets up (or refreshes) the hierarchy, the
+        // others use it as it is.
+        LinearSolverReport total = { true, 0, 0.0, false };
+        for (int k = 0; k < nrhs; ++k) {
+            const LinearSolverReport rep =
+                solveReusingSetup(size, nonzeros, ia, ja, sa, rhs + k*size, solution + k*size,
+                                  maxit, k > 0);
+            accumulateReport(total, rep);
+        }
+        if (linsolver_reuse_setup_ == 0) {
+            // Do not keep the hierarchy if solve() would not use it.
+            amg_cache_.reset();
+        }
+        return total;
+    }
+
+    void LinearSolverIstl::setOrdering(const std::vector<int>& sequence)
+    {
+        ilu_sequence_ = sequence;
+    }
+
     void LinearSolverIstl::setTolerance(const double tol)
     {
         linsolver_residual_tolerance_ = tol;
@@ -315,12 +656,16 @@ namespace Opm
 
     template<class O, class S, class C>
     LinearSolverInterface::LinearSolverReport
-    solveCG_ILU0(O& opA, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity)
+    solveCG_ILU0(O& opA, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity,
+                 DeflatedConjugateGradient* recycle)
     {
 
         // Construct preconditioner.
         typedef Dune::SeqILU0<Mat,Vector,Vector> Preconditioner;
         auto precond = makePreconditioner<Preconditioner>(opA, 1.0, comm);
+        if (recycle) {
+            return solveRecycledCG(opA, x, b, *precond, *recycle, tolerance, maxit);
+        }
 
         // Construct linear solver.
         Dune::CGSolver<Vector> linsolve(opA, sp, *precond, tolerance, maxit, verbosity);
@@ -361,7 +706,8 @@ namespace Opm
     template<class O, class S, class C>
     LinearSolverInterface::LinearSolverReport
     solveCG_AMG(O& opA, Vector& x, Vector& b, S& sp, const C& comm, double tolerance, int maxit, int verbosity,
-                double linsolver_prolongate_factor, int linsolver_smooth_steps)
+                double linsolver_prolongate_factor, int linsolver_smooth_steps,
+                DeflatedConjugateGradient* recycle)
     {
         // Solve with AMG solver.
 
@@ -392,6 +738,9 @@ namespace Opm
         setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
                        linsolver_smooth_steps);
         Precond precond(opA, criterion, smootherArgs, comm);
+        if (recycle) {
+            return solveRecycledCG(opA, x, b, precond, *recycle, tolerance, maxit);
+        }
 
         // Construct linear solver.
         Dune::CGSolver<Vector> linsolve(opA, sp, precond, tolerance, maxit, verbosity);
@@ -538,7 +887,774 @@ namespace Opm
 
 
 
+    /// Solve the small dense system M^T w = e_p by Gaussian
+    /// elimination with partial pivoting. M is n-by-n, row major.
+    void solveTransposedUnit(const int n, const double* M, const int p, double* w)
+    {
+        std::vector<double> T(n*n);
+        for (int r = 0; r < n; ++r) {
+            for (int c = 0; c < n; ++c) {
+                T[r*n + c] = M[c*n + r];
+            }
+            w[r] = (r == p) ? 1.0 : 0.0;
+        }
+        for (int k = 0; k < n; ++k) {
+            int piv = k;
+            for (int r = k + 1; r < n; ++r) {
+                if (std::fabs(T[r*n + k]) > std::fabs(T[piv*n + k])) {
+                    piv = r;
+                }
+            }
+            if (T[piv*n + k] == 0.0) {
+                OPM_THROW(std::runtime_error, "Singular diagonal block in CPR weight computation.");
+            }
+            if (piv != k) {
+                for (int c = 0; c < n; ++c) {
+                    std::swap(T[k*n + c], T[piv*n + c]);
+                }
+                std::swap(w[k], w[piv]);
+            }
+            for (int r = k + 1; r < n; ++r) {
+                const double f = T[r*n + k] / T[k*n + k];
+                for (int c = k; c < n; ++c) {
+                    T[r*n + c] -= f * T[k*n + c];
+                }
+                w[r] -= f * w[k];
+            }
+        }
+        for (int k = n - 1; k >= 0; --k) {
+            double s = w[k];
+            for (int c = k + 1; c < n; ++c) {
+                s -= T[k*n + c] * w[c];
+            }
+            w[k] = s / T[k*n + k];
+        }
+    }
+
+
+
+
+    /// Two-stage constrained pressure residual preconditioner.
+    /// The first stage solves the pressure system (one AMG V-cycle),
+    /// the second stage applies ILU0 of the full system to the
+    /// residual remaining after the pressure correction.
+    class CPRPreconditioner : public Dune::Preconditioner<Vector,Vector>
+    {
+    public:
+#if FIRST_DIAGONAL
+        typedef Dune::Amg::FirstDiagonal CouplingMetric;
+#else
+        typedef Dune::Amg::RowSum        CouplingMetric;
+#endif
+        typedef Dune::Amg::SymmetricCriterion<Mat,CouplingMetric> CriterionBase;
+        typedef Dune::Amg::CoarsenCriterion<CriterionBase>       Criterion;
+        typedef Dune::SeqSOR<Mat,Vector,Vector>                  Smoother;
+        typedef Dune::Amg::AMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation> PressureAmg;
+
+#if !DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        enum { category = Dune::SolverCategory::sequential };
+#endif
+
+        /// \param[in] A              full system, unknowns numbered block by block
+        /// \param[in] opP            operator of the pressure system
+        /// \param[in] weights        pressure restriction weights, one per unknown
+        /// \param[in] block_size     number of unknowns per block
+        /// \param[in] pressure_index index of the pressure unknown in each block
+        CPRPreconditioner(const Mat& A, const Operator& opP,
+                          const std::vector<double>& weights,
+                          const int block_size, const int pressure_index,
+                          const double prolongate_factor, const int verbosity,
+                          const int smooth_steps)
+            : A_(A), weights_(weights), bs_(block_size), pidx_(pressure_index),
+              ilu_(A, 1.0),
+              rp_(opP.getmat().N()), xp_(opP.getmat().N()), r_(A.N()), dv_(A.N())
+        {
+            Criterion criterion;
+            PressureAmg::SmootherArgs smootherArgs;
+            setUpCriterion(criterion, prolongate_factor, verbosity, smooth_steps);
+            amg_.reset(new PressureAmg(opP, criterion, smootherArgs, seq_comm_));
+        }
+
+        virtual void pre(Vector& x, Vector& b)
+        {
+            xp_ = 0.0;
+            rp_ = 0.0;
+            amg_->pre(xp_, rp_);
+            ilu_.pre(x, b);
+        }
+
+        virtual void apply(Vector& v, const Vector& d)
+        {
+            // Stage 1: restrict residual, solve for pressure, prolongate.
+            const int nb = rp_.size();
+            for (int i = 0; i < nb; ++i) {
+                double s = 0.0;
+                for (int k = 0; k < bs_; ++k) {
+                    s += weights_[i*bs_ + k] * d[i*bs_ + k];
+                }
+                rp_[i] = s;
+            }
+            xp_ = 0.0;
+            amg_->apply(xp_, rp_);
+            v = 0.0;
+            for (int i = 0; i < nb; ++i) {
+                v[i*bs_ + pidx_] = xp_[i];
+            }
+
+            // Stage 2: ILU0 on the residual of the full system.
+            r_ = d;
+            A_.mmv(v, r_);
+            dv_ = 0.0;
+            ilu_.apply(dv_, r_);
+            v += dv_;
+        }
+
+        virtual void post(Vector& x)
+        {
+            amg_->post(xp_);
+            ilu_.post(x);
+        }
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        virtual Dune::SolverCategory::Category category() const
+        {
+            return Dune::SolverCategory::sequential;
+        }
+#endif
+
+    private:
+        const Mat& A_;
+        const std::vector<double>& weights_;
+        int bs_;
+        int pidx_;
+        Dune::SeqILU0<Mat,Vector,Vector> ilu_;
+        Dune::Amg::SequentialInformation seq_comm_;
+        std::unique_ptr<PressureAmg> amg_;
+        Vector rp_;
+        Vector xp_;
+        Vector r_;
+        Vector dv_;
+    };
+
+
+
+
+    /// Applies a preconditioner built on a single precision copy of the
+    /// system matrix to double precision vectors. The Krylov solver and
+    /// its residuals stay in double precision, while the preconditioner
+    /// data (ILU factors, AMG hierarchy) take half the memory traffic.
+    /// 	param P single precision preconditioner
+    template<class P>
+    class SinglePrecisionPreconditioner : public Dune::Preconditioner<Vector,Vector>
+    {
+    public:
+#if !DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        enum { category = Dune::SolverCategory::sequential };
+#endif
+
+        /// \param[in] A     system matrix
+        /// \param[in] make  callable creating the preconditioner from the
+        ///                  single precision operator and a sequential
+        ///                  communication object, with new
+        template<class Make>
+        SinglePrecisionPreconditioner(const Mat& A, Make make)
+            : A_(A.N(), A.M(), A.nonzeroes(), FloatMat::row_wise),
+              op_(A_), d_(A.N()), v_(A.N())
+        {
+            for (FloatMat::CreateIterator row = A_.createbegin(); row != A_.createend(); ++row) {
+                const Mat::row_type& arow = A[row.index()];
+                for (Mat::ConstColIterator col = arow.begin(); col != arow.end(); ++col) {
+                    row.insert(col.index());
+                }
+            }
+            for (std::size_t i = 0; i < A.N(); ++i) {
+                const Mat::row_type& arow = A[i];
+                for (Mat::ConstColIterator col = arow.begin(); col != arow.end(); ++col) {
+                    A_[i][col.index()][0][0] = static_cast<float>((*col)[0][0]);
+                }
+            }
+            precond_.reset(make(op_, seq_comm_));
+        }
+
+        virtual void pre(Vector& /* x */, Vector& /* b */)
+        {
+            v_ = 0.0;
+            d_ = 0.0;
+            precond_->pre(v_, d_);
+        }
+
+        virtual void apply(Vector& v, const Vector& d)
+        {
+            const std::size_t n = d_.size();
+            for (std::size_t i = 0; i < n; ++i) {
+                d_[i][0] = static_cast<float>(d[i][0]);
+            }
+            v_ = 0.0;
+            precond_->apply(v_, d_);
+            for (std::size_t i = 0; i < n; ++i) {
+                v[i][0] = v_[i][0];
+            }
+        }
+
+        virtual void post(Vector& /* x */)
+        {
+            precond_->post(v_);
+        }
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        virtual Dune::SolverCategory::Category category() const
+        {
+            return Dune::SolverCategory::sequential;
+        }
+#endif
+
+    private:
+        FloatMat A_;
+        FloatOperator op_;
+        Dune::Amg::SequentialInformation seq_comm_;
+        std::unique_ptr<P> precond_;
+        FloatVector d_;
+        FloatVector v_;
+    };
+
+
+
+
+    template<class O, class S, class C>
+    LinearSolverInterface::LinearSolverReport
+    solveSinglePrecisionPreconditioned(O& /* opA */, Vector& /* x */, Vector& /* b */, S& /* sp */,
+                                       const C& /* comm */, bool /* use_amg */, bool /* use_bicgstab */,
+                                       double /* tolerance */, int /* maxit */, int /* verbosity */,
+                                       double /* prolongateFactor */, int /* smoothsteps */)
+    {
+        OPM_THROW(std::logic_error, "Single precision preconditioners are only available in sequential solves.");
+    }
+
+    template<class O, class S, class P>
+    LinearSolverInterface::LinearSolverReport
+    solveKrylov(O& opA, Vector& x, Vector& b, S& sp, P& precond, bool use_bicgstab,
+                double tolerance, int maxit, int verbosity)
+    {
+        // Construct linear solver and solve system.
+        Dune::InverseOperatorResult result;
+        if (use_bicgstab) {
+            Dune::BiCGSTABSolver<Vector> linsolve(opA, sp, precond, tolerance, maxit, verbosity);
+            linsolve.apply(x, b, result);
+        } else {
+            Dune::CGSolver<Vector> linsolve(opA, sp, precond, tolerance, maxit, verbosity);
+            linsolve.apply(x, b, result);
+        }
+
+        // Output results.
+        LinearSolverInterface::LinearSolverReport res;
+        res.converged = result.converged;
+        res.iterations = result.iterations;
+        res.residual_reduction = result.reduction;
+        return res;
+    }
+
+    template<class O, class P>
+    LinearSolverInterface::LinearSolverReport
+    solveRecycledCG(O& opA, Vector& x, Vector& b, P& precond, DeflatedConjugateGradient& recycle,
+                    double tolerance, int maxit)
+    {
+        precond.pre(x, b);
+        const int n = b.size();
+        Vector in(n);
+        Vector out(n);
+        DeflatedConjugateGradient::Operator apply = [&](const double* v, double* y) {
+            std::copy(v, v + n, in.begin());
+            opA.apply(in, out);
+            std::copy(out.begin(), out.end(), y);
+        };
+        DeflatedConjugateGradient::Operator prec = [&](const double* r, double* z) {
+            std::copy(r, r + n, in.begin());
+            out = 0.0;
+            precond.apply(out, in);
+            std::copy(out.begin(), out.end(), z);
+        };
+        std::vector<double> rhs(b.begin(), b.end());
+        std::vector<double> sol(x.begin(), x.end());
+        LinearSolverInterface::LinearSolverReport res
+            = recycle.solve(n, apply, prec, rhs.data(), sol.data(), tolerance, maxit);
+        std::copy(sol.begin(), sol.end(), x.begin());
+        precond.post(x);
+        return res;
+    }
+
+    template<class O, class S>
+    LinearSolverInterface::LinearSolverReport
+    solveSinglePrecisionPreconditioned(O& opA, Vector& x, Vector& b, S& sp,
+                                       const Dune::Amg::SequentialInformation& /* comm */,
+                                       bool use_amg, bool use_bicgstab,
+                                       double tolerance, int maxit, int verbosity,
+                                       double linsolver_prolongate_factor, int linsolver_smooth_steps)
+    {
+        // Construct preconditioner and solve.
+        if (use_amg) {
+#if FIRST_DIAGONAL
+            typedef Dune::Amg::FirstDiagonal CouplingMetric;
+#else
+            typedef Dune::Amg::RowSum        CouplingMetric;
+#endif
+#if SYMMETRIC
+            typedef Dune::Amg::SymmetricCriterion<FloatMat,CouplingMetric>   CriterionBase;
+#else
+            typedef Dune::Amg::UnSymmetricCriterion<FloatMat,CouplingMetric> CriterionBase;
+#endif
+#if SMOOTHER_ILU
+            typedef Dune::SeqILU0<FloatMat,FloatVector,FloatVector>        Smoother;
+#else
+            typedef Dune::SeqSOR<FloatMat,FloatVector,FloatVector>         Smoother;
+#endif
+            typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
+            typedef Dune::Amg::AMG<FloatOperator,FloatVector,Smoother,Dune::Amg::SequentialInformation> Precond;
+            auto make = [&](const FloatOperator& op, const Dune::Amg::SequentialInformation& comm) {
+                Criterion criterion;
+                typename Precond::SmootherArgs smootherArgs;
+                setUpCriterion(criterion, linsolver_prolongate_factor, verbosity,
+                               linsolver_smooth_steps);
+                return new Precond(op, criterion, smootherArgs, comm);
+            };
+            SinglePrecisionPreconditioner<Precond> precond(opA.getmat(), make);
+            return solveKrylov(opA, x, b, sp, precond, use_bicgstab, tolerance, maxit, verbosity);
+        } else {
+            typedef Dune::SeqILU0<FloatMat,FloatVector,FloatVector> Precond;
+            auto make = [](const FloatOperator& op, const Dune::Amg::SequentialInformation&) {
+                return new Precond(op.getmat(), 1.0);
+            };
+            SinglePrecisionPreconditioner<Precond> precond(opA.getmat(), make);
+            return solveKrylov(opA, x, b, sp, precond, use_bicgstab, tolerance, maxit, verbosity);
+        }
+    }
+
+
+
+
+    /// Wraps a LinearOperatorInterface as an ISTL linear operator.
+    class MatrixFreeAdapter : public Dune::LinearOperator<Vector,Vector>
+    {
+    public:
+#if !DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        enum { category = Dune::SolverCategory::sequential };
+#endif
+
+        explicit MatrixFreeAdapter(const LinearOperatorInterface& A)
+            : A_(A), y_(A.size())
+        {
+        }
+
+        virtual void apply(const Vector& x, Vector& y) const
+        {
+            A_.apply(&x[0][0], &y[0][0]);
+        }
+
+        virtual void applyscaleadd(field_type alpha, const Vector& x, Vector& y) const
+        {
+            A_.apply(&x[0][0], &y_[0][0]);
+            y.axpy(alpha, y_);
+        }
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        virtual Dune::SolverCategory::Category category() const
+        {
+            return Dune::SolverCategory::sequential;
+        }
+#endif
+
+    private:
+        const LinearOperatorInterface& A_;
+        mutable Vector y_;
+    };
+
+
+
+
+    /// Jacobi preconditioner using the diagonal of a matrix-free operator.
+    class DiagonalPreconditioner : public Dune::Preconditioner<Vector,Vector>
+    {
+    public:
+#if !DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        enum { category = Dune::SolverCategory::sequential };
+#endif
+
+        explicit DiagonalPreconditioner(const LinearOperatorInterface& A)
+            : inv_diag_(A.size())
+        {
+            const double* diag = A.diagonal();
+            for (int i = 0; i < A.size(); ++i) {
+                inv_diag_[i] = 1.0 / diag[i];
+            }
+        }
+
+        virtual void pre(Vector& /* x */, Vector& /* b */)
+        {
+        }
+
+        virtual void apply(Vector& v, const Vector& d)
+        {
+            const std::size_t n = d.size();
+            for (std::size_t i = 0; i < n; ++i) {
+                v[i][0] = inv_diag_[i] * d[i][0];
+            }
+        }
+
+        virtual void post(Vector& /* x */)
+        {
+        }
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2, 6)
+        virtual Dune::SolverCategory::Category category() const
+        {
+            return Dune::SolverCategory::sequential;
+        }
+#endif
+
+    private:
+        std::vector<double> inv_diag_;
+    };
+
+
+
+
     } // anonymous namespace
 
 
+
+
+    // The fine-level matrix is kept in the cache and updated in
+    // place, so the AMG hierarchies below (which refer to the
+    // operator's matrix) always see the current fine-level values.
+    // For CG_AMG the Galerkin products of the coarse levels are
+    // recomputed using the existing aggregates; for KAMG and FastAMG
+    // the coarse levels are kept as is.
+    struct LinearSolverIstl::AmgCache
+    {
+        MatrixCache matrix;
+        std::unique_ptr<Operator> op;
+        std::unique_ptr<Dune::Preconditioner<Vector,Vector> > precond;
+        std::function<void()> recalculate;
+        Dune::Amg::SequentialInformation seq_comm;
+        int type;
+        int uses;
+
+        bool matches(const int size, const int nonzeros, const int* ia_in,
+                     const int* ja_in, const int solver_type) const
+        {
+            return type == solver_type
+                && matrix.matches(size, nonzeros, ia_in, ja_in);
+        }
+    };
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveReusingSetup(const int size,
+                                        const int nonzeros,
+                                        const int* ia,
+                                        const int* ja,
+                                        const double* sa,
+                                        const double* rhs,
+                                        double* solution,
+                                        int maxit,
+                                        bool force_reuse) const
+    {
+        const bool reuse = amg_cache_
+            && (force_reuse || amg_cache_->uses < linsolver_reuse_setup_ + 1)
+            && amg_cache_->matches(size, nonzeros, ia, ja, int(linsolver_type_));
+
+        if (reuse) {
+            // Copy new values into existing matrix, refresh hierarchy.
+            // Forced reuse is for unchanged values, so nothing to do.
+            if (!force_reuse) {
+                amg_cache_->matrix.update(size, nonzeros, ia, ja, sa);
+                if (amg_cache_->recalculate) {
+                    amg_cache_->recalculate();
+                }
+            }
+        } else {
+            std::shared_ptr<AmgCache> cache(new AmgCache);
+            cache->type = int(linsolver_type_);
+            cache->uses = 0;
+
+            Mat& A = cache->matrix.update(size, nonzeros, ia, ja, sa);
+            cache->op.reset(new Operator(A));
+
+#if FIRST_DIAGONAL
+            typedef Dune::Amg::FirstDiagonal CouplingMetric;
+#else
+            typedef Dune::Amg::RowSum        CouplingMetric;
+#endif
+#if SYMMETRIC
+            typedef Dune::Amg::SymmetricCriterion<Mat,CouplingMetric>   CriterionBase;
+#else
+            typedef Dune::Amg::UnSymmetricCriterion<Mat,CouplingMetric> CriterionBase;
+#endif
+#if SMOOTHER_ILU
+            typedef Dune::SeqILU0<Mat,Vector,Vector>        Smoother;
+#else
+            typedef Dune::SeqSOR<Mat,Vector,Vector>        Smoother;
+#endif
+            typedef Dune::Amg::CoarsenCriterion<CriterionBase> Criterion;
+
+            switch (linsolver_type_) {
+            case CG_AMG: {
+                typedef Dune::Amg::AMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation> Precond;
+                Criterion criterion;
+                Precond::SmootherArgs smootherArgs;
+                setUpCriterion(criterion, linsolver_prolongate_factor_, linsolver_verbosity_,
+                               linsolver_smooth_steps_);
+                Precond* amg = new Precond(*cache->op, criterion, smootherArgs, cache->seq_comm);
+                cache->precond.reset(amg);
+                cache->recalculate = [amg]() { amg->recalculateHierarchy(); };
+                break;
+            }
+#if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
+            case KAMG: {
+                typedef Dune::Amg::KAMG<Operator,Vector,Smoother,Dune::Amg::SequentialInformation> Precond;
+                Criterion criterion;
+                Precond::SmootherArgs smootherArgs;
+                setUpCriterion(criterion, linsolver_prolongate_factor_, linsolver_verbosity_,
+                               linsolver_smooth_steps_);
+                cache->precond.reset(new Precond(*cache->op, criterion, smootherArgs));
+                break;
+            }
+            case FastAMG: {
+                typedef Dune::Amg::AggregationCriterion<Dune::Amg::SymmetricMatrixDependency<Mat,CouplingMetric> > FastCriterionBase;
+                typedef Dune::Amg::CoarsenCriterion<FastCriterionBase> FastCriterion;
+                typedef Dune::Amg::FastAMG<Operator,Vector> Precond;
+                FastCriterion criterion;
+                const int smooth_steps = 1;
+                setUpCriterion(criterion, linsolver_prolongate_factor_, linsolver_verbosity_, smooth_steps);
+                Dune::Amg::Parameters parms;
+                parms.setDebugLevel(linsolver_verbosity_);
+                parms.setNoPreSmoothSteps(smooth_steps);
+                parms.setNoPostSmoothSteps(smooth_steps);
+                parms.setProlongationDampingFactor(linsolver_prolongate_factor_);
+                cache->precond.reset(new Precond(*cache->op, criterion, parms));
+                break;
+            }
+#endif
+            default:
+                OPM_THROW(std::runtime_error, "AMG setup reuse not supported for linsolver_type "
+                          << int(linsolver_type_));
+            }
+            amg_cache_ = cache;
+        }
+        ++amg_cache_->uses;
+
+        Vector b(size);
+        std::copy(rhs, rhs + size, b.begin());
+        Vector x(size);
+        if (linsolver_initial_guess_) {
+            std::copy(solution, solution + size, x.begin());
+        } else {
+            x = 0.0;
+        }
+
+        DeflatedConjugateGradient* recycle = recycleSpace();
+        if (linsolver_type_ == CG_AMG && recycle) {
+            LinearSolverReport res = solveRecycledCG(*amg_cache_->op, x, b, *amg_cache_->precond, *recycle,
+                                                     linsolver_residual_tolerance_, maxit);
+            std::copy(x.begin(), x.end(), solution);
+            res.setup_reused = reuse;
+            return res;
+        }
+
+        Dune::InverseOperatorResult result;
+        if (linsolver_type_ == CG_AMG) {
+            Dune::SeqScalarProduct<Vector> sp;
+            Dune::CGSolver<Vector> linsolve(*amg_cache_->op, sp, *amg_cache_->precond,
+                                            linsolver_residual_tolerance_, maxit, linsolver_verbosity_);
+            linsolve.apply(x, b, result);
+        } else {
+            Dune::GeneralizedPCGSolver<Vector> linsolve(*amg_cache_->op, *amg_cache_->precond,
+                                                        linsolver_residual_tolerance_, maxit,
+                                                        linsolver_verbosity_);
+            linsolve.apply(x, b, result);
+        }
+        std::copy(x.begin(), x.end(), solution);
+
+        LinearSolverReport res;
+        res.converged = result.converged;
+        res.iterations = result.iterations;
+        res.residual_reduction = result.reduction;
+        res.setup_reused = reuse;
+        return res;
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveMatrixFree(const LinearOperatorInterface& A,
+                                      const double* rhs,
+                                      double* solution) const
+    {
+        int maxit = linsolver_max_iterations_;
+        if (maxit == 0) {
+            maxit = 5000;
+        }
+        const int size = A.size();
+
+        Vector b(size);
+        std::copy(rhs, rhs + size, b.begin());
+        Vector x(size);
+        if (linsolver_initial_guess_) {
+            std::copy(solution, solution + size, x.begin());
+        } else {
+            x = 0.0;
+        }
+
+        MatrixFreeAdapter opA(A);
+        DiagonalPreconditioner precond(A);
+        Dune::SeqScalarProduct<Vector> sp;
+        LinearSolverReport res = solveKrylov(opA, x, b, sp, precond, false,
+                                             linsolver_residual_tolerance_, maxit,
+                                             linsolver_verbosity_);
+        std::copy(x.begin(), x.end(), solution);
+        res.setup_reused = false;
+        return res;
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverIstl::solveBlock(const int size,
+                                 const int block_size,
+                                 const int nonzeros,
+                                 const int* ia,
+                                 const int* ja,
+                                 const double* sa,
+                                 const double* rhs,
+                                 double* solution) const
+    {
+        if (linsolver_type_ != CPR) {
+            return LinearSolverInterface::solveBlock(size, block_size, nonzeros,
+                                                     ia, ja, sa, rhs, solution);
+        }
+        if (cpr_pressure_index_ < 0 || cpr_pressure_index_ >= block_size) {
+            OPM_THROW(std::runtime_error, "cpr_pressure_index " << cpr_pressure_index_
+                      << " out of range for block size " << block_size);
+        }
+
+        const int bs  = block_size;
+        const int bs2 = bs * bs;
+        const int p   = cpr_pressure_index_;
+        int maxit = linsolver_max_iterations_;
+        if (maxit == 0) {
+            maxit = 5000;
+        }
+
+        // Full system, unknowns numbered block by block.
+        Mat A(size*bs, size*bs, nonzeros*bs2, Mat::row_wise);
+        for (Mat::CreateIterator row = A.createbegin(); row != A.createend(); ++row) {
+            const int bi = row.index() / bs;
+            for (int b = ia[bi]; b < ia[bi + 1]; ++b) {
+                for (int c = 0; c < bs; ++c) {
+                    row.insert(ja[b]*bs + c);
+                }
+            }
+        }
+        for (int i = 0; i < size; ++i) {
+            for (int b = ia[i]; b < ia[i + 1]; ++b) {
+                const double* blk = sa + b*bs2;
+                for (int r = 0; r < bs; ++r) {
+                    for (int c = 0; c < bs; ++c) {
+                        A[i*bs + r][ja[b]*bs + c] = blk[r*bs + c];
+                    }
+                }
+            }
+        }
+
+        // Pressure restriction weights w_i, solving D_i^T w_i = e_p.
+        // Quasi-IMPES uses the diagonal block as D_i.  True-IMPES uses
+        // the sum of block column i, which for a conservative
+        // discretisation equals the accumulation term of cell i.
+        std::vector<double> D(size*bs2, 0.0);
+        for (int i = 0; i < size; ++i) {
+            bool found_diag = false;
+            for (int b = ia[i]; b < ia[i + 1]; ++b) {
+                const int j = ja[b];
+                if (cpr_true_impes_) {
+                    for (int k = 0; k < bs2; ++k) {
+                        D[j*bs2 + k] += sa[b*bs2 + k];
+                    }
+                } else if (j == i) {
+                    std::copy(sa + b*bs2, sa + (b + 1)*bs2, D.begin() + i*bs2);
+                }
+                found_diag = found_diag || (j == i);
+            }
+            if (!found_diag) {
+                OPM_THROW(std::runtime_error, "Block row " << i << " has no diagonal block.");
+            }
+        }
+        std::vector<double> weights(size*bs);
+        for (int i = 0; i < size; ++i) {
+            solveTransposedUnit(bs, &D[i*bs2], p, &weights[i*bs]);
+        }
+
+        // Pressure system Ap_ij = w_i^T A_ij e_p.
+        Mat Ap(size, size, nonzeros, Mat::row_wise);
+        for (Mat::CreateIterator row = Ap.createbegin(); row != Ap.createend(); ++row) {
+            const int ri = row.index();
+            for (int b = ia[ri]; b < ia[ri + 1]; ++b) {
+                row.insert(ja[b]);
+            }
+        }
+        for (int i = 0; i < size; ++i) {
+            for (int b = ia[i]; b < ia[i + 1]; ++b) {
+                double s = 0.0;
+                for (int r = 0; r < bs; ++r) {
+                    s += weights[i*bs + r] * sa[b*bs2 + r*bs + p];
+                }
+                Ap[i][ja[b]] = s;
+            }
+        }
+
+        Operator opA(A);
+        Operator opP(Ap);
+        CPRPreconditioner precond(A, opP, weights, bs, p, linsolver_prolongate_factor_,
+                                  linsolver_verbosity_, linsolver_smooth_steps_);
+
+        Vector b(size*bs);
+        std::copy(rhs, rhs + size*bs, b.begin());
+        Vector x(size*bs);
+        x = 0.0;
+
+        Dune::SeqScalarProduct<Vector> sp;
+        Dune::BiCGSTABSolver<Vector> linsolve(opA, sp, precond, linsolver_residual_tolerance_,
+                                              maxit, linsolver_verbosity_);
+        Dune::InverseOperatorResult result;
+        linsolve.apply(x, b, result);
+        std::copy(x.begin(), x.end(), solution);
+
+        LinearSolverReport res;
+        res.converged = result.converged;
+        res.iterations = result.iterations;
+        res.residual_reduction = result.reduction;
+        res.setup_reused = false;
+        return res;
+    }
+
+
+
+
+    void LinearSolverIstl::reportMemory(MemoryReport& report) const
+    {
+        MemoryReport& linsolver = report.child("linear solver");
+        if (matrix_cache_) {
+            linsolver.add("persistent matrix", matrix_cache_->bytes());
+        }
+        if (amg_cache_) {
+            linsolver.add("setup matrix", amg_cache_->matrix.bytes());
+        }
+        if (recycle_space_) {
+            linsolver.add("recycled space", recycle_space_->allocatedBytes());
+        }
+    }
+
+
 } // namespace Opm
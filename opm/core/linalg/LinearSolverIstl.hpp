@@ -22,13 +22,18 @@
 
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/linalg/LinearOperatorInterface.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <memory>
 #include <string>
+#include <vector>
 #include <boost/any.hpp>
 
 namespace Opm
 {
 
+    class DeflatedConjugateGradient;
+
     /// Concrete class encapsulating some dune-istl linear solvers.
     class LinearSolverIstl : public LinearSolverInterface
     {
@@ -39,7 +44,8 @@ namespace Opm
         ///   linsolver_verbosity           0
         ///   linsolver_type                1 ( = CG_AMG), alternatives are:
         ///                                 CG_ILU0 = 0, CG_AMG = 1, BiCGStab_ILU0 = 2
-        ///                                 FastAMG=3, KAMG=4 };
+        ///                                 FastAMG=3, KAMG=4, CPR=5 };
+        ///                                 CPR is only available through solveBlock().
         ///   linsolver_save_system         false
         ///   linsolver_save_filename       <empty string>
         ///   linsolver_max_iterations      0 (unlimited=5000)
@@ -47,6 +53,45 @@ namespace Opm
         ///   linsolver_smooth_steps        2
         ///   linsolver_prolongate_factor   1.6
         ///   linsolver_verbosity           0
+        ///   linsolver_reuse_setup         0 (never reuse). If N > 0, the AMG
+        ///                                 hierarchy of the CG_AMG, KAMG and FastAMG
+        ///                                 solvers is kept for up to N subsequent
+        ///                                 (sequential) solves of systems with
+        ///                                 unchanged sparsity pattern.
+        ///   linsolver_persistent_matrix   true. Keep the ISTL system matrix between
+        ///                                 calls and only copy values while the
+        ///                                 sparsity pattern is unchanged.
+        ///   linsolver_initial_guess       false. Start iterating from the
+        ///                                 solution array passed to solve()
+        ///                                 instead of from zero (not in CPR).
+        ///   linsolver_single_precision_preconditioner
+        ///                                 false. Build the ILU0 or AMG preconditioner
+        ///                                 of CG_ILU0, CG_AMG and BiCGStab_ILU0 from a
+        ///                                 single precision copy of the matrix, while
+        ///                                 the Krylov iterations stay in double
+        ///                                 precision. Only in sequential solves, and
+        ///                                 CG_AMG then does not reuse its setup.
+        ///   linsolver_recycle_vectors     0 (off). If N > 0, sequential CG_ILU0 and
+        ///                                 CG_AMG solves use conjugate gradients
+        ///                                 deflated by N approximate eigenvectors
+        ///                                 kept from the previous solves, see
+        ///                                 DeflatedConjugateGradient. Not with
+        ///                                 single precision preconditioners.
+        ///   linsolver_recycle_directions  2N. Search directions of each solve
+        ///                                 used to update those vectors.
+        ///   linsolver_ilu_ordering        natural. Alternatives are upwind and
+        ///                                 sequence. Sequential CG_ILU0 and
+        ///                                 BiCGStab_ILU0 solves then permute the
+        ///                                 system before the ILU0 factorisation, and
+        ///                                 the solution back afterwards. upwind orders
+        ///                                 the unknowns topologically by the strong
+        ///                                 components of the matrix graph, where row i
+        ///                                 depends on column j if a_ij is nonzero, so
+        ///                                 ILU0 is nearly exact for advection dominated
+        ///                                 transport systems. sequence uses the order
+        ///                                 given to setOrdering().
+        ///   cpr_weights                   quasi_impes, alternative is true_impes.
+        ///   cpr_pressure_index            0 (pressure unknown within each block)
         LinearSolverIstl();
 
         /// Construct from parameters
@@ -77,6 +122,53 @@ namespace Opm
                                          double* solution,
                                          const boost::any& comm=boost::any()) const;
 
+        /// Solve a linear system with several right hand sides, see
+        /// LinearSolverInterface::solveMultiple(). For the AMG solver
+        /// types, the AMG hierarchy is set up once and used for all
+        /// right hand sides, regardless of linsolver_reuse_setup.
+        virtual LinearSolverReport solveMultiple(const int size,
+                                                 const int nonzeros,
+                                                 const int* ia,
+                                                 const int* ja,
+                                                 const double* sa,
+                                                 const int nrhs,
+                                                 const double* rhs,
+                                                 double* solution) const;
+
+        /// Solve a linear system, with a matrix given in block compressed sparse row format.
+        /// With linsolver_type CPR the system is solved by BiCGStab preconditioned with
+        /// a two-stage constrained pressure residual (CPR) preconditioner: AMG on a
+        /// pressure system restricted by IMPES-type weights followed by ILU0 on the full
+        /// system. Other solver types use the expanded scalar system.
+        /// See LinearSolverInterface::solveBlock() for the meaning of the arguments.
+        virtual LinearSolverReport solveBlock(const int size,
+                                              const int block_size,
+                                              const int nonzeros,
+                                              const int* ia,
+                                              const int* ja,
+                                              const double* sa,
+                                              const double* rhs,
+                                              double* solution) const;
+
+        /// Solve a linear system given by a matrix-free operator, e.g.
+        /// TpfaOperator, with CG preconditioned by diagonal (Jacobi)
+        /// scaling. The operator must be symmetric positive definite.
+        /// Uses linsolver_residual_tolerance, linsolver_max_iterations,
+        /// linsolver_verbosity and linsolver_initial_guess, but not
+        /// linsolver_type.
+        /// \param[in] A          operator
+        /// \param[in] rhs         array of length A.size() containing the right hand side
+        /// \param[inout] solution array of length A.size() to which the solution will be written
+        LinearSolverReport solveMatrixFree(const LinearOperatorInterface& A,
+                                           const double* rhs,
+                                           double* solution) const;
+
+        /// Set the order of the unknowns used by linsolver_ilu_ordering
+        /// sequence, e.g. the cell sequence computed by compute_sequence().
+        /// \param[in] sequence   permutation of 0, ..., size - 1, where
+        ///                        sequence[k] is the unknown eliminated k'th.
+        void setOrdering(const std::vector<int>& sequence);
+
         /// Set tolerance for the residual in dune istl linear solver.
         /// \param[in] tol         tolerance value
         virtual void setTolerance(const double tol);
@@ -85,6 +177,12 @@ namespace Opm
         /// \param[out] tolerance value
         virtual double getTolerance() const;
 
+        /// Add the system matrices kept between solves and the
+        /// recycled space of deflated CG to the report, as children
+        /// of "linear solver". The AMG hierarchy of a kept setup is
+        /// not included, since dune-istl does not expose its size.
+        virtual void reportMemory(MemoryReport& report) const;
+
     private:
         /// \brief Solve the linear system using ISTL
         /// \param[in] opA The linear operator of the system to solve.
@@ -97,9 +195,50 @@ namespace Opm
         LinearSolverReport solveSystem(O& opA, double* solution, const double *rhs,
                                        S& sp, const C& comm, int maxit) const;
 
+        /// \brief Solve a sequential system, reusing the AMG setup of a
+        ///        previous call if possible.
+        /// \param[in] force_reuse  Reuse a setup for the same sparsity
+        ///                         pattern and solver type even if it has
+        ///                         been used linsolver_reuse_setup times,
+        ///                         i.e. the matrix values are unchanged.
+        LinearSolverReport solveReusingSetup(const int size,
+                                             const int nonzeros,
+                                             const int* ia,
+                                             const int* ja,
+                                             const double* sa,
+                                             const double* rhs,
+                                             double* solution,
+                                             int maxit,
+                                             bool force_reuse = false) const;
+
+        /// \brief Solve a sequential system as given.
+        LinearSolverReport solveSequential(const int size,
+                                           const int nonzeros,
+                                           const int* ia,
+                                           const int* ja,
+                                           const double* sa,
+                                           const double* rhs,
+                                           double* solution,
+                                           int maxit) const;
+
+        /// \brief Solve a sequential system permuted according to
+        ///        linsolver_ilu_ordering.
+        LinearSolverReport solveReordered(const int size,
+                                          const int nonzeros,
+                                          const int* ia,
+                                          const int* ja,
+                                          const double* sa,
+                                          const double* rhs,
+                                          double* solution,
+                                          int maxit) const;
+
+        /// \brief The recycled Krylov space of deflated CG, created on
+        ///        first use, or null if linsolver_recycle_vectors is zero.
+        DeflatedConjugateGradient* recycleSpace() const;
+
         double linsolver_residual_tolerance_;
         int linsolver_verbosity_;
-        enum LinsolverType { CG_ILU0 = 0, CG_AMG = 1, BiCGStab_ILU0 = 2, FastAMG=3, KAMG=4 };
+        enum LinsolverType { CG_ILU0 = 0, CG_AMG = 1, BiCGStab_ILU0 = 2, FastAMG=3, KAMG=4, CPR=5 };
         LinsolverType linsolver_type_;
         bool linsolver_save_system_;
         std::string linsolver_save_filename_;
@@ -108,6 +247,38 @@ namespace Opm
         int linsolver_smooth_steps_;
         /** \brief The factor to scale the coarse grid correction with. */
         double linsolver_prolongate_factor_;
+        /** \brief Maximum number of solves reusing one AMG setup. */
+        int linsolver_reuse_setup_;
+        /** \brief Use true-IMPES instead of quasi-IMPES weights in CPR. */
+        bool cpr_true_impes_;
+        /** \brief Index of the pressure unknown within each block for CPR. */
+        int cpr_pressure_index_;
+        /** \brief Keep the system matrix allocated between solves. */
+        bool linsolver_persistent_matrix_;
+        /** \brief Use the incoming solution as initial guess. */
+        bool linsolver_initial_guess_;
+        /** \brief Build preconditioners in single precision. */
+        bool linsolver_single_precision_;
+        /** \brief Dimension of the recycled space of deflated CG. */
+        int linsolver_recycle_vectors_;
+        /** \brief Search directions per solve used to update it. */
+        int linsolver_recycle_directions_;
+        enum IluOrdering { NaturalOrdering, UpwindOrdering, SequenceOrdering };
+        /** \brief Ordering of the unknowns for ILU0. */
+        IluOrdering linsolver_ilu_ordering_;
+        /** \brief Order given to setOrdering(). */
+        std::vector<int> ilu_sequence_;
+
+        /// System matrix kept between solves.
+        struct MatrixCache;
+        mutable std::shared_ptr<MatrixCache> matrix_cache_;
+
+        /// Matrix, operator and preconditioner kept between solves.
+        struct AmgCache;
+        mutable std::shared_ptr<AmgCache> amg_cache_;
+
+        /// Recycled space kept between solves.
+        mutable std::shared_ptr<DeflatedConjugateGradient> recycle_space_;
 
     };
 
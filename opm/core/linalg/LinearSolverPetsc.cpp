@@ -19,9 +19,11 @@
 */
 
 #include "config.h"
+#include <algorithm>
 #include <cstring>
 #include <opm/core/linalg/LinearSolverPetsc.hpp>
 #include <unordered_map>
+#include <vector>
 #define PETSC_CLANGUAGE_CXX 1 //enable CHKERRXX macro.
 #include <petsc.h>
 #include <opm/common/ErrorMacros.hpp>
@@ -124,50 +126,26 @@ namespace{
         Map type_map_;
     };
 
-    struct OEM_DATA {
-        /* Convenience struct to handle automatic (de)allocation of some useful
-         * variables, as well as group them up for easier parameter passing
-         */
-        Vec x;
-        Vec b;
-        Mat A;
-        KSP ksp;
-        PC preconditioner;
-
-        OEM_DATA( const int size ) {
-            VecCreate( PETSC_COMM_WORLD, &b );
-            auto err = VecSetSizes( b, PETSC_DECIDE, size );
-            CHKERRXX( err );
-            VecSetFromOptions( b );
-
-            KSPCreate( PETSC_COMM_WORLD, &ksp );
-        }
+    void check( PetscErrorCode err ) {
+        CHKERRXX( err );
+    }
 
-        ~OEM_DATA() {
-            VecDestroy( &x );
-            VecDestroy( &b );
-            MatDestroy( &A );
-            KSPDestroy( &ksp );
-            PCDestroy( &preconditioner );
-        }
-    };
+    /// True if the pattern (ia, ja) equals the stored one.
+    bool same_pattern( const std::vector<int>& ia0, const std::vector<int>& ja0,
+            const int size, const int nonzeros, const int* ia, const int* ja ) {
+        return int( ia0.size() ) == size + 1 && int( ja0.size() ) == nonzeros
+            && std::equal( ia, ia + size + 1, ia0.begin() )
+            && std::equal( ja, ja + nonzeros, ja0.begin() );
+    }
 
-    Vec to_petsc_vec( const double* x, int size ) {
+    void copy_to_vec( const double* x, Vec v, int size ) {
         PetscScalar* vec;
-        Vec v;
-
-        VecCreate( PETSC_COMM_WORLD, &v );
-        VecSetSizes( v, PETSC_DECIDE, size );
-        VecSetFromOptions( v );
-
         VecGetArray( v, &vec );
         std::memcpy( vec, x,  size * sizeof( double ) );
-
         VecRestoreArray( v, &vec );
-        return v;
     }
 
-    void from_petsc_vec( double* x, Vec v ) {
+    void copy_from_vec( double* x, Vec v ) {
         if( !v ) OPM_THROW( std::runtime_error,
                     "PETSc CopySolution: Invalid PETSc vector." );
 
@@ -181,46 +159,52 @@ namespace{
         VecRestoreArray( v, &vec );
     }
 
-    Mat to_petsc_mat( const int size, const int nonzeros,
-            const int* ia, const int* ja, const double* sa ) {
+} // anonymous namespace.
 
+    /// PETSc objects kept alive between solves of systems with the
+    /// same sparsity pattern.
+    struct LinearSolverPetsc::PetscData {
+        Vec x;
+        Vec b;
         Mat A;
-        auto err = MatCreateSeqAIJWithArrays( PETSC_COMM_WORLD, size, size, (int*)ia, (int*)ja, (double*)sa, &A );
-        CHKERRXX( err );
-        return A;
-    }
-
-
-    void solve_system( OEM_DATA& t, KSPType method, PCType pcname,
-            double rtol, double atol, double dtol, int maxits, int ksp_view ) {
-        PetscInt its;
-        PetscReal residual;
-        KSPConvergedReason reason;
+        KSP ksp;
+        std::vector<int> ia;
+        std::vector<int> ja;
+        bool has_pc;
 
-        KSPSetOperators( t.ksp, t.A, t.A, DIFFERENT_NONZERO_PATTERN );
-        KSPGetPC( t.ksp, &t.preconditioner );
-        auto err = KSPSetType( t.ksp, method );
-        CHKERRXX( err );
-        err = PCSetType( t.preconditioner, pcname );
-        CHKERRXX( err );
-        err = KSPSetTolerances( t.ksp, rtol, atol, dtol, maxits );
-        CHKERRXX( err );
-        err = KSPSetFromOptions( t.ksp );
-        CHKERRXX( err );
-        KSPSetInitialGuessNonzero( t.ksp, PETSC_FALSE );
-        KSPSolve( t.ksp, t.x, t.b );
-        KSPGetConvergedReason( t.ksp, &reason );
-        KSPGetIterationNumber( t.ksp, &its );
-        KSPGetResidualNorm( t.ksp, &residual );
+        PetscData( const int size, const int nonzeros, const int* ia_, const int* ja_ )
+            : ia( ia_, ia_ + size + 1 ), ja( ja_, ja_ + nonzeros ), has_pc( false )
+        {
+            std::vector<PetscInt> nnz( size );
+            for( int i = 0; i < size; ++i ) nnz[ i ] = ia_[ i + 1 ] - ia_[ i ];
 
-        if( ksp_view )
-            KSPView( t.ksp, PETSC_VIEWER_STDOUT_WORLD );
+            check( MatCreateSeqAIJ( PETSC_COMM_WORLD, size, size, 0, nnz.data(), &A ) );
+            check( VecCreateSeq( PETSC_COMM_WORLD, size, &b ) );
+            check( VecDuplicate( b, &x ) );
+            check( KSPCreate( PETSC_COMM_WORLD, &ksp ) );
+        }
 
-        err = PetscPrintf( PETSC_COMM_WORLD, "KSP Iterations %D, Final Residual %G\n", its, residual );
-        CHKERRXX( err );
-    }
+        ~PetscData() {
+            KSPDestroy( &ksp );
+            VecDestroy( &x );
+            VecDestroy( &b );
+            MatDestroy( &A );
+        }
 
-} // anonymous namespace.
+        /// Insert the values of all rows.  The first assembly fixes
+        /// the nonzero structure; afterwards, any entry outside it is
+        /// an error rather than a silent reallocation.
+        void setValues( const double* sa ) {
+            const int size = int( ia.size() ) - 1;
+            for( int i = 0; i < size; ++i ) {
+                const PetscInt n = ia[ i + 1 ] - ia[ i ];
+                check( MatSetValues( A, 1, &i, n, &ja[ ia[ i ] ], &sa[ ia[ i ] ], INSERT_VALUES ) );
+            }
+            check( MatAssemblyBegin( A, MAT_FINAL_ASSEMBLY ) );
+            check( MatAssemblyEnd( A, MAT_FINAL_ASSEMBLY ) );
+            check( MatSetOption( A, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE ) );
+        }
+    };
 
     LinearSolverPetsc::LinearSolverPetsc(const parameter::ParameterGroup& param)
         : ksp_type_( param.getDefault( std::string( "ksp_type" ), std::string( "gmres" ) ) )
@@ -230,6 +214,7 @@ namespace{
         , atol_( param.getDefault( std::string( "ksp_atol" ), 1e-50 ) )
         , dtol_( param.getDefault( std::string( "ksp_dtol" ), 1e5 ) )
         , maxits_( param.getDefault( std::string( "ksp_max_it" ), 1e5 ) )
+        , reuse_pc_( param.getDefault( std::string( "ksp_reuse_pc" ), false ) )
     {
         int argc = 0;
         char** argv = NULL;
@@ -239,6 +224,7 @@ namespace{
 
     LinearSolverPetsc::~LinearSolverPetsc()
     {
+       data_.reset();
        PetscFinalize();
     }
 
@@ -253,20 +239,59 @@ namespace{
                                double* solution,
                                const boost::any&) const
     {
-        KSPTypeMap ksp(ksp_type_);
-        KSPType ksp_type = ksp.find(ksp_type_);
-        PCTypeMap pc(pc_type_);
-        PCType pc_type = pc.find(pc_type_);
+        if( !data_ || !same_pattern( data_->ia, data_->ja, size, nonzeros, ia, ja ) ) {
+            KSPTypeMap ksp(ksp_type_);
+            KSPType ksp_type = ksp.find(ksp_type_);
+            PCTypeMap pc(pc_type_);
+            PCType pc_type = pc.find(pc_type_);
+
+            data_.reset();
+            data_.reset( new PetscData( size, nonzeros, ia, ja ) );
+
+            PC preconditioner;
+            KSPGetPC( data_->ksp, &preconditioner );
+            check( KSPSetType( data_->ksp, ksp_type ) );
+            check( PCSetType( preconditioner, pc_type ) );
+            check( KSPSetTolerances( data_->ksp, rtol_, atol_, dtol_, maxits_ ) );
+            check( KSPSetFromOptions( data_->ksp ) );
+            KSPSetInitialGuessNonzero( data_->ksp, PETSC_FALSE );
+        }
+        PetscData& t = *data_;
+
+        t.setValues( sa );
+        copy_to_vec( rhs, t.b, size );
+
+        // Keep the preconditioner of the previous solve if requested;
+        // the first solve with a given pattern always sets it up.
+        const bool reuse = reuse_pc_ && t.has_pc;
+#if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR < 5
+        KSPSetOperators( t.ksp, t.A, t.A, reuse ? SAME_PRECONDITIONER : SAME_NONZERO_PATTERN );
+#else
+        KSPSetOperators( t.ksp, t.A, t.A );
+        KSPSetReusePreconditioner( t.ksp, reuse ? PETSC_TRUE : PETSC_FALSE );
+#endif
+
+        PetscInt its;
+        PetscReal residual;
+        KSPConvergedReason reason;
+
+        KSPSolve( t.ksp, t.b, t.x );
+        t.has_pc = true;
+        KSPGetConvergedReason( t.ksp, &reason );
+        KSPGetIterationNumber( t.ksp, &its );
+        KSPGetResidualNorm( t.ksp, &residual );
+
+        if( ksp_view_ )
+            KSPView( t.ksp, PETSC_VIEWER_STDOUT_WORLD );
 
-        OEM_DATA t( size );
-        t.A = to_petsc_mat( size, nonzeros, ia, ja, sa );
-        t.x = to_petsc_vec( rhs, size );
+        check( PetscPrintf( PETSC_COMM_WORLD, "KSP Iterations %D, Final Residual %G\n", its, residual ) );
 
-        solve_system( t, ksp_type, pc_type, rtol_, atol_, dtol_, maxits_, ksp_view_ );
-        from_petsc_vec( solution, t.b );
+        copy_from_vec( solution, t.x );
 
         LinearSolverReport rep = {};
         rep.converged = true;
+        rep.iterations = its;
+        rep.setup_reused = reuse;
         return rep;
     }
 
@@ -280,4 +305,3 @@ namespace{
     }
 
 } // namespace Opm
-
@@ -22,6 +22,7 @@
 #define OPM_LINEARSOLVERPETSC_HEADER_INCLUDED
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <memory>
 #include <string>
 
 namespace Opm
@@ -40,8 +41,18 @@ namespace Opm
         LinearSolverPetsc();
 
         /// Construct from parameters
-        /// Accepted parameters are, with defaults, listed in the
-        /// default constructor.
+        /// Accepted parameters are, with defaults:
+        ///   ksp_type      gmres
+        ///   pc_type       sor
+        ///   ksp_view      false
+        ///   ksp_rtol      1e-5
+        ///   ksp_atol      1e-50
+        ///   ksp_dtol      1e5
+        ///   ksp_max_it    1e5
+        ///   ksp_reuse_pc  false. Keep the preconditioner of the previous
+        ///                 solve for systems with unchanged sparsity pattern.
+        /// The PETSc matrix, vectors and KSP are kept between calls and
+        /// only rebuilt when the sparsity pattern changes.
         LinearSolverPetsc(const parameter::ParameterGroup& param);
 
         /// Destructor.
@@ -82,6 +93,10 @@ namespace Opm
         double          atol_;
         double          dtol_;
         int             maxits_;
+        bool            reuse_pc_;
+
+        struct PetscData;
+        mutable std::unique_ptr<PetscData> data_;
     };
 
 
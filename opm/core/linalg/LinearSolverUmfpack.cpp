@@ -21,12 +21,31 @@
 #include <opm/core/linalg/LinearSolverUmfpack.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/linalg/call_umfpack.h>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <stdexcept>
 
 namespace Opm
 {
 
     LinearSolverUmfpack::LinearSolverUmfpack()
+        : handle_(umfpack_handle_create(0))
+    {
+        if (handle_ == 0) {
+            OPM_THROW(std::runtime_error, "Failed to allocate UMFPACK solver state.");
+        }
+    }
+
+
+
+
+    LinearSolverUmfpack::LinearSolverUmfpack(const parameter::ParameterGroup& param)
+        : handle_(umfpack_handle_create(param.getDefault("umfpack_reuse_factorization", false) ? 1 : 0))
     {
+        if (handle_ == 0) {
+            OPM_THROW(std::runtime_error, "Failed to allocate UMFPACK solver state.");
+        }
     }
 
 
@@ -34,6 +53,7 @@ namespace Opm
 
     LinearSolverUmfpack::~LinearSolverUmfpack()
     {
+        umfpack_handle_destroy(handle_);
     }
 
 
@@ -56,9 +76,33 @@ namespace Opm
             const_cast<int*>(ja),
             const_cast<double*>(sa)
         };
-        call_UMFPACK(&A, rhs, solution);
         LinearSolverReport rep = {};
-        rep.converged = true;
+        rep.converged = call_UMFPACK_handle(handle_, &A, rhs, solution) != 0;
+        return rep;
+    }
+
+
+
+
+    LinearSolverInterface::LinearSolverReport
+    LinearSolverUmfpack::solveMultiple(const int size,
+                                       const int nonzeros,
+                                       const int* ia,
+                                       const int* ja,
+                                       const double* sa,
+                                       const int nrhs,
+                                       const double* rhs,
+                                       double* solution) const
+    {
+        CSRMatrix A  = {
+            (size_t)size,
+            (size_t)nonzeros,
+            const_cast<int*>(ia),
+            const_cast<int*>(ja),
+            const_cast<double*>(sa)
+        };
+        LinearSolverReport rep = {};
+        rep.converged = call_UMFPACK_handle_multiple(handle_, &A, nrhs, rhs, solution) != 0;
         return rep;
     }
 
@@ -71,6 +115,11 @@ namespace Opm
         return -1.;
     }
 
+    void LinearSolverUmfpack::refactor()
+    {
+        umfpack_handle_refactor(handle_);
+    }
+
 
 } // namespace Opm
 
@@ -23,21 +23,38 @@
 
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 
+struct UMFPACKHandle;
 
 namespace Opm
 {
 
 
+    namespace parameter { class ParameterGroup; }
+
     /// Concrete class encapsulating the UMFPACK direct linear solver.
+    ///
+    /// The symbolic analysis of the matrix is retained between calls to
+    /// solve() for as long as the sparsity pattern does not change.
     class LinearSolverUmfpack : public LinearSolverInterface
     {
     public:
         /// Default constructor.
         LinearSolverUmfpack();
 
+        /// Construct from parameters.
+        /// Accepted parameters are, with defaults, listed below.
+        ///    umfpack_reuse_factorization   false
+        /// If true, the numeric factorisation is also retained and reused
+        /// (simplified Newton) until refactor() is called or the sparsity
+        /// pattern changes.
+        explicit LinearSolverUmfpack(const parameter::ParameterGroup& param);
+
         /// Destructor.
         virtual ~LinearSolverUmfpack();
 
+        LinearSolverUmfpack(const LinearSolverUmfpack&) = delete;
+        LinearSolverUmfpack& operator=(const LinearSolverUmfpack&) = delete;
+
         using LinearSolverInterface::solve;
 
         /// Solve a linear system, with a matrix given in compressed sparse row format.
@@ -58,6 +75,18 @@ namespace Opm
                                          double* solution,
                                          const boost::any& add=boost::any()) const;
 
+        /// Solve a linear system with several right hand sides, see
+        /// LinearSolverInterface::solveMultiple(). The matrix is
+        /// factorised once for all right hand sides.
+        virtual LinearSolverReport solveMultiple(const int size,
+                                                 const int nonzeros,
+                                                 const int* ia,
+                                                 const int* ja,
+                                                 const double* sa,
+                                                 const int nrhs,
+                                                 const double* rhs,
+                                                 double* solution) const;
+
         /// Set tolerance for the linear solver.
         /// \param[in] tol         tolerance value
         /// Not used for UMFPACK solver.
@@ -68,7 +97,12 @@ namespace Opm
         /// Not used for UMFPACK solver. Returns -1.
         virtual double getTolerance() const;
 
+        /// Discard any retained numeric factorisation, so that the next
+        /// call to solve() factorises the current matrix.
+        void refactor();
 
+    private:
+        mutable UMFPACKHandle* handle_;
     };
 
 
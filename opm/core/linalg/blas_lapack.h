@@ -122,6 +122,12 @@ void dpptrf_(const char *uplo, const MAT_SIZE_T *n,
 void dpptri_(const char *uplo, const MAT_SIZE_T *n,
              double     *Ap  ,       MAT_SIZE_T *info);
 
+/* Solve A*x = lambda*B*x for symmetric A and symmetric positive definite B */
+void dsygv_(const MAT_SIZE_T *itype, const char       *jobz , const char       *uplo,
+            const MAT_SIZE_T *n    ,       double     *A    , const MAT_SIZE_T *lda ,
+                  double     *B    , const MAT_SIZE_T *ldb  ,       double     *w   ,
+                  double     *work , const MAT_SIZE_T *lwork,       MAT_SIZE_T *info);
+
 /* y <- a1*op(A)*x + a2*y */
 void dgemv_(const char       *trans,
             const MAT_SIZE_T *m    , const MAT_SIZE_T *n,
@@ -36,6 +36,7 @@
 #include "config.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <umfpack.h>
 
@@ -99,12 +100,14 @@ csc_allocate(UF_long n, UF_long nnz)
 }
 
 
+/* Build column structure of 'csc' from CSR pattern 'ia'/'ja' and
+ * record, in 'pos', the CSC position of each CSR entry. */
 /* ---------------------------------------------------------------------- */
 static void
-csr_to_csc(const int        *ia,
-           const int        *ja,
-           const double     *sa,
-           struct CSCMatrix *csc)
+csr_to_csc_pattern(const int        *ia,
+                   const int        *ja,
+                   struct CSCMatrix *csc,
+                   UF_long          *pos)
 /* ---------------------------------------------------------------------- */
 {
     UF_long i, nz;
@@ -125,13 +128,13 @@ csr_to_csc(const int        *ia,
 
     assert (csc->p[0] == csc->nnz);
 
-    /* Fill matrix whilst defining column end pointers */
+    /* Fill structure whilst defining column end pointers */
     for (i = nz = 0; i < csc->n; i++) {
         for (; nz < ia[i + 1]; nz++) {
-            csc->i[ csc->p[ ja[nz] + 1 ] ] = i;      /* Insertion sort */
-            csc->x[ csc->p[ ja[nz] + 1 ] ] = sa[nz]; /* Insert mat elem */
+            pos[nz] = csc->p[ ja[nz] + 1 ];          /* Insertion sort */
 
-            csc->p        [ ja[nz] + 1 ]  += 1;      /* Advance col ptr */
+            csc->i[ pos[nz] ]          = i;
+            csc->p[ ja[nz] + 1 ]      += 1;          /* Advance col ptr */
         }
     }
 
@@ -141,45 +144,245 @@ csr_to_csc(const int        *ia,
 }
 
 
+/* Cached UMFPACK state for a fixed sparsity pattern. */
+struct UMFPACKHandle {
+    int               reuse_numeric;
+
+    size_t            m;
+    int              *ia;       /* Copy of pattern of last matrix */
+    int              *ja;
+    UF_long          *pos;      /* CSC position of each CSR entry */
+
+    struct CSCMatrix *csc;
+
+    void             *Symbolic;
+    void             *Numeric;
+
+    double            Control[UMFPACK_CONTROL];
+};
+
+
 /* ---------------------------------------------------------------------- */
 static void
-solve_umfpack(struct CSCMatrix *csc, const double *b, double *x)
+handle_release_pattern(struct UMFPACKHandle *h)
 /* ---------------------------------------------------------------------- */
 {
-    void *Symbolic, *Numeric;
-    double Info[UMFPACK_INFO], Control[UMFPACK_CONTROL];
+    if (h->Numeric  != NULL) { umfpack_dl_free_numeric (&h->Numeric ); }
+    if (h->Symbolic != NULL) { umfpack_dl_free_symbolic(&h->Symbolic); }
+
+    csc_deallocate(h->csc);
+    free(h->pos);
+    free(h->ja);
+    free(h->ia);
+
+    h->m        = 0;
+    h->ia       = NULL;
+    h->ja       = NULL;
+    h->pos      = NULL;
+    h->csc      = NULL;
+    h->Symbolic = NULL;
+    h->Numeric  = NULL;
+}
 
-    umfpack_dl_defaults(Control);
 
-    umfpack_dl_symbolic(csc->n, csc->n, csc->p, csc->i, csc->x,
-                        &Symbolic, Control, Info);
-    umfpack_dl_numeric (csc->p, csc->i, csc->x,
-                        Symbolic, &Numeric, Control, Info);
+/* ---------------------------------------------------------------------- */
+static int
+handle_same_pattern(const struct UMFPACKHandle *h, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    size_t nnz;
 
-    umfpack_dl_free_symbolic(&Symbolic);
+    if ((h->csc == NULL) || (h->m != A->m)) {
+        return 0;
+    }
 
-    umfpack_dl_solve(UMFPACK_A, csc->p, csc->i, csc->x, x, b,
-                     Numeric, Control, Info);
+    nnz = A->ia[A->m];
 
-    umfpack_dl_free_numeric(&Numeric);
+    return ((size_t) h->csc->nnz == nnz) &&
+        (memcmp(h->ia, A->ia, (A->m + 1) * sizeof *A->ia) == 0) &&
+        (memcmp(h->ja, A->ja, nnz        * sizeof *A->ja) == 0);
 }
 
 
-/*---------------------------------------------------------------------------*/
+/* ---------------------------------------------------------------------- */
+static int
+handle_set_pattern(struct UMFPACKHandle *h, const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    size_t nnz;
+
+    handle_release_pattern(h);
+
+    nnz = A->ia[A->m];
+
+    h->csc = csc_allocate(A->m, nnz);
+    h->ia  = malloc((A->m + 1) * sizeof *h->ia);
+    h->ja  = malloc(nnz        * sizeof *h->ja);
+    h->pos = malloc(nnz        * sizeof *h->pos);
+
+    if ((h->csc == NULL) || (h->ia == NULL) ||
+        (((h->ja == NULL) || (h->pos == NULL)) && (nnz > 0))) {
+        handle_release_pattern(h);
+        return 0;
+    }
+
+    h->m = A->m;
+    memcpy(h->ia, A->ia, (A->m + 1) * sizeof *h->ia);
+    memcpy(h->ja, A->ja, nnz        * sizeof *h->ja);
+
+    csr_to_csc_pattern(A->ia, A->ja, h->csc, h->pos);
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct UMFPACKHandle *
+umfpack_handle_create(int reuse_numeric)
+/* ---------------------------------------------------------------------- */
+{
+    struct UMFPACKHandle *h;
+
+    h = malloc(1 * sizeof *h);
+
+    if (h != NULL) {
+        h->reuse_numeric = reuse_numeric;
+
+        h->m        = 0;
+        h->ia       = NULL;
+        h->ja       = NULL;
+        h->pos      = NULL;
+        h->csc      = NULL;
+        h->Symbolic = NULL;
+        h->Numeric  = NULL;
+
+        umfpack_dl_defaults(h->Control);
+    }
+
+    return h;
+}
+
+
+/* ---------------------------------------------------------------------- */
 void
-call_UMFPACK(struct CSRMatrix *A, const double *b, double *x)
-/*---------------------------------------------------------------------------*/
+umfpack_handle_destroy(struct UMFPACKHandle *h)
+/* ---------------------------------------------------------------------- */
+{
+    if (h != NULL) {
+        handle_release_pattern(h);
+    }
+
+    free(h);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+umfpack_handle_refactor(struct UMFPACKHandle *h)
+/* ---------------------------------------------------------------------- */
 {
+    if (h->Numeric != NULL) {
+        umfpack_dl_free_numeric(&h->Numeric);
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+handle_factor(struct UMFPACKHandle *h, struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    UF_long          nz;
+    int              status;
+    double           Info[UMFPACK_INFO];
     struct CSCMatrix *csc;
 
-    csc = csc_allocate(A->m, A->ia[A->m]);
+    if (! handle_same_pattern(h, A)) {
+        if (! handle_set_pattern(h, A)) {
+            return 0;
+        }
+    }
 
-    if (csc != NULL) {
-        csr_to_csc(A->ia, A->ja, A->sa, csc);
+    csc = h->csc;
+    for (nz = 0; nz < csc->nnz; nz++) {
+        csc->x[ h->pos[nz] ] = A->sa[nz];
+    }
+
+    if (h->Symbolic == NULL) {
+        status = umfpack_dl_symbolic(csc->n, csc->n, csc->p, csc->i, csc->x,
+                                     &h->Symbolic, h->Control, Info);
+        if (status < UMFPACK_OK) {
+            h->Symbolic = NULL;
+            return 0;
+        }
+    }
+
+    if (! h->reuse_numeric) {
+        umfpack_handle_refactor(h);
+    }
+
+    if (h->Numeric == NULL) {
+        status = umfpack_dl_numeric(csc->p, csc->i, csc->x,
+                                    h->Symbolic, &h->Numeric, h->Control, Info);
+        if (status < UMFPACK_OK) {
+            h->Numeric = NULL;
+            return 0;
+        }
+    }
+
+    return 1;
+}
 
-        solve_umfpack(csc, b, x);
+
+/* ---------------------------------------------------------------------- */
+int
+call_UMFPACK_handle(struct UMFPACKHandle *h, struct CSRMatrix *A,
+                    const double *b, double *x)
+/* ---------------------------------------------------------------------- */
+{
+    return call_UMFPACK_handle_multiple(h, A, 1, b, x);
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+call_UMFPACK_handle_multiple(struct UMFPACKHandle *h, struct CSRMatrix *A,
+                             int nrhs, const double *b, double *x)
+/* ---------------------------------------------------------------------- */
+{
+    int              k, status;
+    double           Info[UMFPACK_INFO];
+    struct CSCMatrix *csc;
+
+    if (! handle_factor(h, A)) {
+        return 0;
     }
 
-    csc_deallocate(csc);
+    /* With a reused factor, the iterative refinement steps of the solve
+     * are carried out against the current matrix values. */
+    csc = h->csc;
+    for (k = 0, status = UMFPACK_OK; (k < nrhs) && (status >= UMFPACK_OK); k++) {
+        status = umfpack_dl_solve(UMFPACK_A, csc->p, csc->i, csc->x,
+                                  x + k*A->m, b + k*A->m,
+                                  h->Numeric, h->Control, Info);
+    }
+
+    return status >= UMFPACK_OK;
 }
 
+
+/*---------------------------------------------------------------------------*/
+void
+call_UMFPACK(struct CSRMatrix *A, const double *b, double *x)
+/*---------------------------------------------------------------------------*/
+{
+    struct UMFPACKHandle *h;
+
+    h = umfpack_handle_create(0);
+
+    if (h != NULL) {
+        call_UMFPACK_handle(h, A, b, x);
+    }
+
+    umfpack_handle_destroy(h);
+}
@@ -40,9 +40,43 @@ extern "C" {
 #endif
 
 struct CSRMatrix;
+struct UMFPACKHandle;
 
+/* Solve A x = b using a fresh factorisation of A. */
 void call_UMFPACK(struct CSRMatrix *A, const double *b, double *x);
 
+/* Create UMFPACK state to be reused across solves.  The symbolic analysis
+ * is retained for as long as the sparsity pattern of the matrix is
+ * unchanged.  If 'reuse_numeric' is non-zero, the numeric factorisation is
+ * retained as well until umfpack_handle_refactor() is called or the pattern
+ * changes (e.g., for simplified Newton iterations).  Returns NULL on
+ * allocation failure. */
+struct UMFPACKHandle *
+umfpack_handle_create(int reuse_numeric);
+
+/* Dispose of UMFPACK state.  'h' may be NULL. */
+void
+umfpack_handle_destroy(struct UMFPACKHandle *h);
+
+/* Discard the retained numeric factorisation, forcing a new one in the
+ * next call to call_UMFPACK_handle(). */
+void
+umfpack_handle_refactor(struct UMFPACKHandle *h);
+
+/* Solve A x = b using, and updating, the state in 'h'.  Returns one
+ * (true) if successful and zero (false) otherwise. */
+int
+call_UMFPACK_handle(struct UMFPACKHandle *h, struct CSRMatrix *A,
+                    const double *b, double *x);
+
+/* Solve A x_k = b_k for 'nrhs' right hand sides with one factorisation.
+ * Right hand side and solution k start at b + k*A->m and x + k*A->m,
+ * respectively.  Returns one (true) if all solves succeed and zero
+ * (false) otherwise. */
+int
+call_UMFPACK_handle_multiple(struct UMFPACKHandle *h, struct CSRMatrix *A,
+                             int nrhs, const double *b, double *x);
+
 #ifdef __cplusplus
 }
 #endif
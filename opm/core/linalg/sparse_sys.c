@@ -21,8 +21,19 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/utility/first_touch.h>
 
 
 /* ---------------------------------------------------------------------- */
@@ -107,8 +118,10 @@ csrmatrix_new_elms_pushback(struct CSRMatrix *A)
 
     A->ia[0] = 0;
 
-    A->ja = malloc(A->nnz * sizeof *A->ja);
-    A->sa = malloc(A->nnz * sizeof *A->sa);
+    /* Place the elements of each row with the threads of the row
+     * parallel kernels.  Row 'i' starts at ia[i + 1] until filled. */
+    A->ja = first_touch_calloc_rows(A->m, A->ia + 1, A->nnz, sizeof *A->ja);
+    A->sa = first_touch_calloc_rows(A->m, A->ia + 1, A->nnz, sizeof *A->sa);
 
     if ((A->ja == NULL) || (A->sa == NULL)) {
         free(A->sa);   A->sa = NULL;
@@ -130,6 +143,32 @@ cmp_row_elems(const void *a0, const void *b0)
 }
 
 
+/* Rows of discretisation matrices are short, for which insertion sort
+ * is faster than qsort(). */
+/* ---------------------------------------------------------------------- */
+static void
+sort_row(int *ja, int n)
+/* ---------------------------------------------------------------------- */
+{
+    int i, j, v;
+
+    if (n > 16) {
+        qsort(ja, n, sizeof *ja, cmp_row_elems);
+        return;
+    }
+
+    for (i = 1; i < n; i++) {
+        v = ja[i];
+
+        for (j = i; (j > 0) && (ja[j - 1] > v); j--) {
+            ja[j] = ja[j - 1];
+        }
+
+        ja[j] = v;
+    }
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 csrmatrix_sortrows(struct CSRMatrix *A)
@@ -138,11 +177,11 @@ csrmatrix_sortrows(struct CSRMatrix *A)
     size_t i;
 
     /* O(A->nnz * log(average nnz per row)) \approx O(A->nnz) */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 256)
+#endif
     for (i = 0; i < A->m; i++) {
-        qsort(A->ja        + A->ia[i] ,
-              A->ia[i + 1] - A->ia[i] ,
-              sizeof A->ja  [A->ia[i]],
-              cmp_row_elems);
+        sort_row(A->ja + A->ia[i], A->ia[i + 1] - A->ia[i]);
     }
 }
 
@@ -178,6 +217,17 @@ csrmatrix_delete(struct CSRMatrix *A)
 }
 
 
+/* ---------------------------------------------------------------------- */
+size_t
+csrmatrix_memory(const struct CSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    return sizeof *A
+        + (A->m + 1) * sizeof *A->ia
+        + A->nnz     * (sizeof *A->ja + sizeof *A->sa);
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 csrmatrix_zero(struct CSRMatrix *A)
@@ -200,6 +250,104 @@ vector_zero(size_t n, double *v)
 }
 
 
+/* ---------------------------------------------------------------------- */
+void
+csrmatrix_matvec(const struct CSRMatrix *A, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    size_t i;
+    int    k;
+    double yi;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(k, yi)
+#endif
+    for (i = 0; i < A->m; i++) {
+        yi = 0.0;
+
+        for (k = A->ia[i]; k < A->ia[i + 1]; k++) {
+            yi += A->sa[k] * x[A->ja[k]];
+        }
+
+        y[i] = yi;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+csr_matvec_transpose_rows(const struct CSRMatrix *A, size_t begin,
+                          size_t end, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    size_t i;
+    int    k;
+
+    for (i = begin; i < end; i++) {
+        for (k = A->ia[i]; k < A->ia[i + 1]; k++) {
+            y[A->ja[k]] += A->sa[k] * x[i];
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+csrmatrix_matvec_transpose(const struct CSRMatrix *A, size_t n,
+                           const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+#if defined(_OPENMP)
+    int     nt;
+    double *work;
+#endif
+
+    vector_zero(n, y);
+
+#if defined(_OPENMP)
+    nt   = omp_get_max_threads();
+    work = (nt > 1) ? malloc(((size_t) nt) * n * sizeof *work) : NULL;
+
+    if (work != NULL) {
+#pragma omp parallel num_threads(nt)
+        {
+            int     t, tid, nthr;
+            size_t  j, begin, end;
+            double *yt;
+
+            tid  = omp_get_thread_num();
+            nthr = omp_get_num_threads();
+
+            yt = work + ((size_t) tid) * n;
+            vector_zero(n, yt);
+
+            begin = (A->m * tid      ) / nthr;
+            end   = (A->m * (tid + 1)) / nthr;
+            csr_matvec_transpose_rows(A, begin, end, x, yt);
+
+#pragma omp barrier
+
+            /* Sum the thread contributions, column range-wise. */
+            begin = (n * tid      ) / nthr;
+            end   = (n * (tid + 1)) / nthr;
+            for (t = 0; t < nthr; t++) {
+                yt = work + ((size_t) t) * n;
+
+                for (j = begin; j < end; j++) {
+                    y[j] += yt[j];
+                }
+            }
+        }
+
+        free(work);
+        return;
+    }
+#endif
+
+    csr_matvec_transpose_rows(A, 0, A->m, x, y);
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 csrmatrix_write(const struct CSRMatrix *A, const char *fn)
@@ -262,3 +410,767 @@ vector_write_stream(size_t n, const double *v, FILE *fp)
         fprintf(fp, "%26.18e\n", v[i]);
     }
 }
+
+
+/* Binary file format: header followed by the arrays in native byte
+ * order.  The endianness tag detects files from machines with a
+ * different byte order. */
+#define SPARSE_BIN_MAGIC_CSR "OPMCSR01"
+#define SPARSE_BIN_MAGIC_VEC "OPMVEC01"
+#define SPARSE_BIN_ENDIAN    0x01020304u
+
+struct sparse_bin_header
+{
+    char     magic[8];
+    uint32_t endian;
+    uint32_t reserved;
+    uint64_t m;
+    uint64_t nnz;
+    uint64_t checksum;
+};
+
+
+#if HAVE_ZLIB
+typedef gzFile sparse_bin_file;
+#else
+typedef FILE  *sparse_bin_file;
+#endif
+
+
+/* ---------------------------------------------------------------------- */
+static sparse_bin_file
+sparse_bin_open(const char *fn, int write, int compress)
+/* ---------------------------------------------------------------------- */
+{
+#if HAVE_ZLIB
+    /* Mode "T" writes without compression; gzread() reads both kinds. */
+    return gzopen(fn, write ? (compress ? "wb6" : "wbT") : "rb");
+#else
+    (void) compress;
+    return fopen(fn, write ? "wb" : "rb");
+#endif
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+sparse_bin_close(sparse_bin_file fp)
+/* ---------------------------------------------------------------------- */
+{
+#if HAVE_ZLIB
+    return gzclose(fp) == Z_OK;
+#else
+    return fclose(fp) == 0;
+#endif
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+sparse_bin_io(sparse_bin_file fp, int write, void *p, size_t n)
+/* ---------------------------------------------------------------------- */
+{
+    char   *c;
+    size_t  chunk;
+
+    c = p;
+
+    /* Chunked, since the zlib interface counts bytes in 'unsigned'. */
+    while (n > 0) {
+        chunk = (n < (((size_t) 1) << 30)) ? n : (((size_t) 1) << 30);
+
+#if HAVE_ZLIB
+        if (write) {
+            if (gzwrite(fp, c, (unsigned) chunk) != (int) chunk) { return 0; }
+        } else {
+            if (gzread (fp, c, (unsigned) chunk) != (int) chunk) { return 0; }
+        }
+#else
+        if (write) {
+            if (fwrite(c, 1, chunk, fp) != chunk) { return 0; }
+        } else {
+            if (fread (c, 1, chunk, fp) != chunk) { return 0; }
+        }
+#endif
+
+        c += chunk;
+        n -= chunk;
+    }
+
+    return 1;
+}
+
+
+/* 64-bit FNV-1a hash. */
+/* ---------------------------------------------------------------------- */
+static uint64_t
+sparse_bin_checksum(uint64_t h, const void *p, size_t n)
+/* ---------------------------------------------------------------------- */
+{
+    const unsigned char *c;
+    size_t               i;
+
+    if (h == 0) { h = 14695981039346656037ULL; }
+
+    c = p;
+    for (i = 0; i < n; i++) {
+        h ^= c[i];
+        h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+sparse_bin_init_header(struct sparse_bin_header *h, const char *magic,
+                       size_t m, size_t nnz)
+/* ---------------------------------------------------------------------- */
+{
+    memset(h, 0, sizeof *h);
+    memcpy(h->magic, magic, sizeof h->magic);
+
+    h->endian = SPARSE_BIN_ENDIAN;
+    h->m      = m;
+    h->nnz    = nnz;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+sparse_bin_read_header(sparse_bin_file fp, const char *magic,
+                       struct sparse_bin_header *h)
+/* ---------------------------------------------------------------------- */
+{
+    return sparse_bin_io(fp, 0, h, sizeof *h)
+        && (memcmp(h->magic, magic, sizeof h->magic) == 0)
+        && (h->endian == SPARSE_BIN_ENDIAN);
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+csrmatrix_write_bin(const struct CSRMatrix *A, const char *fn, int compress)
+/* ---------------------------------------------------------------------- */
+{
+    int                      ok;
+    sparse_bin_file          fp;
+    struct sparse_bin_header h;
+
+    sparse_bin_init_header(&h, SPARSE_BIN_MAGIC_CSR, A->m, A->nnz);
+    h.checksum = sparse_bin_checksum(0, A->ia, (A->m + 1) * sizeof *A->ia);
+    h.checksum = sparse_bin_checksum(h.checksum, A->ja, A->nnz * sizeof *A->ja);
+    h.checksum = sparse_bin_checksum(h.checksum, A->sa, A->nnz * sizeof *A->sa);
+
+    fp = sparse_bin_open(fn, 1, compress);
+    if (fp == NULL) {
+        return 0;
+    }
+
+    ok =       sparse_bin_io(fp, 1, &h   , sizeof h);
+    ok = ok && sparse_bin_io(fp, 1, A->ia, (A->m + 1) * sizeof *A->ia);
+    ok = ok && sparse_bin_io(fp, 1, A->ja, A->nnz     * sizeof *A->ja);
+    ok = ok && sparse_bin_io(fp, 1, A->sa, A->nnz     * sizeof *A->sa);
+
+    return sparse_bin_close(fp) && ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct CSRMatrix *
+csrmatrix_read_bin(const char *fn)
+/* ---------------------------------------------------------------------- */
+{
+    int                      ok;
+    uint64_t                 checksum;
+    sparse_bin_file          fp;
+    struct sparse_bin_header h;
+    struct CSRMatrix        *A;
+
+    fp = sparse_bin_open(fn, 0, 0);
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    A  = NULL;
+    ok = sparse_bin_read_header(fp, SPARSE_BIN_MAGIC_CSR, &h);
+
+    if (ok) {
+        A  = csrmatrix_new_known_nnz(h.m, h.nnz);
+        ok = A != NULL;
+    }
+
+    ok = ok && sparse_bin_io(fp, 0, A->ia, (A->m + 1) * sizeof *A->ia);
+    ok = ok && sparse_bin_io(fp, 0, A->ja, A->nnz     * sizeof *A->ja);
+    ok = ok && sparse_bin_io(fp, 0, A->sa, A->nnz     * sizeof *A->sa);
+
+    sparse_bin_close(fp);
+
+    if (ok) {
+        checksum = sparse_bin_checksum(0, A->ia, (A->m + 1) * sizeof *A->ia);
+        checksum = sparse_bin_checksum(checksum, A->ja, A->nnz * sizeof *A->ja);
+        checksum = sparse_bin_checksum(checksum, A->sa, A->nnz * sizeof *A->sa);
+
+        ok = (checksum == h.checksum) && (A->ia[0] == 0)
+            && ((size_t) A->ia[A->m] == A->nnz);
+    }
+
+    if (! ok) {
+        csrmatrix_delete(A);
+        A = NULL;
+    }
+
+    return A;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+vector_write_bin(size_t n, const double *v, const char *fn, int compress)
+/* ---------------------------------------------------------------------- */
+{
+    int                      ok;
+    sparse_bin_file          fp;
+    struct sparse_bin_header h;
+
+    sparse_bin_init_header(&h, SPARSE_BIN_MAGIC_VEC, n, n);
+    h.checksum = sparse_bin_checksum(0, v, n * sizeof *v);
+
+    fp = sparse_bin_open(fn, 1, compress);
+    if (fp == NULL) {
+        return 0;
+    }
+
+    ok =       sparse_bin_io(fp, 1, &h, sizeof h);
+    ok = ok && sparse_bin_io(fp, 1, (void *) v, n * sizeof *v);
+
+    return sparse_bin_close(fp) && ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+double *
+vector_read_bin(const char *fn, size_t *n)
+/* ---------------------------------------------------------------------- */
+{
+    int                      ok;
+    double                  *v;
+    sparse_bin_file          fp;
+    struct sparse_bin_header h;
+
+    fp = sparse_bin_open(fn, 0, 0);
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    v  = NULL;
+    ok = sparse_bin_read_header(fp, SPARSE_BIN_MAGIC_VEC, &h);
+
+    if (ok) {
+        v  = malloc((h.m > 0 ? h.m : 1) * sizeof *v);
+        ok = v != NULL;
+    }
+
+    ok = ok && sparse_bin_io(fp, 0, v, h.m * sizeof *v);
+
+    sparse_bin_close(fp);
+
+    ok = ok && (sparse_bin_checksum(0, v, h.m * sizeof *v) == h.checksum);
+
+    if (! ok) {
+        free(v);
+        v = NULL;
+    } else {
+        *n = h.m;
+    }
+
+    return v;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct BCSRMatrix *
+bcsrmatrix_new_count_nnz(size_t m, int bs)
+/* ---------------------------------------------------------------------- */
+{
+    size_t             i;
+    struct BCSRMatrix *new;
+
+    assert (m  > 0);
+    assert (bs > 0);
+
+    new = malloc(1 * sizeof *new);
+    if (new != NULL) {
+        new->ia = malloc((m + 1) * sizeof *new->ia);
+
+        if (new->ia != NULL) {
+            for (i = 0; i < m + 1; i++) { new->ia[i] = 0; }
+
+            new->m   = m;
+            new->nnz = 0;
+            new->bs  = bs;
+
+            new->ja  = NULL;
+            new->sa  = NULL;
+        } else {
+            bcsrmatrix_delete(new);
+            new = NULL;
+        }
+    }
+
+    return new;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct BCSRMatrix *
+bcsrmatrix_new_known_nnz(size_t m, size_t nnz, int bs)
+/* ---------------------------------------------------------------------- */
+{
+    struct BCSRMatrix *new;
+
+    assert (bs > 0);
+
+    new = malloc(1 * sizeof *new);
+
+    if (new != NULL) {
+        new->ia = malloc((m + 1)          * sizeof *new->ia);
+        new->ja = malloc(nnz              * sizeof *new->ja);
+        new->sa = malloc(nnz * bs * bs    * sizeof *new->sa);
+
+        if ((new->ia == NULL) || (new->ja == NULL) || (new->sa == NULL)) {
+            bcsrmatrix_delete(new);
+            new = NULL;
+        } else {
+            new->m   = m;
+            new->nnz = nnz;
+            new->bs  = bs;
+        }
+    }
+
+    return new;
+}
+
+
+/* ---------------------------------------------------------------------- */
+size_t
+bcsrmatrix_new_elms_pushback(struct BCSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    size_t i, bs2;
+
+    assert (A->ia[0] == 0);     /* Elems for row 'i' in bin i+1 ... */
+
+    for (i = 1; i <= A->m; i++) {
+        A->ia[0] += A->ia[i];
+        A->ia[i]  = A->ia[0] - A->ia[i];
+    }
+
+    A->nnz = A->ia[0];
+    assert (A->nnz > 0);        /* Else not a real system. */
+
+    A->ia[0] = 0;
+
+    bs2   = ((size_t) A->bs) * ((size_t) A->bs);
+    A->ja = first_touch_calloc_rows(A->m, A->ia + 1, A->nnz,       sizeof *A->ja);
+    A->sa = first_touch_calloc_rows(A->m, A->ia + 1, A->nnz, bs2 * sizeof *A->sa);
+
+    if ((A->ja == NULL) || (A->sa == NULL)) {
+        free(A->sa);   A->sa = NULL;
+        free(A->ja);   A->ja = NULL;
+
+        A->nnz = 0;
+    }
+
+    return A->nnz;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+bcsrmatrix_sortrows(struct BCSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    size_t i;
+
+    for (i = 0; i < A->m; i++) {
+        qsort(A->ja        + A->ia[i] ,
+              A->ia[i + 1] - A->ia[i] ,
+              sizeof A->ja  [A->ia[i]],
+              cmp_row_elems);
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+size_t
+bcsrmatrix_elm_index(int i, int j, const struct BCSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    int *p;
+
+    p = bsearch(&j, A->ja + A->ia[i], A->ia[i + 1] - A->ia[i],
+                sizeof A->ja[A->ia[i]], cmp_row_elems);
+
+    assert (p != NULL);
+
+    return p - A->ja;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+bcsrmatrix_delete(struct BCSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    if (A != NULL) {
+        free(A->sa);
+        free(A->ja);
+        free(A->ia);
+    }
+
+    free(A);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+bcsrmatrix_zero(struct BCSRMatrix *A)
+/* ---------------------------------------------------------------------- */
+{
+    vector_zero(A->nnz * A->bs * A->bs, A->sa);
+}
+
+
+/* Block row kernel.  Called with a literal block size from
+ * bcsrmatrix_matvec() so the compiler may fully unroll the
+ * inner loops for the common small block sizes. */
+/* ---------------------------------------------------------------------- */
+static void
+bcsr_matvec_bs(const struct BCSRMatrix *A, const int bs,
+               const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    size_t        i;
+    int           k, r, c;
+    const double *blk, *xj;
+    double       *yi;
+
+    for (i = 0; i < A->m; i++) {
+        yi = y + i*bs;
+
+        for (r = 0; r < bs; r++) { yi[r] = 0.0; }
+
+        for (k = A->ia[i]; k < A->ia[i + 1]; k++) {
+            blk = A->sa + ((size_t) k)*bs*bs;
+            xj  = x + ((size_t) A->ja[k])*bs;
+
+            for (r = 0; r < bs; r++) {
+                for (c = 0; c < bs; c++) {
+                    yi[r] += blk[r*bs + c] * xj[c];
+                }
+            }
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+bcsr_matvec_2(const struct BCSRMatrix *A, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    bcsr_matvec_bs(A, 2, x, y);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+bcsr_matvec_3(const struct BCSRMatrix *A, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    bcsr_matvec_bs(A, 3, x, y);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+bcsr_matvec_4(const struct BCSRMatrix *A, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    bcsr_matvec_bs(A, 4, x, y);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+bcsrmatrix_matvec(const struct BCSRMatrix *A, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    switch (A->bs) {
+    case 2:  bcsr_matvec_2 (A, x, y);        break;
+    case 3:  bcsr_matvec_3 (A, x, y);        break;
+    case 4:  bcsr_matvec_4 (A, x, y);        break;
+    default: bcsr_matvec_bs(A, A->bs, x, y); break;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+bcsrmatrix_write(const struct BCSRMatrix *A, const char *fn)
+/* ---------------------------------------------------------------------- */
+{
+    FILE *fp;
+
+    fp = fopen(fn, "wt");
+
+    if (fp != NULL) {
+        bcsrmatrix_write_stream(A, fp);
+        fclose(fp);
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+bcsrmatrix_write_stream(const struct BCSRMatrix *A, FILE *fp)
+/* ---------------------------------------------------------------------- */
+{
+    size_t        i;
+    int           k, r, c, bs;
+    const double *blk;
+
+    bs = A->bs;
+
+    for (i = 0; i < A->m; i++) {
+        for (r = 0; r < bs; r++) {
+            for (k = A->ia[i]; k < A->ia[i + 1]; k++) {
+                blk = A->sa + ((size_t) k)*bs*bs;
+
+                for (c = 0; c < bs; c++) {
+                    fprintf(fp, "%lu %lu %26.18e\n",
+                            (unsigned long) (i*bs + r + 1),
+                            (unsigned long) (A->ja[k]*bs + c + 1),
+                            blk[r*bs + c]);
+                }
+            }
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct sellcs_row
+/* ---------------------------------------------------------------------- */
+{
+    int len;
+    int row;
+};
+
+
+/* Decreasing length, increasing row index for equal lengths. */
+/* ---------------------------------------------------------------------- */
+static int
+cmp_sellcs_rows(const void *a0, const void *b0)
+/* ---------------------------------------------------------------------- */
+{
+    const struct sellcs_row *a = a0, *b = b0;
+
+    if (a->len != b->len) { return b->len - a->len; }
+
+    return a->row - b->row;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct SellCSMatrix *
+sellcsmatrix_from_csr(const struct CSRMatrix *A, int C, int sigma)
+/* ---------------------------------------------------------------------- */
+{
+    size_t ch, i, nrows, start, end;
+    int    r, k, len, row, col;
+    size_t ix;
+
+    struct sellcs_row   *rows;
+    struct SellCSMatrix *S;
+
+    if ((C < 1) || (C > SELLCS_MAX_CHUNK_HEIGHT)) {
+        return NULL;
+    }
+
+    if (sigma < 1) { sigma = 1; }
+    if (sigma > 1) { sigma = ((sigma + C - 1) / C) * C; }
+
+    S = malloc(1 * sizeof *S);
+    if (S == NULL) {
+        return NULL;
+    }
+
+    S->m         = A->m;
+    S->nchunks   = (A->m + C - 1) / C;
+    S->C         = C;
+    S->sigma     = sigma;
+    nrows        = S->nchunks * C;
+    S->perm      = malloc((nrows > 0 ? nrows : 1) * sizeof *S->perm);
+    S->chunk_pos = malloc((S->nchunks + 1)        * sizeof *S->chunk_pos);
+    S->ja        = NULL;
+    S->sa        = NULL;
+    rows         = malloc((nrows > 0 ? nrows : 1) * sizeof *rows);
+
+    if ((S->perm == NULL) || (S->chunk_pos == NULL) || (rows == NULL)) {
+        free(rows);
+        sellcsmatrix_delete(S);
+        return NULL;
+    }
+
+    for (i = 0; i < nrows; i++) {
+        rows[i].row = (i < A->m) ? (int) i : -1;
+        rows[i].len = (i < A->m) ? A->ia[i + 1] - A->ia[i] : 0;
+    }
+
+    /* Sort within windows of sigma rows. Padding rows stay last. */
+    if (sigma > 1) {
+        for (start = 0; start < A->m; start += sigma) {
+            end = start + sigma;
+            if (end > A->m) { end = A->m; }
+
+            qsort(rows + start, end - start, sizeof *rows, cmp_sellcs_rows);
+        }
+    }
+
+    S->chunk_pos[0] = 0;
+    for (ch = 0; ch < S->nchunks; ch++) {
+        len = 0;
+        for (r = 0; r < C; r++) {
+            S->perm[ch*C + r] = rows[ch*C + r].row;
+
+            if (rows[ch*C + r].len > len) { len = rows[ch*C + r].len; }
+        }
+
+        S->chunk_pos[ch + 1] = S->chunk_pos[ch] + ((size_t) len) * C;
+    }
+
+    free(rows);
+
+    ix    = S->chunk_pos[S->nchunks];
+    S->ja = malloc((ix > 0 ? ix : 1) * sizeof *S->ja);
+    S->sa = malloc((ix > 0 ? ix : 1) * sizeof *S->sa);
+
+    if ((S->ja == NULL) || (S->sa == NULL)) {
+        sellcsmatrix_delete(S);
+        return NULL;
+    }
+
+    for (ch = 0; ch < S->nchunks; ch++) {
+        len = (int) ((S->chunk_pos[ch + 1] - S->chunk_pos[ch]) / C);
+
+        for (r = 0; r < C; r++) {
+            row = S->perm[ch*C + r];
+
+            /* Padding repeats the last column of the row, so that the
+             * product only touches entries of x the row already reads. */
+            col = 0;
+            for (k = 0; k < len; k++) {
+                ix = S->chunk_pos[ch] + ((size_t) k)*C + r;
+
+                if ((row >= 0) && (k < A->ia[row + 1] - A->ia[row])) {
+                    col = A->ja[A->ia[row] + k];
+                }
+
+                S->ja[ix] = col;
+            }
+        }
+    }
+
+    sellcsmatrix_update_values(A, S);
+
+    return S;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+sellcsmatrix_update_values(const struct CSRMatrix *A,
+                           struct SellCSMatrix    *S)
+/* ---------------------------------------------------------------------- */
+{
+    size_t ch, ix;
+    int    r, k, len, rlen, row, C;
+
+    C = S->C;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(r, k, len, rlen, row, ix)
+#endif
+    for (ch = 0; ch < S->nchunks; ch++) {
+        len = (int) ((S->chunk_pos[ch + 1] - S->chunk_pos[ch]) / C);
+
+        for (r = 0; r < C; r++) {
+            row  = S->perm[ch*C + r];
+            rlen = (row >= 0) ? A->ia[row + 1] - A->ia[row] : 0;
+
+            for (k = 0; k < len; k++) {
+                ix = S->chunk_pos[ch] + ((size_t) k)*C + r;
+
+                S->sa[ix] = (k < rlen) ? A->sa[A->ia[row] + k] : 0.0;
+            }
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+sellcsmatrix_delete(struct SellCSMatrix *S)
+/* ---------------------------------------------------------------------- */
+{
+    if (S != NULL) {
+        free(S->sa);
+        free(S->ja);
+        free(S->chunk_pos);
+        free(S->perm);
+    }
+
+    free(S);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+sellcsmatrix_matvec(const struct SellCSMatrix *S, const double *x, double *y)
+/* ---------------------------------------------------------------------- */
+{
+    size_t        ch;
+    int           r, k, len, C, row;
+    double        acc[SELLCS_MAX_CHUNK_HEIGHT];
+    const int    *ja;
+    const double *sa;
+
+    C = S->C;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(r, k, len, row, acc, ja, sa)
+#endif
+    for (ch = 0; ch < S->nchunks; ch++) {
+        len = (int) ((S->chunk_pos[ch + 1] - S->chunk_pos[ch]) / C);
+        ja  = S->ja + S->chunk_pos[ch];
+        sa  = S->sa + S->chunk_pos[ch];
+
+        for (r = 0; r < C; r++) { acc[r] = 0.0; }
+
+        /* Unit stride over the rows of the chunk in the inner loop. */
+        for (k = 0; k < len; k++) {
+            for (r = 0; r < C; r++) {
+                acc[r] += sa[k*C + r] * x[ja[k*C + r]];
+            }
+        }
+
+        for (r = 0; r < C; r++) {
+            row = S->perm[ch*C + r];
+
+            if (row >= 0) { y[row] = acc[r]; }
+        }
+    }
+}
@@ -142,6 +142,8 @@ csrmatrix_elm_index(int i, int j, const struct CSRMatrix *A);
  * <CODE>A->ja[k] < A->ja[k+1]</CODE> for all <CODE>k = A->ia[i], ...,
  * A->ia[i+1]-2</CODE> in each row <CODE>i = 0, ..., A->m - 1</CODE>.
  *
+ * Rows are sorted independently and in parallel if OpenMP is enabled.
+ *
  * \param[in,out] A Matrix.
  */
 void
@@ -162,6 +164,17 @@ void
 csrmatrix_delete(struct CSRMatrix *A);
 
 
+/**
+ * Count the bytes allocated by a matrix with exactly sized arrays.
+ *
+ * \param[in] A Matrix.
+ *
+ * \return Bytes of the matrix structure and its arrays.
+ */
+size_t
+csrmatrix_memory(const struct CSRMatrix *A);
+
+
 /**
  * Zero all matrix elements, typically in preparation of elemental
  * assembly.
@@ -182,6 +195,38 @@ void
 vector_zero(size_t n, double *v);
 
 
+/**
+ * Compute matrix-vector product <CODE>y = A*x</CODE>.
+ *
+ * Rows are distributed across threads if OpenMP is enabled.
+ *
+ * \param[in]  A Matrix.
+ * \param[in]  x Vector of size at least <CODE>1 + max(A->ja)</CODE>.
+ * \param[out] y Vector of size <CODE>A->m</CODE>.  Must not alias @c x.
+ */
+void
+csrmatrix_matvec(const struct CSRMatrix *A, const double *x, double *y);
+
+
+/**
+ * Compute transposed matrix-vector product <CODE>y = A'*x</CODE>.
+ *
+ * If OpenMP is enabled, each thread accumulates the contributions of
+ * its rows in a private array of size @c n, and the arrays are summed
+ * afterwards.  Falls back to a serial loop if these arrays cannot be
+ * allocated.
+ *
+ * \param[in]  A Matrix.
+ * \param[in]  n Number of matrix columns, i.e., at least
+ *              <CODE>1 + max(A->ja)</CODE>.
+ * \param[in]  x Vector of size <CODE>A->m</CODE>.
+ * \param[out] y Vector of size @c n.  Must not alias @c x.
+ */
+void
+csrmatrix_matvec_transpose(const struct CSRMatrix *A, size_t n,
+                           const double *x, double *y);
+
+
 /**
  * Print matrix to file.
  *
@@ -245,6 +290,320 @@ vector_write(size_t n, const double *v, const char *fn);
 void
 vector_write_stream(size_t n, const double *v, FILE *fp);
 
+
+/**
+ * Write matrix to file in binary format.
+ *
+ * The file holds a header with the matrix sizes and a checksum of the
+ * contents, followed by the arrays @c ia, @c ja and @c sa in native
+ * byte order.  It is much faster to write and read than the text
+ * format of csrmatrix_write(), and preserves the matrix elements
+ * exactly.
+ *
+ * \param[in] A        Matrix.
+ * \param[in] fn       Name of file to which matrix contents will be output.
+ * \param[in] compress Whether to compress the file (gzip format).  The
+ *                     file is written uncompressed if the library is
+ *                     built without zlib.
+ *
+ * \return One if successful and zero otherwise.
+ */
+int
+csrmatrix_write_bin(const struct CSRMatrix *A, const char *fn, int compress);
+
+
+/**
+ * Read matrix from file written by csrmatrix_write_bin().
+ *
+ * Compressed files can only be read if the library is built with zlib.
+ *
+ * \param[in] fn Name of file.
+ *
+ * \return Matrix, to be released with csrmatrix_delete().  @c NULL if
+ * the file cannot be read, is not a matrix file of the same byte order,
+ * or fails the checksum test.
+ */
+struct CSRMatrix *
+csrmatrix_read_bin(const char *fn);
+
+
+/**
+ * Write vector to file in the binary format of csrmatrix_write_bin().
+ *
+ * \param[in] n        Number of vector elements.
+ * \param[in] v        Vector.
+ * \param[in] fn       Name of file to which vector contents will be output.
+ * \param[in] compress Whether to compress the file.
+ *
+ * \return One if successful and zero otherwise.
+ */
+int
+vector_write_bin(size_t n, const double *v, const char *fn, int compress);
+
+
+/**
+ * Read vector from file written by vector_write_bin().
+ *
+ * \param[in]  fn Name of file.
+ * \param[out] n  Number of vector elements.
+ *
+ * \return Vector of size @c *n, to be released with free().  @c NULL
+ * in case of failure, as for csrmatrix_read_bin().
+ */
+double *
+vector_read_bin(const char *fn, size_t *n);
+
+
+/**
+ * Block compressed-sparse row (BCSR) matrix data structure.
+ *
+ * All blocks are square, of size <CODE>bs</CODE>-by-<CODE>bs</CODE>,
+ * and stored consecutively in row major order.  Block @c k occupies
+ * <CODE>sa[k*bs*bs], ..., sa[(k+1)*bs*bs - 1]</CODE>.  Scalar unknown
+ * @c r of block row @c i has index <CODE>i*bs + r</CODE>.
+ */
+struct BCSRMatrix
+{
+    size_t      m;    /**< Number of block rows */
+    size_t      nnz;  /**< Number of structurally non-zero blocks */
+    int         bs;   /**< Block size */
+
+    int        *ia;   /**< Block row pointers */
+    int        *ja;   /**< Block column indices */
+
+    double     *sa;   /**< Block elements */
+};
+
+
+/**
+ * Allocate a block matrix structure and corresponding row pointers
+ * to support the "count and push-back" construction scheme.
+ *
+ * Analogous to csrmatrix_new_count_nnz().  The matrix is fully formed
+ * in bcsrmatrix_new_elms_pushback().
+ *
+ * \param[in] m  Number of block rows.
+ * \param[in] bs Block size.
+ *
+ * \return Allocated matrix structure with zero-initialised row
+ * pointers, @c NULL in case of allocation failure.
+ */
+struct BCSRMatrix *
+bcsrmatrix_new_count_nnz(size_t m, int bs);
+
+
+/**
+ * Allocate a block matrix structure and all constituent fields to
+ * hold a sparse matrix with a specified number of non-zero blocks.
+ *
+ * Analogous to csrmatrix_new_known_nnz().  The sparsity pattern must
+ * be constructed by the caller.
+ *
+ * \param[in] m   Number of block rows.
+ * \param[in] nnz Number of structurally non-zero blocks.
+ * \param[in] bs  Block size.
+ *
+ * \return Allocated matrix structure, @c NULL in case of allocation
+ * failure.
+ */
+struct BCSRMatrix *
+bcsrmatrix_new_known_nnz(size_t m, size_t nnz, int bs);
+
+
+/**
+ * Set row pointers and allocate column index and block element arrays
+ * of a matrix obtained from bcsrmatrix_new_count_nnz().
+ *
+ * Follows the conventions of csrmatrix_new_elms_pushback(), with
+ * counts measured in blocks.
+ *
+ * \param[in,out] A Matrix.
+ *
+ * \return Total number of allocated non-zero blocks if successful and
+ * zero in case of allocation failure.
+ */
+size_t
+bcsrmatrix_new_elms_pushback(struct BCSRMatrix *A);
+
+
+/**
+ * Compute non-zero block index of specified block.
+ *
+ * Requires sorted block rows (see bcsrmatrix_sortrows()).
+ *
+ * \param[in] i Block row index.
+ * \param[in] j Block column index.  Must be in the structural non-zero
+ *              block set of row @c i.
+ * \param[in] A Matrix.
+ *
+ * \return Non-zero block index, into @c A->ja, of block
+ * <CODE>(i,j)</CODE>.  The block elements start at
+ * <CODE>A->sa + index*A->bs*A->bs</CODE>.
+ */
+size_t
+bcsrmatrix_elm_index(int i, int j, const struct BCSRMatrix *A);
+
+
+/**
+ * Sort block column indices within each block row in ascending order.
+ *
+ * As for csrmatrix_sortrows(), the block elements are not referenced.
+ *
+ * \param[in,out] A Matrix.
+ */
+void
+bcsrmatrix_sortrows(struct BCSRMatrix *A);
+
+
+/**
+ * Dispose of memory resources obtained through prior calls to
+ * bcsrmatrix allocation routines.
+ *
+ * \param[in,out] A Matrix.
+ */
+void
+bcsrmatrix_delete(struct BCSRMatrix *A);
+
+
+/**
+ * Zero all block elements.
+ *
+ * \param[in,out] A Matrix for which to zero the elements.
+ */
+void
+bcsrmatrix_zero(struct BCSRMatrix *A);
+
+
+/**
+ * Compute matrix-vector product <CODE>y = A*x</CODE>.
+ *
+ * Block sizes two, three and four use kernels specialised at compile
+ * time.
+ *
+ * \param[in]  A Matrix.
+ * \param[in]  x Vector of size <CODE>A->m * A->bs</CODE>.
+ * \param[out] y Vector of size <CODE>A->m * A->bs</CODE>.  Must not
+ *               alias @c x.
+ */
+void
+bcsrmatrix_matvec(const struct BCSRMatrix *A, const double *x, double *y);
+
+
+/**
+ * Print block matrix to file.
+ *
+ * The matrix is printed in scalar coordinate format as in
+ * csrmatrix_write().
+ *
+ * \param[in] A  Matrix.
+ * \param[in] fn Name of file to which matrix contents will be output.
+ */
+void
+bcsrmatrix_write(const struct BCSRMatrix *A, const char *fn);
+
+
+/**
+ * Print block matrix to stream in scalar coordinate format.
+ *
+ * \param[in]     A  Matrix.
+ * \param[in,out] fp Open (text) stream to which matrix contents
+ *                   will be output.
+ */
+void
+bcsrmatrix_write_stream(const struct BCSRMatrix *A, FILE *fp);
+
+
+/**
+ * Maximum chunk height of a SELL-C-sigma matrix.
+ */
+#define SELLCS_MAX_CHUNK_HEIGHT 32
+
+
+/**
+ * Sliced ELLPACK (SELL-C-sigma) matrix data structure.
+ *
+ * The rows are grouped into chunks of @c C consecutive rows, after
+ * sorting the rows by decreasing length within windows of @c sigma
+ * rows.  Each chunk is stored column major, padded to the length of
+ * its longest row, so that the inner loop of the matrix-vector product
+ * runs over the @c C rows of a chunk with unit stride and vectorises.
+ * Element @c k of sliced row @c r in chunk @c ch is stored at index
+ * <CODE>chunk_pos[ch] + k*C + r</CODE> of @c ja and @c sa.  Padding
+ * elements have value zero and a valid column index.
+ */
+struct SellCSMatrix
+{
+    size_t      m;         /**< Number of rows */
+    size_t      nchunks;   /**< Number of chunks */
+    int         C;         /**< Chunk height */
+    int         sigma;     /**< Sorting window */
+
+    int        *perm;      /**< Original row of each sliced row, -1 for
+                            *   padding rows.  Size @c nchunks*C. */
+    size_t     *chunk_pos; /**< Start of each chunk in @c ja and @c sa.
+                            *   Size @c nchunks+1. */
+    int        *ja;        /**< Column indices */
+    double     *sa;        /**< Matrix elements */
+};
+
+
+/**
+ * Create a SELL-C-sigma copy of a CSR matrix.
+ *
+ * The memory resources should be released through the
+ * sellcsmatrix_delete() function.
+ *
+ * \param[in] A     Matrix.
+ * \param[in] C     Chunk height, in
+ *                  <CODE>[1, SELLCS_MAX_CHUNK_HEIGHT]</CODE>.  Typically
+ *                  the SIMD width, or a small multiple thereof.
+ * \param[in] sigma Sorting window.  A value of one keeps the row
+ *                  order, larger values reduce the padding at the cost
+ *                  of locality in the output vector.  Rounded up to a
+ *                  multiple of @c C.
+ *
+ * \return Allocated matrix, @c NULL in case of allocation failure or
+ * invalid chunk height.
+ */
+struct SellCSMatrix *
+sellcsmatrix_from_csr(const struct CSRMatrix *A, int C, int sigma);
+
+
+/**
+ * Copy the matrix elements of a CSR matrix into a SELL-C-sigma matrix
+ * created from a matrix with the same sparsity pattern, e.g., after
+ * reassembly.
+ *
+ * \param[in]     A Matrix with the same structure as the one passed to
+ *                  sellcsmatrix_from_csr().
+ * \param[in,out] S SELL-C-sigma matrix.
+ */
+void
+sellcsmatrix_update_values(const struct CSRMatrix *A,
+                           struct SellCSMatrix    *S);
+
+
+/**
+ * Dispose of memory resources obtained through sellcsmatrix_from_csr().
+ *
+ * \param[in,out] S Matrix.  Invalid following the call.
+ */
+void
+sellcsmatrix_delete(struct SellCSMatrix *S);
+
+
+/**
+ * Compute matrix-vector product <CODE>y = S*x</CODE>.
+ *
+ * Chunks are distributed across threads if OpenMP is enabled.
+ *
+ * \param[in]  S Matrix.
+ * \param[in]  x Vector.
+ * \param[out] y Vector of size <CODE>S->m</CODE>.  Must not alias @c x.
+ */
+void
+sellcsmatrix_matvec(const struct SellCSMatrix *S, const double *x, double *y);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,10 +27,14 @@
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/wells.h>
 #include <opm/core/simulator/BlackoilState.hpp>
 #include <opm/core/simulator/WellState.hpp>
+#include <opm/core/simulator/TimeStepControlInterface.hpp>
+#include <opm/core/utility/TimingTree.hpp>
+#include <opm/core/props/BlackoilPropertiesInterface.hpp>
 #include <opm/core/props/rock/RockCompressibility.hpp>
 
 #include <algorithm>
@@ -42,6 +46,30 @@
 namespace Opm
 {
 
+    namespace {
+        /// Eisenstat-Walker forcing term, choice 2 with gamma = 0.9
+        /// and alpha = 2, including the safeguards against
+        /// decreasing too fast and over-solving the final iteration.
+        double forcingTerm(const double res_norm,
+                           const double prev_res_norm,
+                           const double prev_forcing,
+                           const double max_forcing,
+                           const double residual_tol)
+        {
+            const double gamma = 0.9;
+            const double ratio = (prev_res_norm > 0.0) ? res_norm / prev_res_norm : 0.0;
+            double forcing = gamma * ratio * ratio;
+            const double safeguard = gamma * prev_forcing * prev_forcing;
+            if (safeguard > 0.1) {
+                forcing = std::max(forcing, safeguard);
+            }
+            if (res_norm > 0.0) {
+                forcing = std::max(forcing, 0.5 * residual_tol / res_norm);
+            }
+            return std::min(forcing, max_forcing);
+        }
+    } // anonymous namespace
+
 
     /// Construct solver.
     /// \param[in] grid          A 2d or 3d grid.
@@ -62,7 +90,7 @@ namespace Opm
     CompressibleTpfa::CompressibleTpfa(const UnstructuredGrid& grid,
                                        const BlackoilPropertiesInterface& props,
                                        const RockCompressibility* rock_comp_props,
-                                       const LinearSolverInterface& linsolver,
+                                       LinearSolverInterface& linsolver,
                                        const double residual_tol,
                                        const double change_tol,
                                        const int maxiter,
@@ -80,6 +108,10 @@ namespace Opm
           htrans_(grid.cell_facepos[ grid.number_of_cells ]),
           trans_ (grid.number_of_faces),
           allcells_(grid.number_of_cells),
+          forcing_term_(false),
+          warm_start_(false),
+          max_forcing_(0.5),
+          iteration_monitor_(0),
           singular_(false)
     {
         if (wells_ && (wells_->number_of_phases != props.numPhases())) {
@@ -94,8 +126,10 @@ namespace Opm
         // If we have rock compressibility, pore volumes are updated
         // in the compute*() methods, otherwise they are constant and
         // hence may be computed here.
+        // The pore volumes at reference pressure are kept for that.
+        computePorevolume(grid_, props.porosity(), static_porevol_);
         if (rock_comp_props_ == NULL || !rock_comp_props_->isActive()) {
-            computePorevolume(grid_, props.porosity(), porevol_);
+            porevol_ = static_porevol_;
         }
         for (int c = 0; c < grid.number_of_cells; ++c) {
             allcells_[c] = c;
@@ -118,6 +152,28 @@ namespace Opm
 
 
 
+    /// Inform the solver that the well topology has changed.
+    void CompressibleTpfa::updateWells(const Wells* wells)
+    {
+        if (wells && (wells->number_of_phases != props_.numPhases())) {
+            OPM_THROW(std::runtime_error, "Inconsistent number of phases specified (wells vs. props): "
+                  << wells->number_of_phases << " != " << props_.numPhases());
+        }
+        wells_ = wells;
+        const int num_dofs = grid_.number_of_cells + (wells ? wells->number_of_wells : 0);
+        pressure_increment_.resize(num_dofs);
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        cfs_tpfa_res_wells w;
+        w.W = const_cast<struct Wells*>(wells_);
+        w.data = NULL;
+        if (!cfs_tpfa_res_update_wells(gg, &w, props_.numPhases(), h_)) {
+            OPM_THROW(std::runtime_error, "Failed to update pressure system for new well topology.");
+        }
+    }
+
+
+
+
     /// Solve pressure equation, by Newton iterations.
     void CompressibleTpfa::solve(const double dt,
                                  BlackoilState& state,
@@ -136,14 +192,22 @@ namespace Opm
         double inc_norm = 0.0;
         int iter = 0;
         double res_norm = residualNorm();
+        double prev_res_norm = res_norm;
+        const double linsolver_tol = linsolver_.getTolerance();
+        double forcing = max_forcing_;
+        std::fill(pressure_increment_.begin(), pressure_increment_.end(), 0.0);
         std::cout << "\nIteration         Residual        Change in p\n"
                   << std::setw(9) << iter
                   << std::setw(18) << res_norm
                   << std::setw(18) << '*' << std::endl;
-        while ((iter < maxiter_) && (res_norm > residual_tol_)) {
+        bool aborted = iteration_monitor_ && !iteration_monitor_->iterationDone(iter, res_norm);
+        while (!aborted && (iter < maxiter_) && (res_norm > residual_tol_)) {
             // Solve for increment in Newton method:
             //   incr = x_{n+1} - x_{n} = -J^{-1}F
             // (J is Jacobian matrix, F is residual)
+            if (forcing_term_) {
+                linsolver_.setTolerance(std::max(forcing, linsolver_tol));
+            }
             solveIncrement();
             ++iter;
 
@@ -176,8 +240,36 @@ namespace Opm
             std::cout << std::setw(9) << iter
                       << std::setw(18) << res_norm
                       << std::setw(18) << inc_norm << std::endl;
+
+            if (iteration_monitor_ && !iteration_monitor_->iterationDone(iter, res_norm)) {
+                aborted = true;
+                break;
+            }
+
+            // Prepare next linear solve.
+            if (forcing_term_) {
+                forcing = forcingTerm(res_norm, prev_res_norm, forcing,
+                                      max_forcing_, residual_tol_);
+            }
+            if (warm_start_) {
+                // Assume the residual keeps decreasing at the same rate.
+                const double scale = (prev_res_norm > 0.0) ? res_norm / prev_res_norm : 0.0;
+                for (double& dp : pressure_increment_) {
+                    dp *= scale;
+                }
+            } else {
+                std::fill(pressure_increment_.begin(), pressure_increment_.end(), 0.0);
+            }
+            prev_res_norm = res_norm;
         }
 
+        if (forcing_term_) {
+            linsolver_.setTolerance(linsolver_tol);
+        }
+
+        if (aborted) {
+            OPM_THROW(std::runtime_error, "CompressibleTpfa::solve() gave up converging after " << iter << " iterations.");
+        }
         if ((iter == maxiter_) && (res_norm > residual_tol_) && (inc_norm > change_tol_)) {
             OPM_THROW(std::runtime_error, "CompressibleTpfa::solve() failed to converge in " << maxiter_ << " iterations.");
         }
@@ -192,6 +284,36 @@ namespace Opm
 
 
 
+    /// Control the accuracy of the linear solves in the Newton
+    /// iterations of solve().
+    void CompressibleTpfa::setInexactNewton(const bool forcing_term,
+                                            const bool warm_start,
+                                            const double max_forcing)
+    {
+        if (!(max_forcing > 0.0 && max_forcing < 1.0)) {
+            OPM_THROW(std::runtime_error, "Maximum forcing term must be in (0, 1), got " << max_forcing);
+        }
+        forcing_term_ = forcing_term;
+        warm_start_ = warm_start;
+        max_forcing_ = max_forcing;
+    }
+
+
+
+
+
+    /// Report the residual norm of every Newton iteration of solve()
+    /// to a monitor, which may make solve() give up early by
+    /// throwing as for too many iterations.
+    void CompressibleTpfa::setIterationMonitor(NewtonIterationMonitorInterface* monitor)
+    {
+        iteration_monitor_ = monitor;
+    }
+
+
+
+
+
     /// @brief After solve(), was the resulting pressure singular.
     /// Returns true if the pressure is singular in the following
     /// sense: if everything is incompressible and there are no
@@ -207,6 +329,36 @@ namespace Opm
 
 
 
+    /// Add the bytes of the residual system and of the work arrays
+    /// to the child "pressure" of the report.
+    void CompressibleTpfa::reportMemory(MemoryReport& report) const
+    {
+        MemoryReport& pressure = report.child("pressure");
+
+        std::size_t matrix = 0, assembly = 0;
+        cfs_tpfa_res_memory(h_, &matrix, &assembly);
+        pressure.add("matrix", matrix);
+        pressure.add("assembly", assembly);
+
+        pressure.add("static data",
+                     MemoryReport::bytes(htrans_) + MemoryReport::bytes(trans_)
+                     + MemoryReport::bytes(allcells_) + MemoryReport::bytes(static_porevol_));
+
+        pressure.add("work arrays",
+                     MemoryReport::bytes(wellperf_wdp_) + MemoryReport::bytes(initial_porevol_)
+                     + MemoryReport::bytes(cell_A_) + MemoryReport::bytes(cell_dA_)
+                     + MemoryReport::bytes(cell_viscosity_) + MemoryReport::bytes(cell_phasemob_)
+                     + MemoryReport::bytes(cell_voldisc_) + MemoryReport::bytes(cell_rho_)
+                     + MemoryReport::bytes(face_A_) + MemoryReport::bytes(face_phasemob_)
+                     + MemoryReport::bytes(face_gravcap_) + MemoryReport::bytes(wellperf_A_)
+                     + MemoryReport::bytes(wellperf_phasemob_) + MemoryReport::bytes(porevol_)
+                     + MemoryReport::bytes(rock_comp_) + MemoryReport::bytes(pressure_increment_));
+    }
+
+
+
+
+
     /// Compute well potentials.
     void CompressibleTpfa::computeWellPotentials(const BlackoilState& state)
     {
@@ -223,25 +375,37 @@ namespace Opm
             return;
         }
 
-        // Temporary storage for perforation A matrices and densities.
-        std::vector<double> A(np*np, 0.0);
-        std::vector<double> rho(np, 0.0);
+        // Gather the perforation cell states, to evaluate the
+        // densities of all perforations in a single property call.
+        std::vector<double> perf_p(nperf);
+        std::vector<double> perf_T(nperf);
+        std::vector<double> perf_z(nperf*np);
+        for (int j = 0; j < nperf; ++j) {
+            const int cell = wells_->well_cells[j];
+            perf_p[j] = state.pressure()[cell];
+            perf_T[j] = state.temperature()[cell];
+            std::copy(&state.surfacevol()[np*cell], &state.surfacevol()[np*cell] + np, &perf_z[np*j]);
+        }
+        std::vector<double> A(nperf*np*np);
+        std::vector<double> rho(nperf*np);
+        props_.matrix(nperf, &perf_p[0], &perf_T[0], &perf_z[0], wells_->well_cells, &A[0], 0);
+        props_.density(nperf, &A[0], wells_->well_cells, &rho[0]);
 
-        // Main loop, iterate over all perforations,
+        // Iterate over all perforations,
         // using the following formula (by phase):
         //    wdp(perf) = g*(perf_z - well_ref_z)*rho(perf)
         // where the total density rho(perf) is taken to be
         //    sum_p (rho_p*saturation_p) in the perforation cell.
+        // Every well writes its own contiguous range of perforations.
+#pragma omp parallel for schedule(static)
         for (int w = 0; w < nw; ++w) {
             const double ref_depth = wells_->depth_ref[w];
             for (int j = wells_->well_connpos[w]; j < wells_->well_connpos[w + 1]; ++j) {
                 const int cell = wells_->well_cells[j];
                 const double cell_depth = grid_.cell_centroids[dim * cell + dim - 1];
-                props_.matrix(1, &state.pressure()[cell], &state.temperature()[cell], &state.surfacevol()[np*cell], &cell, &A[0], 0);
-                props_.density(1, &A[0], &cell, &rho[0]);
                 for (int phase = 0; phase < np; ++phase) {
                     const double s_phase = state.saturation()[np*cell + phase];
-                    wellperf_wdp_[j] += s_phase*rho[phase]*grav*(cell_depth - ref_depth);
+                    wellperf_wdp_[j] += s_phase*rho[np*j + phase]*grav*(cell_depth - ref_depth);
                 }
             }
         }
@@ -257,7 +421,7 @@ namespace Opm
     {
         computeWellPotentials(state);
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), initial_porevol_);
+            computePorevolume(static_porevol_, *rock_comp_props_, state.pressure(), initial_porevol_);
         }
     }
 
@@ -269,6 +433,7 @@ namespace Opm
                                                           const BlackoilState& state,
                                                           const WellState& well_state)
     {
+        OPM_TIMED_SCOPE("property evaluation");
         // These are the variables that get computed by this function:
         //
         // std::vector<double> cell_A_;
@@ -307,18 +472,17 @@ namespace Opm
         // std::vector<double> porevol_;   // Only modified if rock_comp_props_ is non-null.
         // std::vector<double> rock_comp_; // Empty unless rock_comp_props_ is non-null.
         const int nc = grid_.number_of_cells;
-        const int np = props_.numPhases();
         const double* cell_p = &state.pressure()[0];
         const double* cell_T = &state.temperature()[0];
         const double* cell_z = &state.surfacevol()[0];
         const double* cell_s = &state.saturation()[0];
-        cell_A_.resize(nc*np*np);
-        cell_dA_.resize(nc*np*np);
-        props_.matrix(nc, cell_p, cell_T, cell_z, &allcells_[0], &cell_A_[0], &cell_dA_[0]);
-        cell_viscosity_.resize(nc*np);
-        props_.viscosity(nc, cell_p, cell_T, cell_z, &allcells_[0], &cell_viscosity_[0], 0);
-        cell_phasemob_.resize(nc*np);
-        props_.relperm(nc, cell_s, &allcells_[0], &cell_phasemob_[0], 0);
+        // All cell fluid properties in one pass, sharing the PVT lookups.
+        BlackoilFluidData fluid;
+        props_.fluidProperties(nc, cell_p, cell_T, cell_z, cell_s, &allcells_[0], true, fluid);
+        cell_A_.swap(fluid.A);
+        cell_dA_.swap(fluid.dAdp);
+        cell_viscosity_.swap(fluid.mu);
+        cell_phasemob_.swap(fluid.kr);
         std::transform(cell_phasemob_.begin(), cell_phasemob_.end(),
                        cell_viscosity_.begin(),
                        cell_phasemob_.begin(),
@@ -332,11 +496,9 @@ namespace Opm
         cell_voldisc_.resize(nc, 0.0);
 
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol_);
+            computePorevolume(static_porevol_, *rock_comp_props_, state.pressure(), porevol_);
             rock_comp_.resize(nc);
-            for (int cell = 0; cell < nc; ++cell) {
-                rock_comp_[cell] = rock_comp_props_->rockComp(state.pressure()[cell]);
-            }
+            rock_comp_props_->rockComp(nc, state.pressure().data(), rock_comp_.data());
         }
     }
 
@@ -350,49 +512,45 @@ namespace Opm
     {
         // These are the variables that get computed by this function:
         //
+        // std::vector<double> cell_rho_;  // Only with gravity.
         // std::vector<double> face_A_;
         // std::vector<double> face_phasemob_;
         // std::vector<double> face_gravcap_;
+        const int nc = grid_.number_of_cells;
         const int np = props_.numPhases();
         const int nf = grid_.number_of_faces;
         const int dim = grid_.dimensions;
         const double grav = gravity_ ? gravity_[dim - 1] : 0.0;
-        std::vector<double> gravcontrib[2];
-        std::vector<double> pot[2];
-        gravcontrib[0].resize(np);
-        gravcontrib[1].resize(np);
-        pot[0].resize(np);
-        pot[1].resize(np);
+        // Cell densities in a single call, rather than one call per
+        // face side.
+        if (grav != 0.0) {
+            cell_rho_.resize(nc*np);
+            props_.density(nc, &cell_A_[0], &allcells_[0], &cell_rho_[0]);
+        }
         face_A_.resize(nf*np*np);
         face_phasemob_.resize(nf*np);
         face_gravcap_.resize(nf*np);
+        const double* cell_press = &state.pressure()[0];
+        const double* face_press = &state.facepressure()[0];
+        // Gravity terms, potentials and upwinding of each face in a
+        // single pass. Every face only writes its own entries.
+#pragma omp parallel for schedule(static)
         for (int face = 0; face < nf; ++face) {
             // Obtain properties from both sides of the face.
             const double face_depth = grid_.face_centroids[face*dim + dim - 1];
             const int* c = &grid_.face_cells[2*face];
 
-            // Get pressures and compute gravity contributions,
-            // to decide upwind directions.
+            // Get pressures and depth differences, to compute gravity
+            // contributions and decide upwind directions.
             double c_press[2];
+            double c_gdz[2];
             for (int j = 0; j < 2; ++j) {
                 if (c[j] >= 0) {
-                    // Pressure
-                    c_press[j] = state.pressure()[c[j]];
-                    // Gravity contribution, gravcontrib = rho*(face_z - cell_z) [per phase].
-                    if (grav != 0.0) {
-                        const double depth_diff = face_depth - grid_.cell_centroids[c[j]*dim + dim - 1];
-                        props_.density(1, &cell_A_[np*np*c[j]], &c[j], &gravcontrib[j][0]);
-                        for (int p = 0; p < np; ++p) {
-                            gravcontrib[j][p] *= depth_diff*grav;
-                        }
-                    } else {
-                        std::fill(gravcontrib[j].begin(), gravcontrib[j].end(), 0.0);
-                    }
+                    c_press[j] = cell_press[c[j]];
+                    c_gdz[j] = (face_depth - grid_.cell_centroids[c[j]*dim + dim - 1])*grav;
                 } else {
-                    // Pressures
-                    c_press[j] = state.facepressure()[face];
-                    // Gravity contribution.
-                    std::fill(gravcontrib[j].begin(), gravcontrib[j].end(), 0.0);
+                    c_press[j] = face_press[face];
+                    c_gdz[j] = 0.0;
                 }
             }
 
@@ -400,16 +558,11 @@ namespace Opm
             //    gravcapf = rho_1*g*(z_12 - z_1) - rho_2*g*(z_12 - z_2)
             // where _1 and _2 refers to two neigbour cells, z is the
             // z coordinate of the centroid, and z_12 is the face centroid.
-            // Also compute the potentials.
-            for (int phase = 0; phase < np; ++phase) {
-                face_gravcap_[np*face + phase] = gravcontrib[0][phase] - gravcontrib[1][phase];
-                pot[0][phase] = c_press[0] + face_gravcap_[np*face + phase];
-                pot[1][phase] = c_press[1];
-            }
-
-            // Now we can easily find the upwind direction for every phase,
-            // we can also tell which boundary faces are inflow bdys.
-
+            //
+            // Once the gravity contribution of a phase is known, we can
+            // easily find its upwind direction, and we can also tell
+            // which boundary faces are inflow bdys.
+            //
             // Get upwind mobilities by phase.
             // Get upwind A matrix rows by phase.
             // NOTE:
@@ -428,9 +581,22 @@ namespace Opm
             // This prompts the question if we should split the matrix()
             // property method into formation volume and R-factor methods.
             for (int phase = 0; phase < np; ++phase) {
+                double gravcap = 0.0;
+                if (grav != 0.0) {
+                    for (int j = 0; j < 2; ++j) {
+                        if (c[j] >= 0) {
+                            const double gravcontrib = cell_rho_[np*c[j] + phase]*c_gdz[j];
+                            gravcap += (j == 0) ? gravcontrib : -gravcontrib;
+                        }
+                    }
+                }
+                face_gravcap_[np*face + phase] = gravcap;
+
                 int upwindc = -1;
                 if (c[0] >=0 && c[1] >= 0) {
-                    upwindc = (pot[0][phase] < pot[1][phase]) ? c[1] : c[0];
+                    const double pot0 = c_press[0] + gravcap;
+                    const double pot1 = c_press[1];
+                    upwindc = (pot0 < pot1) ? c[1] : c[0];
                 } else {
                     upwindc = (c[0] >= 0) ? c[0] : c[1];
                 }
@@ -508,6 +674,7 @@ namespace Opm
                                     const BlackoilState& state,
                                     const WellState& well_state)
     {
+        OPM_TIMED_SCOPE("assembly");
         const double* cell_press = &state.pressure()[0];
         const double* well_bhp = well_state.bhp().empty() ? NULL : &well_state.bhp()[0];
         const double* z = &state.surfacevol()[0];
@@ -551,7 +718,11 @@ namespace Opm
     /// Computes pressure_increment_.
     void CompressibleTpfa::solveIncrement()
     {
-        // Increment is equal to -J^{-1}F
+        OPM_TIMED_SCOPE("linear solve");
+        // Increment is equal to -J^{-1}F, so the incoming guess for
+        // the increment is negated to give an initial guess for J^{-1}F.
+        std::transform(pressure_increment_.begin(), pressure_increment_.end(),
+                       pressure_increment_.begin(), std::negate<double>());
         linsolver_.solve(h_->J, h_->F, &pressure_increment_[0]);
         std::transform(pressure_increment_.begin(), pressure_increment_.end(),
                        pressure_increment_.begin(), std::negate<double>());
@@ -36,6 +36,8 @@ namespace Opm
     class RockCompressibility;
     class LinearSolverInterface;
     class WellState;
+    class NewtonIterationMonitorInterface;
+    class MemoryReport;
 
     /// Encapsulating a tpfa pressure solver for the compressible-fluid case.
     /// Supports gravity, wells and simple sources as driving forces.
@@ -48,7 +50,9 @@ namespace Opm
         /// \param[in] grid             A 2d or 3d grid.
         /// \param[in] props            Rock and fluid properties.
         /// \param[in] rock_comp_props  Rock compressibility properties. May be null.
-        /// \param[in] linsolver        Linear solver to use.
+        /// \param[in] linsolver        Linear solver to use.  Its tolerance is
+        ///                             temporarily modified by solve() if
+        ///                             forcing terms are enabled.
         /// \param[in] residual_tol     Solution accepted if inf-norm of residual is smaller.
         /// \param[in] change_tol       Solution accepted if inf-norm of change in pressure is smaller.
         /// \param[in] maxiter          Maximum acceptable number of iterations.
@@ -64,7 +68,7 @@ namespace Opm
         CompressibleTpfa(const UnstructuredGrid& grid,
                          const BlackoilPropertiesInterface& props,
                          const RockCompressibility* rock_comp_props,
-                         const LinearSolverInterface& linsolver,
+                         LinearSolverInterface& linsolver,
                          const double residual_tol,
                          const double change_tol,
                          const int maxiter,
@@ -89,6 +93,46 @@ namespace Opm
         /// are significant.)
         bool singularPressure() const;
 
+        /// Inform the solver that the well topology has changed
+        /// (e.g., wells or completions opened, shut, added or
+        /// removed).  Updates only the well-related parts of the
+        /// internal linear system structure instead of
+        /// reconstructing the solver.
+        /// \param[in] wells   The new wells. May be NULL.
+        void updateWells(const Wells* wells);
+
+        /// Control the accuracy of the linear solves in the Newton
+        /// iterations of solve().  By default, every increment is
+        /// solved to the tolerance of the linear solver, starting
+        /// from a zero initial guess.
+        /// \param[in] forcing_term  If true, solve each increment only to
+        ///                          the relative tolerance given by the
+        ///                          Eisenstat-Walker forcing term (choice 2),
+        ///                          which tightens as the residual norm
+        ///                          drops.  The tolerance of the linear
+        ///                          solver is used as a lower bound.
+        /// \param[in] warm_start    If true, use the previous increment,
+        ///                          scaled by the residual reduction it
+        ///                          achieved, as initial guess.  Only of use
+        ///                          with linear solvers that accept one.
+        /// \param[in] max_forcing   Upper bound, and initial value, of the
+        ///                          forcing term.
+        void setInexactNewton(const bool forcing_term,
+                              const bool warm_start,
+                              const double max_forcing = 0.5);
+
+        /// Report the residual norm of every Newton iteration of solve()
+        /// to a monitor, which may make solve() give up early by
+        /// throwing as for too many iterations.
+        /// \param[in] monitor  The monitor, observed by this class. May be NULL.
+        void setIterationMonitor(NewtonIterationMonitorInterface* monitor);
+
+        /// Add the bytes of the residual system (Jacobian and
+        /// assembly arrays) and of the per-cell, per-face and
+        /// per-perforation work arrays to the child "pressure" of the
+        /// report.
+        void reportMemory(MemoryReport& report) const;
+
     private:
         virtual void computePerSolveDynamicData(const double dt,
                                                 const BlackoilState& state,
@@ -120,7 +164,7 @@ namespace Opm
         const UnstructuredGrid& grid_;
         const BlackoilPropertiesInterface& props_;
         const RockCompressibility* rock_comp_props_;
-        const LinearSolverInterface& linsolver_;
+        LinearSolverInterface& linsolver_;
         const double residual_tol_;
         const double change_tol_;
         const int maxiter_;
@@ -129,6 +173,11 @@ namespace Opm
         std::vector<double> htrans_;
         std::vector<double> trans_ ;
         std::vector<int> allcells_;
+        std::vector<double> static_porevol_; // Pore volume at reference pressure.
+        bool forcing_term_;
+        bool warm_start_;
+        double max_forcing_;
+        NewtonIterationMonitorInterface* iteration_monitor_; // May be NULL
 
         // ------ Internal data for the cfs_tpfa_res solver. ------
         struct cfs_tpfa_res_data* h_;
@@ -143,6 +192,7 @@ namespace Opm
         std::vector<double> cell_viscosity_;
         std::vector<double> cell_phasemob_;
         std::vector<double> cell_voldisc_;
+        std::vector<double> cell_rho_;  // Only used with gravity.
         std::vector<double> face_A_;
         std::vector<double> face_phasemob_;
         std::vector<double> face_gravcap_;
@@ -22,6 +22,8 @@
 #include <opm/core/pressure/FlowBCManager.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/core/grid.h>
+#include <opm/core/utility/ThreadControl.hpp>
+#include <algorithm>
 #include <vector>
 
 namespace Opm
@@ -39,8 +41,10 @@ namespace Opm
     /// Default constructor sets up empty boundary conditions.
     /// By convention, this is equivalent to all-noflow conditions.
     FlowBCManager::FlowBCManager()
-	: bc_(0)
+	: bc_(0),
+	  side_grid_(0)
     {
+	std::fill(side_cached_, side_cached_ + 6, false);
 	bc_ = flow_conditions_construct(0);
 	if (!bc_) {
 	    OPM_THROW(std::runtime_error, "Failed to construct FlowBoundaryConditions struct.");
@@ -63,6 +67,18 @@ namespace Opm
     }
 
 
+    /// Make room for a total of num_conditions boundary conditions that
+    /// affect a total of num_faces faces, without further allocation.
+    void FlowBCManager::reserve(const std::size_t num_conditions,
+				const std::size_t num_faces)
+    {
+	int ok = flow_conditions_reserve(num_conditions, num_faces, bc_);
+	if (!ok) {
+	    OPM_THROW(std::runtime_error, "Failed to reserve space for " << num_conditions << " boundary conditions.");
+	}
+    }
+
+
     /// Append a single boundary condition.
     /// If the type is BC_NOFLOW the value argument is not used.
     /// If the type is BC_PRESSURE the value argument is a pressure value.
@@ -94,9 +110,8 @@ namespace Opm
 				     const Side side,
 				     const double pressure)
     {
-	std::vector<int> faces;
-	findSideFaces(grid, side, faces);
-	int ok = flow_conditions_append_multi(BC_PRESSURE, faces.size(), &faces[0], pressure, bc_);
+	const std::vector<int>& faces = sideFaces(grid, side);
+	int ok = flow_conditions_append_multi(BC_PRESSURE, faces.size(), faces.data(), pressure, bc_);
 	if (!ok) {
 	    OPM_THROW(std::runtime_error, "Failed to append pressure boundary conditions for side " << sideString(side));
 	}
@@ -118,8 +133,7 @@ namespace Opm
 				 const double flux)
     {
 	// Find side faces.
-	std::vector<int> faces;
-	findSideFaces(grid, side, faces);
+	const std::vector<int>& faces = sideFaces(grid, side);
 
 	// Compute total area of faces.
 	double tot_area = 0.0;
@@ -127,14 +141,38 @@ namespace Opm
 	    tot_area += grid.face_areas[faces[fi]];
 	}
 
-	// Append flux conditions for all the faces individually.
+	// Append flux conditions for all the faces individually, in
+	// a single operation.
+	std::vector<double> face_flux(faces.size());
 	for (int fi = 0; fi < int(faces.size()); ++fi) {
-	    const double face_flux = flux * grid.face_areas[faces[fi]] / tot_area;
-	    int ok = flow_conditions_append(BC_FLUX_TOTVOL, faces[fi], face_flux, bc_);
-	    if (!ok) {
-		OPM_THROW(std::runtime_error, "Failed to append flux boundary conditions for face " << faces[fi] << " on side " << sideString(side));
+	    face_flux[fi] = flux * grid.face_areas[faces[fi]] / tot_area;
+	}
+	int ok = flow_conditions_append_faces(BC_FLUX_TOTVOL, faces.size(), faces.data(),
+					      face_flux.data(), bc_);
+	if (!ok) {
+	    OPM_THROW(std::runtime_error, "Failed to append flux boundary conditions for side " << sideString(side));
+	}
+    }
+
+
+
+    /// The faces on a given side, as used by pressureSide() and
+    /// fluxSide(), cached per grid object.
+    const std::vector<int>& FlowBCManager::sideFaces(const UnstructuredGrid& grid,
+						     const Side side)
+    {
+	if (side_grid_ != &grid) {
+	    for (int s = 0; s < 6; ++s) {
+		side_faces_[s].clear();
+		side_cached_[s] = false;
 	    }
+	    side_grid_ = &grid;
+	}
+	if (!side_cached_[side]) {
+	    findSideFaces(grid, side, side_faces_[side]);
+	    side_cached_[side] = true;
 	}
+	return side_faces_[side];
     }
 
 
@@ -210,27 +248,44 @@ namespace Opm
             assert(side < 2 * grid.dimensions);
 
 	    // Get all boundary faces with the correct tag and with
-	    // min/max i/j/k (depending on side).
+	    // min/max i/j/k (depending on side).  Each chunk of cells
+	    // collects its own faces, which are then concatenated in
+	    // chunk order.
 	    const int correct_ijk = (side % 2) ? grid.cartdims[side/2] - 1 : 0;
-	    for (int c = 0; c < grid.number_of_cells; ++c) {
-		int ijk[3] = { -1, -1, -1 };
-                int gc = (grid.global_cell != 0) ? grid.global_cell[c] : c;
-		cartCoord(grid.dimensions, gc, grid.cartdims, ijk);
-		if (ijk[side/2] != correct_ijk) {
-		    continue;
-		}
-		for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
-		    if (grid.cell_facetag[hf] == side) {
-			// Tag is correct.
-			const int f = grid.cell_faces[hf];
-			if (grid.face_cells[2*f] == -1 || grid.face_cells[2*f + 1] == -1) {
-			    // Face is on boundary.
-			    faces.push_back(f);
-			} else {
-			    OPM_THROW(std::runtime_error, "Face not on boundary, even with correct tag and boundary cell. This should not occur.");
+	    const int grain = 16384;
+	    const int num_chunks = (grid.number_of_cells + grain - 1) / grain;
+	    std::vector< std::vector<int> > chunk_faces(num_chunks);
+	    threads::parallelFor(0, grid.number_of_cells, grain, [&](const int begin, const int end) {
+		std::vector<int>& cf = chunk_faces[begin / grain];
+		for (int c = begin; c < end; ++c) {
+		    int ijk[3] = { -1, -1, -1 };
+		    int gc = (grid.global_cell != 0) ? grid.global_cell[c] : c;
+		    cartCoord(grid.dimensions, gc, grid.cartdims, ijk);
+		    if (ijk[side/2] != correct_ijk) {
+			continue;
+		    }
+		    for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+			if (grid.cell_facetag[hf] == side) {
+			    // Tag is correct.
+			    const int f = grid.cell_faces[hf];
+			    if (grid.face_cells[2*f] == -1 || grid.face_cells[2*f + 1] == -1) {
+				// Face is on boundary.
+				cf.push_back(f);
+			    } else {
+				OPM_THROW(std::runtime_error, "Face not on boundary, even with correct tag and boundary cell. This should not occur.");
+			    }
 			}
 		    }
 		}
+	    });
+
+	    std::size_t num_faces = faces.size();
+	    for (int k = 0; k < num_chunks; ++k) {
+		num_faces += chunk_faces[k].size();
+	    }
+	    faces.reserve(num_faces);
+	    for (int k = 0; k < num_chunks; ++k) {
+		faces.insert(faces.end(), chunk_faces[k].begin(), chunk_faces[k].end());
 	    }
 	}
 
@@ -22,6 +22,9 @@
 
 #include <opm/core/pressure/flow_bc.h>
 
+#include <cstddef>
+#include <vector>
+
 struct UnstructuredGrid;
 
 namespace Opm
@@ -43,8 +46,14 @@ namespace Opm
 
 	/// Remove all appended BCs.
 	/// By convention, BCs are now equivalent to all-noflow conditions.
+	/// Cached side faces (see sideFaces()) are kept.
 	void clear();
 
+	/// Make room for a total of num_conditions boundary conditions that
+	/// affect a total of num_faces faces, without further allocation.
+	void reserve(const std::size_t num_conditions,
+		     const std::size_t num_faces);
+
 	/// Append a single boundary condition.
 	/// If the type is BC_NOFLOW the value argument is not used.
 	/// If the type is BC_PRESSURE the value argument is a pressure value.
@@ -86,6 +95,15 @@ namespace Opm
 		      const Side side,
 		      const double flux);
 
+	/// The faces on a given side, as used by pressureSide() and
+	/// fluxSide(), in increasing order of their cells.
+	/// The faces of each side are found once, by a parallel scan of
+	/// the cells, and cached for later calls with the same grid
+	/// object.  Calling with a different grid object drops the
+	/// cache.  The grid must not change while it is cached.
+	const std::vector<int>& sideFaces(const UnstructuredGrid& grid,
+					  const Side side);
+
 	/// Access the managed boundary conditions.
 	/// The method is named similarly to c_str() in std::string,
 	/// to make it clear that we are returning a C-compatible struct.
@@ -97,6 +115,10 @@ namespace Opm
 	FlowBCManager& operator=(const FlowBCManager& other);
 	// The managed struct.
 	FlowBoundaryConditions* bc_;
+	// Cached faces of each side of side_grid_.
+	const UnstructuredGrid* side_grid_;
+	std::vector<int> side_faces_[6];
+	bool side_cached_[6];
     };
 
 } // namespace Opm
@@ -0,0 +1,259 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/pressure/IncompMsmfem.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/msmfem/ifsh_ms.h>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/common/ErrorMacros.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+namespace Opm
+{
+
+    namespace
+    {
+        double dot(const std::vector<double>& a, const std::vector<double>& b)
+        {
+            double s = 0.0;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                s += a[i]*b[i];
+            }
+            return s;
+        }
+
+        void matvec(const CSRMatrix& A, const std::vector<double>& x, std::vector<double>& y)
+        {
+            for (std::size_t i = 0; i < A.m; ++i) {
+                double s = 0.0;
+                for (int k = A.ia[i]; k < A.ia[i + 1]; ++k) {
+                    s += A.sa[k]*x[A.ja[k]];
+                }
+                y[i] = s;
+            }
+        }
+
+        // One Gauss-Seidel sweep on A z = r, forward or backward.
+        void gaussSeidel(const CSRMatrix& A, const std::vector<double>& r, const bool forward,
+                         std::vector<double>& z)
+        {
+            const int n = A.m;
+            for (int j = 0; j < n; ++j) {
+                const int i = forward ? j : n - 1 - j;
+                double s = r[i];
+                double diag = 0.0;
+                for (int k = A.ia[i]; k < A.ia[i + 1]; ++k) {
+                    if (A.ja[k] == i) {
+                        diag = A.sa[k];
+                    } else {
+                        s -= A.sa[k]*z[A.ja[k]];
+                    }
+                }
+                z[i] = s / diag;
+            }
+        }
+    } // anonymous namespace
+
+
+
+    /// Construct solver and compute the basis functions.
+    IncompMsmfem::IncompMsmfem(const UnstructuredGrid& grid,
+                               const std::vector<int>& partition,
+                               const double* permeability,
+                               const double* src,
+                               const double* totmob,
+                               LocalSolver local_solver,
+                               const LinearSolverInterface& linsolver)
+        : grid_(grid),
+          local_solver_(local_solver),
+          linsolver_(linsolver),
+          perm_(permeability, permeability + grid.dimensions*grid.dimensions*grid.number_of_cells),
+          htrans_(grid.cell_facepos[grid.number_of_cells]),
+          trans_(grid.number_of_faces),
+          cflux_(grid.number_of_faces),
+          ms_(0),
+          tpfa_(0)
+    {
+        if (int(partition.size()) != grid.number_of_cells) {
+            OPM_THROW(std::runtime_error, "IncompMsmfem: partition has " << partition.size()
+                      << " entries, the grid " << grid.number_of_cells << " cells.");
+        }
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        ms_ = ifsh_ms_construct(gg, &partition[0], &perm_[0], src, totmob, local_solver_);
+        if (ms_ == 0) {
+            OPM_THROW(std::runtime_error, "IncompMsmfem: failed to construct multiscale system.");
+        }
+        tpfa_ = ifs_tpfa_construct(gg, 0);
+        if (tpfa_ == 0) {
+            ifsh_ms_destroy(ms_);
+            OPM_THROW(std::runtime_error, "IncompMsmfem: failed to construct fine-scale system.");
+        }
+        tpfa_htrans_compute(gg, &perm_[0], &htrans_[0]);
+    }
+
+
+
+    /// Destructor.
+    IncompMsmfem::~IncompMsmfem()
+    {
+        ifs_tpfa_destroy(tpfa_);
+        ifsh_ms_destroy(ms_);
+    }
+
+
+
+    /// Recompute basis functions with large total mobility changes.
+    int IncompMsmfem::updateBasis(const double* src,
+                                  const double* totmob,
+                                  const double tol,
+                                  std::vector<double>& mobref)
+    {
+        assert(int(mobref.size()) == grid_.number_of_cells);
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        const int n = ifsh_ms_update_basis(gg, &perm_[0], src, totmob, tol, &mobref[0],
+                                           1, local_solver_, ms_);
+        if (n < 0) {
+            OPM_THROW(std::runtime_error, "IncompMsmfem: failed to update basis functions.");
+        }
+        return n;
+    }
+
+
+
+    /// Solve the coarse system and reconstruct fine-scale quantities.
+    LinearSolverInterface::LinearSolverReport
+    IncompMsmfem::solve(const double* src,
+                        const double* totmob,
+                        std::vector<double>& pressure,
+                        std::vector<double>& faceflux) const
+    {
+        pressure.resize(grid_.number_of_cells);
+        faceflux.resize(grid_.number_of_faces);
+
+        ifsh_ms_assemble(src, totmob, ms_);
+        const CSRMatrix* A = ms_->A;
+        std::fill(ms_->x, ms_->x + A->m, 0.0);
+        const LinearSolverInterface::LinearSolverReport rep =
+            linsolver_.solve(A->m, A->nnz, A->ia, A->ja, A->sa, ms_->b, ms_->x);
+
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        ifsh_ms_press_flux(gg, ms_, &pressure[0], &faceflux[0]);
+        return rep;
+    }
+
+
+
+    /// Coarse correction followed by smoothing, z = M^{-1} r.
+    void IncompMsmfem::precondition(const double* totmob, const int smooth_steps,
+                                    const std::vector<double>& r,
+                                    std::vector<double>& z) const
+    {
+        // The residual acts as source term of the coarse problem.
+        solve(&r[0], totmob, z, cflux_);
+        const CSRMatrix& A = *tpfa_->A;
+        for (int s = 0; s < smooth_steps; ++s) {
+            gaussSeidel(A, r, true, z);
+            gaussSeidel(A, r, false, z);
+        }
+    }
+
+
+
+    /// Solve the fine-scale system, preconditioned by the multiscale solve.
+    LinearSolverInterface::LinearSolverReport
+    IncompMsmfem::solveIterative(const double* src,
+                                 const double* totmob,
+                                 const double tolerance,
+                                 const int max_iterations,
+                                 const int smooth_steps,
+                                 std::vector<double>& pressure,
+                                 std::vector<double>& faceflux) const
+    {
+        const int nc = grid_.number_of_cells;
+        pressure.resize(nc);
+        faceflux.resize(grid_.number_of_faces);
+
+        // Fine-scale two-point system.
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        tpfa_eff_trans_compute(gg, totmob, &htrans_[0], &trans_[0]);
+        const std::vector<double> gpress(grid_.cell_facepos[nc], 0.0);
+        ifs_tpfa_forces forces = { src, 0, 0, totmob, 0 };
+        if (!ifs_tpfa_assemble(gg, &forces, &trans_[0], &gpress[0], tpfa_)) {
+            OPM_THROW(std::runtime_error, "IncompMsmfem: failed assembling fine-scale system.");
+        }
+        const CSRMatrix& A = *tpfa_->A;
+
+        // Right preconditioned BiCGStab from a zero initial guess.
+        std::vector<double> x(nc, 0.0);
+        std::vector<double> r(tpfa_->b, tpfa_->b + nc);
+        const std::vector<double> r0(r);
+        std::vector<double> p(nc, 0.0), v(nc, 0.0), ph(nc), s(nc), sh(nc), t(nc);
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+        const double bnorm = std::sqrt(dot(r, r));
+        double rnorm = bnorm;
+
+        LinearSolverInterface::LinearSolverReport rep = { bnorm == 0.0, 0, 1.0, false };
+        while (!rep.converged && rep.iterations < max_iterations) {
+            const double rho_new = dot(r0, r);
+            if (rho_new == 0.0) {
+                break;
+            }
+            const double beta = (rho_new / rho) * (alpha / omega);
+            rho = rho_new;
+            for (int i = 0; i < nc; ++i) {
+                p[i] = r[i] + beta*(p[i] - omega*v[i]);
+            }
+            precondition(totmob, smooth_steps, p, ph);
+            matvec(A, ph, v);
+            alpha = rho / dot(r0, v);
+            for (int i = 0; i < nc; ++i) {
+                s[i] = r[i] - alpha*v[i];
+            }
+            precondition(totmob, smooth_steps, s, sh);
+            matvec(A, sh, t);
+            const double tt = dot(t, t);
+            omega = (tt > 0.0) ? dot(t, s) / tt : 0.0;
+            for (int i = 0; i < nc; ++i) {
+                x[i] += alpha*ph[i] + omega*sh[i];
+                r[i] = s[i] - omega*t[i];
+            }
+            ++rep.iterations;
+            rnorm = std::sqrt(dot(r, r));
+            rep.converged = rnorm <= tolerance*bnorm;
+            if (omega == 0.0) {
+                break;
+            }
+        }
+        rep.residual_reduction = (bnorm > 0.0) ? rnorm / bnorm : 0.0;
+
+        // Fine-scale fluxes from the pressure.
+        std::copy(x.begin(), x.end(), tpfa_->x);
+        ifs_tpfa_solution soln = { &pressure[0], &faceflux[0], 0, 0 };
+        ifs_tpfa_press_flux(gg, &forces, &trans_[0], tpfa_, &soln);
+        return rep;
+    }
+
+} // namespace Opm
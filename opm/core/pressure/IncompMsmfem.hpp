@@ -0,0 +1,143 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_INCOMPMSMFEM_HEADER_INCLUDED
+#define OPM_INCOMPMSMFEM_HEADER_INCLUDED
+
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/pressure/msmfem/coarse_sys.h>
+#include <vector>
+
+struct UnstructuredGrid;
+struct ifsh_ms_data;
+struct ifs_tpfa_data;
+
+namespace Opm
+{
+
+    /// Incompressible multiscale mixed finite-element (MsMFE) pressure
+    /// solver on a coarse partition of the grid, wrapping ifsh_ms.
+    ///
+    /// The coarse system assembled from the coarse_sys basis functions
+    /// is solved by a LinearSolverInterface, such as LinearSolverIstl
+    /// with an AMG solver type.  solve() gives the multiscale
+    /// approximation, with block-wise constant pressure.
+    /// solveIterative() instead solves the fine-scale two-point system
+    /// by BiCGStab, preconditioned by the multiscale solve as a coarse
+    /// correction followed by symmetric Gauss-Seidel smoothing, so no
+    /// fine-scale direct solve is needed for fine-scale accuracy.
+    ///
+    /// No wells, boundary conditions (no-flow everywhere) or gravity.
+    class IncompMsmfem
+    {
+    public:
+        /// Construct solver and compute the basis functions.
+        /// \param[in] grid          A 2d or 3d grid.
+        /// \param[in] partition     Coarse block of each cell, e.g. from
+        ///                          partition_unif_idx().  The blocks must
+        ///                          be connected.
+        /// \param[in] permeability  Permeability tensors, d*d per cell.
+        /// \param[in] src           Source terms (volume rates) per cell,
+        ///                          used to weight the basis functions.
+        /// \param[in] totmob        Total mobility per cell.
+        /// \param[in] local_solver  Solver of the local flow problems
+        ///                          defining the basis functions.  Must be
+        ///                          reentrant, see coarse_sys.h.
+        /// \param[in] linsolver     Solver of the coarse system.
+        IncompMsmfem(const UnstructuredGrid& grid,
+                     const std::vector<int>& partition,
+                     const double* permeability,
+                     const double* src,
+                     const double* totmob,
+                     LocalSolver local_solver,
+                     const LinearSolverInterface& linsolver);
+
+        /// Destructor.
+        ~IncompMsmfem();
+
+        IncompMsmfem(const IncompMsmfem&) = delete;
+        IncompMsmfem& operator=(const IncompMsmfem&) = delete;
+
+        /// Recompute the basis functions whose support has seen a
+        /// relative total mobility change larger than tol since mobref,
+        /// see coarse_sys_update_basis().  Local problems are solved
+        /// concurrently in OpenMP builds.
+        /// \return The number of recomputed basis functions.
+        int updateBasis(const double* src,
+                        const double* totmob,
+                        const double tol,
+                        std::vector<double>& mobref);
+
+        /// Solve the coarse system and reconstruct the fine-scale
+        /// pressure (constant in each block) and fluxes.
+        /// \param[in]  src        Source terms, should sum to zero.
+        /// \param[in]  totmob     Total mobility per cell, as used for
+        ///                        the basis functions.
+        /// \param[out] pressure   Cell pressures.
+        /// \param[out] faceflux   Face fluxes.
+        /// \return The report of the coarse linear solve.
+        LinearSolverInterface::LinearSolverReport
+        solve(const double* src,
+              const double* totmob,
+              std::vector<double>& pressure,
+              std::vector<double>& faceflux) const;
+
+        /// Solve the fine-scale two-point system iteratively, with the
+        /// multiscale solve as preconditioner.  Each iteration makes
+        /// two coarse solves, so a linear solver reusing its setup
+        /// (linsolver_reuse_setup) pays off.
+        /// \param[in]  src             Source terms, should sum to zero.
+        /// \param[in]  totmob          Total mobility per cell.
+        /// \param[in]  tolerance       Relative residual reduction.
+        /// \param[in]  max_iterations  Maximum number of BiCGStab iterations.
+        /// \param[in]  smooth_steps    Symmetric Gauss-Seidel sweeps per
+        ///                             preconditioner application.
+        /// \param[out] pressure        Cell pressures.
+        /// \param[out] faceflux        Face fluxes.
+        /// \return The report of the fine-scale iteration.
+        LinearSolverInterface::LinearSolverReport
+        solveIterative(const double* src,
+                       const double* totmob,
+                       const double tolerance,
+                       const int max_iterations,
+                       const int smooth_steps,
+                       std::vector<double>& pressure,
+                       std::vector<double>& faceflux) const;
+
+    private:
+        // Coarse correction followed by smoothing, z = M^{-1} r.
+        void precondition(const double* totmob, const int smooth_steps,
+                          const std::vector<double>& r,
+                          std::vector<double>& z) const;
+
+        const UnstructuredGrid& grid_;
+        LocalSolver local_solver_;
+        const LinearSolverInterface& linsolver_;
+        std::vector<double> perm_;
+        std::vector<double> htrans_;
+        mutable std::vector<double> trans_;
+        mutable std::vector<double> cflux_;
+        ifsh_ms_data* ms_;
+        ifs_tpfa_data* tpfa_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_INCOMPMSMFEM_HEADER_INCLUDED
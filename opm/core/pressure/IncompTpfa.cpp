@@ -29,10 +29,13 @@
 #include <opm/core/pressure/mimetic/mimetic.h>
 #include <opm/core/pressure/flow_bc.h>
 #include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/linalg/ParallelIstlInformation.hpp>
 #include <opm/core/linalg/sparse_sys.h>
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 #include <opm/core/wells.h>
 #include <iostream>
 #include <iomanip>
@@ -77,8 +80,11 @@ namespace Opm
           wells_(wells),
           src_(src),
           bcs_(bcs),
-          htrans_(grid.cell_facepos[ grid.number_of_cells ]),
+          static_(std::make_shared<IncompTpfaStaticData>(grid, props.permeability(), gravity)),
+          htrans_(static_->halfTrans()),
+          gpress_(static_->gravityPotential()),
           allcells_(grid.number_of_cells),
+          porevol_update_tol_(0.0),
           trans_ (grid.number_of_faces)
     {
         computeStaticData();
@@ -128,8 +134,11 @@ namespace Opm
           wells_(wells),
           src_(src),
           bcs_(bcs),
-          htrans_(grid.cell_facepos[ grid.number_of_cells ]),
+          static_(std::make_shared<IncompTpfaStaticData>(grid, props.permeability(), gravity)),
+          htrans_(static_->halfTrans()),
+          gpress_(static_->gravityPotential()),
           allcells_(grid.number_of_cells),
+          porevol_update_tol_(0.0),
           trans_ (grid.number_of_faces)
     {
         computeStaticData();
@@ -139,6 +148,56 @@ namespace Opm
 
 
 
+    /// Construct solver from precomputed static data, possibly with
+    /// rock compressibility.
+    /// \param[in] static_data      Grid-dependent data, may be shared with
+    ///                             other solvers. Must have been computed
+    ///                             from the permeability of props.
+    /// \param[in] props            Rock and fluid properties.
+    /// \param[in] rock_comp_props  Rock compressibility properties. May be null.
+    /// \param[in] linsolver        Linear solver to use.
+    /// \param[in] residual_tol     Solution accepted if inf-norm of residual is smaller.
+    /// \param[in] change_tol       Solution accepted if inf-norm of change in pressure is smaller.
+    /// \param[in] maxiter          Maximum acceptable number of iterations.
+    /// \param[in] wells            The wells argument. Will be used in solution,
+    ///                             is ignored if NULL.
+    /// \param[in] src              Source terms. May be empty().
+    /// \param[in] bcs              Boundary conditions, treat as all noflow if null.
+    IncompTpfa::IncompTpfa(std::shared_ptr<const IncompTpfaStaticData> static_data,
+                           const IncompPropertiesInterface& props,
+                           const RockCompressibility* rock_comp_props,
+                           LinearSolverInterface& linsolver,
+                           const double residual_tol,
+                           const double change_tol,
+                           const int maxiter,
+                           const Wells* wells,
+                           const std::vector<double>& src,
+                           const FlowBoundaryConditions* bcs)
+        : grid_(static_data->grid()),
+          props_(props),
+          rock_comp_props_(rock_comp_props),
+          linsolver_(linsolver),
+          residual_tol_(residual_tol),
+          change_tol_(change_tol),
+          maxiter_(maxiter),
+          gravity_(static_data->gravity()),
+          wells_(wells),
+          src_(src),
+          bcs_(bcs),
+          static_(static_data),
+          htrans_(static_->halfTrans()),
+          gpress_(static_->gravityPotential()),
+          allcells_(grid_.number_of_cells),
+          porevol_update_tol_(0.0),
+          trans_ (grid_.number_of_faces)
+    {
+        computeStaticData();
+    }
+
+
+
+
+
     /// Destructor.
     IncompTpfa::~IncompTpfa()
     {
@@ -182,9 +241,10 @@ namespace Opm
         if (!ok) {
             OPM_THROW(std::runtime_error, "Failed assembling pressure system.");
         }
+        eliminateOverlapRows();
 
         // Solve.
-        linsolver_.solve(h_->A, h_->b, h_->x);
+        linearSolve();
 
         // Obtain solution.
         assert(int(state.pressure().size()) == grid_.number_of_cells);
@@ -199,6 +259,7 @@ namespace Opm
             soln.well_press = &well_state.bhp()[0];
         }
         ifs_tpfa_press_flux(gg, &forces_, &trans_[0], h_, &soln);
+        zeroOverlapFluxes(state);
     }
 
 
@@ -284,7 +345,8 @@ namespace Opm
 
 
 
-    /// Compute data that never changes (after construction).
+    /// Compute data that never changes (after construction), except
+    /// for the grid-dependent data held in static_.
     void IncompTpfa::computeStaticData()
     {
         if (wells_ && (wells_->number_of_phases != props_.numPhases())) {
@@ -294,25 +356,23 @@ namespace Opm
         const int num_dofs = grid_.number_of_cells + (wells_ ? wells_->number_of_wells : 0);
         pressures_.resize(num_dofs);
         UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
-        tpfa_htrans_compute(gg, props_.permeability(), &htrans_[0]);
-        if (gravity_) {
-            gpress_.resize(gg->cell_facepos[ gg->number_of_cells ], 0.0);
-
-            mim_ip_compute_gpress(gg->number_of_cells, gg->dimensions, gravity_,
-                                  gg->cell_facepos, gg->cell_faces,
-                                  gg->face_centroids, gg->cell_centroids,
-                                  &gpress_[0]);
-        }
         // gpress_omegaweighted_ is sent to assembler always, and it dislikes
         // getting a zero pointer.
         gpress_omegaweighted_.resize(gg->cell_facepos[ gg->number_of_cells ], 0.0);
         if (rock_comp_props_) {
             rock_comp_.resize(grid_.number_of_cells);
+            // Pore volumes at reference pressure, scaled by the rock
+            // compressibility multipliers in every solve and iteration.
+            computePorevolume(grid_, props_.porosity(), static_porevol_);
         }
         for (int c = 0; c < grid_.number_of_cells; ++c) {
             allcells_[c] = c;
         }
-        h_ = ifs_tpfa_construct(gg, const_cast<struct Wells*>(wells_));
+        h_ = ifs_tpfa_construct_with_pattern(gg, const_cast<struct Wells*>(wells_),
+                                             static_->cellPattern());
+        if (h_ == 0) {
+            OPM_THROW(std::runtime_error, "Failed to construct tpfa pressure system.");
+        }
     }
 
 
@@ -341,19 +401,50 @@ namespace Opm
                             gravity_ ? gravity_[2] : 0.0, true, wdp_);
         }
         // totmob_, omega_, gpress_omegaweighted_
+        const int nc = allcells_.size();
+        pmob_.resize(nc * props_.numPhases());
+        totmob_.resize(nc);
         if (gravity_) {
-            computeTotalMobilityOmega(props_, allcells_, state.saturation(), totmob_, omega_);
+            omega_.resize(nc);
+            computeTotalMobilityOmega(props_, nc, allcells_.data(), state.saturation().data(),
+                                      pmob_.data(), totmob_.data(), omega_.data());
+            exchangeOverlap(totmob_);
+            exchangeOverlap(omega_);
             mim_ip_density_update(grid_.number_of_cells, grid_.cell_facepos,
                                   &omega_[0],
                                   &gpress_[0], &gpress_omegaweighted_[0]);
         } else {
-            computeTotalMobility(props_, allcells_, state.saturation(), totmob_);
+            computeTotalMobility(props_, nc, allcells_.data(), state.saturation().data(),
+                                 pmob_.data(), totmob_.data());
+            exchangeOverlap(totmob_);
+        }
+        // trans_, trans_totmob_
+        // Only faces next to cells with changed mobility are recomputed.
+        const std::vector<int>& fhf = static_->faceHalfFaces();
+        if (static_->precision() == IncompTpfaStaticData::SinglePrecision) {
+            const std::vector<float>& htrans = static_->halfTransSingle();
+            if (trans_totmob_.empty()) {
+                tpfa_eff_trans_compute_faces_sp(&grid_, &fhf[0], &totmob_[0], &htrans[0], &trans_[0]);
+                trans_totmob_ = totmob_;
+            } else {
+                tpfa_eff_trans_update_sp(&grid_, &fhf[0], &totmob_[0], &htrans[0], 0.0,
+                                         &trans_totmob_[0], &trans_[0]);
+            }
+        } else if (trans_totmob_.empty()) {
+            tpfa_eff_trans_compute_faces(&grid_, &fhf[0], &totmob_[0], &htrans_[0], &trans_[0]);
+            trans_totmob_ = totmob_;
+        } else {
+            tpfa_eff_trans_update(&grid_, &fhf[0], &totmob_[0], &htrans_[0], 0.0,
+                                  &trans_totmob_[0], &trans_[0]);
         }
-        // trans_
-        tpfa_eff_trans_compute(const_cast<UnstructuredGrid*>(&grid_), &totmob_[0], &htrans_[0], &trans_[0]);
         // initial_porevol_
+        // Brings porevol_ and rock_comp_ up to date with the pressure
+        // at the start of the step, which the first iteration then
+        // finds unchanged.
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), initial_porevol_);
+            updatePorevolume(static_porevol_, *rock_comp_props_, state.pressure(),
+                             porevol_update_tol_, porevol_pressure_, porevol_, &rock_comp_);
+            initial_porevol_ = porevol_;
         }
         // forces_
         forces_.src = src_.empty() ? NULL : &src_[0];
@@ -379,12 +470,11 @@ namespace Opm
         // std::vector<double> rock_comp_
         // std::vector<double> pressures_
 
-        computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol_);
-        if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            for (int cell = 0; cell < grid_.number_of_cells; ++cell) {
-                rock_comp_[cell] = rock_comp_props_->rockComp(state.pressure()[cell]);
-            }
-        }
+        // Only cells whose pressure has moved by more than
+        // porevol_update_tol_ since their last evaluation are updated.
+        updatePorevolume(static_porevol_, *rock_comp_props_, state.pressure(),
+                         porevol_update_tol_, porevol_pressure_, porevol_,
+                         rock_comp_props_->isActive() ? &rock_comp_ : 0);
         if (wells_) {
             std::copy(state.pressure().begin(), state.pressure().end(), pressures_.begin());
             std::copy(well_state.bhp().begin(), well_state.bhp().end(), pressures_.begin() + grid_.number_of_cells);
@@ -400,6 +490,7 @@ namespace Opm
                               const SimulationDataContainer& state,
                               const WellState& /*well_state*/)
     {
+        OPM_TIMED_SCOPE("assembly");
         const double* pressures = wells_ ? &pressures_[0] : &state.pressure()[0];
 
         bool ok = ifs_tpfa_assemble_comprock_increment(const_cast<UnstructuredGrid*>(&grid_),
@@ -409,6 +500,7 @@ namespace Opm
         if (!ok) {
             OPM_THROW(std::runtime_error, "Failed assembling pressure system.");
         }
+        eliminateOverlapRows();
     }
 
 
@@ -419,9 +511,10 @@ namespace Opm
     /// Computes pressure increment, puts it in h_->x
     void IncompTpfa::solveIncrement()
     {
+        OPM_TIMED_SCOPE("linear solve");
         // Increment is equal to -J^{-1}R.
         // The Jacobian is in h_->A, residual in h_->b.
-        linsolver_.solve(h_->A, h_->b, h_->x);
+        linearSolve();
         // It is not necessary to negate the increment,
         // apparently the system for the increment is generated,
         // not the Jacobian and residual as such.
@@ -439,6 +532,32 @@ namespace Opm
             }
             return norm;
         }
+
+        // Inf-norm over the owned entries of a (possibly) distributed
+        // vector. Entries past the end of the owner mask are well
+        // unknowns and always local.
+        double globalInfnorm(const double* v, const std::size_t n,
+                             const std::vector<double>& owner_mask,
+                             const boost::any& parallel_information)
+        {
+            if (owner_mask.empty()) {
+                return infnorm(v, v + n);
+            }
+            double norm = 0.0;
+            for (std::size_t i = 0; i < owner_mask.size(); ++i) {
+                if (owner_mask[i] != 0.0) {
+                    norm = std::max(norm, std::fabs(v[i]));
+                }
+            }
+#if HAVE_MPI && HAVE_DUNE_ISTL
+            const ParallelISTLInformation& info =
+                boost::any_cast<const ParallelISTLInformation&>(parallel_information);
+            norm = info.communicator().max(norm);
+#else
+            static_cast<void>(parallel_information);
+#endif
+            return norm;
+        }
     } // anonymous namespace
 
 
@@ -447,7 +566,7 @@ namespace Opm
     /// Computes the inf-norm of the residual.
     double IncompTpfa::residualNorm() const
     {
-        return infnorm(h_->b, h_->b + h_->A->m);
+        return globalInfnorm(h_->b, h_->A->m, owner_mask_, parallel_information_);
     }
 
 
@@ -456,7 +575,7 @@ namespace Opm
     /// Computes the inf-norm of pressure_increment_.
     double IncompTpfa::incrementNorm() const
     {
-        return infnorm(h_->x, h_->x + h_->A->m);
+        return globalInfnorm(h_->x, h_->A->m, owner_mask_, parallel_information_);
     }
 
 
@@ -490,6 +609,161 @@ namespace Opm
             soln.well_press = &well_state.bhp()[0];
         }
         ifs_tpfa_press_flux(gg, &forces_, &trans_[0], h_, &soln); // TODO: Check what parts of h_ are used here.
+        zeroOverlapFluxes(state);
+    }
+
+
+
+
+    /// Pressure change below which pore volumes are not updated.
+    void IncompTpfa::setPorevolumeUpdateTolerance(const double tol)
+    {
+        porevol_update_tol_ = tol;
+    }
+
+
+
+
+    /// Solve the pressure equation on a domain decomposition.
+    void IncompTpfa::setParallelInformation(const boost::any& parallel_information)
+    {
+        parallel_information_ = boost::any();
+        owner_mask_.clear();
+        if (parallel_information.empty()) {
+            return;
+        }
+#if HAVE_MPI && HAVE_DUNE_ISTL
+        if (parallel_information.type() != typeid(ParallelISTLInformation)) {
+            OPM_THROW(std::logic_error, "IncompTpfa requires a ParallelISTLInformation for distributed solves.");
+        }
+        if (wells_ && wells_->number_of_wells > 0) {
+            OPM_THROW(std::logic_error, "IncompTpfa does not support wells in distributed solves.");
+        }
+        const ParallelISTLInformation& info =
+            boost::any_cast<const ParallelISTLInformation&>(parallel_information);
+        owner_mask_ = info.updateOwnerMask(allcells_);
+        parallel_information_ = parallel_information;
+#else
+        OPM_THROW(std::logic_error, "IncompTpfa: distributed solves require MPI and dune-istl.");
+#endif
+    }
+
+
+
+
+    void IncompTpfa::reportMemory(MemoryReport& report) const
+    {
+        MemoryReport& pressure = report.child("pressure");
+
+        std::size_t matrix = 0, assembly = 0;
+        ifs_tpfa_memory(h_, &matrix, &assembly);
+        pressure.add("matrix", matrix);
+        pressure.add("assembly", assembly);
+
+        std::size_t static_data = MemoryReport::bytes(static_->halfTrans())
+            + MemoryReport::bytes(static_->halfTransSingle())
+            + MemoryReport::bytes(static_->faceHalfFaces())
+            + MemoryReport::bytes(static_->gravityPotential());
+        if (static_->cellPattern() != 0) {
+            static_data += csrmatrix_memory(static_->cellPattern());
+        }
+        pressure.add("static data", static_data);
+
+        pressure.add("work arrays",
+                     MemoryReport::bytes(allcells_) + MemoryReport::bytes(static_porevol_)
+                     + MemoryReport::bytes(trans_) + MemoryReport::bytes(trans_totmob_)
+                     + MemoryReport::bytes(wdp_) + MemoryReport::bytes(totmob_)
+                     + MemoryReport::bytes(omega_) + MemoryReport::bytes(pmob_)
+                     + MemoryReport::bytes(gpress_omegaweighted_)
+                     + MemoryReport::bytes(initial_porevol_)
+                     + MemoryReport::bytes(porevol_) + MemoryReport::bytes(rock_comp_)
+                     + MemoryReport::bytes(porevol_pressure_) + MemoryReport::bytes(pressures_)
+                     + MemoryReport::bytes(owner_mask_));
+    }
+
+
+
+
+    /// Copy the values of owned cells to their overlap copies on
+    /// other processes.
+    void IncompTpfa::exchangeOverlap(std::vector<double>& v) const
+    {
+#if HAVE_MPI && HAVE_DUNE_ISTL
+        if (!parallel_information_.empty()) {
+            assert(int(v.size()) == grid_.number_of_cells);
+            const ParallelISTLInformation& info =
+                boost::any_cast<const ParallelISTLInformation&>(parallel_information_);
+            info.copyOwnerToAll(v, v);
+        }
+#else
+        static_cast<void>(v);
+#endif
+    }
+
+
+
+
+    /// Replace the equations of overlap cells by identity rows with
+    /// zero right hand side. The equations of these cells are
+    /// assembled by their owners, and the parallel linear solver
+    /// copies the solution of owned cells to their overlap copies.
+    void IncompTpfa::eliminateOverlapRows() const
+    {
+        if (owner_mask_.empty()) {
+            return;
+        }
+        const CSRMatrix* A = h_->A;
+        for (int c = 0; c < grid_.number_of_cells; ++c) {
+            if (owner_mask_[c] != 0.0) {
+                continue;
+            }
+            for (int i = A->ia[c]; i < A->ia[c + 1]; ++i) {
+                A->sa[i] = (A->ja[i] == c) ? 1.0 : 0.0;
+            }
+            h_->b[c] = 0.0;
+        }
+    }
+
+
+
+
+    /// Zero the fluxes of faces without an owned cell, which are
+    /// missing neighbours outside the local grid.
+    void IncompTpfa::zeroOverlapFluxes(SimulationDataContainer& state) const
+    {
+        if (owner_mask_.empty()) {
+            return;
+        }
+        std::vector<double>& flux = state.faceflux();
+        for (int f = 0; f < grid_.number_of_faces; ++f) {
+            const int c1 = grid_.face_cells[2*f];
+            const int c2 = grid_.face_cells[2*f + 1];
+            const bool owned = (c1 >= 0 && owner_mask_[c1] != 0.0)
+                || (c2 >= 0 && owner_mask_[c2] != 0.0);
+            if (!owned) {
+                flux[f] = 0.0;
+            }
+        }
+    }
+
+
+
+
+    /// Solve the linear system in h_, collectively if the domain is
+    /// decomposed. On output the solution is consistent on overlap
+    /// cells.
+    void IncompTpfa::linearSolve() const
+    {
+        const CSRMatrix* A = h_->A;
+        linsolver_.solve(A->m, A->nnz, A->ia, A->ja, A->sa, h_->b, h_->x,
+                         parallel_information_);
+#if HAVE_MPI && HAVE_DUNE_ISTL
+        if (!parallel_information_.empty()) {
+            std::vector<double> x(h_->x, h_->x + grid_.number_of_cells);
+            exchangeOverlap(x);
+            std::copy(x.begin(), x.end(), h_->x);
+        }
+#endif
     }
 
 
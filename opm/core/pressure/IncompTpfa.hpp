@@ -21,6 +21,9 @@
 #define OPM_INCOMPTPFA_HEADER_INCLUDED
 
 #include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/IncompTpfaStaticData.hpp>
+#include <boost/any.hpp>
+#include <memory>
 #include <vector>
 
 struct UnstructuredGrid;
@@ -35,6 +38,7 @@ namespace Opm
     class LinearSolverInterface;
     class WellState;
     class SimulationDataContainer;
+    class MemoryReport;
 
 
     /// Encapsulating a tpfa pressure solver for the incompressible-fluid case.
@@ -101,6 +105,37 @@ namespace Opm
 		   const std::vector<double>& src,
 		   const FlowBoundaryConditions* bcs);
 
+	/// Construct solver from precomputed static data, possibly with
+        /// rock compressibility.
+        /// \param[in] static_data      Grid-dependent data, may be shared with
+        ///                             other solvers. Must have been computed
+        ///                             from the permeability of props.
+        /// \param[in] props            Rock and fluid properties.
+        /// \param[in] rock_comp_props  Rock compressibility properties. May be null.
+        /// \param[in] linsolver        Linear solver to use.
+        /// \param[in] residual_tol     Solution accepted if inf-norm of residual is smaller.
+        /// \param[in] change_tol       Solution accepted if inf-norm of change in pressure is smaller.
+        /// \param[in] maxiter          Maximum acceptable number of iterations.
+        /// \param[in] wells            The wells argument. Will be used in solution,
+        ///                             is ignored if NULL.
+        ///                             Note: this class observes the well object, and
+        ///                                   makes the assumption that the well topology
+        ///                                   and completions does not change during the
+        ///                                   run. However, controls (only) are allowed
+        ///                                   to change.
+        /// \param[in] src              Source terms. May be empty().
+        /// \param[in] bcs              Boundary conditions, treat as all noflow if null.
+	IncompTpfa(std::shared_ptr<const IncompTpfaStaticData> static_data,
+                   const IncompPropertiesInterface& props,
+                   const RockCompressibility* rock_comp_props,
+                   LinearSolverInterface& linsolver,
+                   const double residual_tol,
+                   const double change_tol,
+                   const int maxiter,
+                   const Wells* wells,
+		   const std::vector<double>& src,
+		   const FlowBoundaryConditions* bcs);
+
 	/// Destructor.
 	virtual ~IncompTpfa();
 
@@ -117,8 +152,49 @@ namespace Opm
 
 
         /// Expose read-only reference to internal half-transmissibility.
+        /// Empty if the static data stores them in single precision.
         const std::vector<double>& getHalfTrans() const { return htrans_; }
 
+        /// Static data of this solver, for sharing with other solvers.
+        std::shared_ptr<const IncompTpfaStaticData> getStaticData() const { return static_; }
+
+        /// Set the pressure change below which the pore volumes and
+        /// rock compressibilities of a cell are not updated between
+        /// Newton iterations and steps with rock compressibility.
+        /// The default, zero, updates all cells whose pressure has
+        /// changed at all. A small positive tolerance saves most of
+        /// the updates late in a simulation, when the pressure barely
+        /// changes, at the price of pore volume errors of the order
+        /// of the compressibility times the tolerance.
+        void setPorevolumeUpdateTolerance(const double tol);
+
+        /// Solve the pressure equation on a domain decomposition.
+        ///
+        /// The grid of this solver is then the local part of a
+        /// distributed grid, consisting of the cells owned by this
+        /// process and at least one layer of overlap cells owned by
+        /// other processes. The cell numbering of the grid must be the
+        /// local index numbering of the parallel information.
+        ///
+        /// In each solve, the total mobility and pressure of overlap
+        /// cells are taken from their owners, only the equations of
+        /// owned cells are assembled, and the linear system is solved
+        /// collectively by the parallel linear solver. On output, the
+        /// pressure of all local cells is consistent, and fluxes are
+        /// computed for the faces with at least one owned cell; the
+        /// fluxes of other faces are set to zero.
+        ///
+        /// Wells are not supported in distributed solves.
+        /// \param[in] parallel_information  A ParallelISTLInformation,
+        ///                                   or empty for a serial solve.
+        void setParallelInformation(const boost::any& parallel_information);
+
+        /// Add the bytes of the pressure system, its assembly and work
+        /// arrays and the static data to the child "pressure" of the
+        /// report. Static data shared with other solvers is counted by
+        /// each of them.
+        void reportMemory(MemoryReport& report) const;
+
     protected:
         // Solve with no rock compressibility (linear eqn).
         void solveIncomp(const double dt,
@@ -131,6 +207,10 @@ namespace Opm
     private:
         // Helper functions.
         void computeStaticData();
+        void exchangeOverlap(std::vector<double>& v) const;
+        void eliminateOverlapRows() const;
+        void zeroOverlapFluxes(SimulationDataContainer& state) const;
+        void linearSolve() const;
         virtual void computePerSolveDynamicData(const double dt,
                                                 const SimulationDataContainer& state,
                                                 const WellState& well_state);
@@ -159,15 +239,20 @@ namespace Opm
         const Wells* wells_;    // May be NULL, outside may modify controls (only) between calls to solve().
         const std::vector<double>& src_;
         const FlowBoundaryConditions* bcs_;
-	std::vector<double> htrans_;
-	std::vector<double> gpress_;
+        std::shared_ptr<const IncompTpfaStaticData> static_;
+	const std::vector<double>& htrans_;
+	const std::vector<double>& gpress_;
         std::vector<int> allcells_;
+        std::vector<double> static_porevol_; // Empty unless rock_comp_props_ is non-null.
+        double porevol_update_tol_;
 
         // ------ Data that will be modified for every solve. ------
 	std::vector<double> trans_ ;
+        std::vector<double> trans_totmob_; // Mobilities trans_ was computed from.
         std::vector<double> wdp_;
         std::vector<double> totmob_;
         std::vector<double> omega_;
+        std::vector<double> pmob_; // Phase mobility workspace.
 	std::vector<double> gpress_omegaweighted_;
         std::vector<double> initial_porevol_;
         struct ifs_tpfa_forces forces_;
@@ -175,10 +260,15 @@ namespace Opm
         // ------ Data that will be modified for every solver iteration. ------
         std::vector<double> porevol_;
         std::vector<double> rock_comp_;
+        std::vector<double> porevol_pressure_; // Pressures porevol_ and rock_comp_ were computed from.
         std::vector<double> pressures_;
 
         // ------ Internal data for the ifs_tpfa solver. ------
 	struct ifs_tpfa_data* h_;
+
+        // ------ Domain decomposition, empty for serial solves. ------
+        boost::any parallel_information_;
+        std::vector<double> owner_mask_;
     };
 
 } // namespace Opm
@@ -0,0 +1,96 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <opm/core/pressure/IncompTpfaStaticData.hpp>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/pressure/mimetic/mimetic.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/grid.h>
+#include <opm/common/ErrorMacros.hpp>
+
+namespace Opm
+{
+
+    IncompTpfaStaticData::IncompTpfaStaticData(const UnstructuredGrid& grid,
+                                               const double* permeability,
+                                               const double* gravity,
+                                               Precision precision)
+        : grid_(grid),
+          htrans_(grid.cell_facepos[ grid.number_of_cells ]),
+          face_hf_(2 * grid.number_of_faces),
+          pattern_(0)
+    {
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        tpfa_htrans_compute(gg, permeability, &htrans_[0]);
+        init(gravity, precision);
+    }
+
+
+
+    IncompTpfaStaticData::IncompTpfaStaticData(const UnstructuredGrid& grid,
+                                               const float* permeability,
+                                               const double* gravity,
+                                               Precision precision)
+        : grid_(grid),
+          htrans_(grid.cell_facepos[ grid.number_of_cells ]),
+          face_hf_(2 * grid.number_of_faces),
+          pattern_(0)
+    {
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        tpfa_htrans_compute_sp(gg, permeability, &htrans_[0]);
+        init(gravity, precision);
+    }
+
+
+
+    void IncompTpfaStaticData::init(const double* gravity, Precision precision)
+    {
+        UnstructuredGrid* gg = const_cast<UnstructuredGrid*>(&grid_);
+        precision_ = precision;
+        if (precision_ == SinglePrecision) {
+            htrans_sp_.assign(htrans_.begin(), htrans_.end());
+            std::vector<double>().swap(htrans_);
+        }
+        tpfa_face_halffaces(gg, &face_hf_[0]);
+        if (gravity) {
+            gravity_.assign(gravity, gravity + gg->dimensions);
+            gpress_.resize(gg->cell_facepos[ gg->number_of_cells ], 0.0);
+
+            mim_ip_compute_gpress(gg->number_of_cells, gg->dimensions, gravity,
+                                  gg->cell_facepos, gg->cell_faces,
+                                  gg->face_centroids, gg->cell_centroids,
+                                  &gpress_[0]);
+        }
+        pattern_ = ifs_tpfa_cell_pattern(gg);
+        if (pattern_ == 0) {
+            OPM_THROW(std::runtime_error, "Failed to construct tpfa matrix pattern.");
+        }
+    }
+
+
+
+    IncompTpfaStaticData::~IncompTpfaStaticData()
+    {
+        csrmatrix_delete(pattern_);
+    }
+
+} // namespace Opm
@@ -0,0 +1,118 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_INCOMPTPFASTATICDATA_HEADER_INCLUDED
+#define OPM_INCOMPTPFASTATICDATA_HEADER_INCLUDED
+
+#include <vector>
+
+struct UnstructuredGrid;
+struct CSRMatrix;
+
+namespace Opm
+{
+
+    /// Data of the incompressible tpfa discretization that depends only on
+    /// the grid, the permeability and gravity: half-transmissibilities,
+    /// gravity potentials and the cell-to-cell sparsity pattern of the
+    /// pressure system.
+    ///
+    /// An instance may be shared by any number of IncompTpfa solvers, for
+    /// instance across schedule steps with changing wells or across
+    /// ensemble members, so that those only compute dynamic data.  The
+    /// object is immutable after construction and safe to share between
+    /// threads.
+    ///
+    /// For large models the half-transmissibilities may be stored in
+    /// single precision, see Precision.  They are then widened when the
+    /// effective transmissibilities are computed.
+    class IncompTpfaStaticData
+    {
+    public:
+        /// Storage precision of the half-transmissibilities.
+        enum Precision { DoublePrecision, SinglePrecision };
+
+        /// Compute static data.
+        /// \param[in] grid          A 2d or 3d grid.
+        /// \param[in] permeability  Permeability tensor of each cell, D*D
+        ///                          values per cell.
+        /// \param[in] gravity       Gravity vector. If non-null, the array
+        ///                          should have D elements.
+        /// \param[in] precision     Storage of the half-transmissibilities.
+        IncompTpfaStaticData(const UnstructuredGrid& grid,
+                             const double* permeability,
+                             const double* gravity,
+                             Precision precision = DoublePrecision);
+
+        /// Compute static data from a permeability field stored in
+        /// single precision.  Arguments as for the other constructor.
+        IncompTpfaStaticData(const UnstructuredGrid& grid,
+                             const float* permeability,
+                             const double* gravity,
+                             Precision precision = DoublePrecision);
+
+        /// Destructor.
+        ~IncompTpfaStaticData();
+
+        /// The grid.
+        const UnstructuredGrid& grid() const { return grid_; }
+
+        /// Gravity vector, or null if gravity is not included.
+        const double* gravity() const { return gravity_.empty() ? 0 : &gravity_[0]; }
+
+        /// Storage precision of the half-transmissibilities.
+        Precision precision() const { return precision_; }
+
+        /// Half-transmissibilities, one per cell face.  Empty unless
+        /// precision() is DoublePrecision.
+        const std::vector<double>& halfTrans() const { return htrans_; }
+
+        /// Half-transmissibilities in single precision, one per cell
+        /// face.  Empty unless precision() is SinglePrecision.
+        const std::vector<float>& halfTransSingle() const { return htrans_sp_; }
+
+        /// Half-face indices of each face, as from tpfa_face_halffaces().
+        const std::vector<int>& faceHalfFaces() const { return face_hf_; }
+
+        /// Gravity potential differences, one per cell face.  Empty if
+        /// gravity is not included.
+        const std::vector<double>& gravityPotential() const { return gpress_; }
+
+        /// Cell-to-cell sparsity pattern, as from ifs_tpfa_cell_pattern().
+        const CSRMatrix* cellPattern() const { return pattern_; }
+
+    private:
+        IncompTpfaStaticData(const IncompTpfaStaticData&);
+        IncompTpfaStaticData& operator=(const IncompTpfaStaticData&);
+
+        void init(const double* gravity, Precision precision);
+
+        const UnstructuredGrid& grid_;
+        std::vector<double> gravity_;
+        Precision precision_;
+        std::vector<double> htrans_;
+        std::vector<float> htrans_sp_;
+        std::vector<double> gpress_;
+        std::vector<int> face_hf_;
+        CSRMatrix* pattern_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_INCOMPTPFASTATICDATA_HEADER_INCLUDED
@@ -0,0 +1,205 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/pressure/SinglePhaseUpscaler.hpp>
+
+#include <opm/core/grid.h>
+#include <opm/core/linalg/LinearSolverFactory.hpp>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/flow_bc.h>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/utility/ThreadControl.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm
+{
+
+    namespace
+    {
+
+        // Effective permeability along each axis of one model.
+        void upscaleModel(const UnstructuredGrid& grid,
+                          const double* permeability,
+                          const LinearSolverInterface& linsolver,
+                          double* keff)
+        {
+            if (grid.cell_facetag == 0) {
+                OPM_THROW(std::runtime_error, "SinglePhaseUpscaler needs a grid with face tags.");
+            }
+            UnstructuredGrid* g = const_cast<UnstructuredGrid*>(&grid);
+            const int nc = grid.number_of_cells;
+            const int nf = grid.number_of_faces;
+            const int dim = grid.dimensions;
+            const int nhf = grid.cell_facepos[nc];
+
+            // Unit mobility, so the transmissibilities carry the
+            // permeability only.
+            std::vector<double> htrans(nhf);
+            std::vector<double> trans(nf);
+            tpfa_htrans_compute(g, permeability, htrans.data());
+            tpfa_trans_compute(g, htrans.data(), trans.data());
+            const std::vector<double> totmob(nc, 1.0);
+            const std::vector<double> gpress(nhf, 0.0);
+
+            // Boundary faces by tag.
+            std::vector<std::vector<int> > tagged(2*dim);
+            for (int c = 0; c < nc; ++c) {
+                for (int i = grid.cell_facepos[c]; i < grid.cell_facepos[c + 1]; ++i) {
+                    const int f = grid.cell_faces[i];
+                    const int tag = grid.cell_facetag[i];
+                    if ((grid.face_cells[2*f] < 0 || grid.face_cells[2*f + 1] < 0)
+                        && tag >= 0 && tag < 2*dim) {
+                        tagged[tag].push_back(f);
+                    }
+                }
+            }
+
+            ifs_tpfa_data* h = ifs_tpfa_construct(g, 0);
+            FlowBoundaryConditions* bc = flow_conditions_construct(0);
+            if (h == 0 || bc == 0) {
+                ifs_tpfa_destroy(h);
+                flow_conditions_destroy(bc);
+                OPM_THROW(std::runtime_error, "Failed allocating pressure system.");
+            }
+            std::vector<double> press(nc);
+            std::vector<double> flux(nf);
+            std::fill(keff, keff + 3, 0.0);
+            for (int d = 0; d < dim; ++d) {
+                const std::vector<int>& inlet = tagged[2*d];
+                const std::vector<int>& outlet = tagged[2*d + 1];
+                if (inlet.empty() || outlet.empty()) {
+                    continue;
+                }
+                flow_conditions_clear(bc);
+                flow_conditions_append_multi(BC_PRESSURE, inlet.size(), inlet.data(), 1.0, bc);
+                flow_conditions_append_multi(BC_PRESSURE, outlet.size(), outlet.data(), 0.0, bc);
+                ifs_tpfa_forces forces = { 0, bc, 0, totmob.data(), 0 };
+                if (!ifs_tpfa_assemble(g, &forces, trans.data(), gpress.data(), h)) {
+                    ifs_tpfa_destroy(h);
+                    flow_conditions_destroy(bc);
+                    OPM_THROW(std::runtime_error, "Failed assembling pressure system.");
+                }
+                linsolver.solve(h->A, h->b, h->x);
+                ifs_tpfa_solution soln = { press.data(), flux.data(), 0, 0 };
+                ifs_tpfa_press_flux(g, &forces, trans.data(), h, &soln);
+
+                // Outflow and area of the outlet, and mean position of
+                // the inlet and outlet along the axis.
+                double q = 0.0;
+                double area_out = 0.0;
+                double pos_out = 0.0;
+                for (const int f : outlet) {
+                    const double sign = (grid.face_cells[2*f + 1] < 0) ? 1.0 : -1.0;
+                    q += sign*flux[f];
+                    area_out += grid.face_areas[f];
+                    pos_out += grid.face_areas[f]*grid.face_centroids[dim*f + d];
+                }
+                double area_in = 0.0;
+                double pos_in = 0.0;
+                for (const int f : inlet) {
+                    area_in += grid.face_areas[f];
+                    pos_in += grid.face_areas[f]*grid.face_centroids[dim*f + d];
+                }
+                const double length = std::fabs(pos_out/area_out - pos_in/area_in);
+                keff[d] = q*length/area_out;
+            }
+            ifs_tpfa_destroy(h);
+            flow_conditions_destroy(bc);
+        }
+
+    } // anonymous namespace
+
+
+
+
+    SinglePhaseUpscaler::SinglePhaseUpscaler(const parameter::ParameterGroup& param,
+                                             const int max_threads)
+    {
+        // The parameter object is not thread safe, so all solvers
+        // are created up front.
+        const int n = max_threads > 0 ? max_threads : threads::numThreads();
+        for (int t = 0; t < n; ++t) {
+            solvers_.emplace_back(new LinearSolverFactory(param));
+            free_solvers_.push_back(t);
+        }
+    }
+
+
+
+
+    SinglePhaseUpscaler::~SinglePhaseUpscaler()
+    {
+    }
+
+
+
+
+    std::vector<double>
+    SinglePhaseUpscaler::upscale(const std::vector<const UnstructuredGrid*>& grids,
+                                 const std::vector<const double*>& permeabilities) const
+    {
+        if (grids.size() != permeabilities.size()) {
+            OPM_THROW(std::runtime_error, "SinglePhaseUpscaler: " << grids.size() << " grids but "
+                      << permeabilities.size() << " permeability fields.");
+        }
+        const int num_models = grids.size();
+        std::vector<double> keff(3*num_models, 0.0);
+
+        // At most one concurrent solve per solver.
+        threads::ScopedNumThreads limit(std::min(threads::numThreads(), int(solvers_.size())));
+        threads::parallelFor(0, num_models, 1, [&](const int begin, const int end) {
+                int s;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    s = free_solvers_.back();
+                    free_solvers_.pop_back();
+                }
+                try {
+                    for (int m = begin; m < end; ++m) {
+                        upscaleModel(*grids[m], permeabilities[m], *solvers_[s], &keff[3*m]);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    free_solvers_.push_back(s);
+                    throw;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_solvers_.push_back(s);
+            }, threads::DynamicSchedule);
+        return keff;
+    }
+
+
+
+
+    std::vector<double>
+    SinglePhaseUpscaler::upscale(const UnstructuredGrid& grid,
+                                 const double* permeability) const
+    {
+        return upscale(std::vector<const UnstructuredGrid*>(1, &grid),
+                       std::vector<const double*>(1, permeability));
+    }
+
+} // namespace Opm
@@ -0,0 +1,94 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_SINGLEPHASEUPSCALER_HEADER_INCLUDED
+#define OPM_SINGLEPHASEUPSCALER_HEADER_INCLUDED
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct UnstructuredGrid;
+
+namespace Opm
+{
+
+    namespace parameter { class ParameterGroup; }
+    class LinearSolverInterface;
+
+    /// Effective permeabilities of many small independent models, such
+    /// as the sub-boxes of a larger grid in upscaling.
+    ///
+    /// For each model and each axis direction d, an incompressible
+    /// single-phase flow problem is solved with unit pressure on the
+    /// boundary faces tagged 2d, zero pressure on those tagged 2d+1
+    /// and no flow elsewhere. The effective permeability in direction
+    /// d is then Q L / (A dp), with Q the outflow, A the outlet area
+    /// and L the distance between the area-weighted mean centroids of
+    /// the inlet and outlet faces. The grids must therefore have face
+    /// tags, as Cartesian and corner-point grids do.
+    ///
+    /// The models are solved concurrently with threads::numThreads()
+    /// threads. Each thread has a linear solver of its own, so that
+    /// the state a solver keeps between calls, e.g. the symbolic
+    /// factorisation of UMFPACK, the AMG setup or the matrix of ISTL,
+    /// is reused for all directions of a model and for consecutive
+    /// models of the same size and structure. One object must not be
+    /// used by several threads at once.
+    class SinglePhaseUpscaler
+    {
+    public:
+        /// Create linear solvers for up to max_threads concurrent
+        /// solves (zero for threads::numThreads()).
+        /// \param[in] param  parameters of the linear solvers, see
+        ///                   LinearSolverFactory
+        explicit SinglePhaseUpscaler(const parameter::ParameterGroup& param,
+                                     const int max_threads = 0);
+
+        ~SinglePhaseUpscaler();
+
+        /// Effective permeabilities of a batch of models.
+        /// \param[in] grids           grids of the models
+        /// \param[in] permeabilities  for each model, the permeability of
+        ///                            its cells, dim x dim values per cell
+        /// \return                    three values per model, the effective
+        ///                            permeability along each axis, with the
+        ///                            third zero for two-dimensional grids
+        std::vector<double> upscale(const std::vector<const UnstructuredGrid*>& grids,
+                                    const std::vector<const double*>& permeabilities) const;
+
+        /// Effective permeability of one model, as upscale() for a
+        /// batch of one.
+        std::vector<double> upscale(const UnstructuredGrid& grid,
+                                    const double* permeability) const;
+
+    private:
+        SinglePhaseUpscaler(const SinglePhaseUpscaler&);
+        SinglePhaseUpscaler& operator=(const SinglePhaseUpscaler&);
+
+        std::vector<std::unique_ptr<LinearSolverInterface> > solvers_;
+        // Solvers not in use.
+        mutable std::vector<int> free_solvers_;
+        mutable std::mutex mutex_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_SINGLEPHASEUPSCALER_HEADER_INCLUDED
@@ -25,6 +25,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include <opm/core/pressure/fsh.h>
 #include <opm/core/pressure/fsh_common_impl.h>
 #include <opm/core/pressure/mimetic/hybsys.h>
@@ -33,6 +37,41 @@
 
 
 
+#if defined(_OPENMP)
+/* Compute L, F1 and F2 as hybsys_schur_comp_unsymm(), with each thread
+ * handling a contiguous range of cells. */
+/* ---------------------------------------------------------------------- */
+static void
+cfsh_schur_comp_par(const double *Binv, const double *Biv,
+                    const double *P, struct fsh_data *h)
+/* ---------------------------------------------------------------------- */
+{
+    int           t, nt, c0, c1, nc;
+    struct hybsys sys;
+
+    nc = h->pimpl->nc;
+
+#pragma omp parallel private(t, nt, c0, c1, sys)
+    {
+        nt = omp_get_num_threads();
+        t  = omp_get_thread_num();
+        c0 = (int) (((long) nc) *  t      / nt);
+        c1 = (int) (((long) nc) * (t + 1) / nt);
+
+        /* Cell-indexed arrays (L, P) start at 'c0', face-indexed
+         * arrays (F1, F2, Biv) are addressed through the absolute
+         * offsets of 'gdof_pos'. */
+        sys   = *h->pimpl->sys;
+        sys.L = h->pimpl->sys->L + c0;
+
+        hybsys_schur_comp_unsymm(c1 - c0, h->pimpl->gdof_pos + c0,
+                                 Binv + h->pimpl->binv_pos[c0],
+                                 Biv, P + c0, &sys);
+    }
+}
+#endif  /* defined(_OPENMP) */
+
+
 /* ---------------------------------------------------------------------- */
 static int
 cfsh_assemble_grid(struct FlowBoundaryConditions *bc,
@@ -46,6 +85,16 @@ cfsh_assemble_grid(struct FlowBoundaryConditions *bc,
     int     npp;
     int    *pgconn, *gconn;
 
+#if defined(_OPENMP)
+    if (h->pimpl->coloring != NULL) {
+        npp = fsh_assemble_grid_par(bc, Binv, gpress, src, 0, h);
+
+        if (npp >= 0) {
+            return npp;
+        }
+    }
+#endif
+
     nc     = h->pimpl->nc;
     pgconn = h->pimpl->gdof_pos;
     gconn  = h->pimpl->gdof;
@@ -165,6 +214,10 @@ cfsh_construct(struct UnstructuredGrid *G, well_t *W)
                ngconn_tot * sizeof *new->pimpl->gdof);
 
         hybsys_init(new->max_ngconn, new->pimpl->sys);
+
+#if defined(_OPENMP)
+        fsh_define_concurrent_assembly(G, new->pimpl);
+#endif
     }
 
     return new;
@@ -196,9 +249,16 @@ cfsh_assemble(struct FlowBoundaryConditions *bc,
     /* Suppress warnings about unused parameters. */
     (void) wctrl;  (void) WI;  (void) BivW;  (void) wdp;
 
-    hybsys_schur_comp_unsymm(h->pimpl->nc,
-                             h->pimpl->gdof_pos,
-                             Binv, Biv, P, h->pimpl->sys);
+#if defined(_OPENMP)
+    if (h->pimpl->binv_pos != NULL) {
+        cfsh_schur_comp_par(Binv, Biv, P, h);
+    } else
+#endif
+    {
+        hybsys_schur_comp_unsymm(h->pimpl->nc,
+                                 h->pimpl->gdof_pos,
+                                 Binv, Biv, P, h->pimpl->sys);
+    }
 
     fsh_map_bdry_condition(bc, h->pimpl);
 
@@ -67,9 +67,10 @@ initialise_structure(struct FlowBoundaryConditions *fbc)
 
 /* ---------------------------------------------------------------------- */
 static int
-expand_tables(size_t                         nbc,
-              size_t                         nf ,
-              struct FlowBoundaryConditions *fbc)
+expand_tables(size_t                         nbc  ,
+              size_t                         nf   ,
+              int                            exact,
+              struct FlowBoundaryConditions *fbc  )
 /* ---------------------------------------------------------------------- */
 {
     int     ok_cond, ok_face;
@@ -80,7 +81,7 @@ expand_tables(size_t                         nbc,
     ok_face = nf  <= fbc->face_cpty;
 
     if (! ok_cond) {
-        alloc_sz = alloc_size(nbc, fbc->cond_cpty);
+        alloc_sz = exact ? nbc : alloc_size(nbc, fbc->cond_cpty);
 
         p1 = realloc(fbc->type    , (alloc_sz + 0) * sizeof *fbc->type    );
         p2 = realloc(fbc->value   , (alloc_sz + 0) * sizeof *fbc->value   );
@@ -98,7 +99,7 @@ expand_tables(size_t                         nbc,
     }
 
     if (! ok_face) {
-        alloc_sz = alloc_size(nf, fbc->face_cpty);
+        alloc_sz = exact ? nf : alloc_size(nf, fbc->face_cpty);
 
         p4 = realloc(fbc->face, alloc_sz * sizeof *fbc->face);
 
@@ -135,7 +136,7 @@ flow_conditions_construct(size_t nbc)
     if (fbc != NULL) {
         ok = initialise_structure(fbc);
 
-        ok = ok && expand_tables(nbc, nbc, fbc);
+        ok = ok && expand_tables(nbc, nbc, 0, fbc);
 
         if (! ok) {
             flow_conditions_destroy(fbc);
@@ -203,7 +204,7 @@ flow_conditions_append_multi(enum FlowBCType                type  ,
 
     nbc = fbc->nbc;
 
-    ok  = expand_tables(nbc + 1, fbc->cond_pos[ nbc ] + nfaces, fbc);
+    ok  = expand_tables(nbc + 1, fbc->cond_pos[ nbc ] + nfaces, 0, fbc);
 
     if (ok) {
         memcpy(fbc->face + fbc->cond_pos[ nbc ],
@@ -221,6 +222,61 @@ flow_conditions_append_multi(enum FlowBCType                type  ,
 }
 
 
+/* ---------------------------------------------------------------------- */
+/* Append 'nfaces' new boundary conditions of the same type, one for each
+ * of the interfaces 'faces', with individual target values 'values'.
+ *
+ * Return one (1) if successful, and zero (0) otherwise. */
+/* ---------------------------------------------------------------------- */
+int
+flow_conditions_append_faces(enum FlowBCType                type  ,
+                             size_t                         nfaces,
+                             const int                     *faces ,
+                             const double                  *values,
+                             struct FlowBoundaryConditions *fbc   )
+/* ---------------------------------------------------------------------- */
+{
+    int    ok;
+    size_t nbc, pos, i;
+
+    nbc = fbc->nbc;
+    pos = fbc->cond_pos[ nbc ];
+
+    ok  = expand_tables(nbc + nfaces, pos + nfaces, 0, fbc);
+
+    if (ok) {
+        memcpy(fbc->face + pos, faces, nfaces * sizeof *faces);
+
+        for (i = 0; i < nfaces; i++) {
+            fbc->type [ nbc + i ] = type;
+            fbc->value[ nbc + i ] = values[ i ];
+
+            fbc->cond_pos[ nbc + i + 1 ] = pos + i + 1;
+        }
+
+        fbc->nbc += nfaces;
+    }
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Ensure capacity for 'nbc' conditions and 'nfaces' interfaces.
+ *
+ * Return one (1) if successful, and zero (0) otherwise. */
+/* ---------------------------------------------------------------------- */
+int
+flow_conditions_reserve(size_t                         nbc   ,
+                        size_t                         nfaces,
+                        struct FlowBoundaryConditions *fbc   )
+/* ---------------------------------------------------------------------- */
+{
+    /* Exact sizes, no geometric growth. */
+    return expand_tables(nbc, nfaces, 1, fbc);
+}
+
+
 /* ---------------------------------------------------------------------- */
 /* Clear existing set of boundary conditions */
 /* ---------------------------------------------------------------------- */
@@ -82,6 +82,28 @@ flow_conditions_append_multi(enum FlowBCType                type  ,
                              struct FlowBoundaryConditions *fbc   );
 
 
+/* Append 'nfaces' new boundary conditions of the same type, one for
+ * each of the interfaces 'faces', with individual target values
+ * 'values'.  The tables are grown at most once.
+ * Return one (1) if successful, and zero (0) otherwise. */
+int
+flow_conditions_append_faces(enum FlowBCType                type  ,
+                             size_t                         nfaces,
+                             const int                     *faces ,
+                             const double                  *values,
+                             struct FlowBoundaryConditions *fbc   );
+
+
+/* Ensure that 'fbc' can hold 'nbc' boundary conditions affecting a
+ * total of 'nfaces' interfaces, existing conditions included, without
+ * further allocation.
+ * Return one (1) if successful, and zero (0) otherwise. */
+int
+flow_conditions_reserve(size_t                         nbc   ,
+                        size_t                         nfaces,
+                        struct FlowBoundaryConditions *fbc   );
+
+
 /* Clear existing set of boundary conditions */
 void
 flow_conditions_clear(struct FlowBoundaryConditions *fbc);
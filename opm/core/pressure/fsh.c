@@ -46,7 +46,7 @@ fsh_press_flux(struct UnstructuredGrid *G,
                double *wpress, double *wflux)
 /* ---------------------------------------------------------------------- */
 {
-    int c, f, i;
+    int c, f, i, j, n;
     double s;
 
     hybsys_compute_press_flux(G->number_of_cells,
@@ -69,22 +69,31 @@ fsh_press_flux(struct UnstructuredGrid *G,
                                        h->pimpl->work);
     }
 
-    for (f = 0; f < G->number_of_faces; f++) { fflux[f] = 0.0; }
+    /* Average the half-contact fluxes of each face.  Every face
+     * gathers from its (at most two) cells such that faces may be
+     * processed concurrently. */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(c, i, j, n, s)
+#endif
+    for (f = 0; f < G->number_of_faces; f++) {
+        fflux[f] = 0.0;
+
+        for (j = n = 0; j < 2; j++) {
+            c = G->face_cells[2*f + j];
+            if (c < 0) { continue; }
+
+            n += 1;
+            if ((j == 1) && (c == G->face_cells[2*f + 0])) { continue; }
 
-    i = 0;
-    for (c = 0; c < G->number_of_cells; c++) {
-        for (; i < G->cell_facepos[c + 1]; i++) {
-            f = G->cell_faces[i];
             s = 2.0*(G->face_cells[2*f + 0] == c) - 1.0;
 
-            fflux[f] += s * h->pimpl->cflux[i];
+            for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+                if (G->cell_faces[i] == f) {
+                    fflux[f] += s * h->pimpl->cflux[i];
+                }
+            }
         }
-    }
-
-    for (f = 0; f < G->number_of_faces; f++) {
-        i = (G->face_cells[2*f + 0] >= 0) +
-            (G->face_cells[2*f + 1] >= 0);
 
-        fflux[f] /= i;
+        fflux[f] /= n;
     }
 }
@@ -25,6 +25,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include <opm/core/grid.h>
 #include <opm/core/pressure/legacy_well.h>
 #include <opm/core/pressure/flow_bc.h>
@@ -51,6 +55,8 @@ fsh_destroy_impl(struct fsh_impl *pimpl)
 /* ---------------------------------------------------------------------- */
 {
     if (pimpl != NULL) {
+        hybsys_coloring_destroy(pimpl->coloring);
+        free            (pimpl->binv_pos);
         hybsys_well_free(pimpl->wsys );
         hybsys_free     (pimpl->sys  );
         free            (pimpl->ddata);
@@ -123,6 +129,9 @@ fsh_impl_allocate_basic(size_t idata_sz, size_t ddata_sz)
         new->sys   = NULL;
         new->wsys  = NULL;
 
+        new->coloring = NULL;
+        new->binv_pos = NULL;
+
         if ((new->idata == NULL) || (new->ddata == NULL)) {
             fsh_destroy_impl(new);
             new = NULL;
@@ -315,3 +324,115 @@ fsh_compute_table_sz(struct UnstructuredGrid *G, well_t *W, int max_ngconn,
         *ddata_sz += 2 * W->well_connpos[ W->number_of_wells ];
     }
 }
+
+
+#if defined(_OPENMP)
+/* ---------------------------------------------------------------------- */
+void
+fsh_define_concurrent_assembly(struct UnstructuredGrid *G,
+                               struct fsh_impl         *pimpl)
+/* ---------------------------------------------------------------------- */
+{
+    int c, n, nc;
+
+    nc = G->number_of_cells;
+
+    pimpl->coloring = hybsys_define_coloring(G);
+    pimpl->binv_pos = malloc((nc + (size_t) 1) * sizeof *pimpl->binv_pos);
+
+    if ((pimpl->coloring == NULL) || (pimpl->binv_pos == NULL)) {
+        hybsys_coloring_destroy(pimpl->coloring);
+        free(pimpl->binv_pos);
+
+        pimpl->coloring = NULL;
+        pimpl->binv_pos = NULL;
+    } else {
+        pimpl->binv_pos[0] = 0;
+        for (c = 0; c < nc; c++) {
+            n = G->cell_facepos[c + 1] - G->cell_facepos[c];
+
+            pimpl->binv_pos[c + 1] = pimpl->binv_pos[c] + ((size_t) n) * n;
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+fsh_assemble_grid_par(struct FlowBoundaryConditions *bc,
+                      const double    *Binv,
+                      const double    *gpress,
+                      const double    *src,
+                      int              symm,
+                      struct fsh_data *h)
+/* ---------------------------------------------------------------------- */
+{
+    int     i, k, c, n, p1, t, nt, m, npp, ok;
+    int    *pgconn, *gconn, *iwork;
+    double *dwork;
+
+    struct fsh_impl              impl;
+    struct hybsys                sys;
+    const struct hybsys_coloring *col;
+
+    nt     = omp_get_max_threads();
+    m      = h->max_ngconn;
+    pgconn = h->pimpl->gdof_pos;
+    gconn  = h->pimpl->gdof;
+    col    = h->pimpl->coloring;
+
+    /* Per-thread S (m*m), r (m) and work (m) plus iwork (m) */
+    dwork = malloc(((size_t) nt) * (m*m + 2*m) * sizeof *dwork);
+    iwork = malloc(((size_t) nt) * m           * sizeof *iwork);
+
+    ok = (dwork != NULL) && (iwork != NULL);
+
+    npp = 0;
+    if (ok) {
+#pragma omp parallel num_threads(nt) reduction(+:npp) \
+    private(i, k, c, n, p1, t, impl, sys)
+        {
+            t = omp_get_thread_num();
+
+            sys        = *h->pimpl->sys;
+            sys.S      = dwork + ((size_t) t) * (m*m + 2*m);
+            sys.r      = sys.S + m*m;
+
+            impl       = *h->pimpl;
+            impl.sys   = &sys;
+            impl.work  = sys.r + m;
+            impl.iwork = iwork + ((size_t) t) * m;
+
+            for (k = 0; k < col->ncolors; k++) {
+                /* Implied barrier between colours. */
+#pragma omp for schedule(static)
+                for (i = col->colpos[k]; i < col->colpos[k + 1]; i++) {
+                    c  = col->cells[i];
+                    p1 = pgconn[c];
+                    n  = pgconn[c + 1] - p1;
+
+                    if (symm) {
+                        hybsys_cellcontrib_symm(c, n, p1,
+                                                (int) h->pimpl->binv_pos[c],
+                                                gpress, src, Binv, &sys);
+                    } else {
+                        hybsys_cellcontrib_unsymm(c, n, p1,
+                                                  (int) h->pimpl->binv_pos[c],
+                                                  gpress, src, Binv, &sys);
+                    }
+
+                    npp += fsh_impose_bc(n, gconn + p1, bc, &impl);
+
+                    hybsys_global_assemble_cell(n, gconn + p1, sys.S, sys.r,
+                                                h->A, h->b);
+                }
+            }
+        }
+    }
+
+    free(iwork);
+    free(dwork);
+
+    return ok ? npp : -1;
+}
+#endif  /* defined(_OPENMP) */
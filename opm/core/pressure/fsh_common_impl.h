@@ -46,6 +46,10 @@ struct fsh_impl {
 
     int    *bdry_condition;     /* Map face->boundary condition ID */
 
+    /* Concurrent assembly.  NULL if unavailable. */
+    struct hybsys_coloring *coloring; /* Cells without common faces */
+    size_t                 *binv_pos; /* Start of each cell in Binv */
+
     /* Linear storage goes here... */
     int    *idata;              /* Actual storage array, integers */
     double *ddata;              /* Actual storage array, floating point */
@@ -87,4 +91,25 @@ void
 fsh_compute_table_sz(struct UnstructuredGrid *G, well_t *W, int max_ngconn,
                      size_t *nnu, size_t *idata_sz, size_t *ddata_sz);
 
+#if defined(_OPENMP)
+/* Define 'coloring' and 'binv_pos' for concurrent assembly.  Both
+ * remain NULL (serial assembly) if the allocation fails. */
+void
+fsh_define_concurrent_assembly(struct UnstructuredGrid *G,
+                               struct fsh_impl         *pimpl);
+
+/* Assemble grid contributions, concurrently within each colour of
+ * cells, using hybsys_cellcontrib_symm() if 'symm' is non-zero and
+ * hybsys_cellcontrib_unsymm() otherwise.  Returns the number of
+ * prescribed pressure values or -1 if scratch memory is not
+ * available, without having modified the system. */
+int
+fsh_assemble_grid_par(struct FlowBoundaryConditions *bc,
+                      const double    *Binv,
+                      const double    *gpress,
+                      const double    *src,
+                      int              symm,
+                      struct fsh_data *h);
+#endif
+
 #endif /* OPM_FSH_COMMON_IMPL_HEADER_INCLUDED */
@@ -25,6 +25,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include <opm/core/pressure/fsh.h>
 #include <opm/core/pressure/fsh_common_impl.h>
 #include <opm/core/pressure/mimetic/hybsys.h>
@@ -59,6 +63,40 @@ ifsh_set_effective_well_params(const double    *WI,
 }
 
 
+#if defined(_OPENMP)
+/* Compute L and F1 as hybsys_schur_comp_symm(), with each thread
+ * handling a contiguous range of cells. */
+/* ---------------------------------------------------------------------- */
+static void
+ifsh_schur_comp_par(const double *Binv, struct fsh_data *ifsh)
+/* ---------------------------------------------------------------------- */
+{
+    int           t, nt, c0, c1, nc;
+    struct hybsys sys;
+
+    nc = ifsh->pimpl->nc;
+
+#pragma omp parallel private(t, nt, c0, c1, sys)
+    {
+        nt = omp_get_num_threads();
+        t  = omp_get_thread_num();
+        c0 = (int) (((long) nc) *  t      / nt);
+        c1 = (int) (((long) nc) * (t + 1) / nt);
+
+        /* Cell-indexed arrays start at 'c0', face-indexed (F1) are
+         * addressed through the absolute offsets of 'gdof_pos'. */
+        sys   = *ifsh->pimpl->sys;
+        sys.L = ifsh->pimpl->sys->L + c0;
+
+        hybsys_schur_comp_symm(c1 - c0, ifsh->pimpl->gdof_pos + c0,
+                               Binv + ifsh->pimpl->binv_pos[c0], &sys);
+    }
+}
+
+
+#endif  /* defined(_OPENMP) */
+
+
 /* ---------------------------------------------------------------------- */
 static int
 ifsh_assemble_grid(struct FlowBoundaryConditions *bc,
@@ -72,6 +110,16 @@ ifsh_assemble_grid(struct FlowBoundaryConditions *bc,
     int     npp;
     int    *pgconn, *gconn;
 
+#if defined(_OPENMP)
+    if (ifsh->pimpl->coloring != NULL) {
+        npp = fsh_assemble_grid_par(bc, Binv, gpress, src, 1, ifsh);
+
+        if (npp >= 0) {
+            return npp;
+        }
+    }
+#endif
+
     nc     = ifsh->pimpl->nc;
     pgconn = ifsh->pimpl->gdof_pos;
     gconn  = ifsh->pimpl->gdof;
@@ -335,6 +383,10 @@ ifsh_construct(struct UnstructuredGrid *G, well_t *W)
                ngconn_tot * sizeof *new->pimpl->gdof);
 
         hybsys_init(new->max_ngconn, new->pimpl->sys);
+
+#if defined(_OPENMP)
+        fsh_define_concurrent_assembly(G, new->pimpl);
+#endif
     }
 
     return new;
@@ -364,9 +416,16 @@ ifsh_assemble(struct FlowBoundaryConditions *bc,
 
     fsh_map_bdry_condition(bc, ifsh->pimpl);
 
-    hybsys_schur_comp_symm(ifsh->pimpl->nc,
-                           ifsh->pimpl->gdof_pos,
-                           Binv, ifsh->pimpl->sys);
+#if defined(_OPENMP)
+    if (ifsh->pimpl->binv_pos != NULL) {
+        ifsh_schur_comp_par(Binv, ifsh);
+    } else
+#endif
+    {
+        hybsys_schur_comp_symm(ifsh->pimpl->nc,
+                               ifsh->pimpl->gdof_pos,
+                               Binv, ifsh->pimpl->sys);
+    }
 
     if (ifsh->pimpl->nw > 0) {
         ifsh_set_effective_well_params(WI, wdp, ifsh);
@@ -23,6 +23,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include <opm/core/linalg/blas_lapack.h>
 #include <opm/core/pressure/mimetic/hybsys.h>
 
@@ -577,25 +581,25 @@ hybsys_well_cellcontrib_symm(int c, int ngconn, int p1,
 
 
 /* ---------------------------------------------------------------------- */
-void
-hybsys_compute_press_flux(int nc, const int *pconn, const int *conn,
-                          const double *gpress,
-                          const double *Binv, const struct hybsys *sys,
-                          const double *pi, double *press, double *flux,
-                          double *work)
+static void
+hybsys_press_flux_range(int c0, int c1, size_t p2,
+                        const int *pconn, const int *conn,
+                        const double *gpress,
+                        const double *Binv, const struct hybsys *sys,
+                        const double *pi, double *press, double *flux,
+                        double *work)
 /* ---------------------------------------------------------------------- */
 {
-    int    c, i, nconn, p1, p2;
+    int    c, i, nconn, p1;
     double a1, a2;
 
     MAT_SIZE_T incx, incy, nrows, ncols, lda;
 
     incx = incy = 1;
 
-    p2 = 0;
     a1 = 1.0;
     a2 = 0.0;
-    for (c = 0; c < nc; c++) {
+    for (c = c0; c < c1; c++) {
         p1    = pconn[c + 0];
         nconn = pconn[c + 1] - p1;
 
@@ -627,66 +631,213 @@ hybsys_compute_press_flux(int nc, const int *pconn, const int *conn,
 }
 
 
+#if defined(_OPENMP)
+/* Split cells into 'nchunk' contiguous ranges.  Range 't' is
+ * [cpos[t], cpos[t + 1]) and its first inverse inner product starts
+ * at Binv[bpos[t]].  Returns the maximum number of connections of a
+ * single cell. */
+/* ---------------------------------------------------------------------- */
+static int
+hybsys_partition_cells(int nc, const int *pconn, int nchunk,
+                       int *cpos, size_t *bpos)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, t, nconn, max_nconn;
+    size_t p2;
+
+    max_nconn = 0;
+    p2        = 0;
+
+    for (c = t = 0; c < nc; c++) {
+        while ((t < nchunk) && (c == (int) (((long) nc) * t / nchunk))) {
+            cpos[t] = c;
+            bpos[t] = p2;
+            t      += 1;
+        }
+
+        nconn     = pconn[c + 1] - pconn[c];
+        max_nconn = MAX(max_nconn, nconn);
+        p2       += ((size_t) nconn) * nconn;
+    }
+
+    for (; t <= nchunk; t++) {
+        cpos[t] = nc;
+        bpos[t] = p2;
+    }
+
+    return max_nconn;
+}
+#endif  /* defined(_OPENMP) */
+
+
 /* ---------------------------------------------------------------------- */
 void
-hybsys_compute_press_flux_well(int nc, const int *pgconn, int nf,
-                               int nw, const int *pwconn, const int *wconn,
-                               const double *Binv,
-                               const double *WI,
-                               const double *wdp,
-                               const struct hybsys      *sys,
-                               const struct hybsys_well *wsys,
-                               const double             *pi,
-                               double *cpress, double *cflux,
-                               double *wpress, double *wflux,
-                               double *work)
+hybsys_compute_press_flux(int nc, const int *pconn, const int *conn,
+                          const double *gpress,
+                          const double *Binv, const struct hybsys *sys,
+                          const double *pi, double *press, double *flux,
+                          double *work)
+/* ---------------------------------------------------------------------- */
+{
+#if defined(_OPENMP)
+    int     t, nt, m, ok, *cpos;
+    size_t *bpos;
+    double *twork;
+
+    nt = omp_get_max_threads();
+
+    if ((nt > 1) && (nc > nt)) {
+        cpos = malloc((nt + 1) * sizeof *cpos);
+        bpos = malloc((nt + 1) * sizeof *bpos);
+
+        twork = NULL;
+        if ((cpos != NULL) && (bpos != NULL)) {
+            m     = hybsys_partition_cells(nc, pconn, nt, cpos, bpos);
+            twork = malloc(((size_t) nt) * m * sizeof *twork);
+        }
+
+        ok = twork != NULL;
+        if (ok) {
+            /* Cells are independent once 'pi' is known.  Per-range
+             * scratch space replaces the shared 'work'. */
+#pragma omp parallel for schedule(static) num_threads(nt)
+            for (t = 0; t < nt; t++) {
+                hybsys_press_flux_range(cpos[t], cpos[t + 1], bpos[t],
+                                        pconn, conn, gpress, Binv, sys,
+                                        pi, press, flux,
+                                        twork + ((size_t) t) * m);
+            }
+        }
+
+        free(twork);  free(bpos);  free(cpos);
+
+        if (ok) {
+            return;
+        }
+    }
+#endif
+
+    hybsys_press_flux_range(0, nc, 0, pconn, conn, gpress, Binv, sys,
+                            pi, press, flux, work);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+hybsys_press_flux_well_range(int c0, int c1, size_t gp2,
+                             const int *pgconn, int nf,
+                             const int *pwconn, const int *wconn,
+                             const double *Binv,
+                             const double *WI,
+                             const double *wdp,
+                             const struct hybsys      *sys,
+                             const struct hybsys_well *wsys,
+                             const double             *pi,
+                             double *cpress, double *cflux,
+                             double *wflux)
 /* ---------------------------------------------------------------------- */
 {
     int    c, w, wg, perf;
     int    ngconn, nwconn;
-    size_t gp1, gp2, wp1;
+    size_t gp1, wp1;
 
     MAT_SIZE_T mm, nn, incx, incy, ld;
 
     double dcp, one;
 
-    gp2 = 0;
-    for (c = 0; c < nc; c++) {
+    incx = incy = 1;
+    one  = 1.0;
+
+    for (c = c0; c < c1; c++) {
         ngconn = pgconn[c + 1] - pgconn[c];
         nwconn = pwconn[c + 1] - pwconn[c];
 
         if (nwconn > 0) {
-            dcp = 0.0;
-
             gp1 = pgconn[c];
             wp1 = pwconn[c];
 
+            /* Well pressures are read directly from 'pi' in order to
+             * need no scratch space. */
+            dcp = 0.0;
             for (w = 0; w < nwconn; w++) {
-                wg      = wconn[2*(wp1 + w) + 0];
-                work[w] = pi[nf + wg];
+                wg   = wconn[2*(wp1 + w) + 0];
+                dcp += wsys->F2[wp1 + w] * pi[nf + wg];
             }
-
-            mm   = nwconn;  incx = incy = 1;
-            dcp  = ddot_(&mm, &wsys->F2[wp1], &incx, work, &incy);
             dcp /= sys->L[c];
 
             cpress[c] += dcp;
 
             mm  = nn = ld = ngconn;
-            one = 1.0;
             dgemv_("No Transpose", &mm, &nn,
                    &dcp, &Binv[gp2], &ld, sys->one  , &incx,
                    &one,                 &cflux[gp1], &incy);
 
             for (w = 0; w < nwconn; w++) {
+                wg           = wconn[2*(wp1 + w) + 0];
                 perf         = wconn[2*(wp1 + w) + 1];
 
-                wflux[perf]  = wdp[wp1 + w] + cpress[c] - work[w];
+                wflux[perf]  = wdp[wp1 + w] + cpress[c] - pi[nf + wg];
                 wflux[perf] *= - WI [wp1 + w]; /* Sign => positive inj. */
             }
         }
 
-        gp2 += ngconn + ngconn;
+        gp2 += ((size_t) ngconn) * ngconn;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+hybsys_compute_press_flux_well(int nc, const int *pgconn, int nf,
+                               int nw, const int *pwconn, const int *wconn,
+                               const double *Binv,
+                               const double *WI,
+                               const double *wdp,
+                               const struct hybsys      *sys,
+                               const struct hybsys_well *wsys,
+                               const double             *pi,
+                               double *cpress, double *cflux,
+                               double *wpress, double *wflux,
+                               double *work)
+/* ---------------------------------------------------------------------- */
+{
+#if defined(_OPENMP)
+    int     t, nt, ok, *cpos;
+    size_t *bpos;
+#endif
+
+    (void) work;                /* No longer needed */
+
+#if defined(_OPENMP)
+    nt = omp_get_max_threads();
+    ok = 0;
+
+    if ((nt > 1) && (nc > nt)) {
+        cpos = malloc((nt + 1) * sizeof *cpos);
+        bpos = malloc((nt + 1) * sizeof *bpos);
+
+        ok = (cpos != NULL) && (bpos != NULL);
+        if (ok) {
+            hybsys_partition_cells(nc, pgconn, nt, cpos, bpos);
+
+#pragma omp parallel for schedule(static) num_threads(nt)
+            for (t = 0; t < nt; t++) {
+                hybsys_press_flux_well_range(cpos[t], cpos[t + 1], bpos[t],
+                                             pgconn, nf, pwconn, wconn,
+                                             Binv, WI, wdp, sys, wsys, pi,
+                                             cpress, cflux, wflux);
+            }
+        }
+
+        free(bpos);  free(cpos);
+    }
+
+    if (!ok)
+#endif
+    {
+        hybsys_press_flux_well_range(0, nc, 0, pgconn, nf, pwconn, wconn,
+                                     Binv, WI, wdp, sys, wsys, pi,
+                                     cpress, cflux, wflux);
     }
 
     /* Assign well BHP from linsolve output */
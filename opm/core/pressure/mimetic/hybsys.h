@@ -544,6 +544,9 @@ hybsys_well_cellcontrib_symm(int c, int ngconn, int p1,
  * @param[in,out] work   Scratch array for temporary results.  Array of size at
  *                       least \f$\max_c \{   \mathit{pconn}_{c + 1}
  *                                          - \mathit{pconn}_c \} \f$.
+ *                       Only used in serial runs; when compiled with OpenMP,
+ *                       cell ranges are processed concurrently using
+ *                       internally allocated scratch space.
  */
 void
 hybsys_compute_press_flux(int nc, const int *pconn, const int *conn,
@@ -594,9 +597,7 @@ hybsys_compute_press_flux(int nc, const int *pconn, const int *conn,
  *                       @c nw.
  * @param[out]    wflux  Well connection (perforation) fluxes.  Array of size
  *                       <CODE>pwconn[nw]</CODE>.
- * @param[in,out] work   Scratch array for storing intermediate results.  Array
- *                       of size at least \f$\max_w \{  \mathit{pwconn}_{w + 1}
- *                                                    - \mathit{pwconn}_w\}\f$.
+ * @param[in,out] work   Unused.  Retained for interface compatibility.
  */
 void
 hybsys_compute_press_flux_well(int nc, const int *pgconn, int nf,
@@ -140,7 +140,7 @@ count_conn_per_row_well(struct UnstructuredGrid *G, well_t *W,
                         struct CSRMatrix *A)
 /* ---------------------------------------------------------------------- */
 {
-    int c, w, nc, nf, nwdof, ok, i, dof, *ia, *ja, *wja;
+    int c, w, nc, nf, nwdof, ok, i, dof, *ia, *wja;
 
     size_t m;
 
@@ -152,11 +152,9 @@ count_conn_per_row_well(struct UnstructuredGrid *G, well_t *W,
     ok = 1;
     for (c = 0; c < nc; c++) {
         for (; ok && (wja != cwells + 2*cwpos[c + 1]); wja += 2) {
-            for (       ja  = G->cell_faces + ia[c + 0];
-                 ok && (ja != G->cell_faces + ia[c + 1]); ja++) {
-                dof = *ja;
-                ok  = hash_set_insert(dof, wia[*wja]) == dof;
-            }
+            ok = hash_set_insert_elms(ia[c + 1] - ia[c],
+                                      G->cell_faces + ia[c],
+                                      wia[*wja]) >= 0;
 
             for (i = cwpos[c]; ok && (i < cwpos[c + 1]); i++) {
                 dof = nf + cwells[2*i + 0];
@@ -416,3 +414,92 @@ hybsys_global_assemble_well_sym(int ngconn_tot,
         b[ngconn_tot + wconn[2*wl1 + 0]] += r[ngconn + wl1];
     }
 }
+
+
+/* ---------------------------------------------------------------------- */
+void
+hybsys_coloring_destroy(struct hybsys_coloring *C)
+/* ---------------------------------------------------------------------- */
+{
+    if (C != NULL) {
+        free(C->cells);
+        free(C->colpos);
+    }
+
+    free(C);
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct hybsys_coloring *
+hybsys_define_coloring(struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    int c, i, f, k, nc, max_ncf, other;
+    int *color, *stamp;
+
+    struct hybsys_coloring *C;
+
+    nc      = G->number_of_cells;
+    max_ncf = 0;
+    for (c = 0; c < nc; c++) {
+        max_ncf = MAX(max_ncf, G->cell_facepos[c + 1] - G->cell_facepos[c]);
+    }
+
+    C     = malloc(1 * sizeof *C);
+    color = malloc(nc            * sizeof *color);
+    stamp = malloc((max_ncf + 1) * sizeof *stamp);
+
+    if (C != NULL) {
+        C->ncolors = 0;
+        C->colpos  = malloc((max_ncf + 2) * sizeof *C->colpos);
+        C->cells   = malloc(nc            * sizeof *C->cells);
+
+        if ((color == NULL) || (stamp == NULL) ||
+            (C->colpos == NULL) || ((C->cells == NULL) && (nc > 0))) {
+            hybsys_coloring_destroy(C);
+            C = NULL;
+        }
+    }
+
+    if (C != NULL) {
+        /* Greedy colouring: smallest colour not used by any neighbour. */
+        for (k = 0; k <= max_ncf; k++) { stamp[k] = -1; }
+
+        for (c = 0; c < nc; c++) {
+            for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+                f     = G->cell_faces[i];
+                other = G->face_cells[2*f + 0] + G->face_cells[2*f + 1] - c;
+
+                if ((other >= 0) && (other < c)) {
+                    stamp[ color[other] ] = c;
+                }
+            }
+
+            for (k = 0; stamp[k] == c; k++) { ; }
+
+            color[c]   = k;
+            C->ncolors = MAX(C->ncolors, k + 1);
+        }
+
+        /* Bucket cells by colour */
+        for (k = 0; k <= C->ncolors; k++) { C->colpos[k] = 0; }
+        for (c = 0; c < nc; c++) { C->colpos[ color[c] + 1 ] += 1; }
+        for (k = 0; k < C->ncolors; k++) {
+            C->colpos[k + 1] += C->colpos[k];
+        }
+
+        for (c = 0; c < nc; c++) {
+            C->cells[ C->colpos[ color[c] ] ++ ] = c;
+        }
+        for (k = C->ncolors; k > 0; k--) {
+            C->colpos[k] = C->colpos[k - 1];
+        }
+        C->colpos[0] = 0;
+    }
+
+    free(stamp);
+    free(color);
+
+    return C;
+}
@@ -204,6 +204,50 @@ hybsys_global_assemble_well_sym(int ngconn_tot,
                                 double           *b);
 
 
+/**
+ * Partition of the grid cells into colours such that no two cells of
+ * the same colour share a face.
+ *
+ * The cell contributions of one colour touch disjoint rows of the
+ * global system and may therefore be assembled concurrently using
+ * function hybsys_global_assemble_cell().
+ */
+struct hybsys_coloring {
+    int  ncolors;  /**< Number of colours. */
+    int *colpos;   /**< Start of each colour in @c cells.
+                        <CODE>ncolors + 1</CODE> entries. */
+    int *cells;    /**< Cells of each colour, increasing within each
+                        colour. */
+};
+
+
+/**
+ * Colour the cells of a grid for concurrent assembly.
+ *
+ * Uses greedy colouring of the cell-to-cell (face) graph, so at most
+ * one more colour than the maximum number of faces of any cell.  Logically
+ * Cartesian grids need two colours.  Like the system sparsity pattern, the
+ * colouring depends only on the grid and is intended to be computed once,
+ * alongside hybsys_define_globconn().
+ *
+ * @param[in] G Grid.
+ * @return Cell colouring, or @c NULL on allocation failure.  Must be
+ *         released using function hybsys_coloring_destroy().
+ */
+struct hybsys_coloring *
+hybsys_define_coloring(struct UnstructuredGrid *G);
+
+
+/**
+ * Release memory resources of a cell colouring.
+ *
+ * @param[in,out] C Cell colouring from hybsys_define_coloring().  May be
+ *                  @c NULL.
+ */
+void
+hybsys_coloring_destroy(struct hybsys_coloring *C);
+
+
 
 #ifdef __cplusplus
 }
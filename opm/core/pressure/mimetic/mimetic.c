@@ -19,6 +19,7 @@
 
 #include "config.h"
 #include <assert.h>
+#include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -251,3 +252,154 @@ mim_ip_density_update(int nc, const int *pconn, const double *omega,
         }
     }
 }
+
+
+/* Inverse inner product of single cell with 'nf' faces, stored in
+ * 'Binv' (nf-by-nf, column major).  Q and T are scratch arrays of size
+ * at least nf*d. */
+/* ---------------------------------------------------------------------- */
+static void
+ip_simple_cell(int nf, int d, int c, const int *cf,
+               const int *fneighbour, const double *fcentroid,
+               const double *fnormal, const double *farea,
+               const double *ccentroid, double vol, const double *K,
+               double *Q, double *T, double *Binv)
+/* ---------------------------------------------------------------------- */
+{
+    int    i, j, k, l, pass, f;
+    double s, a, nrm, t, t6, nkn;
+
+    /* Q <- diag(A) * C, T <- N (outward normals) */
+    for (i = 0; i < nf; i++) {
+        f = cf[i];
+        s = 2.0*(fneighbour[2 * f] == c) - 1.0;
+        a = farea[f];
+
+        for (j = 0; j < d; j++) {
+            Q[i + j*nf] = a * (fcentroid[j + f*d] - ccentroid[j + c*d]);
+            T[i + j*nf] = s * fnormal[j + f*d];
+        }
+    }
+
+    /* Q <- orth(Q), modified Gram-Schmidt applied twice. */
+    for (j = 0; j < d; j++) {
+        for (pass = 0; pass < 2; pass++) {
+            for (k = 0; k < j; k++) {
+                s = 0.0;
+                for (i = 0; i < nf; i++) { s += Q[i + k*nf] * Q[i + j*nf]; }
+                for (i = 0; i < nf; i++) { Q[i + j*nf] -= s * Q[i + k*nf]; }
+            }
+        }
+
+        nrm = 0.0;
+        for (i = 0; i < nf; i++) { nrm += Q[i + j*nf] * Q[i + j*nf]; }
+
+        assert (nrm > 0.0);
+        nrm = 1.0 / sqrt(nrm);
+        for (i = 0; i < nf; i++) { Q[i + j*nf] *= nrm; }
+    }
+
+    t = 0.0;
+    for (j = 0; j < d; j++) { t += K[j + j*d]; }
+    t6 = 6.0 * t / d;
+
+    /* Binv <- (N*K*N' + 6t/d * diag(A)*(I - Q*Q')*diag(A)) / vol */
+    for (k = 0; k < nf; k++) {
+        for (i = 0; i <= k; i++) {
+            nkn = 0.0;
+            for (j = 0; j < d; j++) {
+                for (l = 0; l < d; l++) {
+                    nkn += T[i + l*nf] * K[l + j*d] * T[k + j*nf];
+                }
+            }
+
+            s = (i == k) ? 1.0 : 0.0;
+            for (j = 0; j < d; j++) { s -= Q[i + j*nf] * Q[k + j*nf]; }
+
+            s *= farea[cf[i]] * farea[cf[k]];
+
+            Binv[i + k*nf] = Binv[k + i*nf] = (nkn + t6*s) / vol;
+        }
+    }
+}
+
+
+/* Hexahedral instance of ip_simple_cell(): constant sizes let the
+ * compiler unroll and vectorise all loops. */
+/* ---------------------------------------------------------------------- */
+static void
+ip_simple_hex(int c, const int *cf,
+              const int *fneighbour, const double *fcentroid,
+              const double *fnormal, const double *farea,
+              const double *ccentroid, double vol, const double *K,
+              double *Binv)
+/* ---------------------------------------------------------------------- */
+{
+    double Q[6 * 3], T[6 * 3];
+
+    ip_simple_cell(6, 3, c, cf, fneighbour, fcentroid, fnormal, farea,
+                   ccentroid, vol, K, Q, T, Binv);
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+mim_ip_simple_all_batch(int ncells, int d, int max_ncf,
+                        const int *pconn, const int *conn,
+                        const int *fneighbour, const double *fcentroid,
+                        const double *fnormal, const double *farea,
+                        const double *ccentroid, const double *cvol,
+                        const double *perm, double *Binv)
+/* ---------------------------------------------------------------------- */
+{
+    int     c, nf, ok;
+    size_t *pos2;
+    double *work;
+
+    pos2 = malloc((ncells + (size_t) 1) * sizeof *pos2);
+    ok   = pos2 != NULL;
+
+    if (ok) {
+        /* Start of each cell's block in Binv */
+        pos2[0] = 0;
+        for (c = 0; c < ncells; c++) {
+            nf          = pconn[c + 1] - pconn[c];
+            pos2[c + 1] = pos2[c] + ((size_t) nf) * nf;
+        }
+
+#if defined(_OPENMP)
+#pragma omp parallel private(c, nf, work) reduction(&&:ok)
+#endif
+        {
+            /* Scratch for cells other than hexahedra. */
+            work = malloc(2 * ((size_t) max_ncf) * d * sizeof *work);
+
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+            for (c = 0; c < ncells; c++) {
+                nf = pconn[c + 1] - pconn[c];
+
+                if ((nf == 6) && (d == 3)) {
+                    ip_simple_hex(c, conn + pconn[c], fneighbour,
+                                  fcentroid, fnormal, farea, ccentroid,
+                                  cvol[c], perm + c*d*d, Binv + pos2[c]);
+                } else if (work != NULL) {
+                    ip_simple_cell(nf, d, c, conn + pconn[c], fneighbour,
+                                   fcentroid, fnormal, farea, ccentroid,
+                                   cvol[c], perm + c*d*d,
+                                   work, work + ((size_t) max_ncf) * d,
+                                   Binv + pos2[c]);
+                } else {
+                    ok = 0;
+                }
+            }
+
+            free(work);
+        }
+    }
+
+    free(pos2);
+
+    return ok;
+}
@@ -183,6 +183,32 @@ mim_ip_simple_all(int ncells, int d, int max_ncf,
                   double *farea, double *ccentroid, double *cvol,
                   double *perm, double *Binv);
 
+/**
+ * Compute the mimetic inner products as mim_ip_simple_all(), but without
+ * a BLAS/LAPACK call per cell.
+ *
+ * The orthonormal basis of function mim_ip_span_nullspace() is formed by
+ * (re-orthogonalised) Gram-Schmidt in a small, fixed-dimension kernel that
+ * also evaluates the inner product of mim_ip_linpress_exact().  Cells with
+ * six faces in three dimensions (hexahedra) use a fully unrolled instance
+ * of that kernel.  Cells are processed in parallel if OpenMP is enabled.
+ * The results agree with those of mim_ip_simple_all() to rounding error.
+ *
+ * The parameters and the output layout, with each cell's
+ * \f$n_c\times n_c\f$ block stored contiguously as expected by
+ * hybsys_schur_comp_symm(), are those of mim_ip_simple_all().
+ *
+ * @return One (true) if successful or zero (false) if workspace allocation
+ * fails.
+ */
+int
+mim_ip_simple_all_batch(int ncells, int d, int max_ncf,
+                        const int *pconn, const int *conn,
+                        const int *fneighbour, const double *fcentroid,
+                        const double *fnormal, const double *farea,
+                        const double *ccentroid, const double *cvol,
+                        const double *perm, double *Binv);
+
 /**
  * Compute local, static gravity pressure contributions to Darcy
  * flow equation discretised using a mimetic finite-difference method.
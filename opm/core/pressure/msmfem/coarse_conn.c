@@ -16,7 +16,6 @@
   You should have received a copy of the GNU General Public License
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
-
 #include "config.h"
 #include <assert.h>
 #include <limits.h>
@@ -24,7 +23,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <opm/core/pressure/msmfem/hash_set.h>
 #include <opm/core/pressure/msmfem/coarse_conn.h>
 
 #define MAX(a,b)   (((a) > (b)) ? (a) : (b))
@@ -37,16 +35,17 @@
 
 /* Individual block connection. */
 struct block_neighbour {
-    int              b;         /* Neighbouring block */
-    struct hash_set *fconns;    /* Constituent connections */
+    int b;                      /* Neighbouring block */
+    int nfconn;                 /* Number of constituent connections */
+    int cf;                     /* Coarse face number */
 };
 
 
 /* Adjacency list of single block (directed graph) */
 struct block_neighbours {
-    int                    nneigh;  /* Number of neighbours. */
-    int                    cpty;    /* Neighbour capacity. */
-    struct block_neighbour **neigh; /* Actual neighbours (sorted on neigh[i]->b) */
+    int                     nneigh; /* Number of neighbours. */
+    int                     cpty;   /* Neighbour capacity. */
+    struct block_neighbour *neigh;  /* Actual neighbours (sorted on neigh[i].b) */
 };
 
 
@@ -55,87 +54,13 @@ struct block_neighbours {
  * ====================================================================== */
 
 
-/* Relase dynamic memory resources for single block neighbour 'bn'. */
-/* ---------------------------------------------------------------------- */
-static void
-block_neighbour_deallocate(struct block_neighbour *bn)
-/* ---------------------------------------------------------------------- */
-{
-    if (bn != NULL) {
-        hash_set_deallocate(bn->fconns);
-    }
-
-    free(bn);
-}
-
-
-/* Construct empty block neighbour connection capable of holding
- * 'nconn' fine-scale connections (e.g., fine-scale interfaces).
- * The fine-scale table is not allocated unless nconn > 0. */
-/* ---------------------------------------------------------------------- */
-static struct block_neighbour *
-block_neighbour_allocate(int nconn)
-/* ---------------------------------------------------------------------- */
-{
-    struct block_neighbour *new;
-
-    new = malloc(1 * sizeof *new);
-    if (new != NULL) {
-        if (nconn > 0) {
-            new->fconns = hash_set_allocate(nconn);
-
-            if (new->fconns != NULL) {
-                new->b  = INT_MIN;
-            } else {
-                block_neighbour_deallocate(new);
-                new     = NULL;
-            }
-        } else {
-            new->b      = INT_MIN;
-            new->fconns = NULL;
-        }
-    }
-
-    return new;
-}
-
-
-/* Insert fine-scale connection 'fconn' into block neighbour
- * connection 'bn', but only if the bn->fconns table has been allocated.  */
-/* ---------------------------------------------------------------------- */
-static int
-block_neighbour_insert_fconn(int fconn, struct block_neighbour *bn)
-/* ---------------------------------------------------------------------- */
-{
-    int ret;
-
-    assert (bn != NULL);
-
-    ret = 0;
-
-    if (bn->fconns != NULL) {
-        ret = hash_set_insert(fconn, bn->fconns);
-    }
-
-    return ret;
-}
-
-
 /* Relase dynamic memory resources for single-block adjacency list 'bns'. */
 /* ---------------------------------------------------------------------- */
 static void
 block_neighbours_deallocate(struct block_neighbours *bns)
 /* ---------------------------------------------------------------------- */
 {
-    int i;
-
     if (bns != NULL) {
-        if (bns->neigh != NULL) {
-            for (i = bns->nneigh - 1; i >= 0; i--) {
-                block_neighbour_deallocate(bns->neigh[i]);
-            }
-        }
-
         free(bns->neigh);
     }
 
@@ -150,7 +75,6 @@ static struct block_neighbours *
 block_neighbours_allocate(int nneigh)
 /* ---------------------------------------------------------------------- */
 {
-    int                      i;
     struct block_neighbours *new;
 
     new = malloc(1 * sizeof *new);
@@ -160,7 +84,6 @@ block_neighbours_allocate(int nneigh)
             new->neigh = malloc(nneigh * sizeof *new->neigh);
 
             if (new->neigh != NULL) {
-                for (i = 0; i < nneigh; i++) { new->neigh[i] = NULL; }
                 new->nneigh = 0;
                 new->cpty   = nneigh;
             } else {
@@ -185,8 +108,8 @@ static int
 block_neighbours_expand(int nneigh, struct block_neighbours *bns)
 /* ---------------------------------------------------------------------- */
 {
-    int                      ret;
-    struct block_neighbour **neigh;
+    int                     ret;
+    struct block_neighbour *neigh;
 
     assert (bns != NULL);
 
@@ -196,9 +119,7 @@ block_neighbours_expand(int nneigh, struct block_neighbours *bns)
         bns->neigh = neigh;
         bns->cpty  = nneigh;
 
-        for (ret = bns->nneigh; ret < bns->cpty; ret++) {
-            bns->neigh[ret] = NULL;
-        }
+        ret = nneigh;
     } else {
         ret = -1;
     }
@@ -207,18 +128,44 @@ block_neighbours_expand(int nneigh, struct block_neighbours *bns)
 }
 
 
-/* Insert fine-scale connection 'fconn' into single-block adjacency
- * list 'bns' in slot corresponding to connection 'b'.
+/* Locate connection 'b' in single-block adjacency list 'bns'.
+ *
+ * Returns the position of 'b' if present, and the position at which
+ * 'b' must be inserted to keep the list sorted otherwise. */
+/* ---------------------------------------------------------------------- */
+static int
+block_neighbours_find(int b, const struct block_neighbours *bns)
+/* ---------------------------------------------------------------------- */
+{
+    int i, j, p, t;
+
+    i = 0;
+    j = bns->nneigh;
+
+    while (i < j) {
+        p = (i + j) / 2;
+        t = bns->neigh[p].b;
+
+        if      (t < b) { i = p + 1; }
+        else if (t > b) { j = p + 0; }
+        else            { i = j = p; }
+    }
+
+    return i;
+}
+
+
+/* Count one fine-scale connection in slot corresponding to connection
+ * 'b' of single-block adjacency list 'bns', creating the slot if it
+ * does not already exist.
  *
- * New coarse-scale connections are assumed to hold 'expct_nconn'
- * fine-scale connections.*/
+ * Returns a non-negative value if successful and -1 otherwise. */
 /* ---------------------------------------------------------------------- */
 static int
-block_neighbours_insert_neighbour(int b, int fconn, int expct_nconn,
-                                  struct block_neighbours *bns)
+block_neighbours_insert_neighbour(int b, struct block_neighbours *bns)
 /* ---------------------------------------------------------------------- */
 {
-    int i, j, p, t, nmove, ret;
+    int i, nmove, ret;
 
     assert (bns != NULL);
 
@@ -227,26 +174,12 @@ block_neighbours_insert_neighbour(int b, int fconn, int expct_nconn,
         ret = block_neighbours_expand(1, bns);
     }
 
-    if (ret == 1) {
+    if (ret >= 0) {
         /* bns->neigh points to table containing at least one slot. */
-        i = 0;
-        j = bns->nneigh;
-
-        while (i < j) {
-            p = (i + j) / 2;
-
-            assert (bns->neigh[p] != NULL);
-
-            t = bns->neigh[p]->b;
-
-            if      (t < b) { i = p + 1; }
-            else if (t > b) { j = p + 0; }
-            else            { i = j = p; }
-        }
+        i = block_neighbours_find(b, bns);
 
-        if ((i < bns->nneigh) &&
-            (bns->neigh[i] != NULL) && (bns->neigh[i]->b == b)) {
-            ret = block_neighbour_insert_fconn(fconn, bns->neigh[i]);
+        if ((i < bns->nneigh) && (bns->neigh[i].b == b)) {
+            bns->neigh[i].nfconn += 1;
         } else {
             if (bns->nneigh == bns->cpty) {
                 assert (bns->cpty >= 1);
@@ -261,16 +194,11 @@ block_neighbours_insert_neighbour(int b, int fconn, int expct_nconn,
                             nmove * sizeof *bns->neigh);
                 }
 
-                bns->neigh[i] = block_neighbour_allocate(expct_nconn);
-
-                if (bns->neigh[i] != NULL) {
-                    ret = block_neighbour_insert_fconn(fconn, bns->neigh[i]);
+                bns->neigh[i].b      = b;
+                bns->neigh[i].nfconn = 1;
+                bns->neigh[i].cf     = -1;
 
-                    bns->neigh[i]->b = b;
-                    bns->nneigh += 1;
-                } else {
-                    ret = -1;
-                }
+                bns->nneigh += 1;
             }
         }
     }
@@ -297,45 +225,55 @@ count_blocks(int nc, const int *p)
 }
 
 
+/* Classify fine-scale face 'f' according to the blocks it connects.
+ * Inter-block faces are keyed off minimum block number ('*b_in') if
+ * internal and valid block number if external.  The face is on a
+ * block boundary if and only if *b_in != *b_out. */
+/* ---------------------------------------------------------------------- */
+static void
+face_blocks(int f, const int *p, const int *neighbours,
+            int *b_in, int *b_out)
+/* ---------------------------------------------------------------------- */
+{
+    int c1, b1, c2, b2;
+
+    c1 = neighbours[2*f + 0];   b1 = (c1 >= 0) ? p[c1] : -1;
+    c2 = neighbours[2*f + 1];   b2 = (c2 >= 0) ? p[c2] : -1;
+
+    assert ((b1 >= 0) || (b2 >= 0));
+
+    if ((b1 >= 0) && (b2 >= 0)) {
+        *b_in  = MIN(b1, b2);
+        *b_out = MAX(b1, b2);
+    } else if (b1 >= 0) { /* (b2 == -1) */
+        *b_in  = b1;
+        *b_out = b2;
+    } else {/*(b2 >= 0) *//* (b1 == -1) */
+        *b_in  = b2;
+        *b_out = b1;
+    }
+}
+
+
 /* Derive coarse-scale block faces from fine-scale neighbour-ship
  * definition 'neighbours' ('nfinef' connections) and partition vector
- * 'p' (representing 'nblk' coarse blocks).  Inter-block faces keyed
- * off minimum block number if internal and valid block number if
- * external.
- *
- * Fine-scale constituents of each coarse face are computed if
- * 'expct_nconn' is positive, in which case 'expct_nconn' is
- * interpreted as the expected number of constituents in each coarse
- * face and used as an initial size of a hash_set.
+ * 'p' (representing 'nblk' coarse blocks), and count the number of
+ * fine-scale constituents of each coarse face.
  *
  * Return number of coarse faces if successful and -1 otherwise. */
 /* ---------------------------------------------------------------------- */
 static int
-derive_block_faces(int nfinef, int nblk, int expct_nconn,
+derive_block_faces(int nfinef, int nblk,
                    const int *p, const int *neighbours,
                    struct block_neighbours **bns)
 /* ---------------------------------------------------------------------- */
 {
-    int f, c1, b1, c2, b2, b_in, b_out;
+    int f, b, b_in, b_out;
     int ret;
 
     ret = 0;
     for (f = 0; (f < nfinef) && (0 <= ret); f++) {
-        c1 = neighbours[2*f + 0];   b1 = (c1 >= 0) ? p[c1] : -1;
-        c2 = neighbours[2*f + 1];   b2 = (c2 >= 0) ? p[c2] : -1;
-
-        assert ((b1 >= 0) || (b2 >= 0));
-
-        if ((b1 >= 0) && (b2 >= 0)) {
-            b_in  = MIN(b1, b2);
-            b_out = MAX(b1, b2);
-        } else if (b1 >= 0) { /* (b2 == -1) */
-            b_in  = b1;
-            b_out = b2;
-        } else {/*(b2 >= 0) *//* (b1 == -1) */
-            b_in  = b2;
-            b_out = b1;
-        }
+        face_blocks(f, p, neighbours, &b_in, &b_out);
 
         if (b_in != b_out) {
             /* Block boundary */
@@ -344,9 +282,7 @@ derive_block_faces(int nfinef, int nblk, int expct_nconn,
             }
 
             if (bns[b_in] != NULL) {
-                ret = block_neighbours_insert_neighbour(b_out, f,
-                                                        expct_nconn,
-                                                        bns[b_in]);
+                ret = block_neighbours_insert_neighbour(b_out, bns[b_in]);
             } else {
                 ret = -1;
             }
@@ -356,9 +292,9 @@ derive_block_faces(int nfinef, int nblk, int expct_nconn,
     if (ret >= 0) {
         ret = 0;
 
-        for (b1 = 0; b1 < nblk; b1++) {
-            if (bns[b1] != NULL) {
-                ret += bns[b1]->nneigh;
+        for (b = 0; b < nblk; b++) {
+            if (bns[b] != NULL) {
+                ret += bns[b]->nneigh;
             }
         }
     }
@@ -368,8 +304,9 @@ derive_block_faces(int nfinef, int nblk, int expct_nconn,
 
 
 /* Create coarse-scale neighbour-ship definition from block-to-block
- * connectivity information ('bns') keyed off block numbers.  Set
- * start pointers for CSR push-back build mode.
+ * connectivity information ('bns') keyed off block numbers.  Number
+ * the coarse faces and set start pointers for CSR push-back build
+ * mode.
  *
  * Cannot fail. */
 /* ---------------------------------------------------------------------- */
@@ -388,18 +325,18 @@ coarse_topology_build_coarsef(int nblk, struct block_neighbours **bns,
         if (bns[b] != NULL) {
             for (n = 0; n < bns[b]->nneigh; n++) {
                 neighbours[2*coarse_f + 0] = b;
-                neighbours[2*coarse_f + 1] = bns[b]->neigh[n]->b;
+                neighbours[2*coarse_f + 1] = bns[b]->neigh[n].b;
+
+                bns[b]->neigh[n].cf = coarse_f;
 
                 coarse_f          += 1;
                 blkfacepos[b + 1] += 1;
 
-                if (bns[b]->neigh[n]->b >= 0) {
-                    blkfacepos[bns[b]->neigh[n]->b + 1] += 1;
+                if (bns[b]->neigh[n].b >= 0) {
+                    blkfacepos[bns[b]->neigh[n].b + 1] += 1;
                 }
 
-                if (bns[b]->neigh[n]->fconns != NULL) {
-                    *nsubf += hash_set_count_elms(bns[b]->neigh[n]->fconns);
-                }
+                *nsubf += bns[b]->neigh[n].nfconn;
             }
         }
     }
@@ -414,29 +351,70 @@ coarse_topology_build_coarsef(int nblk, struct block_neighbours **bns,
 }
 
 
-/* Create coarse-scale block-to-face mapping and, if requested,
- * coarse-scale constituent faces for each coarse face.
+/* Create coarse-scale constituent faces for each coarse face from the
+ * constituent counts of 'bns'.  Every fine-scale face belongs to at
+ * most one coarse face, so the constituents are collected in a single
+ * pass over the fine-scale faces, in increasing order, without any
+ * duplicate detection.  Uses the standard CSR push-back strategy.
  *
- * Constituent faces requested if subfacepos and subfaces non-NULL.
- * In this case, all coarse faces must carry sub-face information.
+ * Cannot fail. */
+/* ---------------------------------------------------------------------- */
+static void
+coarse_topology_build_subfaces(int ncoarse_f, int nblk, int nfinef,
+                               const int *p, const int *fneighbours,
+                               struct block_neighbours **bns,
+                               int *subfacepos, int *subfaces)
+/* ---------------------------------------------------------------------- */
+{
+    int b, n, f, cf, b_in, b_out;
+
+    for (cf = 0; cf < ncoarse_f + 1; cf++) {
+        subfacepos[cf] = 0;
+    }
+
+    for (b = 0; b < nblk; b++) {
+        if (bns[b] != NULL) {
+            for (n = 0; n < bns[b]->nneigh; n++) {
+                subfacepos[bns[b]->neigh[n].cf + 1] = bns[b]->neigh[n].nfconn;
+            }
+        }
+    }
+
+    /* Derive start pointers */
+    for (cf = 1; cf <= ncoarse_f; cf++) {
+        subfacepos[0] += subfacepos[cf];
+        subfacepos[cf] = subfacepos[0] - subfacepos[cf];
+    }
+    subfacepos[0] = 0;
+
+    for (f = 0; f < nfinef; f++) {
+        face_blocks(f, p, fneighbours, &b_in, &b_out);
+
+        if (b_in != b_out) {
+            n = block_neighbours_find(b_out, bns[b_in]);
+
+            assert ((n < bns[b_in]->nneigh) &&
+                    (bns[b_in]->neigh[n].b == b_out));
+
+            cf = bns[b_in]->neigh[n].cf;
+
+            subfaces[subfacepos[cf + 1] ++] = f;
+        }
+    }
+}
+
+
+/* Create coarse-scale block-to-face mapping.
  *
- * Returns 1 if successful (i.e., no sub-face information requested or
- * sub-face information requested and available for all coarse faces)
- * and zero otherwise. */
+ * Cannot fail. */
 /* ---------------------------------------------------------------------- */
-static int
-coarse_topology_build_final(int ncoarse_f, int nblk,
+static void
+coarse_topology_build_final(int ncoarse_f,
                             const int *neighbours,
-                            int *blkfacepos, int *blkfaces,
-                            struct block_neighbours **bns,
-                            int *subfacepos, int *subfaces)
+                            int *blkfacepos, int *blkfaces)
 /* ---------------------------------------------------------------------- */
 {
-    int              coarse_f, b1, b2, n, subpos, subface_valid = 1;
-    size_t           i;
-    struct hash_set *set;
-
-    assert ((subfacepos == NULL) == (subfaces == NULL));
+    int coarse_f, b1, b2;
 
     for (coarse_f = 0; coarse_f < ncoarse_f; coarse_f++) {
         b1 = neighbours[2*coarse_f + 0];
@@ -447,34 +425,6 @@ coarse_topology_build_final(int ncoarse_f, int nblk,
         if (b1 >= 0) { blkfaces[blkfacepos[b1 + 1] ++] = coarse_f; }
         if (b2 >= 0) { blkfaces[blkfacepos[b2 + 1] ++] = coarse_f; }
     }
-
-    if (subfacepos != NULL) {
-        coarse_f = 0;
-        subpos   = 0;
-
-        for (b1 = 0; (b1 < nblk) && subface_valid; b1++) {
-            if (bns[b1] != NULL) {
-                for (n = 0; n < bns[b1]->nneigh; n++) {
-                    set = bns[b1]->neigh[n]->fconns;
-                    subface_valid = set != NULL;
-
-                    if (subface_valid) {
-                        for (i = 0; i < set->m; i++) {
-                            if (set->s[i] != -1) {
-                                subfaces[subpos ++] = set->s[i];
-                            }
-                        }
-                    } else {
-                        break;
-                    }
-
-                    subfacepos[++ coarse_f] = subpos;
-                }
-            }
-        }
-    }
-
-    return (subfacepos == NULL) || subface_valid;
 }
 
 
@@ -483,16 +433,20 @@ coarse_topology_build_final(int ncoarse_f, int nblk,
  * final coarse grid consists of 'ncoarse_f' coarse faces numbered
  * 0..ncoarse_f-1 and 'nblk' coarse blocks numbered 0..nblk-1.
  *
+ * Constituent faces are derived from the fine-scale neighbour-ship
+ * definition 'fneighbours' ('nfinef' connections) and partition
+ * vector 'p' if 'subf' is non-zero.
+ *
  * Returns fully assembled coarse-grid structure if successful or NULL
  * otherwise. */
 /* ---------------------------------------------------------------------- */
 static struct coarse_topology *
-coarse_topology_build(int ncoarse_f, int nblk,
+coarse_topology_build(int ncoarse_f, int nblk, int subf,
+                      int nfinef, const int *p, const int *fneighbours,
                       struct block_neighbours **bns)
 /* ---------------------------------------------------------------------- */
 {
     int                     i;
-    int                     subface_valid;
     size_t                  nblkf, nsubf;
     struct coarse_topology *new;
 
@@ -520,7 +474,7 @@ coarse_topology_build(int ncoarse_f, int nblk,
             coarse_topology_build_coarsef(nblk, bns, new->neighbours,
                                           new->blkfacepos, &nblkf, &nsubf);
 
-            if (nsubf > 0) {
+            if (subf && (nsubf > 0)) {
                 new->subfacepos = malloc((ncoarse_f + 1) * sizeof *new->subfacepos);
                 new->subfaces   = malloc(nsubf           * sizeof *new->subfaces);
 
@@ -528,9 +482,10 @@ coarse_topology_build(int ncoarse_f, int nblk,
                     free(new->subfaces);   new->subfaces   = NULL;
                     free(new->subfacepos); new->subfacepos = NULL;
                 } else {
-                    for (i = 0; i < ncoarse_f + 1; i++) {
-                        new->subfacepos[i] = 0;
-                    }
+                    coarse_topology_build_subfaces(ncoarse_f, nblk, nfinef,
+                                                   p, fneighbours, bns,
+                                                   new->subfacepos,
+                                                   new->subfaces);
                 }
             }
 
@@ -540,21 +495,12 @@ coarse_topology_build(int ncoarse_f, int nblk,
                 coarse_topology_destroy(new);
                 new = NULL;
             } else {
-                subface_valid = coarse_topology_build_final(ncoarse_f, nblk,
-                                                            new->neighbours,
-                                                            new->blkfacepos,
-                                                            new->blkfaces,
-                                                            bns,
-                                                            new->subfacepos,
-                                                            new->subfaces);
-
-                if (!subface_valid) {
-                    free(new->subfaces);   new->subfaces   = NULL;
-                    free(new->subfacepos); new->subfacepos = NULL;
-                } else {
-                    new->nblocks = nblk;
-                    new->nfaces  = ncoarse_f;
-                }
+                coarse_topology_build_final(ncoarse_f, new->neighbours,
+                                            new->blkfacepos,
+                                            new->blkfaces);
+
+                new->nblocks = nblk;
+                new->nfaces  = ncoarse_f;
             }
         }
     }
@@ -566,6 +512,10 @@ coarse_topology_build(int ncoarse_f, int nblk,
 /* Create coarse-grid topology structure from fine-scale
  * neighbour-ship definition 'neighbours' and partition vector 'p'.
  *
+ * Fine-scale constituents of each coarse face are computed if
+ * 'expct_nconn' is positive.  The constituents are counted before they
+ * are stored, so 'expct_nconn' is no longer used as a size estimate.
+ *
  * Returns fully allocated and assembled coarse-grid structure if
  * successful and NULL otherwise. */
 /* ---------------------------------------------------------------------- */
@@ -587,10 +537,14 @@ coarse_topology_create(int nc, int nf, int expct_nconn,
             bns[b] = NULL;
         }
 
-        ncoarse_f = derive_block_faces(nf, nblocks, expct_nconn,
-                                       p, neighbours, bns);
+        ncoarse_f = derive_block_faces(nf, nblocks, p, neighbours, bns);
 
-        topo = coarse_topology_build(ncoarse_f, nblocks, bns);
+        topo = NULL;
+        if (ncoarse_f >= 0) {
+            topo = coarse_topology_build(ncoarse_f, nblocks,
+                                         expct_nconn > 0,
+                                         nf, p, neighbours, bns);
+        }
 
         for (b = 0; b < nblocks; b++) {
             block_neighbours_deallocate(bns[b]);
@@ -25,6 +25,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #ifndef DEBUG_OUTPUT
 #define DEBUG_OUTPUT 0
@@ -71,7 +74,6 @@ struct coarse_sys_meta {
     int *blk_nhf;               /* Number of fs hfaces per block */
     int *blk_nfsf;              /* Number of fs faces per block */
 
-    int *loc_fno;               /* Local (fs) face numbering */
     int *ncf;                   /* diff(face_pos) */
     int *pconn2;                /* cumsum([0; diff(face_pos).^2]) */
 
@@ -85,8 +87,25 @@ struct coarse_sys_meta {
 };
 
 
+/* Fine-scale data shared by all basis function computations.  Read-only
+ * once constructed. */
+struct bf_fs_data {
+    struct coarse_sys_meta *m;  /* Coarse system meta data */
+
+    double        *Binv;        /* Mobility weighted fine-scale inv(B) */
+    double        *w;           /* BF weighting function */
+    double        *gpress;      /* BF gravity contrib. (== 0) */
+
+    struct hybsys *fsys;        /* Fine-scale Schur complement data */
+};
+
+
+/* Work space of a single basis function computation.  One instance per
+ * thread. */
 struct bf_asm_data {
-    struct hybsys *fsys;        /* Fine-scale hybrid system contributions */
+    struct hybsys fsys;         /* Fine-scale hybrid system contributions.
+                                 * Cell data (L, F1, F2) shared with
+                                 * bf_fs_data, all other arrays private. */
 
     struct CSRMatrix *A;        /* BF coefficient matrix */
     double           *b;        /* BF system RHS */
@@ -96,10 +115,9 @@ struct bf_asm_data {
     double           *p;        /* BF pressure. */
     double           *flux;     /* BF flux.  Symmetrised. */
 
-    double           *gpress;   /* BF gravity contrib. (== 0) */
-
     double           *work;     /* Back-substitution work array */
 
+    int              *loc_fno;  /* Local (fs) face numbering */
     int              *pdof;     /* Indirection pointer to linearised DOF */
     int              *dof;      /* Linearised DOFs per BF */
     int              *fcount;   /* Flux symmetrisation face count. */
@@ -130,8 +148,7 @@ coarse_sys_meta_destroy(struct coarse_sys_meta *m)
 
 /* ---------------------------------------------------------------------- */
 static struct coarse_sys_meta *
-coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c,
-                         size_t nc     , size_t nfaces_f)
+coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c, size_t nc)
 /* ---------------------------------------------------------------------- */
 {
     size_t                  i, alloc_sz;
@@ -144,7 +161,6 @@ coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c,
         alloc_sz += nblocks;     /* blk_nfsf */
         alloc_sz += nc;          /* ncf */
         alloc_sz += nc + 1;      /* pconn2 */
-        alloc_sz += nfaces_f;    /* loc_fno */
         alloc_sz += nblocks + 1; /* pb2c */
         alloc_sz += nc;          /* b2c */
         alloc_sz += nfaces_c;    /* bfno */
@@ -165,9 +181,8 @@ coarse_sys_meta_allocate(size_t nblocks, size_t nfaces_c,
             new->blk_nfsf  = new->blk_nhf   + nblocks;
             new->ncf       = new->blk_nfsf  + nblocks;
             new->pconn2    = new->ncf       + nc;
-            new->loc_fno   = new->pconn2    + nc + 1;
 
-            new->pb2c      = new->loc_fno   + nfaces_f;
+            new->pb2c      = new->pconn2    + nc + 1;
             new->b2c       = new->pb2c      + nblocks + 1;
 
             new->bfno      = new->b2c       + nc;
@@ -188,20 +203,24 @@ bf_asm_data_deallocate(struct bf_asm_data *data)
         free            (data->ddata);
         free            (data->idata);
         csrmatrix_delete(data->A);
-        hybsys_free     (data->fsys);
     }
 
     free(data);
 }
 
 
+/* Allocate work space for computing basis functions.  The fine-scale
+ * cell data of 'fsys' is shared, not copied.
+ *
+ * Returns fully allocated structure if successful and NULL if not. */
 /* ---------------------------------------------------------------------- */
 static struct bf_asm_data *
-bf_asm_data_allocate(struct UnstructuredGrid                 *g,
-                     struct coarse_sys_meta *m)
+bf_asm_data_allocate(struct UnstructuredGrid      *g,
+                     const struct coarse_sys_meta *m,
+                     const struct hybsys          *fsys)
 /* ---------------------------------------------------------------------- */
 {
-    int                 tot_ngconn;
+    size_t              i, nc, nf;
     size_t              max_nhf, max_cells, max_faces, nnz;
     size_t              alloc_sz;
     struct bf_asm_data *new;
@@ -214,15 +233,13 @@ bf_asm_data_allocate(struct UnstructuredGrid                 *g,
         max_faces = 2 * m->max_blk_nfsf;
         nnz       = 2 * m->max_blk_sum_nhf2;
 
-        tot_ngconn = g->cell_facepos[ g->number_of_cells ];
-
-        new->fsys = hybsys_allocate_symm((int) m->max_ngconn,
-                                         g->number_of_cells,
-                                         tot_ngconn);
+        nc = g->number_of_cells;
+        nf = g->number_of_faces;
 
         new->A = csrmatrix_new_known_nnz(max_faces, nnz);
 
-        alloc_sz   = max_cells + 1; /* pdof */
+        alloc_sz   = nf;            /* loc_fno */
+        alloc_sz  += max_cells + 1; /* pdof */
         alloc_sz  += max_nhf;       /* dof */
         alloc_sz  += max_faces;     /* fcount */
 
@@ -232,31 +249,44 @@ bf_asm_data_allocate(struct UnstructuredGrid                 *g,
         alloc_sz  += 1 * max_nhf;   /* v */
         alloc_sz  += 1 * max_cells; /* p */
         alloc_sz  += 1 * max_faces; /* flux */
-        alloc_sz  += tot_ngconn;    /* gpress */
         alloc_sz  += m->max_ngconn; /* work */
 
+        alloc_sz  += m->max_ngconn;                 /* fsys.r */
+        alloc_sz  += m->max_ngconn * m->max_ngconn; /* fsys.S */
+        alloc_sz  += nc;                            /* fsys.q */
+
         new->ddata = malloc(alloc_sz * sizeof *new->ddata);
 
-        if ((new->fsys  == NULL) || (new->A     == NULL) ||
+        if ((new->A     == NULL) ||
             (new->idata == NULL) || (new->ddata == NULL)) {
             bf_asm_data_deallocate(new);
             new = NULL;
         } else {
-            new->pdof   = new->idata;
-            new->dof    = new->pdof   + max_cells + 1;
-            new->fcount = new->dof    + max_nhf;
-
-            new->b      = new->ddata;
-            new->x      = new->b      + max_faces;
-            new->v      = new->x      + max_faces;
-            new->p      = new->v      + max_nhf;
-
-            new->flux   = new->p      + max_cells;
-
-            new->gpress = new->flux   + max_faces;
-            new->work   = new->gpress + tot_ngconn;
-
-            hybsys_init((int) m->max_ngconn, new->fsys);
+            new->loc_fno = new->idata;
+            new->pdof    = new->loc_fno + nf;
+            new->dof     = new->pdof    + max_cells + 1;
+            new->fcount  = new->dof     + max_nhf;
+
+            new->b       = new->ddata;
+            new->x       = new->b       + max_faces;
+            new->v       = new->x       + max_faces;
+            new->p       = new->v       + max_nhf;
+
+            new->flux    = new->p       + max_cells;
+            new->work    = new->flux    + max_faces;
+
+            new->fsys.r  = new->work    + m->max_ngconn;
+            new->fsys.S  = new->fsys.r  + m->max_ngconn;
+            new->fsys.q  = new->fsys.S  + m->max_ngconn * m->max_ngconn;
+
+            new->fsys.L   = fsys->L;
+            new->fsys.F1  = fsys->F1;
+            new->fsys.F2  = fsys->F2;
+            new->fsys.one = fsys->one;
+
+            for (i = 0; i < nf; i++) {
+                new->loc_fno[i] = -1;
+            }
         }
     }
 
@@ -412,10 +442,6 @@ coarse_sys_meta_fill(int nc, const int *pgconn,
         }
     }
 
-    for (f = 0; f < nneigh; f++) {
-        m->loc_fno[f] = -1;
-    }
-
     m->max_cf_nf = 0;
 
     for (f = 0; f < (size_t) ct->nfaces; f++) {
@@ -471,7 +497,7 @@ coarse_sys_meta_construct(struct UnstructuredGrid *g, const int *p,
     struct coarse_sys_meta *m;
 
     m = coarse_sys_meta_allocate(ct->nblocks, ct->nfaces,
-                                 g->number_of_cells, g->number_of_faces);
+                                 g->number_of_cells);
 
     if (m != NULL) {
         coarse_sys_meta_fill(g->number_of_cells,
@@ -924,15 +950,16 @@ set_csys_block_pointers(struct coarse_topology *ct,
 /* Create local numbering of the fine-scale faces contained in a pair
  * of blocks denoted by 'cf'.
  *
- * Precondition: m->loc_fno[0 .. g->number_of_faces-1] < 0
+ * Precondition: bf_asm->loc_fno[0 .. g->number_of_faces-1] < 0
  *
  * Returns the number of local fine-scale faces. */
 /* ---------------------------------------------------------------------- */
 static int
-enumerate_local_dofs(size_t                  cf,
-                     struct UnstructuredGrid                 *g ,
-                     struct coarse_topology *ct,
-                     struct coarse_sys_meta *m)
+enumerate_local_dofs(size_t                        cf,
+                     struct UnstructuredGrid      *g ,
+                     struct coarse_topology       *ct,
+                     const struct coarse_sys_meta *m ,
+                     struct bf_asm_data           *bf_asm)
 /* ---------------------------------------------------------------------- */
 {
     int *b, *c, i, f, loc_no;
@@ -951,8 +978,8 @@ enumerate_local_dofs(size_t                  cf,
 
                     f = g->cell_faces[i];
 
-                    if (m->loc_fno[f] < 0) {
-                        m->loc_fno[f] = loc_no++;
+                    if (bf_asm->loc_fno[f] < 0) {
+                        bf_asm->loc_fno[f] = loc_no++;
                     }
                 }
             }
@@ -973,10 +1000,11 @@ enumerate_local_dofs(size_t                  cf,
  * basis function. */
 /* ---------------------------------------------------------------------- */
 static void
-unenumerate_local_dofs(size_t                  cf,
-                       struct UnstructuredGrid                 *g ,
-                       struct coarse_topology *ct,
-                       struct coarse_sys_meta *m)
+unenumerate_local_dofs(size_t                        cf,
+                       struct UnstructuredGrid      *g ,
+                       struct coarse_topology       *ct,
+                       const struct coarse_sys_meta *m ,
+                       struct bf_asm_data           *bf_asm)
 /* ---------------------------------------------------------------------- */
 {
     int *b, *c, i;
@@ -990,7 +1018,7 @@ unenumerate_local_dofs(size_t                  cf,
                 for (i = g->cell_facepos[*c + 0];
                      i < g->cell_facepos[*c + 1]; i++) {
 
-                    m->loc_fno[ g->cell_faces[i] ] = -1;
+                    bf_asm->loc_fno[ g->cell_faces[i] ] = -1;
                 }
             }
         }
@@ -1001,17 +1029,17 @@ unenumerate_local_dofs(size_t                  cf,
 /* ---------------------------------------------------------------------- */
 /* Define local (to a single BF) pdof/dof CSR table.
  *
- * Precondition: m->loc_fno valid for BF (i.e., called after
+ * Precondition: bf_asm->loc_fno valid for BF (i.e., called after
  * enumerate_local_dofs()).
  *
  * Does not fail. */
 /* ---------------------------------------------------------------------- */
 static void
-linearise_local_dof(size_t                  cf,
-                    struct UnstructuredGrid                 *g ,
-                    struct coarse_topology *ct,
-                    struct coarse_sys_meta *m ,
-                    struct bf_asm_data     *bf_asm)
+linearise_local_dof(size_t                        cf,
+                    struct UnstructuredGrid      *g ,
+                    struct coarse_topology       *ct,
+                    const struct coarse_sys_meta *m ,
+                    struct bf_asm_data           *bf_asm)
 /* ---------------------------------------------------------------------- */
 {
     int *b, *c, i;
@@ -1030,7 +1058,7 @@ linearise_local_dof(size_t                  cf,
 
                 for (i = g->cell_facepos[*c + 0];
                      i < g->cell_facepos[*c + 1]; i++) {
-                    *dof++ = m->loc_fno[ g->cell_faces[i] ];
+                    *dof++ = bf_asm->loc_fno[ g->cell_faces[i] ];
                 }
 
                 *++pdof = dof - bf_asm->dof;
@@ -1119,28 +1147,28 @@ define_csr_sparsity(size_t nc, size_t m, struct bf_asm_data *bf_asm)
 /* Assemble system of linear equations corresponding to local
  * discretisation of flow problem on domain connected to coarse face
  * 'cf'.  The domain has a total of 'nlocf' fine-scale interfaces, and
- * the BF weighting function 'w' is pre-calculated using function
+ * the BF weighting function 'fs->w' is pre-calculated using function
  * coarse_weight().
  *
  * Does not fail. */
 /* ---------------------------------------------------------------------- */
 static void
-assemble_local_system(size_t                  cf   ,
-                      size_t                  nlocf,
-                      struct UnstructuredGrid                 *g    ,
-                      const double           *Binv ,
-                      double                 *w    ,
-                      struct coarse_topology *ct   ,
-                      struct coarse_sys_meta *m    ,
-                      struct bf_asm_data     *bf_asm)
+assemble_local_system(size_t                        cf   ,
+                      size_t                        nlocf,
+                      struct UnstructuredGrid      *g    ,
+                      const struct bf_fs_data      *fs   ,
+                      struct coarse_topology       *ct   ,
+                      struct bf_asm_data           *bf_asm)
 /* ---------------------------------------------------------------------- */
 {
-    int    c, i, p1, p2, ndof;
+    int    c, i, j, p1, p2, ndof;
     int    *b, *dof;
     size_t nc;
 
     double sgn;
 
+    const struct coarse_sys_meta *m = fs->m;
+
     linearise_local_dof(cf, g, ct, m, bf_asm);
 
     nc = 0;
@@ -1168,17 +1196,24 @@ assemble_local_system(size_t                  cf   ,
                 p2   = m->pconn2[c];
                 ndof = g->cell_facepos[c + 1] - p1;
 
-                w[c] *= sgn;    /* Set w-sign according to source/sink */
+                hybsys_cellcontrib_symm(c, ndof, p1, p2, fs->gpress,
+                                        fs->w, fs->Binv, &bf_asm->fsys);
 
-                hybsys_cellcontrib_symm(c, ndof, p1, p2, bf_asm->gpress,
-                                        w, Binv, bf_asm->fsys);
+                /* Set sign according to source/sink.  The cell
+                 * contributions are linear in the source term when
+                 * gravity is excluded, so 'w' itself stays untouched
+                 * and may be shared between concurrent BFs. */
+                if (sgn < 0.0) {
+                    for (j = 0; j < ndof; j++) {
+                        bf_asm->fsys.r[j] = - bf_asm->fsys.r[j];
+                    }
+                    bf_asm->fsys.q[c] = - bf_asm->fsys.q[c];
+                }
 
-                hybsys_global_assemble_cell(ndof, dof, bf_asm->fsys->S,
-                                            bf_asm->fsys->r, bf_asm->A,
+                hybsys_global_assemble_cell(ndof, dof, bf_asm->fsys.S,
+                                            bf_asm->fsys.r, bf_asm->A,
                                             bf_asm->b);
 
-                w[c] *= sgn;    /* Restore original weighting sign */
-
                 dof += ndof;
             }
 
@@ -1197,14 +1232,14 @@ assemble_local_system(size_t                  cf   ,
  * effects in the resulting BFs. */
 /* ---------------------------------------------------------------------- */
 static void
-Binv_scale_mobility(int nc, struct coarse_sys_meta *m,
+Binv_scale_mobility(int nc, const struct coarse_sys_meta *m,
                     const double *totmob, double *Binv)
 /* ---------------------------------------------------------------------- */
 {
     int c, i;
 
     for (c = i = 0; c < nc; c++) {
-        for (; i < m->pconn2[c]; i++) {
+        for (; i < m->pconn2[c + 1]; i++) {
             Binv[i] *= totmob[c];
         }
     }
@@ -1217,7 +1252,7 @@ Binv_scale_mobility(int nc, struct coarse_sys_meta *m,
 /* ---------------------------------------------------------------------- */
 static void
 symmetrise_flux(size_t cf, struct UnstructuredGrid *g, struct coarse_topology *ct,
-                struct coarse_sys_meta *m, struct bf_asm_data *bf_asm)
+                const struct coarse_sys_meta *m, struct bf_asm_data *bf_asm)
 /* ---------------------------------------------------------------------- */
 {
     int    i, j, ndof, p1l, p1g, *b, *c, *dof, *cnt;
@@ -1306,13 +1341,13 @@ symmetrise_flux(size_t cf, struct UnstructuredGrid *g, struct coarse_topology *c
  * Does not fail. */
 /* ---------------------------------------------------------------------- */
 static void
-solve_local_system(size_t                  cf    ,
-                   struct UnstructuredGrid                 *g     ,
-                   const  double          *Binv  ,
-                   struct coarse_topology *ct    ,
-                   struct coarse_sys_meta *m     ,
-                   struct bf_asm_data     *bf_asm,
-                   LocalSolver            linsolve)
+solve_local_system(size_t                        cf    ,
+                   struct UnstructuredGrid      *g     ,
+                   const  double                *Binv  ,
+                   struct coarse_topology       *ct    ,
+                   const struct coarse_sys_meta *m     ,
+                   struct bf_asm_data           *bf_asm,
+                   LocalSolver                   linsolve)
 /* ---------------------------------------------------------------------- */
 {
     int    i, j, ndof, p1l, p1g, *b, *c;
@@ -1347,10 +1382,10 @@ solve_local_system(size_t                  cf    ,
 
                 p1g = g->cell_facepos[*c];
 
-                bf_asm->p[i]  = bf_asm->fsys->q[*c];
-                bf_asm->p[i] += ddot_(&nrows, &bf_asm->fsys->F2[p1g],
+                bf_asm->p[i]  = bf_asm->fsys.q[*c];
+                bf_asm->p[i] += ddot_(&nrows, &bf_asm->fsys.F2[p1g],
                                       &incx, bf_asm->work, &incy);
-                bf_asm->p[i] /= bf_asm->fsys->L[*c];
+                bf_asm->p[i] /= bf_asm->fsys.L[*c];
 
                 for (j = 0; j < ndof; j++) {
                     bf_asm->work[j] = bf_asm->p[i] - bf_asm->work[j];
@@ -1375,11 +1410,11 @@ solve_local_system(size_t                  cf    ,
  * Does not fail. */
 /* ---------------------------------------------------------------------- */
 static void
-store_basis_function(size_t                  cf    ,
-                     struct coarse_topology *ct    ,
-                     struct coarse_sys_meta *m     ,
-                     struct bf_asm_data     *bf_asm,
-                     struct coarse_sys      *sys)
+store_basis_function(size_t                        cf    ,
+                     struct coarse_topology       *ct    ,
+                     const struct coarse_sys_meta *m     ,
+                     struct bf_asm_data           *bf_asm,
+                     struct coarse_sys            *sys)
 /* ---------------------------------------------------------------------- */
 {
     int       i, loc_dofno, *b, *loc_dof;
@@ -1406,6 +1441,239 @@ store_basis_function(size_t                  cf    ,
 }
 
 
+/* ---------------------------------------------------------------------- */
+static void
+bf_fs_data_destroy(struct bf_fs_data *fs)
+/* ---------------------------------------------------------------------- */
+{
+    if (fs != NULL) {
+        hybsys_free(fs->fsys);
+
+        free(fs->gpress);
+        free(fs->w);
+        free(fs->Binv);
+
+        coarse_sys_meta_destroy(fs->m);
+    }
+
+    free(fs);
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Compute fine-scale quantities needed to define basis functions: Meta
+ * data, mobility weighted fine-scale inner products, BF weighting
+ * function, and fine-scale Schur complement reduction.
+ *
+ * Returns fully constructed structure if successful and NULL if not. */
+/* ---------------------------------------------------------------------- */
+static struct bf_fs_data *
+bf_fs_data_construct(struct UnstructuredGrid *g, const int   *p,
+                     struct coarse_topology *ct,
+                     const double           *perm,
+                     const double           *src,
+                     const double           *totmob)
+/* ---------------------------------------------------------------------- */
+{
+    int                ok;
+    size_t             nconn_tot;
+    struct bf_fs_data *new;
+
+    new = malloc(1 * sizeof *new);
+
+    if (new != NULL) {
+        new->Binv = NULL;  new->w = NULL;  new->gpress = NULL;
+        new->fsys = NULL;
+
+        new->m = coarse_sys_meta_construct(g, p, ct);
+        ok     = new->m != NULL;
+
+        if (ok) {
+            nconn_tot   = g->cell_facepos[ g->number_of_cells ];
+
+            new->Binv   = compute_fs_ip(g, perm, new->m);
+            new->w      = coarse_weight(g, ct->nblocks, p, new->m,
+                                        perm, src);
+            new->gpress = malloc(nconn_tot * sizeof *new->gpress);
+            new->fsys   = hybsys_allocate_symm((int) new->m->max_ngconn,
+                                               g->number_of_cells,
+                                               (int) nconn_tot);
+
+            ok = (new->Binv   != NULL) && (new->w    != NULL) &&
+                 (new->gpress != NULL) && (new->fsys != NULL);
+        }
+
+        if (! ok) {
+            bf_fs_data_destroy(new);
+            new = NULL;
+        } else {
+            /* Exclude effects of gravity */
+            vector_zero(nconn_tot, new->gpress);
+
+            /* Include mobility effects (multiple phases) */
+            Binv_scale_mobility(g->number_of_cells, new->m, totmob,
+                                new->Binv);
+
+            /* Discretise flow equation on fine scale */
+            hybsys_init((int) new->m->max_ngconn, new->fsys);
+            hybsys_schur_comp_symm(g->number_of_cells, g->cell_facepos,
+                                   new->Binv, new->fsys);
+        }
+    }
+
+    return new;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Compute the basis functions of the 'nbf' coarse faces 'cfs' and store
+ * them in 'sys'.  The local problems are independent.  If 'concurrent'
+ * is non-zero they are distributed across the available (OpenMP)
+ * threads, each of which uses its own work space.  In that case
+ * 'linsolve' is called concurrently on different systems.
+ *
+ * Returns one (1) if successful and zero (0) if work space allocation
+ * fails.  No basis function is modified on failure. */
+/* ---------------------------------------------------------------------- */
+static int
+compute_basis_functions(int                      nbf,
+                        const int               *cfs,
+                        struct UnstructuredGrid *g,
+                        struct coarse_topology  *ct,
+                        const struct bf_fs_data *fs,
+                        int                      concurrent,
+                        LocalSolver              linsolve,
+                        struct coarse_sys       *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int                  i, t, nthr, ok;
+    struct bf_asm_data **bf_asm;
+
+    nthr = 1;
+#if defined(_OPENMP)
+    if (concurrent && (nbf > 1)) {
+        nthr = omp_get_max_threads();
+        nthr = (nthr < nbf) ? nthr : nbf;
+    }
+#else
+    (void) concurrent;
+#endif
+
+    ok     = 0;
+    bf_asm = malloc(nthr * sizeof *bf_asm);
+
+    if (bf_asm != NULL) {
+        for (t = 0; t < nthr; t++) { bf_asm[t] = NULL; }
+
+        for (t = 0, ok = 1; ok && (t < nthr); t++) {
+            bf_asm[t] = bf_asm_data_allocate(g, fs->m, fs->fsys);
+            ok        = bf_asm[t] != NULL;
+        }
+    }
+
+    if (ok) {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nthr) schedule(dynamic, 1)
+#endif
+        for (i = 0; i < nbf; i++) {
+            int                 cf;
+            size_t              nlocf;
+            struct bf_asm_data *a;
+
+#if defined(_OPENMP)
+            a  = bf_asm[ omp_get_thread_num() ];
+#else
+            a  = bf_asm[ 0 ];
+#endif
+            cf = cfs[i];
+
+            nlocf = enumerate_local_dofs(cf, g, ct, fs->m, a);
+
+            assemble_local_system(cf, nlocf, g, fs, ct, a);
+
+            solve_local_system(cf, g, fs->Binv, ct, fs->m, a, linsolve);
+
+            store_basis_function(cf, ct, fs->m, a, sys);
+
+            unenumerate_local_dofs(cf, g, ct, fs->m, a);
+        }
+    }
+
+    if (bf_asm != NULL) {
+        for (t = 0; t < nthr; t++) {
+            bf_asm_data_deallocate(bf_asm[t]);
+        }
+    }
+
+    free(bf_asm);
+
+    return ok;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static struct coarse_sys *
+coarse_sys_construct_impl(struct UnstructuredGrid *g, const int   *p,
+                          struct coarse_topology *ct,
+                          const double           *perm,
+                          const double           *src,
+                          const double           *totmob,
+                          int                     concurrent,
+                          LocalSolver             linsolve)
+/* ---------------------------------------------------------------------- */
+{
+    int                ok, cf, nbf, *cfs;
+    struct bf_fs_data *fs;
+    struct coarse_sys *sys;
+
+    sys = NULL;  cfs = NULL;
+
+    fs = bf_fs_data_construct(g, p, ct, perm, src, totmob);
+
+    if (fs != NULL) {
+        sys = coarse_sys_allocate(ct, fs->m);
+        cfs = malloc(MAX(fs->m->n_act_bf, 1) * sizeof *cfs);
+    }
+
+    ok = (sys != NULL) && (cfs != NULL);
+
+    if (ok) {
+        /* Provide reverse BF->face mapping for fs flux reconstruction */
+        map_dof_to_conn(ct, fs->m, sys);
+
+        /* Prepare storage tables */
+        set_csys_block_pointers(ct, fs->m, sys);
+
+        for (cf = nbf = 0; cf < ct->nfaces; cf++) {
+            if (fs->m->bfno[cf] >= 0) {
+                cfs[nbf++] = cf;
+            }
+        }
+
+        ok = compute_basis_functions(nbf, cfs, g, ct, fs,
+                                     concurrent, linsolve, sys);
+    }
+
+    if (ok) {
+        coarse_sys_compute_cell_ip(g->number_of_cells,
+                                   fs->m->max_ngconn,
+                                   ct->nblocks,
+                                   g->cell_facepos,
+                                   fs->Binv,
+                                   fs->m->pb2c, fs->m->b2c,
+                                   sys);
+    } else {
+        coarse_sys_destroy(sys);
+        sys = NULL;
+    }
+
+    free(cfs);
+    bf_fs_data_destroy(fs);
+
+    return sys;
+}
+
+
 /* ======================================================================
  * Public interfaces below.
  * ====================================================================== */
@@ -1432,74 +1700,119 @@ coarse_sys_construct(struct UnstructuredGrid *g, const int   *p,
                      LocalSolver             linsolve)
 /* ---------------------------------------------------------------------- */
 {
-    int                     cf;
-    size_t                  nlocf;
-    double                 *Binv, *w;
-    struct coarse_sys_meta *m;
-    struct bf_asm_data     *bf_asm;
-    struct coarse_sys      *sys;
-
-    sys = NULL;  bf_asm = NULL;  Binv = NULL;  w = NULL;
-
-    m = coarse_sys_meta_construct(g, p, ct);
-
-    if (m != NULL) {
-        Binv   = compute_fs_ip(g, perm, m);
-        w      = coarse_weight(g, ct->nblocks, p, m, perm, src);
-        bf_asm = bf_asm_data_allocate(g, m);
-        sys    = coarse_sys_allocate(ct, m);
-    }
+    return coarse_sys_construct_impl(g, p, ct, perm, src, totmob,
+                                     0, linsolve);
+}
 
-    if ((Binv != NULL) && (w != NULL) &&
-        (bf_asm != NULL) && (sys != NULL)) {
 
-        /* Provide reverse BF->face mapping for fs flux reconstruction */
-        map_dof_to_conn(ct, m, sys);
-
-        /* Prepare storage tables */
-        set_csys_block_pointers(ct, m, sys);
+/* ---------------------------------------------------------------------- */
+/* As coarse_sys_construct(), but solve the local problems of distinct
+ * coarse faces concurrently in OpenMP builds.  Each thread assembles its
+ * local systems in private work space, so 'linsolve' may be called from
+ * several threads at once and must be reentrant.  The result is the
+ * same as that of coarse_sys_construct(). */
+/* ---------------------------------------------------------------------- */
+struct coarse_sys *
+coarse_sys_construct_concurrent(struct UnstructuredGrid *g, const int   *p,
+                                struct coarse_topology *ct,
+                                const double           *perm,
+                                const double           *src,
+                                const double           *totmob,
+                                LocalSolver             linsolve)
+/* ---------------------------------------------------------------------- */
+{
+    return coarse_sys_construct_impl(g, p, ct, perm, src, totmob,
+                                     1, linsolve);
+}
 
-        /* Exclude effects of gravity */
-        vector_zero(g->cell_facepos[ g->number_of_cells ], bf_asm->gpress);
 
-        /* Include mobility effects (multiple phases) */
-        Binv_scale_mobility(g->number_of_cells, m, totmob, Binv);
+/* ---------------------------------------------------------------------- */
+/* Update the basis functions of a coarse system constructed from the
+ * same grid (g), partition (p), and coarse topology (ct) to a new total
+ * mobility field (totmob).
+ *
+ * A block is considered changed if the total mobility of any of its
+ * cells differs from the reference value 'mobref' by more than
+ * 'tol*mobref'.  Only the basis functions of coarse faces adjacent to a
+ * changed block are recomputed, after which 'mobref' is reset to
+ * 'totmob' in the cells of all changed blocks.  Initialise 'mobref' to
+ * the mobility used to construct 'sys'.  The local problems are solved
+ * concurrently if 'concurrent' is non-zero, subject to the same
+ * requirements on 'linsolve' as in coarse_sys_construct_concurrent().
+ *
+ * Returns the number of recomputed basis functions if successful, and
+ * -1 if internal allocations fail.  Neither 'sys' nor 'mobref' is
+ * modified on failure. */
+/* ---------------------------------------------------------------------- */
+int
+coarse_sys_update_basis(struct UnstructuredGrid *g, const int   *p,
+                        struct coarse_topology *ct,
+                        const double           *perm,
+                        const double           *src,
+                        const double           *totmob,
+                        double                  tol,
+                        double                 *mobref,
+                        int                     concurrent,
+                        LocalSolver             linsolve,
+                        struct coarse_sys      *sys)
+/* ---------------------------------------------------------------------- */
+{
+    int                c, b, cf, nbf, *changed, *cfs;
+    struct bf_fs_data *fs;
 
-        /* Discretise flow equation on fine scale */
-        hybsys_schur_comp_symm(g->number_of_cells, g->cell_facepos,
-                               Binv, bf_asm->fsys);
+    nbf     = -1;
+    fs      = NULL;
+    changed = malloc(ct->nblocks          * sizeof *changed);
+    cfs     = malloc(MAX(ct->nfaces, 1) * sizeof *cfs);
 
-        for (cf = 0; cf < ct->nfaces; cf++) {
-            if (m->bfno[cf] >= 0) {
-                nlocf = enumerate_local_dofs(cf, g, ct, m);
+    if ((changed != NULL) && (cfs != NULL)) {
+        for (b = 0; b < ct->nblocks; b++) { changed[b] = 0; }
 
-                assemble_local_system(cf, nlocf, g, Binv, w,
-                                      ct, m, bf_asm);
+        for (c = 0; c < g->number_of_cells; c++) {
+            if (fabs(totmob[c] - mobref[c]) > tol * fabs(mobref[c])) {
+                changed[p[c]] = 1;
+            }
+        }
 
-                solve_local_system(cf, g, Binv, ct, m,
-                                   bf_asm, linsolve);
+        for (cf = nbf = 0; cf < ct->nfaces; cf++) {
+            /* Active BFs are those of internal coarse faces */
+            if ((ct->neighbours[2*cf + 0] >= 0) &&
+                (ct->neighbours[2*cf + 1] >= 0) &&
+                (changed[ct->neighbours[2*cf + 0]] ||
+                 changed[ct->neighbours[2*cf + 1]])) {
+                cfs[nbf++] = cf;
+            }
+        }
 
-                store_basis_function(cf, ct, m, bf_asm, sys);
+        if (nbf > 0) {
+            fs = bf_fs_data_construct(g, p, ct, perm, src, totmob);
 
-                unenumerate_local_dofs(cf, g, ct, m);
+            if ((fs == NULL) ||
+                ! compute_basis_functions(nbf, cfs, g, ct, fs,
+                                          concurrent, linsolve, sys)) {
+                nbf = -1;
             }
         }
 
-        coarse_sys_compute_cell_ip(g->number_of_cells,
-                                   m->max_ngconn,
-                                   ct->nblocks,
-                                   g->cell_facepos,
-                                   Binv,
-                                   m->pb2c, m->b2c,
-                                   sys);
+        if (nbf > 0) {
+            coarse_sys_compute_cell_ip(g->number_of_cells,
+                                       fs->m->max_ngconn,
+                                       ct->nblocks,
+                                       g->cell_facepos,
+                                       fs->Binv,
+                                       fs->m->pb2c, fs->m->b2c,
+                                       sys);
+
+            for (c = 0; c < g->number_of_cells; c++) {
+                if (changed[p[c]]) { mobref[c] = totmob[c]; }
+            }
+        }
     }
 
-    bf_asm_data_deallocate(bf_asm);
+    bf_fs_data_destroy(fs);
+    free(cfs);  free(changed);
 
-    free(w);    free(Binv);
-    coarse_sys_meta_destroy(m);
-
-    return sys;
+    return nbf;
 }
 
 
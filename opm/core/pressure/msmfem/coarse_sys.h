@@ -46,6 +46,10 @@ struct coarse_sys {
 struct coarse_topology;
 struct CSRMatrix;
 
+/* Solve A*x = b for a single local (basis function) problem.  Must be
+ * reentrant when used with coarse_sys_construct_concurrent() or a
+ * concurrent coarse_sys_update_basis(), as it is then called from
+ * several threads at once on distinct systems. */
 typedef void (*LocalSolver)(struct CSRMatrix *A,
                             double           *b,
                             double           *x);
@@ -58,6 +62,26 @@ coarse_sys_construct(struct UnstructuredGrid *g, const int   *p,
                      const double           *totmob,
                      LocalSolver             linsolve);
 
+struct coarse_sys *
+coarse_sys_construct_concurrent(struct UnstructuredGrid *g, const int   *p,
+                                struct coarse_topology *ct,
+                                const double           *perm,
+                                const double           *src,
+                                const double           *totmob,
+                                LocalSolver             linsolve);
+
+int
+coarse_sys_update_basis(struct UnstructuredGrid *g, const int   *p,
+                        struct coarse_topology *ct,
+                        const double           *perm,
+                        const double           *src,
+                        const double           *totmob,
+                        double                  tol,
+                        double                 *mobref,
+                        int                     concurrent,
+                        LocalSolver             linsolve,
+                        struct coarse_sys      *sys);
+
 void
 coarse_sys_destroy(struct coarse_sys *sys);
 
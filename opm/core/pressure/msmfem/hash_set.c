@@ -16,11 +16,9 @@
   You should have received a copy of the GNU General Public License
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
-
 #include "config.h"
 #include <assert.h>
 #include <limits.h>
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -29,12 +27,12 @@
 /* ======================================================================
  * Macros
  * ====================================================================== */
-#define GOLDEN_RAT (0.6180339887498949)              /* (sqrt(5) - 1) / 2 */
 #define IS_POW2(x) (((x) & ((x) - 1)) == 0)
 #define MAX(a,b)   (((a) > (b)) ? (a) : (b))
 
 
-/* Define a hash array size (1<<p) capable of holding a set of size 'm' */
+/* Define a hash array size (1<<p) capable of holding 'm' elements at a
+ * load factor of at most one half. */
 /* ---------------------------------------------------------------------- */
 static size_t
 hash_set_size(size_t m)
@@ -42,9 +40,7 @@ hash_set_size(size_t m)
 {
     size_t i;
 
-    if (m == 0) {
-        return 1;
-    }
+    m = 2 * MAX(m, 1);
 
     if (IS_POW2(m)) {
         return m;
@@ -66,82 +62,86 @@ hash_set_size(size_t m)
 }
 
 
-/* Hash element 'k' into table of size 'm' (multiplication method) */
+/* Hash element 'k' into table of size 'm' (integer mixing, then
+ * masking).  Consecutive keys, typical of face numbers, are scattered
+ * across the table. */
 /* ---------------------------------------------------------------------- */
 static size_t
 hash_set_idx(int k, size_t m)
 /* ---------------------------------------------------------------------- */
 {
-    double x = fmod(k * GOLDEN_RAT, 1.0);
-    double y = floor(m * x);
-    return y;
+    unsigned long h;
+
+    h  = (unsigned long) k;
+    h ^= h >> 16;
+    h  = (h * 0x45d9f3bUL) & 0xffffffffUL;
+    h ^= h >> 16;
+
+    return h & (m - 1);
 }
 
 
-/* Insert element 'k' into set 's' of size 'm'
- * (open addressing, double probing). */
+/* Insert element 'k' into set 's' of size 'm' (open addressing,
+ * linear probing).  The table must contain at least one free slot.
+ *
+ * Returns one (1) if 'k' was inserted and zero (0) if already
+ * present. */
 /* ---------------------------------------------------------------------- */
-static size_t
+static int
 hash_set_insert_core(int k, size_t m, int *s)
 /* ---------------------------------------------------------------------- */
 {
-    size_t h1, h2, i, j;
+    size_t j;
 
-    assert ((0 < m) && (m < (size_t)(-1)));
     assert (IS_POW2(m));
 
-    j = h1 = hash_set_idx(k, m);
-    assert (h1 < m);
-
-    if (s[j] == -1) { s[j] = k; }
-    if (s[j] ==  k) { return j; }
-
-    /* Double hash probing.  h2 relatively prime to 'm' */
-    h2 = 2 * hash_set_idx(k, MAX(m >> 1, 1)) + 1;
-
-    for (i = 1; (s[j] != -1) && (s[j] != k) && (i < m); i++) {
-        j += h2;
-        j &= m - 1;             /* Modulo m since IS_POW2(m). */
+    for (j = hash_set_idx(k, m); (s[j] != -1) && (s[j] != k);
+         j = (j + 1) & (m - 1)) {
+        ;
     }
 
-    if ((s[j] == -1) || (s[j] == k)) {
-        s[j] = k;               /* Possibly no-op. */
-    } else {
-        j = m + 1;              /* Invalid.  Caveat emptor. */
+    if (s[j] == k) {
+        return 0;
     }
 
-    return j;
+    s[j] = k;
+
+    return 1;
 }
 
 
 /* Increase size of hash set 't' to hold 'm' elements whilst copying
- * existing elements.  This is typically fairly expensive. */
+ * existing elements.  This is typically fairly expensive.
+ *
+ * Returns new table size if successful and -1 otherwise. */
 /* ---------------------------------------------------------------------- */
 static int
 hash_set_expand(size_t m, struct hash_set *t)
 /* ---------------------------------------------------------------------- */
 {
     int ret, *s, *p;
-    size_t i;
+    size_t i, sz;
 
-    assert (m > t->m);
+    sz = hash_set_size(m);
+    assert (sz > t->m);
 
-    s = malloc(m * sizeof *s);
+    s = malloc(sz * sizeof *s);
     if (s != NULL) {
-        for (i = 0; i < m; i++) { s[i] = -1; }
+        for (i = 0; i < sz; i++) { s[i] = -1; }
 
         for (i = 0; i < t->m; i++) {
-            ret = hash_set_insert_core(t->s[i], m, s);
-            assert ((size_t) ret < m);
+            if (t->s[i] != -1) {
+                hash_set_insert_core(t->s[i], sz, s);
+            }
         }
 
         p    = t->s;
         t->s = s;
-        t->m = m;
+        t->m = sz;
 
         free(p);
 
-        ret = m;
+        ret = sz;
     } else {
         ret = -1;
     }
@@ -164,7 +164,8 @@ hash_set_deallocate(struct hash_set *t)
 }
 
 
-/* Construct an emtpy hash set capable of holding 'm' elements */
+/* Construct an emtpy hash set capable of holding 'm' elements without
+ * rehashing. */
 /* ---------------------------------------------------------------------- */
 struct hash_set *
 hash_set_allocate(int m)
@@ -175,7 +176,7 @@ hash_set_allocate(int m)
 
     new = malloc(1 * sizeof *new);
     if (new != NULL) {
-        sz = hash_set_size(m);
+        sz = hash_set_size(MAX(m, 0));
         new->s = malloc(sz * sizeof *new->s);
 
         if (new->s == NULL) {
@@ -185,6 +186,7 @@ hash_set_allocate(int m)
         } else {
             for (i = 0; i < sz; i++) { new->s[i] = -1; }
             new->m = sz;
+            new->n = 0;
         }
     }
 
@@ -199,43 +201,60 @@ hash_set_insert(int k, struct hash_set *t)
 /* ---------------------------------------------------------------------- */
 {
     int ret;
-    size_t i;
 
     assert (k >= 0);
     assert (t != NULL);
     assert (IS_POW2(t->m));
 
-    i = hash_set_insert_core(k, t->m, t->s);
-    if (i == t->m + 1) {
-        /* Table full.  Preferable an infrequent occurrence.  Expand
-         * table and re-insert key (if possible). */
-        ret = hash_set_expand(t->m << 1, t);
-
-        if (ret > 0) {
-            i = hash_set_insert_core(k, t->m, t->s);
-            assert (i < t->m);
+    ret = k;
 
-            ret = k;
+    if (2 * (t->n + 1) > t->m) {
+        /* Load factor would exceed one half.  Expand table. */
+        if (hash_set_expand(t->n + 1, t) < 0) {
+            ret = -1;
         }
-    } else {
-        ret = k;
+    }
+
+    if (ret == k) {
+        t->n += hash_set_insert_core(k, t->m, t->s);
     }
 
     return ret;
 }
 
 
+/* Insert 'n' elements 'k' into hash set 't', expanding the table at most
+ * once. */
 /* ---------------------------------------------------------------------- */
-size_t
-hash_set_count_elms(const struct hash_set *set)
+int
+hash_set_insert_elms(size_t n, const int *k, struct hash_set *t)
 /* ---------------------------------------------------------------------- */
 {
-    size_t i, n;
+    size_t i;
+
+    assert (t != NULL);
+    assert (IS_POW2(t->m));
+
+    if (2 * (t->n + n) > t->m) {
+        if (hash_set_expand(t->n + n, t) < 0) {
+            return -1;
+        }
+    }
 
-    n = 0;
-    for (i = 0; i < set->m; i++) {
-        n += set->s[i] != -1;
+    for (i = 0; i < n; i++) {
+        assert (k[i] >= 0);
+
+        t->n += hash_set_insert_core(k[i], t->m, t->s);
     }
 
-    return n;
+    return (int) n;
+}
+
+
+/* ---------------------------------------------------------------------- */
+size_t
+hash_set_count_elms(const struct hash_set *set)
+/* ---------------------------------------------------------------------- */
+{
+    return set->n;
 }
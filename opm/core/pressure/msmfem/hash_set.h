@@ -29,9 +29,11 @@ extern "C" {
 
 /* ---------------------------------------------------------------------- */
 /* Poor-man's unordered set (ind. key insert/all key extract only).       */
+/* Flat open-addressing table of non-negative keys.  Free slots are -1.   */
 /* ---------------------------------------------------------------------- */
 struct hash_set {
-    size_t  m;                  /* Table/set capacity (1<<p for some p) */
+    size_t  m;                  /* Table capacity (1<<p for some p) */
+    size_t  n;                  /* Number of keys in set (n <= m/2) */
     int    *s;                  /* Set representation */
 };
 
@@ -44,7 +46,8 @@ hash_set_deallocate(struct hash_set *s);
 
 
 /* ---------------------------------------------------------------------- */
-/* Construct an emtpy hash set capable of holding 'm' elements            */
+/* Construct an emtpy hash set capable of holding 'm' elements without    */
+/* rehashing.                                                             */
 /* ---------------------------------------------------------------------- */
 struct hash_set *
 hash_set_allocate(int m);
@@ -57,6 +60,14 @@ int
 hash_set_insert(int k, struct hash_set *s);
 
 
+/* ---------------------------------------------------------------------- */
+/* Insert 'n' elements 'k' into hash set 's'.  Returns 'n' if successful  */
+/* and -1 if the table cannot be expanded.                                */
+/* ---------------------------------------------------------------------- */
+int
+hash_set_insert_elms(size_t n, const int *k, struct hash_set *s);
+
+
 /* ---------------------------------------------------------------------- */
 /* Count number of valid keys in a hash set.                              */
 /* ---------------------------------------------------------------------- */
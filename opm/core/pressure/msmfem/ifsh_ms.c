@@ -420,6 +420,31 @@ ifsh_ms_construct(struct UnstructuredGrid       *G     ,
 }
 
 
+/* ---------------------------------------------------------------------- */
+/* Recompute those basis functions whose support has seen a relative
+ * total mobility change larger than 'tol' since 'mobref'.  See
+ * coarse_sys_update_basis() for details.
+ *
+ * Returns the number of recomputed basis functions, or -1 on failure. */
+/* ---------------------------------------------------------------------- */
+int
+ifsh_ms_update_basis(struct UnstructuredGrid *G,
+                     const double        *perm,
+                     const double        *src,
+                     const double        *totmob,
+                     double               tol,
+                     double              *mobref,
+                     int                  concurrent,
+                     LocalSolver          linsolve,
+                     struct ifsh_ms_data *h)
+/* ---------------------------------------------------------------------- */
+{
+    return coarse_sys_update_basis(G, h->pimpl->p, h->pimpl->ct,
+                                   perm, src, totmob, tol, mobref,
+                                   concurrent, linsolve, h->pimpl->sys);
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 ifsh_ms_destroy(struct ifsh_ms_data *h)
@@ -54,6 +54,17 @@ ifsh_ms_construct(struct UnstructuredGrid       *G,
 void
 ifsh_ms_destroy(struct ifsh_ms_data *h);
 
+int
+ifsh_ms_update_basis(struct UnstructuredGrid *G,
+                     const double        *perm,
+                     const double        *src,
+                     const double        *totmob,
+                     double               tol,
+                     double              *mobref,
+                     int                  concurrent,
+                     LocalSolver          linsolve,
+                     struct ifsh_ms_data *h);
+
 void
 ifsh_ms_assemble(const double        *src,
                  const double        *totmob,
@@ -0,0 +1,315 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#if HAVE_METIS
+#include <metis.h>
+#endif
+
+#include <opm/core/pressure/msmfem/partition_graph.h>
+
+
+#define MAX(a,b) (((a) > (b)) ? (a) : (b))
+#define MIN(a,b) (((a) < (b)) ? (a) : (b))
+
+
+/* Range of integer weights passed to graph partitioners. */
+#define WEIGHT_RANGE 1000
+
+
+/* ======================================================================
+ * Recursive coordinate bisection
+ * ====================================================================== */
+
+struct rcb_item {
+    double x;                   /* Coordinate along bisection direction */
+    int    c;                   /* Cell */
+};
+
+
+/* ---------------------------------------------------------------------- */
+static int
+rcb_item_cmp(const void *a0, const void *b0)
+/* ---------------------------------------------------------------------- */
+{
+    const struct rcb_item *a = a0, *b = b0;
+
+    if (a->x < b->x) { return -1; }
+    if (a->x > b->x) { return  1; }
+
+    return (a->c > b->c) - (a->c < b->c);
+}
+
+
+/* Assign the 'n' cells 'cells' to parts part0..part0+nparts-1 by
+ * splitting them, recursively, at the weighted median along the
+ * direction of largest extent.  Reorders 'cells'. */
+/* ---------------------------------------------------------------------- */
+static void
+rcb_bisect(int n, int *cells, const double *cweight,
+           int dim, const double *centroids,
+           int nparts, int part0, struct rcb_item *work, int *p)
+/* ---------------------------------------------------------------------- */
+{
+    int    i, d, dmax, k, np1, lo, hi, clo, chi;
+    double x, ext, max_ext, tot, acc, w;
+
+    if ((nparts == 1) || (n <= 1)) {
+        for (i = 0; i < n; i++) { p[cells[i]] = part0; }
+        return;
+    }
+
+    /* Direction of largest extent */
+    dmax = 0;  max_ext = -1.0;
+    for (d = 0; d < dim; d++) {
+        clo = chi = cells[0];
+        for (i = 1; i < n; i++) {
+            x = centroids[cells[i]*dim + d];
+
+            if (x < centroids[clo*dim + d]) { clo = cells[i]; }
+            if (x > centroids[chi*dim + d]) { chi = cells[i]; }
+        }
+
+        ext = centroids[chi*dim + d] - centroids[clo*dim + d];
+        if (ext > max_ext) { max_ext = ext;  dmax = d; }
+    }
+
+    tot = 0.0;
+    for (i = 0; i < n; i++) {
+        work[i].x = centroids[cells[i]*dim + dmax];
+        work[i].c = cells[i];
+
+        tot += (cweight != NULL) ? cweight[cells[i]] : 1.0;
+    }
+
+    qsort(work, n, sizeof *work, rcb_item_cmp);
+
+    /* Weighted split.  The first half receives 'np1' of the parts. */
+    np1 = nparts / 2;
+    acc = 0.0;
+    for (k = 0; k < n; k++) {
+        w = (cweight != NULL) ? cweight[work[k].c] : 1.0;
+
+        if (acc + 0.5*w >= tot * np1 / nparts) { break; }
+
+        acc += w;
+    }
+
+    /* Keep parts non-empty whenever there are enough cells. */
+    lo = MIN(np1, n);
+    hi = n - MIN(nparts - np1, n - lo);
+    k  = MAX(lo, MIN(k, hi));
+
+    for (i = 0; i < n; i++) { cells[i] = work[i].c; }
+
+    rcb_bisect(k, cells, cweight, dim, centroids,
+               np1, part0, work, p);
+
+    rcb_bisect(n - k, cells + k, cweight, dim, centroids,
+               nparts - np1, part0 + np1, work, p);
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+partition_rcb(int nc, const double *cweight,
+              int dim, const double *centroids,
+              int nparts, int *p)
+/* ---------------------------------------------------------------------- */
+{
+    int              c, ret;
+    int             *cells;
+    struct rcb_item *work;
+
+    if ((nc < 1) || (nparts < 1) || (dim < 1) || (centroids == NULL)) {
+        return -1;
+    }
+
+    cells = malloc(nc * sizeof *cells);
+    work  = malloc(nc * sizeof *work);
+
+    if ((cells != NULL) && (work != NULL)) {
+        for (c = 0; c < nc; c++) { cells[c] = c; }
+
+        rcb_bisect(nc, cells, cweight, dim, centroids,
+                   nparts, 0, work, p);
+
+        ret = nparts;
+    } else {
+        ret = -1;
+    }
+
+    free(work);  free(cells);
+
+    return ret;
+}
+
+
+/* ======================================================================
+ * Graph partitioners
+ * ====================================================================== */
+
+#if HAVE_METIS
+/* Integer weight in 0..WEIGHT_RANGE of 'w' relative to 'wmax'. */
+/* ---------------------------------------------------------------------- */
+static idx_t
+metis_weight(double w, double wmax)
+/* ---------------------------------------------------------------------- */
+{
+    return (wmax > 0.0) ? (idx_t) (WEIGHT_RANGE * (w / wmax) + 0.5) : 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+partition_metis(int nc, int nneigh, const int *neigh,
+                const double *fweight, const double *cweight,
+                int nparts, int *p)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, c1, c2, f, ret;
+    double wmax;
+
+    idx_t  nvtxs, ncon, npart, objval;
+    idx_t *xadj, *adjncy, *adjwgt, *vwgt, *part;
+    idx_t  options[METIS_NOPTIONS];
+
+    xadj   = malloc((nc + 1)   * sizeof *xadj);
+    adjncy = malloc(MAX(2 * nneigh, 1) * sizeof *adjncy);
+    adjwgt = malloc(MAX(2 * nneigh, 1) * sizeof *adjwgt);
+    vwgt   = (cweight != NULL) ? malloc(nc * sizeof *vwgt) : NULL;
+    part   = malloc(nc         * sizeof *part);
+
+    ret = -1;
+
+    if ((xadj != NULL) && (adjncy != NULL) && (adjwgt != NULL) &&
+        ((cweight == NULL) || (vwgt != NULL)) && (part != NULL)) {
+
+        wmax = 0.0;
+        for (f = 0; (fweight != NULL) && (f < nneigh); f++) {
+            wmax = MAX(wmax, fweight[f]);
+        }
+
+        /* Count connections per cell... */
+        for (c = 0; c <= nc; c++) { xadj[c] = 0; }
+
+        for (f = 0; f < nneigh; f++) {
+            c1 = neigh[2*f + 0];
+            c2 = neigh[2*f + 1];
+
+            if ((c1 >= 0) && (c2 >= 0) && (c1 != c2) &&
+                ((fweight == NULL) || (fweight[f] > 0.0))) {
+                xadj[c1 + 1] += 1;
+                xadj[c2 + 1] += 1;
+            }
+        }
+
+        /* ...derive start pointers (push-back build mode)... */
+        for (c = 1; c <= nc; c++) {
+            xadj[0] += xadj[c];
+            xadj[c]  = xadj[0] - xadj[c];
+        }
+        xadj[0] = 0;
+
+        /* ...and fill the adjacency graph. */
+        for (f = 0; f < nneigh; f++) {
+            c1 = neigh[2*f + 0];
+            c2 = neigh[2*f + 1];
+
+            if ((c1 >= 0) && (c2 >= 0) && (c1 != c2) &&
+                ((fweight == NULL) || (fweight[f] > 0.0))) {
+                adjwgt[xadj[c1 + 1]  ] = (fweight == NULL) ? 1 :
+                    MAX(metis_weight(fweight[f], wmax), 1);
+                adjncy[xadj[c1 + 1]++] = c2;
+
+                adjwgt[xadj[c2 + 1]  ] = adjwgt[xadj[c1 + 1] - 1];
+                adjncy[xadj[c2 + 1]++] = c1;
+            }
+        }
+
+        if (cweight != NULL) {
+            wmax = 0.0;
+            for (c = 0; c < nc; c++) { wmax = MAX(wmax, cweight[c]); }
+            for (c = 0; c < nc; c++) { vwgt[c] = metis_weight(cweight[c], wmax); }
+        }
+
+        METIS_SetDefaultOptions(options);
+        options[METIS_OPTION_NUMBERING] = 0;
+
+        nvtxs = nc;
+        ncon  = 1;
+        npart = nparts;
+
+        if (METIS_PartGraphKway(&nvtxs, &ncon, xadj, adjncy, vwgt,
+                                NULL, adjwgt, &npart, NULL, NULL,
+                                options, &objval, part) == METIS_OK) {
+            for (c = 0; c < nc; c++) { p[c] = (int) part[c]; }
+
+            ret = nparts;
+        }
+    }
+
+    free(part);  free(vwgt);  free(adjwgt);  free(adjncy);  free(xadj);
+
+    return ret;
+}
+#endif  /* HAVE_METIS */
+
+
+/* ======================================================================
+ * Public interface
+ * ====================================================================== */
+
+
+/* ---------------------------------------------------------------------- */
+int
+partition_graph(int nc, int nneigh, const int *neigh,
+                const double *fweight, const double *cweight,
+                int dim, const double *centroids,
+                int nparts, enum partition_graph_method method,
+                int *p)
+/* ---------------------------------------------------------------------- */
+{
+    int c;
+
+    if ((nc < 1) || (nparts < 1)) {
+        return -1;
+    }
+
+    if (nparts == 1) {
+        for (c = 0; c < nc; c++) { p[c] = 0; }
+
+        return nparts;
+    }
+
+#if HAVE_METIS
+    if (method == PARTITION_GRAPH_DEFAULT) {
+        return partition_metis(nc, nneigh, neigh, fweight, cweight,
+                               nparts, p);
+    }
+#else
+    (void) nneigh;  (void) neigh;  (void) fweight;  (void) method;
+#endif
+
+    return partition_rcb(nc, cweight, dim, centroids, nparts, p);
+}
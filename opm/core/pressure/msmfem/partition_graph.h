@@ -0,0 +1,88 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_PARTITION_GRAPH_HEADER_INCLUDED
+#define OPM_PARTITION_GRAPH_HEADER_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------- */
+/* Graph partitioning of a fine-scale grid.                               */
+/*                                                                        */
+/* The cells are vertices of a graph whose edges are the internal faces,  */
+/* optionally weighted by (e.g.) transmissibility.  The partition can be  */
+/* used as a coarse grid for coarse_sys_construct(), after passing it     */
+/* through partition_split_disconnected() and partition_compress(), or as */
+/* a cell-to-process map (p[c] == rank) for distributed solvers such as   */
+/* those using ParallelISTLInformation.                                   */
+/* ---------------------------------------------------------------------- */
+
+enum partition_graph_method {
+    PARTITION_GRAPH_DEFAULT, /* Graph partitioner (METIS) if available,
+                              * recursive coordinate bisection otherwise */
+    PARTITION_GRAPH_RCB      /* Recursive coordinate bisection */
+};
+
+
+/* ---------------------------------------------------------------------- */
+/* Partition 'nc' cells into 'nparts' parts of (approximately) equal      */
+/* weight.                                                                */
+/*                                                                        */
+/* neigh:     Face-to-cell neighbourship, two entries per face for        */
+/*            'nneigh' faces.  Negative entries denote the outside.       */
+/* fweight:   Connection strength of each face (e.g., transmissibility).  */
+/*            Faces with non-positive weight are not connections.  All    */
+/*            internal faces are equally strong if NULL.  Used by graph   */
+/*            partitioners only.                                          */
+/* cweight:   Non-negative weight (e.g., work load) of each cell.  Unit   */
+/*            weights if NULL.                                            */
+/* dim:       Number of physical dimensions of 'centroids'.               */
+/* centroids: Cell centroids, 'dim' entries per cell.  Used by recursive  */
+/*            coordinate bisection only.                                  */
+/* p:         Part number, 0..nparts-1, of each cell.  Parts may be empty */
+/*            if nparts > nc.                                             */
+/*                                                                        */
+/* Returns 'nparts' if successful and -1 otherwise.                       */
+/* ---------------------------------------------------------------------- */
+int
+partition_graph(int nc, int nneigh, const int *neigh,
+                const double *fweight, const double *cweight,
+                int dim, const double *centroids,
+                int nparts, enum partition_graph_method method,
+                int *p);
+
+
+/* ---------------------------------------------------------------------- */
+/* Recursive coordinate bisection of 'nc' cells into 'nparts' parts of    */
+/* (approximately) equal weight.  See partition_graph() for parameters.   */
+/*                                                                        */
+/* Returns 'nparts' if successful and -1 otherwise.                       */
+/* ---------------------------------------------------------------------- */
+int
+partition_rcb(int nc, const double *cweight,
+              int dim, const double *centroids,
+              int nparts, int *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* OPM_PARTITION_GRAPH_HEADER_INCLUDED */
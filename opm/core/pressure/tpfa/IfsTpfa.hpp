@@ -0,0 +1,81 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_IFSTPFA_HEADER_INCLUDED
+#define OPM_IFSTPFA_HEADER_INCLUDED
+
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+
+/**
+ * \file
+ * Grid templated versions of the incompressible TPFA assembly in ifs_tpfa.h.
+ *
+ * The grid is accessed through the UgGridHelpers interface only, so grids
+ * with implicit topology, such as Opm::CartesianGridView, get inlined
+ * connectivity instead of the indirect arrays of UnstructuredGrid.  The
+ * results are identical to those of the C functions for an UnstructuredGrid.
+ */
+
+/**
+ * Create the cell-to-cell sparsity pattern of the TPFA system matrix, as
+ * the C version for UnstructuredGrid.
+ *
+ * @param[in] G Grid.
+ * @return Pattern with sorted rows if successful, @c NULL in case of
+ * allocation failure.  Must be released using csrmatrix_delete().
+ */
+template<class Grid>
+struct CSRMatrix *
+ifs_tpfa_cell_pattern(const Grid *G);
+
+/**
+ * Allocate TPFA management structure, as ifs_tpfa_construct().
+ *
+ * @param[in] G Grid.
+ * @param[in] W Well topology.
+ * @return Fully formed TPFA management structure if successful, @c NULL in
+ * case of allocation failure.  Must be released using ifs_tpfa_destroy().
+ */
+template<class Grid>
+struct ifs_tpfa_data *
+ifs_tpfa_construct(const Grid *G, struct Wells *W);
+
+/**
+ * Assemble the incompressible TPFA system, as the C version for
+ * UnstructuredGrid.
+ *
+ * @param[in]     G      Grid.
+ * @param[in]     F      Driving forces.  May be @c NULL.
+ * @param[in]     trans  Two-point transmissibilities, one per face.
+ * @param[in]     gpress Gravity pressure contributions, one per half-face
+ *                       in the cell-face order of @c G.
+ * @param[in,out] h      TPFA management structure created for @c G.
+ * @return One if successful, zero if a well control is not supported.
+ */
+template<class Grid>
+int
+ifs_tpfa_assemble(const Grid                   *G     ,
+                  const struct ifs_tpfa_forces *F     ,
+                  const double                 *trans ,
+                  const double                 *gpress,
+                  struct ifs_tpfa_data         *h     );
+
+#include "IfsTpfa_impl.hpp"
+#endif  /* OPM_IFSTPFA_HEADER_INCLUDED */
@@ -0,0 +1,241 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/grid/CartesianGridView.hpp>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/flow_bc.h>
+
+#include <cassert>
+#include <cstddef>
+
+/* ---------------------------------------------------------------------- */
+template<class Grid>
+struct CSRMatrix *
+ifs_tpfa_cell_pattern(const Grid *G)
+/* ---------------------------------------------------------------------- */
+{
+    using namespace Opm::UgGridHelpers;
+
+    const int nc = numCells(*G);
+    const int nf = numFaces(*G);
+    typename FaceCellTraits<Grid>::Type face_cells = faceCells(*G);
+
+    struct CSRMatrix *A = csrmatrix_new_count_nnz(nc);
+
+    if (A != NULL) {
+        /* Self connections */
+        for (int c = 0; c < nc; c++) {
+            A->ia[ c + 1 ] = 1;
+        }
+
+        /* Other connections */
+        for (int f = 0; f < nf; f++) {
+            const int c1 = face_cells(f, 0);
+            const int c2 = face_cells(f, 1);
+
+            if ((c1 >= 0) && (c2 >= 0)) {
+                A->ia[ c1 + 1 ] += 1;
+                A->ia[ c2 + 1 ] += 1;
+            }
+        }
+
+        if (csrmatrix_new_elms_pushback(A) == 0) {
+            csrmatrix_delete(A);
+            A = NULL;
+        }
+    }
+
+    if (A != NULL) {
+        for (int c = 0; c < nc; c++) {
+            A->ja[ A->ia[ c + 1 ] ++ ] = c;
+        }
+
+        for (int f = 0; f < nf; f++) {
+            const int c1 = face_cells(f, 0);
+            const int c2 = face_cells(f, 1);
+
+            if ((c1 >= 0) && (c2 >= 0)) {
+                A->ja[ A->ia[ c1 + 1 ] ++ ] = c2;
+                A->ja[ A->ia[ c2 + 1 ] ++ ] = c1;
+            }
+        }
+
+        /* Guarantee sorted rows */
+        csrmatrix_sortrows(A);
+    }
+
+    return A;
+}
+
+
+/* ---------------------------------------------------------------------- */
+template<class Grid>
+struct ifs_tpfa_data *
+ifs_tpfa_construct(const Grid *G, struct Wells *W)
+/* ---------------------------------------------------------------------- */
+{
+    using namespace Opm::UgGridHelpers;
+
+    struct CSRMatrix *P = ifs_tpfa_cell_pattern<Grid>(G);
+
+    if (P == NULL) {
+        return NULL;
+    }
+
+    struct ifs_tpfa_data *h =
+        ifs_tpfa_construct_from_pattern(numCells(*G), numFaces(*G), W, P);
+
+    csrmatrix_delete(P);
+
+    return h;
+}
+
+
+/* ---------------------------------------------------------------------- */
+template<class Grid>
+int
+ifs_tpfa_assemble(const Grid                   *G     ,
+                  const struct ifs_tpfa_forces *F     ,
+                  const double                 *trans ,
+                  const double                 *gpress,
+                  struct ifs_tpfa_data         *h     )
+/* ---------------------------------------------------------------------- */
+{
+    using namespace Opm::UgGridHelpers;
+
+    typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
+
+    const int nc = numCells(*G);
+    const int nf = numFaces(*G);
+    typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(*G);
+    typename FaceCellTraits<Grid>::Type face_cells = faceCells(*G);
+
+    double *fgrav = ifs_tpfa_face_gravity(h);
+
+    csrmatrix_zero(         h->A);
+    vector_zero   (h->A->m, h->b);
+
+    /* fgrav = accumarray(cf(j), grav(j).*sgn(j), [nf, 1]) */
+    vector_zero(nf, fgrav);
+
+    // Half-face index.  May exceed the range of int for grids with
+    // implicit topology.
+    std::size_t i = 0;
+    for (int c = 0; c < nc; c++) {
+        FaceRow faces = c2f[c];
+
+        for (typename FaceRow::const_iterator f = faces.begin(), end = faces.end();
+             f != end; ++f, ++i)
+        {
+            const int c1 = face_cells(*f, 0);
+            const int c2 = face_cells(*f, 1);
+
+            if ((c1 >= 0) && (c2 >= 0)) {
+                fgrav[*f] += (2.0*(c1 == c) - 1.0) * gpress[i];
+            }
+        }
+    }
+
+    for (int c = 0; c < nc; c++) {
+        const int j1 = csrmatrix_elm_index(c, c, h->A);
+        FaceRow faces = c2f[c];
+
+        for (typename FaceRow::const_iterator f = faces.begin(), end = faces.end();
+             f != end; ++f)
+        {
+            const int c1 = face_cells(*f, 0);
+            const int c2 = (c1 == c) ? face_cells(*f, 1) : c1;
+            const double s = 2.0*(c1 == c) - 1.0;
+
+            h->b[c] -= trans[*f] * (s * fgrav[*f]);
+
+            if (c2 >= 0) {
+                const int j2 = csrmatrix_elm_index(c, c2, h->A);
+
+                h->A->sa[j1] += trans[*f];
+                h->A->sa[j2] -= trans[*f];
+            }
+        }
+    }
+
+    /* Assemble contributions from driving forces other than gravity */
+    int ok = 1;
+    int res_is_neumann = 1;
+    int wells_are_rate = 1;
+    if (F != NULL) {
+        if ((F->W != NULL) && (F->totmob != NULL) && (F->wdp != NULL)) {
+            /* Contributions from wells */
+            ok = ifs_tpfa_assemble_well_contrib(nc, F, h, &wells_are_rate);
+        }
+
+        if (F->bc != NULL) {
+            /* Contributions from boundary conditions, as for the C
+             * version.  Other types than pressure and total flux are
+             * not handled. */
+            const struct FlowBoundaryConditions *bc = F->bc;
+
+            for (std::size_t k = 0; k < bc->nbc; k++) {
+                for (std::size_t j = bc->cond_pos[ k ]; j < bc->cond_pos[k + 1]; j++) {
+                    const int f  = bc->face[ j ];
+                    const int c1 = face_cells(f, 0);
+                    const int c2 = face_cells(f, 1);
+
+                    assert ((c1 < 0) ^ (c2 < 0)); /* BCs on ext. faces only */
+
+                    const int c = (c1 >= 0) ? c1 : c2;
+
+                    if (bc->type[ k ] == BC_PRESSURE) {
+                        res_is_neumann = 0;
+
+                        const double t = trans[ f ];
+                        const double s = 2.0*(c1 >= 0) - 1.0;
+                        const int    ix = csrmatrix_elm_index(c, c, h->A);
+
+                        h->A->sa[ ix ] += t;
+                        h->b    [ c  ] += t * bc->value[ k ];
+                        h->b    [ c  ] -= s * t * fgrav[ f ];
+                    }
+                    else if (bc->type[ k ] == BC_FLUX_TOTVOL) {
+                        /* We currently support individual flux faces only. */
+                        assert (bc->cond_pos[k + 1] - bc->cond_pos[k] == 1);
+
+                        /* Interpret BC as flow *INTO* cell */
+                        h->b[ c ] += bc->value[ k ];
+                    }
+                }
+            }
+        }
+
+        if (F->src != NULL) {
+            /* Contributions from explicit source terms. */
+            for (int c = 0; c < nc; c++) {
+                h->b[c] += F->src[c];
+            }
+        }
+    }
+
+    if (ok && res_is_neumann && wells_are_rate) {
+        /* Remove zero eigenvalue associated to constant pressure */
+        h->A->sa[0] *= 2.0;
+    }
+
+    return ok;
+}
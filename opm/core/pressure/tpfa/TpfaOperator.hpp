@@ -0,0 +1,110 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_TPFAOPERATOR_HEADER_INCLUDED
+#define OPM_TPFAOPERATOR_HEADER_INCLUDED
+
+#include <opm/core/linalg/LinearOperatorInterface.hpp>
+
+#include <vector>
+
+struct UnstructuredGrid;
+struct ifs_tpfa_forces;
+
+namespace Opm
+{
+
+    /// Matrix-free form of the incompressible TPFA pressure operator.
+    ///
+    /// The grid is accessed through the UgGridHelpers functions, so the
+    /// operator can be used both with an UnstructuredGrid (TpfaOperator)
+    /// and with grids whose topology is computed on the fly, such as
+    /// CartesianGridView. Face indices in the boundary conditions and
+    /// cell indices in the wells refer to the numbering of that grid.
+    ///
+    /// Applies the coefficient matrix assembled by ifs_tpfa_assemble()
+    /// without storing it. Off-diagonal cell couplings are computed by a
+    /// loop over the faces of each cell using the face transmissibilities
+    /// and face_cells of the grid. The diagonal (including pressure
+    /// boundary conditions and well terms) and the cell-well couplings
+    /// of rate controlled wells are precomputed in the constructor. The
+    /// unknowns are the cell pressures followed by one bottom-hole
+    /// pressure per well, as in ifs_tpfa.
+    ///
+    /// Memory use is one double per cell and well, and three words per
+    /// rate well perforation, against one double and one int per
+    /// non-zero of the CSR matrix.
+    template <class Grid>
+    class BasicTpfaOperator : public LinearOperatorInterface
+    {
+    public:
+        /// Construct operator.
+        /// \param[in] grid    Grid. Must outlive the operator.
+        /// \param[in] trans   Face transmissibilities, of size
+        ///                    grid.number_of_faces. Not copied, so the
+        ///                    array must outlive the operator.
+        /// \param[in] forces  Driving forces as passed to
+        ///                    ifs_tpfa_assemble(), or null. Only the
+        ///                    wells, total mobilities and boundary
+        ///                    conditions affect the operator.
+        BasicTpfaOperator(const Grid& grid,
+                          const double* trans,
+                          const ifs_tpfa_forces* forces = 0);
+
+        /// Number of unknowns, i.e. cells plus wells.
+        virtual int size() const;
+
+        /// Compute y = A x.
+        virtual void apply(const double* x, double* y) const;
+
+        /// Diagonal of A.
+        virtual const double* diagonal() const;
+
+        /// True if the system is singular without the modification of
+        /// the first diagonal element made by ifs_tpfa_assemble(),
+        /// i.e. if there are no pressure conditions. The modification
+        /// is included in the operator.
+        bool singular() const;
+
+    private:
+        void addWells(const ifs_tpfa_forces& forces);
+        int addBoundaryConditions(const ifs_tpfa_forces& forces);
+
+        const Grid& grid_;
+        const double* trans_;
+        int num_wells_;
+        bool singular_;
+        std::vector<double> diag_;
+        // Couplings between perforated cells and wells of rate
+        // controlled wells, entering A with a negative sign.
+        std::vector<int> perf_cell_;
+        std::vector<int> perf_well_;
+        std::vector<double> perf_trans_;
+    };
+
+    /// Operator on an UnstructuredGrid, instantiated in TpfaOperator.cpp.
+    typedef BasicTpfaOperator<UnstructuredGrid> TpfaOperator;
+
+    extern template class BasicTpfaOperator<UnstructuredGrid>;
+
+} // namespace Opm
+
+#include "TpfaOperator_impl.hpp"
+
+#endif // OPM_TPFAOPERATOR_HEADER_INCLUDED
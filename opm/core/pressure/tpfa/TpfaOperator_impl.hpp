@@ -0,0 +1,237 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_TPFAOPERATOR_IMPL_HEADER_INCLUDED
+#define OPM_TPFAOPERATOR_IMPL_HEADER_INCLUDED
+
+#include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/grid/CartesianGridView.hpp>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/flow_bc.h>
+#include <opm/core/wells.h>
+#include <opm/core/well_controls.h>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <cassert>
+#include <stdexcept>
+
+namespace Opm
+{
+
+    template <class Grid>
+    BasicTpfaOperator<Grid>::BasicTpfaOperator(const Grid& grid,
+                                               const double* trans,
+                                               const ifs_tpfa_forces* forces)
+        : grid_(grid),
+          trans_(trans),
+          num_wells_(0),
+          singular_(true)
+    {
+        using namespace UgGridHelpers;
+        const int nc = numCells(grid_);
+        const typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(grid_);
+        const typename FaceCellTraits<Grid>::Type face_cells = faceCells(grid_);
+        const bool use_wells = forces != 0 && forces->W != 0
+            && forces->totmob != 0 && forces->wdp != 0;
+        num_wells_ = use_wells ? forces->W->number_of_wells : 0;
+
+        diag_.assign(nc + num_wells_, 0.0);
+        for (int c = 0; c < nc; ++c) {
+            const typename Cell2FacesTraits<Grid>::Type::row_type faces = c2f[c];
+            for (auto f = faces.begin(), end = faces.end(); f != end; ++f) {
+                if (face_cells(*f, 0) >= 0 && face_cells(*f, 1) >= 0) {
+                    diag_[c] += trans_[*f];
+                }
+            }
+        }
+
+        bool all_rate = true;
+        if (use_wells) {
+            for (int w = 0; w < num_wells_; ++w) {
+                const WellControls* ctrls = forces->W->ctrls[w];
+                if (!well_controls_well_is_stopped(ctrls)
+                    && (well_controls_get_current_type(ctrls) == BHP
+                        || well_controls_get_current_type(ctrls) == THP)) {
+                    all_rate = false;
+                }
+            }
+            addWells(*forces);
+        }
+        int is_neumann = 1;
+        if (forces != 0 && forces->bc != 0) {
+            is_neumann = addBoundaryConditions(*forces);
+        }
+
+        // Same treatment of the zero eigenvalue as ifs_tpfa_assemble().
+        singular_ = is_neumann && all_rate;
+        if (singular_ && !diag_.empty()) {
+            diag_[0] *= 2.0;
+        }
+    }
+
+
+
+
+    template <class Grid>
+    int BasicTpfaOperator<Grid>::size() const
+    {
+        return diag_.size();
+    }
+
+
+
+
+    template <class Grid>
+    void BasicTpfaOperator<Grid>::apply(const double* x, double* y) const
+    {
+        using namespace UgGridHelpers;
+        const int nc = numCells(grid_);
+        const typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(grid_);
+        const typename FaceCellTraits<Grid>::Type face_cells = faceCells(grid_);
+
+        // Row-wise face loop, so that each cell is written by one thread.
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < nc; ++c) {
+            double yc = diag_[c] * x[c];
+            const typename Cell2FacesTraits<Grid>::Type::row_type faces = c2f[c];
+            for (auto f = faces.begin(), end = faces.end(); f != end; ++f) {
+                const int c1 = face_cells(*f, 0);
+                const int c2 = face_cells(*f, 1);
+                const int other = (c1 == c) ? c2 : c1;
+                if (other >= 0) {
+                    yc -= trans_[*f] * x[other];
+                }
+            }
+            y[c] = yc;
+        }
+
+        for (int w = 0; w < num_wells_; ++w) {
+            y[nc + w] = diag_[nc + w] * x[nc + w];
+        }
+        const int num_coupled = perf_cell_.size();
+        for (int i = 0; i < num_coupled; ++i) {
+            const int c = perf_cell_[i];
+            const int wdof = nc + perf_well_[i];
+            y[c] -= perf_trans_[i] * x[wdof];
+            y[wdof] -= perf_trans_[i] * x[c];
+        }
+    }
+
+
+
+
+    template <class Grid>
+    const double* BasicTpfaOperator<Grid>::diagonal() const
+    {
+        return diag_.data();
+    }
+
+
+
+
+    template <class Grid>
+    bool BasicTpfaOperator<Grid>::singular() const
+    {
+        return singular_;
+    }
+
+
+
+
+    template <class Grid>
+    void BasicTpfaOperator<Grid>::addWells(const ifs_tpfa_forces& forces)
+    {
+        const Wells& W = *forces.W;
+        const int nc = UgGridHelpers::numCells(grid_);
+        for (int w = 0; w < num_wells_; ++w) {
+            const WellControls* ctrls = W.ctrls[w];
+            const int wdof = nc + w;
+            // Shut wells get the trivial equation of ifs_tpfa, BHP wells
+            // in addition a diagonal term in the perforated cells, and
+            // rate wells also the cell-well couplings.
+            bool shut = well_controls_well_is_stopped(ctrls);
+            bool rate = false;
+            if (!shut) {
+                switch (well_controls_get_current_type(ctrls)) {
+                case BHP:
+                case THP:
+                    break;
+                case RESERVOIR_RATE:
+                    if (W.type[w] == PRODUCER) {
+                        const double* distr = well_controls_get_current_distr(ctrls);
+                        for (int p = 0; p < W.number_of_phases; ++p) {
+                            if (distr[p] != 1.0) {
+                                OPM_THROW(std::runtime_error, "RESV controlled producer " << W.name[w]
+                                          << " must have a phase distribution of all ones.");
+                            }
+                        }
+                    }
+                    rate = true;
+                    break;
+                default:
+                    OPM_THROW(std::runtime_error, "TpfaOperator cannot handle the controls of well "
+                              << W.name[w] << ".");
+                }
+            }
+            for (int i = W.well_connpos[w]; i < W.well_connpos[w + 1]; ++i) {
+                const int c = W.well_cells[i];
+                const double t = forces.totmob[c] * W.WI[i];
+                diag_[wdof] += t;
+                if (!shut) {
+                    diag_[c] += t;
+                }
+                if (rate) {
+                    perf_cell_.push_back(c);
+                    perf_well_.push_back(w);
+                    perf_trans_.push_back(t);
+                }
+            }
+        }
+    }
+
+
+
+
+    template <class Grid>
+    int BasicTpfaOperator<Grid>::addBoundaryConditions(const ifs_tpfa_forces& forces)
+    {
+        const FlowBoundaryConditions& bc = *forces.bc;
+        const typename UgGridHelpers::FaceCellTraits<Grid>::Type face_cells
+            = UgGridHelpers::faceCells(grid_);
+        int is_neumann = 1;
+        for (size_t i = 0; i < bc.nbc; ++i) {
+            if (bc.type[i] != BC_PRESSURE) {
+                continue;
+            }
+            is_neumann = 0;
+            for (size_t j = bc.cond_pos[i]; j < bc.cond_pos[i + 1]; ++j) {
+                const int f = bc.face[j];
+                const int c1 = face_cells(f, 0);
+                const int c2 = face_cells(f, 1);
+                assert((c1 < 0) ^ (c2 < 0));
+                diag_[c1 >= 0 ? c1 : c2] += trans_[f];
+            }
+        }
+        return is_neumann;
+    }
+
+} // namespace Opm
+
+#endif // OPM_TPFAOPERATOR_IMPL_HEADER_INCLUDED
@@ -1,8 +1,10 @@
 #include <opm/core/linalg/blas_lapack.h>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 #include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/grid/CartesianGridView.hpp>
 
 #include <cmath>
+#include <cstddef>
 
 namespace Dune
 {
@@ -39,12 +41,16 @@ inline void maybeFreeFaceNormal(const Dune::CpGrid&, const double* array)
 }
 #endif  // HAVE_DUNE_CORNERPOINT
 
-inline const double* multiplyFaceNormalWithArea(const UnstructuredGrid&, int, const double* in)
+// Grids such as UnstructuredGrid and Opm::CartesianGridView store
+// area-weighted normals.
+template<class Grid>
+inline const double* multiplyFaceNormalWithArea(const Grid&, int, const double* in)
 {
     return in;
 }
 
-inline void maybeFreeFaceNormal(const UnstructuredGrid&, const double*)
+template<class Grid>
+inline void maybeFreeFaceNormal(const Grid&, const double*)
 {}
 }
 
@@ -65,7 +71,6 @@ tpfa_htrans_compute(const Grid* G, const double *perm, double *htrans)
     typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(*G);
     typename FaceCellTraits<Grid>::Type face_cells = faceCells(*G);
     
-    const double *n;
     const double *K;
 
     MAT_SIZE_T nrows, ncols, ldA, incx, incy;
@@ -77,7 +82,11 @@ tpfa_htrans_compute(const Grid* G, const double *perm, double *htrans)
     incx  = incy     = 1      ;
     a1    = 1.0;  a2 = 0.0    ;
 
-    for (int c =0, i = 0; c < numCells(*G); c++) {
+    // Half-face index.  May exceed the range of int for grids with
+    // implicit topology.
+    std::size_t i = 0;
+
+    for (int c = 0; c < numCells(*G); c++) {
         K  = perm + (c * d * d);
         
         typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
@@ -87,9 +96,11 @@ tpfa_htrans_compute(const Grid* G, const double *perm, double *htrans)
             f!=end; ++f, ++i)
         {
             s = 2.0*(face_cells(*f, 0) == c) - 1.0;
-            n = faceNormal(*G, *f);
-            const double* nn=multiplyFaceNormalWithArea(*G, *f, n);
-            const double* fc = &(faceCentroid(*G, *f)[0]);
+            // Accessors may return the geometry by value.
+            const auto& n = faceNormal(*G, *f);
+            const auto& fcv = faceCentroid(*G, *f);
+            const double* nn=multiplyFaceNormalWithArea(*G, *f, &n[0]);
+            const double* fc = &fcv[0];
             dgemv_("No Transpose", &nrows, &ncols,
                    &a1, K, &ldA, nn, &incx, &a2, &Kn[0], &incy);
             maybeFreeFaceNormal(*G, nn);
@@ -126,7 +137,8 @@ tpfa_trans_compute(const Grid* G, const double *htrans, double *trans)
 
     typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(*G);
 
-    for (int c = 0, i = 0; c < numCells(*G); c++) {
+    std::size_t i = 0;
+    for (int c = 0; c < numCells(*G); c++) {
         typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
         FaceRow faces = c2f[c];
         
@@ -160,7 +172,8 @@ tpfa_eff_trans_compute(const Grid*        G,
 
     typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(*G);
 
-    for (int c = 0, i = 0; c < numCells(*G); c++) {
+    std::size_t i = 0;
+    for (int c = 0; c < numCells(*G); c++) {
         typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
         FaceRow faces = c2f[c];
         
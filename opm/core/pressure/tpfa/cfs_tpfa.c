@@ -1344,6 +1344,11 @@ cfs_tpfa_impes_maxtime(struct UnstructuredGrid                  *G,
     int c;
     double max_dt, cell_dt;
     max_dt = 1e100;
+
+    /* Cells are independent, and the minimum is exact in any order. */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(cell_dt) reduction(min:max_dt)
+#endif
     for (c = 0; c < G->number_of_cells; ++c) {
         cell_dt = cfs_tpfa_impes_maxtime_cell(c, G, cq, trans, porevol, h,
                                               dpmobf, surf_dens, gravity);
@@ -1383,9 +1388,13 @@ cfs_tpfa_expl_mass_transport(struct UnstructuredGrid                 *G,
     cpress = h->x;
     wpress = h->x + G->number_of_cells;
 
-    /* Transport through interior faces */
-    for (c = i = 0; c < G->number_of_cells; c++) {
-        for (; i < G->cell_facepos[c + 1]; i++) {
+    /* Transport through interior faces.  Each cell gathers the fluxes
+     * of its own faces, so cells may be updated concurrently. */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(i, f, c2, p, dp, dz, gsgn)
+#endif
+    for (c = 0; c < G->number_of_cells; c++) {
+        for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
             f  = G->cell_faces[i];
 
             if ((c2 = G->face_cells[2*f + 0]) == c) {
@@ -1409,7 +1418,8 @@ cfs_tpfa_expl_mass_transport(struct UnstructuredGrid                 *G,
         }
     }
 
-    /* Transport through well perforations */
+    /* Transport through well perforations.  Perforations of different
+     * wells may share cells, so this loop stays serial. */
     if (W != NULL) {
         for (w = i = 0; w < W->number_of_wells; w++) {
             for (; i < W->well_connpos[w + 1]; i++) {
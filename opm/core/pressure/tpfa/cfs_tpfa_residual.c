@@ -5,6 +5,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include <opm/core/wells.h>
 #include <opm/core/well_controls.h>
@@ -35,12 +38,25 @@ struct densrat_util {
     double     *mat_row;
     double     *coeff;
     double     *linsolve_buffer;
+    double     *flux_work;
+
+    /* Bytes allocated for this structure */
+    size_t      nbytes;
 };
 
 
 struct cfs_tpfa_res_impl {
     int                  is_incomp;
 
+    /* Number of threads used in cell assembly (>= 1) */
+    int                  nthreads;
+
+    /* Capacities of well-dependent storage (>= current sizes) */
+    size_t               nwell_cap;
+    size_t               nperf_cap;
+    size_t               nrow_cap;
+    size_t               nnz_cap;
+
     /* One entry per component per face */
     double              *compflux_f;       /* A_{ij} v_{ij} */
     double              *compflux_deriv_f; /* A_{ij} \partial_{p} v_{ij} */
@@ -56,8 +72,12 @@ struct cfs_tpfa_res_impl {
 
     struct densrat_util *ratio;
 
+    /* Per-thread scratch.  ratio_thr[0] == ratio. */
+    struct densrat_util **ratio_thr;
+
     /* Linear storage */
     double *ddata;
+    size_t  ddata_sz;
 };
 
 
@@ -95,10 +115,14 @@ allocate_densrat(size_t max_conn, int np)
         alloc_sz += (max_conn + 1) * 1 ; /* mat_row */
         alloc_sz += (max_conn + 1) * 1 ; /* coeff */
         alloc_sz += n_buffer_col   * np; /* linsolve_buffer */
+        alloc_sz += (1 + 2)        * np; /* flux_work */
 
         ratio->ipiv = malloc(np       * sizeof *ratio->ipiv);
         ratio->lu   = malloc(alloc_sz * sizeof *ratio->lu  );
 
+        ratio->nbytes = sizeof *ratio + np * sizeof *ratio->ipiv
+            + alloc_sz * sizeof *ratio->lu;
+
         if ((ratio->ipiv == NULL) || (ratio->lu == NULL)) {
             deallocate_densrat(ratio);
             ratio = NULL;
@@ -108,6 +132,7 @@ allocate_densrat(size_t max_conn, int np)
             ratio->mat_row         = ratio->t2      + (1              * np);
             ratio->coeff           = ratio->mat_row + ((max_conn + 1) * 1 );
             ratio->linsolve_buffer = ratio->coeff   + ((max_conn + 1) * 1 );
+            ratio->flux_work       = ratio->linsolve_buffer + (n_buffer_col * np);
         }
     }
 
@@ -120,9 +145,19 @@ static void
 impl_deallocate(struct cfs_tpfa_res_impl *pimpl)
 /* ---------------------------------------------------------------------- */
 {
+    int t;
+
     if (pimpl != NULL) {
         free              (pimpl->ddata);
         deallocate_densrat(pimpl->ratio);
+
+        if (pimpl->ratio_thr != NULL) {
+            for (t = 1; t < pimpl->nthreads; t++) {
+                deallocate_densrat(pimpl->ratio_thr[t]);
+            }
+        }
+
+        free(pimpl->ratio_thr);
     }
 
     free(pimpl);
@@ -130,48 +165,73 @@ impl_deallocate(struct cfs_tpfa_res_impl *pimpl)
 
 
 /* ---------------------------------------------------------------------- */
-static struct cfs_tpfa_res_impl *
-impl_allocate(struct UnstructuredGrid   *G       ,
-              struct cfs_tpfa_res_wells *wells   ,
-              size_t                     max_conn,
-              int                        np      )
+static size_t
+ddata_size(struct UnstructuredGrid *G        ,
+           int                      np       ,
+           size_t                   nwell_cap,
+           size_t                   nperf_cap)
 /* ---------------------------------------------------------------------- */
 {
-    size_t                nnu, nwperf;
-    struct cfs_tpfa_res_impl *new;
-
     size_t ddata_sz;
 
-    nnu    = G->number_of_cells;
-    nwperf = 0;
-
-    if ((wells != NULL) && (wells->W != NULL)) {
-        nnu    += wells->W->number_of_wells;
-        nwperf  = wells->W->well_connpos[ wells->W->number_of_wells ];
-    }
-
     /* Linear system */
-    ddata_sz  = nnu;            /* b */
+    ddata_sz  = G->number_of_cells + nwell_cap; /* b */
 
     /* Reservoir */
     ddata_sz += np *      G->number_of_faces ; /* compflux_f */
     ddata_sz += np * (2 * G->number_of_faces); /* compflux_deriv_f */
 
     /* Well perforations */
-    ddata_sz += np *      nwperf ;             /* compflux_p */
-    ddata_sz += np * (2 * nwperf);             /* compflux_deriv_p */
+    ddata_sz += np *      nperf_cap ;          /* compflux_p */
+    ddata_sz += np * (2 * nperf_cap);          /* compflux_deriv_p */
 
     ddata_sz += np * (1 + 2)                 ; /* flux_work */
 
     ddata_sz += 1  *      G->number_of_faces ; /* scratch_f */
 
+    return ddata_sz;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static struct cfs_tpfa_res_impl *
+impl_allocate(struct UnstructuredGrid   *G        ,
+              size_t                     nwell_cap,
+              size_t                     nperf_cap,
+              size_t                     max_conn ,
+              int                        np       ,
+              int                        nthreads )
+/* ---------------------------------------------------------------------- */
+{
+    int                       t, ok;
+    struct cfs_tpfa_res_impl *new;
+
     new = malloc(1 * sizeof *new);
 
     if (new != NULL) {
-        new->ddata = malloc(ddata_sz * sizeof *new->ddata);
-        new->ratio = allocate_densrat(max_conn, np);
+        new->nthreads  = nthreads;
+        new->nwell_cap = nwell_cap;
+        new->nperf_cap = nperf_cap;
+        new->nrow_cap  = 0;
+        new->nnz_cap   = 0;
+        new->ddata_sz  = ddata_size(G, np, nwell_cap, nperf_cap);
+        new->ddata     = malloc(new->ddata_sz * sizeof *new->ddata);
+        new->ratio     = allocate_densrat(max_conn, np);
+        new->ratio_thr = calloc(nthreads, sizeof *new->ratio_thr);
+
+        ok = (new->ddata     != NULL) && (new->ratio != NULL) &&
+             (new->ratio_thr != NULL);
+
+        if (ok) {
+            new->ratio_thr[0] = new->ratio;
+
+            for (t = 1; ok && (t < nthreads); t++) {
+                new->ratio_thr[t] = allocate_densrat(max_conn, np);
+                ok = new->ratio_thr[t] != NULL;
+            }
+        }
 
-        if (new->ddata == NULL || new->ratio == NULL) {
+        if (! ok) {
             impl_deallocate(new);
             new = NULL;
         }
@@ -182,56 +242,122 @@ impl_allocate(struct UnstructuredGrid   *G       ,
 
 
 /* ---------------------------------------------------------------------- */
-static struct CSRMatrix *
-construct_matrix(struct UnstructuredGrid   *G    ,
-                 struct cfs_tpfa_res_wells *wells)
+static void
+count_matrix_conn(struct UnstructuredGrid   *G    ,
+                  struct cfs_tpfa_res_wells *wells,
+                  int                        nnu  ,
+                  int                       *ia   )
 /* ---------------------------------------------------------------------- */
 {
-    int    f, c1, c2, w, i, nc, nnu;
-    int    wells_present;
-    size_t nnz;
-
-    struct CSRMatrix *A;
+    int f, c1, c2, w, i, nc;
 
-    nc = nnu = G->number_of_cells;
+    nc = G->number_of_cells;
 
-    wells_present = (wells != NULL) && (wells->W != NULL);
-    if (wells_present) {
-        nnu += wells->W->number_of_wells;
+    /* Self connections */
+    ia[0] = 0;
+    for (i = 0; i < nnu; i++) {
+        ia[ i + 1 ] = 1;
     }
 
-    A = csrmatrix_new_count_nnz(nnu);
+    /* Other connections */
+    for (f = 0; f < G->number_of_faces; f++) {
+        c1 = G->face_cells[2*f + 0];
+        c2 = G->face_cells[2*f + 1];
 
-    if (A != NULL) {
-        /* Self connections */
-        for (i = 0; i < nnu; i++) {
-            A->ia[ i + 1 ] = 1;
+        if ((c1 >= 0) && (c2 >= 0)) {
+            ia[ c1 + 1 ] += 1;
+            ia[ c2 + 1 ] += 1;
         }
+    }
+
+    if ((wells != NULL) && (wells->W != NULL)) {
+        /* Well <-> cell connections */
+        struct Wells *W = wells->W;
 
-        /* Other connections */
-        for (f = 0; f < G->number_of_faces; f++) {
-            c1 = G->face_cells[2*f + 0];
-            c2 = G->face_cells[2*f + 1];
+        for (w = i = 0; w < W->number_of_wells; w++) {
+            for (; i < W->well_connpos[w + 1]; i++) {
+                c1 = W->well_cells[i];
 
-            if ((c1 >= 0) && (c2 >= 0)) {
-                A->ia[ c1 + 1 ] += 1;
-                A->ia[ c2 + 1 ] += 1;
+                ia[ 0  + c1 + 1 ] += 1; /* c -> w */
+                ia[ nc + w  + 1 ] += 1; /* w -> c */
             }
         }
+    }
+}
 
-        if (wells_present) {
-            /* Well <-> cell connections */
-            struct Wells *W = wells->W;
 
-            for (w = i = 0; w < W->number_of_wells; w++) {
-                for (; i < W->well_connpos[w + 1]; i++) {
-                    c1 = W->well_cells[i];
+/* Fill sparsity pattern of 'A'.  On input, A->ia[i + 1] is the start
+ * position of row 'i'.  On output, A->ia is the final row pointer
+ * array and each row is sorted. */
+/* ---------------------------------------------------------------------- */
+static void
+fill_matrix_conn(struct UnstructuredGrid   *G    ,
+                 struct cfs_tpfa_res_wells *wells,
+                 struct CSRMatrix          *A    )
+/* ---------------------------------------------------------------------- */
+{
+    int    f, c1, c2, w, i, nc;
+    size_t k;
 
-                    A->ia[ 0  + c1 + 1 ] += 1; /* c -> w */
-                    A->ia[ nc + w  + 1 ] += 1; /* w -> c */
-                }
+    nc = G->number_of_cells;
+
+    /* Fill self connections */
+    for (k = 0; k < A->m; k++) {
+        A->ja[ A->ia[ k + 1 ] ++ ] = (int) k;
+    }
+
+    /* Fill other connections */
+    for (f = 0; f < G->number_of_faces; f++) {
+        c1 = G->face_cells[2*f + 0];
+        c2 = G->face_cells[2*f + 1];
+
+        if ((c1 >= 0) && (c2 >= 0)) {
+            A->ja[ A->ia[ c1 + 1 ] ++ ] = c2;
+            A->ja[ A->ia[ c2 + 1 ] ++ ] = c1;
+        }
+    }
+
+    if ((wells != NULL) && (wells->W != NULL)) {
+        /* Fill well <-> cell connections */
+        struct Wells *W = wells->W;
+
+        for (w = i = 0; w < W->number_of_wells; w++) {
+            for (; i < W->well_connpos[w + 1]; i++) {
+                c1 = W->well_cells[i];
+
+                A->ja[ A->ia[ 0  + c1 + 1 ] ++ ] = nc + w;
+                A->ja[ A->ia[ nc + w  + 1 ] ++ ] = c1    ;
             }
         }
+    }
+
+    assert ((size_t) A->ia[ A->m ] == A->nnz);
+
+    /* Enforce sorted connection structure per row */
+    csrmatrix_sortrows(A);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static struct CSRMatrix *
+construct_matrix(struct UnstructuredGrid   *G    ,
+                 struct cfs_tpfa_res_wells *wells)
+/* ---------------------------------------------------------------------- */
+{
+    int    nnu;
+    size_t nnz;
+
+    struct CSRMatrix *A;
+
+    nnu = G->number_of_cells;
+    if ((wells != NULL) && (wells->W != NULL)) {
+        nnu += wells->W->number_of_wells;
+    }
+
+    A = csrmatrix_new_count_nnz(nnu);
+
+    if (A != NULL) {
+        count_matrix_conn(G, wells, nnu, A->ia);
 
         nnz = csrmatrix_new_elms_pushback(A);
         if (nnz == 0) {
@@ -241,43 +367,225 @@ construct_matrix(struct UnstructuredGrid   *G    ,
     }
 
     if (A != NULL) {
-        /* Fill self connections */
-        for (i = 0; i < nnu; i++) {
-            A->ja[ A->ia[ i + 1 ] ++ ] = i;
-        }
+        fill_matrix_conn(G, wells, A);
+    }
 
-        /* Fill other connections */
-        for (f = 0; f < G->number_of_faces; f++) {
-            c1 = G->face_cells[2*f + 0];
-            c2 = G->face_cells[2*f + 1];
+    return A;
+}
 
-            if ((c1 >= 0) && (c2 >= 0)) {
-                A->ja[ A->ia[ c1 + 1 ] ++ ] = c2;
-                A->ja[ A->ia[ c2 + 1 ] ++ ] = c1;
-            }
-        }
 
-        if (wells_present) {
-            /* Fill well <-> cell connections */
-            struct Wells *W = wells->W;
+/* Rebuild sparsity pattern of existing matrix 'A' following a change
+ * in well topology.  Storage is reused if sufficient, otherwise grown
+ * with some slack.  Returns 1 if successful and 0 otherwise. */
+/* ---------------------------------------------------------------------- */
+static int
+rebuild_matrix(struct UnstructuredGrid   *G    ,
+               struct cfs_tpfa_res_wells *wells,
+               struct cfs_tpfa_res_impl  *pimpl,
+               int                        nnu  ,
+               struct CSRMatrix          *A    )
+/* ---------------------------------------------------------------------- */
+{
+    int     i;
+    int    *ia, *ja;
+    double *sa;
+    size_t  nnz, cap;
+
+    if ((size_t) nnu > pimpl->nrow_cap) {
+        cap = G->number_of_cells + MAX(pimpl->nwell_cap, (size_t) nnu);
 
-            for (w = i = 0; w < W->number_of_wells; w++) {
-                for (; i < W->well_connpos[w + 1]; i++) {
-                    c1 = W->well_cells[i];
+        ia = realloc(A->ia, (cap + 1) * sizeof *A->ia);
+        if (ia == NULL) { return 0; }
 
-                    A->ja[ A->ia[ 0  + c1 + 1 ] ++ ] = nc + w;
-                    A->ja[ A->ia[ nc + w  + 1 ] ++ ] = c1    ;
-                }
-            }
-        }
+        A->ia           = ia;
+        pimpl->nrow_cap = cap;
+    }
 
-        assert ((size_t) A->ia[ nnu ] == nnz);
+    count_matrix_conn(G, wells, nnu, A->ia);
 
-        /* Enforce sorted connection structure per row */
-        csrmatrix_sortrows(A);
+    /* Transform row counts (in bins i+1) to start positions. */
+    for (i = 1, nnz = 0; i <= nnu; i++) {
+        nnz      += A->ia[i];
+        A->ia[i]  = (int) nnz - A->ia[i];
     }
 
-    return A;
+    if (nnz > pimpl->nnz_cap) {
+        cap = nnz + nnz / 8;
+
+        ja = realloc(A->ja, cap * sizeof *A->ja);
+        if (ja == NULL) { return 0; }
+        A->ja = ja;
+
+        sa = realloc(A->sa, cap * sizeof *A->sa);
+        if (sa == NULL) { return 0; }
+        A->sa = sa;
+
+        pimpl->nnz_cap = cap;
+    }
+
+    A->m   = nnu;
+    A->nnz = nnz;
+
+    fill_matrix_conn(G, wells, A);
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+set_impl_pointers(struct UnstructuredGrid  *G ,
+                  int                       np,
+                  struct cfs_tpfa_res_data *h )
+/* ---------------------------------------------------------------------- */
+{
+    size_t nf, nwell_cap, nperf_cap;
+
+    nf        = G->number_of_faces;
+    nwell_cap = h->pimpl->nwell_cap;
+    nperf_cap = h->pimpl->nperf_cap;
+
+    /* Allocate linear system components */
+    h->F                       = h->pimpl->ddata + 0;
+
+    h->pimpl->compflux_f       =
+        h->F                     + (G->number_of_cells + nwell_cap);
+    h->pimpl->compflux_p       =
+        h->pimpl->compflux_f                     + (np * nf);
+
+    h->pimpl->compflux_deriv_f =
+        h->pimpl->compflux_p                     + (np * nperf_cap);
+    h->pimpl->compflux_deriv_p =
+        h->pimpl->compflux_deriv_f               + (np * 2 * nf);
+
+    h->pimpl->flux_work        =
+        h->pimpl->compflux_deriv_p               + (np * 2 * nperf_cap);
+
+    h->pimpl->scratch_f        =
+        h->pimpl->flux_work                      + (np * (1 + 2));
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Fixed-size kernels for the common two- and three-phase cases.  Matrices
+ * are stored in column major order (LAPACK convention).  Instead of an LU
+ * factorisation the 'lu' member of 'struct densrat_util' then holds the
+ * explicit (closed-form) inverse of the fluid matrix, which avoids the
+ * LAPACK call overhead in the innermost assembly loops. */
+/* ---------------------------------------------------------------------- */
+
+static void
+invert_2x2(const double *A, double *Ainv)
+{
+    double det;
+
+    det = A[0]*A[3] - A[2]*A[1];
+    assert (det != 0.0);
+
+    det = 1.0 / det;
+
+    Ainv[0] =   A[3] * det;
+    Ainv[1] = - A[1] * det;
+    Ainv[2] = - A[2] * det;
+    Ainv[3] =   A[0] * det;
+}
+
+
+static void
+invert_3x3(const double *A, double *Ainv)
+{
+    double det;
+
+    /* Cofactors, Ainv(i,j) = C(j,i) */
+    Ainv[0] = A[4]*A[8] - A[7]*A[5];
+    Ainv[1] = A[7]*A[2] - A[1]*A[8];
+    Ainv[2] = A[1]*A[5] - A[4]*A[2];
+    Ainv[3] = A[6]*A[5] - A[3]*A[8];
+    Ainv[4] = A[0]*A[8] - A[6]*A[2];
+    Ainv[5] = A[3]*A[2] - A[0]*A[5];
+    Ainv[6] = A[3]*A[7] - A[6]*A[4];
+    Ainv[7] = A[6]*A[1] - A[0]*A[7];
+    Ainv[8] = A[0]*A[4] - A[3]*A[1];
+
+    det = A[0]*Ainv[0] + A[3]*Ainv[1] + A[6]*Ainv[2];
+    assert (det != 0.0);
+
+    det = 1.0 / det;
+
+    Ainv[0] *= det;  Ainv[1] *= det;  Ainv[2] *= det;
+    Ainv[3] *= det;  Ainv[4] *= det;  Ainv[5] *= det;
+    Ainv[6] *= det;  Ainv[7] *= det;  Ainv[8] *= det;
+}
+
+
+/* y <- A * x, A is 2-by-ncol */
+static void
+matvec_2(int ncol, const double *A, const double *x, double *y)
+{
+    int    j;
+    double y0, y1;
+
+    y0 = y1 = 0.0;
+    for (j = 0; j < ncol; j++, A += 2) {
+        y0 += A[0] * x[j];
+        y1 += A[1] * x[j];
+    }
+
+    y[0] = y0;
+    y[1] = y1;
+}
+
+
+/* y <- A * x, A is 3-by-ncol */
+static void
+matvec_3(int ncol, const double *A, const double *x, double *y)
+{
+    int    j;
+    double y0, y1, y2;
+
+    y0 = y1 = y2 = 0.0;
+    for (j = 0; j < ncol; j++, A += 3) {
+        y0 += A[0] * x[j];
+        y1 += A[1] * x[j];
+        y2 += A[2] * x[j];
+    }
+
+    y[0] = y0;
+    y[1] = y1;
+    y[2] = y2;
+}
+
+
+/* C <- A * B, A is 2-by-2, B and C are 2-by-ncol.  In-place (B == C) OK. */
+static void
+matmat_2(int ncol, const double *A, const double *B, double *C)
+{
+    int    j;
+    double b0, b1;
+
+    for (j = 0; j < ncol; j++, B += 2, C += 2) {
+        b0 = B[0];  b1 = B[1];
+
+        C[0] = A[0]*b0 + A[2]*b1;
+        C[1] = A[1]*b0 + A[3]*b1;
+    }
+}
+
+
+/* C <- A * B, A is 3-by-3, B and C are 3-by-ncol.  In-place (B == C) OK. */
+static void
+matmat_3(int ncol, const double *A, const double *B, double *C)
+{
+    int    j;
+    double b0, b1, b2;
+
+    for (j = 0; j < ncol; j++, B += 3, C += 3) {
+        b0 = B[0];  b1 = B[1];  b2 = B[2];
+
+        C[0] = A[0]*b0 + A[3]*b1 + A[6]*b2;
+        C[1] = A[1]*b0 + A[4]*b1 + A[7]*b2;
+        C[2] = A[2]*b0 + A[5]*b1 + A[8]*b2;
+    }
 }
 
 
@@ -287,6 +595,9 @@ factorise_fluid_matrix(int np, const double *A, struct densrat_util *ratio)
     int        np2;
     MAT_SIZE_T m, n, ld, info;
 
+    if (np == 2) { invert_2x2(A, ratio->lu); return; }
+    if (np == 3) { invert_3x3(A, ratio->lu); return; }
+
     m = n = ld = np;
     np2 = np * np;
 
@@ -305,6 +616,10 @@ solve_linear_systems(int                  np   ,
 {
     MAT_SIZE_T n, ldA, ldB, info;
 
+    /* Fixed-size cases: 'lu' holds the explicit inverse */
+    if (np == 2) { matmat_2((int) nrhs, ratio->lu, b, b); return; }
+    if (np == 3) { matmat_3((int) nrhs, ratio->lu, b, b); return; }
+
     n = ldA = ldB = np;
 
     dgetrs_("No Transpose", &n,
@@ -321,6 +636,9 @@ matvec(int nrow, int ncol, const double *A, const double *x, double *y)
     MAT_SIZE_T m, n, ld, incx, incy;
     double     a1, a2;
 
+    if (nrow == 2) { matvec_2(ncol, A, x, y); return; }
+    if (nrow == 3) { matvec_3(ncol, A, x, y); return; }
+
     m    = ld = nrow;
     n    = ncol;
     incx = incy = 1;
@@ -339,6 +657,9 @@ matmat(int np, int ncol, const double *A, const double *B, double *C)
     MAT_SIZE_T m, n, k, ldA, ldB, ldC;
     double     a1, a2;
 
+    if (np == 2) { matmat_2(ncol, A, B, C); return; }
+    if (np == 3) { matmat_3(ncol, A, B, C); return; }
+
     m  = k = ldA = ldB = ldC = np;
     n  = ncol;
     a1 = 1.0;
@@ -349,6 +670,17 @@ matmat(int np, int ncol, const double *A, const double *B, double *C)
 }
 
 
+static int
+current_thread(void)
+{
+#if defined(_OPENMP)
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+
 static void
 compute_darcyflux_and_deriv(int           np,
                             double        trans,
@@ -383,32 +715,35 @@ compute_compflux_and_deriv(struct UnstructuredGrid  *G     ,
 {
     int     c1, c2, f, np2;
     double  dp;
-    double *cflux, *dcflux;
-
-    np2    = np * np;
+    double *work;
 
-    cflux  = pimpl->compflux_f;
-    dcflux = pimpl->compflux_deriv_f;
+    np2 = np * np;
 
-    for (f = 0; f < G->number_of_faces;
-         f++, pmobf += np, gcapf += np, Af += np2,
-             cflux += np, dcflux += 2 * np) {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(pimpl->nthreads) schedule(static) \
+    private(c1, c2, dp, work) if (pimpl->nthreads > 1)
+#endif
+    for (f = 0; f < G->number_of_faces; f++) {
 
         c1 = G->face_cells[2*f + 0];
         c2 = G->face_cells[2*f + 1];
 
         if ((c1 >= 0) && (c2 >= 0)) {
-            dp = cpress[c1] - cpress[c2];
+            work = pimpl->ratio_thr[ current_thread() ]->flux_work;
+            dp   = cpress[c1] - cpress[c2];
 
-            compute_darcyflux_and_deriv(np, trans[f], dp, pmobf, gcapf,
-                                        pimpl->flux_work,
-                                        pimpl->flux_work + np);
+            compute_darcyflux_and_deriv(np, trans[f], dp,
+                                        pmobf + (f * np),
+                                        gcapf + (f * np),
+                                        work, work + np);
 
             /* Component flux = Af * v*/
-            matvec(np, np, Af, pimpl->flux_work     , cflux );
+            matvec(np, np, Af + (f * np2), work,
+                   pimpl->compflux_f + (f * np));
 
             /* Derivative = Af * (dv/dp) */
-            matmat(np, 2 , Af, pimpl->flux_work + np, dcflux);
+            matmat(np, 2 , Af + (f * np2), work + np,
+                   pimpl->compflux_deriv_f + (f * 2 * np));
         }
 
         /* Boundary connections excluded */
@@ -499,19 +834,20 @@ init_cell_contrib(struct UnstructuredGrid  *G    ,
                   double                    pvol ,
                   double                    dt   ,
                   const double             *z    ,
-                  struct cfs_tpfa_res_impl *pimpl)
+                  struct cfs_tpfa_res_impl *pimpl,
+                  struct densrat_util      *ratio)
 {
     int     c1, c2, f, i, conn, nconn;
     double *cflx, *dcflx;
 
     nconn = count_internal_conn(G, c);
 
-    memcpy(pimpl->ratio->linsolve_buffer, z, np * sizeof *z);
+    memcpy(ratio->linsolve_buffer, z, np * sizeof *z);
 
-    pimpl->ratio->coeff[0] = -pvol;
+    ratio->coeff[0] = -pvol;
     conn = 1;
 
-    cflx  = pimpl->ratio->linsolve_buffer + (1 * np);
+    cflx  = ratio->linsolve_buffer + (1 * np);
     dcflx = cflx + (nconn * np);
 
     for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
@@ -529,18 +865,19 @@ init_cell_contrib(struct UnstructuredGrid  *G    ,
             cflx  += 1 * np;
             dcflx += 2 * np;
 
-            pimpl->ratio->coeff[ conn++ ] = dt * (2*(c1 == c) - 1.0);
+            ratio->coeff[ conn++ ] = dt * (2*(c1 == c) - 1.0);
         }
     }
 
     assert (conn == nconn + 1);
-    assert (cflx == pimpl->ratio->linsolve_buffer + (nconn + 1)*np);
+    assert (cflx == ratio->linsolve_buffer + (nconn + 1)*np);
 
     return nconn;
 }
 
 
-static void
+/* Returns 1 if the fluid in cell 'c' is incompressible, 0 otherwise. */
+static int
 compute_cell_contrib(struct UnstructuredGrid  *G    ,
                      int                       c    ,
                      int                       np   ,
@@ -549,49 +886,50 @@ compute_cell_contrib(struct UnstructuredGrid  *G    ,
                      const double             *z    ,
                      const double             *Ac   ,
                      const double             *dAc  ,
-                     struct cfs_tpfa_res_impl *pimpl)
+                     struct cfs_tpfa_res_impl *pimpl,
+                     struct densrat_util      *ratio)
 {
-    int        c1, c2, f, i, off, nconn, p;
+    int        c1, c2, f, i, off, nconn, p, is_incomp;
     MAT_SIZE_T nrhs;
     double     s, dF1, dF2, *dv, *dv1, *dv2;
 
-    nconn = init_cell_contrib(G, c, np, pvol, dt, z, pimpl);
+    nconn = init_cell_contrib(G, c, np, pvol, dt, z, pimpl, ratio);
     nrhs  = 1 + (1 + 2)*nconn;  /* [z, Af*v, Af*dv] */
 
-    factorise_fluid_matrix(np, Ac, pimpl->ratio);
-    solve_linear_systems  (np, nrhs, pimpl->ratio,
-                           pimpl->ratio->linsolve_buffer);
+    factorise_fluid_matrix(np, Ac, ratio);
+    solve_linear_systems  (np, nrhs, ratio,
+                           ratio->linsolve_buffer);
 
     /* Sum residual contributions over the connections (+ accumulation):
      *   t1 <- (Ac \ [z, Af*v]) * [-pvol; repmat(dt, [nconn, 1])] */
-    matvec(np, nconn + 1, pimpl->ratio->linsolve_buffer,
-           pimpl->ratio->coeff, pimpl->ratio->t1);
+    matvec(np, nconn + 1, ratio->linsolve_buffer,
+           ratio->coeff, ratio->t1);
 
     /* Compute residual in cell 'c' */
-    pimpl->ratio->residual = pvol;
+    ratio->residual = pvol;
     for (p = 0; p < np; p++) {
-        pimpl->ratio->residual += pimpl->ratio->t1[ p ];
+        ratio->residual += ratio->t1[ p ];
     }
 
     /* Jacobian row */
 
     vector_zero(1 + (G->cell_facepos[c + 1] - G->cell_facepos[c]),
-                pimpl->ratio->mat_row);
+                ratio->mat_row);
 
     /* t2 <- A \ ((dA/dp) * t1) */
-    matvec(np, np, dAc, pimpl->ratio->t1, pimpl->ratio->t2);
-    solve_linear_systems(np, 1, pimpl->ratio, pimpl->ratio->t2);
+    matvec(np, np, dAc, ratio->t1, ratio->t2);
+    solve_linear_systems(np, 1, ratio, ratio->t2);
 
     dF2 = 0.0;
     for (p = 0; p < np; p++) {
-        dF2 += pimpl->ratio->t2[ p ];
+        dF2 += ratio->t2[ p ];
     }
 
-    pimpl->is_incomp           = pimpl->is_incomp && (! (fabs(dF2) > 0));
-    pimpl->ratio->mat_row[ 0 ] = - dF2;
+    is_incomp           = ! (fabs(dF2) > 0);
+    ratio->mat_row[ 0 ] = - dF2;
 
     /* Accumulate inter-cell Jacobian contributions */
-    dv  = pimpl->ratio->linsolve_buffer + (1 + nconn)*np;
+    dv  = ratio->linsolve_buffer + (1 + nconn)*np;
     off = 1;
     for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++, off++) {
 
@@ -609,12 +947,14 @@ compute_cell_contrib(struct UnstructuredGrid  *G    ,
                 dF2 += dv2[ p ];
             }
 
-            pimpl->ratio->mat_row[  0  ] += s * dt * dF1;
-            pimpl->ratio->mat_row[ off ] += s * dt * dF2;
+            ratio->mat_row[  0  ] += s * dt * dF1;
+            ratio->mat_row[ off ] += s * dt * dF2;
 
             dv += 2 * np;       /* '2' == number of one-sided derivatives. */
         }
     }
+
+    return is_incomp;
 }
 
 
@@ -636,16 +976,17 @@ assemble_sources(double                    dt ,
 
 /* ---------------------------------------------------------------------- */
 static int
-assemble_cell_contrib(struct UnstructuredGrid  *G,
-                      int                       c,
-                      struct cfs_tpfa_res_data *h)
+assemble_cell_contrib(struct UnstructuredGrid   *G    ,
+                      int                        c    ,
+                      const struct densrat_util *ratio,
+                      struct cfs_tpfa_res_data  *h    )
 /* ---------------------------------------------------------------------- */
 {
     int c1, c2, i, f, j1, j2, off;
 
     j1 = csrmatrix_elm_index(c, c, h->J);
 
-    h->J->sa[j1] += h->pimpl->ratio->mat_row[ 0 ];
+    h->J->sa[j1] += ratio->mat_row[ 0 ];
 
     off = 1;
     for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++, off++) {
@@ -659,11 +1000,11 @@ assemble_cell_contrib(struct UnstructuredGrid  *G,
         if (c2 >= 0) {
             j2 = csrmatrix_elm_index(c, c2, h->J);
 
-            h->J->sa[j2] += h->pimpl->ratio->mat_row[ off ];
+            h->J->sa[j2] += ratio->mat_row[ off ];
         }
     }
 
-    h->F[ c ] = h->pimpl->ratio->residual;
+    h->F[ c ] = ratio->residual;
 
     return 0;
 }
@@ -1148,6 +1489,34 @@ maxconn(struct UnstructuredGrid *G)
  * ====================================================================== */
 
 
+/* ---------------------------------------------------------------------- */
+void
+cfs_tpfa_res_memory(const struct cfs_tpfa_res_data *h,
+                    size_t                         *matrix,
+                    size_t                         *work)
+/* ---------------------------------------------------------------------- */
+{
+    int                             t;
+    const struct cfs_tpfa_res_impl *pimpl;
+
+    pimpl = h->pimpl;
+
+    /* The matrix arrays are sized by the capacities, not the current
+     * number of rows and non-zeros. */
+    *matrix = sizeof *h->J
+        + (pimpl->nrow_cap + 1) * sizeof *h->J->ia
+        + pimpl->nnz_cap        * (sizeof *h->J->ja + sizeof *h->J->sa);
+
+    *work = sizeof *h + sizeof *pimpl
+        + pimpl->ddata_sz * sizeof *pimpl->ddata
+        + pimpl->nthreads * sizeof *pimpl->ratio_thr;
+
+    for (t = 0; t < pimpl->nthreads; t++) {
+        *work += pimpl->ratio_thr[t]->nbytes;
+    }
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 cfs_tpfa_res_destroy(struct cfs_tpfa_res_data *h)
@@ -1169,13 +1538,38 @@ cfs_tpfa_res_construct(struct UnstructuredGrid   *G      ,
                        int                        nphases)
 /* ---------------------------------------------------------------------- */
 {
-    size_t                    nf, nwperf;
+    return cfs_tpfa_res_construct_threaded(G, wells, nphases, 1);
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct cfs_tpfa_res_data *
+cfs_tpfa_res_construct_threaded(struct UnstructuredGrid   *G       ,
+                                struct cfs_tpfa_res_wells *wells   ,
+                                int                        nphases ,
+                                int                        nthreads)
+/* ---------------------------------------------------------------------- */
+{
+    size_t                    nw, nwperf;
     struct cfs_tpfa_res_data *h;
 
+#if defined(_OPENMP)
+    if (nthreads <= 0) { nthreads = omp_get_max_threads(); }
+#else
+    nthreads = 1;
+#endif
+
+    nw = nwperf = 0;
+    if ((wells != NULL) && (wells->W != NULL)) {
+        nw     = wells->W->number_of_wells;
+        nwperf = wells->W->well_connpos[ nw ];
+    }
+
     h = malloc(1 * sizeof *h);
 
     if (h != NULL) {
-        h->pimpl = impl_allocate(G, wells, maxconn(G), nphases);
+        h->pimpl = impl_allocate(G, nw, nwperf, maxconn(G),
+                                 nphases, nthreads);
         h->J     = construct_matrix(G, wells);
 
         if ((h->pimpl == NULL) || (h->J == NULL)) {
@@ -1185,33 +1579,58 @@ cfs_tpfa_res_construct(struct UnstructuredGrid   *G      ,
     }
 
     if (h != NULL) {
-        nf     = G->number_of_faces;
-        nwperf = 0;
+        h->pimpl->nrow_cap = h->J->m;
+        h->pimpl->nnz_cap  = h->J->nnz;
 
-        if ((wells != NULL) && (wells->W != NULL)) {
-            nwperf = wells->W->well_connpos[ wells->W->number_of_wells ];
-        }
+        set_impl_pointers(G, nphases, h);
+    }
 
-        /* Allocate linear system components */
-        h->F                       = h->pimpl->ddata + 0;
+    return h;
+}
 
-        h->pimpl->compflux_f       = h->F            + h->J->m;
-        h->pimpl->compflux_p       =
-            h->pimpl->compflux_f                     + (nphases * nf);
 
-        h->pimpl->compflux_deriv_f =
-            h->pimpl->compflux_p                     + (nphases * nwperf);
-        h->pimpl->compflux_deriv_p =
-            h->pimpl->compflux_deriv_f               + (nphases * 2 * nf);
+/* ---------------------------------------------------------------------- */
+int
+cfs_tpfa_res_update_wells(struct UnstructuredGrid   *G      ,
+                          struct cfs_tpfa_res_wells *wells  ,
+                          int                        nphases,
+                          struct cfs_tpfa_res_data  *h      )
+/* ---------------------------------------------------------------------- */
+{
+    size_t  nw, nwperf, nwell_cap, nperf_cap, ddata_sz;
+    double *ddata;
 
-        h->pimpl->flux_work        =
-            h->pimpl->compflux_deriv_p               + (nphases * 2 * nwperf);
+    nw = nwperf = 0;
+    if ((wells != NULL) && (wells->W != NULL)) {
+        nw     = wells->W->number_of_wells;
+        nwperf = wells->W->well_connpos[ nw ];
+    }
 
-        h->pimpl->scratch_f        =
-            h->pimpl->flux_work                      + (nphases * (1 + 2));
+    if ((nw > h->pimpl->nwell_cap) || (nwperf > h->pimpl->nperf_cap)) {
+        /* Reserve slack for additional wells and completions so that
+         * subsequent topology changes typically avoid reallocation. */
+        nwell_cap = MAX(nw     + 1 + nw     / 4, h->pimpl->nwell_cap);
+        nperf_cap = MAX(nwperf + 1 + nwperf / 4, h->pimpl->nperf_cap);
+
+        ddata_sz = ddata_size(G, nphases, nwell_cap, nperf_cap);
+        ddata    = malloc(ddata_sz * sizeof *ddata);
+        if (ddata == NULL) {
+            return 0;
+        }
+
+        /* Contents are recomputed in every assembly. */
+        free(h->pimpl->ddata);
+
+        h->pimpl->ddata     = ddata;
+        h->pimpl->ddata_sz  = ddata_sz;
+        h->pimpl->nwell_cap = nwell_cap;
+        h->pimpl->nperf_cap = nperf_cap;
+
+        set_impl_pointers(G, nphases, h);
     }
 
-    return h;
+    return rebuild_matrix(G, wells, h->pimpl,
+                          (int) (G->number_of_cells + nw), h->J);
 }
 
 
@@ -1230,30 +1649,47 @@ cfs_tpfa_res_assemble(struct UnstructuredGrid     *G        ,
                       struct cfs_tpfa_res_data    *h        )
 /* ---------------------------------------------------------------------- */
 {
-    int res_is_neumann, well_is_neumann, c, np2, singular;
+    int res_is_neumann, well_is_neumann, c, np, np2, singular, is_incomp;
+
+    struct densrat_util *ratio;
 
     csrmatrix_zero(         h->J);
     vector_zero   (h->J->m, h->F);
 
-    h->pimpl->is_incomp = 1;
-
     compute_compflux_and_deriv(G, cq->nphases, cpress, trans,
                                cq->phasemobf, gravcap_f, cq->Af, h->pimpl);
 
     res_is_neumann  = 1;
     well_is_neumann = 1;
 
-    np2 = cq->nphases * cq->nphases;
-    for (c = 0; c < G->number_of_cells;
-         c++, zc += cq->nphases) {
+    np  = cq->nphases;
+    np2 = np * np;
 
-        compute_cell_contrib(G, c, cq->nphases, porevol[c], dt, zc,
-                             cq->Ac + (c * np2), cq->dAc + (c * np2),
-                             h->pimpl);
+    /* Each cell contributes to its own matrix row only, so the cell
+     * loop needs no synchronisation beyond per-thread scratch space.
+     * Every row is formed by a single thread in the same order as in
+     * the serial case, whence the result does not depend on the
+     * number of threads. */
+    is_incomp = 1;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(h->pimpl->nthreads) schedule(static) \
+    private(ratio) reduction(&&:is_incomp) if (h->pimpl->nthreads > 1)
+#endif
+    for (c = 0; c < G->number_of_cells; c++) {
+        ratio = h->pimpl->ratio_thr[ current_thread() ];
+
+        is_incomp = compute_cell_contrib(G, c, np, porevol[c], dt,
+                                         zc + (c * np),
+                                         cq->Ac  + (c * np2),
+                                         cq->dAc + (c * np2),
+                                         h->pimpl, ratio)
+            && is_incomp;
 
-        assemble_cell_contrib(G, c, h);
+        assemble_cell_contrib(G, c, ratio, h);
     }
 
+    h->pimpl->is_incomp = is_incomp;
+
     if ((forces           != NULL) &&
         (forces->wells    != NULL) &&
         (forces->wells->W != NULL)) {
@@ -126,6 +126,61 @@ cfs_tpfa_res_construct(struct UnstructuredGrid   *G      ,
                        int                        nphases);
 
 
+/**
+ * Construct assembler for system of linear equations, using multiple threads
+ * for the reservoir (cell and interface) parts of the assembly process.
+ *
+ * Each thread is given its own scratch space for computing the per-cell fluid
+ * matrix ratios.  Since every cell contributes only to its own row of the
+ * Jacobian matrix, the assembled system is identical (bit-for-bit) to the
+ * system produced by the serial assembler created by function
+ * cfs_tpfa_res_construct().  Well contributions are always assembled serially.
+ *
+ * @param[in] G        Grid
+ * @param[in] wells    Well description.  @c NULL in case of no wells.
+ * @param[in] nphases  Number of active fluid phases in this simulation run.
+ * @param[in] nthreads Number of assembly threads.  Non-positive value selects
+ *                     the default number of OpenMP threads.  Ignored (treated
+ *                     as one) if the library is built without OpenMP support.
+ * @return Fully formed assembler structure.  @c NULL in case of allocation
+ * failure.  Must be destroyed using function cfs_tpfa_res_destroy().
+ */
+struct cfs_tpfa_res_data *
+cfs_tpfa_res_construct_threaded(struct UnstructuredGrid   *G       ,
+                                struct cfs_tpfa_res_wells *wells   ,
+                                int                        nphases ,
+                                int                        nthreads);
+
+
+/**
+ * Update assembler following a change in well topology (e.g., wells or
+ * completions being opened, shut, added or removed).
+ *
+ * Only the well-related parts of the sparsity structure of <CODE>h->J</CODE>
+ * are affected.  Existing storage is reused whenever it is sufficiently large
+ * and otherwise reallocated with some slack for subsequent changes.  The
+ * assembler pointer itself remains valid, although the arrays
+ * <CODE>h->J->ia</CODE>, <CODE>h->J->ja</CODE>, <CODE>h->J->sa</CODE> and
+ * <CODE>h->F</CODE> may be relocated.
+ *
+ * @param[in]     G       Grid.  Must be the same grid as the one used to
+ *                        construct the assembler.
+ * @param[in]     wells   New well description.  @c NULL in case of no wells.
+ * @param[in]     nphases Number of active fluid phases.  Must match the value
+ *                        used at construction time.
+ * @param[in,out] h       Assembler obtained from cfs_tpfa_res_construct() or
+ *                        cfs_tpfa_res_construct_threaded().
+ *
+ * @return 1 if successful and 0 in case of allocation failure.  In the latter
+ * case the assembler must be destroyed.
+ */
+int
+cfs_tpfa_res_update_wells(struct UnstructuredGrid   *G      ,
+                          struct cfs_tpfa_res_wells *wells  ,
+                          int                        nphases,
+                          struct cfs_tpfa_res_data  *h      );
+
+
 /**
  * Destroy assembler for system of linear equations.
  *
@@ -143,6 +198,24 @@ void
 cfs_tpfa_res_destroy(struct cfs_tpfa_res_data *h);
 
 
+/**
+ * Count the bytes allocated by an assembler.
+ *
+ * Storage reserved for additional wells and completions by function
+ * cfs_tpfa_res_update_wells() is included.
+ *
+ * @param[in]  h      Assembler obtained from cfs_tpfa_res_construct() or
+ *                    cfs_tpfa_res_construct_threaded().
+ * @param[out] matrix Bytes of the Jacobian matrix <CODE>h->J</CODE>.
+ * @param[out] work   Bytes of the residual and of the internal work arrays,
+ *                    including the per-thread scratch space.
+ */
+void
+cfs_tpfa_res_memory(const struct cfs_tpfa_res_data *h,
+                    size_t                         *matrix,
+                    size_t                         *work);
+
+
 /**
  * Assemble system of linear equations by linearising the residual around the
  * current pressure point.  Assume incompressible rock (i.e., that the
@@ -39,6 +39,7 @@ struct ifs_tpfa_impl {
 
     /* Linear storage */
     double *ddata;
+    size_t  ddata_sz;
 };
 
 
@@ -57,8 +58,9 @@ impl_deallocate(struct ifs_tpfa_impl *pimpl)
 
 /* ---------------------------------------------------------------------- */
 static struct ifs_tpfa_impl *
-impl_allocate(struct UnstructuredGrid *G,
-              struct Wells            *W)
+impl_allocate(int           nc,
+              int           nf,
+              struct Wells *W )
 /* ---------------------------------------------------------------------- */
 {
     struct ifs_tpfa_impl *new;
@@ -66,19 +68,20 @@ impl_allocate(struct UnstructuredGrid *G,
     size_t nnu;
     size_t ddata_sz;
 
-    nnu = G->number_of_cells;
+    nnu = nc;
     if (W != NULL) {
         nnu += W->number_of_wells;
     }
 
     ddata_sz  = 2 * nnu;                 /* b, x */
-    ddata_sz += 1 * G->number_of_faces;  /* fgrav */
+    ddata_sz += 1 * (size_t) nf;         /* fgrav */
     ddata_sz += 1 * nnu;                 /* work */
 
     new = malloc(1 * sizeof *new);
 
     if (new != NULL) {
-        new->ddata = malloc(ddata_sz * sizeof *new->ddata);
+        new->ddata    = malloc(ddata_sz * sizeof *new->ddata);
+        new->ddata_sz = ddata_sz;
 
         if (new->ddata == NULL) {
             impl_deallocate(new);
@@ -183,6 +186,100 @@ ifs_tpfa_construct_matrix(struct UnstructuredGrid *G,
 }
 
 
+/* ---------------------------------------------------------------------- */
+static int
+compare_int(const void *a, const void *b)
+/* ---------------------------------------------------------------------- */
+{
+    const int ia = *(const int *) a;
+    const int ib = *(const int *) b;
+
+    return (ia < ib) ? -1 : (ia > ib);
+}
+
+
+/* Form system matrix from cell-to-cell pattern 'P' (as created by
+ * ifs_tpfa_cell_pattern()) by appending well connections.  Rows stay
+ * sorted since well unknowns are numbered after all cells. */
+/* ---------------------------------------------------------------------- */
+static struct CSRMatrix *
+ifs_tpfa_construct_matrix_from_pattern(int                     nc,
+                                       struct Wells           *W ,
+                                       const struct CSRMatrix *P )
+/* ---------------------------------------------------------------------- */
+{
+    int    c, w, i, j, nnu;
+    size_t nnz;
+
+    struct CSRMatrix *A;
+
+    nnu = nc;
+    if (W != NULL) {
+        nnu += W->number_of_wells;
+    }
+
+    if (P->m != (size_t) nc) {
+        return NULL;
+    }
+
+    A = csrmatrix_new_count_nnz(nnu);
+
+    if (A != NULL) {
+        for (c = 0; c < nc; c++) {
+            A->ia[ c + 1 ] = P->ia[ c + 1 ] - P->ia[ c ];
+        }
+
+        if (W != NULL) {
+            for (w = i = 0; w < W->number_of_wells; w++) {
+                A->ia[ nc + w + 1 ] = 1;   /* Self connection */
+
+                for (; i < W->well_connpos[w + 1]; i++) {
+                    A->ia[ 0  + W->well_cells[i] + 1 ] += 1; /* c -> w */
+                    A->ia[ nc + w                + 1 ] += 1; /* w -> c */
+                }
+            }
+        }
+
+        nnz = csrmatrix_new_elms_pushback(A);
+        if (nnz == 0) {
+            csrmatrix_delete(A);
+            A = NULL;
+        }
+    }
+
+    if (A != NULL) {
+        for (c = 0; c < nc; c++) {
+            for (j = P->ia[ c ]; j < P->ia[ c + 1 ]; j++) {
+                A->ja[ A->ia[ c + 1 ] ++ ] = P->ja[ j ];
+            }
+        }
+
+        if (W != NULL) {
+            for (w = i = 0; w < W->number_of_wells; w++) {
+                for (; i < W->well_connpos[w + 1]; i++) {
+                    c = W->well_cells[i];
+
+                    A->ja[ A->ia[ 0  + c + 1 ] ++ ] = nc + w;
+                    A->ja[ A->ia[ nc + w + 1 ] ++ ] = c     ;
+                }
+                A->ja[ A->ia[ nc + w + 1 ] ++ ] = nc + w;
+            }
+
+            /* Cell rows may only be complete once all wells are done. */
+            for (w = 0; w < W->number_of_wells; w++) {
+                qsort(A->ja + A->ia[ nc + w ],
+                      A->ia[ nc + w + 1 ] - A->ia[ nc + w ],
+                      sizeof *A->ja, compare_int);
+            }
+        }
+
+        assert ((size_t) A->ia[ nnu ] == nnz);
+    }
+
+    return A;
+}
+
+
 /* ---------------------------------------------------------------------- */
 /* fgrav = accumarray(cf(j), grav(j).*sgn(j), [nf, 1]) */
 /* ---------------------------------------------------------------------- */
@@ -342,7 +439,7 @@ assemble_shut_well(int nc, int w,
 
 /* ---------------------------------------------------------------------- */
 static void
-assemble_well_contrib(int                   nc ,
+assemble_well_contrib_impl(int                   nc ,
                       const struct Wells   *W  ,
                       const double         *mt ,
                       const double         *wdp,
@@ -640,9 +737,9 @@ assemble_incompressible(struct UnstructuredGrid      *G     ,
                     (size_t) G->number_of_cells +
                     (size_t) F->W->number_of_wells);
 
-            assemble_well_contrib(G->number_of_cells, F->W,
-                                  F->totmob, F->wdp, h,
-                                  &wells_are_rate, ok);
+            assemble_well_contrib_impl(G->number_of_cells, F->W,
+                                       F->totmob, F->wdp, h,
+                                       &wells_are_rate, ok);
         }
 
         if (F->bc != NULL) {
@@ -670,13 +767,39 @@ struct ifs_tpfa_data *
 ifs_tpfa_construct(struct UnstructuredGrid *G,
                    struct Wells            *W)
 /* ---------------------------------------------------------------------- */
+{
+    return ifs_tpfa_construct_with_pattern(G, W, NULL);
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct CSRMatrix *
+ifs_tpfa_cell_pattern(struct UnstructuredGrid *G)
+/* ---------------------------------------------------------------------- */
+{
+    return ifs_tpfa_construct_matrix(G, NULL);
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct ifs_tpfa_data *
+ifs_tpfa_construct_with_pattern(struct UnstructuredGrid *G,
+                                struct Wells            *W,
+                                const struct CSRMatrix  *P)
+/* ---------------------------------------------------------------------- */
 {
     struct ifs_tpfa_data *new;
 
+    if (P != NULL) {
+        return ifs_tpfa_construct_from_pattern(G->number_of_cells,
+                                               G->number_of_faces, W, P);
+    }
+
     new = malloc(1 * sizeof *new);
 
     if (new != NULL) {
-        new->pimpl = impl_allocate(G, W);
+        new->pimpl = impl_allocate(G->number_of_cells,
+                                   G->number_of_faces, W);
         new->A     = ifs_tpfa_construct_matrix(G, W);
 
         if ((new->pimpl == NULL) || (new->A == NULL)) {
@@ -697,6 +820,68 @@ ifs_tpfa_construct(struct UnstructuredGrid *G,
 }
 
 
+/* ---------------------------------------------------------------------- */
+struct ifs_tpfa_data *
+ifs_tpfa_construct_from_pattern(int                     nc,
+                                int                     nf,
+                                struct Wells           *W ,
+                                const struct CSRMatrix *P )
+/* ---------------------------------------------------------------------- */
+{
+    struct ifs_tpfa_data *new;
+
+    new = malloc(1 * sizeof *new);
+
+    if (new != NULL) {
+        new->pimpl = impl_allocate(nc, nf, W);
+        new->A     = ifs_tpfa_construct_matrix_from_pattern(nc, W, P);
+
+        if ((new->pimpl == NULL) || (new->A == NULL)) {
+            ifs_tpfa_destroy(new);
+            new = NULL;
+        }
+    }
+
+    if (new != NULL) {
+        new->b = new->pimpl->ddata;
+        new->x = new->b                       + new->A->m;
+
+        new->pimpl->fgrav = new->x            + new->A->m;
+        new->pimpl->work  = new->pimpl->fgrav + nf;
+    }
+
+    return new;
+}
+
+
+/* ---------------------------------------------------------------------- */
+double *
+ifs_tpfa_face_gravity(struct ifs_tpfa_data *h)
+/* ---------------------------------------------------------------------- */
+{
+    return h->pimpl->fgrav;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+ifs_tpfa_assemble_well_contrib(int                           nc      ,
+                               const struct ifs_tpfa_forces *F       ,
+                               struct ifs_tpfa_data         *h       ,
+                               int                          *all_rate)
+/* ---------------------------------------------------------------------- */
+{
+    int ok;
+
+    assert (h->A->m == (size_t) nc + (size_t) F->W->number_of_wells);
+
+    assemble_well_contrib_impl(nc, F->W, F->totmob, F->wdp, h,
+                               all_rate, &ok);
+
+    return ok;
+}
+
+
 /* ---------------------------------------------------------------------- */
 int
 ifs_tpfa_assemble(struct UnstructuredGrid      *G     ,
@@ -861,6 +1046,19 @@ ifs_tpfa_press_flux(struct UnstructuredGrid      *G    ,
 }
 
 
+/* ---------------------------------------------------------------------- */
+void
+ifs_tpfa_memory(const struct ifs_tpfa_data *h,
+                size_t                     *matrix,
+                size_t                     *work)
+/* ---------------------------------------------------------------------- */
+{
+    *matrix = csrmatrix_memory(h->A);
+    *work   = sizeof *h + sizeof *h->pimpl
+        + h->pimpl->ddata_sz * sizeof *h->pimpl->ddata;
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 ifs_tpfa_destroy(struct ifs_tpfa_data *h)
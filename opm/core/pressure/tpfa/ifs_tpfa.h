@@ -92,6 +92,86 @@ ifs_tpfa_construct(struct UnstructuredGrid *G,
                    struct Wells            *W);
 
 
+/**
+ * Create the cell-to-cell sparsity pattern of the TPFA system matrix.
+ *
+ * The pattern depends on the grid only and may be shared by any number of
+ * TPFA management structures through ifs_tpfa_construct_with_pattern().
+ *
+ * @param[in] G Grid.
+ * @return Pattern with sorted rows (values unspecified) if successful,
+ * @c NULL in case of allocation failure.  Must be released using
+ * csrmatrix_delete().
+ */
+struct CSRMatrix *
+ifs_tpfa_cell_pattern(struct UnstructuredGrid *G);
+
+
+/**
+ * Allocate TPFA management structure as ifs_tpfa_construct(), deriving the
+ * system matrix structure from a precomputed cell-to-cell pattern.
+ *
+ * @param[in] G Grid.
+ * @param[in] W Well topology.
+ * @param[in] P Pattern created by ifs_tpfa_cell_pattern() for @c G.  Not
+ *              retained.  Behaves as ifs_tpfa_construct() if @c NULL.
+ * @return Fully formed TPFA management structure if successful, @c NULL in case
+ * of allocation failure or if @c P does not match @c G.
+ */
+struct ifs_tpfa_data *
+ifs_tpfa_construct_with_pattern(struct UnstructuredGrid *G,
+                                struct Wells            *W,
+                                const struct CSRMatrix  *P);
+
+
+/**
+ * Allocate TPFA management structure from grid sizes and a cell-to-cell
+ * pattern only.  Used by the grid templated assembly (IfsTpfa.hpp) for
+ * grids without an UnstructuredGrid representation.
+ *
+ * @param[in] nc Number of grid cells.
+ * @param[in] nf Number of grid faces.
+ * @param[in] W  Well topology.
+ * @param[in] P  Cell-to-cell pattern with sorted rows and @c nc rows.  Not
+ *               retained.
+ * @return Fully formed TPFA management structure if successful, @c NULL in case
+ * of allocation failure or if @c P does not have @c nc rows.
+ */
+struct ifs_tpfa_data *
+ifs_tpfa_construct_from_pattern(int                     nc,
+                                int                     nf,
+                                struct Wells           *W ,
+                                const struct CSRMatrix *P );
+
+
+/**
+ * Face gravity contributions of the most recent assembly.
+ *
+ * @param[in] h TPFA management structure.
+ * @return Array of one value per grid face, written by the assembly
+ * routines and read by ifs_tpfa_press_flux().
+ */
+double *
+ifs_tpfa_face_gravity(struct ifs_tpfa_data *h);
+
+
+/**
+ * Add well contributions to the TPFA system, as done by ifs_tpfa_assemble().
+ *
+ * @param[in]     nc       Number of grid cells.
+ * @param[in]     F        Driving forces with non-NULL wells, total mobility
+ *                         and well gravity adjustment.
+ * @param[in,out] h        TPFA management structure.
+ * @param[out]    all_rate Whether all wells are rate controlled.
+ * @return One if successful, zero if a well control is not supported.
+ */
+int
+ifs_tpfa_assemble_well_contrib(int                           nc      ,
+                               const struct ifs_tpfa_forces *F       ,
+                               struct ifs_tpfa_data         *h       ,
+                               int                          *all_rate);
+
+
 /**
  *
  * @param[in]     G
@@ -138,6 +218,19 @@ ifs_tpfa_press_flux(struct UnstructuredGrid      *G    ,
                     struct ifs_tpfa_data         *h    ,
                     struct ifs_tpfa_solution     *soln );
 
+/**
+ * Count the bytes allocated by an assembler.
+ *
+ * @param[in]  h      Assembler obtained from ifs_tpfa_construct().
+ * @param[out] matrix Bytes of the coefficient matrix <CODE>h->A</CODE>.
+ * @param[out] work   Bytes of the right-hand side, solution and
+ *                    internal work arrays.
+ */
+void
+ifs_tpfa_memory(const struct ifs_tpfa_data *h,
+                size_t                     *matrix,
+                size_t                     *work);
+
 void
 ifs_tpfa_destroy(struct ifs_tpfa_data *h);
 
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include <opm/core/linalg/blas_lapack.h>
+#include <opm/core/grid/geometry_soa.h>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 
 
@@ -69,6 +70,116 @@ tpfa_htrans_compute(struct UnstructuredGrid *G, const double *perm, double *htra
 }
 
 
+/* ---------------------------------------------------------------------- */
+void
+tpfa_htrans_compute_soa(struct UnstructuredGrid      *G,
+                        const struct GridGeometrySoA *geom,
+                        const double                 *perm,
+                        double                       *htrans)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, d, f, i, j, k, nc;
+    double s, dist, denom, Kn, t;
+
+    const double *K;
+
+    d  = G->dimensions;
+    nc = G->number_of_cells;
+
+    assert (geom->dimensions == d);
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) \
+    private(f, i, j, k, s, dist, denom, Kn, t, K)
+#endif
+    for (c = 0; c < nc; c++) {
+        K = perm + (c * d * d);
+
+        for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+            f = G->cell_faces[i];
+            s = 2.0*(G->face_cells[2*f + 0] == c) - 1.0;
+
+            t = denom = 0.0;
+            for (j = 0; j < d; j++) {
+                /* Column-major K, as in tpfa_htrans_compute(). */
+                Kn = 0.0;
+                for (k = 0; k < d; k++) {
+                    Kn += K[j + k*d] * geom->face_normals[k][f];
+                }
+
+                dist = geom->face_centroids[j][f] - geom->cell_centroids[j][c];
+
+                t     += dist * Kn;
+                denom += dist * dist;
+            }
+
+            assert (denom > 0);
+            htrans[i] = fabs(s * t / denom);
+        }
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+tpfa_htrans_compute_sp(struct UnstructuredGrid *G     ,
+                       const float             *perm  ,
+                       double                  *htrans)
+/* ---------------------------------------------------------------------- */
+{
+    int    c, d, f, i, j, k, nc;
+    double s, dist, denom, Kn, t;
+
+    double K[3 * 3];
+    const float  *Kc;
+    const double *cc, *fc, *n;
+
+    d  = G->dimensions;
+    nc = G->number_of_cells;
+
+    assert ((d > 0) && (d <= 3));
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) \
+    private(f, i, j, k, s, dist, denom, Kn, t, K, Kc, cc, fc, n)
+#endif
+    for (c = 0; c < nc; c++) {
+        /* Widen the cell's tensor once for all of its faces. */
+        Kc = perm + (c * d * d);
+        for (j = 0; j < d * d; j++) {
+            K[j] = Kc[j];
+        }
+
+        cc = G->cell_centroids + (c * d);
+
+        for (i = G->cell_facepos[c]; i < G->cell_facepos[c + 1]; i++) {
+            f = G->cell_faces[i];
+            s = 2.0*(G->face_cells[2*f + 0] == c) - 1.0;
+
+            n  = G->face_normals   + (f * d);
+            fc = G->face_centroids + (f * d);
+
+            t = denom = 0.0;
+            for (j = 0; j < d; j++) {
+                /* Column-major K, as in tpfa_htrans_compute(). */
+                Kn = 0.0;
+                for (k = 0; k < d; k++) {
+                    Kn += K[j + k*d] * n[k];
+                }
+
+                dist = fc[j] - cc[j];
+
+                t     += dist * Kn;
+                denom += dist * dist;
+            }
+
+            assert (denom > 0);
+            htrans[i] = fabs(s * t / denom);
+        }
+    }
+}
+
+
 /* ---------------------------------------------------------------------- */
 void
 tpfa_trans_compute(struct UnstructuredGrid *G, const double *htrans, double *trans)
@@ -128,3 +239,217 @@ tpfa_eff_trans_compute(struct UnstructuredGrid       *G,
         trans[f] = 1.0 / trans[f];
     }
 }
+
+
+/* ---------------------------------------------------------------------- */
+void
+tpfa_face_halffaces(const struct UnstructuredGrid *G, int *fhf)
+/* ---------------------------------------------------------------------- */
+{
+    int c, i, f, k;
+
+    for (f = 0; f < 2 * G->number_of_faces; f++) {
+        fhf[f] = -1;
+    }
+
+    for (c = i = 0; c < G->number_of_cells; c++) {
+        for (; i < G->cell_facepos[c + 1]; i++) {
+            f = G->cell_faces[i];
+
+            /* A cell found on both sides of a face fills both slots. */
+            k = ((G->face_cells[2*f + 0] == c) && (fhf[2*f + 0] < 0)) ? 0 : 1;
+
+            fhf[2*f + k] = i;
+        }
+    }
+}
+
+
+/* Effective transmissibility of face 'f' */
+/* ---------------------------------------------------------------------- */
+static double
+face_eff_trans(const struct UnstructuredGrid *G     ,
+               const int                     *fhf   ,
+               const double                  *totmob,
+               const double                  *htrans,
+               int                            f     )
+/* ---------------------------------------------------------------------- */
+{
+    int    k, c;
+    double t;
+
+    t = 0.0;
+    for (k = 0; k < 2; k++) {
+        c = G->face_cells[2*f + k];
+
+        if (c >= 0) {
+            t += 1.0 / (totmob[c] * htrans[fhf[2*f + k]]);
+        }
+    }
+
+    return 1.0 / t;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+tpfa_eff_trans_compute_faces(const struct UnstructuredGrid *G     ,
+                             const int                     *fhf   ,
+                             const double                  *totmob,
+                             const double                  *htrans,
+                             double                        *trans )
+/* ---------------------------------------------------------------------- */
+{
+    int f, nf;
+
+    nf = G->number_of_faces;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (f = 0; f < nf; f++) {
+        trans[f] = face_eff_trans(G, fhf, totmob, htrans, f);
+    }
+}
+
+
+/* Effective transmissibility of face 'f', single precision 'htrans' */
+/* ---------------------------------------------------------------------- */
+static double
+face_eff_trans_sp(const struct UnstructuredGrid *G     ,
+                  const int                     *fhf   ,
+                  const double                  *totmob,
+                  const float                   *htrans,
+                  int                            f     )
+/* ---------------------------------------------------------------------- */
+{
+    int    k, c;
+    double t;
+
+    t = 0.0;
+    for (k = 0; k < 2; k++) {
+        c = G->face_cells[2*f + k];
+
+        if (c >= 0) {
+            t += 1.0 / (totmob[c] * (double) htrans[fhf[2*f + k]]);
+        }
+    }
+
+    return 1.0 / t;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+tpfa_eff_trans_compute_faces_sp(const struct UnstructuredGrid *G     ,
+                                const int                     *fhf   ,
+                                const double                  *totmob,
+                                const float                   *htrans,
+                                double                        *trans )
+/* ---------------------------------------------------------------------- */
+{
+    int f, nf;
+
+    nf = G->number_of_faces;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (f = 0; f < nf; f++) {
+        trans[f] = face_eff_trans_sp(G, fhf, totmob, htrans, f);
+    }
+}
+
+
+/* Has the mobility of cell 'c' changed by more than the tolerance? */
+/* ---------------------------------------------------------------------- */
+static int
+mobility_changed(int c, const double *totmob, const double *mobref,
+                 double tol)
+/* ---------------------------------------------------------------------- */
+{
+    return (c >= 0) && (fabs(totmob[c] - mobref[c]) > tol * mobref[c]);
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+tpfa_eff_trans_update(const struct UnstructuredGrid *G     ,
+                      const int                     *fhf   ,
+                      const double                  *totmob,
+                      const double                  *htrans,
+                      double                         tol   ,
+                      double                        *mobref,
+                      double                        *trans )
+/* ---------------------------------------------------------------------- */
+{
+    int c, f, nc, nf, nupd;
+
+    nc   = G->number_of_cells;
+    nf   = G->number_of_faces;
+    nupd = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) reduction(+:nupd)
+#endif
+    for (f = 0; f < nf; f++) {
+        if (mobility_changed(G->face_cells[2*f + 0], totmob, mobref, tol) ||
+            mobility_changed(G->face_cells[2*f + 1], totmob, mobref, tol)) {
+            trans[f] = face_eff_trans(G, fhf, totmob, htrans, f);
+            nupd    += 1;
+        }
+    }
+
+    /* Separate pass: the face sweep reads the reference of every cell. */
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (c = 0; c < nc; c++) {
+        if (mobility_changed(c, totmob, mobref, tol)) {
+            mobref[c] = totmob[c];
+        }
+    }
+
+    return nupd;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+tpfa_eff_trans_update_sp(const struct UnstructuredGrid *G     ,
+                         const int                     *fhf   ,
+                         const double                  *totmob,
+                         const float                   *htrans,
+                         double                         tol   ,
+                         double                        *mobref,
+                         double                        *trans )
+/* ---------------------------------------------------------------------- */
+{
+    int c, f, nc, nf, nupd;
+
+    nc   = G->number_of_cells;
+    nf   = G->number_of_faces;
+    nupd = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) reduction(+:nupd)
+#endif
+    for (f = 0; f < nf; f++) {
+        if (mobility_changed(G->face_cells[2*f + 0], totmob, mobref, tol) ||
+            mobility_changed(G->face_cells[2*f + 1], totmob, mobref, tol)) {
+            trans[f] = face_eff_trans_sp(G, fhf, totmob, htrans, f);
+            nupd    += 1;
+        }
+    }
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (c = 0; c < nc; c++) {
+        if (mobility_changed(c, totmob, mobref, tol)) {
+            mobref[c] = totmob[c];
+        }
+    }
+
+    return nupd;
+}
@@ -31,6 +31,8 @@
 extern "C" {
 #endif
 
+struct GridGeometrySoA;
+
 /**
  * Calculate static, one-sided transmissibilities for use in the two-point flux
  * approximation method.
@@ -54,6 +56,45 @@ tpfa_htrans_compute(struct UnstructuredGrid *G     ,
                     const double            *perm  ,
                     double                  *htrans);
 
+/**
+ * Calculate static, one-sided transmissibilities as tpfa_htrans_compute(),
+ * reading the grid geometry from a structure-of-arrays mirror.
+ *
+ * Avoids a BLAS call per half-face and processes cells in parallel if
+ * OpenMP is enabled.
+ *
+ * @param[in]  G       Grid.
+ * @param[in]  geom    Geometry of @c G from create_geometry_soa().
+ * @param[in]  perm    Permeability.  One symmetric, positive definite tensor
+ *                     per grid cell.
+ * @param[out] htrans  One-sided transmissibilities.  Array of size at least
+ *                     <CODE>G->cell_facepos[ G->number_of_cells  ]</CODE>.
+ */
+void
+tpfa_htrans_compute_soa(struct UnstructuredGrid      *G     ,
+                        const struct GridGeometrySoA *geom  ,
+                        const double                 *perm  ,
+                        double                       *htrans);
+
+/**
+ * Calculate static, one-sided transmissibilities as tpfa_htrans_compute(),
+ * from a permeability field stored in single precision.
+ *
+ * Each cell's tensor is widened to double precision before use, so only
+ * the storage of @c perm is reduced.  Cells are processed in parallel if
+ * OpenMP is enabled.
+ *
+ * @param[in]  G       Grid.
+ * @param[in]  perm    Permeability.  One symmetric, positive definite tensor
+ *                     per grid cell.
+ * @param[out] htrans  One-sided transmissibilities.  Array of size at least
+ *                     <CODE>G->cell_facepos[ G->number_of_cells  ]</CODE>.
+ */
+void
+tpfa_htrans_compute_sp(struct UnstructuredGrid *G     ,
+                       const float             *perm  ,
+                       double                  *htrans);
+
 /**
  * Compute two-point transmissibilities from one-sided transmissibilities.
  *
@@ -103,6 +144,114 @@ tpfa_eff_trans_compute(struct UnstructuredGrid *G     ,
                        const double            *htrans,
                        double                  *trans );
 
+/**
+ * Map each face to the one-sided transmissibilities of its two cells.
+ *
+ * Entry <CODE>fhf[2*f + k]</CODE> is the half-face (cell-face) index, into
+ * arrays such as @c htrans, corresponding to cell
+ * <CODE>G->face_cells[2*f + k]</CODE>, or -1 if that cell is outside the
+ * domain.  The map depends only on the grid topology and enables the
+ * face-parallel routines tpfa_eff_trans_compute_faces() and
+ * tpfa_eff_trans_update().
+ *
+ * @param[in]  G    Grid.
+ * @param[out] fhf  Face to half-face map.  Array of size at least
+ *                  <CODE>2 * G->number_of_faces</CODE>.
+ */
+void
+tpfa_face_halffaces(const struct UnstructuredGrid *G, int *fhf);
+
+/**
+ * Calculate effective two-point transmissibilities as
+ * tpfa_eff_trans_compute(), but in a single sweep over the faces.
+ *
+ * Each face is computed independently from the mobilities and one-sided
+ * transmissibilities of its two cells, so there is no intermediate
+ * accumulation and faces are processed in parallel if OpenMP is enabled.
+ * The results are identical to those of tpfa_eff_trans_compute().
+ *
+ * @param[in]  G      Grid.
+ * @param[in]  fhf    Face to half-face map from tpfa_face_halffaces().
+ * @param[in]  totmob Total mobilities. One positive scalar value for each cell.
+ * @param[in]  htrans One-sided transmissibilities as defined by function
+ *                    tpfa_htrans_compute().
+ * @param[out] trans  Effective, two-point transmissibilities.  Array of size at
+ *                    least <CODE>G->number_of_faces</CODE>.
+ */
+void
+tpfa_eff_trans_compute_faces(const struct UnstructuredGrid *G     ,
+                             const int                     *fhf   ,
+                             const double                  *totmob,
+                             const double                  *htrans,
+                             double                        *trans );
+
+/**
+ * Incrementally update effective two-point transmissibilities.
+ *
+ * Recomputes, as tpfa_eff_trans_compute_faces(), only those faces that
+ * connect to a cell @c c whose total mobility has changed by more than
+ * <CODE>tol * mobref[c]</CODE> since it was last used.  The reference
+ * mobilities of those cells are then set to @c totmob.  With
+ * <CODE>tol == 0</CODE> the result equals a full recomputation.
+ *
+ * @param[in]     G      Grid.
+ * @param[in]     fhf    Face to half-face map from tpfa_face_halffaces().
+ * @param[in]     totmob Total mobilities. One positive scalar value for each
+ *                       cell.
+ * @param[in]     htrans One-sided transmissibilities as defined by function
+ *                       tpfa_htrans_compute().
+ * @param[in]     tol    Relative mobility change tolerance.  Non-negative.
+ * @param[in,out] mobref Mobilities from which @c trans was last computed.
+ *                       One value for each cell.
+ * @param[in,out] trans  Effective, two-point transmissibilities corresponding
+ *                       to @c mobref on input, updated on output.
+ *
+ * @return Number of recomputed faces.
+ */
+int
+tpfa_eff_trans_update(const struct UnstructuredGrid *G     ,
+                      const int                     *fhf   ,
+                      const double                  *totmob,
+                      const double                  *htrans,
+                      double                         tol   ,
+                      double                        *mobref,
+                      double                        *trans );
+
+/**
+ * Calculate effective two-point transmissibilities as
+ * tpfa_eff_trans_compute_faces(), from one-sided transmissibilities stored
+ * in single precision.  Values are widened on the fly.
+ *
+ * @param[in]  G      Grid.
+ * @param[in]  fhf    Face to half-face map from tpfa_face_halffaces().
+ * @param[in]  totmob Total mobilities. One positive scalar value for each cell.
+ * @param[in]  htrans One-sided transmissibilities in single precision.
+ * @param[out] trans  Effective, two-point transmissibilities.  Array of size at
+ *                    least <CODE>G->number_of_faces</CODE>.
+ */
+void
+tpfa_eff_trans_compute_faces_sp(const struct UnstructuredGrid *G     ,
+                                const int                     *fhf   ,
+                                const double                  *totmob,
+                                const float                   *htrans,
+                                double                        *trans );
+
+/**
+ * Incrementally update effective two-point transmissibilities as
+ * tpfa_eff_trans_update(), from one-sided transmissibilities stored in
+ * single precision.
+ *
+ * @return Number of recomputed faces.
+ */
+int
+tpfa_eff_trans_update_sp(const struct UnstructuredGrid *G     ,
+                         const int                     *fhf   ,
+                         const double                  *totmob,
+                         const float                   *htrans,
+                         double                         tol   ,
+                         double                        *mobref,
+                         double                        *trans );
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,14 +21,154 @@
 #include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
 #include <opm/material/fluidmatrixinteractions/EclMaterialLawManager.hpp>
 #include <opm/core/props/phaseUsageFromDeck.hpp>
+#include <opm/core/props/NumPhasesDispatch.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/utility/compressedToCartesian.hpp>
+#include <opm/core/utility/CellRegionIndex.hpp>
 #include <opm/core/utility/extractPvtTableIndex.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+#include <algorithm>
 #include <vector>
 #include <numeric>
 
 namespace Opm
 {
+
+    namespace
+    {
+        // Smallest number of points for which the property
+        // evaluations are spread over threads. Single-point calls are
+        // common and not worth the cost of a parallel region.
+        const int ParallelMinPoints = 64;
+
+        // Saturation region ('SATNUM' - 1) of each active cell.
+        std::vector<int> cellSatRegions(Opm::EclipseStateConstPtr eclState,
+                                        const int number_of_cells,
+                                        const int* global_cell)
+        {
+            return CellRegionIndex::get(eclState, "SATNUM", number_of_cells, global_cell)->toInt();
+        }
+
+        // Form A = R*inv(B), and optionally dA/dp, for a single data
+        // point from its formation volume factors and dissolution
+        // factors (and their pressure derivatives if dAdp is non-null).
+        //
+        // A     = R*inv(B) whence
+        //
+        // dA/dp = (dR/dp*inv(B) + R*d(inv(B))/dp)
+        //       = (dR/dp*inv(B) - R*inv(B)*(dB/dp)*inv(B))
+        //       = (dR/dp - A*(dB/dp)) * inv(B)
+        //
+        // The B matrix is diagonal and that fact is exploited in the
+        // following implementation. The number of phases is a
+        // NumPhases object, see dispatchNumPhases().
+        template <class NP>
+        void formMatrix(const NP np, const bool oil_and_gas,
+                        const int o, const int g,
+                        const double* B, const double* R,
+                        const double* dB, const double* dR,
+                        double* A, double* dAdp)
+        {
+            std::fill(A, A + np()*np(), 0.0);
+            // Diagonal entries.
+            for (int phase = 0; phase < np(); ++phase) {
+                A[phase + phase*np()] = 1.0/B[phase];
+            }
+            // Off-diagonal entries.
+            if (oil_and_gas) {
+                A[o + g*np()] = R[g]/B[g];
+                A[g + o*np()] = R[o]/B[o];
+            }
+            if (dAdp) {
+                double* m = dAdp;
+
+                // (1): dA/dp <- A
+                std::copy(A, A + np()*np(), m);
+
+                // (2): dA/dp <- -dA/dp*(dB/dp) == -A*(dB/dp)
+                for (int col = 0; col < np(); ++col) {
+                    for (int row = 0; row < np(); ++row) {
+                        m[col*np() + row] *= - dB[ col ]; // Note sign.
+                    }
+                }
+
+                if (oil_and_gas) {
+                    // (2b): dA/dp += dR/dp (== dR/dp - A*(dB/dp))
+                    m[o*np() + g] += dR[ o ];
+                    m[g*np() + o] += dR[ g ];
+                }
+
+                // (3): dA/dp *= inv(B) (== final result)
+                for (int col = 0; col < np(); ++col) {
+                    for (int row = 0; row < np(); ++row) {
+                        m[col*np() + row] /= B[ col ];
+                    }
+                }
+            }
+        }
+
+        // formMatrix() for each of n data points.
+        struct FormMatrices
+        {
+            int n;
+            bool oil_and_gas;
+            int o;
+            int g;
+            const double* B;
+            const double* R;
+            const double* dB;
+            const double* dR;
+            double* A;
+            double* dAdp;
+
+            template <class NP>
+            void operator()(const NP np) const
+            {
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+                for (int i = 0; i < n; ++i) {
+                    formMatrix(np, oil_and_gas, o, g, B + i*np(), R + i*np(),
+                               dAdp ? dB + i*np() : 0, dAdp ? dR + i*np() : 0,
+                               A + i*np()*np(), dAdp ? dAdp + i*np()*np() : 0);
+                }
+            }
+        };
+    }
+
+    /// Read the fluid tables of a deck.
+    BlackoilPropertiesFromDeck::PvtTables::PvtTables(Opm::DeckConstPtr deck,
+                                                     Opm::EclipseStateConstPtr eclState)
+        : phaseUsage(phaseUsageFromDeck(deck))
+    {
+        oilPvt.initFromDeck(deck, eclState);
+        gasPvt.initFromDeck(deck, eclState);
+        waterPvt.initFromDeck(deck, eclState);
+
+        const auto& pu = phaseUsage;
+        int np = pu.num_phases;
+        int numPvtRegions = 1;
+        if (deck->hasKeyword("TABDIMS")) {
+            const auto& tabdimsKeyword = deck->getKeyword("TABDIMS");
+            numPvtRegions = tabdimsKeyword.getRecord(0).getItem("NTPVT").template get<int>(0);
+        }
+
+        const auto& densityKeyword = deck->getKeyword("DENSITY");
+
+        surfaceDensities.resize(np*numPvtRegions);
+        for (int pvtRegionIdx = 0; pvtRegionIdx < numPvtRegions; ++pvtRegionIdx) {
+            if (pu.phase_used[BlackoilPhases::Aqua])
+                surfaceDensities[np*pvtRegionIdx + pu.phase_pos[BlackoilPhases::Aqua]] =
+                    densityKeyword.getRecord(pvtRegionIdx).getItem("WATER").getSIDouble(0);
+
+            if (pu.phase_used[BlackoilPhases::Liquid])
+                surfaceDensities[np*pvtRegionIdx + pu.phase_pos[BlackoilPhases::Liquid]] =
+                    densityKeyword.getRecord(pvtRegionIdx).getItem("OIL").getSIDouble(0);
+
+            if (pu.phase_used[BlackoilPhases::Vapour])
+                surfaceDensities[np*pvtRegionIdx + pu.phase_pos[BlackoilPhases::Vapour]] =
+                    densityKeyword.getRecord(pvtRegionIdx).getItem("GAS").getSIDouble(0);
+        }
+    }
+
     BlackoilPropertiesFromDeck::BlackoilPropertiesFromDeck(Opm::DeckConstPtr deck,
                                                            Opm::EclipseStateConstPtr eclState,
                                                            const UnstructuredGrid& grid,
@@ -119,6 +259,27 @@ namespace Opm
              init_rock);
     }
 
+    BlackoilPropertiesFromDeck::BlackoilPropertiesFromDeck(Opm::DeckConstPtr deck,
+                                                           Opm::EclipseStateConstPtr eclState,
+                                                           std::shared_ptr<const PvtTables> pvtTables,
+                                                           std::shared_ptr<MaterialLawManager> materialLawManager,
+                                                           int number_of_cells,
+                                                           const int* global_cell,
+                                                           const int* cart_dims,
+                                                           const parameter::ParameterGroup& param,
+                                                           bool init_rock)
+        : pvtTables_(pvtTables)
+    {
+        init(deck,
+             eclState,
+             materialLawManager,
+             number_of_cells,
+             global_cell,
+             cart_dims,
+             param,
+             init_rock);
+    }
+
     inline void BlackoilPropertiesFromDeck::init(Opm::DeckConstPtr deck,
                                                  Opm::EclipseStateConstPtr eclState,
                                                  std::shared_ptr<MaterialLawManager> materialLawManager,
@@ -130,18 +291,20 @@ namespace Opm
         // retrieve the cell specific PVT table index from the deck
         // and using the grid...
         extractPvtTableIndex(cellPvtRegionIdx_, eclState, number_of_cells, global_cell);
+        pvtRegionOrder_ = RegionSortedOrder(cellPvtRegionIdx_);
 
         if (init_rock){
            rock_.init(eclState, number_of_cells, global_cell, cart_dims);
         }
-        phaseUsage_ = phaseUsageFromDeck(deck);
-        initSurfaceDensities_(deck);
-        oilPvt_.initFromDeck(deck, eclState);
-        gasPvt_.initFromDeck(deck, eclState);
-        waterPvt_.initFromDeck(deck, eclState);
+        if (!pvtTables_) {
+            pvtTables_ = std::make_shared<PvtTables>(deck, eclState);
+        }
+        phaseUsage_ = pvtTables_->phaseUsage;
+        materialLawManager_ = materialLawManager;
         SaturationPropsFromDeck* ptr
             = new SaturationPropsFromDeck();
-        ptr->init(phaseUsageFromDeck(deck), materialLawManager);
+        ptr->init(phaseUsage_, materialLawManager);
+        ptr->setCellRegions(cellSatRegions(eclState, number_of_cells, global_cell));
         satprops_.reset(ptr);
     }
 
@@ -157,16 +320,17 @@ namespace Opm
         // retrieve the cell specific PVT table index from the deck
         // and using the grid...
         extractPvtTableIndex(cellPvtRegionIdx_, eclState, number_of_cells, global_cell);
+        pvtRegionOrder_ = RegionSortedOrder(cellPvtRegionIdx_);
 
         if(init_rock){
             rock_.init(eclState, number_of_cells, global_cell, cart_dims);
         }
 
-        phaseUsage_ = phaseUsageFromDeck(deck);
-        initSurfaceDensities_(deck);
-        oilPvt_.initFromDeck(deck, eclState);
-        gasPvt_.initFromDeck(deck, eclState);
-        waterPvt_.initFromDeck(deck, eclState);
+        if (!pvtTables_) {
+            pvtTables_ = std::make_shared<PvtTables>(deck, eclState);
+        }
+        phaseUsage_ = pvtTables_->phaseUsage;
+        materialLawManager_ = materialLawManager;
 
         // Unfortunate lack of pointer smartness here...
         std::string threephase_model = param.getDefault<std::string>("threephase_model", "gwseg");
@@ -176,7 +340,8 @@ namespace Opm
 
         SaturationPropsFromDeck* ptr
             = new SaturationPropsFromDeck();
-        ptr->init(phaseUsageFromDeck(deck), materialLawManager);
+        ptr->init(phaseUsage_, materialLawManager);
+        ptr->setCellRegions(cellSatRegions(eclState, number_of_cells, global_cell));
         satprops_.reset(ptr);
     }
 
@@ -247,44 +412,51 @@ namespace Opm
         enum PressureEvalTag {};
         typedef Opm::LocalAd::Evaluation<double, PressureEvalTag, /*size=*/1> LadEval;
 
-        LadEval pLad = 0.0;
-        LadEval TLad = 0.0;
-        LadEval RsLad = 0.0;
-        LadEval RvLad = 0.0;
-        LadEval muLad = 0.0;
-
-        pLad.derivatives[0] = 1.0;
+        std::vector<double> R(n*np);
+        this->compute_R_(n, p, T, z, cells, R.data());
 
-        R_.resize(n*np);
-        this->compute_R_(n, p, T, z, cells, &R_[0]);
-
-        for (int i = 0; i < n; ++ i) {
+        const int* order = pvtRegionOrder_.order(n, cells);
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+        for (int k = 0; k < n; ++ k) {
+            const int i = order ? order[k] : k;
             int cellIdx = cells[i];
             int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
+            LadEval pLad = 0.0;
+            LadEval TLad = 0.0;
+            LadEval RsLad = 0.0;
+            LadEval RvLad = 0.0;
+            LadEval muLad = 0.0;
             pLad.value = p[i];
+            pLad.derivatives[0] = 1.0;
             TLad.value = T[i];
 
             if (pu.phase_used[BlackoilPhases::Aqua]) {
-                muLad = waterPvt_.viscosity(pvtRegionIdx, TLad, pLad);
-                int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Aqua];
+                muLad = pvtTables_->waterPvt.viscosity(pvtRegionIdx, TLad, pLad);
+                int offset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Aqua];
                 mu[offset] = muLad.value;
-                dmudp[offset] = muLad.derivatives[0];
+                if (dmudp) {
+                    dmudp[offset] = muLad.derivatives[0];
+                }
             }
 
             if (pu.phase_used[BlackoilPhases::Liquid]) {
-                RsLad.value = R_[i*np + pu.phase_pos[BlackoilPhases::Liquid]];
-                muLad = oilPvt_.viscosity(pvtRegionIdx, TLad, pLad, RsLad);
-                int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Liquid];
+                RsLad.value = R[i*np + pu.phase_pos[BlackoilPhases::Liquid]];
+                muLad = pvtTables_->oilPvt.viscosity(pvtRegionIdx, TLad, pLad, RsLad);
+                int offset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Liquid];
                 mu[offset] = muLad.value;
-                dmudp[offset] = muLad.derivatives[0];
+                if (dmudp) {
+                    dmudp[offset] = muLad.derivatives[0];
+                }
             }
 
             if (pu.phase_used[BlackoilPhases::Vapour]) {
-                RvLad.value = R_[i*np + pu.phase_pos[BlackoilPhases::Vapour]];
-                muLad = gasPvt_.viscosity(pvtRegionIdx, TLad, pLad, RvLad);
-                int offset = pu.num_phases*cellIdx + pu.phase_pos[BlackoilPhases::Vapour];
+                RvLad.value = R[i*np + pu.phase_pos[BlackoilPhases::Vapour]];
+                muLad = pvtTables_->gasPvt.viscosity(pvtRegionIdx, TLad, pLad, RvLad);
+                int offset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Vapour];
                 mu[offset] = muLad.value;
-                dmudp[offset] = muLad.derivatives[0];
+                if (dmudp) {
+                    dmudp[offset] = muLad.derivatives[0];
+                }
             }
         }
     }
@@ -310,17 +482,20 @@ namespace Opm
     {
         const int np = numPhases();
 
-        B_.resize(n*np);
-        R_.resize(n*np);
+        // Scratch is local, so concurrent calls do not interfere.
+        std::vector<double> B_all(n*np);
+        std::vector<double> R_all(n*np);
+        std::vector<double> dB_all;
+        std::vector<double> dR_all;
         if (dAdp) {
-            dB_.resize(n*np);
-            dR_.resize(n*np);
+            dB_all.resize(n*np);
+            dR_all.resize(n*np);
 
-            this->compute_dBdp_(n, p, T, z, cells, &B_[0], &dB_[0]);
-            this->compute_dRdp_(n, p, T, z, cells, &R_[0], &dR_[0]);
+            this->compute_dBdp_(n, p, T, z, cells, &B_all[0], &dB_all[0]);
+            this->compute_dRdp_(n, p, T, z, cells, &R_all[0], &dR_all[0]);
         } else {
-            this->compute_B_(n, p, T, z, cells, &B_[0]);
-            this->compute_R_(n, p, T, z, cells, &R_[0]);
+            this->compute_B_(n, p, T, z, cells, &B_all[0]);
+            this->compute_R_(n, p, T, z, cells, &R_all[0]);
         }
         const auto& pu = phaseUsage();
         bool oil_and_gas = pu.phase_pos[BlackoilPhases::Liquid] &&
@@ -328,64 +503,12 @@ namespace Opm
         const int o = pu.phase_pos[BlackoilPhases::Liquid];
         const int g = pu.phase_pos[BlackoilPhases::Vapour];
 
-        // Compute A matrix
-// #pragma omp parallel for
-        for (int i = 0; i < n; ++i) {
-            double* m = A + i*np*np;
-            std::fill(m, m + np*np, 0.0);
-            // Diagonal entries.
-            for (int phase = 0; phase < np; ++phase) {
-                m[phase + phase*np] = 1.0/B_[i*np + phase];
-            }
-            // Off-diagonal entries.
-            if (oil_and_gas) {
-                m[o + g*np] = R_[i*np + g]/B_[i*np + g];
-                m[g + o*np] = R_[i*np + o]/B_[i*np + o];
-            }
-        }
-
-        // Derivative of A matrix.
-        // A     = R*inv(B) whence
-        //
-        // dA/dp = (dR/dp*inv(B) + R*d(inv(B))/dp)
-        //       = (dR/dp*inv(B) - R*inv(B)*(dB/dp)*inv(B))
-        //       = (dR/dp - A*(dB/dp)) * inv(B)
-        //
-        // The B matrix is diagonal and that fact is exploited in the
-        // following implementation.
-        if (dAdp) {
-// #pragma omp parallel for
-            // (1): dA/dp <- A
-            std::copy(A, A + n*np*np, dAdp);
-
-            for (int i = 0; i < n; ++i) {
-                double*       m  = dAdp + i*np*np;
-
-                // (2): dA/dp <- -dA/dp*(dB/dp) == -A*(dB/dp)
-                const double* dB = & dB_[i * np];
-                for (int col = 0; col < np; ++col) {
-                    for (int row = 0; row < np; ++row) {
-                        m[col*np + row] *= - dB[ col ]; // Note sign.
-                    }
-                }
-
-                if (oil_and_gas) {
-                    // (2b): dA/dp += dR/dp (== dR/dp - A*(dB/dp))
-                    const double* dR = & dR_[i * np];
-
-                    m[o*np + g] += dR[ o ];
-                    m[g*np + o] += dR[ g ];
-                }
-
-                // (3): dA/dp *= inv(B) (== final result)
-                const double* B = & B_[i * np];
-                for (int col = 0; col < np; ++col) {
-                    for (int row = 0; row < np; ++row) {
-                        m[col*np + row] /= B[ col ];
-                    }
-                }
-            }
-        }
+        // Compute A matrix, and its derivative if requested.
+        const FormMatrices kernel = { n, oil_and_gas, o, g,
+                                      B_all.data(), R_all.data(),
+                                      dAdp ? dB_all.data() : 0, dAdp ? dR_all.data() : 0,
+                                      A, dAdp };
+        dispatchNumPhases(np, kernel);
     }
 
     void BlackoilPropertiesFromDeck::compute_B_(const int n,
@@ -399,23 +522,23 @@ namespace Opm
 
         typedef double LadEval;
 
-        LadEval pLad = 0.0;
-        LadEval TLad = 0.0;
-        LadEval RsLad = 0.0;
-        LadEval RvLad = 0.0;
-
-        for (int i = 0; i < n; ++ i) {
+        const int* order = pvtRegionOrder_.order(n, cells);
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+        for (int k = 0; k < n; ++ k) {
+            const int i = order ? order[k] : k;
             int cellIdx = cells[i];
             int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
-            pLad = p[i];
-            TLad = T[i];
+            LadEval pLad = p[i];
+            LadEval TLad = T[i];
+            LadEval RsLad = 0.0;
+            LadEval RvLad = 0.0;
 
             int oilOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Liquid];
             int gasOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Vapour];
             int waterOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Aqua];
 
             if (pu.phase_used[BlackoilPhases::Aqua]) {
-                LadEval BLad = 1.0/waterPvt_.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                LadEval BLad = 1.0/pvtTables_->waterPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
 
                 B[waterOffset] = BLad;
             }
@@ -425,15 +548,15 @@ namespace Opm
                 double maxRs = 0.0;
                 if (pu.phase_used[BlackoilPhases::Vapour]) {
                     currentRs = (z[oilOffset] == 0.0) ? 0.0 : z[gasOffset]/z[oilOffset];
-                    maxRs = oilPvt_.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
+                    maxRs = pvtTables_->oilPvt.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
                 }
                 LadEval BLad;
                 if (currentRs >= maxRs) {
-                    BLad = 1.0/oilPvt_.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                    BLad = 1.0/pvtTables_->oilPvt.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
                 }
                 else {
                     RsLad = currentRs;
-                    BLad = 1.0/oilPvt_.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RsLad);
+                    BLad = 1.0/pvtTables_->oilPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RsLad);
                 }
 
                 B[oilOffset] = BLad;
@@ -444,15 +567,15 @@ namespace Opm
                 double maxRv = 0.0;
                 if (pu.phase_used[BlackoilPhases::Liquid]) {
                     currentRv = (z[gasOffset] == 0.0) ? 0.0 : z[oilOffset]/z[gasOffset];
-                    maxRv = gasPvt_.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
+                    maxRv = pvtTables_->gasPvt.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
                 }
                 LadEval BLad;
                 if (currentRv >= maxRv) {
-                    BLad = 1.0/gasPvt_.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                    BLad = 1.0/pvtTables_->gasPvt.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
                 }
                 else {
                     RvLad = currentRv;
-                    BLad = 1.0/gasPvt_.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RvLad);
+                    BLad = 1.0/pvtTables_->gasPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RvLad);
                 }
 
                 B[gasOffset] = BLad;
@@ -473,17 +596,18 @@ namespace Opm
         enum PressureEvalTag {};
         typedef Opm::LocalAd::Evaluation<double, PressureEvalTag, /*size=*/1> LadEval;
 
-        LadEval pLad = 0.0;
-        LadEval TLad = 0.0;
-        LadEval RsLad = 0.0;
-        LadEval RvLad = 0.0;
-
-        pLad.derivatives[0] = 1.0;
-
-        for (int i = 0; i < n; ++ i) {
+        const int* order = pvtRegionOrder_.order(n, cells);
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+        for (int k = 0; k < n; ++ k) {
+            const int i = order ? order[k] : k;
             int cellIdx = cells[i];
             int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
+            LadEval pLad = 0.0;
+            LadEval TLad = 0.0;
+            LadEval RsLad = 0.0;
+            LadEval RvLad = 0.0;
             pLad.value = p[i];
+            pLad.derivatives[0] = 1.0;
             TLad.value = T[i];
 
             int oilOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Liquid];
@@ -491,7 +615,7 @@ namespace Opm
             int waterOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Aqua];
 
             if (pu.phase_used[BlackoilPhases::Aqua]) {
-                LadEval BLad = 1.0/waterPvt_.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                LadEval BLad = 1.0/pvtTables_->waterPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
 
                 B[waterOffset] = BLad.value;
                 dBdp[waterOffset] = BLad.derivatives[0];
@@ -502,15 +626,15 @@ namespace Opm
                 double maxRs = 0.0;
                 if (pu.phase_used[BlackoilPhases::Vapour]) {
                     currentRs = (z[oilOffset] == 0.0) ? 0.0 : z[gasOffset]/z[oilOffset];
-                    maxRs = oilPvt_.saturatedGasDissolutionFactor(pvtRegionIdx, TLad.value, pLad.value);
+                    maxRs = pvtTables_->oilPvt.saturatedGasDissolutionFactor(pvtRegionIdx, TLad.value, pLad.value);
                 }
                 LadEval BLad;
                 if (currentRs >= maxRs) {
-                    BLad = 1.0/oilPvt_.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                    BLad = 1.0/pvtTables_->oilPvt.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
                 }
                 else {
                     RsLad.value = currentRs;
-                    BLad = 1.0/oilPvt_.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RsLad);
+                    BLad = 1.0/pvtTables_->oilPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RsLad);
                 }
 
                 B[oilOffset] = BLad.value;
@@ -522,15 +646,15 @@ namespace Opm
                 double maxRv = 0.0;
                 if (pu.phase_used[BlackoilPhases::Liquid]) {
                     currentRv = (z[gasOffset] == 0.0) ? 0.0 : z[oilOffset]/z[gasOffset];
-                    maxRv = gasPvt_.saturatedOilVaporizationFactor(pvtRegionIdx, TLad.value, pLad.value);
+                    maxRv = pvtTables_->gasPvt.saturatedOilVaporizationFactor(pvtRegionIdx, TLad.value, pLad.value);
                 }
                 LadEval BLad;
                 if (currentRv >= maxRv) {
-                    BLad = 1.0/gasPvt_.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                    BLad = 1.0/pvtTables_->gasPvt.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
                 }
                 else {
                     RvLad.value = currentRv;
-                    BLad = 1.0/gasPvt_.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RvLad);
+                    BLad = 1.0/pvtTables_->gasPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RvLad);
                 }
 
                 B[gasOffset] = BLad.value;
@@ -550,14 +674,14 @@ namespace Opm
 
         typedef double LadEval;
 
-        LadEval pLad = 0.0;
-        LadEval TLad = 0.0;
-
-        for (int i = 0; i < n; ++ i) {
+        const int* order = pvtRegionOrder_.order(n, cells);
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+        for (int k = 0; k < n; ++ k) {
+            const int i = order ? order[k] : k;
             int cellIdx = cells[i];
             int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
-            pLad = p[i];
-            TLad = T[i];
+            LadEval pLad = p[i];
+            LadEval TLad = T[i];
 
             int oilOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Liquid];
             int gasOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Vapour];
@@ -568,7 +692,7 @@ namespace Opm
             }
 
             if (pu.phase_used[BlackoilPhases::Liquid]) {
-                LadEval RsSatLad = oilPvt_.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
+                LadEval RsSatLad = pvtTables_->oilPvt.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
 
                 double currentRs = 0.0;
                 if (pu.phase_used[BlackoilPhases::Vapour]) {
@@ -581,7 +705,7 @@ namespace Opm
             }
 
             if (pu.phase_used[BlackoilPhases::Vapour]) {
-                LadEval RvSatLad = gasPvt_.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
+                LadEval RvSatLad = pvtTables_->gasPvt.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
 
                 double currentRv = 0.0;
                 if (pu.phase_used[BlackoilPhases::Liquid]) {
@@ -609,15 +733,16 @@ namespace Opm
         typedef Opm::LocalAd::Evaluation<double, PressureEvalTag, /*size=*/1> LadEval;
         typedef Opm::MathToolbox<LadEval> Toolbox;
 
-        LadEval pLad = 0.0;
-        LadEval TLad = 0.0;
-
-        pLad.derivatives[0] = 1.0;
-
-        for (int i = 0; i < n; ++ i) {
+        const int* order = pvtRegionOrder_.order(n, cells);
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+        for (int k = 0; k < n; ++ k) {
+            const int i = order ? order[k] : k;
             int cellIdx = cells[i];
             int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
+            LadEval pLad = 0.0;
+            LadEval TLad = 0.0;
             pLad.value = p[i];
+            pLad.derivatives[0] = 1.0;
             TLad.value = T[i];
 
             int oilOffset = pu.num_phases*i + pu.phase_pos[BlackoilPhases::Liquid];
@@ -629,7 +754,7 @@ namespace Opm
             }
 
             if (pu.phase_used[BlackoilPhases::Liquid]) {
-                LadEval RsSatLad = oilPvt_.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
+                LadEval RsSatLad = pvtTables_->oilPvt.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
 
                 LadEval currentRs = 0.0;
                 if (pu.phase_used[BlackoilPhases::Vapour]) {
@@ -643,7 +768,7 @@ namespace Opm
             }
 
             if (pu.phase_used[BlackoilPhases::Vapour]) {
-                LadEval RvSatLad = gasPvt_.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
+                LadEval RvSatLad = pvtTables_->gasPvt.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
 
                 LadEval currentRv = 0.0;
                 if (pu.phase_used[BlackoilPhases::Liquid]) {
@@ -671,7 +796,7 @@ namespace Opm
                                              double* rho) const
     {
         const int np = numPhases();
-// #pragma omp parallel for
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
         for (int i = 0; i < n; ++i) {
             int cellIdx = cells?cells[i]:i;
             const double *sdens = surfaceDensity(cellIdx);
@@ -684,41 +809,154 @@ namespace Opm
         }
     }
 
-    /// Densities of stock components at surface conditions.
-    /// \return Array of P density values.
-    const double* BlackoilPropertiesFromDeck::surfaceDensity(int cellIdx) const
+    /// Compute all fluid properties needed by a pressure solver in
+    /// one pass over the data points. The PVT region, saturated
+    /// dissolution and vaporization factors, formation volume
+    /// factors and viscosities are evaluated once per point and
+    /// phase, and shared by all the results.
+    /// \param[in]  n      Number of data points.
+    /// \param[in]  p      Array of n pressure values.
+    /// \param[in]  T      Array of n temperature values.
+    /// \param[in]  z      Array of nP surface volume values.
+    /// \param[in]  s      Array of nP saturation values.
+    /// \param[in]  cells  Array of n cell indices to be associated with the values.
+    /// \param[in]  compute_derivatives  If true, compute dAdp and dmudp.
+    /// \param[out] data   Fluid properties, resized by the call.
+    void BlackoilPropertiesFromDeck::fluidProperties(const int n,
+                                                     const double* p,
+                                                     const double* T,
+                                                     const double* z,
+                                                     const double* s,
+                                                     const int* cells,
+                                                     const bool compute_derivatives,
+                                                     BlackoilFluidData& data) const
     {
-        const auto& pu = phaseUsage();
-        int pvtRegionIdx = getTableIndex_(cellPvtRegionIndex(), cellIdx);
-        return &surfaceDensities_[pvtRegionIdx*pu.num_phases];
-    }
+        const PhaseUsage pu = phaseUsage();
+        const int np = numPhases();
+        data.resize(n, np, compute_derivatives);
 
-    void BlackoilPropertiesFromDeck::initSurfaceDensities_(Opm::DeckConstPtr deck)
-    {
-        const auto& pu = phaseUsage();
-        int np = pu.num_phases;
-        int numPvtRegions = 1;
-        if (deck->hasKeyword("TABDIMS")) {
-            const auto& tabdimsKeyword = deck->getKeyword("TABDIMS");
-            numPvtRegions = tabdimsKeyword.getRecord(0).getItem("NTPVT").template get<int>(0);
-        }
+        const bool has_water = pu.phase_used[BlackoilPhases::Aqua];
+        const bool has_oil = pu.phase_used[BlackoilPhases::Liquid];
+        const bool has_gas = pu.phase_used[BlackoilPhases::Vapour];
+        const int w = pu.phase_pos[BlackoilPhases::Aqua];
+        const int o = pu.phase_pos[BlackoilPhases::Liquid];
+        const int g = pu.phase_pos[BlackoilPhases::Vapour];
+        const bool oil_and_gas = pu.phase_pos[BlackoilPhases::Liquid] &&
+            pu.phase_pos[BlackoilPhases::Vapour];
 
-        const auto& densityKeyword = deck->getKeyword("DENSITY");
+        enum PressureEvalTag {};
+        typedef Opm::LocalAd::Evaluation<double, PressureEvalTag, /*size=*/1> LadEval;
+        typedef Opm::MathToolbox<LadEval> Toolbox;
 
-        surfaceDensities_.resize(np*numPvtRegions);
-        for (int pvtRegionIdx = 0; pvtRegionIdx < numPvtRegions; ++pvtRegionIdx) {
-            if (pu.phase_used[BlackoilPhases::Aqua])
-                surfaceDensities_[np*pvtRegionIdx + pu.phase_pos[BlackoilPhases::Aqua]] =
-                    densityKeyword.getRecord(pvtRegionIdx).getItem("WATER").getSIDouble(0);
+        const int* order = pvtRegionOrder_.order(n, cells);
+#pragma omp parallel for schedule(static) if (n >= ParallelMinPoints)
+        for (int k = 0; k < n; ++k) {
+            const int i = order ? order[k] : k;
+            const int cellIdx = cells[i];
+            const int pvtRegionIdx = cellPvtRegionIdx_[cellIdx];
+            LadEval pLad = 0.0;
+            LadEval TLad = 0.0;
+            pLad.value = p[i];
+            pLad.derivatives[0] = 1.0;
+            TLad.value = T[i];
 
-            if (pu.phase_used[BlackoilPhases::Liquid])
-                surfaceDensities_[np*pvtRegionIdx + pu.phase_pos[BlackoilPhases::Liquid]] =
-                    densityKeyword.getRecord(pvtRegionIdx).getItem("OIL").getSIDouble(0);
+            double B[BlackoilPhases::MaxNumPhases];
+            double dB[BlackoilPhases::MaxNumPhases];
+            double R[BlackoilPhases::MaxNumPhases];
+            double dR[BlackoilPhases::MaxNumPhases];
+            double* mu = &data.mu[np*i];
+
+            if (has_water) {
+                const LadEval BLad = 1.0/pvtTables_->waterPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad);
+                const LadEval muLad = pvtTables_->waterPvt.viscosity(pvtRegionIdx, TLad, pLad);
+                B[w] = BLad.value;
+                dB[w] = BLad.derivatives[0];
+                R[w] = 0.0; // water is always immiscible!
+                dR[w] = 0.0;
+                mu[w] = muLad.value;
+                if (compute_derivatives) {
+                    data.dmudp[np*i + w] = muLad.derivatives[0];
+                }
+            }
 
-            if (pu.phase_used[BlackoilPhases::Vapour])
-                surfaceDensities_[np*pvtRegionIdx + pu.phase_pos[BlackoilPhases::Vapour]] =
-                    densityKeyword.getRecord(pvtRegionIdx).getItem("GAS").getSIDouble(0);
+            if (has_oil) {
+                // Without gas, the gas dissolution factor is zero and
+                // the oil is saturated.
+                LadEval RsLad = 0.0;
+                bool saturated = true;
+                if (has_gas) {
+                    const double currentRs = (z[np*i + o] == 0.0) ? 0.0 : z[np*i + g]/z[np*i + o];
+                    const LadEval RsSatLad = pvtTables_->oilPvt.saturatedGasDissolutionFactor(pvtRegionIdx, TLad, pLad);
+                    saturated = currentRs >= RsSatLad.value;
+                    RsLad = Toolbox::min(RsSatLad, LadEval(currentRs));
+                }
+                LadEval RsConst = 0.0;
+                RsConst.value = RsLad.value;
+                const LadEval BLad = saturated
+                    ? 1.0/pvtTables_->oilPvt.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad)
+                    : 1.0/pvtTables_->oilPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RsConst);
+                const LadEval muLad = pvtTables_->oilPvt.viscosity(pvtRegionIdx, TLad, pLad, RsConst);
+                B[o] = BLad.value;
+                dB[o] = BLad.derivatives[0];
+                R[o] = RsLad.value;
+                dR[o] = RsLad.derivatives[0];
+                mu[o] = muLad.value;
+                if (compute_derivatives) {
+                    data.dmudp[np*i + o] = muLad.derivatives[0];
+                }
+            }
+
+            if (has_gas) {
+                // Without oil, the oil vaporization factor is zero and
+                // the gas is saturated.
+                LadEval RvLad = 0.0;
+                bool saturated = true;
+                if (has_oil) {
+                    const double currentRv = (z[np*i + g] == 0.0) ? 0.0 : z[np*i + o]/z[np*i + g];
+                    const LadEval RvSatLad = pvtTables_->gasPvt.saturatedOilVaporizationFactor(pvtRegionIdx, TLad, pLad);
+                    saturated = currentRv >= RvSatLad.value;
+                    RvLad = Toolbox::min(RvSatLad, LadEval(currentRv));
+                }
+                LadEval RvConst = 0.0;
+                RvConst.value = RvLad.value;
+                const LadEval BLad = saturated
+                    ? 1.0/pvtTables_->gasPvt.saturatedInverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad)
+                    : 1.0/pvtTables_->gasPvt.inverseFormationVolumeFactor(pvtRegionIdx, TLad, pLad, RvConst);
+                const LadEval muLad = pvtTables_->gasPvt.viscosity(pvtRegionIdx, TLad, pLad, RvConst);
+                B[g] = BLad.value;
+                dB[g] = BLad.derivatives[0];
+                R[g] = RvLad.value;
+                dR[g] = RvLad.derivatives[0];
+                mu[g] = muLad.value;
+                if (compute_derivatives) {
+                    data.dmudp[np*i + g] = muLad.derivatives[0];
+                }
+            }
+
+            double* A = &data.A[np*np*i];
+            formMatrix(NumPhases<0>(np), oil_and_gas, o, g, B, R, dB, dR,
+                       A, compute_derivatives ? &data.dAdp[np*np*i] : 0);
+
+            const double* sdens = surfaceDensity(cellIdx);
+            for (int phase = 0; phase < np; ++phase) {
+                double rho = 0.0;
+                for (int comp = 0; comp < np; ++comp) {
+                    rho += A[np*phase + comp]*sdens[comp];
+                }
+                data.rho[np*i + phase] = rho;
+            }
         }
+
+        relperm(n, s, cells, data.kr.data(), 0);
+    }
+
+    /// Densities of stock components at surface conditions.
+    /// \return Array of P density values.
+    const double* BlackoilPropertiesFromDeck::surfaceDensity(int cellIdx) const
+    {
+        const auto& pu = phaseUsage();
+        int pvtRegionIdx = getTableIndex_(cellPvtRegionIndex(), cellIdx);
+        return &pvtTables_->surfaceDensities[pvtRegionIdx*pu.num_phases];
     }
 
     /// \param[in]  n      Number of data points.
@@ -25,6 +25,7 @@
 #include <opm/core/props/rock/RockFromDeck.hpp>
 #include <opm/core/props/satfunc/SaturationPropsFromDeck.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/RegionSortedOrder.hpp>
 #include <opm/material/fluidsystems/blackoilpvt/OilPvtMultiplexer.hpp>
 #include <opm/material/fluidsystems/blackoilpvt/GasPvtMultiplexer.hpp>
 #include <opm/material/fluidsystems/blackoilpvt/WaterPvtMultiplexer.hpp>
@@ -45,6 +46,23 @@ namespace Opm
     public:
         typedef typename SaturationPropsFromDeck::MaterialLawManager MaterialLawManager;
 
+        /// PVT tables and surface densities of a deck. They do not
+        /// depend on the grid and are never modified after
+        /// construction, so several property objects, e.g., of the
+        /// members of an ensemble, may share one instance.
+        struct PvtTables
+        {
+            PvtTables(Opm::DeckConstPtr deck,
+                      Opm::EclipseStateConstPtr eclState);
+
+            PhaseUsage phaseUsage;
+            OilPvtMultiplexer<double> oilPvt;
+            GasPvtMultiplexer<double> gasPvt;
+            WaterPvtMultiplexer<double> waterPvt;
+            // np values per PVT region.
+            std::vector<double> surfaceDensities;
+        };
+
         /// Initialize from deck and grid.
         /// \param[in]  deck     Deck input parser
         /// \param[in]  grid     Grid to which property object applies, needed for the
@@ -95,6 +113,28 @@ namespace Opm
                                    const parameter::ParameterGroup& param,
                                    bool init_rock=true);
 
+        /// Initialize from deck, sharing the fluid tables of another
+        /// property object constructed from the same deck. Only the
+        /// per-cell data (rock properties and region indices) are
+        /// set up anew.
+        /// \param[in]  pvtTables           Shared PVT tables, e.g., from pvtTables()
+        ///                                 of another property object.
+        /// \param[in]  materialLawManager  Shared saturation function data, e.g., from
+        ///                                 materialLawManager() of another property
+        ///                                 object. Since it holds the hysteresis state
+        ///                                 and SWATINIT scaling, it should only be shared
+        ///                                 if neither updateSatHyst() nor swatInitScaling()
+        ///                                 is used.
+        BlackoilPropertiesFromDeck(Opm::DeckConstPtr  deck,
+                                   Opm::EclipseStateConstPtr eclState,
+                                   std::shared_ptr<const PvtTables> pvtTables,
+                                   std::shared_ptr<MaterialLawManager> materialLawManager,
+                                   int number_of_cells,
+                                   const int* global_cell,
+                                   const int* cart_dims,
+                                   const parameter::ParameterGroup& param,
+                                   bool init_rock=true);
+
         /// Destructor.
         virtual ~BlackoilPropertiesFromDeck();
 
@@ -182,6 +222,28 @@ namespace Opm
         /// \return Array of P density values.
         virtual const double* surfaceDensity(int cellIdx = 0) const;
 
+        /// Compute all fluid properties needed by a pressure solver in
+        /// one pass over the data points. The PVT region, saturated
+        /// dissolution and vaporization factors, formation volume
+        /// factors and viscosities are evaluated once per point and
+        /// phase, and shared by all the results.
+        /// \param[in]  n      Number of data points.
+        /// \param[in]  p      Array of n pressure values.
+        /// \param[in]  T      Array of n temperature values.
+        /// \param[in]  z      Array of nP surface volume values.
+        /// \param[in]  s      Array of nP saturation values.
+        /// \param[in]  cells  Array of n cell indices to be associated with the values.
+        /// \param[in]  compute_derivatives  If true, compute dAdp and dmudp.
+        /// \param[out] data   Fluid properties, resized by the call.
+        virtual void fluidProperties(const int n,
+                                     const double* p,
+                                     const double* T,
+                                     const double* z,
+                                     const double* s,
+                                     const int* cells,
+                                     const bool compute_derivatives,
+                                     BlackoilFluidData& data) const;
+
         /// \param[in]  n      Number of data points.
         /// \param[in]  s      Array of nP saturation values.
         /// \param[in]  cells  Array of n cell indices to be associated with the s values.
@@ -237,17 +299,30 @@ namespace Opm
 
         const OilPvtMultiplexer<double>& oilPvt() const
         {
-            return oilPvt_;
+            return pvtTables_->oilPvt;
         }
 
         const GasPvtMultiplexer<double>& gasPvt() const
         {
-            return gasPvt_;
+            return pvtTables_->gasPvt;
         }
 
         const WaterPvtMultiplexer<double>& waterPvt() const
         {
-            return waterPvt_;
+            return pvtTables_->waterPvt;
+        }
+
+        /// The fluid tables, for sharing with other property objects.
+        std::shared_ptr<const PvtTables> pvtTables() const
+        {
+            return pvtTables_;
+        }
+
+        /// The saturation function data, for sharing with other
+        /// property objects.
+        std::shared_ptr<MaterialLawManager> materialLawManager() const
+        {
+            return materialLawManager_;
         }
 
     private:
@@ -258,8 +333,6 @@ namespace Opm
             return pvtTableIdx[cellIdx];
         }
 
-        void initSurfaceDensities_(Opm::DeckConstPtr deck);
-
         void compute_B_(const int n,
                         const double* p,
                         const double* T,
@@ -310,16 +383,10 @@ namespace Opm
         RockFromDeck rock_;
         PhaseUsage phaseUsage_;
         std::vector<int> cellPvtRegionIdx_;
-        OilPvtMultiplexer<double> oilPvt_;
-        GasPvtMultiplexer<double> gasPvt_;
-        WaterPvtMultiplexer<double> waterPvt_;
+        RegionSortedOrder pvtRegionOrder_;
+        std::shared_ptr<const PvtTables> pvtTables_;
         std::shared_ptr<MaterialLawManager> materialLawManager_;
         std::shared_ptr<SaturationPropsInterface> satprops_;
-        std::vector<double> surfaceDensities_;
-        mutable std::vector<double> B_;
-        mutable std::vector<double> dB_;
-        mutable std::vector<double> R_;
-        mutable std::vector<double> dR_;
     };
 
 
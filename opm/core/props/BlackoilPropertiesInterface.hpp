@@ -20,11 +20,38 @@
 #ifndef OPM_BLACKOILPROPERTIESINTERFACE_HEADER_INCLUDED
 #define OPM_BLACKOILPROPERTIESINTERFACE_HEADER_INCLUDED
 
+#include <vector>
+
 namespace Opm
 {
 
     struct PhaseUsage;
 
+    /// Fluid properties of n data points, as computed by
+    /// BlackoilPropertiesInterface::fluidProperties(). Each quantity is
+    /// stored in its own array, with the same cellwise ordering as the
+    /// corresponding single-quantity methods.
+    struct BlackoilFluidData
+    {
+        std::vector<double> A;      ///< nP^2 values, as from matrix().
+        std::vector<double> dAdp;   ///< nP^2 values, empty unless requested.
+        std::vector<double> mu;     ///< nP values, as from viscosity().
+        std::vector<double> dmudp;  ///< nP values, empty unless requested.
+        std::vector<double> rho;    ///< nP values, as from density().
+        std::vector<double> kr;     ///< nP values, as from relperm().
+
+        /// Size the arrays for n data points and np phases.
+        void resize(const int n, const int np, const bool with_derivatives)
+        {
+            A.resize(n*np*np);
+            dAdp.resize(with_derivatives ? n*np*np : 0);
+            mu.resize(n*np);
+            dmudp.resize(with_derivatives ? n*np : 0);
+            rho.resize(n*np);
+            kr.resize(n*np);
+        }
+    };
+
     /// Abstract base class for blackoil fluid and reservoir properties.
     /// Supports variable number of spatial dimensions, called D.
     /// Supports variable number of phases, but assumes that
@@ -121,6 +148,37 @@ namespace Opm
         /// \return Array of P density values.
         virtual const double* surfaceDensity(int regionIdx = 0) const = 0;
 
+        /// Compute all fluid properties needed by a pressure solver in
+        /// one call. Equivalent to calling matrix(), viscosity(),
+        /// density() and relperm(), which is what the default
+        /// implementation does. Implementations may override it to
+        /// share the table lookups of the individual methods.
+        /// \param[in]  n      Number of data points.
+        /// \param[in]  p      Array of n pressure values.
+        /// \param[in]  T      Array of n temperature values.
+        /// \param[in]  z      Array of nP surface volume values.
+        /// \param[in]  s      Array of nP saturation values.
+        /// \param[in]  cells  Array of n cell indices to be associated with the values.
+        /// \param[in]  compute_derivatives  If true, compute dAdp and dmudp.
+        /// \param[out] data   Fluid properties, resized by the call.
+        virtual void fluidProperties(const int n,
+                                     const double* p,
+                                     const double* T,
+                                     const double* z,
+                                     const double* s,
+                                     const int* cells,
+                                     const bool compute_derivatives,
+                                     BlackoilFluidData& data) const
+        {
+            data.resize(n, numPhases(), compute_derivatives);
+            matrix(n, p, T, z, cells, data.A.data(),
+                   compute_derivatives ? data.dAdp.data() : 0);
+            viscosity(n, p, T, z, cells, data.mu.data(),
+                      compute_derivatives ? data.dmudp.data() : 0);
+            density(n, data.A.data(), cells, data.rho.data());
+            relperm(n, s, cells, data.kr.data(), 0);
+        }
+
         /// \param[in]  n      Number of data points.
         /// \param[in]  s      Array of nP saturation values.
         /// \param[in]  cells  Array of n cell indices to be associated with the s values.
@@ -0,0 +1,222 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BLACKOILPROPERTIESSHADOW_HEADER_INCLUDED
+#define OPM_BLACKOILPROPERTIESSHADOW_HEADER_INCLUDED
+
+#include <opm/core/props/BlackoilPropertiesInterface.hpp>
+
+namespace Opm
+{
+    /**
+     * Override rock properties of a blackoil property object with
+     * values from elsewhere, in the manner of IncompPropertiesShadow.
+     *
+     * Porosity and permeability can be replaced, and relative
+     * permeabilities can be scaled by per-cell, per-phase endpoint
+     * multipliers. Everything else is forwarded to the original
+     * object, so e.g. a history matching loop can perturb the rock of
+     * a BlackoilPropertiesFromDeck object without reading the deck
+     * again. No values are copied.
+     *
+     * @remark
+     *     This object is mutable; if you change some properties
+     *     it will affect all clients that have references to it.
+     *     It is thus recommended to only use the mutable portion
+     *     when constructing the object, before passing it to clients.
+     *
+     * @example
+     * @code{.cpp}
+     *   std::vector<double> poro;
+     *   BlackoilPropertiesFromDeck fromDeck(deck, eclState, grid);
+     *   simulate (BlackoilPropertiesShadow(fromDeck).usePorosity(poro.data()));
+     * @endcode
+     */
+    struct BlackoilPropertiesShadow : public BlackoilPropertiesInterface
+    {
+        /**
+         * Shadow another set of properties. If no properties are
+         * overridden, the values from the original will be used.
+         */
+        BlackoilPropertiesShadow (const BlackoilPropertiesInterface& original);
+
+        /**
+         * Implement all methods from the BlackoilPropertiesInterface.
+         */
+        virtual int numDimensions () const;
+        virtual int numCells () const;
+        virtual const int* cellPvtRegionIndex () const;
+        virtual const double* porosity () const;
+        virtual const double* permeability () const;
+        virtual int numPhases () const;
+        virtual PhaseUsage phaseUsage () const;
+        virtual void viscosity (const int n,
+                                const double* p,
+                                const double* T,
+                                const double* z,
+                                const int* cells,
+                                double* mu,
+                                double* dmudp) const;
+        virtual void matrix (const int n,
+                             const double* p,
+                             const double* T,
+                             const double* z,
+                             const int* cells,
+                             double* A,
+                             double* dAdp) const;
+        virtual void density (const int n,
+                              const double* A,
+                              const int* cells,
+                              double* rho) const;
+        virtual const double* surfaceDensity (int regionIdx = 0) const;
+        virtual void fluidProperties (const int n,
+                                      const double* p,
+                                      const double* T,
+                                      const double* z,
+                                      const double* s,
+                                      const int* cells,
+                                      const bool compute_derivatives,
+                                      BlackoilFluidData& data) const;
+        virtual void relperm (const int n,
+                              const double* s,
+                              const int* cells,
+                              double* kr,
+                              double* dkrds) const;
+        virtual void capPress (const int n,
+                               const double* s,
+                               const int* cells,
+                               double* pc,
+                               double* dpcds) const;
+        virtual void satRange (const int n,
+                               const int* cells,
+                               double* smin,
+                               double* smax) const;
+
+        /**
+         * The original is only held by const reference, so SWATINIT
+         * scaling, which modifies it, is not available. Do the
+         * scaling on the original before shadowing it.
+         *
+         * @throws std::logic_error always.
+         */
+        virtual void swatInitScaling (const int cell,
+                                      const double pcow,
+                                      double& swat);
+
+        /**
+         * Use a different set of porosities.
+         *
+         * @param poro
+         *     Pointer to new porosity values. It must contain
+         *     numCells() values.
+         * @return
+         *     A reference to this object, so it can be used for chaining.
+         * @remark
+         *     This object does *not* assume ownership of the underlaying
+         *     memory nor makes any copies of it. Hence, the calling code
+         *     must manage the array so that it points to valid memory for
+         *     the lifetime of this object.
+         */
+        BlackoilPropertiesShadow& usePorosity (const double* poro);
+        BlackoilPropertiesShadow& usePorosity (const BlackoilPropertiesInterface& other);
+
+        /**
+         * Use a different set of permeabilities.
+         *
+         * @param perm
+         *     Pointer to new permeability values. It must contain
+         *     numCells()*numDimensions()*numDimensions() values.
+         * @return
+         *     A reference to this object, so it can be used for chaining.
+         * @remark
+         *     This object does *not* assume ownership of the underlaying
+         *     memory nor makes any copies of it. Hence, the calling code
+         *     must manage the array so that it points to valid memory for
+         *     the lifetime of this object.
+         */
+        BlackoilPropertiesShadow& usePermeability (const double* perm);
+        BlackoilPropertiesShadow& usePermeability (const BlackoilPropertiesInterface& other);
+
+        /**
+         * Scale the relative permeabilities (and their derivatives)
+         * of the original, i.e. its relperm endpoints, cell by cell.
+         *
+         * @param mult
+         *     Pointer to multipliers. It must contain
+         *     numCells()*numPhases() values, the multiplier of phase
+         *     p in cell c at mult[c*numPhases() + p].
+         * @return
+         *     A reference to this object, so it can be used for chaining.
+         * @remark
+         *     This object does *not* assume ownership of the underlaying
+         *     memory nor makes any copies of it. Hence, the calling code
+         *     must manage the array so that it points to valid memory for
+         *     the lifetime of this object.
+         */
+        BlackoilPropertiesShadow& useRelpermMultipliers (const double* mult);
+
+        /**
+         * Convenience method to set both porosity and permeability.
+         */
+        BlackoilPropertiesShadow& useRockProps (const BlackoilPropertiesInterface& other);
+
+    private:
+        /**
+         * Apply the relperm multipliers to n values of kr and dkrds.
+         */
+        void scaleRelperm (const int n,
+                           const int* cells,
+                           double* kr,
+                           double* dkrds) const;
+
+        /**
+         * If we haven't set a property explicitly, then retrieve
+         * them from this.
+         */
+        const BlackoilPropertiesInterface& prototype_;
+
+        /**
+         * Bitfield which tells us which properties that has been
+         * shadowed. The others are retrieved from the original
+         * interface.
+         */
+        int shadowed_;
+
+        /**
+         * Bits that indicates which fields that has been overridden.
+         */
+        static const int POROSITY           = 1 << 1;
+        static const int PERMEABILITY       = 1 << 2;
+        static const int RELPERM_MULTIPLIER = 1 << 3;
+
+        /**
+         * Pointers to alternative values. These pointers should only
+         * be assumed to be valid if the corresponding bit in the mask
+         * is set. No management is done for the memory this points to!
+         */
+        const double* poro_;
+        const double* perm_;
+        const double* krmult_;
+    };
+} /* namespace Opm */
+
+// body of inline methods are defined here:
+#include <opm/core/props/BlackoilPropertiesShadow_impl.hpp>
+
+#endif /* OPM_BLACKOILPROPERTIESSHADOW_HEADER_INCLUDED */
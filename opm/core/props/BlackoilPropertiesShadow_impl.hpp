@@ -0,0 +1,257 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_BLACKOILPROPERTIESSHADOW_HEADER_INCLUDED
+#error Do not include BlackoilPropertiesShadow_impl.hpp directly!
+#endif /* OPM_BLACKOILPROPERTIESSHADOW_HEADER_INCLUDED */
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <cassert>
+#include <stdexcept>
+
+namespace Opm
+{
+    /**
+     * Initialize so that all properties are retrieved from original.
+     */
+    inline BlackoilPropertiesShadow::BlackoilPropertiesShadow (const BlackoilPropertiesInterface& original)
+        : prototype_ (original)
+        , shadowed_ (0)
+        , poro_ (0)
+        , perm_ (0)
+        , krmult_ (0)
+    {
+    }
+
+    /**
+     * The format of the prototype and the shadow must be the same,
+     * so these methods should always be forwarded directly.
+     */
+    inline int BlackoilPropertiesShadow::numDimensions () const
+    {
+        return prototype_.numDimensions();
+    }
+
+    inline int BlackoilPropertiesShadow::numCells () const
+    {
+        return prototype_.numCells();
+    }
+
+    inline const int* BlackoilPropertiesShadow::cellPvtRegionIndex () const
+    {
+        return prototype_.cellPvtRegionIndex();
+    }
+
+    inline int BlackoilPropertiesShadow::numPhases () const
+    {
+        return prototype_.numPhases();
+    }
+
+    inline PhaseUsage BlackoilPropertiesShadow::phaseUsage () const
+    {
+        return prototype_.phaseUsage();
+    }
+
+    /**
+     * Fluid properties are not overridden.
+     */
+    inline void BlackoilPropertiesShadow::viscosity (const int n,
+                                                     const double* p,
+                                                     const double* T,
+                                                     const double* z,
+                                                     const int* cells,
+                                                     double* mu,
+                                                     double* dmudp) const
+    {
+        prototype_.viscosity (n, p, T, z, cells, mu, dmudp);
+    }
+
+    inline void BlackoilPropertiesShadow::matrix (const int n,
+                                                  const double* p,
+                                                  const double* T,
+                                                  const double* z,
+                                                  const int* cells,
+                                                  double* A,
+                                                  double* dAdp) const
+    {
+        prototype_.matrix (n, p, T, z, cells, A, dAdp);
+    }
+
+    inline void BlackoilPropertiesShadow::density (const int n,
+                                                   const double* A,
+                                                   const int* cells,
+                                                   double* rho) const
+    {
+        prototype_.density (n, A, cells, rho);
+    }
+
+    inline const double* BlackoilPropertiesShadow::surfaceDensity (int regionIdx) const
+    {
+        return prototype_.surfaceDensity (regionIdx);
+    }
+
+    /**
+     * Let the original do the (possibly fused) evaluation, and only
+     * scale the relative permeabilities afterwards.
+     */
+    inline void BlackoilPropertiesShadow::fluidProperties (const int n,
+                                                           const double* p,
+                                                           const double* T,
+                                                           const double* z,
+                                                           const double* s,
+                                                           const int* cells,
+                                                           const bool compute_derivatives,
+                                                           BlackoilFluidData& data) const
+    {
+        prototype_.fluidProperties (n, p, T, z, s, cells, compute_derivatives, data);
+        scaleRelperm (n, cells, data.kr.data(), 0);
+    }
+
+    /**
+     * Relative permeabilities are scaled by the endpoint multipliers,
+     * if any. Capillary pressure and saturation ranges are forwarded.
+     */
+    inline void BlackoilPropertiesShadow::relperm (const int n,
+                                                   const double* s,
+                                                   const int* cells,
+                                                   double* kr,
+                                                   double* dkrds) const
+    {
+        prototype_.relperm (n, s, cells, kr, dkrds);
+        scaleRelperm (n, cells, kr, dkrds);
+    }
+
+    inline void BlackoilPropertiesShadow::capPress (const int n,
+                                                    const double* s,
+                                                    const int* cells,
+                                                    double* pc,
+                                                    double* dpcds) const
+    {
+        prototype_.capPress (n, s, cells, pc, dpcds);
+    }
+
+    inline void BlackoilPropertiesShadow::satRange (const int n,
+                                                    const int* cells,
+                                                    double* smin,
+                                                    double* smax) const
+    {
+        prototype_.satRange (n, cells, smin, smax);
+    }
+
+    inline void BlackoilPropertiesShadow::swatInitScaling (const int /* cell */,
+                                                           const double /* pcow */,
+                                                           double& /* swat */)
+    {
+        OPM_THROW(std::logic_error, "BlackoilPropertiesShadow::swatInitScaling(): "
+                  "Cannot modify the shadowed properties.");
+    }
+
+    /**
+     * Return the new value if indicated in the bitfield, otherwise
+     * use the original value from the other object.
+     */
+    inline const double* BlackoilPropertiesShadow::porosity () const
+    {
+        return (shadowed_ & POROSITY) ? poro_ : prototype_.porosity ();
+    }
+
+    inline const double* BlackoilPropertiesShadow::permeability () const
+    {
+        return (shadowed_ & PERMEABILITY) ? perm_ : prototype_.permeability ();
+    }
+
+    /**
+     * Store the pointer and indicate that the new value should be used.
+     */
+    inline BlackoilPropertiesShadow& BlackoilPropertiesShadow::usePorosity (const double* poro)
+    {
+        this->poro_ = poro;
+        shadowed_ |= POROSITY;
+        return *this;
+    }
+
+    inline BlackoilPropertiesShadow& BlackoilPropertiesShadow::usePermeability (const double* perm)
+    {
+        this->perm_ = perm;
+        shadowed_ |= PERMEABILITY;
+        return *this;
+    }
+
+    inline BlackoilPropertiesShadow& BlackoilPropertiesShadow::useRelpermMultipliers (const double* mult)
+    {
+        this->krmult_ = mult;
+        shadowed_ |= RELPERM_MULTIPLIER;
+        return *this;
+    }
+
+    /**
+     * Copy the pointer from another property interface, after checking
+     * that they are compatible.
+     */
+    inline BlackoilPropertiesShadow& BlackoilPropertiesShadow::usePorosity (const BlackoilPropertiesInterface& other)
+    {
+        assert (prototype_.numCells() == other.numCells());
+        return usePorosity (other.porosity());
+    }
+
+    inline BlackoilPropertiesShadow& BlackoilPropertiesShadow::usePermeability (const BlackoilPropertiesInterface& other)
+    {
+        assert (prototype_.numCells() == other.numCells());
+        assert (prototype_.numDimensions() == other.numDimensions());
+        return usePermeability (other.permeability());
+    }
+
+    /**
+     * Convenience methods to set several set of properties at once.
+     */
+    inline BlackoilPropertiesShadow& BlackoilPropertiesShadow::useRockProps (const BlackoilPropertiesInterface& other)
+    {
+        return usePorosity (other).usePermeability (other);
+    }
+
+    /**
+     * The derivative dkr[p]/ds[q] is scaled by the multiplier of
+     * phase p; the derivatives are stored in Fortran order.
+     */
+    inline void BlackoilPropertiesShadow::scaleRelperm (const int n,
+                                                        const int* cells,
+                                                        double* kr,
+                                                        double* dkrds) const
+    {
+        if (!(shadowed_ & RELPERM_MULTIPLIER)) {
+            return;
+        }
+        const int np = prototype_.numPhases();
+        for (int i = 0; i < n; ++i) {
+            const double* mult = krmult_ + np*cells[i];
+            for (int p = 0; p < np; ++p) {
+                kr[np*i + p] *= mult[p];
+            }
+            if (dkrds) {
+                double* dkr = dkrds + np*np*i;
+                for (int q = 0; q < np; ++q) {
+                    for (int p = 0; p < np; ++p) {
+                        dkr[np*q + p] *= mult[p];
+                    }
+                }
+            }
+        }
+    }
+} /* namespace Opm */
@@ -31,9 +31,7 @@ namespace Opm
                                                        Opm::EclipseStateConstPtr eclState,
                                                        const UnstructuredGrid& grid)
     {
-        rock_.init(eclState, grid.number_of_cells, grid.global_cell, grid.cartdims);
-        pvt_.init(deck);
-        auto materialLawManager = std::make_shared<typename SaturationPropsFromDeck::MaterialLawManager>();
+        auto materialLawManager = std::make_shared<MaterialLawManager>();
 
         std::vector<int> compressedToCartesianIdx(grid.number_of_cells);
         for (int cellIdx = 0; cellIdx < grid.number_of_cells; ++cellIdx) {
@@ -46,6 +44,25 @@ namespace Opm
         }
         materialLawManager->initFromDeck(deck, eclState, compressedToCartesianIdx);
 
+        init(deck, eclState, grid, materialLawManager);
+    }
+
+    IncompPropertiesFromDeck::IncompPropertiesFromDeck(Opm::DeckConstPtr deck,
+                                                       Opm::EclipseStateConstPtr eclState,
+                                                       const UnstructuredGrid& grid,
+                                                       std::shared_ptr<MaterialLawManager> materialLawManager)
+    {
+        init(deck, eclState, grid, materialLawManager);
+    }
+
+    void IncompPropertiesFromDeck::init(Opm::DeckConstPtr deck,
+                                        Opm::EclipseStateConstPtr eclState,
+                                        const UnstructuredGrid& grid,
+                                        std::shared_ptr<MaterialLawManager> materialLawManager)
+    {
+        rock_.init(eclState, grid.number_of_cells, grid.global_cell, grid.cartdims);
+        pvt_.init(deck);
+        materialLawManager_ = materialLawManager;
         satprops_.init(deck, materialLawManager);
         if (pvt_.numPhases() != satprops_.numPhases()) {
             OPM_THROW(std::runtime_error, "IncompPropertiesFromDeck::IncompPropertiesFromDeck() - Inconsistent number of phases in pvt data ("
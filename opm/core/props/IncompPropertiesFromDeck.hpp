@@ -46,6 +46,8 @@ namespace Opm
     class IncompPropertiesFromDeck : public IncompPropertiesInterface
     {
     public:
+        typedef SaturationPropsFromDeck::MaterialLawManager MaterialLawManager;
+
         /// Initialize from deck and grid.
         /// \param  deck         Deck input parser
         /// \param  eclState        The EclipseState (processed deck) produced by the opm-parser code
@@ -56,6 +58,21 @@ namespace Opm
                                  Opm::EclipseStateConstPtr eclState,
                                  const UnstructuredGrid& grid);
 
+        /// Initialize from deck and grid, sharing the saturation
+        /// function data of another property object constructed from
+        /// the same deck, e.g., by the members of an ensemble. The
+        /// saturation functions are only evaluated, never modified,
+        /// through this interface.
+        /// \param  deck                Deck input parser
+        /// \param  eclState            The EclipseState (processed deck) produced by the opm-parser code
+        /// \param  grid                Grid to which property object applies.
+        /// \param  materialLawManager  Shared saturation function data, e.g., from
+        ///                             materialLawManager() of another property object.
+        IncompPropertiesFromDeck(Opm::DeckConstPtr deck,
+                                 Opm::EclipseStateConstPtr eclState,
+                                 const UnstructuredGrid& grid,
+                                 std::shared_ptr<MaterialLawManager> materialLawManager);
+
         /// Destructor.
         virtual ~IncompPropertiesFromDeck();
 
@@ -135,10 +152,23 @@ namespace Opm
                               const int* cells,
                               double* smin,
                               double* smax) const;
+        /// The saturation function data, for sharing with other
+        /// property objects.
+        std::shared_ptr<MaterialLawManager> materialLawManager() const
+        {
+            return materialLawManager_;
+        }
+
     private:
+        void init(Opm::DeckConstPtr deck,
+                  Opm::EclipseStateConstPtr eclState,
+                  const UnstructuredGrid& grid,
+                  std::shared_ptr<MaterialLawManager> materialLawManager);
+
         RockFromDeck rock_;
         PvtPropertiesIncompFromDeck pvt_;
         SaturationPropsFromDeck satprops_;
+        std::shared_ptr<MaterialLawManager> materialLawManager_;
     };
 
 
@@ -0,0 +1,81 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_NUMPHASESDISPATCH_HEADER_INCLUDED
+#define OPM_NUMPHASESDISPATCH_HEADER_INCLUDED
+
+namespace Opm
+{
+
+    /// Number of phases known at compile time.
+    ///
+    /// Kernels written in terms of a NumPhases object, e.g.
+    ///
+    ///     template <class NP>
+    ///     void operator()(const NP np) const
+    ///     {
+    ///         for (int i = 0; i < n; ++i)
+    ///             for (int p = 0; p < np(); ++p)
+    ///                 ... a[np()*i + p] ...
+    ///     }
+    ///
+    /// get fixed trip counts and strides for the common two- and
+    /// three-phase cases, so that the inner loops can be unrolled.
+    template <int NP>
+    struct NumPhases
+    {
+        explicit NumPhases(const int) {}
+        int operator()() const { return NP; }
+    };
+
+    /// Number of phases known only at run time.
+    template <>
+    struct NumPhases<0>
+    {
+        explicit NumPhases(const int np) : np_(np) {}
+        int operator()() const { return np_; }
+    private:
+        int np_;
+    };
+
+    /// Call a kernel with the number of phases as a compile-time
+    /// constant if it is two or three, and as a run-time value
+    /// otherwise.
+    /// \param[in] np      Number of phases.
+    /// \param[in] kernel  Function object with a call operator
+    ///                    templated on the NumPhases type.
+    template <class Kernel>
+    void dispatchNumPhases(const int np, const Kernel& kernel)
+    {
+        switch (np) {
+        case 2:
+            kernel(NumPhases<2>(np));
+            break;
+        case 3:
+            kernel(NumPhases<3>(np));
+            break;
+        default:
+            kernel(NumPhases<0>(np));
+            break;
+        }
+    }
+
+} // namespace Opm
+
+#endif // OPM_NUMPHASESDISPATCH_HEADER_INCLUDED
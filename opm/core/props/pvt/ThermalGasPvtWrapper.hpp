@@ -20,6 +20,7 @@
 #define OPM_THERMAL_GAS_PVT_WRAPPER_HPP
 
 #include <opm/core/props/pvt/PvtInterface.hpp>
+#include <opm/core/props/pvt/ViscosityTemperatureFactor.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -35,6 +36,7 @@ namespace Opm
     {
     public:
         ThermalGasPvtWrapper()
+            : gasvisctTables_(0)
         {}
 
 
@@ -58,10 +60,20 @@ namespace Opm
             if (deck->hasKeyword("GASVISCT")) {
                 gasvisctTables_ = &tables->getGasvisctTables();
                 assert(int(gasvisctTables_->size()) == numRegions);
-                static_cast<void>(numRegions); //Silence compiler warning
 
                 gasCompIdx_ = deck->getKeyword("GCOMPIDX").getRecord(0).getItem("GAS_COMPONENT_INDEX").get< int >(0) - 1;
                 gasvisctColumnName_ = "Viscosity"+std::to_string(static_cast<long long>(gasCompIdx_));
+
+                // the table gives the viscosity itself, i.e., the factor is
+                // relative to unity.
+                viscosity_.resize(numRegions);
+                for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
+                    const GasvisctTable& gasvisctTable = gasvisctTables_->getTable<GasvisctTable>(regionIdx);
+                    viscosity_[regionIdx] =
+                        ViscosityTemperatureFactor(gasvisctTable.getColumn("Temperature").vectorCopy(),
+                                                   gasvisctTable.getColumn(gasvisctColumnName_).vectorCopy(),
+                                                   1.0);
+                }
             }
 
             // density
@@ -97,6 +109,7 @@ namespace Opm
                         double* output_dmudr) const
         {
             if (gasvisctTables_ != 0) {
+                int hint = 0;
                 for (int i = 0; i < n; ++i) {
                     // temperature dependence of the gas phase. this assumes that the gas
                     // component index has been set properly, and it also looses the
@@ -106,11 +119,7 @@ namespace Opm
 
 
                     int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
-                    double muGasvisct;
-                    {
-                        const GasvisctTable& gasvisctTable = gasvisctTables_->getTable<GasvisctTable>(regionIdx);
-                        muGasvisct = gasvisctTable.evaluate(gasvisctColumnName_, T[i]);
-                    }
+                    double muGasvisct = viscosity_[regionIdx](T[i], hint);
 
                     output_mu[i] = muGasvisct;
                     output_dmudp[i] = 0.0;
@@ -136,6 +145,7 @@ namespace Opm
                         double* output_dmudr) const
         {
             if (gasvisctTables_ != 0) {
+                int hint = 0;
                 for (int i = 0; i < n; ++i) {
                     // temperature dependence of the gas phase. this assumes that the gas
                     // component index has been set properly, and it also looses the
@@ -143,11 +153,7 @@ namespace Opm
                     // seems to be what the documentation for the GASVISCT keyword in the
                     // RM says.)
                     int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
-                    double muGasvisct;
-                    {
-                        const GasvisctTable& gasvisctTable = gasvisctTables_->getTable<GasvisctTable>(regionIdx);
-                        muGasvisct = gasvisctTable.evaluate(gasvisctColumnName_, T[i]);
-                    }
+                    double muGasvisct = viscosity_[regionIdx](T[i], hint);
 
                     output_mu[i] = muGasvisct;
                     output_dmudp[i] = 0.0;
@@ -310,6 +316,7 @@ namespace Opm
         // to store one value per PVT region.
         const TableContainer* gasvisctTables_;
         std::string gasvisctColumnName_;
+        std::vector<ViscosityTemperatureFactor> viscosity_;
         int gasCompIdx_;
 
         // The PVT properties needed for temperature dependence of the density.
@@ -21,6 +21,7 @@
 #define OPM_THERMAL_OIL_PVT_WRAPPER_HPP
 
 #include <opm/core/props/pvt/PvtInterface.hpp>
+#include <opm/core/props/pvt/ViscosityTemperatureFactor.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -36,6 +37,7 @@ namespace Opm
     {
     public:
         ThermalOilPvtWrapper()
+            : oilvisctTables_(0)
         {}
 
 
@@ -69,6 +71,7 @@ namespace Opm
                 viscrefPress_.resize(numRegions);
                 viscrefRs_.resize(numRegions);
                 muRef_.resize(numRegions);
+                viscosityFactor_.resize(numRegions);
                 for (int regionIdx = 0; regionIdx < numRegions; ++regionIdx) {
                     const auto& viscrefRecord = viscrefKeyword.getRecord(regionIdx);
                     viscrefPress_[regionIdx] = viscrefRecord.getItem("REFERENCE_PRESSURE").getSIDouble(0);
@@ -89,6 +92,12 @@ namespace Opm
                                        &muRef_[regionIdx],
                                        &tmp1,
                                        &tmp2);
+
+                    const OilvisctTable& oilvisctTable = oilvisctTables_->getTable<OilvisctTable>(regionIdx);
+                    viscosityFactor_[regionIdx] =
+                        ViscosityTemperatureFactor(oilvisctTable.getColumn("Temperature").vectorCopy(),
+                                                   oilvisctTable.getColumn("Viscosity").vectorCopy(),
+                                                   muRef_[regionIdx]);
                 }
             }
 
@@ -140,20 +149,13 @@ namespace Opm
                 return;
 
             // temperature dependence
+            int hint = 0;
             for (int i = 0; i < n; ++i) {
                 int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
 
-                // calculate the viscosity of the isothermal keyword for the reference
-                // pressure given by the VISCREF keyword.
-                double muRef = muRef_[regionIdx];
-
-                // compute the viscosity deviation due to temperature
-                double alpha;
-                {
-                    const OilvisctTable& oilvisctTable = oilvisctTables_->getTable<OilvisctTable>(regionIdx);
-                    double muOilvisct = oilvisctTable.evaluate("Viscosity", T[i]);
-                    alpha = muOilvisct/muRef;
-                }
+                // compute the viscosity deviation due to temperature, relative to
+                // the viscosity at the reference pressure given by VISCREF.
+                double alpha = viscosityFactor_[regionIdx](T[i], hint);
 
                 output_mu[i] *= alpha;
                 output_dmudp[i] *= alpha;
@@ -180,20 +182,13 @@ namespace Opm
                 return;
 
             // temperature dependence
+            int hint = 0;
             for (int i = 0; i < n; ++i) {
                 int regionIdx = getPvtRegionIndex_(pvtRegionIdx, i);
 
-                // calculate the viscosity of the isothermal keyword for the reference
-                // pressure given by the VISCREF keyword.
-                double muRef = muRef_[regionIdx];
-
-                // compute the viscosity deviation due to temperature
-                double alpha;
-                {
-                    const OilvisctTable& oilvisctTable = oilvisctTables_->getTable<OilvisctTable>(regionIdx);
-                    double muOilvisct = oilvisctTable.evaluate("Viscosity", T[i]);
-                    alpha = muOilvisct/muRef;
-                }
+                // compute the viscosity deviation due to temperature, relative to
+                // the viscosity at the reference pressure given by VISCREF.
+                double alpha = viscosityFactor_[regionIdx](T[i], hint);
                 output_mu[i] *= alpha;
                 output_dmudp[i] *= alpha;
                 output_dmudr[i] *= alpha;
@@ -374,6 +369,7 @@ namespace Opm
         std::vector<double> viscrefPress_;
         std::vector<double> viscrefRs_;
         std::vector<double> muRef_;
+        std::vector<ViscosityTemperatureFactor> viscosityFactor_;
 
         const TableContainer* oilvisctTables_;
 
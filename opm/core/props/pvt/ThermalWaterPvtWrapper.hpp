@@ -21,6 +21,7 @@
 #define OPM_THERMAL_WATER_PVT_WRAPPER_HPP
 
 #include <opm/core/props/pvt/PvtInterface.hpp>
+#include <opm/core/props/pvt/ViscosityTemperatureFactor.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -74,10 +75,22 @@ namespace Opm
                 assert(int(viscrefKeyword.size()) == numRegions);
 
                 viscrefPress_.resize(numRegions);
+                viscosityFactor_.resize(numRegions);
                 for (int regionIdx = 0; regionIdx < numRegions; ++ regionIdx) {
                     const auto& viscrefRecord = viscrefKeyword.getRecord(regionIdx);
 
                     viscrefPress_[regionIdx] = viscrefRecord.getItem("REFERENCE_PRESSURE").getSIDouble(0);
+
+                    // calculate the viscosity of the isothermal keyword for the reference
+                    // pressure given by the VISCREF keyword.
+                    double x = -pvtwViscosibility_[regionIdx]*(viscrefPress_[regionIdx] - pvtwRefPress_[regionIdx]);
+                    double muRef = pvtwViscosity_[regionIdx]/(1.0 + x + 0.5*x*x);
+
+                    const WatvisctTable& watVisctTable = watvisctTables_->getTable<WatvisctTable>(regionIdx);
+                    viscosityFactor_[regionIdx] =
+                        ViscosityTemperatureFactor(watVisctTable.getColumn("Temperature").vectorCopy(),
+                                                   watVisctTable.getColumn("Viscosity").vectorCopy(),
+                                                   muRef);
                 }
             }
 
@@ -134,21 +147,13 @@ namespace Opm
                 return;
 
             // temperature dependence
+            int hint = 0;
             for (int i = 0; i < n; ++i) {
                 int tableIdx = getTableIndex_(pvtRegionIdx, i);
 
-                // calculate the viscosity of the isothermal keyword for the reference
-                // pressure given by the VISCREF keyword.
-                double x = -pvtwViscosibility_[tableIdx]*(viscrefPress_[tableIdx] - pvtwRefPress_[tableIdx]);
-                double muRef = pvtwViscosity_[tableIdx]/(1.0 + x + 0.5*x*x);
-
-                // compute the viscosity deviation due to temperature
-                double alpha;
-                {
-                    const WatvisctTable& watVisctTable = watvisctTables_->getTable<WatvisctTable>(tableIdx);
-                    double muWatvisct = watVisctTable.evaluate("Viscosity", T[i]);
-                    alpha = muWatvisct/muRef;
-                }
+                // compute the viscosity deviation due to temperature, relative to
+                // the viscosity at the reference pressure given by VISCREF.
+                double alpha = viscosityFactor_[tableIdx](T[i], hint);
 
                 output_mu[i] *= alpha;
                 output_dmudp[i] *= alpha;
@@ -175,21 +180,13 @@ namespace Opm
                 return;
 
             // temperature dependence
+            int hint = 0;
             for (int i = 0; i < n; ++i) {
                 int tableIdx = getTableIndex_(pvtRegionIdx, i);
 
-                // calculate the viscosity of the isothermal keyword for the reference
-                // pressure given by the VISCREF keyword.
-                double x = -pvtwViscosibility_[tableIdx]*(viscrefPress_[tableIdx] - pvtwRefPress_[tableIdx]);
-                double muRef = pvtwViscosity_[tableIdx]/(1.0 + x + 0.5*x*x);
-
-                // compute the viscosity deviation due to temperature
-                double alpha;
-                {
-                    const WatvisctTable& watVisctTable = watvisctTables_->getTable<WatvisctTable>(tableIdx);
-                    double muWatvisct = watVisctTable.evaluate("Viscosity", T[i]);
-                    alpha = muWatvisct/muRef;
-                }
+                // compute the viscosity deviation due to temperature, relative to
+                // the viscosity at the reference pressure given by VISCREF.
+                double alpha = viscosityFactor_[tableIdx](T[i], hint);
                 output_mu[i] *= alpha;
                 output_dmudp[i] *= alpha;
                 output_dmudr[i] *= alpha;
@@ -379,6 +376,7 @@ namespace Opm
         // The PVT properties needed for temperature dependence. We need to store one
         // value per PVT region.
         std::vector<double> viscrefPress_;
+        std::vector<ViscosityTemperatureFactor> viscosityFactor_;
 
         std::vector<double> watdentRefTemp_;
         std::vector<double> watdentCT1_;
@@ -0,0 +1,96 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_VISCOSITY_TEMPERATURE_FACTOR_HPP
+#define OPM_VISCOSITY_TEMPERATURE_FACTOR_HPP
+
+#include <opm/core/utility/linearInterpolation.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace Opm
+{
+    /// Temperature dependence of a viscosity given by a table such as
+    /// OILVISCT, WATVISCT or GASVISCT, as a factor mu(T)/mu_ref.
+    ///
+    /// The interpolation coefficients of every table interval are
+    /// computed once, so an evaluation is a table search and a
+    /// multiply-add. Outside the table the factor is constant, as for
+    /// SimpleTable::evaluate().
+    class ViscosityTemperatureFactor
+    {
+    public:
+        ViscosityTemperatureFactor()
+        {}
+
+        /// \param[in] temperature  Increasing temperatures of the table.
+        /// \param[in] viscosity    Viscosity at each temperature.
+        /// \param[in] muRef        Viscosity which the factor is relative to.
+        ViscosityTemperatureFactor(const std::vector<double>& temperature,
+                                   const std::vector<double>& viscosity,
+                                   const double muRef)
+            : temperature_(temperature)
+        {
+            assert(!temperature.empty() && temperature.size() == viscosity.size());
+            const int numIntervals = std::max(int(temperature.size()) - 1, 1);
+            constant_.assign(numIntervals, viscosity.front()/muRef);
+            slope_.assign(numIntervals, 0.0);
+            for (int j = 0; j + 1 < int(temperature.size()); ++j) {
+                slope_[j] = (viscosity[j + 1] - viscosity[j])
+                    / (temperature[j + 1] - temperature[j]) / muRef;
+                constant_[j] = viscosity[j]/muRef - slope_[j]*temperature[j];
+            }
+            frontFactor_ = viscosity.front()/muRef;
+            backFactor_ = viscosity.back()/muRef;
+        }
+
+        /// Factor at a given temperature.
+        /// \param[in]     T     Temperature.
+        /// \param[in,out] hint  Guess for the table interval containing T,
+        ///                      on output the actual interval. Since
+        ///                      temperature varies slowly between
+        ///                      neighbouring cells, passing the same hint
+        ///                      along a range of cells mostly avoids the
+        ///                      binary search.
+        double operator()(const double T, int& hint) const
+        {
+            if (T <= temperature_.front()) {
+                return frontFactor_;
+            }
+            if (T >= temperature_.back()) {
+                return backFactor_;
+            }
+            hint = tableIndex(temperature_, T, hint);
+            return constant_[hint] + slope_[hint]*T;
+        }
+
+    private:
+        std::vector<double> temperature_;
+        // The factor is constant_[j] + slope_[j]*T on interval j.
+        std::vector<double> constant_;
+        std::vector<double> slope_;
+        double frontFactor_;
+        double backFactor_;
+    };
+
+}
+
+#endif
@@ -27,14 +27,23 @@
 #include <opm/parser/eclipse/EclipseState/Tables/RocktabTable.hpp>
 #include <opm/parser/eclipse/EclipseState/Tables/TableManager.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace Opm
 {
 
+    namespace
+    {
+        // Number of uniform pressure bins per ROCKTAB interval.
+        const int BinsPerInterval = 4;
+    } // anonymous namespace
+
     RockCompressibility::RockCompressibility(const parameter::ParameterGroup& param)
         : pref_(0.0),
-          rock_comp_(0.0)
+          rock_comp_(0.0),
+          bin_pmin_(0.0),
+          bin_inv_width_(0.0)
     {
         pref_ = param.getDefault("rock_compressibility_pref", 100.0)*unit::barsa;
         rock_comp_ = param.getDefault("rock_compressibility", 0.0)/unit::barsa;
@@ -43,7 +52,9 @@ namespace Opm
     RockCompressibility::RockCompressibility(Opm::DeckConstPtr deck,
                                              Opm::EclipseStateConstPtr eclipseState)
         : pref_(0.0),
-          rock_comp_(0.0)
+          rock_comp_(0.0),
+          bin_pmin_(0.0),
+          bin_inv_width_(0.0)
     {
         const auto tables = eclipseState->getTableManager();
         const auto& rocktabTables = tables->getRocktabTables();
@@ -59,6 +70,7 @@ namespace Opm
             } else {
                 transmult_ =  rocktabTable.getColumn("PV_MULT_TRANX").vectorCopy();
             }
+            initTableIndex();
         } else if (deck->hasKeyword("ROCK")) {
             const auto& rockKeyword = deck->getKeyword("ROCK");
             if (rockKeyword.size() != 1) {
@@ -75,6 +87,65 @@ namespace Opm
         }
     }
 
+    /// Set up the uniform pressure bins of the table lookup.
+    void RockCompressibility::initTableIndex()
+    {
+        // Binning is only possible for increasing tables of more than
+        // one interval.  Other tables use the plain binary search.
+        bin_interval_.clear();
+        const int num_intervals = p_.size() - 1;
+        if (num_intervals < 2 || !(p_.back() > p_.front())) {
+            return;
+        }
+        const int num_bins = BinsPerInterval*num_intervals;
+        bin_pmin_ = p_.front();
+        bin_inv_width_ = num_bins/(p_.back() - p_.front());
+        bin_interval_.resize(num_bins);
+        for (int b = 0; b < num_bins; ++b) {
+            bin_interval_[b] = Opm::tableIndex(p_, bin_pmin_ + b/bin_inv_width_);
+        }
+    }
+
+    /// Table interval containing a pressure, with the same result as
+    /// Opm::tableIndex(p_, pressure).
+    int RockCompressibility::tableIndex(const double pressure) const
+    {
+        if (bin_interval_.empty()) {
+            return Opm::tableIndex(p_, pressure);
+        }
+        // Pressures outside the table (and NaNs) fall in the end bins.
+        const int num_bins = bin_interval_.size();
+        const double t = (pressure - bin_pmin_)*bin_inv_width_;
+        const int bin = (t > 0.0) ? ((t < num_bins) ? static_cast<int>(t) : num_bins - 1) : 0;
+        // Few table points fall within a bin, but rounding may also
+        // place a pressure just below the start of its bin.
+        const int last = p_.size() - 2;
+        int j = bin_interval_[bin];
+        while (j < last && pressure >= p_[j + 1]) {
+            ++j;
+        }
+        while (j > 0 && pressure < p_[j]) {
+            --j;
+        }
+        return j;
+    }
+
+    /// Linear interpolation, with extrapolation, in a column of the
+    /// table, and optionally its derivative.
+    void RockCompressibility::evalTable(const std::vector<double>& values,
+                                        const int n, const double* pressure,
+                                        double* y, double* dydp) const
+    {
+        for (int i = 0; i < n; ++i) {
+            const int j = tableIndex(pressure[i]);
+            const double slope = (values[j + 1] - values[j])/(p_[j + 1] - p_[j]);
+            y[i] = slope*(pressure[i] - p_[j]) + values[j];
+            if (dydp) {
+                dydp[i] = slope;
+            }
+        }
+    }
+
     bool RockCompressibility::isActive() const
     {
         return !p_.empty() || (rock_comp_ != 0.0);
@@ -87,7 +158,9 @@ namespace Opm
             const double cpnorm = rock_comp_*(pressure - pref_);
             return (1.0 + cpnorm + 0.5*cpnorm*cpnorm);
         } else {
-            return Opm::linearInterpolation(p_, poromult_, pressure);
+            double mult;
+            evalTable(poromult_, 1, &pressure, &mult, 0);
+            return mult;
         }
     }
 
@@ -98,7 +171,9 @@ namespace Opm
             // we must use its derivative.
             return rock_comp_ + 2 * rock_comp_ * rock_comp_ * (pressure - pref_);
         } else {
-            return Opm::linearInterpolationDerivative(p_, poromult_, pressure);
+            double mult, dmultdp;
+            evalTable(poromult_, 1, &pressure, &mult, &dmultdp);
+            return dmultdp;
         }
     }
 
@@ -107,7 +182,9 @@ namespace Opm
         if (p_.empty()) {
             return 1.0;
         } else {
-            return Opm::linearInterpolation(p_, transmult_, pressure);
+            double mult;
+            evalTable(transmult_, 1, &pressure, &mult, 0);
+            return mult;
         }
     }
 
@@ -116,7 +193,9 @@ namespace Opm
         if (p_.empty()) {
             return 0.0;
         } else {
-            return Opm::linearInterpolationDerivative(p_, transmult_, pressure);
+            double mult, dmultdp;
+            evalTable(transmult_, 1, &pressure, &mult, &dmultdp);
+            return dmultdp;
         }
     }
 
@@ -125,14 +204,57 @@ namespace Opm
         if (p_.empty()) {
             return rock_comp_;
         } else {
-            //const double poromult = Opm::linearInterpolation(p_, poromult_, pressure);
-            //const double dporomultdp = Opm::linearInterpolationDerivative(p_, poromult_, pressure);
-            const double poromult = Opm::linearInterpolation(p_, poromult_, pressure);
-            const double dporomultdp = Opm::linearInterpolationDerivative(p_, poromult_, pressure);
-
+            double poromult, dporomultdp;
+            evalTable(poromult_, 1, &pressure, &poromult, &dporomultdp);
             return dporomultdp/poromult;
         }
     }
 
+    void RockCompressibility::poroMult(const int n, const double* pressure,
+                                       double* mult, double* dmultdp) const
+    {
+        if (p_.empty()) {
+            // Approximating with a quadratic curve.
+            for (int i = 0; i < n; ++i) {
+                const double cpnorm = rock_comp_*(pressure[i] - pref_);
+                mult[i] = 1.0 + cpnorm + 0.5*cpnorm*cpnorm;
+            }
+            if (dmultdp) {
+                for (int i = 0; i < n; ++i) {
+                    dmultdp[i] = rock_comp_ + 2 * rock_comp_ * rock_comp_ * (pressure[i] - pref_);
+                }
+            }
+        } else {
+            evalTable(poromult_, n, pressure, mult, dmultdp);
+        }
+    }
+
+    void RockCompressibility::transMult(const int n, const double* pressure,
+                                        double* mult, double* dmultdp) const
+    {
+        if (p_.empty()) {
+            std::fill(mult, mult + n, 1.0);
+            if (dmultdp) {
+                std::fill(dmultdp, dmultdp + n, 0.0);
+            }
+        } else {
+            evalTable(transmult_, n, pressure, mult, dmultdp);
+        }
+    }
+
+    void RockCompressibility::rockComp(const int n, const double* pressure,
+                                       double* rock_comp) const
+    {
+        if (p_.empty()) {
+            std::fill(rock_comp, rock_comp + n, rock_comp_);
+        } else {
+            std::vector<double> poromult(n);
+            evalTable(poromult_, n, pressure, poromult.data(), rock_comp);
+            for (int i = 0; i < n; ++i) {
+                rock_comp[i] /= poromult[i];
+            }
+        }
+    }
+
 } // namespace Opm
 
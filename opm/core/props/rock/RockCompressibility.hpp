@@ -62,12 +62,48 @@ namespace Opm
         /// Rock compressibility = (d poro / d p)*(1 / poro).
         double rockComp(double pressure) const;
 
+        /// Porosity multipliers of a number of pressure values.
+        /// \param[in]  n          Number of data points.
+        /// \param[in]  pressure   Array of n pressure values.
+        /// \param[out] mult       Array of n porosity multipliers.
+        /// \param[out] dmultdp    If non-null: array of n derivatives of
+        ///                        the multipliers with respect to pressure.
+        void poroMult(const int n, const double* pressure,
+                      double* mult, double* dmultdp) const;
+
+        /// Transmissibility multipliers of a number of pressure values.
+        /// \param[in]  n          Number of data points.
+        /// \param[in]  pressure   Array of n pressure values.
+        /// \param[out] mult       Array of n transmissibility multipliers.
+        /// \param[out] dmultdp    If non-null: array of n derivatives of
+        ///                        the multipliers with respect to pressure.
+        void transMult(const int n, const double* pressure,
+                       double* mult, double* dmultdp) const;
+
+        /// Rock compressibilities of a number of pressure values.
+        /// \param[in]  n          Number of data points.
+        /// \param[in]  pressure   Array of n pressure values.
+        /// \param[out] rock_comp  Array of n rock compressibilities.
+        void rockComp(const int n, const double* pressure,
+                      double* rock_comp) const;
+
     private:
+        void initTableIndex();
+        int tableIndex(const double pressure) const;
+        void evalTable(const std::vector<double>& values,
+                       const int n, const double* pressure,
+                       double* y, double* dydp) const;
+
         std::vector<double> p_;
         std::vector<double> poromult_;
         std::vector<double> transmult_;
         double pref_;
         double rock_comp_;
+        // Table interval at the start of each of a number of uniform
+        // pressure bins, for constant-time table lookup.
+        std::vector<int> bin_interval_;
+        double bin_pmin_;
+        double bin_inv_width_;
     };
 
 } // namespace Opm
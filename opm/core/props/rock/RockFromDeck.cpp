@@ -100,10 +100,8 @@ namespace Opm
         Array poro_glob(eclState, "PORO", 1.0);
         GridPropertyAccess::Compressed<Array> poro(poro_glob, global_cell);
 
-        porosity_.clear(); porosity_.reserve(number_of_cells);
-        for (int c = 0; c < number_of_cells; ++c) {
-            porosity_.push_back(poro[c]);
-        }
+        poro.gather(number_of_cells);
+        porosity_.assign(poro.data(), poro.data() + number_of_cells);
     }
 
     void RockFromDeck::assignPermeability(Opm::EclipseStateConstPtr eclState,
@@ -132,9 +130,21 @@ namespace Opm
 
         assert (! tensor.empty());
         {
-            int off = 0;
+            // Materialise each component once; tensor entries sharing
+            // a component (kmap) then read the same contiguous array.
+            for (auto& comp : tensor) {
+                comp.gather(nc);
+            }
+            std::array<const double*, 9> kval;
+            for (int kix = 0; kix < dim*dim; ++kix) {
+                kval[kix] = tensor[kmap[kix]].data();
+            }
 
-            for (int c = 0; c < nc; ++c, off += dim*dim) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (int c = 0; c < nc; ++c) {
+                const int off = c*dim*dim;
                 // SharedPermTensor K(dim, dim, &permeability_[off]);
                 int kix = 0;
 
@@ -147,8 +157,7 @@ namespace Opm
                         // values in the resulting array are the same
                         // in either order when viewed contiguously
                         // because fillTensor() enforces symmetry.
-                        permeability_[off + (i + dim*j)] =
-                            tensor[kmap[kix]][c];
+                        permeability_[off + (i + dim*j)] = kval[kix][c];
                     }
 
                     // K(i,i) = std::max(K(i,i), perm_threshold);
@@ -24,7 +24,9 @@
 
 namespace Opm{
 
-    RelpermDiagnostics::RelpermDiagnostics(std::string& logFile)
+    RelpermDiagnostics::RelpermDiagnostics(std::string& logFile,
+                                           const bool errorsOnly)
+        : errorsOnly_(errorsOnly)
     {
         streamLog_ = std::make_shared<Opm::StreamLog>(logFile, Opm::Log::DefaultMessageTypes);
     }
@@ -61,6 +63,19 @@ namespace Opm{
 
 
 
+    void RelpermDiagnostics::addWarning_(std::vector<std::string>& messages,
+                                         const std::string& msg)
+    {
+        counter_.warning += 1;
+        if (!errorsOnly_) {
+            messages.push_back(msg);
+            streamLog_->addMessage(Log::MessageType::Warning, msg);
+        }
+    }
+
+
+
+
     void RelpermDiagnostics::phaseCheck_(DeckConstPtr deck)
     {
         bool hasWater = deck->hasKeyword("WATER");
@@ -737,15 +752,11 @@ namespace Opm{
              ///Consistency check.
              if (unscaledEpsInfo_[satnumIdx].Sgu > (1. - unscaledEpsInfo_[satnumIdx].Swl)) {
                 const std::string msg = "-- Warning: In saturation table SATNUM = " + regionIdx + ", Sgmax should not exceed 1-Swco.";
-                messages_.push_back(msg);
-                streamLog_->addMessage(Log::MessageType::Warning, msg);
-                counter_.warning += 1;
+                addWarning_(messages_, msg);
              }
              if (unscaledEpsInfo_[satnumIdx].Sgl > (1. - unscaledEpsInfo_[satnumIdx].Swu)) {
                 const std::string msg = "-- Warning: In saturation table SATNUM = " + regionIdx + ", Sgco should not exceed 1-Swmax.";
-                messages_.push_back(msg);
-                streamLog_->addMessage(Log::MessageType::Warning, msg);
-                counter_.warning += 1;
+                addWarning_(messages_, msg);
              }
 
              //Krow(Sou) == Krog(Sou) for three-phase
@@ -777,24 +788,18 @@ namespace Opm{
                  }
                  if (krow_value != krog_value) {
                      const std::string msg = "-- Warning: In saturation table SATNUM = " + regionIdx + ", Krow(Somax) should be equal to Krog(Somax).";
-                     messages_.push_back(msg);
-                     streamLog_->addMessage(Log::MessageType::Warning, msg);
-                     counter_.warning += 1;
+                     addWarning_(messages_, msg);
                  }
              }
              //Krw(Sw=0)=Krg(Sg=0)=Krow(So=0)=Krog(So=0)=0.
              //Mobile fluid requirements
             if (((unscaledEpsInfo_[satnumIdx].Sowcr + unscaledEpsInfo_[satnumIdx].Swcr)-1) >= 0) {
                 const std::string msg = "-- Warning: In saturation table SATNUM = " + regionIdx + ", Sowcr + Swcr should be less than 1.";
-                messages_.push_back(msg);
-                streamLog_->addMessage(Log::MessageType::Warning, msg);
-                counter_.warning += 1;
+                addWarning_(messages_, msg);
             }
             if (((unscaledEpsInfo_[satnumIdx].Sogcr + unscaledEpsInfo_[satnumIdx].Sgcr + unscaledEpsInfo_[satnumIdx].Swl) - 1 ) > 0) {
                 const std::string msg = "-- Warning: In saturation table SATNUM = " + regionIdx + ", Sogcr + Sgcr + Swco should be less than 1.";
-                messages_.push_back(msg);
-                streamLog_->addMessage(Log::MessageType::Warning, msg);
-                counter_.warning += 1;
+                addWarning_(messages_, msg);
             }
         }
     }
@@ -802,6 +807,121 @@ namespace Opm{
 
 
 
+    // The scaled end-point checks, in the order they are reported.
+    const RelpermDiagnostics::ScaledEndPointMessage
+    RelpermDiagnostics::scaledEndPointMessages_[] = {
+        { SguSwl, ", SGU exceed 1.0 - SWL", false },
+        { SglSwu, ", SGL exceed 1.0 - SWU", false },
+        { SowcrSwcr, ", SOWCR + SWCR exceed 1.0", false },
+        { SogcrSgcrSwl, ", SOGCR + SGCR + SWL exceed 1.0", true },
+        { SwlSwcr, ", SWL > SWCR", false },
+        { SwcrSowcr, ", SWCR > SOWCR", false },
+        { SowcrSwu, ", SOWCR > SWU", false },
+        { SglSgcr, ", SGL > SGCR", false },
+        { SgcrSogcr, ", SGCR > SOGCR", false },
+        { SogcrSgu, ", SOGCR > SGU", false }
+    };
+
 
 
+
+    bool RelpermDiagnostics::sameScaledEndPoints_(const EclEpsScalingPointsInfo<double>& a,
+                                                  const EclEpsScalingPointsInfo<double>& b)
+    {
+        return a.Swl == b.Swl && a.Sgl == b.Sgl
+            && a.Swcr == b.Swcr && a.Sgcr == b.Sgcr
+            && a.Sowcr == b.Sowcr && a.Sogcr == b.Sogcr
+            && a.Swu == b.Swu && a.Sgu == b.Sgu;
+    }
+
+
+
+
+    unsigned RelpermDiagnostics::scaledEndPointsFailures_(const EclEpsScalingPointsInfo<double>& epsInfo,
+                                                          const bool scalecrs) const
+    {
+        unsigned failures = 0;
+        // SGU <= 1.0 - SWL
+        if (epsInfo.Sgu > (1.0 - epsInfo.Swl)) {
+            failures |= SguSwl;
+        }
+        // SGL <= 1.0 - SWU
+        if (epsInfo.Sgl > (1.0 - epsInfo.Swu)) {
+            failures |= SglSwu;
+        }
+        if (scalecrs && fluidSystem_ == FluidSystem::BlackOil) {
+            // Mobilility check.
+            if ((epsInfo.Sowcr + epsInfo.Swcr) >= 1.0) {
+                failures |= SowcrSwcr;
+            }
+            if ((epsInfo.Sogcr + epsInfo.Sgcr + epsInfo.Swl) >= 1.0) {
+                failures |= SogcrSgcrSwl;
+            }
+        }
+        ///Following rules come from NEXUS.
+        if (fluidSystem_ != FluidSystem::WaterGas) {
+            if (epsInfo.Swl > epsInfo.Swcr) {
+                failures |= SwlSwcr;
+            }
+            if (epsInfo.Swcr > epsInfo.Sowcr) {
+                failures |= SwcrSowcr;
+            }
+            if (epsInfo.Sowcr > epsInfo.Swu) {
+                failures |= SowcrSwu;
+            }
+        }
+        if (fluidSystem_ != FluidSystem::OilWater) {
+            if (epsInfo.Sgl > epsInfo.Sgcr) {
+                failures |= SglSgcr;
+            }
+        }
+        if (fluidSystem_ != FluidSystem::BlackOil) {
+            if (epsInfo.Sgcr > epsInfo.Sogcr) {
+                failures |= SgcrSogcr;
+            }
+            if (epsInfo.Sogcr > epsInfo.Sgu) {
+                failures |= SogcrSgu;
+            }
+        }
+        return failures;
+    }
+
+
+
+
+    void RelpermDiagnostics::reportScaledEndPoints_(const unsigned failures,
+                                                    const std::array<int, 3>& ijk,
+                                                    const int satnum)
+    {
+        if (errorsOnly_ && !(failures & ScaledEndPointErrors)) {
+            for (const auto& m : scaledEndPointMessages_) {
+                if (failures & m.check) {
+                    counter_.warning += 1;
+                }
+            }
+            return;
+        }
+        const std::string cellIdx = "(" + std::to_string(ijk[0]) + ", " +
+                               std::to_string(ijk[1]) + ", " +
+                               std::to_string(ijk[2]) + ")";
+        const std::string prefix = "-- Warning: For scaled endpoints input, cell" + cellIdx
+            + " SATNUM = " + std::to_string(satnum);
+        for (const auto& m : scaledEndPointMessages_) {
+            if (!(failures & m.check)) {
+                continue;
+            }
+            if (m.error) {
+                counter_.error += 1;
+            } else {
+                counter_.warning += 1;
+                if (errorsOnly_) {
+                    continue;
+                }
+            }
+            const std::string msg = prefix + m.text;
+            scaled_messages_.push_back(msg);
+            streamLog_->addMessage(Log::MessageType::Warning, msg);
+        }
+    }
+
 } //namespace Opm
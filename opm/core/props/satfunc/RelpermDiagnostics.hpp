@@ -20,6 +20,7 @@
 #ifndef OPM_RELPERMDIAGNOSTICS_HEADER_INCLUDED
 #define OPM_RELPERMDIAGNOSTICS_HEADER_INCLUDED
 
+#include <array>
 #include <vector>
 #include <utility>
 
@@ -54,7 +55,14 @@ namespace Opm {
     public:
 
         ///Constructor for OpmLog.
-        explicit RelpermDiagnostics(std::string& logFile);
+        ///\param[in] logFile     name of the log file.
+        ///\param[in] errorsOnly  if true, warnings are only counted,
+        ///                       and just errors are stored and logged.
+        ///                       This avoids formatting a message for
+        ///                       every cell with inconsistent scaled
+        ///                       end-points.
+        explicit RelpermDiagnostics(std::string& logFile,
+                                    bool errorsOnly = false);
 
         ///This function is used to diagnosis relperm in
         ///eclipse data file. Errors and warings will be 
@@ -99,6 +107,31 @@ namespace Opm {
         };
 
         Counter counter_;
+
+        bool errorsOnly_;
+
+        ///Scaled end-point checks, one bit each.
+        enum ScaledEndPointCheck {
+            SguSwl       = 1 << 0,
+            SglSwu       = 1 << 1,
+            SowcrSwcr    = 1 << 2,
+            SogcrSgcrSwl = 1 << 3,
+            SwlSwcr      = 1 << 4,
+            SwcrSowcr    = 1 << 5,
+            SowcrSwu     = 1 << 6,
+            SglSgcr      = 1 << 7,
+            SgcrSogcr    = 1 << 8,
+            SogcrSgu     = 1 << 9,
+            ScaledEndPointErrors = SogcrSgcrSwl
+        };
+
+        struct ScaledEndPointMessage {
+            unsigned check;
+            const char* text;
+            bool error;
+        };
+
+        static const ScaledEndPointMessage scaledEndPointMessages_[10];
         
         std::vector<Opm::EclEpsScalingPointsInfo<double> > unscaledEpsInfo_;
         std::vector<Opm::EclEpsScalingPointsInfo<double> > scaledEpsInfo_;
@@ -129,6 +162,25 @@ namespace Opm {
                                    EclipseStateConstPtr eclState,
                                    const GridT& grid);
 
+        ///Count a warning, and store and log it unless only errors
+        ///are reported.
+        void addWarning_(std::vector<std::string>& messages,
+                         const std::string& msg);
+
+        ///Whether two cells have the same end-points in all the scaled
+        ///end-point checks.
+        static bool sameScaledEndPoints_(const EclEpsScalingPointsInfo<double>& a,
+                                         const EclEpsScalingPointsInfo<double>& b);
+
+        ///Scaled end-point checks that fail for one cell.
+        unsigned scaledEndPointsFailures_(const EclEpsScalingPointsInfo<double>& epsInfo,
+                                          bool scalecrs) const;
+
+        ///Report the failed scaled end-point checks of one cell.
+        void reportScaledEndPoints_(unsigned failures,
+                                    const std::array<int, 3>& ijk,
+                                    int satnum);
+
         ///For every table, need to deal with case by case.
         void swofTableCheck_(const Opm::SwofTable& swofTables,
                              const int satnumIdx);
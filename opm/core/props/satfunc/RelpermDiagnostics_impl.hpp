@@ -20,6 +20,8 @@
 #ifndef OPM_RELPERMDIAGNOSTICS_IMPL_HEADER_INCLUDED
 #define OPM_RELPERMDIAGNOSTICS_IMPL_HEADER_INCLUDED
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <utility>
 
@@ -84,100 +86,43 @@ namespace Opm {
         EclEpsGridProperties epsGridProperties;
         epsGridProperties.initFromDeck(deck, eclState, /*imbibition=*/false);       
         const auto satnum = eclState->getIntGridProperty("SATNUM");
+        const bool scalecrs = deck->hasKeyword("SCALECRS");
+
+        // Extract and check the end-points in parallel. Scaled
+        // end-points are usually constant over large parts of the
+        // grid, so a cell with the same end-points as the previous
+        // cell of its block reuses that cell's result.
+        std::vector<unsigned> failures(nc, 0);
+        const int blockSize = 1024;
+        const int numBlocks = (nc + blockSize - 1) / blockSize;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int b = 0; b < numBlocks; ++b) {
+            const int end = std::min(nc, (b + 1)*blockSize);
+            for (int c = b*blockSize; c < end; ++c) {
+                scaledEpsInfo_[c].extractScaled(epsGridProperties, compressedToCartesianIdx[c]);
+                if (c > b*blockSize && sameScaledEndPoints_(scaledEpsInfo_[c], scaledEpsInfo_[c - 1])) {
+                    failures[c] = failures[c - 1];
+                } else {
+                    failures[c] = scaledEndPointsFailures_(scaledEpsInfo_[c], scalecrs);
+                }
+            }
+        }
 
+        // Messages are formatted, in cell order, only for the cells
+        // that fail a check.
         for (int c = 0; c < nc; ++c) {
+            if (failures[c] == 0) {
+                continue;
+            }
             const int cartIdx = compressedToCartesianIdx[c];
-            const std::string satnumIdx = std::to_string(satnum->iget(cartIdx));
             std::array<int, 3> ijk;
             ijk[0] = cartIdx % dims[0];
             ijk[1] = (cartIdx / dims[0]) % dims[1];
             ijk[2] = cartIdx / dims[0] / dims[1];
-            const std::string cellIdx = "(" + std::to_string(ijk[0]) + ", " + 
-                                   std::to_string(ijk[1]) + ", " +
-                                   std::to_string(ijk[2]) + ")";
-            scaledEpsInfo_[c].extractScaled(epsGridProperties, cartIdx);
-
-            // SGU <= 1.0 - SWL
-            if (scaledEpsInfo_[c].Sgu > (1.0 - scaledEpsInfo_[c].Swl)) {
-                const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SGU exceed 1.0 - SWL";
-                scaled_messages_.push_back(msg);
-                streamLog_->addMessage(Log::MessageType::Warning, msg);
-                counter_.warning += 1;
-            }
-            
-            // SGL <= 1.0 - SWU
-            if (scaledEpsInfo_[c].Sgl > (1.0 - scaledEpsInfo_[c].Swu)) {
-                const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SGL exceed 1.0 - SWU";
-                scaled_messages_.push_back(msg);
-                streamLog_->addMessage(Log::MessageType::Warning, msg);
-                counter_.warning += 1;
-            }
-
-            if (deck->hasKeyword("SCALECRS") && fluidSystem_ == FluidSystem::BlackOil) {
-                // Mobilility check.
-                if ((scaledEpsInfo_[c].Sowcr + scaledEpsInfo_[c].Swcr) >= 1.0) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SOWCR + SWCR exceed 1.0";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-
-                if ((scaledEpsInfo_[c].Sogcr + scaledEpsInfo_[c].Sgcr + scaledEpsInfo_[c].Swl) >= 1.0) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SOGCR + SGCR + SWL exceed 1.0";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.error += 1;
-                }
-            }
-            ///Following rules come from NEXUS.
-            if (fluidSystem_ != FluidSystem::WaterGas) {
-                if (scaledEpsInfo_[c].Swl > scaledEpsInfo_[c].Swcr) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SWL > SWCR";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-
-                if (scaledEpsInfo_[c].Swcr > scaledEpsInfo_[c].Sowcr) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SWCR > SOWCR";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Opm::Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-            
-                if (scaledEpsInfo_[c].Sowcr > scaledEpsInfo_[c].Swu) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SOWCR > SWU";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-            }
-
-            if (fluidSystem_ != FluidSystem::OilWater) {
-                if (scaledEpsInfo_[c].Sgl > scaledEpsInfo_[c].Sgcr) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SGL > SGCR";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-            }
-
-            if (fluidSystem_ != FluidSystem::BlackOil) {
-                if (scaledEpsInfo_[c].Sgcr > scaledEpsInfo_[c].Sogcr) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SGCR > SOGCR";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-
-                if (scaledEpsInfo_[c].Sogcr > scaledEpsInfo_[c].Sgu) {
-                    const std::string msg = "-- Warning: For scaled endpoints input, cell" + cellIdx + " SATNUM = " + satnumIdx + ", SOGCR > SGU";
-                    scaled_messages_.push_back(msg);
-                    streamLog_->addMessage(Log::MessageType::Warning, msg);
-                    counter_.warning += 1;
-                }
-            }
-        } 
+            reportScaledEndPoints_(failures[c], ijk, satnum->iget(cartIdx));
+        }
     }
 
 } //namespace Opm
@@ -27,7 +27,10 @@
 #include <opm/core/grid/GridHelpers.hpp>
 #include <opm/core/simulator/ExplicitArraysFluidState.hpp>
 #include <opm/core/simulator/ExplicitArraysSatDerivativesFluidState.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 
@@ -36,6 +39,174 @@ namespace Opm
 
     typedef SaturationPropsFromDeck::MaterialLawManager::MaterialLaw MaterialLaw;
 
+    namespace
+    {
+        /// Smallest number of cells for which the evaluation is threaded.
+        const int parallel_min_cells = 1024;
+
+        /// Sign applied to the capillary pressure of each phase.
+        const double capPressSign[BlackoilPhases::MaxNumPhases] = { -1.0, 1.0, 1.0 };
+
+        /// Strides of the output arrays.  The value for cell i and
+        /// phase p is stored at i*cell + p*phase, the derivative with
+        /// respect to saturation j at i*dcell + p*dphase + j*dsat.
+        struct OutputLayout
+        {
+            int cell;
+            int phase;
+            int dcell;
+            int dphase;
+            int dsat;
+        };
+
+        struct RelpermLaw
+        {
+            template <class Evaluation, class Params, class FluidState>
+            void operator()(Evaluation* values, const Params& params, const FluidState& fs) const
+            {
+                MaterialLaw::relativePermeabilities(values, params, fs);
+            }
+        };
+
+        struct CapPressLaw
+        {
+            template <class Evaluation, class Params, class FluidState>
+            void operator()(Evaluation* values, const Params& params, const FluidState& fs) const
+            {
+                MaterialLaw::capillaryPressures(values, params, fs);
+            }
+        };
+
+        inline double valueOf(const double& x) { return x; }
+        inline double derivativeOf(const double&, int) { return 0.0; }
+
+        template <class Evaluation>
+        double valueOf(const Evaluation& x) { return x.value; }
+
+        template <class Evaluation>
+        double derivativeOf(const Evaluation& x, int j) { return x.derivatives[j]; }
+
+        // Evaluate a saturation function law in all lanes of a
+        // batch.  Results are stored according to layout, at the
+        // lane number if by_lane is true and at the array index of
+        // the lane otherwise.
+        template <class Evaluation, class Law>
+        void evaluateBatch(const SaturationPropsFromDeck::FluidStateBatch& batch,
+                           const int* cells,
+                           const Law& law,
+                           const SaturationPropsFromDeck::MaterialLawManager& mgr,
+                           const double* sign,
+                           const OutputLayout& layout,
+                           const bool by_lane,
+                           double* v,
+                           double* dvds)
+        {
+            const int np = batch.phaseUsage().num_phases;
+            Evaluation values[BlackoilPhases::MaxNumPhases];
+            for (int l = 0; l < batch.size(); ++l) {
+                const int i = batch.index(l);
+                law(values, mgr.materialLawParams(cells[i]),
+                    batch.lane<Evaluation>(l));
+
+                // copy the values calculated using opm-material to the target arrays
+                const int o = by_lane ? l : i;
+                for (int p = 0; p < np; ++p) {
+                    v[o*layout.cell + p*layout.phase] = sign[p]*valueOf(values[p]);
+                }
+                if (dvds) {
+                    for (int p = 0; p < np; ++p) {
+                        for (int j = 0; j < np; ++j) {
+                            dvds[o*layout.dcell + p*layout.dphase + j*layout.dsat]
+                                = sign[p]*derivativeOf(values[p], j);
+                        }
+                    }
+                }
+            }
+        }
+
+        template <class Evaluation, class Law>
+        void evaluateCells(const int n,
+                           const double* s,
+                           const int* cells,
+                           const int* order,
+                           const Law& law,
+                           const PhaseUsage& pu,
+                           const SaturationPropsFromDeck::MaterialLawManager& mgr,
+                           const double* sign,
+                           const OutputLayout& layout,
+                           double* v,
+                           double* dvds)
+        {
+            typedef SaturationPropsFromDeck::FluidStateBatch Batch;
+            const int bs = Batch::batchSize;
+            const int nbatch = (n + bs - 1) / bs;
+#if defined(_OPENMP)
+#pragma omp parallel if (n >= parallel_min_cells)
+#endif
+            {
+                // Each thread gathers into its own batch.
+                Batch batch(pu);
+                batch.setSaturationArray(s);
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
+                for (int b = 0; b < nbatch; ++b) {
+                    batch.gather(b*bs, std::min(bs, n - b*bs), order);
+                    evaluateBatch<Evaluation>(batch, cells, law, mgr, sign,
+                                              layout, false, v, dvds);
+                }
+            }
+        }
+
+        // Evaluate a saturation function law at n points, in the
+        // given order (natural order if null), and store the results
+        // according to layout.
+        template <class Law>
+        void evaluate(const int n,
+                      const double* s,
+                      const int* cells,
+                      const int* order,
+                      const Law& law,
+                      const PhaseUsage& pu,
+                      const SaturationPropsFromDeck::MaterialLawManager& mgr,
+                      const double* sign,
+                      const OutputLayout& layout,
+                      double* v,
+                      double* dvds)
+        {
+            if (dvds) {
+                typedef ExplicitArraysSatDerivativesFluidState::Evaluation Evaluation;
+                evaluateCells<Evaluation>
+                    (n, s, cells, order, law, pu, mgr, sign, layout, v, dvds);
+            } else {
+                evaluateCells<double>
+                    (n, s, cells, order, law, pu, mgr, sign, layout, v, dvds);
+            }
+        }
+
+        // Evaluate a saturation function law in the lanes of a batch,
+        // with lane-major output (see relpermBatch()).
+        template <class Law>
+        void evaluate(const SaturationPropsFromDeck::FluidStateBatch& batch,
+                      const int* cells,
+                      const Law& law,
+                      const SaturationPropsFromDeck::MaterialLawManager& mgr,
+                      const double* sign,
+                      double* v,
+                      double* dvds)
+        {
+            const int np = batch.phaseUsage().num_phases;
+            const int bs = SaturationPropsFromDeck::FluidStateBatch::batchSize;
+            const OutputLayout layout = { 1, bs, 1, bs, np*bs };
+            if (dvds) {
+                typedef ExplicitArraysSatDerivativesFluidState::Evaluation Evaluation;
+                evaluateBatch<Evaluation>(batch, cells, law, mgr, sign, layout, true, v, dvds);
+            } else {
+                evaluateBatch<double>(batch, cells, law, mgr, sign, layout, true, v, dvds);
+            }
+        }
+    } // anonymous namespace
+
     // ----------- Methods of SaturationPropsFromDeck ---------
 
 
@@ -52,6 +223,23 @@ namespace Opm
         materialLawManager_ = materialLawManager;
     }
 
+    /// Set the saturation region of each cell.  Evaluations of
+    /// all cells are then done region by region, which keeps the
+    /// saturation tables of one region in cache at a time.
+    /// \param[in]  cell_region  Saturation region ('SATNUM' - 1)
+    ///                          of each cell.
+    void SaturationPropsFromDeck::setCellRegions(const std::vector<int>& cell_region)
+    {
+        regionOrder_ = RegionSortedOrder(cell_region);
+    }
+
+    /// Add the bytes of the region evaluation order to the report.
+    void SaturationPropsFromDeck::reportMemory(MemoryReport& report) const
+    {
+        report.child("saturation functions").add("region order",
+                                                 regionOrder_.allocatedBytes());
+    }
+
     /// \return   P, the number of phases.
     int SaturationPropsFromDeck::numPhases() const
     {
@@ -77,44 +265,51 @@ namespace Opm
                                           double* kr,
                                           double* dkrds) const
     {
+        OPM_TIMED_SCOPE("relperm");
         assert(cells != 0);
 
         const int np = numPhases();
-        if (dkrds) {
-            ExplicitArraysSatDerivativesFluidState fluidState(phaseUsage_);
-            fluidState.setSaturationArray(s);
+        const OutputLayout layout = { np, 1, np*np, 1, np };
+        const double sign[BlackoilPhases::MaxNumPhases] = { 1.0, 1.0, 1.0 };
+        evaluate(n, s, cells, regionOrder_.order(n, cells),
+                 RelpermLaw(), phaseUsage_, *materialLawManager_,
+                 sign, layout, kr, dkrds);
+    }
 
-            typedef ExplicitArraysSatDerivativesFluidState::Evaluation Evaluation;
-            Evaluation relativePerms[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::relativePermeabilities(relativePerms, params, fluidState);
 
-                // copy the values calculated using opm-material to the target arrays
-                for (int krPhaseIdx = 0; krPhaseIdx < np; ++krPhaseIdx) {
-                    kr[np*i + krPhaseIdx] = relativePerms[krPhaseIdx].value;
 
-                    for (int satPhaseIdx = 0; satPhaseIdx < np; ++satPhaseIdx)
-                        dkrds[np*np*i + satPhaseIdx*np + krPhaseIdx] = relativePerms[krPhaseIdx].derivatives[satPhaseIdx];
-                }
-            }
-        } else {
-            ExplicitArraysFluidState fluidState(phaseUsage_);
-            fluidState.setSaturationArray(s);
 
-            double relativePerms[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::relativePermeabilities(relativePerms, params, fluidState);
+    /// Relative permeability, structure-of-arrays output.
+    void SaturationPropsFromDeck::relpermSoA(const int n,
+                                             const double* s,
+                                             const int* cells,
+                                             double* kr,
+                                             double* dkrds) const
+    {
+        OPM_TIMED_SCOPE("relperm");
+        assert(cells != 0);
 
-                // copy the values calculated using opm-material to the target arrays
-                for (int krPhaseIdx = 0; krPhaseIdx < np; ++krPhaseIdx) {
-                    kr[np*i + krPhaseIdx] = relativePerms[krPhaseIdx];
-                }
-            }
-        }
+        const int np = numPhases();
+        const OutputLayout layout = { 1, n, 1, n, np*n };
+        const double sign[BlackoilPhases::MaxNumPhases] = { 1.0, 1.0, 1.0 };
+        evaluate(n, s, cells, regionOrder_.order(n, cells),
+                 RelpermLaw(), phaseUsage_, *materialLawManager_,
+                 sign, layout, kr, dkrds);
+    }
+
+
+
+
+    /// Relative permeability of the points of a batch.
+    void SaturationPropsFromDeck::relpermBatch(const FluidStateBatch& batch,
+                                               const int* cells,
+                                               double* kr,
+                                               double* dkrds) const
+    {
+        assert(cells != 0);
+
+        const double sign[BlackoilPhases::MaxNumPhases] = { 1.0, 1.0, 1.0 };
+        evaluate(batch, cells, RelpermLaw(), *materialLawManager_, sign, kr, dkrds);
     }
 
 
@@ -139,43 +334,41 @@ namespace Opm
         assert(cells != 0);
 
         const int np = numPhases();
-        if (dpcds) {
-            ExplicitArraysSatDerivativesFluidState fluidState(phaseUsage_);
-            typedef ExplicitArraysSatDerivativesFluidState::Evaluation Evaluation;
-            fluidState.setSaturationArray(s);
+        const OutputLayout layout = { np, 1, np*np, 1, np };
+        evaluate(n, s, cells, regionOrder_.order(n, cells),
+                 CapPressLaw(), phaseUsage_, *materialLawManager_,
+                 capPressSign, layout, pc, dpcds);
+    }
 
-            Evaluation capillaryPressures[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::capillaryPressures(capillaryPressures, params, fluidState);
 
-                // copy the values calculated using opm-material to the target arrays
-                for (int pcPhaseIdx = 0; pcPhaseIdx < np; ++pcPhaseIdx) {
-                    double sign = (pcPhaseIdx == BlackoilPhases::Aqua)? -1.0 : 1.0;
-                    pc[np*i + pcPhaseIdx] = sign*capillaryPressures[pcPhaseIdx].value;
 
-                    for (int satPhaseIdx = 0; satPhaseIdx < np; ++satPhaseIdx)
-                        dpcds[np*np*i + satPhaseIdx*np + pcPhaseIdx] = sign*capillaryPressures[pcPhaseIdx].derivatives[satPhaseIdx];
-                }
-            }
-        } else {
-            ExplicitArraysFluidState fluidState(phaseUsage_);
-            fluidState.setSaturationArray(s);
 
-            double capillaryPressures[BlackoilPhases::MaxNumPhases];
-            for (int i = 0; i < n; ++i) {         
-                fluidState.setIndex(i);
-                const auto& params = materialLawManager_->materialLawParams(cells[i]);
-                MaterialLaw::capillaryPressures(capillaryPressures, params, fluidState);
+    /// Capillary pressure, structure-of-arrays output.
+    void SaturationPropsFromDeck::capPressSoA(const int n,
+                                              const double* s,
+                                              const int* cells,
+                                              double* pc,
+                                              double* dpcds) const
+    {
+        assert(cells != 0);
 
-                // copy the values calculated using opm-material to the target arrays
-                for (int pcPhaseIdx = 0; pcPhaseIdx < np; ++pcPhaseIdx) {
-                    double sign = (pcPhaseIdx == BlackoilPhases::Aqua)? -1.0 : 1.0;
-                    pc[np*i + pcPhaseIdx] = sign*capillaryPressures[pcPhaseIdx];
-                }
-            }
-        }
+        const int np = numPhases();
+        const OutputLayout layout = { 1, n, 1, n, np*n };
+        evaluate(n, s, cells, regionOrder_.order(n, cells),
+                 CapPressLaw(), phaseUsage_, *materialLawManager_,
+                 capPressSign, layout, pc, dpcds);
+    }
+
+
+    /// Capillary pressure of the points of a batch.
+    void SaturationPropsFromDeck::capPressBatch(const FluidStateBatch& batch,
+                                                const int* cells,
+                                                double* pc,
+                                                double* dpcds) const
+    {
+        assert(cells != 0);
+
+        evaluate(batch, cells, CapPressLaw(), *materialLawManager_, capPressSign, pc, dpcds);
     }
 
 
@@ -24,6 +24,8 @@
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/props/BlackoilPhases.hpp>
 #include <opm/core/props/phaseUsageFromDeck.hpp>
+#include <opm/core/simulator/ExplicitArraysFluidStateBatch.hpp>
+#include <opm/core/utility/RegionSortedOrder.hpp>
 #include <opm/core/grid.h>
 
 #include <opm/parser/eclipse/Deck/Deck.hpp>
@@ -42,6 +44,8 @@ namespace Opm
     template <class Traits>
     class EclMaterialLawManager;
 
+    class MemoryReport;
+
 
     /// Interface to saturation functions from deck.
     class SaturationPropsFromDeck : public SaturationPropsInterface
@@ -53,6 +57,9 @@ namespace Opm
                                               /*gasPhaseIdx=*/BlackoilPhases::Vapour> MaterialTraits;
         typedef Opm::EclMaterialLawManager<MaterialTraits> MaterialLawManager;
 
+        /// Batch of saturations for relpermBatch() and capPressBatch().
+        typedef ExplicitArraysFluidStateBatch<> FluidStateBatch;
+
         /// Default constructor.
         SaturationPropsFromDeck();
 
@@ -72,6 +79,13 @@ namespace Opm
             init(Opm::phaseUsageFromDeck(deck), materialLawManager);
         }
 
+        /// Set the saturation region of each cell.  Evaluations of
+        /// all cells are then done region by region, which keeps the
+        /// saturation tables of one region in cache at a time.
+        /// \param[in]  cell_region  Saturation region ('SATNUM' - 1)
+        ///                          of each cell.
+        void setCellRegions(const std::vector<int>& cell_region);
+
         /// \return   P, the number of phases.
         int numPhases() const;
 
@@ -90,6 +104,31 @@ namespace Opm
                      double* kr,
                      double* dkrds) const;
 
+        /// Relative permeability, with output in structure-of-arrays layout.
+        /// \param[in]  n      Number of data points.
+        /// \param[in]  s      Array of nP saturation values, as for relperm().
+        /// \param[out] kr     Array of nP relperm values, kr_p of point i at kr[p*n + i].
+        /// \param[out] dkrds  If non-null: array of nP^2 relperm derivative values,
+        ///                    dkr_p/ds_j of point i at dkrds[(j*P + p)*n + i].
+        void relpermSoA(const int n,
+                        const double* s,
+                        const int* cells,
+                        double* kr,
+                        double* dkrds) const;
+
+        /// Relative permeability of the points gathered in a batch.
+        /// \param[in]  batch  Saturations of batch.size() points.
+        /// \param[in]  cells  Array of cell indices, the cell of lane l is
+        ///                    cells[batch.index(l)].
+        /// \param[out] kr     Array of P*B relperm values, B = FluidStateBatch::batchSize,
+        ///                    kr_p of lane l at kr[p*B + l].
+        /// \param[out] dkrds  If non-null: array of P^2*B relperm derivative values,
+        ///                    dkr_p/ds_j of lane l at dkrds[(j*P + p)*B + l].
+        void relpermBatch(const FluidStateBatch& batch,
+                          const int* cells,
+                          double* kr,
+                          double* dkrds) const;
+
         /// Capillary pressure.
         /// \param[in]  n      Number of data points.
         /// \param[in]  s      Array of nP saturation values.
@@ -105,6 +144,29 @@ namespace Opm
                       double* pc,
                       double* dpcds) const;
 
+        /// Capillary pressure, with output in structure-of-arrays layout.
+        /// \param[in]  n      Number of data points.
+        /// \param[in]  s      Array of nP saturation values, as for capPress().
+        /// \param[out] pc     Array of nP capillary pressure values, pc_p of point i at pc[p*n + i].
+        /// \param[out] dpcds  If non-null: array of nP^2 derivative values,
+        ///                    dpc_p/ds_j of point i at dpcds[(j*P + p)*n + i].
+        void capPressSoA(const int n,
+                         const double* s,
+                         const int* cells,
+                         double* pc,
+                         double* dpcds) const;
+
+        /// Capillary pressure of the points gathered in a batch.
+        /// \param[in]  batch  Saturations of batch.size() points.
+        /// \param[in]  cells  Array of cell indices, as for relpermBatch().
+        /// \param[out] pc     Array of P*B capillary pressure values, as kr in relpermBatch().
+        /// \param[out] dpcds  If non-null: array of P^2*B derivative values,
+        ///                    as dkrds in relpermBatch().
+        void capPressBatch(const FluidStateBatch& batch,
+                           const int* cells,
+                           double* pc,
+                           double* dpcds) const;
+
         /// Obtain the range of allowable saturation values.
         /// \param[in]  n      Number of data points.
         /// \param[out] smin   Array of nP minimum s values, array must be valid before calling.
@@ -129,6 +191,12 @@ namespace Opm
                              const double pcow, 
                              double & swat);
 
+        /// Add the bytes of the region evaluation order to the child
+        /// "saturation functions" of the report.  The tables and cell
+        /// parameters held by the MaterialLawManager are not included,
+        /// since it does not report their size.
+        void reportMemory(MemoryReport& report) const;
+
         /// Returns a reference to the MaterialLawManager
         const MaterialLawManager& materialLawManager() const { return *materialLawManager_; }
 
@@ -136,6 +204,7 @@ namespace Opm
     private:
         std::shared_ptr<MaterialLawManager> materialLawManager_;
         PhaseUsage phaseUsage_;
+        RegionSortedOrder regionOrder_;
     };
 
 
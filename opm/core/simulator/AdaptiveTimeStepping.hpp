@@ -22,7 +22,9 @@
 #define OPM_SUBSTEPPING_HEADER_INCLUDED
 
 #include <iostream>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/common/ErrorMacros.hpp>
@@ -31,6 +33,8 @@
 
 namespace Opm {
 
+    class NewtonRateTimeStepControl;
+
 
     // AdaptiveTimeStepping
     //---------------------
@@ -50,6 +54,7 @@ namespace Opm {
 
             \param  timer       simulator timer providing time and timestep
             \param  solver      solver object that must implement a method step( dt, state, well_state )
+                                and may implement setIterationMonitor( NewtonIterationMonitorInterface* )
             \param  state       current state of the solution variables
             \param  well_state  additional well state object
         */
@@ -71,12 +76,49 @@ namespace Opm {
                    Solver& solver, State& state, WellState& well_state,
                    OutputWriter& outputWriter );
 
+        /** \brief  the time step control if "newtonrate" is selected, else null.
+                    The solver should report its residual norms to it, see
+                    NewtonRateTimeStepControl::addResidual(). Solvers with a
+                    method setIterationMonitor( NewtonIterationMonitorInterface* )
+                    are given it by step(), and it stays attached afterwards.
+        */
+        NewtonRateTimeStepControl* newtonRateControl();
+
+        /** \brief  the suggested next time step size followed by the state of
+                    the time step control, to be stored in a checkpoint, see
+                    CheckpointWriter::setControllerState()
+        */
+        std::vector< double > checkpointState() const;
+
+        /** \brief  continue with the time step size and control state of a
+                    checkpoint written with the same time step control
+            \param  state  values returned by checkpointState()
+        */
+        void restoreCheckpointState( const std::vector< double >& state );
+
     protected:
         template <class Solver, class State, class WellState>
         void stepImpl( const SimulatorTimer& timer,
                        Solver& solver, State& state, WellState& well_state,
                        OutputWriter* outputWriter);
 
+        // Type-erased state, kept between report steps so that the
+        // copy saved for solver restarts reuses its storage.
+        struct SavedStateBase
+        {
+            virtual ~SavedStateBase() {}
+        };
+
+        template <class T>
+        struct SavedState : public SavedStateBase
+        {
+            explicit SavedState( const T& s ) : state( s ) {}
+            T state;
+        };
+
+        template <class T>
+        static T& saveState( std::unique_ptr< SavedStateBase >& saved, const T& state );
+
         typedef std::unique_ptr< TimeStepControlInterface > TimeStepControlType;
 
         TimeStepControlType timeStepControl_; //!< time step control object
@@ -89,6 +131,8 @@ namespace Opm {
         const bool timestep_verbose_;         //!< timestep verbosity
         double suggested_next_timestep_;      //!< suggested size of next timestep
         bool full_timestep_initially_;        //!< beginning with the size of the time step from data file
+        std::unique_ptr< SavedStateBase > last_state_;      //!< state at the last converged substep
+        std::unique_ptr< SavedStateBase > last_well_state_; //!< well state at the last converged substep
     };
 }
 
@@ -54,6 +54,19 @@ namespace Opm {
                 return solver_.model().relativeChange( previous_, current_ );
             }
         };
+
+        // Give the monitor to solvers with a setIterationMonitor() method.
+        template <class Solver>
+        auto attachIterationMonitor( Solver& solver, NewtonIterationMonitorInterface* monitor, int )
+            -> decltype( solver.setIterationMonitor( monitor ), void() )
+        {
+            solver.setIterationMonitor( monitor );
+        }
+
+        template <class Solver>
+        void attachIterationMonitor( Solver&, NewtonIterationMonitorInterface*, long )
+        {
+        }
     }
 
     // AdaptiveTimeStepping
@@ -73,7 +86,7 @@ namespace Opm {
         , suggested_next_timestep_( -1.0 )
         , full_timestep_initially_( param.getDefault("full_timestep_initially", bool(false) ) )
     {
-        // valid are "pid" and "pid+iteration"
+        // valid are "pid", "pid+iteration", "iterationcount" and "newtonrate"
         std::string control = param.getDefault("timestep.control", std::string("pid") );
         // iterations is the accumulation of all linear iterations over all newton steops per time step
         const int defaultTargetIterations = 30;
@@ -94,6 +107,17 @@ namespace Opm {
             const double growthrate = param.getDefault("timestep.control.growthrate", double(1.25) );
             timeStepControl_ = TimeStepControlType( new SimpleIterationCountTimeStepControl( iterations, decayrate, growthrate ) );
         }
+        else if ( control == "newtonrate" )
+        {
+            // counts Newton iterations, not linear iterations
+            const int iterations    = param.getDefault("timestep.control.targetnewtoniteration", int(8) );
+            const int maxiterations = param.getDefault("timestep.control.maxnewtoniteration", int(20) );
+            const double restol     = param.getDefault("timestep.control.residualtol", double(1e-6) );
+            const double decayrate  = param.getDefault("timestep.control.decayrate",  double(0.25) );
+            const double growthrate = param.getDefault("timestep.control.growthrate", double(2.0) );
+            timeStepControl_ = TimeStepControlType( new NewtonRateTimeStepControl( iterations, maxiterations, restol,
+                                                                                   decayrate, growthrate, timestep_verbose_ ) );
+        }
         else
             OPM_THROW(std::runtime_error,"Unsupported time step control selected "<< control );
 
@@ -102,6 +126,30 @@ namespace Opm {
     }
 
 
+    inline NewtonRateTimeStepControl* AdaptiveTimeStepping::newtonRateControl()
+    {
+        return dynamic_cast< NewtonRateTimeStepControl* >( timeStepControl_.get() );
+    }
+
+
+    inline std::vector< double > AdaptiveTimeStepping::checkpointState() const
+    {
+        std::vector< double > state( 1, suggested_next_timestep_ );
+        const std::vector< double > control = timeStepControl_->state();
+        state.insert( state.end(), control.begin(), control.end() );
+        return state;
+    }
+
+
+    inline void AdaptiveTimeStepping::restoreCheckpointState( const std::vector< double >& state )
+    {
+        if( state.empty() )
+            OPM_THROW(std::runtime_error,"AdaptiveTimeStepping: empty checkpoint state");
+        suggested_next_timestep_ = state[ 0 ];
+        timeStepControl_->setState( std::vector< double >( state.begin() + 1, state.end() ) );
+    }
+
+
     template <class Solver, class State, class WellState>
     void AdaptiveTimeStepping::
     step( const SimulatorTimer& simulatorTimer, Solver& solver, State& state, WellState& well_state )
@@ -117,6 +165,23 @@ namespace Opm {
         stepImpl( simulatorTimer, solver, state, well_state, &outputWriter );
     }
 
+    // copy a state into the saved state of the same type, or replace
+    // the saved state if it has a different type
+    template <class T>
+    T& AdaptiveTimeStepping::
+    saveState( std::unique_ptr< SavedStateBase >& saved, const T& state )
+    {
+        SavedState< T >* s = dynamic_cast< SavedState< T >* >( saved.get() );
+        if( s ) {
+            s->state = state;
+        }
+        else {
+            s = new SavedState< T >( state );
+            saved.reset( s );
+        }
+        return s->state;
+    }
+
     // implementation of the step method
     template <class Solver, class State, class WState>
     void AdaptiveTimeStepping::
@@ -141,13 +206,23 @@ namespace Opm {
         // create adaptive step timer with previously used sub step size
         AdaptiveSimulatorTimer substepTimer( simulatorTimer, suggested_next_timestep_, max_time_step_ );
 
-        // copy states in case solver has to be restarted (to be revised)
-        State  last_state( state );
-        WState last_well_state( well_state );
+        // copy states in case solver has to be restarted. The copies
+        // are kept between report steps, and all updates are copy
+        // assignments, which reuse their storage instead of allocating
+        // new states.
+        State&  last_state      = saveState( last_state_, state );
+        WState& last_well_state = saveState( last_well_state_, well_state );
 
         // counter for solver restarts
         int restarts = 0;
 
+        // let the solver report its residuals, so that it can
+        // give up a substep that does not converge early
+        NewtonRateTimeStepControl* newtonRate = newtonRateControl();
+        if( newtonRate ) {
+            detail::attachIterationMonitor( solver, newtonRate, 0 );
+        }
+
         // sub step time loop
         while( ! substepTimer.done() )
         {
@@ -160,6 +235,10 @@ namespace Opm {
                           << unit::convert::to(substepTimer.currentStepLength(), unit::day) << " (days)." << std::endl;
             }
 
+            if( newtonRate ) {
+                newtonRate->beginStep();
+            }
+
             int linearIterations = -1;
             try {
                 // (linearIterations < 0 means on convergence in solver)
@@ -226,9 +305,11 @@ namespace Opm {
                 // set new time step length
                 substepTimer.provideTimeStepEstimate( dtEstimate );
 
-                // update states
-                last_state      = state ;
-                last_well_state = well_state;
+                // update states, unless this was the last substep
+                if( ! substepTimer.done() ) {
+                    last_state      = state ;
+                    last_well_state = well_state;
+                }
 
             }
             else // in case of no convergence (linearIterations < 0)
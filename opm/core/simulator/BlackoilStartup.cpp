@@ -0,0 +1,156 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/simulator/BlackoilStartup.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
+#include <opm/core/props/rock/RockCompressibility.hpp>
+#include <opm/core/simulator/BlackoilState.hpp>
+#include <opm/core/simulator/initState.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/TimingTree.hpp>
+#include <opm/core/utility/Units.hpp>
+#include <opm/core/wells/WellsManager.hpp>
+
+namespace Opm
+{
+
+    BlackoilStartup::BlackoilStartup(DeckConstPtr deck,
+                                     EclipseStateConstPtr eclipseState,
+                                     const parameter::ParameterGroup& param,
+                                     WellIndexCache* well_index_cache)
+        : gravity_(deck->hasKeyword("NOGRAV") ? 0.0 : unit::gravity)
+    {
+        // Read on this thread, before any worker uses param.
+        const bool init_saturation = param.has("init_saturation");
+        const parameter::ParameterGroup* prm = &param;
+        const double gravity = gravity_;
+
+        grid_ = std::async(std::launch::async, [deck]() {
+                OPM_TIMED_SCOPE("startup grid");
+                return std::make_shared<GridManager>(deck);
+            }).share();
+
+        rock_comp_ = std::async(std::launch::async, [deck, eclipseState]() {
+                OPM_TIMED_SCOPE("startup rock compressibility");
+                return std::make_shared<RockCompressibility>(deck, eclipseState);
+            }).share();
+
+        const std::shared_future<std::shared_ptr<GridManager> > grid = grid_;
+        props_ = std::async(std::launch::async, [deck, eclipseState, grid, prm]() {
+                const std::shared_ptr<GridManager> g = grid.get();
+                OPM_TIMED_SCOPE("startup properties");
+                return std::make_shared<BlackoilPropertiesFromDeck>(deck, eclipseState,
+                                                                    *g->c_grid(), *prm);
+            }).share();
+
+        const std::shared_future<std::shared_ptr<BlackoilPropertiesFromDeck> > props = props_;
+        wells_ = std::async(std::launch::async,
+                            [eclipseState, grid, props, well_index_cache]() {
+                const std::shared_ptr<GridManager> g = grid.get();
+                const std::shared_ptr<BlackoilPropertiesFromDeck> p = props.get();
+                OPM_TIMED_SCOPE("startup wells");
+                return std::make_shared<WellsManager>(eclipseState, 0, *g->c_grid(),
+                                                      p->permeability(), well_index_cache);
+            }).share();
+
+        state_ = std::async(std::launch::async,
+                            [deck, grid, props, prm, init_saturation, gravity]() {
+                const std::shared_ptr<GridManager> g = grid.get();
+                const std::shared_ptr<BlackoilPropertiesFromDeck> p = props.get();
+                OPM_TIMED_SCOPE("startup initial state");
+                const UnstructuredGrid& ug = *g->c_grid();
+                std::shared_ptr<BlackoilState> state =
+                    std::make_shared<BlackoilState>(ug.number_of_cells, ug.number_of_faces, 2);
+                if (init_saturation) {
+                    initStateBasic(ug, *p, *prm, gravity, *state);
+                } else {
+                    initStateFromDeck(ug, *p, deck, gravity, *state);
+                }
+                initBlackoilSurfvol(ug, *p, *state);
+                return state;
+            }).share();
+    }
+
+
+
+
+    BlackoilStartup::~BlackoilStartup()
+    {
+        // The last future of each std::async task waits for it as
+        // well, but make the order explicit: dependents first.
+        state_.wait();
+        wells_.wait();
+        props_.wait();
+        rock_comp_.wait();
+        grid_.wait();
+    }
+
+
+
+
+    double BlackoilStartup::gravity() const
+    {
+        return gravity_;
+    }
+
+
+
+
+    std::shared_ptr<GridManager> BlackoilStartup::grid() const
+    {
+        return grid_.get();
+    }
+
+
+
+
+    std::shared_ptr<RockCompressibility> BlackoilStartup::rockCompressibility() const
+    {
+        return rock_comp_.get();
+    }
+
+
+
+
+    std::shared_ptr<BlackoilPropertiesFromDeck> BlackoilStartup::props() const
+    {
+        return props_.get();
+    }
+
+
+
+
+    std::shared_ptr<WellsManager> BlackoilStartup::wells() const
+    {
+        return wells_.get();
+    }
+
+
+
+
+    std::shared_ptr<BlackoilState> BlackoilStartup::state() const
+    {
+        return state_.get();
+    }
+
+} // namespace Opm
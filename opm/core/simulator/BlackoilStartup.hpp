@@ -0,0 +1,107 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef OPM_BLACKOILSTARTUP_HEADER_INCLUDED
+#define OPM_BLACKOILSTARTUP_HEADER_INCLUDED
+
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+#include <future>
+#include <memory>
+
+namespace Opm
+{
+
+    namespace parameter { class ParameterGroup; }
+    class GridManager;
+    class BlackoilPropertiesFromDeck;
+    class RockCompressibility;
+    class WellsManager;
+    class WellIndexCache;
+    class BlackoilState;
+
+    /// Builds the components a black-oil simulation from a deck needs
+    /// before its first step, running those that do not depend on each
+    /// other concurrently:
+    ///
+    ///     grid                    at once
+    ///     rock compressibility    at once
+    ///     properties              once the grid is built
+    ///     wells (report step 0)   once the properties are built
+    ///     initial state           once the properties are built
+    ///
+    /// The wells wait for the properties only for the permeability.
+    /// Each accessor waits for its component and rethrows an exception
+    /// thrown while building it (or a component it depends on).
+    class BlackoilStartup
+    {
+    public:
+        /// Start building.
+        /// \param[in] deck              input deck
+        /// \param[in] eclipseState      state built from the deck
+        /// \param[in] param             parameters, this class accepts the following:
+        ///     parameter (default)      effect
+        ///     -----------------------------------------------------------
+        ///     init_saturation          if given, the initial state is set by
+        ///                              initStateBasic(), otherwise from the deck
+        ///                              The properties and initStateBasic() read
+        ///                              further parameters on the worker threads,
+        ///                              so param must not be used elsewhere until
+        ///                              props() and state() have returned.
+        /// \param[in] well_index_cache  passed to WellsManager, may be null. Must
+        ///                              not be used elsewhere until wells() has
+        ///                              returned.
+        BlackoilStartup(DeckConstPtr deck,
+                        EclipseStateConstPtr eclipseState,
+                        const parameter::ParameterGroup& param,
+                        WellIndexCache* well_index_cache = 0);
+
+        /// Waits for all components, discarding any exceptions.
+        ~BlackoilStartup();
+
+        /// Gravity in the z direction, zero if the deck has NOGRAV.
+        double gravity() const;
+
+        std::shared_ptr<GridManager> grid() const;
+        std::shared_ptr<RockCompressibility> rockCompressibility() const;
+        std::shared_ptr<BlackoilPropertiesFromDeck> props() const;
+        /// The wells of report step 0.
+        std::shared_ptr<WellsManager> wells() const;
+        /// State with two phases, pressure, saturation and surface
+        /// volumes initialised.
+        std::shared_ptr<BlackoilState> state() const;
+
+    private:
+        BlackoilStartup(const BlackoilStartup&);
+        BlackoilStartup& operator=(const BlackoilStartup&);
+
+        double gravity_;
+        std::shared_future<std::shared_ptr<GridManager> > grid_;
+        std::shared_future<std::shared_ptr<RockCompressibility> > rock_comp_;
+        std::shared_future<std::shared_ptr<BlackoilPropertiesFromDeck> > props_;
+        std::shared_future<std::shared_ptr<WellsManager> > wells_;
+        std::shared_future<std::shared_ptr<BlackoilState> > state_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_BLACKOILSTARTUP_HEADER_INCLUDED
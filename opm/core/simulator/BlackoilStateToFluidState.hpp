@@ -20,8 +20,13 @@
 #ifndef OPM_BLACKOIL_STATE_TO_FLUID_STATE_HEADER_INCLUDED
 #define OPM_BLACKOIL_STATE_TO_FLUID_STATE_HEADER_INCLUDED
 
+#include <opm/common/ErrorMacros.hpp>
+
+#include <opm/core/props/BlackoilPhases.hpp>
 #include <opm/core/simulator/BlackoilState.hpp>
 
+#include <stdexcept>
+
 namespace Opm
 {
 
@@ -32,8 +37,15 @@ namespace Opm
  * It uses a stripped down version of opm-material's FluidState API and takes an
  * Opm::BlackoilState plus a cell index.
  *
+ * The data arrays of the state and the position of each phase within a saturation
+ * row are looked up once on construction, so the accessors only index into the
+ * state's own storage: nothing is copied, and the arrays themselves (see
+ * saturationArray() and friends) can be handed to batched property kernels such
+ * as Opm::ExplicitArraysFluidStateBatch.
+ *
  * Note that this class requires that is underlying BlackoilState must valid for at least
- * as long as an object of BlackoilStateToFluidState is used.
+ * as long as an object of BlackoilStateToFluidState is used, and that the state's
+ * vectors are not resized in the meantime.
  */
 class BlackoilStateToFluidState
 {
@@ -46,6 +58,8 @@ public:
     /*!
      * \brief Create a BlackoilState to Fluid state wrapper object.
      *
+     * The state must hold all three phases, in canonical phase order.
+     *
      * Note that this class requires that is underlying BlackoilState must valid for at least
      * as long as an object of BlackoilStateToFluidState is used.
      */
@@ -56,6 +70,32 @@ public:
             OPM_THROW(std::runtime_error,
                       "Only " << numPhases << " are supported, but the deck specifies " << blackoilState_.numPhases());
         }
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            phaseOffset_[phaseIdx] = phaseIdx;
+        }
+        prepare();
+    }
+
+    /*!
+     * \brief Create a wrapper for a state whose saturations are ordered according to
+     *        'phaseUsage'.
+     *
+     * The saturation of a phase not in use is zero.
+     */
+    BlackoilStateToFluidState(const BlackoilState& blackoilState,
+                              const PhaseUsage& phaseUsage)
+        : blackoilState_(blackoilState)
+    {
+        if (int(blackoilState_.numPhases()) != phaseUsage.num_phases) {
+            OPM_THROW(std::runtime_error,
+                      "The state has " << blackoilState_.numPhases()
+                      << " phases, but the phase usage specifies " << phaseUsage.num_phases);
+        }
+        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            phaseOffset_[phaseIdx] = phaseUsage.phase_used[phaseIdx]
+                ? phaseUsage.phase_pos[phaseIdx] : -1;
+        }
+        prepare();
     }
 
     /*!
@@ -65,30 +105,97 @@ public:
      * cell.
      */
     void setCurrentCellIndex(unsigned cellIdx)
-    { cellIdx_ = cellIdx; }
+    {
+        cellIdx_ = cellIdx;
+        saturationRow_ = saturation_ + saturationStride_*cellIdx;
+    }
 
     /*!
      * \brief Returns the saturation of a phase for the current cell index.
      */
     Scalar saturation(int phaseIdx) const
-    { return blackoilState_.saturation()[numPhases*cellIdx_ + phaseIdx]; }
+    {
+        const int offset = phaseOffset_[phaseIdx];
+        return (offset < 0) ? 0.0 : saturationRow_[offset];
+    }
+
+    /*!
+     * \brief Returns the pressure [Pa] of a phase for the current cell index.
+     *
+     * BlackoilState stores a single pressure per cell, which is returned for all
+     * phases.
+     */
+    Scalar pressure(int /* phaseIdx */) const
+    { return pressure_[cellIdx_]; }
 
     /*!
      * \brief Returns the temperature [K] of a phase for the current cell index.
      */
-    Scalar temperature(int phaseIdx) const
-    { return blackoilState_.temperature()[cellIdx_]; }
+    Scalar temperature(int /* phaseIdx */) const
+    { return temperature_[cellIdx_]; }
 
-    // TODO (?) pressure, composition, etc
+    // TODO (?) composition, etc
 
-private:
+    /*!
+     * \brief Returns the number of cells of the underlying state.
+     */
     size_t numCells() const
-    { return blackoilState_.pressure().size(); }
+    { return numCells_; }
+
+    /*!
+     * \brief Returns the saturations of all cells.  Saturation of the phase at position
+     *        p of cell c is at saturationArray()[c*saturationStride() + p].
+     */
+    const double* saturationArray() const
+    { return saturation_; }
+
+    /*!
+     * \brief Returns the distance between the saturation rows of consecutive cells.
+     */
+    int saturationStride() const
+    { return saturationStride_; }
+
+    /*!
+     * \brief Returns the position of a phase within a saturation row, or -1 if the phase
+     *        is not in use.
+     */
+    int phaseOffset(int phaseIdx) const
+    { return phaseOffset_[phaseIdx]; }
+
+    /*!
+     * \brief Returns the pressures of all cells.
+     */
+    const double* pressureArray() const
+    { return pressure_; }
+
+    /*!
+     * \brief Returns the temperatures of all cells.
+     */
+    const double* temperatureArray() const
+    { return temperature_; }
+
+private:
+    void prepare()
+    {
+        numCells_         = blackoilState_.pressure().size();
+        saturationStride_ = blackoilState_.numPhases();
+        saturation_       = blackoilState_.saturation().data();
+        pressure_         = blackoilState_.pressure().data();
+        temperature_      = blackoilState_.temperature().data();
+        setCurrentCellIndex(0);
+    }
 
     const BlackoilState& blackoilState_;
+    size_t numCells_;
+    int saturationStride_;
+    int phaseOffset_[numPhases];
+    const double* saturation_;
+    const double* pressure_;
+    const double* temperature_;
+    const double* saturationRow_;
     unsigned cellIdx_;
-}
+};
 
 } // namespace Opm
 
-#endif // OPM_SIMULATORTIMER_HEADER_INCLUDED
+#endif // OPM_BLACKOIL_STATE_TO_FLUID_STATE_HEADER_INCLUDED
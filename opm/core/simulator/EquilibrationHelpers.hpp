@@ -28,7 +28,12 @@
 
 #include <opm/parser/eclipse/EclipseState/InitConfig/Equil.hpp>
 
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
 #include <memory>
+#include <vector>
 
 
 /*
@@ -68,6 +73,8 @@ namespace Opm
                                       const int phase2,
                                       const int cell,
                                       const double target_pc);
+
+        class SatFromPcBatch;
     } // namespace Equil
 } // namespace Opm
 
@@ -702,7 +709,7 @@ namespace Opm
             const BlackoilPropertiesInterface& props_;
             const int phase_;
             const int cell_;
-            const int target_pc_;
+            const double target_pc_;
             mutable double s_[BlackoilPhases::MaxNumPhases];
             mutable double pc_[BlackoilPhases::MaxNumPhases];
         };
@@ -775,7 +782,7 @@ namespace Opm
             const int phase1_;
             const int phase2_;
             const int cell_;
-            const int target_pc_;
+            const double target_pc_;
             mutable double s_[BlackoilPhases::MaxNumPhases];
             mutable double pc_[BlackoilPhases::MaxNumPhases];
         };
@@ -857,6 +864,307 @@ namespace Opm
             return std::abs(f0 - f1) < std::numeric_limits<double>::epsilon();
         }
 
+        /// Inverse of the capillary pressure function of a phase for a
+        /// set of cells, computing the same saturations as satFromPc()
+        /// for all cells at once.
+        ///
+        /// Saturation ranges and capillary pressures are evaluated for
+        /// all cells in single calls to the property object. Cells
+        /// whose saturation ranges, and capillary pressures at the
+        /// ends and midpoint of the ranges, are all equal are assumed
+        /// to share a capillary pressure function, typically that of
+        /// a saturation region. For each such group of cells, the
+        /// inverse is tabulated once, and a root is bracketed by a
+        /// search in the table. Cells whose end-point scaling makes
+        /// their function unique, and cells where the bracket from the
+        /// table turns out not to hold, use the whole saturation range.
+        /// The roots are then found by the regula falsi iteration of
+        /// RegulaFalsi<ThrowOnError>, with the iterations of all cells
+        /// batched.
+        class SatFromPcBatch
+        {
+        public:
+            /// \param[in] props       Property object.
+            /// \param[in] phase       Phase position of the saturation.
+            /// \param[in] cells       Cells, referred to by their index below.
+            /// \param[in] increasing  As for satFromPc().
+            /// \param[in] table_size  Number of saturations of each table.
+            SatFromPcBatch(const BlackoilPropertiesInterface& props,
+                           const int phase,
+                           const std::vector<int>& cells,
+                           const bool increasing = false,
+                           const int table_size = 64)
+                : props_(props),
+                  phase_(phase),
+                  np_(props.numPhases()),
+                  cells_(cells),
+                  increasing_(increasing)
+            {
+                const int n = cells_.size();
+                smin_.resize(n);
+                smax_.resize(n);
+                {
+                    std::vector<double> sminarr(n*np_), smaxarr(n*np_);
+                    props_.satRange(n, cells_.data(), sminarr.data(), smaxarr.data());
+                    for (int i = 0; i < n; ++i) {
+                        smin_[i] = sminarr[i*np_ + phase_];
+                        smax_[i] = smaxarr[i*np_ + phase_];
+                    }
+                }
+                std::vector<double> smid(n);
+                for (int i = 0; i < n; ++i) {
+                    smid[i] = 0.5*(smin_[i] + smax_[i]);
+                }
+                capPress(cells_, smin_, pcmin_);
+                capPress(cells_, smax_, pcmax_);
+                std::vector<double> pcmid;
+                capPress(cells_, smid, pcmid);
+
+                // Group the cells by their function, and tabulate the
+                // functions shared by several cells.
+                typedef std::array<double, 5> Key;
+                std::map<Key, int> groups;
+                std::vector<int> first(n);
+                std::vector<int> count;
+                group_.assign(n, -1);
+                for (int i = 0; i < n; ++i) {
+                    if (isConstPc(i)) {
+                        continue;
+                    }
+                    const Key key = {{ smin_[i], smax_[i], pcmin_[i], pcmax_[i], pcmid[i] }};
+                    const auto g = groups.insert(std::make_pair(key, int(count.size())));
+                    if (g.second) {
+                        first[count.size()] = i;
+                        count.push_back(0);
+                    }
+                    group_[i] = g.first->second;
+                    ++count[group_[i]];
+                }
+                std::vector<int> table(count.size(), -1);
+                std::vector<int> table_cells;
+                std::vector<double> table_sat;
+                for (int g = 0; g < int(count.size()); ++g) {
+                    if (count[g] < 2) {
+                        continue;
+                    }
+                    const int i = first[g];
+                    table[g] = table_sat.size() / table_size;
+                    for (int k = 0; k < table_size; ++k) {
+                        table_cells.push_back(cells_[i]);
+                        table_sat.push_back(smin_[i] + (smax_[i] - smin_[i])*k/(table_size - 1));
+                    }
+                }
+                capPress(table_cells, table_sat, table_pc_);
+                table_sat_.swap(table_sat);
+                table_size_ = table_size;
+                for (int i = 0; i < n; ++i) {
+                    if (group_[i] >= 0) {
+                        group_[i] = table[group_[i]];
+                    }
+                }
+            }
+
+            /// Return true if the capillary pressure function of a cell
+            /// is constant, as isConstPc().
+            bool isConstPc(const int i) const
+            {
+                return std::abs(pcmin_[i] - pcmax_[i]) < std::numeric_limits<double>::epsilon();
+            }
+
+            /// Compute the saturation of the phase at a given capillary
+            /// pressure for each cell marked active.
+            /// \param[in]     target_pc  Capillary pressure of each cell.
+            /// \param[in]     active     Nonzero for the cells to compute.
+            /// \param[in,out] sat        Saturation of each cell; only
+            ///                           those of active cells are set.
+            void solve(const std::vector<double>& target_pc,
+                       const std::vector<char>& active,
+                       std::vector<double>& sat) const
+            {
+                const int max_iter = 30;
+                const double tol = 1e-6;
+                const double macheps = std::numeric_limits<double>::epsilon();
+
+                // State of the iteration of each unresolved cell, as in
+                // RegulaFalsi::solve().
+                std::vector<int> idx;
+                std::vector<double> x0, x1, f0, f1, eps, epsF;
+                for (int i = 0; i < int(cells_.size()); ++i) {
+                    if (!active[i]) {
+                        continue;
+                    }
+                    const double t = target_pc[i];
+                    const double fs0 = (increasing_ ? pcmax_[i] : pcmin_[i]) - t;
+                    const double fs1 = (increasing_ ? pcmin_[i] : pcmax_[i]) - t;
+                    if (fs0 <= 0.0) {
+                        sat[i] = increasing_ ? smax_[i] : smin_[i];
+                        continue;
+                    } else if (fs1 > 0.0) {
+                        sat[i] = increasing_ ? smin_[i] : smax_[i];
+                        continue;
+                    }
+                    const double fa = pcmin_[i] - t;
+                    const double fb = pcmax_[i] - t;
+                    const double e = tol + macheps*std::max(std::max(std::fabs(smin_[i]), std::fabs(smax_[i])), 1.0);
+                    const double eF = tol + macheps*std::max(std::fabs(fa), 1.0);
+                    if (std::fabs(fa) < eF) {
+                        sat[i] = smin_[i];
+                        continue;
+                    }
+                    if (std::fabs(fb) < eF) {
+                        sat[i] = smax_[i];
+                        continue;
+                    }
+                    idx.push_back(i);
+                    x0.push_back(smin_[i]);
+                    x1.push_back(smax_[i]);
+                    f0.push_back(fa);
+                    f1.push_back(fb);
+                    eps.push_back(e);
+                    epsF.push_back(eF);
+                }
+
+                // Narrow the brackets of the cells with a table, and
+                // check them with the function of each cell.
+                std::vector<int> narrowed;
+                std::vector<int> bracket_cells;
+                std::vector<double> bracket_sat;
+                for (int j = 0; j < int(idx.size()); ++j) {
+                    const int g = group_[idx[j]];
+                    if (g < 0) {
+                        continue;
+                    }
+                    const double* s = &table_sat_[g*table_size_];
+                    const double* pc = &table_pc_[g*table_size_];
+                    const double t = target_pc[idx[j]];
+                    const bool positive_lo = pc[0] - t > 0.0;
+                    int lo = 0;
+                    int hi = table_size_ - 1;
+                    if ((pc[hi] - t > 0.0) == positive_lo) {
+                        continue;
+                    }
+                    while (hi - lo > 1) {
+                        const int mid = (lo + hi) / 2;
+                        if ((pc[mid] - t > 0.0) == positive_lo) {
+                            lo = mid;
+                        } else {
+                            hi = mid;
+                        }
+                    }
+                    narrowed.push_back(j);
+                    bracket_cells.push_back(cells_[idx[j]]);
+                    bracket_cells.push_back(cells_[idx[j]]);
+                    bracket_sat.push_back(s[lo]);
+                    bracket_sat.push_back(s[hi]);
+                }
+                std::vector<double> bracket_pc;
+                capPress(bracket_cells, bracket_sat, bracket_pc);
+                for (int m = 0; m < int(narrowed.size()); ++m) {
+                    const int j = narrowed[m];
+                    const double t = target_pc[idx[j]];
+                    const double fa = bracket_pc[2*m] - t;
+                    const double fb = bracket_pc[2*m + 1] - t;
+                    if (fa*fb < 0.0) {
+                        x0[j] = bracket_sat[2*m];
+                        x1[j] = bracket_sat[2*m + 1];
+                        f0[j] = fa;
+                        f1[j] = fb;
+                    }
+                }
+
+                // Batched regula falsi ('Pegasus' variant).
+                int iterations_used = 0;
+                std::vector<int> cells;
+                std::vector<double> xnew, fnew;
+                while (!idx.empty()) {
+                    cells.clear();
+                    xnew.clear();
+                    int kept = 0;
+                    for (int j = 0; j < int(idx.size()); ++j) {
+                        if (std::fabs(x1[j] - x0[j]) < 1e-9*eps[j]) {
+                            sat[idx[j]] = 0.5*(x0[j] + x1[j]);
+                            continue;
+                        }
+                        idx[kept] = idx[j];
+                        x0[kept] = x0[j]; x1[kept] = x1[j];
+                        f0[kept] = f0[j]; f1[kept] = f1[j];
+                        eps[kept] = eps[j]; epsF[kept] = epsF[j];
+                        ++kept;
+                        cells.push_back(cells_[idx[j]]);
+                        xnew.push_back((x1[j]*f0[j] - x0[j]*f1[j])/(f0[j] - f1[j]));
+                    }
+                    idx.resize(kept);
+                    if (idx.empty()) {
+                        break;
+                    }
+                    ++iterations_used;
+                    if (iterations_used > max_iter) {
+                        OPM_THROW(std::runtime_error, "Maximum number of iterations exceeded: " << max_iter
+                                  << " inverting the capillary pressure of cell " << cells[0]);
+                    }
+                    capPress(cells, xnew, fnew);
+                    kept = 0;
+                    for (int j = 0; j < int(idx.size()); ++j) {
+                        const double fn = fnew[j] - target_pc[idx[j]];
+                        if (std::fabs(fn) < epsF[j]) {
+                            sat[idx[j]] = xnew[j];
+                            continue;
+                        }
+                        if ((fn > 0.0) == (f0[j] > 0.0)) {
+                            x0[j] = x1[j];
+                            f0[j] = f1[j];
+                        } else {
+                            f0[j] *= f1[j]/(f1[j] + fn);
+                        }
+                        x1[j] = xnew[j];
+                        f1[j] = fn;
+                        idx[kept] = idx[j];
+                        x0[kept] = x0[j]; x1[kept] = x1[j];
+                        f0[kept] = f0[j]; f1[kept] = f1[j];
+                        eps[kept] = eps[j]; epsF[kept] = epsF[j];
+                        ++kept;
+                    }
+                    idx.resize(kept);
+                }
+            }
+
+        private:
+            /// Capillary pressure of the phase at saturations s in the
+            /// given cells, with the other saturations zero as in PcEq.
+            void capPress(const std::vector<int>& cells,
+                          const std::vector<double>& s,
+                          std::vector<double>& pc) const
+            {
+                const int n = cells.size();
+                std::vector<double> sat(n*np_, 0.0);
+                std::vector<double> pcarr(n*np_, 0.0);
+                for (int i = 0; i < n; ++i) {
+                    sat[i*np_ + phase_] = s[i];
+                }
+                if (n > 0) {
+                    props_.capPress(n, sat.data(), cells.data(), pcarr.data(), 0);
+                }
+                pc.resize(n);
+                for (int i = 0; i < n; ++i) {
+                    pc[i] = pcarr[i*np_ + phase_];
+                }
+            }
+
+            const BlackoilPropertiesInterface& props_;
+            const int phase_;
+            const int np_;
+            const std::vector<int>& cells_;
+            const bool increasing_;
+            std::vector<double> smin_, smax_;
+            std::vector<double> pcmin_, pcmax_;
+            // Table of each cell, or -1, and the saturations and
+            // capillary pressures of the tables.
+            std::vector<int> group_;
+            int table_size_;
+            std::vector<double> table_sat_;
+            std::vector<double> table_pc_;
+        };
+
     } // namespace Equil
 } // namespace Opm
 
@@ -0,0 +1,166 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_EXPLICITARRAYSFLUIDSTATEBATCH_HEADER_INCLUDED
+#define OPM_EXPLICITARRAYSFLUIDSTATEBATCH_HEADER_INCLUDED
+
+#include <opm/core/props/BlackoilPhases.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace Opm
+{
+
+    namespace FluidStateBatchDetail
+    {
+        /// Creates a saturation of type Scalar from its value.  Local
+        /// AD evaluations are seeded as the variable 'phaseIdx'.
+        template <class Scalar>
+        struct SaturationVariable
+        {
+            static Scalar make(const double value, const int phaseIdx)
+            {
+                return Scalar::createVariable(value, phaseIdx);
+            }
+        };
+
+        template <>
+        struct SaturationVariable<double>
+        {
+            static double make(const double value, const int)
+            {
+                return value;
+            }
+        };
+    } // namespace FluidStateBatchDetail
+
+    /// Saturations of a batch of up to BatchSize points, gathered from
+    /// the same interleaved arrays as used by ExplicitArraysFluidState
+    /// into structure-of-arrays form: the saturation of phase p in
+    /// lane l is saturations(p)[l].  Unused phases are zero.
+    ///
+    /// Compared to advancing an ExplicitArraysFluidState cursor one
+    /// point at a time, the gather step touches each input row once
+    /// and leaves the phase saturations of consecutive points
+    /// contiguous, so that per-lane loops over a batch vectorise.
+    /// Lane views (see lane()) expose the single-point fluid state
+    /// API expected by the opm-material laws.
+    template <int BatchSize = 8>
+    class ExplicitArraysFluidStateBatch
+    {
+    public:
+        enum { numPhases = BlackoilPhases::MaxNumPhases };
+        enum { batchSize = BatchSize };
+
+        /// Fluid state view of a single lane of a batch.
+        template <class ScalarT>
+        class Lane
+        {
+        public:
+            typedef ScalarT Scalar;
+            enum { numPhases = BlackoilPhases::MaxNumPhases };
+
+            Lane(const ExplicitArraysFluidStateBatch& batch, const int lane)
+                : batch_(batch), lane_(lane)
+            {}
+
+            /// Saturation of a phase (canonical phase index).
+            Scalar saturation(const int phaseIdx) const
+            {
+                return FluidStateBatchDetail::SaturationVariable<Scalar>
+                    ::make(batch_.sats_[phaseIdx][lane_], phaseIdx);
+            }
+
+        private:
+            const ExplicitArraysFluidStateBatch& batch_;
+            int lane_;
+        };
+
+        explicit ExplicitArraysFluidStateBatch(const PhaseUsage& phaseUsage)
+            : phaseUsage_(phaseUsage), saturations_(0), size_(0)
+        {
+            std::fill(&sats_[0][0], &sats_[0][0] + numPhases*BatchSize, 0.0);
+        }
+
+        /// Set the array containing the phase saturations.  Same
+        /// layout as ExplicitArraysFluidState::setSaturationArray().
+        void setSaturationArray(const double* saturations)
+        {
+            saturations_ = saturations;
+        }
+
+        /// Gather the points begin, ..., begin + count - 1 into the
+        /// batch.  If 'order' is non-null these are the points
+        /// order[begin], ..., order[begin + count - 1] instead.
+        /// \param[in] count  Number of lanes, at most BatchSize.
+        void gather(const int begin, const int count, const int* order = 0)
+        {
+            assert(saturations_ != 0);
+            assert(count >= 0 && count <= BatchSize);
+
+            const int np = phaseUsage_.num_phases;
+            size_ = count;
+            for (int l = 0; l < count; ++l) {
+                index_[l] = order ? order[begin + l] : begin + l;
+            }
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                double* sats = sats_[phaseIdx];
+                if (!phaseUsage_.phase_used[phaseIdx]) {
+                    std::fill(sats, sats + count, 0.0);
+                    continue;
+                }
+                const double* s = saturations_ + phaseUsage_.phase_pos[phaseIdx];
+                for (int l = 0; l < count; ++l) {
+                    sats[l] = s[np*index_[l]];
+                }
+            }
+        }
+
+        /// Number of lanes gathered by the last gather().
+        int size() const { return size_; }
+
+        /// Array index of a lane.
+        int index(const int lane) const { return index_[lane]; }
+
+        /// Saturations of a phase (canonical phase index) in all lanes.
+        const double* saturations(const int phaseIdx) const { return sats_[phaseIdx]; }
+
+        /// Fluid state view of a lane, with saturations of type Scalar.
+        template <class Scalar>
+        Lane<Scalar> lane(const int l) const
+        {
+            assert(l >= 0 && l < size_);
+            return Lane<Scalar>(*this, l);
+        }
+
+        const PhaseUsage& phaseUsage() const { return phaseUsage_; }
+
+    private:
+        const PhaseUsage phaseUsage_;
+        const double* saturations_;
+        int size_;
+        int index_[BatchSize];
+        double sats_[numPhases][BatchSize];
+    };
+
+} // namespace Opm
+
+#endif // OPM_EXPLICITARRAYSFLUIDSTATEBATCH_HEADER_INCLUDED
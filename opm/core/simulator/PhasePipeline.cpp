@@ -0,0 +1,111 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/simulator/PhasePipeline.hpp>
+
+#include <algorithm>
+
+namespace Opm
+{
+
+    PhasePipeline::PhasePipeline(const int pressure_slots, const int transport_slots,
+                                 const int pressure_threads, const int transport_threads)
+        : last_change_(Clock::now()),
+          overlap_(Clock::duration::zero())
+    {
+        slots_[Pressure] = std::max(pressure_slots, 1);
+        slots_[Transport] = std::max(transport_slots, 1);
+        threads_[Pressure] = pressure_threads;
+        threads_[Transport] = transport_threads;
+        for (int p = 0; p < 2; ++p) {
+            running_[p] = 0;
+            wait_[p] = Clock::duration::zero();
+        }
+    }
+
+
+    double PhasePipeline::waitTime(const Phase phase) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::chrono::duration<double>(wait_[phase]).count();
+    }
+
+
+    double PhasePipeline::overlapTime() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Clock::duration overlap = overlap_;
+        if (running_[Pressure] > 0 && running_[Transport] > 0) {
+            overlap += Clock::now() - last_change_;
+        }
+        return std::chrono::duration<double>(overlap).count();
+    }
+
+
+    void PhasePipeline::account(const Clock::time_point now)
+    {
+        if (running_[Pressure] > 0 && running_[Transport] > 0) {
+            overlap_ += now - last_change_;
+        }
+        last_change_ = now;
+    }
+
+
+    int PhasePipeline::enter(const Phase phase)
+    {
+        const Clock::time_point start = Clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        slot_freed_.wait(lock, [&]() { return running_[phase] < slots_[phase]; });
+        const Clock::time_point now = Clock::now();
+        wait_[phase] += now - start;
+        account(now);
+        ++running_[phase];
+        return threads_[phase];
+    }
+
+
+    void PhasePipeline::leave(const Phase phase)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            account(Clock::now());
+            --running_[phase];
+        }
+        slot_freed_.notify_all();
+    }
+
+
+    PhasePipeline::Stage::Stage(PhasePipeline* pipeline, const Phase phase)
+        : pipeline_(pipeline),
+          phase_(phase),
+          threads_(pipeline ? pipeline->enter(phase) : 0)
+    {
+    }
+
+
+    PhasePipeline::Stage::~Stage()
+    {
+        if (pipeline_) {
+            pipeline_->leave(phase_);
+        }
+    }
+
+} // namespace Opm
@@ -0,0 +1,102 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_PHASEPIPELINE_HEADER_INCLUDED
+#define OPM_PHASEPIPELINE_HEADER_INCLUDED
+
+#include <opm/core/utility/ThreadControl.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace Opm
+{
+
+    /// Admission control for the pressure and transport phases of
+    /// several simulations that run concurrently, e.g. the members of
+    /// an ensemble.
+    ///
+    /// Each simulation runs its phases in order in a thread of its
+    /// own, which is the only dependency between them. A simulation
+    /// enters a phase through a Stage, which waits until one of the
+    /// slots of that phase is free and then runs the phase with the
+    /// threads given for it. With few slots of each kind, the pressure
+    /// solve of one member (bandwidth-bound) is then overlapped with
+    /// the transport solve of another (latency-bound), rather than all
+    /// members competing for the node in the same phase.
+    class PhasePipeline
+    {
+    public:
+        enum Phase { Pressure = 0, Transport = 1 };
+
+        /// \param[in] pressure_slots     pressure solves that may run at once
+        /// \param[in] transport_slots    transport solves that may run at once
+        /// \param[in] pressure_threads   threads of each pressure solve
+        /// \param[in] transport_threads  threads of each transport solve
+        PhasePipeline(const int pressure_slots, const int transport_slots,
+                      const int pressure_threads, const int transport_threads);
+
+        /// A phase of one simulation, run while the object lives.
+        class Stage
+        {
+        public:
+            /// Wait for a slot of the phase. If pipeline is null, the
+            /// phase runs at once with the current threads.
+            Stage(PhasePipeline* pipeline, const Phase phase);
+            ~Stage();
+
+        private:
+            Stage(const Stage&);
+            Stage& operator=(const Stage&);
+
+            PhasePipeline* pipeline_;
+            Phase phase_;
+            threads::ScopedNumThreads threads_;
+        };
+
+        /// Total time simulations waited for a slot of a phase, in seconds.
+        double waitTime(const Phase phase) const;
+
+        /// Time during which both phases ran, in seconds.
+        double overlapTime() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        // Wait for a slot of the phase, return the threads to run it with.
+        int enter(const Phase phase);
+        void leave(const Phase phase);
+        // Add the time since last_change_ to overlap_, with mutex_ held.
+        void account(const Clock::time_point now);
+
+        mutable std::mutex mutex_;
+        std::condition_variable slot_freed_;
+        int slots_[2];
+        int threads_[2];
+        int running_[2];
+        Clock::time_point last_change_;
+        Clock::duration overlap_;
+        Clock::duration wait_[2];
+    };
+
+} // namespace Opm
+
+#endif // OPM_PHASEPIPELINE_HEADER_INCLUDED
@@ -34,6 +34,7 @@
 #include <opm/core/simulator/SimulatorReport.hpp>
 #include <opm/core/simulator/SimulatorTimer.hpp>
 #include <opm/core/utility/StopWatch.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 #include <opm/core/io/vtk/writeVtkData.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/miscUtilitiesBlackoil.hpp>
@@ -83,6 +84,7 @@ namespace Opm
         // Parameters for output.
         bool output_;
         bool output_vtk_;
+        std::string output_vtk_format_;
         std::string output_dir_;
         int output_interval_;
         // Parameters for well control
@@ -141,7 +143,8 @@ namespace Opm
     static void outputStateVtk(const UnstructuredGrid& grid,
                                const Opm::BlackoilState& state,
                                const int step,
-                               const std::string& output_dir)
+                               const std::string& output_dir,
+                               const std::string& format)
     {
         // Write data in VTK format.
         std::ostringstream vtkfilename;
@@ -154,7 +157,7 @@ namespace Opm
           OPM_THROW(std::runtime_error, "Creating directories failed: " << fpath);
         }
         vtkfilename << "/output-" << std::setw(3) << std::setfill('0') << step << ".vtu";
-        std::ofstream vtkfile(vtkfilename.str().c_str());
+        std::ofstream vtkfile(vtkfilename.str().c_str(), std::ios::binary);
         if (!vtkfile) {
             OPM_THROW(std::runtime_error, "Failed to open " << vtkfilename.str());
         }
@@ -164,7 +167,12 @@ namespace Opm
         std::vector<double> cell_velocity;
         Opm::estimateCellVelocity(grid, state.faceflux(), cell_velocity);
         dm["velocity"] = &cell_velocity;
-        Opm::writeVtkData(grid, dm, vtkfile);
+        if (format == "ascii") {
+            Opm::writeVtkData(grid, dm, vtkfile);
+        } else {
+            Opm::writeVtuData(grid, dm, vtkfile,
+                              format == "zlib" ? Opm::VtkZlibCompressed : Opm::VtkRawBinary);
+        }
     }
 
 
@@ -258,10 +266,20 @@ namespace Opm
                    param.getDefault("nl_tolerance", 1e-9),
                    param.getDefault("nl_maxiter", 30))
     {
+        // Inexact Newton control of the pressure solver.
+        psolver_.setInexactNewton(param.getDefault("nl_pressure_forcing_term", false),
+                                  param.getDefault("nl_pressure_warm_start", false),
+                                  param.getDefault("nl_pressure_max_forcing", 0.5));
+
         // For output.
         output_ = param.getDefault("output", true);
         if (output_) {
             output_vtk_ = param.getDefault("output_vtk", true);
+            output_vtk_format_ = param.getDefault("output_vtk_format", std::string("ascii"));
+            if (output_vtk_format_ != "ascii" && output_vtk_format_ != "binary" && output_vtk_format_ != "zlib") {
+                OPM_THROW(std::runtime_error, "Unknown output_vtk_format " << output_vtk_format_
+                          << ", expected ascii, binary or zlib");
+            }
             output_dir_ = param.getDefault("output_dir", std::string("output"));
             // Ensure that output dir exists
             boost::filesystem::path fpath(output_dir_);
@@ -331,8 +349,10 @@ namespace Opm
         Opm::WellReport wellreport;
         std::vector<double> fractional_flows;
         std::vector<double> well_resflows_phase;
+        std::vector<double> well_surfflows_phase;
         if (wells_) {
             well_resflows_phase.resize((wells_->number_of_phases)*(wells_->number_of_wells), 0.0);
+            well_surfflows_phase.resize((wells_->number_of_phases)*(wells_->number_of_wells), 0.0);
             wellreport.push(props_, *wells_,
                             state.pressure(), state.surfacevol(), state.saturation(),
                             0.0, well_state.bhp(), well_state.perfRates());
@@ -348,7 +368,7 @@ namespace Opm
             timer.report(std::cout);
             if (output_ && (timer.currentStepNum() % output_interval_ == 0)) {
                 if (output_vtk_) {
-                    outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
+                    outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_, output_vtk_format_);
                 }
                 outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
             }
@@ -360,11 +380,12 @@ namespace Opm
                 computeFractionalFlow(props_, allcells_,
                                       state.pressure(), state.temperature(), state.surfacevol(), state.saturation(),
                                       fractional_flows);
-                wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
+                wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_surfflows_phase);
             }
             bool well_control_passed = !check_well_controls_;
             int well_control_iteration = 0;
             do {
+                OPM_TIMED_SCOPE("pressure");
                 // Run solver.
                 pressure_timer.start();
                 std::vector<double> initial_pressure = state.pressure();
@@ -407,13 +428,13 @@ namespace Opm
 
                 // Optionally, check if well controls are satisfied.
                 if (check_well_controls_) {
-                    Opm::computePhaseFlowRatesPerWell(*wells_,
-                                                      well_state.perfRates(),
-                                                      fractional_flows,
-                                                      well_resflows_phase);
+                    Opm::computeWellPhaseRates(props_, *wells_, state,
+                                               well_state.perfRates(),
+                                               fractional_flows,
+                                               well_resflows_phase,
+                                               well_surfflows_phase);
                     std::cout << "Checking well conditions." << std::endl;
-                    // For testing we set surface := reservoir
-                    well_control_passed = wells_manager_.conditionsMet(well_state.bhp(), well_resflows_phase, well_resflows_phase);
+                    well_control_passed = wells_manager_.applyViolatedControls(well_state.bhp(), well_resflows_phase, well_surfflows_phase) == 0;
                     ++well_control_iteration;
                     if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
                         OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
@@ -445,6 +466,7 @@ namespace Opm
             double injected[2] = { 0.0 };
             double produced[2] = { 0.0 };
             for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
+                OPM_TIMED_SCOPE("transport");
                 tsolver_.solve(&state.faceflux()[0], &state.pressure()[0], &state.temperature()[0],
                                &initial_porevol[0], &porevol[0], &transport_src[0], stepsize,
                                state.saturation(), state.surfacevol());
@@ -515,7 +537,7 @@ namespace Opm
 
         if (output_) {
             if (output_vtk_) {
-                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
+                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_, output_vtk_format_);
             }
             outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
             outputWaterCut(watercut, output_dir_);
@@ -50,9 +50,15 @@ namespace Opm
         ///     output (true)                  write output to files?
         ///     output_dir ("output")          output directoty
         ///     output_interval (1)            output every nth step
+        ///     output_vtk_format ("ascii")    encoding of the vtk output, "ascii",
+        ///                                    "binary" or "zlib" (compressed binary)
         ///     nl_pressure_residual_tolerance (0.0) pressure solver residual tolerance (in Pascal)
         ///     nl_pressure_change_tolerance (1.0)   pressure solver change tolerance (in Pascal)
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
+        ///     nl_pressure_forcing_term (false) solve pressure increments inexactly,
+        ///                                    to Eisenstat-Walker forcing terms
+        ///     nl_pressure_warm_start (false) initial guess from previous pressure increment
+        ///     nl_pressure_max_forcing (0.5)  upper bound of pressure forcing terms
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
         ///     num_transport_substeps (1)     number of transport steps per pressure step
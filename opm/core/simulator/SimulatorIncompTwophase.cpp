@@ -32,12 +32,14 @@
 #include <opm/core/wells.h>
 #include <opm/core/pressure/flow_bc.h>
 
+#include <opm/core/simulator/PhasePipeline.hpp>
 #include <opm/core/simulator/SimulatorReport.hpp>
 #include <opm/core/simulator/SimulatorTimer.hpp>
 #include <opm/core/utility/StopWatch.hpp>
 #include <opm/core/io/vtk/writeVtkData.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/Event.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
 
 #include <opm/core/wells/WellsManager.hpp>
 #include <opm/core/well_controls.h>
@@ -53,6 +55,8 @@
 #include <boost/filesystem.hpp>
 #include <memory>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <numeric>
 #include <fstream>
@@ -77,11 +81,19 @@ namespace Opm
                             TwophaseState& state,
                             WellState& well_state);
 
+        double solvePressure(const double dt,
+                             TwophaseState& state,
+                             WellState& well_state,
+                             std::vector<double>& fractional_flows,
+                             std::vector<double>& well_resflows_phase);
+        bool pressureReusable(const std::vector<double>& s);
+
         // Data.
         // Parameters for output.
         std::ostream* log_;
         bool output_;
         bool output_vtk_;
+        std::string output_vtk_format_;
         std::string output_dir_;
         int output_interval_;
         // Parameters for well control
@@ -89,6 +101,11 @@ namespace Opm
         int max_well_control_iterations_;
         // Parameters for transport solver.
         int num_transport_substeps_;
+        // Parameters for sequential iterations.
+        int max_outer_iterations_;
+        double outer_saturation_tolerance_;
+        double pressure_reuse_mobility_tolerance_;
+        double porevol_update_tolerance_;
         bool use_reorder_;
         bool use_segregation_split_;
         // Observed objects.
@@ -99,11 +116,17 @@ namespace Opm
         const Wells* wells_;
         const std::vector<double>& src_;
         const FlowBoundaryConditions* bcs_;
+        PhasePipeline* pipeline_;
+        LinearSolverInterface& linsolver_;
         // Solvers
         IncompTpfa psolver_;
         std::unique_ptr<TransportSolverTwophaseInterface> tsolver_;
         // Misc. data
         std::vector<int> allcells_;
+        // Phase mobilities at the last pressure solve, and scratch
+        // space, used only if pressure_reuse_mobility_tolerance_ > 0.
+        std::vector<double> pressure_mobility_;
+        std::vector<double> mobility_;
 
         // list of hooks that are notified when a timestep completes
         EventSource timestep_completed_;
@@ -146,6 +169,22 @@ namespace Opm
     void SimulatorIncompTwophase::sync () {
     }
 
+    void SimulatorIncompTwophase::setPhasePipeline(PhasePipeline* pipeline)
+    {
+        pimpl_->pipeline_ = pipeline;
+    }
+
+    void SimulatorIncompTwophase::reportMemory(MemoryReport& report) const
+    {
+        pimpl_->psolver_.reportMemory(report);
+        pimpl_->linsolver_.reportMemory(report);
+        pimpl_->wells_manager_.reportMemory(report);
+        report.add("simulator",
+                   MemoryReport::bytes(pimpl_->allcells_)
+                   + MemoryReport::bytes(pimpl_->pressure_mobility_)
+                   + MemoryReport::bytes(pimpl_->mobility_));
+    }
+
     static void reportVolumes(std::ostream &os, double satvol[2], double tot_porevol_init,
                               double tot_injected[2], double tot_produced[2],
                               double injected[2], double produced[2],
@@ -182,7 +221,8 @@ namespace Opm
     static void outputStateVtk(const UnstructuredGrid& grid,
                                const Opm::TwophaseState& state,
                                const int step,
-                               const std::string& output_dir)
+                               const std::string& output_dir,
+                               const std::string& format)
     {
         // Write data in VTK format.
         std::ostringstream vtkfilename;
@@ -195,7 +235,7 @@ namespace Opm
             OPM_THROW(std::runtime_error, "Creating directories failed: " << fpath);
         }
         vtkfilename << "/output-" << std::setw(3) << std::setfill('0') << step << ".vtu";
-        std::ofstream vtkfile(vtkfilename.str().c_str());
+        std::ofstream vtkfile(vtkfilename.str().c_str(), std::ios::binary);
         if (!vtkfile) {
             OPM_THROW(std::runtime_error, "Failed to open " << vtkfilename.str());
         }
@@ -205,7 +245,12 @@ namespace Opm
         std::vector<double> cell_velocity;
         Opm::estimateCellVelocity(grid, state.faceflux(), cell_velocity);
         dm["velocity"] = &cell_velocity;
-        Opm::writeVtkData(grid, dm, vtkfile);
+        if (format == "ascii") {
+            Opm::writeVtkData(grid, dm, vtkfile);
+        } else {
+            Opm::writeVtuData(grid, dm, vtkfile,
+                              format == "zlib" ? Opm::VtkZlibCompressed : Opm::VtkRawBinary);
+        }
     }
 
     static void outputVectorMatlab(const std::string& name,
@@ -341,6 +386,8 @@ namespace Opm
           wells_(wells_manager.c_wells()),
           src_(src),
           bcs_(bcs),
+          pipeline_(0),
+          linsolver_(linsolver),
           psolver_(grid, props, rock_comp_props, linsolver,
                    param.getDefault("nl_pressure_residual_tolerance", 0.0),
                    param.getDefault("nl_pressure_change_tolerance", 1.0),
@@ -349,11 +396,14 @@ namespace Opm
     {
         // Initialize transport solver.
         if (use_reorder_) {
-            tsolver_.reset(new Opm::TransportSolverTwophaseReorder(grid,
-                                                                   props,
-                                                                   use_segregation_split_ ? gravity : NULL,
-                                                                   param.getDefault("nl_tolerance", 1e-9),
-                                                                   param.getDefault("nl_maxiter", 30)));
+            Opm::TransportSolverTwophaseReorder* reorder
+                = new Opm::TransportSolverTwophaseReorder(grid,
+                                                          props,
+                                                          use_segregation_split_ ? gravity : NULL,
+                                                          param.getDefault("nl_tolerance", 1e-9),
+                                                          param.getDefault("nl_maxiter", 30));
+            tsolver_.reset(reorder);
+            reorder->useNewtonSingleCell(param.getDefault("use_newton_single_cell", false));
 
         } else {
             if (rock_comp_props && rock_comp_props->isActive()) {
@@ -377,6 +427,11 @@ namespace Opm
         output_ = param.getDefault("output", true);
         if (output_) {
             output_vtk_ = param.getDefault("output_vtk", true);
+            output_vtk_format_ = param.getDefault("output_vtk_format", std::string("ascii"));
+            if (output_vtk_format_ != "ascii" && output_vtk_format_ != "binary" && output_vtk_format_ != "zlib") {
+                OPM_THROW(std::runtime_error, "Unknown output_vtk_format " << output_vtk_format_
+                          << ", expected ascii, binary or zlib");
+            }
             output_dir_ = param.getDefault("output_dir", std::string("output"));
             // Ensure that output dir exists
             boost::filesystem::path fpath(output_dir_);
@@ -396,6 +451,17 @@ namespace Opm
         // Transport related init.
         num_transport_substeps_ = param.getDefault("num_transport_substeps", 1);
 
+        // Sequential iterations.
+        max_outer_iterations_ = param.getDefault("max_outer_iterations", 1);
+        outer_saturation_tolerance_ = param.getDefault("outer_saturation_tolerance", 1e-4);
+        pressure_reuse_mobility_tolerance_ = param.getDefault("pressure_reuse_mobility_tolerance", 0.0);
+        if ((max_outer_iterations_ > 1 || pressure_reuse_mobility_tolerance_ > 0.0)
+            && rock_comp_props && rock_comp_props->isActive()) {
+            OPM_THROW(std::runtime_error, "Sequential iterations and reuse of pressure solutions cannot handle rock compressibility.");
+        }
+        porevol_update_tolerance_ = param.getDefault("porevol_update_tolerance", 0.0);
+        psolver_.setPorevolumeUpdateTolerance(porevol_update_tolerance_);
+
         // Misc init.
         const int num_cells = grid.number_of_cells;
         allcells_.resize(num_cells);
@@ -407,6 +473,126 @@ namespace Opm
 
 
 
+    /// Solve the pressure equation, repeated until the well
+    /// controls are met if they are checked.
+    /// \return Time taken by the pressure solves.
+    double SimulatorIncompTwophase::Impl::solvePressure(const double dt,
+                                                        TwophaseState& state,
+                                                        WellState& well_state,
+                                                        std::vector<double>& fractional_flows,
+                                                        std::vector<double>& well_resflows_phase)
+    {
+        Opm::time::StopWatch pressure_timer;
+        double ptime = 0.0;
+
+        if (check_well_controls_) {
+            computeFractionalFlow(props_, allcells_, state.saturation(), fractional_flows);
+            wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
+        }
+        bool well_control_passed = !check_well_controls_;
+        int well_control_iteration = 0;
+        do {
+            // Run solver.
+            pressure_timer.start();
+            std::vector<double> initial_pressure = state.pressure();
+            psolver_.solve(dt, state, well_state);
+
+            // Renormalize pressure if rock is incompressible, and
+            // there are no pressure conditions (bcs or wells).
+            // It is deemed sufficient for now to renormalize
+            // using geometric volume instead of pore volume.
+            if ((rock_comp_props_ == NULL || !rock_comp_props_->isActive())
+                && allNeumannBCs(bcs_) && allRateWells(wells_)) {
+                // Compute average pressures of previous and last
+                // step, and total volume.
+                double av_prev_press = 0.0;
+                double av_press = 0.0;
+                double tot_vol = 0.0;
+                const int num_cells = grid_.number_of_cells;
+                for (int cell = 0; cell < num_cells; ++cell) {
+                    av_prev_press += initial_pressure[cell]*grid_.cell_volumes[cell];
+                    av_press      += state.pressure()[cell]*grid_.cell_volumes[cell];
+                    tot_vol       += grid_.cell_volumes[cell];
+                }
+                // Renormalization constant
+                const double ren_const = (av_prev_press - av_press)/tot_vol;
+                for (int cell = 0; cell < num_cells; ++cell) {
+                    state.pressure()[cell] += ren_const;
+                }
+                const int num_wells = (wells_ == NULL) ? 0 : wells_->number_of_wells;
+                for (int well = 0; well < num_wells; ++well) {
+                    well_state.bhp()[well] += ren_const;
+                }
+            }
+
+            // Stop timer and report.
+            pressure_timer.stop();
+            const double pt = pressure_timer.secsSinceStart();
+            *log_ << "Pressure solver took:  " << pt << " seconds." << std::endl;
+            ptime += pt;
+
+            // Optionally, check if well controls are satisfied.
+            if (check_well_controls_) {
+                Opm::computePhaseFlowRatesPerWell(*wells_,
+                                                  well_state.perfRates(),
+                                                  fractional_flows,
+                                                  well_resflows_phase);
+                *log_ << "Checking well conditions." << std::endl;
+                // For testing we set surface := reservoir
+                well_control_passed = wells_manager_.applyViolatedControls(well_state.bhp(), well_resflows_phase, well_resflows_phase) == 0;
+                ++well_control_iteration;
+                if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
+                    OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
+                }
+                if (!well_control_passed) {
+                    *log_ << "Well controls not passed, solving again." << std::endl;
+                } else {
+                    *log_ << "Well conditions met." << std::endl;
+                }
+            }
+        } while (!well_control_passed);
+
+        // Phase mobilities the fluxes were computed with.
+        if (pressure_reuse_mobility_tolerance_ > 0.0) {
+            computePhaseMobilities(props_, allcells_, state.saturation(), pressure_mobility_);
+        }
+        return ptime;
+    }
+
+
+
+
+    /// Whether the phase mobilities of the saturations differ from
+    /// those of the last pressure solve by at most
+    /// pressure_reuse_mobility_tolerance_, relative to the total
+    /// mobility, in every cell.
+    bool SimulatorIncompTwophase::Impl::pressureReusable(const std::vector<double>& s)
+    {
+        if (!(pressure_reuse_mobility_tolerance_ > 0.0) || pressure_mobility_.empty()) {
+            return false;
+        }
+        computePhaseMobilities(props_, allcells_, s, mobility_);
+        const int np = props_.numPhases();
+        const int nc = grid_.number_of_cells;
+        for (int c = 0; c < nc; ++c) {
+            const double* ref = &pressure_mobility_[np*c];
+            const double* mob = &mobility_[np*c];
+            double totmob = 0.0;
+            double change = 0.0;
+            for (int p = 0; p < np; ++p) {
+                totmob += ref[p];
+                change = std::max(change, std::fabs(mob[p] - ref[p]));
+            }
+            if (change > pressure_reuse_mobility_tolerance_*totmob) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+
+
     SimulatorReport SimulatorIncompTwophase::Impl::run(SimulatorTimer& timer,
                                                        TwophaseState& state,
                                                        WellState& well_state)
@@ -415,16 +601,19 @@ namespace Opm
 
         // Initialisation.
         std::vector<double> porevol;
+        std::vector<double> static_porevol;
+        std::vector<double> porevol_pressure;
+        computePorevolume(grid_, props_.porosity(), static_porevol);
         if (rock_comp_props_ && rock_comp_props_->isActive()) {
-            computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol);
+            updatePorevolume(static_porevol, *rock_comp_props_, state.pressure(),
+                             porevol_update_tolerance_, porevol_pressure, porevol);
         } else {
-            computePorevolume(grid_, props_.porosity(), porevol);
+            porevol = static_porevol;
         }
         const double tot_porevol_init = std::accumulate(porevol.begin(), porevol.end(), 0.0);
         std::vector<double> initial_porevol = porevol;
 
         // Main simulation loop.
-        Opm::time::StopWatch pressure_timer;
         double ptime = 0.0;
         Opm::time::StopWatch transport_timer;
         double ttime = 0.0;
@@ -449,6 +638,11 @@ namespace Opm
             well_resflows_phase.resize((wells_->number_of_phases)*(wells_->number_of_wells), 0.0);
             wellreport.push(props_, *wells_, state.saturation(), 0.0, well_state.bhp(), well_state.perfRates());
         }
+        std::vector<double> step_start_saturation;
+        std::vector<double> previous_saturation;
+        unsigned int outer_iterations = 0;
+        unsigned int skipped_pressure_solves = 0;
+        pressure_mobility_.clear();
         std::fstream tstep_os;
         if (output_) {
             std::string filename = output_dir_ + "/step_timing.param";
@@ -460,7 +654,7 @@ namespace Opm
             timer.report(*log_);
             if (output_ && (timer.currentStepNum() % output_interval_ == 0)) {
                 if (output_vtk_) {
-                    outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
+                    outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_, output_vtk_format_);
                 }
                 outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
                 if (use_reorder_) {
@@ -473,111 +667,122 @@ namespace Opm
 
             SimulatorReport sreport;
 
-            // Solve pressure equation.
-            if (check_well_controls_) {
-                computeFractionalFlow(props_, allcells_, state.saturation(), fractional_flows);
-                wells_manager_.applyExplicitReinjectionControls(well_resflows_phase, well_resflows_phase);
+            // Sequential iterations: pressure and transport are
+            // solved in turn until the saturations settle, each
+            // transport solve starting from the saturations at the
+            // start of the step.
+            const bool sequential = max_outer_iterations_ > 1;
+            if (sequential) {
+                step_start_saturation = state.saturation();
             }
-            bool well_control_passed = !check_well_controls_;
-            int well_control_iteration = 0;
-            do {
-                // Run solver.
-                pressure_timer.start();
-                std::vector<double> initial_pressure = state.pressure();
-                psolver_.solve(timer.currentStepLength(), state, well_state);
-
-                // Renormalize pressure if rock is incompressible, and
-                // there are no pressure conditions (bcs or wells).
-                // It is deemed sufficient for now to renormalize
-                // using geometric volume instead of pore volume.
-                if ((rock_comp_props_ == NULL || !rock_comp_props_->isActive())
-                    && allNeumannBCs(bcs_) && allRateWells(wells_)) {
-                    // Compute average pressures of previous and last
-                    // step, and total volume.
-                    double av_prev_press = 0.0;
-                    double av_press = 0.0;
-                    double tot_vol = 0.0;
-                    const int num_cells = grid_.number_of_cells;
-                    for (int cell = 0; cell < num_cells; ++cell) {
-                        av_prev_press += initial_pressure[cell]*grid_.cell_volumes[cell];
-                        av_press      += state.pressure()[cell]*grid_.cell_volumes[cell];
-                        tot_vol       += grid_.cell_volumes[cell];
-                    }
-                    // Renormalization constant
-                    const double ren_const = (av_prev_press - av_press)/tot_vol;
-                    for (int cell = 0; cell < num_cells; ++cell) {
-                        state.pressure()[cell] += ren_const;
-                    }
-                    const int num_wells = (wells_ == NULL) ? 0 : wells_->number_of_wells;
-                    for (int well = 0; well < num_wells; ++well) {
-                        well_state.bhp()[well] += ren_const;
+            double injected[2] = { 0.0 };
+            double produced[2] = { 0.0 };
+            double stepsize = timer.currentStepLength();
+            if (num_transport_substeps_ != 1) {
+                stepsize /= double(num_transport_substeps_);
+                *log_ << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
+            }
+            int outer_iteration = 0;
+            for (;;) {
+                ++outer_iteration;
+
+                // Reuse the fluxes of the last pressure solve if the
+                // mobilities have changed little since.
+                const bool reuse_pressure = pressureReusable(state.saturation());
+                if (reuse_pressure) {
+                    ++sreport.total_skipped_pressure_solves;
+                    *log_ << "Mobilities changed little, reusing fluxes of last pressure solve." << std::endl;
+                    if (outer_iteration > 1) {
+                        // Transport would repeat the last iteration.
+                        break;
                     }
+                } else {
+                    PhasePipeline::Stage stage(pipeline_, PhasePipeline::Pressure);
+                    const double pt = solvePressure(timer.currentStepLength(), state, well_state,
+                                                    fractional_flows, well_resflows_phase);
+                    ptime += pt;
+                    sreport.pressure_time += pt;
                 }
 
-                // Stop timer and report.
-                pressure_timer.stop();
-                double pt = pressure_timer.secsSinceStart();
-                *log_ << "Pressure solver took:  " << pt << " seconds." << std::endl;
-                ptime += pt;
-                sreport.pressure_time = pt;
-
-                // Optionally, check if well controls are satisfied.
-                if (check_well_controls_) {
-                    Opm::computePhaseFlowRatesPerWell(*wells_,
-                                                      well_state.perfRates(),
-                                                      fractional_flows,
-                                                      well_resflows_phase);
-                    *log_ << "Checking well conditions." << std::endl;
-                    // For testing we set surface := reservoir
-                    well_control_passed = wells_manager_.conditionsMet(well_state.bhp(), well_resflows_phase, well_resflows_phase);
-                    ++well_control_iteration;
-                    if (!well_control_passed && well_control_iteration > max_well_control_iterations_) {
-                        OPM_THROW(std::runtime_error, "Could not satisfy well conditions in " << max_well_control_iterations_ << " tries.");
-                    }
-                    if (!well_control_passed) {
-                        *log_ << "Well controls not passed, solving again." << std::endl;
-                    } else {
-                        *log_ << "Well conditions met." << std::endl;
-                    }
+                // Update pore volumes if rock is compressible.
+                if (rock_comp_props_ && rock_comp_props_->isActive()) {
+                    initial_porevol = porevol;
+                    updatePorevolume(static_porevol, *rock_comp_props_, state.pressure(),
+                                     porevol_update_tolerance_, porevol_pressure, porevol);
                 }
-            } while (!well_control_passed);
 
-            // Update pore volumes if rock is compressible.
-            if (rock_comp_props_ && rock_comp_props_->isActive()) {
-                initial_porevol = porevol;
-                computePorevolume(grid_, props_.porosity(), *rock_comp_props_, state.pressure(), porevol);
-            }
+                // Process transport sources (to include bdy terms and well flows).
+                Opm::computeTransportSource(grid_, src_, state.faceflux(), 1.0,
+                                            wells_, well_state.perfRates(), transport_src);
 
-            // Process transport sources (to include bdy terms and well flows).
-            Opm::computeTransportSource(grid_, src_, state.faceflux(), 1.0,
-                                        wells_, well_state.perfRates(), transport_src);
+                if (outer_iteration > 1) {
+                    previous_saturation = state.saturation();
+                    state.saturation() = step_start_saturation;
+                }
 
-            // Solve transport.
-            transport_timer.start();
-            double stepsize = timer.currentStepLength();
-            if (num_transport_substeps_ != 1) {
-                stepsize /= double(num_transport_substeps_);
-                *log_ << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
-            }
-            double injected[2] = { 0.0 };
-            double produced[2] = { 0.0 };
-            for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
-                tsolver_->solve(&initial_porevol[0], &transport_src[0], stepsize, state);
-
-                double substep_injected[2] = { 0.0 };
-                double substep_produced[2] = { 0.0 };
-                Opm::computeInjectedProduced(props_, state.saturation(), transport_src, stepsize,
-                                             substep_injected, substep_produced);
-                injected[0] += substep_injected[0];
-                injected[1] += substep_injected[1];
-                produced[0] += substep_produced[0];
-                produced[1] += substep_produced[1];
-                if (use_reorder_ && use_segregation_split_) {
-                    // Again, unfortunate but safe use of dynamic_cast.
-                    // Possible solution: refactor gravity solver to its own class.
-                    dynamic_cast<TransportSolverTwophaseReorder&>(*tsolver_)
-                        .solveGravity(&initial_porevol[0], stepsize, state);
+                // Solve transport.
+                PhasePipeline::Stage transport_stage(pipeline_, PhasePipeline::Transport);
+                transport_timer.start();
+                injected[0] = injected[1] = 0.0;
+                produced[0] = produced[1] = 0.0;
+                for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
+                    tsolver_->solve(&initial_porevol[0], &transport_src[0], stepsize, state);
+
+                    double substep_injected[2] = { 0.0 };
+                    double substep_produced[2] = { 0.0 };
+                    Opm::computeInjectedProduced(props_, state.saturation(), transport_src, stepsize,
+                                                 substep_injected, substep_produced);
+                    injected[0] += substep_injected[0];
+                    injected[1] += substep_injected[1];
+                    produced[0] += substep_produced[0];
+                    produced[1] += substep_produced[1];
+                    if (use_reorder_ && use_segregation_split_) {
+                        // Again, unfortunate but safe use of dynamic_cast.
+                        // Possible solution: refactor gravity solver to its own class.
+                        dynamic_cast<TransportSolverTwophaseReorder&>(*tsolver_)
+                            .solveGravity(&initial_porevol[0], stepsize, state);
+                    }
+                    if (!sequential) {
+                        watercut.push(timer.simulationTimeElapsed() + timer.currentStepLength(),
+                                      produced[0]/(produced[0] + produced[1]),
+                                      tot_produced[0]/tot_porevol_init);
+                        if (wells_) {
+                            wellreport.push(props_, *wells_, state.saturation(),
+                                            timer.simulationTimeElapsed() + timer.currentStepLength(),
+                                            well_state.bhp(), well_state.perfRates());
+                        }
+                    }
                 }
+                transport_timer.stop();
+                const double tt = transport_timer.secsSinceStart();
+                sreport.transport_time += tt;
+                *log_ << "Transport solver took: " << tt << " seconds." << std::endl;
+                ttime += tt;
+
+                if (!sequential) {
+                    break;
+                }
+                if (outer_iteration > 1) {
+                    double change = 0.0;
+                    for (std::size_t i = 0; i < previous_saturation.size(); ++i) {
+                        change = std::max(change, std::fabs(state.saturation()[i] - previous_saturation[i]));
+                    }
+                    *log_ << "Sequential iteration " << outer_iteration
+                          << ", saturation change " << change << std::endl;
+                    if (change <= outer_saturation_tolerance_) {
+                        break;
+                    }
+                }
+                if (outer_iteration == max_outer_iterations_) {
+                    *log_ << "Sequential iterations did not converge in "
+                          << max_outer_iterations_ << " iterations." << std::endl;
+                    break;
+                }
+            }
+            sreport.total_outer_iterations = outer_iteration;
+            outer_iterations += sreport.total_outer_iterations;
+            skipped_pressure_solves += sreport.total_skipped_pressure_solves;
+            if (sequential) {
                 watercut.push(timer.simulationTimeElapsed() + timer.currentStepLength(),
                               produced[0]/(produced[0] + produced[1]),
                               tot_produced[0]/tot_porevol_init);
@@ -587,11 +792,6 @@ namespace Opm
                                     well_state.bhp(), well_state.perfRates());
                 }
             }
-            transport_timer.stop();
-            double tt = transport_timer.secsSinceStart();
-            sreport.transport_time = tt;
-            *log_ << "Transport solver took: " << tt << " seconds." << std::endl;
-            ttime += tt;
             // Report volume balances.
             Opm::computeSaturatedVol(porevol, state.saturation(), satvol);
             tot_injected[0] += injected[0];
@@ -620,7 +820,7 @@ namespace Opm
 
         if (output_) {
             if (output_vtk_) {
-                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
+                outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_, output_vtk_format_);
             }
             outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
             if (use_reorder_) {
@@ -642,6 +842,8 @@ namespace Opm
         report.pressure_time = ptime;
         report.transport_time = ttime;
         report.total_time = total_timer.secsSinceStart() - time_in_callbacks;
+        report.total_outer_iterations = outer_iterations;
+        report.total_skipped_pressure_solves = skipped_pressure_solves;
         return report;
     }
 
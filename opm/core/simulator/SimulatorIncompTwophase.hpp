@@ -38,6 +38,8 @@ namespace Opm
     class SimulatorTimer;
     class TwophaseState;
     class WellState;
+    class PhasePipeline;
+    class MemoryReport;
     struct SimulatorReport;
     struct Event;
 
@@ -52,12 +54,27 @@ namespace Opm
         ///     output (true)                  write output to files?
         ///     output_dir ("output")          output directoty
         ///     output_interval (1)            output every nth step
+        ///     output_vtk_format ("ascii")    encoding of the vtk output, "ascii",
+        ///                                    "binary" or "zlib" (compressed binary)
         ///     nl_pressure_residual_tolerance (0.0) pressure solver residual tolerance (in Pascal)
         ///     nl_pressure_change_tolerance (1.0)   pressure solver change tolerance (in Pascal)
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
         ///     num_transport_substeps (1)     number of transport steps per pressure step
+        ///     max_outer_iterations (1)       max sequential pressure-transport iterations
+        ///                                    per step; each transport solve starts from
+        ///                                    the saturations at the start of the step
+        ///     outer_saturation_tolerance (1e-4)  sequential iterations stop when no
+        ///                                    saturation changes by more than this
+        ///     pressure_reuse_mobility_tolerance (0.0)  if positive, reuse the fluxes of the
+        ///                                    last pressure solve as long as no phase
+        ///                                    mobility has changed by more than this,
+        ///                                    relative to the total mobility at that solve
+        ///     porevol_update_tolerance (0.0)  with rock compressibility, pore volumes are
+        ///                                    only updated in cells whose pressure has
+        ///                                    changed by more than this since their last
+        ///                                    update
         ///     use_segregation_split (false)  solve for gravity segregation (if false,
         ///                                    segregation is ignored).
         ///
@@ -133,6 +150,18 @@ namespace Opm
         ///      Opm::SimulatorIncompTwophase::timestep_completed
         void sync ();
 
+        /// Run the pressure and transport solves of run() as stages of
+        /// a pipeline shared with other simulators, so that they wait
+        /// for its slots and use its threads. Null (the default) runs
+        /// them at once. The pipeline must outlive the calls to run().
+        void setPhasePipeline(PhasePipeline* pipeline);
+
+        /// Add the memory of the pressure solver, the linear solver,
+        /// the wells and the simulator's own work arrays to the report.
+        /// The grid and the state are owned by the caller, who adds
+        /// them if wanted.
+        void reportMemory(MemoryReport& report) const;
+
     private:
         struct Impl;
         // Using shared_ptr instead of unique_ptr since unique_ptr requires complete type for Impl.
@@ -19,6 +19,8 @@
 
 #include "config.h"
 #include <opm/core/simulator/SimulatorReport.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 #include <ostream>
 
 namespace Opm
@@ -29,6 +31,10 @@ namespace Opm
           total_time(0.0),
           total_newton_iterations( 0 ),
           total_linear_iterations( 0 ),
+          total_failed_steps( 0 ),
+          total_wasted_newton_iterations( 0 ),
+          total_outer_iterations( 0 ),
+          total_skipped_pressure_solves( 0 ),
           verbose_(verbose)
     {
     }
@@ -40,6 +46,10 @@ namespace Opm
         total_time += sr.total_time;
         total_newton_iterations += sr.total_newton_iterations;
         total_linear_iterations += sr.total_linear_iterations;
+        total_failed_steps += sr.total_failed_steps;
+        total_wasted_newton_iterations += sr.total_wasted_newton_iterations;
+        total_outer_iterations += sr.total_outer_iterations;
+        total_skipped_pressure_solves += sr.total_skipped_pressure_solves;
     }
 
     void SimulatorReport::report(std::ostream& os)
@@ -51,6 +61,10 @@ namespace Opm
                << "\n  Transport time: " << transport_time
                << "\n  Overall Newton Iterations:  " << total_newton_iterations
                << "\n  Overall Linear Iterations:  " << total_linear_iterations
+               << "\n  Failed time steps:          " << total_failed_steps
+               << "\n  Wasted Newton Iterations:   " << total_wasted_newton_iterations
+               << "\n  Outer Iterations:           " << total_outer_iterations
+               << "\n  Skipped Pressure Solves:    " << total_skipped_pressure_solves
                << std::endl;
         }
     }
@@ -63,6 +77,8 @@ namespace Opm
                << "\nSolver time (seconds):       " << pressure_time
                << "\nOverall Newton Iterations:   " << total_newton_iterations
                << "\nOverall Linear Iterations:   " << total_linear_iterations
+               << "\nFailed time steps:           " << total_failed_steps
+               << "\nWasted Newton Iterations:    " << total_wasted_newton_iterations
                << std::endl;
         }
     }
@@ -76,9 +92,35 @@ namespace Opm
                << "\n/timing/transport/total_time=" << transport_time
                << "\n/timing/newton/iterations=" << total_newton_iterations
                << "\n/timing/linear/iterations=" << total_linear_iterations
+               << "\n/timing/newton/failed_steps=" << total_failed_steps
+               << "\n/timing/newton/wasted_iterations=" << total_wasted_newton_iterations
+               << "\n/timing/outer/iterations=" << total_outer_iterations
+               << "\n/timing/pressure/skipped_solves=" << total_skipped_pressure_solves
                << std::endl;
         }
     }
 
+    void SimulatorReport::reportTimings(std::ostream& os)
+    {
+#ifdef OPM_ENABLE_TIMING
+        if ( verbose_ )
+        {
+            os << "\nTimings by scope (seconds summed over threads):\n";
+            time::TimingTree::print(os);
+        }
+#else
+        static_cast<void>(os);
+#endif
+    }
+
+    void SimulatorReport::reportMemory(std::ostream& os, const MemoryReport& memory)
+    {
+        if ( verbose_ )
+        {
+            os << "\nAllocated memory by subsystem:\n";
+            memory.print(os);
+        }
+    }
+
 
 } // namespace Opm
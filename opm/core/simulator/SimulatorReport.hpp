@@ -25,6 +25,8 @@
 namespace Opm
 {
 
+    class MemoryReport;
+
     /// A struct for returning timing data from a simulator to its caller.
     struct SimulatorReport
     {
@@ -35,6 +37,16 @@ namespace Opm
         unsigned int total_newton_iterations;
         unsigned int total_linear_iterations;
 
+        /// Time steps that were given up or failed, and the Newton
+        /// iterations spent in them.
+        unsigned int total_failed_steps;
+        unsigned int total_wasted_newton_iterations;
+
+        /// Sequential pressure-transport iterations, and pressure solves
+        /// skipped since the fluxes of the previous one were reused.
+        unsigned int total_outer_iterations;
+        unsigned int total_skipped_pressure_solves;
+
         /// Default constructor initializing all times to 0.0.
         SimulatorReport(bool verbose=true);
         /// Increment this report's times by those in sr.
@@ -44,6 +56,13 @@ namespace Opm
         /// Print a report, leaving out the transport time.
         void reportFullyImplicit(std::ostream& os);
         void reportParam(std::ostream& os);
+        /// Print the hierarchical timings of the whole run, see
+        /// time::TimingTree. Prints nothing unless the timing probes
+        /// are compiled in (OPM_ENABLE_TIMING).
+        void reportTimings(std::ostream& os);
+        /// Print the bytes allocated by each subsystem, as collected
+        /// by their reportMemory() methods.
+        void reportMemory(std::ostream& os, const MemoryReport& memory);
     private:
         // Whether to print statistics to std::cout
         bool verbose_;
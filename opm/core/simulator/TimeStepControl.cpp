@@ -19,6 +19,7 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <config.h>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -124,6 +125,18 @@ namespace Opm
         }
     }
 
+    std::vector< double > PIDTimeStepControl::state() const
+    {
+        return errors_;
+    }
+
+    void PIDTimeStepControl::setState( const std::vector< double >& state )
+    {
+        if( state.size() != errors_.size() )
+            OPM_THROW(std::runtime_error, "PIDTimeStepControl: state has " << state.size() << " values, expected " << errors_.size() );
+        errors_ = state;
+    }
+
 
 
     ////////////////////////////////////////////////////////////
@@ -155,4 +168,137 @@ namespace Opm
         return dtEstimate;
     }
 
+
+
+    ////////////////////////////////////////////////////////////
+    //
+    //  NewtonRateTimeStepControl  Implementation
+    //
+    ////////////////////////////////////////////////////////////
+
+    NewtonRateTimeStepControl::
+    NewtonRateTimeStepControl( const int target_iterations,
+                               const int max_iterations,
+                               const double residual_tol,
+                               const double min_decay,
+                               const double max_growth,
+                               const bool verbose )
+        : target_iterations_( target_iterations )
+        , max_iterations_( max_iterations )
+        , residual_tol_( residual_tol )
+        , min_decay_( min_decay )
+        , max_growth_( max_growth )
+        , verbose_( verbose )
+        , failed_steps_( 0 )
+        , wasted_iterations_( 0 )
+    {
+        if( target_iterations_ < 1 || max_iterations_ < target_iterations_ ) {
+            OPM_THROW(std::runtime_error,"NewtonRateTimeStepControl: need 1 <= target iterations <= max iterations, got "
+                      << target_iterations_ << " and " << max_iterations_ );
+        }
+        if( !(residual_tol_ > 0.0) ) {
+            OPM_THROW(std::runtime_error,"NewtonRateTimeStepControl: residual tolerance should be > 0 " << residual_tol_ );
+        }
+        if( min_decay_ > 1.0 ) {
+            OPM_THROW(std::runtime_error,"NewtonRateTimeStepControl: decay should be <= 1 " << min_decay_ );
+        }
+        if( max_growth_ < 1.0 ) {
+            OPM_THROW(std::runtime_error,"NewtonRateTimeStepControl: growth should be >= 1 " << max_growth_ );
+        }
+    }
+
+    void NewtonRateTimeStepControl::beginStep()
+    {
+        if( ! residuals_.empty() ) {
+            failStep();
+        }
+    }
+
+    bool NewtonRateTimeStepControl::addResidual( const double residual )
+    {
+        residuals_.push_back( residual );
+        const int iterations = residuals_.size() - 1;
+        if( iterations < 2 || residual <= residual_tol_ ) {
+            return true;
+        }
+
+        const double rate = residual / residuals_[ iterations-1 ];
+        const double prevRate = residuals_[ iterations-1 ] / residuals_[ iterations-2 ];
+        bool doomed = false;
+        if( !(rate < 1.0) ) {
+            // diverging or stagnating
+            doomed = !(prevRate < 1.0);
+        }
+        else {
+            // iterations still needed at the present rate
+            const double remaining = std::log( residual_tol_ / residual ) / std::log( rate );
+            doomed = iterations + remaining > max_iterations_;
+        }
+
+        if( doomed ) {
+            if( verbose_ )
+                std::cout << "Giving up time step after " << iterations << " iterations, residual reduction rate " << rate << std::endl;
+            failStep();
+            return false;
+        }
+        return true;
+    }
+
+    bool NewtonRateTimeStepControl::iterationDone( const int iteration, const double residual )
+    {
+        if( iteration == 0 ) {
+            beginStep();
+        }
+        return addResidual( residual );
+    }
+
+    void NewtonRateTimeStepControl::failStep()
+    {
+        ++failed_steps_;
+        wasted_iterations_ += std::max( int(residuals_.size()) - 1, 0 );
+        residuals_.clear();
+    }
+
+    double NewtonRateTimeStepControl::
+    computeTimeStepSize( const double dt, const int iterations, const RelativeChangeInterface& /* relativeChange */ ) const
+    {
+        double factor = max_growth_;
+        const int newtonIterations = int(residuals_.size()) - 1;
+        if( newtonIterations >= 1 && residuals_.front() > residual_tol_
+            && residuals_.back() > 0.0 && residuals_.back() < residuals_.front() )
+        {
+            // mean and target reduction of the residual per iteration
+            const double rate       = std::pow( residuals_.back() / residuals_.front(), 1.0 / newtonIterations );
+            const double targetRate = std::pow( residual_tol_ / residuals_.front(), 1.0 / target_iterations_ );
+            factor = std::log( rate ) / std::log( targetRate );
+        }
+        else if( newtonIterations < 1 && iterations > 0 )
+        {
+            factor = double( target_iterations_ ) / double( iterations );
+        }
+        residuals_.clear();
+
+        factor = std::max( min_decay_, std::min( max_growth_, factor ) );
+        if( verbose_ )
+            std::cout << "Computed step size (newton rate): " << unit::convert::to( dt * factor, unit::day ) << " (days)" << std::endl;
+        return dt * factor;
+    }
+
+    std::vector< double > NewtonRateTimeStepControl::state() const
+    {
+        std::vector< double > state( 1, failed_steps_ );
+        state.push_back( wasted_iterations_ );
+        state.insert( state.end(), residuals_.begin(), residuals_.end() );
+        return state;
+    }
+
+    void NewtonRateTimeStepControl::setState( const std::vector< double >& state )
+    {
+        if( state.size() < 2 )
+            OPM_THROW(std::runtime_error, "NewtonRateTimeStepControl: state has " << state.size() << " values, expected at least 2" );
+        failed_steps_      = int( state[ 0 ] );
+        wasted_iterations_ = int( state[ 1 ] );
+        residuals_.assign( state.begin() + 2, state.end() );
+    }
+
 } // end namespace Opm
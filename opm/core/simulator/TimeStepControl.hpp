@@ -84,6 +84,12 @@ namespace Opm
         /// \brief \copydoc TimeStepControlInterface::computeTimeStepSize
         double computeTimeStepSize( const double dt, const int /* iterations */, const RelativeChangeInterface& relativeChange ) const;
 
+        /// \brief \copydoc TimeStepControlInterface::state
+        std::vector< double > state() const;
+
+        /// \brief \copydoc TimeStepControlInterface::setState
+        void setState( const std::vector< double >& state );
+
     protected:
         const double tol_;
         mutable std::vector< double > errors_;
@@ -117,6 +123,88 @@ namespace Opm
         const int     target_iterations_;
     };
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ///
+    ///  Time step control based on the convergence rate of the Newton iterations.
+    ///
+    ///  The nonlinear solver reports the residual norm before the first and after
+    ///  each iteration through addResidual(). Once the residual has grown in two
+    ///  consecutive iterations, or the observed rate predicts that the tolerance
+    ///  will not be met within the maximum number of iterations, addResidual()
+    ///  returns false and the solver should give up the step rather than iterate
+    ///  to the end. After a converged step, the next step size is the current one
+    ///  scaled by log(rate)/log(target rate), where rate is the mean residual
+    ///  reduction per iteration and the target rate the reduction that reaches the
+    ///  tolerance in the target number of iterations. Without residuals, the step
+    ///  size is scaled by the ratio of target to actual iterations.
+    ///
+    ///  Solvers that accept a NewtonIterationMonitorInterface can be given this
+    ///  control directly, in which case a step starts with its initial residual.
+    ///
+    ///  Iterations of steps that were given up or failed otherwise are counted as
+    ///  wasted, see failedSteps() and wastedIterations().
+    //
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    class NewtonRateTimeStepControl : public TimeStepControlInterface,
+                                      public NewtonIterationMonitorInterface
+    {
+    public:
+        /// \brief constructor
+        /// \param target_iterations  desired number of Newton iterations per time step
+        /// \param max_iterations     maximum number of Newton iterations of the solver
+        /// \param residual_tol       residual norm at which the solver has converged
+        /// \param min_decay          lower bound of the factor applied to the step size (should be <= 1)
+        /// \param max_growth         upper bound of the factor applied to the step size (should be >= 1)
+        /// \param verbose            if true get some output (default = false)
+        NewtonRateTimeStepControl( const int target_iterations,
+                                   const int max_iterations,
+                                   const double residual_tol,
+                                   const double min_decay = 0.25,
+                                   const double max_growth = 2.0,
+                                   const bool verbose = false );
+
+        /// \brief start a new time step. If the previous step neither converged
+        ///        nor was given up, it is counted as failed.
+        void beginStep();
+
+        /// \brief record the residual norm of the current iterate
+        /// \return false if the step should be given up
+        bool addResidual( const double residual );
+
+        /// \brief \copydoc NewtonIterationMonitorInterface::iterationDone
+        bool iterationDone( const int iteration, const double residual );
+
+        /// \brief \copydoc TimeStepControlInterface::computeTimeStepSize
+        double computeTimeStepSize( const double dt, const int iterations, const RelativeChangeInterface& /* relativeChange */ ) const;
+
+        /// \brief \copydoc TimeStepControlInterface::state
+        std::vector< double > state() const;
+
+        /// \brief \copydoc TimeStepControlInterface::setState
+        void setState( const std::vector< double >& state );
+
+        /// \brief number of time steps that were given up or failed
+        int failedSteps() const { return failed_steps_; }
+
+        /// \brief number of Newton iterations spent in failed time steps
+        int wastedIterations() const { return wasted_iterations_; }
+
+    protected:
+        void failStep();
+
+        const int     target_iterations_;
+        const int     max_iterations_;
+        const double  residual_tol_;
+        const double  min_decay_;
+        const double  max_growth_;
+        const bool    verbose_;
+
+        // residual norms of the current step, cleared when it ends
+        mutable std::vector< double > residuals_;
+        int failed_steps_;
+        int wasted_iterations_;
+    };
+
 
 } // end namespace Opm
 #endif
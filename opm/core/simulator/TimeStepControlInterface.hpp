@@ -19,6 +19,7 @@
 #ifndef OPM_TIMESTEPCONTROLINTERFACE_HEADER_INCLUDED
 #define OPM_TIMESTEPCONTROLINTERFACE_HEADER_INCLUDED
 
+#include <vector>
 
 namespace Opm
 {
@@ -58,9 +59,39 @@ namespace Opm
         /// \return suggested time step size for the next step
         virtual double computeTimeStepSize( const double dt, const int iterations, const RelativeChangeInterface& relativeChange ) const = 0;
 
+        /// \return the history the controller keeps between time steps, for checkpoints
+        virtual std::vector< double > state() const { return std::vector< double >(); }
+
+        /// restore the history from a checkpoint
+        /// \param state  values returned by state() of a controller of the same type
+        virtual void setState( const std::vector< double >& /* state */ ) {}
+
         /// virtual destructor (empty)
         virtual ~TimeStepControlInterface () {}
     };
 
+    ///////////////////////////////////////////////////////////////////
+    ///
+    ///  NewtonIterationMonitorInterface
+    ///
+    ///////////////////////////////////////////////////////////////////
+    class NewtonIterationMonitorInterface
+    {
+    protected:
+        NewtonIterationMonitorInterface() {}
+    public:
+        /// called by a nonlinear solver for the initial residual of a time
+        /// step and after each of its Newton iterations
+        /// \param iteration  number of iterations done, 0 for the initial residual
+        /// \param residual   residual norm of the current iterate
+        ///
+        /// \return false if the solver should give up the time step, which
+        ///         it signals like any other convergence failure
+        virtual bool iterationDone( const int iteration, const double residual ) = 0;
+
+        /// virtual destructor (empty)
+        virtual ~NewtonIterationMonitorInterface () {}
+    };
+
 }
 #endif
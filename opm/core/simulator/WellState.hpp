@@ -44,6 +44,8 @@ namespace Opm
         /// wellRates() fields, depending on controls.  The
         /// perfRates() field is filled with zero, and perfPress()
         /// with -1e100.
+        /// Storage is reused if the numbers of wells and perforations
+        /// are unchanged, so re-initializing does not reallocate.
         template <class State>
         void init(const Wells* wells, const State& state)
         {
@@ -55,8 +57,8 @@ namespace Opm
                 const int np = wells->number_of_phases;
                 bhp_.resize(nw);
                 thp_.resize(nw);
-                temperature_.resize(nw, 273.15 + 20); // standard temperature for now
-                wellrates_.resize(nw * np, 0.0);
+                temperature_.assign(nw, 273.15 + 20); // standard temperature for now
+                wellrates_.assign(nw * np, 0.0);
                 for (int w = 0; w < nw; ++w) {
                     assert((wells->type[w] == INJECTOR) || (wells->type[w] == PRODUCER));
                     const WellControls* ctrl = wells->ctrls[w];
@@ -144,8 +146,8 @@ namespace Opm
                 // The perforation rates and perforation pressures are
                 // not expected to be consistent with bhp_ and wellrates_
                 // after init().
-                perfrates_.resize(wells->well_connpos[nw], 0.0);
-                perfpress_.resize(wells->well_connpos[nw], -1e100);
+                perfrates_.assign(wells->well_connpos[nw], 0.0);
+                perfpress_.assign(wells->well_connpos[nw], -1e100);
             }
         }
 
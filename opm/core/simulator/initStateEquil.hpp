@@ -27,6 +27,7 @@
 #include <opm/core/simulator/BlackoilState.hpp>
 #include <opm/core/props/BlackoilPropertiesInterface.hpp>
 #include <opm/core/props/BlackoilPhases.hpp>
+#include <opm/core/utility/CellRegionIndex.hpp>
 #include <opm/core/utility/RegionMapping.hpp>
 #include <opm/core/utility/Units.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -38,8 +39,11 @@
 #include <opm/parser/eclipse/EclipseState/Tables/RsvdTable.hpp>
 #include <opm/parser/eclipse/EclipseState/Tables/RvvdTable.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -119,6 +123,14 @@ namespace Opm
          * \param[in] cells Range that spans the cells of the current
          *                  equilibration region.
          * \param[in] grav  Acceleration of gravity.
+         * \param[in] sample_depth Additional depths at which to
+         *                  evaluate the phase pressures, typically
+         *                  from subSampleDepths().
+         * \param[out] sample_press If non-null, phase pressures at
+         *                  each of the sample depths, one vector for
+         *                  each active phase.  The pressure tables of
+         *                  the cell centres are reused, so this costs
+         *                  one table evaluation per sample.
          *
          * \return Phase pressures, one vector for each active phase,
          * of pressure values in each cell in the current
@@ -129,7 +141,31 @@ namespace Opm
         phasePressures(const Grid&             G,
                        const Region&           reg,
                        const CellRange&        cells,
-                       const double            grav = unit::gravity);
+                       const double            grav = unit::gravity,
+                       const std::vector<double>& sample_depth = std::vector<double>(),
+                       std::vector< std::vector<double> >* sample_press = 0);
+
+
+
+        /**
+         * Depths of the midpoints of a number of equally thick
+         * horizontal layers in each cell, for evaluating the
+         * saturations of cells that span a transition zone, as does
+         * item 9 of EQUIL.
+         *
+         * \param[in] G           Grid.
+         * \param[in] cells       Range that spans the cells of the current
+         *                        equilibration region.
+         * \param[in] num_samples Number of layers per cell.
+         *
+         * \return Sample depths, num_samples consecutive values for each
+         * cell in the range, from the top down.
+         */
+        template <class Grid, class CellRange>
+        std::vector<double>
+        subSampleDepths(const Grid&      G,
+                        const CellRange& cells,
+                        const int        num_samples);
 
 
 
@@ -154,6 +190,13 @@ namespace Opm
          * \param[in] phase_pressures Phase pressures, one vector for each active phase,
          *                            of pressure values in each cell in the current
          *                            equilibration region.
+         * \param[in] sample_depth    Sample depths from subSampleDepths(), or empty.
+         *                            If given, and there is no SWATINIT, the
+         *                            saturations of each cell are averages over
+         *                            its samples instead of the values at the
+         *                            cell centre.
+         * \param[in] sample_press    Phase pressures at the sample depths,
+         *                            from phasePressures().
          * \return                    Phase saturations, one vector for each phase, each containing
          *                            one saturation value per cell in the region.
          */
@@ -164,7 +207,10 @@ namespace Opm
                          const CellRange&        cells,
                          BlackoilPropertiesInterface& props,
                          const std::vector<double> swat_init,
-                         std::vector< std::vector<double> >& phase_pressures);
+                         std::vector< std::vector<double> >& phase_pressures,
+                         const std::vector<double>& sample_depth = std::vector<double>(),
+                         const std::vector< std::vector<double> >& sample_press
+                         = std::vector< std::vector<double> >());
 
 
 
@@ -216,25 +262,16 @@ namespace Opm
                      const Opm::EclipseStateConstPtr eclipseState,
                      const Grid&  G   )
             {
-                std::vector<int> eqlnum;
                 if (deck->hasKeyword("EQLNUM")) {
-                    const int nc = UgGridHelpers::numCells(G);
-                    eqlnum.resize(nc);
-                    const std::vector<int>& e = 
-                        eclipseState->getIntGridProperty("EQLNUM")->getData();                    
-                    const int* gc = UgGridHelpers::globalCell(G);
-                    for (int cell = 0; cell < nc; ++cell) {
-                        const int deck_pos = (gc == NULL) ? cell : gc[cell];
-                        eqlnum[cell] = e[deck_pos] - 1;
-                    }
+                    return CellRegionIndex::get(eclipseState, "EQLNUM",
+                                                UgGridHelpers::numCells(G),
+                                                UgGridHelpers::globalCell(G))->toInt();
                 }
                 else {
                     // No explicit equilibration region.
                     // All cells in region zero.
-                    eqlnum.assign(UgGridHelpers::numCells(G), 0);
+                    return std::vector<int>(UgGridHelpers::numCells(G), 0);
                 }
-
-                return eqlnum;
             }
 
 
@@ -378,35 +415,68 @@ namespace Opm
                                  const Grid&                       G    ,
                                  const double grav)
                 {
-                    for (const auto& r : reg.activeRegions()) {
-                        const auto& cells = reg.cells(r);
-                        const int repcell = *cells.begin();
-
-                        const RhoCalc calc(props, repcell);
-                        const EqReg eqreg(rec[r], calc,
-                                          rs_func_[r], rv_func_[r],
-                                          props.phaseUsage());
+                    // The regions are independent and write disjoint cells,
+                    // so they are processed in parallel, except with
+                    // SWATINIT, whose scaling modifies the property object.
+                    // With a single region, the cells of the region are
+                    // processed in parallel instead.
+                    const std::vector<int> regions(reg.activeRegions().begin(),
+                                                   reg.activeRegions().end());
+                    const int num_regions = regions.size();
+                    std::string error;
+#pragma omp parallel for schedule(dynamic) if (num_regions > 1 && swat_init_.empty())
+                    for (int ri = 0; ri < num_regions; ++ri) {
+                        try {
+                            const int r = regions[ri];
+                            const auto& cells = reg.cells(r);
+                            const int repcell = *cells.begin();
+
+                            const RhoCalc calc(props, repcell);
+                            const EqReg eqreg(rec[r], calc,
+                                              rs_func_[r], rv_func_[r],
+                                              props.phaseUsage());
                    
-                        PVec pressures = phasePressures(G, eqreg, cells, grav);
-                        const std::vector<double>& temp = temperature(G, eqreg, cells);
+                            // Item 9 of EQUIL: N > 0 requests saturations
+                            // averaged over 2N horizontal layers per cell.
+                            const int accuracy = rec[r].initializationTargetAccuracy();
+                            const int num_samples = (accuracy > 0 && swat_init_.empty())
+                                ? 2*std::min(accuracy, 20) : 0;
+                            std::vector<double> sample_depth;
+                            PVec sample_press;
+                            if (num_samples > 1) {
+                                sample_depth = subSampleDepths(G, cells, num_samples);
+                            }
+
+                            PVec pressures = phasePressures(G, eqreg, cells, grav, sample_depth,
+                                                            num_samples > 1 ? &sample_press : 0);
+                            const std::vector<double>& temp = temperature(G, eqreg, cells);
 
-                        const PVec sat = phaseSaturations(G, eqreg, cells, props, swat_init_, pressures);
+                            const PVec sat = phaseSaturations(G, eqreg, cells, props, swat_init_, pressures,
+                                                              sample_depth, sample_press);
 
-                        const int np = props.numPhases();
-                        for (int p = 0; p < np; ++p) {
-                            copyFromRegion(pressures[p], cells, pp_[p]);
-                            copyFromRegion(sat[p], cells, sat_[p]);
+                            const int np = props.numPhases();
+                            for (int p = 0; p < np; ++p) {
+                                copyFromRegion(pressures[p], cells, pp_[p]);
+                                copyFromRegion(sat[p], cells, sat_[p]);
+                            }
+                            if (props.phaseUsage().phase_used[BlackoilPhases::Liquid]
+                                && props.phaseUsage().phase_used[BlackoilPhases::Vapour]) {
+                                const int oilpos = props.phaseUsage().phase_pos[BlackoilPhases::Liquid];
+                                const int gaspos = props.phaseUsage().phase_pos[BlackoilPhases::Vapour];
+                                const Vec rs_vals = computeRs(G, cells, pressures[oilpos], temp, *(rs_func_[r]), sat[gaspos]);
+                                const Vec rv_vals = computeRs(G, cells, pressures[gaspos], temp, *(rv_func_[r]), sat[oilpos]);
+                                copyFromRegion(rs_vals, cells, rs_);
+                                copyFromRegion(rv_vals, cells, rv_);
+                            }
                         }
-                        if (props.phaseUsage().phase_used[BlackoilPhases::Liquid]
-                            && props.phaseUsage().phase_used[BlackoilPhases::Vapour]) {
-                            const int oilpos = props.phaseUsage().phase_pos[BlackoilPhases::Liquid];
-                            const int gaspos = props.phaseUsage().phase_pos[BlackoilPhases::Vapour];
-                            const Vec rs_vals = computeRs(G, cells, pressures[oilpos], temp, *(rs_func_[r]), sat[gaspos]);
-                            const Vec rv_vals = computeRs(G, cells, pressures[gaspos], temp, *(rv_func_[r]), sat[oilpos]);
-                            copyFromRegion(rs_vals, cells, rs_);
-                            copyFromRegion(rv_vals, cells, rv_);
+                        catch (const std::exception& e) {
+#pragma omp critical
+                            error = e.what();
                         }
                     }
+                    if (!error.empty()) {
+                        OPM_THROW(std::runtime_error, error);
+                    }
                 }
 
                 template <class CellRangeType>
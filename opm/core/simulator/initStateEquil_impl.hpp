@@ -27,9 +27,13 @@
 #include <opm/core/props/BlackoilPhases.hpp>
 #include <opm/core/simulator/initState.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace Opm
@@ -105,6 +109,153 @@ namespace Opm
             stepsize() const { return (span_[1] - span_[0]) / N_; }
         };
 
+        /// Solution of an initial value problem y' = f(x, y) over an
+        /// interval, by the embedded Runge-Kutta pair of Dormand and
+        /// Prince (RK5(4)7M) with adaptive step size.
+        ///
+        /// Steps are chosen so that the local error estimate of each
+        /// step is within atol + rtol*|y|, so a steep or kinked right
+        /// hand side, e.g. from RSVD or RVVD tables, gets small steps
+        /// only where needed. The solution is stored as the fourth
+        /// order continuous extension of each step, and can be
+        /// evaluated anywhere in the interval, concurrently from
+        /// several threads. Outside the interval, the first or last
+        /// step is extrapolated.
+        template <class RHS>
+        class DormandPrinceIVP {
+        public:
+            /// \param[in] f     Right hand side, f(x, y).
+            /// \param[in] span  Start and end of the interval; the end
+            ///                  may be below the start.
+            /// \param[in] y0    Value at the start.
+            /// \param[in] rtol  Relative error tolerance per step.
+            /// \param[in] atol  Absolute error tolerance per step.
+            DormandPrinceIVP(const RHS&                  f   ,
+                             const std::array<double,2>& span,
+                             const double                y0  ,
+                             const double                rtol = 1e-10,
+                             const double                atol = 1e-6)
+                : x0_(span[0])
+                , y0_(y0)
+                , dir_(span[1] < span[0] ? -1.0 : 1.0)
+            {
+                const double length = std::abs(span[1] - span[0]);
+                if (!(length > 0.0)) {
+                    return;
+                }
+
+                // Butcher tableau, error and dense output coefficients.
+                static const double c2 = 1.0/5, c3 = 3.0/10, c4 = 4.0/5, c5 = 8.0/9;
+                static const double a21 = 1.0/5;
+                static const double a31 = 3.0/40, a32 = 9.0/40;
+                static const double a41 = 44.0/45, a42 = -56.0/15, a43 = 32.0/9;
+                static const double a51 = 19372.0/6561, a52 = -25360.0/2187,
+                    a53 = 64448.0/6561, a54 = -212.0/729;
+                static const double a61 = 9017.0/3168, a62 = -355.0/33,
+                    a63 = 46732.0/5247, a64 = 49.0/176, a65 = -5103.0/18656;
+                static const double a71 = 35.0/384, a73 = 500.0/1113,
+                    a74 = 125.0/192, a75 = -2187.0/6784, a76 = 11.0/84;
+                static const double e1 = 71.0/57600, e3 = -71.0/16695,
+                    e4 = 71.0/1920, e5 = -17253.0/339200, e6 = 22.0/525, e7 = -1.0/40;
+                static const double d1 = -12715105075.0/11282082432.0,
+                    d3 = 87487479700.0/32700410799.0, d4 = -10690763975.0/1880347072.0,
+                    d5 = 701980252875.0/199316789632.0, d6 = -1453857185.0/822651844.0,
+                    d7 = 69997945.0/29380423.0;
+
+                const int max_steps = 100000;
+                double x = span[0];
+                double y = y0;
+                double k1 = f(x, y);
+                double h = dir_ * length / 100;
+                double s = 0.0; // distance from the start
+                while (s < length) {
+                    bool last = false;
+                    if (s + std::abs(h) >= length) {
+                        h = dir_ * (length - s);
+                        last = true;
+                    }
+                    const double k2 = f(x + c2*h, y + h*a21*k1);
+                    const double k3 = f(x + c3*h, y + h*(a31*k1 + a32*k2));
+                    const double k4 = f(x + c4*h, y + h*(a41*k1 + a42*k2 + a43*k3));
+                    const double k5 = f(x + c5*h, y + h*(a51*k1 + a52*k2 + a53*k3 + a54*k4));
+                    const double k6 = f(x + h, y + h*(a61*k1 + a62*k2 + a63*k3 + a64*k4 + a65*k5));
+                    const double y1 = y + h*(a71*k1 + a73*k3 + a74*k4 + a75*k5 + a76*k6);
+                    const double k7 = f(x + h, y1);
+
+                    const double err = h*(e1*k1 + e3*k3 + e4*k4 + e5*k5 + e6*k6 + e7*k7);
+                    const double sc = atol + rtol*std::max(std::abs(y), std::abs(y1));
+                    const double errn = std::abs(err) / sc;
+                    const double fac = (errn > 0.0)
+                        ? std::min(5.0, std::max(0.2, 0.9*std::pow(errn, -0.2)))
+                        : 5.0;
+
+                    if (errn <= 1.0 || std::abs(h) <= 1e-12*length) {
+                        Step step;
+                        step.s = s;
+                        step.h = h;
+                        const double ydiff = y1 - y;
+                        const double bspl = h*k1 - ydiff;
+                        step.r[0] = y;
+                        step.r[1] = ydiff;
+                        step.r[2] = bspl;
+                        step.r[3] = ydiff - h*k7 - bspl;
+                        step.r[4] = h*(d1*k1 + d3*k3 + d4*k4 + d5*k5 + d6*k6 + d7*k7);
+                        steps_.push_back(step);
+
+                        s = last ? length : s + std::abs(h);
+                        x += h;
+                        y = y1;
+                        k1 = k7;
+                        if (int(steps_.size()) > max_steps) {
+                            OPM_THROW(std::runtime_error, "Too many steps integrating the phase pressure");
+                        }
+                    }
+                    h *= fac;
+                }
+            }
+
+            double
+            operator()(const double x) const
+            {
+                if (steps_.empty()) {
+                    return y0_;
+                }
+                const double s = dir_ * (x - x0_);
+
+                // Step containing x, the first or last when outside.
+                std::size_t lo = 0;
+                std::size_t hi = steps_.size();
+                while (hi - lo > 1) {
+                    const std::size_t mid = (lo + hi) / 2;
+                    if (steps_[mid].s <= s) {
+                        lo = mid;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                const Step& step = steps_[lo];
+                const double theta = (s - step.s) / std::abs(step.h);
+                const double theta1 = 1.0 - theta;
+                const double* r = step.r;
+                return r[0] + theta*(r[1] + theta1*(r[2] + theta*(r[3] + theta1*r[4])));
+            }
+
+            /// Number of steps taken.
+            int numSteps() const { return steps_.size(); }
+
+        private:
+            struct Step {
+                double s;    // distance of the start from the start of the interval
+                double h;    // signed step length
+                double r[5]; // coefficients of the continuous extension
+            };
+
+            double            x0_;
+            double            y0_;
+            double            dir_;
+            std::vector<Step> steps_;
+        };
+
         namespace PhasePressODE {
             template <class Density>
             class Water {
@@ -316,18 +467,36 @@ namespace Opm
 
                 enum { up = 0, down = 1 };
 
-                std::vector<double>::size_type c = 0;
-                for (typename CellRange::const_iterator
-                         ci = cells.begin(), ce = cells.end();
-                     ci != ce; ++ci, ++c)
-                {
-                    assert (c < p.size());
+                const std::vector<int> cell_list(cells.begin(), cells.end());
+                const int ncell = cell_list.size();
+                assert (std::vector<double>::size_type(ncell) <= p.size());
 
-                    const double z = UgGridHelpers::cellCenterDepth(G, *ci);
+#pragma omp parallel for schedule(static)
+                for (int c = 0; c < ncell; ++c) {
+                    const double z = UgGridHelpers::cellCenterDepth(G, cell_list[c]);
                     p[c] = (z < split) ? f[up](z) : f[down](z);
                 }
             }
 
+            template <class PressFunction>
+            void
+            assign(const std::array<PressFunction, 2>& f    ,
+                   const double                        split,
+                   const std::vector<double>&          depth,
+                   std::vector<double>&                p    )
+            {
+                enum { up = 0, down = 1 };
+
+                const int n = depth.size();
+                p.resize(n);
+
+#pragma omp parallel for schedule(static)
+                for (int i = 0; i < n; ++i) {
+                    const double z = depth[i];
+                    p[i] = (z < split) ? f[up](z) : f[down](z);
+                }
+            }
+
             template <class Grid,
                       class Region,
                       class CellRange>
@@ -338,7 +507,9 @@ namespace Opm
                   const double                grav  ,
                   double&                     po_woc,
                   const CellRange&            cells ,
-                  std::vector<double>&        press )
+                  std::vector<double>&        press ,
+                  const std::vector<double>&  sample_depth,
+                  std::vector<double>*        sample_press)
             {
                 using PhasePressODE::Water;
                 typedef Water<typename Region::CalcDensity> ODE;
@@ -362,16 +533,19 @@ namespace Opm
                 std::array<double,2> up   = {{ z0, span[0] }};
                 std::array<double,2> down = {{ z0, span[1] }};
 
-                typedef Details::RK4IVP<ODE> WPress;
+                typedef Details::DormandPrinceIVP<ODE> WPress;
                 std::array<WPress,2> wpress = {
                     {
-                        WPress(drho, up  , p0, 2000)
+                        WPress(drho, up  , p0)
                         ,
-                        WPress(drho, down, p0, 2000)
+                        WPress(drho, down, p0)
                     }
                 };
 
                 assign(G, wpress, z0, cells, press);
+                if (sample_press) {
+                    assign(wpress, z0, sample_depth, *sample_press);
+                }
 
                 if (reg.datum() > reg.zwoc()) {
                     // Return oil pressure at contact
@@ -390,7 +564,9 @@ namespace Opm
                 const CellRange&            cells ,
                 std::vector<double>&        press ,
                 double&                     po_woc,
-                double&                     po_goc)
+                double&                     po_goc,
+                const std::vector<double>&  sample_depth,
+                std::vector<double>*        sample_press)
             {
                 using PhasePressODE::Oil;
                 typedef Oil<typename Region::CalcDensity,
@@ -422,16 +598,19 @@ namespace Opm
                 std::array<double,2> up   = {{ z0, span[0] }};
                 std::array<double,2> down = {{ z0, span[1] }};
 
-                typedef Details::RK4IVP<ODE> OPress;
+                typedef Details::DormandPrinceIVP<ODE> OPress;
                 std::array<OPress,2> opress = {
                     {
-                        OPress(drho, up  , p0, 2000)
+                        OPress(drho, up  , p0)
                         ,
-                        OPress(drho, down, p0, 2000)
+                        OPress(drho, down, p0)
                     }
                 };
 
                 assign(G, opress, z0, cells, press);
+                if (sample_press) {
+                    assign(opress, z0, sample_depth, *sample_press);
+                }
 
                 const double woc = reg.zwoc();
                 if      (z0 > woc) { po_woc = opress[0](woc); } // WOC above datum
@@ -454,7 +633,9 @@ namespace Opm
                 const double                grav  ,
                 double&                     po_goc,
                 const CellRange&            cells ,
-                std::vector<double>&        press )
+                std::vector<double>&        press ,
+                const std::vector<double>&  sample_depth,
+                std::vector<double>*        sample_press)
             {
                 using PhasePressODE::Gas;
                 typedef Gas<typename Region::CalcDensity,
@@ -484,16 +665,19 @@ namespace Opm
                 std::array<double,2> up   = {{ z0, span[0] }};
                 std::array<double,2> down = {{ z0, span[1] }};
 
-                typedef Details::RK4IVP<ODE> GPress;
+                typedef Details::DormandPrinceIVP<ODE> GPress;
                 std::array<GPress,2> gpress = {
                     {
-                        GPress(drho, up  , p0, 2000)
+                        GPress(drho, up  , p0)
                         ,
-                        GPress(drho, down, p0, 2000)
+                        GPress(drho, down, p0)
                     }
                 };
 
                 assign(G, gpress, z0, cells, press);
+                if (sample_press) {
+                    assign(gpress, z0, sample_depth, *sample_press);
+                }
 
                 if (reg.datum() < reg.zgoc()) {
                     // Return oil pressure at contact
@@ -511,7 +695,9 @@ namespace Opm
                        const double                        grav,
                        const std::array<double,2>&         span,
                        const CellRange&                    cells,
-                       std::vector< std::vector<double> >& press)
+                       std::vector< std::vector<double> >& press,
+                       const std::vector<double>&          sample_depth,
+                       std::vector< std::vector<double> >* sample_press)
         {
             const PhaseUsage& pu = reg.phaseUsage();
 
@@ -522,19 +708,22 @@ namespace Opm
                 if (PhaseUsed::water(pu)) {
                     const int wix = PhaseIndex::water(pu);
                     PhasePressure::water(G, reg, span, grav, po_woc,
-                                         cells, press[ wix ]);
+                                         cells, press[ wix ], sample_depth,
+                                         sample_press ? &(*sample_press)[ wix ] : 0);
                 }
 
                 if (PhaseUsed::oil(pu)) {
                     const int oix = PhaseIndex::oil(pu);
                     PhasePressure::oil(G, reg, span, grav, cells,
-                                       press[ oix ], po_woc, po_goc);
+                                       press[ oix ], po_woc, po_goc, sample_depth,
+                                       sample_press ? &(*sample_press)[ oix ] : 0);
                 }
 
                 if (PhaseUsed::gas(pu)) {
                     const int gix = PhaseIndex::gas(pu);
                     PhasePressure::gas(G, reg, span, grav, po_goc,
-                                       cells, press[ gix ]);
+                                       cells, press[ gix ], sample_depth,
+                                       sample_press ? &(*sample_press)[ gix ] : 0);
                 }
             } else if (reg.datum() < reg.zgoc()) { // Datum in gas zone
                 double po_woc = -1;
@@ -543,19 +732,22 @@ namespace Opm
                 if (PhaseUsed::gas(pu)) {
                     const int gix = PhaseIndex::gas(pu);
                     PhasePressure::gas(G, reg, span, grav, po_goc,
-                                       cells, press[ gix ]);
+                                       cells, press[ gix ], sample_depth,
+                                       sample_press ? &(*sample_press)[ gix ] : 0);
                 }
 
                 if (PhaseUsed::oil(pu)) {
                     const int oix = PhaseIndex::oil(pu);
                     PhasePressure::oil(G, reg, span, grav, cells,
-                                       press[ oix ], po_woc, po_goc);
+                                       press[ oix ], po_woc, po_goc, sample_depth,
+                                       sample_press ? &(*sample_press)[ oix ] : 0);
                 }
 
                 if (PhaseUsed::water(pu)) {
                     const int wix = PhaseIndex::water(pu);
                     PhasePressure::water(G, reg, span, grav, po_woc,
-                                         cells, press[ wix ]);
+                                         cells, press[ wix ], sample_depth,
+                                         sample_press ? &(*sample_press)[ wix ] : 0);
                 }
             } else { // Datum in oil zone
                 double po_woc = -1;
@@ -564,19 +756,22 @@ namespace Opm
                 if (PhaseUsed::oil(pu)) {
                     const int oix = PhaseIndex::oil(pu);
                     PhasePressure::oil(G, reg, span, grav, cells,
-                                       press[ oix ], po_woc, po_goc);
+                                       press[ oix ], po_woc, po_goc, sample_depth,
+                                       sample_press ? &(*sample_press)[ oix ] : 0);
                 }
 
                 if (PhaseUsed::water(pu)) {
                     const int wix = PhaseIndex::water(pu);
                     PhasePressure::water(G, reg, span, grav, po_woc,
-                                         cells, press[ wix ]);
+                                         cells, press[ wix ], sample_depth,
+                                         sample_press ? &(*sample_press)[ wix ] : 0);
                 }
 
                 if (PhaseUsed::gas(pu)) {
                     const int gix = PhaseIndex::gas(pu);
                     PhasePressure::gas(G, reg, span, grav, po_goc,
-                                       cells, press[ gix ]);
+                                       cells, press[ gix ], sample_depth,
+                                       sample_press ? &(*sample_press)[ gix ] : 0);
                 }
             }
         }
@@ -593,7 +788,9 @@ namespace Opm
         phasePressures(const Grid&             G,
                        const Region&           reg,
                        const CellRange&        cells,
-                       const double            grav)
+                       const double            grav,
+                       const std::vector<double>& sample_depth,
+                       std::vector< std::vector<double> >* sample_press)
         {
             std::array<double,2> span =
                 {{  std::numeric_limits<double>::max() ,
@@ -654,11 +851,56 @@ namespace Opm
             span[0] = std::min(span[0],zgoc);
             span[1] = std::max(span[1],zwoc);
 
-            Details::equilibrateOWG(G, reg, grav, span, cells, press);
+            if (sample_press) {
+                sample_press->assign(np, pval(sample_depth.size(), 0.0));
+            }
+
+            Details::equilibrateOWG(G, reg, grav, span, cells, press,
+                                    sample_depth, sample_press);
 
             return press;
         }
 
+        template <class Grid, class CellRange>
+        std::vector<double>
+        subSampleDepths(const Grid&      G,
+                        const CellRange& cells,
+                        const int        num_samples)
+        {
+            assert (UgGridHelpers::dimensions(G) == 3);
+
+            const int nd = UgGridHelpers::dimensions(G);
+            auto cell2Faces = UgGridHelpers::cell2Faces(G);
+            auto faceVertices = UgGridHelpers::face2Vertices(G);
+
+            std::vector<double> depth;
+            depth.reserve(cells.size() * num_samples);
+            for (typename CellRange::const_iterator
+                     ci = cells.begin(), ce = cells.end();
+                 ci != ce; ++ci)
+            {
+                double zmin =  std::numeric_limits<double>::max();
+                double zmax = -std::numeric_limits<double>::max();
+                for (auto fi = cell2Faces[*ci].begin(), fe = cell2Faces[*ci].end();
+                     fi != fe; ++fi)
+                {
+                    for (auto i = faceVertices[*fi].begin(), e = faceVertices[*fi].end();
+                         i != e; ++i)
+                    {
+                        const double z = UgGridHelpers::vertexCoordinates(G, *i)[nd-1];
+                        zmin = std::min(zmin, z);
+                        zmax = std::max(zmax, z);
+                    }
+                }
+                // Midpoints of equally thick horizontal layers.
+                const double dz = (zmax - zmin) / num_samples;
+                for (int j = 0; j < num_samples; ++j) {
+                    depth.push_back(zmin + (j + 0.5)*dz);
+                }
+            }
+            return depth;
+        }
+
         template <class Grid,
                   class Region,
                   class CellRange>
@@ -678,118 +920,251 @@ namespace Opm
                          const CellRange&        cells,
                          BlackoilPropertiesInterface& props,
                          const std::vector<double> swat_init,
-                         std::vector< std::vector<double> >& phase_pressures)
+                         std::vector< std::vector<double> >& phase_pressures,
+                         const std::vector<double>& sample_depth,
+                         const std::vector< std::vector<double> >& sample_press)
         {
             if (!reg.phaseUsage().phase_used[BlackoilPhases::Liquid]) {
                 OPM_THROW(std::runtime_error, "Cannot initialise: not handling water-gas cases.");
             }
 
             std::vector< std::vector<double> > phase_saturations = phase_pressures; // Just to get the right size.
-            double smin[BlackoilPhases::MaxNumPhases] = { 0.0 };
-            double smax[BlackoilPhases::MaxNumPhases] = { 0.0 };
 
             const bool water = reg.phaseUsage().phase_used[BlackoilPhases::Aqua];
             const bool gas = reg.phaseUsage().phase_used[BlackoilPhases::Vapour];
             const int oilpos = reg.phaseUsage().phase_pos[BlackoilPhases::Liquid];
             const int waterpos = reg.phaseUsage().phase_pos[BlackoilPhases::Aqua];
             const int gaspos = reg.phaseUsage().phase_pos[BlackoilPhases::Vapour];
-            std::vector<double>::size_type local_index = 0;
-            for (typename CellRange::const_iterator ci = cells.begin(); ci != cells.end(); ++ci, ++local_index) {
-                const int cell = *ci;
-                props.satRange(1, &cell, smin, smax);
-                // Find saturations from pressure differences by
-                // inverting capillary pressure functions.
-                double sw = 0.0;
+
+            // Invert the capillary pressure functions for all cells at
+            // once; the loop below only picks the saturations.
+            const std::vector<int> cell_list(cells.begin(), cells.end());
+            const std::vector<double>::size_type ncell = cell_list.size();
+            const int num_cells = ncell;
+            const int num_samples = (ncell > 0) ? sample_depth.size() / ncell : 0;
+            const bool subsampled = (num_samples > 1) && swat_init.empty();
+            std::vector<double> sw_pc(ncell, 0.0);
+            std::vector<double> sg_pc(ncell, 0.0);
+            std::unique_ptr<SatFromPcBatch> water_inv;
+            std::unique_ptr<SatFromPcBatch> gas_inv;
+            if (water && !subsampled) {
+                water_inv.reset(new SatFromPcBatch(props, waterpos, cell_list));
+                std::vector<double> pcov(ncell);
+                std::vector<char> active(ncell);
+                for (std::vector<double>::size_type i = 0; i < ncell; ++i) {
+                    pcov[i] = phase_pressures[oilpos][i] - phase_pressures[waterpos][i];
+                    active[i] = swat_init.empty() && !water_inv->isConstPc(i);
+                }
+                water_inv->solve(pcov, active, sw_pc);
+            }
+            if (gas && !subsampled) {
+                // pcog(sg) expected to be increasing function
+                gas_inv.reset(new SatFromPcBatch(props, gaspos, cell_list, true));
+                std::vector<double> pcog(ncell);
+                std::vector<char> active(ncell);
+                for (std::vector<double>::size_type i = 0; i < ncell; ++i) {
+                    pcog[i] = phase_pressures[gaspos][i] - phase_pressures[oilpos][i];
+                    active[i] = !gas_inv->isConstPc(i);
+                }
+                gas_inv->solve(pcog, active, sg_pc);
+            }
+
+            // With sub-sampling, the saturations of a cell are the
+            // averages of the saturations at the sample depths, whose
+            // capillary pressures are inverted in one batch as well.
+            std::vector<double> sw_avg(subsampled ? ncell : 0, 0.0);
+            std::vector<double> sg_avg(subsampled ? ncell : 0, 0.0);
+            if (subsampled) {
+                const int nsample = num_cells * num_samples;
+                std::vector<int> sample_cells(nsample);
+                for (int i = 0; i < nsample; ++i) {
+                    sample_cells[i] = cell_list[i / num_samples];
+                }
+                std::vector<double> sw_s(nsample, 0.0);
+                std::vector<double> sg_s(nsample, 0.0);
+                std::unique_ptr<SatFromPcBatch> water_sinv;
+                std::unique_ptr<SatFromPcBatch> gas_sinv;
                 if (water) {
-                    if (isConstPc(props,waterpos,cell)){
-                        const double cellDepth  =  UgGridHelpers::cellCenterDepth(G,
-                                                                            cell);
-                        sw = satFromDepth(props,cellDepth,reg.zwoc(),waterpos,cell,false);
-                        phase_saturations[waterpos][local_index] = sw;
-                    }
-                    else{
-                        const double pcov = phase_pressures[oilpos][local_index] - phase_pressures[waterpos][local_index];
-                        if (swat_init.empty()) { // Invert Pc to find sw
-                            sw = satFromPc(props, waterpos, cell, pcov);
-                            phase_saturations[waterpos][local_index] = sw;
-                        } else { // Scale Pc to reflect imposed sw
-                            sw = swat_init[cell];
-                            props.swatInitScaling(cell, pcov, sw);
-                            phase_saturations[waterpos][local_index] = sw;
-                        }
+                    water_sinv.reset(new SatFromPcBatch(props, waterpos, sample_cells));
+                    std::vector<double> pcov(nsample);
+                    std::vector<char> active(nsample);
+                    for (int i = 0; i < nsample; ++i) {
+                        pcov[i] = sample_press[oilpos][i] - sample_press[waterpos][i];
+                        active[i] = !water_sinv->isConstPc(i);
                     }
+                    water_sinv->solve(pcov, active, sw_s);
                 }
-                double sg = 0.0;
                 if (gas) {
-                    if (isConstPc(props,gaspos,cell)){
-                        const double cellDepth  = UgGridHelpers::cellCenterDepth(G,
-                                                                                        cell);
-                        sg = satFromDepth(props,cellDepth,reg.zgoc(),gaspos,cell,true);
-                        phase_saturations[gaspos][local_index] = sg;
+                    gas_sinv.reset(new SatFromPcBatch(props, gaspos, sample_cells, true));
+                    std::vector<double> pcog(nsample);
+                    std::vector<char> active(nsample);
+                    for (int i = 0; i < nsample; ++i) {
+                        pcog[i] = sample_press[gaspos][i] - sample_press[oilpos][i];
+                        active[i] = !gas_sinv->isConstPc(i);
                     }
-                    else{
-                        // Note that pcog is defined to be (pg - po), not (po - pg).
-                        const double pcog = phase_pressures[gaspos][local_index] - phase_pressures[oilpos][local_index];
-                        const double increasing = true; // pcog(sg) expected to be increasing function
-                        sg = satFromPc(props, gaspos, cell, pcog, increasing);
-                        phase_saturations[gaspos][local_index] = sg;
+                    gas_sinv->solve(pcog, active, sg_s);
+                }
+                std::string error;
+#pragma omp parallel for schedule(dynamic, 64)
+                for (int local_index = 0; local_index < num_cells; ++local_index) {
+                    try {
+                        const int cell = cell_list[local_index];
+                        double sw_sum = 0.0;
+                        double sg_sum = 0.0;
+                        for (int j = 0; j < num_samples; ++j) {
+                            const int s = local_index*num_samples + j;
+                            double sw = 0.0;
+                            if (water) {
+                                sw = water_sinv->isConstPc(s)
+                                    ? satFromDepth(props, sample_depth[s], reg.zwoc(), waterpos, cell, false)
+                                    : sw_s[s];
+                            }
+                            double sg = 0.0;
+                            if (gas) {
+                                sg = gas_sinv->isConstPc(s)
+                                    ? satFromDepth(props, sample_depth[s], reg.zgoc(), gaspos, cell, true)
+                                    : sg_s[s];
+                            }
+                            if (gas && water && (sg + sw > 1.0)) {
+                                const double pcgw = sample_press[gaspos][s] - sample_press[waterpos][s];
+                                sw = satFromSumOfPcs(props, waterpos, gaspos, cell, pcgw);
+                                sg = 1.0 - sw;
+                            }
+                            sw_sum += sw;
+                            sg_sum += sg;
+                        }
+                        sw_avg[local_index] = sw_sum / num_samples;
+                        sg_avg[local_index] = sg_sum / num_samples;
+                    }
+                    catch (const std::exception& e) {
+#pragma omp critical
+                        error = e.what();
                     }
                 }
-                if (gas && water && (sg + sw > 1.0)) {
-                    // Overlapping gas-oil and oil-water transition
-                    // zones can lead to unphysical saturations when
-                    // treated as above. Must recalculate using gas-water
-                    // capillary pressure.
-                    const double pcgw = phase_pressures[gaspos][local_index] - phase_pressures[waterpos][local_index];
-                    if (! swat_init.empty()) { 
-                        // Re-scale Pc to reflect imposed sw for vanishing oil phase.
-                        // This seems consistent with ecl, and fails to honour 
-                        // swat_init in case of non-trivial gas-oil cap pressure.
-                        props.swatInitScaling(cell, pcgw, sw);
+                if (!error.empty()) {
+                    OPM_THROW(std::runtime_error, error);
+                }
+            }
+
+            // The cells are independent, except that SWATINIT scaling
+            // modifies the property object.
+            std::string error;
+#pragma omp parallel for schedule(dynamic, 64) if (swat_init.empty())
+            for (int local_index = 0; local_index < num_cells; ++local_index) {
+                try {
+                    const int cell = cell_list[local_index];
+                    double smin[BlackoilPhases::MaxNumPhases] = { 0.0 };
+                    double smax[BlackoilPhases::MaxNumPhases] = { 0.0 };
+                    props.satRange(1, &cell, smin, smax);
+                    // Find saturations from pressure differences by
+                    // inverting capillary pressure functions.
+                    double sw = 0.0;
+                    if (water && !subsampled) {
+                        if (water_inv->isConstPc(local_index)){
+                            const double cellDepth  =  UgGridHelpers::cellCenterDepth(G,
+                                                                                cell);
+                            sw = satFromDepth(props,cellDepth,reg.zwoc(),waterpos,cell,false);
+                            phase_saturations[waterpos][local_index] = sw;
+                        }
+                        else{
+                            const double pcov = phase_pressures[oilpos][local_index] - phase_pressures[waterpos][local_index];
+                            if (swat_init.empty()) { // Invert Pc to find sw
+                                sw = sw_pc[local_index];
+                                phase_saturations[waterpos][local_index] = sw;
+                            } else { // Scale Pc to reflect imposed sw
+                                sw = swat_init[cell];
+                                props.swatInitScaling(cell, pcov, sw);
+                                phase_saturations[waterpos][local_index] = sw;
+                            }
+                        }
                     }
-                    sw = satFromSumOfPcs(props, waterpos, gaspos, cell, pcgw);
-                    sg = 1.0 - sw;
-                    phase_saturations[waterpos][local_index] = sw;
-                    phase_saturations[gaspos][local_index] = sg;
-                    // Adjust oil pressure according to gas saturation and cap pressure
+                    double sg = 0.0;
+                    if (gas && !subsampled) {
+                        if (gas_inv->isConstPc(local_index)){
+                            const double cellDepth  = UgGridHelpers::cellCenterDepth(G,
+                                                                                            cell);
+                            sg = satFromDepth(props,cellDepth,reg.zgoc(),gaspos,cell,true);
+                            phase_saturations[gaspos][local_index] = sg;
+                        }
+                        else{
+                            // Note that pcog is defined to be (pg - po), not (po - pg).
+                            sg = sg_pc[local_index];
+                            phase_saturations[gaspos][local_index] = sg;
+                        }
+                    }
+                    if (subsampled) {
+                        sw = sw_avg[local_index];
+                        sg = sg_avg[local_index];
+                        if (water) {
+                            phase_saturations[waterpos][local_index] = sw;
+                        }
+                        if (gas) {
+                            phase_saturations[gaspos][local_index] = sg;
+                        }
+                    }
+                    if (gas && water && (sg + sw > 1.0)) {
+                        // Overlapping gas-oil and oil-water transition
+                        // zones can lead to unphysical saturations when
+                        // treated as above. Must recalculate using gas-water
+                        // capillary pressure.
+                        const double pcgw = phase_pressures[gaspos][local_index] - phase_pressures[waterpos][local_index];
+                        if (! swat_init.empty()) { 
+                            // Re-scale Pc to reflect imposed sw for vanishing oil phase.
+                            // This seems consistent with ecl, and fails to honour 
+                            // swat_init in case of non-trivial gas-oil cap pressure.
+                            props.swatInitScaling(cell, pcgw, sw);
+                        }
+                        sw = satFromSumOfPcs(props, waterpos, gaspos, cell, pcgw);
+                        sg = 1.0 - sw;
+                        phase_saturations[waterpos][local_index] = sw;
+                        phase_saturations[gaspos][local_index] = sg;
+                        // Adjust oil pressure according to gas saturation and cap pressure
+                        double pc[BlackoilPhases::MaxNumPhases];
+                        double sat[BlackoilPhases::MaxNumPhases];
+                        sat[waterpos] = sw;
+                        sat[gaspos] = sg;
+                        sat[oilpos] = 1.0 - sat[waterpos] - sat[gaspos];
+                        props.capPress(1, sat, &cell, pc, 0);                   
+                        phase_pressures[oilpos][local_index] = phase_pressures[gaspos][local_index] - pc[gaspos];
+                    }
+                    phase_saturations[oilpos][local_index] = 1.0 - sw - sg;
+                
+                    // Adjust phase pressures for max and min saturation ...
                     double pc[BlackoilPhases::MaxNumPhases];
                     double sat[BlackoilPhases::MaxNumPhases];
-                    sat[waterpos] = sw;
-                    sat[gaspos] = sg;
-                    sat[oilpos] = 1.0 - sat[waterpos] - sat[gaspos];
-                    props.capPress(1, sat, &cell, pc, 0);                   
-                    phase_pressures[oilpos][local_index] = phase_pressures[gaspos][local_index] - pc[gaspos];
-                }
-                phase_saturations[oilpos][local_index] = 1.0 - sw - sg;
-                
-                // Adjust phase pressures for max and min saturation ...
-                double pc[BlackoilPhases::MaxNumPhases];
-                double sat[BlackoilPhases::MaxNumPhases];
-                double threshold_sat = 1.0e-6;
-
-                sat[waterpos] = smax[waterpos];
-                sat[gaspos] = smax[gaspos];
-                sat[oilpos] = 1.0 - sat[waterpos] - sat[gaspos];
-                if (sw > smax[waterpos]-threshold_sat ) {
+                    double threshold_sat = 1.0e-6;
+
                     sat[waterpos] = smax[waterpos];
-                    props.capPress(1, sat, &cell, pc, 0);                   
-                    phase_pressures[oilpos][local_index] = phase_pressures[waterpos][local_index] + pc[waterpos];
-                } else if (sg > smax[gaspos]-threshold_sat) {
                     sat[gaspos] = smax[gaspos];
-                    props.capPress(1, sat, &cell, pc, 0);                   
-                    phase_pressures[oilpos][local_index] = phase_pressures[gaspos][local_index] - pc[gaspos];
-                }
-                if (sg < smin[gaspos]+threshold_sat) {
-                    sat[gaspos] = smin[gaspos];
-                    props.capPress(1, sat, &cell, pc, 0);
-                    phase_pressures[gaspos][local_index] = phase_pressures[oilpos][local_index] + pc[gaspos];
+                    sat[oilpos] = 1.0 - sat[waterpos] - sat[gaspos];
+                    if (sw > smax[waterpos]-threshold_sat ) {
+                        sat[waterpos] = smax[waterpos];
+                        props.capPress(1, sat, &cell, pc, 0);                   
+                        phase_pressures[oilpos][local_index] = phase_pressures[waterpos][local_index] + pc[waterpos];
+                    } else if (sg > smax[gaspos]-threshold_sat) {
+                        sat[gaspos] = smax[gaspos];
+                        props.capPress(1, sat, &cell, pc, 0);                   
+                        phase_pressures[oilpos][local_index] = phase_pressures[gaspos][local_index] - pc[gaspos];
+                    }
+                    if (sg < smin[gaspos]+threshold_sat) {
+                        sat[gaspos] = smin[gaspos];
+                        props.capPress(1, sat, &cell, pc, 0);
+                        phase_pressures[gaspos][local_index] = phase_pressures[oilpos][local_index] + pc[gaspos];
+                    }
+                    if (sw < smin[waterpos]+threshold_sat) {
+                        sat[waterpos] = smin[waterpos];
+                        props.capPress(1, sat, &cell, pc, 0);
+                        phase_pressures[waterpos][local_index] = phase_pressures[oilpos][local_index] - pc[waterpos];
+                    }
                 }
-                if (sw < smin[waterpos]+threshold_sat) {
-                    sat[waterpos] = smin[waterpos];
-                    props.capPress(1, sat, &cell, pc, 0);
-                    phase_pressures[waterpos][local_index] = phase_pressures[oilpos][local_index] - pc[waterpos];
+                catch (const std::exception& e) {
+#pragma omp critical
+                    error = e.what();
                 }
             }
+            if (!error.empty()) {
+                OPM_THROW(std::runtime_error, error);
+            }
             return phase_saturations;
         }
 
@@ -347,6 +347,7 @@ namespace Opm
                 pv.push_back(it->second);
             }
             MonotCubicInterpolator press(zv, pv);
+            press.freeze();
 
             // Evaluate pressure at each cell centroid.
             std::vector<double>& p = state.pressure();
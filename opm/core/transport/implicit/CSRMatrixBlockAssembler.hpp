@@ -192,6 +192,106 @@ namespace Opm {
 
             struct CSRMatrix      mat_;
         };
+
+        template <>
+        class MatrixZero <struct BCSRMatrix> {
+        public:
+            static void
+            zero(struct BCSRMatrix& A) {
+                bcsrmatrix_zero(&A);
+            }
+        };
+
+        /// Assembler for block matrices, storing one index per
+        /// block rather than expanding to scalar entries.
+        template <>
+        class MatrixBlockAssembler<struct BCSRMatrix> {
+        public:
+            template <class Block>
+            void
+            assembleBlock(::std::size_t ndof,
+                          ::std::size_t i   ,
+                          ::std::size_t j   ,
+                          const Block&  b   ) {
+
+                assert (ndof >  0);
+                assert (ndof == ndof_);
+
+                const ::std::size_t k =
+                    bcsrmatrix_elm_index(i, j, &mat_);
+
+                double* blk = &sa_[k * ndof * ndof];
+
+                for (::std::size_t row = 0; row < ndof; ++row) {
+                    for (::std::size_t col = 0; col < ndof; ++col) {
+                        blk[row*ndof + col] += b[col*ndof + row];
+                    }
+                }
+            }
+
+            template <class Connections>
+            void
+            createBlockRow(::std::size_t      i  ,
+                           const Connections& conn,
+                           ::std::size_t      ndof) {
+
+                assert (ndof >  0);
+                assert (ndof == ndof_);
+                assert (i    == ia_.size() - 1);  (void) i;
+
+                const ::std::size_t start = ja_.size();
+
+                for (typename Connections::const_iterator
+                         c = conn.begin(), e = conn.end(); c != e; ++c) {
+                    ja_.push_back(static_cast<int>(*c));
+                }
+
+                ::std::sort(ja_.begin() + start, ja_.end());
+
+                ia_.push_back(static_cast<int>(ja_.size()));
+                sa_.insert(sa_.end(), conn.size() * ndof * ndof, double(0.0));
+
+                finalizeStructure();
+            }
+
+            void
+            finalizeStructure() {
+                mat_.ia  = &ia_[0];
+                mat_.ja  = ja_.empty() ? 0 : &ja_[0];
+                mat_.sa  = sa_.empty() ? 0 : &sa_[0];
+                mat_.m   = ia_.size() - 1;
+                mat_.nnz = ja_.size();
+                mat_.bs  = static_cast<int>(ndof_);
+            }
+
+            void
+            setSize(size_t ndof, size_t m, size_t n, size_t nnz = 0) {
+                (void) n;
+
+                ia_.resize(0);
+                ja_.resize(0);
+                sa_.resize(0);
+
+                ia_.reserve(1 + m);
+                ja_.reserve(nnz);
+                sa_.reserve(nnz * ndof * ndof);
+
+                ia_.push_back(0);
+                ndof_ = ndof;
+            }
+
+            struct BCSRMatrix&       matrix()       { return mat_; }
+            const struct BCSRMatrix& matrix() const { return mat_; }
+
+        private:
+            ::std::size_t         ndof_;
+
+            ::std::vector<int>    ia_;
+            ::std::vector<int>    ja_;
+            ::std::vector<double> sa_;
+
+            struct BCSRMatrix     mat_;
+        };
     }
 }
 
@@ -0,0 +1,248 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media Project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <opm/core/transport/implicit/CSRMatrixBlockGaussSeidelSolver.hpp>
+#include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/grid.h>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Opm
+{
+namespace ImplicitTransportLinAlgSupport
+{
+
+    namespace
+    {
+        double dot(const std::vector<double>& a, const std::vector<double>& b)
+        {
+            double d = 0.0;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                d += a[i] * b[i];
+            }
+            return d;
+        }
+
+        // y = A x
+        void mult(const CSRMatrix& A, const double* x, std::vector<double>& y)
+        {
+            for (std::size_t i = 0; i < A.m; ++i) {
+                double sum = 0.0;
+                for (int k = A.ia[i]; k < A.ia[i + 1]; ++k) {
+                    sum += A.sa[k] * x[A.ja[k]];
+                }
+                y[i] = sum;
+            }
+        }
+    } // anonymous namespace
+
+
+
+
+    CSRMatrixBlockGaussSeidelSolver::
+    CSRMatrixBlockGaussSeidelSolver(const double tolerance,
+                                    const int    max_iter,
+                                    const int    inner_sweeps)
+        : tol_(tolerance),
+          max_iter_(max_iter),
+          inner_sweeps_(inner_sweeps),
+          iterations_(0)
+    {
+    }
+
+
+
+
+    void CSRMatrixBlockGaussSeidelSolver::setOrdering(const UnstructuredGrid& grid,
+                                                      const double*           flux)
+    {
+        const int nc = grid.number_of_cells;
+        cell_sequence_.resize(nc);
+        cell_components_.resize(nc + 1);
+        int ncomp = 0;
+        compute_sequence(&grid, flux, &cell_sequence_[0], &cell_components_[0], &ncomp);
+        cell_components_.resize(ncomp + 1);
+        row_sequence_.clear();
+    }
+
+
+
+
+    void CSRMatrixBlockGaussSeidelSolver::buildRowOrdering(const std::size_t num_rows)
+    {
+        row_sequence_.clear();
+        row_components_.clear();
+        row_sequence_.reserve(num_rows);
+        row_components_.reserve(num_rows + 1);
+        row_components_.push_back(0);
+
+        if (cell_sequence_.empty()) {
+            // Natural ordering, one row per block.
+            for (std::size_t row = 0; row < num_rows; ++row) {
+                row_sequence_.push_back(row);
+                row_components_.push_back(row + 1);
+            }
+            return;
+        }
+
+        const std::size_t nc = cell_sequence_.size();
+        if (num_rows % nc != 0) {
+            OPM_THROW(std::runtime_error, "Matrix of size " << num_rows
+                      << " does not match ordering of " << nc << " cells.");
+        }
+        const int ndof = num_rows / nc;
+        for (std::size_t comp = 0; comp + 1 < cell_components_.size(); ++comp) {
+            for (int k = cell_components_[comp]; k < cell_components_[comp + 1]; ++k) {
+                for (int dof = 0; dof < ndof; ++dof) {
+                    row_sequence_.push_back(cell_sequence_[k]*ndof + dof);
+                }
+            }
+            row_components_.push_back(row_sequence_.size());
+        }
+    }
+
+
+
+
+    // z = M^{-1} r, where M is the block lower triangular part of A in
+    // the causal ordering, with approximate inverses of the diagonal
+    // blocks.
+    void CSRMatrixBlockGaussSeidelSolver::precondition(const CSRMatrix& A,
+                                                       const double*    r,
+                                                       double*          z) const
+    {
+        for (std::size_t i = 0; i < A.m; ++i) {
+            z[i] = 0.0;
+        }
+
+        for (std::size_t comp = 0; comp + 1 < row_components_.size(); ++comp) {
+            const int begin = row_components_[comp];
+            const int end   = row_components_[comp + 1];
+            const int sweeps = (end - begin == 1) ? 1 : inner_sweeps_;
+
+            for (int sweep = 0; sweep < sweeps; ++sweep) {
+                for (int k = begin; k < end; ++k) {
+                    const int row = row_sequence_[k];
+                    double diag = 0.0;
+                    double sum  = r[row];
+                    for (int nz = A.ia[row]; nz < A.ia[row + 1]; ++nz) {
+                        const int col = A.ja[nz];
+                        if (col == row) {
+                            diag += A.sa[nz];
+                        } else {
+                            sum -= A.sa[nz] * z[col];
+                        }
+                    }
+                    if (diag == 0.0) {
+                        OPM_THROW(std::runtime_error, "Zero diagonal in row " << row
+                                  << " of transport system.");
+                    }
+                    z[row] = sum / diag;
+                }
+            }
+        }
+    }
+
+
+
+
+    void CSRMatrixBlockGaussSeidelSolver::solveSystem(const CSRMatrix& A,
+                                                      const double*    b,
+                                                      double*          x)
+    {
+        const std::size_t n = A.m;
+        if (row_sequence_.size() != n) {
+            buildRowOrdering(n);
+        }
+
+        r_.resize(n);  r0_.resize(n);  p_.resize(n);    v_.resize(n);
+        s_.resize(n);  t_.resize(n);   phat_.resize(n); shat_.resize(n);
+
+        // r = b - A x
+        mult(A, x, t_);
+        for (std::size_t i = 0; i < n; ++i) {
+            r_[i] = b[i] - t_[i];
+        }
+        const double res0 = std::sqrt(dot(r_, r_));
+        iterations_ = 0;
+        if (res0 == 0.0) {
+            return;
+        }
+        const double target = tol_ * res0;
+
+        r0_ = r_;
+        std::fill(p_.begin(), p_.end(), 0.0);
+        std::fill(v_.begin(), v_.end(), 0.0);
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+        while (iterations_ < max_iter_) {
+            ++iterations_;
+
+            const double rho_new = dot(r0_, r_);
+            if (rho_new == 0.0) {
+                break;
+            }
+            const double beta = (rho_new / rho) * (alpha / omega);
+            for (std::size_t i = 0; i < n; ++i) {
+                p_[i] = r_[i] + beta*(p_[i] - omega*v_[i]);
+            }
+            precondition(A, &p_[0], &phat_[0]);
+            mult(A, &phat_[0], v_);
+            alpha = rho_new / dot(r0_, v_);
+            for (std::size_t i = 0; i < n; ++i) {
+                s_[i] = r_[i] - alpha*v_[i];
+            }
+            if (std::sqrt(dot(s_, s_)) <= target) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    x[i] += alpha*phat_[i];
+                }
+                return;
+            }
+
+            precondition(A, &s_[0], &shat_[0]);
+            mult(A, &shat_[0], t_);
+            const double tt = dot(t_, t_);
+            omega = (tt > 0.0) ? dot(t_, s_) / tt : 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                x[i] += alpha*phat_[i] + omega*shat_[i];
+                r_[i] = s_[i] - omega*t_[i];
+            }
+            if (std::sqrt(dot(r_, r_)) <= target) {
+                return;
+            }
+            if (omega == 0.0) {
+                break;
+            }
+            rho = rho_new;
+        }
+
+        OPM_THROW(std::runtime_error, "BiCGStab with reordered block Gauss-Seidel failed to converge "
+                  "on transport system in " << iterations_ << " iterations.");
+    }
+
+} // namespace ImplicitTransportLinAlgSupport
+} // namespace Opm
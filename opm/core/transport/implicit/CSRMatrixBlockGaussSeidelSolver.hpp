@@ -0,0 +1,118 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media Project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CSRMATRIXBLOCKGAUSSSEIDELSOLVER_HPP_HEADER
+#define OPM_CSRMATRIXBLOCKGAUSSSEIDELSOLVER_HPP_HEADER
+
+#include <cstddef>
+#include <vector>
+
+struct CSRMatrix;
+struct UnstructuredGrid;
+
+namespace Opm
+{
+    namespace ImplicitTransportLinAlgSupport
+    {
+
+        /// Iterative linear solver policy for ImplicitTransport.
+        ///
+        /// Solves the Jacobian systems by BiCGStab, preconditioned by one
+        /// block Gauss-Seidel sweep over the cells in the causal order
+        /// given by compute_sequence().  Each block is a strongly
+        /// connected component of the upwind graph.  Single-cell blocks
+        /// are solved exactly, larger blocks (loops due to gravity or
+        /// capillarity) by a fixed number of inner point Gauss-Seidel
+        /// sweeps.  For purely advective transport the preconditioner is
+        /// an exact inverse and BiCGStab converges in one iteration.
+        class CSRMatrixBlockGaussSeidelSolver
+        {
+        public:
+            /// Constructor.
+            /// \param[in] tolerance     Relative residual reduction.
+            /// \param[in] max_iter      Maximum number of BiCGStab iterations.
+            /// \param[in] inner_sweeps  Gauss-Seidel sweeps within blocks
+            ///                          of more than one cell.
+            explicit CSRMatrixBlockGaussSeidelSolver(const double tolerance    = 1.0e-8,
+                                                     const int    max_iter     = 100,
+                                                     const int    inner_sweeps = 2);
+
+            /// Compute block ordering from a Darcy flux field.  Until
+            /// called, cells are processed in natural order, one per
+            /// block.
+            /// \param[in] grid  Grid.  Matrix rows must be numbered cell
+            ///                  by cell, with an equal number per cell.
+            /// \param[in] flux  Darcy flux, one value per face.
+            void setOrdering(const UnstructuredGrid& grid,
+                             const double*           flux);
+
+            /// Number of BiCGStab iterations used in last solve.
+            int iterations() const { return iterations_; }
+
+            template <class Vector>
+            void
+            solve(const struct CSRMatrix* A,
+                  const Vector            b,
+                  Vector                  x)
+            {
+                solveSystem(*A, b, x);
+            }
+
+
+            template <class Vector>
+            void
+            solve(const struct CSRMatrix& A,
+                  const Vector&           b,
+                  Vector&                 x)
+            {
+                solveSystem(A, &b[0], &x[0]);
+            }
+
+        private:
+            void solveSystem(const struct CSRMatrix& A,
+                             const double*           b,
+                             double*                 x);
+
+            void buildRowOrdering(const std::size_t num_rows);
+
+            void precondition(const struct CSRMatrix& A,
+                              const double*           r,
+                              double*                 z) const;
+
+            double tol_;
+            int max_iter_;
+            int inner_sweeps_;
+            int iterations_;
+
+            // Cell sequence and block pointers from compute_sequence().
+            std::vector<int> cell_sequence_;
+            std::vector<int> cell_components_;
+
+            // Same, expanded to matrix rows.
+            std::vector<int> row_sequence_;
+            std::vector<int> row_components_;
+
+            // BiCGStab work vectors.
+            std::vector<double> r_, r0_, p_, v_, s_, t_, phat_, shat_;
+        }; // class CSRMatrixBlockGaussSeidelSolver
+
+    } // namespace ImplicitTransportLinAlgSupport
+} // namespace Opm
+
+#endif  /* OPM_CSRMATRIXBLOCKGAUSSSEIDELSOLVER_HPP_HEADER */
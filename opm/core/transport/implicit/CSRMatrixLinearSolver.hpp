@@ -0,0 +1,82 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media Project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CSRMATRIXLINEARSOLVER_HPP_HEADER
+#define OPM_CSRMATRIXLINEARSOLVER_HPP_HEADER
+
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <stdexcept>
+
+namespace Opm
+{
+    namespace ImplicitTransportLinAlgSupport
+    {
+
+        /// Linear solver policy for ImplicitTransport that forwards the
+        /// Jacobian systems to any LinearSolverInterface, e.g., an
+        /// iterative ISTL solver created by LinearSolverFactory.
+        class CSRMatrixLinearSolver
+        {
+        public:
+            /// Constructor.
+            /// \param[in] linsolver  Solver to use.  Must outlive this object.
+            explicit CSRMatrixLinearSolver(const LinearSolverInterface& linsolver)
+                : linsolver_(linsolver)
+            {
+            }
+
+            template <class Vector>
+            void
+            solve(const struct CSRMatrix* A,
+                  const Vector            b,
+                  Vector                  x)
+            {
+                check(linsolver_.solve(A, b, x));
+            }
+
+
+            template <class Vector>
+            void
+            solve(const struct CSRMatrix& A,
+                  const Vector&           b,
+                  Vector&                 x)
+            {
+                check(linsolver_.solve(&A, &b[0], &x[0]));
+            }
+
+        private:
+            static void
+            check(const LinearSolverInterface::LinearSolverReport& rep)
+            {
+                if (! rep.converged) {
+                    OPM_THROW(std::runtime_error, "Linear solver failed to converge on transport system "
+                              "in " << rep.iterations << " iterations.");
+                }
+            }
+
+            const LinearSolverInterface& linsolver_;
+        }; // class CSRMatrixLinearSolver
+
+    } // namespace ImplicitTransportLinAlgSupport
+} // namespace Opm
+
+#endif  /* OPM_CSRMATRIXLINEARSOLVER_HPP_HEADER */
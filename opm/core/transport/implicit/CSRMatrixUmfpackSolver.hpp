@@ -39,15 +39,56 @@
 #include <opm/core/linalg/call_umfpack.h>
 #include <opm/common/ErrorMacros.hpp>
 
+#include <stdexcept>
+
 namespace Opm
 {
     namespace ImplicitTransportLinAlgSupport
     {
 
+        /// Direct solver for the transport Jacobian systems.
+        ///
+        /// The UMFPACK symbolic analysis is computed once and reused for
+        /// as long as the sparsity pattern of the matrix is unchanged,
+        /// typically for all Newton iterations of all time steps.
         class CSRMatrixUmfpackSolver
         {
         public:
+            /// Constructor.
+            /// \param[in] reuse_factorization If true, also retain the
+            ///            numeric factorisation between solves (simplified
+            ///            Newton) until refactor() is called.
+            explicit CSRMatrixUmfpackSolver(const bool reuse_factorization = false)
+                : handle_(0)
+            {
+#if HAVE_SUITESPARSE_UMFPACK_H
+                handle_ = umfpack_handle_create(reuse_factorization ? 1 : 0);
+                if (handle_ == 0) {
+                    OPM_THROW(std::runtime_error, "Failed to allocate UMFPACK solver state.");
+                }
+#else
+                static_cast<void>(reuse_factorization);
+#endif
+            }
 
+            ~CSRMatrixUmfpackSolver()
+            {
+#if HAVE_SUITESPARSE_UMFPACK_H
+                umfpack_handle_destroy(handle_);
+#endif
+            }
+
+            CSRMatrixUmfpackSolver(const CSRMatrixUmfpackSolver&) = delete;
+            CSRMatrixUmfpackSolver& operator=(const CSRMatrixUmfpackSolver&) = delete;
+
+            /// Discard any retained numeric factorisation, so that the
+            /// next solve factorises the current matrix.
+            void refactor()
+            {
+#if HAVE_SUITESPARSE_UMFPACK_H
+                umfpack_handle_refactor(handle_);
+#endif
+            }
 
             template <class Vector>
             void
@@ -56,7 +97,9 @@ namespace Opm
                   Vector                  x)
             {
 #if HAVE_SUITESPARSE_UMFPACK_H
-                call_UMFPACK(const_cast<CSRMatrix*>(A), b, x);
+                if (! call_UMFPACK_handle(handle_, const_cast<CSRMatrix*>(A), b, x)) {
+                    OPM_THROW(std::runtime_error, "UMFPACK failed to solve transport system.");
+                }
 #else
     OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
           "Reconfigure opm-core with SuiteSparse/UMFPACK support and recompile.");
@@ -71,14 +114,17 @@ namespace Opm
                   Vector&                 x)
             {
 #if HAVE_SUITESPARSE_UMFPACK_H
-                call_UMFPACK(const_cast<CSRMatrix*>(&A), &b[0], &x[0]);
+                if (! call_UMFPACK_handle(handle_, const_cast<CSRMatrix*>(&A), &b[0], &x[0])) {
+                    OPM_THROW(std::runtime_error, "UMFPACK failed to solve transport system.");
+                }
 #else
     OPM_THROW(std::runtime_error, "Cannot use implicit transport solver without UMFPACK. "
           "Reconfigure opm-core with SuiteSparse/UMFPACK support and recompile.");
 #endif
             }
 
-
+        private:
+            struct UMFPACKHandle* handle_;
         }; // class CSRMatrixUmfpackSolver
 
     } // namespace ImplicitTransportLinAlgSupport
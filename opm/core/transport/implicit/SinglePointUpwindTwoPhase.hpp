@@ -42,6 +42,8 @@
 #ifndef OPM_SINGLEPOINTUPWINDTWOPHASE_HPP_HEADER
 #define OPM_SINGLEPOINTUPWINDTWOPHASE_HPP_HEADER
 
+#include <opm/core/utility/FixedSizeAd.hpp>
+
 #include <cassert>
 #include <cstddef>
 
@@ -274,6 +276,15 @@ namespace Opm {
     }
 
 
+    /**
+     * Single-point upstream weighted model of two-phase incompressible
+     * transport.
+     *
+     * Fluid properties are evaluated once per cell and Newton iteration,
+     * in initIteration(), and stored in a spu_2p::ModelParameterStorage.
+     * Face fluxes and source terms are then assembled from these cached
+     * values, with derivatives computed by FixedSizeAd.
+     */
     template <class TwophaseFluid>
     class SinglePointUpwindTwoPhase {
     public:
@@ -371,53 +382,31 @@ namespace Opm {
                        double*               J2   ,
                        double*               F    ) const {
 
-            const int *n = g.face_cells + (2 * f);
-            double dflux = state.faceflux()[f];
-            double gflux = gravityFlux(f);
-            double pcflux,dpcflux[2];
-            capFlux(f,n, pcflux, dpcflux);
-            gflux += pcflux;
-
-            int    pix[2];
-            double m[2], dm[2];
-            upwindMobility(dflux, gflux, n, pix, m, dm);
-
-            assert (! ((m[0] < 0) || (m[1] < 0)));
+            typedef FixedSizeAd<2> Ad; // Derivatives w.r.t. cells n[0] and n[1].
 
-            double mt = m[0] + m[1];
-            assert (mt > 0);
-
-            double sgn  = 2.0*(n[0] == c) - 1.0;
-            dflux      *= sgn;
-            gflux      *= sgn;
+            const int *n = g.face_cells + (2 * f);
+            const double dflux = state.faceflux()[f];
+            const Ad gflux = gravityFlux(f) + capFlux(f, n);
 
+            Ad m[2];
+            upwindMobility(dflux, gflux.value(), n, m);
 
-            double       f1 = m[0] / mt;
-            const double v1 = dflux + m[1]*gflux;
+            assert (! ((m[0].value() < 0) || (m[1].value() < 0)));
 
-            // Assemble residual contributions
-            *F += dt * f1 * v1;
+            const Ad mt = m[0] + m[1];
+            assert (mt.value() > 0);
 
-            // Assemble Jacobian (J1 <-> c, J2 <-> other)
-            double *J[2];
-            if (n[0] == c) {
-                J[0] = J1; J[1] = J2;
-                // sign is positive
-                J1[0*2 + 0] += sgn*dt * f1            * dpcflux[0] * m[1];
-                J2[0*2 + 0] += sgn*dt * f1            * dpcflux[1] * m[1];
-            } else {
-                J[0] = J2; J[1] = J1;
-                // sign is negative
-                J1[0*2 + 0] += sgn*dt * f1            * dpcflux[1] * m[1];
-                J2[0*2 + 0] += sgn*dt * f1            * dpcflux[0] * m[1];
-            }
+            const double sgn = 2.0*(n[0] == c) - 1.0;
+            const Ad     f1  = m[0] / mt;
+            const Ad     v1  = sgn * (dflux + m[1]*gflux);
 
-            // dF/dm_1 \cdot dm_1/ds
-            *J[ pix[0] ] += dt * (1 - f1) / mt * v1    * dm[0];
+            // Assemble residual and Jacobian (J1 <-> c, J2 <-> other)
+            const Ad flux = dt * f1 * v1;
+            const int self = (n[0] == c) ? 0 : 1;
 
-            /* dF/dm_2 \cdot dm_2/ds */
-            *J[ pix[1] ] -= dt * f1       / mt * v1    * dm[1];
-            *J[ pix[1] ] += dt * f1            * gflux * dm[1];
+            *F  += flux.value();
+            *J1 += flux.derivative(self);
+            *J2 += flux.derivative(1 - self);
         }
 
         template <class Grid>
@@ -453,20 +442,20 @@ namespace Opm {
                 *F += dt * dflux * src->saturation[2*i + 0];
             } else {
                 // cell -> src
-                const int     c  = src->cell[i];
-                const double* m  = store_.mob (c);
-                const double* dm = store_.dmob(c);
+                typedef FixedSizeAd<1> Ad;
 
-                const double  mt = m[0] + m[1];
+                const int     c  = src->cell[i];
+                const Ad      m0 = Ad::variable(store_.mob(c)[0], 0, store_.dmob(c)[0]);
+                const Ad      m1 = Ad::variable(store_.mob(c)[1], 0, store_.dmob(c)[1]);
+                const Ad      mt = m0 + m1;
 
-                assert (! ((m[0] < 0) || (m[1] < 0)));
-                assert (mt > 0);
+                assert (! ((m0.value() < 0) || (m1.value() < 0)));
+                assert (mt.value() > 0);
 
-                const double f  = m[0] / mt;
-                const double df = ((1 - f)*dm[0] - f*dm[1]) / mt;
+                const Ad f = dt * dflux * (m0 / mt);
 
-                *F += dt * dflux *  f;
-                *J += dt * dflux * df;
+                *F += f.value();
+                *J += f.derivative(0);
             }
         }
         template <class Grid>
@@ -622,43 +611,42 @@ namespace Opm {
         }
 
     private:
+        // Upwind phase mobilities, with derivatives w.r.t. the
+        // saturations of cells n[0] and n[1].
         void
-        upwindMobility(const double dflux,
-                       const double gflux,
-                       const int*   n    ,
-                       int*         pix  ,
-                       double*      m    ,
-                       double*      dm   ) const {
+        upwindMobility(const double      dflux,
+                       const double      gflux,
+                       const int*        n    ,
+                       FixedSizeAd<2>*   m    ) const {
             bool equal_sign = ( (! (dflux < 0)) && (! (gflux < 0)) ) ||
                 ( (! (dflux > 0)) && (! (gflux > 0)) );
 
+            int pix[2];
             if (equal_sign) {
 
                 if (! (dflux < 0) && ! (gflux < 0)) { pix[0] = 0; }
                 else                                { pix[0] = 1; }
 
-                m[0] = store_.mob(n[ pix[0] ]) [ 0 ];
+                const double m0 = store_.mob(n[ pix[0] ]) [ 0 ];
 
-                if (! (dflux - m[0]*gflux < 0))     { pix[1] = 0; }
+                if (! (dflux - m0*gflux < 0))       { pix[1] = 0; }
                 else                                { pix[1] = 1; }
 
-                m[1] = store_.mob(n[ pix[1] ]) [ 1 ];
-
             } else {
 
                 if (! (dflux < 0) && ! (gflux > 0)) { pix[1] = 0; }
                 else                                { pix[1] = 1; }
 
-                m[1] = store_.mob(n[ pix[1] ]) [ 1 ];
+                const double m1 = store_.mob(n[ pix[1] ]) [ 1 ];
 
-                if (dflux + m[1]*gflux > 0)         { pix[0] = 0; }
+                if (dflux + m1*gflux > 0)           { pix[0] = 0; }
                 else                                { pix[0] = 1; }
-
-                m[0] = store_.mob(n[ pix[0] ]) [ 0 ];
             }
 
-            dm[0] = store_.dmob(n[ pix[0] ]) [ 0 ];
-            dm[1] = store_.dmob(n[ pix[1] ]) [ 1 ];
+            for (int p = 0; p < 2; ++p) {
+                const int up = n[ pix[p] ];
+                m[p] = FixedSizeAd<2>::variable(store_.mob(up)[p], pix[p], store_.dmob(up)[p]);
+            }
         }
 
         template <class Grid>
@@ -702,16 +690,17 @@ namespace Opm {
 
             return gflux;
         }
-        void
-        capFlux(const int f,const int* n,double& pcflux, double* dpcflux) const {
-            //double capflux;
+        // Capillary flux, with derivatives w.r.t. the saturations of
+        // cells n[0] and n[1].
+        FixedSizeAd<2>
+        capFlux(const int f, const int* n) const {
+            typedef FixedSizeAd<2> Ad;
             int i1 = n[0];
             int i2 = n[1];
             assert ((i1 >= 0) && (i2 >= 0));
-            //double sgn=-1.0;
-            pcflux  = store_.trans(f)*(store_.pc(i2) - store_.pc(i1));
-            dpcflux[0]  = -store_.trans(f)*store_.dpc(i1);
-            dpcflux[1]  = store_.trans(f)*store_.dpc(i2);
+            const Ad pc1 = Ad::variable(store_.pc(i1), 0, store_.dpc(i1));
+            const Ad pc2 = Ad::variable(store_.pc(i2), 1, store_.dpc(i2));
+            return store_.trans(f) * (pc2 - pc1);
         }
 
         TwophaseFluid                 fluid_  ;
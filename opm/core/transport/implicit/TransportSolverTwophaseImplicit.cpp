@@ -34,11 +34,69 @@
 #include <opm/core/simulator/TwophaseState.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <string>
 
 namespace Opm
 {
 
+    namespace
+    {
+        // Fluid seen through a map from local to global cell numbers.
+        template <class Fluid>
+        class SubsetFluid
+        {
+        public:
+            SubsetFluid(const Fluid& fluid, const std::vector<int>& cells)
+                : fluid_(fluid), cells_(cells)
+            {
+            }
+
+            double density(int phase) const { return fluid_.density(phase); }
+
+            template <class Sat, class Mob, class DMob>
+            void mobility(int c, const Sat& s, Mob& mob, DMob& dmob) const
+            {
+                fluid_.mobility(cells_[c], s, mob, dmob);
+            }
+
+            template <class Sat, class Pcap, class DPcap>
+            void pc(int c, const Sat& s, Pcap& pcap, DPcap& dpcap) const
+            {
+                fluid_.pc(cells_[c], s, pcap, dpcap);
+            }
+
+            double s_min(int c) const { return fluid_.s_min(cells_[c]); }
+            double s_max(int c) const { return fluid_.s_max(cells_[c]); }
+
+        private:
+            const Fluid& fluid_;
+            const std::vector<int>& cells_;
+        };
+
+        // Minimal reservoir state for a subset of the grid.
+        struct SubsetState
+        {
+            std::vector<double>& saturation() { return sat; }
+            const std::vector<double>& saturation() const { return sat; }
+            const std::vector<double>& faceflux() const { return flux; }
+
+            std::vector<double> sat;
+            std::vector<double> flux;
+        };
+
+        template <class Fluid>
+        double fractionalFlow(const Fluid& fluid, const int cell, const double sw)
+        {
+            const double s[2] = { sw, 1.0 - sw };
+            double mob[2], dmob[2*2];
+            fluid.mobility(cell, s, mob, dmob);
+            return mob[0] / (mob[0] + mob[1]);
+        }
+    } // anonymous namespace
+
     TransportSolverTwophaseImplicit::TransportSolverTwophaseImplicit(
             const UnstructuredGrid& grid,
             const Opm::IncompPropertiesInterface& props,
@@ -46,16 +104,47 @@ namespace Opm
             const double* gravity,
             const std::vector<double>& half_trans,
             const parameter::ParameterGroup& param)
-        : fluid_(props),
+        : linsolver_(param.getDefault("reuse_factorization", false)),
+          fluid_(props),
           model_(fluid_, grid, porevol, gravity, param.getDefault("guess_old_solution", false)),
           tsolver_(model_),
           grid_(grid),
-          props_(props)
+          props_(props),
+          guess_old_solution_(param.getDefault("guess_old_solution", false)),
+          use_active_set_(param.getDefault("active_set", false)),
+          active_set_halo_(param.getDefault("active_set_halo", 2)),
+          active_set_max_fraction_(param.getDefault("active_set_max_fraction", 0.5)),
+          active_set_tol_(param.getDefault("active_set_tolerance", 1.0e-8))
     {
         ctrl_.max_it = param.getDefault("max_it", 20);
         ctrl_.verbosity = param.getDefault("verbosity", 0);
         ctrl_.max_it_ls = param.getDefault("max_it_ls", 5);
+        const std::string ls = param.getDefault<std::string>("transport_linsolver", "umfpack");
+        if (ls == "umfpack") {
+            linsolver_type_ = Umfpack;
+        } else if (ls == "reorder") {
+            linsolver_type_ = Reorder;
+            reorder_linsolver_.reset(new ImplicitTransportLinAlgSupport::CSRMatrixBlockGaussSeidelSolver(
+                param.getDefault("transport_linsolver_tolerance", 1.0e-8),
+                param.getDefault("transport_linsolver_max_iterations", 100),
+                param.getDefault("transport_linsolver_inner_sweeps", 2)));
+        } else if (ls == "generic") {
+            linsolver_type_ = Generic;
+            generic_linsolver_.reset(new LinearSolverFactory(param));
+        } else {
+            OPM_THROW(std::runtime_error, "Unknown transport linear solver: " << ls);
+        }
         model_.initGravityTrans(grid_, half_trans);
+        if (use_active_set_) {
+            // Counter-current gravity segregation may change cells that
+            // receive no inflow, which the active set does not detect.
+            bool has_gravity = false;
+            for (int d = 0; gravity != 0 && d < grid.dimensions; ++d) {
+                has_gravity = has_gravity || (gravity[d] != 0.0);
+            }
+            use_active_set_ = ! has_gravity;
+            half_trans_ = half_trans;
+        }
         tsrc_ = create_transport_source(2, 2);
         initial_porevolume_cell0_ = porevol[0];
     }
@@ -95,9 +184,248 @@ namespace Opm
                 OPM_THROW(std::runtime_error, "Failed building TransportSource struct.");
             }
         }
+        if (use_active_set_ && solveActiveSet(porevolume, dt, state)) {
+            return;
+        }
         Opm::ImplicitTransportDetails::NRReport  rpt;
-        tsolver_.solve(grid_, tsrc_, dt, ctrl_, state, linsolver_, rpt);
+        runSolver(tsolver_, grid_, tsrc_, dt, state, rpt);
         std::cout << rpt;
     }
 
+
+
+
+    template <class Solver, class State>
+    void TransportSolverTwophaseImplicit::runSolver(Solver&                                 ts,
+                                                    const UnstructuredGrid&                 grid,
+                                                    const TransportSource*                  src,
+                                                    const double                            dt,
+                                                    State&                                  state,
+                                                    Opm::ImplicitTransportDetails::NRReport& rpt)
+    {
+        switch (linsolver_type_) {
+        case Umfpack:
+            // A retained factorisation is only reused within a time step.
+            linsolver_.refactor();
+            ts.solve(grid, src, dt, ctrl_, state, linsolver_, rpt);
+            break;
+        case Reorder:
+            reorder_linsolver_->setOrdering(grid, &state.faceflux()[0]);
+            ts.solve(grid, src, dt, ctrl_, state, *reorder_linsolver_, rpt);
+            break;
+        case Generic: {
+            ImplicitTransportLinAlgSupport::CSRMatrixLinearSolver ls(*generic_linsolver_);
+            ts.solve(grid, src, dt, ctrl_, state, ls, rpt);
+            break;
+        }
+        }
+    }
+
+
+
+
+    bool TransportSolverTwophaseImplicit::solveActiveSet(const double* porevolume,
+                                                         const double dt,
+                                                         TwophaseState& state)
+    {
+        const int nc = grid_.number_of_cells;
+        const int nf = grid_.number_of_faces;
+        const std::vector<double>& sat  = state.saturation();
+        const std::vector<double>& flux = state.faceflux();
+
+        std::vector<double> fw(nc);
+        for (int c = 0; c < nc; ++c) {
+            fw[c] = fractionalFlow(fluid_, c, sat[2*c + 0]);
+        }
+
+        // Seed cells.
+        std::vector<char> active(nc, 0);
+        for (int i = 0; i < tsrc_->nsrc; ++i) {
+            const int c = tsrc_->cell[i];
+            if ((tsrc_->flux[i] > 0.0) &&
+                (std::fabs(tsrc_->saturation[2*i + 0] - fw[c]) > active_set_tol_)) {
+                active[c] = 1;
+            }
+        }
+        for (int f = 0; f < nf; ++f) {
+            const int c1 = grid_.face_cells[2*f + 0];
+            const int c2 = grid_.face_cells[2*f + 1];
+            if ((c1 < 0) || (c2 < 0) || (flux[f] == 0.0)) {
+                continue;
+            }
+            const int up   = (flux[f] > 0.0) ? c1 : c2;
+            const int down = (flux[f] > 0.0) ? c2 : c1;
+            if (std::fabs(fw[up] - fw[down]) > active_set_tol_) {
+                active[down] = 1;
+            }
+        }
+
+        const double dummy[] = { 0.0, 0.0 };
+        const int max_cells = static_cast<int>(active_set_max_fraction_ * nc);
+
+        std::vector<int> cells, local(nc), lface(nf);
+        SubsetState sub_state;
+        for (;;) {
+            // Extend by a halo of downstream neighbours.
+            for (int layer = 0; layer < active_set_halo_; ++layer) {
+                std::vector<char> grown(active);
+                for (int f = 0; f < nf; ++f) {
+                    const int c1 = grid_.face_cells[2*f + 0];
+                    const int c2 = grid_.face_cells[2*f + 1];
+                    if ((c1 < 0) || (c2 < 0)) {
+                        continue;
+                    }
+                    if ((flux[f] > 0.0) && active[c1]) { grown[c2] = 1; }
+                    if ((flux[f] < 0.0) && active[c2]) { grown[c1] = 1; }
+                }
+                active.swap(grown);
+            }
+
+            cells.clear();
+            for (int c = 0; c < nc; ++c) {
+                local[c] = active[c] ? static_cast<int>(cells.size()) : -1;
+                if (active[c]) {
+                    cells.push_back(c);
+                }
+            }
+            const int nl = cells.size();
+            if (nl > max_cells) {
+                return false;
+            }
+            if (nl == 0) {
+                return true;
+            }
+
+            // Sub-grid topology.  Faces towards inactive cells become
+            // boundary faces.
+            std::fill(lface.begin(), lface.end(), -1);
+            std::vector<int> faces, cell_facepos(1, 0), cell_faces, face_cells;
+            std::vector<double> pv(nl), htrans;
+            for (int lc = 0; lc < nl; ++lc) {
+                const int c = cells[lc];
+                pv[lc] = porevolume[c];
+                for (int i = grid_.cell_facepos[c]; i < grid_.cell_facepos[c + 1]; ++i) {
+                    const int f = grid_.cell_faces[i];
+                    if (lface[f] < 0) {
+                        lface[f] = faces.size();
+                        faces.push_back(f);
+                        for (int k = 0; k < 2; ++k) {
+                            const int n = grid_.face_cells[2*f + k];
+                            face_cells.push_back((n < 0) ? -1 : local[n]);
+                        }
+                    }
+                    cell_faces.push_back(lface[f]);
+                    htrans.push_back(half_trans_[i]);
+                }
+                cell_facepos.push_back(cell_faces.size());
+            }
+
+            UnstructuredGrid sub = UnstructuredGrid();
+            sub.dimensions      = grid_.dimensions;
+            sub.number_of_cells = nl;
+            sub.number_of_faces = faces.size();
+            sub.cell_facepos    = &cell_facepos[0];
+            sub.cell_faces      = &cell_faces[0];
+            sub.face_cells      = &face_cells[0];
+
+            // Sources, including flow across the boundary of the set.
+            TransportSource* src = create_transport_source(tsrc_->nsrc, 2);
+            bool ok = (src != 0);
+            for (int i = 0; ok && i < tsrc_->nsrc; ++i) {
+                const int c = tsrc_->cell[i];
+                if (active[c]) {
+                    ok = append_transport_source(local[c], 2, tsrc_->pressure[i], tsrc_->flux[i],
+                                                 tsrc_->saturation + 2*i, dummy, src);
+                }
+            }
+            sub_state.flux.resize(faces.size());
+            for (std::size_t lf = 0; ok && lf < faces.size(); ++lf) {
+                const int f  = faces[lf];
+                const int c1 = grid_.face_cells[2*f + 0];
+                const int c2 = grid_.face_cells[2*f + 1];
+                sub_state.flux[lf] = flux[f];
+                if ((c1 < 0) || (c2 < 0) || (active[c1] && active[c2]) || (flux[f] == 0.0)) {
+                    continue;
+                }
+                const int c = active[c1] ? c1 : c2;
+                const int n = active[c1] ? c2 : c1;
+                const bool inflow = (c == c1) == (flux[f] < 0.0);
+                if (inflow) {
+                    const double s_in[] = { fw[n], 1.0 - fw[n] };
+                    ok = append_transport_source(local[c], 2, state.pressure()[c],
+                                                 std::fabs(flux[f]), s_in, dummy, src);
+                } else {
+                    ok = append_transport_source(local[c], 2, state.pressure()[c],
+                                                 -std::fabs(flux[f]), dummy, dummy, src);
+                }
+            }
+            if (! ok) {
+                destroy_transport_source(src);
+                OPM_THROW(std::runtime_error, "Failed building TransportSource struct.");
+            }
+
+            sub_state.sat.resize(2*nl);
+            for (int lc = 0; lc < nl; ++lc) {
+                sub_state.sat[2*lc + 0] = sat[2*cells[lc] + 0];
+                sub_state.sat[2*lc + 1] = sat[2*cells[lc] + 1];
+            }
+
+            typedef SubsetFluid<TwophaseFluid> SubFluid;
+            typedef SinglePointUpwindTwoPhase<SubFluid> SubModel;
+            typedef Opm::ImplicitTransport<SubModel,
+                                           JacSys        ,
+                                           MaxNorm       ,
+                                           ImplicitTransportDefault::VectorNegater ,
+                                           ImplicitTransportDefault::VectorZero    ,
+                                           ImplicitTransportDefault::MatrixZero    ,
+                                           ImplicitTransportDefault::VectorAssign  > SubSolver;
+
+            SubModel sub_model(SubFluid(fluid_, cells), sub, pv, 0, guess_old_solution_);
+            sub_model.initGravityTrans(sub, htrans);
+            SubSolver sub_solver(sub_model);
+            Opm::ImplicitTransportDetails::NRReport rpt;
+            try {
+                runSolver(sub_solver, sub, src, dt, sub_state, rpt);
+            } catch (...) {
+                destroy_transport_source(src);
+                throw;
+            }
+            destroy_transport_source(src);
+
+            // Grow the set where outflow would change inactive cells.
+            bool grow = false;
+            for (std::size_t lf = 0; lf < faces.size(); ++lf) {
+                const int f  = faces[lf];
+                const int c1 = grid_.face_cells[2*f + 0];
+                const int c2 = grid_.face_cells[2*f + 1];
+                if ((c1 < 0) || (c2 < 0) || (active[c1] && active[c2])) {
+                    continue;
+                }
+                const int c = active[c1] ? c1 : c2;
+                const int n = active[c1] ? c2 : c1;
+                const bool outflow = (c == c1) ? (flux[f] > 0.0) : (flux[f] < 0.0);
+                if (outflow) {
+                    const double fw_new = fractionalFlow(fluid_, c, sub_state.sat[2*local[c] + 0]);
+                    if (std::fabs(fw_new - fw[n]) > active_set_tol_) {
+                        active[n] = 1;
+                        grow = true;
+                    }
+                }
+            }
+
+            if (! grow) {
+                std::vector<double>& s = state.saturation();
+                for (int lc = 0; lc < nl; ++lc) {
+                    s[2*cells[lc] + 0] = sub_state.sat[2*lc + 0];
+                    s[2*cells[lc] + 1] = sub_state.sat[2*lc + 1];
+                }
+                if (ctrl_.verbosity > 0) {
+                    std::cout << "Active set: " << nl << " of " << nc << " cells.\n";
+                }
+                std::cout << rpt;
+                return true;
+            }
+        }
+    }
+
 } // namespace Opm
@@ -27,6 +27,8 @@
 #include <opm/core/transport/implicit/ImplicitTransport.hpp>
 #include <opm/core/transport/implicit/transport_source.h>
 #include <opm/core/transport/implicit/CSRMatrixUmfpackSolver.hpp>
+#include <opm/core/transport/implicit/CSRMatrixLinearSolver.hpp>
+#include <opm/core/transport/implicit/CSRMatrixBlockGaussSeidelSolver.hpp>
 #include <opm/core/transport/implicit/NormSupport.hpp>
 #include <opm/core/transport/implicit/ImplicitAssembly.hpp>
 #include <opm/core/transport/implicit/ImplicitTransport.hpp>
@@ -55,7 +57,17 @@ namespace Opm
         /// \param[in] porevol   Pore volumes
         /// \param[in] gravity   Gravity vector (null for no gravity).
         /// \param[in] half_trans Half-transmissibilities (one-sided)
-        /// \param[in] maxit     Maximum number of non-linear iterations used.
+        /// \param[in] param     Parameters.  The linear solver for the
+        ///                      Jacobian systems is selected by
+        ///                      transport_linsolver ("umfpack"), one of
+        ///                      "umfpack"  direct solver,
+        ///                      "reorder"  BiCGStab with block Gauss-Seidel
+        ///                                 preconditioner in causal order,
+        ///                      "generic"  solver from LinearSolverFactory
+        ///                                 constructed from param.
+        ///                      If active_set (false) is true, each step
+        ///                      only solves for the cells whose saturation
+        ///                      can change; see solveActiveSet().
         TransportSolverTwophaseImplicit(const UnstructuredGrid& grid,
                                         const Opm::IncompPropertiesInterface& props,
                                         const std::vector<double>& porevol,
@@ -102,8 +114,35 @@ namespace Opm
                                        ImplicitTransportDefault::MatrixZero    ,
                                        ImplicitTransportDefault::VectorAssign  > TransportSolver;
 
+        enum LinearSolverType { Umfpack, Reorder, Generic };
+
+        // Run Newton solver 'ts' with the selected linear solver.
+        template <class Solver, class State>
+        void runSolver(Solver&                                 ts,
+                       const UnstructuredGrid&                 grid,
+                       const TransportSource*                  src,
+                       const double                            dt,
+                       State&                                  state,
+                       Opm::ImplicitTransportDetails::NRReport& rpt);
+
+        // Solve on the cells whose saturation may change during the step.
+        // Seeds are cells receiving inflow, from a neighbour or a source,
+        // whose fractional flow differs from their own.  These are
+        // extended by a downstream halo, and the set is grown and the
+        // step repeated while the solution would change inactive
+        // cells.  Inactive neighbours enter as Dirichlet-type inflow
+        // and outflow sources.  Returns false, leaving the state
+        // unchanged, if the set becomes larger than the given fraction
+        // of the grid, in which case a full solve is required.
+        bool solveActiveSet(const double* porevolume,
+                            const double dt,
+                            TwophaseState& state);
+
         // Data members.
         Opm::ImplicitTransportLinAlgSupport::CSRMatrixUmfpackSolver linsolver_;
+        LinearSolverType linsolver_type_;
+        std::unique_ptr<Opm::ImplicitTransportLinAlgSupport::CSRMatrixBlockGaussSeidelSolver> reorder_linsolver_;
+        std::unique_ptr<LinearSolverFactory> generic_linsolver_;
         Opm::SimpleFluid2pWrappingProps fluid_;
         SinglePointUpwindTwoPhase<Opm::SimpleFluid2pWrappingProps> model_;
         TransportSolver tsolver_;
@@ -112,6 +151,12 @@ namespace Opm
         const Opm::IncompPropertiesInterface& props_;
         TransportSource* tsrc_;
         double initial_porevolume_cell0_;
+        bool guess_old_solution_;
+        bool use_active_set_;
+        int active_set_halo_;
+        double active_set_max_fraction_;
+        double active_set_tol_;
+        std::vector<double> half_trans_;
     };
 
 } // namespace Opm
@@ -5,7 +5,10 @@
 
 #include "config.h"
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <opm/core/grid.h>
 #include <opm/core/transport/minimal/spu_explicit.h>
@@ -91,3 +94,470 @@ spu_explicit(struct UnstructuredGrid *g, double *s0, double *s, double *mob,
         }
     }
 }
+
+
+struct spu_explicit_work {
+    int     nc;                 /* Number of cells */
+    int     nif;                /* Number of interior faces */
+
+    int    *face;               /* Interior faces */
+    int    *c1, *c2;            /* Cells of interior faces */
+
+    double *flux;               /* Water flux per interior face */
+
+    double *mob;                /* Phase mobilities */
+    double *a;                  /* Per-cell flux derivative bound */
+
+    /* Local time stepping, see spu_explicit_advance_local() */
+    int    *lface, *lc1, *lc2;  /* Interior faces by decreasing level */
+    int    *flev;               /* Level of each entry of 'lface' */
+    int    *clev;               /* Level of each cell */
+    int    *tlev;               /* Finest level of the faces of a cell */
+    int    *tcell;              /* Cells by decreasing 'tlev' */
+    int    *scell;              /* Cells by decreasing 'clev' */
+};
+
+
+/* ---------------------------------------------------------------------- */
+struct spu_explicit_work *
+spu_explicit_work_create(const struct UnstructuredGrid *g)
+/* ---------------------------------------------------------------------- */
+{
+    int                       f, nif, nc;
+    struct spu_explicit_work *w;
+
+    nc  = g->number_of_cells;
+    nif = 0;
+    for (f = 0; f < g->number_of_faces; f++) {
+        nif += (g->face_cells[2*f + 0] >= 0) && (g->face_cells[2*f + 1] >= 0);
+    }
+
+    w = malloc(1 * sizeof *w);
+    if (w != NULL) {
+        w->nc  = nc;
+        w->nif = nif;
+
+        w->face = malloc((7 * (size_t) nif + 4 * (size_t) nc + 1) * sizeof *w->face);
+        w->flux = malloc((1 * (size_t) nif + 3 * (size_t) nc + 1) * sizeof *w->flux);
+
+        if ((w->face == NULL) || (w->flux == NULL)) {
+            spu_explicit_work_destroy(w);
+            w = NULL;
+        }
+    }
+
+    if (w != NULL) {
+        w->c1   = w->face + 1*nif;
+        w->c2   = w->face + 2*nif;
+
+        w->mob  = w->flux + 1*nif;
+        w->a    = w->mob  + 2*nc;
+
+        w->lface = w->face  + 3*nif;
+        w->lc1   = w->lface + 1*nif;
+        w->lc2   = w->lc1   + 1*nif;
+        w->flev  = w->lc2   + 1*nif;
+        w->clev  = w->flev  + 1*nif;
+        w->tlev  = w->clev  + 1*nc;
+        w->tcell = w->tlev  + 1*nc;
+        w->scell = w->tcell + 1*nc;
+
+        nif = 0;
+        for (f = 0; f < g->number_of_faces; f++) {
+            if ((g->face_cells[2*f + 0] >= 0) && (g->face_cells[2*f + 1] >= 0)) {
+                w->face[nif] = f;
+                w->c1  [nif] = g->face_cells[2*f + 0];
+                w->c2  [nif] = g->face_cells[2*f + 1];
+                nif++;
+            }
+        }
+    }
+
+    return w;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+spu_explicit_work_destroy(struct spu_explicit_work *w)
+/* ---------------------------------------------------------------------- */
+{
+    if (w != NULL) {
+        free(w->flux);
+        free(w->face);
+    }
+
+    free(w);
+}
+
+
+/* Water flux of each interior face, using the same upwind rules as
+ * spu_explicit() expressed as selections rather than branches. */
+/* ---------------------------------------------------------------------- */
+static void
+face_fluxes(int nif, const int *restrict face,
+            const int *restrict c1, const int *restrict c2,
+            const double *restrict dflux, const double *restrict gflux,
+            const double *restrict mob, double *restrict flux)
+/* ---------------------------------------------------------------------- */
+{
+    int    k, i, j, co, pos, wup1, oup1;
+    double d, gv, mw1, mw2, mo1, mo2, mwd, mod, m1, m2;
+
+    for (k = 0; k < nif; k++) {
+        i   = c1[k];
+        j   = c2[k];
+        d   = dflux[face[k]];
+        gv  = gflux[face[k]];
+
+        mw1 = mob[2*i + 0];  mo1 = mob[2*i + 1];
+        mw2 = mob[2*j + 0];  mo2 = mob[2*j + 1];
+
+        /* Co-current: Darcy and gravity flux of equal sign.  Then
+         * water is upwinded by the Darcy flux and oil by the total
+         * oil flux, otherwise the other way round. */
+        pos  = d > 0.0;
+        co   = (pos & (gv > 0.0)) | ((d < 0.0) & (gv < 0.0));
+        mwd  = pos ? mw1 : mw2;
+        mod  = pos ? mo1 : mo2;
+        wup1 = (co & pos) | ((co ^ 1) & (d + mod*gv > 0.0));
+        oup1 = ((co ^ 1) & pos) | (co & (d - mwd*gv > 0.0));
+
+        m1 = wup1 ? mw1 : mw2;
+        m2 = oup1 ? mo1 : mo2;
+
+        flux[k] = m1/(m1 + m2)*(d + m2*gv);
+    }
+}
+
+
+/* Source terms and face fluxes into s, starting from s0 (which may
+ * alias s). */
+/* ---------------------------------------------------------------------- */
+static void
+update_saturation(const struct spu_explicit_work *w,
+                  const double *s0, double *s, const double *mob,
+                  const double *src, double dt)
+/* ---------------------------------------------------------------------- */
+{
+    int    i, k;
+    double m1, m2;
+
+    for (i = 0; i < w->nc; i++) {
+        /* Injection: assume sat==1.0 in source, and f(1.0)=1.0 */
+        m1   = mob[2*i + 0];
+        m2   = mob[2*i + 1];
+        s[i] = s0[i] + ((src[i] > 0.0) ? dt*src[i] : dt*src[i]*m1/(m1 + m2));
+    }
+
+    for (k = 0; k < w->nif; k++) {
+        s[w->c1[k]] -= w->flux[k]*dt;
+        s[w->c2[k]] += w->flux[k]*dt;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+spu_explicit_batched(struct spu_explicit_work *w,
+                     const double *s0, double *s, const double *mob,
+                     const double *dflux, const double *gflux,
+                     const double *src, double dt)
+/* ---------------------------------------------------------------------- */
+{
+    face_fluxes(w->nif, w->face, w->c1, w->c2, dflux, gflux, mob, w->flux);
+    update_saturation(w, s0, s, mob, src, dt);
+}
+
+
+/* Assume uniformly spaced table. */
+/* ---------------------------------------------------------------------- */
+static double
+interpolate(int n, double h, double x0, const double *tab, double x)
+/* ---------------------------------------------------------------------- */
+{
+    int    i;
+    double a;
+
+    assert (h > 0);
+    assert ((x-x0) < h*INT_MAX);
+
+    if (x < x0) {
+        return tab[0];
+    }
+
+    i = (x - x0) / h;
+
+    if (i + 1 > n - 1) {
+        return tab[n - 1];
+    }
+
+    a = (x - x0 - i*h) / h;
+
+    return (1 - a)*tab[i] + a*tab[i + 1];
+}
+
+
+/* Largest slopes, between table nodes, of the fractional flow
+ * f = mw/(mw + mo) and of the gravity mobility mw*mo/(mw + mo). */
+/* ---------------------------------------------------------------------- */
+static void
+max_flux_slopes(int n, double h, const double *tab, double *Lf, double *Lg)
+/* ---------------------------------------------------------------------- */
+{
+    int           i;
+    double        mt, f, g, fp, gp;
+    const double *tw, *to;
+
+    tw = tab;
+    to = tab + n;
+
+    *Lf = *Lg = 0.0;
+    fp  = gp  = 0.0;
+    for (i = 0; i < n; i++) {
+        mt = tw[i] + to[i];
+        f  = (mt > 0.0) ? tw[i] / mt         : 0.0;
+        g  = (mt > 0.0) ? tw[i] * to[i] / mt : 0.0;
+
+        if (i > 0) {
+            *Lf = (fabs(f - fp) / h > *Lf) ? fabs(f - fp) / h : *Lf;
+            *Lg = (fabs(g - gp) / h > *Lg) ? fabs(g - gp) / h : *Lg;
+        }
+
+        fp = f;
+        gp = g;
+    }
+}
+
+
+/* Bound |dF/ds| of each cell's update into w->a: the fractional flow
+ * part only moves out of the Darcy upwind cell (and production
+ * wells), the gravity part may go either way. */
+/* ---------------------------------------------------------------------- */
+static void
+cell_rate_bounds(struct spu_explicit_work *w,
+                 double h, int ntab, const double *tab,
+                 const double *dflux, const double *gflux,
+                 const double *src)
+/* ---------------------------------------------------------------------- */
+{
+    int     i, k;
+    double  Lf, Lg, d, gv;
+    double *a;
+
+    a = w->a;
+
+    max_flux_slopes(ntab, h, tab, &Lf, &Lg);
+
+    for (i = 0; i < w->nc; i++) {
+        a[i] = (src[i] < 0.0) ? -src[i] * Lf : 0.0;
+    }
+    for (k = 0; k < w->nif; k++) {
+        d  = dflux[w->face[k]];
+        gv = fabs(gflux[w->face[k]]);
+
+        a[w->c1[k]] += ((d > 0.0) ?  d*Lf : 0.0) + gv*Lg;
+        a[w->c2[k]] += ((d < 0.0) ? -d*Lf : 0.0) + gv*Lg;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+spu_explicit_advance(struct spu_explicit_work *w,
+                     double *s,
+                     double h, double x0, int ntab, const double *tab,
+                     const double *dflux, const double *gflux,
+                     const double *src, double dt, double cfl, int maxsteps)
+/* ---------------------------------------------------------------------- */
+{
+    int     i, step, nsteps;
+    double  amax, dtk;
+    double *mob, *a;
+
+    assert ((0.0 < cfl) && (cfl <= 1.0));
+    assert (ntab > 1);
+
+    mob = w->mob;
+    a   = w->a;
+
+    cell_rate_bounds(w, h, ntab, tab, dflux, gflux, src);
+
+    amax = 0.0;
+    for (i = 0; i < w->nc; i++) {
+        amax = (a[i] > amax) ? a[i] : amax;
+    }
+
+    nsteps = (dt > 0.0) ? 1 : 0;
+    if (amax * dt > cfl * maxsteps) {
+        return -1;
+    }
+    if (amax * dt > cfl) {
+        nsteps = (int) ceil(amax * dt / cfl);
+    }
+
+    dtk = (nsteps > 0) ? dt / nsteps : 0.0;
+    for (step = 0; step < nsteps; step++) {
+        for (i = 0; i < w->nc; i++) {
+            mob[2*i + 0] = interpolate(ntab, h, x0, tab       , s[i]);
+            mob[2*i + 1] = interpolate(ntab, h, x0, tab + ntab, s[i]);
+        }
+
+        face_fluxes(w->nif, w->face, w->c1, w->c2, dflux, gflux, mob, w->flux);
+        update_saturation(w, s, s, mob, src, dtk);
+    }
+
+    return nsteps;
+}
+
+
+/* Finest level of local time stepping.  Level l advances by dt/2^l. */
+#define SPU_LTS_MAX_LEVEL 30
+
+
+/* Order indices 0..n-1 by decreasing level (stable within a level).
+ * On return, the first nge[m] entries of 'order' have level >= m, for
+ * m = 0..L+1. */
+/* ---------------------------------------------------------------------- */
+static void
+sort_by_level(int n, const int *level, int L, int *nge, int *order)
+/* ---------------------------------------------------------------------- */
+{
+    int i, m, pos[SPU_LTS_MAX_LEVEL + 1];
+
+    for (m = 0; m <= L + 1; m++) {
+        nge[m] = 0;
+    }
+    for (i = 0; i < n; i++) {
+        nge[level[i]] += 1;
+    }
+    for (m = L - 1; m >= 0; m--) {
+        nge[m] += nge[m + 1];
+    }
+
+    for (m = 0; m <= L; m++) {
+        pos[m] = nge[m + 1];
+    }
+    for (i = 0; i < n; i++) {
+        order[pos[level[i]]++] = i;
+    }
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+spu_explicit_advance_local(struct spu_explicit_work *w,
+                           double *s,
+                           double h, double x0, int ntab, const double *tab,
+                           const double *dflux, const double *gflux,
+                           const double *src, double dt, double cfl,
+                           int maxsteps)
+/* ---------------------------------------------------------------------- */
+{
+    int     i, j, k, m, t, L, lev, step, nsteps;
+    int     nge_f[SPU_LTS_MAX_LEVEL + 2];
+    int     nge_t[SPU_LTS_MAX_LEVEL + 2];
+    int     nge_c[SPU_LTS_MAX_LEVEL + 2];
+    double  r, dtl, m1, m2;
+    double *mob, *a;
+
+    assert ((0.0 < cfl) && (cfl <= 1.0));
+    assert (ntab > 1);
+
+    if (! (dt > 0.0)) {
+        return 0;
+    }
+
+    mob = w->mob;
+    a   = w->a;
+
+    cell_rate_bounds(w, h, ntab, tab, dflux, gflux, src);
+
+    /* Level of each cell: the coarsest at which its own rate bound
+     * satisfies the CFL condition.  Halving is exact. */
+    L = 0;
+    for (i = 0; i < w->nc; i++) {
+        lev = 0;
+        for (r = a[i] * dt; r > cfl; r *= 0.5) {
+            if ((lev == SPU_LTS_MAX_LEVEL) || ((1 << (lev + 1)) > maxsteps)) {
+                return -1;
+            }
+            lev += 1;
+        }
+
+        w->clev[i] = lev;
+        w->tlev[i] = lev;
+        L = (lev > L) ? lev : L;
+    }
+
+    /* A face advances with the finer level of its cells, and both
+     * cells see identical fluxes, so water is conserved across level
+     * interfaces.  A cell is touched at the finest level of its
+     * faces. */
+    for (k = 0; k < w->nif; k++) {
+        i = w->clev[w->c1[k]];
+        j = w->clev[w->c2[k]];
+
+        lev = (i > j) ? i : j;
+        w->flev[k] = lev;
+
+        if (lev > w->tlev[w->c1[k]]) { w->tlev[w->c1[k]] = lev; }
+        if (lev > w->tlev[w->c2[k]]) { w->tlev[w->c2[k]] = lev; }
+    }
+
+    sort_by_level(w->nif, w->flev, L, nge_f, w->lface);
+    for (j = 0; j < w->nif; j++) {
+        k = w->lface[j];
+
+        w->lc1  [j] = w->c1  [k];
+        w->lc2  [j] = w->c2  [k];
+        w->lface[j] = w->face[k];
+    }
+
+    sort_by_level(w->nc, w->tlev, L, nge_t, w->tcell);
+    sort_by_level(w->nc, w->clev, L, nge_c, w->scell);
+
+    /* Substep 'step' of the finest level advances all levels m..L. */
+    nsteps = 1 << L;
+    for (step = 0; step < nsteps; step++) {
+        m = 0;
+        if (step > 0) {
+            for (m = L, t = step; (t % 2) == 0; t /= 2) {
+                m -= 1;
+            }
+        }
+
+        for (j = 0; j < nge_t[m]; j++) {
+            i = w->tcell[j];
+
+            mob[2*i + 0] = interpolate(ntab, h, x0, tab       , s[i]);
+            mob[2*i + 1] = interpolate(ntab, h, x0, tab + ntab, s[i]);
+        }
+
+        face_fluxes(nge_f[m], w->lface, w->lc1, w->lc2,
+                    dflux, gflux, mob, w->flux);
+
+        for (lev = L; lev >= m; lev--) {
+            dtl = dt / (double) (1 << lev);
+
+            for (j = nge_c[lev + 1]; j < nge_c[lev]; j++) {
+                /* Injection: assume sat==1.0 in source, and f(1.0)=1.0 */
+                i    = w->scell[j];
+                m1   = mob[2*i + 0];
+                m2   = mob[2*i + 1];
+                s[i] += (src[i] > 0.0) ? dtl*src[i] : dtl*src[i]*m1/(m1 + m2);
+            }
+        }
+
+        for (lev = L; lev >= m; lev--) {
+            dtl = dt / (double) (1 << lev);
+
+            for (j = nge_f[lev + 1]; j < nge_f[lev]; j++) {
+                s[w->lc1[j]] -= w->flux[j]*dtl;
+                s[w->lc2[j]] += w->flux[j]*dtl;
+            }
+        }
+    }
+
+    return nsteps;
+}
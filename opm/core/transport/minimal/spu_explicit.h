@@ -5,6 +5,13 @@
 
 #ifndef SPU_EXPLICIT_H_INCLUDED
 #define SPU_EXPLICIT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct UnstructuredGrid;
+
 void
 spu_explicit(struct UnstructuredGrid *g,
              double *s0,
@@ -15,5 +22,89 @@ spu_explicit(struct UnstructuredGrid *g,
              double *src,
              double dt);
 
-#endif /* SPU_EXPLICIT_H_INCLUDED */
 
+/* Interior face list and scratch arrays for repeated explicit
+ * solves on one grid.  Opaque. */
+struct spu_explicit_work;
+
+/* Create work space for grid g.  Returns NULL on allocation failure. */
+struct spu_explicit_work *
+spu_explicit_work_create(const struct UnstructuredGrid *g);
+
+void
+spu_explicit_work_destroy(struct spu_explicit_work *w);
+
+
+/* Same update as spu_explicit(), but faces are processed in batches:
+ * all upwind decisions and fluxes are computed by a branch-free loop
+ * over the interior faces (which the compiler may vectorise) before
+ * the fluxes are gathered into the cells.  Results are identical to
+ * those of spu_explicit(). */
+void
+spu_explicit_batched(struct spu_explicit_work *w,
+                     const double *s0,
+                     double *s,
+                     const double *mob,
+                     const double *dflux,
+                     const double *gflux,
+                     const double *src,
+                     double dt);
+
+
+/* Advance saturation s over time interval dt with as many equal
+ * explicit substeps as stability requires, in one call.
+ *
+ * Phase mobilities are interpolated in the uniform table tab (ntab
+ * water mobilities followed by ntab oil mobilities at saturations
+ * x0 + i*h, as in spu_implicit()) before each substep.  The number of
+ * substeps is the smallest n for which
+ *
+ *     (dt/n) * (Lf * sum |outgoing Darcy flux| + Lg * sum |gravity flux|)
+ *         <= cfl
+ *
+ * in every cell, production included, Lf and Lg being the largest
+ * slopes in the table of the fractional flow and of mw*mo/(mw + mo).
+ * Choose 0 < cfl <= 1.
+ *
+ * Returns the number of substeps taken, or -1, leaving s unchanged,
+ * if more than maxsteps substeps would be needed. */
+int
+spu_explicit_advance(struct spu_explicit_work *w,
+                     double *s,
+                     double h, double x0, int ntab, const double *tab,
+                     const double *dflux,
+                     const double *gflux,
+                     const double *src,
+                     double dt, double cfl, int maxsteps);
+
+
+/* Advance saturation s over time interval dt as spu_explicit_advance(),
+ * but with local time steps.
+ *
+ * A cell is assigned the level l, advancing by dt/2^l, of the coarsest
+ * such step for which its own bound in the CFL condition above holds.
+ * Each interior face advances at the finer level of its two cells and
+ * transfers the same water volume to both, so water is conserved across
+ * level interfaces.  Mobilities are re-interpolated only for the cells
+ * of the faces being advanced.  Cells far from wells thus take a few
+ * large steps while the cells near wells take many small ones.
+ *
+ * If all cells share a level, this is identical to
+ * spu_explicit_advance() with 2^l substeps.
+ *
+ * Returns the number of substeps of the finest level, 2^l, or -1,
+ * leaving s unchanged, if that would exceed maxsteps. */
+int
+spu_explicit_advance_local(struct spu_explicit_work *w,
+                           double *s,
+                           double h, double x0, int ntab, const double *tab,
+                           const double *dflux,
+                           const double *gflux,
+                           const double *src,
+                           double dt, double cfl, int maxsteps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPU_EXPLICIT_H_INCLUDED */
@@ -0,0 +1,76 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_REORDERSEQUENCE_HEADER_INCLUDED
+#define OPM_REORDERSEQUENCE_HEADER_INCLUDED
+
+#include <opm/core/transport/reorder/reordersequence.h>
+
+/**
+ * \file
+ * Grid templated versions of compute_sequence() and
+ * compute_sequence_graph().
+ *
+ * The grid is accessed through the UgGridHelpers interface only, so grids
+ * with implicit topology, such as Opm::CartesianGridView, get inlined
+ * connectivity instead of the indirect arrays of UnstructuredGrid.  The
+ * arguments and results are as for the C functions in reordersequence.h.
+ */
+
+/**
+ * Compute causal permutation sequence of grid cells with respect to
+ * specific Darcy flux field, as the C version for UnstructuredGrid.
+ *
+ * @param[in]  grid        Grid.
+ * @param[in]  flux        Darcy flux field, one value per face.
+ * @param[out] sequence    Causal grid cell permutation.
+ * @param[out] components  Start of each strongly connected component in
+ *                         @c sequence.  Array of size number of cells + 1.
+ * @param[out] ncomponents Number of strongly connected components.
+ */
+template<class Grid>
+void
+compute_sequence(const Grid   *grid       ,
+                 const double *flux       ,
+                 int          *sequence   ,
+                 int          *components ,
+                 int          *ncomponents);
+
+/**
+ * Compute causal permutation sequence as compute_sequence(), and also
+ * return the upwind graph.
+ *
+ * @param[out] ia  Indirection pointers into @c ja.  Array of size number of
+ *                 cells + 1.
+ * @param[out] ja  Upwind cells of each cell.  Array of size at least equal to
+ *                 the number of internal faces of @c grid.
+ */
+template<class Grid>
+void
+compute_sequence_graph(const Grid   *grid       ,
+                       const double *flux       ,
+                       int          *sequence   ,
+                       int          *components ,
+                       int          *ncomponents,
+                       int          *ia         ,
+                       int          *ja         );
+
+#include "ReorderSequence_impl.hpp"
+#endif  /* OPM_REORDERSEQUENCE_HEADER_INCLUDED */
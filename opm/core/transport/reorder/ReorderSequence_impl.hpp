@@ -0,0 +1,141 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <opm/core/grid/GridHelpers.hpp>
+#include <opm/core/grid/CartesianGridView.hpp>
+#include <opm/core/transport/reorder/tarjan.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/* Construct adjacency matrix of upwind graph wrt flux, as the static
+   make_upwind_graph() of reordersequence.cpp.  Column indices are not
+   sorted. */
+// ---------------------------------------------------------------------
+template<class Grid>
+void
+make_upwind_graph(const Grid   *grid,
+                  const double *flux,
+                  int          *ia  ,
+                  int          *ja  ,
+                  int          *work)
+// ---------------------------------------------------------------------
+{
+    using namespace Opm::UgGridHelpers;
+
+    typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
+
+    const int nc = numCells(*grid);
+    typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(*grid);
+    typename FaceCellTraits<Grid>::Type face_cells = faceCells(*grid);
+
+    /* For each face, store upwind cell in work array */
+    for (int c = 0; c < nc; ++c) {
+        FaceRow faces = c2f[c];
+
+        for (typename FaceRow::const_iterator f = faces.begin(), end = faces.end();
+             f != end; ++f)
+        {
+            const double theflux = (face_cells(*f, 0) == c) ? flux[*f] : -flux[*f];
+
+            if (theflux > 0) {
+                /* c is upwind cell for face f */
+                work[*f] = c;
+            }
+        }
+    }
+
+    /* Fill ia and ja */
+    int p = 0;
+    ia[0] = p;
+    for (int c = 0; c < nc; ++c) {
+        FaceRow faces = c2f[c];
+
+        for (typename FaceRow::const_iterator f = faces.begin(), end = faces.end();
+             f != end; ++f)
+        {
+            const int c1 = face_cells(*f, 0);
+            const int c2 = face_cells(*f, 1);
+
+            if ((c1 == -1) || (c2 == -1)) {
+                continue;
+            }
+
+            const double theflux = (c1 == c) ? flux[*f] : -flux[*f];
+
+            if (theflux < 0) {
+                ja[p++] = work[*f];
+            }
+        }
+        ia[c + 1] = p;
+    }
+}
+
+
+// ---------------------------------------------------------------------
+template<class Grid>
+void
+compute_sequence_graph(const Grid   *grid       ,
+                       const double *flux       ,
+                       int          *sequence   ,
+                       int          *components ,
+                       int          *ncomponents,
+                       int          *ia         ,
+                       int          *ja         )
+// ---------------------------------------------------------------------
+{
+    using namespace Opm::UgGridHelpers;
+
+    const std::size_t nc = numCells(*grid);
+    const std::size_t nf = numFaces(*grid);
+
+    std::vector<int> work(std::max(nf, 3 * nc));
+
+    make_upwind_graph(grid, flux, ia, ja, &work[0]);
+
+    tarjan(numCells(*grid), ia, ja, sequence, components, ncomponents, &work[0]);
+
+    assert (0 < *ncomponents);
+    assert (*ncomponents <= numCells(*grid));
+}
+
+
+// ---------------------------------------------------------------------
+template<class Grid>
+void
+compute_sequence(const Grid   *grid       ,
+                 const double *flux       ,
+                 int          *sequence   ,
+                 int          *components ,
+                 int          *ncomponents)
+// ---------------------------------------------------------------------
+{
+    using namespace Opm::UgGridHelpers;
+
+    std::vector<int> ia(numCells(*grid) + 1);
+    std::vector<int> ja(numFaces(*grid));  // A bit too much.
+
+    // Explicit template argument, since the C version is an exact
+    // match for UnstructuredGrid.
+    compute_sequence_graph<Grid>(grid, flux, sequence, components, ncomponents,
+                                 &ia[0], &ja[0]);
+}
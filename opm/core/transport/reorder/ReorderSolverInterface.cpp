@@ -22,45 +22,207 @@
 #include <opm/core/transport/reorder/reordersequence.h>
 #include <opm/core/grid.h>
 #include <opm/core/utility/StopWatch.hpp>
+#include <opm/common/ErrorMacros.hpp>
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <numeric>
+
+
+Opm::ReorderSolverInterface::ReorderSolverInterface()
+    : level_scheduling_(false),
+      parallel_ordering_(false),
+      ordering_given_(false),
+      last_level_scheduled_(false),
+      reorder_ctx_(nullptr, destroy_reorder_context)
+{
+}
+
+
+Opm::ReorderSolverInterface::~ReorderSolverInterface()
+{
+}
+
+
+void Opm::ReorderSolverInterface::useLevelScheduling(const bool enable)
+{
+    level_scheduling_ = enable;
+}
+
+
+void Opm::ReorderSolverInterface::useParallelOrdering(const bool enable)
+{
+    parallel_ordering_ = enable;
+}
+
+
+void Opm::ReorderSolverInterface::setOrdering(const std::vector<int>& sequence,
+                                              const std::vector<int>& components)
+{
+    assert(!components.empty() && components.front() == 0);
+    assert(components.back() == int(sequence.size()));
+    sequence_ = sequence;
+    components_ = components;
+    ordering_given_ = true;
+}
+
+
+void Opm::ReorderSolverInterface::clearOrdering()
+{
+    ordering_given_ = false;
+}
 
 
 void Opm::ReorderSolverInterface::reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux)
+{
+    const bool level_scheduled = level_scheduling_ && !ordering_given_;
+    if (!ordering_given_) {
+        reorder(grid, darcyflux);
+    }
+    last_level_scheduled_ = level_scheduled;
+    solveInOrder(level_scheduled);
+}
+
+
+void Opm::ReorderSolverInterface::transportAgain()
+{
+    solveInOrder(last_level_scheduled_);
+}
+
+
+void Opm::ReorderSolverInterface::solveInOrder(const bool level_scheduled)
+{
+    const int ncomponents = components_.size() - 1;
+
+    if (level_scheduled) {
+        const int nlevels = level_ptr_.size() - 1;
+        for (int level = 0; level < nlevels; ++level) {
+            const int begin = level_ptr_[level];
+            const int end = level_ptr_[level + 1];
+            // Single-cell components of a level are independent.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+            for (int i = begin; i < end; ++i) {
+                const int comp = level_comps_[i];
+                if (components_[comp + 1] - components_[comp] == 1) {
+                    solveSingleCell(sequence_[components_[comp]]);
+                }
+            }
+            // Multi-cell components are solved serially, since
+            // solveMultiCell() may update solver-wide statistics.
+            for (int i = begin; i < end; ++i) {
+                const int comp = level_comps_[i];
+                if (components_[comp + 1] - components_[comp] > 1) {
+                    solveComponent(comp);
+                }
+            }
+        }
+    } else {
+        // Invoke appropriate solve method for each interdependent component.
+        for (int comp = 0; comp < ncomponents; ++comp) {
+#if 0
+#ifdef MATLAB_MEX_FILE
+            // \TODO replace this with general signal handling code, check if it costs performance.
+            if (interrupt_signal) {
+                mexPrintf("Reorder loop interrupted by user: %d of %d "
+                          "cells finished.\n", i, grid.number_of_cells);
+                break;
+            }
+#endif
+#endif
+            solveComponent(comp);
+        }
+    }
+}
+
+
+void Opm::ReorderSolverInterface::reorder(const UnstructuredGrid& grid, const double* darcyflux)
 {
     // Compute reordered sequence of single-cell problems
+    ordering_given_ = false;
     sequence_.resize(grid.number_of_cells);
     components_.resize(grid.number_of_cells + 1);
     int ncomponents;
     time::StopWatch clock;
     clock.start();
-    compute_sequence(&grid, darcyflux, &sequence_[0], &components_[0], &ncomponents);
+    if (!reorder_ctx_
+        || reorder_ctx_->number_of_cells != grid.number_of_cells
+        || reorder_ctx_->number_of_faces != grid.number_of_faces) {
+        reorder_ctx_.reset(create_reorder_context(&grid));
+        if (!reorder_ctx_) {
+            OPM_THROW(std::runtime_error, "Failed to allocate reorder context.");
+        }
+    }
+    reorder_ctx_->parallel = parallel_ordering_ ? 1 : 0;
+    if (!compute_sequence_context(reorder_ctx_.get(), &grid, darcyflux, &sequence_[0], &components_[0],
+                                  &ncomponents, level_scheduling_ ? 1 : 0)) {
+        OPM_THROW(std::runtime_error, "Failed to compute cell ordering.");
+    }
     clock.stop();
     std::cout << "Topological sort took: " << clock.secsSinceStart() << " seconds." << std::endl;
 
     // Make vector's size match actual used data.
     components_.resize(ncomponents + 1);
 
-    // Invoke appropriate solve method for each interdependent component.
-    for (int comp = 0; comp < ncomponents; ++comp) {
-#if 0
-#ifdef MATLAB_MEX_FILE
-	// \TODO replace this with general signal handling code, check if it costs performance.
-        if (interrupt_signal) {
-            mexPrintf("Reorder loop interrupted by user: %d of %d "
-                      "cells finished.\n", i, grid.number_of_cells);
-            break;
+    if (level_scheduling_) {
+        computeLevels();
+    }
+}
+
+
+void Opm::ReorderSolverInterface::solveComponents(const int num_comps, const int* comps)
+{
+    for (int i = 0; i < num_comps; ++i) {
+        solveComponent(comps[i]);
+    }
+}
+
+
+void Opm::ReorderSolverInterface::solveComponent(const int comp)
+{
+    const int comp_size = components_[comp + 1] - components_[comp];
+    if (comp_size == 1) {
+        solveSingleCell(sequence_[components_[comp]]);
+    } else {
+        solveMultiCell(comp_size, &sequence_[components_[comp]]);
+    }
+}
+
+
+// Assign each component the level 1 + (max level of its upwind
+// components), using the component graph of the reorder context.
+// Components are topologically sorted, so a single sweep suffices.
+// Then bucket the components by level.
+void Opm::ReorderSolverInterface::computeLevels()
+{
+    const int ncomp = components_.size() - 1;
+    const int* comp_ia = reorder_ctx_->comp_ia;
+    const int* comp_ja = reorder_ctx_->comp_ja;
+
+    std::vector<int> comp_level(ncomp, 0);
+    int nlevels = 0;
+    for (int comp = 0; comp < ncomp; ++comp) {
+        int level = 0;
+        for (int j = comp_ia[comp]; j < comp_ia[comp + 1]; ++j) {
+            assert(comp_ja[j] < comp);
+            level = std::max(level, comp_level[comp_ja[j]] + 1);
         }
-#endif
-#endif
-	const int comp_size = components_[comp + 1] - components_[comp];
-	if (comp_size == 1) {
-	    solveSingleCell(sequence_[components_[comp]]);
-	} else {
-	    solveMultiCell(comp_size, &sequence_[components_[comp]]);
-	}
+        comp_level[comp] = level;
+        nlevels = std::max(nlevels, level + 1);
+    }
+
+    level_ptr_.assign(nlevels + 1, 0);
+    for (int comp = 0; comp < ncomp; ++comp) {
+        ++level_ptr_[comp_level[comp] + 1];
+    }
+    std::partial_sum(level_ptr_.begin(), level_ptr_.end(), level_ptr_.begin());
+    level_comps_.resize(ncomp);
+    std::vector<int> pos(level_ptr_.begin(), level_ptr_.end() - 1);
+    for (int comp = 0; comp < ncomp; ++comp) {
+        level_comps_[pos[comp_level[comp]]++] = comp;
     }
 }
 
@@ -75,3 +237,15 @@ const std::vector<int>& Opm::ReorderSolverInterface::components() const
 {
     return components_;
 }
+
+
+const std::vector<int>& Opm::ReorderSolverInterface::levels() const
+{
+    return level_ptr_;
+}
+
+
+const std::vector<int>& Opm::ReorderSolverInterface::levelComponents() const
+{
+    return level_comps_;
+}
@@ -20,9 +20,11 @@
 #ifndef OPM_REORDERSOLVERINTERFACE_HEADER_INCLUDED
 #define OPM_REORDERSOLVERINTERFACE_HEADER_INCLUDED
 
+#include <memory>
 #include <vector>
 
 struct UnstructuredGrid;
+struct ReorderContext;
 
 namespace Opm
 {
@@ -35,20 +37,82 @@ namespace Opm
     /// class.) The reorderAndTransport() method is provided as an aid
     /// to implementing solve() in subclasses, together with the
     /// sequence() and components() methods for accessing the ordering.
+    ///
+    /// Optionally, the strongly connected components may be grouped
+    /// into levels (wavefronts) such that all upwind dependencies of
+    /// a component belong to earlier levels.  Single-cell components
+    /// within a level are then solved concurrently (using OpenMP if
+    /// available), whereas multi-cell components are solved one after
+    /// another.  Subclasses that enable this mode must ensure that
+    /// solveSingleCell() only writes data associated with its own cell
+    /// and its outflow faces.
     class ReorderSolverInterface
     {
     public:
-    virtual ~ReorderSolverInterface() {}
+        ReorderSolverInterface();
+        virtual ~ReorderSolverInterface();
+
+        /// Enable or disable level-scheduled (concurrent) solves.
+        void useLevelScheduling(const bool enable);
+
+        /// Enable or disable parallel computation of the ordering,
+        /// see compute_sequence_context(). The ordering is causal,
+        /// but may differ from the sequential one.
+        void useParallelOrdering(const bool enable);
+
+        /// Use a precomputed ordering, as from compute_sequence(), in
+        /// the next solves instead of computing one from the fluxes.
+        /// The ordering must be valid for the fluxes of those solves.
+        /// Components are solved one after another even if level
+        /// scheduling is enabled. The ordering is kept until the next
+        /// call to clearOrdering(), or until a subclass recomputes it.
+        /// \param[in] sequence    causal cell permutation
+        /// \param[in] components  component start indices into sequence,
+        ///                        number of components + 1 entries
+        void setOrdering(const std::vector<int>& sequence,
+                         const std::vector<int>& components);
+
+        /// Compute the ordering from the fluxes in subsequent solves.
+        void clearOrdering();
+
     private:
 	virtual void solveSingleCell(const int cell) = 0;
 	virtual void solveMultiCell(const int num_cells, const int* cells) = 0;
     protected:
 	void reorderAndTransport(const UnstructuredGrid& grid, const double* darcyflux);
+        /// Solve all components again in the ordering (and levels) of
+        /// the last call to reorderAndTransport(), for example after
+        /// changing inflow values. The fluxes must be unchanged.
+        void transportAgain();
+        /// Compute the ordering (and levels, if level-scheduled)
+        /// without solving, i.e. the first half of reorderAndTransport().
+        void reorder(const UnstructuredGrid& grid, const double* darcyflux);
+        /// Solve the components comps[0] ... comps[num_comps - 1]
+        /// one after another. They must be given in increasing order,
+        /// and all their upwind components must already be solved.
+        void solveComponents(const int num_comps, const int* comps);
         const std::vector<int>& sequence() const;
         const std::vector<int>& components() const;
+        /// Component levels. The components of level l are
+        /// levelComponents()[levels()[l] ... levels()[l+1] - 1].
+        /// Only valid in level-scheduled mode.
+        const std::vector<int>& levels() const;
+        const std::vector<int>& levelComponents() const;
     private:
+        void computeLevels();
+        void solveComponent(const int comp);
+        void solveInOrder(const bool level_scheduled);
+
+        bool level_scheduling_;
+        bool parallel_ordering_;
+        bool ordering_given_;
+        bool last_level_scheduled_;
         std::vector<int> sequence_;
         std::vector<int> components_;
+        // Workspace for the ordering, reused while the grid is the same.
+        std::unique_ptr<ReorderContext, void(*)(ReorderContext*)> reorder_ctx_;
+        std::vector<int> level_ptr_;
+        std::vector<int> level_comps_;
     };
 
 
@@ -23,11 +23,14 @@
 #include <opm/core/props/BlackoilPropertiesInterface.hpp>
 #include <opm/core/grid.h>
 #include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/utility/KernelTimer.hpp>
 #include <opm/core/utility/RootFinders.hpp>
+#include <opm/core/utility/ThreadControl.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/miscUtilitiesBlackoil.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <iterator>
@@ -55,6 +58,7 @@ namespace Opm
           dt_(0.0),
           saturation_(grid.number_of_cells, -1.0),
           fractionalflow_(grid.number_of_cells, -1.0),
+          fractionalflow0_(grid.number_of_cells, -1.0),
           gravity_(0),
           mob_(2*grid.number_of_cells, -1.0),
           ia_upw_(grid.number_of_cells + 1, -1),
@@ -104,6 +108,20 @@ namespace Opm
             OPM_THROW(std::runtime_error, "TransportModelCompressibleTwophase requires a property object without miscibility.");
         }
 
+        // Fractional flows at the initial saturations, evaluated in a
+        // single property call instead of one per single-cell solve.
+        // Every cell enters solveSingleCell() with its initial
+        // saturation, so cells already satisfying the residual there
+        // skip the root finder.
+        const int nc = grid_.number_of_cells;
+        std::vector<double> mob(2*nc);
+        props_.relperm(nc, &saturation[0], &allcells_[0], &mob[0], NULL);
+        for (int c = 0; c < nc; ++c) {
+            const double mw = mob[2*c + 0]/visc_[2*c + 0];
+            const double mo = mob[2*c + 1]/visc_[2*c + 1];
+            fractionalflow0_[c] = mw/(mw + mo);
+        }
+
         std::vector<int> seq(grid_.number_of_cells);
         std::vector<int> comp(grid_.number_of_cells + 1);
         int ncomp;
@@ -185,14 +203,26 @@ namespace Opm
         double operator()(double s) const
         {
             // return s - s0 + dtpv*(outflux*tm.fracFlow(s, cell) + influx + s*comp_term);
-            return s - B_cell*z0 + dtpv*(outflux*tm.fracFlow(s, cell) + influx) + s*comp_term;
+            return residual(s, tm.fracFlow(s, cell));
+        }
+        // Residual given the fractional flow ff = f(s).
+        double residual(double s, double ff) const
+        {
+            return s - B_cell*z0 + dtpv*(outflux*ff + influx) + s*comp_term;
         }
     };
 
 
+    // Only writes the saturation and fractional flow of the cell itself,
+    // as required for level scheduling.
     void TransportSolverCompressibleTwophaseReorder::solveSingleCell(const int cell)
     {
+        OPM_TIMED_KERNEL("solveSingleCell (compressible)", 64);
         Residual res(*this, cell);
+        if (std::fabs(res.residual(saturation_[cell], fractionalflow0_[cell])) <= tol_) {
+            fractionalflow_[cell] = fractionalflow0_[cell];
+            return;
+        }
         int iters_used;
         saturation_[cell] = RootFinder::solve(res, saturation_[cell], 0.0, 1.0, maxit_, tol_, iters_used);
         fractionalflow_[cell] = fracFlow(saturation_[cell], cell);
@@ -473,10 +503,11 @@ namespace Opm
             }
         }
 
-        // Store initial saturation s0
-        s0_.resize(nc);
+        // Store initial saturation s0.  Local, since columns may be
+        // solved concurrently.
+        std::vector<double> s0(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
+            s0[ci] = saturation_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
@@ -488,9 +519,9 @@ namespace Opm
                 const int ci2 = nc - ci - 1;
                 double old_s[2] = { saturation_[cells[ci]],
                                     saturation_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
+                saturation_[cells[ci]] = s0[ci];
                 solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
+                saturation_[cells[ci2]] = s0[ci2];
                 solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
                 max_s_change = std::max(max_s_change, std::max(std::fabs(saturation_[cells[ci]] - old_s[0]),
                                                                std::fabs(saturation_[cells[ci2]] - old_s[1])));
@@ -541,12 +572,18 @@ namespace Opm
         dt_ = dt;
         toWaterSat(saturation, saturation_);
 
-        // Solve on all columns.
-        int num_iters = 0;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns[i]);
-        }
+        // Solve on all columns.  Columns do not interact, and each
+        // column only touches the saturations and mobilities of its
+        // own cells.
+        const int ncol = columns.size();
+        std::atomic<int> num_iters(0);
+        threads::parallelFor(0, ncol, 16, [&](const int begin, const int end) {
+                int iters = 0;
+                for (int i = begin; i < end; ++i) {
+                    iters += solveGravityColumn(columns[i]);
+                }
+                num_iters += iters;
+            }, threads::DynamicSchedule);
         std::cout << "Gauss-Seidel column solver average iterations: "
                   << double(num_iters)/double(columns.size()) << std::endl;
         toBothSat(saturation_, saturation);
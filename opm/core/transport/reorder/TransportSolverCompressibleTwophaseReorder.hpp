@@ -32,6 +32,11 @@ namespace Opm
 
     /// Implements a reordering transport solver for compressible,
     /// non-miscible two-phase flow.
+    ///
+    /// With level scheduling enabled (see useLevelScheduling()), the
+    /// single-cell problems of each wavefront are solved concurrently.
+    /// This requires the property object to be safe for concurrent
+    /// relperm() calls.
     class TransportSolverCompressibleTwophaseReorder : public ReorderSolverInterface
     {
     public:
@@ -75,6 +80,8 @@ namespace Opm
         /// It assumes that the input columns contain cells in a single
         /// vertical stack, that do not interact with other columns (for
         /// gravity segregation.
+        /// With OpenMP, the columns are solved concurrently, so they
+        /// must be disjoint.
         /// \param[in] columns           Vector of cell-columns.
         /// \param[in] dt                Time step.
         /// \param[in, out] saturation   Phase saturations.
@@ -112,13 +119,13 @@ namespace Opm
         double dt_;
         std::vector<double> saturation_;        // P (= num. phases) per cell
         std::vector<double> fractionalflow_;  // = m[0]/(m[0] + m[1]) per cell
+        std::vector<double> fractionalflow0_; // as above, at start of solve()
         // For gravity segregation.
         const double* gravity_;
         std::vector<double> trans_;
         std::vector<double> density_;
         std::vector<double> gravflux_;
         std::vector<double> mob_;
-        std::vector<double> s0_;
 
         // Storing the upwind and downwind graphs for experiments.
         std::vector<int> ia_upw_;
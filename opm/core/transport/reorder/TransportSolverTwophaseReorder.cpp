@@ -21,12 +21,19 @@
 #include <opm/core/transport/reorder/TransportSolverTwophaseReorder.hpp>
 #include <opm/core/props/IncompPropertiesInterface.hpp>
 #include <opm/core/grid.h>
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/linalg/ParallelIstlInformation.hpp>
 #include <opm/core/transport/reorder/reordersequence.h>
 #include <opm/core/grid/ColumnExtract.hpp>
+#include <opm/core/utility/KernelTimer.hpp>
 #include <opm/core/utility/RootFinders.hpp>
+#include <opm/core/utility/ThreadControl.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 
+#include <algorithm>
+#include <cmath>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <iterator>
@@ -41,6 +48,7 @@ namespace Opm
 
     // Choose error policy for scalar solves here.
     typedef RegulaFalsi<WarnAndContinueOnError> RootFinder;
+    typedef SafeguardedNewton<WarnAndContinueOnError> NewtonRootFinder;
 
 
     TransportSolverTwophaseReorder::TransportSolverTwophaseReorder(const UnstructuredGrid& grid,
@@ -52,12 +60,18 @@ namespace Opm
           props_(props),
           tol_(tol),
           maxit_(maxit),
+          use_newton_(false),
+          multicell_linsolver_(0),
+          newton_min_cells_(1000),
+          newton_max_sweeps_(20),
           darcyflux_(0),
           source_(0),
           dt_(0.0),
           saturation_(grid.number_of_cells, -1.0),
           fractionalflow_(grid.number_of_cells, -1.0),
           reorder_iterations_(grid.number_of_cells, 0),
+          max_domain_sweeps_(0),
+          domain_sweeps_(0),
           mob_(2*grid.number_of_cells, -1.0)
 #ifdef EXPERIMENT_GAUSS_SEIDEL
         , ia_upw_(grid.number_of_cells + 1, -1),
@@ -116,7 +130,11 @@ namespace Opm
                                &ia_downw_[0], &ja_downw_[0]);
 #endif
         std::fill(reorder_iterations_.begin(),reorder_iterations_.end(),0);
-        reorderAndTransport(grid_, darcyflux_);
+        if (owner_mask_.empty()) {
+            reorderAndTransport(grid_, darcyflux_);
+        } else {
+            solveDistributed();
+        }
         toBothSat(saturation_, state.saturation());
     }
 
@@ -127,6 +145,154 @@ namespace Opm
     }
 
 
+    void TransportSolverTwophaseReorder::setParallelInformation(const boost::any& parallel_information,
+                                                                const int max_domain_sweeps)
+    {
+        parallel_information_ = boost::any();
+        owner_mask_.clear();
+        max_domain_sweeps_ = max_domain_sweeps;
+        if (parallel_information.empty()) {
+            return;
+        }
+#if HAVE_MPI && HAVE_DUNE_ISTL
+        if (parallel_information.type() != typeid(ParallelISTLInformation)) {
+            OPM_THROW(std::logic_error, "TransportSolverTwophaseReorder requires a ParallelISTLInformation "
+                      "for distributed solves.");
+        }
+        const ParallelISTLInformation& info =
+            boost::any_cast<const ParallelISTLInformation&>(parallel_information);
+        owner_mask_ = info.updateOwnerMask(saturation_);
+        parallel_information_ = parallel_information;
+#else
+        OPM_THROW(std::logic_error, "TransportSolverTwophaseReorder: distributed solves require "
+                  "MPI and dune-istl.");
+#endif
+    }
+
+
+    int TransportSolverTwophaseReorder::getDomainSweeps() const
+    {
+        return domain_sweeps_;
+    }
+
+
+    void TransportSolverTwophaseReorder::solveDistributed()
+    {
+#if HAVE_MPI && HAVE_DUNE_ISTL
+        const ParallelISTLInformation& info =
+            boost::any_cast<const ParallelISTLInformation&>(parallel_information_);
+        const int nc = grid_.number_of_cells;
+        // The single-cell solvers take the initial saturation from
+        // saturation_, so owned cells are reset before every sweep.
+        const std::vector<double> s_init = saturation_;
+        std::vector<double> s_prev;
+        double max_change = 0.0;
+        domain_sweeps_ = 0;
+        do {
+            s_prev = saturation_;
+            // Inflow saturations from the upstream domains.
+            info.copyOwnerToAll(saturation_, saturation_);
+            for (int c = 0; c < nc; ++c) {
+                if (owner_mask_[c] != 0.0) {
+                    saturation_[c] = s_init[c];
+                } else {
+                    fractionalflow_[c] = fracFlow(saturation_[c], c);
+                }
+            }
+            if (domain_sweeps_ == 0) {
+                reorderAndTransport(grid_, darcyflux_);
+            } else {
+                transportAgain();
+            }
+            ++domain_sweeps_;
+            max_change = 0.0;
+            for (int c = 0; c < nc; ++c) {
+                if (owner_mask_[c] != 0.0) {
+                    max_change = std::max(max_change, std::fabs(saturation_[c] - s_prev[c]));
+                }
+            }
+            max_change = info.communicator().max(max_change);
+        } while (max_change > tol_ && domain_sweeps_ < max_domain_sweeps_);
+        if (max_change > tol_) {
+            OPM_THROW(std::runtime_error, "Distributed transport did not converge in "
+                      << domain_sweeps_ << " domain sweeps. Delta s = " << max_change);
+        }
+        info.copyOwnerToAll(saturation_, saturation_);
+#endif
+    }
+
+
+    void TransportSolverTwophaseReorder::useNewtonSingleCell(const bool enable)
+    {
+        use_newton_ = enable;
+    }
+
+
+    void TransportSolverTwophaseReorder::useNewtonMultiCell(const LinearSolverInterface* linsolver,
+                                                            const int min_cells,
+                                                            const int max_sweeps)
+    {
+        multicell_linsolver_ = linsolver;
+        newton_min_cells_ = min_cells;
+        newton_max_sweeps_ = max_sweeps;
+    }
+
+
+    double TransportSolverTwophaseReorder::tabulateFractionalFlow(const int num_samples,
+                                                                  const int* region)
+    {
+        ff_region_.clear();
+        ff_table_.clear();
+        dff_table_.clear();
+        if (num_samples == 0) {
+            return 0.0;
+        }
+        if (num_samples < 2) {
+            OPM_THROW(std::runtime_error, "Fractional flow table needs at least 2 samples, got " << num_samples);
+        }
+
+        const int nc = grid_.number_of_cells;
+        std::vector<int> cell_region(nc, 0);
+        if (region) {
+            std::copy(region, region + nc, cell_region.begin());
+        }
+        const int nreg = nc > 0 ? *std::max_element(cell_region.begin(), cell_region.end()) + 1 : 0;
+
+        // First cell of each region represents it.
+        std::vector<int> repr(nreg, -1);
+        for (int c = nc - 1; c >= 0; --c) {
+            repr[cell_region[c]] = c;
+        }
+
+        std::vector< UniformTableLinear<double> > ff(nreg);
+        std::vector< UniformTableLinear<double> > dff(nreg);
+        std::vector<double> fv(num_samples);
+        std::vector<double> dfv(num_samples);
+        const double ds = 1.0/(num_samples - 1);
+        double max_err = 0.0;
+        for (int r = 0; r < nreg; ++r) {
+            const int cell = repr[r];
+            if (cell < 0) {
+                continue;
+            }
+            for (int i = 0; i < num_samples; ++i) {
+                fv[i] = fracFlow(std::min(i*ds, 1.0), cell, dfv[i]);
+            }
+            ff[r]  = UniformTableLinear<double>(0.0, 1.0, fv);
+            dff[r] = UniformTableLinear<double>(0.0, 1.0, dfv);
+            for (int i = 0; i < num_samples - 1; ++i) {
+                const double s = (i + 0.5)*ds;
+                max_err = std::max(max_err, std::fabs(ff[r](s) - fracFlow(s, cell)));
+            }
+        }
+
+        ff_region_.swap(cell_region);
+        ff_table_.swap(ff);
+        dff_table_.swap(dff);
+        return max_err;
+    }
+
+
     // Residual function r(s) for a single-cell implicit Euler transport
     //
     //     r(s) = s - s0 + dt/pv*( influx + outflux*f(s) )
@@ -183,11 +349,23 @@ namespace Opm
         {
             return s - s0 + dtpv*(outflux*tm.fracFlow(s, cell) + influx);
         }
+        double operator()(double s, double& drds) const
+        {
+            double dfds;
+            const double ff = tm.fracFlow(s, cell, dfds);
+            drds = 1.0 + dtpv*outflux*dfds;
+            return s - s0 + dtpv*(outflux*ff + influx);
+        }
     };
 
 
     void TransportSolverTwophaseReorder::solveSingleCell(const int cell)
     {
+        OPM_TIMED_KERNEL("solveSingleCell", 64);
+        // Overlap cells are solved by their owners.
+        if (!owner_mask_.empty() && owner_mask_[cell] == 0.0) {
+            return;
+        }
         Residual res(*this, cell);
         // const double r0 = res(saturation_[cell]);
         // if (std::fabs(r0) < tol_) {
@@ -195,7 +373,11 @@ namespace Opm
         // }
         int iters_used = 0;
         // saturation_[cell] = modifiedRegulaFalsi(res, smin_[2*cell], smax_[2*cell], maxit_, tol_, iters_used);
-        saturation_[cell] = RootFinder::solve(res, saturation_[cell], 0.0, 1.0, maxit_, tol_, iters_used);
+        if (use_newton_) {
+            saturation_[cell] = NewtonRootFinder::solve(res, saturation_[cell], 0.0, 1.0, maxit_, tol_, iters_used);
+        } else {
+            saturation_[cell] = RootFinder::solve(res, saturation_[cell], 0.0, 1.0, maxit_, tol_, iters_used);
+        }
         // add if it is iteration on an out loop
         reorder_iterations_[cell] = reorder_iterations_[cell] + iters_used;
         fractionalflow_[cell] = fracFlow(saturation_[cell], cell);
@@ -334,7 +516,7 @@ namespace Opm
 
         // Note: partially copied from below.
         const double tol = 1e-9;
-        const int max_iters = 300;
+        const int max_iters = multicell_linsolver_ ? newton_max_sweeps_ : 300;
         // Must store s0 before we start.
         std::vector<double> s0(num_cells);
         // Must set initial fractional flows before we start.
@@ -346,6 +528,10 @@ namespace Opm
             s0[i] = saturation_[cell];
             // num_upstream[i] = ia_upw_[cell + 1] - ia_upw_[cell];
         }
+        if (multicell_linsolver_ && num_cells >= newton_min_cells_) {
+            solveMultiCellNewton(num_cells, cells, pos, s0);
+            return;
+        }
         // Solve once in each cell.
         // std::vector<int> fully_marked_stack;
         // fully_marked_stack.reserve(num_cells);
@@ -410,6 +596,10 @@ namespace Opm
         } while (update_count > 0 && ++num_iters < max_iters);
 
         // Done with iterations, check if we succeeded.
+        if (update_count > 0 && multicell_linsolver_) {
+            solveMultiCellNewton(num_cells, cells, pos, s0);
+            return;
+        }
         if (update_count > 0) {
             OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
                   << num_iters << " iterations. Remaining update count = " << update_count);
@@ -455,8 +645,123 @@ namespace Opm
 #endif // EXPERIMENT_GAUSS_SEIDEL
     }
 
+
+    // Newton's method for the coupled residuals
+    //
+    //     r_i(s) = s_i - s0_i + dt/pv_i*( influx_i + outflux_i*f(s_i) )
+    //
+    // of the cells in a strongly connected component, where influx_i
+    // depends on the saturations of upstream cells in the component.
+    // The Jacobian has 1 + dt/pv_i*outflux_i*f'(s_i) on the diagonal and
+    // dt/pv_i*v_ij*f'(s_j) for each upstream neighbour j in the component.
+    void TransportSolverTwophaseReorder::solveMultiCellNewton(const int num_cells, const int* cells,
+                                                              const std::vector<int>& pos,
+                                                              const std::vector<double>& s0)
+    {
+        const double tol = 1e-9;
+        const int max_iters = 100;
+        // Largest saturation update per iteration, to keep Newton from
+        // overshooting past the inflection points of f.
+        const double max_ds = 0.2;
+        std::vector<int> ia(num_cells + 1);
+        std::vector<int> ja;
+        std::vector<double> sa;
+        std::vector<double> res(num_cells);
+        std::vector<double> ds(num_cells);
+        std::vector<double> dff(num_cells);
+        // Position of column j in the current row, if >= ia[row].
+        std::vector<int> entry(num_cells, -1);
+        ja.reserve(5*num_cells);
+        sa.reserve(5*num_cells);
+        int num_iters = 0;
+        double max_s_change = 0.0;
+        do {
+            for (int i = 0; i < num_cells; ++i) {
+                const int cell = cells[i];
+                fractionalflow_[cell] = fracFlow(saturation_[cell], cell, dff[i]);
+            }
+            ja.clear();
+            sa.clear();
+            for (int i = 0; i < num_cells; ++i) {
+                const int cell = cells[i];
+                ia[i] = ja.size();
+                ja.push_back(i);
+                sa.push_back(1.0);
+                // Overlap cells are solved by their owners.
+                if (!owner_mask_.empty() && owner_mask_[cell] == 0.0) {
+                    res[i] = 0.0;
+                    continue;
+                }
+                Residual r(*this, cell);
+                r.s0 = s0[i];
+                double drds;
+                res[i] = r(saturation_[cell], drds);
+                sa[ia[i]] = drds;
+                for (int hf = grid_.cell_facepos[cell]; hf < grid_.cell_facepos[cell+1]; ++hf) {
+                    const int f = grid_.cell_faces[hf];
+                    double flux;
+                    int other;
+                    if (cell == grid_.face_cells[2*f]) {
+                        flux  = darcyflux_[f];
+                        other = grid_.face_cells[2*f+1];
+                    } else {
+                        flux  =-darcyflux_[f];
+                        other = grid_.face_cells[2*f];
+                    }
+                    if (other == -1 || flux >= 0.0 || pos[other] == -1) {
+                        continue;
+                    }
+                    const int j = pos[other];
+                    if (entry[j] < ia[i]) {
+                        entry[j] = ja.size();
+                        ja.push_back(j);
+                        sa.push_back(0.0);
+                    }
+                    sa[entry[j]] += r.dtpv*flux*dff[j];
+                }
+            }
+            ia[num_cells] = ja.size();
+
+            std::fill(ds.begin(), ds.end(), 0.0);
+            LinearSolverInterface::LinearSolverReport rep
+                = multicell_linsolver_->solve(num_cells, ja.size(), &ia[0], &ja[0], &sa[0],
+                                              &res[0], &ds[0]);
+            if (!rep.converged) {
+                OPM_THROW(std::runtime_error, "In solveMultiCellNewton(), linear solver did not converge for "
+                          << num_cells << " cell component in Newton iteration " << num_iters);
+            }
+            double max_update = 0.0;
+            for (int i = 0; i < num_cells; ++i) {
+                max_update = std::max(max_update, std::fabs(ds[i]));
+            }
+            const double scale = max_update > max_ds ? max_ds/max_update : 1.0;
+            max_s_change = 0.0;
+            for (int i = 0; i < num_cells; ++i) {
+                const int cell = cells[i];
+                const double old_s = saturation_[cell];
+                saturation_[cell] = std::min(std::max(old_s - scale*ds[i], 0.0), 1.0);
+                max_s_change = std::max(max_s_change, std::fabs(saturation_[cell] - old_s));
+            }
+        } while (max_s_change > tol && ++num_iters < max_iters);
+
+        if (max_s_change > tol) {
+            OPM_THROW(std::runtime_error, "In solveMultiCellNewton(), we did not converge after "
+                      << num_iters << " iterations. Delta s = " << max_s_change);
+        }
+        for (int i = 0; i < num_cells; ++i) {
+            const int cell = cells[i];
+            fractionalflow_[cell] = fracFlow(saturation_[cell], cell);
+            reorder_iterations_[cell] += num_iters;
+        }
+        std::cout << "Solved " << num_cells << " cell multicell problem in "
+                  << num_iters << " Newton iterations." << std::endl;
+    }
+
     double TransportSolverTwophaseReorder::fracFlow(double s, int cell) const
     {
+        if (!ff_table_.empty()) {
+            return ff_table_[ff_region_[cell]](s);
+        }
         double sat[2] = { s, 1.0 - s };
         double mob[2];
         props_.relperm(1, sat, &cell, mob, 0);
@@ -466,6 +771,28 @@ namespace Opm
     }
 
 
+    double TransportSolverTwophaseReorder::fracFlow(double s, int cell, double& dfds) const
+    {
+        if (!ff_table_.empty()) {
+            const int r = ff_region_[cell];
+            dfds = dff_table_[r](s);
+            return ff_table_[r](s);
+        }
+        double sat[2] = { s, 1.0 - s };
+        double mob[2];
+        double dmob[4];
+        props_.relperm(1, sat, &cell, mob, dmob);
+        // Fortran order: dmob[i + 2*j] = dkr_i/ds_j, and ds_1/ds = -1.
+        const double dm0 = (dmob[0] - dmob[2])/visc_[0];
+        const double dm1 = (dmob[1] - dmob[3])/visc_[1];
+        mob[0] /= visc_[0];
+        mob[1] /= visc_[1];
+        const double mt = mob[0] + mob[1];
+        dfds = (dm0*mob[1] - mob[0]*dm1)/(mt*mt);
+        return mob[0]/mt;
+    }
+
+
 
 
 
@@ -482,7 +809,8 @@ namespace Opm
         double gf[2];
         const TransportSolverTwophaseReorder& tm;
         explicit GravityResidual(const TransportSolverTwophaseReorder& tmodel,
-                                 const std::vector<int>& cells,
+                                 const int* cells,
+                                 const int num_cells,
                                  const int pos,
                                  const double* gravflux) // Always oriented towards next in column. Size = colsize - 1.
             : tm(tmodel)
@@ -496,7 +824,7 @@ namespace Opm
             }
             nbcell[1] = -1;
             gf[1] = 0.0;
-            if (pos < int(cells.size() - 1)) {
+            if (pos < num_cells - 1) {
                 nbcell[1] = cells[pos + 1];
                 gf[1] = gravflux[pos];
             }
@@ -565,16 +893,49 @@ namespace Opm
     void TransportSolverTwophaseReorder::initColumns()
     {
         extractColumn(grid_, columns_);
+
+        // Gravity flux between consecutive cells of each column,
+        // oriented towards the next cell.  Columns and fluxes are
+        // fixed, so this is done once for all time steps.
+        const int ncol = columns_.size();
+        col_gravflux_pos_.assign(ncol + 1, 0);
+        for (int i = 0; i < ncol; ++i) {
+            const int nc = columns_.rowSize(i);
+            col_gravflux_pos_[i + 1] = col_gravflux_pos_[i] + std::max(nc - 1, 0);
+        }
+        col_gravflux_.assign(col_gravflux_pos_[ncol], 0.0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < ncol; ++i) {
+            const int* cells = columns_[i].begin();
+            const int nc = columns_.rowSize(i);
+            double* col_gravflux = col_gravflux_.data() + col_gravflux_pos_[i];
+            for (int ci = 0; ci < nc - 1; ++ci) {
+                const int cell = cells[ci];
+                const int next_cell = cells[ci + 1];
+                for (int j = grid_.cell_facepos[cell]; j < grid_.cell_facepos[cell+1]; ++j) {
+                    const int face = grid_.cell_faces[j];
+                    const int c1 = grid_.face_cells[2*face + 0];
+                    const int c2 = grid_.face_cells[2*face + 1];
+                    if (c1 == next_cell || c2 == next_cell) {
+                        const double gf = gravflux_[face];
+                        col_gravflux[ci] = (c1 == cell) ? gf : -gf;
+                    }
+                }
+            }
+        }
     }
 
 
 
-    void TransportSolverTwophaseReorder::solveSingleCellGravity(const std::vector<int>& cells,
+    void TransportSolverTwophaseReorder::solveSingleCellGravity(const int* cells,
+                                                                const int num_cells,
                                                                 const int pos,
                                                                 const double* gravflux)
     {
         const int cell = cells[pos];
-        GravityResidual res(*this, cells, pos, gravflux);
+        GravityResidual res(*this, cells, num_cells, pos, gravflux);
         if (std::fabs(res(saturation_[cell])) > tol_) {
             int iters_used = 0;
             saturation_[cell] = RootFinder::solve(res, smin_[2*cell], smax_[2*cell], maxit_, tol_, iters_used);
@@ -586,29 +947,15 @@ namespace Opm
 
 
 
-    int TransportSolverTwophaseReorder::solveGravityColumn(const std::vector<int>& cells)
+    int TransportSolverTwophaseReorder::solveGravityColumn(const int* cells,
+                                                           const int nc,
+                                                           const double* col_gravflux)
     {
-        // Set up column gravflux.
-        const int nc = cells.size();
-        std::vector<double> col_gravflux(nc - 1);
-        for (int ci = 0; ci < nc - 1; ++ci) {
-            const int cell = cells[ci];
-            const int next_cell = cells[ci + 1];
-            for (int j = grid_.cell_facepos[cell]; j < grid_.cell_facepos[cell+1]; ++j) {
-                const int face = grid_.cell_faces[j];
-                const int c1 = grid_.face_cells[2*face + 0];
-                const int c2 = grid_.face_cells[2*face + 1];
-                if (c1 == next_cell || c2 == next_cell) {
-                    const double gf = gravflux_[face];
-                    col_gravflux[ci] = (c1 == cell) ? gf : -gf;
-                }
-            }
-        }
-
-        // Store initial saturation s0
-        s0_.resize(nc);
+        // Store initial saturation s0.  Local, since columns may be
+        // solved concurrently.
+        std::vector<double> s0(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
+            s0[ci] = saturation_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
@@ -620,10 +967,10 @@ namespace Opm
                 const int ci2 = nc - ci - 1;
                 double old_s[2] = { saturation_[cells[ci]],
                                     saturation_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
-                solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
-                solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
+                saturation_[cells[ci]] = s0[ci];
+                solveSingleCellGravity(cells, nc, ci, col_gravflux);
+                saturation_[cells[ci2]] = s0[ci2];
+                solveSingleCellGravity(cells, nc, ci2, col_gravflux);
                 max_s_change = std::max(max_s_change, std::max(std::fabs(saturation_[cells[ci]] - old_s[0]),
                                                                std::fabs(saturation_[cells[ci2]] - old_s[1])));
             }
@@ -643,6 +990,9 @@ namespace Opm
                                                       const double dt,
                                                       TwophaseState& state)
     {
+        if (!owner_mask_.empty()) {
+            OPM_THROW(std::logic_error, "solveGravity() does not support distributed solves.");
+        }
         // Initialize mobilities.
         const int nc = grid_.number_of_cells;
         std::vector<int> cells(nc);
@@ -662,12 +1012,19 @@ namespace Opm
         dt_ = dt;
         toWaterSat(state.saturation(), saturation_);
 
-        // Solve on all columns.
-        int num_iters = 0;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns_.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns_[i]);
-        }
+        // Solve on all columns.  Columns do not interact, and each
+        // column only touches the saturations and mobilities of its
+        // own cells.
+        const int ncol = columns_.size();
+        std::atomic<int> num_iters(0);
+        threads::parallelFor(0, ncol, 16, [&](const int begin, const int end) {
+                int iters = 0;
+                for (int i = begin; i < end; ++i) {
+                    iters += solveGravityColumn(columns_[i].begin(), columns_.rowSize(i),
+                                                col_gravflux_.data() + col_gravflux_pos_[i]);
+                }
+                num_iters += iters;
+            }, threads::DynamicSchedule);
         std::cout << "Gauss-Seidel column solver average iterations: "
                   << double(num_iters)/double(columns_.size()) << std::endl;
 
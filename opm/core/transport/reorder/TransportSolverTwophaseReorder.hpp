@@ -22,6 +22,9 @@
 
 #include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
 #include <opm/core/transport/TransportSolverTwophaseInterface.hpp>
+#include <opm/core/utility/SparseTable.hpp>
+#include <opm/core/utility/UniformTableLinear.hpp>
+#include <boost/any.hpp>
 #include <vector>
 #include <map>
 #include <ostream>
@@ -31,6 +34,7 @@ namespace Opm
 {
 
     class IncompPropertiesInterface;
+    class LinearSolverInterface;
 
     /// Implements a reordering transport solver for incompressible two-phase flow.
     class TransportSolverTwophaseReorder : public TransportSolverTwophaseInterface, ReorderSolverInterface
@@ -68,6 +72,7 @@ namespace Opm
         /// This uses a column-wise nonlinear Gauss-Seidel approach.
         /// It assumes that the grid can be divided into vertical columns
         /// that do not interact with each other (for gravity segregation).
+        /// With OpenMP, the columns are solved concurrently.
         /// \param[in] porevolume        Array of pore volumes.
         /// \param[in] dt                Time step.
         /// \param[in, out] state        Reservoir state. Calling solveGravity() will read state.faceflux() and
@@ -80,16 +85,95 @@ namespace Opm
         //// \return vector of iteration per cell
         const std::vector<int>& getReorderIterations() const;
 
+        /// Solve on a domain decomposition in solve().
+        ///
+        /// The grid is then the local part of a distributed grid, with
+        /// the cells owned by this process and at least one layer of
+        /// overlap cells, and the fluxes are those of a distributed
+        /// pressure solve (zero on faces without an owned cell). Each
+        /// process orders its own cells, and the saturations of overlap
+        /// cells are inflow values taken from their owners. The domains
+        /// are swept block Gauss-Seidel fashion, exchanging the overlap
+        /// saturations between sweeps, until no owned saturation changes
+        /// by more than the tolerance. Without cycles between domains, a
+        /// domain is exact once all its upstream domains are, so the
+        /// number of sweeps is one more than the length of the longest
+        /// chain of domains.
+        ///
+        /// solveGravity() is not supported for distributed solves.
+        /// \param[in] parallel_information  A ParallelISTLInformation,
+        ///                                   or empty for a serial solve.
+        /// \param[in] max_domain_sweeps     Maximum number of sweeps.
+        void setParallelInformation(const boost::any& parallel_information,
+                                    const int max_domain_sweeps = 100);
+
+        /// Number of domain sweeps of the last distributed solve().
+        int getDomainSweeps() const;
+
+        /// Enable or disable concurrent solves of independent
+        /// single-cell problems in solve().
+        using ReorderSolverInterface::useLevelScheduling;
+
+        /// Select the root finder for single-cell problems in solve().
+        /// If enabled, use SafeguardedNewton with the analytic residual
+        /// derivative, otherwise (default) use RegulaFalsi.
+        void useNewtonSingleCell(const bool enable);
+
+        /// Solve large strongly connected components in solve() by
+        /// Newton's method on the coupled cell residuals instead of by
+        /// Gauss-Seidel sweeps over single-cell solves.
+        /// The Newton solver is used directly for components of at
+        /// least min_cells cells, and for smaller components whose
+        /// sweeps have not converged after max_sweeps sweeps, starting
+        /// from the last sweep. Each Newton step solves a linear system
+        /// with the component Jacobian, whose off-diagonal entries are
+        /// the upstream couplings within the component.
+        /// \param[in] linsolver   Solver for the Jacobian systems, e.g. a
+        ///                        direct solver or ILU-preconditioned
+        ///                        GMRES. Must outlive this object, and
+        ///                        must not reuse factorizations, since
+        ///                        the matrices change. Null (default)
+        ///                        disables the Newton solver.
+        /// \param[in] min_cells   Component size for direct Newton solves.
+        /// \param[in] max_sweeps  Sweeps before falling back to Newton.
+        void useNewtonMultiCell(const LinearSolverInterface* linsolver,
+                                const int min_cells = 1000,
+                                const int max_sweeps = 20);
+
+        /// Evaluate the fractional flow in solve() from tables instead
+        /// of through the property object.
+        /// The fractional flow f(s) and its derivative are sampled at
+        /// num_samples uniform saturations in [0, 1] for one
+        /// representative cell of each region.  This is only valid if
+        /// all cells of a region share relative permeability curves,
+        /// e.g. regions from SATNUM without end-point scaling.
+        /// \param[in] num_samples  Number of table entries, at least 2.
+        ///                         Zero disables tabulation.
+        /// \param[in] region       Region index (0-based) of each cell,
+        ///                         or null for a single region.
+        /// \return Largest deviation of the tabulated from the exact
+        ///         fractional flow, measured at the interval midpoints
+        ///         where linear interpolation error peaks.
+        double tabulateFractionalFlow(const int num_samples,
+                                      const int* region = 0);
+
     private:
         void initGravity(const double* grav);
         void initColumns();
+        void solveDistributed();
         virtual void solveSingleCell(const int cell);
         virtual void solveMultiCell(const int num_cells, const int* cells);
+        void solveMultiCellNewton(const int num_cells, const int* cells,
+                                  const std::vector<int>& pos,
+                                  const std::vector<double>& s0);
 
-        void solveSingleCellGravity(const std::vector<int>& cells,
+        void solveSingleCellGravity(const int* cells,
+                                    const int num_cells,
                                     const int pos,
                                     const double* gravflux);
-        int solveGravityColumn(const std::vector<int>& cells);
+        int solveGravityColumn(const int* cells,
+                               const int num_cells,
+                               const double* col_gravflux);
     private:
         const UnstructuredGrid& grid_;
         const IncompPropertiesInterface& props_;
@@ -98,6 +182,16 @@ namespace Opm
         std::vector<double> smax_;
         double tol_;
         int maxit_;
+        bool use_newton_;
+        // Newton multi-cell solver, used if linear solver is non-null.
+        const LinearSolverInterface* multicell_linsolver_;
+        int newton_min_cells_;
+        int newton_max_sweeps_;
+
+        // Fractional flow tables, used if non-empty.
+        std::vector<int> ff_region_;
+        std::vector< UniformTableLinear<double> > ff_table_;
+        std::vector< UniformTableLinear<double> > dff_table_;
 
         const double* darcyflux_;   // one flux per grid face
         const double* porevolume_;  // one volume per cell
@@ -106,12 +200,18 @@ namespace Opm
         std::vector<double> saturation_;        // one per cell, only water saturation!
         std::vector<double> fractionalflow_;  // = m[0]/(m[0] + m[1]) per cell
         std::vector<int> reorder_iterations_;
+        // Domain decomposition, empty for serial solves.
+        boost::any parallel_information_;
+        std::vector<double> owner_mask_;
+        int max_domain_sweeps_;
+        int domain_sweeps_;
         //std::vector<double> reorder_fval_;
         // For gravity segregation.
         std::vector<double> gravflux_;
         std::vector<double> mob_;
-        std::vector<double> s0_;
-        std::vector<std::vector<int> > columns_;
+        SparseTable<int> columns_;
+        std::vector<int> col_gravflux_pos_;  // column start in col_gravflux_
+        std::vector<double> col_gravflux_;   // towards next cell in column
 
         // Storing the upwind and downwind graphs for experiments.
         std::vector<int> ia_upw_;
@@ -121,6 +221,7 @@ namespace Opm
 
         struct Residual;
         double fracFlow(double s, int cell) const;
+        double fracFlow(double s, int cell, double& dfds) const;
 
         struct GravityResidual;
         void mobility(double s, int cell, double* mob) const;
@@ -14,8 +14,13 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <vector>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 struct SortByAbsFlux
 {
     SortByAbsFlux(const double* flux)
@@ -177,6 +182,421 @@ compute_sequence_graph(const struct UnstructuredGrid* grid       ,
 }
 
 
+/* Build the graph of the strongly connected components from the
+   upwind graph (ia, ja).  Upwind components precede their downwind
+   neighbours in the sequence, so all edges point to lower numbers. */
+// ---------------------------------------------------------------------
+static void
+make_component_graph(const int *ia        ,
+                     const int *ja        ,
+                     const int *sequence  ,
+                     const int *components,
+                     int        ncomp     ,
+                     int       *comp_of_cell,
+                     int       *comp_ia   ,
+                     int       *comp_ja   ,
+                     int       *marker    )
+// ---------------------------------------------------------------------
+{
+    int comp, i, j, cell, upw, p;
+
+    for (comp = 0; comp < ncomp; ++comp) {
+        for (i = components[comp]; i < components[comp + 1]; ++i) {
+            comp_of_cell[sequence[i]] = comp;
+        }
+    }
+
+    for (comp = 0; comp < ncomp; ++comp) { marker[comp] = -1; }
+
+    p = 0;
+    comp_ia[0] = p;
+    for (comp = 0; comp < ncomp; ++comp) {
+        for (i = components[comp]; i < components[comp + 1]; ++i) {
+            cell = sequence[i];
+            for (j = ia[cell]; j < ia[cell + 1]; ++j) {
+                upw = comp_of_cell[ja[j]];
+                if ((upw != comp) && (marker[upw] != comp)) {
+                    assert (upw < comp);
+                    marker[upw] = comp;
+                    comp_ja[p++] = upw;
+                }
+            }
+        }
+        comp_ia[comp + 1] = p;
+    }
+}
+
+
+/* Atomically add 'v' to '*x', returning the old value. */
+// ---------------------------------------------------------------------
+static int
+fetch_add(int *x, int v)
+// ---------------------------------------------------------------------
+{
+    int old;
+
+#if defined(_OPENMP)
+#pragma omp atomic capture
+#endif
+    { old = *x; *x += v; }
+
+    return old;
+}
+
+
+/* Construct upwind (ia, ja) and downwind (down_ia, down_ja) graphs wrt
+   flux, one cell per loop iteration.  The upwind graph is identical to
+   that of make_upwind_graph(). */
+// ---------------------------------------------------------------------
+static void
+make_updown_graph_parallel(int           nc       ,
+                           const int    *cellfaces,
+                           const int    *faceptr  ,
+                           const int    *face2cell,
+                           const double *flux     ,
+                           int          *ia       ,
+                           int          *ja       ,
+                           int          *down_ia  ,
+                           int          *down_ja  )
+// ---------------------------------------------------------------------
+{
+    int i;
+
+    ia[0] = down_ia[0] = 0;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (i = 0; i < nc; ++i) {
+        int j, f, nup = 0, ndown = 0;
+        for (j = faceptr[i]; j < faceptr[i + 1]; ++j) {
+            f = cellfaces[j];
+            if ((face2cell[2*f + 0] != -1) && (face2cell[2*f + 1] != -1)) {
+                const double theflux = (i == face2cell[2*f]) ? flux[f] : -flux[f];
+                nup   += (theflux < 0);
+                ndown += (theflux > 0);
+            }
+        }
+        ia     [i + 1] = nup;
+        down_ia[i + 1] = ndown;
+    }
+
+    for (i = 0; i < nc; ++i) {
+        ia     [i + 1] += ia     [i];
+        down_ia[i + 1] += down_ia[i];
+    }
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (i = 0; i < nc; ++i) {
+        int j, f, other, pup = ia[i], pdown = down_ia[i];
+        for (j = faceptr[i]; j < faceptr[i + 1]; ++j) {
+            f = cellfaces[j];
+            if ((face2cell[2*f + 0] != -1) && (face2cell[2*f + 1] != -1)) {
+                const int    first   = (i == face2cell[2*f]);
+                const double theflux = first ? flux[f] : -flux[f];
+                other = face2cell[2*f + first];
+                if      (theflux < 0) { ja     [pup++  ] = other; }
+                else if (theflux > 0) { down_ja[pdown++] = other; }
+            }
+        }
+    }
+}
+
+
+/* Repeatedly move cells whose predecessors (in the graph (ia, ja)) are
+   all placed to the sequence.  Cells of round k are placed at
+   seq[pos ...] for dir > 0 and seq[... pos - 1] for dir < 0, and
+   followed by those of round k + 1.  'count' holds the number of
+   unplaced predecessors of each candidate cell and reaches zero when
+   the cell is placed.  Successors are given by (sia, sja).  Returns
+   the position after the last placed cell. */
+// ---------------------------------------------------------------------
+static int
+trim_parallel(int        dir  ,
+              int        beg  ,
+              int        end  ,
+              const int *sia  ,
+              const int *sja  ,
+              int       *count,
+              int       *seq  )
+// ---------------------------------------------------------------------
+{
+    int pos = end;
+    int i;
+
+    while (beg != end) {
+        if (dir > 0) { std::sort(seq + beg, seq + end); }
+        else         { std::sort(seq + end + 1, seq + beg + 1); }
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 256)
+#endif
+        for (i = 0; i < dir * (end - beg); ++i) {
+            const int c = seq[beg + dir*i];
+            int j, left;
+            for (j = sia[c]; j < sia[c + 1]; ++j) {
+                left = fetch_add(&count[sja[j]], -1) - 1;
+                if (left == 0) {
+                    seq[fetch_add(&pos, dir)] = sja[j];
+                }
+            }
+        }
+
+        beg = end;
+        end = pos;
+    }
+
+    return pos;
+}
+
+
+/* Parallel counterpart of compute_reorder_sequence_graph().  Trims the
+   causally ordered front and back of the graph, and orders only the
+   residual cells using tarjan(). */
+// ---------------------------------------------------------------------
+static void
+compute_reorder_sequence_parallel(struct ReorderContext         *ctx        ,
+                                  const struct UnstructuredGrid *grid       ,
+                                  const double                  *flux       ,
+                                  int                           *sequence   ,
+                                  int                           *components ,
+                                  int                           *ncomponents)
+// ---------------------------------------------------------------------
+{
+    const int nc = grid->number_of_cells;
+    int       i, j, c, nfront, nback, nres, nrescomp, pos, p;
+    int      *ia, *ja, *fcount, *bcount, *loc, *ria, *rja;
+
+    make_updown_graph_parallel(nc, grid->cell_faces, grid->cell_facepos,
+                               grid->face_cells, flux, ctx->ia, ctx->ja,
+                               ctx->down_ia, ctx->down_ja);
+
+    ia     = ctx->ia;
+    ja     = ctx->ja;
+    fcount = ctx->fcount;
+    bcount = ctx->bcount;
+
+    /* Front: cells whose upwind cells are all ordered. */
+    pos = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+    for (c = 0; c < nc; ++c) {
+        fcount[c] = ia[c + 1] - ia[c];
+        if (fcount[c] == 0) {
+            sequence[fetch_add(&pos, 1)] = c;
+        }
+    }
+    nfront = trim_parallel(1, 0, pos, ctx->down_ia, ctx->down_ja,
+                           fcount, sequence);
+
+    /* Back: remaining cells whose downwind cells are all ordered.  The
+       downwind cells of a remaining cell are remaining, too.  Cells of
+       the front get a negative count, so they are never placed again. */
+    pos = nc - 1;
+    if (nfront < nc) {
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (c = 0; c < nc; ++c) {
+            if (fcount[c] > 0) {
+                bcount[c] = ctx->down_ia[c + 1] - ctx->down_ia[c];
+                if (bcount[c] == 0) {
+                    sequence[fetch_add(&pos, -1)] = c;
+                }
+            } else {
+                bcount[c] = -1;
+            }
+        }
+    }
+    nback = nc - 1 - trim_parallel(-1, nc - 1, pos, ia, ja, bcount, sequence);
+
+    /* Residual: cells both downwind and upwind of loops. */
+    nres = nc - nfront - nback;
+    for (i = 0; i <= nfront; ++i) { components[i] = i; }
+    nrescomp = 0;
+    if (nres > 0) {
+        /* Residual upwind subgraph, in local numbering, stored in the
+           component graph arrays. */
+        loc = ctx->comp_of_cell;
+        ria = ctx->comp_ia;
+        rja = ctx->comp_ja;
+        p   = 0;
+        for (c = 0; c < nc; ++c) {
+            if ((fcount[c] > 0) && (bcount[c] > 0)) {
+                loc[c]     = p;
+                ctx->cells[p++] = c;
+            } else {
+                loc[c] = -1;
+            }
+        }
+        assert (p == nres);
+
+        p = 0;
+        ria[0] = p;
+        for (i = 0; i < nres; ++i) {
+            c = ctx->cells[i];
+            for (j = ia[c]; j < ia[c + 1]; ++j) {
+                if (loc[ja[j]] >= 0) { rja[p++] = loc[ja[j]]; }
+            }
+            ria[i + 1] = p;
+        }
+
+        tarjan(nres, ria, rja, sequence + nfront, components + nfront,
+               &nrescomp, ctx->work);
+
+        for (i = 0; i < nres; ++i) {
+            sequence[nfront + i] = ctx->cells[sequence[nfront + i]];
+        }
+        for (i = 0; i <= nrescomp; ++i) {
+            components[nfront + i] += nfront;
+        }
+    }
+    for (i = 0; i < nback; ++i) {
+        components[nfront + nrescomp + 1 + i] = nfront + nres + 1 + i;
+    }
+
+    *ncomponents = nfront + nrescomp + nback;
+}
+
+
+// ---------------------------------------------------------------------
+struct ReorderContext *
+create_reorder_context(const struct UnstructuredGrid *grid)
+// ---------------------------------------------------------------------
+{
+    struct ReorderContext *ctx;
+    std::size_t nc, nf, sz;
+
+    nc = grid->number_of_cells;
+    nf = grid->number_of_faces;
+    sz = std::max(nf, 3 * nc);
+
+    ctx = static_cast<ReorderContext*>(std::malloc(1 * sizeof *ctx));
+
+    if (ctx != NULL) {
+        ctx->number_of_cells = grid->number_of_cells;
+        ctx->number_of_faces = grid->number_of_faces;
+        ctx->ncomponents     = 0;
+        ctx->parallel        = 0;
+
+        ctx->down_ia      = NULL;
+        ctx->down_ja      = NULL;
+        ctx->fcount       = NULL;
+        ctx->bcount       = NULL;
+        ctx->cells        = NULL;
+
+        ctx->ia           = static_cast<int*>(std::malloc((nc + 1)     * sizeof *ctx->ia));
+        ctx->ja           = static_cast<int*>(std::malloc((nf + 1)     * sizeof *ctx->ja));
+        ctx->work         = static_cast<int*>(std::malloc((sz + 1)     * sizeof *ctx->work));
+        ctx->comp_of_cell = static_cast<int*>(std::malloc((nc + 1)     * sizeof *ctx->comp_of_cell));
+        ctx->comp_ia      = static_cast<int*>(std::malloc((nc + 1)     * sizeof *ctx->comp_ia));
+        ctx->comp_ja      = static_cast<int*>(std::malloc((nf + 1)     * sizeof *ctx->comp_ja));
+
+        if ((ctx->ia           == NULL) || (ctx->ja      == NULL) ||
+            (ctx->work         == NULL) ||
+            (ctx->comp_of_cell == NULL) ||
+            (ctx->comp_ia      == NULL) || (ctx->comp_ja == NULL)) {
+            destroy_reorder_context(ctx);
+            ctx = NULL;
+        }
+    }
+
+    return ctx;
+}
+
+
+// ---------------------------------------------------------------------
+void
+destroy_reorder_context(struct ReorderContext *ctx)
+// ---------------------------------------------------------------------
+{
+    if (ctx != NULL) {
+        std::free(ctx->cells);
+        std::free(ctx->bcount);
+        std::free(ctx->fcount);
+        std::free(ctx->down_ja);
+        std::free(ctx->down_ia);
+        std::free(ctx->comp_ja);
+        std::free(ctx->comp_ia);
+        std::free(ctx->comp_of_cell);
+        std::free(ctx->work);
+        std::free(ctx->ja);
+        std::free(ctx->ia);
+    }
+
+    std::free(ctx);
+}
+
+
+// ---------------------------------------------------------------------
+int
+compute_sequence_context(struct ReorderContext*         ctx        ,
+                         const struct UnstructuredGrid* grid       ,
+                         const double*                  flux       ,
+                         int*                           sequence   ,
+                         int*                           components ,
+                         int*                           ncomponents,
+                         int                  compute_component_graph)
+// ---------------------------------------------------------------------
+{
+    if ((ctx->number_of_cells != grid->number_of_cells) ||
+        (ctx->number_of_faces != grid->number_of_faces)) {
+        return 0;
+    }
+
+    if (ctx->parallel) {
+        if (ctx->down_ia == NULL) {
+            const std::size_t nc = grid->number_of_cells;
+            const std::size_t nf = grid->number_of_faces;
+
+            ctx->down_ia = static_cast<int*>(std::malloc((nc + 1) * sizeof *ctx->down_ia));
+            ctx->down_ja = static_cast<int*>(std::malloc((nf + 1) * sizeof *ctx->down_ja));
+            ctx->fcount  = static_cast<int*>(std::malloc((nc + 1) * sizeof *ctx->fcount));
+            ctx->bcount  = static_cast<int*>(std::malloc((nc + 1) * sizeof *ctx->bcount));
+            ctx->cells   = static_cast<int*>(std::malloc((nc + 1) * sizeof *ctx->cells));
+
+            if ((ctx->down_ia == NULL) || (ctx->down_ja == NULL) ||
+                (ctx->fcount  == NULL) || (ctx->bcount  == NULL) ||
+                (ctx->cells   == NULL)) {
+                std::free(ctx->cells);   ctx->cells   = NULL;
+                std::free(ctx->bcount);  ctx->bcount  = NULL;
+                std::free(ctx->fcount);  ctx->fcount  = NULL;
+                std::free(ctx->down_ja); ctx->down_ja = NULL;
+                std::free(ctx->down_ia); ctx->down_ia = NULL;
+                return 0;
+            }
+        }
+
+        compute_reorder_sequence_parallel(ctx, grid, flux, sequence,
+                                          components, ncomponents);
+    } else {
+        compute_reorder_sequence_graph(grid->number_of_cells,
+                                       grid->cell_faces,
+                                       grid->cell_facepos,
+                                       grid->face_cells,
+                                       flux,
+                                       sequence,
+                                       components,
+                                       ncomponents,
+                                       ctx->ia, ctx->ja, ctx->work);
+    }
+
+    ctx->ncomponents = *ncomponents;
+
+    if (compute_component_graph) {
+        make_component_graph(ctx->ia, ctx->ja,
+                             sequence, components, *ncomponents,
+                             ctx->comp_of_cell, ctx->comp_ia, ctx->comp_ja,
+                             ctx->work);
+    }
+
+    return 1;
+}
+
+
 /* Local Variables:    */
 /* c-basic-offset:4    */
 /* End:                */
@@ -138,6 +138,118 @@ compute_sequence_graph(const struct UnstructuredGrid *grid       ,
                        int                           *ia         ,
                        int                           *ja         );
 
+
+/**
+ * Persistent workspace for repeated sequence computations on a
+ * single grid, e.g., once per time step.  Holds the upwind graph and
+ * the work arrays of Tarjan's algorithm, and optionally the graph of
+ * the strongly connected components, so that no memory is allocated
+ * per call.
+ */
+struct ReorderContext {
+    int  number_of_cells;    /**< Number of cells of the grid. */
+    int  number_of_faces;    /**< Number of faces of the grid. */
+
+    int *ia;                 /**< Upwind graph of the most recent
+                                  computation, as for
+                                  compute_sequence_graph().
+                                  <CODE>number_of_cells + 1</CODE>
+                                  entries. */
+    int *ja;                 /**< Upwind cells.
+                                  <CODE>number_of_faces</CODE>
+                                  entries. */
+    int *work;               /**< Scratch array. */
+
+    int  ncomponents;        /**< Number of components of the most
+                                  recent computation. */
+    int *comp_of_cell;       /**< Component of each cell.  Only valid
+                                  if the component graph was
+                                  requested. */
+    int *comp_ia;            /**< Component graph (DAG): the distinct
+                                  upwind components of component
+                                  \f$i\f$ are <CODE>comp_ja[comp_ia[i]
+                                  .. comp_ia[i+1]-1]</CODE>, all less
+                                  than \f$i\f$.  Only valid if the
+                                  component graph was requested. */
+    int *comp_ja;            /**< Upwind components. */
+
+    int  parallel;           /**< If nonzero, use the parallel
+                                  algorithm in
+                                  compute_sequence_context().  Zero
+                                  on creation. */
+    int *down_ia;            /**< Work arrays of the parallel
+                                  algorithm, allocated on first
+                                  use. */
+    int *down_ja;
+    int *fcount;
+    int *bcount;
+    int *cells;
+};
+
+
+/**
+ * Create a reorder context for repeated sequence computations.
+ *
+ * \param[in] grid Grid structure.  Only the number of cells and faces
+ *                 are used.
+ *
+ * \return Allocated context, or @c NULL on allocation failure.  Must
+ *         be destroyed using function destroy_reorder_context().
+ */
+struct ReorderContext *
+create_reorder_context(const struct UnstructuredGrid *grid);
+
+
+/**
+ * Dispose of a reorder context.
+ *
+ * \param[in,out] ctx Context.  May be @c NULL.
+ */
+void
+destroy_reorder_context(struct ReorderContext *ctx);
+
+
+/**
+ * Compute causal permutation sequence, as compute_sequence_graph(),
+ * using a reorder context instead of allocating work arrays.  The
+ * upwind graph is stored in the fields @c ia and @c ja of the context.
+ *
+ * \param[in,out] ctx  Context created for a grid of the same size as
+ *                     @c grid.
+ * \param[in]     grid Grid structure.
+ * \param[in]     flux Darcy flux field, as for compute_sequence().
+ * \param[out]    sequence    As for compute_sequence().
+ * \param[out]    components  As for compute_sequence().
+ * \param[out]    ncomponents As for compute_sequence().
+ * \param[in]     compute_component_graph
+ *                     If nonzero, also fill the fields
+ *                     @c comp_of_cell, @c comp_ia and @c comp_ja of the
+ *                     context with the graph of the strongly connected
+ *                     components.
+ *
+ * If the @c parallel field of the context is nonzero, the upwind
+ * graph is built and trimmed in parallel (using OpenMP if available):
+ * cells all of whose upwind cells are ordered are repeatedly moved to
+ * the front of the sequence, and cells all of whose downwind cells are
+ * ordered to the back.  The cells left over are exactly those that are
+ * both upwind and downwind of some counter-current loop, and only this
+ * residual graph is ordered by Tarjan's algorithm.  The sequence is
+ * causal but may differ from the sequential one.  Within each trimming
+ * round the cells are sorted by index, so the result does not depend
+ * on the number of threads.
+ *
+ * \return One (true) if successful, zero (false) if the context does
+ *         not match the size of the grid or memory allocation fails.
+ */
+int
+compute_sequence_context(struct ReorderContext         *ctx        ,
+                         const struct UnstructuredGrid *grid       ,
+                         const double                  *flux       ,
+                         int                           *sequence   ,
+                         int                           *components ,
+                         int                           *ncomponents,
+                         int                  compute_component_graph);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -0,0 +1,93 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_ALIGNEDALLOCATOR_HEADER_INCLUDED
+#define OPM_ALIGNEDALLOCATOR_HEADER_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace Opm
+{
+
+    /// Standard-conforming allocator that aligns every allocation to
+    /// 'Alignment' bytes, e.g. to cache lines for storage that is
+    /// traversed or filled by several threads.
+    template <typename T, std::size_t Alignment = 64>
+    class AlignedAllocator
+    {
+    public:
+        static_assert((Alignment & (Alignment - 1)) == 0,
+                      "Alignment must be a power of two");
+        static_assert(Alignment >= sizeof(void*),
+                      "Alignment must be at least that of a pointer");
+
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+        AlignedAllocator() {}
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+        T* allocate(const std::size_t n)
+        {
+            if (n > (std::numeric_limits<std::size_t>::max() - Alignment) / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            // Over-allocate, and keep the address of the raw block just
+            // before the aligned one.
+            void* raw = ::operator new(n*sizeof(T) + Alignment);
+            const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+            const std::uintptr_t aligned = (start + Alignment - 1) & ~std::uintptr_t(Alignment - 1);
+            reinterpret_cast<void**>(aligned)[-1] = raw;
+            return reinterpret_cast<T*>(aligned);
+        }
+
+        void deallocate(T* p, std::size_t)
+        {
+            if (p != 0) {
+                ::operator delete(reinterpret_cast<void**>(p)[-1]);
+            }
+        }
+    };
+
+    template <typename T, typename U, std::size_t Alignment>
+    bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, std::size_t Alignment>
+    bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+    {
+        return false;
+    }
+
+} // namespace Opm
+
+#endif // OPM_ALIGNEDALLOCATOR_HEADER_INCLUDED
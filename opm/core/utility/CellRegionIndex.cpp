@@ -0,0 +1,141 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+#include <opm/core/utility/CellRegionIndex.hpp>
+
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace Opm
+{
+
+    namespace
+    {
+        // Cheap fingerprint of a compressed-to-Cartesian mapping, used
+        // to tell grids apart that happen to reuse the address of a
+        // destroyed grid's global_cell array.
+        std::uint64_t mappingHash(const int numCells, const int* globalCell)
+        {
+            std::uint64_t h = 14695981039346656037ull;
+            if (globalCell != 0) {
+                for (int c = 0; c < numCells; ++c) {
+                    h = (h ^ std::uint64_t(std::uint32_t(globalCell[c]))) * 1099511628211ull;
+                }
+            }
+            return h;
+        }
+
+        struct CacheEntry
+        {
+            std::weak_ptr<const EclipseState> state;
+            const EclipseState* state_ptr;
+            std::string keyword;
+            int num_cells;
+            const int* global_cell;
+            std::uint64_t hash;
+            std::shared_ptr<const CellRegionIndex> index;
+        };
+
+        std::mutex& cacheMutex()
+        {
+            static std::mutex m;
+            return m;
+        }
+
+        std::vector<CacheEntry>& cache()
+        {
+            static std::vector<CacheEntry> c;
+            return c;
+        }
+    } // anonymous namespace
+
+
+
+    CellRegionIndex::CellRegionIndex(EclipseStateConstPtr eclState,
+                                     const std::string&   keyword,
+                                     const int            numCells,
+                                     const int*           globalCell)
+        : region_(numCells, 0)
+        , num_regions_(numCells > 0 ? 1 : 0)
+    {
+        if (!eclState->hasDeckIntGridProperty(keyword)) {
+            return;
+        }
+
+        // Eclipse uses Fortran-style region numbers starting at 1.
+        const std::vector<int>& data = eclState->getIntGridProperty(keyword)->getData();
+        const int maxRegion = std::numeric_limits<value_type>::max();
+        for (int c = 0; c < numCells; ++c) {
+            const int r = data[globalCell ? globalCell[c] : c] - 1;
+            if (r < 0 || r > maxRegion) {
+                OPM_THROW(std::runtime_error, "Region keyword " << keyword
+                          << " has unsupported value " << (r + 1));
+            }
+            region_[c] = static_cast<value_type>(r);
+        }
+        if (numCells > 0) {
+            num_regions_ = int(*std::max_element(region_.begin(), region_.end())) + 1;
+        }
+    }
+
+
+
+    std::shared_ptr<const CellRegionIndex>
+    CellRegionIndex::get(EclipseStateConstPtr eclState,
+                         const std::string&   keyword,
+                         const int            numCells,
+                         const int*           globalCell)
+    {
+        const std::uint64_t hash = mappingHash(numCells, globalCell);
+
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        std::vector<CacheEntry>& entries = cache();
+
+        // Drop the entries of input decks that no longer exist.
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const CacheEntry& e) { return e.state.expired(); }),
+                      entries.end());
+
+        for (const auto& e : entries) {
+            if (e.state_ptr == eclState.get() && e.keyword == keyword
+                && e.num_cells == numCells && e.global_cell == globalCell
+                && e.hash == hash) {
+                return e.index;
+            }
+        }
+
+        CacheEntry e;
+        e.state = eclState;
+        e.state_ptr = eclState.get();
+        e.keyword = keyword;
+        e.num_cells = numCells;
+        e.global_cell = globalCell;
+        e.hash = hash;
+        e.index = std::make_shared<CellRegionIndex>(eclState, keyword, numCells, globalCell);
+        entries.push_back(e);
+        return e.index;
+    }
+
+} // namespace Opm
@@ -0,0 +1,95 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CELLREGIONINDEX_HEADER_INCLUDED
+#define OPM_CELLREGIONINDEX_HEADER_INCLUDED
+
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Zero-based region index of each active cell, i.e., the value
+    /// of a region keyword such as 'PVTNUM', 'SATNUM' or 'EQLNUM'
+    /// minus one, stored as 16-bit integers.
+    ///
+    /// Use get() to share one instance among all consumers of the
+    /// same keyword, grid and input deck, so that each region array
+    /// is derived from the EclipseState only once.
+    class CellRegionIndex
+    {
+    public:
+        typedef std::uint16_t                             value_type;
+        typedef std::vector<value_type>::size_type        size_type;
+        typedef std::vector<value_type>::const_iterator   const_iterator;
+
+        /// Constructor.
+        /// \param[in] eclState    Processed input deck.
+        /// \param[in] keyword     Region keyword. If it is not in the
+        ///                        deck, all cells are in region zero.
+        /// \param[in] numCells    Number of active cells.
+        /// \param[in] globalCell  Cartesian index of each active cell,
+        ///                        or null for the identity mapping.
+        CellRegionIndex(EclipseStateConstPtr eclState,
+                        const std::string&   keyword,
+                        const int            numCells,
+                        const int*           globalCell);
+
+        /// Region index of a set of cells, shared with every other
+        /// caller asking for the same keyword, input deck and grid.
+        /// Instances are cached for as long as the EclipseState
+        /// exists. Thread safe.
+        static std::shared_ptr<const CellRegionIndex>
+        get(EclipseStateConstPtr eclState,
+            const std::string&   keyword,
+            const int            numCells,
+            const int*           globalCell);
+
+        /// Region index of active cell c.
+        value_type operator[](const size_type c) const { return region_[c]; }
+
+        /// Number of active cells.
+        size_type size() const { return region_.size(); }
+
+        const_iterator begin() const { return region_.begin(); }
+        const_iterator end() const { return region_.end(); }
+
+        /// One more than the largest region index, zero if no cells.
+        int numRegions() const { return num_regions_; }
+
+        /// Region indices as int, e.g., for interfaces that take a
+        /// std::vector<int> region mapping.
+        std::vector<int> toInt() const
+        {
+            return std::vector<int>(region_.begin(), region_.end());
+        }
+
+    private:
+        std::vector<value_type> region_;
+        int num_regions_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_CELLREGIONINDEX_HEADER_INCLUDED
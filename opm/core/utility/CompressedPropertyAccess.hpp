@@ -483,9 +483,53 @@ namespace Opm {
             value_type
             operator[](const int c) const
             {
+                if (cache_) {
+                    return (*cache_)[c];
+                }
+
                 return x_[ (gc_ == 0) ? c : gc_[c] ];
             }
 
+            /**
+             * Materialise the property values of all active cells in
+             * a contiguous cache.  Subsequent element access reads
+             * the cache rather than translating the cell index and
+             * querying the global data array.  Copies of this object
+             * made after the call share the same cache.
+             *
+             * \param[in] nc Number of active cells.
+             */
+            void
+            gather(const int nc)
+            {
+                std::shared_ptr< std::vector<value_type> >
+                    v(new std::vector<value_type>(nc));
+
+                std::vector<value_type>& vals = *v;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+                for (int c = 0; c < nc; ++c) {
+                    vals[c] = x_[ (gc_ == 0) ? c : gc_[c] ];
+                }
+
+                cache_ = v;
+            }
+
+            /**
+             * Contiguous property values of all active cells.
+             *
+             * 
+eturn Start of the cache created by gather(), or
+             * null if the values have not been gathered.
+             */
+            const value_type*
+            data() const
+            {
+                return cache_ ? cache_->data() : 0;
+            }
+
         private:
             /**
              * Global property value array.
@@ -500,6 +544,12 @@ namespace Opm {
              * cells active.
              */
             const int* gc_;
+
+            /**
+             * Active cell values materialised by gather().  Null if
+             * not gathered.
+             */
+            std::shared_ptr< const std::vector<value_type> > cache_;
         };
     } // namespace GridPropertyAccess
 } // namespace Opm
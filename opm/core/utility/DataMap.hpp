@@ -20,6 +20,7 @@
 #ifndef OPM_DATAMAP_HEADER_INCLUDED
 #define OPM_DATAMAP_HEADER_INCLUDED
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <vector>
@@ -28,6 +29,49 @@ namespace Opm
 {
   /// Intended to map strings (giving the output field names) to data.
   typedef std::map<std::string, const std::vector<double>*> DataMap;
+
+  /// A view of output data in the storage of its owner, such as one
+  /// phase of an interleaved saturation array, with an optional unit
+  /// conversion.  Value i is factor*data[i*stride], for i < count.
+  /// Writers read the values through the view, so that they need
+  /// not be copied before formatting.
+  struct DataView
+  {
+    DataView(const double* data_arg, const int count_arg,
+             const int stride_arg = 1, const double factor_arg = 1.0)
+      : data(data_arg), count(count_arg), stride(stride_arg), factor(factor_arg)
+    {
+    }
+
+    /// View of all values of a vector.
+    DataView(const std::vector<double>& v)
+      : data(v.data()), count(v.size()), stride(1), factor(1.0)
+    {
+    }
+
+    double operator[](const int i) const
+    {
+      return factor*data[std::size_t(i)*stride];
+    }
+
+    const double* data;
+    int count;
+    int stride;
+    double factor;
+  };
+
+  /// Maps output field names to views of their data.
+  typedef std::map<std::string, DataView> DataViewMap;
+
+  /// Views of all the vectors of a DataMap.
+  inline DataViewMap dataViews(const DataMap& data)
+  {
+    DataViewMap views;
+    for (DataMap::const_iterator it = data.begin(); it != data.end(); ++it) {
+      views.insert(views.end(), DataViewMap::value_type(it->first, DataView(*it->second)));
+    }
+    return views;
+  }
 }
 
 #endif
@@ -1,12 +1,26 @@
 #include <opm/core/utility/Event.hpp>
 
+#include <algorithm>
+#include <exception>
+
 using namespace std;
 using namespace Opm;
 
 Event&
 EventSource::add (const std::function<void ()>& handler) {
-    // add handler to the back of the queue
-    handlers_.push_back (handler);
+    return this->add (EventHandler (handler), 0);
+}
+
+Event&
+EventSource::add (const EventHandler& handler, int priority, bool concurrent) {
+    // insert after all handlers with the same or higher priority, so
+    // that handlers of equal priority are called in the order added
+    const Entry entry = { handler, priority, concurrent };
+    auto pos = std::find_if (handlers_.begin (), handlers_.end (),
+                             [priority] (const Entry& e) {
+                                 return e.priority < priority;
+                             });
+    handlers_.insert (pos, entry);
 
     // return ourselves so we can be used in a call chain
     return *this;
@@ -14,9 +28,50 @@ EventSource::add (const std::function<void ()>& handler) {
 
 void
 EventSource::signal () {
-    // loop through the list of handlers, and invoke every one of them
-    // (range-based for loops are not available until GCC 4.6)
-    for (auto it = handlers_.begin(); it != handlers_.end(); ++it) {
-        (*it) ();
+    // invoke the handlers one priority at the time; in each, first the
+    // ordinary handlers in order, and then the concurrent ones together
+    const int n = handlers_.size ();
+    int begin = 0;
+    while (begin < n) {
+        int end = begin;
+        int num_concurrent = 0;
+        while (end < n && handlers_[end].priority == handlers_[begin].priority) {
+            if (handlers_[end].concurrent) {
+                ++num_concurrent;
+            }
+            else {
+                handlers_[end].handler ();
+            }
+            ++end;
+        }
+
+        if (num_concurrent == 1) {
+            for (int i = begin; i < end; ++i) {
+                if (handlers_[i].concurrent) {
+                    handlers_[i].handler ();
+                }
+            }
+        }
+        else if (num_concurrent > 1) {
+            std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int i = begin; i < end; ++i) {
+                if (handlers_[i].concurrent) {
+                    try {
+                        handlers_[i].handler ();
+                    }
+                    catch (...) {
+#pragma omp critical
+                        if (!error) {
+                            error = std::current_exception ();
+                        }
+                    }
+                }
+            }
+            if (error) {
+                std::rethrow_exception (error);
+            }
+        }
+        begin = end;
     }
 }
@@ -4,11 +4,49 @@
 // Copyright (C) 2013 Uni Research AS
 // This file is licensed under the GNU General Public License v3.0
 
+#include <cstddef>
 #include <functional>
-#include <list>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 
+/// Callable object with a buffer for small function objects, such as
+/// bound member functions, so that storing and invoking it does not
+/// allocate. Larger function objects are kept on the heap.
+class EventHandler {
+public:
+    template <typename F, typename = typename std::enable_if <
+                  !std::is_same <typename std::decay <F>::type,
+                                 EventHandler>::value>::type>
+    EventHandler (F f);
+    EventHandler (const EventHandler& other);
+    EventHandler& operator= (const EventHandler& other);
+    ~EventHandler ();
+
+    /// Invoke the function object.
+    void operator() () const { ops_->call (const_cast <void*> (buffer ())); }
+
+private:
+    enum { BufferSize = 4 * sizeof (void*) };
+
+    struct Ops {
+        void (*call) (void*);
+        void (*clone) (const void* from, void* to);
+        void (*destroy) (void*);
+    };
+
+    template <typename F> struct InlineOps;
+    template <typename F> struct HeapOps;
+
+    const void* buffer () const { return &buffer_; }
+    void* buffer () { return &buffer_; }
+
+    typename std::aligned_storage <BufferSize>::type buffer_;
+    const Ops* ops_;
+};
+
 /// Interface to register interest in receiving notifications when a
 /// certain event, such as the completion of a timestep, has happened.
 struct Event {
@@ -29,12 +67,36 @@ struct Event {
     /// more than once.
     virtual Event& add (const std::function <void ()>& handler) = 0;
 
+    /// Register a callback with a priority.
+    ///
+    /// \param[in] handler
+    /// Function object that will be invoked when the event happens.
+    ///
+    /// \param[in] priority
+    /// Handlers with higher priority are invoked first; handlers of
+    /// equal priority in the order they were added. The default
+    /// priority of the other overloads is zero.
+    ///
+    /// \param[in] concurrent
+    /// If true, the handler does not depend on, nor interfere with,
+    /// any other concurrent handler of the same priority, and may run
+    /// at the same time as those, after the non-concurrent handlers of
+    /// that priority.
+    virtual Event& add (const EventHandler& handler,
+                        int priority,
+                        bool concurrent = false) = 0;
+
     /// Convenience routine to add a member function of a class as
     /// an event handler.
     ///
     /// This allows us to have all the necessary information the handler
     /// needs put into an object, and then register this with the event.
     template <typename T, void (T::*member)()> Event& add (T& t);
+
+    /// Add a member function of a class as an event handler with a
+    /// priority, see above.
+    template <typename T, void (T::*member)()>
+    Event& add (T& t, int priority, bool concurrent = false);
 };
 
 /// Generator of event notifications.
@@ -84,10 +146,20 @@ struct Event {
 class EventSource : public Event {
 public:
     virtual Event& add (const std::function <void ()>& handler);
+    virtual Event& add (const EventHandler& handler,
+                        int priority,
+                        bool concurrent = false);
+    using Event::add;
     virtual void signal ();
 protected:
-    /// List of actual handlers that will be called
-    std::list <std::function <void ()> > handlers_;
+    struct Entry {
+        EventHandler handler;
+        int priority;
+        bool concurrent;
+    };
+
+    /// Actual handlers that will be called, by decreasing priority
+    std::vector <Entry> handlers_;
 };
 
 // inline definitions
@@ -5,9 +5,87 @@
 #error Do NOT include this file directly!
 #endif /* OPM_EVENT_HEADER_INCLUDED */
 
+template <typename F>
+struct EventHandler::InlineOps {
+    static void create (const F& f, void* to) { new (to) F (f); }
+    static void call (void* p) { (*static_cast <F*> (p)) (); }
+    static void clone (const void* from, void* to) {
+        new (to) F (*static_cast <const F*> (from));
+    }
+    static void destroy (void* p) { static_cast <F*> (p)->~F (); }
+    static const Ops* get () {
+        static const Ops ops = { &call, &clone, &destroy };
+        return &ops;
+    }
+};
+
+template <typename F>
+struct EventHandler::HeapOps {
+    static void create (const F& f, void* to) { *static_cast <F**> (to) = new F (f); }
+    static void call (void* p) { (**static_cast <F**> (p)) (); }
+    static void clone (const void* from, void* to) {
+        *static_cast <F**> (to) = new F (**static_cast <F* const*> (from));
+    }
+    static void destroy (void* p) { delete *static_cast <F**> (p); }
+    static const Ops* get () {
+        static const Ops ops = { &call, &clone, &destroy };
+        return &ops;
+    }
+};
+
+template <typename F, typename> inline
+EventHandler::EventHandler (F f) {
+    const bool fits = (sizeof (F) <= BufferSize)
+        && (std::alignment_of <F>::value <= std::alignment_of <decltype (buffer_)>::value);
+    if (fits) {
+        InlineOps <F>::create (f, buffer ());
+        ops_ = InlineOps <F>::get ();
+    }
+    else {
+        HeapOps <F>::create (f, buffer ());
+        ops_ = HeapOps <F>::get ();
+    }
+}
+
+inline
+EventHandler::EventHandler (const EventHandler& other)
+    : ops_ (other.ops_) {
+    ops_->clone (other.buffer (), buffer ());
+}
+
+inline EventHandler&
+EventHandler::operator= (const EventHandler& other) {
+    if (this != &other) {
+        ops_->destroy (buffer ());
+        other.ops_->clone (other.buffer (), buffer ());
+        ops_ = other.ops_;
+    }
+    return *this;
+}
+
+inline
+EventHandler::~EventHandler () {
+    ops_->destroy (buffer ());
+}
+
+namespace Details {
+    // call a member function through a pointer; small enough to be
+    // stored inside an EventHandler
+    template <typename T, void (T::*member)()>
+    struct MemberCall {
+        T* t;
+        void operator() () const { (t->*member) (); }
+    };
+}
+
 template <typename T, void (T::*member)()> inline Event&
 Event::add (T& t) {
-    // wrap the member function in a std::function and add that
-    // notice the use of ref() to avoid invoking the copy constructor
-    return this->add (std::bind (member, std::ref(t)));
+    // notice the use of a pointer to avoid invoking the copy constructor
+    return this->add <T, member> (t, 0);
+}
+
+template <typename T, void (T::*member)()> inline Event&
+Event::add (T& t, int priority, bool concurrent) {
+    const Details::MemberCall <T, member> call = { &t };
+    return this->add (EventHandler (call), priority, concurrent);
 }
@@ -0,0 +1,161 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_FIXEDSIZEAD_HEADER_INCLUDED
+#define OPM_FIXEDSIZEAD_HEADER_INCLUDED
+
+namespace Opm
+{
+
+    /// Forward-mode automatic differentiation scalar with a number of
+    /// derivatives fixed at compile time.
+    ///
+    /// The value and derivatives are stored inline, so expressions of
+    /// FixedSizeAd objects never allocate. This is meant for small local
+    /// kernels, such as the flux across a face as a function of the
+    /// unknowns of its two cells, where N is typically 1 or 2.
+    template <int N>
+    class FixedSizeAd
+    {
+    public:
+        enum { NumDerivatives = N };
+
+        /// Construct a constant, zero value.
+        FixedSizeAd()
+            : val_(0.0)
+        {
+            setZeroDerivatives();
+        }
+
+        /// Construct a constant, i.e. a value with zero derivatives.
+        static FixedSizeAd constant(const double val)
+        {
+            FixedSizeAd x;
+            x.val_ = val;
+            return x;
+        }
+
+        /// Construct a value with a single nonzero derivative.
+        /// \param[in] val    Value.
+        /// \param[in] index  Index of the nonzero derivative.
+        /// \param[in] deriv  Derivative with respect to variable index.
+        static FixedSizeAd variable(const double val, const int index, const double deriv = 1.0)
+        {
+            FixedSizeAd x = constant(val);
+            x.der_[index] = deriv;
+            return x;
+        }
+
+        double value() const { return val_; }
+        double derivative(const int i) const { return der_[i]; }
+
+        FixedSizeAd& operator+=(const FixedSizeAd& rhs)
+        {
+            val_ += rhs.val_;
+            for (int i = 0; i < N; ++i) der_[i] += rhs.der_[i];
+            return *this;
+        }
+
+        FixedSizeAd& operator-=(const FixedSizeAd& rhs)
+        {
+            val_ -= rhs.val_;
+            for (int i = 0; i < N; ++i) der_[i] -= rhs.der_[i];
+            return *this;
+        }
+
+        FixedSizeAd& operator*=(const FixedSizeAd& rhs)
+        {
+            for (int i = 0; i < N; ++i) der_[i] = der_[i]*rhs.val_ + val_*rhs.der_[i];
+            val_ *= rhs.val_;
+            return *this;
+        }
+
+        FixedSizeAd& operator/=(const FixedSizeAd& rhs)
+        {
+            const double inv = 1.0/rhs.val_;
+            val_ *= inv;
+            for (int i = 0; i < N; ++i) der_[i] = (der_[i] - val_*rhs.der_[i])*inv;
+            return *this;
+        }
+
+        FixedSizeAd& operator+=(const double rhs) { val_ += rhs; return *this; }
+        FixedSizeAd& operator-=(const double rhs) { val_ -= rhs; return *this; }
+
+        FixedSizeAd& operator*=(const double rhs)
+        {
+            val_ *= rhs;
+            for (int i = 0; i < N; ++i) der_[i] *= rhs;
+            return *this;
+        }
+
+        FixedSizeAd& operator/=(const double rhs)
+        {
+            return *this *= 1.0/rhs;
+        }
+
+        FixedSizeAd operator-() const
+        {
+            FixedSizeAd x(*this);
+            x *= -1.0;
+            return x;
+        }
+
+    private:
+        void setZeroDerivatives()
+        {
+            for (int i = 0; i < N; ++i) der_[i] = 0.0;
+        }
+
+        double val_;
+        double der_[N];
+    };
+
+    template <int N>
+    FixedSizeAd<N> operator+(FixedSizeAd<N> lhs, const FixedSizeAd<N>& rhs) { return lhs += rhs; }
+    template <int N>
+    FixedSizeAd<N> operator-(FixedSizeAd<N> lhs, const FixedSizeAd<N>& rhs) { return lhs -= rhs; }
+    template <int N>
+    FixedSizeAd<N> operator*(FixedSizeAd<N> lhs, const FixedSizeAd<N>& rhs) { return lhs *= rhs; }
+    template <int N>
+    FixedSizeAd<N> operator/(FixedSizeAd<N> lhs, const FixedSizeAd<N>& rhs) { return lhs /= rhs; }
+
+    template <int N>
+    FixedSizeAd<N> operator+(FixedSizeAd<N> lhs, const double rhs) { return lhs += rhs; }
+    template <int N>
+    FixedSizeAd<N> operator-(FixedSizeAd<N> lhs, const double rhs) { return lhs -= rhs; }
+    template <int N>
+    FixedSizeAd<N> operator*(FixedSizeAd<N> lhs, const double rhs) { return lhs *= rhs; }
+    template <int N>
+    FixedSizeAd<N> operator/(FixedSizeAd<N> lhs, const double rhs) { return lhs /= rhs; }
+
+    template <int N>
+    FixedSizeAd<N> operator+(const double lhs, FixedSizeAd<N> rhs) { return rhs += lhs; }
+    template <int N>
+    FixedSizeAd<N> operator-(const double lhs, const FixedSizeAd<N>& rhs) { return -rhs + lhs; }
+    template <int N>
+    FixedSizeAd<N> operator*(const double lhs, FixedSizeAd<N> rhs) { return rhs *= lhs; }
+    template <int N>
+    FixedSizeAd<N> operator/(const double lhs, const FixedSizeAd<N>& rhs)
+    {
+        return FixedSizeAd<N>::constant(lhs) /= rhs;
+    }
+
+} // namespace Opm
+
+#endif // OPM_FIXEDSIZEAD_HEADER_INCLUDED
@@ -0,0 +1,151 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "config.h"
+#include <opm/core/utility/KernelTimer.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace Opm
+{
+
+    namespace time
+    {
+
+        namespace
+        {
+            // Head of the list of all timers, newest first. Constant
+            // initialised, so that timers may register themselves
+            // during static initialisation of other translation units.
+            std::atomic<KernelTimer*> timers_head(nullptr);
+
+            // Filename of reportAtExit(), never destroyed so that it is
+            // valid in the exit handler.
+            std::string* exit_report_file = nullptr;
+            std::mutex exit_report_mutex;
+
+            double tickSeconds()
+            {
+                typedef std::chrono::steady_clock::period Period;
+                return double(Period::num) / double(Period::den);
+            }
+
+            void writeExitReport()
+            {
+                std::lock_guard<std::mutex> lock(exit_report_mutex);
+                if (exit_report_file->empty()) {
+                    KernelTimer::report(std::cerr);
+                } else {
+                    std::ofstream os(exit_report_file->c_str());
+                    KernelTimer::report(os);
+                }
+            }
+        } // anonymous namespace
+
+
+        KernelTimer::KernelTimer(const char* name, const unsigned sample_period)
+            : name_(name),
+              period_(std::max(sample_period, 1u)),
+              timed_calls_(0),
+              ticks_(0),
+              next_(timers_head.load(std::memory_order_relaxed))
+        {
+            while (!timers_head.compare_exchange_weak(next_, this,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+            }
+        }
+
+
+        std::uint64_t KernelTimer::timedCalls() const
+        {
+            return timed_calls_.load(std::memory_order_relaxed);
+        }
+
+
+        double KernelTimer::timedSeconds() const
+        {
+            return ticks_.load(std::memory_order_relaxed) * tickSeconds();
+        }
+
+
+        void KernelTimer::reset()
+        {
+            for (KernelTimer* t = timers_head.load(std::memory_order_acquire); t; t = t->next_) {
+                t->timed_calls_.store(0, std::memory_order_relaxed);
+                t->ticks_.store(0, std::memory_order_relaxed);
+            }
+        }
+
+
+        void KernelTimer::report(std::ostream& os)
+        {
+            std::vector<const KernelTimer*> timers;
+            for (KernelTimer* t = timers_head.load(std::memory_order_acquire); t; t = t->next_) {
+                if (t->timedCalls() > 0) {
+                    timers.push_back(t);
+                }
+            }
+            std::sort(timers.begin(), timers.end(),
+                      [](const KernelTimer* a, const KernelTimer* b) {
+                          return a->timedSeconds()*a->period_ > b->timedSeconds()*b->period_;
+                      });
+            const std::ios::fmtflags flags = os.flags();
+            os << std::left << std::setw(32) << "Kernel" << std::right
+               << std::setw(16) << "calls"
+               << std::setw(14) << "seconds"
+               << std::setw(14) << "us/call"
+               << std::setw(10) << "sampled" << '\n';
+            for (const KernelTimer* t : timers) {
+                const std::uint64_t timed = t->timedCalls();
+                const double secs = t->timedSeconds();
+                os << std::left << std::setw(32) << t->name_ << std::right
+                   << std::setw(16) << timed*t->period_
+                   << std::setw(14) << std::fixed << std::setprecision(3) << secs*t->period_
+                   << std::setw(14) << std::setprecision(3) << 1e6*secs/timed
+                   << std::setw(10) << ("1/" + std::to_string(t->period_)) << '\n';
+                os.flags(flags);
+            }
+            os.flags(flags);
+        }
+
+
+        void KernelTimer::reportAtExit(const std::string& filename)
+        {
+            std::lock_guard<std::mutex> lock(exit_report_mutex);
+            if (exit_report_file) {
+                *exit_report_file = filename;
+            } else {
+                exit_report_file = new std::string(filename);
+                std::atexit(writeExitReport);
+            }
+        }
+
+    } // namespace time
+
+} // namespace Opm
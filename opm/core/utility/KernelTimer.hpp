@@ -0,0 +1,154 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_KERNELTIMER_HEADER_INCLUDED
+#define OPM_KERNELTIMER_HEADER_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace Opm
+{
+
+    namespace time
+    {
+
+        /// Accumulated time of a named kernel, for production profiles
+        /// of functions called too often for the scopes of TimingTree.
+        ///
+        /// Timers are meant to be function-local statics, created
+        /// through the OPM_TIMED_KERNEL macro. They register themselves
+        /// in a global list on construction, and are updated and listed
+        /// without locks, so that they may be used from any thread.
+        /// With a sample period of N, only every N-th call of a thread
+        /// is timed, and the reported calls and total time of the
+        /// kernel are estimated from the timed ones.
+        ///
+        /// Timers are never destroyed, so a report made at exit, see
+        /// reportAtExit(), sees all of them.
+        class KernelTimer
+        {
+        public:
+            /// \param[in] name           Name of the kernel, must outlive
+            ///                           the timer (a string literal).
+            /// \param[in] sample_period  Time one in this many calls.
+            KernelTimer(const char* name, const unsigned sample_period);
+
+            /// Record one timed call lasting the given time, standing
+            /// for sample_period() calls.
+            void add(const std::chrono::steady_clock::duration elapsed)
+            {
+                timed_calls_.fetch_add(1, std::memory_order_relaxed);
+                ticks_.fetch_add(elapsed.count(), std::memory_order_relaxed);
+            }
+
+            const char* name() const { return name_; }
+            unsigned samplePeriod() const { return period_; }
+
+            /// Number of timed calls.
+            std::uint64_t timedCalls() const;
+            /// Seconds spent in the timed calls.
+            double timedSeconds() const;
+
+            /// Set all timers to zero.
+            static void reset();
+
+            /// Print, for every kernel with timed calls, the estimated
+            /// number of calls and total seconds, the mean time per
+            /// call and the sample period, sorted by total time.
+            static void report(std::ostream& os);
+
+            /// Write report() to the given file, or to std::cerr if the
+            /// filename is empty, when the program exits normally. Only
+            /// the last call before exit takes effect.
+            static void reportAtExit(const std::string& filename);
+
+        private:
+            KernelTimer(const KernelTimer&);
+            KernelTimer& operator=(const KernelTimer&);
+
+            const char* name_;
+            unsigned period_;
+            std::atomic<std::uint64_t> timed_calls_;
+            std::atomic<std::chrono::steady_clock::rep> ticks_;
+            KernelTimer* next_;
+        };
+
+        /// Times the enclosing scope in a KernelTimer, if it is the
+        /// call to be sampled. Use through the OPM_TIMED_KERNEL macro.
+        class ScopedKernelTimer
+        {
+        public:
+            /// \param[in] timer      Timer to add to.
+            /// \param[in] countdown  Calls of this thread left until
+            ///                       the next timed one.
+            ScopedKernelTimer(KernelTimer& timer, unsigned& countdown)
+                : timer_(0)
+            {
+                if (--countdown == 0) {
+                    countdown = timer.samplePeriod();
+                    timer_ = &timer;
+                    start_ = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~ScopedKernelTimer()
+            {
+                if (timer_) {
+                    timer_->add(std::chrono::steady_clock::now() - start_);
+                }
+            }
+
+        private:
+            ScopedKernelTimer(const ScopedKernelTimer&);
+            ScopedKernelTimer& operator=(const ScopedKernelTimer&);
+
+            KernelTimer* timer_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+    } // namespace time
+
+} // namespace Opm
+
+/// Time one in sample_period calls of the enclosing scope in the flat
+/// registry of Opm::time::KernelTimer. A scope that is not sampled
+/// costs a decrement of a thread-local counter. Like OPM_TIMED_SCOPE,
+/// compiled in only if OPM_ENABLE_TIMING is defined.
+#ifdef OPM_ENABLE_TIMING
+#define OPM_KERNEL_TIMER_CONCAT_(a, b) a ## b
+#define OPM_KERNEL_TIMER_CONCAT(a, b) OPM_KERNEL_TIMER_CONCAT_(a, b)
+#define OPM_TIMED_KERNEL(name, sample_period)                           \
+    static ::Opm::time::KernelTimer                                     \
+        OPM_KERNEL_TIMER_CONCAT(opm_kernel_timer_, __LINE__)(name, sample_period); \
+    static thread_local unsigned                                        \
+        OPM_KERNEL_TIMER_CONCAT(opm_kernel_countdown_, __LINE__) = 1;   \
+    ::Opm::time::ScopedKernelTimer                                      \
+        OPM_KERNEL_TIMER_CONCAT(opm_kernel_scope_, __LINE__)(          \
+            OPM_KERNEL_TIMER_CONCAT(opm_kernel_timer_, __LINE__),       \
+            OPM_KERNEL_TIMER_CONCAT(opm_kernel_countdown_, __LINE__))
+#else
+#define OPM_TIMED_KERNEL(name, sample_period) do {} while (false)
+#endif
+
+#endif // OPM_KERNELTIMER_HEADER_INCLUDED
@@ -0,0 +1,127 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/utility/MemoryReport.hpp>
+
+#include <iomanip>
+#include <ostream>
+
+namespace Opm
+{
+
+    MemoryReport::MemoryReport(const std::string& name)
+        : name_(name), bytes_(0)
+    {
+    }
+
+
+
+
+    MemoryReport& MemoryReport::child(const std::string& name)
+    {
+        for (const auto& ch : children_) {
+            if (ch->name_ == name) {
+                return *ch;
+            }
+        }
+        children_.emplace_back(new MemoryReport(name));
+        return *children_.back();
+    }
+
+
+
+
+    void MemoryReport::add(const std::size_t bytes)
+    {
+        bytes_ += bytes;
+    }
+
+
+
+
+    void MemoryReport::add(const std::string& name, const std::size_t bytes)
+    {
+        child(name).add(bytes);
+    }
+
+
+
+
+    const std::string& MemoryReport::name() const
+    {
+        return name_;
+    }
+
+
+
+
+    std::size_t MemoryReport::bytes() const
+    {
+        std::size_t total = bytes_;
+        for (const auto& ch : children_) {
+            total += ch->bytes();
+        }
+        return total;
+    }
+
+
+
+
+    int MemoryReport::numChildren() const
+    {
+        return children_.size();
+    }
+
+
+
+
+    const MemoryReport& MemoryReport::childAt(const int i) const
+    {
+        return *children_[i];
+    }
+
+
+
+
+    void MemoryReport::print(std::ostream& os) const
+    {
+        os << std::left << std::setw(40) << "Subsystem" << std::right
+           << std::setw(12) << "MiB" << std::setw(8) << "share" << '\n';
+        print(os, 0, 0);
+    }
+
+
+
+
+    void MemoryReport::print(std::ostream& os, const int depth, const std::size_t parent) const
+    {
+        const std::size_t total = bytes();
+        os << std::setw(2*depth) << "" << std::left << std::setw(40 - 2*depth) << name_ << std::right
+           << std::setw(12) << std::fixed << std::setprecision(3) << total/(1024.0*1024.0)
+           << std::setw(7) << std::setprecision(1)
+           << (parent > 0 ? 100.0*total/parent : 100.0) << "%\n";
+        os.unsetf(std::ios_base::floatfield);
+        for (const auto& ch : children_) {
+            ch->print(os, depth + 1, total);
+        }
+    }
+
+} // namespace Opm
@@ -0,0 +1,91 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_MEMORYREPORT_HEADER_INCLUDED
+#define OPM_MEMORYREPORT_HEADER_INCLUDED
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Tree of the bytes allocated by the subsystems of a run.
+    ///
+    /// Every subsystem that supports it has a method reportMemory()
+    /// adding its allocations, usually as a child node with further
+    /// children for its major parts. The bytes of a node are its own
+    /// plus those of all its descendants. Print the tree with
+    /// SimulatorReport::reportMemory().
+    class MemoryReport
+    {
+    public:
+        /// Empty node with the given name.
+        explicit MemoryReport(const std::string& name = "total");
+
+        /// The child with the given name, created if needed.
+        MemoryReport& child(const std::string& name);
+
+        /// Add bytes to this node.
+        void add(const std::size_t bytes);
+
+        /// Add bytes to the child with the given name.
+        void add(const std::string& name, const std::size_t bytes);
+
+        /// Name of this node.
+        const std::string& name() const;
+
+        /// Bytes of this node and all its descendants.
+        std::size_t bytes() const;
+
+        /// Number of children.
+        int numChildren() const;
+
+        /// The i'th child, in the order they were created.
+        const MemoryReport& childAt(const int i) const;
+
+        /// Print the tree with the MiB and share of the parent of each
+        /// node.
+        void print(std::ostream& os) const;
+
+        /// Bytes allocated by a vector, its capacity included.
+        template <class T>
+        static std::size_t bytes(const std::vector<T>& v)
+        {
+            return v.capacity() * sizeof(T);
+        }
+
+    private:
+        MemoryReport(const MemoryReport&);
+        MemoryReport& operator=(const MemoryReport&);
+
+        void print(std::ostream& os, const int depth, const std::size_t parent) const;
+
+        std::string name_;
+        std::size_t bytes_;
+        std::vector<std::unique_ptr<MemoryReport>> children_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_MEMORYREPORT_HEADER_INCLUDED
@@ -41,6 +41,7 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -118,6 +119,7 @@ bool
 MonotCubicInterpolator::
 read(const std::string & datafilename, int xColumn, int fColumn)
 {
+  unfreeze();
   data.clear() ;
   ddata.clear() ;
 
@@ -170,6 +172,7 @@ addPair(double newx, double newf) throw(const char*) {
   if (std::isnan(newx) || std::isinf(newx) || std::isnan(newf) || std::isinf(newf)) {
     throw("MonotCubicInterpolator: addPair() received inf/nan input.");
   }
+  unfreeze();
   data[newx] = newf ;
 
   // In a critical application, we should only update the
@@ -187,6 +190,10 @@ evaluate(double x) const throw(const char*){
     throw("MonotCubicInterpolator: evaluate() received inf/nan input.");
   }
 
+  if (isFrozen()) {
+    return evaluateFrozen(x);
+  }
+
   // xf becomes the first (xdata,fdata) pair where xdata >= x
   map<double,double>::const_iterator xf_iterator = data.lower_bound(x);
 
@@ -233,6 +240,119 @@ evaluate(double x) const throw(const char*){
 }
 
 
+void
+MonotCubicInterpolator::
+evaluate(int n, const double* x, double* f) const throw(const char*) {
+  for (int i = 0; i < n; ++i) {
+    if (std::isnan(x[i]) || std::isinf(x[i])) {
+      throw("MonotCubicInterpolator: evaluate() received inf/nan input.");
+    }
+  }
+  if (isFrozen()) {
+    for (int i = 0; i < n; ++i) {
+      f[i] = evaluateFrozen(x[i]);
+    }
+  }
+  else {
+    for (int i = 0; i < n; ++i) {
+      f[i] = evaluate(x[i]);
+    }
+  }
+}
+
+
+void
+MonotCubicInterpolator::
+freeze() {
+  unfreeze();
+  if (data.empty()) {
+    return;
+  }
+
+  frozenX.reserve(data.size());
+  frozenF.reserve(data.size());
+  for (map<double,double>::const_iterator it = data.begin(); it != data.end(); ++it) {
+    frozenX.push_back(it->first);
+    frozenF.push_back(it->second);
+  }
+  // Same condition as for cubic interpolation in evaluate():
+  if (ddata.size() == data.size()) {
+    frozenD.reserve(ddata.size());
+    for (map<double,double>::const_iterator it = ddata.begin(); it != ddata.end(); ++it) {
+      frozenD.push_back(it->second);
+    }
+  }
+
+  // Two bins per interval, each starting in the last interval whose
+  // left end is below the bin's left end.
+  const int numIntervals = frozenX.size() - 1;
+  const int numBins = std::max(2*numIntervals, 1);
+  frozenBinXmin = frozenX.front();
+  frozenBinInvWidth = (numIntervals > 0)
+    ? numBins/(frozenX.back() - frozenX.front()) : 0.0;
+  frozenBinStart.resize(numBins);
+  for (int b = 0; b < numBins; ++b) {
+    const double left = (numIntervals > 0) ? frozenBinXmin + b/frozenBinInvWidth : frozenBinXmin;
+    const int j = std::lower_bound(frozenX.begin(), frozenX.end(), left) - frozenX.begin() - 1;
+    frozenBinStart[b] = std::min(std::max(j, 0), std::max(numIntervals - 1, 0));
+  }
+}
+
+
+void
+MonotCubicInterpolator::
+unfreeze() {
+  frozenX.clear();
+  frozenF.clear();
+  frozenD.clear();
+  frozenBinStart.clear();
+}
+
+
+double
+MonotCubicInterpolator::
+evaluateFrozen(double x) const {
+  // Constant extrapolation (!!)
+  if (x <= frozenX.front()) {
+    return frozenF.front();
+  }
+  if (x >= frozenX.back()) {
+    return frozenF.back();
+  }
+
+  // Find the interval j with frozenX[j] < x <= frozenX[j+1], as
+  // lower_bound() does for the map in evaluate(). The bin start is a
+  // lower estimate, up to roundoff in computing the bin.
+  const int numBins = frozenBinStart.size();
+  const int b = std::min(int((x - frozenBinXmin)*frozenBinInvWidth), numBins - 1);
+  int j = frozenBinStart[std::max(b, 0)];
+  while (j > 0 && frozenX[j] >= x) {
+    --j;
+  }
+  while (frozenX[j + 1] < x) {
+    ++j;
+  }
+
+  const double x1 = frozenX[j];
+  const double x2 = frozenX[j + 1];
+  const double f1 = frozenF[j];
+  const double f2 = frozenF[j + 1];
+
+  // Linear interpolation if derivative data is not available:
+  if (frozenD.empty()) {
+    return f1 + (f2 - f1) / (x2 - x1) * (x - x1);
+  }
+  else { // Do Cubic Hermite spline
+    double t = (x - x1)/(x2 - x1); // t \in [0,1]
+    double h = x2 - x1;
+    return f1            * H00(t)
+      + frozenD[j]       * H10(t) * h
+      + f2               * H01(t)
+      + frozenD[j + 1]   * H11(t) * h ;
+  }
+}
+
+
 // double
 // MonotCubicInterpolator::
 // evaluate(double x, double& errorestimate_output) {
@@ -521,6 +641,7 @@ chopFlatEndpoints(const double epsilon) {
     // Clear flags:
     strictlyMonotoneCached = false;
     monotoneCached = false;
+    unfreeze();
 
     // Chop left end:
     xf_iterator = data.begin();
@@ -591,6 +712,7 @@ shrinkFlatAreas(const double epsilon) {
     // data
     strictlyMonotoneCached = false;
     monotoneCached = false;
+    unfreeze();
 
     // Iterate through data values, if two data pairs
     // have equal values, delete one of the data pair.
@@ -716,6 +838,7 @@ adjustDerivativesForMonotoneness() const {
 void
 MonotCubicInterpolator::
 scaleData(double factor) {
+  unfreeze();
   map<double,double>::iterator it , itd  ;
   if (data.size() == ddata.size()) {
     for (it = data.begin() , itd = ddata.begin() ; it != data.end() ; ++it , ++itd) {
@@ -227,6 +227,35 @@ class MonotCubicInterpolator {
    */
    double evaluate(double x, double & errorestimate_output ) const ;
 
+   /**
+      Evaluates f(x) for a number of x values, as evaluate(double)
+      does for each of them.
+
+      @param n Number of x values
+      @param x Array of n x values
+      @param f Array of n function values, output
+   */
+   void evaluate(int n, const double* x, double* f) const throw(const char*);
+
+   /**
+      Copies the function data into sorted contiguous arrays, with a
+      uniform bin index over the x range, and uses those for all
+      subsequent evaluations. This avoids the tree searches of the
+      map-based storage, for objects that are set up once and then
+      evaluated many times.
+
+      Modifying the data, e.g. with addPair(), unfreezes the object.
+   */
+   void freeze();
+
+   /**
+      @return True if freeze() has been called and the data has not
+      been modified since
+   */
+   bool isFrozen() const {
+       return !frozenX.empty();
+   }
+
    /**
       Minimum x-value, returns both x and f in a pair.
 
@@ -500,6 +529,19 @@ private:
    // Data structure to store x- and d-values
    mutable std::map<double, double> ddata;
 
+   // Contiguous copies of data and ddata made by freeze(), empty
+   // unless frozen. frozenD is also empty if ddata is not available,
+   // in which case we interpolate linearly.
+   std::vector<double> frozenX;
+   std::vector<double> frozenF;
+   std::vector<double> frozenD;
+
+   // Uniform bins over [frozenX.front(), frozenX.back()]; bin b starts
+   // in interval frozenBinStart[b].
+   std::vector<int> frozenBinStart;
+   double frozenBinXmin;
+   double frozenBinInvWidth;
+
 
    // Storage containers for precomputed interpolation data
    //   std::vector<double> dvalues; // derivatives in Hermite interpolation.
@@ -540,6 +582,16 @@ private:
 
    void computeInternalFunctionData() const ;
 
+   /**
+      Evaluates using the frozen data, assuming x is not inf/nan.
+   */
+   double evaluateFrozen(double x) const;
+
+   /**
+      Drops the frozen data, to be called when the data is modified.
+   */
+   void unfreeze();
+
    /**
        Computes initial derivative values using centered (second order) difference
        for internal datapoints, and one-sided derivative for endpoints
@@ -77,6 +77,31 @@ namespace Opm
         /// @return f'(x)
         double derivative(const double x) const;
 
+        /// @brief Evaluate the value at x, starting the interval search
+        ///        from a hint.
+        /// @param x a domain value
+        /// @param hint on input a guess for the table interval containing x
+        ///             (any value is allowed), on output the actual interval.
+        /// @return f(x)
+        double operator()(const double x, int& hint) const;
+
+        /// @brief Evaluate the derivative at x, starting the interval
+        ///        search from a hint.
+        /// @param x a domain value
+        /// @param hint as for operator()(x, hint).
+        /// @return f'(x)
+        double derivative(const double x, int& hint) const;
+
+        /// @brief Evaluate values, and optionally derivatives, at many points.
+        /// @param n number of points
+        /// @param x array of n domain values
+        /// @param hints array of n interval hints, updated on output.
+        ///              Typically kept per cell between calls.
+        /// @param f array of n values f(x[i])
+        /// @param dfdx if non-null, array of n derivatives f'(x[i])
+        void evaluate(const int n, const double* x, int* hints,
+                      double* f, double* dfdx = 0) const;
+
         /// @brief Evaluate the inverse at y. Requires T to be a double.
         /// @param y a range value
         /// @return f^{-1}(y)
@@ -203,6 +228,40 @@ namespace Opm
         return Opm::linearInterpolationDerivative(x_values_, y_values_, x);
     }
 
+    template<typename T>
+    inline double
+    NonuniformTableLinear<T>
+    ::operator()(const double x, int& hint) const
+    {
+        return Opm::linearInterpolationHinted(x_values_, y_values_, x, hint);
+    }
+
+    template<typename T>
+    inline double
+    NonuniformTableLinear<T>
+    ::derivative(const double x, int& hint) const
+    {
+        return Opm::linearInterpolationDerivativeHinted(x_values_, y_values_, x, hint);
+    }
+
+    template<typename T>
+    inline void
+    NonuniformTableLinear<T>
+    ::evaluate(const int n, const double* x, int* hints,
+               double* f, double* dfdx) const
+    {
+        for (int i = 0; i < n; ++i) {
+            const int j  = tableIndex(x_values_, x[i], hints[i]);
+            const double slope = (y_values_[j + 1] - y_values_[j])
+                / (x_values_[j + 1] - x_values_[j]);
+            f[i] = slope*(x[i] - x_values_[j]) + y_values_[j];
+            if (dfdx) {
+                dfdx[i] = slope;
+            }
+            hints[i] = j;
+        }
+    }
+
     template<typename T>
     inline double
     NonuniformTableLinear<T>
@@ -22,6 +22,9 @@
 
 #include <boost/range.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 
@@ -84,6 +87,12 @@ namespace Opm
         RegionId
         region(const CellId c) const { return reg_[c]; }
 
+        /**
+         * Regions that contain at least one cell.  In increasing
+         * order if the region IDs are small non-negative integers,
+         * which is the normal case for arrays such as 'EQLNUM' or
+         * 'FIPNUM'.
+         */
         const std::vector<RegionId>&
         activeRegions() const
         {
@@ -100,19 +109,65 @@ namespace Opm
          */
         Range
         cells(const RegionId r) const {
-            const auto id = rev_.binid.find(r);
+            const auto i = rev_.bin(r);
 
-            if (id == rev_.binid.end()) {
+            if (i == rev_.npos()) {
                 // Region 'r' not an active region.  Return empty.
                 return Range(rev_.c.end(), rev_.c.end());
             }
 
-            const auto i = id->second;
-
             return Range(rev_.c.begin() + rev_.p[i + 0],
                          rev_.c.begin() + rev_.p[i + 1]);
         }
 
+        /**
+         * Sum cell values over each active region.
+         *
+         * The cells are split into fixed blocks that are summed in
+         * parallel and then combined in block order, so the result
+         * does not depend on the number of threads.
+         *
+         * \param[in] values One value for each active cell.
+         *
+         * \return Sum of the values of each region, in the order of
+         * activeRegions().
+         */
+        template <typename T>
+        std::vector<T>
+        sumByRegion(const std::vector<T>& values) const
+        {
+            assert (values.size() == reg_.size());
+
+            const int nreg  = rev_.active.size();
+            const int ncell = values.size();
+
+            const int block_size = 16384;
+            const int nblock     = (ncell + block_size - 1) / block_size;
+
+            std::vector<T> partial(std::size_t(nblock) * nreg, T(0));
+
+#pragma omp parallel for schedule(static) if (nblock > 1)
+            for (int b = 0; b < nblock; ++b) {
+                T* sum = &partial[std::size_t(b) * nreg];
+
+                const int end = std::min(ncell, (b + 1) * block_size);
+                for (int i = b * block_size; i < end; ++i) {
+                    sum[ rev_.bin(reg_[i]) ] += values[i];
+                }
+            }
+
+            std::vector<T> total(nreg, T(0));
+            for (int b = 0; b < nblock; ++b) {
+                const T* sum = &partial[std::size_t(b) * nreg];
+
+                for (int r = 0; r < nreg; ++r) {
+                    total[r] += sum[r];
+                }
+            }
+
+            return total;
+        }
+
     private:
         /**
          * Copy of forward region mapping (cell-to-region).
@@ -128,9 +183,34 @@ namespace Opm
             std::unordered_map<RegionId, Pos> binid;
             std::vector<RegionId>             active;
 
+            /**
+             * Region-to-bin table indexed by region ID.  Used instead
+             * of 'binid' if the IDs are small non-negative integers.
+             */
+            std::vector<Pos> dense;
+
             std::vector<Pos>    p;   /**< Region start pointers */
             std::vector<CellId> c;   /**< Region cells */
 
+            static Pos npos() { return std::numeric_limits<Pos>::max(); }
+
+            /**
+             * Bin of region 'r', or npos() if 'r' is not active.
+             */
+            Pos
+            bin(const RegionId r) const
+            {
+                if (! dense.empty() || binid.empty()) {
+                    return (r >= RegionId(0) &&
+                            static_cast<Pos>(r) < dense.size())
+                        ? dense[r] : npos();
+                }
+
+                const auto id = binid.find(r);
+
+                return (id == binid.end()) ? npos() : id->second;
+            }
+
             /**
              * Compute reverse mapping.  Standard linear insertion
              * sort algorithm.
@@ -139,13 +219,37 @@ namespace Opm
             init(const Region& reg)
             {
                 binid.clear();
-                for (const auto& r : reg) {
-                    ++binid[r];
-                }
+                dense.clear();
 
                 p     .clear();  p.emplace_back(0);
                 active.clear();
-                {
+
+                if (isDense(reg)) {
+                    RegionId maxid = RegionId(0);
+                    for (const auto& r : reg) {
+                        maxid = std::max(maxid, r);
+                    }
+
+                    std::vector<Pos> count(static_cast<Pos>(maxid) + 1, 0);
+                    for (const auto& r : reg) {
+                        ++count[r];
+                    }
+
+                    dense.assign(count.size(), npos());
+                    for (Pos id = 0, n = 0; id < count.size(); ++id) {
+                        if (count[id] > 0) {
+                            active.push_back(static_cast<RegionId>(id));
+                            p     .push_back(count[id]);
+
+                            dense[id] = n++;
+                        }
+                    }
+                }
+                else {
+                    for (const auto& r : reg) {
+                        ++binid[r];
+                    }
+
                     Pos n = 0;
                     for (auto& id : binid) {
                         active.push_back(id.first);
@@ -166,13 +270,32 @@ namespace Opm
                 {
                     CellId i = 0;
                     for (const auto& r : reg) {
-                        auto& pos  = p[ binid[r] + 1 ];
+                        auto& pos  = p[ bin(r) + 1 ];
                         c[ pos++ ] = i++;
                     }
                 }
 
                 p[0] = 0;
             }
+
+            /**
+             * Whether all region IDs are non-negative and no larger
+             * than a modest multiple of the number of cells, so that a
+             * table indexed by region ID is cheap.
+             */
+            static bool
+            isDense(const Region& reg)
+            {
+                const Pos limit = 2*static_cast<Pos>(reg.size()) + 1024;
+
+                for (const auto& r : reg) {
+                    if ((r < RegionId(0)) || (static_cast<Pos>(r) > limit)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
         } rev_; /**< Reverse mapping instance */
     };
 
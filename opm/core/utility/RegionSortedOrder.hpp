@@ -0,0 +1,107 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_REGIONSORTEDORDER_HEADER_INCLUDED
+#define OPM_REGIONSORTEDORDER_HEADER_INCLUDED
+
+#include <opm/core/utility/RegionMapping.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm
+{
+
+    /**
+     * Persistent permutation of all cells that groups the cells by
+     * region (e.g., 'PVTNUM' or 'SATNUM'), for evaluating
+     * region-dependent properties one region at a time.  Cells of
+     * each region are kept in increasing order.
+     *
+     * Only evaluations of all cells in natural order are reordered;
+     * other evaluations, and all evaluations in single-region models,
+     * keep the order given.  Results are still stored at the position
+     * of their data point, so the reordering is invisible to callers.
+     */
+    class RegionSortedOrder {
+    public:
+        /**
+         * Default constructor.  Keeps the order of all evaluations.
+         */
+        RegionSortedOrder() {}
+
+        /**
+         * Constructor.
+         *
+         * \param[in] cell_region Region of each active cell.
+         */
+        explicit
+        RegionSortedOrder(const std::vector<int>& cell_region)
+        {
+            const RegionMapping<> rmap(cell_region);
+            if (rmap.activeRegions().size() <= 1) {
+                return;
+            }
+            order_.reserve(cell_region.size());
+            for (const auto& r : rmap.activeRegions()) {
+                for (const auto& c : rmap.cells(r)) {
+                    order_.push_back(static_cast<int>(c));
+                }
+            }
+        }
+
+        /**
+         * Order in which to evaluate a set of data points.
+         *
+         * \param[in] n     Number of data points.
+         * \param[in] cells Cell of each data point.
+         *
+         * \return Data point indices in evaluation order, or null if
+         * the points are to be evaluated in the order given.
+         */
+        const int*
+        order(const int n, const int* cells) const
+        {
+            if (order_.empty() || n != static_cast<int>(order_.size())) {
+                return 0;
+            }
+            for (int i = 0; i < n; ++i) {
+                if (cells[i] != i) {
+                    return 0;
+                }
+            }
+            return order_.data();
+        }
+
+        /**
+         * Bytes allocated for the evaluation order.
+         */
+        std::size_t
+        allocatedBytes() const
+        {
+            return order_.capacity() * sizeof(int);
+        }
+
+    private:
+        std::vector<int> order_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_REGIONSORTEDORDER_HEADER_INCLUDED
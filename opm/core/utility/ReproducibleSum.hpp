@@ -0,0 +1,161 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_REPRODUCIBLESUM_HEADER_INCLUDED
+#define OPM_REPRODUCIBLESUM_HEADER_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Block size of the reproducible reductions.  Fixed, so that the
+    /// summation order does not depend on the number of threads.
+    enum { ReproducibleSumBlockSize = 2048 };
+
+    /// Sum a number of terms, with the same rounding for any number of
+    /// threads.
+    ///
+    /// The index range [0, n) is split into blocks of
+    /// ReproducibleSumBlockSize indices.  Each block is summed in index
+    /// order, blocks are summed concurrently if OpenMP is available, and
+    /// the block sums are then combined pairwise in a fixed binary tree.
+    /// The result is therefore bitwise identical for any number of
+    /// threads, including serial builds, although it generally differs
+    /// in the last bits from a plain sequential sum.
+    ///
+    /// \param[in]  n            Number of terms.
+    /// \param[in]  ncomp        Number of components of each term.
+    /// \param[in]  term         Function object; term(i, t) writes the
+    ///                          ncomp components of term i to t[0], ...,
+    ///                          t[ncomp - 1].  Called concurrently for
+    ///                          different i.
+    /// \param[out] sum          The ncomp component sums.
+    /// \param[in]  compensated  If true, use compensated (Kahan-Babuska)
+    ///                          summation, which bounds the error
+    ///                          independently of n.
+    template <class Term>
+    void reproducibleSum(const int n, const int ncomp, const Term& term,
+                         double* sum, const bool compensated = false)
+    {
+        const int bs = ReproducibleSumBlockSize;
+        const int nblocks = std::max((n + bs - 1) / bs, 1);
+
+        // Sum and compensation of each component, per block.
+        std::vector<double> bsum(nblocks*ncomp, 0.0);
+        std::vector<double> bcomp(nblocks*ncomp, 0.0);
+        std::exception_ptr failure;
+#ifdef _OPENMP
+#pragma omp parallel if (nblocks > 1)
+#endif
+        {
+            std::vector<double> t(ncomp);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (int b = 0; b < nblocks; ++b) {
+                try {
+                    double* s = &bsum[b*ncomp];
+                    double* c = &bcomp[b*ncomp];
+                    const int end = std::min(n, (b + 1)*bs);
+                    for (int i = b*bs; i < end; ++i) {
+                        term(i, t.data());
+                        if (compensated) {
+                            for (int k = 0; k < ncomp; ++k) {
+                                const double y = s[k] + t[k];
+                                c[k] += (std::abs(s[k]) >= std::abs(t[k])) ? (s[k] - y) + t[k]
+                                                                           : (t[k] - y) + s[k];
+                                s[k] = y;
+                            }
+                        } else {
+                            for (int k = 0; k < ncomp; ++k) {
+                                s[k] += t[k];
+                            }
+                        }
+                    }
+                } catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+            }
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+
+        // Combine block sums pairwise.
+        for (int stride = 1; stride < nblocks; stride *= 2) {
+            for (int b = 0; b + stride < nblocks; b += 2*stride) {
+                for (int k = 0; k < ncomp; ++k) {
+                    bsum[b*ncomp + k] += bsum[(b + stride)*ncomp + k];
+                    bcomp[b*ncomp + k] += bcomp[(b + stride)*ncomp + k];
+                }
+            }
+        }
+        for (int k = 0; k < ncomp; ++k) {
+            sum[k] = compensated ? bsum[k] + bcomp[k] : bsum[k];
+        }
+    }
+
+    namespace ReproducibleSumDetail
+    {
+        struct Elements
+        {
+            const double* x;
+            void operator()(const int i, double* t) const { t[0] = x[i]; }
+        };
+
+        struct Products
+        {
+            const double* x;
+            const double* y;
+            void operator()(const int i, double* t) const { t[0] = x[i]*y[i]; }
+        };
+    } // namespace ReproducibleSumDetail
+
+    /// Sum of x[0], ..., x[n - 1], see reproducibleSum().
+    inline double reproducibleSum(const int n, const double* x,
+                                  const bool compensated = false)
+    {
+        const ReproducibleSumDetail::Elements term = { x };
+        double sum;
+        reproducibleSum(n, 1, term, &sum, compensated);
+        return sum;
+    }
+
+    /// Dot product of x and y, each of size n, see reproducibleSum().
+    inline double reproducibleDot(const int n, const double* x, const double* y,
+                                  const bool compensated = false)
+    {
+        const ReproducibleSumDetail::Products term = { x, y };
+        double sum;
+        reproducibleSum(n, 1, term, &sum, compensated);
+        return sum;
+    }
+
+} // namespace Opm
+
+#endif // OPM_REPRODUCIBLESUM_HEADER_INCLUDED
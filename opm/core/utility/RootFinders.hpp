@@ -295,6 +295,119 @@ namespace Opm
 
 
 
+    template <class ErrorPolicy = ThrowOnError>
+    class SafeguardedNewton
+    {
+    public:
+
+
+        /// Newton's method safeguarded by bisection, in the spirit of
+        /// 'rtsafe' from Numerical Recipes.
+        /// The functor must provide
+        ///     double operator()(double x, double& dfdx) const
+        /// returning f(x) and setting dfdx to f'(x).
+        /// Iteration starts at the initial guess without evaluating the
+        /// interval end points.  These are only evaluated if a Newton
+        /// step leaves [a, b] before a sign change has been found.  Once
+        /// the zero is bracketed, the step is bisection whenever the
+        /// Newton step would leave the bracket or fails to halve the
+        /// step before last.
+        template <class Functor>
+        inline static double solve(const Functor& f,
+                                   const double initial_guess,
+                                   const double a,
+                                   const double b,
+                                   const int max_iter,
+                                   const double tolerance,
+                                   int& iterations_used)
+        {
+            using namespace std;
+            const double macheps = numeric_limits<double>::epsilon();
+            const double eps = tolerance + macheps*max(max(fabs(a), fabs(b)), 1.0);
+
+            double x = initial_guess;
+            double df = 0.0;
+            double fx = f(x, df);
+            const double epsF = tolerance + macheps*max(fabs(fx), 1.0);
+            if (fabs(fx) < epsF) {
+                return x;
+            }
+            // xneg and xpos are the latest points with negative and
+            // positive function value, respectively.
+            bool have_neg = fx < 0.0;
+            bool have_pos = !have_neg;
+            double xneg = x;
+            double xpos = x;
+            double dx_old = fabs(b - a);
+            iterations_used = 0;
+            while (true) {
+                const bool bracketed = have_neg && have_pos;
+                const double lo = bracketed ? min(xneg, xpos) : a;
+                const double hi = bracketed ? max(xneg, xpos) : b;
+                if (bracketed && (hi - lo < 1e-9*eps)) {
+                    return 0.5*(lo + hi);
+                }
+                double xnew = x - fx/df;
+                if (bracketed) {
+                    // Negated comparison also catches NaN from df == 0.
+                    if (!(xnew > lo && xnew < hi) || fabs(xnew - x) > 0.5*dx_old) {
+                        xnew = 0.5*(lo + hi);
+                    }
+                } else if (!(xnew > a && xnew < b)) {
+                    // Newton would leave the interval: establish a bracket
+                    // from the end points and continue with that.
+                    double dfa = 0.0;
+                    double dfb = 0.0;
+                    const double fa = f(a, dfa);
+                    const double fb = f(b, dfb);
+                    iterations_used += 2;
+                    if (fabs(fa) < epsF) {
+                        return a;
+                    }
+                    if (fabs(fb) < epsF) {
+                        return b;
+                    }
+                    if (fa*fb > 0.0) {
+                        return ErrorPolicy::handleBracketingFailure(a, b, fa, fb);
+                    }
+                    xneg = (fa < 0.0) ? a : b;
+                    xpos = (fa < 0.0) ? b : a;
+                    have_neg = have_pos = true;
+                    // Restart from the end point closer to the guess,
+                    // since its derivative is at hand.
+                    if (fabs(a - x) < fabs(b - x)) {
+                        x = a; fx = fa; df = dfa;
+                    } else {
+                        x = b; fx = fb; df = dfb;
+                    }
+                    dx_old = fabs(b - a);
+                    continue;
+                }
+                dx_old = fabs(xnew - x);
+                x = xnew;
+                fx = f(x, df);
+                ++iterations_used;
+                if (fabs(fx) < epsF) {
+                    return x;
+                }
+                if (iterations_used > max_iter) {
+                    return ErrorPolicy::handleTooManyIterations(lo, hi, max_iter);
+                }
+                if (fx < 0.0) {
+                    xneg = x;
+                    have_neg = true;
+                } else {
+                    xpos = x;
+                    have_pos = true;
+                }
+            }
+        }
+
+
+    };
+
+
+
     /// Attempts to find an interval bracketing a zero by successive
     /// enlargement of search interval.
     template <class Functor>
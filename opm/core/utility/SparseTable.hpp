@@ -38,8 +38,10 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <string>
 #include <boost/range/iterator_range.hpp>
 #include <opm/common/ErrorMacros.hpp>
+#include <opm/core/utility/AlignedAllocator.hpp>
 
 #include <ostream>
 
@@ -50,6 +52,9 @@ namespace Opm
     /// as efficiently as possible.
     /// It is supposed to behave similarly to a vector of vectors.
     /// Its behaviour is similar to compressed row sparse matrices.
+    /// The table data is aligned to 64 bytes, so that rows filled or
+    /// traversed by different threads start on separate cache lines
+    /// as far as possible.
     template <typename T>
     class SparseTable
     {
@@ -102,6 +107,56 @@ namespace Opm
         }
 
 
+        /// Build a table with a given number of rows in two passes,
+        /// each run in parallel if OpenMP is available.
+        /// \param num_rows  Number of rows.
+        /// \param row_size  Function object; row_size(i) returns the
+        ///                  number of entries of row i.
+        /// \param fill_row  Function object; fill_row(i, p) writes the
+        ///                  entries of row i to p[0], ..., p[row_size(i) - 1].
+        /// Both functions are called concurrently for different rows.
+        template <typename SizeFunc, typename FillFunc>
+        void build(const int num_rows, SizeFunc row_size, FillFunc fill_row)
+        {
+            if (num_rows < 1) {
+                OPM_THROW(std::runtime_error, "Must have at least one row. Got " << num_rows << " rows.");
+            }
+            std::string error;
+            row_start_.resize(num_rows + 1);
+            row_start_[0] = 0;
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < num_rows; ++i) {
+                try {
+                    row_start_[i + 1] = row_size(i);
+                }
+                catch (const std::exception& e) {
+#pragma omp critical
+                    error = e.what();
+                }
+            }
+            if (!error.empty()) {
+                OPM_THROW(std::runtime_error, error);
+            }
+            std::partial_sum(row_start_.begin() + 1, row_start_.end(), row_start_.begin() + 1);
+
+            data_.clear();
+            data_.resize(row_start_.back());
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < num_rows; ++i) {
+                try {
+                    fill_row(i, data_.data() + row_start_[i]);
+                }
+                catch (const std::exception& e) {
+#pragma omp critical
+                    error = e.what();
+                }
+            }
+            if (!error.empty()) {
+                OPM_THROW(std::runtime_error, error);
+            }
+        }
+
+
         /// Appends a row to the table.
         template <typename DataIter>
         void appendRow(DataIter row_beg, DataIter row_end)
@@ -182,6 +237,21 @@ namespace Opm
             return mutable_row_type(start_ptr + row_start_[row], start_ptr + row_start_[row + 1]);
         }
 
+        /// Returns a pointer to the first of the rowSize(row) entries
+        /// of a row.
+        const T* rowData(int row) const
+        {
+            assert(row >= 0 && row < size());
+            return data_.data() + row_start_[row];
+        }
+
+        /// Returns a mutable pointer to the first entry of a row.
+        T* rowData(int row)
+        {
+            assert(row >= 0 && row < size());
+            return data_.data() + row_start_[row];
+        }
+
         /// Equality.
         bool operator==(const SparseTable& other) const
         {
@@ -208,7 +278,7 @@ namespace Opm
         }
 
     private:
-        std::vector<T> data_;
+        std::vector<T, AlignedAllocator<T> > data_;
         // Like in the compressed row sparse matrix format,
         // row_start_.size() is equal to the number of rows + 1.
         std::vector<int> row_start_;
@@ -40,6 +40,7 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <cassert>
 #include <boost/range/iterator_range.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
@@ -51,6 +52,13 @@ namespace Opm
     /// It is supposed to behave similarly to a standard vector, but since
     /// direct indexing is a O(log n) operation instead of O(1), we do not
     /// supply it as operator[].
+    ///
+    /// The nonzero elements are stored in index order, and their indices
+    /// as runs of consecutive indices: only the first index of each run
+    /// and the position of its first element are kept. Vectors from
+    /// discretisations, where nonzeros mostly come in runs, then need far
+    /// less index storage, and dot(), axpy(), gather() and scatter() work
+    /// on contiguous ranges of the dense vector.
     template <typename T>
     class SparseVector
     {
@@ -77,22 +85,25 @@ namespace Opm
 	SparseVector(int sz,
 		     DataIter data_beg, DataIter data_end,
 		     IntegerIter index_beg, IntegerIter index_end)
-	    : size_(sz), data_(data_beg, data_end), indices_(index_beg, index_end),
+	    : size_(sz), data_(data_beg, data_end),
 	      default_elem_()
 	{
 #ifndef NDEBUG
 	    OPM_ERROR_IF(sz < 0, "The size of a SparseVector must be non-negative");
-	    OPM_ERROR_IF(indices_.size() != data_.size(), "The number of indices of a SparseVector must equal to the number of entries");
+	    OPM_ERROR_IF(int(index_end - index_beg) != int(data_.size()), "The number of indices of a SparseVector must equal to the number of entries");
 	    int last_index = -1;
-	    int num_ind = indices_.size();
-	    for (int i = 0; i < num_ind; ++i) {
-		int index = indices_[i];
+	    for (IntegerIter it = index_beg; it != index_end; ++it) {
+		int index = *it;
 		if (index <= last_index || index >= sz) {
 		    OPM_THROW(std::logic_error, "Error in SparseVector construction, index is nonincreasing or out of range.");
 		}
 		last_index = index;
 	    }
 #endif
+	    int pos = 0;
+	    for (IntegerIter it = index_beg; it != index_end; ++it, ++pos) {
+		appendIndex(*it, pos);
+	    }
 	}
 
 
@@ -101,10 +112,10 @@ namespace Opm
 	/// Elements must be added in index order.
 	void addElement(const T& elem, int index)
 	{
-	    assert(indices_.empty() || index > indices_.back());
+	    assert(data_.empty() || index > nonzeroIndex(nonzeroSize() - 1));
 	    assert(index < size_);
+	    appendIndex(index, data_.size());
 	    data_.push_back(elem);
-	    indices_.push_back(index);
 	}
 
 	/// \return true if the vector has size 0.
@@ -126,18 +137,28 @@ namespace Opm
 	    return data_.size();
 	}
 
+	/// Returns the number of runs of consecutive nonzero indices.
+	int numBlocks() const
+	{
+	    return block_index_.size();
+	}
+
 	/// Makes the vector empty().
 	void clear()
 	{
 	    data_.clear();
-	    indices_.clear();
+	    block_index_.clear();
+	    block_start_.clear();
 	    size_ = 0;
 	}
 
 	/// Equality.
 	bool operator==(const SparseVector& other) const
 	{
-	    return size_ == other.size_ && data_ == other.data_ && indices_ == other.indices_;
+	    // The runs are maximal, so equal vectors have equal runs.
+	    return size_ == other.size_ && data_ == other.data_
+		&& block_index_ == other.block_index_
+		&& block_start_ == other.block_start_;
 	}
 
 	/// O(log n) element access.
@@ -150,12 +171,16 @@ namespace Opm
 	    OPM_ERROR_IF(index < 0, "The index of a SparseVector must be non-negative (is " << index << ")");
 	    OPM_ERROR_IF(index >= size_, "The index of a SparseVector must be smaller than the maximum value (is " << index << ", max value: " << size_ <<")");
 #endif
-	    std::vector<int>::const_iterator lb = std::lower_bound(indices_.begin(), indices_.end(), index);
-	    if (lb != indices_.end() && *lb == index) {
-		return data_[lb - indices_.begin()];
-	    } else {
-		return default_elem_;
+	    // Last run starting at or before index.
+	    std::vector<int>::const_iterator ub = std::upper_bound(block_index_.begin(), block_index_.end(), index);
+	    if (ub != block_index_.begin()) {
+		const int b = (ub - block_index_.begin()) - 1;
+		const int offset = index - block_index_[b];
+		if (offset < blockEnd(b) - block_start_[b]) {
+		    return data_[block_start_[b] + offset];
+		}
 	    }
+	    return default_elem_;
 	}
 
 	/// O(1) element access.
@@ -170,25 +195,98 @@ namespace Opm
 	    return data_[nzindex];
 	}
 
-	/// O(1) index access.
+	/// Index access, O(log b) in the number b of runs.
 	/// \param nzindex an index counting only nonzero elements.
 	/// \return the index of the nzindex'th nonzero element.
 	int nonzeroIndex(int nzindex) const
 	{
 	    assert(nzindex >= 0);
 	    assert(nzindex < nonzeroSize());
-	    return indices_[nzindex];
+	    const int b = (std::upper_bound(block_start_.begin(), block_start_.end(), nzindex)
+			   - block_start_.begin()) - 1;
+	    return block_index_[b] + (nzindex - block_start_[b]);
+	}
+
+	/// Dot product with a dense vector.
+	/// \param dense Array of at least size() elements.
+	T dot(const T* dense) const
+	{
+	    T result = T();
+	    for (int b = 0; b < numBlocks(); ++b) {
+		const T* x = dense + block_index_[b];
+		const T* v = data_.data() + block_start_[b];
+		const int n = blockEnd(b) - block_start_[b];
+		for (int i = 0; i < n; ++i) {
+		    result += v[i] * x[i];
+		}
+	    }
+	    return result;
+	}
+
+	/// Adds a multiple of this vector to a dense vector: y += a*this.
+	/// \param y Array of at least size() elements.
+	void axpy(const T& a, T* y) const
+	{
+	    for (int b = 0; b < numBlocks(); ++b) {
+		T* x = y + block_index_[b];
+		const T* v = data_.data() + block_start_[b];
+		const int n = blockEnd(b) - block_start_[b];
+		for (int i = 0; i < n; ++i) {
+		    x[i] += a * v[i];
+		}
+	    }
+	}
+
+	/// Sets the nonzero elements to the values of a dense vector at
+	/// their indices, keeping the sparsity pattern.
+	/// \param dense Array of at least size() elements.
+	void gather(const T* dense)
+	{
+	    for (int b = 0; b < numBlocks(); ++b) {
+		std::copy(dense + block_index_[b],
+			  dense + block_index_[b] + (blockEnd(b) - block_start_[b]),
+			  data_.begin() + block_start_[b]);
+	    }
+	}
+
+	/// Writes the nonzero elements into a dense vector at their
+	/// indices. Other elements of the dense vector are left unchanged.
+	/// \param dense Array of at least size() elements.
+	void scatter(T* dense) const
+	{
+	    for (int b = 0; b < numBlocks(); ++b) {
+		std::copy(data_.begin() + block_start_[b],
+			  data_.begin() + blockEnd(b),
+			  dense + block_index_[b]);
+	    }
 	}
 
     private:
-	// The vectors data_ and indices_ are always the same size.
-	// The indices are supposed to be stored in increasing order,
-	// to be unique, and to be in [0, size_ - 1].
+	// The nonzero elements are data_, in increasing index order.
+	// Run b of consecutive indices starts at index block_index_[b]
+	// and element data_[block_start_[b]], and the runs are maximal.
+	// The indices are supposed to be unique and in [0, size_ - 1].
 	// default_elem_ is returned when a default element is requested.
 	int size_;
 	std::vector<T> data_;
-	std::vector<int> indices_;
+	std::vector<int> block_index_;
+	std::vector<int> block_start_;
 	T default_elem_;
+
+	int blockEnd(int b) const
+	{
+	    return (b + 1 < numBlocks()) ? block_start_[b + 1] : int(data_.size());
+	}
+
+	// Record that element number pos, the last one so far, has
+	// the given index.
+	void appendIndex(int index, int pos)
+	{
+	    if (block_index_.empty() || index != block_index_.back() + (pos - block_start_.back())) {
+		block_index_.push_back(index);
+		block_start_.push_back(pos);
+	    }
+	}
     };
 
 } // namespace Opm
@@ -0,0 +1,105 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/utility/ThreadControl.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <atomic>
+
+namespace Opm
+{
+
+    namespace threads
+    {
+
+        namespace
+        {
+            // Number of threads set by setNumThreads(), zero for the
+            // OpenMP default.
+            std::atomic<int> process_threads(0);
+
+            // Limit of ScopedNumThreads in the calling thread, zero if
+            // none.
+            thread_local int thread_limit = 0;
+        } // anonymous namespace
+
+
+        int numThreads()
+        {
+#ifdef _OPENMP
+            if (thread_limit > 0) {
+                return thread_limit;
+            }
+            const int n = process_threads.load(std::memory_order_relaxed);
+            return n > 0 ? n : omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+
+        void setNumThreads(const int num_threads)
+        {
+#ifdef _OPENMP
+            static const int omp_default = omp_get_max_threads();
+            process_threads.store(std::max(num_threads, 0), std::memory_order_relaxed);
+            omp_set_num_threads(num_threads > 0 ? num_threads : omp_default);
+#else
+            static_cast<void>(num_threads);
+#endif
+        }
+
+
+        void setNumThreads(const parameter::ParameterGroup& param)
+        {
+            if (param.has("num_threads")) {
+                setNumThreads(param.get<int>("num_threads"));
+            }
+        }
+
+
+        ScopedNumThreads::ScopedNumThreads(const int num_threads)
+            : previous_limit_(thread_limit),
+              previous_omp_threads_(0)
+        {
+#ifdef _OPENMP
+            previous_omp_threads_ = omp_get_max_threads();
+            if (num_threads > 0) {
+                thread_limit = num_threads;
+                omp_set_num_threads(num_threads);
+            }
+#else
+            static_cast<void>(num_threads);
+#endif
+        }
+
+
+        ScopedNumThreads::~ScopedNumThreads()
+        {
+            thread_limit = previous_limit_;
+#ifdef _OPENMP
+            omp_set_num_threads(previous_omp_threads_);
+#endif
+        }
+
+    } // namespace threads
+
+} // namespace Opm
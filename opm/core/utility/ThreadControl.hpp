@@ -0,0 +1,147 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_THREADCONTROL_HEADER_INCLUDED
+#define OPM_THREADCONTROL_HEADER_INCLUDED
+
+#include <algorithm>
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Opm
+{
+
+    namespace parameter { class ParameterGroup; }
+
+    /// Control of the threads used by the parallel kernels of opm-core.
+    ///
+    /// The parallel kernels of opm-core all run in the thread pool of
+    /// the OpenMP runtime, whose threads persist between parallel
+    /// regions, rather than in threads of their own. The functions
+    /// here are the single place where an application sets how many
+    /// of them are used:
+    ///
+    ///  - setNumThreads() sets the number for the whole process, e.g.
+    ///    from the num_threads parameter through setNumThreads(param).
+    ///  - ScopedNumThreads limits the kernels called by one thread of
+    ///    an embedding application, e.g. each worker of an ensemble
+    ///    driver, so that the workers together do not oversubscribe
+    ///    the node.
+    ///  - parallelFor() runs the chunks of a loop with the current
+    ///    number of threads, and serially inside another parallel
+    ///    region, so that nested kernels do not multiply the threads.
+    ///
+    /// Without OpenMP, all kernels are serial and numThreads() is one.
+    namespace threads
+    {
+
+        /// Number of threads the parallel kernels called by the calling
+        /// thread may use.
+        int numThreads();
+
+        /// Set the number of threads of the parallel kernels, for the
+        /// calling thread and as the default of parallelFor() in other
+        /// threads. Zero or less restores the OpenMP default, e.g. from
+        /// OMP_NUM_THREADS.
+        void setNumThreads(const int num_threads);
+
+        /// Set the number of threads from the num_threads parameter,
+        /// if given.
+        void setNumThreads(const parameter::ParameterGroup& param);
+
+        /// Limit the parallel kernels called by the calling thread to
+        /// a number of threads, while the object lives.
+        class ScopedNumThreads
+        {
+        public:
+            explicit ScopedNumThreads(const int num_threads);
+            ~ScopedNumThreads();
+
+        private:
+            ScopedNumThreads(const ScopedNumThreads&);
+            ScopedNumThreads& operator=(const ScopedNumThreads&);
+
+            int previous_limit_;
+            int previous_omp_threads_;
+        };
+
+        /// Loop schedules of parallelFor(): static for chunks of equal
+        /// cost, dynamic for chunks of varying cost.
+        enum Schedule { StaticSchedule, DynamicSchedule };
+
+        /// Call body(chunk_begin, chunk_end) for the chunks of grain
+        /// indices of [begin, end), concurrently with numThreads()
+        /// threads. If any call throws, the remaining chunks are still
+        /// processed and the first exception caught is rethrown.
+        template <class Body>
+        void parallelFor(const int begin, const int end, const int grain,
+                         const Body& body, const Schedule schedule = StaticSchedule)
+        {
+            const int g = std::max(grain, 1);
+            const int num_chunks = (end - begin + g - 1) / g;
+            if (num_chunks <= 0) {
+                return;
+            }
+            std::exception_ptr failure;
+            auto chunk = [&](const int k) {
+                try {
+                    const int b = begin + k*g;
+                    body(b, std::min(end, b + g));
+                } catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+            };
+#ifdef _OPENMP
+            const int nt = omp_in_parallel() ? 1 : std::min(numThreads(), num_chunks);
+            if (schedule == DynamicSchedule) {
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nt) if (nt > 1)
+                for (int k = 0; k < num_chunks; ++k) {
+                    chunk(k);
+                }
+            } else {
+#pragma omp parallel for schedule(static) num_threads(nt) if (nt > 1)
+                for (int k = 0; k < num_chunks; ++k) {
+                    chunk(k);
+                }
+            }
+#else
+            static_cast<void>(schedule);
+            for (int k = 0; k < num_chunks; ++k) {
+                chunk(k);
+            }
+#endif
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+    } // namespace threads
+
+} // namespace Opm
+
+#endif // OPM_THREADCONTROL_HEADER_INCLUDED
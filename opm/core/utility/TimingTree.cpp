@@ -0,0 +1,534 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "config.h"
+#include <opm/core/utility/TimingTree.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Opm
+{
+
+    namespace time
+    {
+
+        namespace detail
+        {
+            struct TimingNode
+            {
+                TimingNode(const char* n, TimingNode* p, const bool c)
+                    : key(n), name(n), seconds(0.0), calls(0), counter(c), parent(p)
+                {
+                    reset();
+                }
+
+                void reset()
+                {
+                    seconds = 0.0;
+                    calls = 0;
+                    std::fill(counters, counters + NumCounters, 0);
+                    peak_rss_kb = 0;
+                    rss_growth_kb = 0;
+                }
+
+                // The child with the given name, created if needed.
+                TimingNode* child(const char* n, const bool c)
+                {
+                    for (const auto& ch : children) {
+                        if (ch->key == n && ch->counter == c) {
+                            return ch.get();
+                        }
+                    }
+                    for (const auto& ch : children) {
+                        if (ch->counter == c && std::strcmp(ch->name.c_str(), n) == 0) {
+                            return ch.get();
+                        }
+                    }
+                    children.emplace_back(new TimingNode(n, this, c));
+                    return children.back().get();
+                }
+
+                enum { NumCounters = 3 };
+
+                const char* key;
+                std::string name;
+                double seconds;
+                long calls;
+                // cycles, instructions and last level cache misses
+                long long counters[NumCounters];
+                // peak resident set size of the process at the end of
+                // the scope, and its increase during the scope
+                long peak_rss_kb;
+                long rss_growth_kb;
+                bool counter;
+                TimingNode* parent;
+                std::vector<std::unique_ptr<TimingNode>> children;
+            };
+        } // namespace detail
+
+
+        namespace
+        {
+            using detail::TimingNode;
+            typedef std::chrono::steady_clock Clock;
+
+            struct TraceEvent
+            {
+                const TimingNode* node;
+                double start;    // microseconds since the epoch of the registry
+                double duration; // microseconds
+            };
+
+            // Hardware counters of one thread, opened on first use as
+            // a group, so that they are read with a single system call.
+            class HardwareCounters
+            {
+            public:
+                HardwareCounters() : leader_(-1), opened_(false) {}
+
+                ~HardwareCounters()
+                {
+#ifdef __linux__
+                    for (const int fd : fds_) {
+                        close(fd);
+                    }
+#endif
+                }
+
+                bool available()
+                {
+                    open();
+                    return leader_ >= 0;
+                }
+
+                // Current values, or zeros if not available.
+                void read(long long* values)
+                {
+                    std::fill(values, values + TimingNode::NumCounters, 0);
+#ifdef __linux__
+                    if (!available()) {
+                        return;
+                    }
+                    struct { unsigned long long nr; unsigned long long values[TimingNode::NumCounters]; } group;
+                    if (::read(leader_, &group, sizeof(group)) == ssize_t(sizeof(group))) {
+                        std::copy(group.values, group.values + TimingNode::NumCounters, values);
+                    }
+#endif
+                }
+
+            private:
+                void open()
+                {
+                    if (opened_) {
+                        return;
+                    }
+                    opened_ = true;
+#ifdef __linux__
+                    const unsigned long long config[TimingNode::NumCounters] = {
+                        PERF_COUNT_HW_CPU_CYCLES,
+                        PERF_COUNT_HW_INSTRUCTIONS,
+                        PERF_COUNT_HW_CACHE_MISSES
+                    };
+                    for (int i = 0; i < TimingNode::NumCounters; ++i) {
+                        struct perf_event_attr attr;
+                        std::memset(&attr, 0, sizeof(attr));
+                        attr.size = sizeof(attr);
+                        attr.type = PERF_TYPE_HARDWARE;
+                        attr.config = config[i];
+                        attr.read_format = PERF_FORMAT_GROUP;
+                        attr.exclude_kernel = 1;
+                        attr.exclude_hv = 1;
+                        // this thread, on any cpu
+                        const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, fds_.empty() ? -1 : fds_.front(), 0);
+                        if (fd < 0) {
+                            for (const int f : fds_) {
+                                close(f);
+                            }
+                            fds_.clear();
+                            return;
+                        }
+                        fds_.push_back(fd);
+                    }
+                    leader_ = fds_.front();
+#endif
+                }
+
+                int leader_;
+                bool opened_;
+                std::vector<int> fds_;
+            };
+
+            // Peak resident set size of the process in kB.
+            long peakRssKb()
+            {
+#ifdef __linux__
+                struct rusage usage;
+                if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                    return usage.ru_maxrss;
+                }
+#endif
+                return 0;
+            }
+
+            struct ThreadTimings
+            {
+                explicit ThreadTimings(const int id)
+                    : root("", 0, false), current(&root), thread_id(id)
+                {}
+
+                TimingNode root;
+                TimingNode* current;
+                int thread_id;
+                std::vector<TraceEvent> events;
+                HardwareCounters counters;
+            };
+
+            struct Registry
+            {
+                Registry() : epoch(Clock::now()), tracing(false), hardware(false) {}
+
+                std::mutex mutex;
+                std::vector<std::unique_ptr<ThreadTimings>> threads;
+                Clock::time_point epoch;
+                std::atomic<bool> tracing;
+                std::atomic<bool> hardware;
+            };
+
+            Registry& registry()
+            {
+                static Registry r;
+                return r;
+            }
+
+            // Timings of the calling thread. They are owned by the
+            // registry, so they outlive the thread.
+            ThreadTimings& threadTimings()
+            {
+                static thread_local ThreadTimings* timings = 0;
+                if (timings == 0) {
+                    Registry& r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.threads.emplace_back(new ThreadTimings(static_cast<int>(r.threads.size())));
+                    timings = r.threads.back().get();
+                }
+                return *timings;
+            }
+
+            void resetNode(TimingNode& node)
+            {
+                node.reset();
+                for (const auto& ch : node.children) {
+                    resetNode(*ch);
+                }
+            }
+
+            void mergeNode(const TimingNode& from, TimingNode& into)
+            {
+                into.seconds += from.seconds;
+                into.calls += from.calls;
+                for (int i = 0; i < TimingNode::NumCounters; ++i) {
+                    into.counters[i] += from.counters[i];
+                }
+                into.peak_rss_kb = std::max(into.peak_rss_kb, from.peak_rss_kb);
+                into.rss_growth_kb += from.rss_growth_kb;
+                for (const auto& ch : from.children) {
+                    mergeNode(*ch, *into.child(ch->name.c_str(), ch->counter));
+                }
+            }
+
+            // Sum of the timings of all threads.
+            std::unique_ptr<TimingNode> mergedTree()
+            {
+                std::unique_ptr<TimingNode> merged(new TimingNode("total", 0, false));
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                for (const auto& t : r.threads) {
+                    for (const auto& ch : t->root.children) {
+                        mergeNode(*ch, *merged->child(ch->name.c_str(), ch->counter));
+                    }
+                }
+                for (const auto& ch : merged->children) {
+                    if (!ch->counter) {
+                        merged->seconds += ch->seconds;
+                        for (int i = 0; i < TimingNode::NumCounters; ++i) {
+                            merged->counters[i] += ch->counters[i];
+                        }
+                        merged->peak_rss_kb = std::max(merged->peak_rss_kb, ch->peak_rss_kb);
+                        merged->rss_growth_kb += ch->rss_growth_kb;
+                    }
+                }
+                return merged;
+            }
+
+            // Whether hardware counters or memory were recorded.
+            bool hasHardware(const TimingNode& node)
+            {
+                return node.peak_rss_kb > 0 || node.counters[0] > 0;
+            }
+
+            void writeJsonString(std::ostream& os, const std::string& s)
+            {
+                os << '"';
+                for (const char ch : s) {
+                    if (ch == '"' || ch == '\\') {
+                        os << '\\' << ch;
+                    }
+                    else if (static_cast<unsigned char>(ch) < 0x20) {
+                        os << ' ';
+                    }
+                    else {
+                        os << ch;
+                    }
+                }
+                os << '"';
+            }
+
+            void printNode(std::ostream& os, const TimingNode& node, const int depth, const bool hardware)
+            {
+                os << std::setw(2*depth) << "" << std::left << std::setw(40 - 2*depth) << node.name << std::right;
+                if (node.counter) {
+                    os << std::setw(12) << "" << std::setw(8) << "" << std::setw(12) << node.calls << "  (count)\n";
+                }
+                else {
+                    const double parent_seconds = (node.parent != 0) ? node.parent->seconds : 0.0;
+                    os << std::setw(12) << std::fixed << std::setprecision(3) << node.seconds
+                       << std::setw(7) << std::setprecision(1)
+                       << (parent_seconds > 0.0 ? 100.0*node.seconds/parent_seconds : 100.0) << '%'
+                       << std::setw(12) << node.calls;
+                    if (hardware) {
+                        const double cycles = node.counters[0];
+                        os << std::setw(12) << std::setprecision(3) << 1e-9*cycles
+                           << std::setw(7) << std::setprecision(2) << (cycles > 0.0 ? node.counters[1]/cycles : 0.0)
+                           << std::setw(12) << std::setprecision(3) << 1e-6*node.counters[2]
+                           << std::setw(12) << std::setprecision(1) << node.peak_rss_kb/1024.0
+                           << std::setw(12) << node.rss_growth_kb/1024.0;
+                    }
+                    os << '\n';
+                    os.unsetf(std::ios_base::floatfield);
+                }
+                for (const auto& ch : node.children) {
+                    printNode(os, *ch, depth + 1, hardware);
+                }
+            }
+
+            void writeJsonNode(std::ostream& os, const TimingNode& node, const bool hardware)
+            {
+                os << "{\"name\":";
+                writeJsonString(os, node.name);
+                os << ",\"seconds\":" << node.seconds
+                   << ",\"calls\":" << node.calls;
+                if (hardware) {
+                    os << ",\"cycles\":" << node.counters[0]
+                       << ",\"instructions\":" << node.counters[1]
+                       << ",\"llc_misses\":" << node.counters[2]
+                       << ",\"peak_rss_kb\":" << node.peak_rss_kb
+                       << ",\"rss_growth_kb\":" << node.rss_growth_kb;
+                }
+                if (node.counter) {
+                    os << ",\"counter\":true";
+                }
+                os << ",\"children\":[";
+                for (std::size_t i = 0; i < node.children.size(); ++i) {
+                    if (i > 0) {
+                        os << ',';
+                    }
+                    writeJsonNode(os, *node.children[i], hardware);
+                }
+                os << "]}";
+            }
+        } // anonymous namespace
+
+
+
+
+        /// Set all times and counts to zero, and discard the
+        /// recorded trace.
+        void TimingTree::reset()
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (const auto& t : r.threads) {
+                resetNode(t->root);
+                t->events.clear();
+            }
+            r.epoch = Clock::now();
+        }
+
+
+
+
+        /// Start or stop recording every entry of a timed scope,
+        /// for writeChromeTrace(). Off by default.
+        void TimingTree::setTraceRecording(const bool on)
+        {
+            registry().tracing = on;
+        }
+
+
+
+
+        /// Start or stop recording hardware counters and the peak
+        /// resident set size in every timed scope. Off by default.
+        void TimingTree::setHardwareCounters(const bool on)
+        {
+            registry().hardware = on;
+        }
+
+
+
+
+        /// Whether hardware counters can be read by the calling
+        /// thread.
+        bool TimingTree::hardwareCountersAvailable()
+        {
+            return threadTimings().counters.available();
+        }
+
+
+
+
+        /// Add n to the counter with the given name, kept as a child
+        /// of the innermost active scope.
+        void TimingTree::count(const char* name, const long n)
+        {
+            ThreadTimings& t = threadTimings();
+            t.current->child(name, true)->calls += n;
+        }
+
+
+
+
+        /// Print the tree with time, share of the parent's time and
+        /// number of calls of each scope.
+        void TimingTree::print(std::ostream& os)
+        {
+            const std::unique_ptr<TimingNode> tree = mergedTree();
+            const bool hardware = hasHardware(*tree);
+            os << std::left << std::setw(40) << "Scope" << std::right
+               << std::setw(12) << "Seconds" << std::setw(8) << "Share"
+               << std::setw(12) << "Calls";
+            if (hardware) {
+                os << std::setw(12) << "Gcycles" << std::setw(7) << "IPC"
+                   << std::setw(12) << "M LLC miss" << std::setw(12) << "Peak MiB"
+                   << std::setw(12) << "Growth MiB";
+            }
+            os << '\n';
+            printNode(os, *tree, 0, hardware);
+            os.flush();
+        }
+
+
+
+
+        /// Write the tree as a JSON object with the members name,
+        /// seconds, calls and children.
+        void TimingTree::writeJson(std::ostream& os)
+        {
+            const std::unique_ptr<TimingNode> tree = mergedTree();
+            writeJsonNode(os, *tree, hasHardware(*tree));
+            os << '\n';
+        }
+
+
+
+
+        /// Write the recorded trace in the Chrome trace event format
+        /// (chrome://tracing, Perfetto).
+        void TimingTree::writeChromeTrace(std::ostream& os)
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            os << "{\"traceEvents\":[";
+            bool first = true;
+            for (const auto& t : r.threads) {
+                for (const auto& e : t->events) {
+                    os << (first ? "\n" : ",\n") << "{\"name\":";
+                    writeJsonString(os, e.node->name);
+                    os << ",\"ph\":\"X\",\"ts\":" << e.start
+                       << ",\"dur\":" << e.duration
+                       << ",\"pid\":0,\"tid\":" << t->thread_id << '}';
+                    first = false;
+                }
+            }
+            os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+
+
+
+        ScopedTimer::ScopedTimer(const char* name)
+        {
+            ThreadTimings& t = threadTimings();
+            node_ = t.current->child(name, false);
+            t.current = node_;
+            hardware_ = registry().hardware;
+            if (hardware_) {
+                t.counters.read(counters_);
+                rss_kb_ = peakRssKb();
+            }
+            start_ = Clock::now();
+        }
+
+
+
+
+        ScopedTimer::~ScopedTimer()
+        {
+            const Clock::time_point stop = Clock::now();
+            const double seconds = std::chrono::duration<double>(stop - start_).count();
+            node_->seconds += seconds;
+            ++node_->calls;
+            ThreadTimings& t = threadTimings();
+            if (hardware_) {
+                long long counters[TimingNode::NumCounters];
+                t.counters.read(counters);
+                for (int i = 0; i < TimingNode::NumCounters; ++i) {
+                    node_->counters[i] += counters[i] - counters_[i];
+                }
+                const long rss_kb = peakRssKb();
+                node_->peak_rss_kb = std::max(node_->peak_rss_kb, rss_kb);
+                node_->rss_growth_kb += rss_kb - rss_kb_;
+            }
+            t.current = node_->parent;
+            Registry& r = registry();
+            if (r.tracing) {
+                const double start = std::chrono::duration<double, std::micro>(start_ - r.epoch).count();
+                t.events.push_back(TraceEvent{ node_, start, 1e6*seconds });
+            }
+        }
+
+    } // namespace time
+
+} // namespace Opm
@@ -0,0 +1,137 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_TIMINGTREE_HEADER_INCLUDED
+#define OPM_TIMINGTREE_HEADER_INCLUDED
+
+#include <chrono>
+#include <iosfwd>
+
+namespace Opm
+{
+
+    namespace time
+    {
+
+        namespace detail
+        {
+            struct TimingNode;
+        }
+
+        /// Hierarchical timings of the scopes marked by OPM_TIMED_SCOPE.
+        ///
+        /// Every thread accumulates its timings, and the number of times
+        /// each scope was entered, in its own tree, where the children
+        /// of a node are the scopes entered while it was active. The
+        /// reports merge the trees of all threads, so the times of a
+        /// scope entered in parallel are summed over the threads.
+        ///
+        /// Optionally, each scope also records hardware counters (CPU
+        /// cycles, instructions and last level cache misses of the
+        /// thread, through Linux perf events) and the peak resident set
+        /// size of the process, see setHardwareCounters().
+        ///
+        /// The reports should be made, and reset() called, while no
+        /// thread is inside a timed scope.
+        class TimingTree
+        {
+        public:
+            /// Set all times and counts to zero, and discard the
+            /// recorded trace.
+            static void reset();
+
+            /// Start or stop recording every entry of a timed scope,
+            /// for writeChromeTrace(). Off by default.
+            static void setTraceRecording(const bool on);
+
+            /// Start or stop recording hardware counters and the peak
+            /// resident set size in every timed scope. Off by default,
+            /// since reading them costs a few system calls per scope.
+            /// Counters are read only if the kernel permits it (see
+            /// /proc/sys/kernel/perf_event_paranoid), and are reported
+            /// as zero otherwise.
+            static void setHardwareCounters(const bool on);
+
+            /// Whether hardware counters can be read by the calling
+            /// thread.
+            static bool hardwareCountersAvailable();
+
+            /// Add n to the counter with the given name, kept as a child
+            /// of the innermost active scope.
+            static void count(const char* name, const long n);
+
+            /// Print the tree with time, share of the parent's time and
+            /// number of calls of each scope, and the hardware counters
+            /// and peak resident set size if recorded.
+            static void print(std::ostream& os);
+
+            /// Write the tree as a JSON object with the members name,
+            /// seconds, calls and children, and cycles, instructions,
+            /// llc_misses, peak_rss_kb and rss_growth_kb if recorded.
+            static void writeJson(std::ostream& os);
+
+            /// Write the recorded trace in the Chrome trace event format
+            /// (chrome://tracing, Perfetto).
+            static void writeChromeTrace(std::ostream& os);
+        };
+
+        /// Times the scope it lives in, as a child of the innermost
+        /// scope already timed by the same thread. Use through the
+        /// OPM_TIMED_SCOPE macro.
+        class ScopedTimer
+        {
+        public:
+            /// \param[in] name  Name of the scope. For speed, scopes are
+            ///                  looked up by the address of the name
+            ///                  first, so string literals are preferable.
+            explicit ScopedTimer(const char* name);
+            ~ScopedTimer();
+
+        private:
+            ScopedTimer(const ScopedTimer&);
+            ScopedTimer& operator=(const ScopedTimer&);
+
+            detail::TimingNode* node_;
+            std::chrono::steady_clock::time_point start_;
+            bool hardware_;
+            long long counters_[3];
+            long rss_kb_;
+        };
+
+    } // namespace time
+
+} // namespace Opm
+
+/// Time the enclosing scope, see Opm::time::TimingTree. Probes, and
+/// counts made with OPM_TIMING_COUNT, are compiled in only if
+/// OPM_ENABLE_TIMING is defined (cmake -DENABLE_OPM_TIMING=ON), and
+/// cost nothing otherwise.
+#ifdef OPM_ENABLE_TIMING
+#define OPM_TIMING_CONCAT_(a, b) a ## b
+#define OPM_TIMING_CONCAT(a, b) OPM_TIMING_CONCAT_(a, b)
+#define OPM_TIMED_SCOPE(name) \
+    ::Opm::time::ScopedTimer OPM_TIMING_CONCAT(opm_timed_scope_, __LINE__)(name)
+#define OPM_TIMING_COUNT(name, n) ::Opm::time::TimingTree::count(name, n)
+#else
+#define OPM_TIMED_SCOPE(name) do {} while (false)
+#define OPM_TIMING_COUNT(name, n) do {} while (false)
+#endif
+
+#endif // OPM_TIMINGTREE_HEADER_INCLUDED
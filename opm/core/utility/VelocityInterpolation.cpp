@@ -81,6 +81,29 @@ namespace Opm
         }
     }
 
+    /// Interpolate velocity at a number of points in the same cell.
+    /// The velocity is constant in each cell, so it is computed once.
+    /// \param[in]  cell     Cell in which to interpolate.
+    /// \param[in]  npoints  Number of points.
+    /// \param[in]  x        Coordinates of points at which to interpolate.
+    ///                      Must be array of length npoints*grid.dimensions.
+    /// \param[out] v        Interpolated velocities.
+    ///                      Must be array of length npoints*grid.dimensions.
+    void VelocityInterpolationConstant::interpolate(const int cell,
+                                                    const int npoints,
+                                                    const double* x,
+                                                    double* v) const
+    {
+        if (npoints <= 0) {
+            return;
+        }
+        const int dim = grid_.dimensions;
+        interpolate(cell, x, v);
+        for (int pt = 1; pt < npoints; ++pt) {
+            std::copy(v, v + dim, v + dim*pt);
+        }
+    }
+
 
     // --------  Methods of class VelocityInterpolationECVI  --------
 
@@ -93,6 +116,16 @@ namespace Opm
     {
     }
 
+    /// Constructor, reusing precomputed connectivity.
+    /// \param[in]  grid           A grid.
+    /// \param[in]  connectivity   Connectivity of grid, as from
+    ///                            computeGridConnectivity().
+    VelocityInterpolationECVI::VelocityInterpolationECVI(const UnstructuredGrid& grid,
+                                                         std::shared_ptr<const GridConnectivity> connectivity)
+        : bcmethod_(grid, connectivity), grid_(grid)
+    {
+    }
+
     /// Set up fluxes for interpolation.
     /// Computes the corner velocities.
     /// \param[in]  flux   One signed flux per face in the grid.
@@ -167,16 +200,45 @@ namespace Opm
                                                 const double* x,
                                                 double* v) const
     {
+        interpolate(cell, 1, x, v);
+    }
+
+    /// Interpolate velocity at a number of points in the same cell.
+    /// \param[in]  cell     Cell in which to interpolate.
+    /// \param[in]  npoints  Number of points.
+    /// \param[in]  x        Coordinates of points at which to interpolate.
+    ///                      Must be array of length npoints*grid.dimensions.
+    /// \param[out] v        Interpolated velocities.
+    ///                      Must be array of length npoints*grid.dimensions.
+    void VelocityInterpolationECVI::interpolate(const int cell,
+                                                const int npoints,
+                                                const double* x,
+                                                double* v) const
+    {
+        // Called concurrently from level-scheduled reorder solvers,
+        // so the barycentric coordinates must not live in a member.
         const int n = bcmethod_.numCorners(cell);
         const int dim = grid_.dimensions;
-        bary_coord_.resize(n);
-        bcmethod_.cartToBary(cell, x, &bary_coord_[0]);
-        std::fill(v, v + dim, 0.0);
-        const SparseTable<WachspressCoord::CornerInfo>& all_ci = bcmethod_.cornerInfo();
-        for (int i = 0; i < n; ++i) {
-            const int cid = all_ci[cell][i].corner_id;
-            for (int dd = 0; dd < dim; ++dd) {
-                v[dd] += corner_velocity_[dim*cid + dd] * bary_coord_[i];
+        double bary_coord_local[MaxLocalCorners];
+        std::vector<double> bary_coord_heap;
+        double* bary_coord = bary_coord_local;
+        if (n*npoints > MaxLocalCorners) {
+            bary_coord_heap.resize(n*npoints);
+            bary_coord = &bary_coord_heap[0];
+        }
+        bcmethod_.cartToBary(cell, npoints, x, bary_coord);
+        // The corners of the cell have consecutive ids.
+        const double* cell_corner_velocity = n > 0
+            ? &corner_velocity_[dim*bcmethod_.cornerInfo()[cell][0].corner_id]
+            : 0;
+        for (int pt = 0; pt < npoints; ++pt) {
+            const double* bc = bary_coord + n*pt;
+            double* vp = v + dim*pt;
+            std::fill(vp, vp + dim, 0.0);
+            for (int i = 0; i < n; ++i) {
+                for (int dd = 0; dd < dim; ++dd) {
+                    vp[dd] += cell_corner_velocity[dim*i + dd] * bc[i];
+                }
             }
         }
     }
@@ -47,6 +47,19 @@ namespace Opm
         virtual void interpolate(const int cell,
                                  const double* x,
                                  double* v) const = 0;
+
+        /// Interpolate velocity at a number of points in the same cell.
+        /// \param[in]  cell     Cell in which to interpolate.
+        /// \param[in]  npoints  Number of points.
+        /// \param[in]  x        Coordinates of points at which to interpolate.
+        ///                      Must be array of length npoints*grid.dimensions,
+        ///                      the coordinates of each point stored contiguously.
+        /// \param[out] v        Interpolated velocities.
+        ///                      Must be array of length npoints*grid.dimensions.
+        virtual void interpolate(const int cell,
+                                 const int npoints,
+                                 const double* x,
+                                 double* v) const = 0;
     };
 
 
@@ -74,6 +87,18 @@ namespace Opm
         virtual void interpolate(const int cell,
                                  const double* x,
                                  double* v) const;
+
+        /// Interpolate velocity at a number of points in the same cell.
+        /// \param[in]  cell     Cell in which to interpolate.
+        /// \param[in]  npoints  Number of points.
+        /// \param[in]  x        Coordinates of points at which to interpolate.
+        ///                      Must be array of length npoints*grid.dimensions.
+        /// \param[out] v        Interpolated velocities.
+        ///                      Must be array of length npoints*grid.dimensions.
+        virtual void interpolate(const int cell,
+                                 const int npoints,
+                                 const double* x,
+                                 double* v) const;
     private:
         const UnstructuredGrid& grid_;
         const double* flux_;
@@ -94,6 +119,13 @@ namespace Opm
         /// \param[in]  grid   A grid.
         explicit VelocityInterpolationECVI(const UnstructuredGrid& grid);
 
+        /// Constructor, reusing precomputed connectivity.
+        /// \param[in]  grid           A grid.
+        /// \param[in]  connectivity   Connectivity of grid, as from
+        ///                            computeGridConnectivity().
+        VelocityInterpolationECVI(const UnstructuredGrid& grid,
+                                  std::shared_ptr<const GridConnectivity> connectivity);
+
         /// Set up fluxes for interpolation.
         /// \param[in]  flux   One signed flux per face in the grid.
         virtual void setupFluxes(const double* flux);
@@ -107,10 +139,26 @@ namespace Opm
         virtual void interpolate(const int cell,
                                  const double* x,
                                  double* v) const;
+
+        /// Interpolate velocity at a number of points in the same cell,
+        /// sharing the Wachspress coordinate setup between the points.
+        /// \param[in]  cell     Cell in which to interpolate.
+        /// \param[in]  npoints  Number of points.
+        /// \param[in]  x        Coordinates of points at which to interpolate.
+        ///                      Must be array of length npoints*grid.dimensions,
+        ///                      the coordinates of each point stored contiguously.
+        /// \param[out] v        Interpolated velocities.
+        ///                      Must be array of length npoints*grid.dimensions.
+        virtual void interpolate(const int cell,
+                                 const int npoints,
+                                 const double* x,
+                                 double* v) const;
     private:
         WachspressCoord bcmethod_;
         const UnstructuredGrid& grid_;
-        mutable std::vector<double> bary_coord_;
+        enum { MaxLocalCorners = 32 };
+        // Corner velocities by corner id, computed by setupFluxes().
+        // The corners of a cell have consecutive ids.
         std::vector<double> corner_velocity_; // size = dim * #corners
     };
 
@@ -20,9 +20,12 @@
 #include "config.h"
 #include <opm/core/utility/WachspressCoord.hpp>
 #include <opm/core/grid.h>
+#include <opm/core/grid/GridUtilities.hpp>
+#include <algorithm>
 #include <cmath>
+#include <exception>
 #include <map>
-#include <set>
+#include <vector>
 
 namespace Opm
 {
@@ -62,6 +65,9 @@ namespace Opm
             return std::fabs(det);
         }
 
+        /// Size of stack buffers for per-face factors of cartToBary().
+        enum { MaxLocalFaceFactors = 64 };
+
     } // anonymous namespace
 
 
@@ -95,6 +101,17 @@ namespace Opm
     /// Constructor.
     /// \param[in]  grid   A grid.
     WachspressCoord::WachspressCoord(const UnstructuredGrid& grid)
+        : WachspressCoord(grid, nullptr)
+    {
+    }
+
+    /// Constructor, reusing precomputed connectivity.
+    /// \param[in]  grid           A grid.
+    /// \param[in]  connectivity   Connectivity of grid, as from
+    ///                            computeGridConnectivity(). If null,
+    ///                            the cell vertices are computed.
+    WachspressCoord::WachspressCoord(const UnstructuredGrid& grid,
+                                     std::shared_ptr<const GridConnectivity> connectivity)
         : grid_(grid)
     {
         enum { Maxdim = 3 };
@@ -102,59 +119,155 @@ namespace Opm
         if (dim > Maxdim) {
             OPM_THROW(std::runtime_error, "Grid has more than " << Maxdim << " dimensions.");
         }
-        // Compute static data for each corner.
+        // Compute static data for each corner. The cells are processed
+        // concurrently, each into its own CellCorners, which are then
+        // gathered into the tables.
         const int num_cells = grid.number_of_cells;
-        int corner_id_count = 0;
+        struct CellCorners
+        {
+            std::vector<int> vertices;
+            std::vector<double> volume;
+            std::vector<int> adj;           // dim per corner
+            std::vector<int> nonadj_size;   // one per corner
+            std::vector<int> nonadj;
+            std::vector<int> nonadj_local;
+        };
+        std::vector<CellCorners> cell_corners(num_cells);
+        std::exception_ptr failure;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
         for (int cell = 0; cell < num_cells; ++cell) {
-            std::set<int> cell_vertices;
-            std::vector<int> cell_faces;
-            std::multimap<int, int> vertex_adj_faces;
-            for (int hface = grid.cell_facepos[cell]; hface < grid.cell_facepos[cell + 1]; ++hface) {
-                const int face = grid.cell_faces[hface];
-                cell_faces.push_back(face);
-                const int fn0 = grid.face_nodepos[face];
-                const int fn1 = grid.face_nodepos[face + 1];
-                cell_vertices.insert(grid.face_nodes + fn0, grid.face_nodes + fn1);
-                for (int fn = fn0; fn < fn1; ++fn) {
-                    const int vertex = grid.face_nodes[fn];
-                    vertex_adj_faces.insert(std::make_pair(vertex, face));
+            try {
+                CellCorners& cc = cell_corners[cell];
+                std::vector<int>& cell_vertices = cc.vertices;
+                std::vector<int> cell_faces;
+                std::map<int, int> local_face;
+                std::multimap<int, int> vertex_adj_faces;
+                for (int hface = grid.cell_facepos[cell]; hface < grid.cell_facepos[cell + 1]; ++hface) {
+                    const int face = grid.cell_faces[hface];
+                    cell_faces.push_back(face);
+                    local_face.insert(std::make_pair(face, hface - grid.cell_facepos[cell]));
+                    const int fn0 = grid.face_nodepos[face];
+                    const int fn1 = grid.face_nodepos[face + 1];
+                    if (!connectivity) {
+                        cell_vertices.insert(cell_vertices.end(), grid.face_nodes + fn0, grid.face_nodes + fn1);
+                    }
+                    for (int fn = fn0; fn < fn1; ++fn) {
+                        const int vertex = grid.face_nodes[fn];
+                        vertex_adj_faces.insert(std::make_pair(vertex, face));
+                    }
+                }
+                std::sort(cell_faces.begin(), cell_faces.end()); // set_difference requires sorted ranges
+                if (connectivity) {
+                    const auto nodes = connectivity->cell_nodes[cell];
+                    cell_vertices.assign(nodes.begin(), nodes.end());
+                } else {
+                    std::sort(cell_vertices.begin(), cell_vertices.end());
+                    cell_vertices.erase(std::unique(cell_vertices.begin(), cell_vertices.end()),
+                                        cell_vertices.end());
                 }
-            }
-            std::sort(cell_faces.begin(), cell_faces.end()); // set_difference requires sorted ranges
-            std::vector<CornerInfo> cell_corner_info;
-            std::set<int>::const_iterator it = cell_vertices.begin();
-            for (; it != cell_vertices.end(); ++it) {
-                CornerInfo ci;
-                ci.corner_id = corner_id_count++;;
-                ci.vertex = *it;
-                double* fnorm[Maxdim] = { 0 };
-                typedef std::multimap<int, int>::const_iterator MMIt;
-                std::pair<MMIt, MMIt> frange = vertex_adj_faces.equal_range(ci.vertex);
-                int fi = 0;
                 std::vector<int> vert_adj_faces(dim);
-                for (MMIt face_it = frange.first; face_it != frange.second; ++face_it, ++fi) {
-                    if (fi >= dim) {
-                        OPM_THROW(std::runtime_error, "In cell " << cell << ", vertex " << ci.vertex << " has "
-                              << " more than " << dim << " adjacent faces.");
+                std::vector<int> vert_nonadj_faces;
+                for (std::size_t k = 0; k < cell_vertices.size(); ++k) {
+                    const int vertex = cell_vertices[k];
+                    double* fnorm[Maxdim] = { 0 };
+                    typedef std::multimap<int, int>::const_iterator MMIt;
+                    std::pair<MMIt, MMIt> frange = vertex_adj_faces.equal_range(vertex);
+                    int fi = 0;
+                    for (MMIt face_it = frange.first; face_it != frange.second; ++face_it, ++fi) {
+                        if (fi >= dim) {
+                            OPM_THROW(std::runtime_error, "In cell " << cell << ", vertex " << vertex << " has "
+                                  << " more than " << dim << " adjacent faces.");
+                        }
+                        fnorm[fi] = grid_.face_normals + dim*(face_it->second);
+                        vert_adj_faces[fi] = face_it->second;
                     }
-                    fnorm[fi] = grid_.face_normals + dim*(face_it->second);
-                    vert_adj_faces[fi] = face_it->second;
+                    assert(fi == dim);
+                    cc.adj.insert(cc.adj.end(), vert_adj_faces.begin(), vert_adj_faces.end());
+                    cc.volume.push_back(cornerVolume(fnorm, dim));
+                    std::sort(vert_adj_faces.begin(), vert_adj_faces.end());
+                    vert_nonadj_faces.resize(cell_faces.size() - vert_adj_faces.size());
+                    std::set_difference(cell_faces.begin(), cell_faces.end(),
+                                        vert_adj_faces.begin(), vert_adj_faces.end(),
+                                        vert_nonadj_faces.begin());
+                    cc.nonadj_size.push_back(vert_nonadj_faces.size());
+                    for (std::size_t j = 0; j < vert_nonadj_faces.size(); ++j) {
+                        cc.nonadj.push_back(vert_nonadj_faces[j]);
+                        cc.nonadj_local.push_back(local_face[vert_nonadj_faces[j]]);
+                    }
+                }
+            } catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+
+        // Corner ids are numbered cell by cell.
+        std::vector<int> num_cell_corners(num_cells);
+        std::vector<int> corner_start(num_cells + 1, 0);
+        std::vector<int> nonadj_sizes;
+        for (int cell = 0; cell < num_cells; ++cell) {
+            const CellCorners& cc = cell_corners[cell];
+            num_cell_corners[cell] = cc.vertices.size();
+            corner_start[cell + 1] = corner_start[cell] + num_cell_corners[cell];
+            nonadj_sizes.insert(nonadj_sizes.end(), cc.nonadj_size.begin(), cc.nonadj_size.end());
+        }
+        corner_info_.allocate(num_cell_corners.begin(), num_cell_corners.end());
+        adj_faces_.resize(dim*corner_start[num_cells]);
+        nonadj_faces_.allocate(nonadj_sizes.begin(), nonadj_sizes.end());
+        nonadj_local_faces_.allocate(nonadj_sizes.begin(), nonadj_sizes.end());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int cell = 0; cell < num_cells; ++cell) {
+            const CellCorners& cc = cell_corners[cell];
+            int nonadj_pos = 0;
+            for (int k = 0; k < num_cell_corners[cell]; ++k) {
+                const int corner_id = corner_start[cell] + k;
+                CornerInfo& ci = corner_info_[cell][k];
+                ci.corner_id = corner_id;
+                ci.vertex = cc.vertices[k];
+                ci.volume = cc.volume[k];
+                std::copy(cc.adj.begin() + dim*k, cc.adj.begin() + dim*(k + 1),
+                          adj_faces_.begin() + dim*corner_id);
+                for (int j = 0; j < cc.nonadj_size[k]; ++j, ++nonadj_pos) {
+                    nonadj_faces_[corner_id][j] = cc.nonadj[nonadj_pos];
+                    nonadj_local_faces_[corner_id][j] = cc.nonadj_local[nonadj_pos];
                 }
-                assert(fi == dim);
-                adj_faces_.insert(adj_faces_.end(), vert_adj_faces.begin(), vert_adj_faces.end());
-                const double corner_vol = cornerVolume(fnorm, dim);
-                ci.volume = corner_vol;
-                cell_corner_info.push_back(ci);
-                std::sort(vert_adj_faces.begin(), vert_adj_faces.end());
-                std::vector<int> vert_nonadj_faces(cell_faces.size() - vert_adj_faces.size());
-                std::set_difference(cell_faces.begin(), cell_faces.end(),
-                                    vert_adj_faces.begin(), vert_adj_faces.end(),
-                                    vert_nonadj_faces.begin());
-                nonadj_faces_.appendRow(vert_nonadj_faces.begin(), vert_nonadj_faces.end());
             }
-            corner_info_.appendRow(cell_corner_info.begin(), cell_corner_info.end());
         }
-        assert(corner_id_count == corner_info_.dataSize());
+
+        // Outward normals n_j and offsets n_j * c_j of the faces of each
+        // cell, so that cartToBary() computes n_j * (c_j - x) without
+        // looking up face orientation.
+        const int num_hfaces = grid.cell_facepos[num_cells];
+        hface_normal_.resize(dim*num_hfaces);
+        hface_offset_.resize(num_hfaces);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int cell = 0; cell < num_cells; ++cell) {
+            for (int hface = grid.cell_facepos[cell]; hface < grid.cell_facepos[cell + 1]; ++hface) {
+                const int face = grid.cell_faces[hface];
+                const double sgn = (grid.face_cells[2*face] == cell) ? 1.0 : -1.0;
+                assert(sgn > 0.0 || grid.face_cells[2*face + 1] == cell);
+                double offset = 0.0;
+                for (int dd = 0; dd < dim; ++dd) {
+                    const double nd = sgn*grid.face_normals[dim*face + dd];
+                    hface_normal_[dim*hface + dd] = nd;
+                    offset += nd*grid.face_centroids[dim*face + dd];
+                }
+                hface_offset_[hface] = offset;
+            }
+        }
     }
 
 
@@ -198,38 +311,68 @@ namespace Opm
                                      const double* x,
                                      double* xb) const
     {
-        // Note:
-        // A possible optimization is: compute all n_j * (c_j - x) factors
-        // once, instead of repeating computation for all corners (for
-        // which j is a nonadjacent face).
+        cartToBary(cell, 1, x, xb);
+    }
+
+
+
+    /// Compute generalized barycentric coordinates for a number of
+    /// points in the same grid cell.
+    /// \param[in]  cell     Cell in which to compute coordinates.
+    /// \param[in]  npoints  Number of points.
+    /// \param[in]  x        Coordinates of points in cartesian coordinates.
+    ///                      Must be array of length npoints*grid.dimensions.
+    /// \param[out] xb       Coordinates of points in barycentric coordinates.
+    ///                      Must be array of length npoints*numCorners(cell).
+    void WachspressCoord::cartToBary(const int cell,
+                                     const int npoints,
+                                     const double* x,
+                                     double* xb) const
+    {
+        // The factors n_j * (c_j - x) are computed once per face and
+        // point, then shared by all corners for which j is a
+        // nonadjacent face.
         const int n = numCorners(cell);
         const int dim = grid_.dimensions;
-        double totw = 0.0;
-        for (int i = 0; i < n; ++i) {
-            const CornerInfo& ci = corner_info_[cell][i];
-            // Weight (unnormalized) is equal to:
-            // V_i * (prod_{j \in nonadjacent faces} n_j * (c_j - x) )
-            // ^^^                                   ^^^    ^^^
-            // corner "volume"                    normal    centroid
-            xb[i] = ci.volume;
-            const int num_nonadj_faces = nonadj_faces_[ci.corner_id].size();
-            for (int j = 0; j < num_nonadj_faces; ++j) {
-                const int face = nonadj_faces_[ci.corner_id][j];
-                double factor = 0.0;
+        const int face_beg = grid_.cell_facepos[cell];
+        const int num_faces = grid_.cell_facepos[cell + 1] - face_beg;
+        const double* normal = &hface_normal_[dim*face_beg];
+        const double* offset = &hface_offset_[face_beg];
+        double factor_local[MaxLocalFaceFactors];
+        std::vector<double> factor_heap;
+        double* factor = factor_local;
+        if (num_faces > MaxLocalFaceFactors) {
+            factor_heap.resize(num_faces);
+            factor = &factor_heap[0];
+        }
+        const CornerInfo* ci = corner_info_[cell].begin();
+        for (int pt = 0; pt < npoints; ++pt) {
+            const double* xp = x + dim*pt;
+            double* xbp = xb + n*pt;
+            for (int lf = 0; lf < num_faces; ++lf) {
+                double f = offset[lf];
                 for (int dd = 0; dd < dim; ++dd) {
-                    factor += grid_.face_normals[dim*face + dd]*(grid_.face_centroids[dim*face + dd] - x[dd]);
+                    f -= normal[dim*lf + dd]*xp[dd];
                 }
-                // Assumes outward-pointing normals, so negate factor if necessary.
-                if (grid_.face_cells[2*face] != cell) {
-                    assert(grid_.face_cells[2*face + 1] == cell);
-                    factor = -factor;
+                factor[lf] = f;
+            }
+            double totw = 0.0;
+            for (int i = 0; i < n; ++i) {
+                // Weight (unnormalized) is equal to:
+                // V_i * (prod_{j \in nonadjacent faces} n_j * (c_j - x) )
+                // ^^^                                   ^^^    ^^^
+                // corner "volume"                    normal    centroid
+                const auto nonadj = nonadj_local_faces_[ci[i].corner_id];
+                double w = ci[i].volume;
+                for (auto it = nonadj.begin(); it != nonadj.end(); ++it) {
+                    w *= factor[*it];
                 }
-                xb[i] *= factor;
+                xbp[i] = w;
+                totw += w;
+            }
+            for (int i = 0; i < n; ++i) {
+                xbp[i] /= totw;
             }
-            totw += xb[i];
-        }
-        for (int i = 0; i < n; ++i) {
-            xb[i] /= totw;
         }
     }
 
@@ -21,6 +21,7 @@
 #define OPM_WACHSPRESSCOORD_HEADER_INCLUDED
 
 #include <opm/core/utility/SparseTable.hpp>
+#include <memory>
 #include <vector>
 
 struct UnstructuredGrid;
@@ -28,6 +29,8 @@ struct UnstructuredGrid;
 namespace Opm
 {
 
+    struct GridConnectivity;
+
     /// Class capable of computing Wachspress coordinates in 2d and 3d.
     /// The formula used is a modification of the formula given in:
     /// M. Meyer, A. Barr, H. Lee, and M. Desbrun.
@@ -40,6 +43,14 @@ namespace Opm
         /// \param[in]  grid   A grid.
         explicit WachspressCoord(const UnstructuredGrid& grid);
 
+        /// Constructor, reusing precomputed connectivity.
+        /// \param[in]  grid           A grid.
+        /// \param[in]  connectivity   Connectivity of grid, as from
+        ///                            computeGridConnectivity(). If null,
+        ///                            the cell vertices are computed.
+        WachspressCoord(const UnstructuredGrid& grid,
+                        std::shared_ptr<const GridConnectivity> connectivity);
+
         /// Count of vertices adjacent to a call.
         /// \param[in]  cell   A cell index.
         /// \return            Number of corners of cell.
@@ -56,6 +67,22 @@ namespace Opm
                         const double* x,
                         double* xb) const;
 
+        /// Compute generalized barycentric coordinates for a number of
+        /// points in the same grid cell. Gives the same result as calling
+        /// cartToBary() for each point, but shares the per-cell setup.
+        /// \param[in]  cell     Cell in which to compute coordinates.
+        /// \param[in]  npoints  Number of points.
+        /// \param[in]  x        Coordinates of points in cartesian coordinates.
+        ///                      Must be array of length npoints*grid.dimensions,
+        ///                      the coordinates of each point stored contiguously.
+        /// \param[out] xb       Coordinates of points in barycentric coordinates.
+        ///                      Must be array of length npoints*numCorners(cell),
+        ///                      the coordinates of each point stored contiguously.
+        void cartToBary(const int cell,
+                        const int npoints,
+                        const double* x,
+                        double* xb) const;
+
         // A corner is here defined as a {cell, vertex} pair where the
         // vertex is adjacent to the cell.
         struct CornerInfo
@@ -78,6 +105,9 @@ namespace Opm
         SparseTable<CornerInfo> corner_info_;   // Corner info by cell.
         std::vector<int> adj_faces_;    // Set of adjacent faces, by corner id. Contains dim face indices per corner.
         SparseTable<int> nonadj_faces_; // Set of nonadjacent faces, by corner id.
+        SparseTable<int> nonadj_local_faces_; // As nonadj_faces_, but indices into the faces of the cell.
+        std::vector<double> hface_normal_;  // Outward face normal, dim per half-face.
+        std::vector<double> hface_offset_;  // Outward normal times face centroid, per half-face.
     };
 
 } // namespace Opm
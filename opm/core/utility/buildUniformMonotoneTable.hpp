@@ -32,6 +32,7 @@ namespace Opm {
                                    UniformTableLinear<T>& table)
     {
         MonotCubicInterpolator interp(xv, yv);
+        interp.freeze();
         std::vector<T> uniform_yv(samples);
         double xmin = xv[0];
         double xmax = xv.back();
@@ -45,4 +45,23 @@ namespace Opm
     }
 
 
+    // Construct explicit mapping from logical cartesian to active/compressed
+    // indices, the inverse of compressedToCartesian().
+    // \param[in] num_cells    The number of active cells.
+    // \param[in] global_cell  Either null, or an array of size num_cells.
+    // \param[in] cart_size    The number of logical cartesian cells.
+    // \return                 A vector of size cart_size with the active index
+    //                         of each cartesian cell, or -1 for inactive cells.
+    std::vector<int> cartesianToCompressed(const int num_cells,
+                                           const int* global_cell,
+                                           const int cart_size)
+    {
+        std::vector<int> retval(cart_size, -1);
+        for (int i = 0; i < num_cells; ++i) {
+            retval[global_cell ? global_cell[i] : i] = i;
+        }
+        return retval;
+    }
+
+
 } // namespace Opm
@@ -15,12 +15,11 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <config.h>
-#include <cassert>
 
 #include "extractPvtTableIndex.hpp"
 
+#include <opm/core/utility/CellRegionIndex.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
-#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
 
 #include <vector>
 
@@ -31,17 +30,11 @@ void extractPvtTableIndex(std::vector<int> &pvtTableIdx,
                           size_t numCompressed,
                           const int *compressedToCartesianCellIdx)
 {
-    //Get the PVTNUM data
-    const std::vector<int>& pvtnumData = eclState->getIntGridProperty("PVTNUM")->getData();
-    // Convert this into an array of compressed cells
-    // Eclipse uses Fortran-style indices which start at 1
-    // instead of 0, we subtract 1.
-    pvtTableIdx.resize(numCompressed);
-    for (size_t cellIdx = 0; cellIdx < numCompressed; ++ cellIdx) {
-        size_t cartesianCellIdx = compressedToCartesianCellIdx ? compressedToCartesianCellIdx[cellIdx]:cellIdx;
-        assert(cartesianCellIdx < pvtnumData.size());
-        pvtTableIdx[cellIdx] = pvtnumData[cartesianCellIdx] - 1;
-    }
+    // The PVTNUM region of each compressed cell, shared with the
+    // other consumers of the same deck and grid.
+    const auto pvtnum = CellRegionIndex::get(eclState, "PVTNUM", numCompressed,
+                                             compressedToCartesianCellIdx);
+    pvtTableIdx.assign(pvtnum->begin(), pvtnum->end());
 }
 
 }
@@ -0,0 +1,156 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1       /* MADV_HUGEPAGE */
+#endif
+
+#include "config.h"
+
+#include <opm/core/utility/first_touch.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/* Size of a transparent huge page on common hardware. */
+#define FIRST_TOUCH_HUGE_PAGE (((size_t) 2) << 20)
+
+/* -1: not yet decided, read environment. */
+static int first_touch_huge_pages = -1;
+
+
+/* ---------------------------------------------------------------------- */
+void
+first_touch_set_huge_pages(int enable)
+/* ---------------------------------------------------------------------- */
+{
+    first_touch_huge_pages = enable != 0;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+use_huge_pages(void)
+/* ---------------------------------------------------------------------- */
+{
+    const char *env;
+
+    if (first_touch_huge_pages < 0) {
+        env = getenv("OPM_HUGE_PAGES");
+
+        first_touch_huge_pages = (env != NULL) && (strcmp(env, "0") != 0);
+    }
+
+    return first_touch_huge_pages;
+}
+
+
+/* Uninitialised allocation.  Aligned to huge pages, and advised as such,
+ * if huge pages are requested and the block spans at least one. */
+/* ---------------------------------------------------------------------- */
+static void *
+allocate_bytes(size_t nbytes)
+/* ---------------------------------------------------------------------- */
+{
+#if defined(MADV_HUGEPAGE)
+    void *p;
+
+    if ((nbytes >= FIRST_TOUCH_HUGE_PAGE) && use_huge_pages()) {
+        if (posix_memalign(&p, FIRST_TOUCH_HUGE_PAGE, nbytes) == 0) {
+            /* Whole huge pages only; the tail may share a page with
+             * other allocations.  Failure is harmless. */
+            (void) madvise(p, (nbytes / FIRST_TOUCH_HUGE_PAGE) *
+                           FIRST_TOUCH_HUGE_PAGE, MADV_HUGEPAGE);
+            return p;
+        }
+    }
+#endif
+
+    return malloc((nbytes > 0) ? nbytes : 1);
+}
+
+
+/* ---------------------------------------------------------------------- */
+void *
+first_touch_calloc(size_t n, size_t size)
+/* ---------------------------------------------------------------------- */
+{
+    long  i, m;
+    char *p;
+
+    if ((size > 0) && (n > ((size_t) -1) / size)) {
+        return NULL;
+    }
+
+    p = allocate_bytes(n * size);
+
+    if (p != NULL) {
+        m = (long) n;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+        for (i = 0; i < m; i++) {
+            memset(p + ((size_t) i)*size, 0, size);
+        }
+    }
+
+    return p;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void *
+first_touch_calloc_rows(size_t n, const int *start, size_t nelm, size_t size)
+/* ---------------------------------------------------------------------- */
+{
+    long   i, m;
+    size_t end;
+    char  *p;
+
+    if ((size > 0) && (nelm > ((size_t) -1) / size)) {
+        return NULL;
+    }
+
+    p = allocate_bytes(nelm * size);
+
+    if (p != NULL) {
+        m = (long) n;
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) private(end)
+#endif
+        for (i = 0; i < m; i++) {
+            end = (i + 1 < m) ? (size_t) start[i + 1] : nelm;
+
+            memset(p + ((size_t) start[i])*size, 0,
+                   (end - (size_t) start[i])*size);
+        }
+    }
+
+    return p;
+}
@@ -0,0 +1,100 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_FIRST_TOUCH_HEADER_INCLUDED
+#define OPM_FIRST_TOUCH_HEADER_INCLUDED
+
+/**
+ * \file
+ *
+ * Allocation of per-cell and per-face arrays whose pages are first
+ * touched by the threads that later process them.
+ *
+ * Operating systems with a first-touch policy place a page on the NUMA
+ * node of the thread that writes it first.  Arrays that are zeroed by a
+ * single thread therefore end up on one socket, and parallel kernels run
+ * at the memory bandwidth of that socket only.  The functions below zero
+ * the memory in a loop with <CODE>schedule(static)</CODE> over the
+ * entities, which is the partition used by the OpenMP kernels over cells
+ * and faces.
+ *
+ * All memory is released with free().  Without OpenMP the functions
+ * behave as calloc().
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocate zero-initialised array of @c n entities of @c size bytes each,
+ * e.g., one <CODE>double[3]</CODE> centroid per cell.
+ *
+ * @param[in] n    Number of entities.
+ * @param[in] size Size of one entity in bytes.
+ * @return Zero-initialised array, @c NULL in case of allocation failure.
+ * Must be released using free().
+ */
+void *
+first_touch_calloc(size_t n, size_t size);
+
+
+/**
+ * Allocate zero-initialised array of the elements of @c n rows of a
+ * compressed array, such as the elements of a CSR matrix, first touched
+ * by row.
+ *
+ * @param[in] n     Number of rows.
+ * @param[in] start Start of each row.  Row @c i consists of elements
+ *                  <CODE>start[i] .. start[i + 1] - 1</CODE>, and the last
+ *                  row ends at element <CODE>nelm - 1</CODE>.  Array of
+ *                  size @c n, e.g., <CODE>A->ia</CODE> of a CSR matrix,
+ *                  or <CODE>A->ia + 1</CODE> while the matrix is formed
+ *                  in csrmatrix_new_elms_pushback().
+ * @param[in] nelm  Total number of elements.
+ * @param[in] size  Size of one element in bytes.
+ * @return Zero-initialised array of @c nelm elements, @c NULL in case of
+ * allocation failure.  Must be released using free().
+ */
+void *
+first_touch_calloc_rows(size_t n, const int *start, size_t nelm, size_t size);
+
+
+/**
+ * Request transparent huge pages for subsequent large allocations.
+ *
+ * Huge pages reduce TLB misses in kernels that stream through large
+ * arrays.  Only a hint, and only effective on systems that support
+ * <CODE>madvise(MADV_HUGEPAGE)</CODE>.  Unless set by this function, the
+ * hint is given if the environment variable @c OPM_HUGE_PAGES is set to a
+ * value other than @c 0.
+ *
+ * @param[in] enable Whether to request huge pages.
+ */
+void
+first_touch_set_huge_pages(int enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* OPM_FIRST_TOUCH_HEADER_INCLUDED */
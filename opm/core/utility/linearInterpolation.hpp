@@ -52,6 +52,39 @@ namespace Opm
     }
 
 
+    inline int tableIndex(const std::vector<double>& table, double x, int hint)
+    {
+	// Same result as tableIndex(table, x), but first tries the
+	// interval 'hint' and its two neighbours.  Any value of 'hint'
+	// is accepted; a hint outside the table falls back to the
+	// binary search.
+	int n = table.size() - 1;
+	if (n < 2) {
+	    return 0;
+	}
+	bool ascend = (table[n] > table[0]);
+	for (int j = hint; j <= hint + 1; ++j) {
+	    if (j < 0 || j > n - 1) {
+		continue;
+	    }
+	    bool above_lower = (j == 0)     || ((x >= table[j]) == ascend);
+	    bool below_upper = (j == n - 1) || ((x >= table[j + 1]) != ascend);
+	    if (above_lower && below_upper) {
+		return j;
+	    }
+	}
+	if (hint - 1 >= 0 && hint - 1 <= n - 1) {
+	    int j = hint - 1;
+	    bool above_lower = (j == 0) || ((x >= table[j]) == ascend);
+	    bool below_upper = ((x >= table[j + 1]) != ascend);
+	    if (above_lower && below_upper) {
+		return j;
+	    }
+	}
+	return tableIndex(table, x);
+    }
+
+
     inline double linearInterpolationDerivative(const std::vector<double>& xv,
                                                 const std::vector<double>& yv, double x)
     {
@@ -80,6 +113,27 @@ namespace Opm
 	return (yv[ix2] - yv[ix1])/(xv[ix2] - xv[ix1])*(x - xv[ix1]) + yv[ix1];
     }
 
+    inline double linearInterpolationHinted(const std::vector<double>& xv,
+                                            const std::vector<double>& yv,
+                                            double x, int& hint)
+    {
+	// Extrapolates if x is outside xv.  On input 'hint' is a guess
+	// for the interval containing x, on output the actual interval.
+	hint = tableIndex(xv, x, hint);
+	int ix2 = hint + 1;
+	return (yv[ix2] - yv[hint])/(xv[ix2] - xv[hint])*(x - xv[hint]) + yv[hint];
+    }
+
+    inline double linearInterpolationDerivativeHinted(const std::vector<double>& xv,
+                                                      const std::vector<double>& yv,
+                                                      double x, int& hint)
+    {
+	// Extrapolates if x is outside xv.  See linearInterpolationHinted().
+	hint = tableIndex(xv, x, hint);
+	int ix2 = hint + 1;
+	return (yv[ix2] - yv[hint])/(xv[ix2] - xv[hint]);
+    }
+
 
 
 } // namespace Opm
@@ -19,12 +19,15 @@
 
 #include "config.h"
 #include <opm/core/utility/miscUtilities.hpp>
+#include <opm/core/utility/ReproducibleSum.hpp>
+#include <opm/core/utility/ThreadControl.hpp>
 #include <opm/core/utility/Units.hpp>
 #include <opm/core/grid.h>
 #include <opm/core/wells.h>
 #include <opm/core/well_controls.h>
 #include <opm/core/props/IncompPropertiesInterface.hpp>
 #include <opm/core/props/BlackoilPropertiesInterface.hpp>
+#include <opm/core/props/NumPhasesDispatch.hpp>
 #include <opm/core/props/rock/RockCompressibility.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <iostream>
@@ -36,6 +39,197 @@
 namespace Opm
 {
 
+    namespace
+    {
+        // Phase loop kernels, see dispatchNumPhases().
+
+        // lam[c*np + p] /= mu[p].
+        struct DivideByViscosity
+        {
+            int nc;
+            const double* mu;
+            double* lam;
+
+            template <class NP>
+            void operator()(const NP np) const
+            {
+                for (int c = 0; c < nc; ++c) {
+                    for (int p = 0; p < np(); ++p) {
+                        lam[c*np() + p] /= mu[p];
+                    }
+                }
+            }
+        };
+
+        // totmob[c] = sum_p pmob[c*np + p], and, if omega is non-null,
+        // omega[c] = sum_p pmob[c*np + p]*rho[p] / totmob[c].
+        struct TotalMobility
+        {
+            int nc;
+            const double* pmob;
+            const double* rho;
+            double* totmob;
+            double* omega;
+
+            template <class NP>
+            void operator()(const NP np) const
+            {
+                for (int c = 0; c < nc; ++c) {
+                    double t = 0.0;
+                    double o = 0.0;
+                    for (int p = 0; p < np(); ++p) {
+                        t += pmob[c*np() + p];
+                        if (omega) {
+                            o += pmob[c*np() + p] * rho[p];
+                        }
+                    }
+                    totmob[c] = t;
+                    if (omega) {
+                        omega[c] = o / t;
+                    }
+                }
+            }
+        };
+
+        // v[c*np + p] /= sum_q v[c*np + q].
+        struct NormalisePhases
+        {
+            int nc;
+            double* v;
+
+            template <class NP>
+            void operator()(const NP np) const
+            {
+                for (int c = 0; c < nc; ++c) {
+                    double phase_sum = 0.0;
+                    for (int p = 0; p < np(); ++p) {
+                        phase_sum += v[c*np() + p];
+                    }
+                    for (int p = 0; p < np(); ++p) {
+                        v[c*np() + p] /= phase_sum;
+                    }
+                }
+            }
+        };
+
+        // Reduction terms, see reproducibleSum().
+
+        // t[p] = pv[c]*s[c*np + p], and, if with_pv, t[np] = pv[c].
+        struct SaturatedVolume
+        {
+            int np;
+            const double* pv;
+            const double* s;
+            bool with_pv;
+
+            void operator()(const int c, double* t) const
+            {
+                for (int p = 0; p < np; ++p) {
+                    t[p] = pv[c]*s[np*c + p];
+                }
+                if (with_pv) {
+                    t[np] = pv[c];
+                }
+            }
+        };
+
+        // t[0] = scale*max(v[i], 0).
+        struct PositivePart
+        {
+            const double* v;
+            double scale;
+
+            void operator()(const int i, double* t) const
+            {
+                t[0] = (v[i] > 0.0) ? scale*v[i] : 0.0;
+            }
+        };
+
+        // t[p] = scale*w[i]*f[i*np + p].
+        struct WeightedPhases
+        {
+            int np;
+            const double* w;
+            const double* f;
+            double scale;
+
+            void operator()(const int i, double* t) const
+            {
+                for (int p = 0; p < np; ++p) {
+                    t[p] = scale*w[i]*f[np*i + p];
+                }
+            }
+        };
+
+        // y[i] = x[i]*poroMult(p[i]), in parallel over chunks of cells
+        // so that the multipliers are still in cache when scaled.
+        void scaleByPoroMult(const int n, const double* x,
+                             const RockCompressibility& rock_comp,
+                             const double* p, double* y)
+        {
+            const int chunk = 1024;
+            const int num_chunks = (n + chunk - 1) / chunk;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (int k = 0; k < num_chunks; ++k) {
+                const int begin = k*chunk;
+                const int end = std::min(n, begin + chunk);
+                rock_comp.poroMult(end - begin, p + begin, y + begin, 0);
+                for (int i = begin; i < end; ++i) {
+                    y[i] *= x[i];
+                }
+            }
+        }
+
+        // Cells per relperm() call in the mobility computations: small
+        // enough for a chunk's mobilities to stay in cache between the
+        // relperm evaluation and the phase loops that follow it.
+        enum { MobilityChunkSize = 512 };
+
+        // Phase mobilities pmob = kr/mu of a range of cells, followed
+        // by, if totmob is non-null, the total mobility (and omega,
+        // see TotalMobility), or, if normalise is set, by division of
+        // the mobilities with their sum.
+        struct MobilityChunk
+        {
+            const IncompPropertiesInterface* props;
+            const int* cells;
+            const double* s;
+            double* pmob;
+            double* totmob;
+            double* omega;
+            bool normalise;
+
+            void operator()(const int begin, const int end) const
+            {
+                const int np = props->numPhases();
+                const int n  = end - begin;
+                double* lam  = pmob + begin*np;
+                props->relperm(n, s + begin*np, cells + begin, lam, 0);
+
+                const DivideByViscosity divide = { n, props->viscosity(), lam };
+                dispatchNumPhases(np, divide);
+                if (totmob) {
+                    const TotalMobility total = { n, lam, omega ? props->density() : 0,
+                                                  totmob + begin, omega ? omega + begin : 0 };
+                    dispatchNumPhases(np, total);
+                }
+                if (normalise) {
+                    const NormalisePhases norm = { n, lam };
+                    dispatchNumPhases(np, norm);
+                }
+            }
+        };
+
+        // Apply a MobilityChunk to all n cells, in parallel over chunks
+        // of MobilityChunkSize cells.
+        void forEachMobilityChunk(const int n, const MobilityChunk& chunk)
+        {
+            threads::parallelFor(0, n, MobilityChunkSize, chunk);
+        }
+    } // anonymous namespace
+
 
     /// @brief Computes pore volume of all cells in a grid.
     /// @param[in]  grid      a grid
@@ -66,6 +260,88 @@ namespace Opm
     }
 
 
+    /// @brief Computes pore volume of all cells, with rock compressibility
+    ///        effects, from precomputed static pore volumes.
+    /// @param[in]  static_porevol  pore volume by cell at reference pressure
+    /// @param[in]  rock_comp       rock compressibility properties
+    /// @param[in]  pressure        pressure by cell
+    /// @param[out] porevol         the pore volume by cell.
+    void computePorevolume(const std::vector<double>& static_porevol,
+                           const RockCompressibility& rock_comp,
+                           const std::vector<double>& pressure,
+                           std::vector<double>& porevol)
+    {
+        const int num_cells = static_porevol.size();
+        porevol.resize(num_cells);
+        scaleByPoroMult(num_cells, static_porevol.data(), rock_comp, pressure.data(), porevol.data());
+    }
+
+
+    /// @brief Updates pore volumes, with rock compressibility effects,
+    ///        only in the cells whose pressure has changed by more than
+    ///        a tolerance since their pore volume was last evaluated.
+    int updatePorevolume(const std::vector<double>& static_porevol,
+                         const RockCompressibility& rock_comp,
+                         const std::vector<double>& pressure,
+                         const double tol,
+                         std::vector<double>& eval_pressure,
+                         std::vector<double>& porevol,
+                         std::vector<double>* rock_comp_deriv)
+    {
+        const int num_cells = static_porevol.size();
+        if (int(eval_pressure.size()) != num_cells || int(porevol.size()) != num_cells
+            || (rock_comp_deriv && int(rock_comp_deriv->size()) != num_cells)) {
+            computePorevolume(static_porevol, rock_comp, pressure, porevol);
+            if (rock_comp_deriv) {
+                rock_comp_deriv->resize(num_cells);
+                rock_comp.rockComp(num_cells, pressure.data(), rock_comp_deriv->data());
+            }
+            eval_pressure = pressure;
+            return num_cells;
+        }
+        // The changed cells of each chunk are packed into local arrays,
+        // evaluated with one call per property, and scattered back.
+        enum { Chunk = 1024 };
+        const int num_chunks = (num_cells + Chunk - 1) / Chunk;
+        int num_updated = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+:num_updated)
+#endif
+        for (int k = 0; k < num_chunks; ++k) {
+            const int begin = k*Chunk;
+            const int end = std::min(num_cells, begin + Chunk);
+            int cells[Chunk];
+            double p[Chunk];
+            double y[Chunk];
+            int n = 0;
+            for (int c = begin; c < end; ++c) {
+                if (std::fabs(pressure[c] - eval_pressure[c]) > tol) {
+                    cells[n] = c;
+                    p[n] = pressure[c];
+                    ++n;
+                }
+            }
+            if (n == 0) {
+                continue;
+            }
+            rock_comp.poroMult(n, p, y, 0);
+            for (int i = 0; i < n; ++i) {
+                const int c = cells[i];
+                porevol[c] = static_porevol[c]*y[i];
+                eval_pressure[c] = p[i];
+            }
+            if (rock_comp_deriv) {
+                rock_comp.rockComp(n, p, y);
+                for (int i = 0; i < n; ++i) {
+                    (*rock_comp_deriv)[cells[i]] = y[i];
+                }
+            }
+            num_updated += n;
+        }
+        return num_updated;
+    }
+
+
     /// @brief Computes porosity of all cells in a grid, with rock compressibility effects.
     /// @param[in]  grid               a grid
     /// @param[in]  porosity_standard  array of grid.number_of_cells porosity values (at standard conditions)
@@ -80,9 +356,7 @@ namespace Opm
     {
         int num_cells = grid.number_of_cells;
         porosity.resize(num_cells);
-        for (int i = 0; i < num_cells; ++i) {
-            porosity[i] = porosity_standard[i]*rock_comp.poroMult(pressure[i]);
-        }
+        scaleByPoroMult(num_cells, porosity_standard, rock_comp, pressure.data(), porosity.data());
     }
 
 
@@ -102,12 +376,8 @@ namespace Opm
         if (int(s.size()) != num_cells*np) {
             OPM_THROW(std::runtime_error, "Sizes of s and pv vectors do not match.");
         }
-        std::fill(sat_vol, sat_vol + np, 0.0);
-        for (int c = 0; c < num_cells; ++c) {
-            for (int p = 0; p < np; ++p) {
-                sat_vol[p] += pv[c]*s[np*c + p];
-            }
-        }
+        const SaturatedVolume term = { np, pv.data(), s.data(), false };
+        reproducibleSum(num_cells, np, term, sat_vol);
     }
 
 
@@ -127,19 +397,13 @@ namespace Opm
         if (int(s.size()) != num_cells*np) {
             OPM_THROW(std::runtime_error, "Sizes of s and pv vectors do not match.");
         }
-        double tot_pv = 0.0;
-        // Note that we abuse the output array to accumulate the
-        // saturated pore volumes.
-        std::fill(aver_sat, aver_sat + np, 0.0);
-        for (int c = 0; c < num_cells; ++c) {
-            tot_pv += pv[c];
-            for (int p = 0; p < np; ++p) {
-                aver_sat[p] += pv[c]*s[np*c + p];
-            }
-        }
+        // Saturated pore volumes, followed by the total pore volume.
+        std::vector<double> vol(np + 1);
+        const SaturatedVolume term = { np, pv.data(), s.data(), true };
+        reproducibleSum(num_cells, np + 1, term, vol.data());
         // Must divide by pore volumes to get saturations.
         for (int p = 0; p < np; ++p) {
-            aver_sat[p] /= tot_pv;
+            aver_sat[p] = vol[p] / vol[np];
         }
     }
 
@@ -170,25 +434,26 @@ namespace Opm
         }
         std::fill(injected, injected + np, 0.0);
         std::fill(produced, produced + np, 0.0);
-        const double* visc = props.viscosity();
-        std::vector<double> mob(np);
+        const PositivePart inflow = { src.data(), dt };
+        reproducibleSum(num_cells, 1, inflow, injected);
+
+        // Fractional flows of all producing cells, in cell order.
+        std::vector<int> cells;
+        std::vector<double> outflow;
+        std::vector<double> sat;
         for (int c = 0; c < num_cells; ++c) {
-            if (src[c] > 0.0) {
-                injected[0] += src[c]*dt;
-            } else if (src[c] < 0.0) {
-                const double flux = -src[c]*dt;
-                const double* sat = &s[np*c];
-                props.relperm(1, sat, &c, &mob[0], 0);
-                double totmob = 0.0;
-                for (int p = 0; p < np; ++p) {
-                    mob[p] /= visc[p];
-                    totmob += mob[p];
-                }
-                for (int p = 0; p < np; ++p) {
-                    produced[p] += (mob[p]/totmob)*flux;
-                }
+            if (src[c] < 0.0) {
+                cells.push_back(c);
+                outflow.push_back(-src[c]);
+                sat.insert(sat.end(), s.begin() + np*c, s.begin() + np*(c + 1));
             }
         }
+        if (!cells.empty()) {
+            std::vector<double> ff;
+            computeFractionalFlow(props, cells, sat, ff);
+            const WeightedPhases term = { np, outflow.data(), ff.data(), dt };
+            reproducibleSum(cells.size(), np, term, produced);
+        }
     }
 
 
@@ -203,20 +468,24 @@ namespace Opm
                               const std::vector<double>& s,
                               std::vector<double>& totmob)
     {
-        std::vector<double> pmobc;
-
-        computePhaseMobilities(props, cells, s, pmobc);
-
-        const std::size_t                 np = props.numPhases();
-        const std::vector<int>::size_type nc = cells.size();
+        std::vector<double> pmobc(cells.size() * props.numPhases());
+        totmob.resize(cells.size());
+        computeTotalMobility(props, cells.size(), cells.data(), s.data(),
+                             pmobc.data(), totmob.data());
+    }
 
-        std::vector<double>(cells.size(), 0.0).swap(totmob);
 
-        for (std::vector<int>::size_type c = 0; c < nc; ++c) {
-            for (std::size_t p = 0; p < np; ++p) {
-                totmob[ c ] += pmobc[c*np + p];
-            }
-        }
+    /// @brief Computes total mobility for a set of saturation values,
+    ///        into caller-owned storage.
+    void computeTotalMobility(const Opm::IncompPropertiesInterface& props,
+                              const int num_cells,
+                              const int* cells,
+                              const double* s,
+                              double* pmobc,
+                              double* totmob)
+    {
+        const MobilityChunk chunk = { &props, cells, s, pmobc, totmob, 0, false };
+        forEachMobilityChunk(num_cells, chunk);
     }
 
 
@@ -232,25 +501,26 @@ namespace Opm
                                    std::vector<double>& totmob,
                                    std::vector<double>& omega)
     {
-        std::vector<double> pmobc;
-
-        computePhaseMobilities(props, cells, s, pmobc);
-
-        const std::size_t                 np = props.numPhases();
-        const std::vector<int>::size_type nc = cells.size();
-
-        std::vector<double>(cells.size(), 0.0).swap(totmob);
-        std::vector<double>(cells.size(), 0.0).swap(omega );
+        std::vector<double> pmobc(cells.size() * props.numPhases());
+        totmob.resize(cells.size());
+        omega.resize(cells.size());
+        computeTotalMobilityOmega(props, cells.size(), cells.data(), s.data(),
+                                  pmobc.data(), totmob.data(), omega.data());
+    }
 
-        const double* rho = props.density();
-        for (std::vector<int>::size_type c = 0; c < nc; ++c) {
-            for (std::size_t p = 0; p < np; ++p) {
-                totmob[ c ] += pmobc[c*np + p];
-                omega [ c ] += pmobc[c*np + p] * rho[ p ];
-            }
 
-            omega[ c ] /= totmob[ c ];
-        }
+    /// @brief Computes total mobility and omega for a set of saturation
+    ///        values, into caller-owned storage.
+    void computeTotalMobilityOmega(const Opm::IncompPropertiesInterface& props,
+                                   const int num_cells,
+                                   const int* cells,
+                                   const double* s,
+                                   double* pmobc,
+                                   double* totmob,
+                                   double* omega)
+    {
+        const MobilityChunk chunk = { &props, cells, s, pmobc, totmob, omega, false };
+        forEachMobilityChunk(num_cells, chunk);
     }
 
 
@@ -269,18 +539,21 @@ namespace Opm
 
         assert(s.size() == nc * np);
 
-        std::vector<double>(nc * np, 0.0).swap(pmobc );
-        double*                                dpmobc = 0;
-        props.relperm(static_cast<const int>(nc), &s[0], &cells[0],
-                      &pmobc[0], dpmobc);
+        pmobc.resize(nc * np);
+        computePhaseMobilities(props, nc, cells.data(), s.data(), pmobc.data());
+    }
 
-        const double*                 mu  = props.viscosity();
-        std::vector<double>::iterator lam = pmobc.begin();
-        for (std::vector<int>::size_type c = 0; c < nc; ++c) {
-            for (std::size_t p = 0; p < np; ++p, ++lam) {
-                *lam /= mu[ p ];
-            }
-        }
+
+    /// @brief Computes phase mobilities for a set of saturation values,
+    ///        into caller-owned storage.
+    void computePhaseMobilities(const Opm::IncompPropertiesInterface& props,
+                                const int                             num_cells,
+                                const int*                            cells,
+                                const double*                         s,
+                                double*                               pmobc)
+    {
+        const MobilityChunk chunk = { &props, cells, s, pmobc, 0, 0, false };
+        forEachMobilityChunk(num_cells, chunk);
     }
 
     /// Computes the fractional flow for each cell in the cells argument
@@ -294,19 +567,22 @@ namespace Opm
                                const std::vector<double>& saturations,
                                std::vector<double>& fractional_flows)
     {
-        const int num_phases = props.numPhases();
+        fractional_flows.resize(cells.size() * props.numPhases());
+        computeFractionalFlow(props, cells.size(), cells.data(), saturations.data(),
+                              fractional_flows.data());
+    }
 
-        computePhaseMobilities(props, cells, saturations, fractional_flows);
 
-        for (std::vector<int>::size_type i = 0; i < cells.size(); ++i) {
-            double phase_sum = 0.0;
-            for (int phase = 0; phase < num_phases; ++phase) {
-                phase_sum += fractional_flows[i * num_phases + phase];
-            }
-            for (int phase = 0; phase < num_phases; ++phase) {
-                fractional_flows[i * num_phases + phase] /= phase_sum;
-            }
-        }
+    /// Computes the fractional flow for each cell in the cells argument,
+    /// into caller-owned storage.
+    void computeFractionalFlow(const Opm::IncompPropertiesInterface& props,
+                               const int num_cells,
+                               const int* cells,
+                               const double* saturations,
+                               double* fractional_flows)
+    {
+        const MobilityChunk chunk = { &props, cells, saturations, fractional_flows, 0, 0, true };
+        forEachMobilityChunk(num_cells, chunk);
     }
 
     /// Compute two-phase transport source terms from face fluxes,
@@ -79,6 +79,50 @@ namespace Opm
                            const std::vector<double>& pressure,
                            std::vector<double>& porevol);
 
+    /// @brief Computes pore volume of all cells, with rock compressibility
+    ///        effects, from precomputed static pore volumes. Solvers
+    ///        that update pore volumes every step keep the static pore
+    ///        volumes, porosity times cell volume, from construction.
+    /// @param[in]  static_porevol  pore volume by cell at reference pressure,
+    ///                             e.g., from computePorevolume() without
+    ///                             rock compressibility
+    /// @param[in]  rock_comp       rock compressibility properties
+    /// @param[in]  pressure        pressure by cell
+    /// @param[out] porevol         the pore volume by cell.
+    void computePorevolume(const std::vector<double>& static_porevol,
+                           const RockCompressibility& rock_comp,
+                           const std::vector<double>& pressure,
+                           std::vector<double>& porevol);
+
+    /// @brief Updates pore volumes, with rock compressibility effects,
+    ///        only in the cells whose pressure has changed by more than
+    ///        a tolerance since their pore volume was last evaluated.
+    ///        Late in a simulation, when the pressure barely changes
+    ///        between steps or Newton iterations, most cells are then
+    ///        skipped. The change is measured against the pressure of
+    ///        the last evaluation, not the last increment, so that many
+    ///        small increments cannot add up to an unbounded error.
+    ///        If eval_pressure does not hold one value per cell, all
+    ///        pore volumes are computed.
+    /// @param[in]     static_porevol  pore volume by cell at reference pressure
+    /// @param[in]     rock_comp       rock compressibility properties
+    /// @param[in]     pressure        pressure by cell
+    /// @param[in]     tol             cells whose pressure is within tol of
+    ///                                eval_pressure are not updated
+    /// @param[in,out] eval_pressure   pressure by cell at which porevol was
+    ///                                last evaluated, updated with porevol
+    /// @param[in,out] porevol         the pore volume by cell.
+    /// @param[in,out] rock_comp_deriv if non-null, the rock compressibility
+    ///                                by cell, updated in the same cells
+    /// @return the number of cells updated.
+    int updatePorevolume(const std::vector<double>& static_porevol,
+                         const RockCompressibility& rock_comp,
+                         const std::vector<double>& pressure,
+                         const double tol,
+                         std::vector<double>& eval_pressure,
+                         std::vector<double>& porevol,
+                         std::vector<double>* rock_comp_deriv = 0);
+
     /// @brief Computes porosity of all cells in a grid, with rock compressibility effects.
     /// @param[in]  grid               a grid
     /// @param[in]  porosity_standard  array of grid.number_of_cells porosity values (at reference presure)
@@ -144,6 +188,24 @@ namespace Opm
 			      const std::vector<double>& s,
 			      std::vector<double>& totmob);
 
+    /// @brief Computes total mobility for a set of saturation values,
+    ///        into caller-owned storage. Relative permeabilities are
+    ///        evaluated and divided by viscosity in one pass over
+    ///        blocks of cells, in parallel if OpenMP is enabled.
+    /// @param[in]  props      rock and fluid properties
+    /// @param[in]  num_cells  number of cells
+    /// @param[in]  cells      cells with which the saturation values are associated
+    /// @param[in]  s          saturation values (num_cells*numPhases, for all phases)
+    /// @param[out] pmobc      workspace of num_cells*numPhases values,
+    ///                        on output the phase mobilities
+    /// @param[out] totmob     total mobilities (num_cells values).
+    void computeTotalMobility(const Opm::IncompPropertiesInterface& props,
+                              const int num_cells,
+                              const int* cells,
+                              const double* s,
+                              double* pmobc,
+                              double* totmob);
+
     /// @brief Computes total mobility and omega for a set of saturation values.
     /// @param[in]  props     rock and fluid properties
     /// @param[in]  cells     cells with which the saturation values are associated
@@ -156,6 +218,25 @@ namespace Opm
 				   std::vector<double>& totmob,
 				   std::vector<double>& omega);
 
+    /// @brief Computes total mobility and omega for a set of saturation
+    ///        values, into caller-owned storage; see the pointer
+    ///        overload of computeTotalMobility().
+    /// @param[in]  props      rock and fluid properties
+    /// @param[in]  num_cells  number of cells
+    /// @param[in]  cells      cells with which the saturation values are associated
+    /// @param[in]  s          saturation values (for all phases)
+    /// @param[out] pmobc      workspace of num_cells*numPhases values,
+    ///                        on output the phase mobilities
+    /// @param[out] totmob     total mobility
+    /// @param[out] omega      fractional-flow weighted fluid densities.
+    void computeTotalMobilityOmega(const Opm::IncompPropertiesInterface& props,
+                                   const int num_cells,
+                                   const int* cells,
+                                   const double* s,
+                                   double* pmobc,
+                                   double* totmob,
+                                   double* omega);
+
 
     /// @brief Computes phase mobilities for a set of saturation values.
     /// @param[in]  props     rock and fluid properties
@@ -167,6 +248,19 @@ namespace Opm
                                 const std::vector<double>&            s    ,
                                 std::vector<double>&                  pmobc);
 
+    /// @brief Computes phase mobilities for a set of saturation values,
+    ///        into caller-owned storage of num_cells*numPhases values.
+    /// @param[in]  props      rock and fluid properties
+    /// @param[in]  num_cells  number of cells
+    /// @param[in]  cells      cells with which the saturation values are associated
+    /// @param[in]  s          saturation values (for all phases)
+    /// @param[out] pmobc      phase mobilities (for all phases).
+    void computePhaseMobilities(const Opm::IncompPropertiesInterface& props,
+                                const int                             num_cells,
+                                const int*                            cells,
+                                const double*                         s,
+                                double*                               pmobc);
+
 
     /// Computes the fractional flow for each cell in the cells argument
     /// @param[in] props                rock and fluid properties
@@ -178,6 +272,19 @@ namespace Opm
                                const std::vector<double>& saturations,
                                std::vector<double>& fractional_flows);
 
+    /// Computes the fractional flow for each cell in the cells argument,
+    /// into caller-owned storage of num_cells*numPhases values.
+    /// @param[in]  props                rock and fluid properties
+    /// @param[in]  num_cells            number of cells
+    /// @param[in]  cells                cells with which the saturation values are associated
+    /// @param[in]  saturations          saturation values (for all phases)
+    /// @param[out] fractional_flows     the fractional flow for each phase for each cell.
+    void computeFractionalFlow(const Opm::IncompPropertiesInterface& props,
+                               const int num_cells,
+                               const int* cells,
+                               const double* saturations,
+                               double* fractional_flows);
+
 
     /// Compute two-phase transport source terms from face fluxes,
     /// and pressure equation source terms. This puts boundary flows
@@ -256,7 +363,8 @@ namespace Opm
     ///                         saturations[i*densities.size() + p] should give the weight
     ///                         of phase p in cell i.
     /// \param[in] densities    Density for each phase.
-    /// \param[out] wdp         Will contain, for each well, the wdp of the well.
+    /// \param[out] wdp         Will contain, for each perforation, the wdp of the
+    ///                         perforation. Resized to the number of perforations.
     /// \param[in] per_grid_cell Whether or not the saturations are per grid cell or per
     ///                          well cell.
     void computeWDP(const Wells& wells, const UnstructuredGrid& grid, const std::vector<double>& saturations,
@@ -272,7 +380,8 @@ namespace Opm
     ///                         saturations[i*densities.size() + p] should give the weight
     ///                         of phase p in cell i.
     /// \param[in] densities    Density for each phase.
-    /// \param[out] wdp         Will contain, for each well, the wdp of the well.
+    /// \param[out] wdp         Will contain, for each perforation, the wdp of the
+    ///                         perforation. Resized to the number of perforations.
     /// \param[in] per_grid_cell Whether or not the saturations are per grid cell or per
     ///                          well cell.
     template<class T>
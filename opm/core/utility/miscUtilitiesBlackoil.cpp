@@ -32,6 +32,7 @@
 #include <opm/core/utility/Units.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <functional>
 #include <limits>
@@ -406,4 +407,63 @@ namespace Opm
     }
 
 
+    /// Computes the reservoir and surface volume phase rates of each well.
+    /// The A matrices of all perforation cells are evaluated by a single
+    /// call to props.matrix(), the perforation rates are converted with
+    /// computeSurfacevol(), and the rates of each well are then summed
+    /// over its contiguous range of perforations.
+    /// \param[in]  props            Fluid and rock properties.
+    /// \param[in]  wells            Wells data structure.
+    /// \param[in]  state            Reservoir state, giving the A matrices of the
+    ///                              perforation cells.
+    /// \param[in]  perf_rates       Total reservoir volume rate of each perforation,
+    ///                              ordered the same way as the wells struct.
+    /// \param[in]  fractional_flows Fractional flow of each phase in each cell.
+    /// \param[out] well_res_rates   Reservoir volume rate of each phase in each well.
+    /// \param[out] well_surf_rates  Surface volume rate of each phase in each well.
+    void computeWellPhaseRates(const BlackoilPropertiesInterface& props,
+                               const Wells& wells,
+                               const BlackoilState& state,
+                               const std::vector<double>& perf_rates,
+                               const std::vector<double>& fractional_flows,
+                               std::vector<double>& well_res_rates,
+                               std::vector<double>& well_surf_rates)
+    {
+        const int np = wells.number_of_phases;
+        const int nw = wells.number_of_wells;
+        const int nperf = wells.well_connpos[nw];
+        assert(int(perf_rates.size()) == nperf);
+
+        // Gather the perforation cell states and reservoir phase rates.
+        std::vector<double> perf_p(nperf);
+        std::vector<double> perf_T(nperf);
+        std::vector<double> perf_z(nperf*np);
+        std::vector<double> perf_res(nperf*np);
+        for (int j = 0; j < nperf; ++j) {
+            const int cell = wells.well_cells[j];
+            perf_p[j] = state.pressure()[cell];
+            perf_T[j] = state.temperature()[cell];
+            for (int phase = 0; phase < np; ++phase) {
+                perf_z[np*j + phase] = state.surfacevol()[np*cell + phase];
+                perf_res[np*j + phase] = perf_rates[j]*fractional_flows[np*cell + phase];
+            }
+        }
+        std::vector<double> A(nperf*np*np);
+        props.matrix(nperf, &perf_p[0], &perf_T[0], &perf_z[0], wells.well_cells, &A[0], 0);
+        std::vector<double> perf_surf(nperf*np);
+        computeSurfacevol(nperf, np, &A[0], &perf_res[0], &perf_surf[0]);
+
+        // Segmented sum over the perforations of each well.
+        well_res_rates.assign(nw*np, 0.0);
+        well_surf_rates.assign(nw*np, 0.0);
+        for (int w = 0; w < nw; ++w) {
+            for (int j = wells.well_connpos[w]; j < wells.well_connpos[w + 1]; ++j) {
+                for (int phase = 0; phase < np; ++phase) {
+                    well_res_rates[np*w + phase] += perf_res[np*j + phase];
+                    well_surf_rates[np*w + phase] += perf_surf[np*j + phase];
+                }
+            }
+        }
+    }
+
 } // namespace Opm
@@ -159,6 +159,28 @@ namespace Opm
                                 const WellState& well_state,
                                 std::vector<double>& transport_src);
 
+    /// Computes the reservoir and surface volume phase rates of each well.
+    /// The A matrices of all perforation cells are evaluated by a single
+    /// call to props.matrix(), the perforation rates are converted with
+    /// computeSurfacevol(), and the rates of each well are then summed
+    /// over its contiguous range of perforations.
+    /// \param[in]  props            Fluid and rock properties.
+    /// \param[in]  wells            Wells data structure.
+    /// \param[in]  state            Reservoir state, giving the A matrices of the
+    ///                              perforation cells.
+    /// \param[in]  perf_rates       Total reservoir volume rate of each perforation,
+    ///                              ordered the same way as the wells struct.
+    /// \param[in]  fractional_flows Fractional flow of each phase in each cell.
+    /// \param[out] well_res_rates   Reservoir volume rate of each phase in each well.
+    /// \param[out] well_surf_rates  Surface volume rate of each phase in each well.
+    void computeWellPhaseRates(const BlackoilPropertiesInterface& props,
+                               const Wells& wells,
+                               const BlackoilState& state,
+                               const std::vector<double>& perf_rates,
+                               const std::vector<double>& fractional_flows,
+                               std::vector<double>& well_res_rates,
+                               std::vector<double>& well_surf_rates);
+
 } // namespace Opm
 
 #endif // OPM_MISCUTILITIESBLACKOIL_HEADER_INCLUDED
@@ -1,6 +1,7 @@
 #include <opm/core/grid/GridHelpers.hpp>
 #include <opm/core/wells.h>
 #include <opm/core/props/rock/RockCompressibility.hpp>
+#include <algorithm>
 
 namespace Opm
 {
@@ -49,10 +50,10 @@ namespace Opm
                            std::vector<double>& porevol)
     {
         porevol.resize(number_of_cells);
-        std::transform(porosity, porosity + number_of_cells,
-                       begin_cell_volume,
-                       porevol.begin(),
-                       std::multiplies<double>());
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < number_of_cells; ++i) {
+            porevol[i] = porosity[i]*begin_cell_volume[i];
+        }
     }
 
     /// @brief Computes pore volume of all cells in a grid, with rock compressibility effects.
@@ -70,8 +71,18 @@ namespace Opm
                            std::vector<double>& porevol)
     {
         porevol.resize(number_of_cells);
-        for (int i = 0; i < number_of_cells; ++i) {
-            porevol[i] = porosity[i]*begin_cell_volumes[i]*rock_comp.poroMult(pressure[i]);
+        // The pore volume multipliers of a chunk of cells are still in
+        // cache when they are scaled by the static pore volume.
+        const int chunk = 1024;
+        const int num_chunks = (number_of_cells + chunk - 1) / chunk;
+#pragma omp parallel for schedule(static)
+        for (int k = 0; k < num_chunks; ++k) {
+            const int begin = k*chunk;
+            const int end = std::min(number_of_cells, begin + chunk);
+            rock_comp.poroMult(end - begin, pressure.data() + begin, porevol.data() + begin, 0);
+            for (int i = begin; i < end; ++i) {
+                porevol[i] *= porosity[i]*begin_cell_volumes[i];
+            }
         }
     }
 
@@ -81,42 +92,37 @@ namespace Opm
                     std::vector<double>& wdp)
     {
         const int nw = wells.number_of_wells;
-        const size_t np = per_grid_cell ?
+        const int nperf = wells.well_connpos[nw];
+        const int np = per_grid_cell ?
             saturations.size()/number_of_cells
-            : saturations.size()/wells.well_connpos[nw];
-        // Simple for now:
+            : saturations.size()/nperf;
+        wdp.resize(nperf);
+        // Perforations of a well are contiguous, so every well writes
+        // its own range of wdp.
+#pragma omp parallel for schedule(static)
         for (int i = 0; i < nw; i++) {
-            double depth_ref = wells.depth_ref[i];
+            const double depth_ref = wells.depth_ref[i];
             for (int j = wells.well_connpos[i]; j < wells.well_connpos[i + 1]; j++) {
-                int cell = wells.well_cells[j];
+                const int cell = wells.well_cells[j];
+                const double* s = &saturations[0] + np*(per_grid_cell ? cell : j);
 
                 // Is this correct wrt. depth_ref?
-                double cell_depth = UgGridHelpers
+                const double cell_depth = UgGridHelpers
                     ::getCoordinate(UgGridHelpers::increment(begin_cell_centroids, cell, 3), 2);
 
                 double saturation_sum = 0.0;
-                for (size_t p = 0; p < np; p++) {
-                    if (!per_grid_cell) {
-                        saturation_sum += saturations[j * np + p];
-                    } else {
-                        saturation_sum += saturations[np * cell + p];
-                    }
+                double weighted_density = 0.0;
+                for (int p = 0; p < np; p++) {
+                    saturation_sum += s[p];
+                    weighted_density += s[p] * densities[p];
                 }
                 if (saturation_sum == 0) {
                     saturation_sum = 1.0;
                 }
-                double density = 0.0;
-                for (size_t p = 0; p < np; p++) {
-                    if (!per_grid_cell) {
-                        density += saturations[j * np + p] * densities[p] / saturation_sum;
-                    } else {
-                        // Is this a smart way of doing it?
-                        density += saturations[np * cell + p] * densities[p] / saturation_sum;
-                    }
-                }
+                const double density = weighted_density / saturation_sum;
 
                 // Is the sign correct?
-                wdp.push_back(density * (cell_depth - depth_ref) * gravity);
+                wdp[j] = density * (cell_depth - depth_ref) * gravity;
             }
         }
     }
@@ -0,0 +1,107 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <opm/core/utility/parameters/FrozenParameterGroup.hpp>
+
+#include <opm/core/utility/parameters/ParameterStrings.hpp>
+#include <opm/core/utility/parameters/ParameterTools.hpp>
+
+namespace Opm {
+    namespace parameter {
+
+        FrozenParameterGroup::FrozenParameterGroup(const ParameterGroup& param)
+            : path_(param.path())
+        {
+            flatten(param, "");
+        }
+
+
+
+        bool FrozenParameterGroup::has(const std::string& name) const
+        {
+            return find(name) != 0;
+        }
+
+
+
+        void FrozenParameterGroup::flatten(const ParameterGroup& group,
+                                           const std::string& prefix)
+        {
+            for (ParameterGroup::map_type::const_iterator
+                     it = group.map_.begin(); it != group.map_.end(); ++it) {
+                const std::string key = prefix + it->first;
+                items_[key] = it->second;
+                if (it->second->getTag() == ID_xmltag__param_grp) {
+                    flatten(dynamic_cast<const ParameterGroup&>(*it->second),
+                            key + ID_delimiter_path);
+                }
+            }
+        }
+
+
+
+        const ParameterMapItem*
+        FrozenParameterGroup::find(const std::string& name) const
+        {
+            // Leading delimiters refer to the frozen group itself.
+            std::string::size_type start = 0;
+            while (name.compare(start, ID_delimiter_path.size(), ID_delimiter_path) == 0) {
+                start += ID_delimiter_path.size();
+            }
+            return find("", name.substr(start));
+        }
+
+
+
+        const ParameterMapItem*
+        FrozenParameterGroup::find(const std::string& scope,
+                                   const std::string& name) const
+        {
+            const std::pair<std::string, std::string> name_path = split(name);
+            const std::string key = scope.empty()
+                ? name_path.first
+                : scope + ID_delimiter_path + name_path.first;
+
+            const auto it = items_.find(key);
+            if (it == items_.end()) {
+                if (scope.empty()) {
+                    return 0;
+                }
+                // As ParameterGroup::get(), ask the enclosing group.
+                const std::string::size_type pos = scope.rfind(ID_delimiter_path);
+                const std::string parent = (pos == std::string::npos)
+                    ? std::string() : scope.substr(0, pos);
+                return find(parent, name);
+            }
+            if (name_path.second == "") {
+                return it->second.get();
+            }
+            if (it->second->getTag() != ID_xmltag__param_grp) {
+                return 0;
+            }
+            it->second->setUsed();
+            return find(key, name_path.second);
+        }
+
+    } // namespace parameter
+} // namespace Opm
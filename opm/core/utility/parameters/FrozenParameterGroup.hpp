@@ -0,0 +1,210 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPM_FROZENPARAMETERGROUP_HEADER
+#define OPM_FROZENPARAMETERGROUP_HEADER
+
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Opm {
+    namespace parameter {
+
+        class FrozenParameterGroup;
+
+        /// Handle to a parameter value stored in a FrozenParameterGroup.
+        /// Retrieving the value through a handle is an array access.
+        template <typename T>
+        class ParamHandle {
+        public:
+            /// An invalid handle.
+            ParamHandle() : index_(-1) {}
+
+            /// Whether the handle refers to a value.
+            bool valid() const { return index_ >= 0; }
+
+        private:
+            friend class FrozenParameterGroup;
+            explicit ParamHandle(const int index) : index_(index) {}
+            int index_;
+        };
+
+        /// Read-only view of a ParameterGroup for repeated access.
+        ///
+        /// All parameters of the group and its subgroups are indexed
+        /// once, by their path relative to the group, in a hash table.
+        /// Names are looked up with the same inheritance rules as in
+        /// ParameterGroup: a name not found in a subgroup is looked up
+        /// in the enclosing groups, up to the group that was frozen.
+        ///
+        /// A parameter that is read often should be resolved once with
+        /// handle(), which converts its value to the requested type and
+        /// stores it in a typed slot.  get() with the handle then
+        /// returns the stored value without any lookup or conversion.
+        ///
+        /// Parameters are marked as used in the original group when they
+        /// are resolved, so displayUsage() reports them as usual.
+        /// Nothing is written to standard output.  Later changes to the
+        /// original group are not seen.  The supported types are int,
+        /// double, bool and std::string.
+        class FrozenParameterGroup {
+        public:
+            /// Index all parameters of a group.
+            explicit FrozenParameterGroup(const ParameterGroup& param);
+
+            /// Whether a parameter or group of the given name exists.
+            bool has(const std::string& name) const;
+
+            /// Resolve a parameter into a typed slot.
+            /// Throws ParameterGroup::NotFoundException if there is no
+            /// such parameter, and ParameterGroup::WrongTypeException if
+            /// its value cannot be converted to T.
+            template <typename T>
+            ParamHandle<T> handle(const std::string& name);
+
+            /// Resolve a parameter into a typed slot, storing
+            /// default_value if there is no such parameter.
+            template <typename T>
+            ParamHandle<T> handle(const std::string& name, const T& default_value);
+
+            /// Value of a resolved parameter.
+            template <typename T>
+            T get(const ParamHandle<T>& h) const
+            {
+                return slots(static_cast<T*>(0))[h.index_];
+            }
+
+            /// Value of a parameter, by hashed lookup and conversion.
+            /// Throws as handle().
+            template <typename T>
+            T get(const std::string& name) const;
+
+            /// Value of a parameter, or default_value if there is no
+            /// such parameter.
+            template <typename T>
+            T getDefault(const std::string& name, const T& default_value) const;
+
+        private:
+            typedef std::shared_ptr<ParameterMapItem> data_type;
+
+            void flatten(const ParameterGroup& group, const std::string& prefix);
+            const ParameterMapItem* find(const std::string& name) const;
+            const ParameterMapItem* find(const std::string& scope,
+                                         const std::string& name) const;
+
+            template <typename T>
+            T convert(const std::string& name, const ParameterMapItem& item) const;
+
+            std::vector<int>&         slots(int*)         { return ints_; }
+            std::vector<double>&      slots(double*)      { return doubles_; }
+            std::vector<bool>&        slots(bool*)        { return bools_; }
+            std::vector<std::string>& slots(std::string*) { return strings_; }
+            const std::vector<int>&         slots(int*) const         { return ints_; }
+            const std::vector<double>&      slots(double*) const      { return doubles_; }
+            const std::vector<bool>&        slots(bool*) const        { return bools_; }
+            const std::vector<std::string>& slots(std::string*) const { return strings_; }
+
+            std::string path_;
+            std::unordered_map<std::string, data_type> items_;
+            std::vector<int> ints_;
+            std::vector<double> doubles_;
+            std::vector<bool> bools_;
+            std::vector<std::string> strings_;
+        };
+
+
+
+        template <typename T>
+        inline ParamHandle<T>
+        FrozenParameterGroup::handle(const std::string& name)
+        {
+            std::vector<T>& s = slots(static_cast<T*>(0));
+            s.push_back(get<T>(name));
+            return ParamHandle<T>(static_cast<int>(s.size()) - 1);
+        }
+
+        template <typename T>
+        inline ParamHandle<T>
+        FrozenParameterGroup::handle(const std::string& name, const T& default_value)
+        {
+            std::vector<T>& s = slots(static_cast<T*>(0));
+            s.push_back(getDefault<T>(name, default_value));
+            return ParamHandle<T>(static_cast<int>(s.size()) - 1);
+        }
+
+        template <typename T>
+        inline T
+        FrozenParameterGroup::get(const std::string& name) const
+        {
+            const ParameterMapItem* item = find(name);
+            if (item == 0) {
+                std::cerr << "ERROR: The group '" << path_
+                          << "' does not contain an element named '"
+                          << name << "'.\n";
+                throw ParameterGroup::NotFoundException();
+            }
+            return convert<T>(name, *item);
+        }
+
+        template <typename T>
+        inline T
+        FrozenParameterGroup::getDefault(const std::string& name,
+                                         const T& default_value) const
+        {
+            const ParameterMapItem* item = find(name);
+            if (item == 0) {
+                return default_value;
+            }
+            return convert<T>(name, *item);
+        }
+
+        template <typename T>
+        inline T
+        FrozenParameterGroup::convert(const std::string& name,
+                                      const ParameterMapItem& item) const
+        {
+            std::string conversion_error;
+            T value = ParameterMapItemTrait<T>::convert(item, conversion_error, false);
+            if (conversion_error != "") {
+                std::cerr << "ERROR: Failed to convert the element named '"
+                          << name
+                          << "' in the group '"
+                          << path_
+                          << "' to the type '"
+                          << ParameterMapItemTrait<T>::type()
+                          << "'.\n";
+                std::cerr << "The conversion routine returned the following message:\n"
+                          << conversion_error
+                          << "\n";
+                throw ParameterGroup::WrongTypeException();
+            }
+            item.setUsed();
+            return value;
+        }
+
+    } // namespace parameter
+} // namespace Opm
+
+#endif // OPM_FROZENPARAMETERGROUP_HEADER
@@ -46,6 +46,8 @@
 
 namespace Opm {
     namespace parameter {
+	class FrozenParameterGroup;
+
 	/// ParameterGroup is a class that is used to provide run-time parameters.
 	/// The standard use of the class is to call create it with the
 	/// (int argc, char** argv) constructor (where the arguments are those
@@ -278,6 +280,8 @@ namespace Opm {
             const std::vector<std::string>& unhandledArguments() const;
 
 	private:
+	    friend class FrozenParameterGroup;
+
 	    typedef std::shared_ptr<ParameterMapItem> data_type;
 	    typedef std::pair<std::string, data_type> pair_type;
 	    typedef std::map<std::string, data_type> map_type;
@@ -22,7 +22,16 @@
 
 #include <opm/core/props/BlackoilPropertiesFromDeck.hpp>
 #include <opm/core/props/BlackoilPhases.hpp>
+#include <opm/core/utility/CellRegionIndex.hpp>
 
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include <opm/parser/eclipse/EclipseState/SimulationConfig/SimulationConfig.hpp>
 #include <opm/parser/eclipse/EclipseState/SimulationConfig/ThresholdPressure.hpp>
@@ -33,6 +42,81 @@
 
 namespace Opm
 {
+namespace ThresholdPressureDetails
+{
+    /// Values for all ordered pairs of equilibration region numbers,
+    /// stored as a dense matrix indexed by the EQLNUM values.
+    struct RegionPairTable
+    {
+        explicit RegionPairTable(const int numRegions)
+            : nreg(numRegions)
+            , value(std::size_t(numRegions)*numRegions, 0.0)
+            , state(std::size_t(numRegions)*numRegions, 0)
+        {}
+
+        std::size_t index(const int eq1, const int eq2) const
+        {
+            return std::size_t(eq1)*nreg + eq2;
+        }
+
+        int nreg;
+        std::vector<double> value;
+        std::vector<char> state;
+    };
+
+    /// Size of a RegionPairTable for the given EQLNUM values.
+    inline int numRegions(const std::vector<int>& eqlnumData)
+    {
+        int maxEq = 0;
+        for (const int eq : eqlnumData) {
+            if (eq < 0) {
+                OPM_THROW(std::runtime_error, "Negative EQLNUM value " << eq);
+            }
+            maxEq = std::max(maxEq, eq);
+        }
+        return maxEq + 1;
+    }
+
+    enum { NoBarrier = 0, HasThreshold = 1, MissingMaxDp = 2 };
+
+    /// Threshold pressure of every region pair, from THPRES or, if
+    /// defaulted there, from maxDp.
+    template <class ThresholdPressureType>
+    RegionPairTable
+    pairThresholds(const ThresholdPressureType& thresholdPressure,
+                   const std::map<std::pair<int, int>, double>& maxDp,
+                   const int numRegions)
+    {
+        RegionPairTable table(numRegions);
+        for (int eq1 = 0; eq1 < numRegions; ++eq1) {
+            for (int eq2 = 0; eq2 < numRegions; ++eq2) {
+                if (!thresholdPressure.hasRegionBarrier(eq1, eq2)) {
+                    continue;
+                }
+                const std::size_t ix = table.index(eq1, eq2);
+                if (thresholdPressure.hasThresholdPressure(eq1, eq2)) {
+                    table.value[ix] = thresholdPressure.getThresholdPressure(eq1, eq2);
+                    table.state[ix] = HasThreshold;
+                }
+                else {
+                    // set the threshold pressure for faces of PVT regions where the third item
+                    // has been defaulted to the maximum pressure potential difference between
+                    // these regions
+                    const auto it = maxDp.find(std::make_pair(eq1, eq2));
+                    if (it != maxDp.end()) {
+                        table.value[ix] = it->second;
+                        table.state[ix] = HasThreshold;
+                    }
+                    else {
+                        table.state[ix] = MissingMaxDp;
+                    }
+                }
+            }
+        }
+        return table;
+    }
+} // namespace ThresholdPressureDetails
+
 /// \brief Compute the maximum gravity corrected pressure difference of all
 ///        equilibration regions given a reservoir state.
 /// \tparam    Grid           Type of grid object (UnstructuredGrid or CpGrid).
@@ -55,9 +139,6 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
 
     const PhaseUsage& pu = props.phaseUsage();
 
-    std::shared_ptr<const GridProperty<int>> eqlnum = eclipseState->getIntGridProperty("EQLNUM");
-    const auto& eqlnumData = eqlnum->getData();
-
     const int numPhases = initialState.numPhases();
     const int numCells = UgGridHelpers::numCells(grid);
     const int numPvtRegions = deck->getKeyword("TABDIMS").getRecord(0).getItem("NTPVT").get< int >(0);
@@ -96,15 +177,9 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
         }
     }
 
-    // retrieve the PVT region of each cell. note that we need c++ instead of
-    // Fortran indices.
-    const int* gc = UgGridHelpers::globalCell(grid);
-    std::vector<int> pvtRegion(numCells);
-    const auto& cartPvtRegion = eclipseState->getIntGridProperty("PVTNUM")->getData();
-    for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
-        const int cartCellIdx = gc ? gc[cellIdx] : cellIdx;
-        pvtRegion[cellIdx] = std::max(0, cartPvtRegion[cartCellIdx] - 1);
-    }
+    // the PVT region of each cell, as already extracted by the
+    // fluid properties.
+    const int* pvtRegion = props.cellPvtRegionIndex();
 
     // compute the initial "phase presence" of each cell (required to calculate
     // the inverse formation volume factors
@@ -243,52 +318,95 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
     }
 
     // Calculate the maximum pressure potential difference between all PVT region
-    // transitions of the initial solution.
+    // transitions of the initial solution.  The faces are swept in
+    // parallel, each thread keeping its own maxima in a dense table of
+    // region pairs.
+    using namespace ThresholdPressureDetails;
+    const auto eqlnum = CellRegionIndex::get(eclipseState, "EQLNUM", numCells,
+                                             UgGridHelpers::globalCell(grid));
+    // The region pair tables are indexed by EQLNUM values.
+    const int numRegions = eqlnum->numRegions() + 1;
+
+    std::vector<double> depth(numCells);
+#pragma omp parallel for schedule(static)
+    for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        depth[cellIdx] = UgGridHelpers::cellCenterDepth(grid, cellIdx);
+    }
+
+    RegionPairTable dpTable(numRegions);
     const int num_faces = UgGridHelpers::numFaces(grid);
     const auto& fc = UgGridHelpers::faceCells(grid);
-    for (int face = 0; face < num_faces; ++face) {
-        const int c1 = fc(face, 0);
-        const int c2 = fc(face, 1);
-        if (c1 < 0 || c2 < 0) {
-            // Boundary face, skip this.
-            continue;
-        }
-        const int gc1 = (gc == 0) ? c1 : gc[c1];
-        const int gc2 = (gc == 0) ? c2 : gc[c2];
-        const int eq1 = eqlnumData[gc1];
-        const int eq2 = eqlnumData[gc2];
-
-        if (eq1 == eq2) {
-            // not an equilibration region boundary. skip this.
-            continue;
-        }
+#pragma omp parallel
+    {
+        RegionPairTable localDp(numRegions);
+
+#pragma omp for schedule(static)
+        for (int face = 0; face < num_faces; ++face) {
+            const int c1 = fc(face, 0);
+            const int c2 = fc(face, 1);
+            if (c1 < 0 || c2 < 0) {
+                // Boundary face, skip this.
+                continue;
+            }
+            const int eq1 = (*eqlnum)[c1] + 1;
+            const int eq2 = (*eqlnum)[c2] + 1;
 
-        // update the maximum pressure potential difference between the two
-        // regions
-        const auto barrierId = std::make_pair(eq1, eq2);
-        if (maxDp.count(barrierId) == 0) {
-            maxDp[barrierId] = 0.0;
-        }
+            if (eq1 == eq2) {
+                // not an equilibration region boundary. skip this.
+                continue;
+            }
 
-        for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            const double z1 = UgGridHelpers::cellCenterDepth(grid, c1);
-            const double z2 = UgGridHelpers::cellCenterDepth(grid, c2);
+            // update the maximum pressure potential difference between the two
+            // regions
+            const std::size_t barrierIdx = localDp.index(eq1, eq2);
+            localDp.state[barrierIdx] = 1;
+            double& dp = localDp.value[barrierIdx];
+
+            const double z1 = depth[c1];
+            const double z2 = depth[c2];
             const double zAvg = (z1 + z2)/2; // average depth
 
-            const double rhoAvg = (rho[phaseIdx][c1] + rho[phaseIdx][c2])/2;
+            for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                const double rhoAvg = (rho[phaseIdx][c1] + rho[phaseIdx][c2])/2;
+
+                const double s1 = initialState.saturation()[numPhases*c1 + phaseIdx];
+                const double s2 = initialState.saturation()[numPhases*c2 + phaseIdx];
 
-            const double s1 = initialState.saturation()[numPhases*c1 + phaseIdx];
-            const double s2 = initialState.saturation()[numPhases*c2 + phaseIdx];
+                const double sResid1 = minSat[numPhases*c1 + phaseIdx];
+                const double sResid2 = minSat[numPhases*c2 + phaseIdx];
 
-            const double sResid1 = minSat[numPhases*c1 + phaseIdx];
-            const double sResid2 = minSat[numPhases*c2 + phaseIdx];
+                // compute gravity corrected pressure potentials at the average depth
+                const double p1 = phasePressure[phaseIdx][c1] + rhoAvg*gravity*(zAvg - z1);
+                const double p2 = phasePressure[phaseIdx][c2] + rhoAvg*gravity*(zAvg - z2);
+
+                if ((p1 > p2 && s1 > sResid1) || (p2 > p1 && s2 > sResid2))
+                    dp = std::max(dp, std::abs(p1 - p2));
+            }
+        }
 
-            // compute gravity corrected pressure potentials at the average depth
-            const double p1 = phasePressure[phaseIdx][c1] + rhoAvg*gravity*(zAvg - z1);
-            const double p2 = phasePressure[phaseIdx][c2] + rhoAvg*gravity*(zAvg - z2);
+#pragma omp critical
+        for (std::size_t i = 0; i < dpTable.value.size(); ++i) {
+            if (localDp.state[i]) {
+                dpTable.state[i] = 1;
+                dpTable.value[i] = std::max(dpTable.value[i], localDp.value[i]);
+            }
+        }
+    }
 
-            if ((p1 > p2 && s1 > sResid1) || (p2 > p1 && s2 > sResid2))
-                maxDp[barrierId] = std::max(maxDp[barrierId], std::abs(p1 - p2));
+    for (int eq1 = 0; eq1 < numRegions; ++eq1) {
+        for (int eq2 = 0; eq2 < numRegions; ++eq2) {
+            const std::size_t barrierIdx = dpTable.index(eq1, eq2);
+            if (!dpTable.state[barrierIdx]) {
+                continue;
+            }
+            const auto barrierId = std::make_pair(eq1, eq2);
+            const auto it = maxDp.find(barrierId);
+            if (it == maxDp.end()) {
+                maxDp[barrierId] = dpTable.value[barrierIdx];
+            }
+            else {
+                it->second = std::max(it->second, dpTable.value[barrierIdx]);
+            }
         }
     }
 }
@@ -323,14 +441,22 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
         std::vector<double> thpres_vals;
         if (simulationConfig->hasThresholdPressure()) {
             std::shared_ptr<const ThresholdPressure> thresholdPressure = simulationConfig->getThresholdPressure();
-            std::shared_ptr<const GridProperty<int>> eqlnum = eclipseState->getIntGridProperty("EQLNUM");
-            const auto& eqlnumData = eqlnum->getData();
+            const auto eqlnum = CellRegionIndex::get(eclipseState, "EQLNUM",
+                                                     UgGridHelpers::numCells(grid),
+                                                     UgGridHelpers::globalCell(grid));
+
+            // Look up the threshold of each region pair once.  The
+            // table is indexed by EQLNUM values.
+            using namespace ThresholdPressureDetails;
+            const RegionPairTable table =
+                pairThresholds(*thresholdPressure, maxDp, eqlnum->numRegions() + 1);
 
             // Set threshold pressure values for each cell face.
             const int num_faces = UgGridHelpers::numFaces(grid);
             const auto& fc = UgGridHelpers::faceCells(grid);
-            const int* gc = UgGridHelpers::globalCell(grid);
             thpres_vals.resize(num_faces, 0.0);
+            bool missing = false;
+#pragma omp parallel for schedule(static) reduction(||:missing)
             for (int face = 0; face < num_faces; ++face) {
                 const int c1 = fc(face, 0);
                 const int c2 = fc(face, 1);
@@ -338,24 +464,18 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
                     // Boundary face, skip it.
                     continue;
                 }
-                const int gc1 = (gc == 0) ? c1 : gc[c1];
-                const int gc2 = (gc == 0) ? c2 : gc[c2];
-                const int eq1 = eqlnumData[gc1];
-                const int eq2 = eqlnumData[gc2];
-
-                if (thresholdPressure->hasRegionBarrier(eq1,eq2)) {
-                    if (thresholdPressure->hasThresholdPressure(eq1,eq2)) {
-                        thpres_vals[face] = thresholdPressure->getThresholdPressure(eq1,eq2);
-                    }
-                    else {
-                        // set the threshold pressure for faces of PVT regions where the third item
-                        // has been defaulted to the maximum pressure potential difference between
-                        // these regions
-                        const auto barrierId = std::make_pair(eq1, eq2);
-                        thpres_vals[face] = maxDp.at(barrierId);
-                    }
-                }
+                const std::size_t ix = table.index((*eqlnum)[c1] + 1, (*eqlnum)[c2] + 1);
 
+                if (table.state[ix] == HasThreshold) {
+                    thpres_vals[face] = table.value[ix];
+                }
+                else if (table.state[ix] == MissingMaxDp) {
+                    missing = true;
+                }
+            }
+            if (missing) {
+                OPM_THROW(std::runtime_error, "Defaulted threshold pressure between "
+                          "equilibration regions without a computed pressure difference.");
             }
         }
         return thpres_vals;
@@ -373,7 +493,8 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
     ///                           particular connection. An empty vector is
     ///                           returned if there is no THPRES
     ///                           feature used in the deck.
-     std::vector<double> thresholdPressuresNNC(EclipseStateConstPtr eclipseState,
+    inline
+    std::vector<double> thresholdPressuresNNC(EclipseStateConstPtr eclipseState,
                                                const NNC& nnc,
                                                const std::map<std::pair<int, int>, double>& maxDp)
     {
@@ -382,28 +503,33 @@ void computeMaxDp(std::map<std::pair<int, int>, double>& maxDp,
         if (simulationConfig->hasThresholdPressure()) {
             std::shared_ptr<const ThresholdPressure> thresholdPressure = simulationConfig->getThresholdPressure();
             std::shared_ptr<const GridProperty<int>> eqlnum = eclipseState->getIntGridProperty("EQLNUM");
-            auto eqlnumData = eqlnum->getData();
+            const auto& eqlnumData = eqlnum->getData();
 
-            // Set values for each NNC
+            using namespace ThresholdPressureDetails;
+            const RegionPairTable table =
+                pairThresholds(*thresholdPressure, maxDp, numRegions(eqlnumData));
 
-            thpres_vals.resize(nnc.numNNC(), 0.0);
-            for (size_t i = 0 ; i < nnc.numNNC(); ++i) {
-                const int gc1 = nnc.nncdata()[i].cell1;
-                const int gc2 = nnc.nncdata()[i].cell2;
-                const int eq1 = eqlnumData[gc1];
-                const int eq2 = eqlnumData[gc2];
-
-                if (thresholdPressure->hasRegionBarrier(eq1,eq2)) {
-                    if (thresholdPressure->hasThresholdPressure(eq1,eq2)) {
-                        thpres_vals[i] = thresholdPressure->getThresholdPressure(eq1,eq2);
-                    } else {
-                        // set the threshold pressure for NNC of PVT regions where the third item
-                        // has been defaulted to the maximum pressure potential difference between
-                        // these regions
-                        const auto barrierId = std::make_pair(eq1, eq2);
-                        thpres_vals[i] = maxDp.at(barrierId);
-                    }
+            // Set values for each NNC
+            const int num_nnc = nnc.numNNC();
+            const auto& nncdata = nnc.nncdata();
+            thpres_vals.resize(num_nnc, 0.0);
+            bool missing = false;
+#pragma omp parallel for schedule(static) reduction(||:missing)
+            for (int i = 0 ; i < num_nnc; ++i) {
+                const int gc1 = nncdata[i].cell1;
+                const int gc2 = nncdata[i].cell2;
+                const std::size_t ix = table.index(eqlnumData[gc1], eqlnumData[gc2]);
+
+                if (table.state[ix] == HasThreshold) {
+                    thpres_vals[i] = table.value[ix];
                 }
+                else if (table.state[ix] == MissingMaxDp) {
+                    missing = true;
+                }
+            }
+            if (missing) {
+                OPM_THROW(std::runtime_error, "Defaulted threshold pressure between "
+                          "equilibration regions without a computed pressure difference.");
             }
         }
         return thpres_vals;
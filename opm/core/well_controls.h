@@ -21,6 +21,7 @@
 #define OPM_WELL_CONTROLS_H_INCLUDED
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @file
@@ -59,6 +60,13 @@ well_controls_clone(const struct WellControls *ctrl);
 void
 well_controls_destroy(struct WellControls *ctrl);
 
+/**
+ * Count the bytes allocated by a set of well controls, its capacity
+ * included.
+ */
+size_t
+well_controls_memory(const struct WellControls *ctrl);
+
 
 int 
 well_controls_get_num(const struct WellControls *ctrl);
@@ -131,6 +139,115 @@ void
 well_controls_clear(struct WellControls * ctrl);
 
 
+/**
+ * Controls of a set of wells, packed into contiguous arrays (one array
+ * per attribute) so that the limits of all wells may be checked in a
+ * single pass without visiting each well's WellControls.  Each array
+ * starts on a cache line.  The table is a copy, and must be refreshed
+ * by well_controls_table_update() after the controls have changed.
+ */
+struct WellControlsTable
+{
+    int number_of_wells;   /**< Number of wells. */
+    int number_of_phases;  /**< Number of phases. */
+
+    /**
+     * Control start pointers.  The controls of well @c w are
+     * <CODE>ctrl_pos[w] ... ctrl_pos[w + 1] - 1</CODE>.
+     */
+    int *ctrl_pos;
+
+    int *current;          /**< Current control index of each well. */
+    int *is_producer;      /**< Nonzero for producers, one per well. */
+
+    enum WellControlType *type; /**< Control types. */
+    double *target;        /**< Control targets. */
+
+    /**
+     * Rate control distributions, <CODE>number_of_phases</CODE> numbers
+     * for each control.  Zero if a control has no distribution.
+     */
+    double *distr;
+
+    int *ctrl_well;        /**< Well of each control. */
+    int *violated;         /**< Work space of well_controls_table_check_limits(). */
+
+    void *data;            /**< Storage of all arrays. */
+    int   wells_cpty;      /**< Allocated number of wells. */
+    int   ctrls_cpty;      /**< Allocated number of controls. */
+    int   phases_cpty;     /**< Allocated number of phases. */
+};
+
+
+/**
+ * Create a packed table of the controls of a set of wells.
+ *
+ * @param[in] nwells      Number of wells.
+ * @param[in] nphases     Number of phases.
+ * @param[in] ctrls       Controls of each well, @c nwells pointers.
+ * @param[in] is_producer Nonzero for producers, @c nwells values.
+ *
+ * @return Fully populated table, or NULL if allocation failed.
+ * Dispose of the table using well_controls_table_destroy().
+ */
+struct WellControlsTable *
+well_controls_table_create(int nwells, int nphases,
+                           struct WellControls * const *ctrls,
+                           const int *is_producer);
+
+/**
+ * Copy the current controls of a set of wells into an existing table,
+ * reallocating its storage only if it is too small.
+ *
+ * @return 1 if successful, 0 if allocation failed, in which case the
+ * table is left unchanged.
+ */
+int
+well_controls_table_update(int nwells, int nphases,
+                           struct WellControls * const *ctrls,
+                           const int *is_producer,
+                           struct WellControlsTable *tab);
+
+void
+well_controls_table_destroy(struct WellControlsTable *tab);
+
+/**
+ * Check the (inactive) limits of all wells.  For each well, the
+ * controls except the current one and <CODE>skip[w]</CODE> are checked
+ * in order, and the first one violated is reported as the control to
+ * switch to.  A BHP limit is violated by a lower BHP in a producer and
+ * a higher BHP in an injector, a rate limit by a larger absolute rate
+ * (with a relative tolerance of 1e-6 for reservoir rates).
+ *
+ * @param[in]  tab          Controls of all wells.
+ * @param[in]  skip         Additional control index not to check for
+ *                          each well, or -1.  NULL to skip none.
+ * @param[in]  bhp          Bottom-hole pressure of each well.
+ * @param[in]  resv_rates   Reservoir rates, <CODE>number_of_phases</CODE>
+ *                          per well.
+ * @param[in]  surf_rates   Surface rates, <CODE>number_of_phases</CODE>
+ *                          per well.
+ * @param[out] switch_wells Wells violating a limit, in increasing order.
+ *                          Room for <CODE>number_of_wells</CODE> entries.
+ * @param[out] switch_ctrls Control to switch to for each well in
+ *                          @c switch_wells.
+ *
+ * The controls are evaluated in one sweep over all controls of all
+ * wells, using @c tab->violated as work space.
+ *
+ * @return Number of wells to switch, or -1 if a THP limit would have
+ * to be checked, which is not supported.
+ */
+int
+well_controls_table_check_limits(struct WellControlsTable *tab,
+                                 const int                *skip,
+                                 const double             *bhp,
+                                 const double             *resv_rates,
+                                 const double             *surf_rates,
+                                 int                      *switch_wells,
+                                 int                      *switch_ctrls);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -287,6 +287,17 @@ void
 destroy_wells(struct Wells *W);
 
 
+/**
+ * Count the bytes allocated by a Wells object, including its controls and
+ * the capacity reserved for further wells and perforations.
+ *
+ * @param[in] W Existing Wells object.
+ * @return Number of bytes.
+ */
+size_t
+wells_memory(const struct Wells *W);
+
+
 /**
  * Create a deep-copy (i.e., clone) of an existing Wells object, including its
  * controls.
@@ -326,6 +337,10 @@ clone_wells(const struct Wells *W);
  *    of defined and active operational constraints as determined by
  *    function well_controls_equal()
  *
+ * Unless \c verbose is set, all conditions but the last are decided by
+ * comparing hashes maintained by function add_well().  The per-well
+ * arrays must therefore not be modified other than through add_well().
+ *
  * \param[in] W1      Existing set of wells.
  * \param[in] W2      Existing set of wells.
  *
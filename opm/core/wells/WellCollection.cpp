@@ -19,16 +19,26 @@
 
 #include "config.h"
 #include <opm/core/wells/WellCollection.hpp>
+#include <opm/core/wells.h>
+#include <opm/core/well_controls.h>
+#include <opm/common/ErrorMacros.hpp>
 
 #include <opm/parser/eclipse/EclipseState/Schedule/Well.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/Group.hpp>
 
 #include <boost/lexical_cast.hpp>
 
+#include <iostream>
 #include <memory>
+#include <utility>
 
 namespace Opm
 {
+    WellCollection::WellCollection()
+        : wells_(0)
+    {
+    }
+
     void WellCollection::addField(GroupConstPtr fieldGroup, size_t timeStep, const PhaseUsage& phaseUsage) {
         WellsGroupInterface* fieldNode = findNode(fieldGroup->name());
         if (fieldNode) {
@@ -36,6 +46,7 @@ namespace Opm
         }
 
         roots_.push_back(createGroupWellsGroup(fieldGroup, timeStep, phaseUsage));
+        indexNodes(roots_.back().get());
     }
 
     void WellCollection::addGroup(GroupConstPtr groupChild, std::string parent_name,
@@ -58,6 +69,7 @@ namespace Opm
         }
         parent_as_group->addChild(child);
         child->setParent(parent);
+        indexNodes(child.get());
     }
 
     void WellCollection::addWell(WellConstPtr wellChild, size_t timeStep, const PhaseUsage& phaseUsage) {
@@ -77,6 +89,7 @@ namespace Opm
         leaf_nodes_.push_back(static_cast<WellNode*>(child.get()));
 
         child->setParent(parent);
+        indexNodes(child.get());
     }
 
     const std::vector<WellNode*>& WellCollection::getLeafNodes() const {
@@ -85,26 +98,14 @@ namespace Opm
 
     WellsGroupInterface* WellCollection::findNode(const std::string& name)
     {
-
-        for (size_t i = 0; i < roots_.size(); i++) {
-            WellsGroupInterface* result = roots_[i]->findGroup(name);
-            if (result) {
-                return result;
-            }
-        }
-        return NULL;
+        auto it = node_by_name_.find(name);
+        return it == node_by_name_.end() ? NULL : it->second;
     }
 
     const WellsGroupInterface* WellCollection::findNode(const std::string& name) const
     {
-
-        for (size_t i = 0; i < roots_.size(); i++) {
-            WellsGroupInterface* result = roots_[i]->findGroup(name);
-            if (result) {
-                return result;
-            }
-        }
-        return NULL;
+        auto it = node_by_name_.find(name);
+        return it == node_by_name_.end() ? NULL : it->second;
     }
 
     /// Adds the child to the collection
@@ -124,7 +125,7 @@ namespace Opm
         if (child_node->isLeafNode()) {
             leaf_nodes_.push_back(static_cast<WellNode*>(child_node.get()));
         }
-
+        indexNodes(child_node.get());
     }
 
     /// Adds the node to the collection (as a root node)
@@ -135,25 +136,147 @@ namespace Opm
         if (child_node->isLeafNode()) {
             leaf_nodes_.push_back(static_cast<WellNode*> (child_node.get()));
         }
+        indexNodes(child_node.get());
     }
 
     bool WellCollection::conditionsMet(const std::vector<double>& well_bhp,
                                        const std::vector<double>& well_reservoirrates_phase,
                                        const std::vector<double>& well_surfacerates_phase)
     {
-        for (size_t i = 0; i < roots_.size(); i++) {
-            WellPhasesSummed phases;
-            if (!roots_[i]->conditionsMet(well_bhp,
-                                          well_reservoirrates_phase,
-                                          well_surfacerates_phase,
-                                          phases)) {
+        // Same checks, in the same order, as calling conditionsMet()
+        // recursively from each root, but as a bottom-up sweep over
+        // the flattened tree.
+        flattenTree();
+        flat_phases_summed_.assign(flat_nodes_.size(), WellPhasesSummed());
+        for (size_t i = 0; i < flat_nodes_.size(); ++i) {
+            WellsGroupInterface* node = flat_nodes_[i];
+            if (node->isLeafNode()) {
+                if (!node->conditionsMet(well_bhp,
+                                         well_reservoirrates_phase,
+                                         well_surfacerates_phase,
+                                         flat_phases_summed_[i])) {
+                    return false;
+                }
+            } else if (!static_cast<WellsGroup*>(node)->groupConditionsMet(well_reservoirrates_phase,
+                                                                           well_surfacerates_phase,
+                                                                           flat_phases_summed_[i])) {
                 return false;
             }
+            if (flat_parent_[i] >= 0) {
+                flat_phases_summed_[flat_parent_[i]] += flat_phases_summed_[i];
+            }
         }
         return true;
     }
 
+    /// Like conditionsMet(), but checks all wells in one sweep and
+    /// applies the change of every well whose conditions are
+    /// violated, rather than only the first change. Since wells are
+    /// controlled independently, this avoids one pressure solve per
+    /// violating well. Group conditions are checked, and at most one
+    /// group change applied, only if all wells met their conditions,
+    /// because the summed group rates are not valid after a well has
+    /// changed its control.
+    /// \param[in]    well_bhp  A vector containing the bhp for each well. Is assumed
+    ///                         to be ordered the same way as the related Wells-struct.
+    /// \param[in]    well_reservoirrates_phase
+    ///                         A vector containing reservoir rates by phase for each well.
+    ///                         Is assumed to be ordered the same way as the related Wells-struct,
+    ///                         with all phase rates of a single well adjacent in the array.
+    /// \param[in]    well_surfacerates_phase
+    ///                         A vector containing surface rates by phase for each well.
+    ///                         Is assumed to be ordered the same way as the related Wells-struct,
+    ///                         with all phase rates of a single well adjacent in the array.
+    /// \return The number of changes applied, zero if all conditions are met.
+    int WellCollection::applyViolatedControls(const std::vector<double>& well_bhp,
+                                              const std::vector<double>& well_reservoirrates_phase,
+                                              const std::vector<double>& well_surfacerates_phase)
+    {
+        flattenTree();
+        flat_phases_summed_.assign(flat_nodes_.size(), WellPhasesSummed());
+        for (size_t i = 0; i < flat_nodes_.size(); ++i) {
+            WellsGroupInterface* node = flat_nodes_[i];
+            if (node->isLeafNode()) {
+                static_cast<WellNode*>(node)->reportRates(well_reservoirrates_phase,
+                                                          well_surfacerates_phase,
+                                                          flat_phases_summed_[i]);
+            }
+        }
+        const int num_changes = applyViolatedWellLimits(well_bhp,
+                                                        well_reservoirrates_phase,
+                                                        well_surfacerates_phase);
+        if (num_changes > 0) {
+            return num_changes;
+        }
+        // All wells are fine, so the bottom-up sweep of conditionsMet()
+        // only has group conditions left to check.
+        for (size_t i = 0; i < flat_nodes_.size(); ++i) {
+            WellsGroupInterface* node = flat_nodes_[i];
+            if (!node->isLeafNode()
+                && !static_cast<WellsGroup*>(node)->groupConditionsMet(well_reservoirrates_phase,
+                                                                       well_surfacerates_phase,
+                                                                       flat_phases_summed_[i])) {
+                return 1;
+            }
+            if (flat_parent_[i] >= 0) {
+                flat_phases_summed_[flat_parent_[i]] += flat_phases_summed_[i];
+            }
+        }
+        return 0;
+    }
+
+    int WellCollection::applyViolatedWellLimits(const std::vector<double>& well_bhp,
+                                                const std::vector<double>& well_reservoirrates_phase,
+                                                const std::vector<double>& well_surfacerates_phase)
+    {
+        // Same checks as WellNode::conditionsMet() for each well.
+        const int nw = leaf_nodes_.size();
+        if (nw == 0) {
+            return 0;
+        }
+        const int np = leaf_nodes_[0]->phaseUsage().num_phases;
+        is_producer_.resize(nw);
+        skip_ctrl_.resize(nw);
+        for (int w = 0; w < nw; ++w) {
+            is_producer_[w] = (wells_->type[w] == PRODUCER);
+            skip_ctrl_[w] = leaf_nodes_[w]->groupControlIndex();
+        }
+        if (!ctrls_table_) {
+            ctrls_table_.reset(well_controls_table_create(nw, np, wells_->ctrls, is_producer_.data()),
+                               well_controls_table_destroy);
+            if (!ctrls_table_) {
+                OPM_THROW(std::runtime_error, "Failed to allocate well controls table.");
+            }
+        } else if (!well_controls_table_update(nw, np, wells_->ctrls, is_producer_.data(),
+                                               ctrls_table_.get())) {
+            OPM_THROW(std::runtime_error, "Failed to allocate well controls table.");
+        }
+
+        switch_wells_.resize(nw);
+        switch_ctrls_.resize(nw);
+        const int num_switch = well_controls_table_check_limits(ctrls_table_.get(), skip_ctrl_.data(),
+                                                                well_bhp.data(),
+                                                                well_reservoirrates_phase.data(),
+                                                                well_surfacerates_phase.data(),
+                                                                switch_wells_.data(),
+                                                                switch_ctrls_.data());
+        if (num_switch < 0) {
+            OPM_THROW(std::invalid_argument, "THP not implemented in WellCollection::applyViolatedControls.");
+        }
+        for (int i = 0; i < num_switch; ++i) {
+            const int w = switch_wells_[i];
+            const int ctrl_index = switch_ctrls_[i];
+            std::cout << "Limit violated for well " << leaf_nodes_[w]->name()
+                      << ", switching to control " << ctrl_index
+                      << " with target " << well_controls_iget_target(wells_->ctrls[w], ctrl_index)
+                      << std::endl;
+            set_current_control(w, ctrl_index, wells_);
+        }
+        return num_switch;
+    }
+
     void WellCollection::setWellsPointer(Wells* wells) {
+        wells_ = wells;
         for(size_t i = 0; i < leaf_nodes_.size(); i++) {
             leaf_nodes_[i]->setWellsPointer(wells, i);
         }
@@ -184,4 +307,61 @@ namespace Opm
             roots_[i]->applyExplicitReinjectionControls(well_reservoirrates_phase, well_surfacerates_phase);
         }
     }
+
+    void WellCollection::indexNodes(WellsGroupInterface* node)
+    {
+        flat_nodes_.clear();
+        std::vector<WellsGroupInterface*> stack(1, node);
+        while (!stack.empty()) {
+            WellsGroupInterface* current = stack.back();
+            stack.pop_back();
+            node_by_name_.insert(std::make_pair(current->name(), current));
+            if (!current->isLeafNode()) {
+                for (const auto& child : static_cast<WellsGroup*>(current)->children()) {
+                    stack.push_back(child.get());
+                }
+            }
+        }
+    }
+
+    void WellCollection::flattenTree()
+    {
+        if (!flat_nodes_.empty()) {
+            return;
+        }
+        flat_parent_.clear();
+        // Depth-first, with the next child to visit for each node on
+        // the stack. Nodes whose parent has not been reached yet are
+        // kept in 'orphans'; the children of a group are the last
+        // entries there when the group is reached.
+        std::vector<std::pair<WellsGroupInterface*, size_t> > stack;
+        std::vector<int> orphans;
+        for (size_t r = 0; r < roots_.size(); ++r) {
+            stack.push_back(std::make_pair(roots_[r].get(), size_t(0)));
+            while (!stack.empty()) {
+                WellsGroupInterface* current = stack.back().first;
+                const size_t next_child = stack.back().second;
+                size_t num_children = 0;
+                if (!current->isLeafNode()) {
+                    const auto& children = static_cast<WellsGroup*>(current)->children();
+                    num_children = children.size();
+                    if (next_child < num_children) {
+                        ++stack.back().second;
+                        stack.push_back(std::make_pair(children[next_child].get(), size_t(0)));
+                        continue;
+                    }
+                }
+                stack.pop_back();
+                const int index = flat_nodes_.size();
+                flat_nodes_.push_back(current);
+                flat_parent_.push_back(-1);
+                for (size_t c = 0; c < num_children; ++c) {
+                    flat_parent_[orphans.back()] = index;
+                    orphans.pop_back();
+                }
+                orphans.push_back(index);
+            }
+            orphans.clear();
+        }
+    }
 }
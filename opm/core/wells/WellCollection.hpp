@@ -21,6 +21,8 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <opm/core/wells/WellsGroup.hpp>
 #include <opm/core/grid.h>
@@ -29,12 +31,15 @@
 #include <opm/parser/eclipse/EclipseState/Schedule/Well.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/Group.hpp>
 
+struct WellControlsTable;
+
 namespace Opm
 {
 
     class WellCollection
     {
     public:
+        WellCollection();
 
         void addField(GroupConstPtr fieldGroup, size_t timeStep, const PhaseUsage& phaseUsage);
 
@@ -79,6 +84,30 @@ namespace Opm
                            const std::vector<double>& well_reservoirrates_phase,
                            const std::vector<double>& well_surfacerates_phase);
 
+        /// Like conditionsMet(), but checks all wells in one sweep and
+        /// applies the change of every well whose conditions are
+        /// violated, rather than only the first change. Since wells are
+        /// controlled independently, this avoids one pressure solve per
+        /// violating well. Group conditions are checked, and at most one
+        /// group change applied, only if all wells met their conditions,
+        /// because the summed group rates are not valid after a well has
+        /// changed its control. The well limits are checked on a packed
+        /// copy of all well controls, see well_controls_table_check_limits().
+        /// \param[in]    well_bhp  A vector containing the bhp for each well. Is assumed
+        ///                         to be ordered the same way as the related Wells-struct.
+        /// \param[in]    well_reservoirrates_phase
+        ///                         A vector containing reservoir rates by phase for each well.
+        ///                         Is assumed to be ordered the same way as the related Wells-struct,
+        ///                         with all phase rates of a single well adjacent in the array.
+        /// \param[in]    well_surfacerates_phase
+        ///                         A vector containing surface rates by phase for each well.
+        ///                         Is assumed to be ordered the same way as the related Wells-struct,
+        ///                         with all phase rates of a single well adjacent in the array.
+        /// \return The number of changes applied, zero if all conditions are met.
+        int applyViolatedControls(const std::vector<double>& well_bhp,
+                                  const std::vector<double>& well_reservoirrates_phase,
+                                  const std::vector<double>& well_surfacerates_phase);
+
         /// Adds the well pointer to each leaf node (does not take ownership).
         void setWellsPointer(Wells* wells);
 
@@ -111,12 +140,47 @@ namespace Opm
                                               const std::vector<double>& well_surfacerates_phase);
 
     private:
+        /// Adds the node and all nodes below it to the name lookup.
+        void indexNodes(WellsGroupInterface* node);
+
+        /// Builds the flattened tree if the tree has changed.
+        void flattenTree();
+
+        /// Switches the control of every well violating a limit.
+        /// \return The number of wells switched.
+        int applyViolatedWellLimits(const std::vector<double>& well_bhp,
+                                    const std::vector<double>& well_reservoirrates_phase,
+                                    const std::vector<double>& well_surfacerates_phase);
+
         // To account for the possibility of a forest
         std::vector<std::shared_ptr<WellsGroupInterface> > roots_;
 
         // This will be used to traverse the bottom nodes.
         std::vector<WellNode*> leaf_nodes_;
 
+        // All nodes, by name, for findNode(). Nodes must be added
+        // through the collection to be found.
+        std::unordered_map<std::string, WellsGroupInterface*> node_by_name_;
+
+        // The tree flattened in post-order, i.e., each node comes after
+        // all nodes below it and the children of a group are in order,
+        // with the index of the parent of each node (-1 for roots).
+        // Empty when it must be rebuilt.
+        std::vector<WellsGroupInterface*> flat_nodes_;
+        std::vector<int> flat_parent_;
+
+        // Summed phase rates of each node, for conditionsMet() and
+        // applyViolatedControls().
+        std::vector<WellPhasesSummed> flat_phases_summed_;
+
+        // Packed controls of all wells and work space for
+        // applyViolatedWellLimits(), reused between calls.
+        Wells* wells_;
+        std::shared_ptr<WellControlsTable> ctrls_table_;
+        std::vector<int> is_producer_;
+        std::vector<int> skip_ctrl_;
+        std::vector<int> switch_wells_;
+        std::vector<int> switch_ctrls_;
 
     };
 
@@ -0,0 +1,93 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_WELLINDEXCACHE_HEADER_INCLUDED
+#define OPM_WELLINDEXCACHE_HEADER_INCLUDED
+
+#include <opm/parser/eclipse/EclipseState/Schedule/ScheduleEnums.hpp>
+
+#include <map>
+#include <tuple>
+
+namespace Opm
+{
+
+    /// Peaceman well indices of completions, kept between
+    /// constructions of WellsManager.
+    ///
+    /// The well index of a completion depends only on its cell,
+    /// direction, radius and skin factor once the grid, permeability
+    /// and net-to-gross are given. A simulator that rebuilds its wells
+    /// at every report step may therefore keep one cache for the whole
+    /// run and pass it to each WellsManager, so that only completions
+    /// not seen before need their cell geometry and well index
+    /// computed. The cache must be cleared if the grid or the rock
+    /// properties change.
+    class WellIndexCache
+    {
+    public:
+        WellIndexCache() {}
+
+        /// Look up the well index of a completion.
+        /// \param[out] well_index  Cached well index, if found.
+        /// \return True if the completion is in the cache.
+        bool find(const int cell,
+                  const WellCompletion::DirectionEnum direction,
+                  const double radius,
+                  const double skin_factor,
+                  double& well_index) const
+        {
+            const auto it = well_index_.find(Key(cell, static_cast<int>(direction), radius, skin_factor));
+            if (it == well_index_.end()) {
+                return false;
+            }
+            well_index = it->second;
+            return true;
+        }
+
+        /// Store the well index of a completion.
+        void insert(const int cell,
+                    const WellCompletion::DirectionEnum direction,
+                    const double radius,
+                    const double skin_factor,
+                    const double well_index)
+        {
+            well_index_[Key(cell, static_cast<int>(direction), radius, skin_factor)] = well_index;
+        }
+
+        /// Number of cached completions.
+        int size() const
+        {
+            return well_index_.size();
+        }
+
+        /// Forget all cached well indices.
+        void clear()
+        {
+            well_index_.clear();
+        }
+
+    private:
+        typedef std::tuple<int, int, double, double> Key;
+        std::map<Key, double> well_index_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_WELLINDEXCACHE_HEADER_INCLUDED
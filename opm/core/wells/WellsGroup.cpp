@@ -328,7 +328,20 @@ namespace Opm
             child_phases_summed += current_child_phases_summed;
         }
 
+        if (!groupConditionsMet(well_reservoirrates_phase,
+                                well_surfacerates_phase,
+                                child_phases_summed)) {
+            return false;
+        }
+
+        summed_phases += child_phases_summed;
+        return true;
+    }
 
+    bool WellsGroup::groupConditionsMet(const std::vector<double>& well_reservoirrates_phase,
+                                        const std::vector<double>& well_surfacerates_phase,
+                                        const WellPhasesSummed& child_phases_summed)
+    {
         // Injection constraints.
         InjectionSpecification::ControlMode injection_modes[] = {InjectionSpecification::RATE,
                                                                  InjectionSpecification::RESV};
@@ -406,7 +419,6 @@ namespace Opm
             }
         }
 
-        summed_phases += child_phases_summed;
         return true;
     }
 
@@ -415,6 +427,11 @@ namespace Opm
         children_.push_back(child);
     }
 
+    const std::vector<std::shared_ptr<WellsGroupInterface> >& WellsGroup::children() const
+    {
+        return children_;
+    }
+
 
     int WellsGroup::numberOfLeafNodes() {
         // This could probably use some caching, but seeing as how the number of
@@ -647,19 +664,10 @@ namespace Opm
                                  const std::vector<double>& well_surfacerates_phase,
                                  WellPhasesSummed& summed_phases)
     {
-        // Report on our rates.
-        const int np = phaseUsage().num_phases;
-        for (int phase = 0; phase < np; ++phase) {
-            if (wells_->type[self_index_] == INJECTOR) {
-                summed_phases.res_inj_rates[phase] = well_reservoirrates_phase[np*self_index_ + phase];
-                summed_phases.surf_inj_rates[phase] = well_surfacerates_phase[np*self_index_ + phase];
-            } else {
-                summed_phases.res_prod_rates[phase] = well_reservoirrates_phase[np*self_index_ + phase];
-                summed_phases.surf_prod_rates[phase] = well_surfacerates_phase[np*self_index_ + phase];
-            }
-        }
+        reportRates(well_reservoirrates_phase, well_surfacerates_phase, summed_phases);
 
         // Check constraints.
+        const int np = phaseUsage().num_phases;
         bool is_producer = (wells_->type[self_index_] == PRODUCER);
         const WellControls * ctrls = wells_->ctrls[self_index_];
         for (int ctrl_index = 0; ctrl_index < well_controls_get_num(ctrls); ++ctrl_index) {
@@ -729,6 +737,27 @@ namespace Opm
         return true;
     }
 
+    void WellNode::reportRates(const std::vector<double>& well_reservoirrates_phase,
+                               const std::vector<double>& well_surfacerates_phase,
+                               WellPhasesSummed& summed_phases) const
+    {
+        const int np = phaseUsage().num_phases;
+        for (int phase = 0; phase < np; ++phase) {
+            if (wells_->type[self_index_] == INJECTOR) {
+                summed_phases.res_inj_rates[phase] = well_reservoirrates_phase[np*self_index_ + phase];
+                summed_phases.surf_inj_rates[phase] = well_surfacerates_phase[np*self_index_ + phase];
+            } else {
+                summed_phases.res_prod_rates[phase] = well_reservoirrates_phase[np*self_index_ + phase];
+                summed_phases.surf_prod_rates[phase] = well_surfacerates_phase[np*self_index_ + phase];
+            }
+        }
+    }
+
+    int WellNode::groupControlIndex() const
+    {
+        return group_control_index_;
+    }
+
     WellsGroupInterface* WellNode::findGroup(const std::string& name_of_node)
     {
         if (name() == name_of_node) {
@@ -237,11 +237,33 @@ namespace Opm
 
         void addChild(std::shared_ptr<WellsGroupInterface> child);
 
+        /// The children of the group, in the order they were added.
+        const std::vector<std::shared_ptr<WellsGroupInterface> >& children() const;
+
         virtual bool conditionsMet(const std::vector<double>& well_bhp,
                                    const std::vector<double>& well_reservoirrates_phase,
                                    const std::vector<double>& well_surfacerates_phase,
                                    WellPhasesSummed& summed_phases);
 
+        /// Checks the constraints of the group itself, given the summed
+        /// rates of its children, and applies group controls or shuts
+        /// wells as conditionsMet() does. The children's own conditions
+        /// are not checked.
+        /// \param[in]    well_reservoirrates_phase
+        ///                         A vector containing reservoir rates by phase for each well.
+        ///                         Is assumed to be ordered the same way as the related Wells-struct,
+        ///                         with all phase rates of a single well adjacent in the array.
+        /// \param[in]    well_surfacerates_phase
+        ///                         A vector containing surface rates by phase for each well.
+        ///                         Is assumed to be ordered the same way as the related Wells-struct,
+        ///                         with all phase rates of a single well adjacent in the array.
+        /// \param[in]    child_phases_summed
+        ///                         The summed phase rates of all children.
+        /// \return true if no violations were found, false otherwise (false also implies a change).
+        bool groupConditionsMet(const std::vector<double>& well_reservoirrates_phase,
+                                const std::vector<double>& well_surfacerates_phase,
+                                const WellPhasesSummed& child_phases_summed);
+
         virtual int numberOfLeafNodes();
         virtual std::pair<WellNode*, double> getWorstOffending(const std::vector<double>& well_reservoirrates_phase,
                                                                const std::vector<double>& well_surfacerates_phase,
@@ -325,6 +347,15 @@ namespace Opm
 
         virtual bool isLeafNode() const;
 
+        /// Reports the rates of the well, as conditionsMet() does,
+        /// without checking any constraints.
+        void reportRates(const std::vector<double>& well_reservoirrates_phase,
+                         const std::vector<double>& well_surfacerates_phase,
+                         WellPhasesSummed& summed_phases) const;
+
+        /// Returns the index of the control set by group control, or -1.
+        int groupControlIndex() const;
+
         void setWellsPointer(Wells* wells, int self_index);
 
         virtual int numberOfLeafNodes();
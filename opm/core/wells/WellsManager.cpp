@@ -27,6 +27,8 @@
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/core/wells/WellCollection.hpp>
 #include <opm/core/props/phaseUsageFromDeck.hpp>
+#include <opm/core/utility/MemoryReport.hpp>
+#include <opm/core/utility/TimingTree.hpp>
 
 #include <opm/parser/eclipse/EclipseState/Schedule/ScheduleEnums.hpp>
 
@@ -313,13 +315,13 @@ namespace Opm
 
     /// Default constructor.
     WellsManager::WellsManager()
-        : w_(0), is_parallel_run_(false)
+        : w_(0), is_parallel_run_(false), well_index_cache_(0)
     {
     }
 
     /// Construct from existing wells object.
     WellsManager::WellsManager(struct Wells* W)
-        : w_(clone_wells(W)), is_parallel_run_(false)
+        : w_(clone_wells(W)), is_parallel_run_(false), well_index_cache_(0)
     {
     }
 
@@ -327,8 +329,9 @@ namespace Opm
     WellsManager::WellsManager(const Opm::EclipseStateConstPtr eclipseState,
                                const size_t timeStep,
                                const UnstructuredGrid& grid,
-                               const double* permeability)
-        : w_(0), is_parallel_run_(false)
+                               const double* permeability,
+                               WellIndexCache* well_index_cache)
+        : w_(0), is_parallel_run_(false), well_index_cache_(well_index_cache)
     {
         init(eclipseState, timeStep, UgGridHelpers::numCells(grid),
              UgGridHelpers::globalCell(grid), UgGridHelpers::cartDims(grid), 
@@ -366,6 +369,13 @@ namespace Opm
         return well_collection_;
     }
 
+    void WellsManager::reportMemory(MemoryReport& report) const
+    {
+        if (w_ != 0) {
+            report.add("wells", wells_memory(w_));
+        }
+    }
+
     bool WellsManager::conditionsMet(const std::vector<double>& well_bhp,
                                      const std::vector<double>& well_reservoirrates_phase,
                                      const std::vector<double>& well_surfacerates_phase)
@@ -375,6 +385,16 @@ namespace Opm
                                               well_surfacerates_phase);
     }
 
+    int WellsManager::applyViolatedControls(const std::vector<double>& well_bhp,
+                                            const std::vector<double>& well_reservoirrates_phase,
+                                            const std::vector<double>& well_surfacerates_phase)
+    {
+        OPM_TIMED_SCOPE("well controls");
+        return well_collection_.applyViolatedControls(well_bhp,
+                                                      well_reservoirrates_phase,
+                                                      well_surfacerates_phase);
+    }
+
     /// Applies explicit reinjection controls. This must be called at each timestep to be correct.
     /// \param[in]    well_reservoirrates_phase
     ///                         A vector containing reservoir rates by phase for each well.
@@ -391,23 +411,6 @@ namespace Opm
         well_collection_.applyExplicitReinjectionControls(well_reservoirrates_phase, well_surfacerates_phase);
     }
 
-    void WellsManager::setupCompressedToCartesian(const int* global_cell, int number_of_cells,
-                                                  std::map<int,int>& cartesian_to_compressed ) {
-        // global_cell is a map from compressed cells to Cartesian grid cells.
-        // We must make the inverse lookup.
-
-        if (global_cell) {
-            for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(global_cell[i], i));
-            }
-        }
-        else {
-            for (int i = 0; i < number_of_cells; ++i) {
-                cartesian_to_compressed.insert(std::make_pair(i, i));
-            }
-        }
-
-    }
 
 
 
@@ -24,6 +24,7 @@
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 
 #include <opm/core/wells/WellCollection.hpp>
+#include <opm/core/wells/WellIndexCache.hpp>
 #include <opm/core/wells/WellsGroup.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/GroupTree.hpp>
 
@@ -37,6 +38,7 @@ namespace Opm
 {
 
     class Schedule;
+    class MemoryReport;
 
     struct WellData
     {
@@ -76,6 +78,8 @@ namespace Opm
         /// The permeability argument may be zero if the input contain
         /// well productivity indices, otherwise it must be given in
         /// order to approximate these by the Peaceman formula.
+        /// If well_index_cache is given, Peaceman well indices are
+        /// looked up in and added to it, see WellIndexCache.
         template<class F2C, class FC>
         WellsManager(const Opm::EclipseStateConstPtr eclipseState,
                      const size_t timeStep,
@@ -86,12 +90,14 @@ namespace Opm
                      const F2C& f2c,
                      FC begin_face_centroids,
                      const double* permeability,
-                     bool is_parallel_run=false);
+                     bool is_parallel_run=false,
+                     WellIndexCache* well_index_cache=0);
 
         WellsManager(const Opm::EclipseStateConstPtr eclipseState,
                      const size_t timeStep,
                      const UnstructuredGrid& grid,
-                     const double* permeability);
+                     const double* permeability,
+                     WellIndexCache* well_index_cache=0);
         /// Destructor.
         ~WellsManager();
 
@@ -106,6 +112,10 @@ namespace Opm
         /// Access the well group hierarchy.
         const WellCollection& wellCollection() const;
 
+        /// Add the bytes of the managed Wells, controls included, to
+        /// the child "wells" of the report.
+        void reportMemory(MemoryReport& report) const;
+
         /// Checks if each condition is met, applies well controls where needed
         /// (that is, it either changes the active control of violating wells, or shuts
         /// down wells). Only one change is applied per invocation. Typical use will be
@@ -130,6 +140,29 @@ namespace Opm
                            const std::vector<double>& well_reservoirrates_phase,
                            const std::vector<double>& well_surfacerates_phase);
 
+        /// Like conditionsMet(), but checks all wells in one sweep and
+        /// applies the change of every well whose conditions are
+        /// violated, rather than only the first change. Since wells are
+        /// controlled independently, this avoids one pressure solve per
+        /// violating well. Group conditions are checked, and at most one
+        /// group change applied, only if all wells met their conditions,
+        /// because the summed group rates are not valid after a well has
+        /// changed its control.
+        /// \param[in]    well_bhp  A vector containing the bhp for each well. Is assumed
+        ///                         to be ordered the same way as the related Wells-struct.
+        /// \param[in]    well_reservoirrates_phase
+        ///                         A vector containing reservoir rates by phase for each well.
+        ///                         Is assumed to be ordered the same way as the related Wells-struct,
+        ///                         with all phase rates of a single well adjacent in the array.
+        /// \param[in]    well_surfacerates_phase
+        ///                         A vector containing surface rates by phase for each well.
+        ///                         Is assumed to be ordered the same way as the related Wells-struct,
+        ///                         with all phase rates of a single well adjacent in the array.
+        /// \return The number of changes applied, zero if all conditions are met.
+        int applyViolatedControls(const std::vector<double>& well_bhp,
+                                  const std::vector<double>& well_reservoirrates_phase,
+                                  const std::vector<double>& well_surfacerates_phase);
+
         /// Applies explicit reinjection controls. This must be called at each timestep to be correct.
         /// \param[in]    well_reservoirrates_phase
         ///                         A vector containing reservoir rates by phase for each well.
@@ -157,7 +190,6 @@ namespace Opm
         // Disable copying and assignment.
         WellsManager(const WellsManager& other);
         WellsManager& operator=(const WellsManager& other);
-        static void setupCompressedToCartesian(const int* global_cell, int number_of_cells, std::map<int,int>& cartesian_to_compressed );
         void setupWellControls(std::vector<WellConstPtr>& wells, size_t timeStep,
                                std::vector<std::string>& well_names, const PhaseUsage& phaseUsage,
                                const std::vector<int>& wells_on_proc);
@@ -173,7 +205,7 @@ namespace Opm
                                    std::vector<WellData>& well_data,
                                    std::map<std::string, int> & well_names_to_index,
                                    const PhaseUsage& phaseUsage,
-                                   const std::map<int,int>& cartesian_to_compressed,
+                                   const std::vector<int>& cartesian_to_compressed,
                                    const double* permeability,
                                    const NTG& ntg,
                                    std::vector<int>& wells_on_proc);
@@ -187,6 +219,8 @@ namespace Opm
         WellCollection well_collection_;
         // Whether this is a parallel simulation
         bool is_parallel_run_;
+        // Well indices kept between constructions, may be null.
+        WellIndexCache* well_index_cache_;
     };
 
 } // namespace Opm
@@ -116,7 +116,7 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
                                         std::vector<WellData>& well_data,
                                         std::map<std::string, int>& well_names_to_index,
                                         const PhaseUsage& phaseUsage,
-                                        const std::map<int,int>& cartesian_to_compressed,
+                                        const std::vector<int>& cartesian_to_compressed,
                                         const double* permeability,
                                         const NTG& ntg,
                                         std::vector<int>& wells_on_proc)
@@ -157,8 +157,10 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
 
                     const int* cpgdim = cart_dims;
                     int cart_grid_indx = i + cpgdim[0]*(j + cpgdim[1]*k);
-                    std::map<int, int>::const_iterator cgit = cartesian_to_compressed.find(cart_grid_indx);
-                    if (cgit == cartesian_to_compressed.end()) {
+                    const bool in_grid = cart_grid_indx >= 0
+                        && cart_grid_indx < static_cast<int>(cartesian_to_compressed.size());
+                    const int cell = in_grid ? cartesian_to_compressed[cart_grid_indx] : -1;
+                    if (cell < 0) {
                         if ( is_parallel_run_ )
                         {
                             completion_on_proc[c]=0;
@@ -173,7 +175,6 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
                     }
                     else
                     {
-                        int cell = cgit->second;
                         PerfData pd;
                         pd.cell = cell;
                         {
@@ -188,20 +189,27 @@ void WellsManager::createWellsFromSpecs(std::vector<WellConstPtr>& wells, size_t
                                     OPM_MESSAGE("**** Warning: Well bore internal radius set to " << radius);
                                 }
 
-                                std::array<double, 3> cubical =
-                                    WellsManagerDetail::getCubeDim<3>(c2f, begin_face_centroids, cell);
-
-                                // overwrite dz values calculated in getCubeDim.
-                                if (dz.size() > 0) {
-                                    cubical[2] = dz[cell];
+                                const double skin_factor = completion->getSkinFactor();
+                                const WellCompletion::DirectionEnum direction = completion->getDirection();
+                                if (!well_index_cache_
+                                    || !well_index_cache_->find(cell, direction, radius, skin_factor, pd.well_index)) {
+                                    std::array<double, 3> cubical =
+                                        WellsManagerDetail::getCubeDim<3>(c2f, begin_face_centroids, cell);
+
+                                    // overwrite dz values calculated in getCubeDim.
+                                    if (dz.size() > 0) {
+                                        cubical[2] = dz[cell];
+                                    }
+
+                                    const double* cell_perm = &permeability[dimensions*dimensions*cell];
+                                    pd.well_index =
+                                        WellsManagerDetail::computeWellIndex(radius, cubical, cell_perm,
+                                                                             skin_factor, direction,
+                                                                             ntg[cell]);
+                                    if (well_index_cache_) {
+                                        well_index_cache_->insert(cell, direction, radius, skin_factor, pd.well_index);
+                                    }
                                 }
-
-                                const double* cell_perm = &permeability[dimensions*dimensions*cell];
-                                pd.well_index =
-                                    WellsManagerDetail::computeWellIndex(radius, cubical, cell_perm,
-                                                                         completion->getSkinFactor(),
-                                                                         completion->getDirection(),
-                                                                         ntg[cell]);
                             }
                             pd.well_index *= wellPi;
                         }
@@ -326,8 +334,9 @@ WellsManager(const Opm::EclipseStateConstPtr eclipseState,
              const C2F&                      cell_to_faces,
              FC                              begin_face_centroids,
              const double*                   permeability,
-             bool                            is_parallel_run)
-    : w_(0), is_parallel_run_(is_parallel_run)
+             bool                            is_parallel_run,
+             WellIndexCache*                 well_index_cache)
+    : w_(0), is_parallel_run_(is_parallel_run), well_index_cache_(well_index_cache)
 {
     init(eclipseState, timeStep, number_of_cells, global_cell,
          cart_dims, dimensions,
@@ -359,9 +368,9 @@ WellsManager::init(const Opm::EclipseStateConstPtr eclipseState,
         return;
     }
 
-    std::map<int,int> cartesian_to_compressed;
-    setupCompressedToCartesian(global_cell, number_of_cells,
-                               cartesian_to_compressed);
+    const std::vector<int> cartesian_to_compressed =
+        cartesianToCompressed(number_of_cells, global_cell,
+                              cart_dims[0]*cart_dims[1]*cart_dims[2]);
 
     // Obtain phase usage data.
     PhaseUsage pu = phaseUsageFromDeck(eclipseState);
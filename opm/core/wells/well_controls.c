@@ -34,10 +34,15 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L  /* posix_memalign() */
+#endif
+
 #include "config.h"
 
 #include <opm/core/well_controls.h>
 #include <assert.h>
+#include <math.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -125,6 +130,8 @@ well_controls_destroy(struct WellControls *ctrl)
 {
     if (ctrl != NULL) {
         free             (ctrl->distr);
+        free             (ctrl->vfp);
+        free             (ctrl->alq);
         free             (ctrl->target);
         free             (ctrl->type);
     }
@@ -133,6 +140,22 @@ well_controls_destroy(struct WellControls *ctrl)
 }
 
 
+/* ---------------------------------------------------------------------- */
+size_t
+well_controls_memory(const struct WellControls *ctrl)
+/* ---------------------------------------------------------------------- */
+{
+    size_t cpty;
+
+    cpty = ctrl->cpty;
+
+    return sizeof *ctrl
+        + cpty * (sizeof *ctrl->type + sizeof *ctrl->target +
+                  sizeof *ctrl->alq  + sizeof *ctrl->vfp)
+        + cpty * ctrl->number_of_phases * sizeof *ctrl->distr;
+}
+
+
 /* ---------------------------------------------------------------------- */
 struct WellControls *
 well_controls_create(void)
@@ -203,13 +226,8 @@ struct WellControls *
 well_controls_clone(const struct WellControls *ctrl)
 /* ---------------------------------------------------------------------- */
 {
-    int                   ok, i, n;
-    double                target;
-    double                alq;
-    int                   vfp;
-    const double         *distr;
+    int                   ok, n, np;
     struct WellControls  *new;
-    enum WellControlType  type;
 
     new = well_controls_create();
 
@@ -218,40 +236,27 @@ well_controls_clone(const struct WellControls *ctrl)
         well_controls_assert_number_of_phases(new, ctrl->number_of_phases);
 
         n  = well_controls_get_num(ctrl);
+        np = ctrl->number_of_phases;
         ok = well_controls_reserve(n, new);
 
         if (! ok) {
             well_controls_destroy(new);
             new = NULL;
         }
-        else {
-            for (i = 0; ok && (i < n); i++) {
-                type   = well_controls_iget_type  (ctrl, i);
-                distr  = well_controls_iget_distr (ctrl, i);
-                target = well_controls_iget_target(ctrl, i);
-                alq    = well_controls_iget_alq   (ctrl, i);
-                vfp    = well_controls_iget_vfp   (ctrl, i);
-
-                ok = well_controls_add_new(type, target, alq, vfp, distr, new);
-            }
-
-            if (i < n) {
-                assert (!ok);
-                well_controls_destroy(new);
+        else if (n > 0) {
+            /* Copy all controls at once rather than appending them
+             * one by one. */
+            memcpy(new->type  , ctrl->type  , n * 1  * sizeof *new->type  );
+            memcpy(new->target, ctrl->target, n * 1  * sizeof *new->target);
+            memcpy(new->alq   , ctrl->alq   , n * 1  * sizeof *new->alq   );
+            memcpy(new->vfp   , ctrl->vfp   , n * 1  * sizeof *new->vfp   );
+            memcpy(new->distr , ctrl->distr , n * np * sizeof *new->distr );
+        }
 
-                new = NULL;
-            }
-            else {
-                i = well_controls_get_current(ctrl);
-                well_controls_set_current(new, i);
-
-                if (well_controls_well_is_open(ctrl)) {
-                    well_controls_open_well(new);
-                }
-                else {
-                    well_controls_stop_well(new);
-                }
-            }
+        if (new != NULL) {
+            new->num          = n;
+            new->current      = ctrl->current;
+            new->well_is_open = ctrl->well_is_open;
         }
     }
 
@@ -447,3 +452,238 @@ well_controls_equal(const struct WellControls *ctrls1, const struct WellControls
     return are_equal;
 }
 
+
+
+/* ====================================================================== */
+/* Packed controls of all wells                                            */
+/* ====================================================================== */
+
+#define WELL_CONTROLS_TABLE_ALIGN 64
+
+/* Cache line-padded size of an array of n elements of given size. */
+/* ---------------------------------------------------------------------- */
+static size_t
+table_array_size(size_t n, size_t size)
+/* ---------------------------------------------------------------------- */
+{
+    size_t nbytes;
+
+    nbytes = n * size;
+
+    return WELL_CONTROLS_TABLE_ALIGN *
+        ((nbytes + WELL_CONTROLS_TABLE_ALIGN - 1) / WELL_CONTROLS_TABLE_ALIGN);
+}
+
+
+/* Allocate aligned storage for the given numbers of wells, controls
+ * and phases, and point the arrays into it.  The table is unchanged
+ * if allocation fails. */
+/* ---------------------------------------------------------------------- */
+static int
+well_controls_table_reserve(int nwells, int nctrls, int nphases,
+                            struct WellControlsTable *tab)
+/* ---------------------------------------------------------------------- */
+{
+    size_t  sz_pos, sz_well, sz_type, sz_ctrl, sz_target, sz_distr;
+    char   *p;
+    void   *data;
+
+    sz_pos    = table_array_size(nwells + 1       , sizeof *tab->ctrl_pos);
+    sz_well   = table_array_size(nwells           , sizeof *tab->current );
+    sz_type   = table_array_size(nctrls           , sizeof *tab->type    );
+    sz_ctrl   = table_array_size(nctrls           , sizeof *tab->ctrl_well);
+    sz_target = table_array_size(nctrls           , sizeof *tab->target  );
+    sz_distr  = table_array_size(nctrls * nphases , sizeof *tab->distr   );
+
+    if (posix_memalign(&data, WELL_CONTROLS_TABLE_ALIGN,
+                       sz_pos + 2*sz_well + sz_type + 2*sz_ctrl +
+                       sz_target + sz_distr) != 0) {
+        return 0;
+    }
+
+    free(tab->data);
+    tab->data = data;
+
+    /* Doubles first, then the integers. */
+    p = data;
+    tab->target      = (double *) p; p += sz_target;
+    tab->distr       = (double *) p; p += sz_distr;
+    tab->type        = (enum WellControlType *) p; p += sz_type;
+    tab->ctrl_well   = (int *) p; p += sz_ctrl;
+    tab->violated    = (int *) p; p += sz_ctrl;
+    tab->ctrl_pos    = (int *) p; p += sz_pos;
+    tab->current     = (int *) p; p += sz_well;
+    tab->is_producer = (int *) p;
+
+    tab->wells_cpty  = nwells;
+    tab->ctrls_cpty  = nctrls;
+    tab->phases_cpty = nphases;
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+struct WellControlsTable *
+well_controls_table_create(int nwells, int nphases,
+                           struct WellControls * const *ctrls,
+                           const int *is_producer)
+/* ---------------------------------------------------------------------- */
+{
+    struct WellControlsTable *tab;
+
+    tab = malloc(1 * sizeof *tab);
+
+    if (tab != NULL) {
+        memset(tab, 0, sizeof *tab);
+
+        if (!well_controls_table_update(nwells, nphases, ctrls,
+                                        is_producer, tab)) {
+            well_controls_table_destroy(tab);
+            tab = NULL;
+        }
+    }
+
+    return tab;
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+well_controls_table_update(int nwells, int nphases,
+                           struct WellControls * const *ctrls,
+                           const int *is_producer,
+                           struct WellControlsTable *tab)
+/* ---------------------------------------------------------------------- */
+{
+    int w, c, k, n, nctrls;
+    const struct WellControls *ctrl;
+
+    nctrls = 0;
+    for (w = 0; w < nwells; w++) {
+        nctrls += ctrls[w]->num;
+    }
+
+    if ((tab->data == NULL) || (nwells > tab->wells_cpty) ||
+        (nctrls > tab->ctrls_cpty) || (nctrls * nphases > tab->ctrls_cpty * tab->phases_cpty)) {
+        if (!well_controls_table_reserve(nwells, nctrls, nphases, tab)) {
+            return 0;
+        }
+    }
+
+    tab->number_of_wells  = nwells;
+    tab->number_of_phases = nphases;
+
+    k = 0;
+    for (w = 0; w < nwells; w++) {
+        ctrl = ctrls[w];
+        n    = ctrl->num;
+
+        tab->ctrl_pos   [w] = k;
+        tab->current    [w] = ctrl->current;
+        tab->is_producer[w] = is_producer[w] != 0;
+
+        memcpy(tab->type   + k, ctrl->type  , n * sizeof *tab->type  );
+        memcpy(tab->target + k, ctrl->target, n * sizeof *tab->target);
+
+        if (ctrl->number_of_phases == nphases) {
+            memcpy(tab->distr + k*nphases, ctrl->distr,
+                   n * nphases * sizeof *tab->distr);
+        } else {
+            /* No distributions given for this well. */
+            memset(tab->distr + k*nphases, 0,
+                   n * nphases * sizeof *tab->distr);
+        }
+
+        for (c = 0; c < n; c++) {
+            tab->ctrl_well[k + c] = w;
+        }
+
+        k += n;
+    }
+    tab->ctrl_pos[nwells] = k;
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+void
+well_controls_table_destroy(struct WellControlsTable *tab)
+/* ---------------------------------------------------------------------- */
+{
+    if (tab != NULL) {
+        free(tab->data);
+    }
+
+    free(tab);
+}
+
+
+/* ---------------------------------------------------------------------- */
+int
+well_controls_table_check_limits(struct WellControlsTable *tab,
+                                 const int                *skip,
+                                 const double             *bhp,
+                                 const double             *resv_rates,
+                                 const double             *surf_rates,
+                                 int                      *switch_wells,
+                                 int                      *switch_ctrls)
+/* ---------------------------------------------------------------------- */
+{
+    int     w, k, p, np, nctrls, nswitch, is_bhp_viol, is_resv_viol, is_surf_viol;
+    double  target, resv, surf, rmax;
+    const double *distr;
+
+    np     = tab->number_of_phases;
+    nctrls = tab->ctrl_pos[tab->number_of_wells];
+
+    /* Evaluate every control of every well in one flat, branch-free
+     * sweep over the packed arrays. */
+    for (k = 0; k < nctrls; k++) {
+        w      = tab->ctrl_well[k];
+        target = tab->target[k];
+        distr  = tab->distr + k*np;
+
+        resv = surf = 0.0;
+        for (p = 0; p < np; p++) {
+            resv += distr[p] * resv_rates[w*np + p];
+            surf += distr[p] * surf_rates[w*np + p];
+        }
+
+        is_bhp_viol  = tab->is_producer[w] ? (target > bhp[w]) : (target < bhp[w]);
+
+        rmax         = (fabs(resv) > fabs(target)) ? fabs(resv) : fabs(target);
+        is_resv_viol = fabs(resv) - fabs(target) > rmax*1e-6;
+        is_surf_viol = fabs(surf) > fabs(target);
+
+        tab->violated[k] =
+            (tab->type[k] == BHP           ) ? is_bhp_viol  :
+            (tab->type[k] == RESERVOIR_RATE) ? is_resv_viol :
+            (tab->type[k] == SURFACE_RATE  ) ? is_surf_viol : -1;
+    }
+
+    /* First violated control of each well, in control order. */
+    nswitch = 0;
+    for (w = 0; w < tab->number_of_wells; w++) {
+        for (k = tab->ctrl_pos[w]; k < tab->ctrl_pos[w + 1]; k++) {
+            if ((k - tab->ctrl_pos[w] == tab->current[w]) ||
+                ((skip != NULL) && (k - tab->ctrl_pos[w] == skip[w]))) {
+                continue;
+            }
+
+            if (tab->violated[k] < 0) {
+                return -1;
+            }
+
+            if (tab->violated[k]) {
+                switch_wells[nswitch] = w;
+                switch_ctrls[nswitch] = k - tab->ctrl_pos[w];
+                nswitch += 1;
+                break;
+            }
+        }
+    }
+
+    return nswitch;
+}
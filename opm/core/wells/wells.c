@@ -34,6 +34,7 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "config.h"
+#include <opm/core/grid.h>      /* grid_hash_update() */
 #include <opm/core/wells.h>
 #include <opm/core/well_controls.h>
 
@@ -48,6 +49,9 @@
 struct WellMgmt {
     int well_cpty;
     int perf_cpty;
+
+    /* Running hash of the data of all wells entered by add_well(). */
+    uint64_t hash;
 };
 
 
@@ -68,6 +72,7 @@ create_well_mgmt(void)
     if (m != NULL) {
         m->well_cpty = 0;
         m->perf_cpty = 0;
+        m->hash      = GRID_HASH_INIT;
     }
 
     return m;
@@ -259,8 +264,9 @@ struct Wells *
 create_wells(int nphases, int nwells, int nperf)
 /* ---------------------------------------------------------------------- */
 {
-    int           ok;
-    struct Wells *W;
+    int              ok;
+    struct Wells    *W;
+    struct WellMgmt *m;
 
     W = malloc(1 * sizeof *W);
 
@@ -286,6 +292,9 @@ create_wells(int nphases, int nwells, int nperf)
         if (ok) {
             W->well_connpos[0] = 0;
 
+            m = W->data;
+            m->hash = grid_hash_update(m->hash, &nphases, sizeof nphases);
+
             if ((nwells > 0) || (nperf > 0)) {
                 ok = wells_reserve(nwells, nperf, W);
             }
@@ -355,6 +364,36 @@ alloc_size(int n, int a, int cpty)
 }
 
 
+/* Fold the data of well 'w' into a running hash. */
+/* ---------------------------------------------------------------------- */
+static uint64_t
+hash_well(uint64_t h, int w, const struct Wells *W)
+/* ---------------------------------------------------------------------- */
+{
+    int    np, off, nperf;
+    size_t len;
+
+    np    = W->number_of_phases;
+    off   = W->well_connpos[w];
+    nperf = W->well_connpos[w + 1] - off;
+    len   = (W->name[w] != NULL) ? strlen(W->name[w]) + 1 : 0;
+
+    h = grid_hash_update(h, &W->type     [w], sizeof W->type     [w]);
+    h = grid_hash_update(h, &W->depth_ref[w], sizeof W->depth_ref[w]);
+    h = grid_hash_update(h, &W->allow_cf [w], sizeof W->allow_cf [w]);
+    h = grid_hash_update(h, W->comp_frac + np*w, np * sizeof *W->comp_frac);
+
+    h = grid_hash_update(h, &nperf, sizeof nperf);
+    h = grid_hash_update(h, W->well_cells + off, nperf * sizeof *W->well_cells);
+    h = grid_hash_update(h, W->WI         + off, nperf * sizeof *W->WI);
+
+    h = grid_hash_update(h, &len, sizeof len);
+    h = grid_hash_update(h, W->name[w], len);
+
+    return h;
+}
+
+
 /* ---------------------------------------------------------------------- */
 int
 add_well(enum WellType  type     ,
@@ -420,6 +459,8 @@ add_well(enum WellType  type     ,
 
         W->well_connpos[nw + 1]  = off + nperf;
         W->number_of_wells      += 1;
+
+        m->hash = hash_well(m->hash, nw, W);
     }
 
     return ok;
@@ -479,59 +520,125 @@ clear_well_controls(int well_index, struct Wells *W)
 
 
 
+/* ---------------------------------------------------------------------- */
+size_t
+wells_memory(const struct Wells *W)
+/* ---------------------------------------------------------------------- */
+{
+    int                    w, np;
+    size_t                 nbytes, nw, nperf;
+    const struct WellMgmt *m;
+
+    m     = W->data;
+    np    = W->number_of_phases;
+    nw    = m->well_cpty;
+    nperf = m->perf_cpty;
+
+    nbytes  = sizeof *W + sizeof *m;
+    nbytes += nw * (sizeof *W->type  + sizeof *W->depth_ref +
+                    sizeof *W->ctrls + sizeof *W->name      +
+                    sizeof *W->allow_cf);
+    nbytes += nw * np      * sizeof *W->comp_frac;
+    nbytes += (nw + 1)     * sizeof *W->well_connpos;
+    nbytes += nperf * (sizeof *W->well_cells + sizeof *W->WI);
+
+    for (w = 0; w < m->well_cpty; w++) {
+        if (W->ctrls[w] != NULL) {
+            nbytes += well_controls_memory(W->ctrls[w]);
+        }
+        if ((w < W->number_of_wells) && (W->name[w] != NULL)) {
+            nbytes += strlen(W->name[w]) + 1;
+        }
+    }
+
+    return nbytes;
+}
+
+
 /* ---------------------------------------------------------------------- */
 struct Wells *
 clone_wells(const struct Wells *W)
 /* ---------------------------------------------------------------------- */
 {
-    int                  np, nperf, ok, pos, w;
-    const int           *cells;
-    const double        *WI, *comp_frac;
+    int                  np, nw, nperf, ok, w;
 
-    struct WellControls *ctrl;
+    struct WellMgmt     *m;
     struct Wells        *newWells;
 
     if (W == NULL) {
         newWells = NULL;
     }
     else {
-        np  = W->number_of_phases;
-        newWells = create_wells(W->number_of_phases, W->number_of_wells,
-                                W->well_connpos[ W->number_of_wells ]);
+        np    = W->number_of_phases;
+        nw    = W->number_of_wells;
+        nperf = W->well_connpos[ nw ];
 
-        if (newWells != NULL) {
-            pos = W->well_connpos[ 0 ];
-            ok  = 1;
+        /* Allocate the arrays at their final size and copy them
+         * wholesale.  Unlike add_well() this does not create default
+         * control sets that are immediately replaced by the clones. */
+        newWells = create_wells(np, 0, 0);
 
-            for (w = 0; ok && (w < W->number_of_wells); w++) {
-                nperf = W->well_connpos[w + 1] - pos;
-                cells = W->well_cells + pos;
+        ok = newWells != NULL;
 
-                WI        = W->WI        != NULL ? W->WI        + pos  : NULL;
-                comp_frac = W->comp_frac != NULL ? W->comp_frac + w*np : NULL;
+        if (ok && (nw > 0)) {
+            ok = wells_allocate(nw, newWells);
+        }
 
-                ok = add_well(W->type[ w ], W->depth_ref[ w ], nperf,
-                              comp_frac, cells, WI, W->name[ w ], W->allow_cf[ w ],  newWells);
+        if (ok && (nperf > 0)) {
+            ok = perfs_allocate(nperf, newWells);
+        }
 
-                if (ok) {
-                    ok = (ctrl = well_controls_clone(W->ctrls[w])) != NULL;
-                }
+        if (ok) {
+            for (w = 0; w < nw; w++) {
+                newWells->ctrls[w] = NULL;
+                newWells->name [w] = NULL;
+            }
 
-                if (ok) {
-                    /* Destroy control set implied by add_well() */
-                    well_controls_destroy(newWells->ctrls[w]);
+            m = newWells->data;
+            m->well_cpty = nw;
+            m->perf_cpty = nperf;
+            m->hash      = ((const struct WellMgmt *) W->data)->hash;
 
-                    /* Assign complete clone of w's control set */
-                    newWells->ctrls[w] = ctrl;
-                }
+            memcpy(newWells->type     , W->type     , nw * sizeof *W->type     );
+            memcpy(newWells->depth_ref, W->depth_ref, nw * sizeof *W->depth_ref);
+            memcpy(newWells->allow_cf , W->allow_cf , nw * sizeof *W->allow_cf );
 
-                pos = W->well_connpos[w + 1];
+            if (W->comp_frac != NULL) {
+                memcpy(newWells->comp_frac, W->comp_frac,
+                       np * nw * sizeof *W->comp_frac);
             }
+            else {
+                memset(newWells->comp_frac, 0, np * nw * sizeof *W->comp_frac);
+            }
+
+            memcpy(newWells->well_connpos, W->well_connpos,
+                   (nw + 1) * sizeof *W->well_connpos);
+
+            memcpy(newWells->well_cells, W->well_cells,
+                   nperf * sizeof *W->well_cells);
 
-            if (! ok) {
-                destroy_wells(newWells);
-                newWells = NULL;
+            if (W->WI != NULL) {
+                memcpy(newWells->WI, W->WI, nperf * sizeof *W->WI);
             }
+            else {
+                memset(newWells->WI, 0, nperf * sizeof *W->WI);
+            }
+
+            newWells->number_of_wells = nw;
+
+            for (w = 0; ok && (w < nw); w++) {
+                if (W->name[ w ] != NULL) {
+                    /* May return NULL, as in add_well(). */
+                    newWells->name[w] = dup_string(W->name[ w ]);
+                }
+
+                ok = (newWells->ctrls[w] = well_controls_clone(W->ctrls[w])) != NULL;
+            }
+        }
+
+        if (! ok) {
+            destroy_wells(newWells);
+            newWells = NULL;
         }
     }
 
@@ -552,9 +659,22 @@ wells_equal(const struct Wells *W1, const struct Wells *W2 , bool verbose)
         return are_equal;
     }
 
+    /* Equal hashes of the data entered by add_well() leave only the
+     * controls to compare.  The verbose transcript needs the full
+     * comparison. */
+    bool hashed = false;
+    if (!verbose) {
+        const struct WellMgmt* mgmt1 = W1->data;
+        const struct WellMgmt* mgmt2 = W2->data;
+        if (mgmt1->hash != mgmt2->hash) {
+            return false;
+        }
+        hashed = true;
+    }
+
     int i;
     for (i=0; i<W1->number_of_wells; i++) {
-        if (are_equal) {
+        if (are_equal && !hashed) {
             /*
               The name attribute can be NULL. The comparison is as
               follows:
@@ -573,12 +693,12 @@ wells_equal(const struct Wells *W1, const struct Wells *W2 , bool verbose)
             if (verbose && !are_equal) 
                 printf("Well name[%d] %s and %s are different \n",  i , W1->name[i] ,  W2->name[i]);
         }
-        if (W1->type[i] != W2->type[i]) {
+        if (!hashed && (W1->type[i] != W2->type[i])) {
             are_equal = false;
             if (verbose)
                 printf("Well->type[%d] different %d %d \n",i , W1->type[i] , W2->type[i] );
         }
-        if (W1->depth_ref[i] != W2->depth_ref[i]) {
+        if (!hashed && (W1->depth_ref[i] != W2->depth_ref[i])) {
             are_equal = false;
             if (verbose)
                 printf("Well->depth_ref[%d] different %g %g \n",i , W1->depth_ref[i] , W2->depth_ref[i] );
@@ -588,7 +708,7 @@ wells_equal(const struct Wells *W1, const struct Wells *W2 , bool verbose)
             if (verbose)
                 printf("Well controls are different for well[%d]:%s \n",i,W1->name[i]);
         }
-        if (W1->allow_cf[i] != W2->allow_cf[i]) {
+        if (!hashed && (W1->allow_cf[i] != W2->allow_cf[i])) {
             are_equal = false;
             if (verbose)
                 printf("Well->allow_cf[%d] different %d %d \n",i , W1->type[i] , W2->type[i] );
@@ -603,6 +723,10 @@ wells_equal(const struct Wells *W1, const struct Wells *W2 , bool verbose)
         are_equal = are_equal && (mgmt1->well_cpty == mgmt2->well_cpty);
     }
 
+    if (hashed) {
+        return are_equal;
+    }
+
     if (memcmp(W1->comp_frac, W2->comp_frac, W1->number_of_wells * W1->number_of_phases * sizeof *W1->comp_frac ) != 0) {
         are_equal = false;
         if (verbose)
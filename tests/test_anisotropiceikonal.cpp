@@ -37,8 +37,6 @@
 
 using namespace Opm;
 
-#if BOOST_HEAP_AVAILABLE
-
 BOOST_AUTO_TEST_CASE(cartesian_2d_a)
 {
     const GridManager gm(2, 2);
@@ -90,11 +88,47 @@ BOOST_AUTO_TEST_CASE(cartesian_2d_b)
     }
 }
 
-#else // BOOST_HEAP_AVAILABLE is false
 
-BOOST_AUTO_TEST_CASE(dummy)
+BOOST_AUTO_TEST_CASE(cartesian_3d_fast_iterative)
 {
-    BOOST_CHECK(true);
-}
+    const GridManager gm(6, 5, 4);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const int nc = grid.number_of_cells;
+
+    // Unit distance in y and z, twice that in x.
+    std::vector<double> metric;
+    for (int cell = 0; cell < nc; ++cell) {
+        const double m[9] = { 4, 0, 0,   0, 1, 0,   0, 0, 1 };
+        metric.insert(metric.end(), m, m + 9);
+    }
+    const std::vector<int> start = { 0 };
 
-#endif // BOOST_HEAP_AVAILABLE
+    std::vector<double> sol;
+    AnisotropicEikonal3d ae(grid, 1e-12, 1);
+    ae.solve(metric.data(), start, sol);
+    BOOST_REQUIRE_EQUAL(sol.size(), std::size_t(nc));
+    BOOST_CHECK(ae.iterations() > 0);
+
+    // Exact along the axes and the diagonal of the first cell.
+    BOOST_CHECK_EQUAL(sol[0], 0.0);
+    BOOST_CHECK_CLOSE(sol[5], 10.0, 1e-10);
+    BOOST_CHECK_CLOSE(sol[4*6], 4.0, 1e-10);
+    BOOST_CHECK_CLOSE(sol[3*6*5], 3.0, 1e-10);
+    BOOST_CHECK_CLOSE(sol[1 + 6 + 6*5], std::sqrt(6.0), 1e-10);
+
+    // Elsewhere close to the true distance.
+    for (int cell = 0; cell < nc; ++cell) {
+        const double* x = grid.cell_centroids + 3*cell;
+        const double* x0 = grid.cell_centroids;
+        const double dx = x[0] - x0[0], dy = x[1] - x0[1], dz = x[2] - x0[2];
+        const double truth = std::sqrt(4*dx*dx + dy*dy + dz*dz);
+        BOOST_CHECK(sol[cell] >= truth - 1e-10);
+        BOOST_CHECK(sol[cell] <= 1.1*truth + 1e-10);
+    }
+
+    // Independent of the number of threads.
+    std::vector<double> sol_par;
+    AnisotropicEikonal3d ae_par(grid, 1e-12, 4);
+    ae_par.solve(metric.data(), start, sol_par);
+    BOOST_CHECK_EQUAL_COLLECTIONS(sol.begin(), sol.end(), sol_par.begin(), sol_par.end());
+}
@@ -0,0 +1,125 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE AsyncOutputWriterTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/AsyncOutputWriter.hpp>
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/core/simulator/WellState.hpp>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct StepTimer : public Opm::SimulatorTimerInterface {
+    explicit StepTimer (const int step) : step_ (step) { }
+    int currentStepNum () const { return step_; }
+    double currentStepLength () const { return 1.0; }
+    double stepLengthTaken () const { return 1.0; }
+    double simulationTimeElapsed () const { return step_; }
+    void advance () { ++step_; }
+    bool done () const { return false; }
+    boost::posix_time::ptime startDateTime () const {
+        return boost::posix_time::ptime (boost::gregorian::date (2016, 1, 1));
+    }
+    std::unique_ptr <Opm::SimulatorTimerInterface> clone () const {
+        return std::unique_ptr <Opm::SimulatorTimerInterface> (new StepTimer (*this));
+    }
+private:
+    int step_;
+};
+
+// Records the step number and first pressure of each write, slowly.
+struct RecordingWriter : public Opm::OutputWriter {
+    RecordingWriter (std::vector <int>& written, bool& failNext)
+        : written_ (written), failNext_ (failNext) { }
+    void writeInit (const Opm::SimulatorTimerInterface&) { }
+    void writeTimeStep (const Opm::SimulatorTimerInterface& timer,
+                        const Opm::SimulationDataContainer& reservoirState,
+                        const Opm::WellState&,
+                        bool) {
+        std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        if (failNext_) {
+            failNext_ = false;
+            throw std::runtime_error ("write failed");
+        }
+        written_.push_back (1000*timer.currentStepNum ()
+                            + int (reservoirState.pressure ()[0]));
+    }
+private:
+    std::vector <int>& written_;
+    bool& failNext_;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(WritesInOrderFromSnapshots)
+{
+    std::vector <int> written;
+    bool failNext = false;
+    {
+        Opm::AsyncOutputWriter writer (std::unique_ptr <Opm::OutputWriter> (new RecordingWriter (written, failNext)), 2);
+        Opm::SimulationDataContainer state (3, 4, 2);
+        Opm::WellState wellState;
+        for (int step = 0; step < 10; ++step) {
+            // modified right after queueing, so the write must use a copy
+            state.pressure ()[0] = step;
+            writer.writeTimeStep (StepTimer (step), state, wellState, false);
+            state.pressure ()[0] = -1.0;
+        }
+        writer.flush ();
+        BOOST_REQUIRE_EQUAL (written.size (), 10u);
+        for (int step = 0; step < 10; ++step) {
+            BOOST_CHECK_EQUAL (written[step], 1001*step);
+        }
+
+        // pending steps are written on destruction
+        writer.writeTimeStep (StepTimer (10), state, wellState, false);
+    }
+    BOOST_CHECK_EQUAL (written.size (), 11u);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorIsRethrown)
+{
+    std::vector <int> written;
+    bool failNext = true;
+    Opm::AsyncOutputWriter writer (std::unique_ptr <Opm::OutputWriter> (new RecordingWriter (written, failNext)), 1);
+    Opm::SimulationDataContainer state (3, 4, 2);
+    Opm::WellState wellState;
+    writer.writeTimeStep (StepTimer (0), state, wellState, false);
+    BOOST_CHECK_THROW (writer.flush (), std::runtime_error);
+
+    // the writer is usable after the error has been reported
+    writer.writeTimeStep (StepTimer (1), state, wellState, false);
+    writer.flush ();
+    BOOST_CHECK_EQUAL (written.size (), 1u);
+}
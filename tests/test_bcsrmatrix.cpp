@@ -0,0 +1,147 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE BCSRMatrixTest
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/transport/implicit/CSRMatrixBlockAssembler.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+    // Assemble a chain of 'n' cells with 'ndof' unknowns each into
+    // assembler 'a'.  Blocks are column major, as in ImplicitAssembly.
+    template <class Assembler>
+    void assembleChain(const std::size_t n, const std::size_t ndof, Assembler& a)
+    {
+        a.setSize(ndof, n, n, 3*n);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            std::vector<std::size_t> conn;
+            if (i + 1 < n) { conn.push_back(i + 1); }
+            conn.push_back(i);
+            if (i > 0)     { conn.push_back(i - 1); }
+
+            a.createBlockRow(i, conn, ndof);
+        }
+
+        std::vector<double> b(ndof * ndof);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t k = 0; k < b.size(); ++k) {
+                b[k] = 1.0 + i + 0.1*k;
+            }
+            a.assembleBlock(ndof, i, i, b);
+
+            if (i > 0) {
+                for (std::size_t k = 0; k < b.size(); ++k) {
+                    b[k] = -0.5 - 0.01*k;
+                }
+                a.assembleBlock(ndof, i, i - 1, b);
+                a.assembleBlock(ndof, i - 1, i, b);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MatchesScalarAssembly)
+{
+    using namespace Opm::ImplicitTransportDefault;
+
+    for (std::size_t ndof = 1; ndof <= 5; ++ndof) {
+        const std::size_t n = 7;
+
+        MatrixBlockAssembler<struct CSRMatrix>  scalar;
+        MatrixBlockAssembler<struct BCSRMatrix> block;
+        assembleChain(n, ndof, scalar);
+        assembleChain(n, ndof, block);
+
+        const struct CSRMatrix&  A = scalar.matrix();
+        const struct BCSRMatrix& B = block.matrix();
+
+        BOOST_CHECK_EQUAL(B.m  , n);
+        BOOST_CHECK_EQUAL(B.nnz, 3*n - 2);
+        BOOST_CHECK_EQUAL(std::size_t(B.bs), ndof);
+        BOOST_CHECK_EQUAL(A.nnz, B.nnz * ndof * ndof);
+
+        std::vector<double> x(n * ndof), y1(n * ndof, 0.0), y2(n * ndof);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            x[i] = 1.0 + 0.25*i;
+        }
+
+        for (std::size_t i = 0; i < A.m; ++i) {
+            for (int k = A.ia[i]; k < A.ia[i + 1]; ++k) {
+                y1[i] += A.sa[k] * x[A.ja[k]];
+            }
+        }
+        bcsrmatrix_matvec(&B, &x[0], &y2[0]);
+
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            BOOST_CHECK_CLOSE(y1[i], y2[i], 1.0e-12);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CountPushback)
+{
+    const int bs = 2;
+    struct BCSRMatrix* A = bcsrmatrix_new_count_nnz(3, bs);
+    BOOST_REQUIRE(A != 0);
+
+    // Diagonal plus (0,2) and (2,0).
+    A->ia[1] = 2;  A->ia[2] = 1;  A->ia[3] = 2;
+    BOOST_REQUIRE_EQUAL(bcsrmatrix_new_elms_pushback(A), std::size_t(5));
+
+    const int rows[] = { 0, 0, 1, 2, 2 };
+    const int cols[] = { 2, 0, 1, 0, 2 };
+    for (int k = 0; k < 5; ++k) {
+        A->ja[A->ia[rows[k] + 1]++] = cols[k];
+    }
+    bcsrmatrix_sortrows(A);
+    bcsrmatrix_zero(A);
+
+    for (int i = 0; i < 3; ++i) {
+        double* d = A->sa + bcsrmatrix_elm_index(i, i, A)*bs*bs;
+        d[0] = d[3] = 2.0;
+    }
+    A->sa[bcsrmatrix_elm_index(0, 2, A)*bs*bs + 1] = 1.0;
+
+    const double x[] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+    double y[6];
+    bcsrmatrix_matvec(A, x, y);
+
+    BOOST_CHECK_CLOSE(y[0], 2.0 + 6.0, 1.0e-12);
+    BOOST_CHECK_CLOSE(y[1], 4.0, 1.0e-12);
+    BOOST_CHECK_CLOSE(y[2], 6.0, 1.0e-12);
+    BOOST_CHECK_CLOSE(y[5], 12.0, 1.0e-12);
+
+    bcsrmatrix_delete(A);
+}
@@ -23,6 +23,7 @@
 
 #include "opm/core/grid/GridManager.hpp"
 #include "opm/core/simulator/BlackoilState.hpp"
+#include "opm/core/simulator/BlackoilStateToFluidState.hpp"
 
 using namespace Opm;
 using namespace std;
@@ -127,3 +128,44 @@ BOOST_AUTO_TEST_CASE(EqualsNumericalDifferenceReturnFalse) {
         BOOST_CHECK_EQUAL( true , state1.equal(state2) );
     }
 }
+
+
+
+BOOST_AUTO_TEST_CASE(FluidStateAdapterFollowsPhaseUsage) {
+
+    const size_t num_cells = 4;
+    BlackoilState state(num_cells, 5, 2);
+    for (size_t c = 0; c < num_cells; ++c) {
+        state.pressure()[c]         = 1.0e5 * (c + 1);
+        state.temperature()[c]      = 300.0 + c;
+        state.saturation()[2*c + 0] = 0.1 * c;
+        state.saturation()[2*c + 1] = 1.0 - 0.1 * c;
+    }
+
+    PhaseUsage pu;
+    pu.num_phases = 2;
+    pu.phase_used[BlackoilPhases::Aqua]   = 1;
+    pu.phase_used[BlackoilPhases::Liquid] = 1;
+    pu.phase_used[BlackoilPhases::Vapour] = 0;
+    pu.phase_pos[BlackoilPhases::Aqua]    = 0;
+    pu.phase_pos[BlackoilPhases::Liquid]  = 1;
+    pu.phase_pos[BlackoilPhases::Vapour]  = -1;
+
+    BlackoilStateToFluidState fs(state, pu);
+    BOOST_CHECK_EQUAL(fs.numCells(), num_cells);
+    BOOST_CHECK_EQUAL(fs.saturationStride(), 2);
+    BOOST_CHECK(fs.saturationArray() == state.saturation().data());
+    BOOST_CHECK_EQUAL(fs.phaseOffset(BlackoilPhases::Vapour), -1);
+
+    for (size_t c = 0; c < num_cells; ++c) {
+        fs.setCurrentCellIndex(c);
+        BOOST_CHECK_EQUAL(fs.saturation(BlackoilPhases::Aqua),   state.saturation()[2*c + 0]);
+        BOOST_CHECK_EQUAL(fs.saturation(BlackoilPhases::Liquid), state.saturation()[2*c + 1]);
+        BOOST_CHECK_EQUAL(fs.saturation(BlackoilPhases::Vapour), 0.0);
+        BOOST_CHECK_EQUAL(fs.pressure(BlackoilPhases::Liquid),   state.pressure()[c]);
+        BOOST_CHECK_EQUAL(fs.temperature(BlackoilPhases::Liquid), state.temperature()[c]);
+    }
+
+    BOOST_CHECK_THROW(BlackoilStateToFluidState fs3(state), std::runtime_error);
+}
+
@@ -0,0 +1,171 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE BlockGaussSeidelTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/transport/implicit/CSRMatrixBlockGaussSeidelSolver.hpp>
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace
+{
+    // Flux field and upwind-like matrix following the cell order given
+    // by 'next' (next[c] is the downstream neighbour of cell c, or -1).
+    struct UpwindSystem
+    {
+        UpwindSystem(const UnstructuredGrid& g, const std::vector<int>& next)
+            : flux(g.number_of_faces, 0.0)
+        {
+            const int nc = g.number_of_cells;
+            std::vector< std::map<int, double> > rows(nc);
+            for (int c = 0; c < nc; ++c) {
+                rows[c][c] = 2.0 + 0.1*c;
+            }
+            for (int f = 0; f < g.number_of_faces; ++f) {
+                const int c1 = g.face_cells[2*f + 0];
+                const int c2 = g.face_cells[2*f + 1];
+                if (c1 < 0 || c2 < 0) {
+                    continue;
+                }
+                // Full structural pattern, as assembled by ImplicitTransport.
+                rows[c1][c2] += 0.0;
+                rows[c2][c1] += 0.0;
+                if (next[c1] == c2) {
+                    flux[f] = 1.0;
+                    rows[c2][c1] -= 1.0;
+                } else if (next[c2] == c1) {
+                    flux[f] = -1.0;
+                    rows[c1][c2] -= 1.0;
+                }
+            }
+            ia.push_back(0);
+            for (int c = 0; c < nc; ++c) {
+                for (std::map<int, double>::const_iterator it = rows[c].begin();
+                     it != rows[c].end(); ++it) {
+                    ja.push_back(it->first);
+                    sa.push_back(it->second);
+                }
+                ia.push_back(ja.size());
+            }
+            A.m   = nc;
+            A.nnz = ja.size();
+            A.ia  = &ia[0];
+            A.ja  = &ja[0];
+            A.sa  = &sa[0];
+        }
+
+        double residual(const std::vector<double>& b, const std::vector<double>& x) const
+        {
+            double res = 0.0;
+            for (std::size_t i = 0; i < A.m; ++i) {
+                double r = b[i];
+                for (int k = ia[i]; k < ia[i + 1]; ++k) {
+                    r -= sa[k] * x[ja[k]];
+                }
+                res = std::max(res, std::fabs(r));
+            }
+            return res;
+        }
+
+        std::vector<double> flux;
+        std::vector<int> ia, ja;
+        std::vector<double> sa;
+        CSRMatrix A;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (acyclic_exact_in_one_iteration)
+{
+    using Opm::ImplicitTransportLinAlgSupport::CSRMatrixBlockGaussSeidelSolver;
+
+    UnstructuredGrid* g = create_grid_cart2d(12, 1, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+
+    // Flow from right to left, against the natural cell order.
+    std::vector<int> next(nc, -1);
+    for (int c = 1; c < nc; ++c) {
+        next[c] = c - 1;
+    }
+    UpwindSystem sys(*g, next);
+
+    std::vector<double> b(nc), x(nc, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        b[c] = 1.0 + std::sin(0.7*c);
+    }
+
+    CSRMatrixBlockGaussSeidelSolver solver(1.0e-12, 50);
+    solver.setOrdering(*g, &sys.flux[0]);
+    solver.solve(sys.A, b, x);
+
+    BOOST_CHECK_EQUAL(solver.iterations(), 1);
+    BOOST_CHECK_SMALL(sys.residual(b, x), 1.0e-12);
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (loop_and_natural_order)
+{
+    using Opm::ImplicitTransportLinAlgSupport::CSRMatrixBlockGaussSeidelSolver;
+
+    UnstructuredGrid* g = create_grid_cart2d(2, 2, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+
+    // Circulation 0 -> 1 -> 3 -> 2 -> 0 forms a single loop.
+    std::vector<int> next(nc);
+    next[0] = 1;  next[1] = 3;  next[3] = 2;  next[2] = 0;
+    UpwindSystem sys(*g, next);
+
+    std::vector<double> b(nc, 1.0);
+    for (int c = 0; c < nc; ++c) {
+        b[c] = 1.0 + c;
+    }
+
+    CSRMatrixBlockGaussSeidelSolver ordered(1.0e-12, 50);
+    ordered.setOrdering(*g, &sys.flux[0]);
+    std::vector<double> x(nc, 0.0);
+    ordered.solve(sys.A, b, x);
+    BOOST_CHECK_SMALL(sys.residual(b, x), 1.0e-10);
+
+    CSRMatrixBlockGaussSeidelSolver natural(1.0e-12, 50);
+    std::vector<double> y(nc, 0.0);
+    natural.solve(sys.A, b, y);
+    BOOST_CHECK_SMALL(sys.residual(b, y), 1.0e-10);
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -33,8 +33,26 @@
 
 /* --- our own headers --- */
 #include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid/CartesianGridView.hpp>
+#include <opm/core/grid/coarse_grid.h>
+#include <opm/core/grid/cornerpoint_grid.h>
+#include <opm/core/grid/geometry_soa.h>
+#include <opm/core/grid/grid_topology.h>
+#include <opm/core/grid/GridHelpers.hpp>
 #include <opm/core/grid.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/mimetic/mimetic.h>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/pressure/tpfa/TransTpfa.hpp>
+#include <opm/core/wells.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE ()
 
@@ -55,4 +73,560 @@ BOOST_AUTO_TEST_CASE (facenumbers)
     destroy_grid(g);
 }
 
+BOOST_AUTO_TEST_CASE (geometry_soa)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(4, 3, 2, 1., 2., 3.);
+    struct GridGeometrySoA *geom = create_geometry_soa(g);
+    BOOST_REQUIRE (geom != NULL);
+
+    for (int d = 0; d < 3; ++d) {
+        BOOST_CHECK_EQUAL (reinterpret_cast<uintptr_t>(geom->face_normals[d]) % 64, 0u);
+        BOOST_CHECK_EQUAL (reinterpret_cast<uintptr_t>(geom->cell_centroids[d]) % 64, 0u);
+        for (int f = 0; f < g->number_of_faces; ++f) {
+            BOOST_CHECK_EQUAL (geom->face_normals  [d][f], g->face_normals  [3*f + d]);
+            BOOST_CHECK_EQUAL (geom->face_centroids[d][f], g->face_centroids[3*f + d]);
+        }
+        for (int c = 0; c < g->number_of_cells; ++c) {
+            BOOST_CHECK_EQUAL (geom->cell_centroids[d][c], g->cell_centroids[3*c + d]);
+        }
+    }
+
+    // Anisotropic, full tensor permeability.
+    const int nc  = g->number_of_cells;
+    const int nhf = g->cell_facepos[nc];
+    std::vector<double> perm(9*nc, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        perm[9*c + 0] = 1.0 + c;
+        perm[9*c + 4] = 2.0;
+        perm[9*c + 8] = 0.5;
+        perm[9*c + 1] = perm[9*c + 3] = 0.1;
+    }
+    std::vector<double> htrans(nhf), htrans_soa(nhf);
+    tpfa_htrans_compute    (g,       &perm[0], &htrans[0]);
+    tpfa_htrans_compute_soa(g, geom, &perm[0], &htrans_soa[0]);
+    for (int i = 0; i < nhf; ++i) {
+        BOOST_CHECK_CLOSE (htrans_soa[i], htrans[i], 1.0e-12);
+    }
+
+    destroy_geometry_soa(geom);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (single_precision_trans)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(4, 3, 2, 1., 2., 3.);
+    const int nc  = g->number_of_cells;
+    const int nf  = g->number_of_faces;
+    const int nhf = g->cell_facepos[nc];
+
+    std::vector<double> perm(9*nc, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        perm[9*c + 0] = 1.0e-13 * (1.0 + c);
+        perm[9*c + 4] = 2.0e-13;
+        perm[9*c + 8] = 0.5e-13;
+        perm[9*c + 1] = perm[9*c + 3] = 0.1e-13;
+    }
+    const std::vector<float> perm_sp(perm.begin(), perm.end());
+
+    std::vector<double> htrans(nhf), htrans_sp(nhf);
+    tpfa_htrans_compute   (g, &perm[0],    &htrans[0]);
+    tpfa_htrans_compute_sp(g, &perm_sp[0], &htrans_sp[0]);
+    for (int i = 0; i < nhf; ++i) {
+        BOOST_CHECK_CLOSE (htrans_sp[i], htrans[i], 1.0e-4);
+    }
+
+    std::vector<int> fhf(2*nf);
+    tpfa_face_halffaces(g, &fhf[0]);
+    std::vector<double> totmob(nc);
+    for (int c = 0; c < nc; ++c) {
+        totmob[c] = 1.0 + 0.5*(c % 3);
+    }
+    const std::vector<float> htrans_f(htrans.begin(), htrans.end());
+    std::vector<double> trans(nf), trans_sp(nf);
+    tpfa_eff_trans_compute_faces   (g, &fhf[0], &totmob[0], &htrans[0],   &trans[0]);
+    tpfa_eff_trans_compute_faces_sp(g, &fhf[0], &totmob[0], &htrans_f[0], &trans_sp[0]);
+    for (int f = 0; f < nf; ++f) {
+        BOOST_CHECK_CLOSE (trans_sp[f], trans[f], 1.0e-4);
+    }
+
+    std::vector<double> mobref = totmob;
+    totmob[0] *= 2.0;
+    tpfa_eff_trans_compute_faces(g, &fhf[0], &totmob[0], &htrans[0], &trans[0]);
+    const int nupd = tpfa_eff_trans_update_sp(g, &fhf[0], &totmob[0], &htrans_f[0],
+                                              0.0, &mobref[0], &trans_sp[0]);
+    BOOST_CHECK_EQUAL (nupd, g->cell_facepos[1] - g->cell_facepos[0]);
+    for (int f = 0; f < nf; ++f) {
+        BOOST_CHECK_CLOSE (trans_sp[f], trans[f], 1.0e-4);
+    }
+
+    destroy_grid(g);
+}
+
+namespace {
+    // Write a grid in the character format read by read_grid().
+    void write_grid_text(const UnstructuredGrid* g, const char* fname, bool global)
+    {
+        FILE* fp = fopen(fname, "w");
+        BOOST_REQUIRE (fp != NULL);
+
+        const int d = g->dimensions, nc = g->number_of_cells, nf = g->number_of_faces;
+        const int nfn = g->face_nodepos[nf], ncf = g->cell_facepos[nc];
+        fprintf(fp, "%d %d %d %d %d %d\n%d %d\n", d, nc, nf, g->number_of_nodes,
+                nfn, ncf, g->cell_facetag != NULL, int(global));
+        for (int i = 0; i < d; ++i) { fprintf(fp, "%d ", g->cartdims[i]); }
+        fprintf(fp, "\n");
+
+        const auto reals = [fp](const double* x, int n) {
+            for (int i = 0; i < n; ++i) { fprintf(fp, "%.17g%c", x[i], (i % 3 == 2) ? '\n' : ' '); }
+            fprintf(fp, "\n");
+        };
+        const auto ints = [fp](const int* x, int n) {
+            for (int i = 0; i < n; ++i) { fprintf(fp, "%d%c", x[i], (i % 7 == 6) ? '\n' : '\t'); }
+            fprintf(fp, "\n");
+        };
+
+        reals(g->node_coordinates, d * g->number_of_nodes);
+        ints (g->face_nodepos, nf + 1);
+        ints (g->face_nodes, nfn);
+        ints (g->face_cells, 2 * nf);
+        reals(g->face_areas, nf);
+        reals(g->face_centroids, d * nf);
+        reals(g->face_normals, d * nf);
+        ints (g->cell_facepos, nc + 1);
+        for (int i = 0; i < ncf; ++i) {
+            fprintf(fp, "%d", g->cell_faces[i]);
+            if (g->cell_facetag != NULL) { fprintf(fp, " %d", g->cell_facetag[i]); }
+            fprintf(fp, "\n");
+        }
+        if (global) {
+            for (int c = 0; c < nc; ++c) { fprintf(fp, "%d\n", 3*c + 1); }
+        }
+        reals(g->cell_volumes, nc);
+        reals(g->cell_centroids, d * nc);
+        fclose(fp);
+    }
+
+    template <class T>
+    void check_equal(const T* x, const T* y, int n)
+    {
+        BOOST_CHECK (std::equal(x, x + n, y));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (read_grid_text)
+{
+    // Large enough to be read in several chunks.
+    struct UnstructuredGrid *g = create_grid_hexa3d(30, 20, 20, 1., 2., 3.);
+    for (int n = 0; n < g->number_of_nodes; ++n) {
+        g->node_coordinates[3*n + 2] += 0.1 * ((n * 7919) % 13) + 1.0e-7 * n;
+    }
+    compute_geometry(g);
+
+    const char* fname = "read_grid_text.grid";
+    for (int global = 0; global < 2; ++global) {
+        write_grid_text(g, fname, global != 0);
+        struct UnstructuredGrid *h = read_grid(fname);
+        BOOST_REQUIRE (h != NULL);
+
+        const int d = g->dimensions, nc = g->number_of_cells, nf = g->number_of_faces;
+        BOOST_CHECK_EQUAL (h->dimensions, d);
+        BOOST_CHECK_EQUAL (h->number_of_cells, nc);
+        BOOST_CHECK_EQUAL (h->number_of_faces, nf);
+        BOOST_CHECK_EQUAL (h->number_of_nodes, g->number_of_nodes);
+        check_equal(h->cartdims, g->cartdims, 3);
+        check_equal(h->node_coordinates, g->node_coordinates, d * g->number_of_nodes);
+        check_equal(h->face_nodepos, g->face_nodepos, nf + 1);
+        check_equal(h->face_nodes, g->face_nodes, g->face_nodepos[nf]);
+        check_equal(h->face_cells, g->face_cells, 2 * nf);
+        check_equal(h->face_areas, g->face_areas, nf);
+        check_equal(h->face_centroids, g->face_centroids, d * nf);
+        check_equal(h->face_normals, g->face_normals, d * nf);
+        check_equal(h->cell_facepos, g->cell_facepos, nc + 1);
+        check_equal(h->cell_faces, g->cell_faces, g->cell_facepos[nc]);
+        check_equal(h->cell_facetag, g->cell_facetag, g->cell_facepos[nc]);
+        check_equal(h->cell_volumes, g->cell_volumes, nc);
+        check_equal(h->cell_centroids, g->cell_centroids, d * nc);
+        if (global) {
+            BOOST_REQUIRE (h->global_cell != NULL);
+            for (int c = 0; c < nc; ++c) {
+                BOOST_CHECK_EQUAL (h->global_cell[c], 3*c + 1);
+            }
+        } else {
+            BOOST_CHECK (h->global_cell == NULL);
+        }
+        destroy_grid(h);
+    }
+
+    // Truncated input is rejected.
+    {
+        FILE* fp = fopen(fname, "rb");
+        BOOST_REQUIRE (fp != NULL);
+        std::vector<char> text;
+        for (int ch; (ch = fgetc(fp)) != EOF; ) { text.push_back(char(ch)); }
+        fclose(fp);
+        fp = fopen(fname, "wb");
+        BOOST_REQUIRE (fp != NULL);
+        fwrite(&text[0], 1, text.size() / 2, fp);
+        fclose(fp);
+        BOOST_CHECK (read_grid(fname) == NULL);
+    }
+    remove(fname);
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (geometry_threads_reproducible)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(10, 7, 5, 1., 2., 3.);
+
+    // Perturb the nodes to obtain non-trivial geometry.
+    for (int n = 0; n < g->number_of_nodes; ++n) {
+        g->node_coordinates[3*n + 2] += 0.1 * ((n * 7919) % 13);
+    }
+
+    compute_geometry_threaded(g, 1);
+    const int nc = g->number_of_cells;
+    const int nf = g->number_of_faces;
+    const std::vector<double> fn(g->face_normals, g->face_normals + 3*nf);
+    const std::vector<double> fc(g->face_centroids, g->face_centroids + 3*nf);
+    const std::vector<double> cc(g->cell_centroids, g->cell_centroids + 3*nc);
+    const std::vector<double> cv(g->cell_volumes, g->cell_volumes + nc);
+
+    compute_geometry_threaded(g, 4);
+    BOOST_CHECK (memcmp(&fn[0], g->face_normals  , 3*nf*sizeof(double)) == 0);
+    BOOST_CHECK (memcmp(&fc[0], g->face_centroids, 3*nf*sizeof(double)) == 0);
+    BOOST_CHECK (memcmp(&cc[0], g->cell_centroids, 3*nc*sizeof(double)) == 0);
+    BOOST_CHECK (memcmp(&cv[0], g->cell_volumes  ,   nc*sizeof(double)) == 0);
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (coarse_grid_3d)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(4, 4, 2, 1., 1., 1.);
+
+    // 2-by-2-by-1 blocks of 2-by-2-by-2 cells.
+    std::vector<int> p(g->number_of_cells);
+    for (int c = 0; c < g->number_of_cells; ++c) {
+        const int i = c % 4, j = (c / 4) % 4;
+        p[c] = i/2 + 2*(j/2);
+    }
+
+    struct UnstructuredGrid *cg = create_grid_coarse(g, &p[0]);
+    BOOST_REQUIRE (cg != NULL);
+    BOOST_CHECK_EQUAL (cg->number_of_cells, 4);
+    // Four interior faces and one face per side of each block on the
+    // boundary: two lateral sides, top and bottom.
+    BOOST_CHECK_EQUAL (cg->number_of_faces, 4 + 4*4);
+
+    for (int b = 0; b < cg->number_of_cells; ++b) {
+        BOOST_CHECK_CLOSE (cg->cell_volumes[b], 8.0, 1.0e-10);
+        BOOST_CHECK_CLOSE (cg->cell_centroids[3*b + 0], 1.0 + 2*(b % 2), 1.0e-10);
+        BOOST_CHECK_CLOSE (cg->cell_centroids[3*b + 1], 1.0 + 2*(b / 2), 1.0e-10);
+        BOOST_CHECK_CLOSE (cg->cell_centroids[3*b + 2], 1.0, 1.0e-10);
+
+        // Closed cells: outward normals sum to zero, one face per tag.
+        double n[3] = { 0.0, 0.0, 0.0 };
+        int tags = 0;
+        BOOST_CHECK_EQUAL (cg->cell_facepos[b + 1] - cg->cell_facepos[b], 6);
+        for (int i = cg->cell_facepos[b]; i < cg->cell_facepos[b + 1]; ++i) {
+            const int f = cg->cell_faces[i];
+            const double s = (cg->face_cells[2*f + 0] == b) ? 1.0 : -1.0;
+            for (int d = 0; d < 3; ++d) {
+                n[d] += s * cg->face_normals[3*f + d];
+            }
+            tags |= 1 << cg->cell_facetag[i];
+        }
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_SMALL (n[d], 1.0e-12);
+        }
+        BOOST_CHECK_EQUAL (tags, 0x3f);
+    }
+
+    for (int f = 0; f < cg->number_of_faces; ++f) {
+        BOOST_CHECK_CLOSE (cg->face_areas[f], 4.0, 1.0e-10);
+        BOOST_CHECK_EQUAL (cg->face_nodepos[f + 1] - cg->face_nodepos[f], 8);
+    }
+
+    destroy_grid(cg);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (coarse_grid_2d)
+{
+    struct UnstructuredGrid *g = create_grid_cart2d(4, 4, 1., 1.);
+
+    std::vector<int> p(g->number_of_cells);
+    for (int c = 0; c < g->number_of_cells; ++c) {
+        p[c] = (c % 4)/2 + 2*((c / 4)/2);
+    }
+
+    struct UnstructuredGrid *cg = create_grid_coarse(g, &p[0]);
+    BOOST_REQUIRE (cg != NULL);
+    BOOST_CHECK_EQUAL (cg->number_of_cells, 4);
+    BOOST_CHECK_EQUAL (cg->number_of_faces, 4 + 4*2);
+
+    for (int f = 0; f < cg->number_of_faces; ++f) {
+        BOOST_CHECK_CLOSE (cg->face_areas[f], 2.0, 1.0e-10);
+        BOOST_REQUIRE_EQUAL (cg->face_nodepos[f + 1] - cg->face_nodepos[f], 2);
+
+        // End points are a face length apart.
+        const int* fn = cg->face_nodes + cg->face_nodepos[f];
+        double l2 = 0.0;
+        for (int d = 0; d < 2; ++d) {
+            const double dx = cg->node_coordinates[2*fn[1] + d] - cg->node_coordinates[2*fn[0] + d];
+            l2 += dx*dx;
+        }
+        BOOST_CHECK_CLOSE (l2, 4.0, 1.0e-10);
+    }
+
+    destroy_grid(cg);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (grid_topology)
+{
+    using namespace Opm::UgGridHelpers;
+
+    struct UnstructuredGrid *g = create_grid_hexa3d(5, 4, 3, 1., 1., 1.);
+    struct GridTopology *t = create_grid_topology(g);
+    BOOST_REQUIRE (t != NULL);
+    BOOST_CHECK_EQUAL (numCells(*t), numCells(*g));
+    BOOST_CHECK_EQUAL (numFaces(*t), numFaces(*g));
+    BOOST_CHECK_EQUAL (numCellFaces(*t), numCellFaces(*g));
+
+    const auto c2f_g = cell2Faces(*g);
+    const auto c2f_t = cell2Faces(*t);
+    BOOST_CHECK_EQUAL (c2f_t.noEntries(), c2f_g.noEntries());
+    for (int c = 0; c < numCells(*g); ++c) {
+        BOOST_CHECK_EQUAL_COLLECTIONS (c2f_t[c].begin(), c2f_t[c].end(),
+                                       c2f_g[c].begin(), c2f_g[c].end());
+        for (auto f = c2f_t[c].begin(); f != c2f_t[c].end(); ++f) {
+            BOOST_CHECK_EQUAL (faceTag(*t, f), g->cell_facetag[f - c2f_t[0].begin()]);
+        }
+    }
+
+    const auto fc_g = faceCells(*g);
+    const auto fc_t = faceCells(*t);
+    const auto f2v_g = face2Vertices(*g);
+    const auto f2v_t = face2Vertices(*t);
+    for (int f = 0; f < numFaces(*g); ++f) {
+        BOOST_CHECK_EQUAL (fc_t(f, 0), fc_g(f, 0));
+        BOOST_CHECK_EQUAL (fc_t(f, 1), fc_g(f, 1));
+        BOOST_CHECK_EQUAL_COLLECTIONS (f2v_t[f].begin(), f2v_t[f].end(),
+                                       f2v_g[f].begin(), f2v_g[f].end());
+    }
+
+    // Packed face nodes round-trip and are smaller than the raw array.
+    size_t nbytes = 0;
+    unsigned char *buf = grid_topology_pack_face_nodes(t, &nbytes);
+    BOOST_REQUIRE (buf != NULL);
+    BOOST_CHECK_LT (nbytes, g->face_nodepos[g->number_of_faces] * sizeof(int32_t));
+
+    struct GridTopology *u = allocate_grid_topology(3, numCells(*g), numFaces(*g), 0, 0, 0);
+    BOOST_REQUIRE (u != NULL);
+    BOOST_CHECK (!grid_topology_unpack_face_nodes(buf, nbytes - 1, u));
+    BOOST_REQUIRE (grid_topology_unpack_face_nodes(buf, nbytes, u));
+    BOOST_CHECK_EQUAL_COLLECTIONS (u->face_nodepos, u->face_nodepos + numFaces(*g) + 1,
+                                   t->face_nodepos, t->face_nodepos + numFaces(*g) + 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS (u->face_nodes, u->face_nodes + t->face_nodepos[numFaces(*g)],
+                                   t->face_nodes, t->face_nodes + t->face_nodepos[numFaces(*g)]);
+
+    free(buf);
+    destroy_grid_topology(u);
+    destroy_grid_topology(t);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (tpfa_eff_trans_faces)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(4, 3, 2, 1., 2., 3.);
+    const int nc  = g->number_of_cells;
+    const int nf  = g->number_of_faces;
+    const int nhf = g->cell_facepos[nc];
+
+    std::vector<double> perm(9*nc, 0.0), htrans(nhf), totmob(nc);
+    for (int c = 0; c < nc; ++c) {
+        perm[9*c + 0] = 1.0 + c;
+        perm[9*c + 4] = 2.0;
+        perm[9*c + 8] = 0.5;
+        totmob[c] = 1.0 + 0.1*c;
+    }
+    tpfa_htrans_compute(g, &perm[0], &htrans[0]);
+
+    std::vector<int> fhf(2*nf);
+    tpfa_face_halffaces(g, &fhf[0]);
+
+    std::vector<double> trans(nf), trans_faces(nf);
+    tpfa_eff_trans_compute      (g,          &totmob[0], &htrans[0], &trans[0]);
+    tpfa_eff_trans_compute_faces(g, &fhf[0], &totmob[0], &htrans[0], &trans_faces[0]);
+    BOOST_CHECK_EQUAL_COLLECTIONS (trans_faces.begin(), trans_faces.end(),
+                                   trans.begin(), trans.end());
+
+    // Unchanged mobilities recompute nothing.
+    std::vector<double> mobref(totmob);
+    BOOST_CHECK_EQUAL (tpfa_eff_trans_update(g, &fhf[0], &totmob[0], &htrans[0], 0.0,
+                                             &mobref[0], &trans_faces[0]), 0);
+
+    // Changes within tolerance are ignored, others update all faces of a cell.
+    totmob[0] *= 1.001;
+    totmob[nc-1] *= 2.0;
+    const int nupd = tpfa_eff_trans_update(g, &fhf[0], &totmob[0], &htrans[0], 0.01,
+                                           &mobref[0], &trans_faces[0]);
+    BOOST_CHECK_EQUAL (nupd, g->cell_facepos[nc] - g->cell_facepos[nc-1]);
+    BOOST_CHECK_EQUAL (mobref[0], 1.0);
+    BOOST_CHECK_EQUAL (mobref[nc-1], totmob[nc-1]);
+
+    BOOST_CHECK_EQUAL (tpfa_eff_trans_update(g, &fhf[0], &totmob[0], &htrans[0], 0.0,
+                                             &mobref[0], &trans_faces[0]),
+                       g->cell_facepos[1] - g->cell_facepos[0]);
+    tpfa_eff_trans_compute(g, &totmob[0], &htrans[0], &trans[0]);
+    BOOST_CHECK_EQUAL_COLLECTIONS (trans_faces.begin(), trans_faces.end(),
+                                   trans.begin(), trans.end());
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (mimetic_ip_batch)
+{
+    struct UnstructuredGrid *grids[] = { create_grid_hexa3d(4, 3, 2, 1., 2., 3.),
+                                         create_grid_cart2d(5, 4, 1., 2.) };
+    for (struct UnstructuredGrid *g : grids) {
+        const int nc = g->number_of_cells;
+        const int d  = g->dimensions;
+        int max_ncf = 0, nb = 0;
+        for (int c = 0; c < nc; ++c) {
+            const int n = g->cell_facepos[c + 1] - g->cell_facepos[c];
+            max_ncf = std::max(max_ncf, n);
+            nb += n * n;
+        }
+
+        // Anisotropic, full tensor permeability.
+        std::vector<double> perm(d*d*nc, 0.0);
+        for (int c = 0; c < nc; ++c) {
+            for (int j = 0; j < d; ++j) {
+                perm[d*d*c + j*(d + 1)] = 1.0 + c + j;
+            }
+            perm[d*d*c + 1] = perm[d*d*c + d] = 0.1;
+        }
+
+        std::vector<double> Binv(nb), Binv_batch(nb);
+        mim_ip_simple_all(nc, d, max_ncf, g->cell_facepos, g->cell_faces,
+                          g->face_cells, g->face_centroids, g->face_normals,
+                          g->face_areas, g->cell_centroids, g->cell_volumes,
+                          &perm[0], &Binv[0]);
+        BOOST_REQUIRE (mim_ip_simple_all_batch(nc, d, max_ncf, g->cell_facepos, g->cell_faces,
+                                               g->face_cells, g->face_centroids, g->face_normals,
+                                               g->face_areas, g->cell_centroids, g->cell_volumes,
+                                               &perm[0], &Binv_batch[0]));
+
+        double scale = 0.0;
+        for (int i = 0; i < nb; ++i) {
+            scale = std::max(scale, std::fabs(Binv[i]));
+        }
+        for (int i = 0; i < nb; ++i) {
+            BOOST_CHECK_SMALL (Binv_batch[i] - Binv[i], 1.0e-12 * scale);
+        }
+
+        destroy_grid(g);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (tpfa_cell_pattern)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(4, 3, 2, 1., 1., 1.);
+    struct CSRMatrix *p = ifs_tpfa_cell_pattern(g);
+    BOOST_REQUIRE (p != NULL);
+    BOOST_CHECK_EQUAL (p->m, size_t(g->number_of_cells));
+
+    struct Wells *w = create_wells(1, 2, 4);
+    BOOST_REQUIRE (w != NULL);
+    const int cells1[] = { 0, 12 };
+    const int cells2[] = { 23, 11 };
+    BOOST_REQUIRE (add_well(INJECTOR, 0., 2, NULL, cells1, NULL, NULL, 1, w));
+    BOOST_REQUIRE (add_well(PRODUCER, 0., 2, NULL, cells2, NULL, NULL, 1, w));
+
+    // Sharing the cell pattern must not change the assembled structure.
+    struct ifs_tpfa_data *h1 = ifs_tpfa_construct(g, w);
+    struct ifs_tpfa_data *h2 = ifs_tpfa_construct_with_pattern(g, w, p);
+    BOOST_REQUIRE (h1 != NULL);
+    BOOST_REQUIRE (h2 != NULL);
+    BOOST_REQUIRE_EQUAL (h1->A->m, h2->A->m);
+    BOOST_REQUIRE_EQUAL (h1->A->nnz, h2->A->nnz);
+    BOOST_CHECK_EQUAL_COLLECTIONS (h1->A->ia, h1->A->ia + h1->A->m + 1,
+                                   h2->A->ia, h2->A->ia + h2->A->m + 1);
+    BOOST_CHECK_EQUAL_COLLECTIONS (h1->A->ja, h1->A->ja + h1->A->nnz,
+                                   h2->A->ja, h2->A->ja + h2->A->nnz);
+
+    ifs_tpfa_destroy(h2);
+    ifs_tpfa_destroy(h1);
+    destroy_wells(w);
+    csrmatrix_delete(p);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (cartesian_grid_view)
+{
+    // The implicit grid must reproduce create_grid_hexa3d() exactly.
+    const int nx = 5, ny = 4, nz = 3;
+    const double dx = 0.3, dy = 1.7, dz = 2.1;
+    struct UnstructuredGrid *g = create_grid_hexa3d(nx, ny, nz, dx, dy, dz);
+    BOOST_REQUIRE (g != NULL);
+    const Opm::CartesianGridView v(nx, ny, nz, dx, dy, dz);
+
+    using namespace Opm::UgGridHelpers;
+    BOOST_REQUIRE_EQUAL (numCells(v), g->number_of_cells);
+    BOOST_REQUIRE_EQUAL (numFaces(v), g->number_of_faces);
+    BOOST_CHECK_EQUAL (numCellFaces(v), int64_t(numCellFaces(*g)));
+    BOOST_CHECK_EQUAL_COLLECTIONS (cartDims(v), cartDims(v) + 3,
+                                   g->cartdims, g->cartdims + 3);
+
+    const Cell2FacesTraits<Opm::CartesianGridView>::Type c2f = cell2Faces(v);
+    for (int c = 0; c < g->number_of_cells; ++c) {
+        const Cell2FacesTraits<Opm::CartesianGridView>::Type::row_type faces = c2f[c];
+        int i = g->cell_facepos[c];
+        for (auto f = faces.begin(); f != faces.end(); ++f, ++i) {
+            BOOST_CHECK_EQUAL (*f, g->cell_faces[i]);
+            BOOST_CHECK_EQUAL (faceTag(v, f), g->cell_facetag[i]);
+        }
+        BOOST_CHECK_EQUAL (i, g->cell_facepos[c + 1]);
+        BOOST_CHECK_EQUAL (cellVolume(v, c), g->cell_volumes[c]);
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_EQUAL (cellCentroid(v, c)[d], g->cell_centroids[3*c + d]);
+        }
+    }
+
+    const FaceCellTraits<Opm::CartesianGridView>::Type face_cells = faceCells(v);
+    for (int f = 0; f < g->number_of_faces; ++f) {
+        BOOST_CHECK_EQUAL (face_cells(f, 0), g->face_cells[2*f + 0]);
+        BOOST_CHECK_EQUAL (face_cells(f, 1), g->face_cells[2*f + 1]);
+        BOOST_CHECK_EQUAL (faceArea(v, f), g->face_areas[f]);
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_EQUAL (faceCentroid(v, f)[d], g->face_centroids[3*f + d]);
+            BOOST_CHECK_EQUAL (faceNormal(v, f)[d], g->face_normals[3*f + d]);
+        }
+    }
+
+    // Transmissibilities through the templated TPFA code.
+    std::vector<double> perm(9*g->number_of_cells, 0.0);
+    for (int c = 0; c < g->number_of_cells; ++c) {
+        perm[9*c + 0] = 1.0 + 0.1*c;
+        perm[9*c + 4] = 2.0;
+        perm[9*c + 8] = 0.5;
+    }
+    const int nhf = g->cell_facepos[g->number_of_cells];
+    std::vector<double> htrans(nhf), htrans_v(nhf);
+    std::vector<double> trans(g->number_of_faces), trans_v(g->number_of_faces);
+    tpfa_htrans_compute(g, perm.data(), htrans.data());
+    tpfa_htrans_compute(&v, perm.data(), htrans_v.data());
+    tpfa_trans_compute(g, htrans.data(), trans.data());
+    tpfa_trans_compute(&v, htrans_v.data(), trans_v.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS (htrans_v.begin(), htrans_v.end(),
+                                   htrans.begin(), htrans.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS (trans_v.begin(), trans_v.end(),
+                                   trans.begin(), trans.end());
+
+    destroy_grid(g);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
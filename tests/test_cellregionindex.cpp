@@ -0,0 +1,104 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE
+
+#define BOOST_TEST_MODULE CellRegionIndexTest
+
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/utility/CellRegionIndex.hpp>
+#include <opm/core/utility/extractPvtTableIndex.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Parser/ParseContext.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid.h>
+
+struct Setup {
+    Setup()
+    {
+        Opm::ParseContext parseContext;
+        Opm::ParserPtr parser(new Opm::Parser());
+        deck = parser->parseFile("compressed_gridproperty.data" , parseContext);
+        ecl.reset(new Opm::EclipseState(deck , parseContext));
+        grid.reset(new Opm::GridManager(deck));
+    }
+
+    Opm::DeckConstPtr                 deck;
+    Opm::EclipseStateConstPtr         ecl;
+    std::shared_ptr<Opm::GridManager> grid;
+};
+
+
+BOOST_AUTO_TEST_SUITE(CellRegionIndexHandling)
+
+// Active cells one and three of SATNUM = [4 3 2 1].
+BOOST_FIXTURE_TEST_CASE(DefinedKeyword, Setup)
+{
+    const UnstructuredGrid& g = *grid->c_grid();
+    const Opm::CellRegionIndex satnum(ecl, "SATNUM", g.number_of_cells, g.global_cell);
+
+    BOOST_REQUIRE_EQUAL(satnum.size(), 2u);
+    BOOST_CHECK_EQUAL(satnum[0], 2);
+    BOOST_CHECK_EQUAL(satnum[1], 0);
+    BOOST_CHECK_EQUAL(satnum.numRegions(), 3);
+}
+
+
+// Cells are all in region zero if the keyword is not in the deck.
+BOOST_FIXTURE_TEST_CASE(UndefinedKeyword, Setup)
+{
+    const UnstructuredGrid& g = *grid->c_grid();
+    const Opm::CellRegionIndex eqlnum(ecl, "EQLNUM", g.number_of_cells, g.global_cell);
+
+    BOOST_REQUIRE_EQUAL(eqlnum.size(), 2u);
+    BOOST_CHECK_EQUAL(eqlnum[0], 0);
+    BOOST_CHECK_EQUAL(eqlnum[1], 0);
+    BOOST_CHECK_EQUAL(eqlnum.numRegions(), 1);
+}
+
+
+// Instances are shared between consumers of the same keyword, deck
+// and grid.
+BOOST_FIXTURE_TEST_CASE(SharedInstance, Setup)
+{
+    const UnstructuredGrid& g = *grid->c_grid();
+    const auto a = Opm::CellRegionIndex::get(ecl, "SATNUM", g.number_of_cells, g.global_cell);
+    const auto b = Opm::CellRegionIndex::get(ecl, "SATNUM", g.number_of_cells, g.global_cell);
+    const auto c = Opm::CellRegionIndex::get(ecl, "PVTNUM", g.number_of_cells, g.global_cell);
+
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(a != c);
+
+    std::vector<int> pvtIdx;
+    Opm::extractPvtTableIndex(pvtIdx, ecl, g.number_of_cells, g.global_cell);
+    BOOST_CHECK_EQUAL_COLLECTIONS(pvtIdx.begin(), pvtIdx.end(), c->begin(), c->end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,236 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE CfsTpfaResidualTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/pressure/tpfa/cfs_tpfa_residual.h>
+#include <opm/core/pressure/tpfa/compr_quant_general.h>
+#include <opm/core/pressure/tpfa/compr_source.h>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+#include <opm/core/wells.h>
+#include <opm/core/well_controls.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Smooth, cell- or face-dependent test value in (a - b, a + b).
+    double field(const int i, const double a, const double b, const double k)
+    {
+        return a + b*std::sin(k*(i + 1));
+    }
+
+    // A two-phase system with wells, sources and gravity on a
+    // Cartesian grid, to be assembled by different assemblers.
+    struct System
+    {
+        System()
+            : g(create_grid_cart3d(7, 5, 4), destroy_grid),
+              W(create_wells(np, 2, 4), destroy_wells),
+              cq(compr_quantities_gen_allocate(g->number_of_cells, g->number_of_faces, np),
+                 compr_quantities_gen_deallocate),
+              src(compr_src_allocate(np, 2), compr_src_deallocate)
+        {
+            const int nc = g->number_of_cells;
+            const int nf = g->number_of_faces;
+
+            const double invalid_alq = -1e100;
+            const int invalid_vfp = -2147483647;
+            const double frac[] = { 1.0, 0.0 };
+            {
+                const int cells[] = { 0, 35 };
+                const double WI[] = { 1.0e-12, 2.0e-12 };
+                add_well(INJECTOR, 0.0, 2, frac, cells, WI, "INJ", true, W.get());
+                append_well_controls(RESERVOIR_RATE, 1.0e-3, invalid_alq, invalid_vfp,
+                                     frac, 0, W.get());
+            }
+            {
+                const int cells[] = { nc - 1, nc - 36 };
+                const double WI[] = { 3.0e-12, 0.5e-12 };
+                add_well(PRODUCER, 0.0, 2, frac, cells, WI, "PROD", true, W.get());
+                append_well_controls(BHP, 1.0e7, invalid_alq, invalid_vfp,
+                                     0, 1, W.get());
+            }
+            set_current_control(0, 0, W.get());
+            set_current_control(1, 0, W.get());
+
+            const int nperf = W->well_connpos[W->number_of_wells];
+            wdp.resize(nperf);
+            wellA.resize(np*np*nperf);
+            wellmob.resize(np*nperf);
+            for (int j = 0; j < nperf; ++j) {
+                wdp[j] = field(j, 1.0e4, 5.0e3, 0.7);
+                for (int p = 0; p < np; ++p) {
+                    wellmob[j*np + p] = field(j*np + p, 1.0e3, 5.0e2, 1.3);
+                    for (int q = 0; q < np; ++q) {
+                        wellA[(j*np + p)*np + q] = (p == q) ? field(j, 1.0, 0.1, 0.3) : 0.01;
+                    }
+                }
+            }
+            completion.wdp = &wdp[0];
+            completion.A = &wellA[0];
+            completion.phasemob = &wellmob[0];
+            wells.W = W.get();
+            wells.data = &completion;
+
+            const double sat[] = { 1.0, 0.0 };
+            append_compr_source_term(17, np, 1.0e-4, sat, src.get());
+            append_compr_source_term(nc - 20, np, -5.0e-5, sat, src.get());
+            forces.wells = &wells;
+            forces.src = src.get();
+
+            std::vector<double> perm(9*nc, 0.0), htrans(g->cell_facepos[nc]);
+            for (int c = 0; c < nc; ++c) {
+                for (int d = 0; d < 3; ++d) {
+                    perm[9*c + 4*d] = field(c + d, 1.0e-13, 5.0e-14, 0.9);
+                }
+            }
+            tpfa_htrans_compute(g.get(), &perm[0], &htrans[0]);
+            trans.resize(nf);
+            tpfa_trans_compute(g.get(), &htrans[0], &trans[0]);
+
+            for (int c = 0; c < nc; ++c) {
+                for (int p = 0; p < np; ++p) {
+                    for (int q = 0; q < np; ++q) {
+                        const int i = (c*np + p)*np + q;
+                        cq->Ac[i] = (p == q) ? field(c + p, 1.0, 0.1, 0.37) : 0.02;
+                        cq->dAc[i] = (p == q) ? field(c + p, 1.0e-9, 5.0e-10, 0.53) : 0.0;
+                    }
+                }
+            }
+            gravcap.resize(np*nf);
+            for (int f = 0; f < nf; ++f) {
+                for (int p = 0; p < np; ++p) {
+                    cq->phasemobf[f*np + p] = field(f*np + p, 1.0e3, 5.0e2, 0.71);
+                    gravcap[f*np + p] = field(f*np + p, 0.0, 1.0e2, 1.1);
+                    for (int q = 0; q < np; ++q) {
+                        const int i = (f*np + p)*np + q;
+                        cq->Af[i] = (p == q) ? field(f + p, 1.0, 0.1, 0.19) : 0.02;
+                    }
+                }
+            }
+
+            zc.resize(np*nc);
+            cpress.resize(nc);
+            porevol.resize(nc);
+            porevol0.resize(nc);
+            rock_comp.resize(nc);
+            for (int c = 0; c < nc; ++c) {
+                zc[c*np + 0] = field(c, 0.5, 0.3, 0.61);
+                zc[c*np + 1] = 1.0 - zc[c*np + 0];
+                cpress[c] = field(c, 2.0e7, 1.0e6, 0.29);
+                porevol[c] = field(c, 0.2, 0.05, 0.83);
+                porevol0[c] = 0.99*porevol[c];
+                rock_comp[c] = field(c, 1.0e-9, 5.0e-10, 0.47);
+            }
+            wpress.push_back(2.1e7);
+            wpress.push_back(1.0e7);
+        }
+
+        // Assemble with incompressible or with compressible rock.
+        void assemble(struct cfs_tpfa_res_data* h, const bool comprock)
+        {
+            const double dt = 86400.0;
+            if (comprock) {
+                cfs_tpfa_res_comprock_assemble(g.get(), dt, &forces, &zc[0], cq.get(),
+                                               &trans[0], &gravcap[0], &cpress[0], &wpress[0],
+                                               &porevol[0], &porevol0[0], &rock_comp[0], h);
+            } else {
+                cfs_tpfa_res_assemble(g.get(), dt, &forces, &zc[0], cq.get(),
+                                      &trans[0], &gravcap[0], &cpress[0], &wpress[0],
+                                      &porevol[0], h);
+            }
+        }
+
+        static const int np = 2;
+        std::shared_ptr<UnstructuredGrid> g;
+        std::shared_ptr<Wells> W;
+        std::shared_ptr<compr_quantities_gen> cq;
+        std::shared_ptr<compr_src> src;
+        CompletionData completion;
+        cfs_tpfa_res_wells wells;
+        cfs_tpfa_res_forces forces;
+        std::vector<double> wdp, wellA, wellmob;
+        std::vector<double> trans, gravcap, zc, cpress, wpress;
+        std::vector<double> porevol, porevol0, rock_comp;
+    };
+
+    void checkIdentical(const cfs_tpfa_res_data& a, const cfs_tpfa_res_data& b)
+    {
+        BOOST_REQUIRE_EQUAL(a.J->m, b.J->m);
+        BOOST_REQUIRE_EQUAL(a.J->nnz, b.J->nnz);
+        const int m = a.J->m;
+        const int nnz = a.J->nnz;
+        BOOST_CHECK_EQUAL_COLLECTIONS(a.J->ia, a.J->ia + m + 1, b.J->ia, b.J->ia + m + 1);
+        BOOST_CHECK_EQUAL_COLLECTIONS(a.J->ja, a.J->ja + nnz, b.J->ja, b.J->ja + nnz);
+        // Exact comparison: the threaded assembly must be bit-identical.
+        BOOST_CHECK_EQUAL_COLLECTIONS(a.J->sa, a.J->sa + nnz, b.J->sa, b.J->sa + nnz);
+        BOOST_CHECK_EQUAL_COLLECTIONS(a.F, a.F + m, b.F, b.F + m);
+
+        double fmax = 0.0;
+        for (int i = 0; i < m; ++i) {
+            fmax = std::max(fmax, std::fabs(a.F[i]));
+        }
+        BOOST_CHECK(fmax > 0.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ThreadedAssemblyMatchesSerial)
+{
+    System sys;
+    std::shared_ptr<cfs_tpfa_res_data>
+        serial(cfs_tpfa_res_construct(sys.g.get(), &sys.wells, System::np),
+               cfs_tpfa_res_destroy);
+    std::shared_ptr<cfs_tpfa_res_data>
+        threaded(cfs_tpfa_res_construct_threaded(sys.g.get(), &sys.wells, System::np, 4),
+                 cfs_tpfa_res_destroy);
+    BOOST_REQUIRE(serial);
+    BOOST_REQUIRE(threaded);
+
+    for (int comprock = 0; comprock < 2; ++comprock) {
+        sys.assemble(serial.get(), comprock != 0);
+        sys.assemble(threaded.get(), comprock != 0);
+        checkIdentical(*serial, *threaded);
+    }
+
+    // Assembling again reuses the per-thread scratch space.
+    sys.cpress[3] *= 1.01;
+    sys.assemble(serial.get(), false);
+    sys.assemble(threaded.get(), false);
+    checkIdentical(*serial, *threaded);
+}
@@ -0,0 +1,160 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE CheckpointTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/CheckpointWriter.hpp>
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/core/simulator/TimeStepControl.hpp>
+#include <opm/core/simulator/WellState.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct StepTimer : public Opm::SimulatorTimerInterface {
+    explicit StepTimer (const int step) : step_ (step) { }
+    int currentStepNum () const { return step_; }
+    double currentStepLength () const { return 2.0; }
+    double stepLengthTaken () const { return 2.0; }
+    double simulationTimeElapsed () const { return 2.0*step_; }
+    void advance () { ++step_; }
+    bool done () const { return false; }
+    boost::posix_time::ptime startDateTime () const {
+        return boost::posix_time::ptime (boost::gregorian::date (2016, 1, 1));
+    }
+    std::unique_ptr <Opm::SimulatorTimerInterface> clone () const {
+        return std::unique_ptr <Opm::SimulatorTimerInterface> (new StepTimer (*this));
+    }
+private:
+    int step_;
+};
+
+struct NoChange : public Opm::RelativeChangeInterface {
+    explicit NoChange (const double change) : change_ (change) { }
+    double relativeChange () const { return change_; }
+private:
+    double change_;
+};
+
+const char* const FILENAME = "test_checkpoint.ckpt";
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (RoundTrip)
+{
+    Opm::SimulationDataContainer state (4, 5, 2);
+    state.registerCellData ("TRACER", 1, 0.0);
+    for (int c = 0; c < 4; ++c) {
+        state.pressure ()[c] = 100.0 + c;
+        state.getCellData ("TRACER")[c] = 0.5*c;
+    }
+    state.faceflux ()[3] = -1.5;
+    Opm::WellState wellState;
+    Opm::writeCheckpoint (FILENAME, StepTimer (3), state, wellState, 0,
+                          std::vector <double> { 7.0, 8.0 });
+
+    Opm::SimulationDataContainer restored (4, 5, 2);
+    Opm::WellState restoredWellState;
+    const Opm::CheckpointInfo info =
+        Opm::readCheckpoint (FILENAME, restored, restoredWellState, 0);
+    BOOST_CHECK_EQUAL (info.reportStep, 3);
+    BOOST_CHECK_EQUAL (info.currentStep, 3);
+    BOOST_CHECK_EQUAL (info.simulationTimeElapsed, 6.0);
+    BOOST_CHECK_EQUAL (info.stepLength, 2.0);
+    BOOST_CHECK (info.controllerState == (std::vector <double> { 7.0, 8.0 }));
+    BOOST_CHECK (restored.hasCellData ("TRACER"));
+    BOOST_CHECK (restored.pressure () == state.pressure ());
+    BOOST_CHECK (restored.getCellData ("TRACER") == state.getCellData ("TRACER"));
+    BOOST_CHECK (restored.faceflux () == state.faceflux ());
+
+    // a state of another grid is refused
+    Opm::SimulationDataContainer other (3, 5, 2);
+    BOOST_CHECK_THROW (Opm::readCheckpoint (FILENAME, other, restoredWellState, 0),
+                       std::runtime_error);
+
+    // as is a truncated file
+    {
+        std::ofstream os (FILENAME, std::ios::binary | std::ios::trunc);
+        os.write ("OPMCKPT", 8);
+    }
+    BOOST_CHECK_THROW (Opm::readCheckpoint (FILENAME, restored, restoredWellState, 0),
+                       std::runtime_error);
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (WriterSkipsSubsteps)
+{
+    Opm::SimulationDataContainer state (2, 3, 2);
+    Opm::WellState wellState;
+    {
+        Opm::CheckpointWriter writer (FILENAME, 0.0);
+        writer.setControllerState ([] { return std::vector <double> (1, 42.0); });
+        writer.writeInit (StepTimer (0));
+        state.pressure ()[0] = 1.0;
+        writer.writeTimeStep (StepTimer (1), state, wellState, false);
+        state.pressure ()[0] = 2.0;
+        writer.writeTimeStep (StepTimer (2), state, wellState, true);
+        writer.flush ();
+    }
+    Opm::SimulationDataContainer restored (2, 3, 2);
+    const Opm::CheckpointInfo info =
+        Opm::readCheckpoint (FILENAME, restored, wellState, 0);
+    BOOST_CHECK_EQUAL (info.currentStep, 1);
+    BOOST_CHECK_EQUAL (restored.pressure ()[0], 1.0);
+    BOOST_CHECK (info.controllerState == std::vector <double> (1, 42.0));
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (ControllerState)
+{
+    Opm::PIDTimeStepControl pid (1e-2);
+    pid.computeTimeStepSize (1.0, 0, NoChange (1e-3));
+    Opm::PIDTimeStepControl restoredPid (1e-2);
+    restoredPid.setState (pid.state ());
+    BOOST_CHECK_EQUAL (restoredPid.computeTimeStepSize (1.0, 0, NoChange (2e-3)),
+                       pid.computeTimeStepSize (1.0, 0, NoChange (2e-3)));
+    BOOST_CHECK_THROW (restoredPid.setState (std::vector <double> (1, 0.0)),
+                       std::runtime_error);
+
+    Opm::NewtonRateTimeStepControl newton (8, 20, 1e-6);
+    newton.beginStep ();
+    newton.addResidual (1.0);
+    newton.addResidual (2.0);
+    newton.beginStep ();  // the previous step failed
+    Opm::NewtonRateTimeStepControl restoredNewton (8, 20, 1e-6);
+    restoredNewton.setState (newton.state ());
+    BOOST_CHECK_EQUAL (restoredNewton.failedSteps (), 1);
+    BOOST_CHECK_EQUAL (restoredNewton.wastedIterations (), 1);
+}
@@ -0,0 +1,211 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE CoarseSysTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/pressure/msmfem/coarse_conn.h>
+#include <opm/core/pressure/msmfem/coarse_sys.h>
+#include <opm/core/pressure/msmfem/partition.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // Reentrant dense LU solver with partial pivoting.
+    void dense_solve(struct CSRMatrix* A, double* b, double* x)
+    {
+        const std::size_t n = A->m;
+        std::vector<double> M(n * n, 0.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (int k = A->ia[i]; k < A->ia[i + 1]; ++k) {
+                M[i*n + A->ja[k]] = A->sa[k];
+            }
+            x[i] = b[i];
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+            std::size_t piv = j;
+            for (std::size_t i = j + 1; i < n; ++i) {
+                if (std::fabs(M[i*n + j]) > std::fabs(M[piv*n + j])) { piv = i; }
+            }
+            if (piv != j) {
+                for (std::size_t k = 0; k < n; ++k) { std::swap(M[j*n + k], M[piv*n + k]); }
+                std::swap(x[j], x[piv]);
+            }
+            for (std::size_t i = j + 1; i < n; ++i) {
+                const double l = M[i*n + j] / M[j*n + j];
+                for (std::size_t k = j; k < n; ++k) { M[i*n + k] -= l * M[j*n + k]; }
+                x[i] -= l * x[j];
+            }
+        }
+        for (std::size_t j = n; j-- > 0; ) {
+            for (std::size_t k = j + 1; k < n; ++k) { x[j] -= M[j*n + k] * x[k]; }
+            x[j] /= M[j*n + j];
+        }
+    }
+
+    struct CoarseSetup
+    {
+        CoarseSetup()
+            : g(create_grid_hexa3d(6, 6, 2, 1., 1., 1.))
+        {
+            const int nc = g->number_of_cells;
+            const int fine_d[]   = { 6, 6, 2 };
+            const int coarse_d[] = { 3, 3, 1 };
+
+            std::vector<int> idx(nc);
+            for (int c = 0; c < nc; ++c) { idx[c] = c; }
+
+            p.resize(nc);
+            partition_unif_idx(3, nc, fine_d, coarse_d, &idx[0], &p[0]);
+
+            ct = coarse_topology_create(nc, g->number_of_faces, 8,
+                                        &p[0], g->face_cells);
+
+            perm.assign(9 * nc, 0.0);
+            for (int c = 0; c < nc; ++c) {
+                const double k = 1.0 + (c % 5);
+                perm[9*c + 0] = perm[9*c + 4] = perm[9*c + 8] = k;
+            }
+            src.assign(nc, 0.0);
+            totmob.assign(nc, 1.0);
+        }
+
+        ~CoarseSetup()
+        {
+            coarse_topology_destroy(ct);
+            destroy_grid(g);
+        }
+
+        struct UnstructuredGrid* g;
+        struct coarse_topology*  ct;
+        std::vector<int>         p;
+        std::vector<double>      perm, src, totmob;
+    };
+
+    std::size_t basis_size(const CoarseSetup& s, const struct coarse_sys* sys)
+    {
+        return sys->basis_pos[s.ct->nblocks];
+    }
+
+    std::size_t ip_size(const CoarseSetup& s, const struct coarse_sys* sys)
+    {
+        return sys->cell_ip_pos[s.ct->nblocks];
+    }
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (concurrent_construction)
+{
+    CoarseSetup s;
+    BOOST_REQUIRE (s.ct != NULL);
+
+    struct coarse_sys* seq =
+        coarse_sys_construct(s.g, &s.p[0], s.ct, &s.perm[0], &s.src[0],
+                             &s.totmob[0], dense_solve);
+    struct coarse_sys* par =
+        coarse_sys_construct_concurrent(s.g, &s.p[0], s.ct, &s.perm[0],
+                                        &s.src[0], &s.totmob[0],
+                                        dense_solve);
+    BOOST_REQUIRE (seq != NULL);
+    BOOST_REQUIRE (par != NULL);
+
+    // Basis functions are computed independently, hence identically.
+    BOOST_CHECK (std::equal(seq->basis, seq->basis + basis_size(s, seq),
+                            par->basis));
+    BOOST_CHECK (std::equal(seq->cell_ip, seq->cell_ip + ip_size(s, seq),
+                            par->cell_ip));
+
+    coarse_sys_destroy(par);
+    coarse_sys_destroy(seq);
+}
+
+BOOST_AUTO_TEST_CASE (adaptive_update)
+{
+    CoarseSetup s;
+    BOOST_REQUIRE (s.ct != NULL);
+
+    struct coarse_sys* sys =
+        coarse_sys_construct(s.g, &s.p[0], s.ct, &s.perm[0], &s.src[0],
+                             &s.totmob[0], dense_solve);
+    BOOST_REQUIRE (sys != NULL);
+
+    std::vector<double> mobref = s.totmob;
+
+    // Changes below the threshold: nothing to recompute.
+    std::vector<double> totmob(s.totmob.size(), 1.05);
+    BOOST_CHECK_EQUAL (coarse_sys_update_basis(s.g, &s.p[0], s.ct,
+                                               &s.perm[0], &s.src[0],
+                                               &totmob[0], 0.1,
+                                               &mobref[0], 1,
+                                               dense_solve, sys), 0);
+    BOOST_CHECK (mobref == s.totmob);
+
+    // Change mobility in the centre block, which touches four coarse
+    // faces.
+    const int centre = 4;
+    for (int c = 0; c < s.g->number_of_cells; ++c) {
+        totmob[c] = (s.p[c] == centre) ? 3.0 : 1.0;
+    }
+
+    BOOST_CHECK_EQUAL (coarse_sys_update_basis(s.g, &s.p[0], s.ct,
+                                               &s.perm[0], &s.src[0],
+                                               &totmob[0], 0.1,
+                                               &mobref[0], 1,
+                                               dense_solve, sys), 4);
+
+    for (int c = 0; c < s.g->number_of_cells; ++c) {
+        BOOST_CHECK_EQUAL (mobref[c], (s.p[c] == centre) ? 3.0 : 1.0);
+    }
+
+    // Recomputed basis functions match those of a full construction.
+    struct coarse_sys* ref =
+        coarse_sys_construct(s.g, &s.p[0], s.ct, &s.perm[0], &s.src[0],
+                             &totmob[0], dense_solve);
+    BOOST_REQUIRE (ref != NULL);
+
+    BOOST_CHECK (std::equal(ref->basis, ref->basis + basis_size(s, ref),
+                            sys->basis));
+    BOOST_CHECK (std::equal(ref->cell_ip, ref->cell_ip + ip_size(s, ref),
+                            sys->cell_ip));
+
+    coarse_sys_destroy(ref);
+    coarse_sys_destroy(sys);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -62,6 +62,27 @@ BOOST_AUTO_TEST_CASE(FourByFourColumnTest)
 }
 
 
+BOOST_AUTO_TEST_CASE(SparseTableColumnTest)
+{
+    const int size_x = 3, size_y = 2, size_z = 5;
+    using namespace Opm;
+    GridManager manager(size_x, size_y, size_z);
+
+    SparseTable<int> columns;
+    extractColumn(*manager.c_grid(), columns);
+
+    BOOST_REQUIRE_EQUAL(columns.size(), size_x * size_y);
+    for (int i = 0; i < size_x * size_y; i++) {
+        std::vector<int> correct_answer;
+        for (int j = 0; j < size_z; j++) {
+            correct_answer.push_back(i + j*size_x*size_y);
+        }
+        BOOST_CHECK_EQUAL_COLLECTIONS(correct_answer.begin(), correct_answer.end(),
+                                      columns[i].begin(), columns[i].end());
+    }
+}
+
+
 
 BOOST_AUTO_TEST_CASE(DisjointColumn)
 {
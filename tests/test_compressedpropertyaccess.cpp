@@ -221,6 +221,35 @@ BOOST_FIXTURE_TEST_CASE(CAExtractDoubleDefinedNTG,
 }
 
 
+// Gather compressed double array extracted from input deck into a
+// contiguous cache shared by copies of the array.
+BOOST_FIXTURE_TEST_CASE(CAExtractDoubleDefinedGather,
+                        TestFixture<SetupSimple>)
+{
+    typedef Opm::GridPropertyAccess::ArrayPolicy
+        ::ExtractFromDeck<double> ECLGlobalDoubleArray;
+
+    typedef Opm::GridPropertyAccess::
+        Compressed<ECLGlobalDoubleArray> CompressedArray;
+
+    ECLGlobalDoubleArray ntg_glob(ecl, "NTG", 1.0);
+    CompressedArray ntg(ntg_glob, grid.c_grid()->global_cell);
+
+    BOOST_CHECK(ntg.data() == 0);
+
+    ntg.gather(grid.c_grid()->number_of_cells);
+    const CompressedArray copy(ntg);
+
+    BOOST_REQUIRE(ntg.data() != 0);
+    BOOST_CHECK(copy.data() == ntg.data());
+
+    BOOST_CHECK_CLOSE(ntg.data()[0], 0.2, reltol);
+    BOOST_CHECK_CLOSE(ntg.data()[1], 0.4, reltol);
+    BOOST_CHECK_CLOSE(copy[0], 0.2, reltol);
+    BOOST_CHECK_CLOSE(copy[1], 0.4, reltol);
+}
+
+
 // Construct compressed integer (int) array based on global, undefined
 // (unspecified) array extracted from input deck.  Default ("any")
 // type-check tag.
@@ -0,0 +1,213 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE CSRMatrixTest
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <opm/core/linalg/sparse_sys.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Rectangular m-by-(m + 2) matrix with rows of varying length and
+    // unsorted columns.
+    std::shared_ptr<CSRMatrix> makeMatrix(const std::size_t m)
+    {
+        std::shared_ptr<CSRMatrix> A(csrmatrix_new_count_nnz(m), csrmatrix_delete);
+        for (std::size_t i = 0; i < m; ++i) {
+            A->ia[i + 1] = 1 + (i % 5);
+        }
+        BOOST_REQUIRE(csrmatrix_new_elms_pushback(A.get()) > 0);
+        for (std::size_t i = 0; i < m; ++i) {
+            const int len = 1 + (i % 5);
+            for (int k = 0; k < len; ++k) {
+                const int j = A->ia[i + 1];
+                A->ja[j] = (i + 2 - k + m + 2) % (m + 2);
+                A->sa[j] = 1.0 + std::sin(0.3*j);
+                ++A->ia[i + 1];
+            }
+        }
+        return A;
+    }
+
+    std::vector<double> reference(const CSRMatrix& A, const std::vector<double>& x)
+    {
+        std::vector<double> y(A.m, 0.0);
+        for (std::size_t i = 0; i < A.m; ++i) {
+            for (int k = A.ia[i]; k < A.ia[i + 1]; ++k) {
+                y[i] += A.sa[k] * x[A.ja[k]];
+            }
+        }
+        return y;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MatVec)
+{
+    const std::size_t m = 101;
+    std::shared_ptr<CSRMatrix> A = makeMatrix(m);
+
+    std::vector<double> x(m + 2), y(m);
+    for (std::size_t j = 0; j < x.size(); ++j) {
+        x[j] = std::cos(0.7*j);
+    }
+    csrmatrix_matvec(A.get(), &x[0], &y[0]);
+
+    const std::vector<double> yref = reference(*A, x);
+    for (std::size_t i = 0; i < m; ++i) {
+        BOOST_CHECK_CLOSE(y[i], yref[i], 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MatVecTranspose)
+{
+    const std::size_t m = 101;
+    const std::size_t n = m + 2;
+    std::shared_ptr<CSRMatrix> A = makeMatrix(m);
+
+    std::vector<double> x(m), y(n, -1.0), yref(n, 0.0);
+    for (std::size_t i = 0; i < m; ++i) {
+        x[i] = std::cos(0.7*i);
+    }
+    csrmatrix_matvec_transpose(A.get(), n, &x[0], &y[0]);
+
+    for (std::size_t i = 0; i < m; ++i) {
+        for (int k = A->ia[i]; k < A->ia[i + 1]; ++k) {
+            yref[A->ja[k]] += A->sa[k] * x[i];
+        }
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+        BOOST_CHECK_CLOSE(y[j] + 10.0, yref[j] + 10.0, 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SortRows)
+{
+    std::shared_ptr<CSRMatrix> A = makeMatrix(50);
+    csrmatrix_sortrows(A.get());
+
+    for (std::size_t i = 0; i < A->m; ++i) {
+        for (int k = A->ia[i] + 1; k < A->ia[i + 1]; ++k) {
+            BOOST_CHECK_LT(A->ja[k - 1], A->ja[k]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SlicedMatVec)
+{
+    const std::size_t m = 101;
+    std::shared_ptr<CSRMatrix> A = makeMatrix(m);
+
+    std::vector<double> x(m + 2);
+    for (std::size_t j = 0; j < x.size(); ++j) {
+        x[j] = std::cos(0.7*j);
+    }
+
+    const int C[]     = { 1, 4, 8, 8 };
+    const int sigma[] = { 1, 1, 16, 1000 };
+    for (int t = 0; t < 4; ++t) {
+        std::shared_ptr<SellCSMatrix> S(sellcsmatrix_from_csr(A.get(), C[t], sigma[t]),
+                                        sellcsmatrix_delete);
+        BOOST_REQUIRE(S);
+
+        std::vector<double> y(m, 0.0);
+        sellcsmatrix_matvec(S.get(), &x[0], &y[0]);
+        std::vector<double> yref = reference(*A, x);
+        for (std::size_t i = 0; i < m; ++i) {
+            BOOST_CHECK_CLOSE(y[i], yref[i], 1e-12);
+        }
+
+        // New values in the same pattern.
+        for (std::size_t k = 0; k < A->nnz; ++k) {
+            A->sa[k] *= 2.0;
+        }
+        sellcsmatrix_update_values(A.get(), S.get());
+        sellcsmatrix_matvec(S.get(), &x[0], &y[0]);
+        yref = reference(*A, x);
+        for (std::size_t i = 0; i < m; ++i) {
+            BOOST_CHECK_CLOSE(y[i], yref[i], 1e-12);
+        }
+    }
+
+    BOOST_CHECK(sellcsmatrix_from_csr(A.get(), 0, 1) == 0);
+    BOOST_CHECK(sellcsmatrix_from_csr(A.get(), SELLCS_MAX_CHUNK_HEIGHT + 1, 1) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTrip)
+{
+    std::shared_ptr<CSRMatrix> A = makeMatrix(37);
+    std::vector<double> v(A->m);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = std::exp(0.1*i) / 3.0;
+    }
+
+    for (int compress = 0; compress < 2; ++compress) {
+        BOOST_REQUIRE(csrmatrix_write_bin(A.get(), "csrmatrix_test.bin", compress));
+        std::shared_ptr<CSRMatrix> B(csrmatrix_read_bin("csrmatrix_test.bin"), csrmatrix_delete);
+        BOOST_REQUIRE(B);
+        BOOST_CHECK_EQUAL(B->m, A->m);
+        BOOST_CHECK_EQUAL(B->nnz, A->nnz);
+        BOOST_CHECK_EQUAL_COLLECTIONS(B->ia, B->ia + B->m + 1, A->ia, A->ia + A->m + 1);
+        BOOST_CHECK_EQUAL_COLLECTIONS(B->ja, B->ja + B->nnz, A->ja, A->ja + A->nnz);
+        BOOST_CHECK_EQUAL_COLLECTIONS(B->sa, B->sa + B->nnz, A->sa, A->sa + A->nnz);
+
+        BOOST_REQUIRE(vector_write_bin(v.size(), &v[0], "vector_test.bin", compress));
+        std::size_t n = 0;
+        double* w = vector_read_bin("vector_test.bin", &n);
+        BOOST_REQUIRE(w != 0);
+        BOOST_CHECK_EQUAL_COLLECTIONS(w, w + n, v.begin(), v.end());
+        free(w);
+
+        // A vector file is not a matrix file.
+        BOOST_CHECK(csrmatrix_read_bin("vector_test.bin") == 0);
+    }
+
+    // Corrupt a matrix element.
+    BOOST_REQUIRE(csrmatrix_write_bin(A.get(), "csrmatrix_test.bin", 0));
+    {
+        FILE* fp = fopen("csrmatrix_test.bin", "r+b");
+        BOOST_REQUIRE(fp != 0);
+        fseek(fp, -3, SEEK_END);
+        const int c = fgetc(fp);
+        fseek(fp, -3, SEEK_END);
+        fputc(c ^ 0x10, fp);
+        fclose(fp);
+    }
+    BOOST_CHECK(csrmatrix_read_bin("csrmatrix_test.bin") == 0);
+    BOOST_CHECK(csrmatrix_read_bin("nonexistent_file.bin") == 0);
+
+    std::remove("csrmatrix_test.bin");
+    std::remove("vector_test.bin");
+}
@@ -70,4 +70,39 @@ BOOST_AUTO_TEST_CASE (cubic)
     BOOST_REQUIRE_CLOSE (interp.evaluate(4.0), 2., 0.00001);
 }
 
+BOOST_AUTO_TEST_CASE (frozen)
+{
+    const int num_v = 6;
+    double xv[num_v] = {0.0, 0.1, 0.5, 0.6, 2.0, 5.0};
+    double fv[num_v] = {1.0, 2.0, 4.0, 4.0, 7.0, 3.0};
+    std::vector<double> x(xv, xv + num_v);
+    std::vector<double> f(fv, fv + num_v);
+    MonotCubicInterpolator interp(x, f);
+    MonotCubicInterpolator frozen(interp);
+    frozen.freeze();
+    BOOST_CHECK (frozen.isFrozen());
+
+    // Sample densely, including the data points and extrapolation.
+    std::vector<double> xs;
+    for (int i = -10; i <= 560; ++i) {
+        xs.push_back(0.01*i);
+    }
+    xs.insert(xs.end(), x.begin(), x.end());
+    std::vector<double> fs(xs.size());
+    frozen.evaluate(xs.size(), &xs[0], &fs[0]);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        BOOST_CHECK_EQUAL (frozen.evaluate(xs[i]), interp.evaluate(xs[i]));
+        BOOST_CHECK_EQUAL (fs[i], interp.evaluate(xs[i]));
+    }
+
+    // Modification unfreezes.
+    frozen.addPair(1.0, 5.0);
+    interp.addPair(1.0, 5.0);
+    BOOST_CHECK (!frozen.isFrozen());
+    frozen.freeze();
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        BOOST_CHECK_EQUAL (frozen.evaluate(xs[i]), interp.evaluate(xs[i]));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
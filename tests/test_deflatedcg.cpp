@@ -0,0 +1,167 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE DeflatedConjugateGradientTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/linalg/DeflatedConjugateGradient.hpp>
+
+#include <cmath>
+#include <vector>
+
+using Opm::DeflatedConjugateGradient;
+
+namespace
+{
+    // Five-point Laplacian on an n x n grid with a permeability that
+    // varies over several orders of magnitude, scaled by step.
+    struct Laplacian
+    {
+        Laplacian(const int n, const double step)
+            : n_(n), k_(n*n)
+        {
+            for (int j = 0; j < n; ++j) {
+                for (int i = 0; i < n; ++i) {
+                    k_[i + n*j] = std::pow(10.0, 2.0*std::sin(0.7*i + step)*std::cos(0.5*j));
+                }
+            }
+        }
+
+        double trans(const int a, const int b) const
+        {
+            return 2.0/(1.0/k_[a] + 1.0/k_[b]);
+        }
+
+        void apply(const double* x, double* y) const
+        {
+            for (int j = 0; j < n_; ++j) {
+                for (int i = 0; i < n_; ++i) {
+                    const int c = i + n_*j;
+                    // Dirichlet coupling on the left boundary.
+                    double d = (i == 0) ? k_[c] : 0.0;
+                    double s = 0.0;
+                    const int nb[4] = { i > 0 ? c - 1 : -1, i < n_ - 1 ? c + 1 : -1,
+                                        j > 0 ? c - n_ : -1, j < n_ - 1 ? c + n_ : -1 };
+                    for (int q = 0; q < 4; ++q) {
+                        if (nb[q] >= 0) {
+                            const double t = trans(c, nb[q]);
+                            d += t;
+                            s += t*x[nb[q]];
+                        }
+                    }
+                    y[c] = d*x[c] - s;
+                }
+            }
+        }
+
+        double diagonal(const int c) const
+        {
+            std::vector<double> e(n_*n_, 0.0), ae(n_*n_);
+            e[c] = 1.0;
+            apply(e.data(), ae.data());
+            return ae[c];
+        }
+
+        int n_;
+        std::vector<double> k_;
+    };
+
+    double residualNorm(const Laplacian& A, const std::vector<double>& b,
+                        const std::vector<double>& x)
+    {
+        std::vector<double> ax(x.size());
+        A.apply(x.data(), ax.data());
+        double s = 0.0;
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            s += (b[i] - ax[i])*(b[i] - ax[i]);
+        }
+        return std::sqrt(s);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(RecyclingReducesIterations)
+{
+    const int n = 12;
+    const int size = n*n;
+    DeflatedConjugateGradient plain(0);
+    DeflatedConjugateGradient recycling(6, 24);
+    int plain_its = 0;
+    int recycled_its = 0;
+    for (int step = 0; step < 6; ++step) {
+        const Laplacian A(n, 0.02*step);
+        std::vector<double> inv_diag(size);
+        for (int c = 0; c < size; ++c) {
+            inv_diag[c] = 1.0/A.diagonal(c);
+        }
+        DeflatedConjugateGradient::Operator op = [&](const double* x, double* y) { A.apply(x, y); };
+        DeflatedConjugateGradient::Operator jacobi = [&](const double* r, double* z) {
+            for (int c = 0; c < size; ++c) {
+                z[c] = inv_diag[c]*r[c];
+            }
+        };
+        std::vector<double> b(size);
+        for (int c = 0; c < size; ++c) {
+            b[c] = std::cos(0.3*c + step);
+        }
+        const double bnorm = residualNorm(A, b, std::vector<double>(size, 0.0));
+
+        std::vector<double> x0(size, 0.0);
+        const auto r0 = plain.solve(size, op, jacobi, b.data(), x0.data(), 1e-10, 1000);
+        BOOST_CHECK(r0.converged);
+        BOOST_CHECK_LE(residualNorm(A, b, x0), 1e-9*bnorm);
+
+        std::vector<double> x1(size, 0.0);
+        const auto r1 = recycling.solve(size, op, jacobi, b.data(), x1.data(), 1e-10, 1000);
+        BOOST_CHECK(r1.converged);
+        BOOST_CHECK_LE(residualNorm(A, b, x1), 1e-9*bnorm);
+        if (step > 0) {
+            plain_its += r0.iterations;
+            recycled_its += r1.iterations;
+        }
+    }
+    BOOST_CHECK_EQUAL(plain.numVectors(), 0);
+    BOOST_CHECK_EQUAL(recycling.numVectors(), 6);
+    BOOST_CHECK_LT(recycled_its, plain_its);
+}
+
+BOOST_AUTO_TEST_CASE(SizeChangeClearsSpace)
+{
+    DeflatedConjugateGradient dcg(2);
+    for (const int n : { 4, 5 }) {
+        const Laplacian A(n, 0.0);
+        DeflatedConjugateGradient::Operator op = [&](const double* x, double* y) { A.apply(x, y); };
+        DeflatedConjugateGradient::Operator id = [&](const double* r, double* z) {
+            std::copy(r, r + n*n, z);
+        };
+        std::vector<double> b(n*n, 1.0), x(n*n, 0.0);
+        const auto rep = dcg.solve(n*n, op, id, b.data(), x.data(), 1e-12, 100);
+        BOOST_CHECK(rep.converged);
+        BOOST_CHECK_EQUAL(dcg.numVectors(), 2);
+    }
+}
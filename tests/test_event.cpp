@@ -16,6 +16,8 @@
 /* --- our own headers --- */
 #include <opm/core/utility/Event.hpp>
 
+#include <vector>
+
 using namespace std;
 using namespace Opm;
 
@@ -76,3 +78,61 @@ BOOST_AUTO_TEST_CASE(reg_twice)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+    struct Recorder {
+        std::vector <int> order;
+        void record (int i) { order.push_back (i); }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(priority_order)
+{
+    EventSource source;
+    Recorder rec;
+    source.add ([&rec] () { rec.record (1); }, 0)
+          .add ([&rec] () { rec.record (2); }, 10)
+          .add ([&rec] () { rec.record (3); }, 0)
+          .add ([&rec] () { rec.record (4); }, -5);
+    source.signal ();
+    const int expected[] = { 2, 1, 3, 4 };
+    BOOST_CHECK_EQUAL_COLLECTIONS (rec.order.begin (), rec.order.end (),
+                                   expected, expected + 4);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_after_serial)
+{
+    EventSource source;
+    std::vector <int> calls (8, 0);
+    std::vector <int> in_order (8, 1);
+    int serial_done = 0;
+    for (int i = 0; i < 8; ++i) {
+        source.add ([&calls, &in_order, &serial_done, i] () {
+                // the serial handler of this priority has already run
+                if (serial_done != calls[i] + 1) { in_order[i] = 0; }
+                ++calls[i];
+            }, 0, true);
+    }
+    source.add ([&serial_done] () { ++serial_done; }, 0);
+    source.signal ();
+    source.signal ();
+    for (int i = 0; i < 8; ++i) {
+        BOOST_CHECK_EQUAL (calls[i], 2);
+        BOOST_CHECK_EQUAL (in_order[i], 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(large_handler)
+{
+    // too big for the inline buffer of EventHandler
+    std::vector <double> payload (16, 1.0);
+    double big[16] = { 0 };
+    double sum = 0.0;
+    EventSource source;
+    source.add (EventHandler ([big, &sum, &payload] () {
+                for (int i = 0; i < 16; ++i) { sum += big[i] + payload[i]; }
+            }), 0);
+    EventSource copy (source);
+    copy.signal ();
+    BOOST_CHECK_EQUAL (sum, 16.0);
+}
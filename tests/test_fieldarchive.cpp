@@ -0,0 +1,230 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE FieldArchiveTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/FieldArchive.hpp>
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/core/simulator/WellState.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct StepTimer : public Opm::SimulatorTimerInterface {
+    explicit StepTimer (const int step) : step_ (step) { }
+    int currentStepNum () const { return step_; }
+    double currentStepLength () const { return 2.0; }
+    double stepLengthTaken () const { return 2.0; }
+    double simulationTimeElapsed () const { return 2.0*step_; }
+    void advance () { ++step_; }
+    bool done () const { return false; }
+    boost::posix_time::ptime startDateTime () const {
+        return boost::posix_time::ptime (boost::gregorian::date (2016, 1, 1));
+    }
+    std::unique_ptr <Opm::SimulatorTimerInterface> clone () const {
+        return std::unique_ptr <Opm::SimulatorTimerInterface> (new StepTimer (*this));
+    }
+private:
+    int step_;
+};
+
+const char* const FILENAME = "test_fieldarchive.opmfa";
+const int NUM_CELLS = 10;
+
+// state with two phases, where the values depend on the step
+Opm::SimulationDataContainer makeState (const int step) {
+    Opm::SimulationDataContainer state (NUM_CELLS, 0, 2);
+    state.registerCellData ("TRACER", 1, 0.0);
+    for (int c = 0; c < NUM_CELLS; ++c) {
+        state.pressure ()[c] = 1.0e7 + 1234.5678*c + 100.0*step;
+        state.getCellData ("SATURATION")[2*c] = 0.1*c/3.0;
+        state.getCellData ("SATURATION")[2*c + 1] = 1.0 - 0.1*c/3.0;
+        state.getCellData ("TRACER")[c] = std::sin (c + step);
+    }
+    return state;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (Lossless)
+{
+    std::vector <int> globalCell (NUM_CELLS);
+    for (int c = 0; c < NUM_CELLS; ++c) {
+        globalCell[c] = 2*c + 1;
+    }
+    {
+        Opm::FieldArchiveWriter writer (FILENAME, NUM_CELLS, globalCell.data (),
+                                        Opm::FieldArchiveWriter::Tolerances (), 3);
+        Opm::WellState wellState;
+        writer.writeInit (StepTimer (0));
+        for (int step = 0; step < 3; ++step) {
+            writer.writeTimeStep (StepTimer (step), makeState (step), wellState, false);
+            // substeps are not archived
+            writer.writeTimeStep (StepTimer (step), makeState (step + 10), wellState, true);
+        }
+    }
+
+    Opm::FieldArchiveReader reader (FILENAME);
+    BOOST_CHECK_EQUAL (reader.numCells (), NUM_CELLS);
+    BOOST_CHECK (reader.globalCell () == globalCell);
+    BOOST_REQUIRE_EQUAL (reader.numSteps (), 3);
+    BOOST_CHECK_EQUAL (reader.findReportStep (2), 2);
+    BOOST_CHECK_EQUAL (reader.findReportStep (5), -1);
+    BOOST_CHECK_EQUAL (reader.simulationTime (1), 2.0);
+    BOOST_CHECK_EQUAL (reader.components (0, "SATURATION"), 2);
+    BOOST_CHECK (!reader.hasField (0, "FACEFLUX"));
+
+    for (int step = 0; step < 3; ++step) {
+        const Opm::SimulationDataContainer state = makeState (step);
+        const std::vector <std::string> names = reader.fieldNames (step);
+        BOOST_CHECK_EQUAL (names.size (), state.cellData ().size ());
+        for (const auto& field : state.cellData ()) {
+            BOOST_CHECK (reader.read (step, field.first) == field.second);
+            BOOST_CHECK_EQUAL (reader.tolerance (step, field.first), 0.0);
+        }
+    }
+
+    // a range across chunk boundaries
+    const std::vector <double>& saturation = makeState (1).getCellData ("SATURATION");
+    const std::vector <double> range = reader.read (1, "SATURATION", 2, 7);
+    BOOST_CHECK (range == std::vector <double> (saturation.begin () + 4, saturation.begin () + 14));
+    BOOST_CHECK (reader.read (1, "SATURATION", 4, 4).empty ());
+    BOOST_CHECK_THROW (reader.read (1, "SATURATION", 5, 11), std::invalid_argument);
+    BOOST_CHECK_THROW (reader.read (1, "NOSUCHFIELD"), std::runtime_error);
+
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (ErrorBounded)
+{
+    Opm::FieldArchiveWriter::Tolerances tolerances;
+    tolerances["PRESSURE"] = 10.0;
+    tolerances["TRACER"] = 1.0e-6;
+    Opm::SimulationDataContainer state = makeState (0);
+    // cannot be rounded, so its chunk is stored losslessly
+    state.getCellData ("TRACER")[8] = std::numeric_limits <double>::infinity ();
+    {
+        Opm::FieldArchiveWriter writer (FILENAME, NUM_CELLS, 0, tolerances, 4);
+        Opm::WellState wellState;
+        writer.writeInit (StepTimer (0));
+        writer.writeTimeStep (StepTimer (0), state, wellState, false);
+    }
+
+    Opm::FieldArchiveReader reader (FILENAME);
+    BOOST_REQUIRE_EQUAL (reader.numSteps (), 1);
+    BOOST_CHECK (reader.globalCell ().empty ());
+    BOOST_CHECK_EQUAL (reader.tolerance (0, "PRESSURE"), 10.0);
+    for (const auto& field : state.cellData ()) {
+        const double bound = reader.tolerance (0, field.first);
+        const std::vector <double> values = reader.read (0, field.first);
+        BOOST_REQUIRE_EQUAL (values.size (), field.second.size ());
+        for (std::size_t i = 0; i < values.size (); ++i) {
+            if (std::isinf (field.second[i])) {
+                BOOST_CHECK_EQUAL (values[i], field.second[i]);
+            }
+            else {
+                BOOST_CHECK_LE (std::abs (values[i] - field.second[i]), bound * (1.0 + 1.0e-12));
+            }
+        }
+    }
+    BOOST_CHECK (reader.read (0, "SATURATION") == state.getCellData ("SATURATION"));
+
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (WithoutIndex)
+{
+    const std::string copy = std::string (FILENAME) + ".copy";
+    {
+        Opm::FieldArchiveWriter writer (FILENAME, NUM_CELLS, 0);
+        Opm::WellState wellState;
+        writer.writeInit (StepTimer (0));
+        writer.writeTimeStep (StepTimer (0), makeState (0), wellState, false);
+        writer.writeTimeStep (StepTimer (1), makeState (1), wellState, false);
+
+        // as left by an interrupted run, with a partially written step
+        std::ifstream in (FILENAME, std::ios::binary);
+        std::vector <char> contents ((std::istreambuf_iterator <char> (in)),
+                                     std::istreambuf_iterator <char> ());
+        contents.insert (contents.end (), { 'S', 'T', 'E', 'P', 1, 2, 3 });
+        std::ofstream out (copy.c_str (), std::ios::binary);
+        out.write (contents.data (), contents.size ());
+    }
+
+    Opm::FieldArchiveReader reader (copy);
+    BOOST_REQUIRE_EQUAL (reader.numSteps (), 2);
+    BOOST_CHECK_EQUAL (reader.reportStep (1), 1);
+    BOOST_CHECK (reader.read (1, "PRESSURE") == makeState (1).pressure ());
+
+    std::remove (FILENAME);
+    std::remove (copy.c_str ());
+}
+
+BOOST_AUTO_TEST_CASE (Incremental)
+{
+    // TRACER never changes, and PRESSURE only in the cells of the middle chunk
+    std::vector <Opm::SimulationDataContainer> states (3, makeState (0));
+    for (int step = 1; step < 3; ++step) {
+        states[step].pressure ()[4] += step;
+    }
+    std::vector <std::size_t> fileSize;
+    for (const bool incremental : { false, true }) {
+        {
+            Opm::FieldArchiveWriter writer (FILENAME, NUM_CELLS, 0,
+                                            Opm::FieldArchiveWriter::Tolerances (), 3, incremental);
+            Opm::WellState wellState;
+            writer.writeInit (StepTimer (0));
+            for (int step = 0; step < 3; ++step) {
+                writer.writeTimeStep (StepTimer (step), states[step], wellState, false);
+            }
+        }
+        std::ifstream in (FILENAME, std::ios::binary | std::ios::ate);
+        fileSize.push_back (in.tellg ());
+
+        Opm::FieldArchiveReader reader (FILENAME);
+        BOOST_REQUIRE_EQUAL (reader.numSteps (), 3);
+        for (int step = 0; step < 3; ++step) {
+            for (const auto& field : states[step].cellData ()) {
+                BOOST_CHECK (reader.read (step, field.first) == field.second);
+            }
+        }
+        BOOST_CHECK_EQUAL (reader.read (2, "PRESSURE", 4, 5)[0], states[2].pressure ()[4]);
+    }
+    BOOST_CHECK_LT (fileSize[1], fileSize[0]);
+
+    std::remove (FILENAME);
+}
@@ -0,0 +1,83 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE FixedSizeAdTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/core/utility/FixedSizeAd.hpp>
+
+using Opm::FixedSizeAd;
+
+BOOST_AUTO_TEST_CASE(constant_and_variable)
+{
+    typedef FixedSizeAd<2> Ad;
+    const Ad c = Ad::constant(3.0);
+    BOOST_CHECK_EQUAL(c.value(), 3.0);
+    BOOST_CHECK_EQUAL(c.derivative(0), 0.0);
+    BOOST_CHECK_EQUAL(c.derivative(1), 0.0);
+
+    const Ad x = Ad::variable(2.0, 1, 0.5);
+    BOOST_CHECK_EQUAL(x.value(), 2.0);
+    BOOST_CHECK_EQUAL(x.derivative(0), 0.0);
+    BOOST_CHECK_EQUAL(x.derivative(1), 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(arithmetic)
+{
+    typedef FixedSizeAd<2> Ad;
+    const double tol = 1e-12;
+    const Ad x = Ad::variable(2.0, 0);
+    const Ad y = Ad::variable(5.0, 1);
+
+    // f(x, y) = (3x + y)*x/y - 1/x + 2 - y
+    const Ad f = (3.0*x + y)*x/y - 1.0/x + 2.0 - y;
+    BOOST_CHECK_CLOSE(f.value(), 22.0/5.0 - 0.5 + 2.0 - 5.0, tol);
+    // df/dx = (6x + y)/y + 1/x^2
+    BOOST_CHECK_CLOSE(f.derivative(0), 17.0/5.0 + 0.25, tol);
+    // df/dy = -3x^2/y^2 - 1
+    BOOST_CHECK_CLOSE(f.derivative(1), -12.0/25.0 - 1.0, tol);
+
+    const Ad g = -(x - 1.0) * (y / 2.0) + (1.0 - y);
+    BOOST_CHECK_CLOSE(g.value(), -2.5 - 4.0, tol);
+    BOOST_CHECK_CLOSE(g.derivative(0), -2.5, tol);
+    BOOST_CHECK_CLOSE(g.derivative(1), -1.5, tol);
+}
+
+BOOST_AUTO_TEST_CASE(fractional_flow)
+{
+    // Derivative of a fractional flow through the mobility derivatives.
+    typedef FixedSizeAd<1> Ad;
+    const double m0 = 0.3, dm0 = 1.2, m1 = 0.5, dm1 = -0.8;
+    const Ad mw = Ad::variable(m0, 0, dm0);
+    const Ad mo = Ad::variable(m1, 0, dm1);
+    const Ad f = mw / (mw + mo);
+
+    const double mt = m0 + m1;
+    const double fv = m0/mt;
+    BOOST_CHECK_CLOSE(f.value(), fv, 1e-12);
+    BOOST_CHECK_CLOSE(f.derivative(0), ((1 - fv)*dm0 - fv*dm1)/mt, 1e-12);
+}
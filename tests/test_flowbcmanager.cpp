@@ -0,0 +1,115 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE FlowBCManagerTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/pressure/FlowBCManager.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    struct GridDeleter
+    {
+        void operator()(UnstructuredGrid* g) const { destroy_grid(g); }
+    };
+
+    typedef std::unique_ptr<UnstructuredGrid, GridDeleter> GridPtr;
+
+    // Reference side scan: boundary faces carrying the side's tag.
+    std::vector<int> sideFacesByTag(const UnstructuredGrid& g, const int side)
+    {
+        std::vector<int> faces;
+        for (int c = 0; c < g.number_of_cells; ++c) {
+            for (int hf = g.cell_facepos[c]; hf < g.cell_facepos[c + 1]; ++hf) {
+                const int f = g.cell_faces[hf];
+                if (g.cell_facetag[hf] == side &&
+                    (g.face_cells[2*f] == -1 || g.face_cells[2*f + 1] == -1)) {
+                    faces.push_back(f);
+                }
+            }
+        }
+        return faces;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(side_faces)
+{
+    GridPtr g(create_grid_cart3d(7, 5, 3));
+    Opm::FlowBCManager bcm;
+    for (int s = 0; s < 6; ++s) {
+        const Opm::FlowBCManager::Side side = Opm::FlowBCManager::Side(s);
+        const std::vector<int>& faces = bcm.sideFaces(*g, side);
+        const std::vector<int> expected = sideFacesByTag(*g, s);
+        BOOST_CHECK_EQUAL_COLLECTIONS(faces.begin(), faces.end(),
+                                      expected.begin(), expected.end());
+        // Cached: same object on repeated calls.
+        BOOST_CHECK(&faces == &bcm.sideFaces(*g, side));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(side_conditions)
+{
+    GridPtr g(create_grid_cart3d(4, 6, 2));
+    Opm::FlowBCManager bcm;
+    // One pressure condition on Ymin, one flux condition per Zmax face.
+    bcm.reserve(1 + 4*6, 4*2 + 4*6);
+    bcm.pressureSide(*g, Opm::FlowBCManager::Ymin, 1.5);
+    bcm.fluxSide(*g, Opm::FlowBCManager::Zmax, 8.0);
+
+    const FlowBoundaryConditions* bc = bcm.c_bcs();
+    BOOST_REQUIRE_EQUAL(bc->nbc, std::size_t(1 + 4*6));
+    BOOST_REQUIRE_EQUAL(bc->cond_pos[bc->nbc], std::size_t(4*2 + 4*6));
+
+    BOOST_CHECK_EQUAL(bc->type[0], BC_PRESSURE);
+    BOOST_CHECK_EQUAL(bc->value[0], 1.5);
+    const std::vector<int> ymin = sideFacesByTag(*g, Opm::FlowBCManager::Ymin);
+    BOOST_CHECK_EQUAL_COLLECTIONS(bc->face + bc->cond_pos[0], bc->face + bc->cond_pos[1],
+                                  ymin.begin(), ymin.end());
+
+    // Zmax faces all have equal area, so the flux is split evenly.
+    const std::vector<int> zmax = sideFacesByTag(*g, Opm::FlowBCManager::Zmax);
+    BOOST_REQUIRE_EQUAL(zmax.size(), std::size_t(4*6));
+    for (std::size_t i = 0; i < zmax.size(); ++i) {
+        BOOST_CHECK_EQUAL(bc->type[1 + i], BC_FLUX_TOTVOL);
+        BOOST_CHECK_CLOSE(bc->value[1 + i], 8.0/24, 1e-12);
+        BOOST_CHECK_EQUAL(bc->cond_pos[2 + i] - bc->cond_pos[1 + i], std::size_t(1));
+        BOOST_CHECK_EQUAL(bc->face[bc->cond_pos[1 + i]], zmax[i]);
+    }
+
+    // Side faces survive clear().
+    const std::vector<int>* cached = &bcm.sideFaces(*g, Opm::FlowBCManager::Ymin);
+    bcm.clear();
+    BOOST_CHECK_EQUAL(bcm.c_bcs()->nbc, std::size_t(0));
+    BOOST_CHECK(cached == &bcm.sideFaces(*g, Opm::FlowBCManager::Ymin));
+}
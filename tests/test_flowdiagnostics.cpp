@@ -28,6 +28,11 @@
 #define BOOST_TEST_MODULE FlowDiagnosticsTests
 #include <boost/test/unit_test.hpp>
 #include <opm/core/flowdiagnostics/FlowDiagnostics.hpp>
+#include <opm/core/wells.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <tuple>
 
 const std::vector<double> pv(16, 18750.0);
 
@@ -196,3 +201,126 @@ BOOST_AUTO_TEST_CASE(Sweep)
     compareCollections(et.first, Ev);
     compareCollections(et.second, tD);
 }
+
+
+
+
+
+BOOST_AUTO_TEST_CASE(FandPhiBinned)
+{
+    BOOST_CHECK_THROW(computeFandPhiBinned(pv, ftof, wrong_length), std::runtime_error);
+    BOOST_CHECK_THROW(computeFandPhiBinned(pv, ftof, rtof, 0), std::runtime_error);
+
+    // With a bin per distinct travel time the curve is exact.
+    const auto exact = computeFandPhiBinned(pv, ftof, rtof, 100000);
+    BOOST_CHECK_CLOSE(computeLorenz(exact), 1.645920738950826e-01, 1e-8);
+    BOOST_CHECK_SMALL(exact.lorenz_error, 1e-8);
+
+    // With few bins the Lorenz coefficient is within the bound.
+    for (int num_bins = 1; num_bins < 10; ++num_bins) {
+        const auto binned = computeFandPhiBinned(pv, ftof, rtof, num_bins);
+        BOOST_REQUIRE_EQUAL(binned.flowcap.size(), binned.storagecap.size());
+        BOOST_CHECK(binned.flowcap.size() <= std::size_t(num_bins + 1));
+        BOOST_CHECK_CLOSE(binned.flowcap.back(), 1.0, 1e-11);
+        BOOST_CHECK_CLOSE(binned.storagecap.back(), 1.0, 1e-11);
+        const double Lc = computeLorenz(binned);
+        BOOST_CHECK(Lc <= 1.645920738950826e-01 + 1e-12);
+        BOOST_CHECK(Lc + binned.lorenz_error >= 1.645920738950826e-01 - 1e-12);
+        const auto et = computeSweep(binned);
+        BOOST_CHECK_EQUAL(et.first.size(), binned.flowcap.size());
+    }
+}
+
+
+
+
+BOOST_AUTO_TEST_CASE(FandPhiLarge)
+{
+    // Enough cells to sort in parallel, with repeated travel times.
+    const int n = 250000;
+    std::vector<double> lpv(n);
+    std::vector<double> lftof(n);
+    std::vector<double> lrtof(n);
+    for (int c = 0; c < n; ++c) {
+        lpv[c] = 1.0 + (c * 7919LL) % 13;
+        lftof[c] = 1.0 + (c * 104729LL) % 10007;
+        lrtof[c] = 1.0 + (c * 15485863LL) % 997;
+    }
+
+    // Reference: serial sort.
+    std::vector<std::pair<double, double>> time_and_pv(n);
+    for (int c = 0; c < n; ++c) {
+        time_and_pv[c] = std::make_pair(lftof[c] + lrtof[c], lpv[c]);
+    }
+    std::sort(time_and_pv.begin(), time_and_pv.end());
+    std::vector<double> Phi_ref(n + 1, 0.0);
+    for (int c = 0; c < n; ++c) {
+        Phi_ref[c + 1] = Phi_ref[c] + time_and_pv[c].second;
+    }
+    for (int c = 0; c <= n; ++c) {
+        Phi_ref[c] /= Phi_ref[n];
+    }
+
+    const auto FPhi = computeFandPhi(lpv, lftof, lrtof);
+    BOOST_REQUIRE_EQUAL(FPhi.second.size(), Phi_ref.size());
+    BOOST_CHECK(FPhi.second == Phi_ref);
+
+    const double Lc = computeLorenz(FPhi.first, FPhi.second);
+    const auto binned = computeFandPhiBinned(lpv, lftof, lrtof, 200);
+    const double Lc_binned = computeLorenz(binned);
+    BOOST_CHECK(Lc_binned <= Lc + 1e-12);
+    BOOST_CHECK(Lc_binned + binned.lorenz_error >= Lc - 1e-12);
+    BOOST_CHECK(binned.lorenz_error < 0.01);
+}
+
+
+
+
+BOOST_AUTO_TEST_CASE(WellPairsSparse)
+{
+    // Two injectors and three producers on the 16-cell test grid.
+    std::unique_ptr<Wells, void(*)(Wells*)> wells(create_wells(1, 5, 5), destroy_wells);
+    BOOST_REQUIRE(wells);
+    const double comp_frac[] = { 1.0 };
+    const double WI = 1.0;
+    const int cells[] = { 0, 15, 3, 12, 5 };
+    const WellType types[] = { INJECTOR, PRODUCER, INJECTOR, PRODUCER, PRODUCER };
+    const char* names[] = { "I1", "P1", "I2", "P2", "P3" };
+    for (int w = 0; w < 5; ++w) {
+        BOOST_REQUIRE(add_well(types[w], 0.0, 1, comp_frac, &cells[w], &WI, names[w], 1, wells.get()));
+    }
+
+    // Synthetic tracers, some zero, summing to one per cell.
+    const int nc = pv.size();
+    std::vector<double> ftracer(2 * nc, 0.0);
+    std::vector<double> btracer(3 * nc, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        const double a = (c % 5 == 0) ? 0.0 : double(c % 4) / 3.0;
+        ftracer[2*c] = a;
+        ftracer[2*c + 1] = 1.0 - a;
+        const double b = double(c % 3) / 2.0;
+        btracer[3*c + c % 3] = b;
+        btracer[3*c + (c + 1) % 3] = 1.0 - b;
+    }
+
+    const auto dense = computeWellPairs(*wells, pv, ftracer, btracer);
+    const auto sparse = computeWellPairs(*wells, pv,
+                                         compressTracerValues(ftracer, 2),
+                                         compressTracerValues(btracer, 3));
+    BOOST_REQUIRE_EQUAL(dense.size(), 6);
+    BOOST_REQUIRE_EQUAL(sparse.size(), dense.size());
+    double total = 0.0;
+    for (size_t pair = 0; pair < dense.size(); ++pair) {
+        BOOST_CHECK_EQUAL(std::get<0>(sparse[pair]), std::get<0>(dense[pair]));
+        BOOST_CHECK_EQUAL(std::get<1>(sparse[pair]), std::get<1>(dense[pair]));
+        BOOST_CHECK_CLOSE(std::get<2>(sparse[pair]), std::get<2>(dense[pair]), 1e-11);
+        total += std::get<2>(sparse[pair]);
+    }
+    BOOST_CHECK_CLOSE(total, std::accumulate(pv.begin(), pv.end(), 0.0), 1e-11);
+
+    const std::vector<double> short_pv(nc - 1, 1.0);
+    BOOST_CHECK_THROW(computeWellPairs(*wells, short_pv,
+                                       compressTracerValues(ftracer, 2),
+                                       compressTracerValues(btracer, 3)),
+                      std::runtime_error);
+}
@@ -0,0 +1,155 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE FlowDiagnosticsEngineTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <opm/core/flowdiagnostics/FlowDiagnosticsEngine.hpp>
+#include <opm/core/flowdiagnostics/FlowDiagnostics.hpp>
+#include <opm/core/flowdiagnostics/TofReorder.hpp>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/wells.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+    // Flow in the x direction on an nx-by-ny grid, from two injectors
+    // covering the left column to two producers covering the right
+    // column. The lower half of the rows is connected to the first
+    // injector and producer, the upper half to the second ones.
+    struct LineDrive
+    {
+        LineDrive(const UnstructuredGrid& grid, const int nx, const int ny, const double q)
+            : wells(create_wells(1, 4, 2*ny), destroy_wells)
+        {
+            flux.assign(grid.number_of_faces, 0.0);
+            src.assign(grid.number_of_cells, 0.0);
+            for (int f = 0; f < grid.number_of_faces; ++f) {
+                const int c0 = grid.face_cells[2*f + 0];
+                const int c1 = grid.face_cells[2*f + 1];
+                if (c0 >= 0 && c1 >= 0 && grid.face_normals[2*f] != 0.0) {
+                    flux[f] = grid.face_normals[2*f] > 0.0 ? q : -q;
+                }
+            }
+            const double comp_frac[] = { 1.0 };
+            const WellType types[] = { INJECTOR, INJECTOR, PRODUCER, PRODUCER };
+            for (int w = 0; w < 4; ++w) {
+                const int col = (w < 2) ? 0 : nx - 1;
+                const int row_beg = (w % 2 == 0) ? 0 : ny/2;
+                const int row_end = (w % 2 == 0) ? ny/2 : ny;
+                std::vector<int> cells;
+                for (int row = row_beg; row < row_end; ++row) {
+                    const int cell = col + nx*row;
+                    cells.push_back(cell);
+                    src[cell] = (w < 2) ? q : -q;
+                }
+                const std::vector<double> WI(cells.size(), 1.0);
+                const std::string name = "W" + std::to_string(w);
+                BOOST_REQUIRE(add_well(types[w], 0.0, cells.size(), comp_frac, cells.data(),
+                                       WI.data(), name.c_str(), 1, wells.get()));
+            }
+        }
+
+        std::vector<double> flux;
+        std::vector<double> src;
+        std::unique_ptr<Wells, void(*)(Wells*)> wells;
+    };
+}
+
+
+BOOST_AUTO_TEST_CASE(engineMatchesDirectComputation)
+{
+    const int nx = 8;
+    const int ny = 6;
+    const GridManager gm(nx, ny);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+    LineDrive drive(grid, nx, ny, 0.5);
+
+    FlowDiagnosticsEngine engine(grid, pv);
+    BOOST_CHECK_EQUAL(engine.flowFieldVersion(), 0);
+    BOOST_CHECK_THROW(engine.forwardTof(), std::runtime_error);
+
+    engine.setFlowField(drive.flux, drive.src, *drive.wells);
+    BOOST_CHECK_EQUAL(engine.flowFieldVersion(), 1);
+
+    // Time-of-flight increases by pv/q per cell along the rows.
+    const std::vector<double>& ftof = engine.forwardTof();
+    const std::vector<double>& rtof = engine.reverseTof();
+    for (int c = 0; c < grid.number_of_cells; ++c) {
+        const int i = c % nx;
+        BOOST_CHECK_CLOSE(ftof[c], 2.0*(i + 1), 1e-10);
+        BOOST_CHECK_CLOSE(rtof[c], 2.0*(nx - i), 1e-10);
+    }
+
+    // Memoized results are returned without recomputation.
+    BOOST_CHECK(&engine.forwardTof() == &ftof);
+    BOOST_CHECK_EQUAL(engine.forwardSequence().size(), std::size_t(grid.number_of_cells));
+
+    // Same as the direct pipeline.
+    TofReorder solver(grid);
+    std::vector<double> tof;
+    std::vector<double> tracer;
+    SparseTable<int> heads;
+    for (int w = 0; w < 2; ++w) {
+        heads.appendRow(drive.wells->well_cells + drive.wells->well_connpos[w],
+                        drive.wells->well_cells + drive.wells->well_connpos[w + 1]);
+    }
+    solver.solveTofTracer(drive.flux.data(), pv.data(), drive.src.data(), heads, tof, tracer);
+    BOOST_CHECK(tof == engine.forwardTof());
+    BOOST_CHECK(tracer == engine.forwardTracer());
+    const auto fphi = computeFandPhi(pv, ftof, rtof);
+    BOOST_CHECK(fphi == engine.fandPhi());
+    BOOST_CHECK_EQUAL(computeLorenz(fphi.first, fphi.second), engine.lorenz());
+    BOOST_CHECK(computeSweep(fphi.first, fphi.second) == engine.sweep());
+
+    // Each injector only supports the producer in the same rows.
+    const auto& pairs = engine.wellPairs();
+    BOOST_REQUIRE_EQUAL(pairs.size(), 4);
+    for (const auto& pair : pairs) {
+        const bool same_rows = (std::get<0>(pair) % 2) == (std::get<1>(pair) % 2);
+        BOOST_CHECK_CLOSE(std::get<2>(pair) + 1.0, (same_rows ? nx*ny/2 : 0.0) + 1.0, 1e-10);
+    }
+
+    // A new flow field invalidates the cached results.
+    LineDrive faster(grid, nx, ny, 1.0);
+    engine.setFlowField(faster.flux, faster.src, *faster.wells);
+    BOOST_CHECK_EQUAL(engine.flowFieldVersion(), 2);
+    for (int c = 0; c < grid.number_of_cells; ++c) {
+        BOOST_CHECK_CLOSE(engine.forwardTof()[c], double(c % nx + 1), 1e-10);
+    }
+    BOOST_CHECK_CLOSE(engine.lorenz() + 1.0, 1.0, 1e-10);
+}
@@ -0,0 +1,118 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE FluidStateBatchTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/simulator/ExplicitArraysFluidStateBatch.hpp>
+#include <opm/core/simulator/ExplicitArraysFluidState.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // Water and oil, no gas.
+    Opm::PhaseUsage waterOil()
+    {
+        Opm::PhaseUsage pu;
+        pu.num_phases = 2;
+        pu.phase_used[Opm::BlackoilPhases::Aqua]   = 1;
+        pu.phase_used[Opm::BlackoilPhases::Liquid] = 1;
+        pu.phase_used[Opm::BlackoilPhases::Vapour] = 0;
+        pu.phase_pos[Opm::BlackoilPhases::Aqua]    = 0;
+        pu.phase_pos[Opm::BlackoilPhases::Liquid]  = 1;
+        pu.phase_pos[Opm::BlackoilPhases::Vapour]  = -1;
+        return pu;
+    }
+
+    std::vector<double> saturations(const int n)
+    {
+        std::vector<double> s(2*n);
+        for (int i = 0; i < n; ++i) {
+            s[2*i + 0] = 0.05 * i;
+            s[2*i + 1] = 1.0 - s[2*i + 0];
+        }
+        return s;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(GatherMatchesCursor)
+{
+    typedef Opm::ExplicitArraysFluidStateBatch<4> Batch;
+
+    const Opm::PhaseUsage pu = waterOil();
+    const int n = 10;
+    const std::vector<double> s = saturations(n);
+
+    Batch batch(pu);
+    batch.setSaturationArray(s.data());
+    Opm::ExplicitArraysFluidState cursor(pu);
+    cursor.setSaturationArray(s.data());
+
+    for (int begin = 0; begin < n; begin += Batch::batchSize) {
+        const int count = std::min(int(Batch::batchSize), n - begin);
+        batch.gather(begin, count);
+        BOOST_REQUIRE_EQUAL(batch.size(), count);
+
+        for (int l = 0; l < count; ++l) {
+            BOOST_CHECK_EQUAL(batch.index(l), begin + l);
+            cursor.setIndex(begin + l);
+            const Batch::Lane<double> lane = batch.lane<double>(l);
+            for (int p = 0; p < Opm::BlackoilPhases::MaxNumPhases; ++p) {
+                BOOST_CHECK_EQUAL(lane.saturation(p), cursor.saturation(p));
+                BOOST_CHECK_EQUAL(batch.saturations(p)[l], cursor.saturation(p));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(GatherInOrder)
+{
+    typedef Opm::ExplicitArraysFluidStateBatch<> Batch;
+
+    const Opm::PhaseUsage pu = waterOil();
+    const int n = 12;
+    const std::vector<double> s = saturations(n);
+    const int order[] = { 11, 3, 7, 0, 5 };
+
+    Batch batch(pu);
+    batch.setSaturationArray(s.data());
+    batch.gather(1, 3, order);
+
+    BOOST_REQUIRE_EQUAL(batch.size(), 3);
+    for (int l = 0; l < 3; ++l) {
+        const int i = order[1 + l];
+        BOOST_CHECK_EQUAL(batch.index(l), i);
+        BOOST_CHECK_EQUAL(batch.saturations(Opm::BlackoilPhases::Aqua)[l],   s[2*i + 0]);
+        BOOST_CHECK_EQUAL(batch.saturations(Opm::BlackoilPhases::Liquid)[l], s[2*i + 1]);
+        BOOST_CHECK_EQUAL(batch.saturations(Opm::BlackoilPhases::Vapour)[l], 0.0);
+    }
+}
@@ -0,0 +1,172 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE GatherOutputWriterTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/GatherOutputWriter.hpp>
+#include <opm/common/data/SimulationDataContainer.hpp>
+#include <opm/core/simulator/WellState.hpp>
+
+#include <memory>
+#include <vector>
+
+struct MPIFixture {
+    MPIFixture()
+    {
+        int m_argc = boost::unit_test::framework::master_test_suite().argc;
+        char** m_argv = boost::unit_test::framework::master_test_suite().argv;
+        MPI_Init(&m_argc, &m_argv);
+    }
+    ~MPIFixture()
+    {
+        MPI_Finalize();
+    }
+};
+
+BOOST_GLOBAL_FIXTURE(MPIFixture);
+
+namespace {
+
+struct StepTimer : public Opm::SimulatorTimerInterface {
+    explicit StepTimer (const int step) : step_ (step) { }
+    int currentStepNum () const { return step_; }
+    double currentStepLength () const { return 1.0; }
+    double stepLengthTaken () const { return 1.0; }
+    double simulationTimeElapsed () const { return step_; }
+    void advance () { ++step_; }
+    bool done () const { return false; }
+    boost::posix_time::ptime startDateTime () const {
+        return boost::posix_time::ptime (boost::gregorian::date (2016, 1, 1));
+    }
+    std::unique_ptr <Opm::SimulatorTimerInterface> clone () const {
+        return std::unique_ptr <Opm::SimulatorTimerInterface> (new StepTimer (*this));
+    }
+private:
+    int step_;
+};
+
+struct Written {
+    int step;
+    std::vector <double> pressure;
+    std::vector <double> saturation;
+};
+
+struct RecordingWriter : public Opm::OutputWriter {
+    explicit RecordingWriter (std::vector <Written>& written) : written_ (written) { }
+    void writeInit (const Opm::SimulatorTimerInterface&) { }
+    void writeTimeStep (const Opm::SimulatorTimerInterface& timer,
+                        const Opm::SimulationDataContainer& state,
+                        const Opm::WellState&,
+                        bool) {
+        written_.push_back (Written { timer.currentStepNum (),
+                                      state.pressure (),
+                                      state.getCellData ("SATURATION") });
+    }
+private:
+    std::vector <Written>& written_;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (GatherInGlobalOrder)
+{
+    int rank = 0;
+    int size = 1;
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+
+    // process r owns the global cells r, r + size, ..., numbered in
+    // reverse locally, and has one more cell owned by another process
+    const int numGlobalCells = 3*size + 1;
+    std::vector <int> ownedGlobal;
+    for (int cell = rank; cell < numGlobalCells; cell += size) {
+        ownedGlobal.insert (ownedGlobal.begin (), cell);
+    }
+    const int numOwned = static_cast <int> (ownedGlobal.size ());
+    std::vector <int> ownedLocal;
+    for (int i = 0; i < numOwned; ++i) {
+        ownedLocal.push_back (i);
+    }
+
+    std::vector <Written> written;
+    std::unique_ptr <Opm::OutputWriter> recorder (new RecordingWriter (written));
+    Opm::GatherOutputWriter writer (std::move (recorder), ownedLocal, ownedGlobal,
+                                    numGlobalCells, MPI_COMM_WORLD);
+
+    Opm::SimulationDataContainer state (numOwned + 1, 0, 2);
+    Opm::WellState wellState;
+    for (int step = 1; step <= 2; ++step) {
+        for (int i = 0; i < numOwned; ++i) {
+            state.pressure ()[i] = 10.0*step + ownedGlobal[i];
+            state.getCellData ("SATURATION")[2*i] = ownedGlobal[i];
+            state.getCellData ("SATURATION")[2*i + 1] = -ownedGlobal[i];
+        }
+        state.pressure ()[numOwned] = -1.0;
+        writer.writeTimeStep (StepTimer (step), state, wellState, false);
+    }
+
+    // each step is written when the next one is started
+    if (writer.isWriter ()) {
+        BOOST_CHECK_EQUAL (written.size (), 1u);
+    }
+    writer.flush ();
+    if (writer.isWriter ()) {
+        BOOST_REQUIRE_EQUAL (written.size (), 2u);
+        for (int step = 1; step <= 2; ++step) {
+            const Written& w = written[step - 1];
+            BOOST_CHECK_EQUAL (w.step, step);
+            BOOST_REQUIRE_EQUAL (w.pressure.size (), std::size_t (numGlobalCells));
+            BOOST_REQUIRE_EQUAL (w.saturation.size (), std::size_t (2*numGlobalCells));
+            for (int cell = 0; cell < numGlobalCells; ++cell) {
+                BOOST_CHECK_EQUAL (w.pressure[cell], 10.0*step + cell);
+                BOOST_CHECK_EQUAL (w.saturation[2*cell], cell);
+                BOOST_CHECK_EQUAL (w.saturation[2*cell + 1], -cell);
+            }
+        }
+    }
+    else {
+        BOOST_CHECK (written.empty ());
+    }
+}
+
+BOOST_AUTO_TEST_CASE (InvalidOwnership)
+{
+    int size = 1;
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    if (size != 1) {
+        return;
+    }
+    std::vector <Written> written;
+    std::unique_ptr <Opm::OutputWriter> recorder (new RecordingWriter (written));
+    const std::vector <int> local = { 0, 1 };
+    const std::vector <int> global = { 1, 1 };
+    BOOST_CHECK_THROW (Opm::GatherOutputWriter (std::move (recorder), local, global,
+                                                2, MPI_COMM_WORLD),
+                       std::invalid_argument);
+}
@@ -0,0 +1,135 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE GrdeclIndexTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/eclipse/GrdeclIndex.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char* const FILENAME = "test_grdeclindex.grdecl";
+
+void writeFile () {
+    std::ofstream os (FILENAME);
+    os << "-- a comment\n"
+       << "NOECHO\n"
+       << "SPECGRID\n 3 2 1 1 F /\n\n"
+       << "COORD\n";
+    for (int i = 0; i < 20000; ++i) {
+        os << 0.5*i << ((i % 7 == 0) ? '\n' : ' ');
+    }
+    os << "/\n"
+       << "ZCORN\n 5000*1.5 2*2.0D0 -- repeated\n 3 4 1000*7 /\n"
+       << "ACTNUM\n 'x' 4*1 /\n"
+       << "ECHO\n";
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (Keywords)
+{
+    writeFile ();
+    const Opm::GrdeclIndex index (FILENAME);
+
+    BOOST_CHECK (index.hasKeyword ("NOECHO"));
+    BOOST_CHECK (index.hasKeyword ("ECHO"));
+    BOOST_CHECK (!index.hasKeyword ("PORO"));
+    BOOST_CHECK_EQUAL (index.size ("SPECGRID"), 5u);
+    BOOST_CHECK_EQUAL (index.size ("COORD"), 20000u);
+    BOOST_CHECK_EQUAL (index.size ("ZCORN"), 6004u);
+    BOOST_CHECK_THROW (index.size ("PORO"), std::runtime_error);
+
+    const std::vector <double> dims = index.read ("SPECGRID", 0, 3);
+    BOOST_REQUIRE_EQUAL (dims.size (), 3u);
+    BOOST_CHECK_EQUAL (dims[0], 3.0);
+    BOOST_CHECK_EQUAL (dims[1], 2.0);
+    BOOST_CHECK_EQUAL (dims[2], 1.0);
+
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (Ranges)
+{
+    writeFile ();
+    const Opm::GrdeclIndex index (FILENAME);
+
+    // ranges across recorded positions and a skipped gap
+    const std::vector <double> coord =
+        index.read ("COORD", { { 5, 7 }, { 8191, 8194 }, { 19998, 20000 } });
+    const double expected[] = { 2.5, 3.0, 4095.5, 4096.0, 4096.5, 9999.0, 9999.5 };
+    BOOST_CHECK_EQUAL_COLLECTIONS (coord.begin (), coord.end (), expected, expected + 7);
+
+    // ranges starting inside and ending inside repeated values
+    const std::vector <double> zcorn =
+        index.read ("ZCORN", { { 4999, 5001 }, { 5001, 5004 }, { 6003, 6004 } });
+    const double expectedZ[] = { 1.5, 2.0, 2.0, 3.0, 4.0, 7.0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS (zcorn.begin (), zcorn.end (), expectedZ, expectedZ + 6);
+
+    BOOST_CHECK_THROW (index.read ("ZCORN", 6000, 6005), std::runtime_error);
+    BOOST_CHECK_THROW (index.read ("ZCORN", { { 10, 20 }, { 5, 8 } }), std::runtime_error);
+    BOOST_CHECK_THROW (index.read ("ACTNUM", 0, 1), std::runtime_error);
+    BOOST_CHECK_EQUAL (index.read ("ACTNUM", 1, 5)[3], 1.0);
+
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (Scan)
+{
+    writeFile ();
+    const Opm::GrdeclIndex index (FILENAME);
+
+    std::size_t count = 0;
+    double sum = 0.0;
+    index.scan ("COORD", [&] (std::size_t first, const double* values, std::size_t n) {
+            BOOST_CHECK_EQUAL (first, count);
+            for (std::size_t i = 0; i < n; ++i) {
+                sum += values[i];
+            }
+            count += n;
+        });
+    BOOST_CHECK_EQUAL (count, 20000u);
+    BOOST_CHECK_EQUAL (sum, 0.5*20000.0*19999.0/2.0);
+
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (Unterminated)
+{
+    {
+        std::ofstream os (FILENAME);
+        os << "PORO\n 0.1 0.2\n";
+    }
+    BOOST_CHECK_THROW (Opm::GrdeclIndex index (FILENAME), std::runtime_error);
+    std::remove (FILENAME);
+}
@@ -31,6 +31,9 @@
 #include <opm/core/grid/GridUtilities.hpp>
 #include <opm/core/grid/GridManager.hpp>
 
+#include <algorithm>
+#include <memory>
+
 using namespace Opm;
 
 BOOST_AUTO_TEST_CASE(cartesian_2d_cellNeighboursAcrossVertices)
@@ -79,3 +82,87 @@ BOOST_AUTO_TEST_CASE(cartesian_2d_orderCounterClockwise)
         BOOST_CHECK_EQUAL_COLLECTIONS(vnb[c].begin(), vnb[c].end(), truth[c].begin(), truth[c].end());
     }
 }
+
+BOOST_AUTO_TEST_CASE(cartesian_3d_reorderGrid)
+{
+    const GridManager gm(4, 3, 2);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const int nc = grid.number_of_cells;
+    const int nf = grid.number_of_faces;
+
+    const CellOrdering orderings[] = { ReverseCuthillMcKeeOrdering, HilbertCurveOrdering };
+    for (const CellOrdering ordering : orderings) {
+        GridPermutation perm;
+        UnstructuredGrid* g = reorderGrid(grid, ordering, perm);
+        BOOST_REQUIRE(g != 0);
+        BOOST_REQUIRE_EQUAL(g->number_of_cells, nc);
+        BOOST_REQUIRE_EQUAL(g->number_of_faces, nf);
+        BOOST_REQUIRE_EQUAL(int(perm.cell_new_to_old.size()), nc);
+        BOOST_REQUIRE_EQUAL(int(perm.face_new_to_old.size()), nf);
+
+        for (int c = 0; c < nc; ++c) {
+            const int oc = perm.cell_new_to_old[c];
+            BOOST_CHECK_EQUAL(perm.cell_old_to_new[oc], c);
+            BOOST_CHECK_EQUAL(g->global_cell[c], oc);
+            BOOST_CHECK_EQUAL(g->cell_volumes[c], grid.cell_volumes[oc]);
+            BOOST_CHECK_EQUAL(g->cell_facepos[c + 1] - g->cell_facepos[c],
+                              grid.cell_facepos[oc + 1] - grid.cell_facepos[oc]);
+            // Each face of a cell has that cell as a neighbour.
+            for (int hf = g->cell_facepos[c]; hf < g->cell_facepos[c + 1]; ++hf) {
+                const int f = g->cell_faces[hf];
+                BOOST_CHECK(g->face_cells[2*f] == c || g->face_cells[2*f + 1] == c);
+            }
+        }
+        for (int f = 0; f < nf; ++f) {
+            const int of = perm.face_new_to_old[f];
+            BOOST_CHECK_EQUAL(perm.face_old_to_new[of], f);
+            BOOST_CHECK_EQUAL(g->face_areas[f], grid.face_areas[of]);
+            for (int k = 0; k < 2; ++k) {
+                const int oc = grid.face_cells[2*of + k];
+                BOOST_CHECK_EQUAL(g->face_cells[2*f + k], oc < 0 ? oc : perm.cell_old_to_new[oc]);
+            }
+        }
+
+        std::vector<int> newIndex(nc);
+        for (int c = 0; c < nc; ++c) {
+            newIndex[c] = c;
+        }
+        const std::vector<int> restored = restoreCellOrder(perm, newIndex);
+        BOOST_CHECK_EQUAL_COLLECTIONS(restored.begin(), restored.end(),
+                                      perm.cell_old_to_new.begin(), perm.cell_old_to_new.end());
+        const std::vector<int> back = applyCellOrder(perm, restored);
+        BOOST_CHECK_EQUAL_COLLECTIONS(back.begin(), back.end(), newIndex.begin(), newIndex.end());
+
+        destroy_grid(g);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cartesian_3d_computeGridConnectivity)
+{
+    const GridManager gm(3, 2, 2);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const std::shared_ptr<const GridConnectivity> conn = computeGridConnectivity(grid);
+
+    BOOST_CHECK(conn->cell_vertex_neighbours == cellNeighboursAcrossVertices(grid));
+
+    BOOST_REQUIRE_EQUAL(int(conn->cell_face_neighbours.size()), grid.number_of_cells);
+    const int fnb[3] = { 1, 3, 6 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(conn->cell_face_neighbours[0].begin(),
+                                  conn->cell_face_neighbours[0].end(), fnb, fnb + 3);
+
+    BOOST_REQUIRE_EQUAL(int(conn->cell_nodes.size()), grid.number_of_cells);
+    BOOST_REQUIRE_EQUAL(int(conn->node_cells.size()), grid.number_of_nodes);
+    for (int c = 0; c < grid.number_of_cells; ++c) {
+        BOOST_CHECK_EQUAL(int(conn->cell_nodes[c].size()), 8);
+        for (const int node : conn->cell_nodes[c]) {
+            const auto cells = conn->node_cells[node];
+            BOOST_CHECK(std::find(cells.begin(), cells.end(), c) != cells.end());
+        }
+    }
+    // The interior node at logical position (1, 1, 1) is shared by
+    // all eight cells (i, j, k) with i, j, k in {0, 1}.
+    const int node = 1 + 4*1 + 4*3*1;
+    const int ncells[8] = { 0, 1, 3, 4, 6, 7, 9, 10 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(conn->node_cells[node].begin(), conn->node_cells[node].end(),
+                                  ncells, ncells + 8);
+}
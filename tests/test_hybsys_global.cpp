@@ -0,0 +1,69 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE HybsysGlobalTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+#include <opm/core/pressure/mimetic/hybsys_global.h>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (coloring_cartesian)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(5, 4, 3, 1., 1., 1.);
+    struct hybsys_coloring *col = hybsys_define_coloring(g);
+    BOOST_REQUIRE (col != NULL);
+
+    // Cartesian grids are bipartite.
+    BOOST_CHECK_EQUAL (col->ncolors, 2);
+    BOOST_CHECK_EQUAL (col->colpos[col->ncolors], g->number_of_cells);
+
+    std::vector<int> color(g->number_of_cells, -1);
+    for (int k = 0; k < col->ncolors; ++k) {
+        for (int i = col->colpos[k]; i < col->colpos[k + 1]; ++i) {
+            BOOST_REQUIRE_EQUAL (color[col->cells[i]], -1);
+            color[col->cells[i]] = k;
+        }
+    }
+    for (int f = 0; f < g->number_of_faces; ++f) {
+        const int c1 = g->face_cells[2*f + 0];
+        const int c2 = g->face_cells[2*f + 1];
+        if ((c1 >= 0) && (c2 >= 0)) {
+            BOOST_CHECK_NE (color[c1], color[c2]);
+        }
+    }
+
+    hybsys_coloring_destroy(col);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
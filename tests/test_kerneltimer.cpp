@@ -0,0 +1,100 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE KernelTimerTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/utility/KernelTimer.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using Opm::time::KernelTimer;
+using Opm::time::ScopedKernelTimer;
+
+namespace
+{
+    KernelTimer every_call("every call", 1);
+    KernelTimer sampled("sampled kernel", 8);
+
+    void kernel(KernelTimer& timer, unsigned& countdown)
+    {
+        ScopedKernelTimer t(timer, countdown);
+    }
+
+    void calls(const int n)
+    {
+        unsigned countdown_all = 1;
+        unsigned countdown_sampled = 1;
+        for (int i = 0; i < n; ++i) {
+            kernel(every_call, countdown_all);
+            kernel(sampled, countdown_sampled);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Sampling)
+{
+    KernelTimer::reset();
+    calls(40);
+    BOOST_CHECK_EQUAL(every_call.timedCalls(), 40u);
+    // calls 1, 9, 17, 25 and 33
+    BOOST_CHECK_EQUAL(sampled.timedCalls(), 5u);
+    BOOST_CHECK(every_call.timedSeconds() >= 0.0);
+
+    std::ostringstream os;
+    KernelTimer::report(os);
+    const std::string report = os.str();
+    BOOST_CHECK(report.find("every call") != std::string::npos);
+    BOOST_CHECK(report.find("sampled kernel") != std::string::npos);
+    BOOST_CHECK(report.find("1/8") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Reset)
+{
+    calls(10);
+    KernelTimer::reset();
+    BOOST_CHECK_EQUAL(every_call.timedCalls(), 0u);
+    BOOST_CHECK_EQUAL(sampled.timedSeconds(), 0.0);
+
+    // timers without timed calls are not reported
+    std::ostringstream os;
+    KernelTimer::report(os);
+    BOOST_CHECK(os.str().find("every call") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Threads)
+{
+    KernelTimer::reset();
+    std::thread worker(calls, 16);
+    calls(16);
+    worker.join();
+    BOOST_CHECK_EQUAL(every_call.timedCalls(), 32u);
+    BOOST_CHECK_EQUAL(sampled.timedCalls(), 4u);
+}
@@ -124,6 +124,74 @@ void run_test(const Opm::parameter::ParameterGroup& param)
 }
 
 
+// Block system with 2x2 blocks A_ij = L_ij * B (+ I on the diagonal),
+// where L is the 2D Laplacian.
+void run_block_test(const Opm::parameter::ParameterGroup& param)
+{
+    const int N = 8;
+    const int bs = 2;
+    auto mat = createLaplacian(N);
+    const double B[bs*bs] = { 1.0, 0.1, 0.3, 0.5 };
+    std::vector<double> sa(mat->data.size()*bs*bs);
+    for (int row = 0; row < N*N; ++row) {
+        for (int i = mat->rowStart[row]; i < mat->rowStart[row+1]; ++i) {
+            for (int k = 0; k < bs*bs; ++k) {
+                sa[i*bs*bs + k] = mat->data[i]*B[k];
+            }
+            if (mat->colIndex[i] == row) {
+                sa[i*bs*bs + 0] += 1.0;
+                sa[i*bs*bs + 3] += 1.0;
+            }
+        }
+    }
+    std::vector<double> exact(N*N*bs), b(N*N*bs, 0.0), x(N*N*bs, 0.0);
+    for (int i = 0; i < N*N*bs; ++i) {
+        exact[i] = ((double) (rand()%100))/10.0;
+    }
+    for (int row = 0; row < N*N; ++row) {
+        for (int i = mat->rowStart[row]; i < mat->rowStart[row+1]; ++i) {
+            const int col = mat->colIndex[i];
+            for (int r = 0; r < bs; ++r) {
+                for (int c = 0; c < bs; ++c) {
+                    b[row*bs + r] += sa[i*bs*bs + r*bs + c]*exact[col*bs + c];
+                }
+            }
+        }
+    }
+    Opm::LinearSolverFactory ls(param);
+    auto rep = ls.solveBlock(N*N, bs, mat->data.size(), &(mat->rowStart[0]),
+                             &(mat->colIndex[0]), &sa[0], &b[0], &x[0]);
+    BOOST_CHECK(rep.converged);
+    for (int i = 0; i < N*N*bs; ++i) {
+        BOOST_CHECK_CLOSE(x[i], exact[i], 1e-4);
+    }
+}
+
+
+// Several right hand sides for the same matrix.
+void run_multiple_test(const Opm::parameter::ParameterGroup& param)
+{
+    const int N = 8;
+    const int nrhs = 3;
+    auto mat = createLaplacian(N);
+    std::vector<double> exact, b, x(nrhs*N*N, 0.0);
+    for (int k = 0; k < nrhs; ++k) {
+        std::vector<double> xk, bk;
+        createRandomVectors(N*N, xk, bk, *mat);
+        exact.insert(exact.end(), xk.begin(), xk.end());
+        b.insert(b.end(), bk.begin(), bk.end());
+    }
+    Opm::LinearSolverFactory ls(param);
+    auto rep = ls.solveMultiple(N*N, mat->data.size(), &(mat->rowStart[0]),
+                                &(mat->colIndex[0]), &(mat->data[0]), nrhs,
+                                &b[0], &x[0]);
+    BOOST_CHECK(rep.converged);
+    for (int i = 0; i < nrhs*N*N; ++i) {
+        BOOST_CHECK_SMALL(x[i] - exact[i], 1e-5);
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE(DefaultTest)
 {
     Opm::parameter::ParameterGroup param;
@@ -132,6 +200,23 @@ BOOST_AUTO_TEST_CASE(DefaultTest)
     run_test(param);
 }
 
+BOOST_AUTO_TEST_CASE(DefaultMultipleTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    run_multiple_test(param);
+}
+
+BOOST_AUTO_TEST_CASE(AutoMultipleTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("auto"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    run_multiple_test(param);
+}
+
 #ifdef HAVE_DUNE_ISTL
 BOOST_AUTO_TEST_CASE(CGAMGTest)
 {
@@ -143,6 +228,48 @@ BOOST_AUTO_TEST_CASE(CGAMGTest)
     run_test(param);
 }
 
+// Upwind transport system on an N x N grid: each cell depends on the
+// neighbours with higher (random) potential, and the entries of the
+// downwind neighbours are stored as zeros.  A permutation of a
+// triangular matrix, but not triangular in the natural order.
+void run_upwind_test(const Opm::parameter::ParameterGroup& param)
+{
+    const int N = 8;
+    auto mat = createLaplacian(N);
+    std::vector<double> phi(N*N);
+    for (int i = 0; i < N*N; ++i) {
+        phi[i] = rand();
+    }
+    for (int row = 0; row < N*N; ++row) {
+        int diag = -1;
+        double sum = 1.0;
+        for (int i = mat->rowStart[row]; i < mat->rowStart[row+1]; ++i) {
+            const int col = mat->colIndex[i];
+            if (col == row) {
+                diag = i;
+            } else if (phi[col] > phi[row]) {
+                mat->data[i] = -2.0;
+                sum += 2.0;
+            } else {
+                mat->data[i] = 0.0;
+            }
+        }
+        mat->data[diag] = sum;
+    }
+    std::vector<double> exact, b, x(N*N, 0.0);
+    createRandomVectors(N*N, exact, b, *mat);
+    Opm::LinearSolverFactory ls(param);
+    auto rep = ls.solve(N*N, mat->data.size(), &(mat->rowStart[0]),
+                        &(mat->colIndex[0]), &(mat->data[0]), &b[0], &x[0]);
+    BOOST_CHECK(rep.converged);
+    // ILU0 in upwind order is exact.
+    BOOST_CHECK_LE(rep.iterations, 1);
+    for (int i = 0; i < N*N; ++i) {
+        BOOST_CHECK_SMALL(x[i] - exact[i], 1e-6);
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE(CGILUTest)
 {
     Opm::parameter::ParameterGroup param;
@@ -163,6 +290,74 @@ BOOST_AUTO_TEST_CASE(BiCGILUTest)
     run_test(param);
 }
 
+BOOST_AUTO_TEST_CASE(UpwindOrderedBiCGILUTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_type"), std::string("2"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    param.insertParameter(std::string("linsolver_ilu_ordering"), std::string("upwind"));
+    run_upwind_test(param);
+}
+
+BOOST_AUTO_TEST_CASE(CGAMGMultipleTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_type"), std::string("1"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    run_multiple_test(param);
+}
+
+BOOST_AUTO_TEST_CASE(SinglePrecisionAMGTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_type"), std::string("1"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_single_precision_preconditioner"), std::string("true"));
+    run_test(param);
+}
+
+BOOST_AUTO_TEST_CASE(SinglePrecisionBiCGILUTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_type"), std::string("2"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_single_precision_preconditioner"), std::string("true"));
+    run_test(param);
+}
+
+BOOST_AUTO_TEST_CASE(RecyclingCGTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    param.insertParameter(std::string("linsolver_recycle_vectors"), std::string("4"));
+    param.insertParameter(std::string("linsolver_type"), std::string("0"));
+    run_multiple_test(param);
+    param.insertParameter(std::string("linsolver_type"), std::string("1"));
+    run_multiple_test(param);
+    param.insertParameter(std::string("linsolver_reuse_setup"), std::string("4"));
+    run_multiple_test(param);
+}
+
+BOOST_AUTO_TEST_CASE(CPRTest)
+{
+    Opm::parameter::ParameterGroup param;
+    param.insertParameter(std::string("linsolver"), std::string("istl"));
+    param.insertParameter(std::string("linsolver_type"), std::string("5"));
+    param.insertParameter(std::string("linsolver_max_iterations"), std::string("200"));
+    param.insertParameter(std::string("linsolver_residual_tolerance"), std::string("1e-12"));
+    run_block_test(param);
+    param.insertParameter(std::string("cpr_weights"), std::string("true_impes"));
+    run_block_test(param);
+}
+
 #if defined(HAS_DUNE_FAST_AMG) || DUNE_VERSION_NEWER(DUNE_ISTL, 2, 3)
 BOOST_AUTO_TEST_CASE(FastAMGTest)
 {
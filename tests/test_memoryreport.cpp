@@ -0,0 +1,111 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE MemoryReportTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/utility/MemoryReport.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/wells.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Opm::MemoryReport;
+
+BOOST_AUTO_TEST_CASE(TreeSums)
+{
+    MemoryReport report;
+    MemoryReport& pressure = report.child("pressure");
+    pressure.add("matrix", 3*1024*1024);
+    pressure.add("work arrays", 1024*1024);
+    report.add("wells", 4*1024*1024);
+    pressure.add("matrix", 1024*1024);
+
+    BOOST_CHECK_EQUAL(report.numChildren(), 2);
+    BOOST_CHECK_EQUAL(pressure.numChildren(), 2);
+    BOOST_CHECK_EQUAL(pressure.childAt(0).name(), "matrix");
+    BOOST_CHECK_EQUAL(pressure.childAt(0).bytes(), std::size_t(4*1024*1024));
+    BOOST_CHECK_EQUAL(pressure.bytes(), std::size_t(5*1024*1024));
+    BOOST_CHECK_EQUAL(report.bytes(), std::size_t(9*1024*1024));
+
+    std::ostringstream os;
+    report.print(os);
+    const std::string out = os.str();
+    BOOST_CHECK(out.find("total") != std::string::npos);
+    BOOST_CHECK(out.find("\n  pressure") != std::string::npos);
+    BOOST_CHECK(out.find("\n    matrix") != std::string::npos);
+    BOOST_CHECK(out.find("9.000") != std::string::npos);
+    BOOST_CHECK(out.find("80.0%") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(VectorCapacity)
+{
+    std::vector<double> v;
+    v.reserve(100);
+    v.resize(10);
+    BOOST_CHECK_EQUAL(MemoryReport::bytes(v), v.capacity()*sizeof(double));
+}
+
+BOOST_AUTO_TEST_CASE(CStructures)
+{
+    struct UnstructuredGrid* G = create_grid_cart3d(4, 3, 2);
+    BOOST_REQUIRE(G != 0);
+
+    std::size_t topology = 0, geometry = 0;
+    grid_memory(G, &topology, &geometry);
+    const std::size_t nf = G->number_of_faces;
+    const std::size_t nc = G->number_of_cells;
+    // face_cells alone, and face areas plus cell volumes
+    BOOST_CHECK(topology >= 2*nf*sizeof(int));
+    BOOST_CHECK(geometry >= (nf + nc)*sizeof(double));
+
+    struct CSRMatrix* A = csrmatrix_new_known_nnz(5, 13);
+    BOOST_REQUIRE(A != 0);
+    BOOST_CHECK_EQUAL(csrmatrix_memory(A),
+                      sizeof *A + 6*sizeof(int) + 13*(sizeof(int) + sizeof(double)));
+    csrmatrix_delete(A);
+
+    struct Wells* W = create_wells(2, 2, 4);
+    BOOST_REQUIRE(W != 0);
+    const std::size_t empty = wells_memory(W);
+    const int cells[] = { 0, 5 };
+    const double WI[] = { 1.0, 1.0 };
+    const double comp_frac[] = { 1.0, 0.0 };
+    BOOST_REQUIRE(add_well(INJECTOR, 0.0, 2, comp_frac, cells, WI, "INJ", true, W));
+    BOOST_REQUIRE(append_well_controls(BHP, 1e7, -1e100, -1, NULL, 0, W));
+    BOOST_CHECK(wells_memory(W) > empty);
+    destroy_wells(W);
+
+    destroy_grid(G);
+}
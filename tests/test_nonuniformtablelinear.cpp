@@ -89,3 +89,42 @@ BOOST_AUTO_TEST_CASE(table_operations)
     BOOST_CHECK_EQUAL(t1(0.0), 3.0);
     BOOST_CHECK(std::fabs(t1.derivative(0.0)  + 1.0/20.0) < 1e-11);
 }
+
+BOOST_AUTO_TEST_CASE(hinted_lookup)
+{
+    double xva[] = { -1.0, 2.0, 2.2, 3.0, 5.0 };
+    const int numvals = sizeof(xva)/sizeof(xva[0]);
+    std::vector<double> xv(xva, xva + numvals);
+    double yva[numvals] = { 1.0, 2.0, 3.0, 4.0, 2.0 };
+    std::vector<double> yv(yva, yva + numvals);
+    Opm::NonuniformTableLinear<double> t1(xv, yv);
+
+    // Hinted index must agree with the binary search for any hint,
+    // also for descending tables.
+    std::vector<double> xdesc(xv.rbegin(), xv.rend());
+    for (double x = -3.0; x <= 7.0; x += 0.05) {
+        for (int hint = -2; hint <= numvals + 1; ++hint) {
+            BOOST_CHECK_EQUAL(Opm::tableIndex(xv, x, hint), Opm::tableIndex(xv, x));
+            BOOST_CHECK_EQUAL(Opm::tableIndex(xdesc, x, hint), Opm::tableIndex(xdesc, x));
+        }
+    }
+    for (int i = 0; i < numvals; ++i) {
+        BOOST_CHECK_EQUAL(Opm::tableIndex(xv, xv[i], 0), Opm::tableIndex(xv, xv[i]));
+    }
+
+    // Bulk evaluation with per-point hints.
+    const int n = 41;
+    std::vector<double> x(n), f(n), dfdx(n);
+    std::vector<int> hints(n, -1);
+    for (int i = 0; i < n; ++i) {
+        x[i] = -2.0 + 0.2*i;
+    }
+    t1.evaluate(n, &x[0], &hints[0], &f[0], &dfdx[0]);
+    for (int i = 0; i < n; ++i) {
+        BOOST_CHECK_CLOSE(f[i], t1(x[i]), 1e-12);
+        BOOST_CHECK_CLOSE(dfdx[i], t1.derivative(x[i]), 1e-12);
+        int hint = hints[i];
+        BOOST_CHECK_CLOSE(t1(x[i], hint), t1(x[i]), 1e-12);
+        BOOST_CHECK_EQUAL(hint, hints[i]);
+    }
+}
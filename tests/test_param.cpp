@@ -44,6 +44,7 @@
 #define BOOST_TEST_MODULE ParameterTest
 #include <boost/test/unit_test.hpp>
 
+#include <opm/core/utility/parameters/FrozenParameterGroup.hpp>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <cstddef>
 #include <sstream>
@@ -122,3 +123,44 @@ BOOST_AUTO_TEST_CASE(failing_strict_xml_syntax_init)
     const std::size_t argc = argv.size() - 1;
     BOOST_CHECK_THROW(parameter::ParameterGroup p(argc, argv.data()), std::runtime_error);
 }
+
+
+BOOST_AUTO_TEST_CASE(frozen_group_lookup)
+{
+    typedef const char* cp;
+    std::vector<cp> argv = { "program_command",
+                             "topitem=somestring",
+                             "/group/item=1",
+                             "/group/anotheritem=2.5",
+                             "/group/subgroup/item=3",
+                             "/group/subgroup/flag=true",
+                             0 };
+    const std::size_t argc = argv.size() - 1;
+    parameter::ParameterGroup p(argc, argv.data(), true, false);
+    parameter::FrozenParameterGroup fp(p);
+
+    BOOST_CHECK(fp.has("group/subgroup/item"));
+    BOOST_CHECK(!fp.has("group/missing"));
+    BOOST_CHECK_EQUAL(fp.get<std::string>("topitem"), "somestring");
+    BOOST_CHECK_EQUAL(fp.get<int>("group/item"), 1);
+    BOOST_CHECK_EQUAL(fp.get<int>("/group/subgroup/item"), 3);
+    BOOST_CHECK_EQUAL(fp.getDefault<int>("group/missing", 7), 7);
+    BOOST_CHECK_THROW(fp.get<int>("group/missing"),
+                      parameter::ParameterGroup::NotFoundException);
+    BOOST_CHECK_THROW(fp.get<int>("topitem"),
+                      parameter::ParameterGroup::WrongTypeException);
+
+    // Inherited from enclosing groups, as in ParameterGroup.
+    BOOST_CHECK_EQUAL(fp.get<double>("group/subgroup/anotheritem"),
+                      p.get<double>("group/subgroup/anotheritem"));
+    BOOST_CHECK_EQUAL(fp.get<std::string>("group/subgroup/topitem"), "somestring");
+
+    const parameter::ParamHandle<double> h = fp.handle<double>("group/anotheritem");
+    const parameter::ParamHandle<bool> b = fp.handle<bool>("group/subgroup/flag");
+    const parameter::ParamHandle<int> d = fp.handle("group/missing", 42);
+    BOOST_REQUIRE(h.valid() && b.valid() && d.valid());
+    BOOST_CHECK_EQUAL(fp.get(h), 2.5);
+    BOOST_CHECK(fp.get(b));
+    BOOST_CHECK_EQUAL(fp.get(d), 42);
+    BOOST_CHECK(!parameter::ParamHandle<int>().valid());
+}
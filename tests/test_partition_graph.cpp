@@ -0,0 +1,116 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE PartitionGraphTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+#include <opm/core/pressure/msmfem/partition_graph.h>
+
+#include <algorithm>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (rcb_balance)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(12, 5, 3, 1., 1., 1.);
+    const int nc = g->number_of_cells;
+
+    for (int nparts = 1; nparts <= 9; ++nparts) {
+        std::vector<int> p(nc, -1);
+        BOOST_REQUIRE_EQUAL (partition_rcb(nc, NULL, g->dimensions,
+                                           g->cell_centroids, nparts,
+                                           &p[0]), nparts);
+
+        std::vector<int> count(nparts, 0);
+        for (int c = 0; c < nc; ++c) {
+            BOOST_REQUIRE ((0 <= p[c]) && (p[c] < nparts));
+            ++count[p[c]];
+        }
+
+        // Unit weights: part sizes differ by at most one cell per
+        // bisection level.
+        const int lo = *std::min_element(count.begin(), count.end());
+        const int hi = *std::max_element(count.begin(), count.end());
+        BOOST_CHECK_LE (hi - lo, 4);
+        BOOST_CHECK_GT (lo, 0);
+    }
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (rcb_weighted)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(10, 1, 1, 1., 1., 1.);
+    const int nc = g->number_of_cells;
+
+    // Heavy last cell balances the nine others.
+    std::vector<double> w(nc, 1.0);
+    w[nc - 1] = 9.0;
+
+    std::vector<int> p(nc, -1);
+    BOOST_REQUIRE_EQUAL (partition_rcb(nc, &w[0], g->dimensions,
+                                       g->cell_centroids, 2, &p[0]), 2);
+
+    for (int c = 0; c < nc - 1; ++c) {
+        BOOST_CHECK_EQUAL (p[c], 0);
+    }
+    BOOST_CHECK_EQUAL (p[nc - 1], 1);
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (graph_default)
+{
+    struct UnstructuredGrid *g = create_grid_hexa3d(8, 8, 2, 1., 1., 1.);
+    const int nc = g->number_of_cells;
+
+    std::vector<double> trans(g->number_of_faces, 1.0);
+    std::vector<int> p(nc, -1);
+    BOOST_REQUIRE_EQUAL (partition_graph(nc, g->number_of_faces,
+                                         g->face_cells, &trans[0], NULL,
+                                         g->dimensions, g->cell_centroids,
+                                         4, PARTITION_GRAPH_DEFAULT,
+                                         &p[0]), 4);
+
+    std::vector<int> count(4, 0);
+    for (int c = 0; c < nc; ++c) {
+        BOOST_REQUIRE ((0 <= p[c]) && (p[c] < 4));
+        ++count[p[c]];
+    }
+    for (int k = 0; k < 4; ++k) {
+        BOOST_CHECK_GT (count[k], 0);
+    }
+
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE PhasePipelineTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/simulator/PhasePipeline.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using Opm::PhasePipeline;
+
+namespace
+{
+    // Run steps alternating pressure and transport stages, and record
+    // the largest number of stages of each phase running at once.
+    struct Member
+    {
+        Member(PhasePipeline& pipeline, std::atomic<int>* running, std::atomic<int>* peak)
+            : pipeline_(pipeline), running_(running), peak_(peak)
+        {
+        }
+
+        void operator()() const
+        {
+            for (int step = 0; step < 4; ++step) {
+                stage(PhasePipeline::Pressure);
+                stage(PhasePipeline::Transport);
+            }
+        }
+
+        void stage(const PhasePipeline::Phase phase) const
+        {
+            PhasePipeline::Stage s(&pipeline_, phase);
+            const int now = ++running_[phase];
+            int peak = peak_[phase].load();
+            while (now > peak && !peak_[phase].compare_exchange_weak(peak, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --running_[phase];
+        }
+
+        PhasePipeline& pipeline_;
+        std::atomic<int>* running_;
+        std::atomic<int>* peak_;
+    };
+}
+
+BOOST_AUTO_TEST_CASE(SlotsLimitConcurrentStages)
+{
+    PhasePipeline pipeline(1, 2, 1, 1);
+    std::atomic<int> running[2];
+    std::atomic<int> peak[2];
+    for (int p = 0; p < 2; ++p) {
+        running[p] = 0;
+        peak[p] = 0;
+    }
+    std::vector<std::thread> members;
+    for (int k = 0; k < 6; ++k) {
+        members.emplace_back(Member(pipeline, running, peak));
+    }
+    for (std::thread& t : members) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL(peak[PhasePipeline::Pressure].load(), 1);
+    BOOST_CHECK_LE(peak[PhasePipeline::Transport].load(), 2);
+    // With six members contending for three slots, phases overlap and
+    // members have to wait for pressure.
+    BOOST_CHECK_GT(pipeline.overlapTime(), 0.0);
+    BOOST_CHECK_GT(pipeline.waitTime(PhasePipeline::Pressure), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(NullPipelineRunsAtOnce)
+{
+    PhasePipeline::Stage stage(0, PhasePipeline::Pressure);
+}
@@ -109,6 +109,15 @@ BOOST_AUTO_TEST_CASE(Processing)
     BOOST_CHECK_EQUAL(nncdata[0].cell1, nnc1_index);
     BOOST_CHECK_EQUAL(nncdata[0].cell2, nnc2_index);
 
+    std::vector<int> nncCells;
+    std::vector<double> nncTrans;
+    pinch.process(grid, htrans, actnum, multz, porv, nncCells, nncTrans);
+    BOOST_REQUIRE_EQUAL(nncTrans.size(), 1);
+    BOOST_REQUIRE_EQUAL(nncCells.size(), 2);
+    BOOST_CHECK_EQUAL(nncCells[0], nnc1_index);
+    BOOST_CHECK_EQUAL(nncCells[1], nnc2_index);
+    BOOST_CHECK_EQUAL(nncTrans[0], nncdata[0].trans);
+
     std::cout << "WARNING. The opmfil option is hardcoded i.e. the calculated transmissibility is wrong";
     // double factor = Opm::prefix::centi*Opm::unit::Poise
     //     * Opm::unit::cubic(Opm::unit::meter)
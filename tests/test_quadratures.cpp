@@ -30,6 +30,7 @@
 
 #include <opm/core/grid/CellQuadrature.hpp>
 #include <opm/core/grid/FaceQuadrature.hpp>
+#include <opm/core/grid/QuadratureTable.hpp>
 #include <opm/core/grid/GridManager.hpp>
 #include <opm/core/grid.h>
 #include <cmath>
@@ -79,6 +80,31 @@ namespace
         BOOST_CHECK(std::fabs(val - expected_answer) < 1e-12);
     }
 
+
+    template <class Quadrature>
+    void testTable(const UnstructuredGrid& grid,
+                   const int num_entities,
+                   const int degree)
+    {
+        const QuadratureTable<Quadrature> table(grid, num_entities, degree);
+        BOOST_REQUIRE_EQUAL(table.numEntities(), num_entities);
+        const int dim = grid.dimensions;
+        std::vector<double> pt(dim);
+        int num_pts = 0;
+        for (int e = 0; e < num_entities; ++e) {
+            const Quadrature quad(grid, e, degree);
+            BOOST_REQUIRE_EQUAL(table.numQuadPts(e), quad.numQuadPts());
+            for (int i = 0; i < quad.numQuadPts(); ++i) {
+                BOOST_CHECK_EQUAL(table.pointIndex(e, i), num_pts++);
+                quad.quadPtCoord(i, &pt[0]);
+                BOOST_CHECK_EQUAL_COLLECTIONS(pt.begin(), pt.end(),
+                                              table.quadPtCoord(e, i), table.quadPtCoord(e, i) + dim);
+                BOOST_CHECK_EQUAL(table.quadPtWeight(e, i), quad.quadPtWeight(i));
+            }
+        }
+        BOOST_CHECK_EQUAL(table.numQuadPts(), num_pts);
+    }
+
 } // anonymous namespace
 
 
@@ -203,3 +229,17 @@ BOOST_AUTO_TEST_CASE(test_quadratures)
     cart2d::test();
     cart3d::test();
 }
+
+BOOST_AUTO_TEST_CASE(test_quadrature_tables)
+{
+    GridManager g2(3, 2);
+    GridManager g3(3, 2, 2);
+    const UnstructuredGrid* grids[2] = { g2.c_grid(), g3.c_grid() };
+    for (int g = 0; g < 2; ++g) {
+        const UnstructuredGrid& grid = *grids[g];
+        for (int degree = 0; degree <= 2; ++degree) {
+            testTable<CellQuadrature>(grid, grid.number_of_cells, degree);
+            testTable<FaceQuadrature>(grid, grid.number_of_faces, degree);
+        }
+    }
+}
@@ -35,9 +35,11 @@
 /* --- our own headers --- */
 
 #include <opm/core/utility/RegionMapping.hpp>
+#include <opm/core/utility/RegionSortedOrder.hpp>
 
 #include <algorithm>
 #include <map>
+#include <numeric>
 
 BOOST_AUTO_TEST_SUITE ()
 
@@ -152,4 +154,103 @@ BOOST_AUTO_TEST_CASE (NonConsecutive)
 }
 
 
+BOOST_AUTO_TEST_CASE (SparseIds)
+{
+    //                           0        1  2        3   4
+    std::vector<int> regions = { 1000000, 3, 1000000, -2, 3 };
+
+    Opm::RegionMapping<> rm(regions);
+
+    BOOST_CHECK_EQUAL(rm.activeRegions().size(), std::size_t(3));
+
+    const std::vector<int> expect = { 0, 2 };
+    const auto& cells = rm.cells(1000000);
+    BOOST_CHECK_EQUAL_COLLECTIONS(cells .begin(), cells .end(),
+                                  expect.begin(), expect.end());
+    BOOST_CHECK_EQUAL(rm.cells(-2).size(), 1);
+    BOOST_CHECK(rm.cells(0).empty());
+}
+
+
+BOOST_AUTO_TEST_CASE (SumByRegion)
+{
+    //                           0  1  2  3  4  5  6  7  8
+    std::vector<int> regions = { 2, 4, 2, 4, 2, 7, 6, 3, 6 };
+
+    Opm::RegionMapping<> rm(regions);
+
+    // Dense region IDs are reported in increasing order.
+    const std::vector<int> region_ids = { 2, 3, 4, 6, 7 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(rm.activeRegions().begin(),
+                                  rm.activeRegions().end(),
+                                  region_ids.begin(), region_ids.end());
+
+    std::vector<double> values(regions.size());
+    std::iota(values.begin(), values.end(), 1.0);
+
+    const std::vector<double> sum    = rm.sumByRegion(values);
+    const std::vector<double> expect = { 1.0 + 3.0 + 5.0, 8.0, 2.0 + 4.0,
+                                         7.0 + 9.0, 6.0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(sum   .begin(), sum   .end(),
+                                  expect.begin(), expect.end());
+
+    // More cells than one block.
+    const int n = 100000;
+    std::vector<int> big(n);
+    std::vector<int> ones(n, 1);
+    for (int i = 0; i < n; ++i) {
+        big[i] = i % 3;
+    }
+
+    const std::vector<int> count = Opm::RegionMapping<>(big).sumByRegion(ones);
+    BOOST_REQUIRE_EQUAL(count.size(), std::size_t(3));
+    BOOST_CHECK_EQUAL(count[0], 33334);
+    BOOST_CHECK_EQUAL(count[1], 33333);
+    BOOST_CHECK_EQUAL(count[2], 33333);
+}
+
+
+BOOST_AUTO_TEST_CASE (SortedOrder)
+{
+    //                           0  1  2  3  4  5  6  7  8
+    std::vector<int> regions = { 2, 4, 2, 4, 2, 7, 6, 3, 6 };
+
+    Opm::RegionSortedOrder ro(regions);
+
+    std::vector<int> cells(regions.size());
+    std::iota(cells.begin(), cells.end(), 0);
+
+    const int n = cells.size();
+    const int* order = ro.order(n, cells.data());
+    BOOST_REQUIRE(order != 0);
+
+    // Every cell once, contiguous regions, increasing within a region.
+    std::vector<int> seen(order, order + n);
+    std::sort(seen.begin(), seen.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(seen .begin(), seen .end(),
+                                  cells.begin(), cells.end());
+
+    std::vector<int> region_seq;
+    for (int k = 0; k < n; ++k) {
+        if (k > 0 && regions[order[k]] == regions[order[k - 1]]) {
+            BOOST_CHECK_LT(order[k - 1], order[k]);
+        } else {
+            region_seq.push_back(regions[order[k]]);
+        }
+    }
+    std::sort(region_seq.begin(), region_seq.end());
+    BOOST_CHECK(std::adjacent_find(region_seq.begin(), region_seq.end())
+                == region_seq.end());
+
+    // Subsets, other cell orders, and single regions keep given order.
+    BOOST_CHECK(ro.order(n - 1, cells.data()) == 0);
+    std::swap(cells[0], cells[1]);
+    BOOST_CHECK(ro.order(n, cells.data()) == 0);
+
+    Opm::RegionSortedOrder single(std::vector<int>(regions.size(), 0));
+    std::iota(cells.begin(), cells.end(), 0);
+    BOOST_CHECK(single.order(n, cells.data()) == 0);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
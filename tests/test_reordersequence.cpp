@@ -0,0 +1,203 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE ReorderSequenceTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/transport/reorder/ReorderSequence.hpp>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid/CartesianGridView.hpp>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace
+{
+    struct Ordering
+    {
+        std::vector<int> sequence;
+        std::vector<int> components;
+    };
+
+    Ordering order(ReorderContext* ctx, const UnstructuredGrid& grid,
+                   const std::vector<double>& flux, const int parallel)
+    {
+        Ordering o;
+        o.sequence.resize(grid.number_of_cells);
+        o.components.resize(grid.number_of_cells + 1);
+        int ncomp = 0;
+        ctx->parallel = parallel;
+        BOOST_REQUIRE(compute_sequence_context(ctx, &grid, flux.data(), o.sequence.data(),
+                                               o.components.data(), &ncomp, 1));
+        o.components.resize(ncomp + 1);
+        return o;
+    }
+
+    // Check that the ordering is causal and that the component graph
+    // of the context matches it.
+    void checkCausal(const ReorderContext& ctx, const Ordering& o)
+    {
+        const int nc = o.sequence.size();
+        const int ncomp = o.components.size() - 1;
+        BOOST_CHECK_EQUAL(o.components.front(), 0);
+        BOOST_CHECK_EQUAL(o.components.back(), nc);
+        std::vector<int> sorted(o.sequence);
+        std::sort(sorted.begin(), sorted.end());
+        for (int c = 0; c < nc; ++c) {
+            BOOST_REQUIRE_EQUAL(sorted[c], c);
+        }
+        std::vector<int> comp(nc);
+        for (int k = 0; k < ncomp; ++k) {
+            for (int i = o.components[k]; i < o.components[k + 1]; ++i) {
+                comp[o.sequence[i]] = k;
+            }
+        }
+        for (int c = 0; c < nc; ++c) {
+            BOOST_CHECK_EQUAL(ctx.comp_of_cell[c], comp[c]);
+            for (int j = ctx.ia[c]; j < ctx.ia[c + 1]; ++j) {
+                BOOST_CHECK(comp[ctx.ja[j]] <= comp[c]);
+            }
+        }
+        for (int k = 0; k < ncomp; ++k) {
+            for (int j = ctx.comp_ia[k]; j < ctx.comp_ia[k + 1]; ++j) {
+                BOOST_CHECK(ctx.comp_ja[j] < k);
+            }
+        }
+    }
+
+    template <class Grid>
+    Ordering sequence(const Grid* grid, const std::vector<double>& flux)
+    {
+        const int nc = Opm::UgGridHelpers::numCells(*grid);
+        Ordering o;
+        o.sequence.resize(nc);
+        o.components.resize(nc + 1);
+        int ncomp = 0;
+        compute_sequence<Grid>(grid, flux.data(), o.sequence.data(),
+                               o.components.data(), &ncomp);
+        o.components.resize(ncomp + 1);
+        return o;
+    }
+
+    std::set<std::set<int>> componentSets(const Ordering& o)
+    {
+        std::set<std::set<int>> sets;
+        for (std::size_t k = 0; k + 1 < o.components.size(); ++k) {
+            sets.insert(std::set<int>(o.sequence.begin() + o.components[k],
+                                      o.sequence.begin() + o.components[k + 1]));
+        }
+        return sets;
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(parallelMatchesSequential)
+{
+    const Opm::GridManager gm(30, 20);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    std::unique_ptr<ReorderContext, void(*)(ReorderContext*)>
+        ctx(create_reorder_context(&grid), destroy_reorder_context);
+    BOOST_REQUIRE(ctx);
+
+    // Mostly uniform flow in the x direction, with a few reversed
+    // faces creating loops, and some zero fluxes.
+    std::vector<double> flux(grid.number_of_faces, 0.0);
+    for (int f = 0; f < grid.number_of_faces; ++f) {
+        const double nx = grid.face_normals[2*f];
+        const double ny = grid.face_normals[2*f + 1];
+        flux[f] = nx + 0.1*ny;
+        if (f % 17 == 0) {
+            flux[f] = -flux[f];
+        }
+        if (f % 23 == 0) {
+            flux[f] = 0.0;
+        }
+    }
+
+    const Ordering seq = order(ctx.get(), grid, flux, 0);
+    checkCausal(*ctx, seq);
+    const Ordering par = order(ctx.get(), grid, flux, 1);
+    checkCausal(*ctx, par);
+
+    // Strongly connected components are unique.
+    BOOST_CHECK_EQUAL(seq.components.size(), par.components.size());
+    BOOST_CHECK(componentSets(seq) == componentSets(par));
+    BOOST_CHECK(seq.components.size() < std::size_t(grid.number_of_cells + 1));
+
+    // Context does not fit another grid.
+    const Opm::GridManager other(5, 5);
+    std::vector<int> sequence(25);
+    std::vector<int> components(26);
+    int ncomp = 0;
+    BOOST_CHECK(!compute_sequence_context(ctx.get(), other.c_grid(), flux.data(),
+                                          sequence.data(), components.data(), &ncomp, 0));
+}
+
+
+BOOST_AUTO_TEST_CASE(templatedMatchesC)
+{
+    std::unique_ptr<UnstructuredGrid, void(*)(UnstructuredGrid*)>
+        grid(create_grid_hexa3d(6, 5, 4, 1.0, 1.0, 1.0), destroy_grid);
+    BOOST_REQUIRE(grid);
+    const Opm::CartesianGridView view(6, 5, 4);
+    BOOST_REQUIRE_EQUAL(Opm::UgGridHelpers::numFaces(view), grid->number_of_faces);
+
+    // Diagonal flow with some reversed faces creating loops.
+    std::vector<double> flux(grid->number_of_faces, 0.0);
+    for (int f = 0; f < grid->number_of_faces; ++f) {
+        const double* n = grid->face_normals + 3*f;
+        flux[f] = n[0] + 0.5*n[1] + 0.25*n[2];
+        if (f % 13 == 0) {
+            flux[f] = -flux[f];
+        }
+    }
+
+    Ordering ref;
+    ref.sequence.resize(grid->number_of_cells);
+    ref.components.resize(grid->number_of_cells + 1);
+    int ncomp = 0;
+    compute_sequence(grid.get(), flux.data(), ref.sequence.data(),
+                     ref.components.data(), &ncomp);
+    ref.components.resize(ncomp + 1);
+    BOOST_CHECK(ncomp < grid->number_of_cells);
+
+    const Ordering ug = sequence<UnstructuredGrid>(grid.get(), flux);
+    BOOST_CHECK(ug.sequence == ref.sequence);
+    BOOST_CHECK(ug.components == ref.components);
+
+    // The face order of the cells may differ, so only the strongly
+    // connected components are unique.
+    const Ordering cv = sequence(&view, flux);
+    BOOST_CHECK(componentSets(cv) == componentSets(ref));
+}
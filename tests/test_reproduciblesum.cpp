@@ -0,0 +1,124 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE ReproducibleSumTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/core/utility/ReproducibleSum.hpp>
+
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+    std::vector<double> testData(const int n)
+    {
+        std::vector<double> x(n);
+        for (int i = 0; i < n; ++i) {
+            x[i] = std::sin(0.37*i) * std::pow(10.0, (i % 7) - 3);
+        }
+        return x;
+    }
+
+    struct TwoComponents
+    {
+        const double* x;
+        void operator()(const int i, double* t) const
+        {
+            t[0] = x[i];
+            t[1] = x[i]*x[i];
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE(sums)
+{
+    const int n = 10001;
+    const std::vector<double> x = testData(n);
+    long double exact = 0.0;
+    long double exact_sq = 0.0;
+    for (int i = 0; i < n; ++i) {
+        exact += x[i];
+        exact_sq += (long double)(x[i])*x[i];
+    }
+    BOOST_CHECK_CLOSE(Opm::reproducibleSum(n, x.data()), double(exact), 1e-8);
+    BOOST_CHECK_CLOSE(Opm::reproducibleSum(n, x.data(), true), double(exact), 1e-12);
+    BOOST_CHECK_CLOSE(Opm::reproducibleDot(n, x.data(), x.data()), double(exact_sq), 1e-10);
+
+    const TwoComponents term = { x.data() };
+    double sum[2];
+    Opm::reproducibleSum(n, 2, term, sum);
+    BOOST_CHECK_EQUAL(sum[0], Opm::reproducibleSum(n, x.data()));
+    BOOST_CHECK_EQUAL(sum[1], Opm::reproducibleDot(n, x.data(), x.data()));
+
+    BOOST_CHECK_EQUAL(Opm::reproducibleSum(0, x.data()), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(compensated)
+{
+    // Terms that cancel, so that a plain sum loses all small terms.
+    const int n = 3*Opm::ReproducibleSumBlockSize;
+    std::vector<double> x(n, 1.0);
+    for (int i = 0; i < n; i += 2) {
+        x[i] = 1e16;
+        x[i + 1] = -1e16;
+    }
+    x[1] = 1.0;
+    x[n - 1] = -1e16 + 2.0;
+    // Exact sum is 1 + 1e16 + 2 = 1e16 + 3, not representable; the
+    // nearest double is 1e16 + 4 (spacing 2 at this magnitude).
+    const double s = Opm::reproducibleSum(n, x.data(), true);
+    BOOST_CHECK_EQUAL(s, 1e16 + 4.0);
+}
+
+BOOST_AUTO_TEST_CASE(thread_count_independence)
+{
+    const int n = 50000;
+    const std::vector<double> x = testData(n);
+    const std::vector<double> y = testData(n + 3);
+    const double s0 = Opm::reproducibleSum(n, x.data());
+    const double c0 = Opm::reproducibleSum(n, x.data(), true);
+    const double d0 = Opm::reproducibleDot(n, x.data(), y.data() + 3);
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    for (int nt = 1; nt <= 8; ++nt) {
+        omp_set_num_threads(nt);
+        BOOST_CHECK_EQUAL(Opm::reproducibleSum(n, x.data()), s0);
+        BOOST_CHECK_EQUAL(Opm::reproducibleSum(n, x.data(), true), c0);
+        BOOST_CHECK_EQUAL(Opm::reproducibleDot(n, x.data(), y.data() + 3), d0);
+    }
+    omp_set_num_threads(max_threads);
+#else
+    BOOST_CHECK_EQUAL(Opm::reproducibleSum(n, x.data()), s0);
+    BOOST_CHECK_EQUAL(Opm::reproducibleSum(n, x.data(), true), c0);
+    BOOST_CHECK_EQUAL(Opm::reproducibleDot(n, x.data(), y.data() + 3), d0);
+#endif
+}
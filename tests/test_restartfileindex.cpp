@@ -0,0 +1,210 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE RestartFileIndexTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/eclipse/RestartFileIndex.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Writes keywords in the unformatted Eclipse layout.
+class KeywordWriter {
+public:
+    explicit KeywordWriter (const std::string& filename)
+        : os_ (filename.c_str (), std::ios::binary) { }
+
+    void header (const std::string& name, const int count, const std::string& type) {
+        std::string paddedName = name;
+        paddedName.resize (8, ' ');
+        marker (16);
+        os_.write (paddedName.data (), 8);
+        int32 (count);
+        os_.write (type.data (), 4);
+        marker (16);
+    }
+
+    void real (const std::string& name, const std::vector <float>& values) {
+        header (name, values.size (), "REAL");
+        for (std::size_t first = 0; first < values.size (); first += 1000) {
+            const std::size_t n = std::min <std::size_t> (1000, values.size () - first);
+            marker (4*n);
+            for (std::size_t i = first; i < first + n; ++i) {
+                std::uint32_t bits;
+                std::memcpy (&bits, &values[i], 4);
+                int32 (bits);
+            }
+            marker (4*n);
+        }
+    }
+
+    void doub (const std::string& name, const std::vector <double>& values) {
+        header (name, values.size (), "DOUB");
+        marker (8*values.size ());
+        for (const double value : values) {
+            std::uint64_t bits;
+            std::memcpy (&bits, &value, 8);
+            int32 (std::uint32_t (bits >> 32));
+            int32 (std::uint32_t (bits));
+        }
+        marker (8*values.size ());
+    }
+
+    void inte (const std::string& name, const int value) {
+        header (name, 1, "INTE");
+        marker (4);
+        int32 (value);
+        marker (4);
+    }
+
+    void chars (const std::string& name, const int count) {
+        header (name, count, "CHAR");
+        for (int first = 0; first < count; first += 105) {
+            const int n = std::min (105, count - first);
+            marker (8*n);
+            os_.write (std::string (8*n, 'x').data (), 8*n);
+            marker (8*n);
+        }
+    }
+
+private:
+    void marker (const std::size_t n) { int32 (std::uint32_t (n)); }
+
+    void int32 (const std::uint32_t value) {
+        const char bytes[4] = { char (value >> 24), char (value >> 16),
+                                char (value >> 8), char (value) };
+        os_.write (bytes, 4);
+    }
+
+    std::ofstream os_;
+};
+
+const char* const FILENAME = "test_restartfileindex.UNRST";
+
+std::vector <float> pressures (const int step) {
+    std::vector <float> p (2500);
+    for (std::size_t i = 0; i < p.size (); ++i) {
+        p[i] = 100.0f*step + 0.5f*i;
+    }
+    return p;
+}
+
+void writeUnified () {
+    KeywordWriter w (FILENAME);
+    for (int step = 0; step <= 2; step += 2) {
+        w.inte ("SEQNUM", step);
+        w.chars ("ZWEL", 230);
+        w.header ("STARTSOL", 0, "MESS");
+        w.real ("PRESSURE", pressures (step));
+        w.doub ("OPM_XWEL", { 1.0 + step, 2.0, 3.0 });
+        w.header ("ENDSOL", 0, "MESS");
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (IndexUnified)
+{
+    writeUnified ();
+    BOOST_CHECK (Opm::RestartFileIndex::isUnformatted (FILENAME));
+
+    const Opm::RestartFileIndex index (FILENAME);
+    BOOST_CHECK_EQUAL (index.keywords ().size (), 12u);
+    BOOST_CHECK (index.hasReportStep (0));
+    BOOST_CHECK (index.hasReportStep (2));
+    BOOST_CHECK (!index.hasReportStep (1));
+    BOOST_CHECK (index.find ("RS", 2) == 0);
+
+    const Opm::RestartFileIndex::Keyword* p = index.find ("PRESSURE", 2);
+    BOOST_REQUIRE (p != 0);
+    BOOST_CHECK_EQUAL (p->count, 2500);
+    BOOST_CHECK_EQUAL (p->type, "REAL");
+    BOOST_CHECK_EQUAL (p->reportStep, 2);
+
+    // all values, scaled
+    const std::vector <float> expected = pressures (2);
+    std::vector <double> values (2500);
+    index.read (*p, 0, 2500, values.data (), 1, 2.0, 100.0);
+    for (int i = 0; i < 2500; ++i) {
+        BOOST_CHECK_EQUAL (values[i], (double (expected[i]) - 100.0)*2.0);
+    }
+
+    // a range across a record boundary, strided
+    std::vector <double> striped (2*20, -1.0);
+    index.read (*p, 990, 20, striped.data () + 1, 2);
+    for (int i = 0; i < 20; ++i) {
+        BOOST_CHECK_EQUAL (striped[2*i], -1.0);
+        BOOST_CHECK_EQUAL (striped[2*i + 1], double (expected[990 + i]));
+    }
+
+    const Opm::RestartFileIndex::Keyword* xwel = index.find ("OPM_XWEL", 0);
+    BOOST_REQUIRE (xwel != 0);
+    double x[2];
+    index.read (*xwel, 0, 2, x);
+    BOOST_CHECK_EQUAL (x[0], 1.0);
+    BOOST_CHECK_EQUAL (x[1], 2.0);
+
+    BOOST_CHECK_THROW (index.read (*xwel, 2, 2, x), std::runtime_error);
+    BOOST_CHECK_THROW (index.read (*index.find ("ZWEL", 0), 0, 1, x), std::runtime_error);
+
+    std::remove (FILENAME);
+}
+
+BOOST_AUTO_TEST_CASE (InvalidFiles)
+{
+    writeUnified ();
+    {
+        // cut off in the middle of the last keyword
+        std::ifstream is (FILENAME, std::ios::binary);
+        std::string contents ((std::istreambuf_iterator <char> (is)), std::istreambuf_iterator <char> ());
+        std::ofstream os (FILENAME, std::ios::binary);
+        os.write (contents.data (), contents.size () - 30);
+    }
+    BOOST_CHECK_THROW (Opm::RestartFileIndex index (FILENAME), std::runtime_error);
+
+    {
+        std::ofstream os (FILENAME);
+        os << " 'SEQNUM  '           1 'INTE'\n";
+    }
+    BOOST_CHECK (!Opm::RestartFileIndex::isUnformatted (FILENAME));
+    BOOST_CHECK_THROW (Opm::RestartFileIndex index (FILENAME), std::runtime_error);
+
+    std::remove (FILENAME);
+    BOOST_CHECK (!Opm::RestartFileIndex::isUnformatted (FILENAME));
+    BOOST_CHECK_THROW (Opm::RestartFileIndex index (FILENAME), std::runtime_error);
+}
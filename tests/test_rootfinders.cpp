@@ -0,0 +1,143 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE RootFindersTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/utility/RootFinders.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+    // Single-cell implicit transport residual with quadratic relative
+    // permeabilities, r(s) = s - s0 + c*f(s).  Counts evaluations.
+    struct TransportResidual
+    {
+        TransportResidual(double s0_, double c_, double M_)
+            : s0(s0_), c(c_), M(M_), evals(0) {}
+
+        double operator()(double s) const
+        {
+            ++evals;
+            return s - s0 + c*frac(s);
+        }
+
+        double operator()(double s, double& drds) const
+        {
+            ++evals;
+            const double m0 = s*s;
+            const double m1 = (1.0 - s)*(1.0 - s)/M;
+            const double mt = m0 + m1;
+            const double dfds = (2.0*s*m1 + m0*2.0*(1.0 - s)/M)/(mt*mt);
+            drds = 1.0 + c*dfds;
+            return s - s0 + c*m0/mt;
+        }
+
+        double frac(double s) const
+        {
+            const double m0 = s*s;
+            return m0/(m0 + (1.0 - s)*(1.0 - s)/M);
+        }
+
+        double s0, c, M;
+        mutable int evals;
+    };
+
+    struct Steep
+    {
+        double operator()(double x, double& dfdx) const
+        {
+            const double t = std::tanh(20.0*(x - 0.7));
+            dfdx = 20.0*(1.0 - t*t);
+            return t;
+        }
+    };
+
+    struct NoZero
+    {
+        double operator()(double x, double& dfdx) const
+        {
+            dfdx = 2.0*x;
+            return x*x + 1.0;
+        }
+    };
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (newton_vs_regula_falsi)
+{
+    typedef Opm::RegulaFalsi<Opm::ThrowOnError>       RF;
+    typedef Opm::SafeguardedNewton<Opm::ThrowOnError> SN;
+
+    const double tol = 1e-9;
+    int newton_evals = 0;
+    int rf_evals = 0;
+    for (int i = 0; i < 10; ++i) {
+        // Range of old saturations and throughputs.
+        const double s0 = 0.1*i;
+        TransportResidual r(s0, 1.0 + 0.5*i, 2.0);
+
+        int it = 0;
+        const double s_rf = RF::solve(r, s0, 0.0, 1.0, 50, tol, it);
+        rf_evals += r.evals;
+        r.evals = 0;
+        const double s_sn = SN::solve(r, s0, 0.0, 1.0, 50, tol, it);
+        newton_evals += r.evals;
+
+        BOOST_CHECK_SMALL(r(s_rf), 1e-8);
+        BOOST_CHECK_SMALL(r(s_sn), 1e-8);
+        BOOST_CHECK_CLOSE(s_rf + 1.0, s_sn + 1.0, 1e-6);
+    }
+    BOOST_CHECK_LT(newton_evals, rf_evals);
+}
+
+BOOST_AUTO_TEST_CASE (newton_safeguard)
+{
+    typedef Opm::SafeguardedNewton<Opm::ThrowOnError> SN;
+
+    // The Newton step from zero overshoots far outside the interval.
+    int it = 0;
+    const double x = SN::solve(Steep(), 0.0, 0.0, 1.0, 100, 1e-12, it);
+    BOOST_CHECK_CLOSE(x, 0.7, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE (newton_no_zero)
+{
+    typedef Opm::SafeguardedNewton<Opm::ThrowOnError> SN;
+
+    int it = 0;
+    BOOST_CHECK_THROW(SN::solve(NoZero(), 0.5, -1.0, 1.0, 20, 1e-9, it),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,8 @@
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/props/IncompPropertiesBasic.hpp>
 #include <opm/core/props/IncompPropertiesShadow.hpp>
+#include <opm/core/props/BlackoilPropertiesBasic.hpp>
+#include <opm/core/props/BlackoilPropertiesShadow.hpp>
 
 using namespace Opm;
 
@@ -32,3 +34,55 @@ BOOST_AUTO_TEST_CASE(shadowPorosity)
     shadow.usePorosity (basic);
     BOOST_CHECK_CLOSE (*(shadow.porosity()), defaultPorosity, 0.001);
 }
+
+BOOST_AUTO_TEST_CASE(shadowBlackoilRock)
+{
+    const double newPorosity[] = { 0.5, 0.25 };
+
+    parameter::ParameterGroup param;
+    BlackoilPropertiesBasic basic (param, 2, 2);
+    BlackoilPropertiesShadow shadow (basic);
+    BOOST_CHECK_EQUAL (shadow.porosity(), basic.porosity());
+    BOOST_CHECK_EQUAL (shadow.permeability(), basic.permeability());
+    shadow.usePorosity (newPorosity);
+    BOOST_CHECK_EQUAL (shadow.porosity(), newPorosity);
+    BOOST_CHECK_EQUAL (shadow.permeability(), basic.permeability());
+    shadow.useRockProps (basic);
+    BOOST_CHECK_EQUAL (shadow.porosity(), basic.porosity());
+}
+
+BOOST_AUTO_TEST_CASE(shadowBlackoilRelperm)
+{
+    // Two cells, two phases with linear relperm.
+    const double mult[] = { 0.5, 1.0,
+                            1.0, 2.0 };
+    const double s[] = { 0.4, 0.6,
+                         0.8, 0.2 };
+    const int cells[] = { 0, 1 };
+
+    parameter::ParameterGroup param;
+    BlackoilPropertiesBasic basic (param, 2, 2);
+    BlackoilPropertiesShadow shadow (basic);
+    shadow.useRelpermMultipliers (mult);
+
+    double kr[4], dkrds[8], kr0[4], dkrds0[8];
+    basic.relperm (2, s, cells, kr0, dkrds0);
+    shadow.relperm (2, s, cells, kr, dkrds);
+    for (int i = 0; i < 2; ++i) {
+        for (int p = 0; p < 2; ++p) {
+            BOOST_CHECK_CLOSE (kr[2*i + p], mult[2*i + p]*kr0[2*i + p], 1e-12);
+            for (int q = 0; q < 2; ++q) {
+                BOOST_CHECK_CLOSE (dkrds[4*i + 2*q + p] + 1.0,
+                                   mult[2*i + p]*dkrds0[4*i + 2*q + p] + 1.0, 1e-12);
+            }
+        }
+    }
+
+    const double p[] = { 1e5, 1e5 };
+    const double T[] = { 300.0, 300.0 };
+    BlackoilFluidData data;
+    shadow.fluidProperties (2, p, T, s, s, cells, false, data);
+    for (int i = 0; i < 4; ++i) {
+        BOOST_CHECK_CLOSE (data.kr[i], kr[i], 1e-12);
+    }
+}
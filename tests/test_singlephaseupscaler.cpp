@@ -0,0 +1,123 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE SinglePhaseUpscalerTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/pressure/SinglePhaseUpscaler.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+    struct GridDeleter
+    {
+        void operator()(UnstructuredGrid* g) const { destroy_grid(g); }
+    };
+    typedef std::unique_ptr<UnstructuredGrid, GridDeleter> GridPtr;
+
+    // Diagonal permeability in layers along z, with permeability
+    // kz[k] in layer k in all directions.
+    std::vector<double> layeredPermeability(const UnstructuredGrid& g, const int nx, const int ny,
+                                            const std::vector<double>& kz)
+    {
+        std::vector<double> perm(9*g.number_of_cells, 0.0);
+        for (int c = 0; c < g.number_of_cells; ++c) {
+            const double k = kz[c/(nx*ny)];
+            perm[9*c] = perm[9*c + 4] = perm[9*c + 8] = k;
+        }
+        return perm;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LayeredBoxes)
+{
+    Opm::parameter::ParameterGroup param;
+    Opm::SinglePhaseUpscaler upscaler(param);
+
+    // Boxes of different sizes and layerings.
+    const int num_models = 12;
+    std::vector<GridPtr> grids;
+    std::vector<std::vector<double> > perms;
+    std::vector<const UnstructuredGrid*> grid_ptrs;
+    std::vector<const double*> perm_ptrs;
+    std::vector<double> arithmetic, harmonic;
+    for (int m = 0; m < num_models; ++m) {
+        const int nx = 2 + m % 3;
+        const int ny = 3;
+        const int nz = 2 + m % 4;
+        grids.emplace_back(create_grid_hexa3d(nx, ny, nz, 2.0, 1.0, 0.5));
+        std::vector<double> kz(nz);
+        double sum = 0.0;
+        double inv_sum = 0.0;
+        for (int k = 0; k < nz; ++k) {
+            kz[k] = 1e-13*(1 + (k + m) % 5);
+            sum += kz[k];
+            inv_sum += 1.0/kz[k];
+        }
+        arithmetic.push_back(sum/nz);
+        harmonic.push_back(nz/inv_sum);
+        perms.push_back(layeredPermeability(*grids.back(), nx, ny, kz));
+        grid_ptrs.push_back(grids.back().get());
+        perm_ptrs.push_back(perms.back().data());
+    }
+
+    const std::vector<double> keff = upscaler.upscale(grid_ptrs, perm_ptrs);
+    BOOST_REQUIRE_EQUAL(keff.size(), 3u*num_models);
+    for (int m = 0; m < num_models; ++m) {
+        BOOST_CHECK_CLOSE(keff[3*m + 0], arithmetic[m], 1e-6);
+        BOOST_CHECK_CLOSE(keff[3*m + 1], arithmetic[m], 1e-6);
+        BOOST_CHECK_CLOSE(keff[3*m + 2], harmonic[m], 1e-6);
+        // The batch gives the same result as one model at a time.
+        const std::vector<double> single = upscaler.upscale(*grid_ptrs[m], perm_ptrs[m]);
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_CLOSE(single[d], keff[3*m + d], 1e-10);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TwoDimensional)
+{
+    Opm::parameter::ParameterGroup param;
+    Opm::SinglePhaseUpscaler upscaler(param, 1);
+    GridPtr grid(create_grid_cart2d(4, 3, 1.0, 1.0));
+    std::vector<double> perm(4*grid->number_of_cells, 0.0);
+    for (int c = 0; c < grid->number_of_cells; ++c) {
+        perm[4*c] = 2e-13;
+        perm[4*c + 3] = 5e-14;
+    }
+    const std::vector<double> keff = upscaler.upscale(*grid, perm.data());
+    BOOST_CHECK_CLOSE(keff[0], 2e-13, 1e-6);
+    BOOST_CHECK_CLOSE(keff[1], 5e-14, 1e-6);
+    BOOST_CHECK_EQUAL(keff[2], 0.0);
+}
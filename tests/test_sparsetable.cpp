@@ -130,3 +130,34 @@ BOOST_AUTO_TEST_CASE(construction_and_queries)
     BOOST_CHECK_THROW(const SparseTable<int> st6(elem, elem + num_elem, err_rs, err_rs + num_rows), std::exception);
 #endif
 }
+
+
+BOOST_AUTO_TEST_CASE(parallel_build)
+{
+    // Row i holds i % 4 entries, each equal to 10*i + j.
+    const int num_rows = 1000;
+    SparseTable<int> st;
+    st.build(num_rows,
+             [](const int i) { return i % 4; },
+             [](const int i, int* row) {
+                 for (int j = 0; j < i % 4; ++j) {
+                     row[j] = 10*i + j;
+                 }
+             });
+
+    std::vector<int> elem;
+    std::vector<int> rowsizes;
+    for (int i = 0; i < num_rows; ++i) {
+        rowsizes.push_back(i % 4);
+        for (int j = 0; j < i % 4; ++j) {
+            elem.push_back(10*i + j);
+        }
+    }
+    const SparseTable<int> expected(elem.begin(), elem.end(), rowsizes.begin(), rowsizes.end());
+    BOOST_CHECK(st == expected);
+    BOOST_CHECK_EQUAL(st.rowData(7)[2], 72);
+    BOOST_CHECK_EQUAL(std::size_t(st.rowData(0)) % 64, std::size_t(0));
+
+    BOOST_CHECK_THROW(st.build(0, [](const int) { return 0; }, [](const int, int*) {}),
+                      std::exception);
+}
@@ -107,3 +107,45 @@ BOOST_AUTO_TEST_CASE(construction_and_queries)
 #endif
 }
 
+
+
+BOOST_AUTO_TEST_CASE(blocks_and_dense_operations)
+{
+    // Runs { 1, 2, 3 }, { 5 }, { 8, 9 }.
+    const int size = 12;
+    const int num_elem = 6;
+    const double elem[num_elem] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+    const int indices[num_elem] = { 1, 2, 3, 5, 8, 9 };
+    const SparseVector<double> sv(size, elem, elem + num_elem, indices, indices + num_elem);
+    BOOST_CHECK_EQUAL(sv.numBlocks(), 3);
+    for (int i = 0; i < num_elem; ++i) {
+        BOOST_CHECK_EQUAL(sv.nonzeroIndex(i), indices[i]);
+        BOOST_CHECK_EQUAL(sv.element(indices[i]), elem[i]);
+    }
+    BOOST_CHECK_EQUAL(sv.element(4), 0.0);
+    BOOST_CHECK_EQUAL(sv.element(10), 0.0);
+
+    std::vector<double> dense(size);
+    for (int i = 0; i < size; ++i) {
+        dense[i] = i;
+    }
+    BOOST_CHECK_EQUAL(sv.dot(dense.data()), 1.0*1 + 2.0*2 + 3.0*3 + 4.0*5 + 5.0*8 + 6.0*9);
+
+    std::vector<double> y(size, 1.0);
+    sv.axpy(2.0, y.data());
+    BOOST_CHECK_EQUAL(y[0], 1.0);
+    BOOST_CHECK_EQUAL(y[3], 7.0);
+    BOOST_CHECK_EQUAL(y[9], 13.0);
+
+    std::vector<double> out(size, -1.0);
+    sv.scatter(out.data());
+    BOOST_CHECK_EQUAL(out[0], -1.0);
+    BOOST_CHECK_EQUAL(out[5], 4.0);
+    BOOST_CHECK_EQUAL(out[8], 5.0);
+
+    SparseVector<double> g = sv;
+    g.gather(dense.data());
+    for (int i = 0; i < num_elem; ++i) {
+        BOOST_CHECK_EQUAL(g.nonzeroElement(i), double(indices[i]));
+    }
+}
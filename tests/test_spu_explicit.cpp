@@ -0,0 +1,268 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE SpuExplicitTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid.h>
+#include <opm/core/transport/minimal/spu_explicit.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (batched_matches_reference)
+{
+    UnstructuredGrid* g = create_grid_cart2d(7, 5, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+    const int nf = g->number_of_faces;
+
+    std::vector<double> s0(nc), mob(2*nc), src(nc, 0.0);
+    std::vector<double> dflux(nf), gflux(nf);
+    for (int c = 0; c < nc; ++c) {
+        s0[c] = 0.5 + 0.4*std::sin(1.3*c);
+        mob[2*c + 0] = s0[c]*s0[c];
+        mob[2*c + 1] = 0.5*(1.0 - s0[c])*(1.0 - s0[c]);
+    }
+    for (int f = 0; f < nf; ++f) {
+        // All sign combinations of Darcy and gravity flux.
+        dflux[f] = 0.3*std::cos(0.7*f);
+        gflux[f] = 0.2*std::sin(1.1*f + 0.5);
+    }
+    src[0] = 0.5;
+    src[nc - 1] = -0.5;
+
+    std::vector<double> s_ref(nc), s(nc);
+    spu_explicit(g, &s0[0], &s_ref[0], &mob[0], &dflux[0], &gflux[0], &src[0], 0.1);
+
+    spu_explicit_work* w = spu_explicit_work_create(g);
+    BOOST_REQUIRE(w != 0);
+    spu_explicit_batched(w, &s0[0], &s[0], &mob[0], &dflux[0], &gflux[0], &src[0], 0.1);
+
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_EQUAL(s[c], s_ref[c]);
+    }
+
+    spu_explicit_work_destroy(w);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (advance_substeps)
+{
+    // Water flood along a row of cells.
+    const int n = 20;
+    UnstructuredGrid* g = create_grid_cart2d(n, 1, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+    const int nf = g->number_of_faces;
+
+    const double q = 1.0;
+    std::vector<double> dflux(nf, 0.0), gflux(nf, 0.0), src(nc, 0.0);
+    for (int f = 0; f < nf; ++f) {
+        if (g->face_cells[2*f] >= 0 && g->face_cells[2*f + 1] >= 0) {
+            dflux[f] = q;
+        }
+    }
+    src[0] = q;
+    src[nc - 1] = -q;
+
+    // Quadratic relative permeabilities, oil twice as viscous.
+    const int ntab = 101;
+    const double h = 1.0/(ntab - 1);
+    std::vector<double> tab(2*ntab);
+    for (int i = 0; i < ntab; ++i) {
+        const double sw = i*h;
+        tab[i] = sw*sw;
+        tab[ntab + i] = 0.5*(1.0 - sw)*(1.0 - sw);
+    }
+
+    spu_explicit_work* w = spu_explicit_work_create(g);
+    BOOST_REQUIRE(w != 0);
+
+    // Far beyond a single stable step.
+    const double dt = 5.0;
+    std::vector<double> s(nc, 0.0);
+    BOOST_CHECK_EQUAL(spu_explicit_advance(w, &s[0], h, 0.0, ntab, &tab[0],
+                                           &dflux[0], &gflux[0], &src[0],
+                                           dt, 0.9, 1), -1);
+
+    std::fill(s.begin(), s.end(), 0.0);
+    const int nsteps = spu_explicit_advance(w, &s[0], h, 0.0, ntab, &tab[0],
+                                            &dflux[0], &gflux[0], &src[0],
+                                            dt, 0.9, 10000);
+    BOOST_CHECK_GT(nsteps, 1);
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_GE(s[c], -1e-12);
+        BOOST_CHECK_LE(s[c], 1.0 + 1e-12);
+    }
+    // Front has not broken through: all injected water is in place.
+    BOOST_CHECK_SMALL(s[nc - 1], 1e-10);
+    BOOST_CHECK_CLOSE(std::accumulate(s.begin(), s.end(), 0.0), q*dt, 1e-8);
+
+    spu_explicit_work_destroy(w);
+    destroy_grid(g);
+}
+
+namespace
+{
+    // Quadratic relative permeabilities, oil twice as viscous.
+    std::vector<double> mobilityTable(const int ntab)
+    {
+        const double h = 1.0/(ntab - 1);
+        std::vector<double> tab(2*ntab);
+        for (int i = 0; i < ntab; ++i) {
+            const double sw = i*h;
+            tab[i] = sw*sw;
+            tab[ntab + i] = 0.5*(1.0 - sw)*(1.0 - sw);
+        }
+        return tab;
+    }
+
+    // Flux along a row of cells, with injection at the given cells.
+    std::vector<double> rowFlux(const UnstructuredGrid* g, const std::vector<double>& src)
+    {
+        std::vector<double> dflux(g->number_of_faces, 0.0);
+        for (int f = 0; f < g->number_of_faces; ++f) {
+            const int c1 = g->face_cells[2*f];
+            const int c2 = g->face_cells[2*f + 1];
+            if (c1 >= 0 && c2 >= 0) {
+                dflux[f] = std::accumulate(src.begin(), src.begin() + std::max(c1, c2), 0.0);
+            }
+        }
+        return dflux;
+    }
+}
+
+BOOST_AUTO_TEST_CASE (advance_local_uniform_matches_advance)
+{
+    const int n = 20;
+    UnstructuredGrid* g = create_grid_cart2d(n, 1, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+    const int ntab = 101;
+    const double h = 1.0/(ntab - 1);
+    const std::vector<double> tab = mobilityTable(ntab);
+
+    std::vector<double> src(nc, 0.0);
+    src[0] = 1.0;
+    src[nc - 1] = -1.0;
+    const std::vector<double> dflux = rowFlux(g, src);
+    const std::vector<double> gflux(g->number_of_faces, 0.0);
+
+    spu_explicit_work* w = spu_explicit_work_create(g);
+    BOOST_REQUIRE(w != 0);
+
+    // All cells have the same rate bound, unit flux times the largest
+    // slope of the fractional flow, so both take eight equal steps.
+    double amax = 0.0;
+    for (int i = 1; i < ntab; ++i) {
+        const double fi = tab[i]/(tab[i] + tab[ntab + i]);
+        const double fp = tab[i - 1]/(tab[i - 1] + tab[ntab + i - 1]);
+        amax = std::max(amax, std::fabs(fi - fp)/h);
+    }
+    const double cfl = 0.9;
+    const double dt = 7.5*cfl/amax;
+
+    std::vector<double> s(nc, 0.0), sl(nc, 0.0);
+    BOOST_CHECK_EQUAL(spu_explicit_advance(w, &s[0], h, 0.0, ntab, &tab[0],
+                                           &dflux[0], &gflux[0], &src[0],
+                                           dt, cfl, 1000), 8);
+    BOOST_CHECK_EQUAL(spu_explicit_advance_local(w, &sl[0], h, 0.0, ntab, &tab[0],
+                                                 &dflux[0], &gflux[0], &src[0],
+                                                 dt, cfl, 1000), 8);
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_EQUAL(sl[c], s[c]);
+    }
+
+    // Too many steps.
+    std::fill(sl.begin(), sl.end(), 0.0);
+    BOOST_CHECK_EQUAL(spu_explicit_advance_local(w, &sl[0], h, 0.0, ntab, &tab[0],
+                                                 &dflux[0], &gflux[0], &src[0],
+                                                 dt, cfl, 7), -1);
+    BOOST_CHECK_EQUAL(std::accumulate(sl.begin(), sl.end(), 0.0), 0.0);
+
+    spu_explicit_work_destroy(w);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_CASE (advance_local_conserves_water)
+{
+    // Weak injection upstream and strong injection in cell 5, so the
+    // downstream cells need much smaller steps than the upstream ones.
+    const int n = 40;
+    UnstructuredGrid* g = create_grid_cart2d(n, 1, 1.0, 1.0);
+    const int nc = g->number_of_cells;
+    const int ntab = 101;
+    const double h = 1.0/(ntab - 1);
+    const std::vector<double> tab = mobilityTable(ntab);
+
+    std::vector<double> src(nc, 0.0);
+    src[0] = 0.05;
+    src[5] = 1.0;
+    src[nc - 1] = -1.05;
+    const std::vector<double> dflux = rowFlux(g, src);
+    const std::vector<double> gflux(g->number_of_faces, 0.0);
+
+    spu_explicit_work* w = spu_explicit_work_create(g);
+    BOOST_REQUIRE(w != 0);
+
+    const double dt = 2.0;
+    std::vector<double> s(nc, 0.0), sl(nc, 0.0);
+    const int nsteps = spu_explicit_advance(w, &s[0], h, 0.0, ntab, &tab[0],
+                                            &dflux[0], &gflux[0], &src[0],
+                                            dt, 0.9, 100000);
+    const int nlocal = spu_explicit_advance_local(w, &sl[0], h, 0.0, ntab, &tab[0],
+                                                  &dflux[0], &gflux[0], &src[0],
+                                                  dt, 0.9, 100000);
+    BOOST_CHECK_GT(nlocal, 1);
+    BOOST_CHECK_GE(nlocal, nsteps);
+    BOOST_CHECK_LT(nlocal, 2*nsteps);
+
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_GE(sl[c], -1e-12);
+        BOOST_CHECK_LE(sl[c], 1.0 + 1e-12);
+    }
+    // Front has not broken through: all injected water is in place.
+    BOOST_CHECK_SMALL(sl[nc - 1], 1e-10);
+    BOOST_CHECK_CLOSE(std::accumulate(sl.begin(), sl.end(), 0.0), 1.05*dt, 1e-8);
+
+    // Same solution up to the time discretisation error.
+    double diff = 0.0;
+    for (int c = 0; c < nc; ++c) {
+        diff += std::fabs(sl[c] - s[c]);
+    }
+    BOOST_CHECK_SMALL(diff/nc, 0.01);
+
+    spu_explicit_work_destroy(w);
+    destroy_grid(g);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
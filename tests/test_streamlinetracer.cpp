@@ -0,0 +1,151 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE StreamlineTracerTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <opm/core/flowdiagnostics/StreamlineTracer.hpp>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/utility/SparseTable.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+    // Unit flux in the logical x direction through all interior faces
+    // of an nx-by-ny grid. Each cell of the left column is a source,
+    // and each cell of the right column a sink.
+    void lineDrive(const UnstructuredGrid& grid, const int nx, const int ny,
+                   std::vector<double>& flux, std::vector<double>& src)
+    {
+        flux.assign(grid.number_of_faces, 0.0);
+        src.assign(grid.number_of_cells, 0.0);
+        for (int c = 0; c < grid.number_of_cells; ++c) {
+            for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                const int c0 = grid.face_cells[2*f + 0];
+                const int c1 = grid.face_cells[2*f + 1];
+                if (grid.cell_facetag[hf] == 1 && c0 >= 0 && c1 >= 0) {
+                    flux[f] = (c0 == c) ? 1.0 : -1.0;
+                }
+            }
+        }
+        for (int j = 0; j < ny; ++j) {
+            src[nx*j] = 1.0;
+            src[nx*j + nx - 1] = -1.0;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(uniformFlowTof)
+{
+    const int nx = 5, ny = 2;
+    GridManager gm(nx, ny);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    std::vector<double> flux, src;
+    lineDrive(grid, nx, ny, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    StreamlineTracer tracer(grid, 3);
+    std::vector<double> tof;
+    tracer.solveTof(flux.data(), pv.data(), src.data(), tof);
+
+    BOOST_REQUIRE_EQUAL(tof.size(), std::size_t(grid.number_of_cells));
+    for (int j = 0; j < ny; ++j) {
+        BOOST_CHECK_EQUAL(tof[nx*j], 0.0);
+        for (int i = 1; i < nx - 1; ++i) {
+            // Uniform velocity: half a cell, then whole cells.
+            BOOST_CHECK_CLOSE(tof[nx*j + i], i - 0.5, 1e-10);
+        }
+        // In the sink cell the velocity decreases linearly from one
+        // at the inflow face to zero at the boundary, averaged over
+        // the seeds at xi = 1/6, 1/2 and 5/6.
+        double sink_tof = 0.0;
+        for (int s = 0; s < 3; ++s) {
+            const double xi = (s + 0.5)/3.0;
+            sink_tof += -std::log(1.0 - xi)/3.0;
+        }
+        BOOST_CHECK_CLOSE(tof[nx*j + nx - 1], nx - 2 + sink_tof, 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tracerFollowsRows)
+{
+    const int nx = 4, ny = 3;
+    GridManager gm(nx, ny);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    std::vector<double> flux, src;
+    lineDrive(grid, nx, ny, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 2.0);
+
+    std::vector<int> heads;
+    std::vector<int> sizes;
+    for (int j = 0; j < ny; ++j) {
+        heads.push_back(nx*j);
+        sizes.push_back(1);
+    }
+    const SparseTable<int> tracerheads(heads.begin(), heads.end(), sizes.begin(), sizes.end());
+
+    StreamlineTracer tracer(grid);
+    std::vector<double> tof, tr;
+    tracer.solveTofTracer(flux.data(), pv.data(), src.data(), tracerheads, tof, tr);
+
+    BOOST_REQUIRE_EQUAL(tr.size(), std::size_t(ny*grid.number_of_cells));
+    for (int c = 0; c < grid.number_of_cells; ++c) {
+        for (int k = 0; k < ny; ++k) {
+            BOOST_CHECK_EQUAL(tr[ny*c + k], (c / nx == k) ? 1.0 : 0.0);
+        }
+    }
+    BOOST_CHECK_CLOSE(tof[1], 1.0, 1e-10);
+    BOOST_CHECK_CLOSE(tof[2], 3.0, 1e-10);
+
+    // Reversed flow traces back to the sinks, which have no tracer.
+    for (double& f : flux) { f = -f; }
+    for (double& s : src) { s = -s; }
+    tracer.solveTofTracer(flux.data(), pv.data(), src.data(), tracerheads, tof, tr);
+    BOOST_CHECK_EQUAL(tof[nx - 1], 0.0);
+    BOOST_CHECK_CLOSE(tof[nx - 2], 1.0, 1e-10);
+    for (int c = 0; c < grid.number_of_cells; ++c) {
+        for (int k = 0; k < ny; ++k) {
+            BOOST_CHECK_EQUAL(tr[ny*c + k], 0.0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(requiresFaceTags)
+{
+    GridManager gm(3, 3);
+    UnstructuredGrid grid = *gm.c_grid();
+    grid.cell_facetag = 0;
+    BOOST_CHECK_THROW(StreamlineTracer tracer(grid), std::runtime_error);
+}
@@ -0,0 +1,104 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE ThreadControlTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/utility/ThreadControl.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace threads = Opm::threads;
+
+BOOST_AUTO_TEST_CASE(ChunksCoverRange)
+{
+    for (const threads::Schedule schedule : { threads::StaticSchedule, threads::DynamicSchedule }) {
+        std::vector<int> visits(1001, 0);
+        threads::parallelFor(0, 1001, 64, [&](const int begin, const int end) {
+                BOOST_CHECK_LE(end - begin, 64);
+                for (int i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            }, schedule);
+        for (const int v : visits) {
+            BOOST_CHECK_EQUAL(v, 1);
+        }
+    }
+    int calls = 0;
+    threads::parallelFor(5, 5, 16, [&](int, int) { ++calls; });
+    BOOST_CHECK_EQUAL(calls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ExceptionIsRethrown)
+{
+    std::atomic<int> chunks(0);
+    BOOST_CHECK_THROW(threads::parallelFor(0, 100, 10, [&](const int begin, int) {
+                ++chunks;
+                if (begin == 50) {
+                    throw std::runtime_error("failed chunk");
+                }
+            }), std::runtime_error);
+    BOOST_CHECK_EQUAL(chunks.load(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(ScopedLimit)
+{
+    threads::setNumThreads(3);
+#ifdef _OPENMP
+    BOOST_CHECK_EQUAL(threads::numThreads(), 3);
+#endif
+    {
+        threads::ScopedNumThreads limit(1);
+        BOOST_CHECK_EQUAL(threads::numThreads(), 1);
+        // A limit of one runs every chunk in the calling thread.
+        const std::thread::id caller = std::this_thread::get_id();
+        threads::parallelFor(0, 100, 1, [&](int, int) {
+                BOOST_CHECK(std::this_thread::get_id() == caller);
+            });
+    }
+#ifdef _OPENMP
+    BOOST_CHECK_EQUAL(threads::numThreads(), 3);
+#endif
+    // The limit only applies to the thread that set it.
+    int other = 0;
+    {
+        threads::ScopedNumThreads limit(1);
+        std::thread t([&]() { other = threads::numThreads(); });
+        t.join();
+    }
+#ifdef _OPENMP
+    BOOST_CHECK_EQUAL(other, 3);
+#else
+    BOOST_CHECK_EQUAL(other, 1);
+#endif
+    threads::setNumThreads(0);
+}
@@ -0,0 +1,150 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE TimingTreeTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/utility/TimingTree.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+using Opm::time::ScopedTimer;
+using Opm::time::TimingTree;
+
+namespace
+{
+    void assemble()
+    {
+        ScopedTimer t("assemble");
+        TimingTree::count("cells", 10);
+    }
+
+    void step()
+    {
+        ScopedTimer t("step");
+        assemble();
+        assemble();
+        ScopedTimer s("solve");
+    }
+
+    std::string json()
+    {
+        std::ostringstream os;
+        TimingTree::writeJson(os);
+        return os.str();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(NestedScopes)
+{
+    TimingTree::reset();
+    step();
+    step();
+
+    const std::string tree = json();
+    BOOST_CHECK(tree.find("\"name\":\"step\",\"seconds\":") != std::string::npos);
+    // assemble and solve are children of step, cells is a counter of assemble
+    const std::string::size_type step_pos = tree.find("\"step\"");
+    const std::string::size_type assemble_pos = tree.find("\"assemble\"");
+    const std::string::size_type solve_pos = tree.find("\"solve\"");
+    BOOST_REQUIRE(assemble_pos != std::string::npos);
+    BOOST_REQUIRE(solve_pos != std::string::npos);
+    BOOST_CHECK(step_pos < assemble_pos);
+    BOOST_CHECK(assemble_pos < solve_pos);
+    BOOST_CHECK(tree.find(",\"calls\":4,") != std::string::npos);
+    BOOST_CHECK(tree.find("\"name\":\"cells\",\"seconds\":0,\"calls\":40,\"counter\":true") != std::string::npos);
+
+    std::ostringstream os;
+    TimingTree::print(os);
+    BOOST_CHECK(os.str().find("    assemble") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Reset)
+{
+    TimingTree::reset();
+    step();
+    TimingTree::reset();
+    const std::string tree = json();
+    BOOST_CHECK(tree.find(",\"calls\":1,") == std::string::npos);
+    BOOST_CHECK(tree.find(",\"calls\":2,") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadsAreMerged)
+{
+    TimingTree::reset();
+    std::thread worker(step);
+    step();
+    worker.join();
+    BOOST_CHECK(json().find("\"name\":\"cells\",\"seconds\":0,\"calls\":40,\"counter\":true") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(ChromeTrace)
+{
+    TimingTree::reset();
+    TimingTree::setTraceRecording(true);
+    step();
+    TimingTree::setTraceRecording(false);
+    step();
+
+    std::ostringstream os;
+    TimingTree::writeChromeTrace(os);
+    const std::string trace = os.str();
+    BOOST_CHECK_EQUAL(trace.compare(0, 15, "{\"traceEvents\":"), 0);
+    int events = 0;
+    for (std::string::size_type pos = trace.find("\"ph\":\"X\""); pos != std::string::npos;
+         pos = trace.find("\"ph\":\"X\"", pos + 1)) {
+        ++events;
+    }
+    // step, two assemble and solve, only while recording
+    BOOST_CHECK_EQUAL(events, 4);
+}
+
+BOOST_AUTO_TEST_CASE(HardwareCounters)
+{
+    TimingTree::reset();
+    step();
+    BOOST_CHECK(json().find("\"peak_rss_kb\"") == std::string::npos);
+
+    TimingTree::setHardwareCounters(true);
+    step();
+    TimingTree::setHardwareCounters(false);
+    const std::string tree = json();
+#ifdef __linux__
+    // the peak resident set size is always available
+    const std::string::size_type step_pos = tree.find("\"name\":\"step\"");
+    BOOST_REQUIRE(step_pos != std::string::npos);
+    const std::string::size_type rss_pos = tree.find("\"peak_rss_kb\":", step_pos);
+    BOOST_REQUIRE(rss_pos != std::string::npos);
+    BOOST_CHECK(tree[rss_pos + 14] != '0');
+#endif
+    if (!TimingTree::hardwareCountersAvailable()) {
+        BOOST_CHECK(tree.find("\"cycles\":0") != std::string::npos || tree.find("\"cycles\"") == std::string::npos);
+    }
+}
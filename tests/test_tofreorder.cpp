@@ -0,0 +1,394 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE TofReorderTest
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+#include <boost/test/unit_test.hpp>
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <opm/core/flowdiagnostics/TofReorder.hpp>
+#include <opm/core/flowdiagnostics/TofDiscGalReorder.hpp>
+#include <opm/core/flowdiagnostics/TofLevelSweep.hpp>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/utility/SparseTable.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+    // Uniform velocity field (vx, vy) on a 2D grid.  Boundary fluxes
+    // are represented as sources (inflow) and sinks (outflow).
+    void uniformFlow(const UnstructuredGrid& grid,
+                     const double vx, const double vy,
+                     std::vector<double>& flux,
+                     std::vector<double>& src)
+    {
+        flux.assign(grid.number_of_faces, 0.0);
+        src.assign(grid.number_of_cells, 0.0);
+        for (int f = 0; f < grid.number_of_faces; ++f) {
+            const double* n = grid.face_normals + 2*f;
+            flux[f] = vx*n[0] + vy*n[1];
+            const int c0 = grid.face_cells[2*f + 0];
+            const int c1 = grid.face_cells[2*f + 1];
+            if (c1 < 0) {
+                src[c0] -= flux[f];
+            } else if (c0 < 0) {
+                src[c1] += flux[f];
+            }
+        }
+    }
+
+    // As uniformFlow(), for velocity (vx, vy, vz) on a 3D grid.
+    void uniformFlow3d(const UnstructuredGrid& grid,
+                       const double vx, const double vy, const double vz,
+                       std::vector<double>& flux,
+                       std::vector<double>& src)
+    {
+        flux.assign(grid.number_of_faces, 0.0);
+        src.assign(grid.number_of_cells, 0.0);
+        for (int f = 0; f < grid.number_of_faces; ++f) {
+            const double* n = grid.face_normals + 3*f;
+            flux[f] = vx*n[0] + vy*n[1] + vz*n[2];
+            const int c0 = grid.face_cells[2*f + 0];
+            const int c1 = grid.face_cells[2*f + 1];
+            if (c1 < 0) {
+                src[c0] -= flux[f];
+            } else if (c0 < 0) {
+                src[c1] += flux[f];
+            }
+        }
+    }
+
+    // Add a counterclockwise circulation of strength s around the
+    // node v of a 2D grid, making its cells strongly connected.
+    void addCirculation(const UnstructuredGrid& grid, const int v, const double s,
+                        std::vector<double>& flux)
+    {
+        for (int f = 0; f < grid.number_of_faces; ++f) {
+            const int n0 = grid.face_nodes[grid.face_nodepos[f] + 0];
+            const int n1 = grid.face_nodes[grid.face_nodepos[f] + 1];
+            if (n0 != v && n1 != v) {
+                continue;
+            }
+            const int w = (n0 == v) ? n1 : n0;
+            const double dx = grid.node_coordinates[2*w + 0] - grid.node_coordinates[2*v + 0];
+            const double dy = grid.node_coordinates[2*w + 1] - grid.node_coordinates[2*v + 1];
+            const double* n = grid.face_normals + 2*f;
+            flux[f] += s*(-dy*n[0] + dx*n[1]);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(levelScheduledMatchesSequential)
+{
+    const GridManager gm(20, 15);
+    const UnstructuredGrid& grid = *gm.c_grid();
+
+    std::vector<double> flux, src;
+    uniformFlow(grid, 1.0, 0.5, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    std::vector<double> tof_seq;
+    TofReorder seq(grid);
+    seq.solveTof(flux.data(), pv.data(), src.data(), tof_seq);
+
+    std::vector<double> tof_lev;
+    TofReorder lev(grid);
+    lev.useLevelScheduling(true);
+    lev.solveTof(flux.data(), pv.data(), src.data(), tof_lev);
+
+    BOOST_REQUIRE_EQUAL(tof_seq.size(), tof_lev.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(tof_seq.begin(), tof_seq.end(),
+                                  tof_lev.begin(), tof_lev.end());
+
+    std::vector<double> tof_par;
+    TofReorder par(grid);
+    par.useLevelScheduling(true);
+    par.useParallelOrdering(true);
+    par.solveTof(flux.data(), pv.data(), src.data(), tof_par);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(tof_seq.begin(), tof_seq.end(),
+                                  tof_par.begin(), tof_par.end());
+}
+
+
+BOOST_AUTO_TEST_CASE(batchedTracersPartitionUnity)
+{
+    const GridManager gm(20, 15);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const int nc = grid.number_of_cells;
+
+    std::vector<double> flux, src;
+    uniformFlow(grid, 1.0, 0.5, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    // Represent boundary flow by sources only.
+    for (int f = 0; f < grid.number_of_faces; ++f) {
+        if ((grid.face_cells[2*f + 0] < 0) || (grid.face_cells[2*f + 1] < 0)) {
+            flux[f] = 0.0;
+        }
+    }
+
+    // One tracer per source cell, so that tracers sum to one everywhere.
+    SparseTable<int> heads;
+    for (int c = 0; c < nc; ++c) {
+        if (src[c] > 0.0) {
+            heads.appendRow(&c, &c + 1);
+        }
+    }
+    const int nt = heads.size();
+    BOOST_REQUIRE(nt > 1);
+
+    std::vector<double> tof_ref;
+    TofReorder ref(grid);
+    ref.solveTof(flux.data(), pv.data(), src.data(), tof_ref);
+
+    std::vector<double> tof, tracer;
+    TofReorder solver(grid);
+    solver.solveTofTracer(flux.data(), pv.data(), src.data(), heads, tof, tracer);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(tof_ref.begin(), tof_ref.end(),
+                                  tof.begin(), tof.end());
+    BOOST_REQUIRE_EQUAL(tracer.size(), std::vector<double>::size_type(nc*nt));
+    for (int c = 0; c < nc; ++c) {
+        double sum = 0.0;
+        for (int tr = 0; tr < nt; ++tr) {
+            sum += tracer[nt*c + tr];
+        }
+        BOOST_CHECK_CLOSE(sum, 1.0, 1.0e-10);
+    }
+    // Tracer heads carry their own tracer only.
+    for (int tr = 0; tr < nt; ++tr) {
+        const int c = heads[tr][0];
+        BOOST_CHECK_EQUAL(tracer[nt*c + tr], 1.0);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(levelSweepMatchesReorder)
+{
+    const GridManager gm(20, 15);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const int nc = grid.number_of_cells;
+
+    std::vector<double> flux, src;
+    uniformFlow(grid, 1.0, 0.5, flux, src);
+    // Two loops, giving multi-cell components in the same level.
+    addCirculation(grid, 5*21 + 5, 4.0, flux);
+    addCirculation(grid, 5*21 + 15, 4.0, flux);
+    std::vector<double> pv(nc);
+    for (int c = 0; c < nc; ++c) {
+        pv[c] = 1.0 + 0.1*(c % 7);
+    }
+
+    SparseTable<int> heads;
+    for (int c = 0; c < nc; ++c) {
+        if (src[c] > 0.0) {
+            heads.appendRow(&c, &c + 1);
+        }
+    }
+
+    std::vector<double> tof_ref, tracer_ref;
+    TofReorder ref(grid);
+    ref.solveTofTracer(flux.data(), pv.data(), src.data(), heads, tof_ref, tracer_ref);
+
+    TofLevelSweep sweep(grid);
+    std::vector<double> tof, tracer;
+    sweep.solveTofTracer(flux.data(), pv.data(), src.data(), heads, tof, tracer);
+    BOOST_CHECK_EQUAL_COLLECTIONS(tof_ref.begin(), tof_ref.end(),
+                                  tof.begin(), tof.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(tracer_ref.begin(), tracer_ref.end(),
+                                  tracer.begin(), tracer.end());
+
+    // Repeated solves reuse the connectivity, only the fluxes change.
+    uniformFlow(grid, 0.5, 1.0, flux, src);
+    ref.solveTof(flux.data(), pv.data(), src.data(), tof_ref);
+    sweep.solveTof(flux.data(), pv.data(), src.data(), tof);
+    BOOST_CHECK_EQUAL_COLLECTIONS(tof_ref.begin(), tof_ref.end(),
+                                  tof.begin(), tof.end());
+}
+
+
+BOOST_AUTO_TEST_CASE(incrementalUpdateMatchesFullSolve)
+{
+    const GridManager gm(20, 15);
+    const UnstructuredGrid& grid = *gm.c_grid();
+
+    std::vector<double> flux, src;
+    uniformFlow(grid, 1.0, 0.5, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    std::vector<double> tof_inc;
+    TofReorder inc(grid);
+    inc.updateTof(flux.data(), pv.data(), src.data(), tof_inc);
+
+    // Perturb the fluxes of one interior cell without changing
+    // their directions, then also reverse one of them.
+    const int cell = 5 + 20*7;
+    const int first_face = grid.cell_faces[grid.cell_facepos[cell]];
+    for (int reverse = 0; reverse < 2; ++reverse) {
+        if (reverse) {
+            flux[first_face] = -flux[first_face];
+        } else {
+            for (int i = grid.cell_facepos[cell]; i < grid.cell_facepos[cell + 1]; ++i) {
+                flux[grid.cell_faces[i]] *= 1.5;
+            }
+        }
+        inc.updateTof(flux.data(), pv.data(), src.data(), tof_inc);
+
+        std::vector<double> tof_full;
+        TofReorder full(grid);
+        full.solveTof(flux.data(), pv.data(), src.data(), tof_full);
+
+        BOOST_REQUIRE_EQUAL(tof_full.size(), tof_inc.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(tof_full.begin(), tof_full.end(),
+                                      tof_inc.begin(), tof_inc.end());
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(incrementalTracerUpdateMatchesFullSolve)
+{
+    const GridManager gm(20, 15);
+    const UnstructuredGrid& grid = *gm.c_grid();
+    const int nc = grid.number_of_cells;
+
+    std::vector<double> flux, src;
+    uniformFlow(grid, 1.0, 0.5, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    std::vector<int> head_cells;
+    for (int c = 0; c < nc; ++c) {
+        if (src[c] > 0.0) {
+            head_cells.push_back(c);
+        }
+    }
+    BOOST_REQUIRE(head_cells.size() > 1);
+    SparseTable<int> heads;
+    heads.appendRow(&head_cells[0], &head_cells[0] + 1);
+    heads.appendRow(&head_cells[1], &head_cells[0] + head_cells.size());
+
+    std::vector<double> tof_inc, tracer_inc;
+    TofReorder inc(grid);
+    inc.updateTofTracer(flux.data(), pv.data(), src.data(), heads, tof_inc, tracer_inc);
+
+    // Change the fluxes near the first head and move that head.
+    const int cell = head_cells[0];
+    for (int i = grid.cell_facepos[cell]; i < grid.cell_facepos[cell + 1]; ++i) {
+        flux[grid.cell_faces[i]] *= 2.0;
+    }
+    SparseTable<int> moved_heads;
+    moved_heads.appendRow(&head_cells[1], &head_cells[1] + 1);
+    moved_heads.appendRow(&head_cells[0], &head_cells[0] + 1);
+    inc.updateTofTracer(flux.data(), pv.data(), src.data(), moved_heads, tof_inc, tracer_inc);
+
+    std::vector<double> tof_full, tracer_full;
+    TofReorder full(grid);
+    full.solveTofTracer(flux.data(), pv.data(), src.data(), moved_heads, tof_full, tracer_full);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(tof_full.begin(), tof_full.end(),
+                                  tof_inc.begin(), tof_inc.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(tracer_full.begin(), tracer_full.end(),
+                                  tracer_inc.begin(), tracer_inc.end());
+}
+
+
+BOOST_AUTO_TEST_CASE(discGalLevelScheduledMatchesSequential)
+{
+    const GridManager gm(8, 6, 4);
+    const UnstructuredGrid& grid = *gm.c_grid();
+
+    std::vector<double> flux, src;
+    uniformFlow3d(grid, 1.0, 0.5, 0.25, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    // Both DG1 bases in 3D, i.e., 4 and 8 unknowns per cell.
+    for (int tensorial = 0; tensorial < 2; ++tensorial) {
+        parameter::ParameterGroup param;
+        param.insertParameter("dg_degree", "1");
+        param.insertParameter("use_tensorial_basis", tensorial ? "true" : "false");
+        param.insertParameter("use_limiter", "true");
+
+        std::vector<double> tof_seq;
+        TofDiscGalReorder seq(grid, param);
+        seq.solveTof(flux.data(), pv.data(), src.data(), tof_seq);
+
+        param.insertParameter("use_level_scheduling", "true");
+        std::vector<double> tof_lev;
+        TofDiscGalReorder lev(grid, param);
+        lev.solveTof(flux.data(), pv.data(), src.data(), tof_lev);
+
+        BOOST_REQUIRE_EQUAL(tof_seq.size(), std::size_t(grid.number_of_cells*(tensorial ? 8 : 4)));
+        BOOST_REQUIRE_EQUAL(tof_seq.size(), tof_lev.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(tof_seq.begin(), tof_seq.end(),
+                                      tof_lev.begin(), tof_lev.end());
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(discGalQuadratureTablesMatchOnTheFly)
+{
+    const GridManager gm(6, 5, 3);
+    const UnstructuredGrid& grid = *gm.c_grid();
+
+    std::vector<double> flux, src;
+    uniformFlow3d(grid, 1.0, 0.5, 0.25, flux, src);
+    const std::vector<double> pv(grid.number_of_cells, 1.0);
+
+    for (int tensorial = 0; tensorial < 2; ++tensorial) {
+        parameter::ParameterGroup param;
+        param.insertParameter("dg_degree", "1");
+        param.insertParameter("use_tensorial_basis", tensorial ? "true" : "false");
+
+        std::vector<double> tof_ref;
+        TofDiscGalReorder ref(grid, param);
+        ref.solveTof(flux.data(), pv.data(), src.data(), tof_ref);
+
+        param.insertParameter("use_quadrature_tables", "true");
+        std::vector<double> tof_quad;
+        TofDiscGalReorder quad(grid, param);
+        quad.solveTof(flux.data(), pv.data(), src.data(), tof_quad);
+
+        param.insertParameter("use_basis_tables", "true");
+        std::vector<double> tof_basis;
+        TofDiscGalReorder basis(grid, param);
+        basis.solveTof(flux.data(), pv.data(), src.data(), tof_basis);
+        // Repeated solves reuse the tables.
+        basis.solveTof(flux.data(), pv.data(), src.data(), tof_basis);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(tof_ref.begin(), tof_ref.end(),
+                                      tof_quad.begin(), tof_quad.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(tof_ref.begin(), tof_ref.end(),
+                                      tof_basis.begin(), tof_basis.end());
+    }
+}
@@ -0,0 +1,281 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+/* --- Boost.Test boilerplate --- */
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE TpfaOperatorTest
+#include <boost/test/unit_test.hpp>
+
+/* --- our own headers --- */
+#include <opm/core/pressure/tpfa/TpfaOperator.hpp>
+#include <opm/core/pressure/tpfa/IfsTpfa.hpp>
+#include <opm/core/pressure/tpfa/ifs_tpfa.h>
+#include <opm/core/pressure/flow_bc.h>
+#include <opm/core/linalg/sparse_sys.h>
+#include <opm/core/grid/cart_grid.h>
+#include <opm/core/grid/CartesianGridView.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/wells.h>
+#include <opm/core/well_controls.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Compares TpfaOperator with the matrix of ifs_tpfa_assemble().
+    void checkAgainstAssembled(UnstructuredGrid* g, const std::vector<double>& trans,
+                               const ifs_tpfa_forces& forces, Wells* W)
+    {
+        const Opm::TpfaOperator op(*g, trans.data(), &forces);
+
+        ifs_tpfa_data* h = ifs_tpfa_construct(g, W);
+        BOOST_REQUIRE(h != 0);
+        const std::vector<double> gpress(g->cell_facepos[g->number_of_cells], 0.0);
+        BOOST_REQUIRE(ifs_tpfa_assemble(g, &forces, trans.data(), gpress.data(), h));
+
+        const CSRMatrix& A = *h->A;
+        BOOST_REQUIRE_EQUAL(op.size(), int(A.m));
+
+        std::vector<double> x(A.m), y(A.m), yref(A.m, 0.0);
+        for (size_t i = 0; i < A.m; ++i) {
+            x[i] = std::sin(0.9*i + 0.3);
+        }
+        op.apply(x.data(), y.data());
+        for (size_t i = 0; i < A.m; ++i) {
+            for (int j = A.ia[i]; j < A.ia[i + 1]; ++j) {
+                yref[i] += A.sa[j] * x[A.ja[j]];
+                if (A.ja[j] == int(i)) {
+                    BOOST_CHECK_CLOSE(op.diagonal()[i], A.sa[j], 1e-12);
+                }
+            }
+            BOOST_CHECK_CLOSE(y[i], yref[i], 1e-10);
+        }
+
+        ifs_tpfa_destroy(h);
+    }
+
+    // Gravity pressure contributions in the half-face order of a grid.
+    template <class Grid>
+    std::vector<double> halfFaceGravity(const Grid& g)
+    {
+        using namespace Opm::UgGridHelpers;
+        std::vector<double> gpress;
+        const typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(g);
+        for (int c = 0; c < numCells(g); ++c) {
+            const typename Cell2FacesTraits<Grid>::Type::row_type faces = c2f[c];
+            for (auto f = faces.begin(), end = faces.end(); f != end; ++f) {
+                const auto& fc = faceCentroid(g, *f);
+                gpress.push_back(9.81*(fc[2] - cellCentroidCoordinate(g, c, 2)));
+            }
+        }
+        return gpress;
+    }
+
+    std::vector<double> faceTrans(const UnstructuredGrid* g)
+    {
+        std::vector<double> trans(g->number_of_faces);
+        for (int f = 0; f < g->number_of_faces; ++f) {
+            trans[f] = 1.0 + 0.5*std::cos(1.7*f);
+        }
+        return trans;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE ()
+
+BOOST_AUTO_TEST_CASE (neumann_matches_assembled)
+{
+    std::shared_ptr<UnstructuredGrid> g(create_grid_cart2d(6, 4, 1.0, 1.0), destroy_grid);
+    const std::vector<double> trans = faceTrans(g.get());
+
+    ifs_tpfa_forces forces = { 0, 0, 0, 0, 0 };
+    checkAgainstAssembled(g.get(), trans, forces, 0);
+
+    const Opm::TpfaOperator op(*g, trans.data());
+    BOOST_CHECK(op.singular());
+}
+
+BOOST_AUTO_TEST_CASE (wells_and_bc_match_assembled)
+{
+    std::shared_ptr<UnstructuredGrid> g(create_grid_cart2d(6, 4, 1.0, 1.0), destroy_grid);
+    const int nc = g->number_of_cells;
+    const std::vector<double> trans = faceTrans(g.get());
+
+    std::shared_ptr<Wells> W(create_wells(1, 3, 5), destroy_wells);
+    BOOST_REQUIRE(W);
+    const double frac[] = { 1.0 };
+    const double invalid_alq = -1e100;
+    const int invalid_vfp = -2147483647;
+    {
+        const int cells[] = { 0, 6 };
+        const double WI[] = { 1.0, 2.0 };
+        BOOST_REQUIRE(add_well(INJECTOR, 0.0, 2, frac, cells, WI, "RATE", true, W.get()));
+        BOOST_REQUIRE(append_well_controls(RESERVOIR_RATE, 1.0, invalid_alq, invalid_vfp,
+                                           frac, 0, W.get()));
+    }
+    {
+        const int cells[] = { 23, 17 };
+        const double WI[] = { 3.0, 0.5 };
+        BOOST_REQUIRE(add_well(PRODUCER, 0.0, 2, frac, cells, WI, "BHP", true, W.get()));
+        BOOST_REQUIRE(append_well_controls(BHP, 0.0, invalid_alq, invalid_vfp,
+                                           0, 1, W.get()));
+    }
+    {
+        const int cells[] = { 10 };
+        const double WI[] = { 1.5 };
+        BOOST_REQUIRE(add_well(PRODUCER, 0.0, 1, frac, cells, WI, "SHUT", true, W.get()));
+        BOOST_REQUIRE(append_well_controls(BHP, 0.0, invalid_alq, invalid_vfp,
+                                           0, 2, W.get()));
+    }
+    for (int w = 0; w < 3; ++w) {
+        set_current_control(w, 0, W.get());
+    }
+    well_controls_stop_well(W->ctrls[2]);
+
+    std::vector<double> totmob(nc), wdp(5, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        totmob[c] = 0.5 + 0.1*c;
+    }
+
+    std::shared_ptr<FlowBoundaryConditions> bc(flow_conditions_construct(1),
+                                               flow_conditions_destroy);
+    // Face 0 is the left boundary face of cell 0.
+    BOOST_REQUIRE(flow_conditions_append(BC_PRESSURE, 0, 1.0, bc.get()));
+
+    ifs_tpfa_forces forces = { 0, bc.get(), W.get(), totmob.data(), wdp.data() };
+    checkAgainstAssembled(g.get(), trans, forces, W.get());
+
+    const Opm::TpfaOperator op(*g, trans.data(), &forces);
+    BOOST_CHECK(!op.singular());
+}
+
+BOOST_AUTO_TEST_CASE (cartesian_grid_view_matches_unstructured)
+{
+    std::shared_ptr<UnstructuredGrid> g(create_grid_hexa3d(4, 3, 2, 1.0, 2.0, 0.5), destroy_grid);
+    const Opm::CartesianGridView v(4, 3, 2, 1.0, 2.0, 0.5);
+    const std::vector<double> trans = faceTrans(g.get());
+
+    std::shared_ptr<FlowBoundaryConditions> bc(flow_conditions_construct(1),
+                                               flow_conditions_destroy);
+    BOOST_REQUIRE(flow_conditions_append(BC_PRESSURE, 0, 1.0, bc.get()));
+    ifs_tpfa_forces forces = { 0, bc.get(), 0, 0, 0 };
+
+    const Opm::TpfaOperator op(*g, trans.data(), &forces);
+    const Opm::BasicTpfaOperator<Opm::CartesianGridView> opv(v, trans.data(), &forces);
+    BOOST_REQUIRE_EQUAL(opv.size(), op.size());
+    BOOST_CHECK(!opv.singular());
+
+    const int n = op.size();
+    std::vector<double> x(n), y(n), yv(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = std::sin(0.9*i + 0.3);
+    }
+    op.apply(x.data(), y.data());
+    opv.apply(x.data(), yv.data());
+    for (int i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(opv.diagonal()[i], op.diagonal()[i]);
+        BOOST_CHECK_CLOSE(yv[i], y[i], 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (templated_assembly_matches_c)
+{
+    std::shared_ptr<UnstructuredGrid> g(create_grid_hexa3d(4, 3, 2, 1.0, 2.0, 0.5), destroy_grid);
+    const Opm::CartesianGridView v(4, 3, 2, 1.0, 2.0, 0.5);
+    const int nc = g->number_of_cells;
+    const std::vector<double> trans = faceTrans(g.get());
+
+    std::shared_ptr<Wells> W(create_wells(1, 2, 3), destroy_wells);
+    BOOST_REQUIRE(W);
+    const double frac[] = { 1.0 };
+    const double invalid_alq = -1e100;
+    const int invalid_vfp = -2147483647;
+    {
+        const int cells[] = { 0, 12 };
+        const double WI[] = { 1.0, 2.0 };
+        BOOST_REQUIRE(add_well(INJECTOR, 0.0, 2, frac, cells, WI, "RATE", true, W.get()));
+        BOOST_REQUIRE(append_well_controls(RESERVOIR_RATE, 1.0, invalid_alq, invalid_vfp,
+                                           frac, 0, W.get()));
+    }
+    {
+        const int cells[] = { 23 };
+        const double WI[] = { 3.0 };
+        BOOST_REQUIRE(add_well(PRODUCER, 0.0, 1, frac, cells, WI, "BHP", true, W.get()));
+        BOOST_REQUIRE(append_well_controls(BHP, 0.0, invalid_alq, invalid_vfp,
+                                           0, 1, W.get()));
+    }
+    for (int w = 0; w < 2; ++w) {
+        set_current_control(w, 0, W.get());
+    }
+
+    std::vector<double> totmob(nc), wdp(3, 0.1), src(nc, 0.0);
+    for (int c = 0; c < nc; ++c) {
+        totmob[c] = 0.5 + 0.1*c;
+    }
+    src[5] = 0.25;
+
+    std::shared_ptr<FlowBoundaryConditions> bc(flow_conditions_construct(2),
+                                               flow_conditions_destroy);
+    // Face 0 is the left boundary face of cell 0, face 4 the right
+    // boundary face of cell 3.
+    BOOST_REQUIRE(flow_conditions_append(BC_PRESSURE, 0, 1.0, bc.get()));
+    BOOST_REQUIRE(flow_conditions_append(BC_FLUX_TOTVOL, 4, -0.5, bc.get()));
+
+    const ifs_tpfa_forces forces = { src.data(), bc.get(), W.get(), totmob.data(), wdp.data() };
+
+    const std::vector<double> gpress = halfFaceGravity(*g);
+    const std::vector<double> gpressv = halfFaceGravity(v);
+    BOOST_REQUIRE_EQUAL(gpressv.size(), gpress.size());
+
+    std::shared_ptr<ifs_tpfa_data> href(ifs_tpfa_construct(g.get(), W.get()), ifs_tpfa_destroy);
+    BOOST_REQUIRE(href);
+    BOOST_REQUIRE(ifs_tpfa_assemble(g.get(), &forces, trans.data(), gpress.data(), href.get()));
+
+    const UnstructuredGrid* cg = g.get();
+    std::shared_ptr<ifs_tpfa_data> hg(ifs_tpfa_construct(cg, W.get()), ifs_tpfa_destroy);
+    std::shared_ptr<ifs_tpfa_data> hv(ifs_tpfa_construct(&v, W.get()), ifs_tpfa_destroy);
+    BOOST_REQUIRE(hg);
+    BOOST_REQUIRE(hv);
+    BOOST_REQUIRE(ifs_tpfa_assemble(cg, &forces, trans.data(), gpress.data(), hg.get()));
+    BOOST_REQUIRE(ifs_tpfa_assemble(&v, &forces, trans.data(), gpressv.data(), hv.get()));
+
+    const CSRMatrix& A = *href->A;
+    for (const ifs_tpfa_data* h : { hg.get(), hv.get() }) {
+        BOOST_REQUIRE_EQUAL(h->A->m, A.m);
+        for (size_t i = 0; i < A.m; ++i) {
+            BOOST_REQUIRE_EQUAL(h->A->ia[i + 1], A.ia[i + 1]);
+            for (int j = A.ia[i]; j < A.ia[i + 1]; ++j) {
+                BOOST_CHECK_EQUAL(h->A->ja[j], A.ja[j]);
+                BOOST_CHECK_CLOSE(h->A->sa[j], A.sa[j], 1e-12);
+            }
+            BOOST_CHECK_CLOSE(h->b[i], href->b[i], 1e-12);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,10 +17,14 @@
 
 /* --- our own headers --- */
 #include <algorithm>
+#include <cstdio>
+#include <thread>
 #include <vector>
 #include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
 #include <opm/core/grid/cornerpoint_grid.h>  /* compute_geometry */
 #include <opm/core/grid/GridManager.hpp>  /* compute_geometry */
+#include <opm/core/grid/GridHelpers.hpp>
 #include <opm/core/grid/cpgpreprocess/preprocess.h>
 #include <opm/parser/eclipse/Parser/Parser.hpp>
 #include <opm/parser/eclipse/Parser/ParseContext.hpp>
@@ -168,3 +172,181 @@ BOOST_AUTO_TEST_CASE(TOPS_Fully_Specified) {
 }
 
 
+
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTrip) {
+    const std::string filename = "CORNERPOINT_ACTNUM.DATA";
+    Opm::ParserPtr parser(new Opm::Parser() );
+    Opm::ParseContext parseContext;
+    Opm::DeckConstPtr deck = parser->parseFile( filename , parseContext);
+
+    Opm::GridManager gridM(deck);
+    const UnstructuredGrid* cgrid1 = gridM.c_grid();
+
+    const char* binfile = "test_ug_binary.ugb";
+    const uint64_t key = 12345;
+    BOOST_REQUIRE( write_grid_binary( cgrid1 , binfile , key ));
+
+    struct UnstructuredGrid * cgrid2 = read_grid_binary( binfile , key );
+    BOOST_REQUIRE( cgrid2 != NULL );
+    BOOST_CHECK( grid_equal( cgrid1 , cgrid2 ));
+    BOOST_CHECK( std::equal( cgrid1->cartdims , cgrid1->cartdims + 3 , cgrid2->cartdims ));
+    destroy_grid( cgrid2 );
+
+    // A different key never matches.
+    BOOST_CHECK( read_grid_binary( binfile , key + 1 ) == NULL );
+
+#if defined(__unix__)
+    struct UnstructuredGrid * cgrid3 = map_grid_binary( binfile , key );
+    BOOST_REQUIRE( cgrid3 != NULL );
+    BOOST_CHECK( cgrid3->mapping != NULL );
+    BOOST_CHECK( grid_equal( cgrid1 , cgrid3 ));
+    destroy_grid( cgrid3 );
+    BOOST_CHECK( map_grid_binary( binfile , key + 1 ) == NULL );
+#endif
+
+    std::remove( binfile );
+}
+
+
+BOOST_AUTO_TEST_CASE(ConcurrentBinaryWriters) {
+    struct UnstructuredGrid* g = create_grid_hexa3d(6, 5, 4, 1.0, 2.0, 3.0);
+    BOOST_REQUIRE( g != NULL );
+
+    // Writers of the same cache file must not clobber each other's
+    // temporary file, so that whatever is published is complete.
+    const char* binfile = "test_ug_concurrent.ugb";
+    const uint64_t key = 54321;
+    std::vector<int> ok(4, 1);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&, t]() {
+                for (int i = 0; i < 10; ++i) {
+                    ok[t] = ok[t] && write_grid_binary( g , binfile , key );
+                }
+            });
+    }
+    for (auto& w : writers) {
+        w.join();
+    }
+    for (int t = 0; t < 4; ++t) {
+        BOOST_CHECK( ok[t] );
+    }
+
+    struct UnstructuredGrid* g2 = read_grid_binary( binfile , key );
+    BOOST_REQUIRE( g2 != NULL );
+    BOOST_CHECK( grid_equal( g , g2 ));
+    destroy_grid( g2 );
+
+    std::remove( binfile );
+    destroy_grid( g );
+}
+
+
+BOOST_AUTO_TEST_CASE(CachedHash) {
+    struct UnstructuredGrid* g1 = create_grid_hexa3d(4, 3, 2, 1.0, 2.0, 3.0);
+    struct UnstructuredGrid* g2 = create_grid_hexa3d(4, 3, 2, 1.0, 2.0, 3.0);
+    BOOST_REQUIRE( g1 != NULL );
+    BOOST_REQUIRE( g2 != NULL );
+
+    BOOST_CHECK( g1->topology_hash != 0 );
+    BOOST_CHECK( g1->geometry_hash != 0 );
+    BOOST_CHECK_EQUAL( g1->topology_hash , g2->topology_hash );
+    BOOST_CHECK_EQUAL( g1->geometry_hash , g2->geometry_hash );
+    BOOST_CHECK( grid_equal( g1 , g2 ));
+
+    // Same topology, different spacing.
+    struct UnstructuredGrid* g3 = create_grid_hexa3d(4, 3, 2, 1.0, 2.0, 4.0);
+    BOOST_REQUIRE( g3 != NULL );
+    BOOST_CHECK_EQUAL( g1->topology_hash , g3->topology_hash );
+    BOOST_CHECK( g1->geometry_hash != g3->geometry_hash );
+    BOOST_CHECK( !grid_equal( g1 , g3 ));
+    destroy_grid( g3 );
+
+    // Geometry within the comparison tolerance still compares equal.
+    g2->node_coordinates[3] *= 1.0 + 1.0e-14;
+    grid_update_hash( g2 );
+    BOOST_CHECK( g1->geometry_hash != g2->geometry_hash );
+    BOOST_CHECK( grid_equal( g1 , g2 ));
+
+    // Modified topology is detected with unknown and with refreshed hashes.
+    std::swap( g2->face_cells[0] , g2->face_cells[1] );
+    grid_invalidate_hash( g2 );
+    BOOST_CHECK( !grid_equal( g1 , g2 ));
+    grid_update_hash( g2 );
+    BOOST_CHECK( g1->topology_hash != g2->topology_hash );
+    BOOST_CHECK( !grid_equal( g1 , g2 ));
+
+    destroy_grid( g2 );
+    destroy_grid( g1 );
+}
+
+
+BOOST_AUTO_TEST_CASE(GeometryMask) {
+    // Single column of two cells with a sloping top.
+    const double coord[] = { 0, 0, 0,  0, 0, 3,   1, 0, 0,  1, 0, 3,
+                             0, 1, 0,  0, 1, 3,   1, 1, 0,  1, 1, 3 };
+    const double zcorn[] = { 0.0, 0.2, 0.1, 0.3,   1, 1, 1, 1,
+                             1, 1, 1, 1,              2, 2, 2, 2.5 };
+    struct grdecl g;
+    g.dims[0] = 1;  g.dims[1] = 1;  g.dims[2] = 2;
+    g.coord   = coord;
+    g.zcorn   = zcorn;
+    g.actnum  = NULL;
+    g.mapaxes = NULL;
+
+    struct UnstructuredGrid* full = create_grid_cornerpoint(&g, 0.0);
+    struct UnstructuredGrid* lean = create_grid_cornerpoint_masked(&g, 0.0, 1, 0);
+    BOOST_REQUIRE( full != NULL );
+    BOOST_REQUIRE( lean != NULL );
+
+    BOOST_CHECK( lean->face_centroids == NULL );
+    BOOST_CHECK( lean->cell_centroids == NULL );
+    BOOST_CHECK_EQUAL_COLLECTIONS( lean->cell_volumes, lean->cell_volumes + lean->number_of_cells,
+                                   full->cell_volumes, full->cell_volumes + full->number_of_cells );
+    BOOST_CHECK_EQUAL_COLLECTIONS( lean->face_normals, lean->face_normals + 3*lean->number_of_faces,
+                                   full->face_normals, full->face_normals + 3*full->number_of_faces );
+
+    // Centroids are computed on demand.
+    const double* cc = Opm::UgGridHelpers::cellCentroid( *lean , 1 );
+    BOOST_CHECK( lean->cell_centroids != NULL );
+    BOOST_CHECK_EQUAL_COLLECTIONS( cc, cc + 3, full->cell_centroids + 3, full->cell_centroids + 6 );
+    BOOST_CHECK( grid_equal( full , lean ));
+
+    destroy_grid( lean );
+    destroy_grid( full );
+}
+
+
+BOOST_AUTO_TEST_CASE(InplaceZcorn) {
+    // Two columns of two cells, with a fault between the columns.
+    const double coord[] = { 0, 0, 0,  0, 0, 3,   1, 0, 0,  1, 0, 3,   2, 0, 0,  2, 0, 3,
+                             0, 1, 0,  0, 1, 3,   1, 1, 0,  1, 1, 3,   2, 1, 0,  2, 1, 3 };
+    const std::vector<double> zcorn = { 0.0, 0.2, 0.5, 0.5,  0.1, 0.3, 0.5, 0.5,
+                                        1.0, 1.0, 1.5, 1.5,  1.0, 1.0, 1.5, 1.5,
+                                        1.0, 1.0, 1.5, 1.5,  1.0, 1.0, 1.5, 1.5,
+                                        2.0, 2.0, 2.5, 2.5,  2.0, 2.5, 2.5, 2.5 };
+    for (int sign = 1; sign >= -1; sign -= 2) {
+        std::vector<double> z(zcorn);
+        for (double& zi : z) {
+            zi *= sign;
+        }
+        struct grdecl g;
+        g.dims[0] = 2;  g.dims[1] = 1;  g.dims[2] = 2;
+        g.coord   = coord;
+        g.zcorn   = z.data();
+        g.actnum  = NULL;
+        g.mapaxes = NULL;
+
+        struct UnstructuredGrid* copied = create_grid_cornerpoint(&g, 0.0);
+        struct UnstructuredGrid* inplace = create_grid_cornerpoint_inplace(&g, z.data(), 0.0, 1,
+                                                                           GRID_GEOMETRY_ALL);
+        BOOST_REQUIRE( copied != NULL );
+        BOOST_REQUIRE( inplace != NULL );
+        BOOST_CHECK_EQUAL( inplace->number_of_cells, 4 );
+        BOOST_CHECK( grid_equal( copied , inplace ));
+
+        destroy_grid( inplace );
+        destroy_grid( copied );
+    }
+}
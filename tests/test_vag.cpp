@@ -0,0 +1,131 @@
+/*
+  Copyright 2016 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#define NVERBOSE  // Suppress own messages when throw()ing
+
+#define BOOST_TEST_MODULE VagTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/core/io/vag/vag.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/cart_grid.h>
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+typedef std::unique_ptr<UnstructuredGrid, void(*)(UnstructuredGrid*)> GridPtr;
+
+GridPtr cartesianGrid ()
+{
+    return GridPtr (create_grid_cart3d (3, 2, 2), destroy_grid);
+}
+
+GridPtr toGrid (Opm::VAG& vag)
+{
+    GridPtr grid (allocate_grid (3, vag.number_of_volumes, vag.number_of_faces,
+                                 vag.faces_to_vertices.value.size (),
+                                 vag.volumes_to_faces.value.size (),
+                                 vag.number_of_vertices),
+                  destroy_grid);
+    Opm::vagToUnstructuredGrid (vag, *grid);
+    return grid;
+}
+
+void checkSameGrid (const UnstructuredGrid& g1, const UnstructuredGrid& g2)
+{
+    BOOST_REQUIRE_EQUAL (g1.number_of_cells, g2.number_of_cells);
+    BOOST_REQUIRE_EQUAL (g1.number_of_faces, g2.number_of_faces);
+    BOOST_REQUIRE_EQUAL (g1.number_of_nodes, g2.number_of_nodes);
+    BOOST_CHECK_EQUAL_COLLECTIONS (g1.face_cells, g1.face_cells + 2*g1.number_of_faces,
+                                   g2.face_cells, g2.face_cells + 2*g2.number_of_faces);
+    BOOST_CHECK_EQUAL_COLLECTIONS (g1.face_nodes, g1.face_nodes + g1.face_nodepos[g1.number_of_faces],
+                                   g2.face_nodes, g2.face_nodes + g2.face_nodepos[g2.number_of_faces]);
+    BOOST_CHECK_EQUAL_COLLECTIONS (g1.cell_faces, g1.cell_faces + g1.cell_facepos[g1.number_of_cells],
+                                   g2.cell_faces, g2.cell_faces + g2.cell_facepos[g2.number_of_cells]);
+    BOOST_CHECK_EQUAL_COLLECTIONS (g1.node_coordinates, g1.node_coordinates + 3*g1.number_of_nodes,
+                                   g2.node_coordinates, g2.node_coordinates + 3*g2.number_of_nodes);
+    for (int c = 0; c < g1.number_of_cells; ++c) {
+        BOOST_CHECK_CLOSE (g1.cell_volumes[c], g2.cell_volumes[c], 1e-10);
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE (TextRoundTrip)
+{
+    GridPtr grid = cartesianGrid ();
+    Opm::VAG vag;
+    Opm::unstructuredGridToVag (*grid, vag);
+
+    std::stringstream text;
+    Opm::writeVagFormat (text, vag);
+    Opm::VAG read;
+    Opm::readVagGrid (text, read);
+
+    BOOST_CHECK_EQUAL (read.number_of_vertices, vag.number_of_vertices);
+    BOOST_CHECK_EQUAL (read.number_of_volumes, vag.number_of_volumes);
+    BOOST_CHECK_EQUAL (read.number_of_faces, vag.number_of_faces);
+    BOOST_CHECK_EQUAL (read.number_of_edges, vag.number_of_edges);
+    BOOST_CHECK (read.edges == vag.edges);
+    BOOST_CHECK (read.faces_to_edges.value == vag.faces_to_edges.value);
+    BOOST_CHECK (read.volumes_to_vertices.pos == vag.volumes_to_vertices.pos);
+    checkSameGrid (*grid, *toGrid (read));
+}
+
+BOOST_AUTO_TEST_CASE (BinaryRoundTrip)
+{
+    GridPtr grid = cartesianGrid ();
+    Opm::VAG vag;
+    Opm::unstructuredGridToVag (*grid, vag);
+    vag.material.assign (2*vag.number_of_volumes, 0.5);
+
+    std::stringstream binary;
+    Opm::writeVagBinary (binary, vag);
+    BOOST_CHECK (Opm::isVagBinary (binary.str ()));
+
+    {
+        std::istringstream is (binary.str ());
+        Opm::VAG read;
+        Opm::readVagGrid (is, read);
+        BOOST_CHECK (read.material == vag.material);
+        BOOST_CHECK (read.edges == vag.edges);
+        BOOST_CHECK (read.faces_to_edges.pos == vag.faces_to_edges.pos);
+        checkSameGrid (*grid, *toGrid (read));
+    }
+    {
+        std::istringstream is (binary.str ());
+        GridPtr direct (Opm::readVagBinaryGrid (is), destroy_grid);
+        checkSameGrid (*grid, *direct);
+    }
+    {
+        std::istringstream is (binary.str ().substr (0, binary.str ().size () / 2));
+        BOOST_CHECK_THROW (Opm::readVagBinaryGrid (is), std::runtime_error);
+    }
+}
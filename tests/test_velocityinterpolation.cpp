@@ -29,6 +29,7 @@
 
 #include <opm/core/utility/VelocityInterpolation.hpp>
 #include <opm/core/grid/GridManager.hpp>
+#include <opm/core/grid/GridUtilities.hpp>
 #include <opm/core/grid.h>
 #include <cmath>
 
@@ -465,12 +466,75 @@ void testLinearVelReproIrregPrism()
 }
 
 
+template <class VelInterp>
+void testBatchMatchesSingle()
+{
+    GridManager g(3, 2, 2);
+    const UnstructuredGrid& grid = *g.c_grid();
+    std::vector<double> v0(3);
+    v0[0] = 0.1;
+    v0[1] = -0.2;
+    v0[2] = 0.3;
+    std::vector<double> v1(3);
+    v1[0] = 0.5;
+    v1[1] = 0.25;
+    v1[2] = -1.0;
+    std::vector<double> flux;
+    computeFluxLinear(grid, v0, v1, flux);
+    VelInterp vic(grid);
+    vic.setupFluxes(&flux[0]);
+
+    // Points in each cell, between the centroid and the corners.
+    const int npoints = 5;
+    for (int cell = 0; cell < grid.number_of_cells; ++cell) {
+        std::vector<double> x(3*npoints);
+        for (int pt = 0; pt < npoints; ++pt) {
+            for (int dd = 0; dd < 3; ++dd) {
+                const double offset = 0.1*(pt + 1)*(((pt + dd) % 2 == 0) ? 1.0 : -1.0);
+                x[3*pt + dd] = grid.cell_centroids[3*cell + dd] + offset;
+            }
+        }
+        std::vector<double> v_batch(3*npoints);
+        vic.interpolate(cell, npoints, &x[0], &v_batch[0]);
+        for (int pt = 0; pt < npoints; ++pt) {
+            std::vector<double> v_single(3);
+            vic.interpolate(cell, &x[3*pt], &v_single[0]);
+            for (int dd = 0; dd < 3; ++dd) {
+                BOOST_CHECK_EQUAL(v_batch[3*pt + dd], v_single[dd]);
+            }
+        }
+    }
+}
+
+
+static void testSharedConnectivity()
+{
+    GridManager g(3, 2, 2);
+    const UnstructuredGrid& grid = *g.c_grid();
+    std::vector<double> v0(3, 0.2);
+    std::vector<double> v1(3, -0.1);
+    std::vector<double> flux;
+    computeFluxLinear(grid, v0, v1, flux);
+    VelocityInterpolationECVI vic(grid);
+    VelocityInterpolationECVI vic_shared(grid, computeGridConnectivity(grid));
+    vic.setupFluxes(&flux[0]);
+    vic_shared.setupFluxes(&flux[0]);
+    for (int cell = 0; cell < grid.number_of_cells; ++cell) {
+        std::vector<double> v(3), v_shared(3);
+        vic.interpolate(cell, grid.cell_centroids + 3*cell, &v[0]);
+        vic_shared.interpolate(cell, grid.cell_centroids + 3*cell, &v_shared[0]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(v.begin(), v.end(), v_shared.begin(), v_shared.end());
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE(test_VelocityInterpolationConstant)
 {
     testConstantVelRepro2d<VelocityInterpolationConstant>();
     testConstantVelReproPyramid<VelocityInterpolationConstant>();
     testConstantVelReproIrreg2d<VelocityInterpolationConstant>();
     testConstantVelReproIrregPrism<VelocityInterpolationConstant>();
+    testBatchMatchesSingle<VelocityInterpolationConstant>();
 }
 
 BOOST_AUTO_TEST_CASE(test_VelocityInterpolationECVI)
@@ -479,6 +543,8 @@ BOOST_AUTO_TEST_CASE(test_VelocityInterpolationECVI)
     BOOST_CHECK_THROW(testConstantVelReproPyramid<VelocityInterpolationECVI>(), std::exception);
     testConstantVelReproIrreg2d<VelocityInterpolationECVI>();
     testConstantVelReproIrregPrism<VelocityInterpolationECVI>();
+    testBatchMatchesSingle<VelocityInterpolationECVI>();
+    testSharedConnectivity();
     // Though the interpolation has linear precision, the corner velocity
     // construction does not, so the below test cannot be expected to succeed.
     // testLinearVelReproIrregPrism<VelocityInterpolationECVI>();
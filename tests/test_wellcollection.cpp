@@ -90,5 +90,6 @@ BOOST_AUTO_TEST_CASE(AddWellsAndGroupToCollection) {
     BOOST_CHECK_EQUAL("G1", collection.findNode("INJ2")->getParent()->name());
     BOOST_CHECK_EQUAL("G2", collection.findNode("PROD1")->getParent()->name());
     BOOST_CHECK_EQUAL("G2", collection.findNode("PROD2")->getParent()->name());
+    BOOST_CHECK(collection.findNode("NOSUCHNODE") == NULL);
 }
 
@@ -247,3 +247,94 @@ BOOST_AUTO_TEST_CASE(Equals_WellsDiffer_ReturnsFalse) {
 
     BOOST_CHECK(!wells_equal(W1.get(), W2.get() , false ));
 }
+
+
+BOOST_AUTO_TEST_CASE(Equals_WellIndexDiffers_ReturnsFalse) {
+    const int nphases = 2;
+
+    std::shared_ptr<Wells> W1(create_wells(nphases, 1, 2), destroy_wells);
+    std::shared_ptr<Wells> W2(create_wells(nphases, 1, 2), destroy_wells);
+    std::shared_ptr<Wells> W3(create_wells(nphases, 1, 2), destroy_wells);
+
+    const int    cells[] = { 0, 9 };
+    const double WI1[]   = { 1.0, 2.0 };
+    const double WI2[]   = { 1.0, 3.0 };
+    const double frac[]  = { 1.0, 0.0 };
+
+    BOOST_REQUIRE(add_well(INJECTOR, 0.0, 2, frac, cells, WI1, "INJ", true, W1.get()));
+    BOOST_REQUIRE(add_well(INJECTOR, 0.0, 2, frac, cells, WI1, "INJ", true, W2.get()));
+    BOOST_REQUIRE(add_well(INJECTOR, 0.0, 2, frac, cells, WI2, "INJ", true, W3.get()));
+
+    BOOST_CHECK( wells_equal(W1.get(), W2.get() , false ));
+    BOOST_CHECK(!wells_equal(W1.get(), W3.get() , false ));
+    BOOST_CHECK(!wells_equal(W1.get(), W3.get() , true  ));
+
+    // Controls are compared even if the well data agree.
+    const double distr[] = { 1.0, 0.0 };
+    BOOST_REQUIRE(append_well_controls(BHP, 1.0e7, invalid_alq, invalid_vfp, distr, 0, W1.get()));
+    BOOST_CHECK(!wells_equal(W1.get(), W2.get() , false ));
+}
+
+
+BOOST_AUTO_TEST_CASE(ControlsTableCheckLimits)
+{
+    const int nphases = 2;
+    const int nwells  = 3;
+    const int nperfs  = 3;
+
+    std::shared_ptr<Wells> W(create_wells(nphases, nwells, nperfs),
+                             destroy_wells);
+    BOOST_REQUIRE(W);
+
+    int          cells[] = { 0, 5, 9 };
+    const double WI      = 1.0;
+    const double frac[]  = { 1.0, 0.0 };
+    BOOST_REQUIRE(add_well(INJECTOR, 0.0, 1, frac, &cells[0], &WI, "INJ", true, W.get()));
+    BOOST_REQUIRE(add_well(PRODUCER, 0.0, 1, frac, &cells[1], &WI, "PROD1", true, W.get()));
+    BOOST_REQUIRE(add_well(PRODUCER, 0.0, 1, frac, &cells[2], &WI, "PROD2", true, W.get()));
+
+    const double total[] = { 1.0, 1.0 };
+    const double water[] = { 1.0, 0.0 };
+    // Injector: rate control, BHP limit.
+    BOOST_REQUIRE(append_well_controls(SURFACE_RATE, 10.0, invalid_alq, invalid_vfp, water, 0, W.get()));
+    BOOST_REQUIRE(append_well_controls(BHP, 300.0, invalid_alq, invalid_vfp, NULL, 0, W.get()));
+    // Producers: rate control, reservoir rate and BHP limits.
+    for (int w = 1; w < nwells; ++w) {
+        BOOST_REQUIRE(append_well_controls(SURFACE_RATE, -5.0, invalid_alq, invalid_vfp, total, w, W.get()));
+        BOOST_REQUIRE(append_well_controls(RESERVOIR_RATE, -8.0, invalid_alq, invalid_vfp, total, w, W.get()));
+        BOOST_REQUIRE(append_well_controls(BHP, 100.0, invalid_alq, invalid_vfp, NULL, w, W.get()));
+    }
+    for (int w = 0; w < nwells; ++w) {
+        set_current_control(w, 0, W.get());
+    }
+
+    const int is_producer[] = { 0, 1, 1 };
+    std::shared_ptr<WellControlsTable>
+        tab(well_controls_table_create(nwells, nphases, W->ctrls, is_producer),
+            well_controls_table_destroy);
+    BOOST_REQUIRE(tab);
+    BOOST_CHECK_EQUAL(tab->ctrl_pos[nwells], 8);
+    BOOST_CHECK_EQUAL(tab->target[tab->ctrl_pos[1] + 1], -8.0);
+
+    // Injector above its BHP limit, PROD1 fine, PROD2 exceeding its
+    // reservoir rate limit and below its BHP limit.
+    const double bhp [] = { 350.0, 150.0, 50.0 };
+    const double resv[] = { 10.0, 0.0, -2.0, -3.0, -4.0, -5.0 };
+    const double surf[] = { 10.0, 0.0, -2.0, -3.0, -2.0, -3.0 };
+    std::vector<int> sw(nwells), sc(nwells);
+    int n = well_controls_table_check_limits(tab.get(), NULL, bhp, resv, surf, sw.data(), sc.data());
+    BOOST_REQUIRE_EQUAL(n, 2);
+    BOOST_CHECK_EQUAL(sw[0], 0);
+    BOOST_CHECK_EQUAL(sc[0], 1);
+    BOOST_CHECK_EQUAL(sw[1], 2);
+    BOOST_CHECK_EQUAL(sc[1], 1);
+
+    // Skipped controls and changed targets.
+    const int skip[] = { -1, -1, 1 };
+    well_controls_iset_target(W->ctrls[0], 1, 400.0);
+    BOOST_REQUIRE(well_controls_table_update(nwells, nphases, W->ctrls, is_producer, tab.get()));
+    n = well_controls_table_check_limits(tab.get(), skip, bhp, resv, surf, sw.data(), sc.data());
+    BOOST_REQUIRE_EQUAL(n, 1);
+    BOOST_CHECK_EQUAL(sw[0], 2);
+    BOOST_CHECK_EQUAL(sc[0], 2);
+}